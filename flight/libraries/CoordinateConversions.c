@@ -32,6 +32,21 @@
 #include <pios_math.h>
 #include "CoordinateConversions.h"
 
+// boards defining USE_FAST_TRIG trade libm precision for the polynomial
+// approximations from mathmisc.h in the attitude conversions
+#ifdef USE_FAST_TRIG
+#include <mathmisc.h>
+#define attitude_sinf   fast_sinf
+#define attitude_cosf   fast_cosf
+#define attitude_asinf  fast_asinf
+#define attitude_atan2f fast_atan2f
+#else
+#define attitude_sinf   sinf
+#define attitude_cosf   cosf
+#define attitude_asinf  asinf
+#define attitude_atan2f atan2f
+#endif
+
 #define MIN_ALLOWABLE_MAGNITUDE 1e-30f
 
 // ****** convert Lat,Lon,Alt to ECEF  ************
@@ -141,9 +156,9 @@ void Quaternion2RPY(const float q[4], float rpy[3])
     R23    = 2.0f * (q[2] * q[3] + q[0] * q[1]);
     R33    = q0s - q1s - q2s + q3s;
 
-    rpy[1] = RAD2DEG(asinf(-R13)); // pitch always between -pi/2 to pi/2
-    rpy[2] = RAD2DEG(atan2f(R12, R11));
-    rpy[0] = RAD2DEG(atan2f(R23, R33));
+    rpy[1] = RAD2DEG(attitude_asinf(-R13)); // pitch always between -pi/2 to pi/2
+    rpy[2] = RAD2DEG(attitude_atan2f(R12, R11));
+    rpy[0] = RAD2DEG(attitude_atan2f(R23, R33));
 
     // TODO: consider the cases where |R13| ~= 1, |pitch| ~= pi/2
 }
@@ -157,12 +172,12 @@ void RPY2Quaternion(const float rpy[3], float q[4])
     phi    = DEG2RAD(rpy[0] / 2);
     theta  = DEG2RAD(rpy[1] / 2);
     psi    = DEG2RAD(rpy[2] / 2);
-    cphi   = cosf(phi);
-    sphi   = sinf(phi);
-    ctheta = cosf(theta);
-    stheta = sinf(theta);
-    cpsi   = cosf(psi);
-    spsi   = sinf(psi);
+    cphi   = attitude_cosf(phi);
+    sphi   = attitude_sinf(phi);
+    ctheta = attitude_cosf(theta);
+    stheta = attitude_sinf(theta);
+    cpsi   = attitude_cosf(psi);
+    spsi   = attitude_sinf(psi);
 
     q[0]   = cphi * ctheta * cpsi + sphi * stheta * spsi;
     q[1]   = sphi * ctheta * cpsi - cphi * stheta * spsi;
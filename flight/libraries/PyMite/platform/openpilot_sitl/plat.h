@@ -27,5 +27,8 @@
 
 #define PM_HEAP_SIZE 0x20000
 #define PM_FLOAT_LITTLE_ENDIAN
+// Code images are only loaded from RAM or flash, both memory mapped, so
+// the interpreter fetches bytecodes inline instead of through plat_memGetByte()
+#define PM_PLAT_MEMSPACES_MAPPED
 
 #endif /* _PLAT_H_ */
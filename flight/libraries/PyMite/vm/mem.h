@@ -54,7 +54,12 @@ typedef enum PmMemSpace_e
  * @return  byte from memory.
  *          paddr - points to the next byte
  */
+#ifdef PM_PLAT_MEMSPACES_MAPPED
+/* RAM and program memory are both in the address space, read them inline */
+#define mem_getByte(memspace, paddr) ((void)(memspace), *(*(paddr))++)
+#else
 #define mem_getByte(memspace, paddr) plat_memGetByte((memspace), (paddr))
+#endif
 
 /**
  * Returns the 2-byte word at the given address in memspace.
@@ -56,6 +56,11 @@
 // #define MALLOC(x) malloc(x)
 // #define FREE(x) free(x)
 
+// size of the cells results are cached for, the field changes by far less than
+// a nT over a cell this size, which is well below the model accuracy
+#define WMM_CACHE_CELL_DEG 0.01f
+#define WMM_CACHE_CELL_ALT 100.0f
+
 // http://reviews.openpilot.org/cru/OPReview-436#c6476 :
 // first column not used but it will be optimized out by compiler
 static const float CoeffFile[91][6] = {
@@ -156,6 +161,18 @@ static WMMtype_Ellipsoid *Ellip = NULL;
 static WMMtype_MagneticModel *MagneticModel = NULL;
 static float decimal_date;
 
+// result of the last evaluation, reused for queries in the same cell on the same day
+static struct {
+    bool     valid;
+    int32_t  lat;
+    int32_t  lon;
+    int32_t  alt;
+    uint16_t month;
+    uint16_t day;
+    uint16_t year;
+    float    B[3];
+} magCache;
+
 /**************************************************************************************
 *   Example use - very simple - only two exposed functions
 *
@@ -221,6 +238,20 @@ int WMM_GetMagVector(float Lat, float Lon, float AltEllipsoid, uint16_t Month, u
         return -4; // error
     }
     // ***********
+    // the full model is expensive, answer repeated queries from the cache
+
+    int32_t latCell = (int32_t)floorf(Lat / WMM_CACHE_CELL_DEG);
+    int32_t lonCell = (int32_t)floorf(Lon / WMM_CACHE_CELL_DEG);
+    int32_t altCell = (int32_t)floorf(AltEllipsoid / WMM_CACHE_CELL_ALT);
+
+    if (magCache.valid && magCache.lat == latCell && magCache.lon == lonCell && magCache.alt == altCell &&
+        magCache.month == Month && magCache.day == Day && magCache.year == Year) {
+        B[0] = magCache.B[0];
+        B[1] = magCache.B[1];
+        B[2] = magCache.B[2];
+        return 0;
+    }
+    // ***********
     // allocated required memory
 
 // Ellip = NULL;
@@ -271,9 +302,20 @@ int WMM_GetMagVector(float Lat, float Lon, float AltEllipsoid, uint16_t Month, u
         if (WMM_Geomag(CoordSpherical, CoordGeodetic, GeoMagneticElements) < 0) {
             returned = -9; // error
         } else { // set the returned values
-            B[0] = GeoMagneticElements->X;
-            B[1] = GeoMagneticElements->Y;
-            B[2] = GeoMagneticElements->Z;
+            B[0] = GeoMagneticElements->X * 1e-2f;
+            B[1] = GeoMagneticElements->Y * 1e-2f;
+            B[2] = GeoMagneticElements->Z * 1e-2f;
+
+            magCache.valid = true;
+            magCache.lat   = latCell;
+            magCache.lon   = lonCell;
+            magCache.alt   = altCell;
+            magCache.month = Month;
+            magCache.day   = Day;
+            magCache.year  = Year;
+            magCache.B[0]  = B[0];
+            magCache.B[1]  = B[1];
+            magCache.B[2]  = B[2];
         }
     }
 
@@ -302,10 +344,6 @@ int WMM_GetMagVector(float Lat, float Lon, float AltEllipsoid, uint16_t Month, u
         Ellip = NULL;
     }
 
-    B[0] = GeoMagneticElements->X * 1e-2f;
-    B[1] = GeoMagneticElements->Y * 1e-2f;
-    B[2] = GeoMagneticElements->Z * 1e-2f;
-
     return returned;
 }
 
@@ -37,13 +37,41 @@
         #define PIOS_ALARM_GRACETIME 1000
 #endif // PIOS_ALARM_GRACETIME
 
+// The SystemAlarms object is published from a low priority flight control callback
+#define CALLBACK_PRIORITY    CALLBACK_PRIORITY_LOW
+#define CBTASK_PRIORITY      CALLBACK_TASK_FLIGHTCONTROL
+#define STACK_SIZE_BYTES     512
+
+#define ALARM_SEVERITY_COUNT (SYSTEMALARMS_ALARM_ERROR + 1)
+
+#if SYSTEMALARMS_ALARM_NUMELEM > 32
+#error "The alarm severity masks hold one bit per alarm, at most 32 alarms are supported"
+#endif
+
 // Private types
 
 // Private variables
-static xSemaphoreHandle lock;
+// The alarm states are kept here and published to the SystemAlarms object in one update,
+// from a callback, after they have been changed. The object lags behind the local states,
+// the firmware reads the alarms with AlarmsGet() and only the GCS and the OSD read the object.
+// Alarms are only ever set from tasks, the state is updated without locking: the severity of
+// an alarm is changed with a compare and swap and the severity masks are toggled with atomic
+// xors, which gives the right masks whatever the order concurrent changes are made in.
+static volatile uint8_t severities[SYSTEMALARMS_ALARM_NUMELEM];
+static volatile uint8_t extendedStatus[SYSTEMALARMS_EXTENDEDALARMSTATUS_NUMELEM];
+static volatile uint8_t extendedSubStatus[SYSTEMALARMS_EXTENDEDALARMSTATUS_NUMELEM];
+// Bit n of severityMasks[s] is set when alarm n has severity s, all alarms start uninitialised
+static volatile uint32_t severityMasks[ALARM_SEVERITY_COUNT] = {
+    [SYSTEMALARMS_ALARM_UNINITIALISED] = (uint32_t)((1ULL << SYSTEMALARMS_ALARM_NUMELEM) - 1)
+};
 static volatile uint16_t lastAlarmChange[SYSTEMALARMS_ALARM_NUMELEM] = { 0 }; // this deliberately overflows every 2^16 milliseconds to save memory
+static volatile uint32_t publishPending;
+static DelayedCallbackInfo *publishCallback;
 
 // Private functions
+static int32_t setAlarm(SystemAlarmsAlarmElem alarm, SystemAlarmsAlarmOptions severity, bool extended,
+                        SystemAlarmsExtendedAlarmStatusOptions status, uint8_t subStatus);
+static void publishAlarms(void);
 static int32_t hasSeverity(SystemAlarmsAlarmOptions severity);
 
 /**
@@ -53,7 +81,7 @@ int32_t AlarmsInitialize(void)
 {
     SystemAlarmsInitialize();
 
-    lock = xSemaphoreCreateRecursiveMutex();
+    publishCallback = PIOS_CALLBACKSCHEDULER_Create(&publishAlarms, CALLBACK_PRIORITY, CBTASK_PRIORITY, -1, STACK_SIZE_BYTES);
     // do not change the default states of the alarms, let the init code generated by the uavobjectgenerator handle that
     // AlarmsClearAll();
     // AlarmsDefaultAll();
@@ -68,30 +96,12 @@ int32_t AlarmsInitialize(void)
  */
 int32_t AlarmsSet(SystemAlarmsAlarmElem alarm, SystemAlarmsAlarmOptions severity)
 {
-    SystemAlarmsAlarmData alarms;
-
     // Check that this is a valid alarm
     if (alarm >= SYSTEMALARMS_ALARM_NUMELEM) {
         return -1;
     }
 
-    // Lock
-    xSemaphoreTakeRecursive(lock, portMAX_DELAY);
-
-    // Read alarm and update its severity only if it was changed
-    SystemAlarmsAlarmGet(&alarms);
-    uint16_t flightTime = (uint16_t)xTaskGetTickCount() * (uint16_t)portTICK_RATE_MS; // this deliberately overflows every 2^16 milliseconds to save memory
-    if (((uint16_t)(flightTime - lastAlarmChange[alarm]) > PIOS_ALARM_GRACETIME &&
-         SystemAlarmsAlarmToArray(alarms)[alarm] != severity)
-        || SystemAlarmsAlarmToArray(alarms)[alarm] < severity) {
-        SystemAlarmsAlarmToArray(alarms)[alarm] = severity;
-        lastAlarmChange[alarm] = flightTime;
-        SystemAlarmsAlarmSet(&alarms);
-    }
-
-    // Release lock
-    xSemaphoreGiveRecursive(lock);
-    return 0;
+    return setAlarm(alarm, severity, false, 0, 0);
 }
 
 /**
@@ -107,34 +117,73 @@ int32_t ExtendedAlarmsSet(SystemAlarmsAlarmElem alarm,
                           SystemAlarmsExtendedAlarmStatusOptions status,
                           uint8_t subStatus)
 {
-    SystemAlarmsData alarms;
-
     // Check that this is a valid alarm
     if (alarm >= SYSTEMALARMS_EXTENDEDALARMSTATUS_NUMELEM) {
         return -1;
     }
 
-    // Lock
-    xSemaphoreTakeRecursive(lock, portMAX_DELAY);
+    return setAlarm(alarm, severity, true, status, subStatus);
+}
 
-    // Read alarm and update its severity only if it was changed
-    SystemAlarmsGet(&alarms);
+/**
+ * Update the severity (and extended status) of an alarm and schedule the publication of the
+ * SystemAlarms object if it was changed.
+ */
+static int32_t setAlarm(SystemAlarmsAlarmElem alarm, SystemAlarmsAlarmOptions severity, bool extended,
+                        SystemAlarmsExtendedAlarmStatusOptions status, uint8_t subStatus)
+{
+    if (severity >= ALARM_SEVERITY_COUNT) {
+        return -1;
+    }
+
+    // Update the severity only if it was changed
+    uint8_t current     = severities[alarm];
     uint16_t flightTime = (uint16_t)xTaskGetTickCount() * (uint16_t)portTICK_RATE_MS; // this deliberately overflows every 2^16 milliseconds to save memory
-    if (((uint16_t)(flightTime - lastAlarmChange[alarm]) > PIOS_ALARM_GRACETIME &&
-         SystemAlarmsAlarmToArray(alarms.Alarm)[alarm] != severity)
-        || SystemAlarmsAlarmToArray(alarms.Alarm)[alarm] < severity) {
-        SystemAlarmsExtendedAlarmStatusToArray(alarms.ExtendedAlarmStatus)[alarm] = status;
-        SystemAlarmsExtendedAlarmSubStatusToArray(alarms.ExtendedAlarmSubStatus)[alarm] = subStatus;
-        SystemAlarmsAlarmToArray(alarms.Alarm)[alarm] = severity;
-        lastAlarmChange[alarm] = flightTime;
-        SystemAlarmsSet(&alarms);
+    bool changed = ((uint16_t)(flightTime - lastAlarmChange[alarm]) > PIOS_ALARM_GRACETIME && current != severity)
+                   || current < severity;
+    if (!changed) {
+        return 0;
+    }
+    // Lost a race with another task changing the same alarm, its change stands
+    if (!__sync_bool_compare_and_swap(&severities[alarm], current, (uint8_t)severity)) {
+        return 0;
+    }
+    if (extended) {
+        extendedStatus[alarm]    = status;
+        extendedSubStatus[alarm] = subStatus;
     }
+    lastAlarmChange[alarm] = flightTime;
+    __sync_fetch_and_xor(&severityMasks[current], 1UL << alarm);
+    __sync_fetch_and_xor(&severityMasks[severity], 1UL << alarm);
 
-    // Release lock
-    xSemaphoreGiveRecursive(lock);
+    // All the changes made until the callback runs go in the same update
+    if (__sync_bool_compare_and_swap(&publishPending, 0, 1)) {
+        PIOS_CALLBACKSCHEDULER_Dispatch(publishCallback);
+    }
     return 0;
 }
 
+/**
+ * Publish the alarm states to the SystemAlarms object
+ */
+static void publishAlarms(void)
+{
+    SystemAlarmsData alarms;
+
+    // Changes made from now on schedule a new update
+    __sync_lock_release(&publishPending);
+    __sync_synchronize();
+
+    for (uint32_t n = 0; n < SYSTEMALARMS_ALARM_NUMELEM; ++n) {
+        SystemAlarmsAlarmToArray(alarms.Alarm)[n] = severities[n];
+    }
+    for (uint32_t n = 0; n < SYSTEMALARMS_EXTENDEDALARMSTATUS_NUMELEM; ++n) {
+        SystemAlarmsExtendedAlarmStatusToArray(alarms.ExtendedAlarmStatus)[n]       = extendedStatus[n];
+        SystemAlarmsExtendedAlarmSubStatusToArray(alarms.ExtendedAlarmSubStatus)[n] = extendedSubStatus[n];
+    }
+    SystemAlarmsSet(&alarms);
+}
+
 /**
  * Get an alarm
  * @param alarm The system alarm to be read
@@ -142,16 +191,12 @@ int32_t ExtendedAlarmsSet(SystemAlarmsAlarmElem alarm,
  */
 SystemAlarmsAlarmOptions AlarmsGet(SystemAlarmsAlarmElem alarm)
 {
-    SystemAlarmsAlarmData alarms;
-
     // Check that this is a valid alarm
     if (alarm >= SYSTEMALARMS_ALARM_NUMELEM) {
         return 0;
     }
 
-    // Read alarm
-    SystemAlarmsAlarmGet(&alarms);
-    return SystemAlarmsAlarmToArray(alarms)[alarm];
+    return severities[alarm];
 }
 
 /**
@@ -233,24 +278,13 @@ int32_t AlarmsHasCritical()
  */
 static int32_t hasSeverity(SystemAlarmsAlarmOptions severity)
 {
-    SystemAlarmsAlarmData alarms;
-
-    // Lock
-    xSemaphoreTakeRecursive(lock, portMAX_DELAY);
-
-    // Read alarms
-    SystemAlarmsAlarmGet(&alarms);
-
-    // Go through alarms and check if any are of the given severity or higher
-    for (uint32_t n = 0; n < SYSTEMALARMS_ALARM_NUMELEM; ++n) {
-        if (SystemAlarmsAlarmToArray(alarms)[n] >= severity) {
-            xSemaphoreGiveRecursive(lock);
+    for (uint32_t s = severity; s < ALARM_SEVERITY_COUNT; ++s) {
+        if (severityMasks[s]) {
             return 1;
         }
     }
 
     // If this point is reached then no alarms found
-    xSemaphoreGiveRecursive(lock);
     return 0;
 }
 /**
@@ -259,26 +293,12 @@ static int32_t hasSeverity(SystemAlarmsAlarmOptions severity)
  */
 SystemAlarmsAlarmOptions AlarmsGetHighestSeverity()
 {
-    SystemAlarmsAlarmData alarmsData;
-    SystemAlarmsAlarmOptions highest = SYSTEMALARMS_ALARM_UNINITIALISED;
-
-    // Lock
-    xSemaphoreTakeRecursive(lock, portMAX_DELAY);
-
-    // Read alarms
-    SystemAlarmsAlarmGet(&alarmsData);
-
-    // Go through alarms and find the highest severity
-    uint32_t n = 0;
-    while (n < SYSTEMALARMS_ALARM_NUMELEM && highest != SYSTEMALARMS_ALARM_CRITICAL) {
-        if (SystemAlarmsAlarmToArray(alarmsData)[n] > highest) {
-            highest = SystemAlarmsAlarmToArray(alarmsData)[n];
+    for (int32_t s = ALARM_SEVERITY_COUNT - 1; s > SYSTEMALARMS_ALARM_UNINITIALISED; --s) {
+        if (severityMasks[s]) {
+            return s;
         }
-        n++;
     }
-
-    xSemaphoreGiveRecursive(lock);
-    return highest;
+    return SYSTEMALARMS_ALARM_UNINITIALISED;
 }
 
 /**
@@ -273,6 +273,31 @@ uint16_t fifoBuf_putData(t_fifo_buffer *buf, const void *data, uint16_t len)
     return i; // return number of bytes copied
 }
 
+uint8_t *fifoBuf_getWritePtr(t_fifo_buffer *buf, uint16_t *len)
+{ // return where the next byte goes and how many bytes fit there without wrapping
+    uint16_t wr = buf->wr;
+    uint16_t num_bytes = buf->buf_size - wr;
+    uint16_t free_bytes = fifoBuf_getFree(buf);
+
+    if (num_bytes > free_bytes) {
+        num_bytes = free_bytes;
+    }
+    *len = num_bytes;
+
+    return buf->buf_ptr + wr;
+}
+
+void fifoBuf_commitData(t_fifo_buffer *buf, uint16_t len)
+{ // add bytes written through fifoBuf_getWritePtr() to the buffer
+    uint16_t wr = buf->wr + len;
+
+    if (wr >= buf->buf_size) {
+        wr -= buf->buf_size;
+    }
+
+    buf->wr = wr;
+}
+
 void fifoBuf_init(t_fifo_buffer *buf, const void *buffer, const uint16_t buffer_size)
 {
     buf->buf_ptr  = (uint8_t *)buffer;
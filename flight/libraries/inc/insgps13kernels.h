@@ -0,0 +1,57 @@
+/**
+ ******************************************************************************
+ * @addtogroup AHRS
+ * @{
+ * @addtogroup INSGPS
+ * @{
+ * @brief INSGPS is a joint attitude and position estimation EKF
+ *
+ * @file       insgps13kernels.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @brief      C interface to the unrolled 13 state covariance kernels.
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+
+#ifndef INSGPS13KERNELS_H_
+#define INSGPS13KERNELS_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Drop in replacements of CovariancePrediction() and SerialUpdate() of insgps13state.c
+// (full covariance only), built from insgpskernels.hpp by insgps13kernels.cpp
+void INS13CovariancePrediction(float F[13][13], float G[13][9], float Q[9], float dT, float P[13][13]);
+void INS13SerialUpdate(float H[10][13], float R[10], float Z[10], float Y[10], float P[13][13], float X[13],
+                       uint16_t SensorsUsed);
+
+#ifdef __cplusplus
+}
+#endif
+
+/**
+ * @}
+ * @}
+ */
+
+#endif /* INSGPS13KERNELS_H_ */
@@ -0,0 +1,273 @@
+/**
+ ******************************************************************************
+ * @addtogroup AHRS
+ * @{
+ * @addtogroup INSGPS
+ * @{
+ * @brief INSGPS is a joint attitude and position estimation EKF
+ *
+ * @file       insgpskernels.hpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @brief      Fixed size EKF covariance kernels, unrolled at compile time.
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef INSGPSKERNELS_HPP
+#define INSGPSKERNELS_HPP
+
+#include <stdint.h>
+
+#define INSGPS_KERNEL_INLINE inline __attribute__((always_inline))
+
+namespace insgps {
+/**
+ * Compile time loops.
+ * For<Begin, End>::run<Body>(args) expands to Body<Begin>::run(args); ... Body<End>::run(args);
+ * Sum<Term, Begin, End>::eval(args) expands to Term<Begin>::eval(args) + ... + Term<End>::eval(args).
+ * Both expand to nothing when End < Begin, which is how the empty rows of a sparse matrix vanish.
+ */
+template<int Begin, int End, bool Empty = (End < Begin)>
+struct For {
+    template<template<int> class Body, typename ... Args>
+    static INSGPS_KERNEL_INLINE void run(Args ... args)
+    {
+        Body<Begin>::run(args ...);
+        For<Begin + 1, End>::template run<Body>(args ...);
+    }
+};
+
+template<int Begin, int End>
+struct For<Begin, End, true> {
+    template<template<int> class Body, typename ... Args>
+    static INSGPS_KERNEL_INLINE void run(Args ...) {}
+};
+
+template<template<int> class Term, int Begin, int End, bool Empty = (End < Begin)>
+struct Sum {
+    template<typename ... Args>
+    static INSGPS_KERNEL_INLINE float eval(Args ... args)
+    {
+        return Term<Begin>::eval(args ...) + Sum<Term, Begin + 1, End>::eval(args ...);
+    }
+};
+
+template<template<int> class Term, int Begin, int End>
+struct Sum<Term, Begin, End, true> {
+    template<typename ... Args>
+    static INSGPS_KERNEL_INLINE float eval(Args ...)
+    {
+        return 0.0f;
+    }
+};
+
+constexpr int maxIndex(int a, int b)
+{
+    return a > b ? a : b;
+}
+
+constexpr int minIndex(int a, int b)
+{
+    return a < b ? a : b;
+}
+
+/**
+ * Covariance prediction and serial update of an EKF whose dimensions and
+ * Jacobian sparsity are known at compile time. Model provides:
+ *  - NUMX, NUMW, NUMV: number of states, plant noise inputs and measurements
+ *  - constexpr FrowMin(i)/FrowMax(i), GrowMin(i)/GrowMax(i) and HrowMin(m)/HrowMax(m):
+ *    the first and last possibly non zero column of each row of F, G and H,
+ *    max < min for a row that is all zeros.
+ * Every loop over a sparse row is expanded, only the dense loops of the serial
+ * update are left to the compiler. The arithmetic is the one of the C filters,
+ * so both give the same results to rounding.
+ */
+template<class Model>
+class Kernels {
+public:
+    enum { NUMX = Model::NUMX, NUMW = Model::NUMW, NUMV = Model::NUMV };
+
+    // Pnew = (I+F*T)*P*(I+F*T)' + (T^2)*G*Q*G' = (T^2)[(P/T + F*P)*(I/T + F') + G*Q*G')]
+    static INSGPS_KERNEL_INLINE void covariancePrediction(float F[NUMX][NUMX], float G[NUMX][NUMW],
+                                                          float Q[NUMW], float dT, float P[NUMX][NUMX])
+    {
+        float Dummy[NUMX][NUMX];
+        float dT1  = 1.0f / dT;
+        float dTsq = dT * dT;
+
+        For<0, NUMX - 1>::template run<DummyRow>(Dummy, F, P, dT1);
+        For<0, NUMX - 1>::template run<PRow>(P, Dummy, F, G, Q, dT1, dTsq);
+    }
+
+    // Xnew = X + K*(Z-Y), Pnew=(I-K*H)*P, where K=P*H'*inv[H*P*H'+R], one measurement at a time
+    static INSGPS_KERNEL_INLINE void serialUpdate(float H[NUMV][NUMX], float R[NUMV], float Z[NUMV],
+                                                  float Y[NUMV], float P[NUMX][NUMX], float X[NUMX],
+                                                  uint16_t SensorsUsed)
+    {
+        For<0, NUMV - 1>::template run<Measurement>(H, R, Z, Y, P, X, SensorsUsed);
+    }
+
+private:
+    // The dense part of a measurement update, shared by all the measurements so that
+    // expanding them does not multiply the code size
+    static __attribute__((noinline)) void gainUpdate(float (*P)[NUMX], float *X, const float *HP, float HPHR, float Error)
+    {
+        float Km[NUMX];
+
+        for (int k = 0; k < NUMX; k++) {
+            Km[k] = HP[k] / HPHR; // find K = HP/HPHR
+        }
+        for (int i = 0; i < NUMX; i++) { // Find P(m)= P(m-1) + K*HP
+            for (int j = i; j < NUMX; j++) {
+                P[i][j] = P[j][i] = P[i][j] - Km[i] * HP[j];
+            }
+        }
+        for (int i = 0; i < NUMX; i++) { // Find X(m)= X(m-1) + K*Error
+            X[i] = X[i] + Km[i] * Error;
+        }
+    }
+
+    // Dummy[i][j] = P[i][j]/T + sum_k F[i][k] * P[k][j]
+    template<int I, int J>
+    struct FP {
+        template<int K>
+        struct Term {
+            static INSGPS_KERNEL_INLINE float eval(float (*F)[NUMX], float (*P)[NUMX])
+            {
+                return F[I][K] * P[K][J];
+            }
+        };
+    };
+
+    template<int I>
+    struct DummyRow {
+        template<int J>
+        struct Col {
+            static INSGPS_KERNEL_INLINE void run(float (*Dummy)[NUMX], float (*F)[NUMX], float (*P)[NUMX], float dT1)
+            {
+                Dummy[I][J] = P[I][J] * dT1
+                              + Sum<FP<I, J>::template Term, Model::FrowMin(I), Model::FrowMax(I)>::eval(F, P);
+            }
+        };
+
+        static INSGPS_KERNEL_INLINE void run(float (*Dummy)[NUMX], float (*F)[NUMX], float (*P)[NUMX], float dT1)
+        {
+            For<0, NUMX - 1>::template run<Col>(Dummy, F, P, dT1);
+        }
+    };
+
+    // P[i][j] = (T^2) [Dummy[i][j]/T + sum_k Dummy[i][k] * F[j][k] + sum_k Q[k] * G[i][k] * G[j][k]]
+    template<int I, int J>
+    struct DFt {
+        template<int K>
+        struct Term {
+            static INSGPS_KERNEL_INLINE float eval(float (*Dummy)[NUMX], float (*F)[NUMX])
+            {
+                return Dummy[I][K] * F[J][K];
+            }
+        };
+    };
+
+    template<int I, int J>
+    struct GQGt {
+        template<int K>
+        struct Term {
+            static INSGPS_KERNEL_INLINE float eval(float (*G)[NUMW], float *Q)
+            {
+                return Q[K] * G[I][K] * G[J][K];
+            }
+        };
+    };
+
+    template<int I>
+    struct PRow {
+        template<int J>
+        struct Col {
+            static INSGPS_KERNEL_INLINE void run(float (*P)[NUMX], float (*Dummy)[NUMX], float (*F)[NUMX],
+                                                 float (*G)[NUMW], float *Q, float dT1, float dTsq)
+            {
+                float Ptmp = Dummy[I][J] * dT1
+                             + Sum<DFt<I, J>::template Term, Model::FrowMin(J), Model::FrowMax(J)>::eval(Dummy, F)
+                             + Sum<GQGt<I, J>::template Term,
+                                   maxIndex(Model::GrowMin(I), Model::GrowMin(J)),
+                                   minIndex(Model::GrowMax(I), Model::GrowMax(J))>::eval(G, Q);
+
+                P[I][J] = Ptmp * dTsq;
+                P[J][I] = P[I][J];
+            }
+        };
+
+        // Use symmetry, ie only find upper triangular
+        static INSGPS_KERNEL_INLINE void run(float (*P)[NUMX], float (*Dummy)[NUMX], float (*F)[NUMX],
+                                             float (*G)[NUMW], float *Q, float dT1, float dTsq)
+        {
+            For<I, NUMX - 1>::template run<Col>(P, Dummy, F, G, Q, dT1, dTsq);
+        }
+    };
+
+    // HP[j] = sum_k H[m][k] * P[k][j], HPHR = R[m] + sum_k HP[k] * H[m][k]
+    template<int M>
+    struct HPj {
+        template<int K>
+        struct Term {
+            static INSGPS_KERNEL_INLINE float eval(float (*H)[NUMX], float (*P)[NUMX], int j)
+            {
+                return H[M][K] * P[K][j];
+            }
+        };
+    };
+
+    template<int M>
+    struct HPHt {
+        template<int K>
+        struct Term {
+            static INSGPS_KERNEL_INLINE float eval(float (*H)[NUMX], float *HP)
+            {
+                return HP[K] * H[M][K];
+            }
+        };
+    };
+
+    template<int M>
+    struct Measurement {
+        static INSGPS_KERNEL_INLINE void run(float (*H)[NUMX], float *R, float *Z, float *Y,
+                                             float (*P)[NUMX], float *X, uint16_t SensorsUsed)
+        {
+            if (!(SensorsUsed & (0x01 << M))) {
+                return;
+            }
+
+            float HP[NUMX];
+            for (int j = 0; j < NUMX; j++) {
+                HP[j] = Sum<HPj<M>::template Term, Model::HrowMin(M), Model::HrowMax(M)>::eval(H, P, j);
+            }
+            float HPHR = R[M] + Sum<HPHt<M>::template Term, Model::HrowMin(M), Model::HrowMax(M)>::eval(H, HP);
+
+            gainUpdate(P, X, HP, HPHR, Z[M] - Y[M]);
+        }
+    };
+};
+}
+
+/**
+ * @}
+ * @}
+ */
+
+#endif // INSGPSKERNELS_HPP
@@ -36,4 +36,11 @@ void InstrumentationInit();
  */
 void InstrumentationPublishAllCounters();
 
+/**
+ * Stop tracing and write all recorded trace events to the debug log.
+ * Timestamps are converted to the PIOS_DELAY_GetuS() timebase used by log entries.
+ * \return the number of events written
+ */
+uint32_t InstrumentationDumpTrace();
+
 #endif /* INSTRUMENTATION_H */
@@ -0,0 +1,69 @@
+/**
+ ******************************************************************************
+ * @addtogroup OpenPilotSystem OpenPilot System
+ * @{
+ * @addtogroup OpenPilotLibraries OpenPilot System Libraries
+ * @{
+ * @file       loadgovernor.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @brief      Load shedding level shared by the non-critical consumers
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef LOADGOVERNOR_H
+#define LOADGOVERNOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * Load shedding levels, in the order the consumers are slowed down when the
+ * CPU runs out of headroom. At a given level all the consumers of that level
+ * and of the levels below are shed, they are restored in the reverse order.
+ */
+typedef enum {
+    LOADGOVERNOR_LEVEL_NONE = 0,
+    LOADGOVERNOR_LEVEL_TELEMETRY, // periodic telemetry updates
+    LOADGOVERNOR_LEVEL_LOGGING, // periodic logging
+    LOADGOVERNOR_LEVEL_OSD, // OSD output
+    LOADGOVERNOR_LEVEL_NAVIGATION, // navigation filter corrections (mag, baro, airspeed)
+} LoadGovernorLevel;
+
+#define LOADGOVERNOR_LEVEL_MAX LOADGOVERNOR_LEVEL_NAVIGATION
+
+/**
+ * Set the load shedding level, called by the System module
+ * @param level new level
+ */
+extern void LoadGovernorSetLevel(LoadGovernorLevel level);
+
+/**
+ * Get the load shedding level
+ * @return current level
+ */
+extern LoadGovernorLevel LoadGovernorGetLevel();
+
+/**
+ * Check whether a consumer should run at a reduced rate
+ * @param consumer level of the consumer
+ * @return true when the consumer is shed
+ */
+extern bool LoadGovernorIsShedding(LoadGovernorLevel consumer);
+
+#endif /* LOADGOVERNOR_H */
@@ -48,6 +48,12 @@ typedef struct {
 #define COUNT   1
 #define DATA    5
 
+// Capabilities reported with the device count (byte 2 of Rep_Capabilities)
+#define DFU_CAPABILITY_COMPRESSED 0x01
+// Set in the transfer type of Upload when the data is an LZ4 block stream, the
+// decompressed size is then sent as the second option word
+#define DFU_TRANSFER_COMPRESSED   0x80
+
 /* Exported functions ------------------------------------------------------- */
 void processComand(uint8_t *Receive_Buffer);
 void DataDownload(DownloadAction);
@@ -34,6 +34,29 @@ struct path_status {
     float correction_vector[3];
 };
 
+enum path_geometry_type {
+    PATH_GEOMETRY_ENDPOINT,
+    PATH_GEOMETRY_VECTOR,
+    PATH_GEOMETRY_CIRCLE
+};
+
+// PathDesired reduced to the values that only change with the path itself
+struct path_geometry {
+    enum path_geometry_type type;
+    bool  mode3D;
+    bool  clockwise;
+    float start[3];
+    float end[3]; // end point, or centre for circles
+    float vector[3]; // end - start, horizontal in 2D modes
+    float length; // length of vector, the radius for circles
+    float unit[3]; // vector / length, zero if length is zero
+    float start_angle; // circles: angle of the radius vector, 0..2*pi
+    float starting_velocity;
+    float ending_velocity;
+};
+
+void path_geometry_init(const PathDesiredData *path, struct path_geometry *geometry);
+void path_geometry_progress(const struct path_geometry *geometry, const float *cur_point, struct path_status *status);
 void path_progress(PathDesiredData *path, float *cur_point, struct path_status *status);
 
 #endif
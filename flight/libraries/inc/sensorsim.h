@@ -0,0 +1,123 @@
+/**
+ ******************************************************************************
+ * @addtogroup OpenPilotSystem OpenPilot System
+ * @{
+ * @addtogroup OpenPilotLibraries OpenPilot System Libraries
+ * @{
+ * @file       sensorsim.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @brief      Batch simulation of a multirotor and of its sensors
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef SENSORSIM_H
+#define SENSORSIM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Most samples generated by one SensorSimRun() call
+#define SENSORSIM_MAX_BLOCK         32
+// Gaussian noise values drawn per sample, whatever the sensors due
+#define SENSORSIM_NOISE_PER_SAMPLE  14
+
+// Sensor sample periods
+#define SENSORSIM_BARO_PERIOD_US    50000
+#define SENSORSIM_MAG_PERIOD_US     13333
+#define SENSORSIM_GPS_PERIOD_US     100000
+
+// Bits of sensorsim_block.due, the slower sensors with a new value at a sample
+#define SENSORSIM_DUE_BARO          0x01
+#define SENSORSIM_DUE_MAG           0x02
+#define SENSORSIM_DUE_GPS           0x04
+
+/**
+ * Vehicle and noise processes state. Two states initialized with the same
+ * seed and run with the same inputs generate the same samples, whatever the
+ * block lengths the samples are generated in.
+ */
+struct sensorsim_state {
+    double   pos[3]; // NED, m
+    double   vel[3]; // NED, m/s
+    float    q[4];
+    float    rpy[3]; // low pass filtered rate command, deg/s
+    float    wind[3];
+    float    accel_bias[3];
+    float    gps_drift[3];
+    float    gps_vel_drift[3];
+    float    baro_offset;
+    uint32_t time_us;
+    uint32_t next_baro_us;
+    uint32_t next_mag_us;
+    uint32_t next_gps_us;
+    uint32_t rng;
+};
+
+/**
+ * Commands, held over a block
+ */
+struct sensorsim_input {
+    bool  armed;
+    float throttle; // ActuatorDesired.Throttle
+    float rate[3]; // RateDesired, deg/s
+    float Be[3]; // HomeLocation.Be
+};
+
+/**
+ * Block of samples, one array per axis so the per sample transforms vectorize.
+ * Sample i holds the gyro and accel values, the mag, baro and GPS values are
+ * only new where flagged in due[i].
+ */
+struct sensorsim_block {
+    uint16_t count;
+    uint32_t time_us[SENSORSIM_MAX_BLOCK];
+    uint8_t  due[SENSORSIM_MAX_BLOCK];
+    float    gyro[3][SENSORSIM_MAX_BLOCK]; // deg/s
+    float    accel[3][SENSORSIM_MAX_BLOCK]; // m/s^2
+    float    mag[3][SENSORSIM_MAX_BLOCK];
+    float    baro_altitude[SENSORSIM_MAX_BLOCK]; // m
+    float    gps_pos[3][SENSORSIM_MAX_BLOCK]; // NED from home, m
+    float    gps_vel[3][SENSORSIM_MAX_BLOCK]; // NED, m/s
+    // Simulated truth
+    float    q[4][SENSORSIM_MAX_BLOCK];
+    float    pos[3][SENSORSIM_MAX_BLOCK];
+    float    vel[3][SENSORSIM_MAX_BLOCK];
+    // Scratch
+    float    ned_accel[3][SENSORSIM_MAX_BLOCK];
+    float    noise[SENSORSIM_NOISE_PER_SAMPLE][SENSORSIM_MAX_BLOCK];
+};
+
+/**
+ * Reset the vehicle on the ground, level and heading north
+ * @param state state to reset
+ * @param seed noise generator seed, 0 is replaced by a fixed seed
+ */
+extern void SensorSimInit(struct sensorsim_state *state, uint32_t seed);
+
+/**
+ * Integrate the dynamics over count samples and generate their sensor values
+ * @param state state to advance
+ * @param input commands applied over the whole block
+ * @param count number of samples, at most SENSORSIM_MAX_BLOCK
+ * @param period_us time between two samples
+ * @param block generated samples
+ */
+extern void SensorSimRun(struct sensorsim_state *state, const struct sensorsim_input *input, uint16_t count, uint32_t period_us, struct sensorsim_block *block);
+
+#endif /* SENSORSIM_H */
@@ -0,0 +1,96 @@
+/**
+ ******************************************************************************
+ * @addtogroup AHRS
+ * @{
+ * @addtogroup INSGPS
+ * @{
+ * @brief INSGPS is a joint attitude and position estimation EKF
+ *
+ * @file       insgps13kernels.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @brief      The 13 state covariance kernels, unrolled for its sparsity.
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+
+#include "insgps13kernels.h"
+#include "insgpskernels.hpp"
+
+namespace {
+// Sparsity of F, G and H as LinearizeFG() and LinearizeH() of insgps13state.c fill them,
+// keep both copies in step (the insgps unit test compares the two filters)
+constexpr int8_t FrowMinTable[13] = { 3, 4, 5, 6, 6, 6, 7, 6, 6, 6, 13, 13, 13 };
+constexpr int8_t FrowMaxTable[13] = { 3, 4, 5, 9, 9, 9, 12, 12, 12, 12, -1, -1, -1 };
+
+constexpr int8_t GrowMinTable[13] = { 9, 9, 9, 3, 3, 3, 0, 0, 0, 0, 6, 7, 8 };
+constexpr int8_t GrowMaxTable[13] = { -1, -1, -1, 5, 5, 5, 2, 2, 2, 2, 6, 7, 8 };
+
+constexpr int8_t HrowMinTable[10] = { 0, 1, 2, 3, 4, 5, 6, 6, 6, 2 };
+constexpr int8_t HrowMaxTable[10] = { 0, 1, 2, 3, 4, 5, 9, 9, 9, 2 };
+
+struct INS13Model {
+    enum { NUMX = 13, NUMW = 9, NUMV = 10 };
+
+    static constexpr int FrowMin(int i)
+    {
+        return FrowMinTable[i];
+    }
+    static constexpr int FrowMax(int i)
+    {
+        return FrowMaxTable[i];
+    }
+    static constexpr int GrowMin(int i)
+    {
+        return GrowMinTable[i];
+    }
+    static constexpr int GrowMax(int i)
+    {
+        return GrowMaxTable[i];
+    }
+    static constexpr int HrowMin(int m)
+    {
+        return HrowMinTable[m];
+    }
+    static constexpr int HrowMax(int m)
+    {
+        return HrowMaxTable[m];
+    }
+};
+
+typedef insgps::Kernels<INS13Model> INS13Kernels;
+}
+
+__attribute__((optimize("O3")))
+void INS13CovariancePrediction(float F[13][13], float G[13][9], float Q[9], float dT, float P[13][13])
+{
+    INS13Kernels::covariancePrediction(F, G, Q, dT, P);
+}
+
+__attribute__((optimize("O3")))
+void INS13SerialUpdate(float H[10][13], float R[10], float Z[10], float Y[10], float P[13][13], float X[13],
+                       uint16_t SensorsUsed)
+{
+    INS13Kernels::serialUpdate(H, R, Z, Y, P, X, SensorsUsed);
+}
+
+/**
+ * @}
+ * @}
+ */
@@ -33,19 +33,34 @@
 #include <math.h>
 #include <stdint.h>
 #include <pios_math.h>
+#ifdef INSGPS_TEMPLATE_KERNELS
+#ifdef INSGPS_PACKED_COVARIANCE
+#error INSGPS_TEMPLATE_KERNELS works on the full covariance, it cannot be combined with INSGPS_PACKED_COVARIANCE
+#endif
+#include "insgps13kernels.h"
+#endif
 
 // constants/macros/typdefs
 #define NUMX 13 // number of states, X is the state vector
 #define NUMW 9 // number of plant noise inputs, w is disturbance noise vector
 #define NUMV 10 // number of measurements, v is the measurement noise vector
 #define NUMU 6 // number of deterministic inputs, U is the input vector
+#define NUMP (NUMX * (NUMX + 1) / 2) // size of the packed upper triangle of P
 
 // Private functions
+#ifdef INSGPS_PACKED_COVARIANCE
+void CovariancePrediction(float F[NUMX][NUMX], float G[NUMX][NUMW],
+                          float Q[NUMW], float dT, float P[NUMP]);
+void SerialUpdate(float H[NUMV][NUMX], float R[NUMV], float Z[NUMV],
+                  float Y[NUMV], float P[NUMP], float X[NUMX],
+                  uint16_t SensorsUsed);
+#else
 void CovariancePrediction(float F[NUMX][NUMX], float G[NUMX][NUMW],
                           float Q[NUMW], float dT, float P[NUMX][NUMX]);
 void SerialUpdate(float H[NUMV][NUMX], float R[NUMV], float Z[NUMV],
                   float Y[NUMV], float P[NUMX][NUMX], float X[NUMX],
                   uint16_t SensorsUsed);
+#endif
 void RungeKutta(float X[NUMX], float U[NUMU], float dT);
 void StateEq(float X[NUMX], float U[NUMU], float Xdot[NUMX]);
 void LinearizeFG(float X[NUMX], float U[NUMU], float F[NUMX][NUMX],
@@ -84,6 +99,23 @@ static const int8_t GrowMax[NUMX] = { -1, -1, -1, 5, 5, 5, 2, 2, 2, 2, 6, 7, 8 }
 static const int8_t HrowMin[NUMV] = { 0, 1, 2, 3, 4, 5, 6, 6, 6, 2 };
 static const int8_t HrowMax[NUMV] = { 0, 1, 2, 3, 4, 5, 9, 9, 9, 2 };
 
+#ifdef INSGPS_PACKED_COVARIANCE
+// P is symmetric, only its upper triangle is stored, row by row.
+// element (i,j) with i <= j lives at ProwStart[i] + j
+static const uint8_t ProwStart[NUMX] = { 0, 12, 23, 33, 42, 50, 57, 63, 68, 72, 75, 77, 78 };
+#define PELEM(i, j) ekf.P[((i) <= (j)) ? ProwStart[i] + (j) : ProwStart[j] + (i)]
+#else
+#define PELEM(i, j) ekf.P[i][j]
+#endif
+
+// The filter state is used at the sensor rate, keep it in the CCM RAM of the F4
+// (not zeroed at startup, INSGPSInit() initializes all of it)
+#if defined(PIOS_TARGET_PROVIDES_FAST_HEAP)
+#define EKF_FAST_RAM __attribute__((section(".fast")))
+#else
+#define EKF_FAST_RAM
+#endif
+
 static struct EKFData {
     // linearized system matrices
     float F[NUMX][NUMX];
@@ -92,12 +124,16 @@ static struct EKFData {
     // local magnetic unit vector in NED frame
     float Be[3];
     // covariance matrix and state vector
+#ifdef INSGPS_PACKED_COVARIANCE
+    float P[NUMP];
+#else
     float P[NUMX][NUMX];
+#endif
     float X[NUMX];
     // input noise and measurement noise variances
     float Q[NUMW];
     float R[NUMV];
-} ekf;
+} ekf EKF_FAST_RAM;
 
 // Global variables
 struct NavStruct Nav;
@@ -118,7 +154,7 @@ void INSGPSInit() // pretty much just a place holder for now
 
     for (int i = 0; i < NUMX; i++) {
         for (int j = 0; j < NUMX; j++) {
-            ekf.P[i][j] = 0.0f; // zero all terms
+            PELEM(i, j) = 0.0f; // zero all terms
             ekf.F[i][j] = 0.0f;
         }
 
@@ -140,10 +176,10 @@ void INSGPSInit() // pretty much just a place holder for now
     }
 
 
-    ekf.P[0][0]   = ekf.P[1][1] = ekf.P[2][2] = 25.0f;            // initial position variance (m^2)
-    ekf.P[3][3]   = ekf.P[4][4] = ekf.P[5][5] = 5.0f;             // initial velocity variance (m/s)^2
-    ekf.P[6][6]   = ekf.P[7][7] = ekf.P[8][8] = ekf.P[9][9] = 1e-5f;  // initial quaternion variance
-    ekf.P[10][10] = ekf.P[11][11] = ekf.P[12][12] = 1e-9f; // initial gyro bias variance (rad/s)^2
+    PELEM(0, 0)   = PELEM(1, 1) = PELEM(2, 2) = 25.0f;            // initial position variance (m^2)
+    PELEM(3, 3)   = PELEM(4, 4) = PELEM(5, 5) = 5.0f;             // initial velocity variance (m/s)^2
+    PELEM(6, 6)   = PELEM(7, 7) = PELEM(8, 8) = PELEM(9, 9) = 1e-5f;  // initial quaternion variance
+    PELEM(10, 10) = PELEM(11, 11) = PELEM(12, 12) = 1e-9f; // initial gyro bias variance (rad/s)^2
 
     ekf.X[0]  = ekf.X[1] = ekf.X[2] = ekf.X[3] = ekf.X[4] = ekf.X[5] = 0.0f; // initial pos and vel (m)
     ekf.X[6]  = 1.0f;
@@ -170,9 +206,9 @@ void INSResetP(float PDiag[NUMX])
     for (i = 0; i < NUMX; i++) {
         if (PDiag != 0) {
             for (j = 0; j < NUMX; j++) {
-                ekf.P[i][j] = ekf.P[j][i] = 0.0f;
+                PELEM(i, j) = PELEM(j, i) = 0.0f;
             }
-            ekf.P[i][i] = PDiag[i];
+            PELEM(i, i) = PDiag[i];
         }
     }
 }
@@ -184,7 +220,7 @@ void INSGetP(float PDiag[NUMX])
     // retrieve diagonal elements (aka state variance)
     for (i = 0; i < NUMX; i++) {
         if (PDiag != 0) {
-            PDiag[i] = ekf.P[i][i];
+            PDiag[i] = PELEM(i, i);
         }
     }
 }
@@ -211,13 +247,13 @@ void INSPosVelReset(float pos[3], float vel[3])
 {
     for (int i = 0; i < 6; i++) {
         for (int j = i; j < NUMX; j++) {
-            ekf.P[i][j] = 0; // zero the first 6 rows and columns
-            ekf.P[j][i] = 0;
+            PELEM(i, j) = 0; // zero the first 6 rows and columns
+            PELEM(j, i) = 0;
         }
     }
 
-    ekf.P[0][0] = ekf.P[1][1] = ekf.P[2][2] = 25; // initial position variance (m^2)
-    ekf.P[3][3] = ekf.P[4][4] = ekf.P[5][5] = 5; // initial velocity variance (m/s)^2
+    PELEM(0, 0) = PELEM(1, 1) = PELEM(2, 2) = 25; // initial position variance (m^2)
+    PELEM(3, 3) = PELEM(4, 4) = PELEM(5, 5) = 5; // initial velocity variance (m/s)^2
 
     ekf.X[0]    = pos[0];
     ekf.X[1]    = pos[1];
@@ -432,8 +468,98 @@ void INSCorrection(float mag_data[3], float Pos[3], float Vel[3],
 // dimensions equal to the number of disturbance noise variables
 // The General Method is very inefficient,not taking advantage of the sparse F and G
 // The first Method is very specific to this implementation
+// The packed variant stores only the upper triangle of P and hardcodes the
+// block structure of F and G produced by LinearizeFG()
 // ************************************************
 
+#ifdef INSGPS_PACKED_COVARIANCE
+__attribute__((optimize("O3")))
+void CovariancePrediction(float F[NUMX][NUMX], float G[NUMX][NUMW],
+                          float Q[NUMW], float dT, float P[NUMP])
+{
+    // Pnew = (I+F*T)*P*(I+F*T)' + (T^2)*G*Q*G' = A + T*A*F' + (T^2)*G*Q*G', with A = (I+F*T)*P
+
+    float dTsq = dT * dT;
+
+    float Pf[NUMX][NUMX]; // unpacked P
+    float A[NUMX][NUMX];
+    int8_t i, j, k;
+
+    for (i = 0; i < NUMX; i++) {
+        const float *Pirow = &P[ProwStart[i]];
+        for (j = i; j < NUMX; j++) {
+            Pf[i][j] = Pf[j][i] = Pirow[j];
+        }
+    }
+
+    for (j = 0; j < NUMX; j++) { // Calculate A = P + T*F*P
+        for (i = 0; i < 3; i++) { // dPdot/dV = I
+            A[i][j] = Pf[i][j] + dT * Pf[i + 3][j];
+        }
+        for (i = 3; i < 6; i++) { // dVdot/dq
+            A[i][j] = Pf[i][j] + dT * (F[i][6] * Pf[6][j] + F[i][7] * Pf[7][j] + F[i][8] * Pf[8][j] + F[i][9] * Pf[9][j]);
+        }
+        for (i = 6; i < 10; i++) { // dqdot/dq has a zero diagonal, dqdot/dwbias
+            float Atmp = F[i][10] * Pf[10][j] + F[i][11] * Pf[11][j] + F[i][12] * Pf[12][j];
+            for (k = 6; k < 10; k++) {
+                if (k != i) {
+                    Atmp += F[i][k] * Pf[k][j];
+                }
+            }
+            A[i][j] = Pf[i][j] + dT * Atmp;
+        }
+        for (i = 10; i < NUMX; i++) { // gyro bias is a random walk
+            A[i][j] = Pf[i][j];
+        }
+    }
+
+    for (i = 0; i < NUMX; i++) { // Calculate Pnew = A + T*A*F', only the upper triangle
+        const float *Airow = A[i];
+        float *Pirow = &P[ProwStart[i]];
+        for (j = i; j < 3; j++) {
+            Pirow[j] = Airow[j] + dT * Airow[j + 3];
+        }
+        for (j = MAX(i, 3); j < 6; j++) {
+            Pirow[j] = Airow[j] + dT * (F[j][6] * Airow[6] + F[j][7] * Airow[7] + F[j][8] * Airow[8] + F[j][9] * Airow[9]);
+        }
+        for (j = MAX(i, 6); j < 10; j++) {
+            float Ptmp = F[j][10] * Airow[10] + F[j][11] * Airow[11] + F[j][12] * Airow[12];
+            for (k = 6; k < 10; k++) {
+                if (k != j) {
+                    Ptmp += F[j][k] * Airow[k];
+                }
+            }
+            Pirow[j] = Airow[j] + dT * Ptmp;
+        }
+        for (j = MAX(i, 10); j < NUMX; j++) {
+            Pirow[j] = Airow[j];
+        }
+    }
+
+    // G*Q*G' only has the velocity, quaternion and gyro bias diagonal blocks
+    for (i = 3; i < 6; i++) {
+        float *Pirow = &P[ProwStart[i]];
+        for (j = i; j < 6; j++) {
+            Pirow[j] += dTsq * (Q[3] * G[i][3] * G[j][3] + Q[4] * G[i][4] * G[j][4] + Q[5] * G[i][5] * G[j][5]);
+        }
+    }
+    for (i = 6; i < 10; i++) {
+        float *Pirow = &P[ProwStart[i]];
+        for (j = i; j < 10; j++) {
+            Pirow[j] += dTsq * (Q[0] * G[i][0] * G[j][0] + Q[1] * G[i][1] * G[j][1] + Q[2] * G[i][2] * G[j][2]);
+        }
+    }
+    for (i = 10; i < NUMX; i++) {
+        P[ProwStart[i] + i] += dTsq * Q[i - 4];
+    }
+}
+#elif defined(INSGPS_TEMPLATE_KERNELS)
+void CovariancePrediction(float F[NUMX][NUMX], float G[NUMX][NUMW],
+                          float Q[NUMW], float dT, float P[NUMX][NUMX])
+{
+    INS13CovariancePrediction(F, G, Q, dT, P);
+}
+#else /* INSGPS_PACKED_COVARIANCE */
 __attribute__((optimize("O3")))
 void CovariancePrediction(float F[NUMX][NUMX], float G[NUMX][NUMW],
                           float Q[NUMW], float dT, float P[NUMX][NUMX])
@@ -495,6 +621,7 @@ void CovariancePrediction(float F[NUMX][NUMX], float G[NUMX][NUMW],
         }
     }
 }
+#endif /* INSGPS_PACKED_COVARIANCE */
 
 // *************  SerialUpdate *******************
 // Does the update step of the Kalman filter for the covariance and estimate
@@ -512,6 +639,61 @@ void CovariancePrediction(float F[NUMX][NUMX], float G[NUMX][NUMW],
 // should be used in the update.
 // ************************************************
 
+#ifdef INSGPS_PACKED_COVARIANCE
+void SerialUpdate(float H[NUMV][NUMX], float R[NUMV], float Z[NUMV],
+                  float Y[NUMV], float P[NUMP], float X[NUMX],
+                  uint16_t SensorsUsed)
+{
+    float HP[NUMX], HPHR, Error;
+    uint8_t i, j, k, m;
+    float Km[NUMX];
+
+    for (m = 0; m < NUMV; m++) {
+        if (SensorsUsed & (0x01 << m)) { // use this sensor for update
+            for (j = 0; j < NUMX; j++) {
+                HP[j] = 0;
+            }
+            for (k = HrowMin[m]; k <= HrowMax[m]; k++) { // Find Hp = H*P, walking row k of P
+                const float Hmk = H[m][k];
+                const float *Pkrow = &P[ProwStart[k]];
+                for (j = 0; j < k; j++) {
+                    HP[j] += Hmk * P[ProwStart[j] + k];
+                }
+                for (j = k; j < NUMX; j++) {
+                    HP[j] += Hmk * Pkrow[j];
+                }
+            }
+            HPHR = R[m]; // Find  HPHR = H*P*H' + R
+            for (k = HrowMin[m]; k <= HrowMax[m]; k++) {
+                HPHR += HP[k] * H[m][k];
+            }
+
+            float invHPHR = 1.0f / HPHR;
+            for (k = 0; k < NUMX; k++) {
+                Km[k] = HP[k] * invHPHR; // find K = HP/HPHR
+            }
+            for (i = 0; i < NUMX; i++) { // Find P(m)= P(m-1) + K*HP
+                float *Pirow = &P[ProwStart[i]];
+                for (j = i; j < NUMX; j++) {
+                    Pirow[j] -= Km[i] * HP[j];
+                }
+            }
+
+            Error = Z[m] - Y[m];
+            for (i = 0; i < NUMX; i++) { // Find X(m)= X(m-1) + K*Error
+                X[i] = X[i] + Km[i] * Error;
+            }
+        }
+    }
+}
+#elif defined(INSGPS_TEMPLATE_KERNELS)
+void SerialUpdate(float H[NUMV][NUMX], float R[NUMV], float Z[NUMV],
+                  float Y[NUMV], float P[NUMX][NUMX], float X[NUMX],
+                  uint16_t SensorsUsed)
+{
+    INS13SerialUpdate(H, R, Z, Y, P, X, SensorsUsed);
+}
+#else /* INSGPS_PACKED_COVARIANCE */
 void SerialUpdate(float H[NUMV][NUMX], float R[NUMV], float Z[NUMV],
                   float Y[NUMV], float P[NUMX][NUMX], float X[NUMX],
                   uint16_t SensorsUsed)
@@ -550,6 +732,7 @@ void SerialUpdate(float H[NUMV][NUMX], float R[NUMV], float Z[NUMV],
         }
     }
 }
+#endif /* INSGPS_PACKED_COVARIANCE */
 
 // *************  RungeKutta **********************
 // Does a 4th order Runge Kutta numerical integration step
@@ -27,10 +27,14 @@
 #include <openpilot.h>
 #include <instrumentation.h>
 #include <pios_instrumentation.h>
+#include <debuglogentry.h>
 
 static uint8_t publishedCountersInstances = 0;
 static void counterCallback(const pios_perf_counter_t *counter, const int8_t index, void *context);
 static xSemaphoreHandle sem;
+
+// number of trace events packed into a single debug log entry
+#define TRACE_EVENTS_PER_ENTRY (sizeof(((DebugLogEntryData *)0)->Data) / sizeof(pios_trace_event_t))
 void InstrumentationInit()
 {
     PerfCounterInitialize();
@@ -60,3 +64,33 @@ void counterCallback(const pios_perf_counter_t *counter, const int8_t index, __a
     data.Counter.Value = counter->value;
     PerfCounterInstSet(index, &data);
 }
+
+uint32_t InstrumentationDumpTrace()
+{
+    uint32_t dumped = 0;
+    uint16_t count;
+
+    PIOS_Instrumentation_EnableTrace(false);
+
+    // dumps are rare and usually run from the event dispatcher, keep the block off its stack
+    pios_trace_event_t *events = pios_malloc(sizeof(pios_trace_event_t) * TRACE_EVENTS_PER_ENTRY);
+    if (!events) {
+        return 0;
+    }
+
+    // take a single reference point so every event maps to the same timebase
+    uint32_t nowRaw = PIOS_DELAY_GetRaw();
+    uint32_t nowUs  = PIOS_DELAY_GetuS();
+
+    while ((count = PIOS_Instrumentation_ReadTrace(events, TRACE_EVENTS_PER_ENTRY)) > 0) {
+        for (uint16_t i = 0; i < count; i++) {
+            events[i].timestamp = nowUs - PIOS_DELAY_DiffuS2(events[i].timestamp, nowRaw);
+        }
+        if (!PIOS_DEBUGLOG_Trace(count * sizeof(pios_trace_event_t), (uint8_t *)events)) {
+            break;
+        }
+        dumped += count;
+    }
+    pios_free(events);
+    return dumped;
+}
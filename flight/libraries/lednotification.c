@@ -235,7 +235,6 @@ static void run_led(NotifierLedStatus_t *status)
     for (uint8_t i = status->led_set_start; i <= status->led_set_end; i++) {
         PIOS_WS2811_setColorRGB(color, i, false);
     }
-    PIOS_WS2811_Update();
     advance_sequence(status);
 }
 
@@ -256,4 +255,6 @@ void LedNotificationExtLedsRun()
     for (uint8_t i = 0; i < MAX_HANDLED_LED; i++) {
         run_led(&led_status[i]);
     }
+    // the driver only sends the frame when a color changed, or a change missed a busy transfer
+    PIOS_WS2811_Update();
 }
@@ -1,12 +1,13 @@
 /**
  ******************************************************************************
- *
- * @file       trailitem.cpp
- * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2012.
- * @brief      A graphicsItem representing a trail point
- * @see        The GNU Public License (GPL) Version 3
- * @defgroup   OPMapWidget
+ * @addtogroup OpenPilot System OpenPilot System
+ * @{
+ * @addtogroup OpenPilot Libraries OpenPilot System Libraries
  * @{
+ * @file       loadgovernor.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @brief      Load shedding level shared by the non-critical consumers
+ * @see        The GNU Public License (GPL) Version 3
  *
  *****************************************************************************/
 /*
@@ -24,25 +25,26 @@
  * with this program; if not, write to the Free Software Foundation, Inc.,
  * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
  */
-#include "traillineitem.h"
 
-namespace mapcontrol {
-TrailLineItem::TrailLineItem(internals::PointLatLng const & coord1, internals::PointLatLng const & coord2, QBrush color, MapGraphicItem *map) : QGraphicsLineItem(map), coord1(coord1), coord2(coord2), m_brush(color), m_map(map)
-{
-    QPen pen;
+#include <openpilot.h>
 
-    pen.setBrush(m_brush);
-    pen.setWidth(1);
-    this->setPen(pen);
-}
+// Private includes
+#include "inc/loadgovernor.h"
+
+// Private variables
+static volatile uint8_t level;
 
-int TrailLineItem::type() const
+void LoadGovernorSetLevel(LoadGovernorLevel newLevel)
 {
-    return Type;
+    level = (newLevel > LOADGOVERNOR_LEVEL_MAX) ? LOADGOVERNOR_LEVEL_MAX : newLevel;
 }
 
-void TrailLineItem::setLineSlot()
+LoadGovernorLevel LoadGovernorGetLevel()
 {
-    setLine(m_map->FromLatLngToLocal(this->coord1).X(), m_map->FromLatLngToLocal(this->coord1).Y(), m_map->FromLatLngToLocal(this->coord2).X(), m_map->FromLatLngToLocal(this->coord2).Y());
+    return (LoadGovernorLevel)level;
 }
+
+bool LoadGovernorIsShedding(LoadGovernorLevel consumer)
+{
+    return consumer != LOADGOVERNOR_LEVEL_NONE && level >= consumer;
 }
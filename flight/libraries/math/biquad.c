@@ -0,0 +1,191 @@
+/**
+ ******************************************************************************
+ * @addtogroup OpenPilot Math Utilities
+ * @{
+ * @addtogroup Biquad filter bank
+ * @{
+ *
+ * @file       biquad.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @brief      Cascaded biquad filters applied to several channels at once
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include <math.h>
+#include <string.h>
+#include <pios_math.h>
+#include "biquad.h"
+
+/**
+ * Initialization function for a first order low pass y[n] = alpha * y[n-1] + (1 - alpha) * x[n]
+ * expressed as a biquad stage, so it can be cascaded with the others.
+ * @param[in]  alpha Smoothing factor
+ * @param[out] coeffsPtr Pointer to filter coefficients
+ * @returns Nothing
+ */
+void InitBiquadFirstOrderLowPass(const float alpha, struct BiquadCoeffs *coeffsPtr)
+{
+    coeffsPtr->b0 = 1.0f - alpha;
+    coeffsPtr->b1 = 0.0f;
+    coeffsPtr->b2 = 0.0f;
+    coeffsPtr->a1 = -alpha;
+    coeffsPtr->a2 = 0.0f;
+}
+
+
+/**
+ * Initialization function for a second order low pass, see the Audio EQ Cookbook by R. Bristow-Johnson.
+ * @param[in]  ff Cut-off frequency ratio
+ * @param[in]  q Quality factor, 1/sqrt(2) gives a Butterworth response
+ * @param[out] coeffsPtr Pointer to filter coefficients
+ * @returns Nothing
+ */
+void InitBiquadLowPass(const float ff, const float q, struct BiquadCoeffs *coeffsPtr)
+{
+    const float w0    = 2.0f * M_PI_F * ff;
+    const float cosw0 = cosf(w0);
+    const float alpha = sinf(w0) / (2.0f * q);
+    const float a0    = 1.0f + alpha;
+
+    coeffsPtr->b0 = (1.0f - cosw0) * 0.5f / a0;
+    coeffsPtr->b1 = (1.0f - cosw0) / a0;
+    coeffsPtr->b2 = coeffsPtr->b0;
+    coeffsPtr->a1 = -2.0f * cosw0 / a0;
+    coeffsPtr->a2 = (1.0f - alpha) / a0;
+}
+
+
+/**
+ * Initialization function for a notch filter, see the Audio EQ Cookbook by R. Bristow-Johnson.
+ * @param[in]  ff Center frequency ratio
+ * @param[in]  q Quality factor, center frequency divided by the -3dB bandwidth
+ * @param[out] coeffsPtr Pointer to filter coefficients
+ * @returns Nothing
+ */
+void InitBiquadNotch(const float ff, const float q, struct BiquadCoeffs *coeffsPtr)
+{
+    const float w0    = 2.0f * M_PI_F * ff;
+    const float cosw0 = cosf(w0);
+    const float alpha = sinf(w0) / (2.0f * q);
+    const float a0    = 1.0f + alpha;
+
+    coeffsPtr->b0 = 1.0f / a0;
+    coeffsPtr->b1 = -2.0f * cosw0 / a0;
+    coeffsPtr->b2 = coeffsPtr->b0;
+    coeffsPtr->a1 = coeffsPtr->b1;
+    coeffsPtr->a2 = (1.0f - alpha) / a0;
+}
+
+
+/**
+ * Initialization function for an empty filter bank, which passes its input through.
+ * @param[out] bankPtr Pointer to filter bank
+ * @returns Nothing
+ */
+void InitBiquadBank(struct BiquadBank *bankPtr)
+{
+    memset(bankPtr, 0, sizeof(*bankPtr));
+}
+
+
+/**
+ * Append a stage to the cascade.
+ * @param[in]  bankPtr Pointer to filter bank
+ * @param[in]  coeffsPtr Pointer to the coefficients of the new stage
+ * @returns false if the bank is full
+ */
+bool AddBiquadBankStage(struct BiquadBank *bankPtr, const struct BiquadCoeffs *coeffsPtr)
+{
+    if (bankPtr->stages >= BIQUAD_MAX_STAGES) {
+        return false;
+    }
+    bankPtr->coeffs[bankPtr->stages++] = *coeffsPtr;
+    return true;
+}
+
+
+/**
+ * Initialization function for the intermediate values of all stages,
+ * such that a constant input x0 produces a constant output without transient.
+ * @param[in]  bankPtr Pointer to filter bank
+ * @param[in]  x0 Prescribed value for each channel
+ * @returns Nothing
+ */
+void ResetBiquadBank(struct BiquadBank *bankPtr, const float x0[BIQUAD_CHANNELS])
+{
+    float x[BIQUAD_CHANNELS];
+
+    memcpy(x, x0, sizeof(x));
+    for (uint8_t stage = 0; stage < bankPtr->stages; stage++) {
+        const struct BiquadCoeffs *c = &bankPtr->coeffs[stage];
+        const float gain = (c->b0 + c->b1 + c->b2) / (1.0f + c->a1 + c->a2);
+
+        for (uint8_t t = 0; t < BIQUAD_CHANNELS; t++) {
+            const float y = gain * x[t];
+            bankPtr->s2[stage][t] = c->b2 * x[t] - c->a2 * y;
+            bankPtr->s1[stage][t] = c->b1 * x[t] - c->a1 * y + bankPtr->s2[stage][t];
+            x[t] = y;
+        }
+    }
+    memcpy(bankPtr->last, x, sizeof(x));
+}
+
+
+/**
+ * Filter one sample of every channel through all stages of the bank.
+ * The channels are independent, so the FPU pipeline is kept busy with
+ * three interleaved dependency chains instead of waiting on one.
+ * @param[in]  bankPtr Pointer to filter bank
+ * @param[in]  xn New raw values
+ * @param[out] yn Filtered values, may be the same array as xn
+ * @returns Nothing
+ */
+void FilterBiquadBank(struct BiquadBank *bankPtr, const float xn[BIQUAD_CHANNELS], float yn[BIQUAD_CHANNELS])
+{
+    float x0 = xn[0];
+    float x1 = xn[1];
+    float x2 = xn[2];
+
+    for (uint8_t stage = 0; stage < bankPtr->stages; stage++) {
+        const struct BiquadCoeffs *c = &bankPtr->coeffs[stage];
+        float *s1 = bankPtr->s1[stage];
+        float *s2 = bankPtr->s2[stage];
+
+        const float y0 = c->b0 * x0 + s1[0];
+        const float y1 = c->b0 * x1 + s1[1];
+        const float y2 = c->b0 * x2 + s1[2];
+
+        s1[0] = c->b1 * x0 - c->a1 * y0 + s2[0];
+        s1[1] = c->b1 * x1 - c->a1 * y1 + s2[1];
+        s1[2] = c->b1 * x2 - c->a1 * y2 + s2[2];
+
+        s2[0] = c->b2 * x0 - c->a2 * y0;
+        s2[1] = c->b2 * x1 - c->a2 * y1;
+        s2[2] = c->b2 * x2 - c->a2 * y2;
+
+        x0    = y0;
+        x1    = y1;
+        x2    = y2;
+    }
+
+    yn[0] = bankPtr->last[0] = x0;
+    yn[1] = bankPtr->last[1] = x1;
+    yn[2] = bankPtr->last[2] = x2;
+}
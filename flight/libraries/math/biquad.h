@@ -0,0 +1,68 @@
+/**
+ ******************************************************************************
+ * @addtogroup OpenPilot Math Utilities
+ * @{
+ * @addtogroup Biquad filter bank
+ * @{
+ *
+ * @file       biquad.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @brief      Cascaded biquad filters applied to several channels at once
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef BIQUAD_H
+#define BIQUAD_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define BIQUAD_CHANNELS   3
+#define BIQUAD_MAX_STAGES 4
+
+// Coefficients of one biquadratic stage, normalised to a0 = 1
+struct BiquadCoeffs {
+    float b0;
+    float b1;
+    float b2;
+    float a1;
+    float a2;
+};
+
+// Cascade of biquad stages in transposed direct form two, the state of all
+// channels of a stage is kept next to each other so they are filtered in one pass
+struct BiquadBank {
+    uint8_t stages;
+    struct BiquadCoeffs coeffs[BIQUAD_MAX_STAGES];
+    float   s1[BIQUAD_MAX_STAGES][BIQUAD_CHANNELS];
+    float   s2[BIQUAD_MAX_STAGES][BIQUAD_CHANNELS];
+    float   last[BIQUAD_CHANNELS];
+};
+
+// Function declarations
+void InitBiquadFirstOrderLowPass(const float alpha, struct BiquadCoeffs *coeffsPtr);
+void InitBiquadLowPass(const float ff, const float q, struct BiquadCoeffs *coeffsPtr);
+void InitBiquadNotch(const float ff, const float q, struct BiquadCoeffs *coeffsPtr);
+void InitBiquadBank(struct BiquadBank *bankPtr);
+bool AddBiquadBankStage(struct BiquadBank *bankPtr, const struct BiquadCoeffs *coeffsPtr);
+void ResetBiquadBank(struct BiquadBank *bankPtr, const float x0[BIQUAD_CHANNELS]);
+void FilterBiquadBank(struct BiquadBank *bankPtr, const float xn[BIQUAD_CHANNELS], float yn[BIQUAD_CHANNELS]);
+
+#endif
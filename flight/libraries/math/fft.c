@@ -0,0 +1,132 @@
+/**
+ ******************************************************************************
+ * @addtogroup OpenPilot Math Utilities
+ * @{
+ * @addtogroup Fixed point FFT
+ * @{
+ *
+ * @file       fft.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @brief      Small radix-2 fixed point FFT for spectrum analysis
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include <math.h>
+#include <pios_math.h>
+#include "fft.h"
+
+/**
+ * Initialization function for the twiddle factor and window tables of one transform size.
+ * @param[in]  log2n Base two logarithm of the transform size
+ * @param[out] fftPtr Pointer to the tables
+ * @returns 0 on success, -1 if the size is not supported
+ */
+int32_t InitFFTq15(const uint8_t log2n, struct FFTq15 *fftPtr)
+{
+    if (log2n < 2 || log2n > FFT_LOG2_MAX) {
+        return -1;
+    }
+
+    const uint16_t n = 1 << log2n;
+    fftPtr->log2n = log2n;
+    fftPtr->n     = n;
+
+    for (uint16_t k = 0; k < n; k++) {
+        fftPtr->sinTable[k] = (int16_t)lrintf(32767.0f * sinf(2.0f * M_PI_F * k / n));
+        fftPtr->window[k]   = (int16_t)lrintf(32767.0f * 0.5f * (1.0f - cosf(2.0f * M_PI_F * k / n)));
+    }
+    return 0;
+}
+
+
+/**
+ * Apply the Hann window to a block of samples.
+ * @param[in]  fftPtr Pointer to the tables
+ * @param[in,out] re Samples, fftPtr->n values
+ * @returns Nothing
+ */
+void WindowFFTq15(const struct FFTq15 *fftPtr, int16_t *re)
+{
+    for (uint16_t k = 0; k < fftPtr->n; k++) {
+        re[k] = (int16_t)(((int32_t)re[k] * fftPtr->window[k]) >> 15);
+    }
+}
+
+
+/**
+ * In place complex radix-2 decimation in time FFT.
+ * Every butterfly stage halves its result, so the output is the transform scaled
+ * by 1/n and cannot overflow as long as the input magnitude stays below 1.0 in Q15.
+ * @param[in]  fftPtr Pointer to the tables
+ * @param[in,out] re Real parts, fftPtr->n values
+ * @param[in,out] im Imaginary parts, fftPtr->n values
+ * @returns Nothing
+ */
+void FFTq15(const struct FFTq15 *fftPtr, int16_t *re, int16_t *im)
+{
+    const uint16_t n = fftPtr->n;
+
+    // bit reversal permutation
+    for (uint16_t i = 1, j = 0; i < n; i++) {
+        uint16_t bit = n >> 1;
+        for (; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j) {
+            int16_t t = re[i];
+            re[i] = re[j];
+            re[j] = t;
+            t     = im[i];
+            im[i] = im[j];
+            im[j] = t;
+        }
+    }
+
+    for (uint16_t len = 2, step = n >> 1; len <= n; len <<= 1, step >>= 1) {
+        const uint16_t half = len >> 1;
+        for (uint16_t k = 0; k < half; k++) {
+            // w = exp(-2*pi*i*k/len) = cos - i*sin
+            const int32_t wr = fftPtr->sinTable[(k * step + (n >> 2)) & (n - 1)];
+            const int32_t wi = -fftPtr->sinTable[k * step];
+            for (uint16_t i = k; i < n; i += len) {
+                const uint16_t j = i + half;
+                const int32_t tr = (wr * re[j] - wi * im[j] + (1 << 14)) >> 15;
+                const int32_t ti = (wr * im[j] + wi * re[j] + (1 << 14)) >> 15;
+                re[j] = (int16_t)((re[i] - tr + 1) >> 1);
+                im[j] = (int16_t)((im[i] - ti + 1) >> 1);
+                re[i] = (int16_t)((re[i] + tr + 1) >> 1);
+                im[i] = (int16_t)((im[i] + ti + 1) >> 1);
+            }
+        }
+    }
+}
+
+
+/**
+ * Squared magnitude of one bin.
+ * @param[in]  re Real part
+ * @param[in]  im Imaginary part
+ * @returns re^2 + im^2
+ */
+uint32_t MagnitudeSquaredFFTq15(const int16_t re, const int16_t im)
+{
+    return (uint32_t)((int32_t)re * re) + (uint32_t)((int32_t)im * im);
+}
@@ -1,12 +1,15 @@
 /**
  ******************************************************************************
+ * @addtogroup OpenPilot Math Utilities
+ * @{
+ * @addtogroup Fixed point FFT
+ * @{
+ *
+ * @file       fft.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @brief      Small radix-2 fixed point FFT for spectrum analysis
  *
- * @file       traillineitem.h
- * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2012.
- * @brief      A graphicsItem representing a WayPoint
  * @see        The GNU Public License (GPL) Version 3
- * @defgroup   OPMapWidget
- * @{
  *
  *****************************************************************************/
 /*
@@ -24,32 +27,27 @@
  * with this program; if not, write to the Free Software Foundation, Inc.,
  * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
  */
-#ifndef TAILLINEITEM_H
-#define TAILLINEITEM_H
 
-#include <QGraphicsItem>
-#include <QPainter>
-#include <QLabel>
-#include "../internals/pointlatlng.h"
-#include <QObject>
-#include "mapgraphicitem.h"
+#ifndef FFT_H
+#define FFT_H
 
-namespace mapcontrol {
-class TrailLineItem : public QObject, public QGraphicsLineItem {
-    Q_OBJECT Q_INTERFACES(QGraphicsItem)
-public:
-    enum { Type = UserType + 7 };
-    TrailLineItem(internals::PointLatLng const & coord1, internals::PointLatLng const & coord2, QBrush color, MapGraphicItem *map);
-    int type() const;
-    internals::PointLatLng coord1;
-    internals::PointLatLng coord2;
-private:
-    QBrush m_brush;
-    MapGraphicItem *m_map;
-public slots:
-    void setLineSlot();
-signals:
+#include <stdint.h>
+
+#define FFT_LOG2_MAX 8
+#define FFT_SIZE_MAX (1 << FFT_LOG2_MAX)
+
+// Twiddle factors and Hann window for one transform size, in Q15
+struct FFTq15 {
+    uint8_t  log2n;
+    uint16_t n;
+    int16_t  sinTable[FFT_SIZE_MAX];
+    int16_t  window[FFT_SIZE_MAX];
 };
-}
 
-#endif // TAILLINEITEM_H
+// Function declarations
+int32_t InitFFTq15(const uint8_t log2n, struct FFTq15 *fftPtr);
+void WindowFFTq15(const struct FFTq15 *fftPtr, int16_t *re);
+void FFTq15(const struct FFTq15 *fftPtr, int16_t *re, int16_t *im);
+uint32_t MagnitudeSquaredFFTq15(const int16_t re, const int16_t im);
+
+#endif
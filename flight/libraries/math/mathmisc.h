@@ -144,6 +144,88 @@ static inline float fast_invsqrtf(float number)
     return y;
 }
 
+/**
+ * Fast atan2() approximation, odd minimax polynomial over [0, 1] after
+ * folding the argument into the first octant.
+ * Max absolute error is 1e-5 rad over the whole input range,
+ * fast_atan2f(0, 0) returns 0
+ */
+static inline float fast_atan2f(float y, float x)
+{
+    const float ax = fabsf(x);
+    const float ay = fabsf(y);
+    const float mx = (ay > ax) ? ay : ax;
+    const float mn = (ay > ax) ? ax : ay;
+
+    if (mx == 0.0f) {
+        return 0.0f;
+    }
+
+    const float z  = mn / mx;
+    const float z2 = z * z;
+    float r = z * (0.99997726f + z2 * (-0.33262347f + z2 * (0.19354346f + z2 * (-0.11643287f + z2 * (0.05265332f + z2 * -0.01172120f)))));
+
+    if (ay > ax) {
+        r = 1.57079633f - r;
+    }
+    if (x < 0.0f) {
+        r = 3.14159265f - r;
+    }
+    return (y < 0.0f) ? -r : r;
+}
+
+/**
+ * Fast asin() approximation based on fast_atan2f().
+ * Max absolute error is 1e-5 rad, arguments outside [-1, 1] are clamped
+ */
+static inline float fast_asinf(float x)
+{
+    const float c = 1.0f - x * x;
+
+    return fast_atan2f(x, (c > 0.0f) ? sqrtf(c) : 0.0f);
+}
+
+// reduce x to [-pi, pi], 2*pi is split into an exact and a small part
+// to keep the reduction error down for large arguments
+static inline float fast_trig_reducef(float x)
+{
+    const float k = rintf(x * 0.159154943f);
+
+    return (x - k * 6.28125f) - k * 1.93530717e-3f;
+}
+
+// sin() for x in [-pi, pi], folded into [-pi/2, pi/2] for an 11th order
+// Taylor polynomial
+static inline float fast_sin_reducedf(float x)
+{
+    if (x > 1.57079633f) {
+        x = 3.14159265f - x;
+    } else if (x < -1.57079633f) {
+        x = -3.14159265f - x;
+    }
+
+    const float x2 = x * x;
+    return x * (1.0f + x2 * (-1.66666667e-1f + x2 * (8.33333333e-3f + x2 * (-1.98412698e-4f + x2 * (2.75573192e-6f + x2 * -2.50521084e-8f)))));
+}
+
+/**
+ * Fast sin() approximation.
+ * Max absolute error is 1e-6 for arguments up to +-100 rad
+ */
+static inline float fast_sinf(float x)
+{
+    return fast_sin_reducedf(fast_trig_reducef(x));
+}
+
+/**
+ * Fast cos() approximation, same error bound as fast_sinf()
+ */
+static inline float fast_cosf(float x)
+{
+    // shift after the reduction, x + pi/2 would lose precision for large x
+    return fast_sin_reducedf(fast_trig_reducef(fast_trig_reducef(x) + 1.57079633f));
+}
+
 /**
  * Ultrafast pow() aproximation needed for expo
  * Based on Algorithm by Martin Ankerl
@@ -143,3 +143,79 @@ void pid_configure(struct pid *pid, float p, float i, float d, float iLim)
     pid->d    = d;
     pid->iLim = iLim;
 }
+
+/**
+ * Update the three axis PID computation with setpoint weighting on the derivative
+ * @param[in] pid The PID struture which stores temporary information
+ * @param[in] scaler Array of three dynamic factors to scale the pid's by
+ * @param[in] setpoint Array of three setpoints
+ * @param[in] measured Array of three measured values
+ * @param[in] dT  The time step
+ * @param[out] output Array of three computed controller values
+ *
+ * Same as calling pid_apply_setpoint() for each axis, but the terms that only
+ * depend on dT are computed once and the loop body is free of function calls.
+ */
+void pid3_apply_setpoint(struct pid3 *pid, const pid_scaler *scaler, const float *setpoint, const float *measured, float dT, float *output)
+{
+    // Scale up accumulator by 1000 while computing to avoid losing precision
+    const float iFactor = dT * 1000.0f;
+    // alpha / dT with alpha = dT/(deriv_tau+dT), see pid_apply_setpoint()
+    const float dFactor = (dT > 0.0f) ? 1.0f / (dT + deriv_tau) : 0.0f;
+    const float dAlpha  = dT * dFactor;
+
+    for (int t = 0; t < 3; t++) {
+        const float err    = setpoint[t] - measured[t];
+        const float derr   = deriv_gamma * setpoint[t] - measured[t];
+        const float diff   = derr - pid->lastErr[t];
+        const float iLimit = pid->iLim[t] * 1000.0f;
+        float dterm = 0.0f;
+
+        pid->iAccumulator[t] = boundf(pid->iAccumulator[t] + err * (scaler[t].i * pid->i[t] * iFactor), -iLimit, iLimit);
+        pid->lastErr[t] = derr;
+
+        if (pid->d[t] > 0.0f && dT > 0.0f) {
+            dterm = pid->lastDer[t] + scaler[t].d * diff * pid->d[t] * dFactor - dAlpha * pid->lastDer[t];
+            pid->lastDer[t] = dterm;
+        }
+
+        output[t] = (err * scaler[t].p * pid->p[t]) + pid->iAccumulator[t] / 1000.0f + dterm;
+    }
+}
+
+/**
+ * Reset all three axes
+ * @param[in] pid The pid to reset
+ */
+void pid3_zero(struct pid3 *pid)
+{
+    if (!pid) {
+        return;
+    }
+
+    for (int t = 0; t < 3; t++) {
+        pid->iAccumulator[t] = 0;
+        pid->lastErr[t] = 0;
+        pid->lastDer[t] = 0;
+    }
+}
+
+/**
+ * Configure the settings for one axis of a three axis pid structure
+ * @param[out] pid The PID structure to configure
+ * @param[in] axis The axis to configure, 0 to 2
+ * @param[in] p The proportional term
+ * @param[in] i The integral term
+ * @param[in] d The derivative term
+ */
+void pid3_configure(struct pid3 *pid, int axis, float p, float i, float d, float iLim)
+{
+    if (!pid || axis < 0 || axis > 2) {
+        return;
+    }
+
+    pid->p[axis]    = p;
+    pid->i[axis]    = i;
+    pid->d[axis]    = d;
+    pid->iLim[axis] = iLim;
+}
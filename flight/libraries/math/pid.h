@@ -44,6 +44,17 @@ struct pid {
     float lastDer;
 };
 
+// ! Three axis pid, laid out per term so all axes are updated in one pass
+struct pid3 {
+    float p[3];
+    float i[3];
+    float d[3];
+    float iLim[3];
+    float iAccumulator[3];
+    float lastErr[3];
+    float lastDer[3];
+};
+
 typedef struct pid_scaler {
     float p;
     float i;
@@ -56,5 +67,8 @@ float pid_apply_setpoint(struct pid *pid, const pid_scaler *scaler, const float
 void pid_zero(struct pid *pid);
 void pid_configure(struct pid *pid, float p, float i, float d, float iLim);
 void pid_configure_derivative(float cutoff, float gamma);
+void pid3_apply_setpoint(struct pid3 *pid, const pid_scaler *scaler, const float *setpoint, const float *measured, float dT, float *output);
+void pid3_zero(struct pid3 *pid);
+void pid3_configure(struct pid3 *pid, int axis, float p, float i, float d, float iLim);
 
 #endif /* PID_H */
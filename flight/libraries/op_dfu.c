@@ -54,6 +54,7 @@ uint32_t Expected_CRC    = 0;
 uint8_t SizeOfLastPacket = 0;
 uint32_t Next_Packet     = 0;
 uint8_t TransferType;
+uint8_t TransferCompressed = 0;
 uint32_t Count = 0;
 uint32_t Data;
 uint8_t Data0;
@@ -67,6 +68,30 @@ uint32_t downSizeOfLastPacket = 0;
 uint32_t downPacketTotal = 0;
 uint32_t downPacketCurrent    = 0;
 DFUTransfer downType = 0;
+
+// Upload decompression state, the LZ4 stream is decoded straight into flash as it comes.
+// Matches are copied from the flash already written, so the only RAM window needed
+// is the word being assembled.
+typedef enum {
+    LZ4_TOKEN,
+    LZ4_LITERAL_LENGTH,
+    LZ4_LITERALS,
+    LZ4_OFFSET_LOW,
+    LZ4_OFFSET_HIGH,
+    LZ4_MATCH_LENGTH,
+} lz4State;
+
+static struct {
+    lz4State state;
+    uint8_t  token;
+    uint32_t length; // literals left to copy, or match length
+    uint32_t offset;
+    uint32_t base; // flash address of the first decompressed byte
+    uint32_t size; // expected decompressed size
+    uint32_t written; // decompressed bytes so far
+    uint32_t word; // word being assembled, written bytes past the last programmed word
+    bool     failed;
+} lz4;
 /* Extern variables ----------------------------------------------------------*/
 extern DFUStates DeviceState;
 extern uint8_t JumpToApp;
@@ -75,6 +100,10 @@ extern int32_t platform_senddata(const uint8_t *msg, uint16_t msg_len);
 static uint32_t baseOfAdressType(uint8_t type);
 static uint8_t isBiggerThanAvailable(uint8_t type, uint32_t size);
 static void OPDfuIni(uint8_t discover);
+static bool programWord(uint32_t address, uint32_t word);
+static void lz4Start(uint32_t base, uint32_t size);
+static void lz4Decode(uint8_t byte);
+static bool lz4Finish(void);
 bool flash_read(uint8_t *buffer, uint32_t adr, DFUProgType type);
 /* Private functions ---------------------------------------------------------*/
 void sendData(uint8_t *buf, uint16_t size);
@@ -188,14 +217,16 @@ void processComand(uint8_t *xReceive_Buffer)
     case Upload:
         if ((DeviceState == DFUidle) || (DeviceState == uploading)) {
             if ((StartFlag == 1) && (Next_Packet == 0)) {
-                TransferType     = Data0;
+                TransferType     = Data0 & ~DFU_TRANSFER_COMPRESSED;
+                TransferCompressed = (Data0 & DFU_TRANSFER_COMPRESSED) != 0;
                 SizeOfTransfer   = Count;
                 Next_Packet      = 1;
                 Expected_CRC     = unpack_uint32(&xReceive_Buffer[DATA + 2]);
                 SizeOfLastPacket = Data1;
 
                 if (isBiggerThanAvailable(TransferType, (SizeOfTransfer - 1)
-                                          * 14 * 4 + SizeOfLastPacket * 4) == true) {
+                                          * 14 * 4 + SizeOfLastPacket * 4) == true
+                    || (TransferCompressed && isBiggerThanAvailable(TransferType, Opt[1]) == true)) {
                     DeviceState = outsideDevCapabilities;
                     Aditionals  = (uint32_t)Command;
                 } else {
@@ -212,6 +243,13 @@ void processComand(uint8_t *xReceive_Buffer)
                             break;
                         }
                     }
+                    if (TransferCompressed) {
+                        if (currentProgrammingDestination == Self_flash) {
+                            lz4Start(baseOfAdressType(TransferType), Opt[1]);
+                        } else {
+                            result = false;
+                        }
+                    }
                     if (result != 1) {
                         DeviceState = Last_operation_failed;
                         Aditionals  = (uint32_t)Command;
@@ -236,15 +274,17 @@ void processComand(uint8_t *xReceive_Buffer)
                         for (uint8_t x = 0; x < numberOfWords; ++x) {
                             offset = 4 * x;
                             Data   = unpack_uint32(&xReceive_Buffer[DATA + offset]);
-                            aux    = baseOfAdressType(TransferType) + (uint32_t)(
-                                Count * 14 * 4 + x * 4);
-                            result = 0;
-                            for (int retry = 0; retry < MAX_WRI_RETRYS; ++retry) {
-                                if (result == 0) {
-                                    result = (FLASH_ProgramWord(aux, Data)
-                                              == FLASH_COMPLETE) ? 1 : 0;
+                            if (TransferCompressed) {
+                                // the stream bytes are packed in the words in flash order
+                                for (uint8_t b = 0; b < 4; ++b) {
+                                    lz4Decode(Data >> (8 * b));
                                 }
+                                result = !lz4.failed;
+                                continue;
                             }
+                            aux    = baseOfAdressType(TransferType) + (uint32_t)(
+                                Count * 14 * 4 + x * 4);
+                            result = programWord(aux, Data);
                         }
                         break;
                     case Remote_flash_via_spi:
@@ -275,7 +315,7 @@ void processComand(uint8_t *xReceive_Buffer)
         Buffer[0] = 0x01;
         Buffer[1] = Rep_Capabilities;
         if (Data0 == 0) {
-            Buffer[2] = 0;
+            Buffer[2] = DFU_CAPABILITY_COMPRESSED;
             Buffer[3] = 0;
             Buffer[4] = 0;
             Buffer[5] = 0;
@@ -325,7 +365,10 @@ void processComand(uint8_t *xReceive_Buffer)
         if (DeviceState == uploading) {
             if (Next_Packet - 1 == SizeOfTransfer) {
                 Next_Packet = 0;
-                if ((TransferType != FW) || (Expected_CRC == CalcFirmCRC())) {
+                if (TransferCompressed && !lz4Finish()) {
+                    DeviceState = Last_operation_failed;
+                    Aditionals  = (uint32_t)Command;
+                } else if ((TransferType != FW) || (Expected_CRC == CalcFirmCRC())) {
                     DeviceState = Last_operation_Success;
                 } else {
                     DeviceState = CRC_Fail;
@@ -385,6 +428,120 @@ void processComand(uint8_t *xReceive_Buffer)
         sendData(echoBuffer + 1, 63);
     }
 }
+static bool programWord(uint32_t address, uint32_t word)
+{
+    bool result = false;
+
+    for (int retry = 0; retry < MAX_WRI_RETRYS && !result; ++retry) {
+        result = (FLASH_ProgramWord(address, word) == FLASH_COMPLETE);
+    }
+    return result;
+}
+
+static void lz4Start(uint32_t base, uint32_t size)
+{
+    lz4.state   = LZ4_TOKEN;
+    lz4.base    = base;
+    lz4.size    = size;
+    lz4.written = 0;
+    lz4.word    = 0xFFFFFFFF;
+    lz4.failed  = false;
+}
+
+static void lz4Output(uint8_t byte)
+{
+    uint8_t shift = 8 * (lz4.written & 3);
+
+    lz4.word = (lz4.word & ~(0xFFu << shift)) | ((uint32_t)byte << shift);
+    ++lz4.written;
+    if ((lz4.written & 3) == 0) {
+        lz4.failed |= !programWord(lz4.base + lz4.written - 4, lz4.word);
+        lz4.word    = 0xFFFFFFFF;
+    }
+}
+
+static void lz4CopyMatch(uint32_t length)
+{
+    if (lz4.offset == 0 || lz4.offset > lz4.written) {
+        lz4.failed = true;
+        return;
+    }
+    for (; length && lz4.written < lz4.size; --length) {
+        uint32_t from = lz4.written - lz4.offset;
+        uint8_t byte;
+        if (from >= (lz4.written & ~3u)) {
+            // not programmed yet, still in the word being assembled
+            byte = lz4.word >> (8 * (from & 3));
+        } else {
+            byte = *(const uint8_t *)(lz4.base + from);
+        }
+        lz4Output(byte);
+    }
+}
+
+/**
+ * Decode one byte of an LZ4 block stream. Bytes past the decompressed size,
+ * as the padding of the last packet, are ignored.
+ */
+static void lz4Decode(uint8_t byte)
+{
+    if (lz4.failed || lz4.written >= lz4.size) {
+        return;
+    }
+    switch (lz4.state) {
+    case LZ4_TOKEN:
+        lz4.token  = byte;
+        lz4.length = byte >> 4;
+        lz4.state  = (lz4.length == 15) ? LZ4_LITERAL_LENGTH : (lz4.length ? LZ4_LITERALS : LZ4_OFFSET_LOW);
+        break;
+    case LZ4_LITERAL_LENGTH:
+        lz4.length += byte;
+        if (byte != 255) {
+            lz4.state = LZ4_LITERALS;
+        }
+        break;
+    case LZ4_LITERALS:
+        lz4Output(byte);
+        if (--lz4.length == 0) {
+            lz4.state = LZ4_OFFSET_LOW;
+        }
+        break;
+    case LZ4_OFFSET_LOW:
+        lz4.offset = byte;
+        lz4.state  = LZ4_OFFSET_HIGH;
+        break;
+    case LZ4_OFFSET_HIGH:
+        lz4.offset |= (uint32_t)byte << 8;
+        lz4.length  = lz4.token & 0x0F;
+        if (lz4.length == 15) {
+            lz4.state = LZ4_MATCH_LENGTH;
+        } else {
+            lz4CopyMatch(lz4.length + 4);
+            lz4.state = LZ4_TOKEN;
+        }
+        break;
+    case LZ4_MATCH_LENGTH:
+        lz4.length += byte;
+        if (byte != 255) {
+            lz4CopyMatch(lz4.length + 4);
+            lz4.state = LZ4_TOKEN;
+        }
+        break;
+    }
+}
+
+/**
+ * Program the last partial word
+ * @return true if the whole image was decompressed and programmed
+ */
+static bool lz4Finish(void)
+{
+    if (!lz4.failed && (lz4.written & 3)) {
+        lz4.failed = !programWord(lz4.base + (lz4.written & ~3u), lz4.word);
+    }
+    return !lz4.failed && lz4.written == lz4.size;
+}
+
 void OPDfuIni(uint8_t discover)
 {
     const struct pios_board_info *bdinfo = &pios_board_info_blob;
@@ -237,13 +237,23 @@ void
 Find_Roots (void)
 {
   int sum, r, k;	
+  int term[RS_ECC_NPARITY+1];
   NErrors = 0;
+
+  /* Chien search: keep log(Lambda[k] * a^(k*r)) for each term and step it by k,
+   * -1 marks a zero coefficient */
+  for (k = 0; k < RS_ECC_NPARITY+1; k++) {
+    term[k] = Lambda[k] ? glog[Lambda[k]] : -1;
+  }
   
   for (r = 1; r < 256; r++) {
     sum = 0;
     /* evaluate lambda at r */
     for (k = 0; k < RS_ECC_NPARITY+1; k++) {
-      sum ^= gmult(gexp[(k*r)%255], Lambda[k]);
+      if (term[k] < 0) continue;
+      term[k] += k;
+      if (term[k] >= 255) term[k] -= 255;
+      sum ^= gexp[term[k]];
     }
     if (sum == 0) 
       { 
@@ -77,9 +77,9 @@ void encode_data (unsigned char msg[], int nbytes, unsigned char dst[]);
 /* CRC-CCITT checksum generator */
 BIT16 crc_ccitt(unsigned char *msg, int len);
 
-/* galois arithmetic tables */
-extern const int gexp[];
-extern const int glog[];
+/* galois arithmetic tables, bytes to keep them small in flash */
+extern const uint8_t gexp[];
+extern const uint8_t glog[];
 
 void init_galois_tables (void);
 int ginv(int elt); 
@@ -38,6 +38,9 @@ int synBytes[MAXDEG];
 /* generator polynomial */
 int genPoly[MAXDEG*2];
 
+/* logarithms of the generator polynomial coefficients, used by the encoder */
+static uint8_t genLog[RS_ECC_NPARITY];
+
 //int DEBUG = FALSE;
 
 static void
@@ -52,6 +55,9 @@ initialize_ecc ()
 
     /* Compute the encoder generator polynomial */
     compute_genpoly(RS_ECC_NPARITY, genPoly);
+
+    /* The coefficients are never zero, so the encoder can multiply in the log domain */
+    for (int i = 0; i < RS_ECC_NPARITY; i++) genLog[i] = glog[genPoly[i]];
 }
 
 void
@@ -114,7 +120,8 @@ decode_data(unsigned char data[], int nbytes)
   for (j = 0; j < RS_ECC_NPARITY;  j++) {
     sum	= 0;
     for (i = 0; i < nbytes; i++) {
-      sum = data[i] ^ gmult(gexp[j+1], sum);
+      /* sum * a^(j+1), with the multiplication done on the logarithm */
+      sum = data[i] ^ (sum ? gexp[glog[sum] + j + 1] : 0);
     }
     synBytes[j]  = sum;
   }
@@ -187,16 +194,25 @@ compute_genpoly (int nbytes, int genpoly[])
 void
 encode_data (unsigned char msg[], int nbytes, unsigned char dst[])
 {
-  int i, LFSR[RS_ECC_NPARITY+1],dbyte, j;
+  int i, LFSR[RS_ECC_NPARITY+1],dbyte, ldbyte, j;
 	
   for(i=0; i < RS_ECC_NPARITY+1; i++) LFSR[i]=0;
 
   for (i = 0; i < nbytes; i++) {
     dbyte = msg[i] ^ LFSR[RS_ECC_NPARITY-1];
+    if (dbyte == 0) {
+      for (j = RS_ECC_NPARITY-1; j > 0; j--) {
+        LFSR[j] = LFSR[j-1];
+      }
+      LFSR[0] = 0;
+      continue;
+    }
+    /* genPoly[j] * dbyte is a single table lookup on the summed logarithms */
+    ldbyte = glog[dbyte];
     for (j = RS_ECC_NPARITY-1; j > 0; j--) {
-      LFSR[j] = LFSR[j-1] ^ gmult(genPoly[j], dbyte);
+      LFSR[j] = LFSR[j-1] ^ gexp[genLog[j] + ldbyte];
     }
-    LFSR[0] = gmult(genPoly[0], dbyte);
+    LFSR[0] = gexp[genLog[0] + ldbyte];
   }
 
   for (i = 0; i < RS_ECC_NPARITY; i++) 
@@ -0,0 +1,272 @@
+/**
+ ******************************************************************************
+ * @addtogroup OpenPilot System OpenPilot System
+ * @{
+ * @addtogroup OpenPilot Libraries OpenPilot System Libraries
+ * @{
+ * @file       sensorsim.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @brief      Batch simulation of a multirotor and of its sensors
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "sensorsim.h"
+
+// Private constants
+#define GRAV           9.81f
+#define ACTUATOR_ALPHA 0.8f
+#define MAX_THRUST     (GRAV * 2)
+#define K_FRICTION     1.0f
+#define DEFAULT_SEED   0x2545F491u
+#define BARO_OFFSET    50.0f
+#define TWO_PI         6.28318530717958647692f
+#define DEG2RAD        0.01745329251994329577f
+
+// Index of the noise values drawn for each sample
+enum {
+    NOISE_GYRO     = 0, // 3 axes
+    NOISE_WIND     = 3, // 3 axes
+    NOISE_BARO     = 6,
+    NOISE_GPS_VEL  = 7, // 3 axes
+    NOISE_GPS_POS  = 10, // 3 axes
+};
+
+// Private functions
+static inline float rng_uniform(uint32_t *rng);
+static void draw_noise(struct sensorsim_state *state, uint16_t count, float noise[SENSORSIM_NOISE_PER_SAMPLE][SENSORSIM_MAX_BLOCK]);
+
+void SensorSimInit(struct sensorsim_state *state, uint32_t seed)
+{
+    memset(state, 0, sizeof(*state));
+    state->q[0]         = 1;
+    state->baro_offset  = BARO_OFFSET;
+    state->rng = seed ? seed : DEFAULT_SEED;
+    state->next_mag_us  = SENSORSIM_MAG_PERIOD_US;
+    state->next_baro_us = SENSORSIM_BARO_PERIOD_US;
+    state->next_gps_us  = SENSORSIM_GPS_PERIOD_US;
+
+    // Accel biases, gaussian from the seeded sequence
+    float u[4];
+    for (int i = 0; i < 4; i++) {
+        u[i] = rng_uniform(&state->rng);
+    }
+    state->accel_bias[0] = sqrtf(-2 * logf(u[0])) * cosf(TWO_PI * u[1]) / 10;
+    state->accel_bias[1] = sqrtf(-2 * logf(u[0])) * sinf(TWO_PI * u[1]) / 10;
+    state->accel_bias[2] = sqrtf(-2 * logf(u[2])) * cosf(TWO_PI * u[3]) / 10;
+}
+
+void SensorSimRun(struct sensorsim_state *state, const struct sensorsim_input *input, uint16_t count, uint32_t period_us, struct sensorsim_block *block)
+{
+    if (count > SENSORSIM_MAX_BLOCK) {
+        count = SENSORSIM_MAX_BLOCK;
+    }
+    block->count = count;
+
+    const float dT  = period_us * 1e-6f;
+    const float armed = input->armed ? 1.0f : 0.0f;
+    float thrust    = input->armed ? input->throttle * MAX_THRUST : 0;
+    // Also rejects NaN
+    if (!(thrust > 0)) {
+        thrust = 0;
+    }
+
+    // 1. Noise of the whole block, in sample order so the sequence does not
+    // depend on the block length
+    draw_noise(state, count, block->noise);
+
+    // 2. Dynamics, sequential by nature, only what the next step depends on
+    float q[4] = { state->q[0], state->q[1], state->q[2], state->q[3] };
+    float rpy[3]  = { state->rpy[0], state->rpy[1], state->rpy[2] };
+    double pos[3] = { state->pos[0], state->pos[1], state->pos[2] };
+    double vel[3] = { state->vel[0], state->vel[1], state->vel[2] };
+
+    for (uint16_t n = 0; n < count; n++) {
+        for (int i = 0; i < 3; i++) {
+            rpy[i] = armed * input->rate[i] * (1 - ACTUATOR_ALPHA) + rpy[i] * ACTUATOR_ALPHA;
+        }
+
+        // Predict the attitude forward in time
+        const float k = dT * DEG2RAD / 2;
+        float qdot[4];
+        qdot[0] = (-q[1] * rpy[0] - q[2] * rpy[1] - q[3] * rpy[2]) * k;
+        qdot[1] = (q[0] * rpy[0] - q[3] * rpy[1] + q[2] * rpy[2]) * k;
+        qdot[2] = (q[3] * rpy[0] + q[0] * rpy[1] - q[1] * rpy[2]) * k;
+        qdot[3] = (-q[2] * rpy[0] + q[1] * rpy[1] + q[0] * rpy[2]) * k;
+        float qmag = 0;
+        for (int i = 0; i < 4; i++) {
+            q[i] += qdot[i];
+            qmag += q[i] * q[i];
+        }
+        qmag = 1 / sqrtf(qmag);
+        for (int i = 0; i < 4; i++) {
+            q[i] *= qmag;
+            block->q[i][n] = q[i];
+        }
+
+        for (int i = 0; i < 3; i++) {
+            state->wind[i] = state->wind[i] * 0.95f + block->noise[NOISE_WIND + i][n] / 10;
+        }
+
+        // Thrust is along the body down axis, the last row of Rbe, made negative as down is positive
+        float Rz[3];
+        Rz[0] = 2 * (q[1] * q[3] + q[0] * q[2]);
+        Rz[1] = 2 * (q[2] * q[3] - q[0] * q[1]);
+        Rz[2] = q[0] * q[0] - q[1] * q[1] - q[2] * q[2] + q[3] * q[3];
+
+        double ned_accel[3];
+        for (int i = 0; i < 3; i++) {
+            ned_accel[i] = -thrust * Rz[i] - K_FRICTION * (vel[i] - state->wind[i]);
+        }
+        // Gravity causes acceleration of 9.81 in the down direction
+        ned_accel[2] += GRAV;
+
+        for (int i = 0; i < 3; i++) {
+            vel[i] += ned_accel[i] * dT;
+            pos[i] += vel[i] * dT;
+        }
+
+        // Simulate hitting ground
+        if (pos[2] > 0) {
+            pos[2] = 0;
+            vel[2] = 0;
+            ned_accel[2] = 0;
+        }
+
+        // Sensor feels gravity (when not acceleration in ned frame e.g. ned_accel[2] = 0)
+        ned_accel[2] -= GRAV;
+
+        // Very small drift process
+        state->baro_offset += block->noise[NOISE_BARO][n] / 100;
+        for (int i = 0; i < 3; i++) {
+            state->gps_vel_drift[i] = state->gps_vel_drift[i] * 0.65f + block->noise[NOISE_GPS_VEL + i][n] / 5;
+        }
+
+        state->time_us += period_us;
+        uint8_t due = 0;
+        if ((int32_t)(state->time_us - state->next_baro_us) >= 0) {
+            state->next_baro_us += SENSORSIM_BARO_PERIOD_US;
+            due |= SENSORSIM_DUE_BARO;
+        }
+        if ((int32_t)(state->time_us - state->next_mag_us) >= 0) {
+            state->next_mag_us += SENSORSIM_MAG_PERIOD_US;
+            due |= SENSORSIM_DUE_MAG;
+        }
+        if ((int32_t)(state->time_us - state->next_gps_us) >= 0) {
+            state->next_gps_us += SENSORSIM_GPS_PERIOD_US;
+            due |= SENSORSIM_DUE_GPS;
+            for (int i = 0; i < 3; i++) {
+                state->gps_drift[i] = state->gps_drift[i] * 0.95f + block->noise[NOISE_GPS_POS + i][n] / 10;
+            }
+        }
+
+        block->time_us[n] = state->time_us;
+        block->due[n]     = due;
+        block->baro_altitude[n] = -pos[2] + state->baro_offset;
+        for (int i = 0; i < 3; i++) {
+            block->gyro[i][n]      = rpy[i];
+            block->ned_accel[i][n] = ned_accel[i];
+            block->pos[i][n] = pos[i];
+            block->vel[i][n] = vel[i];
+            block->gps_pos[i][n]   = pos[i] + state->gps_drift[i];
+            block->gps_vel[i][n]   = vel[i] + state->gps_vel_drift[i];
+        }
+    }
+
+    for (int i = 0; i < 3; i++) {
+        state->rpy[i] = rpy[i];
+        state->pos[i] = pos[i];
+        state->vel[i] = vel[i];
+    }
+    for (int i = 0; i < 4; i++) {
+        state->q[i] = q[i];
+    }
+
+    // 3. Sensor models, independent per sample, straight loops over the axis arrays
+    const float *q0 = block->q[0], *q1 = block->q[1], *q2 = block->q[2], *q3 = block->q[3];
+    for (uint16_t n = 0; n < count; n++) {
+        const float q0s = q0[n] * q0[n], q1s = q1[n] * q1[n], q2s = q2[n] * q2[n], q3s = q3[n] * q3[n];
+        const float R00 = q0s + q1s - q2s - q3s;
+        const float R01 = 2 * (q1[n] * q2[n] + q0[n] * q3[n]);
+        const float R02 = 2 * (q1[n] * q3[n] - q0[n] * q2[n]);
+        const float R10 = 2 * (q1[n] * q2[n] - q0[n] * q3[n]);
+        const float R11 = q0s - q1s + q2s - q3s;
+        const float R12 = 2 * (q2[n] * q3[n] + q0[n] * q1[n]);
+        const float R20 = 2 * (q1[n] * q3[n] + q0[n] * q2[n]);
+        const float R21 = 2 * (q2[n] * q3[n] - q0[n] * q1[n]);
+        const float R22 = q0s - q1s - q2s + q3s;
+
+        // Transform the accels back in to body frame
+        const float ax  = block->ned_accel[0][n], ay = block->ned_accel[1][n], az = block->ned_accel[2][n];
+        block->accel[0][n] = R00 * ax + R01 * ay + R02 * az + state->accel_bias[0];
+        block->accel[1][n] = R10 * ax + R11 * ay + R12 * az + state->accel_bias[1];
+        block->accel[2][n] = R20 * ax + R21 * ay + R22 * az + state->accel_bias[2];
+
+        block->mag[0][n]   = R00 * input->Be[0] + R01 * input->Be[1] + R02 * input->Be[2];
+        block->mag[1][n]   = R10 * input->Be[0] + R11 * input->Be[1] + R12 * input->Be[2];
+        block->mag[2][n]   = R20 * input->Be[0] + R21 * input->Be[1] + R22 * input->Be[2];
+    }
+    for (int i = 0; i < 3; i++) {
+        for (uint16_t n = 0; n < count; n++) {
+            block->gyro[i][n] += block->noise[NOISE_GYRO + i][n];
+        }
+    }
+}
+
+/**
+ * xorshift32 uniform generator, deterministic and the same on every host
+ */
+static inline float rng_uniform(uint32_t *rng)
+{
+    uint32_t x = *rng;
+
+    x   ^= x << 13;
+    x   ^= x >> 17;
+    x   ^= x << 5;
+    *rng = x;
+
+    // 24 bit uniform in (0, 1]
+    return ((x >> 8) + 1) * (1.0f / 16777216.0f);
+}
+
+/**
+ * Draw SENSORSIM_NOISE_PER_SAMPLE unit gaussian values for each sample. The uniform
+ * values are drawn sample after sample, then turned into gaussian ones pairwise
+ * with the Box-Muller transform in one pass over the block.
+ */
+static void draw_noise(struct sensorsim_state *state, uint16_t count, float noise[SENSORSIM_NOISE_PER_SAMPLE][SENSORSIM_MAX_BLOCK])
+{
+    for (uint16_t n = 0; n < count; n++) {
+        for (int k = 0; k < SENSORSIM_NOISE_PER_SAMPLE; k++) {
+            noise[k][n] = rng_uniform(&state->rng);
+        }
+    }
+
+    for (int k = 0; k < SENSORSIM_NOISE_PER_SAMPLE; k += 2) {
+        float *u1 = noise[k], *u2 = noise[k + 1];
+        for (uint16_t n = 0; n < count; n++) {
+            const float r = sqrtf(-2 * logf(u1[n]));
+            const float a = TWO_PI * u2[n];
+            u1[n] = r * cosf(a);
+            u2[n] = r * sinf(a);
+        }
+    }
+}
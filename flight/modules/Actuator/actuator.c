@@ -45,6 +45,9 @@
 #include "cameradesired.h"
 #include "manualcontrolcommand.h"
 #include "taskinfo.h"
+#ifdef DIAG_CONTROLLATENCY
+#include "controllatency.h"
+#endif
 #undef PIOS_INCLUDE_INSTRUMENTATION
 #ifdef PIOS_INCLUDE_INSTRUMENTATION
 #include <pios_instrumentation.h>
@@ -70,6 +73,9 @@ static int8_t counter;
 #define ACTUATOR_ONESHOT125_CLOCK       2000000
 #define ACTUATOR_ONESHOT125_PULSE_SCALE 4
 #define ACTUATOR_PWM_CLOCK              1000000
+
+#define CONTROLLATENCY_BUCKETS          CONTROLLATENCY_HISTOGRAM_NUMELEM
+#define CONTROLLATENCY_PUBLISH_MS       1000
 // Private types
 
 
@@ -80,11 +86,24 @@ static xTaskHandle taskHandle;
 static float lastResult[MAX_MIX_ACTUATORS] = { 0 };
 static float filterAccumulator[MAX_MIX_ACTUATORS] = { 0 };
 static uint8_t pinsMode[MAX_MIX_ACTUATORS];
+// mixer vectors compiled from MixerSettings and scaled to unity, zero for channels that don't mix
+static float mixerMatrix[MAX_MIX_ACTUATORS][MIXERSETTINGS_MIXER1VECTOR_NUMELEM];
+// number of enabled mixers
+static uint8_t mixerCount;
 // used to inform the actuator thread that actuator update rate is changed
 static volatile bool actuator_settings_updated;
 // used to inform the actuator thread that mixer settings are changed
 static volatile bool mixer_settings_updated;
 
+#ifdef DIAG_CONTROLLATENCY
+// upper bound of each histogram bucket in us, the last bucket collects everything above
+static const uint16_t controlLatencyBounds[CONTROLLATENCY_BUCKETS - 1] = { 250, 500, 750, 1000, 1500, 2000, 3000, 4000, 6000, 8000 };
+static ControlLatencyData controlLatency;
+static uint64_t controlLatencySum;
+static uint32_t controlLatencyLastSample;
+static uint32_t controlLatencyLastPublish;
+#endif
+
 // Private functions
 static void actuatorTask(void *parameters);
 static int16_t scaleChannel(float value, int16_t max, int16_t min, int16_t neutral);
@@ -93,6 +112,10 @@ static float MixerCurve(const float throttle, const float *curve, uint8_t elemen
 static bool set_channel(uint8_t mixer_channel, uint16_t value, const ActuatorSettingsData *actuatorSettings);
 static void actuator_update_rate_if_changed(const ActuatorSettingsData *actuatorSettings, bool force_update);
 static void MixerSettingsUpdatedCb(UAVObjEvent *ev);
+static void compileMixer(const MixerSettingsData *mixerSettings);
+#ifdef DIAG_CONTROLLATENCY
+static void updateControlLatency(uint32_t sampleTime);
+#endif
 static void ActuatorSettingsUpdatedCb(UAVObjEvent *ev);
 float ProcessMixer(const int index, const float curve1, const float curve2,
                    const MixerSettingsData *mixerSettings, ActuatorDesiredData *desired,
@@ -149,6 +172,13 @@ int32_t ActuatorInitialize()
     MixerStatusInitialize();
 #endif
 
+#ifdef DIAG_CONTROLLATENCY
+    // UAVO used to benchmark the sensor to actuator latency
+    ControlLatencyInitialize();
+    ControlLatencyGet(&controlLatency);
+    controlLatency.Min = UINT16_MAX;
+#endif
+
     return 0;
 }
 MODULE_INITCALL(ActuatorInitialize, ActuatorStart);
@@ -195,6 +225,7 @@ static void actuatorTask(__attribute__((unused)) void *parameters)
     MixerSettingsData mixerSettings;
     mixer_settings_updated = false;
     MixerSettingsGet(&mixerSettings);
+    compileMixer(&mixerSettings);
 
     /* Force an initial configuration of the actuator update rates */
     actuator_update_rate_if_changed(&actuatorSettings, true);
@@ -223,6 +254,7 @@ static void actuatorTask(__attribute__((unused)) void *parameters)
         if (mixer_settings_updated) {
             mixer_settings_updated = false;
             MixerSettingsGet(&mixerSettings);
+            compileMixer(&mixerSettings);
         }
 
         if (rc != pdTRUE) {
@@ -279,14 +311,8 @@ static void actuatorTask(__attribute__((unused)) void *parameters)
 #ifdef DIAG_MIXERSTATUS
         MixerStatusGet(&mixerStatus);
 #endif
-        int nMixers     = 0;
         Mixer_t *mixers = (Mixer_t *)&mixerSettings.Mixer1Type;
-        for (int ct = 0; ct < MAX_MIX_ACTUATORS; ct++) {
-            if (mixers[ct].type != MIXERSETTINGS_MIXER1TYPE_DISABLED) {
-                nMixers++;
-            }
-        }
-        if ((nMixers < 2) && !ActuatorCommandReadOnly()) { // Nothing can fly with less than two mixers.
+        if ((mixerCount < 2) && !ActuatorCommandReadOnly()) { // Nothing can fly with less than two mixers.
             setFailsafe(&actuatorSettings, &mixerSettings); // So that channels like PWM buzzer keep working
             continue;
         }
@@ -442,6 +468,9 @@ static void actuatorTask(__attribute__((unused)) void *parameters)
         }
         // Update output object
         ActuatorCommandSet(&command);
+#ifdef DIAG_CONTROLLATENCY
+        updateControlLatency(desired.SampleTime);
+#endif
         // Update in case read only (eg. during servo configuration)
         ActuatorCommandGet(&command);
 
@@ -471,6 +500,70 @@ static void actuatorTask(__attribute__((unused)) void *parameters)
 }
 
 
+#ifdef DIAG_CONTROLLATENCY
+/**
+ * Record the time from the gyro sample that produced the current ActuatorDesired
+ * to the ActuatorCommand update, publishing the histogram once per second
+ * \param[in] sampleTime raw timestamp of the originating gyro sample, 0 if unknown
+ */
+static void updateControlLatency(uint32_t sampleTime)
+{
+    // skip commands not driven by a sensor sample, and samples already accounted for
+    if (sampleTime == 0 || sampleTime == controlLatencyLastSample) {
+        return;
+    }
+    controlLatencyLastSample = sampleTime;
+
+    uint32_t latency = PIOS_DELAY_DiffuS(sampleTime);
+    uint8_t bucket   = 0;
+    while (bucket < CONTROLLATENCY_BUCKETS - 1 && latency >= controlLatencyBounds[bucket]) {
+        bucket++;
+    }
+    ControlLatencyHistogramToArray(controlLatency.Histogram)[bucket]++;
+    controlLatency.Samples++;
+    controlLatencySum += latency;
+
+    if (latency > UINT16_MAX) {
+        latency = UINT16_MAX;
+    }
+    if (latency < controlLatency.Min) {
+        controlLatency.Min = latency;
+    }
+    if (latency > controlLatency.Max) {
+        controlLatency.Max = latency;
+    }
+
+    if (PIOS_DELAY_DiffuS(controlLatencyLastPublish) >= CONTROLLATENCY_PUBLISH_MS * 1000) {
+        controlLatencyLastPublish = PIOS_DELAY_GetRaw();
+        controlLatency.Average    = controlLatencySum / controlLatency.Samples;
+        ControlLatencySet(&controlLatency);
+    }
+}
+#endif /* DIAG_CONTROLLATENCY */
+
+/**
+ * Convert the mixer vectors to floats scaled to unity and count the enabled mixers,
+ * so the actuator loop doesn't have to do it every cycle
+ */
+static void compileMixer(const MixerSettingsData *mixerSettings)
+{
+    const Mixer_t *mixers = (Mixer_t *)&mixerSettings->Mixer1Type; // pointer to array of mixers in UAVObjects
+
+    mixerCount = 0;
+    for (int ct = 0; ct < MAX_MIX_ACTUATORS; ct++) {
+        bool mixing = (mixers[ct].type == MIXERSETTINGS_MIXER1TYPE_MOTOR) ||
+                      (mixers[ct].type == MIXERSETTINGS_MIXER1TYPE_REVERSABLEMOTOR) ||
+                      (mixers[ct].type == MIXERSETTINGS_MIXER1TYPE_SERVO);
+
+        for (int i = 0; i < MIXERSETTINGS_MIXER1VECTOR_NUMELEM; i++) {
+            mixerMatrix[ct][i] = mixing ? (float)mixers[ct].matrix[i] / 128.0f : 0.0f;
+        }
+        if (mixers[ct].type != MIXERSETTINGS_MIXER1TYPE_DISABLED) {
+            mixerCount++;
+        }
+    }
+}
+
 /**
  * Process mixing for one actuator
  */
@@ -480,12 +573,13 @@ float ProcessMixer(const int index, const float curve1, const float curve2,
     static float lastFilteredResult[MAX_MIX_ACTUATORS];
     const Mixer_t *mixers = (Mixer_t *)&mixerSettings->Mixer1Type; // pointer to array of mixers in UAVObjects
     const Mixer_t *mixer  = &mixers[index];
+    const float *vector   = mixerMatrix[index];
 
-    float result = ((((float)mixer->matrix[MIXERSETTINGS_MIXER1VECTOR_THROTTLECURVE1]) * curve1) +
-                    (((float)mixer->matrix[MIXERSETTINGS_MIXER1VECTOR_THROTTLECURVE2]) * curve2) +
-                    (((float)mixer->matrix[MIXERSETTINGS_MIXER1VECTOR_ROLL]) * desired->Roll) +
-                    (((float)mixer->matrix[MIXERSETTINGS_MIXER1VECTOR_PITCH]) * desired->Pitch) +
-                    (((float)mixer->matrix[MIXERSETTINGS_MIXER1VECTOR_YAW]) * desired->Yaw)) / 128.0f;
+    float result = vector[MIXERSETTINGS_MIXER1VECTOR_THROTTLECURVE1] * curve1 +
+                   vector[MIXERSETTINGS_MIXER1VECTOR_THROTTLECURVE2] * curve2 +
+                   vector[MIXERSETTINGS_MIXER1VECTOR_ROLL] * desired->Roll +
+                   vector[MIXERSETTINGS_MIXER1VECTOR_PITCH] * desired->Pitch +
+                   vector[MIXERSETTINGS_MIXER1VECTOR_YAW] * desired->Yaw;
 
     // note: no feedforward for reversable motors yet for safety reasons
     if (mixer->type == MIXERSETTINGS_MIXER1TYPE_MOTOR) {
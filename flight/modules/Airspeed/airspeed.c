@@ -127,7 +127,7 @@ int32_t AirspeedInitialize()
 
     return 0;
 }
-MODULE_INITCALL(AirspeedInitialize, AirspeedStart);
+MODULE_INITCALL_DEFERRED(AirspeedInitialize, AirspeedStart);
 
 
 /**
@@ -55,8 +55,9 @@ struct IMUGlobals {
     float ff, ffV;
 
     // storage variables for Butterworth filter
-    float pn1, pn2;
-    float yn1, yn2;
+    float x1n1, x1n2;
+    float x2n1, x2n2;
+    float x3n1, x3n2;
     float v1n1, v1n2;
     float v2n1, v2n2;
     float v3n1, v3n2;
@@ -66,7 +67,7 @@ struct IMUGlobals {
     float Vw1, Vw2, Vw3;
 
     // storage variables for derivative calculation
-    float pOld, yOld;
+    float xBOld[3];
     float v1Old, v2Old, v3Old;
 };
 
@@ -81,54 +82,34 @@ static inline float Sq(float x)
     return x * x;
 }
 
-// ****** find pitch, yaw from quaternion ********
-static void Quaternion2PY(const float q0, const float q1, const float q2, const float q3, float *pPtr, float *yPtr, bool principalArg)
+// ****** fuselage vector from quaternion ********
+// First column of the rotation matrix, the body x axis in NED, without any trigonometry
+static void Quaternion2xB(const float q0, const float q1, const float q2, const float q3, float x[3])
 {
-    float R13, R11, R12;
-    const float q0s = q0 * q0;
-    const float q1s = q1 * q1;
-    const float q2s = q2 * q2;
-    const float q3s = q3 * q3;
-
-    R13   = 2.0f * (q1 * q3 - q0 * q2);
-    R11   = q0s + q1s - q2s - q3s;
-    R12   = 2.0f * (q1 * q2 + q0 * q3);
-
-    *pPtr = asinf(-R13); // pitch always between -pi/2 to pi/2
-
-    const float y_ = atan2f(R12, R11);
-    // use old yaw contained in y to add multiples of 2pi to have a continuous yaw if user does not want the principal argument
-    // else simply copy atan2 result into result
-    if (principalArg) {
-        *yPtr = y_;
-    } else {
-        // calculate needed mutliples of 2pi to avoid jumps
-        // number of cycles accumulated in old yaw
-        const int32_t cycles = (int32_t)(*yPtr / M_2PI_F);
-        // look for a jump by substracting the modulus, i.e. there is maximally one jump.
-        // take slightly less than 2pi, because the jump will always be lower than 2pi
-        const int32_t mod    = (int32_t)((y_ - (*yPtr - cycles * M_2PI_F)) / (M_2PI_F * 0.8f));
-        *yPtr = y_ + M_2PI_F * (cycles - mod);
-    }
+    x[0] = q0 * q0 + q1 * q1 - q2 * q2 - q3 * q3;
+    x[1] = 2.0f * (q1 * q2 + q0 * q3);
+    x[2] = 2.0f * (q1 * q3 - q0 * q2);
 }
 
-static void PY2xB(const float p, const float y, float x[3])
+// low pass filter the fuselage vector per component and bring it back to unit length
+static void FilterxB(const float xIn[3], float x[3])
 {
-    const float cosp = cosf(p);
-
-    x[0] = cosp * cosf(y);
-    x[1] = cosp * sinf(y);
-    x[2] = -sinf(p);
-}
-
-
-static void PY2DeltaxB(const float p, const float y, const float xB[3], float x[3])
-{
-    const float cosp = cosf(p);
-
-    x[0] = xB[0] - cosp * cosf(y);
-    x[1] = xB[1] - cosp * sinf(y);
-    x[2] = xB[2] - -sinf(p);
+    x[0] = FilterButterWorthDF2(xIn[0], &(imu->prefilter), &(imu->x1n1), &(imu->x1n2));
+    x[1] = FilterButterWorthDF2(xIn[1], &(imu->prefilter), &(imu->x2n1), &(imu->x2n2));
+    x[2] = FilterButterWorthDF2(xIn[2], &(imu->prefilter), &(imu->x3n1), &(imu->x3n2));
+
+    const float norm2 = Sq(x[0]) + Sq(x[1]) + Sq(x[2]);
+    if (norm2 > EPS) {
+        const float invNorm = 1.0f / sqrtf(norm2);
+        x[0] *= invNorm;
+        x[1] *= invNorm;
+        x[2] *= invNorm;
+    } else {
+        // only after a half turn within the filter period, keep the last direction
+        x[0] = imu->xBOld[0];
+        x[1] = imu->xBOld[1];
+        x[2] = imu->xBOld[2];
+    }
 }
 
 
@@ -159,10 +140,11 @@ void imu_airspeedInitialize(const AirspeedSettingsData *airspeedSettings)
     imu->ffV = ffV;
     imu->ff  = ff;
 
-    // get pitch and yaw from quarternion; principal argument for yaw
-    Quaternion2PY(attData.q1, attData.q2, attData.q3, attData.q4, &(imu->pOld), &(imu->yOld), true);
-    InitButterWorthDF2Values(imu->pOld, &(imu->prefilter), &(imu->pn1), &(imu->pn2));
-    InitButterWorthDF2Values(imu->yOld, &(imu->prefilter), &(imu->yn1), &(imu->yn2));
+    // get fuselage vector from quarternion
+    Quaternion2xB(attData.q1, attData.q2, attData.q3, attData.q4, imu->xBOld);
+    InitButterWorthDF2Values(imu->xBOld[0], &(imu->prefilter), &(imu->x1n1), &(imu->x1n2));
+    InitButterWorthDF2Values(imu->xBOld[1], &(imu->prefilter), &(imu->x2n1), &(imu->x2n2));
+    InitButterWorthDF2Values(imu->xBOld[2], &(imu->prefilter), &(imu->x3n1), &(imu->x3n2));
 
     // use current NED speed as vOld vector and as initial value for filter
     imu->v1Old = velData.North;
@@ -192,9 +174,11 @@ void imu_airspeedInitialize(const AirspeedSettingsData *airspeedSettings)
  * See OP-1317 imu_wind_estimation.pdf for details on the adaptation
  * Need a low pass filter to filter out spikes in non coordinated maneuvers
  * A two step Butterworth second order filter is used. In the first step fuselage vector xB
- * and ground speed vector Vel are filtered. The fuselage vector is filtered through its pitch
- * and yaw to keep a unit length. After building the differenced dxB and dVel are produced and
- * the airspeed calculated. The calculated airspeed is filtered again with a Butterworth filter
+ * and ground speed vector Vel are filtered. The fuselage vector is the first column of the
+ * rotation matrix of the attitude quaternion, it is filtered per component and normalized
+ * again to keep a unit length. The previous filtered vectors are kept, so the differences
+ * dxB and dVel cost a subtraction each and no trigonometric function is evaluated. Then the
+ * airspeed is calculated. The calculated airspeed is filtered again with a Butterworth filter
  */
 void imu_airspeedGet(AirspeedSensorData *airspeedData, const AirspeedSettingsData *airspeedSettings)
 {
@@ -212,8 +196,9 @@ void imu_airspeedGet(AirspeedSensorData *airspeedData, const AirspeedSettingsDat
     }
     if (fabsf(ff - imu->ff) > EPS) {
         InitButterWorthDF2Filter(ff, &(imu->prefilter));
-        InitButterWorthDF2Values(imu->pOld, &(imu->prefilter), &(imu->pn1), &(imu->pn2));
-        InitButterWorthDF2Values(imu->yOld, &(imu->prefilter), &(imu->yn1), &(imu->yn2));
+        InitButterWorthDF2Values(imu->xBOld[0], &(imu->prefilter), &(imu->x1n1), &(imu->x1n2));
+        InitButterWorthDF2Values(imu->xBOld[1], &(imu->prefilter), &(imu->x2n1), &(imu->x2n2));
+        InitButterWorthDF2Values(imu->xBOld[2], &(imu->prefilter), &(imu->x3n1), &(imu->x3n2));
         InitButterWorthDF2Values(imu->v1Old, &(imu->prefilter), &(imu->v1n1), &(imu->v1n2));
         InitButterWorthDF2Values(imu->v2Old, &(imu->prefilter), &(imu->v2n1), &(imu->v2n2));
         InitButterWorthDF2Values(imu->v3Old, &(imu->prefilter), &(imu->v3n1), &(imu->v3n2));
@@ -230,20 +215,17 @@ void imu_airspeedGet(AirspeedSensorData *airspeedData, const AirspeedSettingsDat
         AttitudeStateGet(&attData);
         VelocityStateData velData;
         VelocityStateGet(&velData);
-        float p = imu->pOld, y = imu->yOld;
+        float rawxB[3];
         float dxB[3];
 
-        // get pitch and roll Euler angles from quaternion
-        // do not calculate the principlal argument of yaw, i.e. use old yaw to add multiples of 2pi to have a continuous yaw
-        Quaternion2PY(attData.q1, attData.q2, attData.q3, attData.q4, &p, &y, false);
-
-        // filter pitch and roll Euler angles instead of fuselage vector to guarantee a unit length at all times
-        p = FilterButterWorthDF2(p, &(imu->prefilter), &(imu->pn1), &(imu->pn2));
-        y = FilterButterWorthDF2(y, &(imu->prefilter), &(imu->yn1), &(imu->yn2));
-        // transform pitch and yaw into fuselage vector xB and xBold
-        PY2xB(p, y, xB);
+        // get fuselage vector from quaternion
+        Quaternion2xB(attData.q1, attData.q2, attData.q3, attData.q4, rawxB);
+        // filter fuselage vector, normalized to guarantee a unit length at all times
+        FilterxB(rawxB, xB);
         // calculate change in fuselage vector by substraction of old value
-        PY2DeltaxB(imu->pOld, imu->yOld, xB, dxB);
+        dxB[0] = xB[0] - imu->xBOld[0];
+        dxB[1] = xB[1] - imu->xBOld[1];
+        dxB[2] = xB[2] - imu->xBOld[2];
 
         // filter ground speed from VelocityState
         const float fv1n = FilterButterWorthDF2(velData.North, &(imu->prefilter), &(imu->v1n1), &(imu->v1n2));
@@ -258,11 +240,12 @@ void imu_airspeedGet(AirspeedSensorData *airspeedData, const AirspeedSettingsDat
         dvdtDotdfdt = (fv1n - imu->v1Old) * dxB[0] + (fv2n - imu->v2Old) * dxB[1] + (fv3n - imu->v3Old) * dxB[2];
 
         // actualise old values
-        imu->pOld   = p;
-        imu->yOld   = y;
-        imu->v1Old  = fv1n;
-        imu->v2Old  = fv2n;
-        imu->v3Old  = fv3n;
+        imu->xBOld[0] = xB[0];
+        imu->xBOld[1] = xB[1];
+        imu->xBOld[2] = xB[2];
+        imu->v1Old    = fv1n;
+        imu->v2Old    = fv2n;
+        imu->v3Old    = fv3n;
     }
 
     // Some reorientation needed to be able to calculate airspeed, calculate only for sufficient velocity
@@ -370,6 +370,7 @@ static int32_t updateSensors(AccelStateData *accelState, GyroStateData *gyros)
         return -1;
     }
     PERF_TIMED_SECTION_START(counterUpd);
+    gyros->SampleTime = PIOS_DELAY_GetRaw();
     // First sample is temperature
     gyros->x = -(gyro[1] - STD_CC_ANALOG_GYRO_NEUTRAL) * gyro_scale.X;
     gyros->y = (gyro[2] - STD_CC_ANALOG_GYRO_NEUTRAL) * gyro_scale.Y;
@@ -503,6 +504,8 @@ static int32_t updateSensorsCC3D(AccelStateData *accelStateData, GyroStateData *
     }
     float invcount = 1.0f / count;
     PERF_TIMED_SECTION_START(counterUpd);
+    // capture time of the newest sample
+    gyrosData->SampleTime = mpu6000_data->timestamp;
     gyros[0]  *= gyro_scale.X * invcount;
     gyros[1]  *= gyro_scale.Y * invcount;
     gyros[2]  *= gyro_scale.Z * invcount;
@@ -606,7 +609,7 @@ static inline void apply_accel_filter(const float *raw, float *filtered)
 
 __attribute__((optimize("O3"))) static void updateAttitude(AccelStateData *accelStateData, GyroStateData *gyrosData)
 {
-    float dT      = PIOS_DELTATIME_GetAverageSeconds(&dtconfig);
+    float dT      = PIOS_DELTATIME_GetAverageSecondsSince(&dtconfig, gyrosData->SampleTime);
 
     // Bad practice to assume structure order, but saves memory
     float *gyros  = &gyrosData->x;
@@ -31,10 +31,16 @@
  */
 
 /**
- * Input objects: None, takes sensor data via pios
- * Output objects: @ref AttitudeRaw @ref AttitudeActual
+ * Input objects: @ref FlightStatus @ref ManualControlCommand @ref RelayTuning
+ * Output objects: @ref StabilizationDesired @ref StabilizationSettings
  *
- * This module computes an attitude estimate from the sensor data
+ * This module switches roll and pitch to relay mode in turn and computes
+ * gains from the oscillation measured by the relay controller in @ref RelayTuning
+ *
+ * NOTE: this module is not built by any target. The relay stabilization modes
+ * and the RelayTuning/RelayTuningSettings objects it depends on are no longer
+ * part of the tree, the gain computation in update_stabilization_settings()
+ * runs once on landing and costs no CPU while flying.
  *
  * The module executes in its own thread.
  *
@@ -116,7 +122,7 @@ int32_t AutotuneStart(void)
     return 0;
 }
 
-MODULE_INITCALL(AutotuneInitialize, AutotuneStart);
+MODULE_INITCALL_DEFERRED(AutotuneInitialize, AutotuneStart);
 
 /**
  * Module thread, should not return.
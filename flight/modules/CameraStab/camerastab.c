@@ -49,6 +49,7 @@
 
 #include "accessorydesired.h"
 #include "attitudestate.h"
+#include "gyrostate.h"
 #include "camerastabsettings.h"
 #include "cameradesired.h"
 #include "hwsettings.h"
@@ -62,8 +63,10 @@
 
 // Private variables
 static struct CameraStab_data {
-    portTickType lastSysTime;
-    float inputs[CAMERASTABSETTINGS_INPUT_NUMELEM];
+    uint32_t lastSysTime; // PIOS_DELAY_GetRaw() time of the last update
+    float    inputs[CAMERASTABSETTINGS_INPUT_NUMELEM];
+    CameraStabSettingsData settings;
+    bool     attitudeConnected; // updated on every AttitudeState update rather than periodically
 
 #ifdef USE_GIMBAL_LPF
     float attitudeFiltered[CAMERASTABSETTINGS_INPUT_NUMELEM];
@@ -78,9 +81,10 @@ static struct CameraStab_data {
 
 // Private functions
 static void attitudeUpdated(UAVObjEvent *ev);
+static void settingsUpdated(UAVObjEvent *ev);
 
 #ifdef USE_GIMBAL_FF
-static void applyFeedForward(uint8_t index, float dT, float *attitude, CameraStabSettingsData *cameraStab);
+static void applyFeedForward(uint8_t index, float dT, float *attitude, const CameraStabSettingsData *cameraStab);
 #endif
 
 
@@ -116,12 +120,16 @@ int32_t CameraStabInitialize(void)
 
         // initialize camera state variables
         memset(csd, 0, sizeof(struct CameraStab_data));
-        csd->lastSysTime = xTaskGetTickCount();
+        csd->lastSysTime = PIOS_DELAY_GetRaw();
 
         AttitudeStateInitialize();
+        GyroStateInitialize();
         CameraStabSettingsInitialize();
         CameraDesiredInitialize();
 
+        CameraStabSettingsConnectCallback(settingsUpdated);
+        settingsUpdated(NULL);
+
         UAVObjEvent ev = {
             .obj    = AttitudeStateHandle(),
             .instId = 0,
@@ -144,24 +152,53 @@ int32_t CameraStabStart(void)
 
 MODULE_INITCALL(CameraStabInitialize, CameraStabStart);
 
+static void settingsUpdated(__attribute__((unused)) UAVObjEvent *ev)
+{
+    CameraStabSettingsGet(&csd->settings);
+
+    // in AttitudeUpdate mode the outputs follow the attitude estimation rate, and the
+    // actuator picks them up at its next cycle
+    bool attitudeMode = (csd->settings.UpdateMode == CAMERASTABSETTINGS_UPDATEMODE_ATTITUDEUPDATE);
+    if (attitudeMode && !csd->attitudeConnected) {
+        AttitudeStateConnectCallback(attitudeUpdated);
+    } else if (!attitudeMode && csd->attitudeConnected) {
+        UAVObjDisconnectCallback(AttitudeStateHandle(), attitudeUpdated);
+    }
+    csd->attitudeConnected = attitudeMode;
+}
+
 static void attitudeUpdated(UAVObjEvent *ev)
 {
     if (ev->obj != AttitudeStateHandle()) {
         return;
     }
+    // the periodic callback has no event, it is idle while the outputs follow the attitude updates
+    if (csd->attitudeConnected && !ev->event) {
+        return;
+    }
 
     AccessoryDesiredData accessory;
 
-    CameraStabSettingsData cameraStab;
-    CameraStabSettingsGet(&cameraStab);
+    const CameraStabSettingsData *cameraStab = &csd->settings;
 
     // check how long since last update, time delta between calls in ms
-    portTickType thisSysTime = xTaskGetTickCount();
-    float dT_millis = (thisSysTime > csd->lastSysTime) ?
-                      (float)((thisSysTime - csd->lastSysTime) * portTICK_RATE_MS) :
-                      (float)SAMPLE_PERIOD_MS;
+    uint32_t thisSysTime = PIOS_DELAY_GetRaw();
+    float dT_millis = (float)PIOS_DELAY_DiffuS2(csd->lastSysTime, thisSysTime) * 0.001f;
+    if (dT_millis <= 0.0f || dT_millis > 10.0f * SAMPLE_PERIOD_MS) {
+        dT_millis = (float)SAMPLE_PERIOD_MS;
+    }
     csd->lastSysTime = thisSysTime;
 
+    // rates to lead the attitude with, the gimbal then moves ahead of the frame instead of lagging behind it
+    float gyroRates[CAMERASTABSETTINGS_INPUT_NUMELEM] = { 0.0f };
+    if (cameraStab->GyroFeedForward.Roll || cameraStab->GyroFeedForward.Pitch || cameraStab->GyroFeedForward.Yaw) {
+        GyroStateData gyro;
+        GyroStateGet(&gyro);
+        gyroRates[CAMERASTABSETTINGS_INPUT_ROLL]  = gyro.x;
+        gyroRates[CAMERASTABSETTINGS_INPUT_PITCH] = gyro.y;
+        gyroRates[CAMERASTABSETTINGS_INPUT_YAW]   = gyro.z;
+    }
+
     // storage for elevon roll component before the pitch component has been generated
     // we are guaranteed that the iteration order of i is roll pitch yaw
     // that guarnteees this won't be used uninited, but the compiler doesn't know that
@@ -171,22 +208,22 @@ static void attitudeUpdated(UAVObjEvent *ev)
     // process axes
     for (uint8_t i = 0; i < CAMERASTABSETTINGS_INPUT_NUMELEM; i++) {
         // read and process control input
-        if (CameraStabSettingsInputToArray(cameraStab.Input)[i] != CAMERASTABSETTINGS_INPUT_NONE) {
-            if (AccessoryDesiredInstGet(CameraStabSettingsInputToArray(cameraStab.Input)[i] -
+        if (CameraStabSettingsInputToArray(cameraStab->Input)[i] != CAMERASTABSETTINGS_INPUT_NONE) {
+            if (AccessoryDesiredInstGet(CameraStabSettingsInputToArray(cameraStab->Input)[i] -
                                         CAMERASTABSETTINGS_INPUT_ACCESSORY0, &accessory) == 0) {
                 float input_rate;
-                switch (CameraStabSettingsStabilizationModeToArray(cameraStab.StabilizationMode)[i]) {
+                switch (CameraStabSettingsStabilizationModeToArray(cameraStab->StabilizationMode)[i]) {
                 case CAMERASTABSETTINGS_STABILIZATIONMODE_ATTITUDE:
                     csd->inputs[i] = accessory.AccessoryVal *
-                                     CameraStabSettingsInputRangeToArray(cameraStab.InputRange)[i];
+                                     CameraStabSettingsInputRangeToArray(cameraStab->InputRange)[i];
                     break;
                 case CAMERASTABSETTINGS_STABILIZATIONMODE_AXISLOCK:
                     input_rate = accessory.AccessoryVal *
-                                 CameraStabSettingsInputRateToArray(cameraStab.InputRate)[i];
-                    if (fabsf(input_rate) > cameraStab.MaxAxisLockRate) {
+                                 CameraStabSettingsInputRateToArray(cameraStab->InputRate)[i];
+                    if (fabsf(input_rate) > cameraStab->MaxAxisLockRate) {
                         csd->inputs[i] = boundf(csd->inputs[i] + input_rate * 0.001f * dT_millis,
-                                                -CameraStabSettingsInputRangeToArray(cameraStab.InputRange)[i],
-                                                CameraStabSettingsInputRangeToArray(cameraStab.InputRange)[i]);
+                                                -CameraStabSettingsInputRangeToArray(cameraStab->InputRange)[i],
+                                                CameraStabSettingsInputRangeToArray(cameraStab->InputRange)[i]);
                     }
                     break;
                 default:
@@ -212,30 +249,33 @@ static void attitudeUpdated(UAVObjEvent *ev)
             PIOS_Assert(0);
         }
 
+        // where the frame will be by the time the servo moves
+        attitude += gyroRates[i] * (float)CameraStabSettingsGyroFeedForwardToArray(cameraStab->GyroFeedForward)[i] * 0.001f;
+
 #ifdef USE_GIMBAL_LPF
-        if (CameraStabSettingsResponseTimeToArray(cameraStab.ResponseTime)[i]) {
-            float rt = (float)CameraStabSettingsResponseTimeToArray(cameraStab.ResponseTime)[i];
+        if (CameraStabSettingsResponseTimeToArray(cameraStab->ResponseTime)[i]) {
+            float rt = (float)CameraStabSettingsResponseTimeToArray(cameraStab->ResponseTime)[i];
             attitude = csd->attitudeFiltered[i] = ((rt * csd->attitudeFiltered[i]) + (dT_millis * attitude)) / (rt + dT_millis);
         }
 #endif
 
 #ifdef USE_GIMBAL_FF
-        if (CameraStabSettingsFeedForwardToArray(cameraStab.FeedForward)[i]) {
-            applyFeedForward(i, dT_millis, &attitude, &cameraStab);
+        if (CameraStabSettingsFeedForwardToArray(cameraStab->FeedForward)[i]) {
+            applyFeedForward(i, dT_millis, &attitude, cameraStab);
         }
 #endif
 
         // bounding for elevon mixing occurs on the unmixed output
         // to limit the range of the mixed output you must limit the range
         // of both the unmixed pitch and unmixed roll
-        float output = boundf((attitude + csd->inputs[i]) / CameraStabSettingsOutputRangeToArray(cameraStab.OutputRange)[i], -1.0f, 1.0f);
+        float output = boundf((attitude + csd->inputs[i]) / CameraStabSettingsOutputRangeToArray(cameraStab->OutputRange)[i], -1.0f, 1.0f);
 
         // set output channels
         switch (i) {
         case CAMERASTABSETTINGS_INPUT_ROLL:
             // we are guaranteed that the iteration order of i is roll pitch yaw
             // for elevon mixing we simply grab the value for later use
-            if (cameraStab.GimbalType == CAMERASTABSETTINGS_GIMBALTYPE_ROLLPITCHMIXED) {
+            if (cameraStab->GimbalType == CAMERASTABSETTINGS_GIMBALTYPE_ROLLPITCHMIXED) {
                 elevon_roll = output;
             } else {
                 CameraDesiredRollOrServo1Set(&output);
@@ -244,14 +284,14 @@ static void attitudeUpdated(UAVObjEvent *ev)
         case CAMERASTABSETTINGS_INPUT_PITCH:
             // we are guaranteed that the iteration order of i is roll pitch yaw
             // for elevon mixing we use the value we previously grabbed and set both s1 and s2
-            if (cameraStab.GimbalType == CAMERASTABSETTINGS_GIMBALTYPE_ROLLPITCHMIXED) {
+            if (cameraStab->GimbalType == CAMERASTABSETTINGS_GIMBALTYPE_ROLLPITCHMIXED) {
                 float elevon_pitch = output;
                 // elevon reversing works like this:
                 // first use the normal reversing facilities to get servo 1 roll working in the correct direction
                 // then use the normal reversing facilities to get servo 2 roll working in the correct direction
                 // then use these new reversing switches to reverse servo 1 and/or 2 pitch as needed
                 // if servo 1 pitch is reversed
-                if (cameraStab.Servo1PitchReverse == CAMERASTABSETTINGS_SERVO1PITCHREVERSE_TRUE) {
+                if (cameraStab->Servo1PitchReverse == CAMERASTABSETTINGS_SERVO1PITCHREVERSE_TRUE) {
                     // use (reversed pitch) + roll
                     output = ((1.0f - elevon_pitch) + elevon_roll) / 2.0f;
                 } else {
@@ -260,7 +300,7 @@ static void attitudeUpdated(UAVObjEvent *ev)
                 }
                 CameraDesiredRollOrServo1Set(&output);
                 // if servo 2 pitch is reversed
-                if (cameraStab.Servo2PitchReverse == CAMERASTABSETTINGS_SERVO2PITCHREVERSE_TRUE) {
+                if (cameraStab->Servo2PitchReverse == CAMERASTABSETTINGS_SERVO2PITCHREVERSE_TRUE) {
                     // use (reversed pitch) - roll
                     output = ((1.0f - elevon_pitch) - elevon_roll) / 2.0f;
                 } else {
@@ -282,7 +322,7 @@ static void attitudeUpdated(UAVObjEvent *ev)
 }
 
 #ifdef USE_GIMBAL_FF
-void applyFeedForward(uint8_t index, float dT_millis, float *attitude, CameraStabSettingsData *cameraStab)
+void applyFeedForward(uint8_t index, float dT_millis, float *attitude, const CameraStabSettingsData *cameraStab)
 {
     // compensate high feed forward values depending on gimbal type
     float gimbalTypeCorrection = 1.0f;
@@ -36,6 +36,20 @@
 #define TYPE_FLOAT32 6
 #define TYPE_ENUM 7
 
+// Last object looked up, scripts usually read and write the same objects in a loop
+static uint32_t cachedObjId;
+static UAVObjHandle cachedObjHandle;
+
+static UAVObjHandle getObjHandle(uint32_t objId)
+{
+	if (!cachedObjHandle || objId != cachedObjId)
+	{
+		cachedObjHandle = UAVObjGetByID(objId);
+		cachedObjId = objId;
+	}
+	return cachedObjHandle;
+}
+
 """
 
 from list import append
@@ -159,6 +173,9 @@ class UAVObject:
 		pPmObj_t field;
 		pPmObj_t fields;
 		pPmObj_t fieldName;
+		pPmObj_t nameFtype;
+		pPmObj_t nameNumElements;
+		pPmObj_t nameValue;
 		pPmObj_t value;
 		PmReturn_t retval;
 		uint32_t numFields;
@@ -189,7 +206,7 @@ class UAVObject:
 		instId = ((pPmInt_t) field)->val;    
 		
 		// Get handle and number of bytes in the object
-		objHandle = UAVObjGetByID(objId);
+		objHandle = getObjHandle(objId);
 		numBytes = UAVObjGetNumBytes(objHandle);
 		uint8_t data[numBytes];
 		
@@ -202,6 +219,15 @@ class UAVObject:
 		retval = dict_getItem(attrs, fieldName, &fields); PM_RETURN_IF_ERROR(retval);
 		numFields = ((pPmList_t) fields)->length;    
 
+		// Look up the field attribute names once, they are the cached twins
+		// of the keys of the field dictionaries so they stay alive during the call
+		tmpStr = (uint8_t const *)"ftype";
+		retval = string_new(&tmpStr, &nameFtype); PM_RETURN_IF_ERROR(retval);
+		tmpStr = (uint8_t const *)"numElements";
+		retval = string_new(&tmpStr, &nameNumElements); PM_RETURN_IF_ERROR(retval);
+		tmpStr = (uint8_t const *)"value";
+		retval = string_new(&tmpStr, &nameValue); PM_RETURN_IF_ERROR(retval);
+
 		// Process each field
 		dataIdx = 0;
 		for (fieldIdx = 0; fieldIdx < numFields; ++fieldIdx)
@@ -210,19 +236,13 @@ class UAVObject:
 			retval = list_getItem(fields, fieldIdx, &field); PM_RETURN_IF_ERROR(retval);
 			attrs = (pPmObj_t)((pPmInstance_t)field)->cli_attrs;
 			// Get type
-			tmpStr = (uint8_t const *)"ftype";
-			retval = string_new(&tmpStr, &fieldName); PM_RETURN_IF_ERROR(retval); 
-			retval = dict_getItem(attrs, fieldName, &field); PM_RETURN_IF_ERROR(retval);
+			retval = dict_getItem(attrs, nameFtype, &field); PM_RETURN_IF_ERROR(retval);
 			type = ((pPmInt_t) field)->val;   
 			// Get number of elements
-			tmpStr = (uint8_t const *)"numElements";
-			retval = string_new(&tmpStr, &fieldName); PM_RETURN_IF_ERROR(retval); 
-			retval = dict_getItem(attrs, fieldName, &field); PM_RETURN_IF_ERROR(retval);
+			retval = dict_getItem(attrs, nameNumElements, &field); PM_RETURN_IF_ERROR(retval);
 			numElements = ((pPmInt_t) field)->val;
 			// Get value
-			tmpStr = (uint8_t const *)"value";
-			retval = string_new(&tmpStr, &fieldName); PM_RETURN_IF_ERROR(retval); 
-			retval = dict_getItem(attrs, fieldName, &field); PM_RETURN_IF_ERROR(retval); 
+			retval = dict_getItem(attrs, nameValue, &field); PM_RETURN_IF_ERROR(retval); 
 			// Set value for each element
 			for (valueIdx = 0; valueIdx < numElements; ++valueIdx)
 			{		
@@ -260,9 +280,7 @@ class UAVObject:
 				}
 				else
 				{
-					tmpStr = (uint8_t const *)"value";
-					retval = string_new(&tmpStr, &fieldName); PM_RETURN_IF_ERROR(retval); 
-					retval = dict_setItem(attrs, fieldName, value); PM_RETURN_IF_ERROR(retval); 
+					retval = dict_setItem(attrs, nameValue, value); PM_RETURN_IF_ERROR(retval); 
 				}
 			}
 		}
@@ -283,6 +301,9 @@ class UAVObject:
 		pPmObj_t field;
 		pPmObj_t fields;
 		pPmObj_t fieldName;
+		pPmObj_t nameFtype;
+		pPmObj_t nameNumElements;
+		pPmObj_t nameValue;
 		pPmObj_t value;
 		PmReturn_t retval;
 		uint32_t numFields;
@@ -314,7 +335,7 @@ class UAVObject:
 		instId = ((pPmInt_t) field)->val;    
 		
 		// Get handle and number of bytes in the object
-		objHandle = UAVObjGetByID(objId);
+		objHandle = getObjHandle(objId);
 		numBytes = UAVObjGetNumBytes(objHandle);
 		uint8_t data[numBytes];
 			
@@ -324,6 +345,15 @@ class UAVObject:
 		retval = dict_getItem(attrs, fieldName, &fields); PM_RETURN_IF_ERROR(retval);
 		numFields = ((pPmList_t) fields)->length;    
 
+		// Look up the field attribute names once, they are the cached twins
+		// of the keys of the field dictionaries so they stay alive during the call
+		tmpStr = (uint8_t const *)"ftype";
+		retval = string_new(&tmpStr, &nameFtype); PM_RETURN_IF_ERROR(retval);
+		tmpStr = (uint8_t const *)"numElements";
+		retval = string_new(&tmpStr, &nameNumElements); PM_RETURN_IF_ERROR(retval);
+		tmpStr = (uint8_t const *)"value";
+		retval = string_new(&tmpStr, &nameValue); PM_RETURN_IF_ERROR(retval);
+
 		// Process each field
 		dataIdx = 0;
 		for (fieldIdx = 0; fieldIdx < numFields; ++fieldIdx)
@@ -332,19 +362,13 @@ class UAVObject:
 			retval = list_getItem(fields, fieldIdx, &field); PM_RETURN_IF_ERROR(retval);
 			attrs = (pPmObj_t)((pPmInstance_t)field)->cli_attrs;
 			// Get type
-			tmpStr = (uint8_t const *)"ftype";
-			retval = string_new(&tmpStr, &fieldName); PM_RETURN_IF_ERROR(retval); 
-			retval = dict_getItem(attrs, fieldName, &field); PM_RETURN_IF_ERROR(retval);
+			retval = dict_getItem(attrs, nameFtype, &field); PM_RETURN_IF_ERROR(retval);
 			type = ((pPmInt_t) field)->val;   
 			// Get number of elements
-			tmpStr = (uint8_t const *)"numElements";
-			retval = string_new(&tmpStr, &fieldName); PM_RETURN_IF_ERROR(retval); 
-			retval = dict_getItem(attrs, fieldName, &field); PM_RETURN_IF_ERROR(retval);
+			retval = dict_getItem(attrs, nameNumElements, &field); PM_RETURN_IF_ERROR(retval);
 			numElements = ((pPmInt_t) field)->val;
 			// Get value
-			tmpStr = (uint8_t const *)"value";
-			retval = string_new(&tmpStr, &fieldName); PM_RETURN_IF_ERROR(retval); 
-			retval = dict_getItem(attrs, fieldName, &field); PM_RETURN_IF_ERROR(retval); 
+			retval = dict_getItem(attrs, nameValue, &field); PM_RETURN_IF_ERROR(retval); 
 			// Set value for each element
 			for (valueIdx = 0; valueIdx < numElements; ++valueIdx)
 			{
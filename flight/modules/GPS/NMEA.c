@@ -75,6 +75,8 @@ static bool nmeaProcessGxGSA(GPSPositionSensorData *GpsData, bool *gpsDataUpdate
 static bool nmeaProcessGxZDA(GPSPositionSensorData *GpsData, bool *gpsDataUpdated, char *param[], uint8_t nbParam);
 static bool nmeaProcessGxGSV(GPSPositionSensorData *GpsData, bool *gpsDataUpdated, char *param[], uint8_t nbParam);
 #endif // PIOS_GPS_MINIMAL
+static bool NMEA_process_params(char *params[], uint8_t nbParams, GPSPositionSensorData *GpsData);
+static bool NMEA_checksum_matches(const char *marker, uint8_t checksum_computed);
 
 static const struct nmea_parser nmea_parsers[] = {
     {
@@ -111,6 +113,12 @@ int parse_nmea_stream(uint8_t *rx, uint8_t len, char *gps_rx_buffer, GPSPosition
     static uint8_t rx_count = 0;
     static bool start_flag  = false;
     static bool found_cr    = false;
+    // The checksum and the field boundaries are tracked while the sentence is received,
+    // so a complete sentence doesn't have to be scanned again.
+    static uint8_t checksum = 0;
+    static uint8_t star_pos = 0; // position of the '*' checksum marker, 0 while not found
+    static uint8_t nb_fields = 0;
+    static uint8_t field_pos[MAX_NB_PARAMS]; // position of the first character of each field
     uint8_t c;
 
     for (int i = 0; i < len; i++) {
@@ -120,6 +128,11 @@ int parse_nmea_stream(uint8_t *rx, uint8_t len, char *gps_rx_buffer, GPSPosition
             start_flag = true;
             found_cr   = false;
             rx_count   = 0;
+            checksum   = 0;
+            star_pos   = 0;
+            // The first field is the message name, skip the '$' and the talker ID (GP, GL, GN...)
+            field_pos[0] = 3;
+            nb_fields  = 1;
         } else if (!start_flag) {
             return PARSER_ERROR;
         }
@@ -134,6 +147,16 @@ int parse_nmea_stream(uint8_t *rx, uint8_t len, char *gps_rx_buffer, GPSPosition
             ret = PARSER_OVERRUN;
         } else {
             gps_rx_buffer[rx_count] = c;
+            if ((rx_count > 0) && (star_pos == 0)) {
+                if (c == '*') {
+                    star_pos = rx_count;
+                } else {
+                    checksum ^= c;
+                    if ((c == ',') && (nb_fields < MAX_NB_PARAMS)) {
+                        field_pos[nb_fields++] = rx_count + 1;
+                    }
+                }
+            }
             rx_count++;
         }
 
@@ -154,19 +177,31 @@ int parse_nmea_stream(uint8_t *rx, uint8_t len, char *gps_rx_buffer, GPSPosition
             // Our rxBuffer must look like this now:
             // [0]           = '$'
             // ...           = zero or more bytes of sentence payload
-            // [end_pos - 1] = '\r'
-            // [end_pos]     = '\n'
+            // [star_pos]    = '*'
+            // ...           = checksum and terminating zero
             //
             // Prepare to consume the sentence from the buffer
 
             // Validate the checksum over the sentence
-            if (!NMEA_checksum(&gps_rx_buffer[1])) { // Invalid checksum.  May indicate dropped characters on Rx.
-                                                     // PIOS_DEBUG_PinHigh(2);
+            if (!NMEA_checksum_matches(&gps_rx_buffer[star_pos], checksum) || (star_pos < field_pos[0])) {
+                // Invalid checksum.  May indicate dropped characters on Rx.
+                // PIOS_DEBUG_PinHigh(2);
                 gpsRxStats->gpsRxChkSumError++;
                 // PIOS_DEBUG_PinLow(2);
                 ret = PARSER_ERROR;
             } else { // Valid checksum, use this packet to update the GPS position
-                if (!NMEA_update_position(&gps_rx_buffer[1], GpsData)) {
+                char *params[MAX_NB_PARAMS];
+
+                // Terminate the fields in place
+                gps_rx_buffer[star_pos] = 0;
+                for (uint8_t f = 0; f < nb_fields; f++) {
+                    params[f] = &gps_rx_buffer[field_pos[f]];
+                    if (f > 0) {
+                        gps_rx_buffer[field_pos[f] - 1] = 0;
+                    }
+                }
+
+                if (!NMEA_process_params(params, nb_fields, GpsData)) {
                     // PIOS_DEBUG_PinHigh(2);
                     gpsRxStats->gpsRxParserError++;
                     // PIOS_DEBUG_PinLow(2);
@@ -190,8 +225,9 @@ static const struct nmea_parser *NMEA_find_parser_by_prefix(const char *prefix)
     for (uint8_t i = 0; i < NELEMENTS(nmea_parsers); i++) {
         const struct nmea_parser *parser = &nmea_parsers[i];
 
-        /* Use strcmp to check for exact equality over the entire prefix */
-        if (!strcmp(prefix, parser->prefix)) {
+        /* All prefixes are three characters, check for exact equality over the entire prefix */
+        if ((prefix[0] == parser->prefix[0]) && (prefix[1] == parser->prefix[1]) &&
+            (prefix[2] == parser->prefix[2]) && (prefix[3] == '\0')) {
             /* Found an appropriate parser */
             return parser;
         }
@@ -201,6 +237,36 @@ static const struct nmea_parser *NMEA_find_parser_by_prefix(const char *prefix)
     return NULL;
 }
 
+/**
+ * Compares the checksum following a '*' marker with a computed checksum
+ * \param[in] Buffer pointing at the '*' marker, 0 terminated
+ * \param[in] The checksum computed over the sentence
+ * \return true if there is a checksum and it matches
+ */
+static bool NMEA_checksum_matches(const char *marker, uint8_t checksum_computed)
+{
+    uint8_t checksum_received = 0;
+    uint8_t digits = 0;
+
+    if (*marker++ != '*') {
+        return false;
+    }
+    for (; digits < 2; digits++, marker++) {
+        char c = *marker;
+        if (c >= '0' && c <= '9') {
+            checksum_received = (checksum_received << 4) | (c - '0');
+        } else if (c >= 'A' && c <= 'F') {
+            checksum_received = (checksum_received << 4) | (c - 'A' + 10);
+        } else if (c >= 'a' && c <= 'f') {
+            checksum_received = (checksum_received << 4) | (c - 'a' + 10);
+        } else {
+            break;
+        }
+    }
+
+    return (digits > 0) && (checksum_computed == checksum_received);
+}
+
 /**
  * Computes NMEA sentence checksum
  * \param[in] Buffer for parsed nmea sentence
@@ -210,25 +276,14 @@ static const struct nmea_parser *NMEA_find_parser_by_prefix(const char *prefix)
 bool NMEA_checksum(char *nmea_sentence)
 {
     uint8_t checksum_computed = 0;
-    uint8_t checksum_received;
 
     while (*nmea_sentence != '\0' && *nmea_sentence != '*') {
         checksum_computed ^= *nmea_sentence;
         nmea_sentence++;
     }
 
-    /* Make sure we're now pointing at the checksum */
-    if (*nmea_sentence == '\0') {
-        /* Buffer ran out before we found a checksum marker */
-        return false;
-    }
-
-    /* Load the checksum from the buffer */
-    checksum_received = strtol(nmea_sentence + 1, NULL, 16);
-
-    // PIOS_COM_SendFormattedStringNonBlocking(COM_DEBUG_USART,"$%d=%d\r\n",checksum_received,checksum_computed);
-
-    return checksum_computed == checksum_received;
+    /* Make sure we're now pointing at the checksum, the buffer may have run out before a checksum marker */
+    return NMEA_checksum_matches(nmea_sentence, checksum_computed);
 }
 
 /*
@@ -243,38 +298,49 @@ bool NMEA_checksum(char *nmea_sentence)
  * into a signed whole part and an unsigned fractional part.
  * The fract_units field indicates the units of the fractional part as
  *   1 whole = 10^fract_units fract
+ * Fractional digits beyond the ninth are ignored.
  */
-static bool NMEA_parse_real(int32_t *whole, uint32_t *fract, uint8_t *fract_units, char *field)
+static bool NMEA_parse_real(int32_t *whole, uint32_t *fract, uint8_t *fract_units, const char *field)
 {
-    char *s = field;
-    char *field_w;
-    char *field_f;
+    bool negative = false;
+    int32_t num_w = 0;
+    uint32_t num_f = 0;
+    uint8_t units  = 0;
 
     PIOS_DEBUG_Assert(whole);
     PIOS_DEBUG_Assert(fract);
     PIOS_DEBUG_Assert(fract_units);
     PIOS_DEBUG_Assert(field);
 
-    field_w = strsep(&s, ".");
-    field_f = s;
-
-    *whole  = strtol(field_w, NULL, 10);
-
-    if (field_w) {
+    if (*field == '-') {
+        negative = true;
+        field++;
+    }
+    while (*field >= '0' && *field <= '9') {
+        num_w = num_w * 10 + (*field++ - '0');
+    }
+    if (*field == '.') {
         /* decimal was found so we may have a fractional part */
-        *fract = strtoul(field_f, NULL, 10);
-        *fract_units = strlen(field_f);
-    } else {
-        /* no decimal was found, fractional part is zero */
-        *fract = 0;
-        *fract_units = 0;
+        field++;
+        while (*field >= '0' && *field <= '9') {
+            if (units < 9) {
+                num_f = num_f * 10 + (*field - '0');
+                units++;
+            }
+            field++;
+        }
     }
 
+    *whole = negative ? -num_w : num_w;
+    *fract = num_f;
+    *fract_units = units;
+
     return true;
 }
 
 static float NMEA_real_to_float(char *nmea_real)
 {
+    static const float fract_scale[10] = { 1e0f, 1e-1f, 1e-2f, 1e-3f, 1e-4f, 1e-5f, 1e-6f, 1e-7f, 1e-8f, 1e-9f };
     int32_t whole;
     uint32_t fract;
     uint8_t fract_units;
@@ -283,8 +349,24 @@ static float NMEA_real_to_float(char *nmea_real)
         return false;
     }
 
-    /* Convert to float */
-    return ((float)whole) + fract * powf(10.0f, -fract_units);
+    /* Convert to float, the fractional part carries the sign of the number */
+    float fract_value = fract * fract_scale[fract_units];
+    return (*nmea_real == '-') ? ((float)whole) - fract_value : ((float)whole) + fract_value;
+}
+
+/* Parse a decimal integer, without the overhead of atoi()/strtol() */
+static int32_t NMEA_parse_int(const char *field)
+{
+    bool negative = (*field == '-');
+    int32_t value = 0;
+
+    if (negative) {
+        field++;
+    }
+    while (*field >= '0' && *field <= '9') {
+        value = value * 10 + (*field++ - '0');
+    }
+    return negative ? -value : value;
 }
 
 /*
@@ -402,6 +484,17 @@ bool NMEA_update_position(char *nmea_sentence, GPSPositionSensorData *GpsData)
     }
 #endif
 
+    return NMEA_process_params(params, nbParams, GpsData);
+}
+
+/**
+ * Dispatches the fields of an NMEA sentence to its parser and updates the GPSPositionSensor UAVObject
+ * \param[in] The zero terminated fields of the sentence, the first one is the message name
+ * \return true if the sentence was successfully parsed
+ * \return false if any errors were encountered with the parsing
+ */
+static bool NMEA_process_params(char *params[], uint8_t nbParams, GPSPositionSensorData *GpsData)
+{
     // The first parameter is the message name, lets see if we find a parser for it
     const struct nmea_parser *parser;
     parser = NMEA_find_parser_by_prefix(params[0]);
@@ -492,7 +585,7 @@ static bool nmeaProcessGxGGA(GPSPositionSensorData *GpsData, bool *gpsDataUpdate
     }
 
     // get number of satellites used in GPS solution
-    GpsData->Satellites = atoi(param[7]);
+    GpsData->Satellites = NMEA_parse_int(param[7]);
 
     // get altitude (in meters mm.m)
     GpsData->Altitude   = NMEA_real_to_float(param[9]);
@@ -625,9 +718,9 @@ static bool nmeaProcessGxZDA(__attribute__((unused)) GPSPositionSensorData *GpsD
     gpst.Hour   = (int)hms / 10000;
 
     // Get Date
-    gpst.Day    = atoi(param[2]);
-    gpst.Month  = atoi(param[3]);
-    gpst.Year   = atoi(param[4]);
+    gpst.Day    = NMEA_parse_int(param[2]);
+    gpst.Month  = NMEA_parse_int(param[3]);
+    gpst.Year   = NMEA_parse_int(param[4]);
 
     GPSTimeSet(&gpst);
     return true;
@@ -652,8 +745,8 @@ static bool nmeaProcessGxGSV(__attribute__((unused)) GPSPositionSensorData *GpsD
     DEBUG_MSG(" Sats=%s\n", param[3]);
 #endif
 
-    uint8_t nbSentences  = atoi(param[1]);
-    uint8_t currSentence = atoi(param[2]);
+    uint8_t nbSentences  = NMEA_parse_int(param[1]);
+    uint8_t currSentence = NMEA_parse_int(param[2]);
 
     *gpsDataUpdated = false;
 
@@ -661,7 +754,7 @@ static bool nmeaProcessGxGSV(__attribute__((unused)) GPSPositionSensorData *GpsD
         return false;
     }
 
-    gsv_partial.SatsInView = atoi(param[3]);
+    gsv_partial.SatsInView = NMEA_parse_int(param[3]);
 
     // Find out if this is the first sentence in the GSV set
     if (currSentence == 1) {
@@ -696,10 +789,10 @@ static bool nmeaProcessGxGSV(__attribute__((unused)) GPSPositionSensorData *GpsD
             uint8_t sat_index = ((currSentence - 1) * 4) + i;
 
             // Get sat info
-            gsv_partial.PRN[sat_index]       = atoi(param[parIdx++]);
-            gsv_partial.Elevation[sat_index] = atoi(param[parIdx++]);
-            gsv_partial.Azimuth[sat_index]   = atoi(param[parIdx++]);
-            gsv_partial.SNR[sat_index]       = atoi(param[parIdx++]);
+            gsv_partial.PRN[sat_index]       = NMEA_parse_int(param[parIdx++]);
+            gsv_partial.Elevation[sat_index] = NMEA_parse_int(param[parIdx++]);
+            gsv_partial.Azimuth[sat_index]   = NMEA_parse_int(param[parIdx++]);
+            gsv_partial.SNR[sat_index]       = NMEA_parse_int(param[parIdx++]);
 #ifdef NMEA_DEBUG_GSV
             DEBUG_MSG(" %d", gsv_partial.PRN[sat_index]);
 #endif
@@ -743,7 +836,7 @@ static bool nmeaProcessGxGSA(GPSPositionSensorData *GpsData, bool *gpsDataUpdate
 
     *gpsDataUpdated = false;
 
-    switch (atoi(param[2])) {
+    switch (NMEA_parse_int(param[2])) {
     case 1:
         GpsData->Status = GPSPOSITIONSENSOR_STATUS_NOFIX;
         break;
@@ -218,6 +218,8 @@ int parse_ubx_stream(uint8_t *rx, uint8_t len, char *gps_rx_buffer, GPSPositionS
 static struct msgtracker {
     uint32_t currentTOW; // TOW of the message set currently in progress
     uint8_t  msg_received;   // keep track of received message types
+    bool     velocity_valid; // velocity holds a solution for this message set
+    GPSVelocitySensorData velocity; // published together with the position once the set is complete
 } msgtracker;
 
 // Check if a message belongs to the current data set and register it as 'received'
@@ -225,8 +227,9 @@ bool check_msgtracker(uint32_t tow, uint8_t msg_flag)
 {
     if (tow > msgtracker.currentTOW ? true // start of a new message set
         : (msgtracker.currentTOW - tow > 6 * 24 * 3600 * 1000)) { // 6 days, TOW wrap around occured
-        msgtracker.currentTOW   = tow;
-        msgtracker.msg_received = NONE_RECEIVED;
+        msgtracker.currentTOW     = tow;
+        msgtracker.msg_received   = NONE_RECEIVED;
+        msgtracker.velocity_valid = false;
     } else if (tow < msgtracker.currentTOW) { // message outdated (don't process)
         return false;
     }
@@ -323,14 +326,13 @@ static void parse_ubx_nav_velned(struct UBXPacket *ubx, GPSPositionSensorData *G
     if (usePvt) {
         return;
     }
-    GPSVelocitySensorData GpsVelocity;
     struct UBX_NAV_VELNED *velned = &ubx->payload.nav_velned;
     if (check_msgtracker(velned->iTOW, VELNED_RECEIVED)) {
         if (GpsPosition->Status != GPSPOSITIONSENSOR_STATUS_NOFIX) {
-            GpsVelocity.North        = (float)velned->velN / 100.0f;
-            GpsVelocity.East         = (float)velned->velE / 100.0f;
-            GpsVelocity.Down         = (float)velned->velD / 100.0f;
-            GPSVelocitySensorSet(&GpsVelocity);
+            msgtracker.velocity.North = (float)velned->velN / 100.0f;
+            msgtracker.velocity.East  = (float)velned->velE / 100.0f;
+            msgtracker.velocity.Down  = (float)velned->velD / 100.0f;
+            msgtracker.velocity_valid = true;
             GpsPosition->Groundspeed = (float)velned->gSpeed * 0.01f;
             GpsPosition->Heading     = (float)velned->heading * 1.0e-5f;
         }
@@ -341,14 +343,13 @@ static void parse_ubx_nav_pvt(struct UBXPacket *ubx, GPSPositionSensorData *GpsP
 {
     lastPvtTime = PIOS_DELAY_GetuS();
 
-    GPSVelocitySensorData GpsVelocity;
     struct UBX_NAV_PVT *pvt = &ubx->payload.nav_pvt;
     check_msgtracker(pvt->iTOW, (ALL_RECEIVED));
 
-    GpsVelocity.North = (float)pvt->velN * 0.001f;
-    GpsVelocity.East  = (float)pvt->velE * 0.001f;
-    GpsVelocity.Down  = (float)pvt->velD * 0.001f;
-    GPSVelocitySensorSet(&GpsVelocity);
+    msgtracker.velocity.North = (float)pvt->velN * 0.001f;
+    msgtracker.velocity.East  = (float)pvt->velE * 0.001f;
+    msgtracker.velocity.Down  = (float)pvt->velD * 0.001f;
+    msgtracker.velocity_valid = true;
 
     GpsPosition->Groundspeed     = (float)pvt->gSpeed * 0.001f;
     GpsPosition->Heading         = (float)pvt->heading * 1.0e-5f;
@@ -512,7 +513,12 @@ uint32_t parse_ubx_message(struct UBXPacket *ubx, GPSPositionSensorData *GpsPosi
     GpsPosition->SensorType = sensorType;
 
     if (msgtracker.msg_received == ALL_RECEIVED) {
+        // Publish the whole navigation solution of this epoch at once
         GPSPositionSensorSet(GpsPosition);
+        if (msgtracker.velocity_valid) {
+            GPSVelocitySensorSet(&msgtracker.velocity);
+            msgtracker.velocity_valid = false;
+        }
         msgtracker.msg_received = NONE_RECEIVED;
         id = GPSPOSITIONSENSOR_OBJID;
     } else {
@@ -36,6 +36,18 @@
 #include "debuglogstatus.h"
 #include "debuglogentry.h"
 #include "flightstatus.h"
+#include <callbackinfo.h>
+#ifdef PIOS_INCLUDE_INSTRUMENTATION
+#include <pios_instrumentation.h>
+#include <instrumentation.h>
+#endif
+
+// Private constants
+#define BLACKBOX_PERIOD_MS 10
+#define BULK_MIN_PERIOD_MS 1
+#define CALLBACK_PRIORITY  CALLBACK_PRIORITY_LOW
+#define CBTASK_PRIORITY    CALLBACK_TASK_AUXILIARY
+#define STACK_SIZE_BYTES   512
 
 // private variables
 static DebugLogSettingsData settings;
@@ -43,12 +55,26 @@ static DebugLogControlData control;
 static DebugLogStatusData status;
 static FlightStatusData flightstatus;
 static DebugLogEntryData *entry; // would be better on stack but event dispatcher stack might be insufficient
+static DebugLogEntryData *bulkEntry; // owned by the bulk sender, which runs in another task than the control callback
+static DelayedCallbackInfo *blackboxWriter;
+static DelayedCallbackInfo *bulkSender;
+
+// state of the bulk retrieve stream, active is written last so the sender never sees half a request
+static struct {
+    volatile bool active;
+    uint16_t flight;
+    uint16_t entry;
+    uint16_t remaining; // zero to stream until the end of the flight
+    uint8_t  period;
+} bulk;
 
 // private functions
 static void SettingsUpdatedCb(UAVObjEvent *ev);
 static void ControlUpdatedCb(UAVObjEvent *ev);
 static void StatusUpdatedCb(UAVObjEvent *ev);
 static void FlightStatusUpdatedCb(UAVObjEvent *ev);
+static void BlackboxWriterCb(void);
+static void BulkSenderCb(void);
 
 int32_t LoggingInitialize(void)
 {
@@ -58,8 +84,9 @@ int32_t LoggingInitialize(void)
     DebugLogEntryInitialize();
     FlightStatusInitialize();
     PIOS_DEBUGLOG_Initialize();
-    entry = pios_malloc(sizeof(DebugLogEntryData));
-    if (!entry) {
+    entry     = pios_malloc(sizeof(DebugLogEntryData));
+    bulkEntry = pios_malloc(sizeof(DebugLogEntryData));
+    if (!entry || !bulkEntry) {
         return -1;
     }
 
@@ -83,16 +110,61 @@ int32_t LoggingStart(void)
     // invoke a periodic dispatcher callback - the event struct is a dummy, it could be filled with anything!
     StatusUpdatedCb(&ev);
 
+    // stream the blackbox to flash from a low priority callback, boards without one don't need it
+    if (PIOS_DEBUGLOG_ProcessBlackbox() >= 0) {
+        blackboxWriter = PIOS_CALLBACKSCHEDULER_Create(&BlackboxWriterCb, CALLBACK_PRIORITY, CBTASK_PRIORITY, CALLBACKINFO_RUNNING_LOGGING0, STACK_SIZE_BYTES);
+        PIOS_CALLBACKSCHEDULER_Schedule(blackboxWriter, BLACKBOX_PERIOD_MS, CALLBACK_UPDATEMODE_NONE);
+    }
+    bulkSender = PIOS_CALLBACKSCHEDULER_Create(&BulkSenderCb, CALLBACK_PRIORITY, CBTASK_PRIORITY, CALLBACKINFO_RUNNING_LOGGING1, STACK_SIZE_BYTES);
+
     return 0;
 }
-MODULE_INITCALL(LoggingInitialize, LoggingStart);
+MODULE_INITCALL_DEFERRED(LoggingInitialize, LoggingStart);
 
 static void StatusUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
 {
     PIOS_DEBUGLOG_Info(&status.Flight, &status.Entry, &status.FreeSlots, &status.UsedSlots);
+    PIOS_DEBUGLOG_BlackboxInfo(&status.BlackboxUsed, &status.BlackboxFree, &status.BlackboxDropped);
     DebugLogStatusSet(&status);
 }
 
+static void BlackboxWriterCb(void)
+{
+    // write out one full buffer (or erase one sector) at a time, keep going while there is more
+    if (PIOS_DEBUGLOG_ProcessBlackbox() > 0) {
+        PIOS_CALLBACKSCHEDULER_Dispatch(blackboxWriter);
+    } else {
+        PIOS_CALLBACKSCHEDULER_Schedule(blackboxWriter, BLACKBOX_PERIOD_MS, CALLBACK_UPDATEMODE_NONE);
+    }
+}
+
+static void BulkSenderCb(void)
+{
+    if (!bulk.active) {
+        return;
+    }
+    memset(bulkEntry, 0, sizeof(DebugLogEntryData));
+    if (PIOS_DEBUGLOG_Read(bulkEntry, bulk.flight, bulk.entry) != 0) {
+        // past the last entry, tell the GCS where the flight ends
+        bulkEntry->Type = DEBUGLOGENTRY_TYPE_EMPTY;
+        bulk.active     = false;
+    }
+    // flight and entry are the sequence number the GCS sorts the stream by
+    bulkEntry->Flight = bulk.flight;
+    bulkEntry->Entry  = bulk.entry;
+    // pushed unacked, the GCS requests whatever got lost again
+    DebugLogEntrySet(bulkEntry);
+    DebugLogEntryUpdated();
+
+    bulk.entry++;
+    if (bulk.remaining && --bulk.remaining == 0) {
+        bulk.active = false;
+    }
+    if (bulk.active) {
+        PIOS_CALLBACKSCHEDULER_Schedule(bulkSender, bulk.period, CALLBACK_UPDATEMODE_NONE);
+    }
+}
+
 static void FlightStatusUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
 {
     FlightStatusGet(&flightstatus);
@@ -110,6 +182,7 @@ static void FlightStatusUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
 static void SettingsUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
 {
     DebugLogSettingsGet(&settings);
+    PIOS_DEBUGLOG_EnableBlackbox(settings.Blackbox == DEBUGLOGSETTINGS_BLACKBOX_ENABLED);
     if (settings.LoggingEnabled == DEBUGLOGSETTINGS_LOGGINGENABLED_ALWAYS) {
         PIOS_DEBUGLOG_Enable(1);
         PIOS_DEBUGLOG_Printf("On board logging enabled.");
@@ -124,7 +197,16 @@ static void SettingsUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
 static void ControlUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
 {
     DebugLogControlGet(&control);
-    if (control.Operation == DEBUGLOGCONTROL_OPERATION_RETRIEVE) {
+    // a new request always replaces a running stream
+    bulk.active = false;
+    if (control.Operation == DEBUGLOGCONTROL_OPERATION_BULKRETRIEVE) {
+        bulk.flight    = control.Flight;
+        bulk.entry     = control.Entry;
+        bulk.remaining = control.Count;
+        bulk.period    = control.Period < BULK_MIN_PERIOD_MS ? BULK_MIN_PERIOD_MS : control.Period;
+        bulk.active    = true;
+        PIOS_CALLBACKSCHEDULER_Dispatch(bulkSender);
+    } else if (control.Operation == DEBUGLOGCONTROL_OPERATION_RETRIEVE) {
         memset(entry, 0, sizeof(DebugLogEntryData));
         if (PIOS_DEBUGLOG_Read(entry, control.Flight, control.Entry) != 0) {
             // reading from log failed, mark as non existent in output
@@ -133,12 +215,36 @@ static void ControlUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
             entry->Type   = DEBUGLOGENTRY_TYPE_EMPTY;
         }
         DebugLogEntrySet(entry);
+    } else if (control.Operation == DEBUGLOGCONTROL_OPERATION_RETRIEVEBLACKBOX) {
+        uint32_t block = ((uint32_t)control.Flight << 16) | control.Entry;
+        memset(entry, 0xff, sizeof(DebugLogEntryData));
+        int32_t size   = PIOS_DEBUGLOG_ReadBlackbox(entry->Data, block * sizeof(entry->Data), sizeof(entry->Data));
+        entry->Flight  = control.Flight;
+        entry->Entry   = control.Entry;
+        entry->FlightTime = 0;
+        entry->ObjectID   = 0;
+        entry->InstanceID = 0;
+        if (size > 0) {
+            entry->Type = DEBUGLOGENTRY_TYPE_BLACKBOX;
+            entry->Size = size;
+        } else {
+            // past the end of the blackbox, or there is none
+            entry->Type = DEBUGLOGENTRY_TYPE_EMPTY;
+            entry->Size = 0;
+        }
+        DebugLogEntrySet(entry);
     } else if (control.Operation == DEBUGLOGCONTROL_OPERATION_FORMATFLASH) {
         uint8_t armed;
         FlightStatusArmedGet(&armed);
         if (armed == FLIGHTSTATUS_ARMED_DISARMED) {
             PIOS_DEBUGLOG_Format();
         }
+#ifdef PIOS_INCLUDE_INSTRUMENTATION
+    } else if (control.Operation == DEBUGLOGCONTROL_OPERATION_STARTTRACE) {
+        PIOS_Instrumentation_EnableTrace(true);
+    } else if (control.Operation == DEBUGLOGCONTROL_OPERATION_DUMPTRACE) {
+        InstrumentationDumpTrace();
+#endif
     }
     StatusUpdatedCb(ev);
 }
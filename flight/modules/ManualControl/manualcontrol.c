@@ -108,10 +108,17 @@ static float thrustHi = 0.0f;
 #endif /* ifndef PIOS_EXCLUDE_ADVANCED_FEATURES */
 // Private variables
 static DelayedCallbackInfo *callbackHandle;
+// settings are read again only after they changed
+static FlightModeSettingsData flightModeSettings;
+#ifndef PIOS_EXCLUDE_ADVANCED_FEATURES
+static VtolPathFollowerSettingsThrustLimitsData thrustLimits;
+#endif
+static volatile bool settingsUpdated = true;
 
 // Private functions
 static void configurationUpdatedCb(UAVObjEvent *ev);
 static void commandUpdatedCb(UAVObjEvent *ev);
+static void settingsUpdatedCb(UAVObjEvent *ev);
 static void manualControlTask(void);
 #ifndef PIOS_EXCLUDE_ADVANCED_FEATURES
 static uint8_t isAssistedFlightMode(uint8_t position, uint8_t flightMode, FlightModeSettingsData *modeSettings);
@@ -131,6 +138,10 @@ int32_t ManualControlStart()
     SystemSettingsConnectCallback(configurationUpdatedCb);
     ManualControlSettingsConnectCallback(configurationUpdatedCb);
     ManualControlCommandConnectCallback(commandUpdatedCb);
+    FlightModeSettingsConnectCallback(settingsUpdatedCb);
+#ifndef PIOS_EXCLUDE_ADVANCED_FEATURES
+    VtolPathFollowerSettingsConnectCallback(settingsUpdatedCb);
+#endif
 
     // clear alarms
     AlarmsClear(SYSTEMALARMS_ALARM_MANUALCONTROL);
@@ -187,13 +198,14 @@ static void manualControlTask(void)
     FlightStatusGet(&flightStatus);
     ManualControlCommandData cmd;
     ManualControlCommandGet(&cmd);
+
+    if (settingsUpdated) {
+        settingsUpdated = false;
+        FlightModeSettingsGet(&flightModeSettings);
 #ifndef PIOS_EXCLUDE_ADVANCED_FEATURES
-    VtolPathFollowerSettingsThrustLimitsData thrustLimits;
-    VtolPathFollowerSettingsThrustLimitsGet(&thrustLimits);
+        VtolPathFollowerSettingsThrustLimitsGet(&thrustLimits);
 #endif
-
-    FlightModeSettingsData modeSettings;
-    FlightModeSettingsGet(&modeSettings);
+    }
 
     uint8_t position = cmd.FlightModeSwitchPosition;
     uint8_t newMode  = flightStatus.FlightMode;
@@ -201,7 +213,7 @@ static void manualControlTask(void)
     uint8_t newAssistedControlState  = flightStatus.AssistedControlState;
     uint8_t newAssistedThrottleState = flightStatus.AssistedThrottleState;
     if (position < FLIGHTMODESETTINGS_FLIGHTMODEPOSITION_NUMELEM) {
-        newMode = modeSettings.FlightModePosition[position];
+        newMode = flightModeSettings.FlightModePosition[position];
     }
 
     // if a mode change occurs we default the assist mode and states here
@@ -232,7 +244,7 @@ static void manualControlTask(void)
         handler = &handler_STABILIZED;
 
 #ifndef PIOS_EXCLUDE_ADVANCED_FEATURES
-        newFlightModeAssist = isAssistedFlightMode(position, newMode, &modeSettings);
+        newFlightModeAssist = isAssistedFlightMode(position, newMode, &flightModeSettings);
         if (newFlightModeAssist) {
             // assess roll/pitch state
             bool flagRollPitchHasInput = (fabsf(cmd.Roll) > 0.0f || fabsf(cmd.Pitch) > 0.0f);
@@ -367,7 +379,7 @@ static void manualControlTask(void)
 #ifndef PIOS_EXCLUDE_ADVANCED_FEATURES
 
     case FLIGHTSTATUS_FLIGHTMODE_POSITIONHOLD:
-        newFlightModeAssist = isAssistedFlightMode(position, newMode, &modeSettings);
+        newFlightModeAssist = isAssistedFlightMode(position, newMode, &flightModeSettings);
         if (newFlightModeAssist) {
             switch (newFlightModeAssist) {
             case FLIGHTSTATUS_FLIGHTMODEASSIST_GPSASSIST_PRIMARYTHRUST:
@@ -453,6 +465,14 @@ static void commandUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
     PIOS_CALLBACKSCHEDULER_Dispatch(callbackHandle);
 }
 
+/**
+ * Settings changed, reload them at the next run
+ */
+static void settingsUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
+{
+    settingsUpdated = true;
+}
+
 
 /**
  * Check and set modes for gps assisted stablised flight modes
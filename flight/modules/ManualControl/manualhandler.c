@@ -60,6 +60,8 @@ void manualHandler(bool newinit)
     actuator.Pitch  = cmd.Pitch;
     actuator.Yaw    = cmd.Yaw;
     actuator.Thrust = cmd.Thrust;
+    // not driven by a sensor sample, exclude from latency measurement
+    actuator.SampleTime = 0;
 
     ActuatorDesiredSet(&actuator);
 }
@@ -36,11 +36,25 @@
 #include <stabilizationbank.h>
 
 // Private constants
+// segments of the expo curve tables, over the 0..1 stick range
+#define EXPO_TABLE_SEGMENTS 64
+#define EXPO_TABLE_ONE      32767
 
 // Private types
 
+// Private variables
+// settings are read again, and the expo curves rebuilt, only after they changed
+static FlightModeSettingsData settings;
+static StabilizationBankData stabSettings;
+static volatile bool settingsUpdated = true;
+// stick expo curves for roll, pitch and yaw, in Q15
+static int16_t (*expoTable)[EXPO_TABLE_SEGMENTS + 1];
+
 // Private functions
 static float applyExpo(float value, float expo);
+static void buildExpoTable(int16_t *table, float expo);
+static float lookupExpo(float value, const int16_t *table);
+static void settingsUpdatedCb(UAVObjEvent *ev);
 
 
 static float applyExpo(float value, float expo)
@@ -64,6 +78,39 @@ static float applyExpo(float value, float expo)
 }
 
 
+/**
+ * Sample the expo curve of the positive stick range
+ */
+static void buildExpoTable(int16_t *table, float expo)
+{
+    for (uint32_t i = 0; i <= EXPO_TABLE_SEGMENTS; i++) {
+        table[i] = (int16_t)(applyExpo((float)i / EXPO_TABLE_SEGMENTS, expo) * EXPO_TABLE_ONE + 0.5f);
+    }
+}
+
+/**
+ * Apply an expo curve by linear interpolation of its table, the curve is symmetric
+ */
+static float lookupExpo(float value, const int16_t *table)
+{
+    // stick position in 1/256 of a segment
+    int32_t pos = (int32_t)(fabsf(value) * (EXPO_TABLE_SEGMENTS * 256));
+
+    if (pos >= EXPO_TABLE_SEGMENTS * 256) {
+        pos = EXPO_TABLE_SEGMENTS * 256 - 1;
+    }
+    const int32_t index = pos >> 8;
+    const int32_t frac  = pos & 0xFF;
+    const int32_t out   = table[index] + (((table[index + 1] - table[index]) * frac) >> 8);
+
+    return (value < 0.0f ? -out : out) * (1.0f / EXPO_TABLE_ONE);
+}
+
+static void settingsUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
+{
+    settingsUpdated = true;
+}
+
 /**
  * @brief Handler to control Stabilized flightmodes. FlightControl is governed by "Stabilization"
  * @input: ManualControlCommand
@@ -74,22 +121,32 @@ void stabilizedHandler(bool newinit)
     if (newinit) {
         StabilizationDesiredInitialize();
         StabilizationBankInitialize();
+        if (!expoTable) {
+            expoTable = pios_malloc(sizeof(int16_t) * 3 * (EXPO_TABLE_SEGMENTS + 1));
+            PIOS_Assert(expoTable);
+            FlightModeSettingsConnectCallback(settingsUpdatedCb);
+            StabilizationBankConnectCallback(settingsUpdatedCb);
+            settingsUpdated = true;
+        }
     }
     ManualControlCommandData cmd;
     ManualControlCommandGet(&cmd);
 
-    FlightModeSettingsData settings;
-    FlightModeSettingsGet(&settings);
+    if (settingsUpdated) {
+        settingsUpdated = false;
+        FlightModeSettingsGet(&settings);
+        StabilizationBankGet(&stabSettings);
+        buildExpoTable(expoTable[0], stabSettings.StickExpo.Roll);
+        buildExpoTable(expoTable[1], stabSettings.StickExpo.Pitch);
+        buildExpoTable(expoTable[2], stabSettings.StickExpo.Yaw);
+    }
 
     StabilizationDesiredData stabilization;
     StabilizationDesiredGet(&stabilization);
 
-    StabilizationBankData stabSettings;
-    StabilizationBankGet(&stabSettings);
-
-    cmd.Roll  = applyExpo(cmd.Roll, stabSettings.StickExpo.Roll);
-    cmd.Pitch = applyExpo(cmd.Pitch, stabSettings.StickExpo.Pitch);
-    cmd.Yaw   = applyExpo(cmd.Yaw, stabSettings.StickExpo.Yaw);
+    cmd.Roll  = lookupExpo(cmd.Roll, expoTable[0]);
+    cmd.Pitch = lookupExpo(cmd.Pitch, expoTable[1]);
+    cmd.Yaw   = lookupExpo(cmd.Yaw, expoTable[2]);
     uint8_t *stab_settings;
     FlightStatusData flightStatus;
     FlightStatusGet(&flightStatus);
@@ -102,11 +102,8 @@ void updatedCb(UAVObjEvent *ev)
 
 void onTimerCb(__attribute__((unused)) UAVObjEvent *ev)
 {
-    static SystemAlarmsAlarmData alarms;
-
-    SystemAlarmsAlarmGet(&alarms);
     for (uint8_t i = 0; i < alarmsMapSize; i++) {
-        uint8_t alarm = ((uint8_t *)&alarms)[alarmsMap[i].alarmIndex];
+        uint8_t alarm = AlarmsGet(alarmsMap[i].alarmIndex);
         checkAlarm(alarm,
                    &alarmStatus[i].lastAlarm,
                    &alarmStatus[i].lastAlarmTime,
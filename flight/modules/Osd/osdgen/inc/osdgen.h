@@ -162,6 +162,7 @@ uint8_t getCharData(uint16_t charPos);
 void introText();
 
 void clearGraphics();
+void finishGraphics();
 uint8_t validPos(uint16_t x, uint16_t y);
 void setPixel(uint16_t x, uint16_t y, uint8_t state);
 void drawCircle(uint16_t x0, uint16_t y0, uint16_t radius);
@@ -89,12 +89,35 @@ xSemaphoreHandle osdSemaphore = NULL;
 
 #define TASK_PRIORITY    (tskIDLE_PRIORITY + 4)
 #define UPDATE_PERIOD    100
+// Frames after which the screen is redrawn even if no UAVObject changed, for the
+// values that are not UAVObjects (ADC, RTC, video lines)
+#define REFRESH_FRAMES   5
+
+// Mark rows as written to in the current draw buffer, only writes that may set bits need this
+#define MARK_DIRTY(y0, y1) \
+    { if ((y0) < dirtyTop) { dirtyTop = (y0); } \
+      if ((y1) > dirtyBottom) { dirtyBottom = (y1); } }
 
 // ****************
 // Private variables
 
 static xTaskHandle osdgenTaskHandle;
 
+// Rows drawn into since each buffer pair was last cleared, top > bottom when clean.
+// The buffers are swapped after each new frame, so there is one entry per buffer.
+struct dirtyRows {
+    uint8_t  *buffer; // level buffer of the pair
+    uint16_t top;
+    uint16_t bottom;
+};
+static struct dirtyRows dirtyBuffers[2];
+static struct dirtyRows *currentDirty;
+static uint16_t dirtyTop;
+static uint16_t dirtyBottom;
+
+// Set when one of the displayed UAVObjects changed
+static volatile bool inputsUpdated;
+
 struct splashEntry {
     unsigned int   width, height;
     const uint16_t *level;
@@ -126,10 +149,48 @@ uint16_t mirror(uint16_t source)
     return result;
 }
 
+/**
+ * clearGraphics: Clear the rows of the draw buffer that were drawn into the last
+ * time it was used, and start tracking the rows drawn into this frame.
+ */
 void clearGraphics()
 {
-    memset((uint8_t *)draw_buffer_mask, 0, GRAPHICS_WIDTH * GRAPHICS_HEIGHT);
-    memset((uint8_t *)draw_buffer_level, 0, GRAPHICS_WIDTH * GRAPHICS_HEIGHT);
+    if (dirtyBuffers[0].buffer == draw_buffer_level) {
+        currentDirty = &dirtyBuffers[0];
+    } else if (dirtyBuffers[1].buffer == draw_buffer_level) {
+        currentDirty = &dirtyBuffers[1];
+    } else {
+        // first time this buffer is drawn into, it is cleared by PIOS_Video_Init()
+        currentDirty = dirtyBuffers[0].buffer ? &dirtyBuffers[1] : &dirtyBuffers[0];
+        currentDirty->buffer = draw_buffer_level;
+        currentDirty->top    = GRAPHICS_HEIGHT_REAL;
+        currentDirty->bottom = 0;
+    }
+    if (currentDirty->top <= currentDirty->bottom) {
+        uint16_t bottom = MIN(currentDirty->bottom, GRAPHICS_HEIGHT_REAL - 1);
+        uint32_t offset = currentDirty->top * GRAPHICS_WIDTH;
+        uint32_t length = (bottom - currentDirty->top + 1) * GRAPHICS_WIDTH;
+        memset((uint8_t *)draw_buffer_mask + offset, 0, length);
+        memset((uint8_t *)draw_buffer_level + offset, 0, length);
+    }
+    dirtyTop    = GRAPHICS_HEIGHT_REAL;
+    dirtyBottom = 0;
+}
+
+/**
+ * finishGraphics: Mask out the last half-word of the rows drawn into, the SPI keeps
+ * clocking it out otherwise, and remember them for the next clearGraphics().
+ */
+void finishGraphics()
+{
+    if (dirtyTop <= dirtyBottom) {
+        for (uint32_t i = 0; i < 8; i++) {
+            write_vline(draw_buffer_level, GRAPHICS_WIDTH_REAL - i - 1, dirtyTop, MIN(dirtyBottom, GRAPHICS_HEIGHT_REAL - 1), 0);
+            write_vline(draw_buffer_mask, GRAPHICS_WIDTH_REAL - i - 1, dirtyTop, MIN(dirtyBottom, GRAPHICS_HEIGHT_REAL - 1), 0);
+        }
+    }
+    currentDirty->top    = dirtyTop;
+    currentDirty->bottom = dirtyBottom;
 }
 
 void copyimage(uint16_t offsetx, uint16_t offsety, int image)
@@ -141,6 +202,7 @@ void copyimage(uint16_t offsetx, uint16_t offsety, int image)
     struct splashEntry splash_info;
     splash_info = splash[image];
     offsetx     = offsetx / 8;
+    MARK_DIRTY(offsety, offsety + splash_info.height - 1);
     for (uint16_t y = offsety; y < ((splash_info.height) + offsety); y++) {
         uint16_t x1 = offsetx;
         for (uint16_t x = offsetx; x < (((splash_info.width) / 16) + offsetx); x++) {
@@ -348,6 +410,9 @@ void drawBox(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2)
 void write_pixel(uint8_t *buff, unsigned int x, unsigned int y, int mode)
 {
     CHECK_COORDS(x, y);
+    if (mode) {
+        MARK_DIRTY(y, y);
+    }
     // Determine the bit in the word to be set and the word
     // index to set it in.
     int bitnum    = CALC_BIT_IN_WORD(x);
@@ -369,6 +434,7 @@ void write_pixel(uint8_t *buff, unsigned int x, unsigned int y, int mode)
 void write_pixel_lm(unsigned int x, unsigned int y, int mmode, int lmode)
 {
     CHECK_COORDS(x, y);
+    MARK_DIRTY(y, y);
     // Determine the bit in the word to be set and the word
     // index to set it in.
     int bitnum    = CALC_BIT_IN_WORD(x);
@@ -398,6 +464,9 @@ void write_hline(uint8_t *buff, unsigned int x0, unsigned int x1, unsigned int y
     if (x0 == x1) {
         return;
     }
+    if (mode) {
+        MARK_DIRTY(y, y);
+    }
     /* This is an optimised algorithm for writing horizontal lines.
     * We begin by finding the addresses of the x0 and x1 points. */
     int addr0     = CALC_BUFF_ADDR(x0, y);
@@ -416,10 +485,16 @@ void write_hline(uint8_t *buff, unsigned int x0, unsigned int x1, unsigned int y
         mask_r = COMPUTE_HLINE_EDGE_R_MASK(addr1_bit);
         WRITE_WORD_MODE(buff, addr0, mask_l, mode);
         WRITE_WORD_MODE(buff, addr1, mask_r, mode);
-        // Now write 0xffff words from start+1 to end-1.
-        for (i = addr0 + 1; i <= addr1 - 1; i++) {
-            uint8_t m = 0xff;
-            WRITE_WORD_MODE(buff, i, m, mode);
+        // Now write 0xffff words from start+1 to end-1, as a block unless toggling.
+        if (mode < 2) {
+            if (addr1 - addr0 > 1) {
+                memset(&buff[addr0 + 1], mode ? 0xff : 0, addr1 - addr0 - 1);
+            }
+        } else {
+            for (i = addr0 + 1; i <= addr1 - 1; i++) {
+                uint8_t m = 0xff;
+                WRITE_WORD_MODE(buff, i, m, mode);
+            }
         }
     }
 }
@@ -491,6 +566,9 @@ void write_vline(uint8_t *buff, unsigned int x, unsigned int y0, unsigned int y1
     if (y0 == y1) {
         return;
     }
+    if (mode) {
+        MARK_DIRTY(y0, y1);
+    }
     /* This is an optimised algorithm for writing vertical lines.
      * We begin by finding the addresses of the x,y0 and x,y1 points. */
     unsigned int addr0  = CALC_BUFF_ADDR(x, y0);
@@ -575,6 +653,9 @@ void write_filled_rectangle(uint8_t *buff, unsigned int x, unsigned int y, unsig
     if (width <= 0 || height <= 0) {
         return;
     }
+    if (mode) {
+        MARK_DIRTY(y, y + height - 1);
+    }
     // Calculate as if the rectangle was only a horizontal line. We then
     // step these addresses through each row until we iterate `height` times.
     unsigned int addr0     = CALC_BUFF_ADDR(x, y);
@@ -604,14 +685,20 @@ void write_filled_rectangle(uint8_t *buff, unsigned int x, unsigned int y, unsig
             addr1 += GRAPHICS_WIDTH_REAL / 8;
             yy++;
         }
-        // Now write 0xffff words from start+1 to end-1 for each row.
+        // Now write 0xffff words from start+1 to end-1 for each row, as a block unless toggling.
         yy    = 0;
         addr0 = addr0_old;
         addr1 = addr1_old;
         while (yy < height) {
-            for (i = addr0 + 1; i <= addr1 - 1; i++) {
-                uint8_t m = 0xff;
-                WRITE_WORD_MODE(buff, i, m, mode);
+            if (mode < 2) {
+                if (addr1 - addr0 > 1) {
+                    memset(&buff[addr0 + 1], mode ? 0xff : 0, addr1 - addr0 - 1);
+                }
+            } else {
+                for (i = addr0 + 1; i <= addr1 - 1; i++) {
+                    uint8_t m = 0xff;
+                    WRITE_WORD_MODE(buff, i, m, mode);
+                }
             }
             addr0 += GRAPHICS_WIDTH_REAL / 8;
             addr1 += GRAPHICS_WIDTH_REAL / 8;
@@ -957,6 +1044,9 @@ void write_word_misaligned(uint8_t *buff, uint16_t word, unsigned int addr, unsi
     int16_t firstmask = word >> xoff;
     int16_t lastmask  = word << (16 - xoff);
 
+    if (mode) {
+        MARK_DIRTY(addr / (GRAPHICS_WIDTH_REAL / 8), addr / (GRAPHICS_WIDTH_REAL / 8));
+    }
     WRITE_WORD_MODE(buff, addr + 1, firstmask && 0x00ff, mode);
     WRITE_WORD_MODE(buff, addr, (firstmask & 0xff00) >> 8, mode);
     if (xoff > 0) {
@@ -1097,6 +1187,7 @@ void write_char16(char ch, unsigned int x, unsigned int y, int font)
         row_temp  = row;
         addr_temp = addr;
         xshift    = 16 - font_info.width;
+        MARK_DIRTY(y, y + font_info.height - 1);
         // We can write mask words easily.
         for (yy = y; yy < y + font_info.height; yy++) {
             if (font == 3) {
@@ -1178,6 +1269,7 @@ void write_char(char ch, unsigned int x, unsigned int y, int flags, int font)
         row_temp  = row;
         addr_temp = addr;
         xshift    = 16 - font_info.width;
+        MARK_DIRTY(y, y + font_info.height - 1);
         // We can write mask words easily.
         for (yy = y; yy < y + font_info.height; yy++) {
             write_word_misaligned_OR(draw_buffer_mask, font_info.data[row] << xshift, addr, wbit);
@@ -2023,12 +2115,6 @@ void introGraphics()
 
     /* frame */
     drawBox(APPLY_HDEADBAND(0), APPLY_VDEADBAND(0), APPLY_HDEADBAND(GRAPHICS_RIGHT - 8), APPLY_VDEADBAND(GRAPHICS_BOTTOM));
-
-    // Must mask out last half-word because SPI keeps clocking it out otherwise
-    for (uint32_t i = 0; i < 8; i++) {
-        write_vline(draw_buffer_level, GRAPHICS_WIDTH_REAL - i - 1, 0, GRAPHICS_HEIGHT_REAL - 1, 0);
-        write_vline(draw_buffer_mask, GRAPHICS_WIDTH_REAL - i - 1, 0, GRAPHICS_HEIGHT_REAL - 1, 0);
-    }
 }
 
 void calcHomeArrow(int16_t m_yaw)
@@ -2379,18 +2465,18 @@ void updateGraphics()
         write_hline_lm(APPLY_HDEADBAND(0), APPLY_HDEADBAND(GRAPHICS_RIGHT), APPLY_VDEADBAND(GRAPHICS_BOTTOM / 2), 1, 1);
         break;
     }
-
-    // Must mask out last half-word because SPI keeps clocking it out otherwise
-    for (uint32_t i = 0; i < 8; i++) {
-        write_vline(draw_buffer_level, GRAPHICS_WIDTH_REAL - i - 1, 0, GRAPHICS_HEIGHT_REAL - 1, 0);
-        write_vline(draw_buffer_mask, GRAPHICS_WIDTH_REAL - i - 1, 0, GRAPHICS_HEIGHT_REAL - 1, 0);
-    }
 }
 
 void updateOnceEveryFrame()
 {
     clearGraphics();
     updateGraphics();
+    finishGraphics();
+}
+
+static void inputsUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
+{
+    inputsUpdated = true;
 }
 
 // ****************
@@ -2434,6 +2520,18 @@ int32_t osdgenInitialize(void)
     BaroSensorInitialize();
     FlightStatusInitialize();
 
+    // The screen is only redrawn when what it shows changes
+    AttitudeStateConnectCallback(inputsUpdatedCb);
+#ifdef PIOS_INCLUDE_GPS
+    GPSPositionSensorConnectCallback(inputsUpdatedCb);
+#ifdef PIOS_GPS_SETS_HOMELOCATION
+    HomeLocationConnectCallback(inputsUpdatedCb);
+#endif
+#endif
+    OsdSettingsConnectCallback(inputsUpdatedCb);
+    BaroSensorConnectCallback(inputsUpdatedCb);
+    FlightStatusConnectCallback(inputsUpdatedCb);
+
     return 0;
 }
 MODULE_INITCALL(osdgenInitialize, osdgenStart);
@@ -2463,6 +2561,8 @@ static void osdgenTask(__attribute__((unused)) void *parameters)
 #endif
             clearGraphics();
             introGraphics();
+            finishGraphics();
+            PIOS_Video_FrameDone(true);
         }
     }
     for (int i = 0; i < 63; i++) {
@@ -2473,15 +2573,29 @@ static void osdgenTask(__attribute__((unused)) void *parameters)
             clearGraphics();
             introGraphics();
             introText();
+            finishGraphics();
+            PIOS_Video_FrameDone(true);
         }
     }
 
+    uint8_t framesSinceRefresh = 0;
+    inputsUpdated = true;
+
     while (1) {
         if (xSemaphoreTake(osdSemaphore, LONG_TIME) == pdTRUE) {
 #ifdef PIOS_INCLUDE_WDG
             PIOS_WDG_UpdateFlag(PIOS_WDG_OSDGEN);
 #endif
-            updateOnceEveryFrame();
+            // the buffers are only swapped when a new frame was drawn, the
+            // displayed one stays up to date as long as nothing changes
+            if (inputsUpdated || ++framesSinceRefresh >= REFRESH_FRAMES) {
+                inputsUpdated = false;
+                framesSinceRefresh = 0;
+                updateOnceEveryFrame();
+                PIOS_Video_FrameDone(true);
+            } else {
+                PIOS_Video_FrameDone(false);
+            }
         }
         // xSemaphoreTake(osdSemaphore, portMAX_DELAY);
         // vTaskDelayUntil(&lastSysTime, 10 / portTICK_RATE_MS);
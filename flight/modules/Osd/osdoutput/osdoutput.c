@@ -43,6 +43,8 @@
 #include "hwsettings.h"
 #include "flightstatus.h"
 
+#include <loadgovernor.h>
+
 static bool osdoutputEnabled;
 
 enum osd_hk_sync {
@@ -125,6 +127,7 @@ static volatile bool newAlarmData    = false;
 static uint32_t osd_hk_com_id;
 static uint8_t osd_hk_msg_dropped;
 static uint8_t osd_packet;
+static uint8_t osd_skipped;
 
 static void send_update(__attribute__((unused)) UAVObjEvent *ev)
 {
@@ -138,6 +141,11 @@ static void send_update(__attribute__((unused)) UAVObjEvent *ev)
         return;
     }
 
+    /* Send every other update while the load governor sheds the OSD */
+    if (LoadGovernorIsShedding(LOADGOVERNOR_LEVEL_OSD) && !(osd_skipped++ & 1)) {
+        return;
+    }
+
     FlightStatusData flightStatus;
 
     /*
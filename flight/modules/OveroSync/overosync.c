@@ -35,6 +35,7 @@
 #include "overosync.h"
 
 #include "hwsettings.h"
+#include "overosyncsettings.h"
 #include "overosyncstats.h"
 #include "systemstats.h"
 #include "taskinfo.h"
@@ -51,11 +52,14 @@ static xQueueHandle queue;
 static UAVTalkConnection uavTalkCon;
 static xTaskHandle overoSyncTaskHandle;
 static bool overoEnabled;
+// Objects streamed at every update, all of them when empty
+static uint32_t streamObjects[OVEROSYNCSETTINGS_STREAMOBJECTS_NUMELEM];
 
 // Private functions
 static void overoSyncTask(void *parameters);
 static int32_t packData(uint8_t *data, int32_t length);
 static void registerObject(UAVObjHandle obj);
+static bool isStreamed(UAVObjHandle obj);
 
 // External variables
 extern uint32_t pios_com_overo_id;
@@ -87,17 +91,18 @@ int32_t OveroSyncInitialize(void)
 
     if (optionalModules[HWSETTINGS_OPTIONALMODULES_OVERO] == HWSETTINGS_OPTIONALMODULES_ENABLED) {
         overoEnabled = true;
-
-        // Create object queues
-        queue = xQueueCreate(MAX_QUEUE_SIZE, sizeof(UAVObjEvent));
     } else {
         overoEnabled = false;
         return -1;
     }
 #endif
 
+    // Create object queues
+    queue = xQueueCreate(MAX_QUEUE_SIZE, sizeof(UAVObjEvent));
 
     OveroSyncStatsInitialize();
+    OveroSyncSettingsInitialize();
+    OveroSyncSettingsStreamObjectsGet(streamObjects);
 
 
     // Initialise UAVTalk
@@ -147,6 +152,10 @@ static void registerObject(UAVObjHandle obj)
 {
     int32_t eventMask;
 
+    if (!isStreamed(obj)) {
+        return;
+    }
+
     eventMask = EV_UPDATED | EV_UPDATED_MANUAL | EV_UPDATE_REQ;
     if (UAVObjIsMetaobject(obj)) {
         eventMask |= EV_UNPACKED; // we also need to act on remote updates (unpack events)
@@ -154,6 +163,29 @@ static void registerObject(UAVObjHandle obj)
     UAVObjConnectQueue(obj, queue, eventMask);
 }
 
+/**
+ * Check whether the updates of an object are streamed, the metadata follow their object.
+ * The stream stays with the objects the companion computer needs, which can then be
+ * sent at every update (at the sensor rate for the state objects).
+ * \param[in] obj The object
+ * \return true if the object is streamed
+ */
+static bool isStreamed(UAVObjHandle obj)
+{
+    uint32_t objId = UAVObjGetID(UAVObjIsMetaobject(obj) ? UAVObjGetLinkedObj(obj) : obj);
+    bool all = true;
+
+    for (uint8_t i = 0; i < OVEROSYNCSETTINGS_STREAMOBJECTS_NUMELEM; i++) {
+        if (streamObjects[i] == objId) {
+            return true;
+        }
+        if (streamObjects[i] != 0) {
+            all = false;
+        }
+    }
+    return all;
+}
+
 /**
  * Telemetry transmit task, regular priority
  *
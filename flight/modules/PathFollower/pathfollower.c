@@ -139,6 +139,7 @@ static uint32_t updatePeriod = PF_IDLE_UPDATE_RATE_MS;
 static struct Globals global;
 static PathStatusData pathStatus;
 static PathDesiredData pathDesired;
+static struct path_geometry pathGeometry;
 static FixedWingPathFollowerSettingsData fixedWingPathFollowerSettings;
 static VtolPathFollowerSettingsData vtolPathFollowerSettings;
 static FlightStatusData flightStatus;
@@ -310,6 +311,7 @@ static void SettingsUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
     pid_configure(&global.BrakePIDvel[1], vtolPathFollowerSettings.BrakeHorizontalVelPID.Kp, vtolPathFollowerSettings.BrakeHorizontalVelPID.Ki, vtolPathFollowerSettings.BrakeHorizontalVelPID.Kd, vtolPathFollowerSettings.BrakeHorizontalVelPID.ILimit);
 
     PathDesiredGet(&pathDesired);
+    path_geometry_init(&pathDesired, &pathGeometry);
 }
 
 
@@ -595,7 +597,7 @@ static float updatePathBearing()
                      positionState.Down };
     struct path_status progress;
 
-    path_progress(&pathDesired, cur, &progress);
+    path_geometry_progress(&pathGeometry, cur, &progress);
 
     // atan2f always returns in between + and - 180 degrees
     return RAD2DEG(atan2f(progress.path_vector[1], progress.path_vector[0]));
@@ -709,6 +711,7 @@ static void processPOI()
             pathDesired.EndingVelocity   = 0.0f;
             pathDesired.Mode = PATHDESIRED_MODE_FLYENDPOINT;
             PathDesiredSet(&pathDesired);
+            path_geometry_init(&pathDesired, &pathGeometry);
         }
     }
     // not above
@@ -752,10 +755,13 @@ static void updateBrakeVelocity(float startingVelocity, float dT, float brakeRat
 static void updatePathVelocity(float kFF, bool limited)
 {
     PositionStateData positionState;
-
-    PositionStateGet(&positionState);
     VelocityStateData velocityState;
-    VelocityStateGet(&velocityState);
+    const UAVObjSnapshotEntry state[] = {
+        { PositionStateHandle(), &positionState },
+        { VelocityStateHandle(), &velocityState },
+    };
+
+    UAVObjGetSnapshot(state, NELEMENTS(state));
     VelocityDesiredData velocityDesired;
 
     const float dT = updatePeriod / 1000.0f;
@@ -798,7 +804,7 @@ static void updatePathVelocity(float kFF, bool limited)
                          positionState.East + (velocityState.East * kFF),
                          positionState.Down + (velocityState.Down * kFF) };
         struct path_status progress;
-        path_progress(&pathDesired, cur, &progress);
+        path_geometry_progress(&pathGeometry, cur, &progress);
 
         // calculate velocity - can be zero if waypoints are too close
         velocityDesired.North = progress.path_vector[0];
@@ -1230,12 +1236,15 @@ static int8_t updateVtolDesiredAttitude(bool yaw_attitude, float yaw_direction)
     float downError;
     float downCommand;
 
+    const UAVObjSnapshotEntry state[] = {
+        { VelocityStateHandle(), &velocityState },
+        { AttitudeStateHandle(), &attitudeState },
+    };
+
     SystemSettingsGet(&systemSettings);
-    VelocityStateGet(&velocityState);
+    UAVObjGetSnapshot(state, NELEMENTS(state));
     VelocityDesiredGet(&velocityDesired);
     StabilizationDesiredGet(&stabDesired);
-    VelocityDesiredGet(&velocityDesired);
-    AttitudeStateGet(&attitudeState);
     StabilizationBankGet(&stabSettings);
     VtolSelfTuningStatsGet(&vtolSelfTuningStats);
 
@@ -51,15 +51,26 @@
 #define TASK_PRIORITY               CALLBACK_TASK_NAVIGATION
 #define MAX_QUEUE_SIZE              2
 #define PATH_PLANNER_UPDATE_RATE_MS 100 // can be slow, since we listen to status updates as well
+#define LOOKAHEAD_LEGS              3 // upcoming legs prepared ahead of the active one
 
 // Private types
 
+// PathDesired prepared for an upcoming waypoint
+struct leg {
+    int32_t index; // waypoint index, -1 if unused
+    PathDesiredData pathDesired;
+};
+
 // Private functions
 static void pathPlannerTask();
 static void commandUpdated(UAVObjEvent *ev);
 static void statusUpdated(UAVObjEvent *ev);
+static void planUpdated(UAVObjEvent *ev);
 static void updatePathDesired();
 static void setWaypoint(uint16_t num);
+static void computeLeg(uint16_t index, PathDesiredData *pathDesired);
+static void checkLookahead();
+static void updateLookahead();
 
 static uint8_t checkPathPlan();
 static uint8_t pathConditionCheck();
@@ -82,6 +93,9 @@ static WaypointActiveData waypointActive;
 static WaypointData waypoint;
 static PathActionData pathAction;
 static bool pathplanner_active = false;
+static struct leg lookahead[LOOKAHEAD_LEGS];
+static volatile bool lookaheadInvalid = true;
+static int32_t publishedIndex = -1;
 
 
 /**
@@ -91,9 +105,9 @@ int32_t PathPlannerStart()
 {
     plan_initialize();
     // when the active waypoint changes, update pathDesired
-    WaypointConnectCallback(commandUpdated);
+    WaypointConnectCallback(planUpdated);
     WaypointActiveConnectCallback(commandUpdated);
-    PathActionConnectCallback(commandUpdated);
+    PathActionConnectCallback(planUpdated);
     PathStatusConnectCallback(statusUpdated);
 
     // Start main task callback
@@ -142,6 +156,7 @@ static void pathPlannerTask()
     FlightStatusGet(&flightStatus);
     if (flightStatus.ControlChain.PathPlanner != FLIGHTSTATUS_CONTROLCHAIN_TRUE) {
         pathplanner_active = false;
+        publishedIndex     = -1;
         if (!validPathPlan) {
             // unverified path plans are only a warning while we are not in pathplanner mode
             // so it does not prevent arming. However manualcontrols safety check
@@ -166,6 +181,8 @@ static void pathPlannerTask()
         // make a forced disarming but rth has a higher chance of survival when
         // in flight.
         pathplanner_active = false;
+        publishedIndex     = -1;
+        lookaheadInvalid   = true;
 
         if (!failsafeRTHset) {
             failsafeRTHset = 1;
@@ -191,6 +208,8 @@ static void pathPlannerTask()
         return;
     }
 
+    updateLookahead();
+
     WaypointInstGet(waypointActive.Index, &waypoint);
     PathActionInstGet(waypoint.Action, &pathAction);
     PathStatusData pathStatus;
@@ -317,20 +336,27 @@ static uint8_t checkPathPlan()
     return true;
 }
 
-// callback function when status changed, issue execution of state machine
+// callback function when the active waypoint changed, update pathDesired
 void commandUpdated(__attribute__((unused)) UAVObjEvent *ev)
 {
     PIOS_CALLBACKSCHEDULER_Dispatch(pathDesiredUpdaterHandle);
 }
 
-// callback function when waypoints changed in any way, update pathDesired
+// callback function when waypoints or actions changed in any way, update pathDesired
+void planUpdated(__attribute__((unused)) UAVObjEvent *ev)
+{
+    lookaheadInvalid = true;
+    PIOS_CALLBACKSCHEDULER_Dispatch(pathDesiredUpdaterHandle);
+}
+
+// callback function when status changed, issue execution of state machine
 void statusUpdated(__attribute__((unused)) UAVObjEvent *ev)
 {
     PIOS_CALLBACKSCHEDULER_Dispatch(pathPlannerHandle);
 }
 
 
-// callback function when waypoints changed in any way, update pathDesired
+// publish pathDesired for the active waypoint, from the lookahead if it is prepared
 void updatePathDesired()
 {
     // only ever touch pathDesired if pathplanner is enabled
@@ -338,26 +364,54 @@ void updatePathDesired()
         return;
     }
 
-    PathDesiredData pathDesired;
+    checkLookahead();
 
     // find out current waypoint
     WaypointActiveGet(&waypointActive);
 
+    // already published straight from setWaypoint()
+    if (waypointActive.Index == publishedIndex) {
+        return;
+    }
+
     WaypointInstGet(waypointActive.Index, &waypoint);
     PathActionInstGet(waypoint.Action, &pathAction);
 
-    pathDesired.End.North = waypoint.Position.North;
-    pathDesired.End.East  = waypoint.Position.East;
-    pathDesired.End.Down  = waypoint.Position.Down;
-    pathDesired.EndingVelocity    = waypoint.Velocity;
-    pathDesired.Mode = pathAction.Mode;
-    pathDesired.ModeParameters[0] = pathAction.ModeParameters[0];
-    pathDesired.ModeParameters[1] = pathAction.ModeParameters[1];
-    pathDesired.ModeParameters[2] = pathAction.ModeParameters[2];
-    pathDesired.ModeParameters[3] = pathAction.ModeParameters[3];
-    pathDesired.UID = waypointActive.Index;
-
-    if (waypointActive.Index == 0) {
+    for (int i = 0; i < LOOKAHEAD_LEGS; i++) {
+        if (lookahead[i].index == waypointActive.Index) {
+            PathDesiredSet(&lookahead[i].pathDesired);
+            publishedIndex = waypointActive.Index;
+            return;
+        }
+    }
+
+    PathDesiredData pathDesired;
+    computeLeg(waypointActive.Index, &pathDesired);
+    PathDesiredSet(&pathDesired);
+    publishedIndex = waypointActive.Index;
+}
+
+// compute pathDesired for the leg ending in the given waypoint
+static void computeLeg(uint16_t index, PathDesiredData *pathDesired)
+{
+    WaypointData legWaypoint;
+    PathActionData legAction;
+
+    WaypointInstGet(index, &legWaypoint);
+    PathActionInstGet(legWaypoint.Action, &legAction);
+
+    pathDesired->End.North = legWaypoint.Position.North;
+    pathDesired->End.East  = legWaypoint.Position.East;
+    pathDesired->End.Down  = legWaypoint.Position.Down;
+    pathDesired->EndingVelocity    = legWaypoint.Velocity;
+    pathDesired->Mode = legAction.Mode;
+    pathDesired->ModeParameters[0] = legAction.ModeParameters[0];
+    pathDesired->ModeParameters[1] = legAction.ModeParameters[1];
+    pathDesired->ModeParameters[2] = legAction.ModeParameters[2];
+    pathDesired->ModeParameters[3] = legAction.ModeParameters[3];
+    pathDesired->UID = index;
+
+    if (index == 0) {
         PositionStateData positionState;
         PositionStateGet(&positionState);
         // First waypoint has itself as start point (used to be home position but that proved dangerous when looping)
@@ -365,21 +419,74 @@ void updatePathDesired()
         /*pathDesired.Start[PATHDESIRED_START_NORTH] =  waypoint.Position[WAYPOINT_POSITION_NORTH];
            pathDesired.Start[PATHDESIRED_START_EAST] =  waypoint.Position[WAYPOINT_POSITION_EAST];
            pathDesired.Start[PATHDESIRED_START_DOWN] =  waypoint.Position[WAYPOINT_POSITION_DOWN];*/
-        pathDesired.Start.North = positionState.North;
-        pathDesired.Start.East  = positionState.East;
-        pathDesired.Start.Down  = positionState.Down;
-        pathDesired.StartingVelocity = pathDesired.EndingVelocity;
+        pathDesired->Start.North = positionState.North;
+        pathDesired->Start.East  = positionState.East;
+        pathDesired->Start.Down  = positionState.Down;
+        pathDesired->StartingVelocity = pathDesired->EndingVelocity;
     } else {
         // Get previous waypoint as start point
         WaypointData waypointPrev;
-        WaypointInstGet(waypointActive.Index - 1, &waypointPrev);
+        WaypointInstGet(index - 1, &waypointPrev);
 
-        pathDesired.Start.North = waypointPrev.Position.North;
-        pathDesired.Start.East  = waypointPrev.Position.East;
-        pathDesired.Start.Down  = waypointPrev.Position.Down;
-        pathDesired.StartingVelocity = waypointPrev.Velocity;
+        pathDesired->Start.North = waypointPrev.Position.North;
+        pathDesired->Start.East  = waypointPrev.Position.East;
+        pathDesired->Start.Down  = waypointPrev.Position.Down;
+        pathDesired->StartingVelocity = waypointPrev.Velocity;
+    }
+}
+
+// drop all prepared legs after the waypoints or actions changed
+static void checkLookahead()
+{
+    if (lookaheadInvalid) {
+        lookaheadInvalid = false;
+        publishedIndex   = -1;
+        for (int i = 0; i < LOOKAHEAD_LEGS; i++) {
+            lookahead[i].index = -1;
+        }
+    }
+}
+
+/**
+ * Prepare pathDesired for the waypoints following the active one, so that
+ * advancing to the next waypoint only has to publish a finished leg.
+ * Waypoint 0 starts from the current position and is always computed live.
+ */
+static void updateLookahead()
+{
+    PathPlanData pathPlan;
+
+    checkLookahead();
+    PathPlanGet(&pathPlan);
+
+    for (int k = 1; k <= LOOKAHEAD_LEGS; k++) {
+        // path plans wrap around
+        int32_t index = (waypointActive.Index + k) % pathPlan.WaypointCount;
+        int i;
+
+        if (index == 0) {
+            break;
+        }
+        for (i = 0; i < LOOKAHEAD_LEGS && lookahead[i].index != index; i++) {
+            ;
+        }
+        if (i < LOOKAHEAD_LEGS) {
+            continue;
+        }
+
+        // reuse an entry that is not ahead of the active waypoint
+        for (i = 0; i < LOOKAHEAD_LEGS; i++) {
+            int32_t ahead = lookahead[i].index - waypointActive.Index;
+            if (lookahead[i].index < 0 || ahead <= 0 || ahead > LOOKAHEAD_LEGS) {
+                break;
+            }
+        }
+        if (i == LOOKAHEAD_LEGS) {
+            break;
+        }
+        computeLeg(index, &lookahead[i].pathDesired);
+        lookahead[i].index = index;
     }
-    PathDesiredSet(&pathDesired);
 }
 
 // helper function to go to a specific waypoint
@@ -397,6 +504,11 @@ static void setWaypoint(uint16_t num)
 
     waypointActive.Index = num;
     WaypointActiveSet(&waypointActive);
+
+    // publish right away instead of waiting for the WaypointActive event,
+    // also when staying on the same waypoint as its start point may change
+    publishedIndex = -1;
+    updatePathDesired();
 }
 
 // execute the appropriate condition and report result
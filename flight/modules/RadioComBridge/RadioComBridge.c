@@ -38,6 +38,13 @@
 #include <oplinksettings.h>
 #include <oplinkreceiver.h>
 #include <radiocombridgestats.h>
+#include <flighttelemetrystats.h>
+#include <gcstelemetrystats.h>
+#include <flightstatus.h>
+#include <systemalarms.h>
+#include <debuglogentry.h>
+#include <taskinfo.h>
+#include <callbackinfo.h>
 #include <uavtalk_priv.h>
 #include <pios_rfm22b.h>
 #include <ecc.h>
@@ -57,12 +64,45 @@
 #define EVENT_QUEUE_SIZE  10
 #define MAX_PORT_DELAY    200
 #define SERIAL_RX_BUF_LEN 100
+#define RX_BUFFER_SIZE    16
 #define PPM_INPUT_TIMEOUT 100
 
+// Free space of the output buffer below which the normal objects are dropped,
+// the rest of the buffer is kept for the critical objects
+#define ROUTE_NORMAL_MIN_FREE 64
+// Free space of the output buffer below which the bulk objects are dropped
+#define ROUTE_BULK_MIN_FREE   160
+
 
 // ****************
 // Private types
 
+// How the relayed objects are routed when the output buffer fills
+typedef enum {
+    ROUTE_CRITICAL, // always relayed
+    ROUTE_NORMAL, // dropped when the output buffer is nearly full
+    ROUTE_BULK, // only relayed when the output buffer is mostly empty
+    ROUTE_DROP, // never relayed
+} RouteClass;
+
+typedef struct {
+    uint32_t objId;
+    uint8_t  routeClass;
+    uint16_t minPeriodMs; // relayed at most once per period, 0 for no limit
+} RouteEntry;
+
+// The objects that are not listed are routed as ROUTE_NORMAL
+static const RouteEntry routes[] = {
+    { FLIGHTTELEMETRYSTATS_OBJID, ROUTE_CRITICAL, 0    },
+    { GCSTELEMETRYSTATS_OBJID,    ROUTE_CRITICAL, 0    },
+    { FLIGHTSTATUS_OBJID,         ROUTE_CRITICAL, 0    },
+    { SYSTEMALARMS_OBJID,         ROUTE_CRITICAL, 0    },
+    { OBJECTPERSISTENCE_OBJID,    ROUTE_CRITICAL, 0    },
+    { DEBUGLOGENTRY_OBJID,        ROUTE_BULK,     0    },
+    { TASKINFO_OBJID,             ROUTE_BULK,     1000 },
+    { CALLBACKINFO_OBJID,         ROUTE_BULK,     1000 },
+};
+
 typedef struct {
     // The task handles.
     xTaskHandle telemetryTxTaskHandle;
@@ -86,6 +126,12 @@ typedef struct {
     // Error statistics.
     uint32_t telemetryTxRetries;
     uint32_t radioTxRetries;
+    uint32_t telemetryTxDropped;
+    uint32_t radioTxDropped;
+
+    // Time the rate limited objects were last relayed, to the telemetry port and to the radio
+    uint32_t telemetryRouteTime[NELEMENTS(routes)];
+    uint32_t radioRouteTime[NELEMENTS(routes)];
 
     // Is this modem the coordinator
     bool     isCoordinator;
@@ -108,10 +154,12 @@ static void radioRxTask(void *parameters);
 static void PPMInputTask(void *parameters);
 static int32_t UAVTalkSendHandler(uint8_t *buf, int32_t length);
 static int32_t RadioSendHandler(uint8_t *buf, int32_t length);
-static void ProcessTelemetryStream(UAVTalkConnection inConnectionHandle, UAVTalkConnection outConnectionHandle, uint8_t rxbyte);
-static void ProcessRadioStream(UAVTalkConnection inConnectionHandle, UAVTalkConnection outConnectionHandle, uint8_t rxbyte);
+static void ProcessTelemetryStream(UAVTalkConnection inConnectionHandle, UAVTalkConnection outConnectionHandle, const uint8_t *rxbuffer, uint16_t length);
+static void ProcessRadioStream(UAVTalkConnection inConnectionHandle, UAVTalkConnection outConnectionHandle, const uint8_t *rxbuffer, uint16_t length);
 static void objectPersistenceUpdatedCb(UAVObjEvent *objEv);
 static void registerObject(UAVObjHandle obj);
+static uint32_t getTelemetryOutputPort();
+static bool routePacket(UAVTalkConnection inConnectionHandle, uint32_t outputPort, uint32_t *routeTime);
 
 // ****************
 // Private variables
@@ -247,6 +295,10 @@ static int32_t RadioComBridgeInitialize(void)
     // Initialize the statistics.
     data->telemetryTxRetries = 0;
     data->radioTxRetries     = 0;
+    data->telemetryTxDropped = 0;
+    data->radioTxDropped     = 0;
+    memset(data->telemetryRouteTime, 0, sizeof(data->telemetryRouteTime));
+    memset(data->radioRouteTime, 0, sizeof(data->radioRouteTime));
 
     data->parseUAVTalk = true;
     data->comSpeed     = OPLINKSETTINGS_COMSPEED_9600;
@@ -300,6 +352,8 @@ static void updateRadioComBridgeStats()
 
     radioComBridgeStats.TelemetryTxRetries     = data->telemetryTxRetries;
     radioComBridgeStats.RadioTxRetries         = data->radioTxRetries;
+    radioComBridgeStats.TelemetryTxDropped     = data->telemetryTxDropped;
+    radioComBridgeStats.RadioTxDropped         = data->radioTxDropped;
 
     // Update stats object
     radioComBridgeStats.TelemetryTxBytes      += telemetryUAVTalkStats.txBytes;
@@ -403,14 +457,12 @@ static void radioRxTask(__attribute__((unused)) void *parameters)
         PIOS_WDG_UpdateFlag(PIOS_WDG_RADIORX);
 #endif
         if (PIOS_COM_RADIO) {
-            uint8_t serial_data[1];
+            uint8_t serial_data[RX_BUFFER_SIZE];
             uint16_t bytes_to_process = PIOS_COM_ReceiveBuffer(PIOS_COM_RADIO, serial_data, sizeof(serial_data), MAX_PORT_DELAY);
             if (bytes_to_process > 0) {
                 if (data->parseUAVTalk) {
                     // Pass the data through the UAVTalk parser.
-                    for (uint8_t i = 0; i < bytes_to_process; i++) {
-                        ProcessRadioStream(data->radioUAVTalkCon, data->telemUAVTalkCon, serial_data[i]);
-                    }
+                    ProcessRadioStream(data->radioUAVTalkCon, data->telemUAVTalkCon, serial_data, bytes_to_process);
                 } else if (PIOS_COM_TELEMETRY) {
                     // Send the data straight to the telemetry port.
                     // Following call can fail with -2 error code (buffer full) or -3 error code (could not acquire send mutex)
@@ -448,12 +500,10 @@ static void telemetryRxTask(__attribute__((unused)) void *parameters)
         }
 #endif /* PIOS_INCLUDE_USB */
         if (inputPort) {
-            uint8_t serial_data[1];
+            uint8_t serial_data[RX_BUFFER_SIZE];
             uint16_t bytes_to_process = PIOS_COM_ReceiveBuffer(inputPort, serial_data, sizeof(serial_data), MAX_PORT_DELAY);
             if (bytes_to_process > 0) {
-                for (uint8_t i = 0; i < bytes_to_process; i++) {
-                    ProcessTelemetryStream(data->telemUAVTalkCon, data->radioUAVTalkCon, serial_data[i]);
-                }
+                ProcessTelemetryStream(data->telemUAVTalkCon, data->radioUAVTalkCon, serial_data, bytes_to_process);
             }
         } else {
             vTaskDelay(5);
@@ -538,14 +588,8 @@ static void serialRxTask(__attribute__((unused)) void *parameters)
 static int32_t UAVTalkSendHandler(uint8_t *buf, int32_t length)
 {
     int32_t ret;
-    uint32_t outputPort = data->parseUAVTalk ? PIOS_COM_TELEMETRY : 0;
+    uint32_t outputPort = getTelemetryOutputPort();
 
-#if defined(PIOS_INCLUDE_USB)
-    // Determine output port (USB takes priority over telemetry port)
-    if (PIOS_COM_TELEM_USB_HID && PIOS_COM_Available(PIOS_COM_TELEM_USB_HID)) {
-        outputPort = PIOS_COM_TELEM_USB_HID;
-    }
-#endif /* PIOS_INCLUDE_USB */
     if (outputPort) {
         // Following call can fail with -2 error code (buffer full) or -3 error code (could not acquire send mutex)
         // It is the caller responsibility to retry in such cases...
@@ -560,6 +604,24 @@ static int32_t UAVTalkSendHandler(uint8_t *buf, int32_t length)
     return ret;
 }
 
+/**
+ * @brief Get the port the telemetry stream is sent to.
+ *
+ * @return the com port, 0 if the telemetry is not sent
+ */
+static uint32_t getTelemetryOutputPort()
+{
+    uint32_t outputPort = data->parseUAVTalk ? PIOS_COM_TELEMETRY : 0;
+
+#if defined(PIOS_INCLUDE_USB)
+    // Determine output port (USB takes priority over telemetry port)
+    if (PIOS_COM_TELEM_USB_HID && PIOS_COM_Available(PIOS_COM_TELEM_USB_HID)) {
+        outputPort = PIOS_COM_TELEM_USB_HID;
+    }
+#endif /* PIOS_INCLUDE_USB */
+    return outputPort;
+}
+
 /**
  * Transmit data buffer to the com port.
  *
@@ -591,18 +653,27 @@ static int32_t RadioSendHandler(uint8_t *buf, int32_t length)
 }
 
 /**
- * @brief Process a byte of data received on the telemetry stream
+ * @brief Process a block of data received on the telemetry stream
  *
  * @param[in] inConnectionHandle  The UAVTalk connection handle on the telemetry port
  * @param[in] outConnectionHandle  The UAVTalk connection handle on the radio port.
- * @param[in] rxbyte  The received byte.
+ * @param[in] rxbuffer  The received bytes.
+ * @param[in] length  The number of received bytes.
  */
-static void ProcessTelemetryStream(UAVTalkConnection inConnectionHandle, UAVTalkConnection outConnectionHandle, uint8_t rxbyte)
+static void ProcessTelemetryStream(UAVTalkConnection inConnectionHandle, UAVTalkConnection outConnectionHandle, const uint8_t *rxbuffer, uint16_t length)
 {
-    // Keep reading until we receive a completed packet.
-    UAVTalkRxState state = UAVTalkProcessInputStreamQuiet(inConnectionHandle, rxbyte);
+    uint16_t position;
+
+    while (length > 0) {
+        // Keep reading until we receive a completed packet.
+        UAVTalkRxState state = UAVTalkProcessInputBufferQuiet(inConnectionHandle, rxbuffer, length, &position);
+        rxbuffer += position;
+        length   -= position;
+        if (state != UAVTALK_STATE_COMPLETE) {
+            // The whole buffer was parsed
+            break;
+        }
 
-    if (state == UAVTALK_STATE_COMPLETE) {
         // We only want to unpack certain telemetry objects
         uint32_t objId = UAVTalkGetPacketObjId(inConnectionHandle);
         switch (objId) {
@@ -630,26 +701,39 @@ static void ProcessTelemetryStream(UAVTalkConnection inConnectionHandle, UAVTalk
             UAVTalkRelayPacket(inConnectionHandle, outConnectionHandle);
             break;
         default:
-            // all other packets are relayed to the remote modem
-            UAVTalkRelayPacket(inConnectionHandle, outConnectionHandle);
+            // all other packets are relayed to the remote modem, as the routing table allows
+            if (routePacket(inConnectionHandle, PIOS_COM_RADIO, data->radioRouteTime)) {
+                UAVTalkRelayPacket(inConnectionHandle, outConnectionHandle);
+            } else {
+                data->radioTxDropped++;
+            }
             break;
         }
     }
 }
 
 /**
- * @brief Process a byte of data received on the radio data stream.
+ * @brief Process a block of data received on the radio data stream.
  *
  * @param[in] inConnectionHandle  The UAVTalk connection handle on the radio port.
  * @param[in] outConnectionHandle  The UAVTalk connection handle on the telemetry port.
- * @param[in] rxbyte  The received byte.
+ * @param[in] rxbuffer  The received bytes.
+ * @param[in] length  The number of received bytes.
  */
-static void ProcessRadioStream(UAVTalkConnection inConnectionHandle, UAVTalkConnection outConnectionHandle, uint8_t rxbyte)
+static void ProcessRadioStream(UAVTalkConnection inConnectionHandle, UAVTalkConnection outConnectionHandle, const uint8_t *rxbuffer, uint16_t length)
 {
-    // Keep reading until we receive a completed packet.
-    UAVTalkRxState state = UAVTalkProcessInputStreamQuiet(inConnectionHandle, rxbyte);
+    uint16_t position;
+
+    while (length > 0) {
+        // Keep reading until we receive a completed packet.
+        UAVTalkRxState state = UAVTalkProcessInputBufferQuiet(inConnectionHandle, rxbuffer, length, &position);
+        rxbuffer += position;
+        length   -= position;
+        if (state != UAVTALK_STATE_COMPLETE) {
+            // The whole buffer was parsed
+            break;
+        }
 
-    if (state == UAVTALK_STATE_COMPLETE) {
         // We only want to unpack certain objects from the remote modem
         // Similarly we only want to relay certain objects to the telemetry port
         uint32_t objId = UAVTalkGetPacketObjId(inConnectionHandle);
@@ -672,11 +756,75 @@ static void ProcessRadioStream(UAVTalkConnection inConnectionHandle, UAVTalkConn
             UAVTalkReceiveObject(inConnectionHandle);
             break;
         default:
-            // all other packets are relayed to the telemetry port
-            UAVTalkRelayPacket(inConnectionHandle, outConnectionHandle);
+            // all other packets are relayed to the telemetry port, as the routing table allows
+            if (routePacket(inConnectionHandle, getTelemetryOutputPort(), data->telemetryRouteTime)) {
+                UAVTalkRelayPacket(inConnectionHandle, outConnectionHandle);
+            } else {
+                data->telemetryTxDropped++;
+            }
+            break;
+        }
+    }
+}
+
+/**
+ * @brief Check the routing table to know if the packet that was just received should be relayed.
+ *
+ * Only the unacknowledged updates are dropped or rate limited, requests, acks and acknowledged
+ * updates are always relayed so that the transactions between the GCS and the flight controller
+ * are not broken. Dropped object requests are answered with a timeout and retried by the GCS.
+ *
+ * @param[in] inConnectionHandle  The UAVTalk connection handle the packet was received on.
+ * @param[in] outputPort  The com port the packet would be relayed to.
+ * @param[in] routeTime  The time the rate limited objects were last relayed to that port.
+ * @return true if the packet should be relayed
+ */
+static bool routePacket(UAVTalkConnection inConnectionHandle, uint32_t outputPort, uint32_t *routeTime)
+{
+    uint8_t type = UAVTalkGetPacketType(inConnectionHandle);
+
+    if (type != UAVTALK_TYPE_OBJ && type != UAVTALK_TYPE_OBJ_TS && type != UAVTALK_TYPE_BUNDLE) {
+        return true;
+    }
+
+    uint32_t objId = UAVTalkGetPacketObjId(inConnectionHandle);
+    uint8_t routeClass = ROUTE_NORMAL;
+    uint8_t i;
+    for (i = 0; i < NELEMENTS(routes); i++) {
+        if (routes[i].objId == objId) {
+            routeClass = routes[i].routeClass;
             break;
         }
     }
+
+    uint16_t txFree = outputPort ? PIOS_COM_GetTxFree(outputPort) : 0;
+    switch (routeClass) {
+    case ROUTE_CRITICAL:
+        return true;
+
+    case ROUTE_NORMAL:
+        if (txFree < ROUTE_NORMAL_MIN_FREE) {
+            return false;
+        }
+        break;
+    case ROUTE_BULK:
+        if (txFree < ROUTE_BULK_MIN_FREE) {
+            return false;
+        }
+        break;
+    default:
+        return false;
+    }
+
+    if (i < NELEMENTS(routes) && routes[i].minPeriodMs) {
+        uint32_t now = xTaskGetTickCount() * portTICK_RATE_MS;
+        if (now - routeTime[i] < routes[i].minPeriodMs) {
+            return false;
+        }
+        routeTime[i] = now;
+    }
+
+    return true;
 }
 
 /**
@@ -180,9 +180,23 @@ static void receiverTask(__attribute__((unused)) void *parameters)
     float scaledChannel[MANUALCONTROLSETTINGS_CHANNELGROUPS_NUMELEM] = { 0 };
     SystemSettingsThrustControlOptions thrustType;
 
+    ManualControlSettingsGet(&settings);
+
     while (1) {
-        // Wait until next update
-        vTaskDelayUntil(&lastSysTime, UPDATE_PERIOD_MS / portTICK_RATE_MS);
+        // Wait until the receiver of the throttle channel has decoded a new frame, if it can tell,
+        // so the frame is used as soon as it is complete. Never wait longer than the update period.
+        extern uint32_t pios_rcvr_group_map[];
+        xSemaphoreHandle frameSemaphore = NULL;
+        if (settings.ChannelGroups.Throttle < MANUALCONTROLSETTINGS_CHANNELGROUPS_NONE) {
+            frameSemaphore = PIOS_RCVR_GetSemaphore(pios_rcvr_group_map[settings.ChannelGroups.Throttle],
+                                                    settings.ChannelNumber.Throttle);
+        }
+        if (frameSemaphore) {
+            xSemaphoreTake(frameSemaphore, UPDATE_PERIOD_MS / portTICK_RATE_MS);
+            lastSysTime = xTaskGetTickCount();
+        } else {
+            vTaskDelayUntil(&lastSysTime, UPDATE_PERIOD_MS / portTICK_RATE_MS);
+        }
 #ifdef PIOS_INCLUDE_WDG
         PIOS_WDG_UpdateFlag(PIOS_WDG_MANUAL);
 #endif
@@ -221,8 +235,6 @@ static void receiverTask(__attribute__((unused)) void *parameters)
 
         // Read channel values in us
         for (uint8_t n = 0; n < MANUALCONTROLSETTINGS_CHANNELGROUPS_NUMELEM && n < MANUALCONTROLCOMMAND_CHANNEL_NUMELEM; ++n) {
-            extern uint32_t pios_rcvr_group_map[];
-
             if (ManualControlSettingsChannelGroupsToArray(settings.ChannelGroups)[n] >= MANUALCONTROLSETTINGS_CHANNELGROUPS_NONE) {
                 cmd.Channel[n] = PIOS_RCVR_INVALID;
             } else {
@@ -107,12 +107,15 @@ typedef struct {
     Vector3i32 accum[2];
     int32_t    temperature;
     uint32_t   count;
+    uint32_t   timestamp; // capture time of the newest sample, 0 if unknown
 } sensor_fetch_context;
 
-#define MAX_SENSOR_DATA_SIZE (sizeof(PIOS_SENSORS_3Axis_SensorsWithTemp) + MAX_SENSORS_PER_INSTANCE * sizeof(Vector3i16))
+// large enough for a burst of samples from drivers reading their FIFO in one go
+#define MAX_SENSOR_DATA_SIZE (sizeof(PIOS_SENSORS_3Axis_SensorsBurstWithTemp) + PIOS_SENSORS_MAX_BURST * MAX_SENSORS_PER_INSTANCE * sizeof(Vector3i16))
 typedef union {
-    PIOS_SENSORS_3Axis_SensorsWithTemp sensorSample3Axis;
-    PIOS_SENSORS_1Axis_SensorsWithTemp sensorSample1Axis;
+    PIOS_SENSORS_3Axis_SensorsWithTemp      sensorSample3Axis;
+    PIOS_SENSORS_1Axis_SensorsWithTemp      sensorSample1Axis;
+    PIOS_SENSORS_3Axis_SensorsBurstWithTemp sensorBurst3Axis;
 } sensor_data;
 
 #define PIOS_INSTRUMENT_MODULE
@@ -124,19 +127,22 @@ PERF_DEFINE_COUNTER(counterMagPeriod);
 PERF_DEFINE_COUNTER(counterBaroPeriod);
 PERF_DEFINE_COUNTER(counterSensorPeriod);
 PERF_DEFINE_COUNTER(counterSensorResets);
+PERF_DEFINE_COUNTER(counterSensorProcess);
+PERF_DEFINE_COUNTER(counterSensorLatency);
 
 // Private functions
 static void SensorsTask(void *parameters);
 static void settingsUpdatedCb(UAVObjEvent *objEv);
 
 static void accumulateSamples(sensor_fetch_context *sensor_context, sensor_data *sample);
+static void accumulateBurst(sensor_fetch_context *sensor_context, sensor_data *sample);
 static void processSamples3d(sensor_fetch_context *sensor_context, const PIOS_SENSORS_Instance *sensor);
 static void processSamples1d(PIOS_SENSORS_1Axis_SensorsWithTemp *sample, const PIOS_SENSORS_Instance *sensor);
 
 static void clearContext(sensor_fetch_context *sensor_context);
 
 static void handleAccel(float *samples, float temperature);
-static void handleGyro(float *samples, float temperature);
+static void handleGyro(float *samples, float temperature, uint32_t timestamp);
 static void handleMag(float *samples, float temperature);
 static void handleBaro(float sample, float temperature);
 
@@ -253,6 +259,8 @@ static void SensorsTask(__attribute__((unused)) void *parameters)
     PERF_INIT_COUNTER(counterBaroPeriod, 0x53000004);
     PERF_INIT_COUNTER(counterSensorPeriod, 0x53000005);
     PERF_INIT_COUNTER(counterSensorResets, 0x53000006);
+    PERF_INIT_COUNTER(counterSensorProcess, 0x53000007);
+    PERF_INIT_COUNTER(counterSensorLatency, 0x53000008);
 
     // Test sensors
     bool sensors_test = true;
@@ -299,10 +307,16 @@ static void SensorsTask(__attribute__((unused)) void *parameters)
                 while (xQueueReceive(queue,
                                      (void *)source_data,
                                      (is_primary && !sensor_context.count) ? sensor_period_ticks : 0) == pdTRUE) {
-                    accumulateSamples(&sensor_context, source_data);
+                    if (sensor->driver->is_burst) {
+                        accumulateBurst(&sensor_context, source_data);
+                    } else {
+                        accumulateSamples(&sensor_context, source_data);
+                    }
                 }
                 if (sensor_context.count) {
+                    PERF_TIMED_SECTION_START(counterSensorProcess);
                     processSamples3d(&sensor_context, sensor);
+                    PERF_TIMED_SECTION_END(counterSensorProcess);
                     clearContext(&sensor_context);
                 } else if (is_primary) {
                     PIOS_SENSOR_Reset(sensor);
@@ -311,7 +325,11 @@ static void SensorsTask(__attribute__((unused)) void *parameters)
                     error = true;
                 }
             } else {
+                // event driven sensors are only fetched once their data ready interrupt fired
                 if (PIOS_SENSORS_Poll(sensor)) {
+                    if (sensor->driver->is_event_driven) {
+                        PERF_TRACK_VALUE(counterSensorLatency, PIOS_DELAY_GetuSSince(PIOS_SENSORS_GetDataReadyTime(sensor)));
+                    }
                     PIOS_SENSOR_Fetch(sensor, (void *)source_data, MAX_SENSORS_PER_INSTANCE);
                     if (sensor->type & PIOS_SENSORS_TYPE_3D) {
                         accumulateSamples(&sensor_context, source_data);
@@ -339,6 +357,7 @@ static void clearContext(sensor_fetch_context *sensor_context)
     }
     sensor_context->temperature = 0;
     sensor_context->count = 0;
+    sensor_context->timestamp   = 0;
 }
 
 static void accumulateSamples(sensor_fetch_context *sensor_context, sensor_data *sample)
@@ -350,6 +369,27 @@ static void accumulateSamples(sensor_fetch_context *sensor_context, sensor_data
     }
     sensor_context->temperature += sample->sensorSample3Axis.temperature;
     sensor_context->count++;
+    sensor_context->timestamp    = sample->sensorSample3Axis.timestamp;
+}
+
+static void accumulateBurst(sensor_fetch_context *sensor_context, sensor_data *sample)
+{
+    const PIOS_SENSORS_3Axis_SensorsBurstWithTemp *burst = &sample->sensorBurst3Axis;
+    const uint32_t sensors = (burst->count < MAX_SENSORS_PER_INSTANCE) ? burst->count : MAX_SENSORS_PER_INSTANCE;
+    const uint32_t samples = (burst->burst < PIOS_SENSORS_MAX_BURST) ? burst->burst : PIOS_SENSORS_MAX_BURST;
+
+    // samples are interleaved, sensor i of sample j is at j * count + i
+    for (uint32_t j = 0; j < samples; j++) {
+        const Vector3i16 *row = &burst->sample[j * burst->count];
+        for (uint32_t i = 0; i < sensors; i++) {
+            sensor_context->accum[i].x += row[i].x;
+            sensor_context->accum[i].y += row[i].y;
+            sensor_context->accum[i].z += row[i].z;
+        }
+    }
+    sensor_context->temperature += burst->temperature * (int32_t)samples;
+    sensor_context->count += samples;
+    sensor_context->timestamp    = burst->timestamp;
 }
 
 static void processSamples3d(sensor_fetch_context *sensor_context, const PIOS_SENSORS_Instance *sensor)
@@ -388,7 +428,7 @@ static void processSamples3d(sensor_fetch_context *sensor_context, const PIOS_SE
         samples[1]  = ((float)sensor_context->accum[index].y * t);
         samples[2]  = ((float)sensor_context->accum[index].z * t);
         temperature = (float)sensor_context->temperature * inv_count * 0.01f;
-        handleGyro(samples, temperature);
+        handleGyro(samples, temperature, sensor_context->timestamp);
         return;
     }
 }
@@ -423,10 +463,13 @@ static void handleAccel(float *samples, float temperature)
     AccelSensorSet(&accelSensorData);
 }
 
-static void handleGyro(float *samples, float temperature)
+static void handleGyro(float *samples, float temperature, uint32_t timestamp)
 {
     GyroSensorData gyroSensorData;
 
+    // stamp the sample with its capture time, the filters integrate over it and the
+    // end to end latency is measured from it downstream
+    gyroSensorData.SampleTime = timestamp ? timestamp : PIOS_DELAY_GetRaw();
     updateGyroTempBias(temperature);
     float gyros_out[3] = { samples[0] * agcal.gyro_scale.X - agcal.gyro_bias.X - gyro_temp_bias[0],
                            samples[1] * agcal.gyro_scale.Y - agcal.gyro_bias.Y - gyro_temp_bias[1],
@@ -69,11 +69,14 @@
 #include "taskinfo.h"
 
 #include "CoordinateConversions.h"
+#include "sensorsim.h"
 
 // Private constants
 #define STACK_SIZE_BYTES 1540
 #define TASK_PRIORITY    (tskIDLE_PRIORITY + 3)
 #define SENSOR_PERIOD    2
+// Samples the quadcopter model generates at once in lockstep
+#define SIM_BLOCK_LENGTH 8
 
 #define F_PI             3.14159265358979323846f
 #define PI_MOD(x) (fmod(x + F_PI, F_PI * 2) - F_PI)
@@ -91,6 +94,10 @@ static void simulateModelAirplane();
 
 static float accel_bias[3];
 
+static struct sensorsim_state simState;
+static struct sensorsim_block simBlock;
+static uint16_t simSample;
+
 static float rand_gauss();
 
 enum sensor_sim_type { CONSTANT, MODEL_AGNOSTIC, MODEL_QUADCOPTER, MODEL_AIRPLANE } sensor_sim_type;
@@ -105,6 +112,7 @@ int32_t SensorsInitialize(void)
     accel_bias[0] = rand_gauss() / 10;
     accel_bias[1] = rand_gauss() / 10;
     accel_bias[2] = rand_gauss() / 10;
+    SensorSimInit(&simState, 0);
 
     AccelSensorInitialize();
     AttitudeSimulatedInitialize();
@@ -226,6 +234,7 @@ static void simulateConstant()
     gyroSensorData.x = 0;
     gyroSensorData.y = 0;
     gyroSensorData.z = 0;
+    gyroSensorData.SampleTime = PIOS_DELAY_GetRaw();
 
 /* TODO
     // Apply bias correction to the gyros
@@ -288,6 +297,7 @@ static void simulateModelAgnostic()
     gyroSensorData.x = rateDesired.Roll + rand_gauss();
     gyroSensorData.y = rateDesired.Pitch + rand_gauss();
     gyroSensorData.z = rateDesired.Yaw + rand_gauss();
+    gyroSensorData.SampleTime = PIOS_DELAY_GetRaw();
 
 /* TODO
     // Apply bias correction to the gyros
@@ -323,88 +333,74 @@ static void simulateModelAgnostic()
 
 float thrustToDegs   = 50;
 bool overideAttitude = false;
+/**
+ * Quadcopter model, run by the sensorsim library. In lockstep the simulated
+ * time is exact, the samples are generated SIM_BLOCK_LENGTH at a time with the
+ * commands held over the block, then published one per task period. In real
+ * time one sample is generated per period, over the measured period.
+ */
 static void simulateModelQuadcopter()
 {
-    static double pos[3]       = { 0, 0, 0 };
-    static double vel[3]       = { 0, 0, 0 };
-    static double ned_accel[3] = { 0, 0, 0 };
-    static float q[4]          = { 1, 0, 0, 0 };
-    static float rpy[3]        = { 0, 0, 0 }; // Low pass filtered actuator
-    static float baro_offset   = 0.0f;
-    float Rbe[3][3];
-
-    const float ACTUATOR_ALPHA = 0.8;
-    const float MAX_THRUST     = GRAV * 2;
-    const float K_FRICTION     = 1;
-    const float GPS_PERIOD     = 0.1;
-    const float MAG_PERIOD     = 1.0 / 75.0;
-    const float BARO_PERIOD    = 1.0 / 20.0;
-
     static uint32_t last_time;
 
-    float dT = (PIOS_DELAY_DiffuS(last_time) / 1e6);
+    HomeLocationData homeLocation;
 
-    if (dT < 1e-3) {
-        dT = 2e-3;
-    }
-    last_time = PIOS_DELAY_GetRaw();
+    HomeLocationGet(&homeLocation);
 
-    FlightStatusData flightStatus;
-    FlightStatusGet(&flightStatus);
-    ActuatorDesiredData actuatorDesired;
-    ActuatorDesiredGet(&actuatorDesired);
+    if (simSample >= simBlock.count) {
+        uint16_t count     = 1;
+        uint32_t period_us = PIOS_DELAY_DiffuS(last_time);
+        last_time = PIOS_DELAY_GetRaw();
 
-    float thrust = (flightStatus.Armed == FLIGHTSTATUS_ARMED_ARMED) ? actuatorDesired.Throttle * MAX_THRUST : 0;
-    if (thrust < 0) {
-        thrust = 0;
-    }
+#if defined(PIOS_INCLUDE_SIMCLOCK)
+        if (PIOS_SIMCLOCK_IsLockstep()) {
+            count     = SIM_BLOCK_LENGTH;
+            period_us = SENSOR_PERIOD * 1000;
+        }
+#endif
+        if (period_us < 1000 || period_us > 100000) {
+            period_us = SENSOR_PERIOD * 1000;
+        }
 
-    if (thrust != thrust) {
-        thrust = 0;
+        FlightStatusData flightStatus;
+        FlightStatusGet(&flightStatus);
+        ActuatorDesiredData actuatorDesired;
+        ActuatorDesiredGet(&actuatorDesired);
+        RateDesiredData rateDesired;
+        RateDesiredGet(&rateDesired);
+
+        struct sensorsim_input input;
+        input.armed    = (flightStatus.Armed == FLIGHTSTATUS_ARMED_ARMED);
+        input.throttle = actuatorDesired.Throttle;
+        input.rate[0]  = rateDesired.Roll;
+        input.rate[1]  = rateDesired.Pitch;
+        input.rate[2]  = rateDesired.Yaw;
+        input.Be[0]    = homeLocation.Be[0];
+        input.Be[1]    = homeLocation.Be[1];
+        input.Be[2]    = homeLocation.Be[2];
+
+        SensorSimRun(&simState, &input, count, period_us, &simBlock);
+        simSample = 0;
     }
 
-// float control_scaling = thrust * thrustToDegs;
-//// In rad/s
-// rpy[0] = control_scaling * actuatorDesired.Roll * (1 - ACTUATOR_ALPHA) + rpy[0] * ACTUATOR_ALPHA;
-// rpy[1] = control_scaling * actuatorDesired.Pitch * (1 - ACTUATOR_ALPHA) + rpy[1] * ACTUATOR_ALPHA;
-// rpy[2] = control_scaling * actuatorDesired.Yaw * (1 - ACTUATOR_ALPHA) + rpy[2] * ACTUATOR_ALPHA;
-//
-// GyrosData gyroSensorData; // Skip get as we set all the fields
-// gyroSensorData.x = rpy[0] * 180 / M_PI + rand_gauss();
-// gyroSensorData.y = rpy[1] * 180 / M_PI + rand_gauss();
-// gyroSensorData.z = rpy[2] * 180 / M_PI + rand_gauss();
-
-    RateDesiredData rateDesired;
-    RateDesiredGet(&rateDesired);
-
-    rpy[0] = (flightStatus.Armed == FLIGHTSTATUS_ARMED_ARMED) * rateDesired.Roll * (1 - ACTUATOR_ALPHA) + rpy[0] * ACTUATOR_ALPHA;
-    rpy[1] = (flightStatus.Armed == FLIGHTSTATUS_ARMED_ARMED) * rateDesired.Pitch * (1 - ACTUATOR_ALPHA) + rpy[1] * ACTUATOR_ALPHA;
-    rpy[2] = (flightStatus.Armed == FLIGHTSTATUS_ARMED_ARMED) * rateDesired.Yaw * (1 - ACTUATOR_ALPHA) + rpy[2] * ACTUATOR_ALPHA;
+    const uint16_t n = simSample++;
 
     GyroSensorData gyroSensorData; // Skip get as we set all the fields
-    gyroSensorData.x = rpy[0] + rand_gauss();
-    gyroSensorData.y = rpy[1] + rand_gauss();
-    gyroSensorData.z = rpy[2] + rand_gauss();
+    gyroSensorData.x = simBlock.gyro[0][n];
+    gyroSensorData.y = simBlock.gyro[1][n];
+    gyroSensorData.z = simBlock.gyro[2][n];
+    gyroSensorData.temperature = 30;
+    gyroSensorData.SampleTime  = PIOS_DELAY_GetRaw();
     GyroSensorSet(&gyroSensorData);
 
-    // Predict the attitude forward in time
-    float qdot[4];
-    qdot[0] = (-q[1] * rpy[0] - q[2] * rpy[1] - q[3] * rpy[2]) * dT * M_PI / 180 / 2;
-    qdot[1] = (q[0] * rpy[0] - q[3] * rpy[1] + q[2] * rpy[2]) * dT * M_PI / 180 / 2;
-    qdot[2] = (q[3] * rpy[0] + q[0] * rpy[1] - q[1] * rpy[2]) * dT * M_PI / 180 / 2;
-    qdot[3] = (-q[2] * rpy[0] + q[1] * rpy[1] + q[0] * rpy[2]) * dT * M_PI / 180 / 2;
+    AccelSensorData accelSensorData; // Skip get as we set all the fields
+    accelSensorData.x = simBlock.accel[0][n];
+    accelSensorData.y = simBlock.accel[1][n];
+    accelSensorData.z = simBlock.accel[2][n];
+    accelSensorData.temperature = 30;
+    AccelSensorSet(&accelSensorData);
 
-    // Take a time step
-    q[0]    = q[0] + qdot[0];
-    q[1]    = q[1] + qdot[1];
-    q[2]    = q[2] + qdot[2];
-    q[3]    = q[3] + qdot[3];
-
-    float qmag = sqrtf(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
-    q[0]    = q[0] / qmag;
-    q[1]    = q[1] / qmag;
-    q[2]    = q[2] / qmag;
-    q[3]    = q[3] / qmag;
+    float q[4] = { simBlock.q[0][n], simBlock.q[1][n], simBlock.q[2][n], simBlock.q[3][n] };
 
     if (overideAttitude) {
         AttitudeStateData attitudeState;
@@ -416,125 +412,45 @@ static void simulateModelQuadcopter()
         AttitudeStateSet(&attitudeState);
     }
 
-    static float wind[3] = { 0, 0, 0 };
-    wind[0] = wind[0] * 0.95 + rand_gauss() / 10.0;
-    wind[1] = wind[1] * 0.95 + rand_gauss() / 10.0;
-    wind[2] = wind[2] * 0.95 + rand_gauss() / 10.0;
-
-    Quaternion2R(q, Rbe);
-    // Make thrust negative as down is positive
-    ned_accel[0]  = -thrust * Rbe[2][0];
-    ned_accel[1]  = -thrust * Rbe[2][1];
-    // Gravity causes acceleration of 9.81 in the down direction
-    ned_accel[2]  = -thrust * Rbe[2][2] + GRAV;
-
-    // Apply acceleration based on velocity
-    ned_accel[0] -= K_FRICTION * (vel[0] - wind[0]);
-    ned_accel[1] -= K_FRICTION * (vel[1] - wind[1]);
-    ned_accel[2] -= K_FRICTION * (vel[2] - wind[2]);
-
-    // Predict the velocity forward in time
-    vel[0] = vel[0] + ned_accel[0] * dT;
-    vel[1] = vel[1] + ned_accel[1] * dT;
-    vel[2] = vel[2] + ned_accel[2] * dT;
-
-    // Predict the position forward in time
-    pos[0] = pos[0] + vel[0] * dT;
-    pos[1] = pos[1] + vel[1] * dT;
-    pos[2] = pos[2] + vel[2] * dT;
-
-    // Simulate hitting ground
-    if (pos[2] > 0) {
-        pos[2] = 0;
-        vel[2] = 0;
-        ned_accel[2] = 0;
-    }
-
-    // Sensor feels gravity (when not acceleration in ned frame e.g. ned_accel[2] = 0)
-    ned_accel[2] -= 9.81;
-
-    // Transform the accels back in to body frame
-    AccelSensorData accelSensorData; // Skip get as we set all the fields
-    accelSensorData.x = ned_accel[0] * Rbe[0][0] + ned_accel[1] * Rbe[0][1] + ned_accel[2] * Rbe[0][2] + accel_bias[0];
-    accelSensorData.y = ned_accel[0] * Rbe[1][0] + ned_accel[1] * Rbe[1][1] + ned_accel[2] * Rbe[1][2] + accel_bias[1];
-    accelSensorData.z = ned_accel[0] * Rbe[2][0] + ned_accel[1] * Rbe[2][1] + ned_accel[2] * Rbe[2][2] + accel_bias[2];
-    accelSensorData.temperature = 30;
-    AccelSensorSet(&accelSensorData);
-
-    if (baro_offset == 0) {
-        // Hacky initialization
-        baro_offset = 50; // * rand_gauss();
-    } else {
-        // Very small drift process
-        baro_offset += rand_gauss() / 100;
-    }
-    // Update baro periodically
-    static uint32_t last_baro_time = 0;
-    if (PIOS_DELAY_DiffuS(last_baro_time) / 1.0e6 > BARO_PERIOD) {
+    if (simBlock.due[n] & SENSORSIM_DUE_BARO) {
         BaroSensorData baroSensor;
         BaroSensorGet(&baroSensor);
-        baroSensor.Altitude = -pos[2] + baro_offset;
+        baroSensor.Altitude = simBlock.baro_altitude[n];
         BaroSensorSet(&baroSensor);
-        last_baro_time = PIOS_DELAY_GetRaw();
     }
 
-    HomeLocationData homeLocation;
-    HomeLocationGet(&homeLocation);
-
-    static float gps_vel_drift[3] = { 0, 0, 0 };
-    gps_vel_drift[0] = gps_vel_drift[0] * 0.65 + rand_gauss() / 5.0;
-    gps_vel_drift[1] = gps_vel_drift[1] * 0.65 + rand_gauss() / 5.0;
-    gps_vel_drift[2] = gps_vel_drift[2] * 0.65 + rand_gauss() / 5.0;
-
-    // Update GPS periodically
-    static uint32_t last_gps_time = 0;
-    if (PIOS_DELAY_DiffuS(last_gps_time) / 1.0e6 > GPS_PERIOD) {
+    if (simBlock.due[n] & SENSORSIM_DUE_GPS) {
         // Use double precision here as simulating what GPS produces
         double T[3];
         T[0] = homeLocation.Altitude + 6.378137E6f * M_PI / 180.0;
         T[1] = cos(homeLocation.Latitude / 10e6 * M_PI / 180.0f) * (homeLocation.Altitude + 6.378137E6) * M_PI / 180.0;
         T[2] = -1.0;
 
-        static float gps_drift[3] = { 0, 0, 0 };
-        gps_drift[0] = gps_drift[0] * 0.95 + rand_gauss() / 10.0;
-        gps_drift[1] = gps_drift[1] * 0.95 + rand_gauss() / 10.0;
-        gps_drift[2] = gps_drift[2] * 0.95 + rand_gauss() / 10.0;
-
         GPSPositionSensorData gpsPosition;
         GPSPositionSensorGet(&gpsPosition);
-        gpsPosition.Latitude    = homeLocation.Latitude + ((pos[0] + gps_drift[0]) / T[0] * 10.0e6);
-        gpsPosition.Longitude   = homeLocation.Longitude + ((pos[1] + gps_drift[1]) / T[1] * 10.0e6);
-        gpsPosition.Altitude    = homeLocation.Altitude + ((pos[2] + gps_drift[2]) / T[2]);
-        gpsPosition.Groundspeed = sqrt(pow(vel[0] + gps_vel_drift[0], 2) + pow(vel[1] + gps_vel_drift[1], 2));
-        gpsPosition.Heading     = 180 / M_PI * atan2(vel[1] + gps_vel_drift[1], vel[0] + gps_vel_drift[0]);
+        gpsPosition.Latitude    = homeLocation.Latitude + (simBlock.gps_pos[0][n] / T[0] * 10.0e6);
+        gpsPosition.Longitude   = homeLocation.Longitude + (simBlock.gps_pos[1][n] / T[1] * 10.0e6);
+        gpsPosition.Altitude    = homeLocation.Altitude + (simBlock.gps_pos[2][n] / T[2]);
+        gpsPosition.Groundspeed = sqrtf(powf(simBlock.gps_vel[0][n], 2) + powf(simBlock.gps_vel[1][n], 2));
+        gpsPosition.Heading     = 180 / M_PI * atan2f(simBlock.gps_vel[1][n], simBlock.gps_vel[0][n]);
         gpsPosition.Satellites  = 7;
         gpsPosition.PDOP = 1;
         GPSPositionSensorSet(&gpsPosition);
-        last_gps_time    = PIOS_DELAY_GetRaw();
-    }
 
-    // Update GPS Velocity measurements
-    static uint32_t last_gps_vel_time = 1000; // Delay by a millisecond
-    if (PIOS_DELAY_DiffuS(last_gps_vel_time) / 1.0e6 > GPS_PERIOD) {
         GPSVelocitySensorData gpsVelocity;
         GPSVelocitySensorGet(&gpsVelocity);
-        gpsVelocity.North = vel[0] + gps_vel_drift[0];
-        gpsVelocity.East  = vel[1] + gps_vel_drift[1];
-        gpsVelocity.Down  = vel[2] + gps_vel_drift[2];
+        gpsVelocity.North = simBlock.gps_vel[0][n];
+        gpsVelocity.East  = simBlock.gps_vel[1][n];
+        gpsVelocity.Down  = simBlock.gps_vel[2][n];
         GPSVelocitySensorSet(&gpsVelocity);
-        last_gps_vel_time = PIOS_DELAY_GetRaw();
     }
 
-    // Update mag periodically
-    static uint32_t last_mag_time = 0;
-    if (PIOS_DELAY_DiffuS(last_mag_time) / 1.0e6 > MAG_PERIOD) {
+    if (simBlock.due[n] & SENSORSIM_DUE_MAG) {
         MagSensorData mag;
-        mag.x = homeLocation.Be[0] * Rbe[0][0] + homeLocation.Be[1] * Rbe[0][1] + homeLocation.Be[2] * Rbe[0][2];
-        mag.y = homeLocation.Be[0] * Rbe[1][0] + homeLocation.Be[1] * Rbe[1][1] + homeLocation.Be[2] * Rbe[1][2];
-        mag.z = homeLocation.Be[0] * Rbe[2][0] + homeLocation.Be[1] * Rbe[2][1] + homeLocation.Be[2] * Rbe[2][2];
-
+        mag.x = simBlock.mag[0][n];
+        mag.y = simBlock.mag[1][n];
+        mag.z = simBlock.mag[2][n];
         MagSensorSet(&mag);
-        last_mag_time = PIOS_DELAY_GetRaw();
     }
 
     AttitudeSimulatedData attitudeSimulated;
@@ -544,12 +460,12 @@ static void simulateModelQuadcopter()
     attitudeSimulated.q3 = q[2];
     attitudeSimulated.q4 = q[3];
     Quaternion2RPY(q, &attitudeSimulated.Roll);
-    attitudeSimulated.Position[0] = pos[0];
-    attitudeSimulated.Position[1] = pos[1];
-    attitudeSimulated.Position[2] = pos[2];
-    attitudeSimulated.Velocity[0] = vel[0];
-    attitudeSimulated.Velocity[1] = vel[1];
-    attitudeSimulated.Velocity[2] = vel[2];
+    attitudeSimulated.Position[0] = simBlock.pos[0][n];
+    attitudeSimulated.Position[1] = simBlock.pos[1][n];
+    attitudeSimulated.Position[2] = simBlock.pos[2][n];
+    attitudeSimulated.Velocity[0] = simBlock.vel[0][n];
+    attitudeSimulated.Velocity[1] = simBlock.vel[1][n];
+    attitudeSimulated.Velocity[2] = simBlock.vel[2][n];
     AttitudeSimulatedSet(&attitudeSimulated);
 }
 
@@ -637,6 +553,7 @@ static void simulateModelAirplane()
     gyroSensorData.x = rpy[0] + rand_gauss();
     gyroSensorData.y = rpy[1] + rand_gauss();
     gyroSensorData.z = rpy[2] + rand_gauss();
+    gyroSensorData.SampleTime = PIOS_DELAY_GetRaw();
     GyroSensorSet(&gyroSensorData);
 
     // Predict the attitude forward in time
@@ -0,0 +1,240 @@
+/**
+ ******************************************************************************
+ *
+ * @file       dynamicnotch.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @brief      Collects gyro samples, finds the dominant vibration peaks with an
+ *             FFT and moves a notch in the gyro filter bank onto them.
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+
+#include <openpilot.h>
+
+#include <callbackinfo.h>
+
+#include <mathmisc.h>
+#include <fft.h>
+#include <dynamicnotch.h>
+#include <gyrospectrum.h>
+
+#ifdef REVOLUTION
+
+// Private constants
+#define CALLBACK_PRIORITY CALLBACK_PRIORITY_LOW
+#define CBTASK_PRIORITY   CALLBACK_TASK_AUXILIARY
+
+#define STACK_SIZE_BYTES  512
+
+#define FFT_LOG2N         7
+#define FFT_N             (1 << FFT_LOG2N)
+#define SAMPLE_SCALE      8.0f // deg/s to FFT input, full scale is +-4096 deg/s
+#define FREQUENCY_ALPHA   0.7f // low pass on the notch frequency to avoid jumps
+#define PEAK_RATIO        8 // power of a peak over the band average to be tracked
+
+// Private types
+struct data {
+    struct FFTq15 fft;
+    int16_t samples[2][3][FFT_N];
+    int16_t re[FFT_N];
+    int16_t im[FFT_N];
+    uint32_t power[FFT_N / 2];
+};
+
+// Private variables
+static DelayedCallbackInfo *callbackHandle;
+static struct data *data;
+static volatile bool enabled;
+static float minFrequency;
+static float maxFrequency;
+static float notchQ;
+static float notchFrequency;
+static int8_t notchStage = -1;
+static uint8_t fillBuffer;
+static uint16_t fillCount;
+// set while the callback owns the buffer that is not being filled
+static volatile bool processing;
+// new notch coefficients handed over to the gyro update
+static volatile bool coeffsPending;
+static struct BiquadCoeffs pendingCoeffs;
+
+// Private functions
+static void dynamicNotchTask(void);
+static float peakOffset(const uint32_t *power, uint16_t bin);
+
+void stabilizationDynamicNotchInit()
+{
+    GyroSpectrumInitialize();
+    callbackHandle = PIOS_CALLBACKSCHEDULER_Create(&dynamicNotchTask, CALLBACK_PRIORITY, CBTASK_PRIORITY, CALLBACKINFO_RUNNING_STABILIZATION2, STACK_SIZE_BYTES);
+}
+
+/**
+ * Append the dynamic notch stage to a freshly built gyro filter bank,
+ * called from the event dispatcher whenever the filter settings change
+ */
+void stabilizationDynamicNotchConfigure(struct BiquadBank *bank, const GyroFilterSettingsData *settings)
+{
+    struct BiquadCoeffs coeffs;
+
+    enabled    = false;
+    notchStage = -1;
+
+    if (settings->DynamicNotch != GYROFILTERSETTINGS_DYNAMICNOTCH_ENABLED) {
+        return;
+    }
+
+    minFrequency = settings->DynamicNotchRange.Min;
+    maxFrequency = settings->DynamicNotchRange.Max;
+    notchQ = settings->DynamicNotchQ;
+    if (!(minFrequency > 0.0f && maxFrequency > minFrequency && maxFrequency < 0.5f * PIOS_SENSOR_RATE && notchQ > 0.0f)) {
+        return;
+    }
+
+    if (!data) {
+        data = (struct data *)pios_malloc(sizeof(struct data));
+        if (!data) {
+            return;
+        }
+        InitFFTq15(FFT_LOG2N, &data->fft);
+    }
+
+    if (!(notchFrequency >= minFrequency && notchFrequency <= maxFrequency)) {
+        notchFrequency = 0.5f * (minFrequency + maxFrequency);
+    }
+    InitBiquadNotch(notchFrequency / PIOS_SENSOR_RATE, notchQ, &coeffs);
+    if (!AddBiquadBankStage(bank, &coeffs)) {
+        return;
+    }
+    notchStage    = bank->stages - 1;
+    coeffsPending = false;
+    enabled = true;
+}
+
+/**
+ * Collect one gyro sample per axis and apply retuned notch coefficients,
+ * called for every gyro update before the filter bank is run
+ */
+void stabilizationDynamicNotchSample(struct BiquadBank *bank, const float *gyro)
+{
+    if (!enabled) {
+        return;
+    }
+
+    if (coeffsPending) {
+        bank->coeffs[notchStage] = pendingCoeffs;
+        coeffsPending = false;
+    }
+
+    for (uint8_t t = 0; t < 3; t++) {
+        data->samples[fillBuffer][t][fillCount] = (int16_t)boundf(gyro[t] * SAMPLE_SCALE, -32767.0f, 32767.0f);
+    }
+    if (++fillCount < FFT_N) {
+        return;
+    }
+    fillCount = 0;
+
+    // hand the full block over unless the previous one is still being analysed,
+    // in that case the block is dropped and refilled
+    if (!processing) {
+        processing  = true;
+        fillBuffer ^= 1;
+        PIOS_CALLBACKSCHEDULER_Dispatch(callbackHandle);
+    }
+}
+
+/**
+ * Analyse one block of gyro samples, publish the peaks and retune the notch
+ */
+static void dynamicNotchTask(void)
+{
+    const float binWidth = PIOS_SENSOR_RATE / FFT_N;
+    const uint16_t minBin = MAX(1, (uint16_t)(minFrequency / binWidth));
+    const uint16_t maxBin = MIN(FFT_N / 2 - 2, (uint16_t)(maxFrequency / binWidth) + 1);
+    uint32_t total = 0;
+    uint16_t peakBin = minBin;
+    GyroSpectrumData spectrum;
+
+    memset(data->power, 0, sizeof(data->power));
+
+    for (uint8_t t = 0; t < 3; t++) {
+        uint16_t axisBin = minBin;
+        uint32_t axisPeak = 0;
+
+        memcpy(data->re, data->samples[fillBuffer ^ 1][t], sizeof(data->re));
+        memset(data->im, 0, sizeof(data->im));
+        WindowFFTq15(&data->fft, data->re);
+        FFTq15(&data->fft, data->re, data->im);
+
+        for (uint16_t k = minBin - 1; k <= maxBin + 1; k++) {
+            uint32_t p = MagnitudeSquaredFFTq15(data->re[k], data->im[k]);
+            // scaled down so the sum over three axes cannot overflow
+            data->power[k] += p >> 2;
+            if (k >= minBin && k <= maxBin && p > axisPeak) {
+                axisPeak = p;
+                axisBin  = k;
+            }
+        }
+
+        // the windowed FFT scaled by 1/n shows a sine of amplitude A as A/4
+        GyroSpectrumPeakFrequencyToArray(spectrum.PeakFrequency)[t] = axisBin * binWidth;
+        GyroSpectrumPeakAmplitudeToArray(spectrum.PeakAmplitude)[t] = 4.0f * sqrtf((float)axisPeak) / SAMPLE_SCALE;
+    }
+
+    for (uint16_t k = minBin; k <= maxBin; k++) {
+        total += data->power[k] / (maxBin - minBin + 1);
+        if (data->power[k] > data->power[peakBin]) {
+            peakBin = k;
+        }
+    }
+
+    // only follow peaks that clearly stand out from the broadband noise
+    if (data->power[peakBin] > PEAK_RATIO * total) {
+        float frequency = boundf((peakBin + peakOffset(data->power, peakBin)) * binWidth, minFrequency, maxFrequency);
+        notchFrequency = FREQUENCY_ALPHA * notchFrequency + (1.0f - FREQUENCY_ALPHA) * frequency;
+
+        if (!coeffsPending) {
+            InitBiquadNotch(notchFrequency / PIOS_SENSOR_RATE, notchQ, &pendingCoeffs);
+            coeffsPending = true;
+        }
+    }
+
+    spectrum.NotchFrequency = notchFrequency;
+    GyroSpectrumSet(&spectrum);
+
+    processing = false;
+}
+
+/**
+ * Fractional bin offset of a peak from a parabola through it and its neighbours
+ */
+static float peakOffset(const uint32_t *power, uint16_t bin)
+{
+    const float a = sqrtf((float)power[bin - 1]);
+    const float b = sqrtf((float)power[bin]);
+    const float c = sqrtf((float)power[bin + 1]);
+    const float d = a - 2.0f * b + c;
+
+    if (d >= 0.0f) {
+        return 0.0f;
+    }
+    return 0.5f * (a - c) / d;
+}
+
+#endif /* ifdef REVOLUTION */
@@ -0,0 +1,43 @@
+/**
+ ******************************************************************************
+ * @addtogroup OpenPilotModules OpenPilot Modules
+ * @{
+ * @addtogroup StabilizationModule Stabilization Module
+ * @brief dynamic notch
+ * @note This file implements the gyro spectrum analysis for the dynamic notch
+ * @{
+ *
+ * @file       dynamicnotch.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @brief      Gyro spectrum analysis and dynamic notch filter.
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef DYNAMICNOTCH_H
+#define DYNAMICNOTCH_H
+
+#include <biquad.h>
+#include <gyrofiltersettings.h>
+
+void stabilizationDynamicNotchInit();
+void stabilizationDynamicNotchConfigure(struct BiquadBank *bank, const GyroFilterSettingsData *settings);
+void stabilizationDynamicNotchSample(struct BiquadBank *bank, const float *gyro);
+
+#endif /* DYNAMICNOTCH_H */
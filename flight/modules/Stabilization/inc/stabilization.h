@@ -37,6 +37,9 @@
 #include <pid.h>
 #include <stabilizationsettings.h>
 #include <stabilizationbank.h>
+#ifdef REVOLUTION
+#include <biquad.h>
+#endif
 
 
 int32_t StabilizationInitialize();
@@ -45,6 +48,10 @@ typedef struct {
     StabilizationSettingsData settings;
     StabilizationBankData     stabBank;
     float gyro_alpha;
+#ifdef REVOLUTION
+    // GyroTau low pass followed by the GyroFilterSettings stages
+    struct BiquadBank gyroFilter;
+#endif
     struct {
         float min_thrust;
         float max_thrust;
@@ -58,9 +65,16 @@ typedef struct {
         int8_t rateupdates;
     }     monitor;
     float rattitude_mode_transition_stick_position;
-    struct pid innerPids[3], outerPids[3];
+    struct pid3 innerPids;
+    struct pid  outerPids[3];
     // TPS [Roll,Pitch,Yaw][P,I,D]
     bool  thrust_pid_scaling_enabled[3][3];
+    // TPS curve as one line per quarter of the thrust range, y = offset + slope * x
+    struct {
+        bool  enabled;
+        float offset[4];
+        float slope[4];
+    } thrust_pid_scaling_curve;
 } StabilizationData;
 
 
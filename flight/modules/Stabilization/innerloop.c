@@ -38,6 +38,7 @@
 #include <ratedesired.h>
 #include <actuatordesired.h>
 #include <gyrostate.h>
+#include <gyrosensor.h>
 #include <airspeedstate.h>
 #include <stabilizationstatus.h>
 #include <flightstatus.h>
@@ -49,6 +50,12 @@
 #include <stabilization.h>
 #include <virtualflybar.h>
 #include <cruisecontrol.h>
+#ifdef REVOLUTION
+#include <dynamicnotch.h>
+#endif
+
+#define PIOS_INSTRUMENT_MODULE
+#include <pios_instrumentation_helper.h>
 
 // Private constants
 
@@ -62,15 +69,20 @@
 // Private variables
 static DelayedCallbackInfo *callbackHandle;
 static float gyro_filtered[3] = { 0, 0, 0 };
+static uint32_t gyro_sampletime = 0;
 static float axis_lock_accum[3] = { 0, 0, 0 };
 static uint8_t previous_mode[AXES] = { 255, 255, 255, 255 };
 static PiOSDeltatimeConfig timeval;
 static float speedScaleFactor = 1.0f;
 
+PERF_DEFINE_COUNTER(counterInnerloop);
+
 // Private functions
 static void stabilizationInnerloopTask();
 static void GyroStateUpdatedCb(__attribute__((unused)) UAVObjEvent *ev);
+static void gyroUpdated(const float *gyro, uint32_t sampleTime);
 #ifdef REVOLUTION
+static void GyroSensorUpdatedCb(__attribute__((unused)) UAVObjEvent *ev);
 static void AirSpeedUpdatedCb(__attribute__((unused)) UAVObjEvent *ev);
 #endif
 
@@ -87,11 +99,17 @@ void stabilizationInnerloopInit()
 #ifdef REVOLUTION
     AirspeedStateInitialize();
     AirspeedStateConnectCallback(AirSpeedUpdatedCb);
+    // low latency mode, run the rate loop straight from the sensor samples
+    GyroSensorInitialize();
+    UAVObjConnectCallbackPriority(GyroSensorHandle(), &GyroSensorUpdatedCb, EV_MASK_ALL_UPDATES, EV_PRIORITY_CRITICAL);
 #endif
     PIOS_DELTATIME_Init(&timeval, UPDATE_EXPECTED, UPDATE_MIN, UPDATE_MAX, UPDATE_ALPHA);
 
+    PERF_INIT_COUNTER(counterInnerloop, 0x5AB10001);
+
     callbackHandle = PIOS_CALLBACKSCHEDULER_Create(&stabilizationInnerloopTask, CALLBACK_PRIORITY, CBTASK_PRIORITY, CALLBACKINFO_RUNNING_STABILIZATION1, STACK_SIZE_BYTES);
-    GyroStateConnectCallback(GyroStateUpdatedCb);
+    // the gyro events trigger the rate loop, keep them ahead of the regular lane
+    UAVObjConnectCallbackPriority(GyroStateHandle(), &GyroStateUpdatedCb, EV_MASK_ALL_UPDATES, EV_PRIORITY_CRITICAL);
 
     // schedule dead calls every FAILSAFE_TIMEOUT_MS to have the watchdog cleared
     PIOS_CALLBACKSCHEDULER_Schedule(callbackHandle, FAILSAFE_TIMEOUT_MS, CALLBACK_UPDATEMODE_LATER);
@@ -123,50 +141,38 @@ static float get_pid_scale_source_value()
     return value;
 }
 
-typedef struct pid_curve_scaler {
-    float  x;
-    pointf points[5];
-} pid_curve_scaler;
-
-static float pid_curve_value(const pid_curve_scaler *scaler)
+/**
+ * Thrust PID scaling curve value, the lines are prepared by BankUpdatedCb()
+ * so this is evaluated once per inner loop run for all axes
+ */
+static float pid_curve_value()
 {
-    float y = y_on_curve(scaler->x, scaler->points, sizeof(scaler->points) / sizeof(scaler->points[0]));
+    if (!stabSettings.thrust_pid_scaling_curve.enabled) {
+        return 1.0f;
+    }
+
+    const float x = get_pid_scale_source_value();
+    const int segment = (x < 0.25f) ? 0 : (x < 0.5f) ? 1 : (x < 0.75f) ? 2 : 3;
+    const float y     = stabSettings.thrust_pid_scaling_curve.offset[segment] + stabSettings.thrust_pid_scaling_curve.slope[segment] * x;
 
     return 1.0f + (IS_REAL(y) ? y : 0.0f);
 }
 
-static pid_scaler create_pid_scaler(int axis)
+static pid_scaler create_pid_scaler(int axis, float curve_value)
 {
     pid_scaler scaler;
 
     // Always scaled with the this.
     scaler.p = scaler.i = scaler.d = speedScaleFactor;
 
-    if (stabSettings.thrust_pid_scaling_enabled[axis][0]
-        || stabSettings.thrust_pid_scaling_enabled[axis][1]
-        || stabSettings.thrust_pid_scaling_enabled[axis][2]) {
-        const pid_curve_scaler curve_scaler = {
-            .x      = get_pid_scale_source_value(),
-            .points = {
-                { 0.00f, stabSettings.stabBank.ThrustPIDScaleCurve[0] },
-                { 0.25f, stabSettings.stabBank.ThrustPIDScaleCurve[1] },
-                { 0.50f, stabSettings.stabBank.ThrustPIDScaleCurve[2] },
-                { 0.75f, stabSettings.stabBank.ThrustPIDScaleCurve[3] },
-                { 1.00f, stabSettings.stabBank.ThrustPIDScaleCurve[4] }
-            }
-        };
-
-        float curve_value = pid_curve_value(&curve_scaler);
-
-        if (stabSettings.thrust_pid_scaling_enabled[axis][0]) {
-            scaler.p *= curve_value;
-        }
-        if (stabSettings.thrust_pid_scaling_enabled[axis][1]) {
-            scaler.i *= curve_value;
-        }
-        if (stabSettings.thrust_pid_scaling_enabled[axis][2]) {
-            scaler.d *= curve_value;
-        }
+    if (stabSettings.thrust_pid_scaling_enabled[axis][0]) {
+        scaler.p *= curve_value;
+    }
+    if (stabSettings.thrust_pid_scaling_enabled[axis][1]) {
+        scaler.i *= curve_value;
+    }
+    if (stabSettings.thrust_pid_scaling_enabled[axis][2]) {
+        scaler.d *= curve_value;
     }
 
     return scaler;
@@ -179,6 +185,7 @@ static pid_scaler create_pid_scaler(int axis)
  */
 static void stabilizationInnerloopTask()
 {
+    PERF_TIMED_SECTION_START(counterInnerloop);
     // watchdog and error handling
     {
 #ifdef PIOS_INCLUDE_WDG
@@ -241,54 +248,79 @@ static void stabilizationInnerloopTask()
     float dT;
     dT = PIOS_DELTATIME_GetAverageSeconds(&timeval);
 
+    // the rate pid runs for all three axes at once, axes in other modes
+    // pass the gyro as setpoint with the integral frozen, so only the
+    // derivative state follows the gyro and no output is used
+    float setpoint[3];
+    float stickinput[3];
+    float pidOutput[3];
+    pid_scaler scaler[3];
+    const float curve_value = pid_curve_value();
+
+    for (t = 0; t < STABILIZATIONSTATUS_INNERLOOP_THRUST; t++) {
+        bool reinit = (StabilizationStatusInnerLoopToArray(enabled)[t] != previous_mode[t]);
+
+        if (reinit) {
+            stabSettings.innerPids.iAccumulator[t] = 0;
+        }
+        scaler[t]   = create_pid_scaler(t, curve_value);
+        setpoint[t] = gyro_filtered[t];
+
+        switch (StabilizationStatusInnerLoopToArray(enabled)[t]) {
+        case STABILIZATIONSTATUS_INNERLOOP_AXISLOCK:
+            if (fabsf(rate[t]) > stabSettings.settings.MaxAxisLockRate) {
+                // While getting strong commands act like rate mode
+                axis_lock_accum[t] = 0;
+            } else {
+                // For weaker commands or no command simply attitude lock (almost) on no gyro change
+                axis_lock_accum[t] += (rate[t] - gyro_filtered[t]) * dT;
+                axis_lock_accum[t]  = boundf(axis_lock_accum[t], -stabSettings.settings.MaxAxisLock, stabSettings.settings.MaxAxisLock);
+                rate[t] = axis_lock_accum[t] * stabSettings.settings.AxisLockKp;
+            }
+        // IMPORTANT: deliberately no "break;" here, execution continues with regular RATE control loop to avoid code duplication!
+        // keep order as it is, RATE must follow!
+        case STABILIZATIONSTATUS_INNERLOOP_RATE:
+            // limit rate to maximum configured limits (once here instead of 5 times in outer loop)
+            rate[t] = boundf(rate[t],
+                             -StabilizationBankMaximumRateToArray(stabSettings.stabBank.MaximumRate)[t],
+                             StabilizationBankMaximumRateToArray(stabSettings.stabBank.MaximumRate)[t]
+                             );
+            setpoint[t] = rate[t];
+            break;
+        case STABILIZATIONSTATUS_INNERLOOP_ACRO:
+            stickinput[t] = boundf(rate[t] / StabilizationBankManualRateToArray(stabSettings.stabBank.ManualRate)[t], -1.0f, 1.0f);
+            rate[t] = boundf(rate[t],
+                             -StabilizationBankMaximumRateToArray(stabSettings.stabBank.MaximumRate)[t],
+                             StabilizationBankMaximumRateToArray(stabSettings.stabBank.MaximumRate)[t]
+                             );
+            scaler[t].i *= boundf(1.0f - (1.5f * fabsf(stickinput[t])), 0.0f, 1.0f); // this prevents Integral from getting too high while controlled manually
+            setpoint[t]  = rate[t];
+            break;
+        default:
+            scaler[t].i = 0.0f;
+            break;
+        }
+    }
+
+    pid3_apply_setpoint(&stabSettings.innerPids, scaler, setpoint, gyro_filtered, dT, pidOutput);
+
     for (t = 0; t < AXES; t++) {
         bool reinit = (StabilizationStatusInnerLoopToArray(enabled)[t] != previous_mode[t]);
         previous_mode[t] = StabilizationStatusInnerLoopToArray(enabled)[t];
 
         if (t < STABILIZATIONSTATUS_INNERLOOP_THRUST) {
-            if (reinit) {
-                stabSettings.innerPids[t].iAccumulator = 0;
-            }
             switch (StabilizationStatusInnerLoopToArray(enabled)[t]) {
             case STABILIZATIONSTATUS_INNERLOOP_VIRTUALFLYBAR:
                 stabilization_virtual_flybar(gyro_filtered[t], rate[t], &actuatorDesiredAxis[t], dT, reinit, t, &stabSettings.settings);
                 break;
             case STABILIZATIONSTATUS_INNERLOOP_AXISLOCK:
-                if (fabsf(rate[t]) > stabSettings.settings.MaxAxisLockRate) {
-                    // While getting strong commands act like rate mode
-                    axis_lock_accum[t] = 0;
-                } else {
-                    // For weaker commands or no command simply attitude lock (almost) on no gyro change
-                    axis_lock_accum[t] += (rate[t] - gyro_filtered[t]) * dT;
-                    axis_lock_accum[t]  = boundf(axis_lock_accum[t], -stabSettings.settings.MaxAxisLock, stabSettings.settings.MaxAxisLock);
-                    rate[t] = axis_lock_accum[t] * stabSettings.settings.AxisLockKp;
-                }
-            // IMPORTANT: deliberately no "break;" here, execution continues with regular RATE control loop to avoid code duplication!
-            // keep order as it is, RATE must follow!
             case STABILIZATIONSTATUS_INNERLOOP_RATE:
-                // limit rate to maximum configured limits (once here instead of 5 times in outer loop)
-                rate[t] = boundf(rate[t],
-                                 -StabilizationBankMaximumRateToArray(stabSettings.stabBank.MaximumRate)[t],
-                                 StabilizationBankMaximumRateToArray(stabSettings.stabBank.MaximumRate)[t]
-                                 );
-                pid_scaler scaler = create_pid_scaler(t);
-                actuatorDesiredAxis[t] = pid_apply_setpoint(&stabSettings.innerPids[t], &scaler, rate[t], gyro_filtered[t], dT);
+                actuatorDesiredAxis[t] = pidOutput[t];
                 break;
             case STABILIZATIONSTATUS_INNERLOOP_ACRO:
             {
-                float stickinput[3];
-                stickinput[0] = boundf(rate[0] / stabSettings.stabBank.ManualRate.Roll, -1.0f, 1.0f);
-                stickinput[1] = boundf(rate[1] / stabSettings.stabBank.ManualRate.Pitch, -1.0f, 1.0f);
-                stickinput[2] = boundf(rate[2] / stabSettings.stabBank.ManualRate.Yaw, -1.0f, 1.0f);
-                rate[t] = boundf(rate[t],
-                                 -StabilizationBankMaximumRateToArray(stabSettings.stabBank.MaximumRate)[t],
-                                 StabilizationBankMaximumRateToArray(stabSettings.stabBank.MaximumRate)[t]
-                                 );
-                pid_scaler ascaler = create_pid_scaler(t);
-                ascaler.i *= boundf(1.0f - (1.5f * fabsf(stickinput[t])), 0.0f, 1.0f); // this prevents Integral from getting too high while controlled manually
-                float arate  = pid_apply_setpoint(&stabSettings.innerPids[t], &ascaler, rate[t], gyro_filtered[t], dT);
                 float factor = fabsf(stickinput[t]) * stabSettings.stabBank.AcroInsanityFactor;
-                actuatorDesiredAxis[t] = factor * stickinput[t] + (1.0f - factor) * arate;
+                actuatorDesiredAxis[t] = factor * stickinput[t] + (1.0f - factor) * pidOutput[t];
             }
             break;
             case STABILIZATIONSTATUS_INNERLOOP_DIRECT:
@@ -312,6 +344,7 @@ static void stabilizationInnerloopTask()
     }
 
     actuator.UpdateTime = dT * 1000;
+    actuator.SampleTime = gyro_sampletime;
 
     if (cchain.Stabilization == FLIGHTSTATUS_CONTROLCHAIN_TRUE) {
         ActuatorDesiredSet(&actuator);
@@ -322,15 +355,15 @@ static void stabilizationInnerloopTask()
         }
     }
 
-    if (stabSettings.stabBank.EnablePiroComp == STABILIZATIONBANK_ENABLEPIROCOMP_TRUE && stabSettings.innerPids[0].iLim > 1e-3f && stabSettings.innerPids[1].iLim > 1e-3f) {
+    if (stabSettings.stabBank.EnablePiroComp == STABILIZATIONBANK_ENABLEPIROCOMP_TRUE && stabSettings.innerPids.iLim[0] > 1e-3f && stabSettings.innerPids.iLim[1] > 1e-3f) {
         // attempted piro compensation - rotate pitch and yaw integrals (experimental)
         float angleYaw = DEG2RAD(gyro_filtered[2] * dT);
         float sinYaw   = sinf(angleYaw);
         float cosYaw   = cosf(angleYaw);
-        float rollAcc  = stabSettings.innerPids[0].iAccumulator / stabSettings.innerPids[0].iLim;
-        float pitchAcc = stabSettings.innerPids[1].iAccumulator / stabSettings.innerPids[1].iLim;
-        stabSettings.innerPids[0].iAccumulator = stabSettings.innerPids[0].iLim * (cosYaw * rollAcc + sinYaw * pitchAcc);
-        stabSettings.innerPids[1].iAccumulator = stabSettings.innerPids[1].iLim * (cosYaw * pitchAcc - sinYaw * rollAcc);
+        float rollAcc  = stabSettings.innerPids.iAccumulator[0] / stabSettings.innerPids.iLim[0];
+        float pitchAcc = stabSettings.innerPids.iAccumulator[1] / stabSettings.innerPids.iLim[1];
+        stabSettings.innerPids.iAccumulator[0] = stabSettings.innerPids.iLim[0] * (cosYaw * rollAcc + sinYaw * pitchAcc);
+        stabSettings.innerPids.iAccumulator[1] = stabSettings.innerPids.iLim[1] * (cosYaw * pitchAcc - sinYaw * rollAcc);
     }
 
     {
@@ -346,6 +379,7 @@ static void stabilizationInnerloopTask()
             }
         }
     }
+    PERF_TIMED_SECTION_END(counterInnerloop);
     PIOS_CALLBACKSCHEDULER_Schedule(callbackHandle, FAILSAFE_TIMEOUT_MS, CALLBACK_UPDATEMODE_LATER);
 }
 
@@ -354,11 +388,44 @@ static void GyroStateUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
 {
     GyroStateData gyroState;
 
+#ifdef REVOLUTION
+    if (stabSettings.settings.GyroSource == STABILIZATIONSETTINGS_GYROSOURCE_GYROSENSOR) {
+        return;
+    }
+#endif
     GyroStateGet(&gyroState);
+    gyroUpdated(&gyroState.x, gyroState.SampleTime);
+}
+
+#ifdef REVOLUTION
+/**
+ * Low latency path, skips the StateEstimation filter chain and the GyroState hop.
+ * GyroState is still published by StateEstimation for everything else.
+ */
+static void GyroSensorUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
+{
+    GyroSensorData gyroSensor;
+
+    if (stabSettings.settings.GyroSource != STABILIZATIONSETTINGS_GYROSOURCE_GYROSENSOR) {
+        return;
+    }
+    GyroSensorGet(&gyroSensor);
+    gyroUpdated(&gyroSensor.x, gyroSensor.SampleTime);
+}
+#endif
+
+static void gyroUpdated(const float *gyro, uint32_t sampleTime)
+{
+    gyro_sampletime  = sampleTime;
 
-    gyro_filtered[0] = gyro_filtered[0] * stabSettings.gyro_alpha + gyroState.x * (1 - stabSettings.gyro_alpha);
-    gyro_filtered[1] = gyro_filtered[1] * stabSettings.gyro_alpha + gyroState.y * (1 - stabSettings.gyro_alpha);
-    gyro_filtered[2] = gyro_filtered[2] * stabSettings.gyro_alpha + gyroState.z * (1 - stabSettings.gyro_alpha);
+#ifdef REVOLUTION
+    stabilizationDynamicNotchSample(&stabSettings.gyroFilter, gyro);
+    FilterBiquadBank(&stabSettings.gyroFilter, gyro, gyro_filtered);
+#else
+    gyro_filtered[0] = gyro_filtered[0] * stabSettings.gyro_alpha + gyro[0] * (1 - stabSettings.gyro_alpha);
+    gyro_filtered[1] = gyro_filtered[1] * stabSettings.gyro_alpha + gyro[1] * (1 - stabSettings.gyro_alpha);
+    gyro_filtered[2] = gyro_filtered[2] * stabSettings.gyro_alpha + gyro[2] * (1 - stabSettings.gyro_alpha);
+#endif
 
     PIOS_CALLBACKSCHEDULER_Dispatch(callbackHandle);
     stabSettings.monitor.gyroupdates++;
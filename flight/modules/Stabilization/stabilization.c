@@ -44,11 +44,17 @@
 #include <stabilizationsettingsbank2.h>
 #include <stabilizationsettingsbank3.h>
 #include <ratedesired.h>
+#ifdef REVOLUTION
+#include <gyrofiltersettings.h>
+#endif
 #include <sin_lookup.h>
 #include <stabilization.h>
 #include <innerloop.h>
 #include <outerloop.h>
 #include <altitudeloop.h>
+#ifdef REVOLUTION
+#include <dynamicnotch.h>
+#endif
 
 
 // Public variables
@@ -63,6 +69,9 @@ static void BankUpdatedCb(UAVObjEvent *ev);
 static void SettingsBankUpdatedCb(UAVObjEvent *ev);
 static void FlightModeSwitchUpdatedCb(UAVObjEvent *ev);
 static void StabilizationDesiredUpdatedCb(UAVObjEvent *ev);
+#ifdef REVOLUTION
+static void GyroFilterSettingsUpdatedCb(UAVObjEvent *ev);
+#endif
 
 /**
  * Module initialization
@@ -76,6 +85,9 @@ int32_t StabilizationStart()
     StabilizationSettingsBank2ConnectCallback(SettingsBankUpdatedCb);
     StabilizationSettingsBank3ConnectCallback(SettingsBankUpdatedCb);
     StabilizationDesiredConnectCallback(StabilizationDesiredUpdatedCb);
+#ifdef REVOLUTION
+    GyroFilterSettingsConnectCallback(GyroFilterSettingsUpdatedCb);
+#endif
     SettingsUpdatedCb(StabilizationSettingsHandle());
     StabilizationDesiredUpdatedCb(StabilizationDesiredHandle());
     FlightModeSwitchUpdatedCb(ManualControlCommandHandle());
@@ -102,19 +114,22 @@ int32_t StabilizationInitialize()
     StabilizationSettingsBank3Initialize();
     RateDesiredInitialize();
     ManualControlCommandInitialize(); // only used for PID bank selection based on flight mode switch
+#ifdef REVOLUTION
+    GyroFilterSettingsInitialize();
+    InitBiquadBank(&stabSettings.gyroFilter);
+#endif
     sin_lookup_initalize();
 
     stabilizationOuterloopInit();
     stabilizationInnerloopInit();
 #ifdef REVOLUTION
     stabilizationAltitudeloopInit();
+    stabilizationDynamicNotchInit();
 #endif
     pid_zero(&stabSettings.outerPids[0]);
     pid_zero(&stabSettings.outerPids[1]);
     pid_zero(&stabSettings.outerPids[2]);
-    pid_zero(&stabSettings.innerPids[0]);
-    pid_zero(&stabSettings.innerPids[1]);
-    pid_zero(&stabSettings.innerPids[2]);
+    pid3_zero(&stabSettings.innerPids);
     return 0;
 }
 
@@ -285,19 +300,19 @@ static void BankUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
     StabilizationBankGet(&stabSettings.stabBank);
 
     // Set the roll rate PID constants
-    pid_configure(&stabSettings.innerPids[0], stabSettings.stabBank.RollRatePID.Kp,
+    pid3_configure(&stabSettings.innerPids, 0, stabSettings.stabBank.RollRatePID.Kp,
                   stabSettings.stabBank.RollRatePID.Ki,
                   stabSettings.stabBank.RollRatePID.Kd,
                   stabSettings.stabBank.RollRatePID.ILimit);
 
     // Set the pitch rate PID constants
-    pid_configure(&stabSettings.innerPids[1], stabSettings.stabBank.PitchRatePID.Kp,
+    pid3_configure(&stabSettings.innerPids, 1, stabSettings.stabBank.PitchRatePID.Kp,
                   stabSettings.stabBank.PitchRatePID.Ki,
                   stabSettings.stabBank.PitchRatePID.Kd,
                   stabSettings.stabBank.PitchRatePID.ILimit);
 
     // Set the yaw rate PID constants
-    pid_configure(&stabSettings.innerPids[2], stabSettings.stabBank.YawRatePID.Kp,
+    pid3_configure(&stabSettings.innerPids, 2, stabSettings.stabBank.YawRatePID.Kp,
                   stabSettings.stabBank.YawRatePID.Ki,
                   stabSettings.stabBank.YawRatePID.Kd,
                   stabSettings.stabBank.YawRatePID.ILimit);
@@ -330,13 +345,24 @@ static void BankUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
         use_tps_for_i(),
         use_tps_for_d()
     };
+    stabSettings.thrust_pid_scaling_curve.enabled = false;
     for (int axis = 0; axis < 3; axis++) {
         for (int pid = 0; pid < 3; pid++) {
             stabSettings.thrust_pid_scaling_enabled[axis][pid] = stabSettings.stabBank.EnableThrustPIDScaling
                                                                  && tps_for_axis[axis]
                                                                  && tps_for_pid[pid];
+            stabSettings.thrust_pid_scaling_curve.enabled    |= stabSettings.thrust_pid_scaling_enabled[axis][pid];
         }
     }
+
+    // The curve points sit at thrust 0, 0.25, 0.5, 0.75 and 1, the inner loop
+    // picks the line by thrust and extends the first and last one beyond that
+    for (int t = 0; t < 4; t++) {
+        const float y0 = stabSettings.stabBank.ThrustPIDScaleCurve[t];
+        const float y1 = stabSettings.stabBank.ThrustPIDScaleCurve[t + 1];
+        stabSettings.thrust_pid_scaling_curve.slope[t]  = (y1 - y0) * 4.0f;
+        stabSettings.thrust_pid_scaling_curve.offset[t] = y0 - (y1 - y0) * t;
+    }
 }
 
 
@@ -359,6 +385,9 @@ static void SettingsUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
     } else {
         stabSettings.gyro_alpha = expf(-fakeDt / stabSettings.settings.GyroTau);
     }
+#ifdef REVOLUTION
+    GyroFilterSettingsUpdatedCb(GyroFilterSettingsHandle());
+#endif
 
     // force flight mode update
     cur_flight_mode = -1;
@@ -379,6 +408,48 @@ static void SettingsUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
     stabSettings.cruiseControl.max_power_factor_angle = RAD2DEG(acosf(1.0f / stabSettings.settings.CruiseControlMaxPowerFactor));
 }
 
+#ifdef REVOLUTION
+/**
+ * Rebuild the gyro filter bank from GyroTau and GyroFilterSettings.
+ * The new stages start from the current filter output, so settings
+ * changed in flight (e.g. GyroTau through TxPID) do not cause a step
+ */
+static void GyroFilterSettingsUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
+{
+    GyroFilterSettingsData settings;
+    struct BiquadBank bank;
+    struct BiquadCoeffs coeffs;
+
+    GyroFilterSettingsGet(&settings);
+    InitBiquadBank(&bank);
+
+    if (stabSettings.gyro_alpha > 0.0f) {
+        InitBiquadFirstOrderLowPass(stabSettings.gyro_alpha, &coeffs);
+        AddBiquadBankStage(&bank, &coeffs);
+    }
+
+    float ff = settings.LowPassCutoff / PIOS_SENSOR_RATE;
+    if (ff > 0.0f && ff < 0.5f) {
+        InitBiquadLowPass(ff, M_SQRT1_2_F, &coeffs);
+        AddBiquadBankStage(&bank, &coeffs);
+    }
+
+    for (int t = 0; t < GYROFILTERSETTINGS_NOTCHFREQUENCY_NUMELEM; t++) {
+        ff = GyroFilterSettingsNotchFrequencyToArray(settings.NotchFrequency)[t] / PIOS_SENSOR_RATE;
+        float q = GyroFilterSettingsNotchQToArray(settings.NotchQ)[t];
+        if (ff > 0.0f && ff < 0.5f && q > 0.0f) {
+            InitBiquadNotch(ff, q, &coeffs);
+            AddBiquadBankStage(&bank, &coeffs);
+        }
+    }
+
+    stabilizationDynamicNotchConfigure(&bank, &settings);
+
+    ResetBiquadBank(&bank, stabSettings.gyroFilter.last);
+    stabSettings.gyroFilter = bank;
+}
+#endif
+
 /**
  * @}
  * @}
@@ -57,6 +57,7 @@ int32_t filterAirInitialize(stateFilter *handle)
 {
     handle->init      = &init;
     handle->filter    = &filter;
+    handle->inputs    = SENSORUPDATES_baro | SENSORUPDATES_airspeed;
     handle->localdata = pios_malloc(sizeof(struct data));
     return STACK_REQUIRED;
 }
@@ -82,6 +82,7 @@ int32_t filterAltitudeInitialize(stateFilter *handle)
 {
     handle->init      = &init;
     handle->filter    = &filter;
+    handle->inputs    = SENSORUPDATES_accel | SENSORUPDATES_baro | SENSORUPDATES_pos | SENSORUPDATES_vel;
     handle->localdata = pios_malloc(sizeof(struct data));
     HomeLocationInitialize();
     AttitudeStateInitialize();
@@ -63,6 +63,7 @@ int32_t filterBaroInitialize(stateFilter *handle)
 {
     handle->init      = &initwithgps;
     handle->filter    = &filter;
+    handle->inputs    = SENSORUPDATES_baro | SENSORUPDATES_pos;
     handle->localdata = pios_malloc(sizeof(struct data));
     return STACK_REQUIRED;
 }
@@ -71,6 +72,7 @@ int32_t filterBaroiInitialize(stateFilter *handle)
 {
     handle->init      = &initwithoutgps;
     handle->filter    = &filter;
+    handle->inputs    = SENSORUPDATES_baro;
     handle->localdata = pios_malloc(sizeof(struct data));
     return STACK_REQUIRED;
 }
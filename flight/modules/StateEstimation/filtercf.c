@@ -66,7 +66,7 @@ struct data {
     float   accel_alpha;
     bool    accel_filter_enabled;
     float   rollPitchBiasRate;
-    int32_t timeval;
+    uint32_t timeval;
     int32_t starttime;
     uint8_t init;
     bool    magCalibrated;
@@ -82,7 +82,7 @@ static int32_t initwithmag(stateFilter *self);
 static int32_t initwithoutmag(stateFilter *self);
 static int32_t maininit(stateFilter *self);
 static filterResult filter(stateFilter *self, stateEstimation *state);
-static filterResult complementaryFilter(struct data *this, float gyro[3], float accel[3], float mag[3], float attitude[4]);
+static filterResult complementaryFilter(struct data *this, float gyro[3], uint32_t gyroSampleTime, float accel[3], float mag[3], float attitude[4]);
 
 static void flightStatusUpdatedCb(UAVObjEvent *ev);
 
@@ -106,7 +106,8 @@ int32_t filterCFInitialize(stateFilter *handle)
     globalInit();
     handle->init      = &initwithoutmag;
     handle->filter    = &filter;
-    handle->localdata = pios_malloc(sizeof(struct data));
+    handle->inputs    = SENSORUPDATES_gyro | SENSORUPDATES_accel | SENSORUPDATES_mag;
+    handle->localdata = pios_fastheapmalloc(sizeof(struct data));
     return STACK_REQUIRED;
 }
 
@@ -115,7 +116,8 @@ int32_t filterCFMInitialize(stateFilter *handle)
     globalInit();
     handle->init      = &initwithmag;
     handle->filter    = &filter;
-    handle->localdata = pios_malloc(sizeof(struct data));
+    handle->inputs    = SENSORUPDATES_gyro | SENSORUPDATES_accel | SENSORUPDATES_mag;
+    handle->localdata = pios_fastheapmalloc(sizeof(struct data));
     return STACK_REQUIRED;
 }
 
@@ -186,7 +188,7 @@ static filterResult filter(stateFilter *self, stateEstimation *state)
     if (IS_SET(state->updated, SENSORUPDATES_gyro)) {
         if (this->accelUpdated) {
             float attitude[4];
-            result = complementaryFilter(this, state->gyro, this->currentAccel, this->currentMag, attitude);
+            result = complementaryFilter(this, state->gyro, state->gyroSampleTime, this->currentAccel, this->currentMag, attitude);
             if (result == FILTERRESULT_OK) {
                 state->attitude[0] = attitude[0];
                 state->attitude[1] = attitude[1];
@@ -215,7 +217,7 @@ static inline void apply_accel_filter(const struct data *this, const float *raw,
     }
 }
 
-static filterResult complementaryFilter(struct data *this, float gyro[3], float accel[3], float mag[3], float attitude[4])
+static filterResult complementaryFilter(struct data *this, float gyro[3], uint32_t gyroSampleTime, float accel[3], float mag[3], float attitude[4])
 {
     float dT;
 
@@ -277,7 +279,7 @@ static filterResult complementaryFilter(struct data *this, float gyro[3], float
         this->grot_filtered[0]   = 0.0f;
         this->grot_filtered[1]   = 0.0f;
         this->grot_filtered[2]   = 0.0f;
-        this->timeval   = PIOS_DELAY_GetRaw(); // Cycle counter used for precise timing
+        this->timeval   = gyroSampleTime; // Cycle counter used for precise timing
         this->starttime = xTaskGetTickCount(); // Tick counter used for long time intervals
 
         return FILTERRESULT_OK; // must return OK on initial initialization, so attitude will init with a valid quaternion
@@ -285,7 +287,7 @@ static filterResult complementaryFilter(struct data *this, float gyro[3], float
 
     if (this->init == 0 && xTaskGetTickCount() - this->starttime < CALIBRATION_DELAY_MS / portTICK_RATE_MS) {
         // wait 4 seconds for the user to get his hands off in case the board was just powered
-        this->timeval = PIOS_DELAY_GetRaw();
+        this->timeval = gyroSampleTime;
         return FILTERRESULT_ERROR;
     } else if (this->init == 0 && xTaskGetTickCount() - this->starttime < (CALIBRATION_DELAY_MS + CALIBRATION_DURATION_MS) / portTICK_RATE_MS) {
         // For first 6 seconds use accels to get gyro bias
@@ -315,9 +317,9 @@ static filterResult complementaryFilter(struct data *this, float gyro[3], float
         this->init = 1;
     }
 
-    // Compute the dT using the cpu clock
-    dT = PIOS_DELAY_DiffuS(this->timeval) / 1000000.0f;
-    this->timeval = PIOS_DELAY_GetRaw();
+    // Compute the dT using the capture time of the gyro samples
+    dT = PIOS_DELAY_DiffuS2(this->timeval, gyroSampleTime) / 1000000.0f;
+    this->timeval = gyroSampleTime;
     if (dT < 0.001f) { // safe bounds
         dT = 0.001f;
     }
@@ -37,6 +37,7 @@
 #include <attitudestate.h>
 #include <systemalarms.h>
 #include <homelocation.h>
+#include <callbackinfo.h>
 
 #include <insgps.h>
 #include <CoordinateConversions.h>
@@ -44,11 +45,19 @@
 // Private constants
 
 #define STACK_REQUIRED 2048
+// same priority as the prediction, the scheduler alternates between them so neither is starved
+#define CORRECTION_CALLBACK_PRIORITY CALLBACK_PRIORITY_REGULAR
 #define DT_ALPHA       1e-3f
 #define DT_MIN         1e-6f
 #define DT_MAX         1.0f
 #define DT_INIT        (1.0f / PIOS_SENSOR_RATE) // initialize with board sensor rate
 
+#define EKF_INPUTS \
+    (SENSORUPDATES_gyro | SENSORUPDATES_accel | SENSORUPDATES_mag | SENSORUPDATES_baro | \
+     SENSORUPDATES_pos | SENSORUPDATES_vel | SENSORUPDATES_airspeed)
+#define EKF_CORRECTION_INPUTS \
+    (SENSORUPDATES_mag | SENSORUPDATES_baro | SENSORUPDATES_pos | SENSORUPDATES_vel | SENSORUPDATES_airspeed)
+
 #define IMPORT_SENSOR_IF_UPDATED(shortname, num) \
     if (IS_SET(state->updated, SENSORUPDATES_##shortname)) { \
         uint8_t t; \
@@ -71,11 +80,24 @@ struct data {
     bool inited;
 
     PiOSDeltatimeConfig dtconfig;
+
+    // covariance prediction time and steps not applied yet
+    float   covarianceDT;
+    uint8_t covarianceSteps;
+
+    // measurements imported since the last run of the correction callback
+    sensorUpdates pendingUpdates;
 };
 
 // Private variables
 static bool initialized = 0;
 
+// the correction step runs in its own callback so it does not delay the attitude output.
+// It shares the scheduler task with the state estimation callback, so the two never
+// preempt each other and Nav and the working set can be handed over without locking
+static DelayedCallbackInfo *correctionCallback;
+static struct data *correctionData;
+
 
 // Private functions
 
@@ -84,6 +106,7 @@ static int32_t init13(stateFilter *self);
 static int32_t maininit(stateFilter *self);
 static filterResult filter(stateFilter *self, stateEstimation *state);
 static inline bool invalid_var(float data);
+static void correctionCb(void);
 
 static void globalInit(void);
 
@@ -95,6 +118,7 @@ static void globalInit(void)
         EKFConfigurationInitialize();
         EKFStateVarianceInitialize();
         HomeLocationInitialize();
+        correctionCallback = PIOS_CALLBACKSCHEDULER_Create(&correctionCb, CORRECTION_CALLBACK_PRIORITY, STATEESTIMATION_CALLBACK_TASK, CALLBACKINFO_RUNNING_STATEESTIMATION1, STACK_REQUIRED);
     }
 }
 
@@ -103,7 +127,8 @@ int32_t filterEKF13iInitialize(stateFilter *handle)
     globalInit();
     handle->init      = &init13i;
     handle->filter    = &filter;
-    handle->localdata = pios_malloc(sizeof(struct data));
+    handle->inputs    = EKF_INPUTS;
+    handle->localdata = pios_fastheapmalloc(sizeof(struct data));
     return STACK_REQUIRED;
 }
 int32_t filterEKF13Initialize(stateFilter *handle)
@@ -111,7 +136,8 @@ int32_t filterEKF13Initialize(stateFilter *handle)
     globalInit();
     handle->init      = &init13;
     handle->filter    = &filter;
-    handle->localdata = pios_malloc(sizeof(struct data));
+    handle->inputs    = EKF_INPUTS;
+    handle->localdata = pios_fastheapmalloc(sizeof(struct data));
     return STACK_REQUIRED;
 }
 // XXX
@@ -122,7 +148,8 @@ int32_t filterEKF16iInitialize(stateFilter *handle)
     globalInit();
     handle->init      = &init13i;
     handle->filter    = &filter;
-    handle->localdata = pios_malloc(sizeof(struct data));
+    handle->inputs    = EKF_INPUTS;
+    handle->localdata = pios_fastheapmalloc(sizeof(struct data));
     return STACK_REQUIRED;
 }
 int32_t filterEKF16Initialize(stateFilter *handle)
@@ -130,7 +157,8 @@ int32_t filterEKF16Initialize(stateFilter *handle)
     globalInit();
     handle->init      = &init13;
     handle->filter    = &filter;
-    handle->localdata = pios_malloc(sizeof(struct data));
+    handle->inputs    = EKF_INPUTS;
+    handle->localdata = pios_fastheapmalloc(sizeof(struct data));
     return STACK_REQUIRED;
 }
 
@@ -155,9 +183,12 @@ static int32_t maininit(stateFilter *self)
 {
     struct data *this = (struct data *)self->localdata;
 
-    this->inited       = false;
-    this->init_stage   = 0;
-    this->work.updated = 0;
+    this->inited          = false;
+    this->init_stage      = 0;
+    this->work.updated    = 0;
+    this->covarianceDT    = 0.0f;
+    this->covarianceSteps = 0;
+    this->pendingUpdates  = 0;
     PIOS_DELTATIME_Init(&this->dtconfig, DT_INIT, DT_MIN, DT_MAX, DT_ALPHA);
 
     EKFConfigurationGet(&this->ekfConfiguration);
@@ -190,7 +221,8 @@ static int32_t maininit(stateFilter *self)
 }
 
 /**
- * Collect all required state variables, then run complementary filter
+ * Collect all required state variables, then run the state prediction.
+ * Corrections are handed over to correctionCb()
  */
 static filterResult filter(stateFilter *self, stateEstimation *state)
 {
@@ -200,15 +232,12 @@ static filterResult filter(stateFilter *self, stateEstimation *state)
 
     // Perform the update
     float dT;
-    uint16_t sensors = 0;
 
     this->work.updated |= state->updated;
 
     // check magnetometer alarm, discard any magnetometer readings if not OK
     // during initialization phase (but let them through afterwards)
-    SystemAlarmsAlarmData alarms;
-    SystemAlarmsAlarmGet(&alarms);
-    if (alarms.Magnetometer != SYSTEMALARMS_ALARM_OK && !this->inited) {
+    if (AlarmsGet(SYSTEMALARMS_ALARM_MAGNETOMETER) != SYSTEMALARMS_ALARM_OK && !this->inited) {
         UNSET_MASK(state->updated, SENSORUPDATES_mag);
         UNSET_MASK(this->work.updated, SENSORUPDATES_mag);
     }
@@ -233,7 +262,8 @@ static filterResult filter(stateFilter *self, stateEstimation *state)
         return FILTERRESULT_OK;
     }
 
-    dT = PIOS_DELTATIME_GetAverageSeconds(&this->dtconfig);
+    // integrate over the time between the gyro captures, not between the filter runs
+    dT = PIOS_DELTATIME_GetAverageSecondsSince(&this->dtconfig, state->gyroSampleTime);
 
     if (!this->inited && IS_SET(this->work.updated, SENSORUPDATES_mag) && IS_SET(this->work.updated, SENSORUPDATES_baro) && IS_SET(this->work.updated, SENSORUPDATES_pos)) {
         // Don't initialize until all sensors are read
@@ -295,6 +325,9 @@ static filterResult filter(stateFilter *self, stateEstimation *state)
             INSSetState(this->work.pos, (float *)zeros, this->work.attitude, (float *)zeros, (float *)zeros);
 
             INSResetP(EKFConfigurationPToArray(this->ekfConfiguration.P));
+            this->covarianceDT    = 0.0f;
+            this->covarianceSteps = 0;
+            this->pendingUpdates  = 0;
         } else {
             // Run prediction a bit before any corrections
 
@@ -353,14 +386,57 @@ static filterResult filter(stateFilter *self, stateEstimation *state)
     state->vel[2]   = Nav.Vel[2];
     state->updated |= SENSORUPDATES_attitude | SENSORUPDATES_pos | SENSORUPDATES_vel;
 
-    // Advance the covariance estimate
-    INSCovariancePrediction(dT);
+    // the covariance estimate may be advanced at a lower rate, see correctionCb()
+    this->covarianceDT += dT;
+    this->covarianceSteps++;
+
+    // all sensor data has been used for prediction, hand the measurements over to the correction
+    this->pendingUpdates |= this->work.updated & EKF_CORRECTION_INPUTS;
+    this->work.updated    = 0;
+
+    if (this->pendingUpdates || this->covarianceDT >= DT_MAX ||
+        (this->ekfConfiguration.CovarianceDecimation && this->covarianceSteps >= this->ekfConfiguration.CovarianceDecimation)) {
+        correctionData = this;
+        PIOS_CALLBACKSCHEDULER_Dispatch(correctionCallback);
+    }
+
+    if (this->init_stage < 0) {
+        return FILTERRESULT_WARNING;
+    } else {
+        return FILTERRESULT_OK;
+    }
+}
+
+// check for invalid variance values
+static inline bool invalid_var(float data)
+{
+    if (isnan(data) || isinf(data)) {
+        return true;
+    }
+    if (data < 1e-15f) { // var should not be close to zero. And not negative either.
+        return true;
+    }
+    return false;
+}
+
+/**
+ * Correction step of the EKF, dispatched by filter() whenever measurements are pending
+ * or the covariance estimate is due to be advanced
+ */
+static void correctionCb(void)
+{
+    struct data *this = correctionData;
+    uint16_t sensors  = 0;
 
-    if (IS_SET(this->work.updated, SENSORUPDATES_mag)) {
+    if (!this || !this->inited) {
+        return;
+    }
+
+    if (IS_SET(this->pendingUpdates, SENSORUPDATES_mag)) {
         sensors |= MAG_SENSORS;
     }
 
-    if (IS_SET(this->work.updated, SENSORUPDATES_baro)) {
+    if (IS_SET(this->pendingUpdates, SENSORUPDATES_baro)) {
         sensors |= BARO_SENSOR;
     }
 
@@ -386,15 +462,15 @@ static filterResult filter(stateFilter *self, stateEstimation *state)
                         );
     }
 
-    if (IS_SET(this->work.updated, SENSORUPDATES_pos)) {
+    if (IS_SET(this->pendingUpdates, SENSORUPDATES_pos)) {
         sensors |= POS_SENSORS;
     }
 
-    if (IS_SET(this->work.updated, SENSORUPDATES_vel)) {
+    if (IS_SET(this->pendingUpdates, SENSORUPDATES_vel)) {
         sensors |= HORIZ_SENSORS | VERT_SENSORS;
     }
 
-    if (IS_SET(this->work.updated, SENSORUPDATES_airspeed) && ((!IS_SET(this->work.updated, SENSORUPDATES_vel) && !IS_SET(this->work.updated, SENSORUPDATES_pos)) | !this->usePos)) {
+    if (IS_SET(this->pendingUpdates, SENSORUPDATES_airspeed) && ((!IS_SET(this->pendingUpdates, SENSORUPDATES_vel) && !IS_SET(this->pendingUpdates, SENSORUPDATES_pos)) | !this->usePos)) {
         // HACK: feed airspeed into EKF as velocity, treat wind as 1e2 variance
         sensors |= HORIZ_SENSORS | VERT_SENSORS;
         INSSetPosVelVar((float[3]) { this->ekfConfiguration.FakeR.FakeGPSPosIndoor,
@@ -415,6 +491,14 @@ static filterResult filter(stateFilter *self, stateEstimation *state)
      * TODO: Need to add a general sanity check for all the inputs to make sure their kosher
      * although probably should occur within INS itself
      */
+    // Advance the covariance estimate over all steps since the last time, always before a correction
+    if (sensors || this->covarianceDT >= DT_MAX ||
+        (this->ekfConfiguration.CovarianceDecimation && this->covarianceSteps >= this->ekfConfiguration.CovarianceDecimation)) {
+        INSCovariancePrediction(this->covarianceDT);
+        this->covarianceDT    = 0.0f;
+        this->covarianceSteps = 0;
+    }
+
     if (sensors) {
         INSCorrection(this->work.mag, this->work.pos, this->work.vel, this->work.baro[0], sensors);
     }
@@ -432,26 +516,8 @@ static filterResult filter(stateFilter *self, stateEstimation *state)
         }
     }
 
-    // all sensor data has been used, reset!
-    this->work.updated = 0;
-
-    if (this->init_stage < 0) {
-        return FILTERRESULT_WARNING;
-    } else {
-        return FILTERRESULT_OK;
-    }
-}
-
-// check for invalid variance values
-static inline bool invalid_var(float data)
-{
-    if (isnan(data) || isinf(data)) {
-        return true;
-    }
-    if (data < 1e-15f) { // var should not be close to zero. And not negative either.
-        return true;
-    }
-    return false;
+    // all measurements have been used, reset!
+    this->pendingUpdates = 0;
 }
 
 /**
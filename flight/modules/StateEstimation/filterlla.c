@@ -60,6 +60,7 @@ int32_t filterLLAInitialize(stateFilter *handle)
 {
     handle->init      = &init;
     handle->filter    = &filter;
+    handle->inputs    = SENSORUPDATES_lla;
     handle->localdata = pios_malloc(sizeof(struct data));
     GPSSettingsInitialize();
     GPSPositionSensorInitialize();
@@ -71,6 +71,7 @@ int32_t filterMagInitialize(stateFilter *handle)
 {
     handle->init      = &init;
     handle->filter    = &filter;
+    handle->inputs    = SENSORUPDATES_auxMag | SENSORUPDATES_boardMag;
     handle->localdata = pios_malloc(sizeof(struct data));
     HomeLocationInitialize();
     return STACK_REQUIRED;
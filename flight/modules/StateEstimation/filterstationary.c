@@ -49,6 +49,7 @@ int32_t filterStationaryInitialize(stateFilter *handle)
 {
     handle->init      = &init;
     handle->filter    = &filter;
+    handle->inputs    = 0;
     handle->localdata = NULL;
     return STACK_REQUIRED;
 }
@@ -32,6 +32,8 @@
 
 #include <openpilot.h>
 
+// callback scheduler task shared by all state estimation stages
+#define STATEESTIMATION_CALLBACK_TASK CALLBACK_TASK_FLIGHTCONTROL
 
 // Enumeration for filter result
 typedef enum {
@@ -72,6 +74,7 @@ typedef struct {
     float   auxMag[3];
     uint8_t magStatus;
     float   boardMag[3];
+    uint32_t gyroSampleTime; // PIOS_DELAY_GetRaw() capture time of the gyro sample
     sensorUpdates updated;
 } stateEstimation;
 
@@ -79,6 +82,10 @@ typedef struct stateFilterStruct {
     int32_t (*init)(struct stateFilterStruct *self);
     filterResult (*filter)(struct stateFilterStruct *self, stateEstimation *state);
     void *localdata;
+    // the filter is only run in cycles that updated one of these, 0 runs it every cycle
+    sensorUpdates inputs;
+    // result of the last run, still reported while the filter is skipped
+    filterResult  lastResult;
 } stateFilter;
 
 
@@ -55,11 +55,15 @@
 #include "flightstatus.h"
 
 #include "CoordinateConversions.h"
+#include <loadgovernor.h>
+
+#define PIOS_INSTRUMENT_MODULE
+#include <pios_instrumentation_helper.h>
 
 // Private constants
 #define STACK_SIZE_BYTES        256
 #define CALLBACK_PRIORITY       CALLBACK_PRIORITY_REGULAR
-#define TASK_PRIORITY           CALLBACK_TASK_FLIGHTCONTROL
+#define TASK_PRIORITY           STATEESTIMATION_CALLBACK_TASK
 #define TIMEOUT_MS              10
 
 // Private filter init const
@@ -140,6 +144,10 @@ static DelayedCallbackInfo *stateEstimationCallback;
 
 static volatile RevoSettingsData revoSettings;
 static volatile sensorUpdates updatedSensors;
+static uint8_t magReceived;
+static uint8_t auxMagReceived;
+static uint8_t baroReceived;
+static uint8_t airspeedReceived;
 static volatile int32_t fusionAlgorithm  = -1;
 static const filterPipeline *filterChain = NULL;
 
@@ -157,6 +165,8 @@ static stateFilter cfmFilter;
 static stateFilter ekf13iFilter;
 static stateFilter ekf13Filter;
 
+PERF_DEFINE_COUNTER(counterEstimation);
+
 // this is a hack to provide a computational shortcut for faster gyro state progression
 static float gyroRaw[3];
 static float gyroDelta[3];
@@ -257,6 +267,17 @@ static void sensorUpdatedCb(UAVObjEvent *objEv);
 static void homeLocationUpdatedCb(UAVObjEvent *objEv);
 static void StateEstimationCb(void);
 
+/**
+ * While the load governor sheds the navigation filter, only every other
+ * correction from the slow sensors (mag, baro, airspeed) is fused.
+ * Gyro, accel and GPS updates are never dropped.
+ * \param[in,out] received count of the updates received from the sensor
+ */
+static inline bool dropCorrection(uint8_t *received)
+{
+    return LoadGovernorIsShedding(LOADGOVERNOR_LEVEL_NAVIGATION) && ((*received)++ & 1);
+}
+
 static inline int32_t maxint32_t(int32_t a, int32_t b)
 {
     if (a > b) {
@@ -318,7 +339,9 @@ int32_t StateEstimationInitialize(void)
     stack_required = maxint32_t(stack_required, filterEKF13iInitialize(&ekf13iFilter));
     stack_required = maxint32_t(stack_required, filterEKF13Initialize(&ekf13Filter));
 
-    stateEstimationCallback = PIOS_CALLBACKSCHEDULER_Create(&StateEstimationCb, CALLBACK_PRIORITY, TASK_PRIORITY, CALLBACKINFO_RUNNING_STATEESTIMATION, stack_required);
+    PERF_INIT_COUNTER(counterEstimation, 0x5E000001);
+
+    stateEstimationCallback = PIOS_CALLBACKSCHEDULER_Create(&StateEstimationCb, CALLBACK_PRIORITY, TASK_PRIORITY, CALLBACKINFO_RUNNING_STATEESTIMATION0, stack_required);
 
     return 0;
 }
@@ -364,6 +387,7 @@ static void StateEstimationCb(void)
     switch (runState) {
     case RUNSTATE_LOAD:
 
+        PERF_TIMED_SECTION_START(counterEstimation);
         alarm = FILTERRESULT_OK;
 
         // set alarm to warning if called through timeout
@@ -405,6 +429,7 @@ static void StateEstimationCb(void)
                 bool error = 0;
                 while (current != NULL) {
                     int32_t result = current->filter->init((stateFilter *)current->filter);
+                    ((stateFilter *)current->filter)->lastResult = FILTERRESULT_OK;
                     if (result != 0) {
                         error = 1;
                         break;
@@ -432,6 +457,7 @@ static void StateEstimationCb(void)
             gyroRaw[0] = states.gyro[0];
             gyroRaw[1] = states.gyro[1];
             gyroRaw[2] = states.gyro[2];
+            GyroSensorSampleTimeGet(&states.gyroSampleTime);
         }
         FETCH_SENSOR_FROM_UAVOBJECT_CHECK_AND_LOAD_TO_STATE_3_DIMENSIONS(AccelSensor, accel, x, y, z);
         FETCH_SENSOR_FROM_UAVOBJECT_CHECK_AND_LOAD_TO_STATE_3_DIMENSIONS(MagSensor, boardMag, x, y, z);
@@ -454,8 +480,18 @@ static void StateEstimationCb(void)
 
     case RUNSTATE_FILTER:
 
+        // skip over filters whose inputs did not change this cycle, they would not do
+        // anything but still cost a callback dispatch on every gyro update
+        while (current != NULL && current->filter->inputs && !(states.updated & current->filter->inputs)) {
+            if (current->filter->lastResult > alarm) {
+                alarm = current->filter->lastResult;
+            }
+            current = current->next;
+        }
+
         if (current != NULL) {
             filterResult result = current->filter->filter((stateFilter *)current->filter, &states);
+            ((stateFilter *)current->filter)->lastResult = result;
             if (result > alarm) {
                 alarm = result;
             }
@@ -540,6 +576,8 @@ static void StateEstimationCb(void)
             AlarmsClear(SYSTEMALARMS_ALARM_ATTITUDE);
         }
 
+        PERF_TIMED_SECTION_END(counterEstimation);
+
         // we are done, re-schedule next self execution
         runState = RUNSTATE_LOAD;
         if (updatedSensors) {
@@ -590,6 +628,7 @@ static void sensorUpdatedCb(UAVObjEvent *ev)
         t.x = s.x + gyroDelta[0];
         t.y = s.y + gyroDelta[1];
         t.z = s.z + gyroDelta[2];
+        t.SampleTime = s.SampleTime;
         GyroStateSet(&t);
     }
 
@@ -598,10 +637,16 @@ static void sensorUpdatedCb(UAVObjEvent *ev)
     }
 
     if (ev->obj == MagSensorHandle()) {
+        if (dropCorrection(&magReceived)) {
+            return;
+        }
         updatedSensors |= SENSORUPDATES_boardMag;
     }
 
     if (ev->obj == AuxMagSensorHandle()) {
+        if (dropCorrection(&auxMagReceived)) {
+            return;
+        }
         updatedSensors |= SENSORUPDATES_auxMag;
     }
 
@@ -614,10 +659,16 @@ static void sensorUpdatedCb(UAVObjEvent *ev)
     }
 
     if (ev->obj == BaroSensorHandle()) {
+        if (dropCorrection(&baroReceived)) {
+            return;
+        }
         updatedSensors |= SENSORUPDATES_baro;
     }
 
     if (ev->obj == AirspeedSensorHandle()) {
+        if (dropCorrection(&airspeedReceived)) {
+            return;
+        }
         updatedSensors |= SENSORUPDATES_airspeed;
     }
 
@@ -49,13 +49,17 @@
 
 // UAVOs
 #include <objectpersistence.h>
+#include <settingsdigest.h>
 #include <flightstatus.h>
 #include <systemstats.h>
+#include <systemhealthsummary.h>
+#include <bootstats.h>
 #include <systemsettings.h>
 #include <i2cstats.h>
 #include <taskinfo.h>
 #include <watchdogstatus.h>
 #include <callbackinfo.h>
+#include <callbacklatency.h>
 #include <hwsettings.h>
 #include <pios_flashfs.h>
 #include <pios_notify.h>
@@ -71,6 +75,7 @@
 
 // Flight Libraries
 #include <sanitycheck.h>
+#include <loadgovernor.h>
 
 
 // #define DEBUG_THIS_FILE
@@ -83,6 +88,13 @@
 
 // Private constants
 #define SYSTEM_UPDATE_PERIOD_MS 250
+#define SYSTEM_COMPACT_SLOTS    16 // flash filesystem slots compacted per update
+#define SYSTEM_SUMMARY_PERIOD_MS 1000 // the summary is sent at its (lower) telemetry period
+
+// Load governor, one level is shed per summary period while out of headroom
+#define LOADGOVERNOR_LATENCY_LIMIT_US   2000 // worst callback latency (p99) before shedding
+#define LOADGOVERNOR_HEADROOM_PERCENT   10 // load below CPULOAD_LIMIT_WARNING needed to restore
+#define LOADGOVERNOR_RESTORE_PERIOD_MS  5000 // time with headroom before restoring a level
 
 #if defined(PIOS_SYSTEM_STACK_SIZE)
 #define STACK_SIZE_BYTES        PIOS_SYSTEM_STACK_SIZE
@@ -102,16 +114,34 @@ static bool mallocFailed;
 static HwSettingsData bootHwSettings;
 static FrameType_t bootFrameType;
 static struct PIOS_FLASHFS_Stats fsStats;
+static SettingsDigestData *digestData;
+static uint16_t digestEntry;
+static uint16_t digestFirstEntry;
+static uint32_t eventErrors;
+static portTickType lastSummaryTime;
+static portTickType lastOverloadTime;
 
 // Private functions
 static void objectUpdatedCb(UAVObjEvent *ev);
+static int32_t saveObjectList(ObjectPersistenceData *objper);
 static void checkSettingsUpdatedCb(UAVObjEvent *ev);
+static void updateSettingsDigest();
+static void settingsDigestIterateCb(UAVObjHandle obj);
 #ifdef DIAG_TASKS
 static void taskMonitorForEachCallback(uint16_t task_id, const struct pios_task_info *task_info, void *context);
 static void callbackSchedulerForEachCallback(int16_t callback_id, const struct pios_callback_info *callback_info, void *context);
+static void callbackLatencyForEachCallback(int16_t callback_id, const struct pios_callback_info *callback_info, void *context);
 #endif
 static void updateStats();
+static void compactFilesystems();
 static void updateSystemAlarms();
+static void updateHealthSummary();
+static void updateLoadGovernor(SystemHealthSummaryData *summary);
+#ifdef PIOS_INCLUDE_INITCALL_PROFILE
+static void publishBootStats();
+#endif
+static void summaryTaskForEachCallback(uint16_t task_id, const struct pios_task_info *task_info, void *context);
+static void summaryCallbackForEachCallback(int16_t callback_id, const struct pios_callback_info *callback_info, void *context);
 static void systemTask(void *parameters);
 #ifdef DIAG_I2C_WDG_STATS
 static void updateI2Cstats();
@@ -147,11 +177,14 @@ int32_t SystemModInitialize(void)
     // Must registers objects here for system thread because ObjectManager started in OpenPilotInit
     SystemSettingsInitialize();
     SystemStatsInitialize();
+    SystemHealthSummaryInitialize();
     FlightStatusInitialize();
     ObjectPersistenceInitialize();
+    SettingsDigestInitialize();
 #ifdef DIAG_TASKS
     TaskInfoInitialize();
     CallbackInfoInitialize();
+    CallbackLatencyInitialize();
 #endif
 #ifdef DIAG_I2C_WDG_STATS
     I2CStatsInitialize();
@@ -161,8 +194,11 @@ int32_t SystemModInitialize(void)
 #ifdef PIOS_INCLUDE_INSTRUMENTATION
     InstrumentationInit();
 #endif
+#ifdef PIOS_INCLUDE_INITCALL_PROFILE
+    BootStatsInitialize();
+#endif
 
-    objectPersistenceQueue = xQueueCreate(1, sizeof(UAVObjEvent));
+    objectPersistenceQueue = xQueueCreate(2, sizeof(UAVObjEvent));
     if (objectPersistenceQueue == NULL) {
         return -1;
     }
@@ -184,6 +220,12 @@ static void systemTask(__attribute__((unused)) void *parameters)
     /* start the delayed callback scheduler */
     PIOS_CALLBACKSCHEDULER_Start();
 
+    /* the flight modules are running, bring up the ones they do not depend on */
+    MODULE_INITIALISE_DEFERRED;
+#ifdef PIOS_INCLUDE_INITCALL_PROFILE
+    publishBootStats();
+#endif
+
     if (mallocFailed) {
         /* We failed to malloc during task creation,
          * system behaviour is undefined.  Reset and let
@@ -197,6 +239,7 @@ static void systemTask(__attribute__((unused)) void *parameters)
 #endif
     // Listen for SettingPersistance object updates, connect a callback function
     ObjectPersistenceConnectQueue(objectPersistenceQueue);
+    SettingsDigestConnectQueue(objectPersistenceQueue);
 
     // Load a copy of HwSetting active at boot time
     HwSettingsGet(&bootHwSettings);
@@ -208,14 +251,22 @@ static void systemTask(__attribute__((unused)) void *parameters)
 #ifdef DIAG_TASKS
     TaskInfoData taskInfoData;
     CallbackInfoData callbackInfoData;
+    CallbackLatencyData callbackLatencyData;
 #endif
     // Main system loop
     while (1) {
         NotificationUpdateStatus();
         // Update the system statistics
         updateStats();
+        // Keep some free slots in the flash filesystems
+        compactFilesystems();
         // Update the system alarms
         updateSystemAlarms();
+        // Update the health summary, no need to do it more often than it can be sent
+        if ((xTaskGetTickCount() - lastSummaryTime) * portTICK_RATE_MS >= SYSTEM_SUMMARY_PERIOD_MS) {
+            lastSummaryTime = xTaskGetTickCount();
+            updateHealthSummary();
+        }
 #ifdef DIAG_I2C_WDG_STATS
         updateI2Cstats();
         updateWDGstats();
@@ -233,6 +284,8 @@ static void systemTask(__attribute__((unused)) void *parameters)
 // if(FALSE){
         PIOS_CALLBACKSCHEDULER_ForEachCallback(callbackSchedulerForEachCallback, &callbackInfoData);
         CallbackInfoSet(&callbackInfoData);
+        PIOS_CALLBACKSCHEDULER_ForEachCallback(callbackLatencyForEachCallback, &callbackLatencyData);
+        CallbackLatencySet(&callbackLatencyData);
 // }
 #endif
 // }
@@ -362,6 +415,8 @@ static void objectUpdatedCb(UAVObjEvent *ev)
                 retval = UAVObjSaveSettings();
             } else if (objper.Selection == OBJECTPERSISTENCE_SELECTION_ALLMETAOBJECTS || objper.Selection == OBJECTPERSISTENCE_SELECTION_ALLOBJECTS) {
                 retval = UAVObjSaveMetaobjects();
+            } else if (objper.Selection == OBJECTPERSISTENCE_SELECTION_OBJECTLIST) {
+                retval = saveObjectList(&objper);
             }
         } else if (objper.Operation == OBJECTPERSISTENCE_OPERATION_DELETE) {
             if (objper.Selection == OBJECTPERSISTENCE_SELECTION_SINGLEOBJECT) {
@@ -396,9 +451,95 @@ static void objectUpdatedCb(UAVObjEvent *ev)
         default:
             break;
         }
+    } else if (ev->obj == SettingsDigestHandle()) {
+        updateSettingsDigest();
     }
 }
 
+/**
+ * Save the first ObjectCount objects of ObjectIDList/InstanceIDList in one
+ * logfs batch, then read them back to verify the save like a single object
+ * save does. Nothing is saved if one of the objects is unknown.
+ * @return 0 if success or -1 if failure
+ */
+static int32_t saveObjectList(ObjectPersistenceData *objper)
+{
+    UAVObjHandle objs[OBJECTPERSISTENCE_OBJECTIDLIST_NUMELEM];
+    int32_t retval = 0;
+
+    if (objper->ObjectCount == 0 || objper->ObjectCount > OBJECTPERSISTENCE_OBJECTIDLIST_NUMELEM) {
+        return -1;
+    }
+    for (uint8_t i = 0; i < objper->ObjectCount; i++) {
+        objs[i] = UAVObjGetByID(objper->ObjectIDList[i]);
+        if (objs[i] == 0) {
+            return -1;
+        }
+    }
+
+    if (UAVObjBatchBegin() == -1) {
+        return -1;
+    }
+    for (uint8_t i = 0; i < objper->ObjectCount && retval == 0; i++) {
+        retval = UAVObjBatchSave(objs[i], objper->InstanceIDList[i]);
+    }
+    if (UAVObjBatchCommit() == -1) {
+        retval = -1;
+    }
+
+    for (uint8_t i = 0; i < objper->ObjectCount && retval == 0; i++) {
+        retval = UAVObjLoad(objs[i], objper->InstanceIDList[i]);
+    }
+    return retval;
+}
+
+/**
+ * Reply to a SettingsDigest request with the CRCs of the requested page
+ * of settings objects and metaobjects. Unused entries have a zero ObjectID.
+ */
+static void updateSettingsDigest()
+{
+    SettingsDigestData digest;
+
+    SettingsDigestGet(&digest);
+
+    // When this is called because of this method don't do anything
+    if (digest.Operation != SETTINGSDIGEST_OPERATION_REQUEST) {
+        return;
+    }
+
+    memset(digest.ObjectID, 0, sizeof(digest.ObjectID));
+    memset(digest.ObjectCRC, 0, sizeof(digest.ObjectCRC));
+    digestData       = &digest;
+    digestEntry      = 0;
+    digestFirstEntry = digest.Page * SETTINGSDIGEST_OBJECTID_NUMELEM;
+    UAVObjIterate(&settingsDigestIterateCb);
+    digestData       = NULL;
+
+    digest.Operation = SETTINGSDIGEST_OPERATION_REPLY;
+    SettingsDigestSet(&digest);
+}
+
+static void settingsDigestIterateCb(UAVObjHandle obj)
+{
+    if (!UAVObjIsSettings(obj) && !UAVObjIsMetaobject(obj)) {
+        return;
+    }
+
+    uint16_t entry = digestEntry++;
+    if (entry < digestFirstEntry || entry >= digestFirstEntry + SETTINGSDIGEST_OBJECTID_NUMELEM) {
+        return;
+    }
+
+    uint8_t crc = 0;
+    uint16_t numInstances = UAVObjGetNumInstances(obj);
+    for (uint16_t instId = 0; instId < numInstances; ++instId) {
+        crc = UAVObjUpdateCRC(obj, instId, crc);
+    }
+    digestData->ObjectID[entry - digestFirstEntry] = UAVObjGetID(obj);
+    digestData->ObjectCRC[entry - digestFirstEntry] = crc;
+}
+
 /**
  * Called whenever hardware settings changed
  */
@@ -444,8 +585,28 @@ static void callbackSchedulerForEachCallback(int16_t callback_id, const struct p
     PIOS_DEBUG_Assert(callback_id < CALLBACKINFO_RUNNING_NUMELEM);
     ((uint8_t *)&callbackData->Running)[callback_id] = callback_info->is_running;
     ((uint32_t *)&callbackData->RunningTime)[callback_id]   = callback_info->running_time_count;
+    ((float *)&callbackData->CPULoad)[callback_id] = callback_info->running_time_permille * 0.1f;
     ((int16_t *)&callbackData->StackRemaining)[callback_id] = callback_info->stack_remaining;
 }
+
+static void callbackLatencyForEachCallback(int16_t callback_id, const struct pios_callback_info *callback_info, void *context)
+{
+    CallbackLatencyData *latencyData = (CallbackLatencyData *)context;
+
+    if (callback_id < 0) {
+        return;
+    }
+    // Same mapping of callback_id's as CallbackInfo
+    PIOS_DEBUG_Assert(callback_id < CALLBACKLATENCY_LATENCYMIN_NUMELEM);
+    ((uint16_t *)&latencyData->LatencyMin)[callback_id]   = callback_info->latency.min;
+    ((uint16_t *)&latencyData->LatencyAvg)[callback_id]   = callback_info->latency.avg;
+    ((uint16_t *)&latencyData->LatencyMax)[callback_id]   = callback_info->latency.max;
+    ((uint16_t *)&latencyData->LatencyP99)[callback_id]   = callback_info->latency.p99;
+    ((uint16_t *)&latencyData->ExecutionMin)[callback_id] = callback_info->execution.min;
+    ((uint16_t *)&latencyData->ExecutionAvg)[callback_id] = callback_info->execution.avg;
+    ((uint16_t *)&latencyData->ExecutionMax)[callback_id] = callback_info->execution.max;
+    ((uint16_t *)&latencyData->ExecutionP99)[callback_id] = callback_info->execution.p99;
+}
 #endif /* ifdef DIAG_TASKS */
 
 /**
@@ -560,6 +721,22 @@ static void updateStats()
     SystemStatsSet(&stats);
 }
 
+/**
+ * Advance the background compaction of the flash filesystems a little,
+ * so that saving settings does not have to wait for a full garbage collection
+ */
+static void compactFilesystems()
+{
+#if !defined(ARCH_POSIX) && !defined(ARCH_WIN32)
+    if (pios_uavo_settings_fs_id) {
+        PIOS_FLASHFS_Compact(pios_uavo_settings_fs_id, SYSTEM_COMPACT_SLOTS);
+    }
+    if (pios_user_fs_id) {
+        PIOS_FLASHFS_Compact(pios_user_fs_id, SYSTEM_COMPACT_SLOTS);
+    }
+#endif
+}
+
 /**
  * Update system alarms
  */
@@ -614,6 +791,7 @@ static void updateSystemAlarms()
     EventGetStats(&evStats);
     UAVObjClearStats();
     EventClearStats();
+    eventErrors += objStats.eventCallbackErrors + objStats.eventQueueErrors + evStats.eventErrors;
     if (objStats.eventCallbackErrors > 0 || objStats.eventQueueErrors > 0 || evStats.eventErrors > 0) {
         AlarmsSet(SYSTEMALARMS_ALARM_EVENTSYSTEM, SYSTEMALARMS_ALARM_WARNING);
     } else {
@@ -621,12 +799,176 @@ static void updateSystemAlarms()
     }
 
     if (objStats.lastCallbackErrorID || objStats.lastQueueErrorID || evStats.lastErrorID) {
-        SystemStatsData sysStats;
-        SystemStatsGet(&sysStats);
-        sysStats.EventSystemWarningID    = evStats.lastErrorID;
-        sysStats.ObjectManagerCallbackID = objStats.lastCallbackErrorID;
-        sysStats.ObjectManagerQueueID    = objStats.lastQueueErrorID;
-        SystemStatsSet(&sysStats);
+        stats.EventSystemWarningID    = evStats.lastErrorID;
+        stats.ObjectManagerCallbackID = objStats.lastCallbackErrorID;
+        stats.ObjectManagerQueueID    = objStats.lastQueueErrorID;
+    }
+    // Usage of the event and instance pools
+    stats.EventPoolMax       = objStats.eventPoolMax;
+    stats.EventPoolOverflows = objStats.eventPoolOverflows;
+    stats.PeriodicPoolMax    = evStats.periodicPoolMax;
+    stats.PeriodicPoolOverflows  = evStats.periodicPoolOverflows;
+    stats.InstanceArenaUsed      = objStats.instanceArenaUsed;
+    stats.InstanceArenaOverflows = objStats.instanceArenaOverflows;
+    SystemStatsSet(&stats);
+}
+
+#ifdef PIOS_INCLUDE_INITCALL_PROFILE
+/**
+ * Publish the boot profile, once the deferred modules are up
+ */
+static void publishBootStats()
+{
+    const struct pios_initcall_profile *profile = PIOS_INITCALL_GetProfile();
+    BootStatsData stats;
+
+    memset(&stats, 0, sizeof(stats));
+    stats.BoardInit    = profile->phase_us[PIOS_INITCALL_PHASE_BOARD];
+    stats.ModuleInit   = profile->phase_us[PIOS_INITCALL_PHASE_INIT];
+    stats.TaskCreate   = profile->phase_us[PIOS_INITCALL_PHASE_TASKCREATE];
+    stats.DeferredInit = profile->phase_us[PIOS_INITCALL_PHASE_DEFERRED];
+    stats.Ready = profile->phase_end_us[PIOS_INITCALL_PHASE_TASKCREATE];
+    stats.Done  = profile->phase_end_us[PIOS_INITCALL_PHASE_DEFERRED];
+
+    uint32_t count = __module_initcall_end - __module_initcall_start;
+    for (uint32_t i = 0; i < count && i < BOOTSTATS_INITCALLADDRESS_NUMELEM && i < PIOS_INITCALL_PROFILE_MAX; i++) {
+        const initmodule_t *fn = &__module_initcall_start[i];
+        stats.InitcallAddress[i]  = (uint32_t)(fn->fn_minit ? fn->fn_minit : fn->fn_tinit);
+        stats.InitcallInit[i]     = profile->minit_us[i];
+        stats.InitcallStart[i]    = profile->tinit_us[i];
+        stats.InitcallDeferred[i] = (fn->flags & MODULE_INITCALL_FLAG_DEFERRED) ?
+                                    BOOTSTATS_INITCALLDEFERRED_TRUE : BOOTSTATS_INITCALLDEFERRED_FALSE;
+    }
+    BootStatsSet(&stats);
+}
+#endif /* PIOS_INCLUDE_INITCALL_PROFILE */
+
+/**
+ * Update the health summary from the system stats, the alarms and the
+ * task and callback monitors
+ */
+static void updateHealthSummary()
+{
+    SystemHealthSummaryData summary;
+    SystemStatsData stats;
+
+    SystemStatsGet(&stats);
+
+    summary.AlarmOK       = 0;
+    summary.AlarmWarning  = 0;
+    summary.AlarmCritical = 0;
+    summary.AlarmError    = 0;
+    for (uint8_t i = 0; i < SYSTEMALARMS_ALARM_NUMELEM; i++) {
+        switch (AlarmsGet(i)) {
+        case SYSTEMALARMS_ALARM_OK:
+            summary.AlarmOK |= 1 << i;
+            break;
+        case SYSTEMALARMS_ALARM_WARNING:
+            summary.AlarmWarning |= 1 << i;
+            break;
+        case SYSTEMALARMS_ALARM_CRITICAL:
+            summary.AlarmCritical |= 1 << i;
+            break;
+        case SYSTEMALARMS_ALARM_ERROR:
+            summary.AlarmError |= 1 << i;
+            break;
+        default:
+            break;
+        }
+    }
+
+    summary.FlightTime        = stats.FlightTime;
+    summary.HeapRemaining     = stats.HeapRemaining;
+    summary.EventErrors       = eventErrors;
+    summary.IRQStackRemaining = stats.IRQStackRemaining;
+    summary.CPULoad = stats.CPULoad;
+    summary.CPUTemp = stats.CPUTemp;
+
+    // Lowest stack low-water marks and worst scheduling latency
+    summary.TaskStackRemaining     = 0xFFFF;
+    summary.TaskStackTask          = 0xFF;
+    summary.CallbackStackRemaining = 0x7FFF;
+    summary.CallbackStackCallback  = 0xFF;
+    summary.LatencyP99      = 0;
+    summary.LatencyMax      = 0;
+    summary.LatencyCallback = 0xFF;
+    summary.TopCPUTask      = 0xFF;
+    summary.TopCPUTaskLoad  = 0.0f;
+    summary.TopCPUCallback  = 0xFF;
+    summary.TopCPUCallbackLoad = 0.0f;
+    PIOS_TASK_MONITOR_ForEachTask(summaryTaskForEachCallback, &summary);
+    PIOS_CALLBACKSCHEDULER_ForEachCallback(summaryCallbackForEachCallback, &summary);
+
+    updateLoadGovernor(&summary);
+
+    SystemHealthSummarySet(&summary);
+}
+
+/**
+ * Slow down the non-critical consumers one level at a time while the CPU load or
+ * the callback latency is over its limit, and restore them one level at a time
+ * once there has been enough headroom for a while.
+ */
+static void updateLoadGovernor(SystemHealthSummaryData *summary)
+{
+    LoadGovernorLevel level = LoadGovernorGetLevel();
+
+    if (summary->CPULoad > CPULOAD_LIMIT_WARNING || summary->LatencyP99 > LOADGOVERNOR_LATENCY_LIMIT_US) {
+        lastOverloadTime = xTaskGetTickCount();
+        if (level < LOADGOVERNOR_LEVEL_MAX) {
+            level++;
+        }
+    } else if (summary->CPULoad > CPULOAD_LIMIT_WARNING - LOADGOVERNOR_HEADROOM_PERCENT
+               || summary->LatencyP99 > LOADGOVERNOR_LATENCY_LIMIT_US / 2) {
+        // Not enough headroom to restore anything yet
+        lastOverloadTime = xTaskGetTickCount();
+    } else if (level > LOADGOVERNOR_LEVEL_NONE
+               && (xTaskGetTickCount() - lastOverloadTime) * portTICK_RATE_MS >= LOADGOVERNOR_RESTORE_PERIOD_MS) {
+        lastOverloadTime = xTaskGetTickCount();
+        level--;
+    }
+
+    LoadGovernorSetLevel(level);
+    summary->LoadLevel = level;
+}
+
+static void summaryTaskForEachCallback(uint16_t task_id, const struct pios_task_info *task_info, void *context)
+{
+    SystemHealthSummaryData *summary = (SystemHealthSummaryData *)context;
+
+    // Same mapping of task_id's as TaskInfo, tasks that are not running have no stack
+    if (task_info->is_running && task_info->stack_remaining < summary->TaskStackRemaining) {
+        summary->TaskStackRemaining = task_info->stack_remaining;
+        summary->TaskStackTask = task_id;
+    }
+    if (task_info->is_running && task_info->running_time_permille * 0.1f > summary->TopCPUTaskLoad) {
+        summary->TopCPUTaskLoad = task_info->running_time_permille * 0.1f;
+        summary->TopCPUTask     = task_id;
+    }
+}
+
+static void summaryCallbackForEachCallback(int16_t callback_id, const struct pios_callback_info *callback_info, void *context)
+{
+    SystemHealthSummaryData *summary = (SystemHealthSummaryData *)context;
+
+    // Same mapping of callback_id's as CallbackInfo, negative ids are the scheduler tasks
+    if (callback_id < 0) {
+        return;
+    }
+    if (callback_info->stack_remaining < summary->CallbackStackRemaining) {
+        summary->CallbackStackRemaining = callback_info->stack_remaining;
+        summary->CallbackStackCallback  = callback_id;
+    }
+    if (callback_info->latency.p99 > summary->LatencyP99) {
+        summary->LatencyP99      = callback_info->latency.p99;
+        summary->LatencyCallback = callback_id;
+    }
+    if (callback_info->latency.max > summary->LatencyMax) {
+        summary->LatencyMax = callback_info->latency.max;
+    }
+    if (callback_info->running_time_permille * 0.1f > summary->TopCPUCallbackLoad) {
+        summary->TopCPUCallbackLoad = callback_info->running_time_permille * 0.1f;
+        summary->TopCPUCallback     = callback_id;
     }
 }
 
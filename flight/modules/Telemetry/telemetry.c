@@ -36,8 +36,18 @@
 
 #include "flighttelemetrystats.h"
 #include "gcstelemetrystats.h"
+#include "timesync.h"
 #include "hwsettings.h"
 #include "taskinfo.h"
+#include <loadgovernor.h>
+#if defined(PIOS_TELEM_BANDWIDTH_BUDGET)
+#include <utlist.h>
+#endif
+#if defined(PIOS_TELEM_BANDWIDTH_BUDGET) || defined(PIOS_TELEM_FANOUT)
+#ifdef PIOS_INCLUDE_RFM22B
+#include "oplinksettings.h"
+#endif
+#endif
 
 // Private constants
 #define MAX_QUEUE_SIZE            TELEM_QUEUE_SIZE
@@ -63,8 +73,65 @@
 #define MAX_RETRIES               2
 #define STATS_UPDATE_PERIOD_MS    4000
 #define CONNECTION_TIMEOUT_MS     8000
+// Period multiplier of the periodic telemetry and logging while the load governor sheds them
+#define LOAD_SHED_PERIOD_FACTOR   4
+// Bytes read from the com port and parsed at once by the receive tasks
+#define RX_BUFFER_SIZE            16
+// An object skipping its unchanged periodic updates is still sent every this many periods
+#define KEEPALIVE_PERIODS         10
+#if defined(PIOS_TELEM_BANDWIDTH_BUDGET)
+// Estimated UAVTalk framing overhead of an object update (header, instance id and crc)
+#define OBJECT_OVERHEAD_BYTES     11
+// Percentage of the link rate the telemetry is allowed to use
+#define BANDWIDTH_BUDGET_PERCENT  80
+// Periods are only relaxed when the traffic falls below this percentage of the budget
+#define BANDWIDTH_RELAX_PERCENT   75
+// Periodic update periods are stretched by up to 10x (in percent)
+#define MIN_PERIOD_SCALE          100
+#define MAX_PERIOD_SCALE          1000
+#endif
+#if defined(PIOS_TELEM_FANOUT)
+// Ports the telemetry stream is copied to, besides the primary port
+#define MAX_FANOUT_SINKS          2
+// Input of the secondary telemetry port is polled at this period while USB is connected
+#define FANOUT_RX_POLL_MS         5
+#endif
 
 // Private types
+// Telemetry and logging policy of an object, decoded from its metadata
+typedef struct {
+    UAVObjHandle obj;
+    uint16_t     telemetryUpdatePeriod;
+    uint16_t     loggingUpdatePeriod;
+    uint8_t      telemetryUpdateMode;
+    uint8_t      loggingUpdateMode;
+    uint8_t      telemetryAcked;
+    uint8_t      telemetryTimestamped;
+    uint8_t      telemetrySkipUnchanged;
+    // Periodic updates skipped since the data last sent, and its hash. Only kept with the policy cache
+    uint8_t      skippedPeriods;
+    bool         sentHashValid;
+    uint32_t     sentHash;
+    // State of the event dispatcher for the object, -1 when unknown
+    int32_t      appliedUpdatePeriod;
+    int32_t      appliedLoggingPeriod;
+    int32_t      appliedEventMask;
+} TelemetryPolicy;
+#if defined(PIOS_TELEM_BANDWIDTH_BUDGET)
+typedef struct ObjectTxStatsStruct {
+    UAVObjHandle obj;
+    uint32_t     txBytes; // bytes sent during the current stats period
+    struct ObjectTxStatsStruct *next;
+} ObjectTxStats;
+#endif
+#if defined(PIOS_TELEM_FANOUT)
+typedef struct {
+    uint32_t port;
+    uint32_t rate; // link rate in bytes/s, 0 if unlimited
+    uint32_t tokens; // bytes the link can take before the updates are dropped
+    uint32_t timeOfLastRefill;
+} TelemetrySink;
+#endif
 
 // Private variables
 static uint32_t telemetryPort;
@@ -75,6 +142,8 @@ static xQueueHandle queue;
 
 #if defined(PIOS_TELEM_PRIORITY_QUEUE)
 static xQueueHandle priorityQueue;
+// Both queues, the TX task blocks on it until either has an event
+static xQueueSetHandle queueSet;
 #else
 #define priorityQueue queue
 #endif
@@ -87,10 +156,30 @@ static xTaskHandle radioRxTaskHandle;
 static uint32_t txErrors;
 static uint32_t txRetries;
 static uint32_t timeOfLastObjectUpdate;
+static LoadGovernorLevel loadLevel;
 static UAVTalkConnection uavTalkCon;
 #ifdef PIOS_INCLUDE_RFM22B
 static UAVTalkConnection radioUavTalkCon;
 #endif
+#if defined(PIOS_TELEM_BANDWIDTH_BUDGET)
+static ObjectTxStats *objectTxStats;
+static uint16_t periodScale;
+static uint32_t budgetTxBytes;
+static uint32_t timeOfLastBudgetUpdate;
+#endif
+#if defined(PIOS_TELEM_POLICY_CACHE)
+// Policies of the data objects, sorted by handle
+static TelemetryPolicy *policies;
+static uint16_t numPolicies;
+static uint16_t maxPolicies;
+#endif
+#if defined(PIOS_TELEM_FANOUT)
+static TelemetrySink fanoutSinks[MAX_FANOUT_SINKS];
+static uint8_t numFanoutSinks;
+// Input of the telemetry port while USB is the primary port
+static UAVTalkConnection fanoutUavTalkCon;
+static uint8_t *reservedData;
+#endif
 
 // Private functions
 static void telemetryTxTask(void *parameters);
@@ -100,15 +189,46 @@ static void radioRxTask(void *parameters);
 static int32_t transmitRadioData(uint8_t *data, int32_t length);
 #endif
 static int32_t transmitData(uint8_t *data, int32_t length);
+static uint8_t *reserveTransmitData(uint16_t length);
+static int32_t commitTransmitData(uint16_t length);
 static void registerObject(UAVObjHandle obj);
 static void updateObject(UAVObjHandle obj, int32_t eventType);
-static int32_t setUpdatePeriod(UAVObjHandle obj, int32_t updatePeriodMs);
-static int32_t setLoggingPeriod(UAVObjHandle obj, int32_t updatePeriodMs);
+static int32_t setUpdatePeriod(TelemetryPolicy *policy, int32_t updatePeriodMs);
+static int32_t setLoggingPeriod(TelemetryPolicy *policy, int32_t updatePeriodMs);
+static TelemetryPolicy *getPolicy(UAVObjHandle obj, TelemetryPolicy *buffer);
+static TelemetryPolicy *refreshPolicy(UAVObjHandle obj, TelemetryPolicy *buffer);
+static void decodePolicy(UAVObjHandle obj, TelemetryPolicy *policy);
+#if defined(PIOS_TELEM_POLICY_CACHE)
+static void countObject(UAVObjHandle obj);
+static TelemetryPolicy *findPolicy(UAVObjHandle obj, bool insert);
+#endif
 static void processObjEvent(UAVObjEvent *ev);
+static bool skipUnchangedUpdate(TelemetryPolicy *policy, UAVObjEvent *ev);
 static void updateTelemetryStats();
 static void gcsTelemetryStatsUpdated();
+static void timeSyncUpdated(UAVObjEvent *ev);
 static void updateSettings();
 static uint32_t getComPort(bool input);
+static bool isUsbLink();
+static int32_t getScaledPeriod(UAVObjHandle obj, int32_t updatePeriodMs);
+static int32_t getScaledLoggingPeriod(int32_t updatePeriodMs);
+static void applyPeriodScale(UAVObjHandle obj);
+static void updateLoadLevel();
+#if defined(PIOS_TELEM_BANDWIDTH_BUDGET)
+static void accountObjectTx(UAVObjHandle obj, uint16_t instId);
+static void updateBandwidthBudget(uint32_t txBytes, FlightTelemetryStatsData *flightStats);
+static uint32_t getLinkRate();
+#endif
+#if defined(PIOS_TELEM_BANDWIDTH_BUDGET) || defined(PIOS_TELEM_FANOUT)
+static uint32_t getPortRate(uint32_t port);
+#endif
+#if defined(PIOS_TELEM_FANOUT)
+static void addFanoutSink(uint32_t port);
+static void updateFanoutSinks();
+static void fanOut(const uint8_t *data, uint16_t length, uint32_t primaryPort);
+static uint32_t getFanoutInputPort(uint32_t inputPort);
+static int32_t transmitFanoutData(uint8_t *data, int32_t length);
+#endif
 
 /**
  * Initialise the telemetry module
@@ -117,11 +237,21 @@ static uint32_t getComPort(bool input);
  */
 int32_t TelemetryStart(void)
 {
+#if defined(PIOS_TELEM_POLICY_CACHE)
+    // Room for the policies of all the data objects registered so far
+    UAVObjIterate(&countObject);
+    policies = (TelemetryPolicy *)pios_malloc(maxPolicies * sizeof(TelemetryPolicy));
+    if (!policies) {
+        maxPolicies = 0;
+    }
+#endif
+
     // Process all registered objects and connect queue for updates
     UAVObjIterate(&registerObject);
 
     // Listen to objects of interest
     GCSTelemetryStatsConnectQueue(priorityQueue);
+    TimeSyncConnectQueue(priorityQueue);
 
     // Start telemetry tasks
     xTaskCreate(telemetryTxTask, "TelTx", STACK_SIZE_TX_BYTES / 4, NULL, TASK_PRIORITY_TX, &telemetryTxTaskHandle);
@@ -146,14 +276,25 @@ int32_t TelemetryInitialize(void)
 {
     FlightTelemetryStatsInitialize();
     GCSTelemetryStatsInitialize();
+    TimeSyncInitialize();
 
     // Initialize vars
     timeOfLastObjectUpdate = 0;
+#if defined(PIOS_TELEM_BANDWIDTH_BUDGET)
+    objectTxStats = NULL;
+    periodScale   = MIN_PERIOD_SCALE;
+    budgetTxBytes = 0;
+    timeOfLastBudgetUpdate = 0;
+#endif
 
     // Create object queues
     queue = xQueueCreate(MAX_QUEUE_SIZE, sizeof(UAVObjEvent));
 #if defined(PIOS_TELEM_PRIORITY_QUEUE)
     priorityQueue = xQueueCreate(MAX_QUEUE_SIZE, sizeof(UAVObjEvent));
+    // The queues must still be empty when added to the set
+    queueSet = xQueueCreateSet(2 * MAX_QUEUE_SIZE);
+    xQueueAddToSet(queue, queueSet);
+    xQueueAddToSet(priorityQueue, queueSet);
 #endif
 
     // Update telemetry settings
@@ -166,9 +307,22 @@ int32_t TelemetryInitialize(void)
 
     // Initialise UAVTalk
     uavTalkCon = UAVTalkInitialize(&transmitData);
+    UAVTalkSetOutputReserve(uavTalkCon, &reserveTransmitData, &commitTransmitData);
 #ifdef PIOS_INCLUDE_RFM22B
     radioUavTalkCon = UAVTalkInitialize(&transmitRadioData);
 #endif
+#if defined(PIOS_TELEM_FANOUT)
+    // The stream is packed once for the primary port and copied to the other ports
+    numFanoutSinks   = 0;
+    addFanoutSink(telemetryPort);
+#ifdef PIOS_INCLUDE_RFM22B
+    if (radioPort != telemetryPort) {
+        addFanoutSink(radioPort);
+    }
+#endif
+    updateFanoutSinks();
+    fanoutUavTalkCon = UAVTalkInitialize(&transmitFanoutData);
+#endif
 
     // Create periodic event that will be used to update the telemetry stats
     // FIXME STATS_UPDATE_PERIOD_MS is 4000ms while FlighTelemetryStats update period is 5000ms...
@@ -205,8 +359,8 @@ static void registerObject(UAVObjHandle obj)
  */
 static void updateObject(UAVObjHandle obj, int32_t eventType)
 {
-    UAVObjMetadata metadata;
-    UAVObjUpdateMode updateMode, loggingMode;
+    TelemetryPolicy buffer;
+    TelemetryPolicy *policy;
     int32_t eventMask;
 
     if (UAVObjIsMetaobject(obj)) {
@@ -216,23 +370,21 @@ static void updateObject(UAVObjHandle obj, int32_t eventType)
         return;
     }
 
-    // Get metadata
-    UAVObjGetMetadata(obj, &metadata);
-    updateMode  = UAVObjGetTelemetryUpdateMode(&metadata);
-    loggingMode = UAVObjGetLoggingUpdateMode(&metadata);
+    // Decode the metadata on initialization and metadata change, the policy is cached otherwise
+    policy    = (eventType == EV_NONE) ? refreshPolicy(obj, &buffer) : getPolicy(obj, &buffer);
 
     // Setup object depending on update mode
-    eventMask   = 0;
-    switch (updateMode) {
+    eventMask = 0;
+    switch (policy->telemetryUpdateMode) {
     case UPDATEMODE_PERIODIC:
         // Set update period
-        setUpdatePeriod(obj, metadata.telemetryUpdatePeriod);
+        setUpdatePeriod(policy, getScaledPeriod(obj, policy->telemetryUpdatePeriod));
         // Connect queue
         eventMask |= EV_UPDATED_PERIODIC | EV_UPDATED_MANUAL | EV_UPDATE_REQ;
         break;
     case UPDATEMODE_ONCHANGE:
         // Set update period
-        setUpdatePeriod(obj, 0);
+        setUpdatePeriod(policy, 0);
         // Connect queue
         eventMask |= EV_UPDATED | EV_UPDATED_MANUAL | EV_UPDATE_REQ;
         break;
@@ -242,7 +394,7 @@ static void updateObject(UAVObjHandle obj, int32_t eventType)
             eventMask |= EV_UPDATED | EV_UPDATED_MANUAL | EV_UPDATE_REQ;
             // Set update period on initialization and metadata change
             if (eventType == EV_NONE) {
-                setUpdatePeriod(obj, metadata.telemetryUpdatePeriod);
+                setUpdatePeriod(policy, getScaledPeriod(obj, policy->telemetryUpdatePeriod));
             }
         } else {
             // Otherwise, we just received an object update, so switch to periodic for the timeout period to prevent more updates
@@ -251,21 +403,21 @@ static void updateObject(UAVObjHandle obj, int32_t eventType)
         break;
     case UPDATEMODE_MANUAL:
         // Set update period
-        setUpdatePeriod(obj, 0);
+        setUpdatePeriod(policy, 0);
         // Connect queue
         eventMask |= EV_UPDATED_MANUAL | EV_UPDATE_REQ;
         break;
     }
-    switch (loggingMode) {
+    switch (policy->loggingUpdateMode) {
     case UPDATEMODE_PERIODIC:
         // Set update period
-        setLoggingPeriod(obj, metadata.loggingUpdatePeriod);
+        setLoggingPeriod(policy, getScaledLoggingPeriod(policy->loggingUpdatePeriod));
         // Connect queue
         eventMask |= EV_LOGGING_PERIODIC | EV_LOGGING_MANUAL;
         break;
     case UPDATEMODE_ONCHANGE:
         // Set update period
-        setLoggingPeriod(obj, 0);
+        setLoggingPeriod(policy, 0);
         // Connect queue
         eventMask |= EV_UPDATED | EV_LOGGING_MANUAL;
         break;
@@ -275,7 +427,7 @@ static void updateObject(UAVObjHandle obj, int32_t eventType)
             eventMask |= EV_UPDATED | EV_LOGGING_MANUAL;
             // Set update period on initialization and metadata change
             if (eventType == EV_NONE) {
-                setLoggingPeriod(obj, metadata.loggingUpdatePeriod);
+                setLoggingPeriod(policy, getScaledLoggingPeriod(policy->loggingUpdatePeriod));
             }
         } else {
             // Otherwise, we just received an object update, so switch to periodic for the timeout period to prevent more updates
@@ -284,11 +436,16 @@ static void updateObject(UAVObjHandle obj, int32_t eventType)
         break;
     case UPDATEMODE_MANUAL:
         // Set update period
-        setLoggingPeriod(obj, 0);
+        setLoggingPeriod(policy, 0);
         // Connect queue
         eventMask |= EV_LOGGING_MANUAL;
         break;
     }
+    // The queue connection only needs an update when the event mask changes
+    if (eventMask == policy->appliedEventMask) {
+        return;
+    }
+    policy->appliedEventMask = eventMask;
     // note that all setting objects have implicitly IsPriority=true
     if (UAVObjIsPriority(obj)) {
         UAVObjConnectQueue(obj, priorityQueue, eventMask);
@@ -302,30 +459,50 @@ static void updateObject(UAVObjHandle obj, int32_t eventType)
  */
 static void processObjEvent(UAVObjEvent *ev)
 {
-    UAVObjMetadata metadata;
+    TelemetryPolicy buffer;
+    TelemetryPolicy *policy = NULL;
     UAVObjUpdateMode updateMode;
     int32_t retries;
     int32_t success;
 
+    if (ev->obj) {
+        // Get object policy
+        policy = getPolicy(ev->obj, &buffer);
+    }
+
     if (ev->obj == 0) {
         updateTelemetryStats();
     } else if (ev->obj == GCSTelemetryStatsHandle()) {
         gcsTelemetryStatsUpdated();
+    } else if (ev->obj == TimeSyncHandle()) {
+        timeSyncUpdated(ev);
     } else {
-        // Get object metadata
-        UAVObjGetMetadata(ev->obj, &metadata);
-        updateMode = UAVObjGetTelemetryUpdateMode(&metadata);
+        updateMode = policy->telemetryUpdateMode;
 
         // Act on event
         retries    = 0;
         success    = -1;
         if ((ev->event == EV_UPDATED && (updateMode == UPDATEMODE_ONCHANGE || updateMode == UPDATEMODE_THROTTLED))
             || ev->event == EV_UPDATED_MANUAL
-            || (ev->event == EV_UPDATED_PERIODIC && updateMode != UPDATEMODE_THROTTLED)) {
+            || (ev->event == EV_UPDATED_PERIODIC && updateMode != UPDATEMODE_THROTTLED && !skipUnchangedUpdate(policy, ev))) {
+            uint8_t timestamped = policy->telemetryTimestamped;
+            if (!policy->telemetryAcked && !timestamped) {
+                if (ev->instId != UAVOBJ_ALL_INSTANCES && UAVObjGetCompactProfile(ev->obj) && !isUsbLink()) {
+                    // Quantized representation on the radio and serial links
+                    success = UAVTalkSendObjectCompact(uavTalkCon, ev->obj, ev->instId);
+                } else {
+                    // Unacked updates are bundled together, the bundle is sent when the queues are empty
+                    success = UAVTalkSendObjectBundled(uavTalkCon, ev->obj, ev->instId);
+                }
+            }
             // Send update to GCS (with retries)
             while (retries < MAX_RETRIES && success == -1) {
                 // call blocks until ack is received or timeout
-                success = UAVTalkSendObject(uavTalkCon, ev->obj, ev->instId, UAVObjGetTelemetryAcked(&metadata), REQ_TIMEOUT_MS);
+                if (timestamped) {
+                    success = UAVTalkSendObjectTimestamped(uavTalkCon, ev->obj, ev->instId, policy->telemetryAcked, REQ_TIMEOUT_MS);
+                } else {
+                    success = UAVTalkSendObject(uavTalkCon, ev->obj, ev->instId, policy->telemetryAcked, REQ_TIMEOUT_MS);
+                }
                 if (success == -1) {
                     ++retries;
                 }
@@ -335,6 +512,11 @@ static void processObjEvent(UAVObjEvent *ev)
             if (success == -1) {
                 ++txErrors;
             }
+#if defined(PIOS_TELEM_BANDWIDTH_BUDGET)
+            else {
+                accountObjectTx(ev->obj, ev->instId);
+            }
+#endif
         } else if (ev->event == EV_UPDATE_REQ) {
             // Request object update from GCS (with retries)
             while (retries < MAX_RETRIES && success == -1) {
@@ -363,7 +545,7 @@ static void processObjEvent(UAVObjEvent *ev)
     }
     // Log UAVObject if necessary
     if (ev->obj) {
-        updateMode = UAVObjGetLoggingUpdateMode(&metadata);
+        updateMode = policy->loggingUpdateMode;
         if ((ev->event == EV_UPDATED && (updateMode == UPDATEMODE_ONCHANGE || updateMode == UPDATEMODE_THROTTLED))
             || ev->event == EV_LOGGING_MANUAL
             || (ev->event == EV_LOGGING_PERIODIC && updateMode != UPDATEMODE_THROTTLED)) {
@@ -383,6 +565,30 @@ static void processObjEvent(UAVObjEvent *ev)
     }
 }
 
+/**
+ * Check whether a periodic update can be skipped because the object did not
+ * change since it was last sent. A keepalive still goes out every KEEPALIVE_PERIODS.
+ * \param[in] policy The object policy, its skip state is updated
+ * \param[in] ev The periodic update event
+ * \return true if the update should not be sent
+ */
+static bool skipUnchangedUpdate(TelemetryPolicy *policy, UAVObjEvent *ev)
+{
+    if (!policy->telemetrySkipUnchanged || policy->telemetryUpdateMode != UPDATEMODE_PERIODIC) {
+        return false;
+    }
+
+    uint32_t hash = UAVObjGetInstanceHash(ev->obj, ev->instId);
+
+    if (policy->sentHashValid && hash == policy->sentHash && ++policy->skippedPeriods < KEEPALIVE_PERIODS) {
+        return true;
+    }
+    policy->sentHash       = hash;
+    policy->sentHashValid  = true;
+    policy->skippedPeriods = 0;
+    return false;
+}
+
 /**
  * Telemetry transmit task, regular priority
  */
@@ -392,30 +598,33 @@ static void telemetryTxTask(__attribute__((unused)) void *parameters)
 
     // Loop forever
     while (1) {
+#if defined(PIOS_TELEM_PRIORITY_QUEUE)
         /**
-         * Tries to empty the high priority queue before handling any standard priority item
+         * The set holds one entry per event queued in either queue. Each pass takes
+         * one entry and one event, the high priority one whenever there is one, so
+         * the counts stay in step even though the event does not always come from
+         * the queue the entry was posted for.
          */
-#if defined(PIOS_TELEM_PRIORITY_QUEUE)
-        // empty priority queue, non-blocking
-        while (xQueueReceive(priorityQueue, &ev, 0) == pdTRUE) {
-            // Process event
-            processObjEvent(&ev);
+        if (uxQueueMessagesWaiting(queueSet) == 0) {
+            // both queues are empty, send the bundled updates
+            UAVTalkFlushBundle(uavTalkCon);
         }
-        // check regular queue and process update - non-blocking
-        if (xQueueReceive(queue, &ev, 0) == pdTRUE) {
-            // Process event
-            processObjEvent(&ev);
-            // if both queues are empty, wait on priority queue for updates (1 tick) then repeat cycle
-        } else if (xQueueReceive(priorityQueue, &ev, 1) == pdTRUE) {
+        // sleep until either queue has an event
+        xQueueSelectFromSet(queueSet, portMAX_DELAY);
+        if (xQueueReceive(priorityQueue, &ev, 0) == pdTRUE || xQueueReceive(queue, &ev, 0) == pdTRUE) {
             // Process event
             processObjEvent(&ev);
         }
 #else
-        // wait on queue for updates (1 tick) then repeat cycle
-        if (xQueueReceive(queue, &ev, 1) == pdTRUE) {
-            // Process event
-            processObjEvent(&ev);
+        // check queue and process update - non-blocking
+        if (xQueueReceive(queue, &ev, 0) != pdTRUE) {
+            // queue is empty, send the bundled updates
+            UAVTalkFlushBundle(uavTalkCon);
+            // sleep until there is an event
+            xQueueReceive(queue, &ev, portMAX_DELAY);
         }
+        // Process event
+        processObjEvent(&ev);
 #endif /* if defined(PIOS_TELEM_PRIORITY_QUEUE) */
     }
 }
@@ -429,17 +638,29 @@ static void telemetryRxTask(__attribute__((unused)) void *parameters)
     // Task loop
     while (1) {
         uint32_t inputPort = getComPort(true);
+        uint32_t timeoutMs = 500;
 
+#if defined(PIOS_TELEM_FANOUT)
+        uint32_t fanoutPort = getFanoutInputPort(inputPort);
+        if (fanoutPort) {
+            // Serve the GCS on the telemetry port too
+            uint8_t serial_data[RX_BUFFER_SIZE];
+            uint16_t bytes_to_process;
+
+            while ((bytes_to_process = PIOS_COM_ReceiveBuffer(fanoutPort, serial_data, sizeof(serial_data), 0)) > 0) {
+                UAVTalkProcessInputBuffer(fanoutUavTalkCon, serial_data, bytes_to_process);
+            }
+            timeoutMs = FANOUT_RX_POLL_MS;
+        }
+#endif
         if (inputPort) {
             // Block until data are available
-            uint8_t serial_data[1];
+            uint8_t serial_data[RX_BUFFER_SIZE];
             uint16_t bytes_to_process;
 
-            bytes_to_process = PIOS_COM_ReceiveBuffer(inputPort, serial_data, sizeof(serial_data), 500);
+            bytes_to_process = PIOS_COM_ReceiveBuffer(inputPort, serial_data, sizeof(serial_data), timeoutMs);
             if (bytes_to_process > 0) {
-                for (uint8_t i = 0; i < bytes_to_process; i++) {
-                    UAVTalkProcessInputStream(uavTalkCon, serial_data[i]);
-                }
+                UAVTalkProcessInputBuffer(uavTalkCon, serial_data, bytes_to_process);
             }
         } else {
             vTaskDelay(5);
@@ -457,14 +678,12 @@ static void radioRxTask(__attribute__((unused)) void *parameters)
     while (1) {
         if (radioPort) {
             // Block until data are available
-            uint8_t serial_data[1];
+            uint8_t serial_data[RX_BUFFER_SIZE];
             uint16_t bytes_to_process;
 
             bytes_to_process = PIOS_COM_ReceiveBuffer(radioPort, serial_data, sizeof(serial_data), 500);
             if (bytes_to_process > 0) {
-                for (uint8_t i = 0; i < bytes_to_process; i++) {
-                    UAVTalkProcessInputStream(radioUavTalkCon, serial_data[i]);
-                }
+                UAVTalkProcessInputBuffer(radioUavTalkCon, serial_data, bytes_to_process);
             }
         } else {
             vTaskDelay(5);
@@ -499,6 +718,9 @@ static int32_t transmitData(uint8_t *data, int32_t length)
 {
     uint32_t outputPort = getComPort(false);
 
+#if defined(PIOS_TELEM_FANOUT)
+    fanOut(data, length, outputPort);
+#endif
     if (outputPort) {
         return PIOS_COM_SendBuffer(outputPort, data, length);
     }
@@ -506,6 +728,48 @@ static int32_t transmitData(uint8_t *data, int32_t length)
     return -1;
 }
 
+// Port holding the current reservation, UAVTalk serialises reserve/commit pairs
+static uint32_t reservedPort;
+
+/**
+ * Reserve room for a packet directly in the output port transmit buffer.
+ * \param[in] length Length of the packet
+ * \return NULL if the packet has to go through transmitData()
+ * \return pointer to the reserved room on success
+ */
+static uint8_t *reserveTransmitData(uint16_t length)
+{
+    uint32_t outputPort = getComPort(false);
+
+    if (!outputPort) {
+        return NULL;
+    }
+    uint8_t *data = PIOS_COM_SendBufferReserve(outputPort, length);
+    if (data) {
+        reservedPort = outputPort;
+#if defined(PIOS_TELEM_FANOUT)
+        reservedData = data;
+#endif
+    }
+    return data;
+}
+
+/**
+ * Send the packet built in room returned by reserveTransmitData()
+ * \param[in] length Length of the packet, 0 to drop it
+ * \return number of bytes transmitted
+ */
+static int32_t commitTransmitData(uint16_t length)
+{
+#if defined(PIOS_TELEM_FANOUT)
+    if (length > 0) {
+        // Copied before the commit, the reserved room is only valid until then
+        fanOut(reservedData, length, reservedPort);
+    }
+#endif
+    return PIOS_COM_SendBufferCommit(reservedPort, length);
+}
+
 /**
  * Set update period of object (it must be already setup for periodic updates)
  * \param[in] obj The object to update
@@ -513,23 +777,28 @@ static int32_t transmitData(uint8_t *data, int32_t length)
  * \return 0 Success
  * \return -1 Failure
  */
-static int32_t setUpdatePeriod(UAVObjHandle obj, int32_t updatePeriodMs)
+static int32_t setUpdatePeriod(TelemetryPolicy *policy, int32_t updatePeriodMs)
 {
     UAVObjEvent ev;
     int32_t ret;
 
+    if (updatePeriodMs == policy->appliedUpdatePeriod) {
+        return 0;
+    }
+
     // Add or update object for periodic updates
-    ev.obj    = obj;
+    ev.obj    = policy->obj;
     ev.instId = UAVOBJ_ALL_INSTANCES;
     ev.event  = EV_UPDATED_PERIODIC;
     ev.lowPriority = true;
 
-    xQueueHandle targetQueue = UAVObjIsPriority(obj) ? priorityQueue : queue;
+    xQueueHandle targetQueue = UAVObjIsPriority(policy->obj) ? priorityQueue : queue;
 
     ret = EventPeriodicQueueUpdate(&ev, targetQueue, updatePeriodMs);
     if (ret == -1) {
         ret = EventPeriodicQueueCreate(&ev, targetQueue, updatePeriodMs);
     }
+    policy->appliedUpdatePeriod = (ret == 0) ? updatePeriodMs : -1;
     return ret;
 }
 
@@ -540,26 +809,141 @@ static int32_t setUpdatePeriod(UAVObjHandle obj, int32_t updatePeriodMs)
  * \return 0 Success
  * \return -1 Failure
  */
-static int32_t setLoggingPeriod(UAVObjHandle obj, int32_t updatePeriodMs)
+static int32_t setLoggingPeriod(TelemetryPolicy *policy, int32_t updatePeriodMs)
 {
     UAVObjEvent ev;
     int32_t ret;
 
+    if (updatePeriodMs == policy->appliedLoggingPeriod) {
+        return 0;
+    }
+
     // Add or update object for periodic updates
-    ev.obj    = obj;
+    ev.obj    = policy->obj;
     ev.instId = UAVOBJ_ALL_INSTANCES;
     ev.event  = EV_LOGGING_PERIODIC;
     ev.lowPriority = true;
 
-    xQueueHandle targetQueue = UAVObjIsPriority(obj) ? priorityQueue : queue;
+    xQueueHandle targetQueue = UAVObjIsPriority(policy->obj) ? priorityQueue : queue;
 
     ret = EventPeriodicQueueUpdate(&ev, targetQueue, updatePeriodMs);
     if (ret == -1) {
         ret = EventPeriodicQueueCreate(&ev, targetQueue, updatePeriodMs);
     }
+    policy->appliedLoggingPeriod = (ret == 0) ? updatePeriodMs : -1;
     return ret;
 }
 
+/**
+ * Get the telemetry and logging policy of an object, from the cache when available
+ * \param[in] obj The object
+ * \param[in] buffer Storage for the policy when it is not cached
+ * \return The policy
+ */
+static TelemetryPolicy *getPolicy(UAVObjHandle obj, TelemetryPolicy *buffer)
+{
+#if defined(PIOS_TELEM_POLICY_CACHE)
+    TelemetryPolicy *policy = findPolicy(obj, false);
+    if (policy) {
+        return policy;
+    }
+#endif
+    buffer->appliedUpdatePeriod  = -1;
+    buffer->appliedLoggingPeriod = -1;
+    buffer->appliedEventMask     = -1;
+    decodePolicy(obj, buffer);
+    return buffer;
+}
+
+/**
+ * Decode the telemetry and logging policy of an object again, after its metadata changed
+ * \param[in] obj The object
+ * \param[in] buffer Storage for the policy when it can not be cached
+ * \return The policy
+ */
+static TelemetryPolicy *refreshPolicy(UAVObjHandle obj, TelemetryPolicy *buffer)
+{
+#if defined(PIOS_TELEM_POLICY_CACHE)
+    TelemetryPolicy *policy = findPolicy(obj, true);
+    if (policy) {
+        decodePolicy(obj, policy);
+        return policy;
+    }
+#endif
+    return getPolicy(obj, buffer);
+}
+
+/**
+ * Decode the telemetry and logging policy from the object metadata
+ * \param[in] obj The object
+ * \param[out] policy The policy, the dispatcher state is left untouched
+ */
+static void decodePolicy(UAVObjHandle obj, TelemetryPolicy *policy)
+{
+    UAVObjMetadata metadata;
+
+    UAVObjGetMetadata(obj, &metadata);
+    policy->obj = obj;
+    policy->telemetryUpdatePeriod = metadata.telemetryUpdatePeriod;
+    policy->loggingUpdatePeriod   = metadata.loggingUpdatePeriod;
+    policy->telemetryUpdateMode   = UAVObjGetTelemetryUpdateMode(&metadata);
+    policy->loggingUpdateMode     = UAVObjGetLoggingUpdateMode(&metadata);
+    policy->telemetryAcked = UAVObjGetTelemetryAcked(&metadata);
+    policy->telemetryTimestamped  = UAVObjGetTelemetryTimestamped(&metadata);
+    policy->telemetrySkipUnchanged = UAVObjGetTelemetrySkipUnchanged(&metadata);
+    // Send the next periodic update in any case
+    policy->sentHashValid = false;
+}
+
+#if defined(PIOS_TELEM_POLICY_CACHE)
+/**
+ * Count the data objects, to size the policy cache
+ * \param[in] obj The object
+ */
+static void countObject(UAVObjHandle obj)
+{
+    if (!UAVObjIsMetaobject(obj)) {
+        maxPolicies++;
+    }
+}
+
+/**
+ * Find the cached policy of an object
+ * \param[in] obj The object
+ * \param[in] insert Add an entry for the object when it is missing and there is room left
+ * \return The policy, NULL if the object is not cached
+ */
+static TelemetryPolicy *findPolicy(UAVObjHandle obj, bool insert)
+{
+    uint16_t low  = 0;
+    uint16_t high = numPolicies;
+
+    while (low < high) {
+        uint16_t mid = (low + high) / 2;
+        if ((uintptr_t)policies[mid].obj < (uintptr_t)obj) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    if (low < numPolicies && policies[low].obj == obj) {
+        return &policies[low];
+    }
+    if (!insert || numPolicies >= maxPolicies) {
+        return NULL;
+    }
+
+    // Keep the cache sorted, objects are only added when telemetry starts
+    memmove(&policies[low + 1], &policies[low], (numPolicies - low) * sizeof(TelemetryPolicy));
+    numPolicies++;
+    policies[low].obj = obj;
+    policies[low].appliedUpdatePeriod  = -1;
+    policies[low].appliedLoggingPeriod = -1;
+    policies[low].appliedEventMask     = -1;
+    return &policies[low];
+}
+#endif /* PIOS_TELEM_POLICY_CACHE */
+
 /**
  * Called each time the GCS telemetry stats object is updated.
  * Trigger a flight telemetry stats update if a connection is not
@@ -577,6 +961,32 @@ static void gcsTelemetryStatsUpdated()
     }
 }
 
+/**
+ * Called each time the time sync object is updated.
+ * Answers the GCS requests right away with the board time they were received
+ * and sent back at, the GCS works out the clock offset and the round trip from them.
+ * The tick count is sent too, it is the time base of the timestamped updates and of the logs.
+ */
+static void timeSyncUpdated(UAVObjEvent *ev)
+{
+    TimeSyncData timeSync;
+
+    // Only the requests unpacked from the GCS are answered, not our own updates
+    if (ev->event != EV_UNPACKED) {
+        return;
+    }
+
+    uint32_t rxTime = PIOS_DELAY_GetuS();
+    TimeSyncGet(&timeSync);
+    timeSync.BoardRxTime = rxTime;
+    timeSync.BoardTxTick = xTaskGetTickCount() * portTICK_RATE_MS;
+    timeSync.BoardTxTime = PIOS_DELAY_GetuS();
+    TimeSyncSet(&timeSync);
+    if (UAVTalkSendObject(uavTalkCon, TimeSyncHandle(), 0, 0, 0) == -1) {
+        ++txErrors;
+    }
+}
+
 /**
  * Update telemetry statistics and handle connection handshake
  */
@@ -594,6 +1004,11 @@ static void updateTelemetryStats()
 #ifdef PIOS_INCLUDE_RFM22B
     UAVTalkAddStats(radioUavTalkCon, &utalkStats, true);
 #endif
+#if defined(PIOS_TELEM_FANOUT)
+    UAVTalkAddStats(fanoutUavTalkCon, &utalkStats, true);
+    // The link speeds can be changed at run time
+    updateFanoutSinks();
+#endif
 
     // Get object data
     FlightTelemetryStatsGet(&flightStats);
@@ -623,6 +1038,11 @@ static void updateTelemetryStats()
         flightStats.RxSyncErrors = 0;
         flightStats.RxCrcErrors  = 0;
     }
+#if defined(PIOS_TELEM_BANDWIDTH_BUDGET)
+    // Periodic updates are sent whether or not a GCS is connected, so the budget always applies
+    updateBandwidthBudget(utalkStats.txBytes, &flightStats);
+#endif
+    updateLoadLevel();
     txErrors  = 0;
     txRetries = 0;
 
@@ -746,6 +1166,390 @@ static uint32_t getComPort(__attribute__((unused)) bool input)
     }
 }
 
+/**
+ * Check whether telemetry goes over USB, where the full objects are always sent
+ */
+static bool isUsbLink()
+{
+#if defined(PIOS_INCLUDE_USB)
+    return getComPort(false) == PIOS_COM_TELEM_USB;
+#else
+    return false;
+#endif /* PIOS_INCLUDE_USB */
+}
+
+/**
+ * Scale the update period of an object to fit the bandwidth budget and the CPU
+ * load, see updateLoadLevel().
+ * Priority objects (settings, telemetry stats) always use the requested period.
+ * \param[in] obj The object
+ * \param[in] updatePeriodMs The update period requested by the object metadata
+ * \return The update period to use
+ */
+static int32_t getScaledPeriod(UAVObjHandle obj, int32_t updatePeriodMs)
+{
+    if (UAVObjIsPriority(obj)) {
+        return updatePeriodMs;
+    }
+#if defined(PIOS_TELEM_BANDWIDTH_BUDGET)
+    updatePeriodMs = (updatePeriodMs * periodScale) / MIN_PERIOD_SCALE;
+#endif
+    if (loadLevel >= LOADGOVERNOR_LEVEL_TELEMETRY) {
+        updatePeriodMs *= LOAD_SHED_PERIOD_FACTOR;
+    }
+    return updatePeriodMs;
+}
+
+/**
+ * Scale the logging period of an object to the CPU load, see updateLoadLevel()
+ * \param[in] updatePeriodMs The logging period requested by the object metadata
+ * \return The logging period to use
+ */
+static int32_t getScaledLoggingPeriod(int32_t updatePeriodMs)
+{
+    if (loadLevel >= LOADGOVERNOR_LEVEL_LOGGING) {
+        updatePeriodMs *= LOAD_SHED_PERIOD_FACTOR;
+    }
+    return updatePeriodMs;
+}
+
+/**
+ * Apply the current period scale to a periodic object
+ * \param[in] obj The object to update
+ */
+static void applyPeriodScale(UAVObjHandle obj)
+{
+    TelemetryPolicy buffer;
+    TelemetryPolicy *policy;
+
+    if (UAVObjIsMetaobject(obj) || UAVObjIsPriority(obj)) {
+        return;
+    }
+
+    policy = getPolicy(obj, &buffer);
+    if (policy->telemetryUpdateMode == UPDATEMODE_PERIODIC || policy->telemetryUpdateMode == UPDATEMODE_THROTTLED) {
+        setUpdatePeriod(policy, getScaledPeriod(obj, policy->telemetryUpdatePeriod));
+    }
+    if (policy->loggingUpdateMode == UPDATEMODE_PERIODIC || policy->loggingUpdateMode == UPDATEMODE_THROTTLED) {
+        setLoggingPeriod(policy, getScaledLoggingPeriod(policy->loggingUpdatePeriod));
+    }
+}
+
+/**
+ * Follow the load governor of the System module: the periodic telemetry and then
+ * the periodic logging are slowed down while the CPU is short of headroom.
+ * On change updates are left alone, they are only sent when the data changes.
+ */
+static void updateLoadLevel()
+{
+    LoadGovernorLevel level = LoadGovernorGetLevel();
+
+    if (level > LOADGOVERNOR_LEVEL_LOGGING) {
+        level = LOADGOVERNOR_LEVEL_LOGGING;
+    }
+    if (level != loadLevel) {
+        loadLevel = level;
+        UAVObjIterate(&applyPeriodScale);
+    }
+}
+
+#if defined(PIOS_TELEM_BANDWIDTH_BUDGET)
+/**
+ * Account the bytes sent for an object update
+ * \param[in] obj The object sent
+ * \param[in] instId The instance sent, or UAVOBJ_ALL_INSTANCES
+ */
+static void accountObjectTx(UAVObjHandle obj, uint16_t instId)
+{
+    ObjectTxStats *entry;
+    uint32_t numInstances = (instId == UAVOBJ_ALL_INSTANCES) ? UAVObjGetNumInstances(obj) : 1;
+
+    LL_FOREACH(objectTxStats, entry) {
+        if (entry->obj == obj) {
+            break;
+        }
+    }
+    if (!entry) {
+        // Entries are only created for objects actually sent
+        entry = (ObjectTxStats *)pios_malloc(sizeof(ObjectTxStats));
+        if (!entry) {
+            return;
+        }
+        entry->obj     = obj;
+        entry->txBytes = 0;
+        LL_PREPEND(objectTxStats, entry);
+    }
+    entry->txBytes += numInstances * (UAVObjGetNumBytes(obj) + OBJECT_OVERHEAD_BYTES);
+}
+
+/**
+ * Report the object using most of the link and stretch the periodic update periods
+ * so that the telemetry traffic fits the link rate.
+ * \param[in] txBytes Bytes sent since the last call
+ * \param[in,out] flightStats Telemetry stats, top talker and period scale are updated
+ */
+static void updateBandwidthBudget(uint32_t txBytes, FlightTelemetryStatsData *flightStats)
+{
+    ObjectTxStats *entry;
+    ObjectTxStats *topEntry = NULL;
+    uint32_t timeNow = xTaskGetTickCount() * portTICK_RATE_MS;
+    uint32_t elapsed = timeNow - timeOfLastBudgetUpdate;
+    uint32_t budget;
+    uint32_t txRate;
+    uint32_t scale;
+
+    // The stats are also updated on handshake, only evaluate over a full stats period
+    budgetTxBytes += txBytes;
+    if (elapsed < STATS_UPDATE_PERIOD_MS) {
+        return;
+    }
+
+    // Find the top talker and restart the accounting
+    LL_FOREACH(objectTxStats, entry) {
+        if (!topEntry || entry->txBytes > topEntry->txBytes) {
+            topEntry = entry;
+        }
+    }
+    if (topEntry && topEntry->txBytes > 0) {
+        flightStats->TxTopObjectID   = UAVObjGetID(topEntry->obj);
+        flightStats->TxTopObjectRate = ((float)topEntry->txBytes * 1000.0f) / (float)elapsed;
+    } else {
+        flightStats->TxTopObjectID   = 0;
+        flightStats->TxTopObjectRate = 0;
+    }
+    LL_FOREACH(objectTxStats, entry) {
+        entry->txBytes = 0;
+    }
+
+    txRate = (uint32_t)(((uint64_t)budgetTxBytes * 1000) / elapsed);
+    budgetTxBytes = 0;
+    timeOfLastBudgetUpdate = timeNow;
+
+    budget = (getLinkRate() * BANDWIDTH_BUDGET_PERCENT) / 100;
+    scale  = periodScale;
+    if (budget == 0) {
+        // No rate limit on this link (USB), use the requested periods
+        scale = MIN_PERIOD_SCALE;
+    } else {
+        if (txRate > budget || txRate < (budget * BANDWIDTH_RELAX_PERCENT) / 100) {
+            // Periodic traffic is inversely proportional to the periods, aim at the budget
+            scale = (uint32_t)(((uint64_t)scale * txRate) / budget);
+        }
+        if (uxQueueMessagesWaiting(queue) > MAX_QUEUE_SIZE / 2) {
+            // The queue is backing up whatever the estimate says, back off further
+            scale += scale / 4;
+        }
+        if (scale < MIN_PERIOD_SCALE) {
+            scale = MIN_PERIOD_SCALE;
+        } else if (scale > MAX_PERIOD_SCALE) {
+            scale = MAX_PERIOD_SCALE;
+        }
+    }
+
+    if (scale != periodScale) {
+        periodScale = scale;
+        UAVObjIterate(&applyPeriodScale);
+    }
+    flightStats->TxPeriodScale = periodScale;
+}
+
+/**
+ * Get the rate of the link used for telemetry
+ * \return The link rate in bytes/s, 0 if unlimited
+ */
+static uint32_t getLinkRate()
+{
+    return getPortRate(getComPort(false));
+}
+#endif /* PIOS_TELEM_BANDWIDTH_BUDGET */
+
+#if defined(PIOS_TELEM_BANDWIDTH_BUDGET) || defined(PIOS_TELEM_FANOUT)
+/**
+ * Get the rate of a telemetry link
+ * \param[in] port The com port of the link
+ * \return The link rate in bytes/s, 0 if unlimited
+ */
+static uint32_t getPortRate(uint32_t port)
+{
+    uint32_t baud = 0;
+    uint8_t speed;
+
+#if defined(PIOS_INCLUDE_USB)
+    if (port == PIOS_COM_TELEM_USB) {
+        return 0;
+    }
+#endif /* PIOS_INCLUDE_USB */
+    if (!port) {
+        return 0;
+    }
+
+#ifdef PIOS_INCLUDE_RFM22B
+    if (port == PIOS_COM_RF) {
+        // Internal modem, the serial speed selects the RF data rate
+        OPLinkSettingsComSpeedGet(&speed);
+        switch (speed) {
+        case OPLINKSETTINGS_COMSPEED_4800:
+            baud = 4800;
+            break;
+        case OPLINKSETTINGS_COMSPEED_9600:
+            baud = 9600;
+            break;
+        case OPLINKSETTINGS_COMSPEED_19200:
+            baud = 19200;
+            break;
+        case OPLINKSETTINGS_COMSPEED_38400:
+            baud = 38400;
+            break;
+        case OPLINKSETTINGS_COMSPEED_57600:
+            baud = 57600;
+            break;
+        case OPLINKSETTINGS_COMSPEED_115200:
+            baud = 115200;
+            break;
+        }
+        return baud / 10;
+    }
+#endif /* PIOS_INCLUDE_RFM22B */
+
+    HwSettingsTelemetrySpeedGet(&speed);
+    switch (speed) {
+    case HWSETTINGS_TELEMETRYSPEED_2400:
+        baud = 2400;
+        break;
+    case HWSETTINGS_TELEMETRYSPEED_4800:
+        baud = 4800;
+        break;
+    case HWSETTINGS_TELEMETRYSPEED_9600:
+        baud = 9600;
+        break;
+    case HWSETTINGS_TELEMETRYSPEED_19200:
+        baud = 19200;
+        break;
+    case HWSETTINGS_TELEMETRYSPEED_38400:
+        baud = 38400;
+        break;
+    case HWSETTINGS_TELEMETRYSPEED_57600:
+        baud = 57600;
+        break;
+    case HWSETTINGS_TELEMETRYSPEED_115200:
+        baud = 115200;
+        break;
+    }
+    // 8N1 framing, ten bits on the wire per byte
+    return baud / 10;
+}
+#endif /* defined(PIOS_TELEM_BANDWIDTH_BUDGET) || defined(PIOS_TELEM_FANOUT) */
+
+#if defined(PIOS_TELEM_FANOUT)
+/**
+ * Add a port the telemetry stream is copied to when it is not the primary port
+ * \param[in] port The com port, ignored if zero
+ */
+static void addFanoutSink(uint32_t port)
+{
+    if (!port || numFanoutSinks >= MAX_FANOUT_SINKS) {
+        return;
+    }
+    TelemetrySink *sink = &fanoutSinks[numFanoutSinks++];
+    sink->port   = port;
+    sink->rate   = 0;
+    sink->tokens = 0;
+    sink->timeOfLastRefill = xTaskGetTickCount() * portTICK_RATE_MS;
+}
+
+/**
+ * Update the rate profile of the fan out ports from the link settings
+ */
+static void updateFanoutSinks()
+{
+    for (uint8_t i = 0; i < numFanoutSinks; i++) {
+        fanoutSinks[i].rate = getPortRate(fanoutSinks[i].port);
+    }
+}
+
+/**
+ * Copy a frame sent on the primary port to the other telemetry ports.
+ * The copies never block, a port whose transmit buffer is full misses the frame.
+ * Each port spends its link rate as a token bucket, the updates that are not
+ * acknowledged are dropped when it is exhausted so that a slow radio link does not
+ * fill up with stale updates while the primary port runs at full rate.
+ * \param[in] data The frame
+ * \param[in] length Length of the frame
+ * \param[in] primaryPort Port the frame is sent on, 0 if none
+ */
+static void fanOut(const uint8_t *data, uint16_t length, uint32_t primaryPort)
+{
+    bool lossTolerant = UAVTalkIsLossTolerant(data, length);
+    uint32_t timeNow  = xTaskGetTickCount() * portTICK_RATE_MS;
+
+    for (uint8_t i = 0; i < numFanoutSinks; i++) {
+        TelemetrySink *sink = &fanoutSinks[i];
+        if (sink->port == primaryPort || !PIOS_COM_Available(sink->port)) {
+            continue;
+        }
+        if (sink->rate) {
+            // Refill, the bucket holds up to a second of traffic
+            uint32_t refill = ((timeNow - sink->timeOfLastRefill) * sink->rate) / 1000;
+            if (refill > 0) {
+                sink->tokens += refill;
+                if (sink->tokens > sink->rate) {
+                    sink->tokens = sink->rate;
+                }
+                sink->timeOfLastRefill = timeNow;
+            }
+            if (sink->tokens < length) {
+                if (lossTolerant) {
+                    continue;
+                }
+                sink->tokens = 0;
+            } else {
+                sink->tokens -= length;
+            }
+        }
+        PIOS_COM_SendBufferNonBlocking(sink->port, data, length);
+    }
+}
+
+/**
+ * Get the secondary port to read, the telemetry port while USB is the primary port.
+ * The internal modem input is always read by the radio task.
+ * \param[in] inputPort The primary input port
+ * \return The port, 0 if none
+ */
+static uint32_t getFanoutInputPort(__attribute__((unused)) uint32_t inputPort)
+{
+#if defined(PIOS_INCLUDE_USB)
+    if (inputPort != PIOS_COM_TELEM_USB || !telemetryPort) {
+        return 0;
+    }
+#ifdef PIOS_INCLUDE_RFM22B
+    if (telemetryPort == PIOS_COM_RF) {
+        return 0;
+    }
+#endif /* PIOS_INCLUDE_RFM22B */
+    return PIOS_COM_Available(telemetryPort) ? telemetryPort : 0;
+#else
+    return 0;
+#endif /* PIOS_INCLUDE_USB */
+}
+
+/**
+ * Transmit the answers to the GCS on the telemetry port while USB is the primary port.
+ * \param[in] data Data buffer to send
+ * \param[in] length Length of buffer
+ * \return -1 on failure
+ * \return number of bytes transmitted on success
+ */
+static int32_t transmitFanoutData(uint8_t *data, int32_t length)
+{
+    if (telemetryPort) {
+        return PIOS_COM_SendBuffer(telemetryPort, data, length);
+    }
+
+    return -1;
+}
+#endif /* PIOS_TELEM_FANOUT */
+
 /**
  * @}
  * @}
@@ -172,8 +172,28 @@ static xThreadState* prvGetThreadHandleByThread( pthread_t hThread );
 static portLONG prvGetFreeThreadState( void );
 static void prvDeleteThread( void *xThreadId );
 static void prvPortYield();
+static portBASE_TYPE prvSystemTick( void );
+#if ( configUSE_LOCKSTEP_CLOCK == 1 )
+static void prvLockstepStep( portLONG lTicks );
+#endif
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_LOCKSTEP_CLOCK == 1 )
+/*
+ * Lockstep clock hooks, provided by the application (see pios_simclock.c).
+ * xApplicationLockstepWait() returns pdFALSE while the clock runs in real
+ * time, otherwise it blocks until the simulator asks for *plTicks ticks.
+ * vApplicationLockstepTick() advances the simulated time by one tick and
+ * vApplicationLockstepDone() reports a finished step to the simulator.
+ */
+extern portBASE_TYPE xApplicationLockstepWait( portLONG *plTicks );
+extern void vApplicationLockstepTick( void );
+extern void vApplicationLockstepDone( void );
+
+/* Real time allowed for the tasks to settle after a lockstep tick before the next one is forced */
+#define LOCKSTEP_IDLE_TIMEOUT_US	( 100 * portTICK_RATE_MICROSECONDS )
+#endif
+
 /*
  * Exception handlers.
  */
@@ -303,6 +323,16 @@ portBASE_TYPE xPortStartScheduler( void )
 	
 	while ( pdTRUE != xSchedulerEnd )
 	{
+#if ( configUSE_LOCKSTEP_CLOCK == 1 )
+		/* in lockstep the simulator, not the wall clock, decides when to tick */
+		portLONG lLockstepTicks;
+		if ( pdTRUE == xApplicationLockstepWait( &lLockstepTicks ) ) {
+			prvLockstepStep( lLockstepTicks );
+			gettimeofday( &lastTime, NULL );
+			sleepTimeUS = portTICK_RATE_MICROSECONDS;
+			continue;
+		}
+#endif
 		/* wait for the specified wait time */
 		wait.tv_sec = sleepTimeUS / 1000000;
 		wait.tv_nsec = 1000 * ( sleepTimeUS % 1000000 );
@@ -581,10 +611,54 @@ void vPortClearInterruptMask( portBASE_TYPE xMask )
 
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_LOCKSTEP_CLOCK == 1 )
+/**
+ * Runs lTicks ticks back to back. After every tick the tasks get to run
+ * until all of them are blocked and the idle task is scheduled, so the
+ * outcome does not depend on how fast the host is.
+ */
+static void prvLockstepStep( portLONG lTicks )
+{
+	struct timeval start, now;
+
+	while ( lTicks-- > 0 && pdTRUE != xSchedulerEnd )
+	{
+		vApplicationLockstepTick();
+
+		/* a tick is deferred while a task is in a critical section, retry until it happens */
+		while ( pdTRUE != prvSystemTick() && pdTRUE != xSchedulerEnd ) {
+			sched_yield();
+		}
+
+		/* wait until all tasks have blocked, a task spinning forever only delays the step */
+		gettimeofday( &start, NULL );
+		while ( xTaskGetCurrentTaskHandle() != xTaskGetIdleTaskHandle() && pdTRUE != xSchedulerEnd ) {
+			sched_yield();
+			gettimeofday( &now, NULL );
+			if ( 1000000 * ( now.tv_sec - start.tv_sec ) + ( now.tv_usec - start.tv_usec ) > LOCKSTEP_IDLE_TIMEOUT_US ) {
+				break;
+			}
+		}
+	}
+
+	vApplicationLockstepDone();
+}
+/*-----------------------------------------------------------*/
+#endif
+
 /**
  * the tick handler is just an ordinary function, called by the supervisor thread periodically
  */
 void vPortSystemTickHandler()
+{
+	(void)prvSystemTick();
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * Returns pdFALSE when the tick could not be processed right now and was pended
+ */
+static portBASE_TYPE prvSystemTick( void )
 {
 	/**
 	 * the problem with the tick handler is, that it runs outside of the schedulers domain - worse,
@@ -597,14 +671,14 @@ void vPortSystemTickHandler()
 	if ( prvGetThreadHandle(xTaskGetCurrentTaskHandle())->threadStatus!=THREAD_RUNNING ) {
 		xPendYield = pdTRUE;
 		PORT_UNLOCK( xGuardMutex );
-		return;
+		return pdFALSE;
 	}
 
 	/* interrupts MUST be enabled */
 	if ( xInterruptsEnabled != pdTRUE ) {
 		xPendYield = pdTRUE;
 		PORT_UNLOCK( xGuardMutex );
-		return;
+		return pdFALSE;
 	}
 
 	/* this should always be true, but it can't harm to check */
@@ -670,6 +744,8 @@ void vPortSystemTickHandler()
 
 	/* finish up */
 	PORT_UNLOCK( xGuardMutex );
+
+	return pdTRUE;
 }
 /*-----------------------------------------------------------*/
 
@@ -0,0 +1,518 @@
+/**
+ ******************************************************************************
+ * @file       pios_blackbox.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @addtogroup PIOS PIOS Core hardware abstraction layer
+ * @{
+ * @addtogroup PIOS_BLACKBOX Raw flash blackbox log
+ * @{
+ * @brief Streams high rate UAVObject samples to a raw flash partition
+ *
+ * Records are batched in one of two RAM chunks while the other one is written
+ * to flash by a low priority writer calling PIOS_BLACKBOX_Process(). Chunks are
+ * programmed page by page in sequence, there is no per record filesystem
+ * overhead and no erase while logging: the partition is erased up front with
+ * PIOS_BLACKBOX_Erase() and logging stops once it is full.
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "pios.h"
+
+#ifdef PIOS_INCLUDE_BLACKBOX
+
+#include <stdbool.h>
+#include <string.h>
+#include "pios_blackbox_priv.h"
+
+enum pios_blackbox_dev_magic {
+    PIOS_BLACKBOX_DEV_MAGIC = 0x42424f58,
+};
+
+/* Starts every chunk written to flash, must not read as erased flash */
+#define BLACKBOX_CHUNK_MAGIC 0xB1ACB0C5
+
+struct blackbox_chunk_header {
+    uint32_t magic;
+    uint16_t session;
+    uint16_t used; /* bytes of the chunk holding records, header included */
+} __attribute__((packed));
+
+struct blackbox_record_header {
+    uint32_t timestamp; /* PIOS_DELAY_GetuS() when the sample was logged */
+    uint32_t obj_id;
+    uint16_t obj_inst_id;
+    uint16_t obj_size;
+} __attribute__((packed));
+
+struct blackbox_state {
+    enum pios_blackbox_dev_magic magic;
+    const struct pios_blackbox_cfg *cfg;
+
+    /* Double buffer, records go into buffer[fill_buffer] while the other one may be pending */
+    uint8_t *buffer[2];
+    uint8_t fill_buffer;
+    uint16_t fill; /* bytes used in the fill buffer, header included */
+    volatile bool pending; /* the other buffer is full and waiting for the writer */
+
+    uint32_t write_offset; /* next chunk to be written, relative to start_offset */
+    uint32_t erase_offset; /* next sector to be erased while erasing */
+    volatile bool erasing;
+    uint32_t erase_generation; /* bumped by every erase request, see PIOS_BLACKBOX_Process() */
+    uint16_t session;
+    uint32_t dropped_records;
+
+#if defined(PIOS_INCLUDE_FREERTOS)
+    xSemaphoreHandle mutex;
+#endif
+
+    /* Underlying flash driver glue */
+    const struct pios_flash_driver *driver;
+    uintptr_t flash_id;
+};
+
+#if defined(PIOS_INCLUDE_FREERTOS)
+#define mutexlock(bb)   xSemaphoreTake((bb)->mutex, portMAX_DELAY)
+#define mutexunlock(bb) xSemaphoreGive((bb)->mutex)
+#else
+#define mutexlock(bb)
+#define mutexunlock(bb)
+#endif
+
+static bool PIOS_BLACKBOX_validate(const struct blackbox_state *bb)
+{
+    return bb && (bb->magic == PIOS_BLACKBOX_DEV_MAGIC);
+}
+
+/**
+ * @brief Hands the fill buffer over to the writer and starts filling the other one
+ * @note Must be called while holding the mutex, with no buffer pending
+ */
+static void blackbox_swap_buffers(struct blackbox_state *bb)
+{
+    PIOS_Assert(!bb->pending);
+
+    struct blackbox_chunk_header *hdr = (struct blackbox_chunk_header *)bb->buffer[bb->fill_buffer];
+    hdr->magic = BLACKBOX_CHUNK_MAGIC;
+    hdr->used  = bb->fill;
+
+    /* Leave the unused tail erased */
+    memset(bb->buffer[bb->fill_buffer] + bb->fill, 0xFF, bb->cfg->chunk_size - bb->fill);
+
+    bb->pending     = true;
+    bb->fill_buffer ^= 1;
+    bb->fill = sizeof(struct blackbox_chunk_header);
+}
+
+/**
+ * @brief Check whether a chunk in flash has been written
+ * @return 1 if written, 0 if erased, < 0 if it holds something else or on error
+ * @note Must be called while holding the flash transaction lock
+ */
+static int32_t blackbox_chunk_state(const struct blackbox_state *bb, uint32_t offset, struct blackbox_chunk_header *hdr)
+{
+    if (bb->driver->read_data(bb->flash_id,
+                              bb->cfg->start_offset + offset,
+                              (uint8_t *)hdr,
+                              sizeof(*hdr)) != 0) {
+        return -1;
+    }
+
+    if (hdr->magic == BLACKBOX_CHUNK_MAGIC) {
+        return 1;
+    }
+    if (hdr->magic == 0xFFFFFFFF && hdr->session == 0xFFFF && hdr->used == 0xFFFF) {
+        return 0;
+    }
+
+    /* Not ours, the partition needs an erase before it can be used */
+    return -2;
+}
+
+/**
+ * @brief Find the end of the log, written chunks must be followed by erased ones only
+ * @return 0 if success, < 0 if the partition does not hold a valid log
+ * @note Scans every chunk header so that leftovers of a different flash layout are caught
+ * @note Must be called while holding the flash transaction lock
+ */
+static int32_t blackbox_find_end(struct blackbox_state *bb)
+{
+    struct blackbox_chunk_header hdr;
+
+    bb->write_offset = bb->cfg->size;
+    bb->session = 0;
+
+    for (uint32_t offset = 0; offset < bb->cfg->size; offset += bb->cfg->chunk_size) {
+        switch (blackbox_chunk_state(bb, offset, &hdr)) {
+        case 1:
+            if (bb->write_offset < offset) {
+                /* Written chunk after the end of the log */
+                return -1;
+            }
+            /* Continue with the session after the last one logged */
+            bb->session = hdr.session + 1;
+            break;
+        case 0:
+            if (bb->write_offset > offset) {
+                bb->write_offset = offset;
+            }
+            break;
+        default:
+            return -2;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Initialize the blackbox on a raw flash partition
+ * @param[out] blackbox_id handle to the blackbox
+ * @param[in] cfg partition layout
+ * @param[in] driver flash driver
+ * @param[in] flash_id flash device id
+ * @return 0 if success, < 0 on failure
+ * @note A partition that does not hold a valid log is erased by the writer before use
+ */
+int32_t PIOS_BLACKBOX_Init(uintptr_t *blackbox_id, const struct pios_blackbox_cfg *cfg, const struct pios_flash_driver *driver, uintptr_t flash_id)
+{
+    PIOS_Assert(blackbox_id);
+    PIOS_Assert(cfg);
+    PIOS_Assert(driver);
+
+    /* Chunks are written page by page, the partition consists of whole chunks and sectors */
+    PIOS_Assert(cfg->chunk_size % cfg->page_size == 0);
+    PIOS_Assert(cfg->sector_size % cfg->chunk_size == 0);
+    PIOS_Assert(cfg->size % cfg->sector_size == 0);
+
+    struct blackbox_state *bb = (struct blackbox_state *)pios_malloc(sizeof(*bb));
+    if (!bb) {
+        return -1;
+    }
+    memset(bb, 0, sizeof(*bb));
+
+    bb->buffer[0] = (uint8_t *)pios_malloc(cfg->chunk_size);
+    bb->buffer[1] = (uint8_t *)pios_malloc(cfg->chunk_size);
+#if defined(PIOS_INCLUDE_FREERTOS)
+    bb->mutex     = xSemaphoreCreateMutex();
+    if (!bb->mutex) {
+        return -1;
+    }
+#endif
+    if (!bb->buffer[0] || !bb->buffer[1]) {
+        return -1;
+    }
+
+    bb->cfg      = cfg;
+    bb->driver   = driver;
+    bb->flash_id = flash_id;
+    bb->fill     = sizeof(struct blackbox_chunk_header);
+    bb->magic    = PIOS_BLACKBOX_DEV_MAGIC;
+
+    if (driver->start_transaction(flash_id) != 0) {
+        return -2;
+    }
+
+    if (blackbox_find_end(bb) != 0) {
+        /* Let the writer wipe it before anything gets logged */
+        bb->erase_offset = 0;
+        bb->erasing = true;
+    }
+
+    driver->end_transaction(flash_id);
+
+    *blackbox_id = (uintptr_t)bb;
+    return 0;
+}
+
+/**
+ * @brief Log one UAVObject sample
+ * @param[in] blackbox_id The blackbox to use for this action
+ * @param[in] obj_id UAVObject ID of the sample
+ * @param[in] obj_inst_id The instance number of the sample
+ * @param[in] obj_data Contents of the sample
+ * @param[in] obj_size Size of the sample
+ * @return 0 if success or error code
+ * @retval -1 if blackbox_id is not a valid blackbox instance
+ * @retval -2 if the sample does not fit in a chunk
+ * @retval -3 if the blackbox is full or being erased
+ * @retval -4 if the writer fell behind and the sample was dropped
+ */
+int32_t PIOS_BLACKBOX_Write(uintptr_t blackbox_id, uint32_t obj_id, uint16_t obj_inst_id, const uint8_t *obj_data, uint16_t obj_size)
+{
+    int32_t rc;
+    struct blackbox_state *bb = (struct blackbox_state *)blackbox_id;
+
+    if (!PIOS_BLACKBOX_validate(bb)) {
+        return -1;
+    }
+
+    uint16_t record_size = sizeof(struct blackbox_record_header) + obj_size;
+    if (record_size > bb->cfg->chunk_size - sizeof(struct blackbox_chunk_header)) {
+        return -2;
+    }
+
+    if (bb->erasing || bb->write_offset >= bb->cfg->size) {
+        return -3;
+    }
+
+    mutexlock(bb);
+
+    struct blackbox_chunk_header *hdr = (struct blackbox_chunk_header *)bb->buffer[bb->fill_buffer];
+    bool has_records = bb->fill > sizeof(struct blackbox_chunk_header);
+    if (has_records &&
+        (bb->fill + record_size > bb->cfg->chunk_size || hdr->session != bb->session)) {
+        /* Chunk is full or belongs to the previous session */
+        if (bb->pending) {
+            bb->dropped_records++;
+            rc = -4;
+            goto out_unlock;
+        }
+        blackbox_swap_buffers(bb);
+        hdr = (struct blackbox_chunk_header *)bb->buffer[bb->fill_buffer];
+        has_records = false;
+    }
+    if (!has_records) {
+        hdr->session = bb->session;
+    }
+
+    struct blackbox_record_header *record = (struct blackbox_record_header *)(bb->buffer[bb->fill_buffer] + bb->fill);
+    record->timestamp   = PIOS_DELAY_GetuS();
+    record->obj_id      = obj_id;
+    record->obj_inst_id = obj_inst_id;
+    record->obj_size    = obj_size;
+    memcpy((uint8_t *)record + sizeof(*record), obj_data, obj_size);
+    bb->fill += record_size;
+
+    rc = 0;
+
+out_unlock:
+    mutexunlock(bb);
+    return rc;
+}
+
+/**
+ * @brief Ends the current logging session, the records logged so far are handed to the writer
+ * @param[in] blackbox_id The blackbox to use for this action
+ * @return 0 if success or error code
+ * @retval -1 if blackbox_id is not a valid blackbox instance
+ */
+int32_t PIOS_BLACKBOX_NewSession(uintptr_t blackbox_id)
+{
+    struct blackbox_state *bb = (struct blackbox_state *)blackbox_id;
+
+    if (!PIOS_BLACKBOX_validate(bb)) {
+        return -1;
+    }
+
+    mutexlock(bb);
+    if (bb->fill > sizeof(struct blackbox_chunk_header) && !bb->pending) {
+        blackbox_swap_buffers(bb);
+    }
+    /* Anything still buffered gets flushed by the next write, see PIOS_BLACKBOX_Write() */
+    bb->session++;
+    mutexunlock(bb);
+
+    return 0;
+}
+
+/**
+ * @brief Writes a pending chunk to flash or erases the next sector, call from a low priority task
+ * @param[in] blackbox_id The blackbox to use for this action
+ * @return 0 if there is nothing left to do, 1 if more calls are needed, or error code
+ * @retval -1 if blackbox_id is not a valid blackbox instance
+ * @retval -2 if failed to start transaction
+ * @retval -3 if erasing a sector failed
+ * @retval -4 if writing the chunk failed
+ */
+int32_t PIOS_BLACKBOX_Process(uintptr_t blackbox_id)
+{
+    int32_t rc;
+    struct blackbox_state *bb = (struct blackbox_state *)blackbox_id;
+
+    if (!PIOS_BLACKBOX_validate(bb)) {
+        return -1;
+    }
+
+    /*
+     * The flash is accessed without holding the mutex so that logging is not blocked,
+     * work from a snapshot of the state. An erase requested meanwhile bumps the
+     * generation, the outcome of this call is then dropped and the erase starts over.
+     */
+    mutexlock(bb);
+    bool erasing = bb->erasing;
+    bool pending = bb->pending;
+    uint32_t erase_offset = bb->erase_offset;
+    uint32_t write_offset = bb->write_offset;
+    uint32_t generation   = bb->erase_generation;
+    /* The fill buffer cannot change while the other one is pending */
+    uint8_t *chunk = bb->buffer[bb->fill_buffer ^ 1];
+    mutexunlock(bb);
+
+    if (!erasing && !pending) {
+        return 0;
+    }
+
+    if (bb->driver->start_transaction(bb->flash_id) != 0) {
+        return -2;
+    }
+
+    if (erasing) {
+        /* One sector per call, erasing can take longer than a second */
+        if (bb->driver->erase_sector(bb->flash_id, bb->cfg->start_offset + erase_offset) != 0) {
+            rc = -3;
+            goto out_end_trans;
+        }
+        mutexlock(bb);
+        if (bb->erase_generation == generation) {
+            bb->erase_offset = erase_offset + bb->cfg->sector_size;
+            if (bb->erase_offset >= bb->cfg->size) {
+                bb->write_offset = 0;
+                bb->session = 0;
+                bb->erasing = false;
+            }
+        }
+        rc = bb->erasing ? 1 : 0;
+        mutexunlock(bb);
+        goto out_end_trans;
+    }
+
+    bool written = false;
+    if (write_offset < bb->cfg->size) {
+        for (uint16_t page = 0; page < bb->cfg->chunk_size; page += bb->cfg->page_size) {
+            if (bb->driver->write_data(bb->flash_id,
+                                       bb->cfg->start_offset + write_offset + page,
+                                       chunk + page,
+                                       bb->cfg->page_size) != 0) {
+                rc = -4;
+                goto out_end_trans;
+            }
+        }
+        written = true;
+    }
+    /* else the blackbox filled up while this chunk was buffered, drop it */
+
+    mutexlock(bb);
+    if (bb->erase_generation == generation) {
+        if (written) {
+            bb->write_offset = write_offset + bb->cfg->chunk_size;
+        }
+        bb->pending = false;
+    }
+    mutexunlock(bb);
+    rc = 0;
+
+out_end_trans:
+    bb->driver->end_transaction(bb->flash_id);
+    return rc;
+}
+
+/**
+ * @brief Erases the whole blackbox partition, the writer does the work in the background
+ * @param[in] blackbox_id The blackbox to use for this action
+ * @return 0 if success or error code
+ * @retval -1 if blackbox_id is not a valid blackbox instance
+ */
+int32_t PIOS_BLACKBOX_Erase(uintptr_t blackbox_id)
+{
+    struct blackbox_state *bb = (struct blackbox_state *)blackbox_id;
+
+    if (!PIOS_BLACKBOX_validate(bb)) {
+        return -1;
+    }
+
+    mutexlock(bb);
+    /* Anything buffered is part of the log being erased */
+    bb->fill    = sizeof(struct blackbox_chunk_header);
+    bb->pending = false;
+    bb->dropped_records = 0;
+    bb->erase_offset    = 0;
+    bb->erasing = true;
+    bb->erase_generation++;
+    mutexunlock(bb);
+
+    return 0;
+}
+
+/**
+ * @brief Reads back raw log contents
+ * @param[in] blackbox_id The blackbox to use for this action
+ * @param[in] offset Byte offset into the log
+ * @param[out] data Buffer to hold the log contents
+ * @param[in] len Size of the buffer
+ * @return number of bytes read, 0 past the end of the log, or error code
+ * @retval -1 if blackbox_id is not a valid blackbox instance
+ * @retval -2 if failed to start transaction
+ * @retval -3 if reading from flash fails
+ */
+int32_t PIOS_BLACKBOX_Read(uintptr_t blackbox_id, uint32_t offset, uint8_t *data, uint16_t len)
+{
+    struct blackbox_state *bb = (struct blackbox_state *)blackbox_id;
+
+    PIOS_Assert(data);
+
+    if (!PIOS_BLACKBOX_validate(bb)) {
+        return -1;
+    }
+
+    if (bb->erasing || offset >= bb->write_offset) {
+        return 0;
+    }
+    if (len > bb->write_offset - offset) {
+        len = bb->write_offset - offset;
+    }
+
+    if (bb->driver->start_transaction(bb->flash_id) != 0) {
+        return -2;
+    }
+
+    int32_t rc = len;
+    if (bb->driver->read_data(bb->flash_id, bb->cfg->start_offset + offset, data, len) != 0) {
+        rc = -3;
+    }
+
+    bb->driver->end_transaction(bb->flash_id);
+    return rc;
+}
+
+/**
+ * @brief Returns stats for the blackbox
+ * @param[in] blackbox_id The blackbox to use for this action
+ * @return 0 if success or error code
+ * @retval -1 if blackbox_id is not a valid blackbox instance
+ */
+int32_t PIOS_BLACKBOX_GetStats(uintptr_t blackbox_id, struct PIOS_BLACKBOX_Stats *stats)
+{
+    PIOS_Assert(stats);
+    struct blackbox_state *bb = (struct blackbox_state *)blackbox_id;
+
+    if (!PIOS_BLACKBOX_validate(bb)) {
+        return -1;
+    }
+
+    stats->used_bytes = bb->erasing ? 0 : bb->write_offset;
+    stats->free_bytes = bb->erasing ? 0 : bb->cfg->size - bb->write_offset;
+    stats->dropped_records = bb->dropped_records;
+    stats->session = bb->session;
+    return 0;
+}
+
+#endif /* PIOS_INCLUDE_BLACKBOX */
+
+/**
+ * @}
+ * @}
+ */
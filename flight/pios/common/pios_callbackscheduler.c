@@ -36,14 +36,37 @@
 #define STACK_SIZE        (190 + STACK_SAFETYSIZE)
 #define STACK_SAFETYSIZE  8
 #define MAX_SLEEP         1000
+// cpu loads are sampled at most this often, whoever asks for them
+#define LOAD_SAMPLE_MS    1000
+#ifdef DIAG_TASKS
+// timing histogram buckets, bucket n counts durations up to 2^(n+1)-1 us
+#define TIMING_BUCKETS    16
+#define TIMING_AVG_SHIFT  4 // exponential moving average over ~16 runs
+#define TIMING_PERCENTILE 99
+#endif
 
 // Private types
+#ifdef DIAG_TASKS
+/**
+ * timing statistics
+ */
+struct DelayedCallbackTimingStruct {
+    uint16_t histogram[TIMING_BUCKETS];
+    uint16_t min;
+    uint16_t max;
+    uint32_t avg; // fixed point, shifted by TIMING_AVG_SHIFT
+};
+#endif
+
 /**
  * task information
  */
 struct DelayedCallbackTaskStruct {
     DelayedCallbackInfo *callbackQueue[CALLBACK_PRIORITY_LOW + 1];
     DelayedCallbackInfo *queueCursor[CALLBACK_PRIORITY_LOW + 1];
+    uint32_t volatile   readyMask; // one bit per callback priority with possibly waiting callbacks
+    DelayedCallbackInfo *volatile rescheduleList; // callbacks whose scheduletime changed, pushed lock free
+    DelayedCallbackInfo *timerList; // scheduled callbacks ordered by deadline, owned by the scheduler task
     xTaskHandle callbackSchedulerTaskHandle;
     char name[3];
     uint32_t    stackSize;
@@ -58,16 +81,28 @@ struct DelayedCallbackTaskStruct {
 struct DelayedCallbackInfoStruct {
     DelayedCallback   cb;
     int16_t callbackID;
+    DelayedCallbackPriority priority;
     bool volatile     waiting;
     uint32_t volatile scheduletime;
+    uint8_t volatile  rescheduleQueued;
+    uint32_t timerTime; // deadline this callback is sorted by in the timer list, 0 if not in the list
     uint32_t stackSize;
     int32_t  stackFree;
     int32_t  stackNotFree;
     uint16_t stackSafetyCount;
     uint16_t currentSafetyCount;
     uint32_t runCount;
+    uint32_t volatile runTime; // us spent in the callback since the last load sample
+    uint16_t load; // permille of the cpu time during the last sample period
+#ifdef DIAG_TASKS
+    uint32_t volatile dispatchTime;
+    struct DelayedCallbackTimingStruct latency;
+    struct DelayedCallbackTimingStruct execution;
+#endif
     struct DelayedCallbackTaskStruct *task;
     struct DelayedCallbackInfoStruct *next;
+    struct DelayedCallbackInfoStruct *nextTimer;
+    struct DelayedCallbackInfoStruct *nextReschedule;
 };
 
 
@@ -75,10 +110,20 @@ struct DelayedCallbackInfoStruct {
 static struct DelayedCallbackTaskStruct *schedulerTasks;
 static xSemaphoreHandle mutex;
 static bool schedulerStarted;
+static portTickType lastLoadSample;
 
 // Private functions
 static void CallbackSchedulerTask(void *task);
-static int32_t runNextCallback(struct DelayedCallbackTaskStruct *task, DelayedCallbackPriority priority);
+static bool runNextCallback(struct DelayedCallbackTaskStruct *task, DelayedCallbackPriority priority);
+static int32_t updateTimers(struct DelayedCallbackTaskStruct *task);
+static void queueReschedule(DelayedCallbackInfo *cbinfo);
+static void markReady(DelayedCallbackInfo *cbinfo);
+static void sampleLoads();
+#ifdef DIAG_TASKS
+static void timingInit(struct DelayedCallbackTimingStruct *timing);
+static void timingAdd(struct DelayedCallbackTimingStruct *timing, uint32_t us);
+static void timingGet(const struct DelayedCallbackTimingStruct *timing, struct pios_callback_timing *result);
+#endif
 
 /**
  * Initialize the scheduler
@@ -90,6 +135,7 @@ int32_t PIOS_CALLBACKSCHEDULER_Initialize()
     // Initialize variables
     schedulerTasks   = NULL;
     schedulerStarted = false;
+    lastLoadSample   = 0;
 
     // Create mutex
     mutex = xSemaphoreCreateRecursiveMutex();
@@ -160,7 +206,7 @@ int32_t PIOS_CALLBACKSCHEDULER_Schedule(
     int32_t milliseconds,
     DelayedCallbackUpdateMode updatemode)
 {
-    int32_t result = 0;
+    uint32_t old;
 
     PIOS_Assert(cbinfo);
 
@@ -168,33 +214,28 @@ int32_t PIOS_CALLBACKSCHEDULER_Schedule(
         milliseconds = 0; // we can and will not schedule in the past since that ruins the wraparound of uint32_t
     }
 
-    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
-
     uint32_t new = xTaskGetTickCount() + (milliseconds / portTICK_RATE_MS);
     if (!new) {
         new = 1; // zero has a special meaning, schedule at time 1 instead
     }
 
-    int32_t diff = new - cbinfo->scheduletime;
-    if ((!cbinfo->scheduletime)
-        || ((updatemode & CALLBACK_UPDATEMODE_SOONER) && diff < 0)
-        || ((updatemode & CALLBACK_UPDATEMODE_LATER) && diff > 0)
-        ) {
-        // the scheduletime may be updated
-        if (!cbinfo->scheduletime) {
-            result = 1;
-        } else {
-            result = 2;
+    // the scheduler task clears scheduletime when it fires, so update it with compare and swap
+    do {
+        old = cbinfo->scheduletime;
+        int32_t diff = new - old;
+        if (old
+            && !((updatemode & CALLBACK_UPDATEMODE_SOONER) && diff < 0)
+            && !((updatemode & CALLBACK_UPDATEMODE_LATER) && diff > 0)
+            ) {
+            return 0; // previous schedule takes precedence
         }
-        cbinfo->scheduletime = new;
+    } while (!__sync_bool_compare_and_swap(&cbinfo->scheduletime, old, new));
 
-        // scheduler needs to be notified to adapt sleep times
-        xSemaphoreGive(cbinfo->task->signal);
-    }
-
-    xSemaphoreGiveRecursive(mutex);
+    // scheduler needs to be notified to re-sort its timers and adapt sleep times
+    queueReschedule(cbinfo);
+    xSemaphoreGive(cbinfo->task->signal);
 
-    return result;
+    return old ? 2 : 1;
 }
 
 /**
@@ -208,7 +249,7 @@ int32_t PIOS_CALLBACKSCHEDULER_Dispatch(DelayedCallbackInfo *cbinfo)
     PIOS_Assert(cbinfo);
 
     // no semaphore needed for the callback
-    cbinfo->waiting = true;
+    markReady(cbinfo);
     // but the scheduler as a whole needs to be notified
     return xSemaphoreGive(cbinfo->task->signal);
 }
@@ -232,7 +273,7 @@ int32_t PIOS_CALLBACKSCHEDULER_DispatchFromISR(DelayedCallbackInfo *cbinfo, long
     PIOS_Assert(cbinfo);
 
     // no semaphore needed for the callback
-    cbinfo->waiting = true;
+    markReady(cbinfo);
     // but the scheduler as a whole needs to be notified
     return xSemaphoreGiveFromISR(cbinfo->task->signal, pxHigherPriorityTaskWoken);
 }
@@ -273,7 +314,7 @@ DelayedCallbackInfo *PIOS_CALLBACKSCHEDULER_Create(
     // if given priorityTask does not exist, create it
     if (!task) {
         // allocate memory if possible
-        task = (struct DelayedCallbackTaskStruct *)pios_malloc(sizeof(struct DelayedCallbackTaskStruct));
+        task = (struct DelayedCallbackTaskStruct *)pios_fastheapmalloc(sizeof(struct DelayedCallbackTaskStruct));
         if (!task) {
             xSemaphoreGiveRecursive(mutex);
             return NULL;
@@ -284,6 +325,9 @@ DelayedCallbackInfo *PIOS_CALLBACKSCHEDULER_Create(
             task->callbackQueue[p] = NULL;
             task->queueCursor[p]   = NULL;
         }
+        task->readyMask      = 0;
+        task->rescheduleList = NULL;
+        task->timerList      = NULL;
         task->name[0]      = 'C';
         task->name[1]      = 'a' + t;
         task->name[2]      = 0;
@@ -329,23 +373,35 @@ DelayedCallbackInfo *PIOS_CALLBACKSCHEDULER_Create(
     }
 
     // initialize callback scheduling info
-    DelayedCallbackInfo *info = (DelayedCallbackInfo *)pios_malloc(sizeof(DelayedCallbackInfo));
+    DelayedCallbackInfo *info = (DelayedCallbackInfo *)pios_fastheapmalloc(sizeof(DelayedCallbackInfo));
     if (!info) {
         xSemaphoreGiveRecursive(mutex);
         return NULL; // error - not enough memory
     }
     info->next               = NULL;
+    info->nextTimer          = NULL;
+    info->nextReschedule     = NULL;
+    info->priority           = priority;
     info->waiting            = false;
     info->scheduletime       = 0;
+    info->rescheduleQueued   = 0;
+    info->timerTime          = 0;
     info->task               = task;
     info->cb = cb;
     info->callbackID         = callbackID;
     info->runCount           = 0;
+    info->runTime            = 0;
+    info->load               = 0;
     info->stackSize          = stacksize - STACK_SIZE;
     info->stackNotFree       = info->stackSize;
     info->stackFree          = 0;
     info->stackSafetyCount   = STACK_SAFETYCOUNT;
     info->currentSafetyCount = 0;
+#ifdef DIAG_TASKS
+    info->dispatchTime       = 0;
+    timingInit(&info->latency);
+    timingInit(&info->execution);
+#endif
 
     // add to scheduling queue
     LL_APPEND(task->callbackQueue[priority], info);
@@ -369,6 +425,8 @@ void PIOS_CALLBACKSCHEDULER_ForEachCallback(CallbackSchedulerCallbackInfoCallbac
 
     struct pios_callback_info info;
 
+    sampleLoads();
+
     struct DelayedCallbackTaskStruct *task = NULL;
     LL_FOREACH(schedulerTasks, task) {
         int prio;
@@ -379,7 +437,15 @@ void PIOS_CALLBACKSCHEDULER_ForEachCallback(CallbackSchedulerCallbackInfoCallbac
                 xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
                 info.is_running = true;
                 info.stack_remaining    = cbinfo->stackNotFree;
-                info.running_time_count = cbinfo->runCount;
+                info.running_time_count   = cbinfo->runCount;
+                info.running_time_permille = cbinfo->load;
+#ifdef DIAG_TASKS
+                timingGet(&cbinfo->latency, &info.latency);
+                timingGet(&cbinfo->execution, &info.execution);
+#else
+                memset(&info.latency, 0, sizeof(info.latency));
+                memset(&info.execution, 0, sizeof(info.execution));
+#endif
                 xSemaphoreGiveRecursive(mutex);
                 callback(cbinfo->callbackID, &info, context);
             }
@@ -387,6 +453,39 @@ void PIOS_CALLBACKSCHEDULER_ForEachCallback(CallbackSchedulerCallbackInfoCallbac
     }
 }
 
+/**
+ * Turn the time spent in each callback since the last sample into a cpu load,
+ * unless the loads were sampled less than LOAD_SAMPLE_MS ago, so that callers
+ * asking at different rates all get the loads of the same period.
+ */
+static void sampleLoads()
+{
+    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+
+    portTickType now = xTaskGetTickCount();
+    uint32_t elapsed = (now - lastLoadSample) * portTICK_RATE_MS;
+
+    if (elapsed >= LOAD_SAMPLE_MS) {
+        lastLoadSample = now;
+
+        struct DelayedCallbackTaskStruct *task = NULL;
+        LL_FOREACH(schedulerTasks, task) {
+            int prio;
+
+            for (prio = 0; prio < (CALLBACK_PRIORITY_LOW + 1); prio++) {
+                struct DelayedCallbackInfoStruct *cbinfo;
+                LL_FOREACH(task->callbackQueue[prio], cbinfo) {
+                    // us per ms is permille
+                    uint32_t load = __sync_fetch_and_and(&cbinfo->runTime, 0) / elapsed;
+                    cbinfo->load = load < 1000 ? load : 1000;
+                }
+            }
+        }
+    }
+
+    xSemaphoreGiveRecursive(mutex);
+}
+
 /**
  * Stack magic, find how much stack is being used without affecting performance
  */
@@ -457,27 +556,233 @@ static void checkStack(DelayedCallbackInfo *current)
     }
 }
 
+#ifdef DIAG_TASKS
+/**
+ * Reset timing statistics
+ * \param[in] timing The statistics to reset
+ */
+static void timingInit(struct DelayedCallbackTimingStruct *timing)
+{
+    memset(timing, 0, sizeof(struct DelayedCallbackTimingStruct));
+    timing->min = 0xffff;
+}
+
+/**
+ * Add a sample to timing statistics, run from the scheduler task only
+ * \param[in] timing The statistics to update
+ * \param[in] us The measured duration in microseconds
+ */
+static void timingAdd(struct DelayedCallbackTimingStruct *timing, uint32_t us)
+{
+    uint8_t bucket = 0;
+
+    if (us > 0xffff) {
+        us = 0xffff;
+    }
+    while (bucket < TIMING_BUCKETS - 1 && (us >> (bucket + 1))) {
+        bucket++;
+    }
+    if (timing->histogram[bucket] == 0xffff) {
+        // halve all counts to make room, this keeps the distribution but ages old samples
+        for (uint8_t t = 0; t < TIMING_BUCKETS; t++) {
+            timing->histogram[t] >>= 1;
+        }
+    }
+    timing->histogram[bucket]++;
+
+    if (us < timing->min) {
+        timing->min = us;
+    }
+    if (us > timing->max) {
+        timing->max = us;
+    }
+    if (timing->avg == 0) {
+        timing->avg = us << TIMING_AVG_SHIFT;
+    } else {
+        timing->avg = timing->avg - (timing->avg >> TIMING_AVG_SHIFT) + us;
+    }
+}
+
+/**
+ * Compute reportable values from timing statistics
+ * \param[in] timing The statistics
+ * \param[out] result min, average, max and percentile upper bound
+ */
+static void timingGet(const struct DelayedCallbackTimingStruct *timing, struct pios_callback_timing *result)
+{
+    uint32_t total = 0;
+    uint32_t count = 0;
+    uint8_t bucket;
+
+    for (bucket = 0; bucket < TIMING_BUCKETS; bucket++) {
+        total += timing->histogram[bucket];
+    }
+    if (!total) {
+        memset(result, 0, sizeof(struct pios_callback_timing));
+        return;
+    }
+    for (bucket = 0; bucket < TIMING_BUCKETS - 1; bucket++) {
+        count += timing->histogram[bucket];
+        if (count * 100 >= total * TIMING_PERCENTILE) {
+            break;
+        }
+    }
+    result->min = timing->min;
+    result->avg = timing->avg >> TIMING_AVG_SHIFT;
+    result->max = timing->max;
+    result->p99 = (2 << bucket) - 1;
+    if (result->p99 > result->max) {
+        result->p99 = result->max;
+    }
+}
+#endif /* DIAG_TASKS */
+
+/**
+ * Mark a callback as waiting for execution. Lock free, safe to call from ISR.
+ * \param[in] cbinfo the callback handle
+ */
+static void markReady(DelayedCallbackInfo *cbinfo)
+{
+#ifdef DIAG_TASKS
+    if (!cbinfo->waiting) {
+        // latency is measured from the first dispatch that has not been served yet
+        cbinfo->dispatchTime = PIOS_DELAY_GetRaw();
+    }
+#endif
+    cbinfo->waiting = true;
+    __sync_fetch_and_or(&cbinfo->task->readyMask, 1 << cbinfo->priority);
+}
+
+/**
+ * Hand a callback with a changed scheduletime over to its scheduler task.
+ * Lock free, the callback is pushed at most once until the scheduler has processed it.
+ * \param[in] cbinfo the callback handle
+ */
+static void queueReschedule(DelayedCallbackInfo *cbinfo)
+{
+    struct DelayedCallbackTaskStruct *task = cbinfo->task;
+    DelayedCallbackInfo *head;
+
+    if (!__sync_bool_compare_and_swap(&cbinfo->rescheduleQueued, 0, 1)) {
+        return; // already queued, the scheduler will pick up the latest scheduletime
+    }
+    do {
+        head = task->rescheduleList;
+        cbinfo->nextReschedule = head;
+    } while (!__sync_bool_compare_and_swap(&task->rescheduleList, head, cbinfo));
+}
+
+/**
+ * Remove a callback from the timer list of its scheduler task
+ * \param[in] task The scheduler task
+ * \param[in] cbinfo the callback handle
+ */
+static void removeTimer(struct DelayedCallbackTaskStruct *task, DelayedCallbackInfo *cbinfo)
+{
+    DelayedCallbackInfo **cursor = &task->timerList;
+
+    if (!cbinfo->timerTime) {
+        return; // not in the list
+    }
+    while (*cursor) {
+        if (*cursor == cbinfo) {
+            *cursor = cbinfo->nextTimer;
+            break;
+        }
+        cursor = &(*cursor)->nextTimer;
+    }
+    cbinfo->nextTimer = NULL;
+    cbinfo->timerTime = 0;
+}
+
+/**
+ * Insert a callback in the timer list of its scheduler task, ordered by deadline
+ * \param[in] task The scheduler task
+ * \param[in] cbinfo the callback handle
+ * \param[in] time The deadline, 0 if not scheduled
+ */
+static void insertTimer(struct DelayedCallbackTaskStruct *task, DelayedCallbackInfo *cbinfo, uint32_t time)
+{
+    DelayedCallbackInfo **cursor = &task->timerList;
+
+    if (!time) {
+        return;
+    }
+    // wraparound safe ordering, callbacks with equal deadlines keep their scheduling order
+    while (*cursor && (int32_t)((*cursor)->timerTime - time) <= 0) {
+        cursor = &(*cursor)->nextTimer;
+    }
+    cbinfo->timerTime = time;
+    cbinfo->nextTimer = *cursor;
+    *cursor = cbinfo;
+}
+
+/**
+ * Scheduler subtask, sorts rescheduled callbacks into the timer list and marks
+ * all callbacks whose deadline has passed ready for execution.
+ * Only ever called from the scheduler task itself, so no locking is needed.
+ * \param[in] task The scheduler task in question
+ * \return wait time until next scheduled callback is due
+ */
+static int32_t updateTimers(struct DelayedCallbackTaskStruct *task)
+{
+    DelayedCallbackInfo *cbinfo = __sync_lock_test_and_set(&task->rescheduleList, NULL);
+    DelayedCallbackInfo *next;
+    uint32_t time;
+    int32_t diff;
+
+    while (cbinfo) {
+        next = cbinfo->nextReschedule;
+        // allow the callback to be queued again before reading the latest scheduletime
+        __sync_lock_release(&cbinfo->rescheduleQueued);
+        __sync_synchronize();
+        removeTimer(task, cbinfo);
+        insertTimer(task, cbinfo, cbinfo->scheduletime);
+        cbinfo = next;
+    }
+
+    while (task->timerList) {
+        cbinfo = task->timerList;
+        time   = cbinfo->timerTime;
+        diff   = time - xTaskGetTickCount();
+        if (diff > 0) {
+            return (diff < MAX_SLEEP) ? diff : MAX_SLEEP;
+        }
+        task->timerList   = cbinfo->nextTimer;
+        cbinfo->nextTimer = NULL;
+        cbinfo->timerTime = 0;
+        // if the schedule has been changed or cleared meanwhile it is not due,
+        // a changed schedule is queued and will be sorted in on the next update
+        if (__sync_bool_compare_and_swap(&cbinfo->scheduletime, time, 0)) {
+            markReady(cbinfo);
+        }
+    }
+    return MAX_SLEEP;
+}
+
 /**
  * Scheduler subtask
  * \param[in] task The scheduler task in question
  * \param[in] priority The scheduling priority of the callback to search for
- * \return wait time until next scheduled callback is due - 0 if a callback has just been executed
+ * \return true if a callback has just been executed
  */
-static int32_t runNextCallback(struct DelayedCallbackTaskStruct *task, DelayedCallbackPriority priority)
+static bool runNextCallback(struct DelayedCallbackTaskStruct *task, DelayedCallbackPriority priority)
 {
-    int32_t result = MAX_SLEEP;
-    int32_t diff   = 0;
+    uint32_t readyBit = 1 << priority;
 
     // no such queue
     if (priority > CALLBACK_PRIORITY_LOW) {
-        return result;
+        return false;
     }
 
-    // queue is empty, search a lower priority queue
-    if (task->callbackQueue[priority] == NULL) {
+    // nothing dispatched on this priority, search a lower priority queue
+    if (!(task->readyMask & readyBit)) {
         return runNextCallback(task, priority + 1);
     }
 
+    // clear the ready bit before searching, so a dispatch that happens during the search is not lost
+    __sync_fetch_and_and(&task->readyMask, ~readyBit);
+
     DelayedCallbackInfo *current = task->queueCursor[priority];
     DelayedCallbackInfo *next;
     do {
@@ -485,30 +790,28 @@ static int32_t runNextCallback(struct DelayedCallbackTaskStruct *task, DelayedCa
             next = task->callbackQueue[priority]; // loop around the end of the list
             // also attempt to run a callback that has lower priority
             // every time the queue is completely traversed
-            diff = runNextCallback(task, priority + 1);
-            if (!diff) {
+            if (runNextCallback(task, priority + 1)) {
                 task->queueCursor[priority] = next; // the recursive call has executed a callback
-                return 0;
-            }
-            if (diff < result) {
-                result = diff; // adjust sleep time
+                __sync_fetch_and_or(&task->readyMask, readyBit); // this queue has not been searched completely
+                return true;
             }
         } else {
             next = current->next;
-            xSemaphoreTakeRecursive(mutex, portMAX_DELAY); // access to scheduletime should be mutex protected
-            if (current->scheduletime) {
-                diff = current->scheduletime - xTaskGetTickCount();
-                if (diff <= 0) {
-                    current->waiting = true;
-                } else if (diff < result) {
-                    result = diff; // adjust sleep time
-                }
-            }
             if (current->waiting) {
                 task->queueCursor[priority] = next;
-                current->scheduletime = 0; // any schedules are reset
+                // more callbacks of this priority might be waiting
+                __sync_fetch_and_or(&task->readyMask, readyBit);
+                // any schedules are reset, a stale timer entry is dropped when it expires
+                uint32_t time = current->scheduletime;
+                if (time) {
+                    __sync_bool_compare_and_swap(&current->scheduletime, time, 0);
+                }
                 current->waiting = false; // the flag is reset just before execution.
-                xSemaphoreGiveRecursive(mutex);
+
+#ifdef DIAG_TASKS
+                timingAdd(&current->latency, PIOS_DELAY_DiffuS(current->dispatchTime));
+#endif
+                uint32_t startTime = PIOS_DELAY_GetRaw();
 
                 /* callback gets invoked here - check stack sizes */
                 markStack(current);
@@ -517,16 +820,22 @@ static int32_t runNextCallback(struct DelayedCallbackTaskStruct *task, DelayedCa
 
                 checkStack(current);
 
+                uint32_t duration = PIOS_DELAY_DiffuS(startTime);
+                // the system task reads and resets the accumulated time concurrently
+                __sync_fetch_and_add(&current->runTime, duration);
+#ifdef DIAG_TASKS
+                timingAdd(&current->execution, duration);
+#endif
+
                 current->runCount++;
 
-                return 0;
+                return true;
             }
-            xSemaphoreGiveRecursive(mutex);
         }
         current = next;
     } while (current != task->queueCursor[priority]);
     // once the list has been traversed entirely without finding any to be executed task, abort (nothing to do)
-    return result;
+    return false;
 }
 
 /**
@@ -538,8 +847,8 @@ static void CallbackSchedulerTask(void *task)
     uint32_t delay = 0;
 
     while (1) {
-        delay = runNextCallback((struct DelayedCallbackTaskStruct *)task, CALLBACK_PRIORITY_CRITICAL);
-        if (delay) {
+        delay = updateTimers((struct DelayedCallbackTaskStruct *)task);
+        if (!runNextCallback((struct DelayedCallbackTaskStruct *)task, CALLBACK_PRIORITY_CRITICAL)) {
             // nothing to do but sleep
             xSemaphoreTake(((struct DelayedCallbackTaskStruct *)task)->signal, delay);
         }
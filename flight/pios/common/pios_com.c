@@ -427,6 +427,85 @@ int32_t PIOS_COM_SendBuffer(uint32_t com_id, const uint8_t *buffer, uint16_t len
     return len;
 }
 
+/**
+ * Reserve room for a packet directly in the transmit buffer, so the caller
+ * can build it in place instead of copying it in with PIOS_COM_SendBuffer().
+ * Waits for the transmitter like PIOS_COM_SendBuffer() does. On success the
+ * port stays locked for other senders until PIOS_COM_SendBufferCommit().
+ * \param[in] com_id COM port
+ * \param[in] len number of bytes to reserve
+ * \return pointer to len contiguous bytes
+ * \return NULL if the port is unavailable or the space would wrap around the
+ *         end of the buffer, the caller should fall back to PIOS_COM_SendBuffer()
+ */
+uint8_t *PIOS_COM_SendBufferReserve(uint32_t com_id, uint16_t len)
+{
+    struct pios_com_dev *com_dev = (struct pios_com_dev *)com_id;
+
+    if (!PIOS_COM_validate(com_dev) || !com_dev->has_tx) {
+        return NULL;
+    }
+    if (len == 0 || len > fifoBuf_getSize(&com_dev->tx)) {
+        return NULL;
+    }
+    if (com_dev->driver->available && !com_dev->driver->available(com_dev->lower_id)) {
+        return NULL;
+    }
+#if defined(PIOS_INCLUDE_FREERTOS)
+    if (xSemaphoreTake(com_dev->sendbuffer_sem, 5) != pdTRUE) {
+        return NULL;
+    }
+#endif /* PIOS_INCLUDE_FREERTOS */
+    while (fifoBuf_getFree(&com_dev->tx) < len) {
+        /* Make sure the transmitter is running while we wait */
+        if (com_dev->driver->tx_start) {
+            (com_dev->driver->tx_start)(com_dev->lower_id,
+                                        fifoBuf_getUsed(&com_dev->tx));
+        }
+#if defined(PIOS_INCLUDE_FREERTOS)
+        if (xSemaphoreTake(com_dev->tx_sem, 5000) != pdTRUE) {
+            xSemaphoreGive(com_dev->sendbuffer_sem);
+            return NULL;
+        }
+#endif
+    }
+
+    uint16_t contiguous;
+    uint8_t *ptr = fifoBuf_getWritePtr(&com_dev->tx, &contiguous);
+    if (contiguous < len) {
+#if defined(PIOS_INCLUDE_FREERTOS)
+        xSemaphoreGive(com_dev->sendbuffer_sem);
+#endif /* PIOS_INCLUDE_FREERTOS */
+        return NULL;
+    }
+    return ptr;
+}
+
+/**
+ * Queue the bytes written into a reservation and unlock the port.
+ * \param[in] com_id COM port
+ * \param[in] len number of bytes written, 0 drops the reservation
+ * \return number of bytes queued
+ */
+int32_t PIOS_COM_SendBufferCommit(uint32_t com_id, uint16_t len)
+{
+    struct pios_com_dev *com_dev = (struct pios_com_dev *)com_id;
+
+    PIOS_Assert(PIOS_COM_validate(com_dev));
+
+    if (len > 0) {
+        fifoBuf_commitData(&com_dev->tx, len);
+        if (com_dev->driver->tx_start) {
+            com_dev->driver->tx_start(com_dev->lower_id,
+                                      fifoBuf_getUsed(&com_dev->tx));
+        }
+    }
+#if defined(PIOS_INCLUDE_FREERTOS)
+    xSemaphoreGive(com_dev->sendbuffer_sem);
+#endif /* PIOS_INCLUDE_FREERTOS */
+    return len;
+}
+
 /**
  * Sends a single character over given port
  * \param[in] port COM port
@@ -570,6 +649,108 @@ check_again:
     return bytes_from_fifo;
 }
 
+static uint16_t PIOS_COM_ForwardToTx(struct pios_com_dev *src_dev, struct pios_com_dev *dst_dev, uint16_t max_len)
+{
+#if defined(PIOS_INCLUDE_FREERTOS)
+    if (xSemaphoreTake(dst_dev->sendbuffer_sem, 5) != pdTRUE) {
+        return 0;
+    }
+#endif /* PIOS_INCLUDE_FREERTOS */
+
+    uint16_t moved = 0;
+    while (moved == 0) {
+        uint16_t room;
+        uint8_t *ptr = fifoBuf_getWritePtr(&dst_dev->tx, &room);
+        if (room == 0) {
+            /* Transmit buffer full, wait for the transmitter to drain it */
+            if (dst_dev->driver->tx_start) {
+                (dst_dev->driver->tx_start)(dst_dev->lower_id,
+                                            fifoBuf_getUsed(&dst_dev->tx));
+            }
+#if defined(PIOS_INCLUDE_FREERTOS)
+            if (xSemaphoreTake(dst_dev->tx_sem, 5000) != pdTRUE) {
+                break;
+            }
+#endif
+            continue;
+        }
+        /* Fill up to the end of the transmit buffer, the rest goes on the next call */
+        moved = fifoBuf_getData(&src_dev->rx, ptr, MIN(room, max_len));
+        fifoBuf_commitData(&dst_dev->tx, moved);
+    }
+
+    if (moved > 0 && dst_dev->driver->tx_start) {
+        (dst_dev->driver->tx_start)(dst_dev->lower_id,
+                                    fifoBuf_getUsed(&dst_dev->tx));
+    }
+#if defined(PIOS_INCLUDE_FREERTOS)
+    xSemaphoreGive(dst_dev->sendbuffer_sem);
+#endif /* PIOS_INCLUDE_FREERTOS */
+    return moved;
+}
+
+/**
+ * Move received bytes from one port straight into the transmit buffer of
+ * another, without going through a copy buffer. Only as many bytes as fit
+ * are taken, so a slow destination throttles the source through its
+ * receive buffer instead of losing data.
+ * \param[in] src_id COM port to receive from
+ * \param[in] dst_id COM port to transmit on
+ * \param[in] max_len most bytes to move in one call
+ * \param[in] timeout_ms time to wait for received bytes
+ * \return number of bytes moved, bytes dropped because the destination
+ *         is unavailable are not counted
+ */
+uint16_t PIOS_COM_ForwardBuffer(uint32_t src_id, uint32_t dst_id, uint16_t max_len, uint32_t timeout_ms)
+{
+    struct pios_com_dev *src_dev = (struct pios_com_dev *)src_id;
+    struct pios_com_dev *dst_dev = (struct pios_com_dev *)dst_id;
+
+    PIOS_Assert(max_len);
+    if (!PIOS_COM_validate(src_dev)) {
+        /* Undefined COM port for this board (see pios_board.c) */
+        PIOS_Assert(0);
+    }
+    PIOS_Assert(src_dev->has_rx);
+
+    while (fifoBuf_getUsed(&src_dev->rx) == 0) {
+        /* Make sure the receiver is running while we wait */
+        if (src_dev->driver->rx_start) {
+            (src_dev->driver->rx_start)(src_dev->lower_id,
+                                        fifoBuf_getFree(&src_dev->rx));
+        }
+        if (timeout_ms == 0) {
+            return 0;
+        }
+#if defined(PIOS_INCLUDE_FREERTOS)
+        if (xSemaphoreTake(src_dev->rx_sem, timeout_ms / portTICK_RATE_MS) != pdTRUE) {
+            return 0;
+        }
+        timeout_ms = 0;
+#else
+        PIOS_DELAY_WaitmS(1);
+        timeout_ms--;
+#endif
+    }
+
+    uint16_t moved = 0;
+    if (!PIOS_COM_validate(dst_dev) || !dst_dev->has_tx ||
+        (dst_dev->driver->available && !dst_dev->driver->available(dst_dev->lower_id))) {
+        /* Nobody to forward to, drop the bytes like PIOS_COM_SendBuffer() would */
+        fifoBuf_removeData(&src_dev->rx, max_len);
+    } else {
+        moved = PIOS_COM_ForwardToTx(src_dev, dst_dev, max_len);
+    }
+
+    /* Notify the lower layer that there is now room in the rx buffer */
+    if (src_dev->driver->rx_start) {
+        (src_dev->driver->rx_start)(src_dev->lower_id,
+                                    fifoBuf_getFree(&src_dev->rx));
+    }
+
+    return moved;
+}
+
 /**
  * Query if a com port is available for use.  That can be
  * used to check a link is established even if the device
@@ -592,6 +773,23 @@ bool PIOS_COM_Available(uint32_t com_id)
     return (com_dev->driver->available)(com_dev->lower_id);
 }
 
+/**
+ * Query the free space of the transmit buffer of a com port, so that callers
+ * can shed low priority data before the buffer is full.
+ * \param[in] com_id COM port
+ * \return number of bytes that can be queued, 0 if the port is not valid
+ */
+uint16_t PIOS_COM_GetTxFree(uint32_t com_id)
+{
+    struct pios_com_dev *com_dev = (struct pios_com_dev *)com_id;
+
+    if (!PIOS_COM_validate(com_dev) || !com_dev->has_tx) {
+        return 0;
+    }
+
+    return fifoBuf_getFree(&com_dev->tx);
+}
+
 #endif /* PIOS_INCLUDE_COM */
 
 /**
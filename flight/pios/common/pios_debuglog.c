@@ -38,6 +38,10 @@
 
 // Global variables
 extern uintptr_t pios_user_fs_id; // flash filesystem for logging
+#if defined(PIOS_INCLUDE_BLACKBOX)
+extern uintptr_t pios_blackbox_id; // raw flash partition for high rate samples
+static bool blackbox_enabled = false;
+#endif
 
 #if defined(PIOS_INCLUDE_FREERTOS)
 static xSemaphoreHandle mutex = 0;
@@ -66,8 +70,68 @@ static DebugLogEntryData staticbuffer;
 
 static uint32_t used_buffer_space = 0;
 
+/*
+ * Compact entries hold a sequence of records, each one an object sample coded as
+ * the zig-zag varint delta of every field against the previous sample of the same
+ * object instance:
+ *   varint   slot << 1 | keyframe
+ *   varint   microseconds since the previous record, or since FlightTime for the first one
+ *   keyframe only: uint32 objid, varint instid, varint size, varint words, varint halfwords
+ *   varint   zig-zag delta for every 32, 16 then 8 bit field, against zero for keyframes
+ * Objects are bound to a slot by their keyframe, which is repeated every
+ * LOG_COMPACT_KEYFRAME_INTERVAL samples and at the start of each flight.
+ */
+#define LOG_COMPACT_MAX_OBJECTS       16
+#define LOG_COMPACT_UNTRACKED_SLOT    0x3F
+#define LOG_COMPACT_KEYFRAME_INTERVAL 32
+// worst case: record header, keyframe description and one extra byte per field byte
+#define LOG_COMPACT_HEADER_MAX        (5 + 5)
+#define LOG_COMPACT_RECORD_MAX(size)  (LOG_COMPACT_HEADER_MAX + 4 + 3 + 3 + 3 + 3 + 2 * (size))
+
+struct log_compact_object {
+    uint32_t objid;
+    uint16_t instid;
+    uint16_t size; // zero for a free slot
+    uint16_t num_words;
+    uint16_t num_halfwords;
+    uint8_t  samples; // since the last keyframe
+    uint8_t  *previous;
+};
+
+static struct log_compact_object *compact_objects = 0;
+#if !defined(PIOS_INCLUDE_FREERTOS)
+static struct log_compact_object staticcompactobjects[LOG_COMPACT_MAX_OBJECTS];
+#endif
+static uint8_t *compact_record = 0; // record being coded, before it is known to fit the block
+#if !defined(PIOS_INCLUDE_FREERTOS)
+static uint8_t staticcompactrecord[LOG_ENTRY_MAX_DATA_SIZE];
+#endif
+static uint32_t compact_last_time = 0;
+
+/*
+ * Message entries hold a sequence of deferred format debug messages, each one coded as:
+ *   varint   offset of the format string in the debuglog_fmt section
+ *   varint   microseconds since the previous record, or since FlightTime for the first one
+ *   varint   size of the arguments
+ *   then one value per conversion of the format string, '*' widths and precisions included:
+ *     d i              zig-zag varint
+ *     u o x X c p      varint
+ *     e f g a          float, 4 bytes little endian
+ *     s                varint length followed by at most LOG_MESSAGE_STRING_MAX characters
+ * 64 bit integers are truncated to 32 bits. The format strings are only in flash,
+ * the GCS expands the messages with the debuglog_fmt section extracted from the elf.
+ */
+#define LOG_MESSAGE_STRING_MAX  32
+#define LOG_MESSAGE_HEADER_MAX  (5 + 5 + 5)
+// worst case: '*' width and precision, then a string
+#define LOG_MESSAGE_ARG_MAX     (5 + 5 + 5 + LOG_MESSAGE_STRING_MAX)
+extern const char __start_debuglog_fmt[];
+
 /* Private Function Prototypes */
 static void enqueue_data(uint32_t objid, uint16_t instid, size_t size, uint8_t *data);
+static bool enqueue_compact(uint32_t objid, uint16_t instid, size_t size, uint16_t num_words, uint16_t num_halfwords, const uint8_t *data);
+static void enqueue_message(const char *format, va_list args);
+static void reset_compact();
 static bool write_current_buffer();
 /**
  * @brief Initialize the log facility
@@ -78,14 +142,22 @@ void PIOS_DEBUGLOG_Initialize()
     if (!mutex) {
         mutex  = xSemaphoreCreateRecursiveMutex();
         buffer = pios_malloc(sizeof(DebugLogEntryData));
+        compact_objects = pios_malloc(sizeof(struct log_compact_object) * LOG_COMPACT_MAX_OBJECTS);
+        if (compact_objects) {
+            memset(compact_objects, 0, sizeof(struct log_compact_object) * LOG_COMPACT_MAX_OBJECTS);
+        }
+        compact_record  = pios_malloc(LOG_ENTRY_MAX_DATA_SIZE);
     }
 #else
     buffer = &staticbuffer;
+    compact_objects = staticcompactobjects;
+    compact_record  = staticcompactrecord;
 #endif
     if (!buffer) {
         return;
     }
     mutexlock();
+    reset_compact();
     lognum      = 0;
     flightnum   = 0;
     fails_count = 0;
@@ -106,28 +178,62 @@ void PIOS_DEBUGLOG_Enable(uint8_t enabled)
 {
     // increase the flight num as soon as logging is disabled
     if (logging_enabled && !enabled) {
+        mutexlock();
+        // the pending block belongs to the flight that just ended
+        if (buffer && used_buffer_space) {
+            write_current_buffer();
+        }
         flightnum++;
         lognum = 0;
+        reset_compact();
+        mutexunlock();
+#if defined(PIOS_INCLUDE_BLACKBOX)
+        if (pios_blackbox_id) {
+            PIOS_BLACKBOX_NewSession(pios_blackbox_id);
+        }
+#endif
     }
     logging_enabled = enabled;
 }
 
+/**
+ * @brief Sends UAVObject entries to the blackbox instead of the log filesystem
+ * @param[in] enable or disable the blackbox, ignored on boards without one
+ */
+void PIOS_DEBUGLOG_EnableBlackbox(__attribute__((unused)) uint8_t enabled)
+{
+#if defined(PIOS_INCLUDE_BLACKBOX)
+    blackbox_enabled = enabled;
+#endif
+}
+
 /**
  * @brief Write a debug log entry with a uavobject
  * @param[in] objectid
  * @param[in] instanceid
- * @param[in] instanceid
  * @param[in] size of object
+ * @param[in] number of 32 bit fields, stored first
+ * @param[in] number of 16 bit fields, stored after the 32 bit ones
  * @param[in] data buffer
  */
-void PIOS_DEBUGLOG_UAVObject(uint32_t objid, uint16_t instid, size_t size, uint8_t *data)
+void PIOS_DEBUGLOG_UAVObject(uint32_t objid, uint16_t instid, size_t size, uint16_t num_words, uint16_t num_halfwords, uint8_t *data)
 {
+#if defined(PIOS_INCLUDE_BLACKBOX)
+    if (logging_enabled && blackbox_enabled && pios_blackbox_id) {
+        // buffered in RAM and streamed to flash by the writer, no filesystem access here
+        PIOS_BLACKBOX_Write(pios_blackbox_id, objid, instid, data, size);
+        return;
+    }
+#endif
     if (!logging_enabled || !buffer || log_is_full) {
         return;
     }
     mutexlock();
 
-    enqueue_data(objid, instid, size, data);
+    // objects too large to be delta coded fall back to the plain format
+    if (!enqueue_compact(objid, instid, size, num_words, num_halfwords, data)) {
+        enqueue_data(objid, instid, size, data);
+    }
 
     mutexunlock();
 }
@@ -168,6 +274,68 @@ void PIOS_DEBUGLOG_Printf(char *format, ...)
     mutexunlock();
 }
 
+/**
+ * @brief Write a debug log entry with a message in the deferred format, use PIOS_DEBUGLOG_MESSAGE()
+ * @param[in] format string in the debuglog_fmt section
+ * @param[in] variable arguments for printf
+ */
+void PIOS_DEBUGLOG_Message(const char *format, ...)
+{
+    if (!logging_enabled || !buffer || !compact_record || log_is_full) {
+        return;
+    }
+
+    va_list args;
+    va_start(args, format);
+    mutexlock();
+    enqueue_message(format, args);
+    mutexunlock();
+    va_end(args);
+}
+
+/**
+ * @brief Write a debug log entry with a block of instrumentation trace events
+ * Trace entries are written whenever the log has room, even if logging is disabled
+ * @param[in] size of the trace data, truncated to the maximum entry size
+ * @param[in] data buffer
+ * @return true if the entry was written
+ */
+bool PIOS_DEBUGLOG_Trace(size_t size, uint8_t *data)
+{
+    bool written = false;
+
+    if (!buffer || log_is_full) {
+        return false;
+    }
+
+    mutexlock();
+    // flush any pending buffer before writing the trace block
+    if (used_buffer_space) {
+        write_current_buffer();
+    }
+    if (size > sizeof(buffer->Data)) {
+        size = sizeof(buffer->Data);
+    }
+    memset(buffer->Data, 0xff, sizeof(buffer->Data));
+    memcpy(buffer->Data, data, size);
+    buffer->Flight     = flightnum;
+
+    buffer->FlightTime = PIOS_DELAY_GetuS();
+
+    buffer->Entry      = lognum;
+    buffer->Type       = DEBUGLOGENTRY_TYPE_TRACE;
+    buffer->ObjectID   = 0;
+    buffer->InstanceID = 0;
+    buffer->Size       = size;
+
+    if (PIOS_FLASHFS_ObjSave(pios_user_fs_id, LOG_GET_FLIGHT_OBJID(flightnum), lognum, (uint8_t *)buffer, sizeof(DebugLogEntryData)) == 0) {
+        lognum++;
+        written = true;
+    }
+    mutexunlock();
+    return written;
+}
+
 
 /**
  * @brief Load one object instance from the filesystem
@@ -212,18 +380,91 @@ void PIOS_DEBUGLOG_Info(uint16_t *flight, uint16_t *entry, uint16_t *free, uint1
     }
 }
 
+/**
+ * @brief Retrieve run time info of the blackbox
+ * @param[out] bytes logged
+ * @param[out] bytes left
+ * @param[out] samples dropped because the writer fell behind
+ * @return 0 if success, -1 if there is no blackbox
+ */
+int32_t PIOS_DEBUGLOG_BlackboxInfo(uint32_t *used, uint32_t *free, uint32_t *dropped)
+{
+#if defined(PIOS_INCLUDE_BLACKBOX)
+    struct PIOS_BLACKBOX_Stats stats;
+    if (pios_blackbox_id && PIOS_BLACKBOX_GetStats(pios_blackbox_id, &stats) == 0) {
+        if (used) {
+            *used = stats.used_bytes;
+        }
+        if (free) {
+            *free = stats.free_bytes;
+        }
+        if (dropped) {
+            *dropped = stats.dropped_records;
+        }
+        return 0;
+    }
+#endif
+    if (used) {
+        *used = 0;
+    }
+    if (free) {
+        *free = 0;
+    }
+    if (dropped) {
+        *dropped = 0;
+    }
+    return -1;
+}
+
+/**
+ * @brief Read back raw blackbox contents
+ * @param[out] buffer for the data
+ * @param[in] byte offset into the blackbox
+ * @param[in] size of the buffer
+ * @return number of bytes read, 0 past the end, < 0 on error or if there is no blackbox
+ */
+int32_t PIOS_DEBUGLOG_ReadBlackbox(__attribute__((unused)) uint8_t *mybuffer, __attribute__((unused)) uint32_t offset, __attribute__((unused)) uint16_t size)
+{
+#if defined(PIOS_INCLUDE_BLACKBOX)
+    if (pios_blackbox_id) {
+        return PIOS_BLACKBOX_Read(pios_blackbox_id, offset, mybuffer, size);
+    }
+#endif
+    return -1;
+}
+
+/**
+ * @brief Run the blackbox writer, call periodically from a low priority task
+ * @return 1 if more work is pending, 0 if idle, < 0 on error or if there is no blackbox
+ */
+int32_t PIOS_DEBUGLOG_ProcessBlackbox(void)
+{
+#if defined(PIOS_INCLUDE_BLACKBOX)
+    if (pios_blackbox_id) {
+        return PIOS_BLACKBOX_Process(pios_blackbox_id);
+    }
+#endif
+    return -1;
+}
+
 /**
  * @brief Format entire flash memory!!!
  */
 void PIOS_DEBUGLOG_Format(void)
 {
     mutexlock();
+#if defined(PIOS_INCLUDE_BLACKBOX)
+    if (pios_blackbox_id) {
+        PIOS_BLACKBOX_Erase(pios_blackbox_id);
+    }
+#endif
     PIOS_FLASHFS_Format(pios_user_fs_id);
     lognum      = 0;
     flightnum   = 0;
     log_is_full = false;
     fails_count = 0;
     used_buffer_space = 0;
+    reset_compact();
     mutexunlock();
 }
 
@@ -231,6 +472,13 @@ void enqueue_data(uint32_t objid, uint16_t instid, size_t size, uint8_t *data)
 {
     DebugLogEntryData *entry;
 
+    // compact and plain samples are not mixed in the same block, neither are messages
+    if (used_buffer_space && (buffer->Type == DEBUGLOGENTRY_TYPE_COMPACTUAVOBJECTS || buffer->Type == DEBUGLOGENTRY_TYPE_MESSAGES)) {
+        if (!write_current_buffer()) {
+            return;
+        }
+    }
+
     // start a new block
     if (!used_buffer_space) {
         entry = buffer;
@@ -266,6 +514,272 @@ void enqueue_data(uint32_t objid, uint16_t instid, size_t size, uint8_t *data)
     memcpy(entry->Data, data, size);
 }
 
+static uint8_t *put_varint(uint8_t *p, uint32_t value)
+{
+    while (value >= 0x80) {
+        *p++    = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    *p++ = (uint8_t)value;
+    return p;
+}
+
+static inline uint32_t zigzag(int32_t value)
+{
+    return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+/**
+ * @brief Append the zig-zag varint deltas of every field of a sample
+ * @param[in] output position
+ * @param[in] sample
+ * @param[in] previous sample of the same instance, NULL for a keyframe
+ * @return next output position
+ */
+static uint8_t *put_fields(uint8_t *p, const uint8_t *data, const uint8_t *previous, size_t size, uint16_t num_words, uint16_t num_halfwords)
+{
+    size_t i = 0;
+
+    for (uint16_t n = 0; n < num_words; n++, i += 4) {
+        uint32_t cur, prev = 0;
+        memcpy(&cur, &data[i], 4);
+        if (previous) {
+            memcpy(&prev, &previous[i], 4);
+        }
+        p = put_varint(p, zigzag((int32_t)(cur - prev)));
+    }
+    for (uint16_t n = 0; n < num_halfwords; n++, i += 2) {
+        uint16_t cur, prev = 0;
+        memcpy(&cur, &data[i], 2);
+        if (previous) {
+            memcpy(&prev, &previous[i], 2);
+        }
+        p = put_varint(p, zigzag((int16_t)(cur - prev)));
+    }
+    for (; i < size; i++) {
+        p = put_varint(p, zigzag((int8_t)(data[i] - (previous ? previous[i] : 0))));
+    }
+    return p;
+}
+
+/**
+ * @brief Forget the previous samples so that every object starts again with a keyframe
+ */
+void reset_compact()
+{
+    if (!compact_objects) {
+        return;
+    }
+    for (uint8_t slot = 0; slot < LOG_COMPACT_MAX_OBJECTS; slot++) {
+        compact_objects[slot].samples = 0;
+    }
+}
+
+/**
+ * @brief Append a sample to a compact block, see the record format above
+ * @return false if the object cannot be delta coded and has to be logged in the plain format
+ */
+bool enqueue_compact(uint32_t objid, uint16_t instid, size_t size, uint16_t num_words, uint16_t num_halfwords, const uint8_t *data)
+{
+    struct log_compact_object *obj = 0;
+    uint8_t slot;
+
+    if (!compact_objects || !compact_record || LOG_COMPACT_RECORD_MAX(size) > LOG_ENTRY_MAX_DATA_SIZE ||
+        4 * (size_t)num_words + 2 * (size_t)num_halfwords > size) {
+        return false;
+    }
+
+    for (slot = 0; slot < LOG_COMPACT_MAX_OBJECTS; slot++) {
+        struct log_compact_object *candidate = &compact_objects[slot];
+        if (!candidate->size) {
+            // first sample of this instance, claim the free slot
+            candidate->previous = pios_malloc(size);
+            if (candidate->previous) {
+                candidate->objid   = objid;
+                candidate->instid  = instid;
+                candidate->size    = size;
+                candidate->num_words     = num_words;
+                candidate->num_halfwords = num_halfwords;
+                candidate->samples = 0;
+                obj = candidate;
+            }
+            break;
+        }
+        if (candidate->objid == objid && candidate->instid == instid) {
+            obj = candidate;
+            break;
+        }
+    }
+    // out of slots, keep logging the instance as standalone keyframes
+    bool keyframe = !obj || obj->samples == 0;
+    if (!obj) {
+        slot = LOG_COMPACT_UNTRACKED_SLOT;
+    }
+
+    // code the fields first, the record only goes in the block once its length is known
+    uint8_t *p = compact_record;
+    if (keyframe) {
+        memcpy(p, &objid, sizeof(objid));
+        p += sizeof(objid);
+        p  = put_varint(p, instid);
+        p  = put_varint(p, size);
+        p  = put_varint(p, num_words);
+        p  = put_varint(p, num_halfwords);
+    }
+    p = put_fields(p, data, keyframe ? NULL : obj->previous, size, num_words, num_halfwords);
+    uint32_t record_size = p - compact_record;
+
+    if (used_buffer_space && (buffer->Type != DEBUGLOGENTRY_TYPE_COMPACTUAVOBJECTS ||
+                              used_buffer_space + LOG_COMPACT_HEADER_MAX + record_size > LOG_ENTRY_MAX_DATA_SIZE)) {
+        if (!write_current_buffer()) {
+            // sample dropped, the previous one stays the reference
+            return true;
+        }
+    }
+
+    uint32_t now = PIOS_DELAY_GetuS();
+    if (!used_buffer_space) {
+        memset(buffer->Data, 0xff, sizeof(buffer->Data));
+        buffer->Flight     = flightnum;
+        buffer->FlightTime = now;
+        buffer->Entry      = lognum;
+        buffer->Type       = DEBUGLOGENTRY_TYPE_COMPACTUAVOBJECTS;
+        buffer->ObjectID   = 0;
+        buffer->InstanceID = 0;
+        compact_last_time  = now;
+    }
+
+    p = &buffer->Data[used_buffer_space];
+    p = put_varint(p, ((uint32_t)slot << 1) | (keyframe ? 1 : 0));
+    p = put_varint(p, now - compact_last_time);
+    memcpy(p, compact_record, record_size);
+    p += record_size;
+
+    used_buffer_space = p - buffer->Data;
+    buffer->Size      = used_buffer_space;
+    compact_last_time = now;
+
+    if (obj) {
+        memcpy(obj->previous, data, size);
+        obj->samples = (obj->samples + 1) % LOG_COMPACT_KEYFRAME_INTERVAL;
+    }
+    return true;
+}
+
+/**
+ * @brief Append a message to a message block, see the record format above
+ * The arguments are fetched as the format string says, nothing is formatted here
+ */
+void enqueue_message(const char *format, va_list args)
+{
+    uint8_t *p = compact_record;
+    const uint8_t *end = compact_record + LOG_ENTRY_MAX_DATA_SIZE - LOG_MESSAGE_HEADER_MAX - LOG_MESSAGE_ARG_MAX;
+    bool done  = false;
+
+    // code the arguments first, the record only goes in the block once its length is known.
+    // Arguments that do not fit are dropped, the size of the arguments tells the GCS where to stop.
+    for (const char *f = format; !done && *f && p <= end; f++) {
+        if (*f != '%' || *++f == '%') {
+            continue;
+        }
+        // flags, width and precision, '*' takes an int argument
+        while (*f && strchr("-+ #0123456789.*", *f)) {
+            if (*f == '*') {
+                p = put_varint(p, zigzag(va_arg(args, int)));
+            }
+            f++;
+        }
+        // length modifiers, only long long changes the argument size
+        bool longlong = false;
+        while (*f && strchr("hlLqjzt", *f)) {
+            longlong = longlong || *f == 'L' || *f == 'q' || (*f == 'l' && f[1] == 'l');
+            f += (*f == 'l' && f[1] == 'l') ? 2 : 1;
+        }
+        switch (*f) {
+        case 'd':
+        case 'i':
+            p = put_varint(p, zigzag(longlong ? (int32_t)va_arg(args, long long) : va_arg(args, int)));
+            break;
+        case 'u':
+        case 'o':
+        case 'x':
+        case 'X':
+        case 'c':
+            p = put_varint(p, longlong ? (uint32_t)va_arg(args, unsigned long long) : va_arg(args, unsigned int));
+            break;
+        case 'p':
+            p = put_varint(p, (uint32_t)(uintptr_t)va_arg(args, void *));
+            break;
+        case 'e':
+        case 'E':
+        case 'f':
+        case 'F':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A':
+        {
+            float value = (float)va_arg(args, double);
+            memcpy(p, &value, sizeof(value));
+            p += sizeof(value);
+            break;
+        }
+        case 's':
+        {
+            const char *str = va_arg(args, const char *);
+            uint32_t len    = 0;
+            while (str && len < LOG_MESSAGE_STRING_MAX && str[len]) {
+                len++;
+            }
+            p = put_varint(p, len);
+            if (len) {
+                memcpy(p, str, len);
+                p += len;
+            }
+            break;
+        }
+        case 'n':
+            (void)va_arg(args, void *);
+            break;
+        default:
+            // unknown conversion or end of the string, the arguments that follow cannot be fetched
+            done = true;
+            break;
+        }
+    }
+    uint32_t args_size = p - compact_record;
+
+    if (used_buffer_space && (buffer->Type != DEBUGLOGENTRY_TYPE_MESSAGES ||
+                              used_buffer_space + LOG_MESSAGE_HEADER_MAX + args_size > LOG_ENTRY_MAX_DATA_SIZE)) {
+        if (!write_current_buffer()) {
+            return;
+        }
+    }
+
+    uint32_t now = PIOS_DELAY_GetuS();
+    if (!used_buffer_space) {
+        memset(buffer->Data, 0xff, sizeof(buffer->Data));
+        buffer->Flight     = flightnum;
+        buffer->FlightTime = now;
+        buffer->Entry      = lognum;
+        buffer->Type       = DEBUGLOGENTRY_TYPE_MESSAGES;
+        buffer->ObjectID   = 0;
+        buffer->InstanceID = 0;
+        compact_last_time  = now;
+    }
+
+    p = &buffer->Data[used_buffer_space];
+    p = put_varint(p, format - __start_debuglog_fmt);
+    p = put_varint(p, now - compact_last_time);
+    p = put_varint(p, args_size);
+    memcpy(p, compact_record, args_size);
+    p += args_size;
+
+    used_buffer_space = p - buffer->Data;
+    buffer->Size      = used_buffer_space;
+    compact_last_time = now;
+}
+
 bool write_current_buffer()
 {
     // not enough space, write the block and start a new one
@@ -43,10 +43,23 @@ void PIOS_DELTATIME_Init(PiOSDeltatimeConfig *config, float average, float min,
 
 
 float PIOS_DELTATIME_GetAverageSeconds(PiOSDeltatimeConfig *config)
+{
+    return PIOS_DELTATIME_GetAverageSecondsSince(config, PIOS_DELAY_GetRaw());
+}
+
+
+/**
+ * Same as PIOS_DELTATIME_GetAverageSeconds() for an event that happened at a given time,
+ * for instance the capture time of a sensor sample, rather than now.
+ * @param config delta time configuration
+ * @param time PIOS_DELAY_GetRaw() time of the event
+ * @return averaged time since the previous event, in seconds
+ */
+float PIOS_DELTATIME_GetAverageSecondsSince(PiOSDeltatimeConfig *config, uint32_t time)
 {
     PIOS_Assert(config);
-    float dT = PIOS_DELAY_DiffuS(config->last) * 1.0e-6f;
-    config->last = PIOS_DELAY_GetRaw();
+    float dT = PIOS_DELAY_DiffuS2(config->last, time) * 1.0e-6f;
+    config->last = time;
     if (dT < config->min) {
         dT = config->min;
     }
@@ -69,6 +69,11 @@ struct jedec_flash_dev {
     uint8_t  capacity;
 
     const struct pios_flash_jedec_cfg *cfg;
+
+    // A program or erase operation may still be running in the chip
+    volatile bool busy;
+    pios_flash_jedec_callback callback;
+    uint32_t context;
 #if defined(FLASH_FREERTOS)
     xSemaphoreHandle transaction_lock;
 #endif
@@ -88,6 +93,12 @@ static int32_t PIOS_Flash_Jedec_ClaimBus(struct jedec_flash_dev *flash_dev, bool
 static int32_t PIOS_Flash_Jedec_ReleaseBus(struct jedec_flash_dev *flash_dev);
 static int32_t PIOS_Flash_Jedec_WriteEnable(struct jedec_flash_dev *flash_dev);
 static int32_t PIOS_Flash_Jedec_Busy(struct jedec_flash_dev *flash_dev);
+static int32_t PIOS_Flash_Jedec_WaitReady(struct jedec_flash_dev *flash_dev);
+static void PIOS_Flash_Jedec_Complete(struct jedec_flash_dev *flash_dev, int32_t status);
+static int32_t PIOS_Flash_Jedec_StartEraseSector(struct jedec_flash_dev *flash_dev, uint32_t addr);
+static int32_t PIOS_Flash_Jedec_StartWriteData(struct jedec_flash_dev *flash_dev, uint32_t addr, uint8_t *data, uint16_t len);
+static int32_t PIOS_Flash_Jedec_StartRead(struct jedec_flash_dev *flash_dev, uint32_t addr);
+static void PIOS_Flash_Jedec_ReadComplete(uint32_t context, bool crc_ok, uint8_t crc_val);
 
 /**
  * @brief Allocate a new device
@@ -101,8 +112,10 @@ static struct jedec_flash_dev *PIOS_Flash_Jedec_alloc(void)
         return NULL;
     }
 
-    flash_dev->claimed = false;
-    flash_dev->magic   = PIOS_JEDEC_DEV_MAGIC;
+    flash_dev->claimed  = false;
+    flash_dev->busy     = false;
+    flash_dev->callback = NULL;
+    flash_dev->magic    = PIOS_JEDEC_DEV_MAGIC;
 #if defined(FLASH_FREERTOS)
     flash_dev->transaction_lock = xSemaphoreCreateMutex();
 #endif
@@ -206,6 +219,59 @@ static int32_t PIOS_Flash_Jedec_Busy(struct jedec_flash_dev *flash_dev)
     return status & JEDEC_STATUS_BUSY;
 }
 
+/**
+ * @brief Wait for the program or erase operation started last to complete
+ * @returns 0 when the chip is ready, -1 if unable to claim bus
+ */
+static int32_t PIOS_Flash_Jedec_WaitReady(struct jedec_flash_dev *flash_dev)
+{
+    if (!flash_dev->busy) {
+        return 0;
+    }
+
+#if defined(FLASH_FREERTOS)
+    // Release the bus between polls so the other devices on it keep running
+    int32_t status;
+    while ((status = PIOS_Flash_Jedec_Busy(flash_dev)) != 0) {
+        if (status < 0) {
+            return -1;
+        }
+        vTaskDelay(1);
+    }
+#else
+    // Query status this way to prevent accel chip locking us out
+    if (PIOS_Flash_Jedec_ClaimBus(flash_dev, true) < 0) {
+        return -1;
+    }
+
+    PIOS_SPI_TransferByte(flash_dev->spi_id, JEDEC_READ_STATUS);
+    while (PIOS_SPI_TransferByte(flash_dev->spi_id, JEDEC_READ_STATUS) & JEDEC_STATUS_BUSY) {
+        ;
+    }
+
+    PIOS_Flash_Jedec_ReleaseBus(flash_dev);
+#endif /* FLASH_FREERTOS */
+
+    flash_dev->busy = false;
+    PIOS_Flash_Jedec_Complete(flash_dev, 0);
+
+    return 0;
+}
+
+/**
+ * @brief Report the completion of a non-blocking operation to its caller
+ */
+static void PIOS_Flash_Jedec_Complete(struct jedec_flash_dev *flash_dev, int32_t status)
+{
+    pios_flash_jedec_callback callback = flash_dev->callback;
+
+    if (callback) {
+        /* Clear before calling so the callback may start the next operation */
+        flash_dev->callback = NULL;
+        callback((uintptr_t)flash_dev, status, flash_dev->context);
+    }
+}
+
 /**
  * @brief Execute the write enable instruction and returns the status
  * @returns 0 if successful, -1 if unable to claim bus
@@ -336,20 +402,14 @@ static int32_t PIOS_Flash_Jedec_EndTransaction(__attribute__((unused)) uintptr_t
 #endif /* FLASH_USE_FREERTOS_LOCKS */
 
 /**
- * @brief Erase a sector on the flash chip
- * @param[in] add Address of flash to erase
+ * @brief Send the erase sector command, the chip stays busy for a while afterwards
+ * @param[in] addr Address of flash to erase
  * @returns 0 if successful
  * @retval -1 if unable to claim bus
- * @retval
+ * @retval -2 if the command could not be sent
  */
-static int32_t PIOS_Flash_Jedec_EraseSector(uintptr_t flash_id, uint32_t addr)
+static int32_t PIOS_Flash_Jedec_StartEraseSector(struct jedec_flash_dev *flash_dev, uint32_t addr)
 {
-    struct jedec_flash_dev *flash_dev = (struct jedec_flash_dev *)flash_id;
-
-    if (PIOS_Flash_Jedec_Validate(flash_dev) != 0) {
-        return -1;
-    }
-
     uint8_t ret;
     uint8_t out[] = { flash_dev->cfg->sector_erase, (addr >> 16) & 0xff, (addr >> 8) & 0xff, addr & 0xff };
 
@@ -367,15 +427,36 @@ static int32_t PIOS_Flash_Jedec_EraseSector(uintptr_t flash_id, uint32_t addr)
     }
 
     PIOS_Flash_Jedec_ReleaseBus(flash_dev);
+    flash_dev->busy = true;
 
-    // Keep polling when bus is busy too
-    while (PIOS_Flash_Jedec_Busy(flash_dev) != 0) {
-#if defined(FLASH_FREERTOS)
-        vTaskDelay(2);
-#endif
+    return 0;
+}
+
+/**
+ * @brief Erase a sector on the flash chip
+ * @param[in] add Address of flash to erase
+ * @returns 0 if successful
+ * @retval -1 if unable to claim bus
+ * @retval
+ */
+static int32_t PIOS_Flash_Jedec_EraseSector(uintptr_t flash_id, uint32_t addr)
+{
+    struct jedec_flash_dev *flash_dev = (struct jedec_flash_dev *)flash_id;
+    int32_t ret;
+
+    if (PIOS_Flash_Jedec_Validate(flash_dev) != 0) {
+        return -1;
     }
 
-    return 0;
+    if ((ret = PIOS_Flash_Jedec_WaitReady(flash_dev)) != 0) {
+        return ret;
+    }
+
+    if ((ret = PIOS_Flash_Jedec_StartEraseSector(flash_dev, addr)) != 0) {
+        return ret;
+    }
+
+    return PIOS_Flash_Jedec_WaitReady(flash_dev);
 }
 
 /**
@@ -393,6 +474,10 @@ static int32_t PIOS_Flash_Jedec_EraseChip(uintptr_t flash_id)
     uint8_t ret;
     uint8_t out[] = { flash_dev->cfg->chip_erase };
 
+    if ((ret = PIOS_Flash_Jedec_WaitReady(flash_dev)) != 0) {
+        return ret;
+    }
+
     if ((ret = PIOS_Flash_Jedec_WriteEnable(flash_dev)) != 0) {
         return ret;
     }
@@ -427,9 +512,8 @@ static int32_t PIOS_Flash_Jedec_EraseChip(uintptr_t flash_id)
     return 0;
 }
 
-
 /**
- * @brief Write one page of data (up to 256 bytes) aligned to a page start
+ * @brief Send the page program command and data, the chip stays busy for a while afterwards
  * @param[in] addr Address in flash to write to
  * @param[in] data Pointer to data to write to flash
  * @param[in] len Length of data to write (max 256 bytes)
@@ -438,14 +522,8 @@ static int32_t PIOS_Flash_Jedec_EraseChip(uintptr_t flash_id)
  * @retval -2 Size exceeds 256 bytes
  * @retval -3 Length to write would wrap around page boundary
  */
-static int32_t PIOS_Flash_Jedec_WriteData(uintptr_t flash_id, uint32_t addr, uint8_t *data, uint16_t len)
+static int32_t PIOS_Flash_Jedec_StartWriteData(struct jedec_flash_dev *flash_dev, uint32_t addr, uint8_t *data, uint16_t len)
 {
-    struct jedec_flash_dev *flash_dev = (struct jedec_flash_dev *)flash_id;
-
-    if (PIOS_Flash_Jedec_Validate(flash_dev) != 0) {
-        return -1;
-    }
-
     uint8_t ret;
     uint8_t out[4] = { JEDEC_PAGE_WRITE, (addr >> 16) & 0xff, (addr >> 8) & 0xff, addr & 0xff };
 
@@ -478,28 +556,39 @@ static int32_t PIOS_Flash_Jedec_WriteData(uintptr_t flash_id, uint32_t addr, uin
     }
 
     PIOS_Flash_Jedec_ReleaseBus(flash_dev);
+    flash_dev->busy = true;
 
-    // Keep polling when bus is busy too
-#if defined(FLASH_FREERTOS)
-    while (PIOS_Flash_Jedec_Busy(flash_dev) != 0) {
-        vTaskDelay(1);
-    }
-#else
+    return 0;
+}
 
-    // Query status this way to prevent accel chip locking us out
-    if (PIOS_Flash_Jedec_ClaimBus(flash_dev, true) < 0) {
+/**
+ * @brief Write one page of data (up to 256 bytes) aligned to a page start
+ * @param[in] addr Address in flash to write to
+ * @param[in] data Pointer to data to write to flash
+ * @param[in] len Length of data to write (max 256 bytes)
+ * @return Zero if success or error code
+ * @retval -1 Unable to claim SPI bus
+ * @retval -2 Size exceeds 256 bytes
+ * @retval -3 Length to write would wrap around page boundary
+ */
+static int32_t PIOS_Flash_Jedec_WriteData(uintptr_t flash_id, uint32_t addr, uint8_t *data, uint16_t len)
+{
+    struct jedec_flash_dev *flash_dev = (struct jedec_flash_dev *)flash_id;
+    int32_t ret;
+
+    if (PIOS_Flash_Jedec_Validate(flash_dev) != 0) {
         return -1;
     }
 
-    PIOS_SPI_TransferByte(flash_dev->spi_id, JEDEC_READ_STATUS);
-    while (PIOS_SPI_TransferByte(flash_dev->spi_id, JEDEC_READ_STATUS) & JEDEC_STATUS_BUSY) {
-        ;
+    if ((ret = PIOS_Flash_Jedec_WaitReady(flash_dev)) != 0) {
+        return ret;
     }
 
-    PIOS_Flash_Jedec_ReleaseBus(flash_dev);
+    if ((ret = PIOS_Flash_Jedec_StartWriteData(flash_dev, addr, data, len)) != 0) {
+        return ret;
+    }
 
-#endif
-    return 0;
+    return PIOS_Flash_Jedec_WaitReady(flash_dev);
 }
 
 /**
@@ -537,6 +626,9 @@ static int32_t PIOS_Flash_Jedec_WriteChunks(uintptr_t flash_id, uint32_t addr, s
     if (((addr & 0xff) + len) > 0x100) {
         return -3;
     }
+    if ((ret = PIOS_Flash_Jedec_WaitReady(flash_dev)) != 0) {
+        return ret;
+    }
     if ((ret = PIOS_Flash_Jedec_WriteEnable(flash_dev)) != 0) {
         return ret;
     }
@@ -562,27 +654,23 @@ static int32_t PIOS_Flash_Jedec_WriteChunks(uintptr_t flash_id, uint32_t addr, s
     }
     PIOS_Flash_Jedec_ReleaseBus(flash_dev);
 
-    // Skip checking for busy with this to get OS running again fast
+    // Skip checking for busy with this to get OS running again fast, the next access waits for it
+    flash_dev->busy = true;
 
     return 0;
 }
 
 /**
- * @brief Read data from a location in flash memory
- * @param[in] addr Address in flash to write to
- * @param[in] data Pointer to data to write from flash
- * @param[in] len Length of data to write (max 256 bytes)
+ * @brief Claim the bus and send the read command, CS is left asserted for the data
+ * @param[in] addr Address in flash to read from
  * @return Zero if success or error code
  * @retval -1 Unable to claim SPI bus
+ * @retval -2 Unable to send the command
  */
-static int32_t PIOS_Flash_Jedec_ReadData(uintptr_t flash_id, uint32_t addr, uint8_t *data, uint16_t len)
+static int32_t PIOS_Flash_Jedec_StartRead(struct jedec_flash_dev *flash_dev, uint32_t addr)
 {
-    struct jedec_flash_dev *flash_dev = (struct jedec_flash_dev *)flash_id;
-
-    if (PIOS_Flash_Jedec_Validate(flash_dev) != 0) {
-        return -1;
-    }
     bool fast_read = flash_dev->cfg->fast_read != 0;
+
     if (PIOS_Flash_Jedec_ClaimBus(flash_dev, fast_read) == -1) {
         return -1;
     }
@@ -607,6 +695,32 @@ static int32_t PIOS_Flash_Jedec_ReadData(uintptr_t flash_id, uint32_t addr, uint
         }
     }
 
+    return 0;
+}
+
+/**
+ * @brief Read data from a location in flash memory
+ * @param[in] addr Address in flash to write to
+ * @param[in] data Pointer to data to write from flash
+ * @param[in] len Length of data to write (max 256 bytes)
+ * @return Zero if success or error code
+ * @retval -1 Unable to claim SPI bus
+ */
+static int32_t PIOS_Flash_Jedec_ReadData(uintptr_t flash_id, uint32_t addr, uint8_t *data, uint16_t len)
+{
+    struct jedec_flash_dev *flash_dev = (struct jedec_flash_dev *)flash_id;
+    int32_t ret;
+
+    if (PIOS_Flash_Jedec_Validate(flash_dev) != 0) {
+        return -1;
+    }
+    if (PIOS_Flash_Jedec_WaitReady(flash_dev) != 0) {
+        return -1;
+    }
+    if ((ret = PIOS_Flash_Jedec_StartRead(flash_dev, addr)) != 0) {
+        return ret;
+    }
+
     /* Copy the transfer data to the buffer */
     if (PIOS_SPI_TransferBlock(flash_dev->spi_id, NULL, data, len, NULL) < 0) {
         PIOS_Flash_Jedec_ReleaseBus(flash_dev);
@@ -618,6 +732,163 @@ static int32_t PIOS_Flash_Jedec_ReadData(uintptr_t flash_id, uint32_t addr, uint
     return 0;
 }
 
+/**********************************
+ *
+ * Non-blocking API
+ *
+ *********************************/
+
+/**
+ * @brief Start erasing a sector, the callback is called by PIOS_Flash_Jedec_Poll() once it completes
+ * @param[in] addr Address of flash to erase
+ * @param[in] callback Called from the task polling the chip, may be NULL
+ * @param[in] context Passed back to the callback
+ * @return Zero if the erase has been started or error code
+ * @retval -1 Invalid handle or unable to claim SPI bus
+ * @retval -2 Unable to send the command
+ */
+int32_t PIOS_Flash_Jedec_EraseSectorAsync(uintptr_t flash_id, uint32_t addr, pios_flash_jedec_callback callback, uint32_t context)
+{
+    struct jedec_flash_dev *flash_dev = (struct jedec_flash_dev *)flash_id;
+    int32_t ret;
+
+    if (PIOS_Flash_Jedec_Validate(flash_dev) != 0) {
+        return -1;
+    }
+
+    if ((ret = PIOS_Flash_Jedec_WaitReady(flash_dev)) != 0) {
+        return ret;
+    }
+
+    if ((ret = PIOS_Flash_Jedec_StartEraseSector(flash_dev, addr)) != 0) {
+        return ret;
+    }
+    flash_dev->context  = context;
+    flash_dev->callback = callback;
+
+    return 0;
+}
+
+/**
+ * @brief Start programming one page, the callback is called by PIOS_Flash_Jedec_Poll() once it completes
+ * @param[in] addr Address in flash to write to
+ * @param[in] data Pointer to data to write to flash, only used until the call returns
+ * @param[in] len Length of data to write (max 256 bytes)
+ * @param[in] callback Called from the task polling the chip, may be NULL
+ * @param[in] context Passed back to the callback
+ * @return Zero if the write has been started or error code
+ * @retval -1 Invalid handle or unable to claim SPI bus
+ * @retval -2 Size exceeds 256 bytes
+ * @retval -3 Length to write would wrap around page boundary
+ */
+int32_t PIOS_Flash_Jedec_WriteDataAsync(uintptr_t flash_id, uint32_t addr, uint8_t *data, uint16_t len, pios_flash_jedec_callback callback, uint32_t context)
+{
+    struct jedec_flash_dev *flash_dev = (struct jedec_flash_dev *)flash_id;
+    int32_t ret;
+
+    if (PIOS_Flash_Jedec_Validate(flash_dev) != 0) {
+        return -1;
+    }
+
+    if ((ret = PIOS_Flash_Jedec_WaitReady(flash_dev)) != 0) {
+        return ret;
+    }
+
+    if ((ret = PIOS_Flash_Jedec_StartWriteData(flash_dev, addr, data, len)) != 0) {
+        return ret;
+    }
+    flash_dev->context  = context;
+    flash_dev->callback = callback;
+
+    return 0;
+}
+
+/**
+ * @brief Read data with a single DMA transfer, the callback is called from the SPI interrupt
+ * once the data is in the buffer. The bus stays claimed until then.
+ * @param[in] addr Address in flash to read from
+ * @param[in] data Pointer to the buffer, must stay valid until the callback
+ * @param[in] len Length of data to read, may span any number of pages
+ * @param[in] callback Called from the SPI interrupt
+ * @param[in] context Passed back to the callback
+ * @return Zero if the read has been started or error code
+ * @retval -1 Invalid handle or unable to claim SPI bus
+ * @retval -2 Unable to send the command
+ * @retval -3 Unable to start the transfer
+ */
+int32_t PIOS_Flash_Jedec_ReadDataAsync(uintptr_t flash_id, uint32_t addr, uint8_t *data, uint16_t len, pios_flash_jedec_callback callback, uint32_t context)
+{
+    struct jedec_flash_dev *flash_dev = (struct jedec_flash_dev *)flash_id;
+    int32_t ret;
+
+    if (PIOS_Flash_Jedec_Validate(flash_dev) != 0 || !callback) {
+        return -1;
+    }
+    if (PIOS_Flash_Jedec_WaitReady(flash_dev) != 0) {
+        return -1;
+    }
+    if ((ret = PIOS_Flash_Jedec_StartRead(flash_dev, addr)) != 0) {
+        return ret;
+    }
+
+    flash_dev->context  = context;
+    flash_dev->callback = callback;
+    if (PIOS_SPI_TransferBlockAsync(flash_dev->spi_id, NULL, data, len, PIOS_Flash_Jedec_ReadComplete, (uint32_t)flash_dev) < 0) {
+        flash_dev->callback = NULL;
+        PIOS_Flash_Jedec_ReleaseBus(flash_dev);
+        return -3;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief End of the DMA transfer of PIOS_Flash_Jedec_ReadDataAsync(), called from the SPI interrupt
+ */
+static void PIOS_Flash_Jedec_ReadComplete(uint32_t context, __attribute__((unused)) bool crc_ok, __attribute__((unused)) uint8_t crc_val)
+{
+    struct jedec_flash_dev *flash_dev = (struct jedec_flash_dev *)context;
+    bool woken = false;
+
+    PIOS_SPI_RC_PinSet(flash_dev->spi_id, flash_dev->slave_num, 1);
+    PIOS_SPI_ReleaseBusISR(flash_dev->spi_id, &woken);
+    flash_dev->claimed = false;
+
+    PIOS_Flash_Jedec_Complete(flash_dev, 0);
+
+#if defined(PIOS_INCLUDE_FREERTOS)
+    portEND_SWITCHING_ISR(woken ? pdTRUE : pdFALSE);
+#endif
+}
+
+/**
+ * @brief Check once whether the program or erase operation started last has completed,
+ * without holding the bus, and call its callback if it has
+ * @return 0 if the chip is ready, 1 if it is still busy, -1 on error
+ */
+int32_t PIOS_Flash_Jedec_Poll(uintptr_t flash_id)
+{
+    struct jedec_flash_dev *flash_dev = (struct jedec_flash_dev *)flash_id;
+    int32_t status;
+
+    if (PIOS_Flash_Jedec_Validate(flash_dev) != 0) {
+        return -1;
+    }
+
+    if (!flash_dev->busy) {
+        return 0;
+    }
+
+    if ((status = PIOS_Flash_Jedec_Busy(flash_dev)) != 0) {
+        return status < 0 ? -1 : 1;
+    }
+
+    flash_dev->busy = false;
+    PIOS_Flash_Jedec_Complete(flash_dev, 0);
+
+    return 0;
+}
+
 /* Provide a flash driver to external drivers */
 const struct pios_flash_driver pios_jedec_flash_driver = {
     .start_transaction = PIOS_Flash_Jedec_StartTransaction,
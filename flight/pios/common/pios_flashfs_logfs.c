@@ -30,6 +30,7 @@
 #ifdef PIOS_INCLUDE_FLASH
 
 #include <stdbool.h>
+#include <string.h>
 #include <openpilot.h>
 #include <pios_math.h>
 #include <pios_wdg.h>
@@ -43,6 +44,24 @@ enum pios_flashfs_logfs_dev_magic {
     PIOS_FLASHFS_LOGFS_DEV_MAGIC = 0x94938201,
 };
 
+/*
+ * RAM index entry, maps an object instance to the slot holding its active version
+ */
+struct logfs_index_entry {
+    uint32_t obj_id;
+    uint16_t obj_inst_id;
+    uint16_t slot_id;
+};
+
+/*
+ * Progress of a compaction of the active arena into the next one
+ */
+enum logfs_gc_state {
+    LOGFS_GC_IDLE,
+    LOGFS_GC_ERASING, /* erasing the destination arena one sector at a time */
+    LOGFS_GC_COPYING, /* copying the active slots one at a time */
+};
+
 struct logfs_state {
     enum pios_flashfs_logfs_dev_magic magic;
     const struct flashfs_logfs_cfg    *cfg;
@@ -56,6 +75,23 @@ struct logfs_state {
     uint16_t num_free_slots; /* slots in free state */
     uint16_t num_active_slots; /* slots in active state */
 
+    /* Active slots sorted by obj_id/obj_inst_id, only trusted while index_valid is set */
+    struct logfs_index_entry *index;
+    uint16_t index_used;
+    bool     index_valid;
+
+    /* Compaction in progress, only advanced by logfs_compact_step() */
+    enum logfs_gc_state gc_state;
+    uint8_t  gc_dst_arena_id;
+    uint16_t gc_sector_id; /* next destination sector to erase */
+    uint16_t gc_src_slot_id; /* next source slot to look at */
+    uint16_t gc_dst_slot_id; /* next free destination slot */
+
+    /* Reserved slots written by PIOS_FLASHFS_BatchSave, activated by PIOS_FLASHFS_BatchCommit */
+    struct logfs_index_entry *batch;
+    uint16_t batch_used;
+    bool     batch_open;
+
     /* Underlying flash driver glue */
     const struct pios_flash_driver *driver;
     uintptr_t flash_id;
@@ -111,22 +147,22 @@ struct arena_header {
 ****************************************/
 
 /**
- * @brief Erases all sectors within the given arena and sets arena to erased state.
+ * @brief Erases one sector within the given arena, the last one sets the arena to erased state.
  * @return 0 if success, < 0 on failure
  * @note Must be called while holding the flash transaction lock
  */
-static int32_t logfs_erase_arena(const struct logfs_state *logfs, uint8_t arena_id)
+static int32_t logfs_erase_arena_sector(const struct logfs_state *logfs, uint8_t arena_id, uint16_t sector_id)
 {
     uintptr_t arena_addr = logfs_get_addr(logfs, arena_id, 0);
 
-    /* Erase all of the sectors in the arena */
-    for (uint8_t sector_id = 0;
-         sector_id < (logfs->cfg->arena_size / logfs->cfg->sector_size);
-         sector_id++) {
-        if (logfs->driver->erase_sector(logfs->flash_id,
-                                        arena_addr + (sector_id * logfs->cfg->sector_size))) {
-            return -1;
-        }
+    if (logfs->driver->erase_sector(logfs->flash_id,
+                                    arena_addr + (sector_id * logfs->cfg->sector_size))) {
+        return -1;
+    }
+
+    if (sector_id < (logfs->cfg->arena_size / logfs->cfg->sector_size) - 1) {
+        /* More sectors to go */
+        return 0;
     }
 
     /* Mark this arena as fully erased */
@@ -146,6 +182,25 @@ static int32_t logfs_erase_arena(const struct logfs_state *logfs, uint8_t arena_
     return 0;
 }
 
+/**
+ * @brief Erases all sectors within the given arena and sets arena to erased state.
+ * @return 0 if success, < 0 on failure
+ * @note Must be called while holding the flash transaction lock
+ */
+static int32_t logfs_erase_arena(const struct logfs_state *logfs, uint8_t arena_id)
+{
+    /* Erase all of the sectors in the arena */
+    for (uint16_t sector_id = 0;
+         sector_id < (logfs->cfg->arena_size / logfs->cfg->sector_size);
+         sector_id++) {
+        if (logfs_erase_arena_sector(logfs, arena_id, sector_id) != 0) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
 /**
  * @brief Marks the given arena as reserved so it can be filled.
  * @return 0 if success, < 0 on failure
@@ -416,13 +471,84 @@ static bool logfs_log_is_full(const struct logfs_state *logfs)
     return logfs->num_free_slots == 0;
 }
 
+/**
+ * @brief Find the position of an object instance in the RAM index
+ * @return position of the entry if found, else the position where it would have to be inserted
+ */
+static uint16_t logfs_index_search(const struct logfs_state *logfs, uint32_t obj_id, uint16_t obj_inst_id, bool *found)
+{
+    uint16_t lo = 0;
+    uint16_t hi = logfs->index_used;
+
+    *found = false;
+    while (lo < hi) {
+        uint16_t mid = (lo + hi) / 2;
+        const struct logfs_index_entry *entry = &logfs->index[mid];
+        if (entry->obj_id == obj_id && entry->obj_inst_id == obj_inst_id) {
+            *found = true;
+            return mid;
+        }
+        if (entry->obj_id < obj_id || (entry->obj_id == obj_id && entry->obj_inst_id < obj_inst_id)) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+/**
+ * @brief Record the slot holding the active version of an object instance
+ * @note Invalidates the index if it is full or if the object instance is already indexed,
+ *       lookups then fall back to scanning the flash until the next mount
+ */
+static void logfs_index_add(struct logfs_state *logfs, uint32_t obj_id, uint16_t obj_inst_id, uint16_t slot_id)
+{
+    if (!logfs->index_valid) {
+        return;
+    }
+
+    bool found;
+    uint16_t pos = logfs_index_search(logfs, obj_id, obj_inst_id, &found);
+    if (found || logfs->index_used >= logfs->cfg->index_size) {
+        logfs->index_valid = false;
+        return;
+    }
+
+    memmove(&logfs->index[pos + 1], &logfs->index[pos], (logfs->index_used - pos) * sizeof(logfs->index[0]));
+    logfs->index[pos].obj_id      = obj_id;
+    logfs->index[pos].obj_inst_id = obj_inst_id;
+    logfs->index[pos].slot_id     = slot_id;
+    logfs->index_used++;
+}
+
+/**
+ * @brief Forget about an object instance after its active slot has been obsoleted
+ */
+static void logfs_index_remove(struct logfs_state *logfs, uint32_t obj_id, uint16_t obj_inst_id)
+{
+    if (!logfs->index_valid) {
+        return;
+    }
+
+    bool found;
+    uint16_t pos = logfs_index_search(logfs, obj_id, obj_inst_id, &found);
+    if (found) {
+        logfs->index_used--;
+        memmove(&logfs->index[pos], &logfs->index[pos + 1], (logfs->index_used - pos) * sizeof(logfs->index[0]));
+    }
+}
+
 static int32_t logfs_unmount_log(struct logfs_state *logfs)
 {
     PIOS_Assert(logfs->mounted);
 
     logfs->num_active_slots = 0;
     logfs->num_free_slots   = 0;
-    logfs->mounted = false;
+    logfs->index_used       = 0;
+    logfs->index_valid      = false;
+    logfs->gc_state = LOGFS_GC_IDLE;
+    logfs->mounted  = false;
 
     return 0;
 }
@@ -434,8 +560,10 @@ static int32_t logfs_mount_log(struct logfs_state *logfs, uint8_t arena_id)
     logfs->num_active_slots = 0;
     logfs->num_free_slots   = 0;
     logfs->active_arena_id  = arena_id;
+    logfs->index_used       = 0;
+    logfs->index_valid      = (logfs->index != NULL);
 
-    /* Scan the log to find out how full it is */
+    /* Scan the log to find out how full it is and build the index */
     for (uint16_t slot_id = 1;
          slot_id < (logfs->cfg->arena_size / logfs->cfg->slot_size);
          slot_id++) {
@@ -461,6 +589,7 @@ static int32_t logfs_mount_log(struct logfs_state *logfs, uint8_t arena_id)
             break;
         case SLOT_STATE_ACTIVE:
             logfs->num_active_slots++;
+            logfs_index_add(logfs, slot_hdr.obj_id, slot_hdr.obj_inst_id, slot_id);
             break;
         case SLOT_STATE_RESERVED:
         case SLOT_STATE_OBSOLETE:
@@ -491,14 +620,33 @@ static struct logfs_state *PIOS_FLASHFS_Logfs_alloc(void)
     }
 
     logfs->magic = PIOS_FLASHFS_LOGFS_DEV_MAGIC;
+    logfs->index = NULL;
+    logfs->batch = NULL;
     return logfs;
 }
 static void PIOS_FLASHFS_Logfs_free(struct logfs_state *logfs)
 {
     /* Invalidate the magic */
     logfs->magic = ~PIOS_FLASHFS_LOGFS_DEV_MAGIC;
+    if (logfs->index) {
+        vPortFree(logfs->index);
+    }
+    if (logfs->batch) {
+        vPortFree(logfs->batch);
+    }
     vPortFree(logfs);
 }
+static void PIOS_FLASHFS_Logfs_alloc_index(struct logfs_state *logfs)
+{
+    if (logfs->cfg->index_size) {
+        /* Without an index lookups just scan the flash, so failing to allocate it is not fatal */
+        logfs->index = (struct logfs_index_entry *)pios_malloc(logfs->cfg->index_size * sizeof(struct logfs_index_entry));
+    }
+    if (logfs->cfg->batch_size) {
+        /* Without a batch every save is written through, again not fatal */
+        logfs->batch = (struct logfs_index_entry *)pios_malloc(logfs->cfg->batch_size * sizeof(struct logfs_index_entry));
+    }
+}
 #else
 static struct logfs_state pios_flashfs_logfs_devs[PIOS_FLASHFS_LOGFS_MAX_DEVS];
 static uint8_t pios_flashfs_logfs_num_devs;
@@ -512,6 +660,8 @@ static struct logfs_state *PIOS_FLASHFS_Logfs_alloc(void)
 
     logfs = &pios_flashfs_logfs_devs[pios_flashfs_logfs_num_devs++];
     logfs->magic = PIOS_FLASHFS_LOGFS_DEV_MAGIC;
+    logfs->index = NULL;
+    logfs->batch = NULL;
 
     return logfs;
 }
@@ -522,6 +672,10 @@ static void PIOS_FLASHFS_Logfs_free(struct logfs_state *logfs)
 
     /* Can't free the resources with this simple allocator */
 }
+static void PIOS_FLASHFS_Logfs_alloc_index(__attribute__((unused)) struct logfs_state *logfs)
+{
+    /* No heap, lookups always scan the flash and batched saves are written through */
+}
 #endif /* if defined(PIOS_INCLUDE_FREERTOS) */
 
 /**
@@ -559,6 +713,10 @@ int32_t PIOS_FLASHFS_Logfs_Init(uintptr_t *fs_id, const struct flashfs_logfs_cfg
     logfs->driver   = driver; /* lower-level flash driver */
     logfs->flash_id = flash_id; /* lower-level flash device id */
     logfs->mounted  = false;
+    logfs->gc_state = LOGFS_GC_IDLE;
+    logfs->batch_used = 0;
+    logfs->batch_open = false;
+    PIOS_FLASHFS_Logfs_alloc_index(logfs);
 
     if (logfs->driver->start_transaction(logfs->flash_id) != 0) {
         rc = -1;
@@ -628,76 +786,196 @@ out_exit:
     return rc;
 }
 
+/*
+ * Should a background compaction be started?
+ * true = the log is running low on free slots and compacting would bring it back above the headroom
+ * false = either there is plenty of room left or compaction would not free enough of it
+ */
+static bool logfs_compact_wanted(const struct logfs_state *logfs)
+{
+    uint16_t num_slots = logfs->cfg->arena_size / logfs->cfg->slot_size;
+
+    return logfs->num_free_slots < logfs->cfg->gc_headroom &&
+           (num_slots - 1 - logfs->num_active_slots) >= logfs->cfg->gc_headroom;
+}
+
 /* NOTE: Must be called while holding the flash transaction lock */
-static int32_t logfs_garbage_collect(struct logfs_state *logfs)
+static void logfs_compact_start(struct logfs_state *logfs)
 {
     PIOS_Assert(logfs->mounted);
+    PIOS_Assert(logfs->gc_state == LOGFS_GC_IDLE);
+
+    /* Source arena is the active arena, destination is the next one */
+    logfs->gc_dst_arena_id = (logfs->active_arena_id + 1) % (logfs->cfg->total_fs_size / logfs->cfg->arena_size);
+    logfs->gc_sector_id    = 0;
+    logfs->gc_src_slot_id  = 1;
+    logfs->gc_dst_slot_id  = 1;
+    logfs->gc_state = LOGFS_GC_ERASING;
+}
 
-    /* Source arena is the active arena */
+/**
+ * @brief Switches the filesystem over to the fully populated destination arena
+ * @return 0 if success, < 0 on failure
+ * @note Must be called while holding the flash transaction lock
+ */
+static int32_t logfs_compact_finish(struct logfs_state *logfs)
+{
     uint8_t src_arena_id = logfs->active_arena_id;
+    uint8_t dst_arena_id = logfs->gc_dst_arena_id;
 
-    /* Compute destination arena */
-    uint8_t dst_arena_id = (logfs->active_arena_id + 1) % (logfs->cfg->total_fs_size / logfs->cfg->arena_size);
-
-    /* Erase destination arena */
-    if (logfs_erase_arena(logfs, dst_arena_id) != 0) {
+    /* Activate the destination arena */
+    if (logfs_activate_arena(logfs, dst_arena_id) != 0) {
         return -1;
     }
 
-    /* Reserve the destination arena so we can start filling it */
-    if (logfs_reserve_arena(logfs, dst_arena_id) != 0) {
-        /* Unable to reserve the arena */
+    /* Unmount the source arena */
+    if (logfs_unmount_log(logfs) != 0) {
         return -2;
     }
 
-    /* Copy active slots from active arena to destination arena */
-    uint16_t dst_slot_id = 1;
-    for (uint16_t src_slot_id = 1;
-         src_slot_id < (logfs->cfg->arena_size / logfs->cfg->slot_size);
-         src_slot_id++) {
+    /* Obsolete the source arena */
+    if (logfs_obsolete_arena(logfs, src_arena_id) != 0) {
+        return -3;
+    }
+
+    /* Mount the new arena */
+    if (logfs_mount_log(logfs, dst_arena_id) != 0) {
+        return -4;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Advances the compaction by one sector erase or one slot copy
+ * @return 0 if success, < 0 on failure
+ * @note Foreground saves keep appending to the source arena in between steps,
+ *       the copy only completes once it has caught up with the end of the log.
+ * @note Must be called while holding the flash transaction lock
+ */
+static int32_t logfs_compact_step(struct logfs_state *logfs)
+{
+    int32_t rc;
+
+    PIOS_Assert(logfs->mounted);
+
+    switch (logfs->gc_state) {
+    case LOGFS_GC_ERASING:
+        if (logfs_erase_arena_sector(logfs, logfs->gc_dst_arena_id, logfs->gc_sector_id) != 0) {
+            rc = -1;
+            goto out_abort;
+        }
+        logfs->gc_sector_id++;
+        if (logfs->gc_sector_id < (logfs->cfg->arena_size / logfs->cfg->sector_size)) {
+            /* More sectors to erase */
+            break;
+        }
+
+        /* Reserve the destination arena so we can start filling it */
+        if (logfs_reserve_arena(logfs, logfs->gc_dst_arena_id) != 0) {
+            rc = -2;
+            goto out_abort;
+        }
+        logfs->gc_state = LOGFS_GC_COPYING;
+        break;
+    case LOGFS_GC_COPYING:
+        if (logfs->gc_src_slot_id < (logfs->cfg->arena_size / logfs->cfg->slot_size) - logfs->num_free_slots) {
+            /* Copy the next slot if it is still active */
+            struct slot_header slot_hdr;
+            uintptr_t src_addr = logfs_get_addr(logfs, logfs->active_arena_id, logfs->gc_src_slot_id);
+            if (logfs->driver->read_data(logfs->flash_id,
+                                         src_addr,
+                                         (uint8_t *)&slot_hdr,
+                                         sizeof(slot_hdr)) != 0) {
+                rc = -3;
+                goto out_abort;
+            }
+
+            if (slot_hdr.state == SLOT_STATE_ACTIVE) {
+                uintptr_t dst_addr = logfs_get_addr(logfs, logfs->gc_dst_arena_id, logfs->gc_dst_slot_id);
+                if (logfs_raw_copy_bytes(logfs,
+                                         src_addr,
+                                         sizeof(slot_hdr) + slot_hdr.obj_size,
+                                         dst_addr) != 0) {
+                    /* Failed to copy all bytes */
+                    rc = -4;
+                    goto out_abort;
+                }
+                logfs->gc_dst_slot_id++;
+            }
+            logfs->gc_src_slot_id++;
+            break;
+        }
+
+        /* Caught up with the end of the log, the destination holds every active slot */
+        if (logfs_compact_finish(logfs) != 0) {
+            return -5;
+        }
+        break;
+    case LOGFS_GC_IDLE:
+        break;
+    }
+
+    return 0;
+
+out_abort:
+    /* Start over from a fresh erase next time, the source arena is untouched */
+    logfs->gc_state = LOGFS_GC_IDLE;
+    return rc;
+}
+
+/**
+ * @brief Obsoletes the destination arena copy of an object instance that was just deleted
+ * @return 0 if success, < 0 on failure
+ * @note Must be called while holding the flash transaction lock
+ */
+static int32_t logfs_compact_obsolete_copy(struct logfs_state *logfs, uint32_t obj_id, uint16_t obj_inst_id)
+{
+    for (uint16_t slot_id = 1; slot_id < logfs->gc_dst_slot_id; slot_id++) {
         struct slot_header slot_hdr;
-        uintptr_t src_addr = logfs_get_addr(logfs, src_arena_id, src_slot_id);
+        uintptr_t slot_addr = logfs_get_addr(logfs, logfs->gc_dst_arena_id, slot_id);
         if (logfs->driver->read_data(logfs->flash_id,
-                                     src_addr,
+                                     slot_addr,
                                      (uint8_t *)&slot_hdr,
                                      sizeof(slot_hdr)) != 0) {
-            return -3;
+            return -1;
         }
 
-        if (slot_hdr.state == SLOT_STATE_ACTIVE) {
-            uintptr_t dst_addr = logfs_get_addr(logfs, dst_arena_id, dst_slot_id);
-            if (logfs_raw_copy_bytes(logfs,
-                                     src_addr,
-                                     sizeof(slot_hdr) + slot_hdr.obj_size,
-                                     dst_addr) != 0) {
-                /* Failed to copy all bytes */
-                return -4;
+        if (slot_hdr.state == SLOT_STATE_ACTIVE &&
+            slot_hdr.obj_id == obj_id &&
+            slot_hdr.obj_inst_id == obj_inst_id) {
+            slot_hdr.state = SLOT_STATE_OBSOLETE;
+            if (logfs->driver->write_data(logfs->flash_id,
+                                          slot_addr,
+                                          (uint8_t *)&slot_hdr,
+                                          sizeof(slot_hdr)) != 0) {
+                return -2;
             }
-            dst_slot_id++;
+            /* Only one version of an object instance is ever active */
+            return 0;
         }
-#ifdef PIOS_INCLUDE_WDG
-        PIOS_WDG_Clear();
-#endif
     }
 
-    /* Activate the destination arena */
-    if (logfs_activate_arena(logfs, dst_arena_id) != 0) {
-        return -5;
-    }
+    return 0;
+}
 
-    /* Unmount the source arena */
-    if (logfs_unmount_log(logfs) != 0) {
-        return -6;
-    }
+/* NOTE: Must be called while holding the flash transaction lock */
+static int32_t logfs_garbage_collect(struct logfs_state *logfs)
+{
+    PIOS_Assert(logfs->mounted);
 
-    /* Obsolete the source arena */
-    if (logfs_obsolete_arena(logfs, src_arena_id) != 0) {
-        return -7;
+    if (logfs->gc_state == LOGFS_GC_IDLE) {
+        logfs_compact_start(logfs);
     }
 
-    /* Mount the new arena */
-    if (logfs_mount_log(logfs, dst_arena_id) != 0) {
-        return -8;
+    /* Run any compaction already in progress in the background to completion */
+    while (logfs->gc_state != LOGFS_GC_IDLE) {
+        if (logfs_compact_step(logfs) != 0) {
+            return -1;
+        }
+#ifdef PIOS_INCLUDE_WDG
+        PIOS_WDG_Clear();
+#endif
     }
 
     return 0;
@@ -714,6 +992,25 @@ static int16_t logfs_object_find_next(const struct logfs_state *logfs, struct sl
         *curr_slot = 1;
     }
 
+    if (logfs->index_valid) {
+        /* The index knows every active slot, no need to scan the flash */
+        bool found;
+        uint16_t pos = logfs_index_search(logfs, obj_id, obj_inst_id, &found);
+        if (!found || logfs->index[pos].slot_id < *curr_slot) {
+            return -1;
+        }
+
+        uintptr_t slot_addr = logfs_get_addr(logfs, logfs->active_arena_id, logfs->index[pos].slot_id);
+        if (logfs->driver->read_data(logfs->flash_id,
+                                     slot_addr,
+                                     (uint8_t *)slot_hdr,
+                                     sizeof(*slot_hdr)) != 0) {
+            return -2;
+        }
+        *curr_slot = logfs->index[pos].slot_id;
+        return 0;
+    }
+
     for (uint16_t slot_id = *curr_slot;
          slot_id < (logfs->cfg->arena_size / logfs->cfg->slot_size);
          slot_id++) {
@@ -746,7 +1043,31 @@ static int16_t logfs_object_find_next(const struct logfs_state *logfs, struct sl
 }
 
 /* NOTE: Must be called while holding the flash transaction lock */
-/* OPTIMIZE: could trust that there is at most one active version of every object and terminate the search when we find one */
+static int8_t logfs_obsolete_slot(struct logfs_state *logfs, uint16_t slot_id, struct slot_header *slot_hdr)
+{
+    slot_hdr->state = SLOT_STATE_OBSOLETE;
+    uintptr_t slot_addr = logfs_get_addr(logfs, logfs->active_arena_id, slot_id);
+
+    if (logfs->driver->write_data(logfs->flash_id,
+                                  slot_addr,
+                                  (uint8_t *)slot_hdr,
+                                  sizeof(*slot_hdr)) != 0) {
+        return -1;
+    }
+    /* Object has been successfully obsoleted and is no longer active */
+    logfs->num_active_slots--;
+    if (logfs->gc_state == LOGFS_GC_COPYING && slot_id < logfs->gc_src_slot_id) {
+        /* The compaction already carried this slot over, drop the copy as well */
+        if (logfs_compact_obsolete_copy(logfs, slot_hdr->obj_id, slot_hdr->obj_inst_id) != 0) {
+            return -2;
+        }
+    }
+    logfs_index_remove(logfs, slot_hdr->obj_id, slot_hdr->obj_inst_id);
+
+    return 0;
+}
+
+/* NOTE: Must be called while holding the flash transaction lock */
 static int8_t logfs_delete_object(struct logfs_state *logfs, uint32_t obj_id, uint16_t obj_inst_id)
 {
     int8_t rc;
@@ -759,18 +1080,11 @@ static int8_t logfs_delete_object(struct logfs_state *logfs, uint32_t obj_id, ui
         switch (logfs_object_find_next(logfs, &slot_hdr, &curr_slot_id, obj_id, obj_inst_id)) {
         case 0:
             /* Found a matching slot.  Obsolete it. */
-            slot_hdr.state = SLOT_STATE_OBSOLETE;
-            uintptr_t slot_addr = logfs_get_addr(logfs, logfs->active_arena_id, curr_slot_id);
-
-            if (logfs->driver->write_data(logfs->flash_id,
-                                          slot_addr,
-                                          (uint8_t *)&slot_hdr,
-                                          sizeof(slot_hdr)) != 0) {
+            if (logfs_obsolete_slot(logfs, curr_slot_id, &slot_hdr) != 0) {
                 rc = -2;
                 goto out_exit;
             }
-            /* Object has been successfully obsoleted and is no longer active */
-            logfs->num_active_slots--;
+            /* A valid index holds at most one active version, the next lookup ends the search */
             break;
         case -1:
             /* Search completed, object not found */
@@ -845,22 +1159,19 @@ static int8_t logfs_reserve_free_slot(struct logfs_state *logfs, uint16_t *slot_
 }
 
 /* NOTE: Must be called while holding the flash transaction lock */
-static int8_t logfs_append_to_log(struct logfs_state *logfs, uint32_t obj_id, uint16_t obj_inst_id, uint8_t *obj_data, uint16_t obj_size)
+static int8_t logfs_write_to_log(struct logfs_state *logfs, uint16_t *slot_id, struct slot_header *slot_hdr, uint32_t obj_id, uint16_t obj_inst_id, uint8_t *obj_data, uint16_t obj_size)
 {
     /* Reserve a free slot for our new object */
-    uint16_t free_slot_id;
-    struct slot_header slot_hdr;
-
-    if (logfs_reserve_free_slot(logfs, &free_slot_id, &slot_hdr, obj_id, obj_inst_id, obj_size) != 0) {
+    if (logfs_reserve_free_slot(logfs, slot_id, slot_hdr, obj_id, obj_inst_id, obj_size) != 0) {
         /* Failed to reserve a free slot */
         return -1;
     }
 
     /* Compute slot address */
-    uintptr_t slot_addr   = logfs_get_addr(logfs, logfs->active_arena_id, free_slot_id);
+    uintptr_t slot_addr   = logfs_get_addr(logfs, logfs->active_arena_id, *slot_id);
 
     /* Write the data into the reserved slot, starting after the slot header */
-    uintptr_t slot_offset = sizeof(slot_hdr);
+    uintptr_t slot_offset = sizeof(*slot_hdr);
     while (obj_size > 0) {
         /* Individual writes must fit entirely within a single page buffer. */
         uint16_t page_remaining = logfs->cfg->page_size - (slot_offset % logfs->cfg->page_size);
@@ -879,18 +1190,238 @@ static int8_t logfs_append_to_log(struct logfs_state *logfs, uint32_t obj_id, ui
         obj_size    -= write_size;
     }
 
+    /* The slot stays reserved, and is ignored when mounting, until it is activated */
+    return 0;
+}
+
+/* NOTE: Must be called while holding the flash transaction lock */
+static int8_t logfs_activate_slot(struct logfs_state *logfs, uint16_t slot_id, struct slot_header *slot_hdr)
+{
+    uintptr_t slot_addr = logfs_get_addr(logfs, logfs->active_arena_id, slot_id);
+
     /* Mark this slot active in one atomic step */
-    slot_hdr.state = SLOT_STATE_ACTIVE;
+    slot_hdr->state = SLOT_STATE_ACTIVE;
     if (logfs->driver->write_data(logfs->flash_id,
                                   slot_addr,
-                                  (uint8_t *)&slot_hdr,
-                                  sizeof(slot_hdr)) != 0) {
+                                  (uint8_t *)slot_hdr,
+                                  sizeof(*slot_hdr)) != 0) {
         /* Failed to mark the slot active */
-        return -4;
+        return -1;
     }
 
     /* Object has been successfully written to the slot */
     logfs->num_active_slots++;
+    logfs_index_add(logfs, slot_hdr->obj_id, slot_hdr->obj_inst_id, slot_id);
+    return 0;
+}
+
+/* NOTE: Must be called while holding the flash transaction lock */
+static int8_t logfs_append_to_log(struct logfs_state *logfs, uint32_t obj_id, uint16_t obj_inst_id, uint8_t *obj_data, uint16_t obj_size)
+{
+    uint16_t free_slot_id;
+    struct slot_header slot_hdr;
+
+    if (logfs_write_to_log(logfs, &free_slot_id, &slot_hdr, obj_id, obj_inst_id, obj_data, obj_size) != 0) {
+        /* Failed to write the object data */
+        return -1;
+    }
+
+    if (logfs_activate_slot(logfs, free_slot_id, &slot_hdr) != 0) {
+        /* Failed to mark the slot active */
+        return -4;
+    }
+
+    return 0;
+}
+
+/* NOTE: Must be called while holding the flash transaction lock */
+static int8_t logfs_save_object(struct logfs_state *logfs, uint32_t obj_id, uint16_t obj_inst_id, uint8_t *obj_data, uint16_t obj_size)
+{
+    if (logfs_delete_object(logfs, obj_id, obj_inst_id) != 0) {
+        return -3;
+    }
+
+    /*
+     * All old versions of this object + instance have been invalidated.
+     * Write the new object.
+     */
+
+    /* Check if the arena is entirely full. */
+    if (logfs_fs_is_full(logfs)) {
+        /* Note: Filesystem Full means we're full of *active* records so gc won't help at all. */
+        return -4;
+    }
+
+    /* Is garbage collection required? */
+    if (logfs_log_is_full(logfs)) {
+        /* Note: Log Full means the log is full but may contain obsolete slots so gc may free some space */
+        /* Note: This also finishes any background compaction that did not keep up with the saves */
+        if (logfs_garbage_collect(logfs) != 0) {
+            return -5;
+        }
+        /* Check one more time just to be sure we actually free'd some space */
+        if (logfs_log_is_full(logfs)) {
+            /*
+             * Log is still full even after gc!
+             * NOTE: This should not happen since the filesystem wasn't full
+             *       when we checked above so gc should have helped.
+             */
+            PIOS_DEBUG_Assert(0);
+            return -6;
+        }
+    }
+
+    /* We have room for our new object.  Append it to the log. */
+    if (logfs_append_to_log(logfs, obj_id, obj_inst_id, obj_data, obj_size) != 0) {
+        /* Error during append */
+        return -7;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Position of an object instance in the pending batch
+ * @return position of the entry if found, else batch_used
+ */
+static uint16_t logfs_batch_search(const struct logfs_state *logfs, uint32_t obj_id, uint16_t obj_inst_id)
+{
+    uint16_t pos;
+
+    for (pos = 0; pos < logfs->batch_used; pos++) {
+        if (logfs->batch[pos].obj_id == obj_id && logfs->batch[pos].obj_inst_id == obj_inst_id) {
+            break;
+        }
+    }
+    return pos;
+}
+
+/**
+ * @brief Replaces the previous versions of all objects in the batch with the reserved slots
+ * @return 0 if success, < 0 on failure
+ * @note The old versions are obsoleted first, in one scan of the log unless the index
+ *       can find them directly, then the new slots are activated in log order. A reset
+ *       in between loses the batched objects just like an interrupted PIOS_FLASHFS_ObjSave.
+ * @note Must be called while holding the flash transaction lock
+ */
+static int8_t logfs_batch_flush(struct logfs_state *logfs)
+{
+    int8_t rc;
+
+    if (logfs->index_valid) {
+        for (uint16_t i = 0; i < logfs->batch_used; i++) {
+            if (logfs_delete_object(logfs, logfs->batch[i].obj_id, logfs->batch[i].obj_inst_id) != 0) {
+                rc = -1;
+                goto out_exit;
+            }
+        }
+    } else {
+        /* Reserved slots are skipped, only active ones can be previous versions */
+        for (uint16_t slot_id = 1;
+             slot_id < (logfs->cfg->arena_size / logfs->cfg->slot_size) - logfs->num_free_slots;
+             slot_id++) {
+            struct slot_header slot_hdr;
+            uintptr_t slot_addr = logfs_get_addr(logfs, logfs->active_arena_id, slot_id);
+            if (logfs->driver->read_data(logfs->flash_id,
+                                         slot_addr,
+                                         (uint8_t *)&slot_hdr,
+                                         sizeof(slot_hdr)) != 0) {
+                rc = -1;
+                goto out_exit;
+            }
+            if (slot_hdr.state == SLOT_STATE_ACTIVE &&
+                logfs_batch_search(logfs, slot_hdr.obj_id, slot_hdr.obj_inst_id) < logfs->batch_used) {
+                if (logfs_obsolete_slot(logfs, slot_id, &slot_hdr) != 0) {
+                    rc = -1;
+                    goto out_exit;
+                }
+            }
+#ifdef PIOS_INCLUDE_WDG
+            PIOS_WDG_Clear();
+#endif
+        }
+    }
+
+    for (uint16_t i = 0; i < logfs->batch_used; i++) {
+        struct slot_header slot_hdr;
+        uintptr_t slot_addr = logfs_get_addr(logfs, logfs->active_arena_id, logfs->batch[i].slot_id);
+        if (logfs->driver->read_data(logfs->flash_id,
+                                     slot_addr,
+                                     (uint8_t *)&slot_hdr,
+                                     sizeof(slot_hdr)) != 0) {
+            rc = -2;
+            goto out_exit;
+        }
+        if (logfs_activate_slot(logfs, logfs->batch[i].slot_id, &slot_hdr) != 0) {
+            rc = -2;
+            goto out_exit;
+        }
+    }
+
+    rc = 0;
+
+out_exit:
+    /* Whatever was not activated stays reserved and is dropped by the next compaction */
+    logfs->batch_used = 0;
+    return rc;
+}
+
+/* NOTE: Must be called while holding the flash transaction lock */
+static int8_t logfs_batch_save(struct logfs_state *logfs, uint32_t obj_id, uint16_t obj_inst_id, uint8_t *obj_data, uint16_t obj_size)
+{
+    if (!logfs->batch) {
+        /* No room to remember the reserved slots, write through */
+        return logfs_save_object(logfs, obj_id, obj_inst_id, obj_data, obj_size) == 0 ? 0 : -2;
+    }
+
+    uint16_t pos = logfs_batch_search(logfs, obj_id, obj_inst_id);
+
+    if (logfs_log_is_full(logfs)) {
+        /* The compaction only carries over active slots, commit what we have before it runs */
+        if (logfs_batch_flush(logfs) != 0) {
+            return -1;
+        }
+        return logfs_save_object(logfs, obj_id, obj_inst_id, obj_data, obj_size) == 0 ? 0 : -2;
+    }
+
+    if (pos == logfs->cfg->batch_size) {
+        /* Batch is full, commit it and start over */
+        if (logfs_batch_flush(logfs) != 0) {
+            return -1;
+        }
+        pos = 0;
+    }
+
+    uint16_t slot_id;
+    struct slot_header slot_hdr;
+    if (logfs_write_to_log(logfs, &slot_id, &slot_hdr, obj_id, obj_inst_id, obj_data, obj_size) != 0) {
+        return -2;
+    }
+
+    if (pos < logfs->batch_used) {
+        /* Saved twice in the same batch, the earlier reserved slot is never activated */
+        struct slot_header old_hdr;
+        uintptr_t slot_addr = logfs_get_addr(logfs, logfs->active_arena_id, logfs->batch[pos].slot_id);
+        if (logfs->driver->read_data(logfs->flash_id,
+                                     slot_addr,
+                                     (uint8_t *)&old_hdr,
+                                     sizeof(old_hdr)) != 0) {
+            return -2;
+        }
+        old_hdr.state = SLOT_STATE_OBSOLETE;
+        if (logfs->driver->write_data(logfs->flash_id,
+                                      slot_addr,
+                                      (uint8_t *)&old_hdr,
+                                      sizeof(old_hdr)) != 0) {
+            return -2;
+        }
+    } else {
+        logfs->batch[pos].obj_id      = obj_id;
+        logfs->batch[pos].obj_inst_id = obj_inst_id;
+        logfs->batch_used++;
+    }
+    logfs->batch[pos].slot_id = slot_id;
+
     return 0;
 }
 
@@ -936,57 +1467,111 @@ int32_t PIOS_FLASHFS_ObjSave(uintptr_t fs_id, uint32_t obj_id, uint16_t obj_inst
         goto out_exit;
     }
 
-    if (logfs_delete_object(logfs, obj_id, obj_inst_id) != 0) {
-        rc = -3;
-        goto out_end_trans;
+    /* 0 if the object was successfully written to the log */
+    rc = logfs_save_object(logfs, obj_id, obj_inst_id, obj_data, obj_size);
+
+    logfs->driver->end_transaction(logfs->flash_id);
+
+out_exit:
+    return rc;
+}
+
+/**
+ * @brief Starts a batch of saves that are committed together
+ * @param[in] fs_id The filesystem to use for this action
+ * @return 0 if success or error code
+ * @retval -1 if fs_id is not a valid filesystem instance
+ * @retval -2 if failed to start transaction
+ * @note The flash transaction is held until PIOS_FLASHFS_BatchCommit, the calling
+ *       task must not use any other PIOS_FLASHFS_* function on this filesystem meanwhile
+ *       and other tasks wait for the commit.
+ */
+int32_t PIOS_FLASHFS_BatchBegin(uintptr_t fs_id)
+{
+    struct logfs_state *logfs = (struct logfs_state *)fs_id;
+
+    if (!PIOS_FLASHFS_Logfs_validate(logfs)) {
+        return -1;
     }
 
-    /*
-     * All old versions of this object + instance have been invalidated.
-     * Write the new object.
-     */
+    if (logfs->driver->start_transaction(logfs->flash_id) != 0) {
+        return -2;
+    }
 
-    /* Check if the arena is entirely full. */
-    if (logfs_fs_is_full(logfs)) {
-        /* Note: Filesystem Full means we're full of *active* records so gc won't help at all. */
-        rc = -4;
-        goto out_end_trans;
+    PIOS_Assert(!logfs->batch_open);
+    logfs->batch_open = true;
+    logfs->batch_used = 0;
+
+    return 0;
+}
+
+/**
+ * @brief Writes one object instance ahead of the commit of the current batch
+ * @param[in] fs_id The filesystem to use for this action
+ * @param[in] obj UAVObject ID of the object to save
+ * @param[in] obj_inst_id The instance number of the object being saved
+ * @param[in] obj_data Contents of the object being saved
+ * @param[in] obj_size Size of the object being saved
+ * @return 0 if success or error code
+ * @retval -1 if fs_id is not a valid filesystem instance
+ * @retval -2 if no batch was started with PIOS_FLASHFS_BatchBegin
+ * @retval -3 if committing the earlier saves of a full batch failed
+ * @retval -4 if writing the new object to the filesystem failed
+ * @note The data is written to a reserved slot right away, the previous version
+ *       stays active until the commit. Batches larger than cfg->batch_size are
+ *       committed in chunks, as is everything saved before the log fills up.
+ */
+int32_t PIOS_FLASHFS_BatchSave(uintptr_t fs_id, uint32_t obj_id, uint16_t obj_inst_id, uint8_t *obj_data, uint16_t obj_size)
+{
+    struct logfs_state *logfs = (struct logfs_state *)fs_id;
+
+    if (!PIOS_FLASHFS_Logfs_validate(logfs)) {
+        return -1;
     }
 
-    /* Is garbage collection required? */
-    if (logfs_log_is_full(logfs)) {
-        /* Note: Log Full means the log is full but may contain obsolete slots so gc may free some space */
-        if (logfs_garbage_collect(logfs) != 0) {
-            rc = -5;
-            goto out_end_trans;
-        }
-        /* Check one more time just to be sure we actually free'd some space */
-        if (logfs_log_is_full(logfs)) {
-            /*
-             * Log is still full even after gc!
-             * NOTE: This should not happen since the filesystem wasn't full
-             *       when we checked above so gc should have helped.
-             */
-            PIOS_DEBUG_Assert(0);
-            rc = -6;
-            goto out_end_trans;
-        }
+    PIOS_Assert(obj_size <= (logfs->cfg->slot_size - sizeof(struct slot_header)));
+
+    if (!logfs->batch_open) {
+        return -2;
     }
 
-    /* We have room for our new object.  Append it to the log. */
-    if (logfs_append_to_log(logfs, obj_id, obj_inst_id, obj_data, obj_size) != 0) {
-        /* Error during append */
-        rc = -7;
-        goto out_end_trans;
+    switch (logfs_batch_save(logfs, obj_id, obj_inst_id, obj_data, obj_size)) {
+    case 0:
+        return 0;
+    case -1:
+        return -3;
+    default:
+        return -4;
     }
+}
 
-    /* Object successfully written to the log */
-    rc = 0;
+/**
+ * @brief Activates all objects saved since PIOS_FLASHFS_BatchBegin
+ * @param[in] fs_id The filesystem to use for this action
+ * @return 0 if success or error code
+ * @retval -1 if fs_id is not a valid filesystem instance
+ * @retval -2 if no batch was started with PIOS_FLASHFS_BatchBegin
+ * @retval -3 if committing the batch failed
+ */
+int32_t PIOS_FLASHFS_BatchCommit(uintptr_t fs_id)
+{
+    int32_t rc;
 
-out_end_trans:
+    struct logfs_state *logfs = (struct logfs_state *)fs_id;
+
+    if (!PIOS_FLASHFS_Logfs_validate(logfs)) {
+        return -1;
+    }
+
+    if (!logfs->batch_open) {
+        return -2;
+    }
+
+    rc = (logfs_batch_flush(logfs) == 0) ? 0 : -3;
+
+    logfs->batch_open = false;
     logfs->driver->end_transaction(logfs->flash_id);
 
-out_exit:
     return rc;
 }
 
@@ -1158,6 +1743,69 @@ out_end_trans:
 out_exit:
     return rc;
 }
+/**
+ * @brief Compacts the filesystem in the background, a few slots at a time
+ * @param[in] fs_id The filesystem to use for this action
+ * @param[in] max_slots Maximum number of log slots to look at in this call
+ * @return 0 if no compaction is in progress, 1 if more calls are needed, or error code
+ * @retval -1 if fs_id is not a valid filesystem instance
+ * @retval -2 if failed to start transaction
+ * @retval -3 if a compaction step failed
+ * @note A compaction is started once fewer than gc_headroom slots are free,
+ *       which keeps the garbage collection out of PIOS_FLASHFS_ObjSave.
+ *       Erasing the destination arena takes one call per sector regardless of max_slots.
+ */
+int32_t PIOS_FLASHFS_Compact(uintptr_t fs_id, uint16_t max_slots)
+{
+    int32_t rc;
+
+    struct logfs_state *logfs = (struct logfs_state *)fs_id;
+
+    if (!PIOS_FLASHFS_Logfs_validate(logfs)) {
+        rc = -1;
+        goto out_exit;
+    }
+
+    if (!logfs->mounted ||
+        (logfs->gc_state == LOGFS_GC_IDLE && !logfs_compact_wanted(logfs))) {
+        /* Nothing to do, don't bother taking the flash */
+        rc = 0;
+        goto out_exit;
+    }
+
+    if (logfs->driver->start_transaction(logfs->flash_id) != 0) {
+        rc = -2;
+        goto out_exit;
+    }
+
+    if (logfs->gc_state == LOGFS_GC_IDLE) {
+        logfs_compact_start(logfs);
+    }
+
+    if (logfs->gc_state == LOGFS_GC_ERASING) {
+        /* Sector erases are slow, one per call */
+        if (logfs_compact_step(logfs) != 0) {
+            rc = -3;
+            goto out_end_trans;
+        }
+    } else {
+        for (uint16_t i = 0; i < max_slots && logfs->gc_state == LOGFS_GC_COPYING; i++) {
+            if (logfs_compact_step(logfs) != 0) {
+                rc = -3;
+                goto out_end_trans;
+            }
+        }
+    }
+
+    rc = (logfs->gc_state == LOGFS_GC_IDLE) ? 0 : 1;
+
+out_end_trans:
+    logfs->driver->end_transaction(logfs->flash_id);
+
+out_exit:
+    return rc;
+}
+
 /**
  * @brief Returs stats for the filesystems
  * @param[in] fs_id The filesystem to use for this action
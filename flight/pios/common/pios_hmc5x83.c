@@ -46,6 +46,7 @@ typedef struct {
     uint8_t  slave_num;
     uint8_t  CTRLB;
     volatile bool data_ready;
+    PIOS_SENSORS_Instance *sensor; // set once registered with the sensor subsystem
 } pios_hmc5x83_dev_data_t;
 
 static int32_t PIOS_HMC5x83_Config(pios_hmc5x83_dev_data_t *dev);
@@ -65,6 +66,9 @@ const PIOS_SENSORS_Driver PIOS_HMC5x83_Driver = {
     .get_queue = NULL,
     .get_scale = PIOS_HMC5x83_driver_get_scale,
     .is_polled = true,
+#ifdef PIOS_HMC5X83_HAS_GPIOS
+    .is_event_driven = true,
+#endif
 };
 /**
  * Allocate the device setting structure
@@ -117,7 +121,9 @@ pios_hmc5x83_dev_t PIOS_HMC5x83_Init(const struct pios_hmc5x83_cfg *cfg, uint32_
 
 void PIOS_HMC5x83_Register(pios_hmc5x83_dev_t handler)
 {
-    PIOS_SENSORS_Register(&PIOS_HMC5x83_Driver, PIOS_SENSORS_TYPE_3AXIS_MAG, handler);
+    pios_hmc5x83_dev_data_t *dev = dev_validate(handler);
+
+    dev->sensor = PIOS_SENSORS_Register(&PIOS_HMC5x83_Driver, PIOS_SENSORS_TYPE_3AXIS_MAG, handler);
 }
 
 /**
@@ -443,6 +449,9 @@ bool PIOS_HMC5x83_IRQHandler(pios_hmc5x83_dev_t handler)
     pios_hmc5x83_dev_data_t *dev = dev_validate(handler);
 
     dev->data_ready = true;
+    if (dev->sensor) {
+        PIOS_SENSORS_DataReadyFromISR(dev->sensor);
+    }
     return false;
 }
 
@@ -625,6 +634,7 @@ void PIOS_HMC5x83_driver_get_scale(float *scales, uint8_t size, __attribute__((u
 void PIOS_HMC5x83_driver_fetch(void *data, uint8_t size, uintptr_t context)
 {
     PIOS_Assert(size > 0);
+    pios_hmc5x83_dev_data_t *dev = dev_validate((pios_hmc5x83_dev_t)context);
     int16_t mag[3];
     PIOS_HMC5x83_ReadMag((pios_hmc5x83_dev_t)context, mag);
     PIOS_SENSORS_3Axis_SensorsWithTemp *tmp = data;
@@ -633,6 +643,7 @@ void PIOS_HMC5x83_driver_fetch(void *data, uint8_t size, uintptr_t context)
     tmp->sample[0].y = mag[1];
     tmp->sample[0].z = mag[2];
     tmp->temperature = 0;
+    tmp->timestamp   = dev->sensor ? PIOS_SENSORS_GetDataReadyTime(dev->sensor) : 0;
 }
 
 bool PIOS_HMC5x83_driver_poll(uintptr_t context)
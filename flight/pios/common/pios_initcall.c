@@ -0,0 +1,81 @@
+/**
+ ******************************************************************************
+ * @addtogroup OpenPilotSystem OpenPilot System
+ * @{
+ * @addtogroup OpenPilotLibraries OpenPilot System Libraries
+ * @{
+ * @file       pios_initcall.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @brief      Boot time profile of the module initcalls
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include <pios.h>
+
+#ifdef PIOS_INCLUDE_INITCALL_PROFILE
+
+// Written by the init and System tasks one after the other, read once the boot is over
+static struct pios_initcall_profile profile;
+static uint32_t bootRaw;
+
+/**
+ * Set the time origin of the profile, as early as possible after PIOS_DELAY_Init()
+ */
+void PIOS_INITCALL_ProfileBoot(void)
+{
+    bootRaw = PIOS_DELAY_GetRaw();
+}
+
+/**
+ * Record the duration of a boot phase which started at raw_start (PIOS_DELAY_GetRaw())
+ */
+void PIOS_INITCALL_ProfilePhase(enum pios_initcall_phase phase, uint32_t raw_start)
+{
+    uint32_t now = PIOS_DELAY_GetRaw();
+
+    profile.phase_us[phase]     = PIOS_DELAY_DiffuS2(raw_start, now);
+    profile.phase_end_us[phase] = PIOS_DELAY_DiffuS2(bootRaw, now);
+}
+
+/**
+ * Record the duration of the module init (task false) or start (task true) function of fn
+ */
+void PIOS_INITCALL_ProfileCall(const initmodule_t *fn, bool task, uint32_t raw_start)
+{
+    uint32_t index = fn - __module_initcall_start;
+
+    if (index < PIOS_INITCALL_PROFILE_MAX) {
+        uint32_t *times = task ? profile.tinit_us : profile.minit_us;
+        times[index] = PIOS_DELAY_DiffuS(raw_start);
+    }
+}
+
+/**
+ * Get the profile, complete once MODULE_INITIALISE_DEFERRED has run
+ */
+const struct pios_initcall_profile *PIOS_INITCALL_GetProfile(void)
+{
+    return &profile;
+}
+
+#endif /* PIOS_INCLUDE_INITCALL_PROFILE */
+
+/**
+ * @}
+ * @}
+ */
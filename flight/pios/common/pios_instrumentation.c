@@ -30,6 +30,12 @@ pios_perf_counter_t *pios_instrumentation_perf_counters = NULL;
 int8_t pios_instrumentation_max_counters = -1;
 int8_t pios_instrumentation_last_used_counter = -1;
 
+pios_trace_event_t *pios_instrumentation_trace = NULL;
+uint16_t pios_instrumentation_trace_mask  = 0;
+uint16_t pios_instrumentation_trace_head  = 0;
+uint16_t pios_instrumentation_trace_count = 0;
+bool pios_instrumentation_trace_enabled   = false;
+
 void PIOS_Instrumentation_Init(int8_t maxCounters)
 {
     PIOS_Assert(maxCounters >= 0);
@@ -80,3 +86,55 @@ void PIOS_Instrumentation_ForEachCounter(InstrumentationCounterCallback callback
         callback(counter, index, context);
     }
 }
+
+void PIOS_Instrumentation_InitTrace(uint16_t length)
+{
+    uint16_t size = 1;
+
+    if (pios_instrumentation_trace || length < 2) {
+        return;
+    }
+    // round down to a power of two so the ring index can be masked
+    while ((uint32_t)size * 2 <= length) {
+        size *= 2;
+    }
+    pios_instrumentation_trace = (pios_trace_event_t *)pvPortMalloc(sizeof(pios_trace_event_t) * size);
+    if (!pios_instrumentation_trace) {
+        return;
+    }
+    pios_instrumentation_trace_mask  = size - 1;
+    pios_instrumentation_trace_head  = 0;
+    pios_instrumentation_trace_count = 0;
+}
+
+void PIOS_Instrumentation_EnableTrace(bool enable)
+{
+    if (!pios_instrumentation_trace) {
+        return;
+    }
+    vPortEnterCritical();
+    if (enable && !pios_instrumentation_trace_enabled) {
+        pios_instrumentation_trace_head  = 0;
+        pios_instrumentation_trace_count = 0;
+    }
+    pios_instrumentation_trace_enabled = enable;
+    vPortExitCritical();
+}
+
+uint16_t PIOS_Instrumentation_ReadTrace(pios_trace_event_t *events, uint16_t maxEvents)
+{
+    uint16_t read = 0;
+
+    if (!pios_instrumentation_trace) {
+        return 0;
+    }
+    vPortEnterCritical();
+    uint16_t tail = (pios_instrumentation_trace_head - pios_instrumentation_trace_count) & pios_instrumentation_trace_mask;
+    while (read < maxEvents && pios_instrumentation_trace_count) {
+        events[read++] = pios_instrumentation_trace[tail];
+        tail = (tail + 1) & pios_instrumentation_trace_mask;
+        pios_instrumentation_trace_count--;
+    }
+    vPortExitCritical();
+    return read;
+}
@@ -294,6 +294,62 @@ int32_t PIOS_FLASHFS_GetStats(
     return 0;
 }
 
+/**
+ * @brief Compacts the filesystem in the background, a few slots at a time
+ * @param[in] fs_id The filesystem to use for this action
+ * @param[in] max_slots Maximum number of log slots to look at in this call
+ * @return 0 if no compaction is in progress, 1 if more calls are needed, or error code
+ */
+int32_t PIOS_FLASHFS_Compact(
+    __attribute__((unused)) uintptr_t fs_id,
+    __attribute__((unused)) uint16_t max_slots)
+{
+    // yaffs does its own garbage collection
+    return 0;
+}
+
+/**
+ * @brief Starts a batch of saves that are committed together
+ * @param[in] fs_id The filesystem to use for this action
+ * @return 0 if success or error code
+ */
+int32_t PIOS_FLASHFS_BatchBegin(
+    __attribute__((unused)) uintptr_t fs_id)
+{
+    // every save is its own yaffs file, nothing to batch
+    return 0;
+}
+
+/**
+ * @brief Writes one object instance ahead of the commit of the current batch
+ * @param[in] fs_id The filesystem to use for this action
+ * @param[in] obj UAVObject ID of the object to save
+ * @param[in] obj_inst_id The instance number of the object being saved
+ * @param[in] obj_data Contents of the object being saved
+ * @param[in] obj_size Size of the object being saved
+ * @return 0 if success or error code
+ */
+int32_t PIOS_FLASHFS_BatchSave(
+    uintptr_t fs_id,
+    uint32_t obj_id,
+    uint16_t obj_inst_id,
+    uint8_t *obj_data,
+    uint16_t obj_size)
+{
+    return PIOS_FLASHFS_ObjSave(fs_id, obj_id, obj_inst_id, obj_data, obj_size);
+}
+
+/**
+ * @brief Activates all objects saved since PIOS_FLASHFS_BatchBegin
+ * @param[in] fs_id The filesystem to use for this action
+ * @return 0 if success or error code
+ */
+int32_t PIOS_FLASHFS_BatchCommit(
+    __attribute__((unused)) uintptr_t fs_id)
+{
+    return 0;
+}
+
 
 /**
  * @}
@@ -0,0 +1,127 @@
+/**
+ ******************************************************************************
+ * @addtogroup PIOS PIOS Core hardware abstraction layer
+ * @{
+ * @addtogroup PIOS_MEMPOOL Fixed size block pool
+ * @brief Constant time allocation of fixed size blocks
+ * @{
+ *
+ * @file       pios_mempool.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @brief      Fixed size block pool
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include <pios_mem.h>
+#include <pios_mempool.h>
+
+/**
+ * Allocate the storage of a pool and link all its blocks in the free list.
+ * \param[in] pool The pool
+ * \param[in] block_size Size of each block in bytes
+ * \param[in] num_blocks Number of blocks, may be zero to always use the heap
+ * \param[in] fast Allocate the storage and the overflow blocks from the fast heap
+ * \return 0 on success, -1 if the storage could not be allocated
+ */
+int32_t PIOS_MEMPOOL_Init(struct pios_mempool *pool, size_t block_size, uint16_t num_blocks, bool fast)
+{
+    // Blocks hold the free list link and stay word aligned
+    if (block_size < sizeof(void *)) {
+        block_size = sizeof(void *);
+    }
+    block_size = (block_size + sizeof(void *) - 1) & ~(sizeof(void *) - 1);
+
+    pool->free_list  = NULL;
+    pool->storage    = NULL;
+    pool->block_size = block_size;
+    pool->num_blocks = num_blocks;
+    pool->used       = 0;
+    pool->max_used   = 0;
+    pool->overflows  = 0;
+    pool->fast       = fast;
+
+    if (num_blocks == 0) {
+        return 0;
+    }
+
+    pool->storage = (uint8_t *)(fast ? pios_fastheapmalloc(block_size * num_blocks) : pios_malloc(block_size * num_blocks));
+    if (pool->storage == NULL) {
+        pool->num_blocks = 0;
+        return -1;
+    }
+
+    // Link the blocks in address order
+    for (uint16_t i = num_blocks; i > 0; i--) {
+        void **block = (void **)(pool->storage + (i - 1) * block_size);
+        *block = pool->free_list;
+        pool->free_list = block;
+    }
+
+    return 0;
+}
+
+/**
+ * Allocate a block, from the heap if the pool is empty.
+ * \param[in] pool The pool
+ * \return The block, or NULL if the pool is empty and the heap allocation failed
+ */
+void *PIOS_MEMPOOL_Alloc(struct pios_mempool *pool)
+{
+    void *block = pool->free_list;
+
+    if (block) {
+        pool->free_list = *(void **)block;
+    } else {
+        block = pool->fast ? pios_fastheapmalloc(pool->block_size) : pios_malloc(pool->block_size);
+        if (block == NULL) {
+            return NULL;
+        }
+        pool->overflows++;
+    }
+
+    if (++pool->used > pool->max_used) {
+        pool->max_used = pool->used;
+    }
+    return block;
+}
+
+/**
+ * Give a block back to the pool, or to the heap if it was an overflow allocation.
+ * \param[in] pool The pool
+ * \param[in] block The block, as returned by PIOS_MEMPOOL_Alloc()
+ */
+void PIOS_MEMPOOL_Free(struct pios_mempool *pool, void *block)
+{
+    if (block == NULL) {
+        return;
+    }
+
+    pool->used--;
+    if ((uint8_t *)block >= pool->storage && (uint8_t *)block < pool->storage + pool->block_size * pool->num_blocks) {
+        *(void **)block = pool->free_list;
+        pool->free_list = block;
+    } else {
+        pios_free(block);
+    }
+}
+
+/**
+ * @}
+ * @}
+ */
@@ -57,6 +57,18 @@ const PIOS_SENSORS_Driver PIOS_MPU6000_Driver = {
     .get_scale = PIOS_MPU6000_driver_get_scale,
     .is_polled = false,
 };
+
+// same driver, used when samples are read from the chip FIFO in bursts
+const PIOS_SENSORS_Driver PIOS_MPU6000_BurstDriver = {
+    .test      = PIOS_MPU6000_driver_Test,
+    .poll      = NULL,
+    .fetch     = NULL,
+    .reset     = PIOS_MPU6000_driver_Reset,
+    .get_queue = PIOS_MPU6000_driver_get_queue,
+    .get_scale = PIOS_MPU6000_driver_get_scale,
+    .is_polled = false,
+    .is_burst  = true,
+};
 //
 
 
@@ -73,6 +85,11 @@ struct mpu6000_dev {
 
 #define PIOS_MPU6000_SAMPLES_BYTES    14
 #define PIOS_MPU6000_SENSOR_FIRST_REG PIOS_MPU6000_ACCEL_X_OUT_MSB
+#define PIOS_MPU6000_FIFO_SIZE        1024
+// accel, temperature and gyro end up in the FIFO in register order, same layout as a direct read
+#define PIOS_MPU6000_FIFO_STORE_ALL \
+    (PIOS_MPU6000_ACCEL_OUT | PIOS_MPU6000_FIFO_TEMP_OUT | PIOS_MPU6000_FIFO_GYRO_X_OUT | PIOS_MPU6000_FIFO_GYRO_Y_OUT | PIOS_MPU6000_FIFO_GYRO_Z_OUT)
+#define PIOS_MPU6000_BURST_BYTES      (1 + PIOS_MPU6000_SAMPLES_BYTES * PIOS_SENSORS_MAX_BURST)
 
 typedef union {
     uint8_t buffer[1 + PIOS_MPU6000_SAMPLES_BYTES];
@@ -95,7 +112,7 @@ typedef union {
     } data;
 } mpu6000_data_t;
 
-#define GET_SENSOR_DATA(mpudataptr, sensor) (mpudataptr.data.sensor##_h << 8 | mpudataptr.data.sensor##_l)
+#define GET_SENSOR_DATA(mpudataptr, sensor) (mpudataptr->data.sensor##_h << 8 | mpudataptr->data.sensor##_l)
 
 // ! Global structure for this device device
 static struct mpu6000_dev *dev;
@@ -104,6 +121,13 @@ static mpu6000_data_t mpu6000_data;
 static PIOS_SENSORS_3Axis_SensorsWithTemp *queue_data = 0;
 #define SENSOR_COUNT     2
 #define SENSOR_DATA_SIZE (sizeof(PIOS_SENSORS_3Axis_SensorsWithTemp) + sizeof(Vector3i16) * SENSOR_COUNT)
+#define BURST_DATA_SIZE  (sizeof(PIOS_SENSORS_3Axis_SensorsBurstWithTemp) + sizeof(Vector3i16) * SENSOR_COUNT * PIOS_SENSORS_MAX_BURST)
+// FIFO burst mode buffers, only allocated when enabled in the configuration
+static PIOS_SENSORS_3Axis_SensorsBurstWithTemp *burst_data = 0;
+static uint8_t *fifo_buffer = 0;
+static uint8_t fifo_pending = 0;
+// time of the last data ready interrupt, that is the capture time of the newest sample
+static uint32_t drdy_time = 0;
 // ! Private functions
 static struct mpu6000_dev *PIOS_MPU6000_alloc(const struct pios_mpu6000_cfg *cfg);
 static int32_t PIOS_MPU6000_Validate(struct mpu6000_dev *dev);
@@ -113,12 +137,20 @@ static int32_t PIOS_MPU6000_GetReg(uint8_t address);
 static void PIOS_MPU6000_SetSpeed(const bool fast);
 static bool PIOS_MPU6000_HandleData();
 static bool PIOS_MPU6000_ReadSensor(bool *woken);
+static int16_t PIOS_MPU6000_ConvertSample(const mpu6000_data_t *data, Vector3i16 *accel, Vector3i16 *gyro);
+static bool PIOS_MPU6000_ReadFifo(bool *woken);
+static bool PIOS_MPU6000_HandleFifoData(uint16_t samples);
+static void PIOS_MPU6000_ResetFifoISR(bool *woken);
 
 static int32_t PIOS_MPU6000_Test(void);
 
 void PIOS_MPU6000_Register()
 {
-    PIOS_SENSORS_Register(&PIOS_MPU6000_Driver, PIOS_SENSORS_TYPE_3AXIS_GYRO_ACCEL, 0);
+    if (dev && burst_data) {
+        PIOS_SENSORS_Register(&PIOS_MPU6000_BurstDriver, PIOS_SENSORS_TYPE_3AXIS_GYRO_ACCEL, 0);
+    } else {
+        PIOS_SENSORS_Register(&PIOS_MPU6000_Driver, PIOS_SENSORS_TYPE_3AXIS_GYRO_ACCEL, 0);
+    }
 }
 /**
  * @brief Allocate a new device
@@ -132,6 +164,19 @@ static struct mpu6000_dev *PIOS_MPU6000_alloc(const struct pios_mpu6000_cfg *cfg
 
     mpu6000_dev->magic = PIOS_MPU6000_DEV_MAGIC;
 
+    if (cfg->fifo_burst > 1) {
+        PIOS_Assert(cfg->fifo_burst <= PIOS_SENSORS_MAX_BURST);
+        // each queue entry carries a whole burst
+        mpu6000_dev->queue = xQueueCreate(cfg->max_downsample / cfg->fifo_burst + 2, BURST_DATA_SIZE);
+        PIOS_Assert(mpu6000_dev->queue);
+
+        burst_data  = (PIOS_SENSORS_3Axis_SensorsBurstWithTemp *)pios_malloc(BURST_DATA_SIZE);
+        fifo_buffer = (uint8_t *)pios_malloc(PIOS_MPU6000_BURST_BYTES);
+        PIOS_Assert(burst_data && fifo_buffer);
+        burst_data->count = SENSOR_COUNT;
+        return mpu6000_dev;
+    }
+
     mpu6000_dev->queue = xQueueCreate(cfg->max_downsample + 1, SENSOR_DATA_SIZE);
     PIOS_Assert(mpu6000_dev->queue);
 
@@ -229,15 +274,17 @@ static void PIOS_MPU6000_Config(struct pios_mpu6000_cfg const *cfg)
         ;
     }
 
-    // FIFO storage
-    while (PIOS_MPU6000_SetReg(PIOS_MPU6000_FIFO_EN_REG, cfg->Fifo_store) != 0) {
+    // FIFO storage, burst mode needs every sensor in the FIFO
+    while (PIOS_MPU6000_SetReg(PIOS_MPU6000_FIFO_EN_REG, burst_data ? PIOS_MPU6000_FIFO_STORE_ALL : cfg->Fifo_store) != 0) {
         ;
     }
     PIOS_MPU6000_ConfigureRanges(cfg->gyro_range, cfg->accel_range, cfg->filter);
     // Interrupt configuration
-    while (PIOS_MPU6000_SetReg(PIOS_MPU6000_USER_CTRL_REG, cfg->User_ctl) != 0) {
+    while (PIOS_MPU6000_SetReg(PIOS_MPU6000_USER_CTRL_REG,
+                               burst_data ? (cfg->User_ctl | PIOS_MPU6000_USERCTL_FIFO_EN | PIOS_MPU6000_USERCTL_FIFO_RST) : cfg->User_ctl) != 0) {
         ;
     }
+    fifo_pending = 0;
 
     // Interrupt configuration
     while (PIOS_MPU6000_SetReg(PIOS_MPU6000_PWR_MGMT_REG, cfg->Pwr_mgmt_clk) != 0) {
@@ -545,6 +592,17 @@ bool PIOS_MPU6000_IRQHandler(void)
     if (!mpu6000_configured) {
         return false;
     }
+    drdy_time = PIOS_DELAY_GetRaw();
+
+    if (burst_data) {
+        // samples pile up in the chip FIFO, fetch them once a whole burst is available
+        if (++fifo_pending < dev->cfg->fifo_burst) {
+            return false;
+        }
+        fifo_pending = 0;
+        PIOS_MPU6000_ReadFifo(&woken);
+        return woken;
+    }
 
     bool read_ok = false;
     read_ok = PIOS_MPU6000_ReadSensor(&woken);
@@ -557,12 +615,15 @@ bool PIOS_MPU6000_IRQHandler(void)
     return woken;
 }
 
-static bool PIOS_MPU6000_HandleData()
+/**
+ * @brief Convert one raw sample to OP convention
+ * @param[in] data raw sample as read from the sensor registers or the FIFO
+ * @param[out] accel rotated accel sample
+ * @param[out] gyro rotated gyro sample
+ * @return temperature in degrees Celsius * 100
+ */
+static int16_t PIOS_MPU6000_ConvertSample(const mpu6000_data_t *data, Vector3i16 *accel, Vector3i16 *gyro)
 {
-    if (!queue_data) {
-        return false;
-    }
-
     // Rotate the sensor to OP convention.  The datasheet defines X as towards the right
     // and Y as forward.  OP convention transposes this.  Also the Z is defined negatively
     // to our convention
@@ -570,41 +631,138 @@ static bool PIOS_MPU6000_HandleData()
     // Currently we only support rotations on top so switch X/Y accordingly
     switch (dev->cfg->orientation) {
     case PIOS_MPU6000_TOP_0DEG:
-        queue_data->sample[0].y = GET_SENSOR_DATA(mpu6000_data, Accel_X); // chip X
-        queue_data->sample[0].x = GET_SENSOR_DATA(mpu6000_data, Accel_Y); // chip Y
-        queue_data->sample[1].y = GET_SENSOR_DATA(mpu6000_data, Gyro_X); // chip X
-        queue_data->sample[1].x = GET_SENSOR_DATA(mpu6000_data, Gyro_Y); // chip Y
+        accel->y = GET_SENSOR_DATA(data, Accel_X); // chip X
+        accel->x = GET_SENSOR_DATA(data, Accel_Y); // chip Y
+        gyro->y  = GET_SENSOR_DATA(data, Gyro_X); // chip X
+        gyro->x  = GET_SENSOR_DATA(data, Gyro_Y); // chip Y
         break;
     case PIOS_MPU6000_TOP_90DEG:
         // -1 to bring it back to -32768 +32767 range
-        queue_data->sample[0].y = -1 - (GET_SENSOR_DATA(mpu6000_data, Accel_Y)); // chip Y
-        queue_data->sample[0].x = GET_SENSOR_DATA(mpu6000_data, Accel_X); // chip X
-        queue_data->sample[1].y = -1 - (GET_SENSOR_DATA(mpu6000_data, Gyro_Y)); // chip Y
-        queue_data->sample[1].x = GET_SENSOR_DATA(mpu6000_data, Gyro_X); // chip X
+        accel->y = -1 - (GET_SENSOR_DATA(data, Accel_Y)); // chip Y
+        accel->x = GET_SENSOR_DATA(data, Accel_X); // chip X
+        gyro->y  = -1 - (GET_SENSOR_DATA(data, Gyro_Y)); // chip Y
+        gyro->x  = GET_SENSOR_DATA(data, Gyro_X); // chip X
         break;
     case PIOS_MPU6000_TOP_180DEG:
-        queue_data->sample[0].y = -1 - (GET_SENSOR_DATA(mpu6000_data, Accel_X)); // chip X
-        queue_data->sample[0].x = -1 - (GET_SENSOR_DATA(mpu6000_data, Accel_Y)); // chip Y
-        queue_data->sample[1].y = -1 - (GET_SENSOR_DATA(mpu6000_data, Gyro_X)); // chip X
-        queue_data->sample[1].x = -1 - (GET_SENSOR_DATA(mpu6000_data, Gyro_Y)); // chip Y
+        accel->y = -1 - (GET_SENSOR_DATA(data, Accel_X)); // chip X
+        accel->x = -1 - (GET_SENSOR_DATA(data, Accel_Y)); // chip Y
+        gyro->y  = -1 - (GET_SENSOR_DATA(data, Gyro_X)); // chip X
+        gyro->x  = -1 - (GET_SENSOR_DATA(data, Gyro_Y)); // chip Y
         break;
     case PIOS_MPU6000_TOP_270DEG:
-        queue_data->sample[0].y = GET_SENSOR_DATA(mpu6000_data, Accel_Y); // chip Y
-        queue_data->sample[0].x = -1 - (GET_SENSOR_DATA(mpu6000_data, Accel_X)); // chip X
-        queue_data->sample[1].y = GET_SENSOR_DATA(mpu6000_data, Gyro_Y); // chip Y
-        queue_data->sample[1].x = -1 - (GET_SENSOR_DATA(mpu6000_data, Gyro_X)); // chip X
+        accel->y = GET_SENSOR_DATA(data, Accel_Y); // chip Y
+        accel->x = -1 - (GET_SENSOR_DATA(data, Accel_X)); // chip X
+        gyro->y  = GET_SENSOR_DATA(data, Gyro_Y); // chip Y
+        gyro->x  = -1 - (GET_SENSOR_DATA(data, Gyro_X)); // chip X
         break;
     }
-    queue_data->sample[0].z = -1 - (GET_SENSOR_DATA(mpu6000_data, Accel_Z));
-    queue_data->sample[1].z = -1 - (GET_SENSOR_DATA(mpu6000_data, Gyro_Z));
-    const int16_t temp = GET_SENSOR_DATA(mpu6000_data, Temperature);
-    queue_data->temperature = 3500 + ((float)(temp + 512)) * (1.0f / 3.4f);
+    accel->z = -1 - (GET_SENSOR_DATA(data, Accel_Z));
+    gyro->z  = -1 - (GET_SENSOR_DATA(data, Gyro_Z));
+    const int16_t temp = GET_SENSOR_DATA(data, Temperature);
+    return 3500 + ((float)(temp + 512)) * (1.0f / 3.4f);
+}
+
+static bool PIOS_MPU6000_HandleData()
+{
+    if (!queue_data) {
+        return false;
+    }
+
+    queue_data->temperature = PIOS_MPU6000_ConvertSample(&mpu6000_data, &queue_data->sample[0], &queue_data->sample[1]);
+    queue_data->timestamp   = drdy_time;
 
     BaseType_t higherPriorityTaskWoken;
     xQueueSendToBackFromISR(dev->queue, (void *)queue_data, &higherPriorityTaskWoken);
     return higherPriorityTaskWoken == pdTRUE;
 }
 
+/**
+ * @brief Convert a burst read from the FIFO and queue it as a single block
+ * @param[in] samples number of samples in fifo_buffer
+ * @return true if a higher priority task has been woken
+ */
+static bool PIOS_MPU6000_HandleFifoData(uint16_t samples)
+{
+    int32_t temperature = 0;
+
+    for (uint16_t i = 0; i < samples; i++) {
+        // the command byte slot of each overlay is the last byte of the previous sample
+        const mpu6000_data_t *data = (const mpu6000_data_t *)&fifo_buffer[i * PIOS_MPU6000_SAMPLES_BYTES];
+        temperature += PIOS_MPU6000_ConvertSample(data, &burst_data->sample[i * SENSOR_COUNT], &burst_data->sample[i * SENSOR_COUNT + 1]);
+    }
+    burst_data->burst       = samples;
+    burst_data->temperature = temperature / samples;
+    burst_data->timestamp   = drdy_time;
+
+    BaseType_t higherPriorityTaskWoken;
+    xQueueSendToBackFromISR(dev->queue, (void *)burst_data, &higherPriorityTaskWoken);
+    return higherPriorityTaskWoken == pdTRUE;
+}
+
+/**
+ * @brief Read all samples queued in the chip FIFO, up to PIOS_SENSORS_MAX_BURST, in a single transfer
+ * @param woken[in,out] If non-NULL, will be set to true if a higher priority task is now eligible to run
+ * @return true if a burst was read and queued
+ */
+static bool PIOS_MPU6000_ReadFifo(bool *woken)
+{
+    static const uint8_t count_send_buf[3] = { PIOS_MPU6000_FIFO_CNT_MSB | 0x80 };
+    // the FIFO register does not auto increment, every following byte pops the FIFO
+    static const uint8_t fifo_send_buf[PIOS_MPU6000_BURST_BYTES] = { PIOS_MPU6000_FIFO_REG | 0x80 };
+    uint8_t count_buf[3];
+
+    if (PIOS_MPU6000_ClaimBusISR(woken, true) != 0) {
+        return false;
+    }
+    if (PIOS_SPI_TransferBlock(dev->spi_id, &count_send_buf[0], &count_buf[0], sizeof(count_buf), NULL) < 0) {
+        PIOS_MPU6000_ReleaseBusISR(woken);
+        return false;
+    }
+    PIOS_MPU6000_ReleaseBusISR(woken);
+
+    uint16_t available = (count_buf[1] << 8) | count_buf[2];
+    if ((available % PIOS_MPU6000_SAMPLES_BYTES) != 0 || available > PIOS_MPU6000_FIFO_SIZE - PIOS_MPU6000_SAMPLES_BYTES) {
+        // partial sample or overflow, the stream lost its alignment so start over
+        PIOS_MPU6000_ResetFifoISR(woken);
+        return false;
+    }
+    uint16_t samples = available / PIOS_MPU6000_SAMPLES_BYTES;
+    if (samples > PIOS_SENSORS_MAX_BURST) {
+        // leftovers are picked up by the next burst
+        samples = PIOS_SENSORS_MAX_BURST;
+    }
+    if (samples == 0) {
+        return false;
+    }
+
+    if (PIOS_MPU6000_ClaimBusISR(woken, true) != 0) {
+        return false;
+    }
+    if (PIOS_SPI_TransferBlock(dev->spi_id, &fifo_send_buf[0], &fifo_buffer[0], 1 + samples * PIOS_MPU6000_SAMPLES_BYTES, NULL) < 0) {
+        PIOS_MPU6000_ReleaseBusISR(woken);
+        return false;
+    }
+    PIOS_MPU6000_ReleaseBusISR(woken);
+
+    *woken |= PIOS_MPU6000_HandleFifoData(samples);
+    return true;
+}
+
+/**
+ * @brief Flush the chip FIFO from interrupt context
+ * @param woken[in,out] If non-NULL, will be set to true if a higher priority task is now eligible to run
+ */
+static void PIOS_MPU6000_ResetFifoISR(bool *woken)
+{
+    const uint8_t reset_buf[2] = { PIOS_MPU6000_USER_CTRL_REG & 0x7f, dev->cfg->User_ctl | PIOS_MPU6000_USERCTL_FIFO_EN | PIOS_MPU6000_USERCTL_FIFO_RST };
+
+    if (PIOS_MPU6000_ClaimBusISR(woken, false) != 0) {
+        return;
+    }
+    PIOS_SPI_TransferBlock(dev->spi_id, &reset_buf[0], NULL, sizeof(reset_buf), NULL);
+    PIOS_MPU6000_ReleaseBusISR(woken);
+}
+
 static bool PIOS_MPU6000_ReadSensor(bool *woken)
 {
     const uint8_t mpu6000_send_buf[1 + PIOS_MPU6000_SAMPLES_BYTES] = { PIOS_MPU6000_SENSOR_FIRST_REG | 0x80 };
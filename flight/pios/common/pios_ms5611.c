@@ -36,13 +36,14 @@
 // TODO: Clean this up.  Getting around old constant.
 #define PIOS_MS5611_OVERSAMPLING   oversampling
 
-// Option to change the interleave between Temp and Pressure conversions
-// Undef for normal operation
-#define PIOS_MS5611_SLOW_TEMP_RATE 20
+// Default interleave between Temp and Pressure conversions, when the board cfg does not set one
 #ifndef PIOS_MS5611_SLOW_TEMP_RATE
-#define PIOS_MS5611_SLOW_TEMP_RATE 1
+#define PIOS_MS5611_SLOW_TEMP_RATE 20
 #endif
 
+// Restart the pipeline when a queued transfer did not complete by then, well after the I2C adapter timeout
+#define MS5611_TRANSFER_TIMEOUT_US 200000
+
 /* Local Types */
 typedef struct {
     uint16_t C[6];
@@ -56,9 +57,10 @@ typedef enum {
 
 typedef enum {
     MS5611_FSM_INIT = 0,
-    MS5611_FSM_TEMPERATURE,
-    MS5611_FSM_PRESSURE,
-    MS5611_FSM_CALCULATE,
+    MS5611_FSM_STARTING, // conversion command queued
+    MS5611_FSM_CONVERTING, // waiting for the conversion time
+    MS5611_FSM_READING, // ADC read queued, the next conversion is started once it completes
+    MS5611_FSM_RETRY, // the I2C adapter did not take the transfer, queue it again
 } MS5611_FSM_State;
 
 /* Glocal Variables */
@@ -81,6 +83,12 @@ static int32_t PIOS_MS5611_Read(uint8_t address, uint8_t *buffer, uint8_t len);
 static int32_t PIOS_MS5611_WriteCommand(uint8_t command);
 static uint32_t PIOS_MS5611_GetDelay();
 static uint32_t PIOS_MS5611_GetDelayUs();
+static void PIOS_MS5611_ProcessTemperature(uint32_t raw);
+static void PIOS_MS5611_ProcessPressure(uint32_t raw);
+static void PIOS_MS5611_QueueConversion(void);
+static void PIOS_MS5611_QueueTransfer(struct pios_i2c_request *request, MS5611_FSM_State state);
+static void PIOS_MS5611_ConversionStarted(uint32_t context, int32_t status);
+static void PIOS_MS5611_ADCRead(uint32_t context, int32_t status);
 
 // Second order temperature compensation. Temperature offset
 static int64_t compensation_t2;
@@ -91,6 +99,58 @@ static const struct pios_ms5611_cfg *dev_cfg;
 static int32_t i2c_id;
 static PIOS_SENSORS_1Axis_SensorsWithTemp results;
 
+// Conversion pipeline, run by the sensor poll and the I2C completion callbacks
+static volatile MS5611_FSM_State fsm_state;
+static uint8_t temperature_interleaving;
+static uint8_t temp_press_interleave_count;
+static ConversionTypeTypeDef pipeline_conversion;
+static uint8_t conversion_command;
+static uint8_t adc_read_command = MS5611_ADC_READ;
+static uint8_t adc_buffer[3];
+static volatile bool sample_ready;
+static volatile uint32_t sample_raw;
+static volatile ConversionTypeTypeDef sample_type;
+static uint32_t transfer_start;
+static struct pios_i2c_request *transfer_request;
+static MS5611_FSM_State transfer_state;
+// Passed as the request context, completions of abandoned transfers are ignored
+static volatile uint32_t transfer_generation;
+static const struct pios_i2c_txn conversion_txn_list[] = {
+    {
+        .info = "PIOS_MS5611_QueueConversion",
+        .addr = MS5611_I2C_ADDR,
+        .rw   = PIOS_I2C_TXN_WRITE,
+        .len  = 1,
+        .buf  = &conversion_command,
+    },
+};
+static const struct pios_i2c_txn adc_read_txn_list[] = {
+    {
+        .info = "PIOS_MS5611_driver_poll",
+        .addr = MS5611_I2C_ADDR,
+        .rw   = PIOS_I2C_TXN_WRITE,
+        .len  = 1,
+        .buf  = &adc_read_command,
+    },
+    {
+        .info = "PIOS_MS5611_driver_poll",
+        .addr = MS5611_I2C_ADDR,
+        .rw   = PIOS_I2C_TXN_READ,
+        .len  = sizeof(adc_buffer),
+        .buf  = adc_buffer,
+    },
+};
+static struct pios_i2c_request conversion_request = {
+    .txn_list = conversion_txn_list,
+    .num_txns = NELEMENTS(conversion_txn_list),
+    .callback = PIOS_MS5611_ConversionStarted,
+};
+static struct pios_i2c_request adc_read_request = {
+    .txn_list = adc_read_txn_list,
+    .num_txns = NELEMENTS(adc_read_txn_list),
+    .callback = PIOS_MS5611_ADCRead,
+};
+
 // sensor driver interface
 bool PIOS_MS5611_driver_Test(uintptr_t context);
 void PIOS_MS5611_driver_Reset(uintptr_t context);
@@ -118,6 +178,9 @@ void PIOS_MS5611_Init(const struct pios_ms5611_cfg *cfg, int32_t i2c_device)
     oversampling = cfg->oversampling;
     conversionDelayMs = PIOS_MS5611_GetDelay();
     conversionDelayUs = PIOS_MS5611_GetDelayUs();
+    temperature_interleaving = cfg->temperature_interleaving ? cfg->temperature_interleaving : PIOS_MS5611_SLOW_TEMP_RATE;
+    fsm_state    = MS5611_FSM_INIT;
+    sample_ready = false;
 
     dev_cfg = cfg; // Store cfg before enabling interrupt
 
@@ -231,71 +294,83 @@ int32_t PIOS_MS5611_ReadADC(void)
     if (conversionDelayUs > PIOS_DELAY_DiffuS(lastConversionStart)) {
         return -1;
     }
-    static int64_t deltaTemp;
 
     /* Read and store the 16bit result */
+    if (PIOS_MS5611_Read(MS5611_ADC_READ, Data, 3) != 0) {
+        return -2;
+    }
     if (CurrentRead == MS5611_CONVERSION_TYPE_TemperatureConv) {
-        /* Read the temperature conversion */
-        if (PIOS_MS5611_Read(MS5611_ADC_READ, Data, 3) != 0) {
-            return -2;
-        }
-
-        RawTemperature = (Data[0] << 16) | (Data[1] << 8) | Data[2];
-        // Difference between actual and reference temperature
-        // dT = D2 - TREF = D2 - C5 * 2^8
-        deltaTemp   = ((int32_t)RawTemperature) - (CalibData.C[4] * POW2(8));
-        // Actual temperature (-40…85°C with 0.01°C resolution)
-        // TEMP = 20°C + dT * TEMPSENS = 2000 + dT * C6 / 2^23
-        Temperature = 2000l + ((deltaTemp * CalibData.C[5]) / POW2(23));
+        PIOS_MS5611_ProcessTemperature((Data[0] << 16) | (Data[1] << 8) | Data[2]);
     } else {
-        int64_t Offset;
-        int64_t Sens;
-        // used for second order temperature compensation
-        int64_t Offset2 = 0;
-        int64_t Sens2   = 0;
-
-        /* Read the pressure conversion */
-        if (PIOS_MS5611_Read(MS5611_ADC_READ, Data, 3) != 0) {
-            return -2;
-        }
-        // check if temperature is less than 20°C
-        if (Temperature < 2000) {
-            // Apply compensation
-            // T2 = dT^2 / 2^31
-            // OFF2 = 5 ⋅ (TEMP – 2000)^2/2
-            // SENS2 = 5 ⋅ (TEMP – 2000)^2/2^2
-
-            int64_t tcorr = (Temperature - 2000) * (Temperature - 2000);
-            Offset2 = (5 * tcorr) / 2;
-            Sens2   = (5 * tcorr) / 4;
-            compensation_t2 = (deltaTemp * deltaTemp) >> 31;
-            // Apply the "Very low temperature compensation" when temp is less than -15°C
-            if (Temperature < -1500) {
-                // OFF2 = OFF2 + 7 ⋅ (TEMP + 1500)^2
-                // SENS2 = SENS2 + 11 ⋅ (TEMP + 1500)^2 / 2
-                int64_t tcorr2 = (Temperature + 1500) * (Temperature + 1500);
-                Offset2 += 7 * tcorr2;
-                Sens2   += (11 * tcorr2) / 2;
-            }
-        } else {
-            compensation_t2 = 0;
-            Offset2 = 0;
-            Sens2 = 0;
-        }
-        RawPressure = ((Data[0] << 16) | (Data[1] << 8) | Data[2]);
-        // Offset at actual temperature
-        // OFF = OFFT1 + TCO * dT = C2 * 2^16 + (C4 * dT) / 2^7
-        Offset   = ((int64_t)CalibData.C[1]) * POW2(16) + (((int64_t)CalibData.C[3]) * deltaTemp) / POW2(7) - Offset2;
-        // Sensitivity at actual temperature
-        // SENS = SENST1 + TCS * dT = C1 * 2^15 + (C3 * dT) / 2^8
-        Sens     = ((int64_t)CalibData.C[0]) * POW2(15) + (((int64_t)CalibData.C[2]) * deltaTemp) / POW2(8) - Sens2;
-        // Temperature compensated pressure (10…1200mbar with 0.01mbar resolution)
-        // P = D1 * SENS - OFF = (D1 * SENS / 2^21 - OFF) / 2^15
-        Pressure = (((((int64_t)RawPressure) * Sens) / POW2(21)) - Offset) / POW2(15);
+        PIOS_MS5611_ProcessPressure((Data[0] << 16) | (Data[1] << 8) | Data[2]);
     }
     return 0;
 }
 
+// Difference between actual and reference temperature, shared by the temperature and pressure compensation
+static int64_t deltaTemp;
+
+/**
+ * Compute the temperature from a raw temperature conversion
+ */
+static void PIOS_MS5611_ProcessTemperature(uint32_t raw)
+{
+    RawTemperature = raw;
+    // Difference between actual and reference temperature
+    // dT = D2 - TREF = D2 - C5 * 2^8
+    deltaTemp   = ((int32_t)RawTemperature) - (CalibData.C[4] * POW2(8));
+    // Actual temperature (-40…85°C with 0.01°C resolution)
+    // TEMP = 20°C + dT * TEMPSENS = 2000 + dT * C6 / 2^23
+    Temperature = 2000l + ((deltaTemp * CalibData.C[5]) / POW2(23));
+}
+
+/**
+ * Compute the compensated pressure from a raw pressure conversion
+ */
+static void PIOS_MS5611_ProcessPressure(uint32_t raw)
+{
+    int64_t Offset;
+    int64_t Sens;
+    // used for second order temperature compensation
+    int64_t Offset2 = 0;
+    int64_t Sens2   = 0;
+
+    // check if temperature is less than 20°C
+    if (Temperature < 2000) {
+        // Apply compensation
+        // T2 = dT^2 / 2^31
+        // OFF2 = 5 ⋅ (TEMP – 2000)^2/2
+        // SENS2 = 5 ⋅ (TEMP – 2000)^2/2^2
+
+        int64_t tcorr = (Temperature - 2000) * (Temperature - 2000);
+        Offset2 = (5 * tcorr) / 2;
+        Sens2   = (5 * tcorr) / 4;
+        compensation_t2 = (deltaTemp * deltaTemp) >> 31;
+        // Apply the "Very low temperature compensation" when temp is less than -15°C
+        if (Temperature < -1500) {
+            // OFF2 = OFF2 + 7 ⋅ (TEMP + 1500)^2
+            // SENS2 = SENS2 + 11 ⋅ (TEMP + 1500)^2 / 2
+            int64_t tcorr2 = (Temperature + 1500) * (Temperature + 1500);
+            Offset2 += 7 * tcorr2;
+            Sens2   += (11 * tcorr2) / 2;
+        }
+    } else {
+        compensation_t2 = 0;
+        Offset2 = 0;
+        Sens2 = 0;
+    }
+    RawPressure = raw;
+    // Offset at actual temperature
+    // OFF = OFFT1 + TCO * dT = C2 * 2^16 + (C4 * dT) / 2^7
+    Offset   = ((int64_t)CalibData.C[1]) * POW2(16) + (((int64_t)CalibData.C[3]) * deltaTemp) / POW2(7) - Offset2;
+    // Sensitivity at actual temperature
+    // SENS = SENST1 + TCS * dT = C1 * 2^15 + (C3 * dT) / 2^8
+    Sens     = ((int64_t)CalibData.C[0]) * POW2(15) + (((int64_t)CalibData.C[2]) * deltaTemp) / POW2(8) - Sens2;
+    // Temperature compensated pressure (10…1200mbar with 0.01mbar resolution)
+    // P = D1 * SENS - OFF = (D1 * SENS / 2^21 - OFF) / 2^15
+    Pressure = (((((int64_t)RawPressure) * Sens) / POW2(21)) - Offset) / POW2(15);
+}
+
 /**
  * Return the most recently computed temperature in kPa
  */
@@ -421,51 +496,129 @@ void PIOS_MS5611_driver_fetch(void *data, __attribute__((unused)) uint8_t size,
     memcpy(data, (void *)&results, sizeof(PIOS_SENSORS_1Axis_SensorsWithTemp));
 }
 
-bool PIOS_MS5611_driver_poll(__attribute__((unused)) uintptr_t context)
+/**
+ * Queue the command starting the next conversion of the pipeline, one temperature
+ * conversion every temperature_interleaving pressure conversions
+ */
+static void PIOS_MS5611_QueueConversion(void)
 {
-    static uint8_t temp_press_interleave_count = 1;
-    static MS5611_FSM_State next_state = MS5611_FSM_INIT;
+    if (pipeline_conversion == MS5611_CONVERSION_TYPE_TemperatureConv
+        || (pipeline_conversion == MS5611_CONVERSION_TYPE_PressureConv && --temp_press_interleave_count)) {
+        pipeline_conversion = MS5611_CONVERSION_TYPE_PressureConv;
+        conversion_command  = MS5611_PRES_ADDR + oversampling;
+    } else {
+        temp_press_interleave_count = temperature_interleaving;
+        pipeline_conversion = MS5611_CONVERSION_TYPE_TemperatureConv;
+        conversion_command  = MS5611_TEMP_ADDR + oversampling;
+    }
 
-    int32_t conversionResult = PIOS_MS5611_ReadADC();
+    PIOS_MS5611_QueueTransfer(&conversion_request, MS5611_FSM_STARTING);
+}
 
-    if (__builtin_expect(conversionResult == -1, 1)) {
-        return false; // wait for conversion to complete
-    } else if (__builtin_expect(conversionResult == -2, 0)) {
-        temp_press_interleave_count = 1;
-        next_state = MS5611_FSM_INIT;
+/**
+ * Queue a transfer of the pipeline, the poll queues it again if the adapter does not
+ * take it and restarts the pipeline if it never completes
+ */
+static void PIOS_MS5611_QueueTransfer(struct pios_i2c_request *request, MS5611_FSM_State state)
+{
+    fsm_state = state;
+    transfer_request = request;
+    transfer_state   = state;
+    transfer_start   = PIOS_DELAY_GetRaw();
+    request->context = transfer_generation;
+    if (PIOS_I2C_Transfer_Queued(i2c_id, request) != 0) {
+        fsm_state = MS5611_FSM_RETRY;
     }
-    switch (next_state) {
-    case MS5611_FSM_INIT:
-    case MS5611_FSM_TEMPERATURE:
-        PIOS_MS5611_StartADC(MS5611_CONVERSION_TYPE_TemperatureConv);
-        next_state = MS5611_FSM_PRESSURE;
-        return false;
-
-    case MS5611_FSM_PRESSURE:
-        PIOS_MS5611_StartADC(MS5611_CONVERSION_TYPE_PressureConv);
-        next_state = MS5611_FSM_CALCULATE;
-        return false;
-
-    case MS5611_FSM_CALCULATE:
-        temp_press_interleave_count--;
-        if (!temp_press_interleave_count) {
-            temp_press_interleave_count = PIOS_MS5611_SLOW_TEMP_RATE;
-            PIOS_MS5611_StartADC(MS5611_CONVERSION_TYPE_TemperatureConv);
-            next_state = MS5611_FSM_PRESSURE;
+}
+
+/**
+ * I2C completion of the conversion command, the conversion time starts now
+ */
+static void PIOS_MS5611_ConversionStarted(uint32_t context, int32_t status)
+{
+    if (context != transfer_generation) {
+        return;
+    }
+    if (status != 0) {
+        fsm_state = MS5611_FSM_INIT;
+        return;
+    }
+    lastConversionStart = PIOS_DELAY_GetRaw();
+    fsm_state = MS5611_FSM_CONVERTING;
+}
+
+/**
+ * I2C completion of the ADC read, hands the sample to the poll and starts the next conversion
+ */
+static void PIOS_MS5611_ADCRead(uint32_t context, int32_t status)
+{
+    if (context != transfer_generation) {
+        return;
+    }
+    if (status != 0) {
+        fsm_state = MS5611_FSM_INIT;
+        return;
+    }
+    sample_raw   = (adc_buffer[0] << 16) | (adc_buffer[1] << 8) | adc_buffer[2];
+    sample_type  = pipeline_conversion;
+    sample_ready = true;
+
+    PIOS_MS5611_QueueConversion();
+}
+
+bool PIOS_MS5611_driver_poll(__attribute__((unused)) uintptr_t context)
+{
+    bool updated = false;
+
+    /* The compensation is done here rather than in the I2C interrupt */
+    if (sample_ready) {
+        if (sample_type == MS5611_CONVERSION_TYPE_TemperatureConv) {
+            PIOS_MS5611_ProcessTemperature(sample_raw);
         } else {
-            PIOS_MS5611_StartADC(MS5611_CONVERSION_TYPE_PressureConv);
-            next_state = MS5611_FSM_CALCULATE;
+            PIOS_MS5611_ProcessPressure(sample_raw);
+            results.temperature = PIOS_MS5611_GetTemperature();
+            results.sample = PIOS_MS5611_GetPressure();
+            updated = true;
         }
+        sample_ready = false;
+    }
 
-        results.temperature = PIOS_MS5611_GetTemperature();
-        results.sample = PIOS_MS5611_GetPressure();
-        return true;
+    switch (fsm_state) {
+    case MS5611_FSM_STARTING:
+    case MS5611_FSM_READING:
+        // I2C transfer in progress
+        if (PIOS_DELAY_DiffuS(transfer_start) <= MS5611_TRANSFER_TIMEOUT_US) {
+            break;
+        }
+        // the transfer got lost, take it back from the adapter before queueing it again
+        if (PIOS_I2C_Transfer_Cancel(i2c_id, transfer_request) != 0) {
+            // the adapter is completing a transfer, maybe this one
+            break;
+        }
+        transfer_generation++;
+        // fall through
+    case MS5611_FSM_INIT:
+        // (re)start with a temperature conversion, the pressure compensation needs it
+        pipeline_conversion = MS5611_CONVERSION_TYPE_None;
+        PIOS_MS5611_QueueConversion();
+        break;
+
+    case MS5611_FSM_CONVERTING:
+        if (conversionDelayUs <= PIOS_DELAY_DiffuS(lastConversionStart)) {
+            PIOS_MS5611_QueueTransfer(&adc_read_request, MS5611_FSM_READING);
+        }
+        break;
+
+    case MS5611_FSM_RETRY:
+        PIOS_MS5611_QueueTransfer(transfer_request, transfer_state);
+        break;
 
     default:
         // it should not be there
         PIOS_Assert(0);
     }
-    return false;
+
+    return updated;
 }
 
 
@@ -76,6 +76,11 @@
 #define RFM22B_DEFAULT_MAX_CHANNEL       250
 #define RFM22B_PPM_ONLY_DATARATE         RFM22_datarate_9600
 
+// Adaptive datarate parameters
+#define RFM22B_FALLBACK_DATARATE_STEPS   2   // how many datarate steps below the configured datarate to fall back to
+#define RFM22B_DATARATE_DOWN_QUALITY     48  // fall back below this link quality
+#define RFM22B_DATARATE_UP_QUALITY       112 // return to the configured datarate above this link quality
+
 // PPM encoding limits
 #define RFM22B_PPM_MIN                   1
 #define RFM22B_PPM_MAX                   511
@@ -170,6 +175,8 @@ static const uint8_t OUT_FF[64] = {
 static void pios_rfm22_task(void *parameters);
 static bool pios_rfm22_readStatus(struct pios_rfm22b_dev *rfm22b_dev);
 static void pios_rfm22_setDatarate(struct pios_rfm22b_dev *rfm22b_dev);
+static void rfm22_setChannelDatarate(struct pios_rfm22b_dev *rfm22b_dev, enum rfm22b_datarate datarate);
+static bool rfm22_adaptDatarate(struct pios_rfm22b_dev *rfm22b_dev);
 static void rfm22_rxFailure(struct pios_rfm22b_dev *rfm22b_dev);
 static void pios_rfm22_inject_event(struct pios_rfm22b_dev *rfm22b_dev, enum pios_radio_event event, bool inISR);
 static enum pios_radio_event rfm22_init(struct pios_rfm22b_dev *rfm22b_dev);
@@ -600,15 +607,45 @@ void PIOS_RFM22B_SetChannelConfig(uint32_t rfm22b_id, enum rfm22b_datarate datar
     if (ppm_only) {
         rfm22b_dev->one_way_link = true;
         datarate = RFM22B_PPM_ONLY_DATARATE;
-        rfm22b_dev->datarate     = RFM22B_PPM_ONLY_DATARATE;
     } else {
         rfm22b_dev->one_way_link = oneway;
-        rfm22b_dev->datarate     = datarate;
     }
-    rfm22b_dev->packet_time = (ppm_mode ? packet_time_ppm[datarate] : packet_time[datarate]);
+    rfm22b_dev->min_chan = min_chan;
+    rfm22b_dev->max_chan = max_chan;
+
+    // The configured datarate is the fastest the link will run at. Two-way links fall back to
+    // a slower datarate when the link quality drops, PPM links can't go below the PPM only datarate.
+    rfm22b_dev->nominal_datarate  = datarate;
+    rfm22b_dev->fallback_datarate = datarate;
+    if (!rfm22b_dev->one_way_link) {
+        uint8_t min_datarate = ppm_mode ? RFM22B_PPM_ONLY_DATARATE + 1 : RFM22_datarate_9600;
+        if (datarate >= min_datarate + RFM22B_FALLBACK_DATARATE_STEPS) {
+            rfm22b_dev->fallback_datarate = datarate - RFM22B_FALLBACK_DATARATE_STEPS;
+        } else {
+            rfm22b_dev->fallback_datarate = min_datarate;
+        }
+    }
+
+    rfm22_setChannelDatarate(rfm22b_dev, datarate);
+}
+
+/**
+ * Set the air datarate and recalculate the frequency hopping channels and packet timing for it.
+ * The new datarate is written to the radio when the modem is (re)initialized.
+ *
+ * @param[in] rfm22b_dev  The device structure
+ * @param[in] datarate  The air datarate.
+ */
+static void rfm22_setChannelDatarate(struct pios_rfm22b_dev *rfm22b_dev, enum rfm22b_datarate datarate)
+{
+    bool ppm_mode = rfm22b_dev->ppm_send_mode || rfm22b_dev->ppm_recv_mode;
+
+    rfm22b_dev->datarate       = datarate;
+    rfm22b_dev->datarate_ticks = xTaskGetTickCount();
+    rfm22b_dev->packet_time    = (ppm_mode ? packet_time_ppm[datarate] : packet_time[datarate]);
 
     uint8_t num_found = 0;
-    rfm22_gen_channels(rfm22_destinationID(rfm22b_dev), datarate, min_chan, max_chan,
+    rfm22_gen_channels(rfm22_destinationID(rfm22b_dev), datarate, rfm22b_dev->min_chan, rfm22b_dev->max_chan,
                        rfm22b_dev->channels, &num_found);
 
     rfm22b_dev->num_channels = num_found;
@@ -1194,6 +1231,11 @@ static void pios_rfm22_task(void *parameters)
             rfm22_process_event(rfm22b_dev, RADIO_EVENT_RX_MODE);
         }
 
+        // Switch datarates if the link quality calls for it.
+        if (rfm22_adaptDatarate(rfm22b_dev)) {
+            rfm22_process_event(rfm22b_dev, RADIO_EVENT_INITIALIZE);
+        }
+
         portTickType curTicks = xTaskGetTickCount();
         // Have we been sending / receiving this packet too long?
 
@@ -2304,6 +2346,77 @@ static bool rfm22_changeChannel(struct pios_rfm22b_dev *rfm22b_dev)
 }
 
 
+/*****************************************************************************
+* Adaptive Datarate Functions
+*****************************************************************************/
+
+/**
+ * Return how long a remote modem should listen on the sync channel at a datarate
+ * before concluding that the coordinator isn't using it.
+ *
+ * @param[in] rfm22b_dev  The device structure
+ * @param[in] datarate  The air datarate.
+ */
+static uint32_t rfm22_scanTime(struct pios_rfm22b_dev *rfm22b_dev, enum rfm22b_datarate datarate)
+{
+    bool ppm_mode = rfm22b_dev->ppm_send_mode || rfm22b_dev->ppm_recv_mode;
+    uint8_t period = (ppm_mode ? packet_time_ppm[datarate] : packet_time[datarate]);
+
+    // The coordinator passes the sync channel once per frequency hop cycle, listen for two.
+    return (uint32_t)period * num_channels[datarate] * 2;
+}
+
+/**
+ * Choose between the configured and fallback datarates.
+ * The coordinator decides from the link quality it sees, the remote modem follows it by
+ * alternating between the two datarates while it's disconnected.
+ *
+ * @param[in] rfm22b_dev  The device structure
+ * @return True if the datarate was changed and the modem has to be reinitialized.
+ */
+static bool rfm22_adaptDatarate(struct pios_rfm22b_dev *rfm22b_dev)
+{
+    if (rfm22b_dev->fallback_datarate == rfm22b_dev->nominal_datarate) {
+        return false;
+    }
+
+    portTickType curTicks = xTaskGetTickCount();
+    uint32_t since_switch = pios_rfm22_time_difference_ms(rfm22b_dev->datarate_ticks, curTicks);
+    bool fallen_back = (rfm22b_dev->datarate != rfm22b_dev->nominal_datarate);
+    enum rfm22b_datarate datarate;
+
+    if (rfm22_isCoordinator(rfm22b_dev)) {
+        // Wait for the packet statistics to fill up at this datarate.
+        if (since_switch < (uint32_t)rfm22b_dev->packet_time * 2 * RFM22B_RX_PACKET_STATS_LEN * 16) {
+            return false;
+        }
+
+        // Give the remote modem time to try both datarates before giving up on it.
+        uint32_t lost_timeout = rfm22_scanTime(rfm22b_dev, rfm22b_dev->nominal_datarate) +
+                                rfm22_scanTime(rfm22b_dev, rfm22b_dev->fallback_datarate) + CONNECTED_TIMEOUT;
+        bool lost = (rfm22b_dev->last_contact == 0) ? (since_switch > lost_timeout) :
+                    (pios_rfm22_time_difference_ms(rfm22b_dev->last_contact, curTicks) > lost_timeout);
+
+        rfm22_calculateLinkQuality(rfm22b_dev);
+        if (!fallen_back && (lost || (rfm22b_dev->stats.link_quality < RFM22B_DATARATE_DOWN_QUALITY))) {
+            datarate = rfm22b_dev->fallback_datarate;
+        } else if (fallen_back && !lost && (rfm22b_dev->stats.link_quality > RFM22B_DATARATE_UP_QUALITY)) {
+            datarate = rfm22b_dev->nominal_datarate;
+        } else {
+            return false;
+        }
+    } else {
+        if (rfm22_isConnected(rfm22b_dev) || (since_switch < rfm22_scanTime(rfm22b_dev, rfm22b_dev->datarate))) {
+            return false;
+        }
+        datarate = fallen_back ? rfm22b_dev->nominal_datarate : rfm22b_dev->fallback_datarate;
+    }
+
+    rfm22_setChannelDatarate(rfm22b_dev, datarate);
+    return true;
+}
+
+
 /*****************************************************************************
 * Error Handling Functions
 *****************************************************************************/
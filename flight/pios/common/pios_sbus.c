@@ -42,11 +42,17 @@ static uint16_t PIOS_SBus_RxInCallback(uint32_t context,
                                        uint16_t *headroom,
                                        bool *need_yield);
 static void PIOS_SBus_Supervisor(uint32_t sbus_id);
+#if defined(PIOS_INCLUDE_FREERTOS)
+static xSemaphoreHandle PIOS_SBus_Get_Semaphore(uint32_t rcvr_id, uint8_t channel);
+#endif
 
 
 /* Local Variables */
 const struct pios_rcvr_driver pios_sbus_rcvr_driver = {
     .read = PIOS_SBus_Get,
+#if defined(PIOS_INCLUDE_FREERTOS)
+    .get_semaphore = PIOS_SBus_Get_Semaphore,
+#endif
 };
 
 enum pios_sbus_dev_magic {
@@ -66,6 +72,10 @@ struct pios_sbus_dev {
     enum pios_sbus_dev_magic   magic;
     const struct pios_sbus_cfg *cfg;
     struct pios_sbus_state     state;
+#if defined(PIOS_INCLUDE_FREERTOS)
+    /* given once per decoded frame, whatever the channel asked for */
+    xSemaphoreHandle new_frame_semaphore;
+#endif
 };
 
 /* Allocate S.Bus device descriptor */
@@ -80,6 +90,7 @@ static struct pios_sbus_dev *PIOS_SBus_Alloc(void)
     }
 
     sbus_dev->magic = PIOS_SBUS_DEV_MAGIC;
+    sbus_dev->new_frame_semaphore = 0;
     return sbus_dev;
 }
 #else
@@ -188,6 +199,25 @@ static int32_t PIOS_SBus_Get(uint32_t rcvr_id, uint8_t channel)
     return sbus_dev->state.channel_data[channel];
 }
 
+#if defined(PIOS_INCLUDE_FREERTOS)
+static xSemaphoreHandle PIOS_SBus_Get_Semaphore(uint32_t rcvr_id, __attribute__((unused)) uint8_t channel)
+{
+    struct pios_sbus_dev *sbus_dev = (struct pios_sbus_dev *)rcvr_id;
+
+    if (!PIOS_SBus_Validate(sbus_dev)) {
+        return 0;
+    }
+
+    /* All the channels are updated together, one semaphore serves them all */
+    if (sbus_dev->new_frame_semaphore == 0) {
+        vSemaphoreCreateBinary(sbus_dev->new_frame_semaphore);
+        /* Only signal the frames received from now on */
+        xSemaphoreTake(sbus_dev->new_frame_semaphore, 0);
+    }
+    return sbus_dev->new_frame_semaphore;
+}
+#endif /* if defined(PIOS_INCLUDE_FREERTOS) */
+
 /**
  * Compute channel_data[] from received_data[].
  * For efficiency it unrolls first 8 channels without loops and does the
@@ -225,12 +255,17 @@ static void PIOS_SBus_UnrollChannels(struct pios_sbus_state *state)
     *d++ = (s[22] & SBUS_FLAG_DC2) ? SBUS_VALUE_MAX : SBUS_VALUE_MIN;
 }
 
-/* Update decoder state processing input byte from the S.Bus stream */
-static void PIOS_SBus_UpdateState(struct pios_sbus_state *state, uint8_t b)
+/**
+ * Update decoder state processing input byte from the S.Bus stream
+ * \output true when a full frame has been received and the channels updated
+ */
+static bool PIOS_SBus_UpdateState(struct pios_sbus_state *state, uint8_t b)
 {
+    bool updated = false;
+
     /* should not process any data until new frame is found */
     if (!state->frame_found) {
-        return;
+        return false;
     }
 
     if (state->byte_count == 0) {
@@ -241,7 +276,7 @@ static void PIOS_SBus_UpdateState(struct pios_sbus_state *state, uint8_t b)
             /* do not store the SOF byte */
             state->byte_count++;
         }
-        return;
+        return false;
     }
 
     /* do not store last frame byte as well */
@@ -258,10 +293,12 @@ static void PIOS_SBus_UpdateState(struct pios_sbus_state *state, uint8_t b)
             } else if (flags & SBUS_FLAG_FS) {
                 /* failsafe flag active */
                 PIOS_SBus_ResetChannels(state);
+                updated = true;
             } else {
                 /* data looking good */
                 PIOS_SBus_UnrollChannels(state);
                 state->failsafe_timer = 0;
+                updated = true;
             }
         } else {
             /* discard whole frame */
@@ -270,6 +307,8 @@ static void PIOS_SBus_UpdateState(struct pios_sbus_state *state, uint8_t b)
         /* prepare for the next frame */
         state->frame_found = 0;
     }
+
+    return updated;
 }
 
 /* Comm byte received callback */
@@ -286,10 +325,11 @@ static uint16_t PIOS_SBus_RxInCallback(uint32_t context,
     PIOS_Assert(valid);
 
     struct pios_sbus_state *state = &(sbus_dev->state);
+    bool frame_updated = false;
 
     /* process byte(s) and clear receive timer */
     for (uint8_t i = 0; i < buf_len; i++) {
-        PIOS_SBus_UpdateState(state, buf[i]);
+        frame_updated |= PIOS_SBus_UpdateState(state, buf[i]);
         state->receive_timer = 0;
     }
 
@@ -298,8 +338,15 @@ static uint16_t PIOS_SBus_RxInCallback(uint32_t context,
         *headroom = SBUS_FRAME_LENGTH;
     }
 
-    /* We never need a yield */
     *need_yield = false;
+#if defined(PIOS_INCLUDE_FREERTOS)
+    /* Wake up the reader as soon as the whole frame is decoded */
+    if (frame_updated && sbus_dev->new_frame_semaphore != 0) {
+        signed portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+        xSemaphoreGiveFromISR(sbus_dev->new_frame_semaphore, &xHigherPriorityTaskWoken);
+        *need_yield = (xHigherPriorityTaskWoken == pdTRUE);
+    }
+#endif
 
     /* Always indicate that all bytes were consumed */
     return buf_len;
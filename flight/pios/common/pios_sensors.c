@@ -40,6 +40,8 @@ PIOS_SENSORS_Instance *PIOS_SENSORS_Register(const PIOS_SENSORS_Driver *driver,
     instance->type    = type;
     instance->context = context;
     instance->next    = NULL;
+    instance->data_ready = false;
+    instance->data_ready_time = 0;
     LL_APPEND(sensor_list, instance);
     return instance;
 }
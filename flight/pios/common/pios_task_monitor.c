@@ -29,13 +29,25 @@
 
 #ifdef PIOS_INCLUDE_TASK_MONITOR
 
+// Run times are sampled at most this often, whoever asks for them. Must stay well below the
+// wrap around period of the run time counter (25s for the cycle counter at 168MHz).
+#ifndef PIOS_TASK_MONITOR_SAMPLE_MS
+#define PIOS_TASK_MONITOR_SAMPLE_MS 1000
+#endif
+
 // Private variables
 static xSemaphoreHandle mLock;
 static xTaskHandle *mTaskHandles;
+static uint16_t *mTaskLoads; // permille of the cpu time during the last sample period
+static uint16_t mIdleLoad;
 static uint32_t mLastMonitorTime;
-static uint32_t mLastIdleMonitorTime;
+static portTickType mLastSampleTime;
+static bool mSampled;
 static uint16_t mMaxTasks;
 
+// Private functions
+static void sampleRunTimes();
+
 /**
  * Initialize the Task Monitor
  */
@@ -52,13 +64,20 @@ int32_t PIOS_TASK_MONITOR_Initialize(uint16_t max_tasks)
     }
     memset(mTaskHandles, 0, max_tasks * sizeof(xTaskHandle));
 
-    mMaxTasks = max_tasks;
+    mTaskLoads = (uint16_t *)pios_malloc(max_tasks * sizeof(uint16_t));
+    if (!mTaskLoads) {
+        return -1;
+    }
+    memset(mTaskLoads, 0, max_tasks * sizeof(uint16_t));
+
+    mMaxTasks  = max_tasks;
+    mIdleLoad  = 0;
+    mSampled   = false;
+    mLastSampleTime = 0;
 #if (configGENERATE_RUN_TIME_STATS == 1)
-    mLastMonitorTime     = portGET_RUN_TIME_COUNTER_VALUE();
-    mLastIdleMonitorTime = portGET_RUN_TIME_COUNTER_VALUE();
+    mLastMonitorTime = portGET_RUN_TIME_COUNTER_VALUE();
 #else
-    mLastMonitorTime     = 0;
-    mLastIdleMonitorTime = 0;
+    mLastMonitorTime = 0;
 #endif
     return 0;
 }
@@ -112,15 +131,8 @@ void PIOS_TASK_MONITOR_ForEachTask(TaskMonitorTaskInfoCallback callback, void *c
 
     xSemaphoreTakeRecursive(mLock, portMAX_DELAY);
 
-#if (configGENERATE_RUN_TIME_STATS == 1)
-    /* Calculate the amount of elapsed run time between the last time we
-     * measured and now. Scale so that we can convert task run times
-     * directly to percentages. */
-    uint32_t currentTime = portGET_RUN_TIME_COUNTER_VALUE();
-    /* avoid divide-by-zero if the interval is too small */
-    uint32_t deltaTime   = ((currentTime - mLastMonitorTime) / 100) ? : 1;
-    mLastMonitorTime = currentTime;
-#endif
+    sampleRunTimes();
+
     /* Update all task information */
     for (uint16_t n = 0; n < mMaxTasks; ++n) {
         struct pios_task_info info;
@@ -131,15 +143,12 @@ void PIOS_TASK_MONITOR_ForEachTask(TaskMonitorTaskInfoCallback callback, void *c
 #else
             info.stack_remaining = uxTaskGetStackHighWaterMark(mTaskHandles[n]) * 4;
 #endif
-#if (configGENERATE_RUN_TIME_STATS == 1)
-            /* Generate run time percentage stats */
-            info.running_time_percentage = uxTaskGetRunTime(mTaskHandles[n]) / deltaTime;
-#else
-            info.running_time_percentage = 0;
-#endif
+            info.running_time_permille   = mTaskLoads[n];
+            info.running_time_percentage = (mTaskLoads[n] + 5) / 10;
         } else {
             info.is_running = false;
             info.stack_remaining = 0;
+            info.running_time_permille   = 0;
             info.running_time_percentage = 0;
         }
         /* Pass the information for this task back to the caller */
@@ -155,17 +164,13 @@ uint8_t PIOS_TASK_MONITOR_GetIdlePercentage()
     return 50;
 
 #elif (configGENERATE_RUN_TIME_STATS == 1)
-    xSemaphoreTakeRecursive(mLock, portMAX_DELAY);
-
-    uint32_t currentTime = portGET_RUN_TIME_COUNTER_VALUE();
-
-    /* avoid divide-by-zero if the interval is too small */
-    uint32_t deltaTime   = ((currentTime - mLastIdleMonitorTime) / 100) ? : 1;
-    mLastIdleMonitorTime = currentTime;
-    uint8_t running_time_percentage = 0;
+    if (!mTaskHandles) {
+        return 0;
+    }
 
-    /* Generate idle time percentage stats */
-    running_time_percentage = uxTaskGetRunTime(xTaskGetIdleTaskHandle()) / deltaTime;
+    xSemaphoreTakeRecursive(mLock, portMAX_DELAY);
+    sampleRunTimes();
+    uint8_t running_time_percentage = (mIdleLoad + 5) / 10;
     xSemaphoreGiveRecursive(mLock);
     return running_time_percentage;
 
@@ -175,5 +180,41 @@ uint8_t PIOS_TASK_MONITOR_GetIdlePercentage()
 #endif
 }
 
+/**
+ * Read and reset the run time counters of all the tasks, unless they were sampled
+ * less than PIOS_TASK_MONITOR_SAMPLE_MS ago. Reading the counters resets them, so
+ * callers that ask at different rates all get the loads of the same period instead
+ * of stealing run time from each other. Must be called with mLock held.
+ */
+static void sampleRunTimes()
+{
+#if (configGENERATE_RUN_TIME_STATS == 1)
+    portTickType now = xTaskGetTickCount();
+
+    if (mSampled && (now - mLastSampleTime) * portTICK_RATE_MS < PIOS_TASK_MONITOR_SAMPLE_MS) {
+        return;
+    }
+    mSampled = true;
+    mLastSampleTime = now;
+
+    /* Calculate the amount of elapsed run time between the last time we
+     * measured and now, avoid divide-by-zero if the interval is too small */
+    uint32_t currentTime = portGET_RUN_TIME_COUNTER_VALUE();
+    uint32_t deltaTime   = (currentTime - mLastMonitorTime) ? : 1;
+    mLastMonitorTime = currentTime;
+
+    for (uint16_t n = 0; n < mMaxTasks; ++n) {
+        if (mTaskHandles[n]) {
+            uint32_t load = ((uint64_t)uxTaskGetRunTime(mTaskHandles[n]) * 1000) / deltaTime;
+            mTaskLoads[n] = load < 1000 ? load : 1000;
+        } else {
+            mTaskLoads[n] = 0;
+        }
+    }
+    uint32_t idle = ((uint64_t)uxTaskGetRunTime(xTaskGetIdleTaskHandle()) * 1000) / deltaTime;
+    mIdleLoad = idle < 1000 ? idle : 1000;
+#endif /* configGENERATE_RUN_TIME_STATS */
+}
+
 
 #endif // PIOS_INCLUDE_TASK_MONITOR
@@ -38,6 +38,13 @@
 #include "pios_usbhook.h" /* PIOS_USBHOOK_Register* */
 #include "pios_usb_hid.h" /* PIOS_USB_HID_Register* */
 
+#ifdef BOOTLOADER
+/* firmware uploads are bound by the OUT polling rate, the endpoint NAKs while the rx buffer is full */
+#define HID_OUT_INTERVAL 1
+#else
+#define HID_OUT_INTERVAL 4
+#endif
+
 static const struct usb_device_desc device_desc = {
     .bLength = sizeof(struct usb_device_desc),
     .bDescriptorType    = USB_DESC_TYPE_DEVICE,
@@ -152,7 +159,7 @@ const struct usb_config_hid_only config_hid_only = {
         .bEndpointAddress = USB_EP_OUT(1),
         .bmAttributes     = USB_EP_ATTR_TT_INTERRUPT,
         .wMaxPacketSize   = htousbs(PIOS_USB_BOARD_HID_DATA_LENGTH),
-        .bInterval            = 4,                                      /* ms */
+        .bInterval            = HID_OUT_INTERVAL,                       /* ms */
     },
 };
 
@@ -39,6 +39,7 @@ static void stop_hsync_timers();
 static void reset_hsync_timers();
 static void prepare_line(uint32_t line_num);
 static void flush_spi();
+static void swap_buffers();
 
 // Private variables
 extern xSemaphoreHandle osdSemaphore;
@@ -77,13 +78,21 @@ volatile uint16_t line = 0;
 volatile uint16_t Vsync_update = 0;
 volatile uint16_t Hsync_update = 0;
 static int16_t m_osdLines = 0;
+// State of the frame in the draw buffer, the OSD task is woken for the next frame only
+// once it is done with the current one
+enum frame_state {
+    FRAME_DRAWING, // the OSD task has been woken and has not finished yet
+    FRAME_UNCHANGED, // the draw buffer was not updated, keep showing the display buffer
+    FRAME_UPDATED, // the draw buffer holds a complete new frame
+};
+static volatile enum frame_state frameState = FRAME_UNCHANGED;
 
 /**
  * swap_buffers: Swaps the two buffers. Contents in the display
  * buffer is seen on the output and the display buffer becomes
  * the new draw buffer.
  */
-void swap_buffers()
+static void swap_buffers()
 {
     // While we could use XOR swap this is more reliable and
     // dependable and it's only called a few times per second.
@@ -123,12 +132,19 @@ bool PIOS_Vsync_ISR()
     Hsync_update = 0;
     Vsync_update++;
     if (Vsync_update >= 2) {
-        // load second image buffer
-        swap_buffers();
         Vsync_update = 0;
 
-        // trigger redraw every second field
-        xHigherPriorityTaskWoken = xSemaphoreGiveFromISR(osdSemaphore, &xHigherPriorityTaskWoken);
+        // show the draw buffer only once it has been completely drawn, a frame
+        // that is not finished in time is shown at a later vsync instead of torn
+        if (frameState != FRAME_DRAWING) {
+            if (frameState == FRAME_UPDATED) {
+                swap_buffers();
+            }
+            frameState = FRAME_DRAWING;
+
+            // trigger redraw every second field
+            xHigherPriorityTaskWoken = xSemaphoreGiveFromISR(osdSemaphore, &xHigherPriorityTaskWoken);
+        }
     }
 
     portEND_SWITCHING_ISR(xHigherPriorityTaskWoken); // portEND_SWITCHING_ISR(xHigherPriorityTaskWoken);
@@ -136,6 +152,16 @@ bool PIOS_Vsync_ISR()
     return xHigherPriorityTaskWoken == pdTRUE;
 }
 
+/**
+ * Tell the video driver the OSD task is done with the frame it was woken for.
+ * Nothing must be drawn until the next osdSemaphore, which is given after the swap.
+ * \param[in] updated true if the draw buffer holds a new frame to display from the next vsync on
+ */
+void PIOS_Video_FrameDone(bool updated)
+{
+    frameState = updated ? FRAME_UPDATED : FRAME_UNCHANGED;
+}
+
 uint16_t PIOS_Video_GetOSDLines(void)
 {
     return m_osdLines;
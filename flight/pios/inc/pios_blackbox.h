@@ -0,0 +1,51 @@
+/**
+ ******************************************************************************
+ * @file       pios_blackbox.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @addtogroup PIOS PIOS Core hardware abstraction layer
+ * @{
+ * @addtogroup PIOS_BLACKBOX Raw flash blackbox log
+ * @{
+ * @brief Streams high rate UAVObject samples to a raw flash partition
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef PIOS_BLACKBOX_H
+#define PIOS_BLACKBOX_H
+
+#include <stdint.h>
+
+struct PIOS_BLACKBOX_Stats {
+    uint32_t used_bytes; /* bytes of the partition written so far */
+    uint32_t free_bytes; /* bytes left before the blackbox is full */
+    uint32_t dropped_records; /* records lost because the writer fell behind */
+    uint16_t session; /* current logging session, increases at each PIOS_BLACKBOX_NewSession() */
+};
+
+int32_t PIOS_BLACKBOX_Write(uintptr_t blackbox_id, uint32_t obj_id, uint16_t obj_inst_id, const uint8_t *obj_data, uint16_t obj_size);
+int32_t PIOS_BLACKBOX_NewSession(uintptr_t blackbox_id);
+int32_t PIOS_BLACKBOX_Process(uintptr_t blackbox_id);
+int32_t PIOS_BLACKBOX_Erase(uintptr_t blackbox_id);
+int32_t PIOS_BLACKBOX_Read(uintptr_t blackbox_id, uint32_t offset, uint8_t *data, uint16_t len);
+int32_t PIOS_BLACKBOX_GetStats(uintptr_t blackbox_id, struct PIOS_BLACKBOX_Stats *stats);
+
+#endif /* PIOS_BLACKBOX_H */
+
+/**
+ * @}
+ * @}
+ */
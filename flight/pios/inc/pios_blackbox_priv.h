@@ -0,0 +1,48 @@
+/**
+ ******************************************************************************
+ * @file       pios_blackbox_priv.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @addtogroup PIOS PIOS Core hardware abstraction layer
+ * @{
+ * @addtogroup PIOS_BLACKBOX Raw flash blackbox log
+ * @{
+ * @brief Streams high rate UAVObject samples to a raw flash partition
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef PIOS_BLACKBOX_PRIV_H
+#define PIOS_BLACKBOX_PRIV_H
+
+#include <stdint.h>
+#include "pios_flash.h" /* struct pios_flash_driver */
+
+struct pios_blackbox_cfg {
+    uint32_t start_offset; /* Offset into flash where the blackbox starts */
+    uint32_t size; /* Size of the blackbox partition, a multiple of sector_size */
+    uint32_t sector_size; /* Size of a flash erase block */
+    uint32_t page_size; /* Maximum flash burst write size */
+    uint16_t chunk_size; /* Size of each of the two RAM buffers, a multiple of page_size */
+};
+
+int32_t PIOS_BLACKBOX_Init(uintptr_t *blackbox_id, const struct pios_blackbox_cfg *cfg, const struct pios_flash_driver *driver, uintptr_t flash_id);
+
+#endif /* PIOS_BLACKBOX_PRIV_H */
+
+/**
+ * @}
+ * @}
+ */
@@ -186,6 +186,18 @@ int32_t PIOS_CALLBACKSCHEDULER_Dispatch(DelayedCallbackInfo *cbinfo);
  */
 int32_t PIOS_CALLBACKSCHEDULER_DispatchFromISR(DelayedCallbackInfo *cbinfo, long *pxHigherPriorityTaskWoken);
 
+/**
+ * Timing statistics of a callback in microseconds, saturated at 65535.
+ * Only collected if DIAG_TASKS is defined, all zero otherwise.
+ */
+struct pios_callback_timing {
+    uint16_t min;
+    uint16_t avg;
+    uint16_t max;
+    /** Upper bound of the 99th percentile */
+    uint16_t p99;
+};
+
 /**
  * Information about a running callback that has been registered
  * via a call to PIOS_CALLBACKSCHEDULER_Create().
@@ -197,6 +209,12 @@ struct pios_callback_info {
     bool     is_running;
     /** Count of executions of the callback since system start */
     uint32_t running_time_count;
+    /** Tenths of a percent of the cpu time used by the callback during the last second */
+    uint16_t running_time_permille;
+    /** Time from dispatch (or schedule expiry) until the callback is run */
+    struct pios_callback_timing latency;
+    /** Execution time of the callback */
+    struct pios_callback_timing execution;
 };
 
 /**
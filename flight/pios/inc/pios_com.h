@@ -52,12 +52,16 @@ extern int32_t PIOS_COM_SendCharNonBlocking(uint32_t com_id, char c);
 extern int32_t PIOS_COM_SendChar(uint32_t com_id, char c);
 extern int32_t PIOS_COM_SendBufferNonBlocking(uint32_t com_id, const uint8_t *buffer, uint16_t len);
 extern int32_t PIOS_COM_SendBuffer(uint32_t com_id, const uint8_t *buffer, uint16_t len);
+extern uint8_t *PIOS_COM_SendBufferReserve(uint32_t com_id, uint16_t len);
+extern int32_t PIOS_COM_SendBufferCommit(uint32_t com_id, uint16_t len);
 extern int32_t PIOS_COM_SendStringNonBlocking(uint32_t com_id, const char *str);
 extern int32_t PIOS_COM_SendString(uint32_t com_id, const char *str);
 extern int32_t PIOS_COM_SendFormattedStringNonBlocking(uint32_t com_id, const char *format, ...);
 extern int32_t PIOS_COM_SendFormattedString(uint32_t com_id, const char *format, ...);
 extern uint16_t PIOS_COM_ReceiveBuffer(uint32_t com_id, uint8_t *buf, uint16_t buf_len, uint32_t timeout_ms);
+extern uint16_t PIOS_COM_ForwardBuffer(uint32_t src_id, uint32_t dst_id, uint16_t max_len, uint32_t timeout_ms);
 extern bool PIOS_COM_Available(uint32_t com_id);
+extern uint16_t PIOS_COM_GetTxFree(uint32_t com_id);
 
 #endif /* PIOS_COM_H */
 
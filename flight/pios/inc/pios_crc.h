@@ -38,5 +38,11 @@ uint16_t PIOS_CRC16_updateCRC(uint16_t crc, const uint8_t *data, int32_t length)
 
 uint32_t PIOS_CRC32_updateByte(uint32_t crc, const uint8_t data);
 uint32_t PIOS_CRC32_updateCRC(uint32_t crc, const uint8_t *data, int32_t length);
+uint32_t PIOS_CRC32_calcBlock(const uint8_t *data, int32_t length);
+
+#if defined(STM32F4XX)
+bool PIOS_CRC_HW_Claim(void);
+void PIOS_CRC_HW_Release(void);
+#endif
 
 #endif /* PIOS_CRC_H */
@@ -43,15 +43,22 @@ void PIOS_DEBUGLOG_Initialize();
  */
 void PIOS_DEBUGLOG_Enable(uint8_t enabled);
 
+/**
+ * @brief Sends UAVObject entries to the blackbox instead of the log filesystem
+ * @param[in] enable or disable the blackbox, ignored on boards without one
+ */
+void PIOS_DEBUGLOG_EnableBlackbox(uint8_t enabled);
+
 /**
  * @brief Write a debug log entry with a uavobject
  * @param[in] objectid
  * @param[in] instanceid
- * @param[in] instanceid
  * @param[in] size of object
+ * @param[in] number of 32 bit fields, stored first
+ * @param[in] number of 16 bit fields, stored after the 32 bit ones
  * @param[in] data buffer
  */
-void PIOS_DEBUGLOG_UAVObject(uint32_t objid, uint16_t instid, size_t size, uint8_t *data);
+void PIOS_DEBUGLOG_UAVObject(uint32_t objid, uint16_t instid, size_t size, uint16_t num_words, uint16_t num_halfwords, uint8_t *data);
 
 /**
  * @brief Write a debug log entry with text
@@ -61,6 +68,38 @@ void PIOS_DEBUGLOG_UAVObject(uint32_t objid, uint16_t instid, size_t size, uint8
  */
 void PIOS_DEBUGLOG_Printf(char *format, ...);
 
+/**
+ * @brief Write a debug log entry with a message in the deferred format
+ * Only the offset of the format string in the debuglog_fmt section and the raw
+ * arguments are logged, the GCS formats the message with the string table made
+ * from the firmware (fw_<board>.debuglog). Cheap enough for the hot paths.
+ * Conversions: d i u o x X c p as 32 bit integers, e f g a as floats and s
+ * truncated to 32 characters.
+ * @param[in] format - as in printf, must be a string literal
+ * @param[in] variable arguments for printf
+ */
+#define PIOS_DEBUGLOG_MESSAGE(format, ...) \
+    do { \
+        static const char __attribute__((section("debuglog_fmt"))) pios_debuglog_format[] = format; \
+        PIOS_DEBUGLOG_Message(pios_debuglog_format,##__VA_ARGS__); \
+    } while (0)
+
+/**
+ * @brief Write a debug log entry with a message in the deferred format, use PIOS_DEBUGLOG_MESSAGE()
+ * @param[in] format string in the debuglog_fmt section
+ * @param[in] variable arguments for printf
+ */
+void PIOS_DEBUGLOG_Message(const char *format, ...);
+
+/**
+ * @brief Write a debug log entry with a block of instrumentation trace events
+ * Trace entries are written whenever the log has room, even if logging is disabled
+ * @param[in] size of the trace data, truncated to the maximum entry size
+ * @param[in] data buffer
+ * @return true if the entry was written
+ */
+bool PIOS_DEBUGLOG_Trace(size_t size, uint8_t *data);
+
 /**
  * @brief Load one object instance from the filesystem
  * @param[out] buffer where to store the uavobject
@@ -84,6 +123,30 @@ int32_t PIOS_DEBUGLOG_Read(void *buffer, uint16_t flight, uint16_t inst);
  */
 void PIOS_DEBUGLOG_Info(uint16_t *flight, uint16_t *entry, uint16_t *free, uint16_t *used);
 
+/**
+ * @brief Retrieve run time info of the blackbox
+ * @param[out] bytes logged
+ * @param[out] bytes left
+ * @param[out] samples dropped because the writer fell behind
+ * @return 0 if success, -1 if there is no blackbox
+ */
+int32_t PIOS_DEBUGLOG_BlackboxInfo(uint32_t *used, uint32_t *free, uint32_t *dropped);
+
+/**
+ * @brief Read back raw blackbox contents
+ * @param[out] buffer for the data
+ * @param[in] byte offset into the blackbox
+ * @param[in] size of the buffer
+ * @return number of bytes read, 0 past the end, < 0 on error or if there is no blackbox
+ */
+int32_t PIOS_DEBUGLOG_ReadBlackbox(uint8_t *buffer, uint32_t offset, uint16_t size);
+
+/**
+ * @brief Run the blackbox writer, call periodically from a low priority task
+ * @return 1 if more work is pending, 0 if idle, < 0 on error or if there is no blackbox
+ */
+int32_t PIOS_DEBUGLOG_ProcessBlackbox(void);
+
 /**
  * @brief Format entire flash memory!!!
  */
@@ -45,6 +45,8 @@ void PIOS_DELTATIME_Init(PiOSDeltatimeConfig *config, float average, float min,
 
 float PIOS_DELTATIME_GetAverageSeconds(PiOSDeltatimeConfig *config);
 
+float PIOS_DELTATIME_GetAverageSecondsSince(PiOSDeltatimeConfig *config, uint32_t time);
+
 #endif /* PIOS_DELTATIME_H */
 
 /**
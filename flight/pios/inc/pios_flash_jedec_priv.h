@@ -51,6 +51,13 @@ struct pios_flash_jedec_cfg {
     uint8_t fast_read_dummy_bytes;
 };
 
+/* Completion callback of the non-blocking operations, status is 0 on success */
+typedef void (*pios_flash_jedec_callback)(uintptr_t flash_id, int32_t status, uint32_t context);
+
 int32_t PIOS_Flash_Jedec_Init(uintptr_t *flash_id, uint32_t spi_id, uint32_t slave_num);
+int32_t PIOS_Flash_Jedec_EraseSectorAsync(uintptr_t flash_id, uint32_t addr, pios_flash_jedec_callback callback, uint32_t context);
+int32_t PIOS_Flash_Jedec_WriteDataAsync(uintptr_t flash_id, uint32_t addr, uint8_t *data, uint16_t len, pios_flash_jedec_callback callback, uint32_t context);
+int32_t PIOS_Flash_Jedec_ReadDataAsync(uintptr_t flash_id, uint32_t addr, uint8_t *data, uint16_t len, pios_flash_jedec_callback callback, uint32_t context);
+int32_t PIOS_Flash_Jedec_Poll(uintptr_t flash_id);
 
 #endif /* PIOS_FLASH_JEDEC_H */
@@ -42,4 +42,8 @@ int32_t PIOS_FLASHFS_ObjSave(uintptr_t fs_id, uint32_t obj_id, uint16_t obj_inst
 int32_t PIOS_FLASHFS_ObjLoad(uintptr_t fs_id, uint32_t obj_id, uint16_t obj_inst_id, uint8_t *obj_data, uint16_t obj_size);
 int32_t PIOS_FLASHFS_ObjDelete(uintptr_t fs_id, uint32_t obj_id, uint16_t obj_inst_id);
 int32_t PIOS_FLASHFS_GetStats(uintptr_t fs_id, struct PIOS_FLASHFS_Stats *stats);
+int32_t PIOS_FLASHFS_Compact(uintptr_t fs_id, uint16_t max_slots);
+int32_t PIOS_FLASHFS_BatchBegin(uintptr_t fs_id);
+int32_t PIOS_FLASHFS_BatchSave(uintptr_t fs_id, uint32_t obj_id, uint16_t obj_inst_id, uint8_t *obj_data, uint16_t obj_size);
+int32_t PIOS_FLASHFS_BatchCommit(uintptr_t fs_id);
 #endif /* PIOS_FLASHFS_H */
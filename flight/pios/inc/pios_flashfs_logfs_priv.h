@@ -39,6 +39,10 @@ struct flashfs_logfs_cfg {
     uint32_t start_offset; /* Offset into flash where this filesystem starts */
     uint32_t sector_size; /* Size of a flash erase block */
     uint32_t page_size; /* Maximum flash burst write size */
+
+    uint16_t index_size; /* Number of active objects tracked in RAM, 0 to always scan the flash */
+    uint16_t gc_headroom; /* Free slots below which PIOS_FLASHFS_Compact starts, 0 to only collect when full */
+    uint16_t batch_size; /* Saves held back until PIOS_FLASHFS_BatchCommit, 0 to write each one through */
 };
 
 int32_t PIOS_FLASHFS_Logfs_Init(uintptr_t *fs_id, const struct flashfs_logfs_cfg *cfg, const struct pios_flash_driver *driver, uintptr_t flash_id);
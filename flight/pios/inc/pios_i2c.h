@@ -48,6 +48,23 @@ struct pios_i2c_txn {
     uint8_t    *buf;
 };
 
+/*
+ * Completion callback of the queued transfers with the PIOS_I2C_Transfer() result, never called from the
+ * I2C interrupt. The F4 adapter calls it from the I2C callback scheduler task (CALLBACK_TASK_DEVICEDRIVER),
+ * or from a task waiting in PIOS_I2C_Transfer() for the queue. The F1 and F0 adapters have no queue, they
+ * run the transfer and call it from PIOS_I2C_Transfer_Queued(), in the caller's context.
+ */
+typedef void (*pios_i2c_callback)(uint32_t context, int32_t status);
+
+/* Queued transfer, owned by the driver from PIOS_I2C_Transfer_Queued() until its callback or PIOS_I2C_Transfer_Cancel() */
+struct pios_i2c_request {
+    const struct pios_i2c_txn *txn_list;
+    uint32_t num_txns;
+    pios_i2c_callback callback;
+    uint32_t context;
+    struct pios_i2c_request   *next;
+};
+
 #define I2C_LOG_DEPTH 20
 enum pios_i2c_error_type {
     PIOS_I2C_ERROR_EVENT,
@@ -66,6 +83,8 @@ struct pios_i2c_fault_history {
 /* Public Functions */
 extern int32_t PIOS_I2C_Transfer(uint32_t i2c_id, const struct pios_i2c_txn txn_list[], uint32_t num_txns);
 extern int32_t PIOS_I2C_Transfer_Callback(uint32_t i2c_id, const struct pios_i2c_txn txn_list[], uint32_t num_txns, void *callback);
+extern int32_t PIOS_I2C_Transfer_Queued(uint32_t i2c_id, struct pios_i2c_request *request);
+extern int32_t PIOS_I2C_Transfer_Cancel(uint32_t i2c_id, struct pios_i2c_request *request);
 extern void PIOS_I2C_EV_IRQ_Handler(uint32_t i2c_id);
 extern void PIOS_I2C_ER_IRQ_Handler(uint32_t i2c_id);
 extern void PIOS_I2C_IRQ_Handler(uint32_t i2c_id);
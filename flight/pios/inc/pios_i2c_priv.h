@@ -70,6 +70,16 @@ struct pios_i2c_adapter {
 
     void    (*callback)();
 
+    /* Queued transfers, the head is on the bus while queue_active is set */
+    struct pios_i2c_request *queue_head;
+    struct pios_i2c_request *queue_tail;
+    volatile bool queue_active;
+    /* A task completes or aborts the transfer on the bus */
+    volatile bool queue_servicing;
+    uint32_t queue_start_time;
+    /* A blocking transfer is on the bus */
+    volatile bool sync_active;
+
     uint8_t *active_byte;
     uint8_t *last_byte;
 };
@@ -46,8 +46,12 @@ typedef int32_t (*initcall_t)(void);
 typedef struct {
     initcall_t fn_minit;
     initcall_t fn_tinit;
+    uint32_t   flags;
 } initmodule_t;
 
+/* The module is initialised and started by MODULE_INITIALISE_DEFERRED, once the others run */
+#define MODULE_INITCALL_FLAG_DEFERRED 0x01
+
 /* Init module section */
 extern initmodule_t __module_initcall_start[], __module_initcall_end[];
 
@@ -57,6 +61,7 @@ extern void InitModules();
 extern void StartModules();
 
 #define MODULE_INITCALL(ifn, sfn)
+#define MODULE_INITCALL_DEFERRED(ifn, sfn)
 
 #define MODULE_TASKCREATE_ALL \
     { \
@@ -71,6 +76,10 @@ extern void StartModules();
         /* Initialize the system thread */ \
         SystemModInitialize(); }
 
+#define MODULE_INITIALISE_DEFERRED
+
+#define PIOS_INITCALL_PROFILE(phase, code) { code; }
+
 #else
 
 /* initcalls are now grouped by functionality into separate
@@ -85,25 +94,82 @@ extern void StartModules();
     static initcall_t __initcall_##fn##id __attribute__((__used__)) \
     __attribute__((__section__(".initcall" level ".init"))) = fn
 
-#define __define_module_initcall(level, ifn, sfn) \
+#define __define_module_initcall(level, ifn, sfn, fl) \
     static initmodule_t __initcall_##ifn __attribute__((__used__)) \
-    __attribute__((__section__(".initcall" level ".init"))) = { .fn_minit = ifn, .fn_tinit = sfn }
+    __attribute__((__section__(".initcall" level ".init"))) = { .fn_minit = ifn, .fn_tinit = sfn, .flags = fl }
+
+#define MODULE_INITCALL(ifn, sfn)          __define_module_initcall("module", ifn, sfn, 0)
+
+/* For the modules the flight does not depend on (logging, tuning aids...), they are
+ * brought up by the System task after all the other modules have been started */
+#define MODULE_INITCALL_DEFERRED(ifn, sfn) __define_module_initcall("module", ifn, sfn, MODULE_INITCALL_FLAG_DEFERRED)
+
+#ifdef PIOS_INCLUDE_INITCALL_PROFILE
+
+/* Boot phases, timed by PIOS_INITCALL_PROFILE() */
+enum pios_initcall_phase {
+    PIOS_INITCALL_PHASE_BOARD, /* PIOS_Board_Init() */
+    PIOS_INITCALL_PHASE_INIT, /* MODULE_INITIALISE_ALL */
+    PIOS_INITCALL_PHASE_TASKCREATE, /* MODULE_TASKCREATE_ALL */
+    PIOS_INITCALL_PHASE_DEFERRED, /* MODULE_INITIALISE_DEFERRED */
+    PIOS_INITCALL_PHASE_NUM
+};
+
+/* Module initcalls beyond this are run but not timed */
+#ifndef PIOS_INITCALL_PROFILE_MAX
+#define PIOS_INITCALL_PROFILE_MAX 32
+#endif
+
+struct pios_initcall_profile {
+    uint32_t phase_end_us[PIOS_INITCALL_PHASE_NUM]; /* since PIOS_INITCALL_ProfileBoot() */
+    uint32_t phase_us[PIOS_INITCALL_PHASE_NUM];
+    uint32_t minit_us[PIOS_INITCALL_PROFILE_MAX]; /* in the module section order */
+    uint32_t tinit_us[PIOS_INITCALL_PROFILE_MAX];
+};
+
+extern void PIOS_INITCALL_ProfileBoot(void);
+extern void PIOS_INITCALL_ProfilePhase(enum pios_initcall_phase phase, uint32_t raw_start);
+extern void PIOS_INITCALL_ProfileCall(const initmodule_t *fn, bool task, uint32_t raw_start);
+extern const struct pios_initcall_profile *PIOS_INITCALL_GetProfile(void);
+
+#define PIOS_INITCALL_PROFILE(phase, code) \
+    { uint32_t __raw_start = PIOS_DELAY_GetRaw(); \
+      code; \
+      PIOS_INITCALL_ProfilePhase(phase, __raw_start); \
+    }
 
-#define MODULE_INITCALL(ifn, sfn) __define_module_initcall("module", ifn, sfn)
+#define __module_initcall_run(fn, member, task) \
+    { uint32_t __raw_start = PIOS_DELAY_GetRaw(); \
+      (fn->member)(); \
+      PIOS_INITCALL_ProfileCall(fn, task, __raw_start); \
+    }
 
-#define MODULE_INITIALISE_ALL \
+#else /* PIOS_INCLUDE_INITCALL_PROFILE */
+
+#define PIOS_INITCALL_PROFILE(phase, code) { code; }
+
+#define __module_initcall_run(fn, member, task) (fn->member)()
+
+#endif /* PIOS_INCLUDE_INITCALL_PROFILE */
+
+#define __module_initcall_foreach(member, task, deferred) \
     { for (initmodule_t *fn = __module_initcall_start; fn < __module_initcall_end; fn++) { \
-          if (fn->fn_minit) { \
-              (fn->fn_minit)(); } \
+          if (fn->member && ((fn->flags & MODULE_INITCALL_FLAG_DEFERRED) != 0) == (deferred)) { \
+              __module_initcall_run(fn, member, task); } \
       } \
     }
 
+#define MODULE_INITIALISE_ALL \
+    PIOS_INITCALL_PROFILE(PIOS_INITCALL_PHASE_INIT, __module_initcall_foreach(fn_minit, false, false))
+
 #define MODULE_TASKCREATE_ALL \
-    { for (initmodule_t *fn = __module_initcall_start; fn < __module_initcall_end; fn++) { \
-          if (fn->fn_tinit) { \
-              (fn->fn_tinit)(); } \
-      } \
-    }
+    PIOS_INITCALL_PROFILE(PIOS_INITCALL_PHASE_TASKCREATE, __module_initcall_foreach(fn_tinit, true, false))
+
+/* Initialise and start the deferred modules, after MODULE_TASKCREATE_ALL */
+#define MODULE_INITIALISE_DEFERRED \
+    PIOS_INITCALL_PROFILE(PIOS_INITCALL_PHASE_DEFERRED, \
+                          __module_initcall_foreach(fn_minit, false, true) \
+                          __module_initcall_foreach(fn_tinit, true, true))
 
 #endif /* USE_SIM_POSIX */
 
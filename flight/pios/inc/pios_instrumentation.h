@@ -39,9 +39,50 @@ typedef struct {
 
 typedef void *pios_counter_t;
 
+typedef enum {
+    PIOS_TRACE_EVENT_ENTER  = 0,
+    PIOS_TRACE_EVENT_EXIT   = 1,
+    PIOS_TRACE_EVENT_PERIOD = 2,
+    PIOS_TRACE_EVENT_VALUE  = 3,
+} pios_trace_event_type_t;
+
+typedef struct {
+    uint32_t timestamp; // raw PIOS_DELAY_GetRaw() time (cycle counter where available)
+    uint32_t id; // id of the counter that generated the event
+    uint8_t  type; // @see pios_trace_event_type_t
+} __attribute__((packed)) pios_trace_event_t;
+
 extern pios_perf_counter_t *pios_instrumentation_perf_counters;
 extern int8_t pios_instrumentation_last_used_counter;
 
+extern pios_trace_event_t *pios_instrumentation_trace;
+extern uint16_t pios_instrumentation_trace_mask;
+extern uint16_t pios_instrumentation_trace_head;
+extern uint16_t pios_instrumentation_trace_count;
+extern bool pios_instrumentation_trace_enabled;
+
+/**
+ * Append an event to the trace ring buffer, overwriting the oldest event when full.
+ * Must be called from within a critical section.
+ * @param counter the counter that generated the event
+ * @param type the kind of event @see pios_trace_event_type_t
+ * @param timestamp raw timestamp of the event
+ */
+inline void PIOS_Instrumentation_TraceEvent(const pios_perf_counter_t *counter, uint8_t type, uint32_t timestamp)
+{
+    if (!pios_instrumentation_trace_enabled) {
+        return;
+    }
+    pios_trace_event_t *event = &pios_instrumentation_trace[pios_instrumentation_trace_head];
+    event->timestamp = timestamp;
+    event->id   = counter->id;
+    event->type = type;
+    pios_instrumentation_trace_head = (pios_instrumentation_trace_head + 1) & pios_instrumentation_trace_mask;
+    if (pios_instrumentation_trace_count <= pios_instrumentation_trace_mask) {
+        pios_instrumentation_trace_count++;
+    }
+}
+
 /**
  * Update a counter with a new value
  * @param counter_handle handle of the counter to update @see PIOS_Instrumentation_SearchCounter @see PIOS_Instrumentation_CreateCounter
@@ -62,6 +103,7 @@ inline void PIOS_Instrumentation_updateCounter(pios_counter_t counter_handle, in
         counter->min = counter->value;
     }
     counter->lastUpdateTS = PIOS_DELAY_GetRaw();
+    PIOS_Instrumentation_TraceEvent(counter, PIOS_TRACE_EVENT_VALUE, counter->lastUpdateTS);
     vPortExitCritical();
 }
 
@@ -76,6 +118,7 @@ inline void PIOS_Instrumentation_TimeStart(pios_counter_t counter_handle)
     pios_perf_counter_t *counter = (pios_perf_counter_t *)counter_handle;
 
     counter->lastUpdateTS = PIOS_DELAY_GetRaw();
+    PIOS_Instrumentation_TraceEvent(counter, PIOS_TRACE_EVENT_ENTER, counter->lastUpdateTS);
     vPortExitCritical();
 }
 
@@ -88,8 +131,10 @@ inline void PIOS_Instrumentation_TimeEnd(pios_counter_t counter_handle)
     PIOS_Assert(pios_instrumentation_perf_counters && counter_handle);
     vPortEnterCritical();
     pios_perf_counter_t *counter = (pios_perf_counter_t *)counter_handle;
+    uint32_t now = PIOS_DELAY_GetRaw();
 
-    counter->value = PIOS_DELAY_DiffuS(counter->lastUpdateTS);
+    PIOS_Instrumentation_TraceEvent(counter, PIOS_TRACE_EVENT_EXIT, now);
+    counter->value = PIOS_DELAY_DiffuS2(counter->lastUpdateTS, now);
     counter->max--;
     if (counter->value > counter->max) {
         counter->max = counter->value;
@@ -125,6 +170,11 @@ inline void PIOS_Instrumentation_TrackPeriod(pios_counter_t counter_handle)
         vPortExitCritical();
     }
     counter->lastUpdateTS = PIOS_DELAY_GetRaw();
+    if (pios_instrumentation_trace_enabled) {
+        vPortEnterCritical();
+        PIOS_Instrumentation_TraceEvent(counter, PIOS_TRACE_EVENT_PERIOD, counter->lastUpdateTS);
+        vPortExitCritical();
+    }
 }
 
 /**
@@ -156,4 +206,25 @@ typedef void (*InstrumentationCounterCallback)(const pios_perf_counter_t *counte
  */
 void PIOS_Instrumentation_ForEachCounter(InstrumentationCounterCallback callback, void *context);
 
+/**
+ * Allocate the trace ring buffer. Tracing starts disabled. @see PIOS_Instrumentation_EnableTrace
+ * @param length number of events the ring can hold, rounded down to a power of two. 0 disables tracing.
+ */
+void PIOS_Instrumentation_InitTrace(uint16_t length);
+
+/**
+ * Start or stop recording enter/exit events into the trace ring buffer.
+ * Starting a trace discards any previously recorded events.
+ * @param enable true to start recording, false to stop
+ */
+void PIOS_Instrumentation_EnableTrace(bool enable);
+
+/**
+ * Copy the recorded events, oldest first, and remove them from the ring.
+ * @param events buffer that receives the events
+ * @param maxEvents maximum number of events to copy
+ * @return the number of events copied
+ */
+uint16_t PIOS_Instrumentation_ReadTrace(pios_trace_event_t *events, uint16_t maxEvents);
+
 #endif /* PIOS_INSTRUMENTATION_H */
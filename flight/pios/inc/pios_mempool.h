@@ -0,0 +1,62 @@
+/**
+ ******************************************************************************
+ *
+ * @file       pios_mempool.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @addtogroup PiOS
+ * @{
+ * @addtogroup PiOS
+ * @{
+ * @brief PiOS fixed size block pool
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef PIOS_MEMPOOL_H
+#define PIOS_MEMPOOL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+ * Pool of fixed size blocks, the storage for all the blocks is allocated
+ * once by PIOS_MEMPOOL_Init() so that allocating and freeing a block is
+ * constant time and does not fragment the heap.
+ * When the pool is empty the blocks are allocated from the heap instead,
+ * these allocations are counted in overflows so the pool can be resized.
+ * The pool does no locking, the caller must serialize the accesses.
+ */
+struct pios_mempool {
+    void     *free_list;
+    uint8_t  *storage;
+    uint16_t block_size;
+    uint16_t num_blocks;
+    uint16_t used; /* blocks in use, heap allocations included */
+    uint16_t max_used; /* high-water mark of used */
+    uint16_t overflows; /* blocks allocated from the heap because the pool was empty */
+    bool     fast;
+};
+
+int32_t PIOS_MEMPOOL_Init(struct pios_mempool *pool, size_t block_size, uint16_t num_blocks, bool fast);
+void *PIOS_MEMPOOL_Alloc(struct pios_mempool *pool);
+void PIOS_MEMPOOL_Free(struct pios_mempool *pool, void *block);
+
+#endif /* PIOS_MEMPOOL_H */
+
+/**
+ * @}
+ * @}
+ */
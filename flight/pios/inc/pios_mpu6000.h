@@ -151,6 +151,7 @@ struct pios_mpu6000_cfg {
     SPIPrescalerTypeDef fast_prescaler;
     SPIPrescalerTypeDef std_prescaler;
     uint8_t max_downsample;
+    uint8_t fifo_burst; /* when > 1 samples are queued in the chip FIFO and read in a single burst every fifo_burst samples */
 };
 
 /* Public Functions */
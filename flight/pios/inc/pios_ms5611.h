@@ -43,6 +43,7 @@
 
 struct pios_ms5611_cfg {
     uint32_t oversampling;
+    uint8_t  temperature_interleaving; // pressure conversions per temperature conversion, 0 for the default
 };
 
 enum pios_ms5611_osr {
@@ -697,6 +697,11 @@ struct pios_rfm22b_dev {
 
     // The RF datarate lookup index.
     uint8_t  datarate;
+    // The configured datarate, and the datarate used when the link quality is poor.
+    uint8_t  nominal_datarate;
+    uint8_t  fallback_datarate;
+    // The time of the last datarate change.
+    portTickType datarate_ticks;
 
     // The radio state machine state
     enum pios_radio_state state;
@@ -763,6 +768,9 @@ struct pios_rfm22b_dev {
     // Are we sending / receiving only PPM data?
     bool         ppm_only_mode;
 
+    // The configured channel range
+    uint8_t      min_chan;
+    uint8_t      max_chan;
     // The channel list
     uint8_t      channels[RFM22B_NUM_CHANNELS];
     // The number of frequency hopping channels.
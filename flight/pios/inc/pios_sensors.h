@@ -51,6 +51,8 @@ typedef struct PIOS_SENSORS_Driver {
     PIOS_SENSORS_get_queue_function get_queue; // get the queue reference
     PIOS_SENSORS_get_scale_function get_scale; // return scales for the sensors
     bool is_polled;
+    bool is_burst; // queue carries PIOS_SENSORS_3Axis_SensorsBurstWithTemp blocks instead of single samples
+    bool is_event_driven; // polled sensor signalling new data with PIOS_SENSORS_DataReadyFromISR(), poll is not called
 } PIOS_SENSORS_Driver;
 
 typedef enum PIOS_SENSORS_TYPE {
@@ -69,6 +71,8 @@ typedef struct PIOS_SENSORS_Instance {
     uintptr_t context;
     struct PIOS_SENSORS_Instance *next;
     uint8_t type;
+    volatile bool     data_ready; // set by PIOS_SENSORS_DataReadyFromISR() for event driven sensors
+    volatile uint32_t data_ready_time; // PIOS_DELAY_GetRaw() time of the last data ready signal
 } PIOS_SENSORS_Instance;
 
 /**
@@ -77,9 +81,25 @@ typedef struct PIOS_SENSORS_Instance {
 typedef struct PIOS_SENSORS_3Axis_SensorsWithTemp {
     uint16_t   count; // number of sensor instances
     int16_t    temperature;  // Degrees Celsius * 100
+    uint32_t   timestamp; // PIOS_DELAY_GetRaw() time the sample was captured, 0 if unknown
     Vector3i16 sample[];
 } PIOS_SENSORS_3Axis_SensorsWithTemp;
 
+/**
+ * A burst of 3d samples read from a sensor FIFO in a single bus transaction.
+ * sample holds burst * count entries, oldest first, count consecutive entries per sample time
+ */
+typedef struct PIOS_SENSORS_3Axis_SensorsBurstWithTemp {
+    uint16_t   count; // number of sensor instances
+    uint16_t   burst; // number of samples for each sensor instance
+    int16_t    temperature; // Degrees Celsius * 100, averaged over the burst
+    uint32_t   timestamp; // PIOS_DELAY_GetRaw() time the newest sample was captured, 0 if unknown
+    Vector3i16 sample[];
+} PIOS_SENSORS_3Axis_SensorsBurstWithTemp;
+
+// maximum number of samples a driver may put in a single burst
+#define PIOS_SENSORS_MAX_BURST 16
+
 typedef struct PIOS_SENSORS_1Axis_SensorsWithTemp {
     float temperature; // Degrees Celsius
     float sample; // sample
@@ -125,7 +145,9 @@ static inline bool PIOS_SENSORS_Poll(const PIOS_SENSORS_Instance *sensor)
 {
     PIOS_Assert(sensor);
 
-    if (!sensor->driver->poll) {
+    if (sensor->driver->is_event_driven) {
+        return sensor->data_ready;
+    } else if (!sensor->driver->poll) {
         return true;
     } else {
         return sensor->driver->poll(sensor->context);
@@ -137,12 +159,34 @@ static inline bool PIOS_SENSORS_Poll(const PIOS_SENSORS_Instance *sensor)
  * @param samples
  * @param size
  */
-static inline void PIOS_SENSOR_Fetch(const PIOS_SENSORS_Instance *sensor, void *samples, uint8_t size)
+static inline void PIOS_SENSOR_Fetch(PIOS_SENSORS_Instance *sensor, void *samples, uint8_t size)
 {
     PIOS_Assert(sensor);
+    // cleared before reading so that a data ready signal raised meanwhile is not lost
+    sensor->data_ready = false;
     sensor->driver->fetch(samples, size, sensor->context);
 }
 
+/**
+ * Signal that an event driven sensor has new data, to be called from the data ready interrupt
+ * @param sensor instance that has new data
+ */
+static inline void PIOS_SENSORS_DataReadyFromISR(PIOS_SENSORS_Instance *sensor)
+{
+    sensor->data_ready_time = PIOS_DELAY_GetRaw();
+    sensor->data_ready = true;
+}
+
+/**
+ * Time the data of an event driven sensor were signalled as ready
+ * @param sensor instance
+ * @return PIOS_DELAY_GetRaw() time of the last data ready signal
+ */
+static inline uint32_t PIOS_SENSORS_GetDataReadyTime(const PIOS_SENSORS_Instance *sensor)
+{
+    return sensor->data_ready_time;
+}
+
 static inline void PIOS_SENSOR_Reset(const PIOS_SENSORS_Instance *sensor)
 {
     PIOS_Assert(sensor);
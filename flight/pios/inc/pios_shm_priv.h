@@ -0,0 +1,40 @@
+/**
+ ******************************************************************************
+ *
+ * @file       pios_shm_priv.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @brief      Shared memory COM private definitions.
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef PIOS_SHM_PRIV_H
+#define PIOS_SHM_PRIV_H
+
+#include <pios.h>
+#include <pios_shm_ring.h>
+
+struct pios_shm_cfg {
+    const char *name; /* shared memory object, see PIOS_SHM_NAME_FORMAT */
+};
+
+extern int32_t PIOS_SHM_Init(uint32_t *shm_id, const struct pios_shm_cfg *cfg);
+
+extern const struct pios_com_driver pios_shm_com_driver;
+
+#endif /* PIOS_SHM_PRIV_H */
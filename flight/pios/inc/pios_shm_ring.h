@@ -0,0 +1,184 @@
+/**
+ ******************************************************************************
+ *
+ * @file       pios_shm_ring.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @brief      Layout of the shared memory link between SITL and the GCS.
+ *             Shared with the GCS shared memory connection plugin, keep it
+ *             free of PiOS dependencies.
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef PIOS_SHM_RING_H
+#define PIOS_SHM_RING_H
+
+#include <stdint.h>
+#include <string.h>
+
+#define PIOS_SHM_MAGIC       0x4D53504F /* "OPSM" */
+#define PIOS_SHM_VERSION     1
+/* Name of the shared memory object of a simposix instance */
+#define PIOS_SHM_NAME_FORMAT "/openpilot-sitl-%u"
+/* Must be a power of two */
+#define PIOS_SHM_RING_SIZE   65536
+
+/*
+ * Single producer, single consumer byte ring. head and tail count the bytes
+ * written and read since the ring was reset and wrap around at 2^32, each is
+ * only changed by one side and sits in its own cache line.
+ */
+struct pios_shm_ring {
+    volatile uint32_t head;
+    uint8_t  head_pad[60];
+    volatile uint32_t tail;
+    uint8_t  tail_pad[60];
+    uint8_t  data[PIOS_SHM_RING_SIZE];
+};
+
+/*
+ * The shared memory object, created and reset by the firmware.
+ * magic is written last so the GCS never sees a half initialized region.
+ */
+struct pios_shm_region {
+    volatile uint32_t    magic;
+    uint32_t version;
+    uint8_t  pad[56];
+    struct pios_shm_ring to_gcs;
+    struct pios_shm_ring to_fc;
+};
+
+static inline void pios_shm_ring_reset(struct pios_shm_ring *ring)
+{
+    ring->head = 0;
+    ring->tail = 0;
+}
+
+static inline uint32_t pios_shm_ring_used(const struct pios_shm_ring *ring)
+{
+    return ring->head - ring->tail;
+}
+
+static inline uint32_t pios_shm_ring_free(const struct pios_shm_ring *ring)
+{
+    return PIOS_SHM_RING_SIZE - (ring->head - ring->tail);
+}
+
+/**
+ * Producer side, contiguous free space to copy data into before
+ * committing it with pios_shm_ring_commit_write()
+ * @param[out] len size of the space
+ */
+static inline uint8_t *pios_shm_ring_write_ptr(struct pios_shm_ring *ring, uint32_t *len)
+{
+    uint32_t offset = ring->head & (PIOS_SHM_RING_SIZE - 1);
+    uint32_t space  = pios_shm_ring_free(ring);
+
+    *len = (space < PIOS_SHM_RING_SIZE - offset) ? space : PIOS_SHM_RING_SIZE - offset;
+    return &ring->data[offset];
+}
+
+static inline void pios_shm_ring_commit_write(struct pios_shm_ring *ring, uint32_t len)
+{
+    /* The data must be visible before the new head */
+    __sync_synchronize();
+    ring->head += len;
+}
+
+/**
+ * Consumer side, contiguous data to copy out before handing the
+ * space back with pios_shm_ring_commit_read()
+ * @param[out] len size of the data
+ */
+static inline uint8_t *pios_shm_ring_read_ptr(struct pios_shm_ring *ring, uint32_t *len)
+{
+    uint32_t offset = ring->tail & (PIOS_SHM_RING_SIZE - 1);
+    uint32_t used   = pios_shm_ring_used(ring);
+
+    *len = (used < PIOS_SHM_RING_SIZE - offset) ? used : PIOS_SHM_RING_SIZE - offset;
+    /* The data must not be read before the head it was published with */
+    __sync_synchronize();
+    return &ring->data[offset];
+}
+
+static inline void pios_shm_ring_commit_read(struct pios_shm_ring *ring, uint32_t len)
+{
+    /* The data must be copied out before the space is handed back */
+    __sync_synchronize();
+    ring->tail += len;
+}
+
+/**
+ * Producer side, copy as much of data as fits
+ * @return the number of bytes written
+ */
+static inline uint32_t pios_shm_ring_write(struct pios_shm_ring *ring, const uint8_t *data, uint32_t len)
+{
+    uint32_t head = ring->head;
+    uint32_t space = PIOS_SHM_RING_SIZE - (head - ring->tail);
+
+    if (len > space) {
+        len = space;
+    }
+
+    uint32_t offset = head & (PIOS_SHM_RING_SIZE - 1);
+    uint32_t first  = PIOS_SHM_RING_SIZE - offset;
+    if (first > len) {
+        first = len;
+    }
+    memcpy(&ring->data[offset], data, first);
+    memcpy(&ring->data[0], data + first, len - first);
+
+    /* The data must be visible before the new head */
+    __sync_synchronize();
+    ring->head = head + len;
+
+    return len;
+}
+
+/**
+ * Consumer side, copy up to len bytes out of the ring
+ * @return the number of bytes read
+ */
+static inline uint32_t pios_shm_ring_read(struct pios_shm_ring *ring, uint8_t *data, uint32_t len)
+{
+    uint32_t tail = ring->tail;
+    uint32_t used = ring->head - tail;
+
+    if (len > used) {
+        len = used;
+    }
+
+    /* The data must not be read before the head it was published with */
+    __sync_synchronize();
+    uint32_t offset = tail & (PIOS_SHM_RING_SIZE - 1);
+    uint32_t first  = PIOS_SHM_RING_SIZE - offset;
+    if (first > len) {
+        first = len;
+    }
+    memcpy(data, &ring->data[offset], first);
+    memcpy(data + first, &ring->data[0], len - first);
+
+    /* The data must be copied out before the space is handed back */
+    __sync_synchronize();
+    ring->tail = tail + len;
+
+    return len;
+}
+
+#endif /* PIOS_SHM_RING_H */
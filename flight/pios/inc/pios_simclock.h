@@ -0,0 +1,49 @@
+/**
+ ******************************************************************************
+ *
+ * @file       pios_simclock.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @brief      Lockstep simulation clock for the simulation targets.
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef PIOS_SIMCLOCK_H
+#define PIOS_SIMCLOCK_H
+
+/*
+ * Step protocol, one UDP datagram each way in host byte order:
+ * the simulator sends a request with the number of ticks to run, the
+ * firmware runs them as fast as the host allows and answers with the
+ * ticks run and the simulated time. The first request switches the
+ * firmware from real time to lockstep, a request for 0 ticks switches
+ * it back.
+ */
+#define PIOS_SIMCLOCK_MAGIC 0x4353504fu /* "OPSC" */
+
+struct pios_simclock_msg {
+    uint32_t magic;
+    uint32_t ticks;
+    uint32_t time_us;
+};
+
+/* Public Functions */
+extern bool PIOS_SIMCLOCK_IsLockstep(void);
+extern uint32_t PIOS_SIMCLOCK_GetuS(void);
+
+#endif /* PIOS_SIMCLOCK_H */
@@ -42,11 +42,15 @@ typedef enum {
     PIOS_SPI_PRESCALER_256 = 7
 } SPIPrescalerTypeDef;
 
+/* Completion callback for asynchronous transfers, called from the DMA interrupt */
+typedef void (*pios_spi_callback)(uint32_t context, bool crc_ok, uint8_t crc_val);
+
 /* Public Functions */
 extern int32_t PIOS_SPI_SetClockSpeed(uint32_t spi_id, SPIPrescalerTypeDef spi_prescaler);
 extern int32_t PIOS_SPI_RC_PinSet(uint32_t spi_id, uint32_t slave_id, uint8_t pin_value);
 extern int32_t PIOS_SPI_TransferByte(uint32_t spi_id, uint8_t b);
 extern int32_t PIOS_SPI_TransferBlock(uint32_t spi_id, const uint8_t *send_buffer, uint8_t *receive_buffer, uint16_t len, void *callback);
+extern int32_t PIOS_SPI_TransferBlockAsync(uint32_t spi_id, const uint8_t *send_buffer, uint8_t *receive_buffer, uint16_t len, pios_spi_callback callback, uint32_t context);
 extern int32_t PIOS_SPI_Busy(uint32_t spi_id);
 extern int32_t PIOS_SPI_ClaimBus(uint32_t spi_id);
 extern int32_t PIOS_SPI_ClaimBusISR(uint32_t spi_id, bool *woken);
@@ -50,6 +50,8 @@ struct pios_spi_cfg {
 struct pios_spi_dev {
     const struct pios_spi_cfg *cfg;
     void    (*callback)(uint8_t, uint8_t);
+    pios_spi_callback async_callback;
+    uint32_t async_context;
     uint8_t tx_dummy_byte;
     uint8_t rx_dummy_byte;
 #if defined(PIOS_INCLUDE_FREERTOS)
@@ -80,10 +80,12 @@ struct pios_task_info {
     uint32_t stack_remaining;
     /** Flag indicating whether or not the task is running. */
     bool     is_running;
-    /** Percentage of cpu time used by the task since the last call
-     *  to PIOS_TASK_MONITOR_ForEachTask(). Low-load tasks may
-     *  report 0% load even though they have run during the interval. */
+    /** Percentage of cpu time used by the task during the last sample
+     *  period (PIOS_TASK_MONITOR_SAMPLE_MS), rounded. */
     uint8_t running_time_percentage;
+    /** Same in tenths of a percent, low-load tasks report a non zero
+     *  load as long as they used 0.1% of the cpu. */
+    uint16_t running_time_permille;
 };
 
 /**
@@ -105,7 +107,7 @@ typedef void (*TaskMonitorTaskInfoCallback)(uint16_t task_id, const struct pios_
 extern void PIOS_TASK_MONITOR_ForEachTask(TaskMonitorTaskInfoCallback callback, void *context);
 
 /**
- * Return the idle task running time percentage.
+ * Return the idle task running time percentage during the last sample period.
  */
 extern uint8_t PIOS_TASK_MONITOR_GetIdlePercentage();
 
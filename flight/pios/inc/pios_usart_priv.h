@@ -38,6 +38,22 @@
 
 extern const struct pios_com_driver pios_usart_com_driver;
 
+/*
+ * Optional DMA configuration. A stream with a NULL channel keeps using the
+ * byte interrupt path. The RX stream runs in circular mode and is drained on
+ * half/full transfer and on USART idle line, the TX stream sends chunks taken
+ * from the COM fifo. irq.flags are the DMA_IT_* bits to clear for the stream.
+ * The board must route both stream IRQs to PIOS_USART_DMA_irq_handler() and
+ * give them the same preemption priority as the USART IRQ, PIOS_USART_Init()
+ * asserts it for the RX stream.
+ */
+struct pios_usart_dma {
+    struct stm32_irq rx_irq;
+    struct stm32_dma_chan rx;
+    struct stm32_irq tx_irq;
+    struct stm32_dma_chan tx;
+};
+
 struct pios_usart_cfg {
     USART_TypeDef     *regs;
     uint32_t remap; /* GPIO_Remap_* */
@@ -45,10 +61,12 @@ struct pios_usart_cfg {
     struct stm32_gpio rx;
     struct stm32_gpio tx;
     struct stm32_irq  irq;
+    const struct pios_usart_dma *dma;
 };
 
 extern int32_t PIOS_USART_Init(uint32_t *usart_id, const struct pios_usart_cfg *cfg);
 extern const struct pios_usart_cfg *PIOS_USART_GetConfig(uint32_t usart_id);
+extern void PIOS_USART_DMA_irq_handler(USART_TypeDef *regs);
 
 #endif /* PIOS_USART_PRIV_H */
 
@@ -59,6 +59,7 @@ extern TTime timex;
 
 extern void PIOS_Video_Init(const struct pios_video_cfg *cfg);
 uint16_t PIOS_Video_GetOSDLines(void);
+extern void PIOS_Video_FrameDone(bool updated);
 extern bool PIOS_Hsync_ISR();
 extern bool PIOS_Vsync_ISR();
 
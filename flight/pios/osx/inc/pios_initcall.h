@@ -52,6 +52,7 @@ extern void InitModules();
 extern void StartModules();
 
 #define MODULE_INITCALL(ifn, sfn)
+#define MODULE_INITCALL_DEFERRED(ifn, sfn)
 
 #define MODULE_TASKCREATE_ALL \
     { \
@@ -66,6 +67,10 @@ extern void StartModules();
         /* Initialize the system thread */ \
         SystemModInitialize(); }
 
+#define MODULE_INITIALISE_DEFERRED
+
+#define PIOS_INITCALL_PROFILE(phase, code) { code; }
+
 #endif /* PIOS_INITCALL_H */
 
 /**
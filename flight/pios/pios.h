@@ -93,6 +93,7 @@ extern "C" {
 #include <stdbool.h>
 
 #include <pios_mem.h>
+#include <pios_mempool.h>
 
 #include <pios_architecture.h>
 
@@ -268,6 +269,10 @@ extern "C" {
 #include <pios_flashfs.h>
 #endif
 
+#ifdef PIOS_INCLUDE_BLACKBOX
+#include <pios_blackbox.h>
+#endif
+
 /* driver for storage on internal flash */
 /* #define PIOS_INCLUDE_FLASH_INTERNAL */
 
@@ -298,6 +303,14 @@ extern "C" {
 #include <pios_udp.h>
 #endif
 
+#ifdef PIOS_INCLUDE_SIMCLOCK
+#include <pios_simclock.h>
+#endif
+
+#ifdef PIOS_INCLUDE_SHM
+#include <pios_shm.h>
+#endif
+
 /* PIOS abstract comms interface with options */
 #ifdef PIOS_INCLUDE_COM
 /* #define PIOS_INCLUDE_COM_MSG */
@@ -306,6 +319,8 @@ extern "C" {
 /* #define PIOS_INCLUDE_COM_FLEXI */
 /* #define PIOS_INCLUDE_COM_AUX */
 /* #define PIOS_TELEM_PRIORITY_QUEUE */
+/* #define PIOS_TELEM_FANOUT */
+/* #define PIOS_TELEM_POLICY_CACHE */
 /* #define PIOS_INCLUDE_GPS */
 /* #define PIOS_GPS_MINIMAL */
 /* #define PIOS_INCLUDE_GPS_NMEA_PARSER */
@@ -362,6 +362,25 @@ int32_t PIOS_COM_SendBuffer(uint32_t com_id, const uint8_t *buffer, uint16_t len
     return rc;
 }
 
+/**
+ * In-place transmit is not supported here, callers fall back to
+ * PIOS_COM_SendBuffer()
+ * \return NULL
+ */
+uint8_t *PIOS_COM_SendBufferReserve(__attribute__((unused)) uint32_t com_id, __attribute__((unused)) uint16_t len)
+{
+    return NULL;
+}
+
+/**
+ * Counterpart of PIOS_COM_SendBufferReserve(), never called with a reservation here
+ * \return 0
+ */
+int32_t PIOS_COM_SendBufferCommit(__attribute__((unused)) uint32_t com_id, __attribute__((unused)) uint16_t len)
+{
+    return 0;
+}
+
 /**
  * Sends a single character over given port
  * \param[in] port COM port
@@ -526,6 +545,23 @@ bool PIOS_COM_Available(uint32_t com_id)
     return (com_dev->driver->available)(com_dev->lower_id);
 }
 
+/**
+ * Query the free space of the transmit buffer of a com port, so that callers
+ * can shed low priority data before the buffer is full.
+ * \param[in] com_id COM port
+ * \return number of bytes that can be queued, 0 if the port is not valid
+ */
+uint16_t PIOS_COM_GetTxFree(uint32_t com_id)
+{
+    struct pios_com_dev *com_dev = PIOS_COM_find_dev(com_id);
+
+    if (!PIOS_COM_validate(com_dev) || !com_dev->has_tx) {
+        return 0;
+    }
+
+    return fifoBuf_getFree(&com_dev->tx);
+}
+
 #endif /* if defined(PIOS_INCLUDE_COM) */
 
 /**
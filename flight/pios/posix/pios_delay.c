@@ -63,6 +63,13 @@ int32_t PIOS_DELAY_WaituS(uint32_t uS)
 {
     static struct timespec wait, rest;
 
+#if defined(PIOS_INCLUDE_SIMCLOCK)
+    // simulated time stands still while a task runs, busy waiting would never end
+    if (PIOS_SIMCLOCK_IsLockstep()) {
+        return 0;
+    }
+#endif
+
     wait.tv_sec  = 0;
     wait.tv_nsec = 1000 * uS;
     while (nanosleep(&wait, &rest) != 0) {
@@ -90,6 +97,12 @@ int32_t PIOS_DELAY_WaitmS(uint32_t mS)
     // PIOS_DELAY_WaituS(1000);
     static struct timespec wait, rest;
 
+#if defined(PIOS_INCLUDE_SIMCLOCK)
+    if (PIOS_SIMCLOCK_IsLockstep()) {
+        return 0;
+    }
+#endif
+
     wait.tv_sec  = mS / 1000;
     wait.tv_nsec = (mS % 1000) * 1000000;
     while (nanosleep(&wait, &rest) != 0) {
@@ -109,6 +122,11 @@ uint32_t PIOS_DELAY_GetuS()
 {
     static struct timespec current;
 
+#if defined(PIOS_INCLUDE_SIMCLOCK)
+    if (PIOS_SIMCLOCK_IsLockstep()) {
+        return PIOS_SIMCLOCK_GetuS();
+    }
+#endif
     clock_gettime(CLOCK_REALTIME, &current);
     return (current.tv_sec * 1000000) + (current.tv_nsec / 1000);
 }
@@ -141,5 +159,16 @@ uint32_t PIOS_DELAY_DiffuS(uint32_t raw)
     return PIOS_DELAY_GetuS() - raw;
 }
 
+/**
+ * @brief Compare two raw times and convert to us
+ * @param[in] raw earlier raw time
+ * @param[in] later later raw time
+ * @return The microseconds between raw and later
+ */
+uint32_t PIOS_DELAY_DiffuS2(uint32_t raw, uint32_t later)
+{
+    return later - raw;
+}
+
 
 #endif /* if defined(PIOS_INCLUDE_DELAY) */
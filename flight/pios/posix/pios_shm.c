@@ -0,0 +1,283 @@
+/**
+ ******************************************************************************
+ *
+ * @file       pios_shm.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @brief      COM driver over a shared memory ring, for a GCS on the same host.
+ * @see        The GNU Public License (GPL) Version 3
+ * @defgroup   PIOS_SHM Shared memory COM Functions
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+
+/* Project Includes */
+#include "pios.h"
+
+#if defined(PIOS_INCLUDE_SHM)
+
+#include <pios_shm_priv.h>
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+
+#define PIOS_SHM_MAX_DEV 4
+
+struct pios_shm_dev {
+    const struct pios_shm_cfg *cfg;
+    struct pios_shm_region    *region;
+#if defined(PIOS_INCLUDE_FREERTOS)
+    xTaskHandle rxThread;
+#else
+    pthread_t   rxThread;
+#endif
+
+    /* Set while a context copies into the ring, the ring has a single producer */
+    volatile uint32_t tx_busy;
+    /* Data is left in the COM buffer, the rx thread retries */
+    volatile bool     tx_pending;
+
+    pios_com_callback tx_out_cb;
+    uint32_t tx_out_context;
+    pios_com_callback rx_in_cb;
+    uint32_t rx_in_context;
+};
+
+static uint8_t pios_shm_num_devices = 0;
+
+static struct pios_shm_dev pios_shm_devices[PIOS_SHM_MAX_DEV];
+
+
+/* Provide a COM driver */
+static void PIOS_SHM_ChangeBaud(uint32_t shm_id, uint32_t baud);
+static void PIOS_SHM_RegisterRxCallback(uint32_t shm_id, pios_com_callback rx_in_cb, uint32_t context);
+static void PIOS_SHM_RegisterTxCallback(uint32_t shm_id, pios_com_callback tx_out_cb, uint32_t context);
+static void PIOS_SHM_TxStart(uint32_t shm_id, uint16_t tx_bytes_avail);
+static void PIOS_SHM_RxStart(uint32_t shm_id, uint16_t rx_bytes_avail);
+
+const struct pios_com_driver pios_shm_com_driver = {
+    .set_baud   = PIOS_SHM_ChangeBaud,
+    .tx_start   = PIOS_SHM_TxStart,
+    .rx_start   = PIOS_SHM_RxStart,
+    .bind_tx_cb = PIOS_SHM_RegisterTxCallback,
+    .bind_rx_cb = PIOS_SHM_RegisterRxCallback,
+};
+
+
+static struct pios_shm_dev *find_shm_dev_by_id(uint32_t shm_id)
+{
+    if (shm_id >= pios_shm_num_devices) {
+        /* Undefined shared memory port for this board (see pios_board.c) */
+        PIOS_Assert(0);
+        return NULL;
+    }
+
+    return &pios_shm_devices[shm_id];
+}
+
+/**
+ * Move the pending transmit data straight from the COM buffer into the ring
+ */
+static void PIOS_SHM_TxPump(struct pios_shm_dev *shm_dev)
+{
+    if (!shm_dev->tx_out_cb) {
+        return;
+    }
+    if (__sync_lock_test_and_set(&shm_dev->tx_busy, 1)) {
+        /* Another context is copying, make sure the data it may miss is picked up */
+        shm_dev->tx_pending = true;
+        return;
+    }
+    shm_dev->tx_pending = false;
+
+    while (1) {
+        uint32_t space;
+        uint8_t *dst = pios_shm_ring_write_ptr(&shm_dev->region->to_gcs, &space);
+        if (space == 0) {
+            /* The GCS is behind (or not there), keep the rest in the COM buffer */
+            shm_dev->tx_pending = true;
+            break;
+        }
+
+        bool tx_need_yield = false;
+        uint16_t length    = (shm_dev->tx_out_cb)(shm_dev->tx_out_context, dst, space > UINT16_MAX ? UINT16_MAX : space, NULL, &tx_need_yield);
+        if (length == 0) {
+            break;
+        }
+        pios_shm_ring_commit_write(&shm_dev->region->to_gcs, length);
+    }
+
+    __sync_lock_release(&shm_dev->tx_busy);
+}
+
+/**
+ * RxThread, also retries the transmit data that did not fit in the ring
+ */
+void *PIOS_SHM_RxThread(void *shm_dev_n)
+{
+    struct pios_shm_dev *shm_dev = (struct pios_shm_dev *)shm_dev_n;
+
+    while (1) {
+        bool idle = true;
+
+        if (shm_dev->rx_in_cb) {
+            uint32_t available;
+            uint8_t *src = pios_shm_ring_read_ptr(&shm_dev->region->to_fc, &available);
+            if (available > 0) {
+                /* Unlike the UDP driver nothing is discarded, what the COM buffer
+                 * does not take stays in the ring until the next pass */
+                bool rx_need_yield = false;
+                uint16_t received  = (shm_dev->rx_in_cb)(shm_dev->rx_in_context, src, available > UINT16_MAX ? UINT16_MAX : available, NULL, &rx_need_yield);
+                pios_shm_ring_commit_read(&shm_dev->region->to_fc, received);
+                idle = (received == 0);
+
+#if defined(PIOS_INCLUDE_FREERTOS)
+                if (rx_need_yield) {
+                    vPortYieldFromISR();
+                }
+#endif /* PIOS_INCLUDE_FREERTOS */
+            }
+        }
+
+        if (shm_dev->tx_pending) {
+            PIOS_SHM_TxPump(shm_dev);
+        }
+
+        if (idle) {
+#if defined(PIOS_INCLUDE_FREERTOS)
+            vTaskDelay(1);
+#else
+            usleep(1000);
+#endif /* PIOS_INCLUDE_FREERTOS */
+        }
+    }
+}
+
+
+/**
+ * Create (or reuse) the shared memory object and reset both rings
+ */
+int32_t PIOS_SHM_Init(uint32_t *shm_id, const struct pios_shm_cfg *cfg)
+{
+    PIOS_Assert(pios_shm_num_devices < PIOS_SHM_MAX_DEV);
+
+    struct pios_shm_dev *shm_dev = &pios_shm_devices[pios_shm_num_devices];
+
+    int fd = shm_open(cfg->name, O_RDWR | O_CREAT, 0600);
+    if (fd < 0) {
+        return -1;
+    }
+    if (ftruncate(fd, sizeof(struct pios_shm_region)) < 0) {
+        close(fd);
+        return -1;
+    }
+    void *region = mmap(NULL, sizeof(struct pios_shm_region), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (region == MAP_FAILED) {
+        return -1;
+    }
+
+    /* initialize */
+    shm_dev->cfg        = cfg;
+    shm_dev->region     = (struct pios_shm_region *)region;
+    shm_dev->rx_in_cb   = NULL;
+    shm_dev->tx_out_cb  = NULL;
+    shm_dev->tx_busy    = 0;
+    shm_dev->tx_pending = false;
+
+    /* A GCS still attached from a previous run sees the region go invalid while it is reset */
+    shm_dev->region->magic   = 0;
+    __sync_synchronize();
+    pios_shm_ring_reset(&shm_dev->region->to_gcs);
+    pios_shm_ring_reset(&shm_dev->region->to_fc);
+    shm_dev->region->version = PIOS_SHM_VERSION;
+    __sync_synchronize();
+    shm_dev->region->magic   = PIOS_SHM_MAGIC;
+
+    /* Create receive thread for this connection */
+#if defined(PIOS_INCLUDE_FREERTOS)
+    xTaskCreate((pdTASK_CODE)PIOS_SHM_RxThread, "SHM_Rx_Thread", 1024, (void *)shm_dev, (tskIDLE_PRIORITY + 1), &shm_dev->rxThread);
+#else
+    pthread_create(&shm_dev->rxThread, NULL, PIOS_SHM_RxThread, (void *)shm_dev);
+#endif
+
+    printf("shm dev %i - %s mapped\n", pios_shm_num_devices, cfg->name);
+
+    *shm_id = pios_shm_num_devices++;
+
+    return 0;
+}
+
+
+static void PIOS_SHM_ChangeBaud(__attribute__((unused)) uint32_t shm_id, __attribute__((unused)) uint32_t baud)
+{
+    /**
+     * doesn't apply!
+     */
+}
+
+
+static void PIOS_SHM_RxStart(__attribute__((unused)) uint32_t shm_id, __attribute__((unused)) uint16_t rx_bytes_avail)
+{
+    /**
+     * the rx thread polls the ring
+     */
+}
+
+
+static void PIOS_SHM_TxStart(uint32_t shm_id, __attribute__((unused)) uint16_t tx_bytes_avail)
+{
+    struct pios_shm_dev *shm_dev = find_shm_dev_by_id(shm_id);
+
+    PIOS_Assert(shm_dev);
+
+    PIOS_SHM_TxPump(shm_dev);
+}
+
+static void PIOS_SHM_RegisterRxCallback(uint32_t shm_id, pios_com_callback rx_in_cb, uint32_t context)
+{
+    struct pios_shm_dev *shm_dev = find_shm_dev_by_id(shm_id);
+
+    PIOS_Assert(shm_dev);
+
+    /*
+     * Order is important in these assignments since the rx thread uses _cb
+     * field to determine if it's ok to dereference _cb and _context
+     */
+    shm_dev->rx_in_context = context;
+    shm_dev->rx_in_cb = rx_in_cb;
+}
+
+static void PIOS_SHM_RegisterTxCallback(uint32_t shm_id, pios_com_callback tx_out_cb, uint32_t context)
+{
+    struct pios_shm_dev *shm_dev = find_shm_dev_by_id(shm_id);
+
+    PIOS_Assert(shm_dev);
+
+    /*
+     * Order is important in these assignments since the rx thread uses _cb
+     * field to determine if it's ok to dereference _cb and _context
+     */
+    shm_dev->tx_out_context = context;
+    shm_dev->tx_out_cb = tx_out_cb;
+}
+
+
+#endif /* if defined(PIOS_INCLUDE_SHM) */
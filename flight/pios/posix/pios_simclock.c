@@ -0,0 +1,179 @@
+/**
+ ******************************************************************************
+ *
+ * @file       pios_simclock.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @brief      Lockstep simulation clock. Lets a simulator step the FreeRTOS
+ *             tick so simulated flights run as fast as the host allows.
+ * @see        The GNU Public License (GPL) Version 3
+ * @defgroup   PIOS_SIMCLOCK Simulation clock
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+/* Project Includes */
+#include "pios.h"
+
+#if defined(PIOS_INCLUDE_SIMCLOCK)
+
+#include <pios_simclock_priv.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+
+/* How long the scheduler blocks on the socket in lockstep before it checks for shutdown */
+#define PIOS_SIMCLOCK_RECV_TIMEOUT_MS 100
+
+static int simclock_socket = -1;
+static struct sockaddr_in simclock_client;
+static volatile bool simclock_lockstep = false;
+static volatile uint32_t simclock_time_us;
+static uint32_t simclock_ticks;
+
+/* Hooks called by the scheduler thread of the FreeRTOS posix port */
+portBASE_TYPE xApplicationLockstepWait(portLONG *plTicks);
+void vApplicationLockstepTick(void);
+void vApplicationLockstepDone(void);
+
+/**
+ * Open the socket the simulator sends its step requests to.
+ * The clock keeps running in real time until the first request.
+ */
+int32_t PIOS_SIMCLOCK_Init(const struct pios_simclock_cfg *cfg)
+{
+    struct sockaddr_in server;
+
+    simclock_socket = socket(PF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (simclock_socket < 0) {
+        return -1;
+    }
+
+    memset(&server, 0, sizeof(server));
+    server.sin_family      = AF_INET;
+    server.sin_addr.s_addr = inet_addr(cfg->ip);
+    server.sin_port = htons(cfg->port);
+    if (bind(simclock_socket, (struct sockaddr *)&server, sizeof(server)) < 0) {
+        close(simclock_socket);
+        simclock_socket = -1;
+        return -1;
+    }
+
+    struct timeval timeout = {
+        .tv_sec  = 0,
+        .tv_usec = PIOS_SIMCLOCK_RECV_TIMEOUT_MS * 1000,
+    };
+    setsockopt(simclock_socket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    printf("simclock - socket %i opened on port %i\n", simclock_socket, cfg->port);
+
+    return 0;
+}
+
+/**
+ * @brief Whether the simulator currently drives the clock
+ */
+bool PIOS_SIMCLOCK_IsLockstep(void)
+{
+    return simclock_lockstep;
+}
+
+/**
+ * @brief Simulated time, only meaningful in lockstep
+ * @return A microsecond value
+ */
+uint32_t PIOS_SIMCLOCK_GetuS(void)
+{
+    return simclock_time_us;
+}
+
+static uint32_t PIOS_SIMCLOCK_RealTimeuS(void)
+{
+    struct timespec current;
+
+    clock_gettime(CLOCK_REALTIME, &current);
+    return (current.tv_sec * 1000000) + (current.tv_nsec / 1000);
+}
+
+/**
+ * Called by the scheduler thread of the FreeRTOS port before every tick.
+ * Returns pdFALSE in real time, otherwise the number of ticks to run next.
+ */
+portBASE_TYPE xApplicationLockstepWait(portLONG *plTicks)
+{
+    struct pios_simclock_msg msg;
+    socklen_t length = sizeof(simclock_client);
+
+    if (simclock_socket < 0) {
+        return pdFALSE;
+    }
+
+    /* In real time only poll, the scheduler has a tick to keep */
+    ssize_t received = recvfrom(simclock_socket, &msg, sizeof(msg), simclock_lockstep ? 0 : MSG_DONTWAIT,
+                                (struct sockaddr *)&simclock_client, &length);
+
+    if (received != sizeof(msg) || msg.magic != PIOS_SIMCLOCK_MAGIC) {
+        /* Nothing (valid) received, in lockstep wait again without ticking */
+        *plTicks = 0;
+        return simclock_lockstep ? pdTRUE : pdFALSE;
+    }
+
+    if (!simclock_lockstep) {
+        /* Continue from the current time so deltas stay sane across the switch */
+        simclock_time_us  = PIOS_SIMCLOCK_RealTimeuS();
+        simclock_lockstep = true;
+    }
+
+    simclock_ticks = 0;
+    *plTicks = msg.ticks;
+    if (msg.ticks == 0) {
+        /* Back to real time, still acknowledge the request */
+        vApplicationLockstepDone();
+        simclock_lockstep = false;
+        return pdFALSE;
+    }
+
+    return pdTRUE;
+}
+
+void vApplicationLockstepTick(void)
+{
+    simclock_time_us += portTICK_RATE_MICROSECONDS;
+    simclock_ticks++;
+}
+
+void vApplicationLockstepDone(void)
+{
+    struct pios_simclock_msg msg = {
+        .magic   = PIOS_SIMCLOCK_MAGIC,
+        .ticks   = simclock_ticks,
+        .time_us = simclock_time_us,
+    };
+
+    sendto(simclock_socket, &msg, sizeof(msg), 0, (struct sockaddr *)&simclock_client, sizeof(simclock_client));
+}
+
+#endif /* PIOS_INCLUDE_SIMCLOCK */
+
+/**
+ * @}
+ */
@@ -87,11 +87,18 @@ void *PIOS_UDP_RxThread(void *udp_dev_n)
          * receive
          */
         int received;
+        int flags = 0;
+#if defined(PIOS_INCLUDE_FREERTOS)
+        /* poll instead of blocking in the socket, so the task is seen as
+         * blocked by the scheduler and the lockstep clock can tell when
+         * all tasks are done with a tick */
+        flags = MSG_DONTWAIT;
+#endif
         udp_dev->clientLength = sizeof(udp_dev->client);
         if ((received = recvfrom(udp_dev->socket,
                                  &udp_dev->rx_buffer,
                                  PIOS_UDP_RX_BUFFER_SIZE,
-                                 0,
+                                 flags,
                                  (struct sockaddr *)&udp_dev->client,
                                  (socklen_t *)&udp_dev->clientLength)) >= 0) {
             /* copy received data to buffer if possible */
@@ -108,6 +115,11 @@ void *PIOS_UDP_RxThread(void *udp_dev_n)
             }
 #endif /* PIOS_INCLUDE_FREERTOS */
         }
+#if defined(PIOS_INCLUDE_FREERTOS)
+        else {
+            vTaskDelay(1);
+        }
+#endif /* PIOS_INCLUDE_FREERTOS */
     }
 }
 
@@ -668,6 +668,36 @@ int32_t PIOS_I2C_Transfer(uint32_t i2c_id, const struct pios_i2c_txn txn_list[],
            0;
 }
 
+/**
+ * Queued transfer, this adapter has no transfer queue so it runs synchronously
+ * and calls the callback before returning.
+ * \param[in] i2c_id I2C adapter
+ * \param[in] request Transfer and completion callback
+ * \return 0 once the callback has been called
+ */
+int32_t PIOS_I2C_Transfer_Queued(uint32_t i2c_id, struct pios_i2c_request *request)
+{
+    PIOS_Assert(request);
+    PIOS_Assert(request->callback);
+
+    request->next = NULL;
+    request->callback(request->context, PIOS_I2C_Transfer(i2c_id, request->txn_list, request->num_txns));
+
+    return 0;
+}
+
+/**
+ * Take back a queued transfer, nothing to do as this adapter completes them before
+ * PIOS_I2C_Transfer_Queued() returns.
+ * \param[in] i2c_id I2C adapter
+ * \param[in] request Transfer submitted with PIOS_I2C_Transfer_Queued()
+ * \return 0, the request is never left queued
+ */
+int32_t PIOS_I2C_Transfer_Cancel(__attribute__((unused)) uint32_t i2c_id, __attribute__((unused)) struct pios_i2c_request *request)
+{
+    return 0;
+}
+
 void PIOS_I2C_IRQ_Handler(uint32_t i2c_id)
 {
     struct pios_i2c_adapter *i2c_adapter = (struct pios_i2c_adapter *)i2c_id;
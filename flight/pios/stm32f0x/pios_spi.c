@@ -700,6 +700,24 @@ int32_t PIOS_SPI_TransferBlock(uint32_t spi_id, const uint8_t *send_buffer, uint
     return SPI_PIO_TransferBlock(spi_id, send_buffer, receive_buffer, len);
 }
 
+/**
+ * Asynchronous block transfer. This port has no working DMA completion path
+ * for it, so the transfer is done synchronously and the callback is called
+ * before returning.
+ * \return >= 0 if no error during transfer
+ * \return -3 if function has been called during an ongoing DMA transfer
+ */
+int32_t PIOS_SPI_TransferBlockAsync(uint32_t spi_id, const uint8_t *send_buffer, uint8_t *receive_buffer, uint16_t len, pios_spi_callback callback, uint32_t context)
+{
+    PIOS_Assert(callback);
+
+    int32_t ret = PIOS_SPI_TransferBlock(spi_id, send_buffer, receive_buffer, len, NULL);
+    if (ret >= 0) {
+        callback(context, true, 0);
+    }
+    return ret;
+}
+
 /**
  * Check if a transfer is in progress
  * \param[in] spi SPI number (0 or 1)
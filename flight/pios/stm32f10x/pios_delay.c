@@ -168,6 +168,19 @@ uint32_t PIOS_DELAY_DiffuS(uint32_t raw)
     return diff / us_ticks;
 }
 
+/**
+ * @brief Compare two raw times and convert to us
+ * @param[in] raw earlier raw time
+ * @param[in] later later raw time
+ * @return The microseconds between raw and later
+ */
+uint32_t PIOS_DELAY_DiffuS2(uint32_t raw, uint32_t later)
+{
+    uint32_t diff = later - raw;
+
+    return diff / us_ticks;
+}
+
 #endif /* PIOS_INCLUDE_DELAY */
 
 /**
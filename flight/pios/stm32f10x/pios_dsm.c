@@ -43,10 +43,16 @@ static uint16_t PIOS_DSM_RxInCallback(uint32_t context,
                                       uint16_t *headroom,
                                       bool *need_yield);
 static void PIOS_DSM_Supervisor(uint32_t dsm_id);
+#if defined(PIOS_INCLUDE_FREERTOS)
+static xSemaphoreHandle PIOS_DSM_Get_Semaphore(uint32_t rcvr_id, uint8_t channel);
+#endif
 
 /* Local Variables */
 const struct pios_rcvr_driver pios_dsm_rcvr_driver = {
     .read = PIOS_DSM_Get,
+#if defined(PIOS_INCLUDE_FREERTOS)
+    .get_semaphore = PIOS_DSM_Get_Semaphore,
+#endif
 };
 
 enum pios_dsm_dev_magic {
@@ -70,6 +76,10 @@ struct pios_dsm_dev {
     enum pios_dsm_dev_magic   magic;
     const struct pios_dsm_cfg *cfg;
     struct pios_dsm_state     state;
+#if defined(PIOS_INCLUDE_FREERTOS)
+    /* given once per decoded frame, whatever the channel asked for */
+    xSemaphoreHandle new_frame_semaphore;
+#endif
 };
 
 /* Allocate DSM device descriptor */
@@ -84,6 +94,7 @@ static struct pios_dsm_dev *PIOS_DSM_Alloc(void)
     }
 
     dsm_dev->magic = PIOS_DSM_DEV_MAGIC;
+    dsm_dev->new_frame_semaphore = 0;
     return dsm_dev;
 }
 #else
@@ -251,10 +262,14 @@ stream_error:
     return -1;
 }
 
-/* Update decoder state processing input byte from the DSMx stream */
-static void PIOS_DSM_UpdateState(struct pios_dsm_dev *dsm_dev, uint8_t byte)
+/**
+ * Update decoder state processing input byte from the DSMx stream
+ * \output true when a full frame has been received and the channels updated
+ */
+static bool PIOS_DSM_UpdateState(struct pios_dsm_dev *dsm_dev, uint8_t byte)
 {
     struct pios_dsm_state *state = &(dsm_dev->state);
+    bool updated = false;
 
     if (state->frame_found) {
         /* receiving the data frame */
@@ -266,6 +281,7 @@ static void PIOS_DSM_UpdateState(struct pios_dsm_dev *dsm_dev, uint8_t byte)
                 if (!PIOS_DSM_UnrollChannels(dsm_dev)) {
                     /* data looking good */
                     state->failsafe_timer = 0;
+                    updated = true;
                 }
 
                 /* prepare for the next frame */
@@ -273,6 +289,8 @@ static void PIOS_DSM_UpdateState(struct pios_dsm_dev *dsm_dev, uint8_t byte)
             }
         }
     }
+
+    return updated;
 }
 
 /* Initialise DSM receiver interface */
@@ -328,9 +346,11 @@ static uint16_t PIOS_DSM_RxInCallback(uint32_t context,
 
     PIOS_Assert(valid);
 
+    bool frame_updated = false;
+
     /* process byte(s) and clear receive timer */
     for (uint8_t i = 0; i < buf_len; i++) {
-        PIOS_DSM_UpdateState(dsm_dev, buf[i]);
+        frame_updated |= PIOS_DSM_UpdateState(dsm_dev, buf[i]);
         dsm_dev->state.receive_timer = 0;
     }
 
@@ -339,8 +359,15 @@ static uint16_t PIOS_DSM_RxInCallback(uint32_t context,
         *headroom = DSM_FRAME_LENGTH;
     }
 
-    /* We never need a yield */
     *need_yield = false;
+#if defined(PIOS_INCLUDE_FREERTOS)
+    /* Wake up the reader as soon as the whole frame is decoded */
+    if (frame_updated && dsm_dev->new_frame_semaphore != 0) {
+        signed portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+        xSemaphoreGiveFromISR(dsm_dev->new_frame_semaphore, &xHigherPriorityTaskWoken);
+        *need_yield = (xHigherPriorityTaskWoken == pdTRUE);
+    }
+#endif
 
     /* Always indicate that all bytes were consumed */
     return buf_len;
@@ -370,6 +397,25 @@ static int32_t PIOS_DSM_Get(uint32_t rcvr_id, uint8_t channel)
     return dsm_dev->state.channel_data[channel];
 }
 
+#if defined(PIOS_INCLUDE_FREERTOS)
+static xSemaphoreHandle PIOS_DSM_Get_Semaphore(uint32_t rcvr_id, __attribute__((unused)) uint8_t channel)
+{
+    struct pios_dsm_dev *dsm_dev = (struct pios_dsm_dev *)rcvr_id;
+
+    if (!PIOS_DSM_Validate(dsm_dev)) {
+        return 0;
+    }
+
+    /* All the channels are updated together, one semaphore serves them all */
+    if (dsm_dev->new_frame_semaphore == 0) {
+        vSemaphoreCreateBinary(dsm_dev->new_frame_semaphore);
+        /* Only signal the frames received from now on */
+        xSemaphoreTake(dsm_dev->new_frame_semaphore, 0);
+    }
+    return dsm_dev->new_frame_semaphore;
+}
+#endif /* if defined(PIOS_INCLUDE_FREERTOS) */
+
 /**
  * Input data supervisor is called periodically and provides
  * two functions: frame syncing and failsafe triggering.
@@ -198,9 +198,25 @@ uint32_t PIOS_BL_HELPER_CRC_Memory_Calc()
     const struct pios_board_info *bdinfo = &pios_board_info_blob;
 
     PIOS_BL_HELPER_CRC_Ini();
+
+    if (!PIOS_CRC_HW_Claim()) {
+        /* Same CRC computed in software: words are fed most significant bit first */
+        const uint32_t *p = (const uint32_t *)bdinfo->fw_base;
+        uint32_t crc = 0xFFFFFFFF;
+        for (uint32_t n = (bdinfo->fw_size) >> 2; n > 0; n--) {
+            crc ^= *p++;
+            for (uint8_t i = 0; i < 32; i++) {
+                crc = (crc & 0x80000000) ? (crc << 1) ^ 0x04C11DB7 : (crc << 1);
+            }
+        }
+        return crc;
+    }
+
     CRC_ResetDR();
     CRC_CalcBlockCRC((uint32_t *)bdinfo->fw_base, (bdinfo->fw_size) >> 2);
-    return CRC_GetCRC();
+    uint32_t crc = CRC_GetCRC();
+    PIOS_CRC_HW_Release();
+    return crc;
 }
 
 void PIOS_BL_HELPER_FLASH_Read_Description(uint8_t *array, uint8_t size)
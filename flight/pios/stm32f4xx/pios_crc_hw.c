@@ -0,0 +1,120 @@
+/**
+ ******************************************************************************
+ * @addtogroup PIOS PIOS Core hardware abstraction layer
+ * @{
+ * @addtogroup PIOS_CRC CRC functions
+ * @brief Block CRC32 using the STM32F4 CRC unit
+ * @{
+ *
+ * @file       pios_crc_hw.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @brief      Hardware CRC32 for block sized checks
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include <pios.h>
+
+#define CRC32_POLYNOMIAL 0x04C11DB7
+
+static volatile bool crc_hw_busy;
+
+/**
+ * Take exclusive use of the CRC unit. Never blocks, callers that fail to
+ * claim the unit have to compute the CRC in software.
+ * \return true if the unit has been claimed
+ */
+bool PIOS_CRC_HW_Claim(void)
+{
+    bool claimed = false;
+
+    PIOS_IRQ_Disable();
+    if (!crc_hw_busy) {
+        crc_hw_busy = true;
+        claimed     = true;
+    }
+    PIOS_IRQ_Enable();
+
+    return claimed;
+}
+
+/**
+ * Release the CRC unit claimed by PIOS_CRC_HW_Claim()
+ */
+void PIOS_CRC_HW_Release(void)
+{
+    crc_hw_busy = false;
+}
+
+/**
+ * Bitwise CRC32, used for the tail that does not fill a word and when the
+ * unit is in use. Keeps this file free of the lookup tables in pios_crc.c
+ * so it also links into the bootloaders.
+ */
+static uint32_t PIOS_CRC32_updateBitwise(uint32_t crc, const uint8_t *data, int32_t length)
+{
+    while (length-- > 0) {
+        crc ^= (uint32_t)*data++ << 24;
+        for (uint8_t i = 0; i < 8; i++) {
+            crc = (crc & 0x80000000) ? (crc << 1) ^ CRC32_POLYNOMIAL : (crc << 1);
+        }
+    }
+    return crc;
+}
+
+/**
+ * @brief Compute the CRC32 of a block, starting from 0xFFFFFFFF
+ * Gives the same result as PIOS_CRC32_updateCRC(0xFFFFFFFF, data, length).
+ * The unit consumes a word with its most significant bit first, so words are
+ * byte swapped to keep the byte stream order of the software CRC.
+ * @param[in] data Data buffer
+ * @param[in] length Number of bytes to process
+ * @returns CRC of the block
+ */
+uint32_t PIOS_CRC32_calcBlock(const uint8_t *data, int32_t length)
+{
+    if (length < 4 || !PIOS_CRC_HW_Claim()) {
+        return PIOS_CRC32_updateBitwise(0xFFFFFFFF, data, length);
+    }
+
+    int32_t words = length >> 2;
+
+    CRC_ResetDR();
+    if (((uint32_t)data & 3) == 0) {
+        const uint32_t *p = (const uint32_t *)data;
+        while (words--) {
+            CRC->DR = __REV(*p++);
+        }
+    } else {
+        const uint8_t *p = data;
+        while (words--) {
+            CRC->DR = ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+            p += 4;
+        }
+    }
+    uint32_t crc = CRC->DR;
+
+    PIOS_CRC_HW_Release();
+
+    return PIOS_CRC32_updateBitwise(crc, data + (length & ~3), length & 3);
+}
+
+/**
+ * @}
+ * @}
+ */
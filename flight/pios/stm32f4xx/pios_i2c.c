@@ -160,6 +160,22 @@ static void i2c_adapter_reset_bus(struct pios_i2c_adapter *i2c_adapter);
 
 static void i2c_adapter_log_fault(enum pios_i2c_error_type type);
 static bool i2c_adapter_callback_handler(struct pios_i2c_adapter *i2c_adapter);
+static bool i2c_adapter_claim_sync(struct pios_i2c_adapter *i2c_adapter);
+static void i2c_adapter_release_sync(struct pios_i2c_adapter *i2c_adapter);
+static void i2c_adapter_start_queued(struct pios_i2c_adapter *i2c_adapter);
+static bool i2c_adapter_dequeue(struct pios_i2c_adapter *i2c_adapter);
+static void i2c_adapter_complete_queued(struct pios_i2c_adapter *i2c_adapter, int32_t status);
+static void i2c_adapter_abort_queued(struct pios_i2c_adapter *i2c_adapter);
+static void i2c_adapter_process_queue(struct pios_i2c_adapter *i2c_adapter);
+static void i2c_adapter_service_queue(struct pios_i2c_adapter *i2c_adapter);
+#ifdef PIOS_INCLUDE_CALLBACKSCHEDULER
+static void i2c_queue_callback(void);
+
+#define I2C_QUEUE_STACK_SIZE_BYTES 256
+
+/* Finishes the queued transfers outside of the interrupt handlers and times out hung ones */
+static DelayedCallbackInfo *i2c_queue_cb;
+#endif
 
 static const struct i2c_adapter_transition i2c_adapter_transitions[I2C_STATE_NUM_STATES] = {
     [I2C_STATE_FSM_FAULT] =             {
@@ -870,6 +886,167 @@ static bool i2c_adapter_callback_handler(struct pios_i2c_adapter *i2c_adapter)
     return (!i2c_adapter->bus_error) && semaphore_success;
 }
 
+/**
+ * Take the bus from the transfer queue for a blocking transfer
+ * \return false if queued transfers are still running
+ */
+static bool i2c_adapter_claim_sync(struct pios_i2c_adapter *i2c_adapter)
+{
+    bool claimed;
+
+    PIOS_IRQ_Disable();
+    claimed = !i2c_adapter->queue_active;
+    if (claimed) {
+        i2c_adapter->sync_active = true;
+    }
+    PIOS_IRQ_Enable();
+
+    return claimed;
+}
+
+/**
+ * Hand the bus back to the transfer queue after a blocking transfer
+ */
+static void i2c_adapter_release_sync(struct pios_i2c_adapter *i2c_adapter)
+{
+    bool start;
+
+    PIOS_IRQ_Disable();
+    i2c_adapter->sync_active = false;
+    start = (i2c_adapter->queue_head != NULL);
+    i2c_adapter->queue_active = start;
+    PIOS_IRQ_Enable();
+
+    if (start) {
+        i2c_adapter_start_queued(i2c_adapter);
+    }
+}
+
+/**
+ * Start the transfer at the head of the queue, the caller has set queue_active
+ */
+static void i2c_adapter_start_queued(struct pios_i2c_adapter *i2c_adapter)
+{
+    struct pios_i2c_request *request = i2c_adapter->queue_head;
+
+    PIOS_DEBUG_Assert(i2c_adapter->curr_state == I2C_STATE_STOPPED);
+
+    i2c_adapter->first_txn  = &request->txn_list[0];
+    i2c_adapter->last_txn   = &request->txn_list[request->num_txns - 1];
+    i2c_adapter->active_txn = i2c_adapter->first_txn;
+
+    i2c_adapter->queue_start_time = PIOS_DELAY_GetRaw();
+    i2c_adapter->callback  = NULL;
+    i2c_adapter->bus_error = false;
+    i2c_adapter->nack = false;
+    i2c_adapter_inject_event(i2c_adapter, I2C_EVENT_START);
+
+#ifdef PIOS_INCLUDE_CALLBACKSCHEDULER
+    /* Watchdog in case the transfer never completes */
+    PIOS_CALLBACKSCHEDULER_Schedule(i2c_queue_cb, i2c_adapter->cfg->transfer_timeout_ms + 1, CALLBACK_UPDATEMODE_SOONER);
+#endif
+}
+
+/**
+ * Remove the transfer at the head of the queue, only done by the task servicing the queue
+ * \return true if the next transfer has to be started
+ */
+static bool i2c_adapter_dequeue(struct pios_i2c_adapter *i2c_adapter)
+{
+    bool start;
+
+    PIOS_IRQ_Disable();
+    i2c_adapter->queue_head = i2c_adapter->queue_head->next;
+    if (!i2c_adapter->queue_head) {
+        i2c_adapter->queue_tail = NULL;
+    }
+    start = (i2c_adapter->queue_head != NULL);
+    i2c_adapter->queue_active = start;
+    PIOS_IRQ_Enable();
+
+    return start;
+}
+
+/**
+ * Report the result of the transfer at the head of the queue and start the next one
+ */
+static void i2c_adapter_complete_queued(struct pios_i2c_adapter *i2c_adapter, int32_t status)
+{
+    struct pios_i2c_request *request = i2c_adapter->queue_head;
+    bool start = i2c_adapter_dequeue(i2c_adapter);
+
+    /* The request may be submitted again from its callback */
+    request->callback(request->context, status);
+
+    if (start) {
+        i2c_adapter_start_queued(i2c_adapter);
+    }
+}
+
+/**
+ * Stop the queued transfer on the bus and reset the bus, the transfer stays at the head of the queue
+ */
+static void i2c_adapter_abort_queued(struct pios_i2c_adapter *i2c_adapter)
+{
+    PIOS_IRQ_Disable();
+    I2C_ITConfig(i2c_adapter->cfg->regs, I2C_IT_EVT | I2C_IT_BUF | I2C_IT_ERR, DISABLE);
+    PIOS_IRQ_Enable();
+    i2c_adapter_fsm_init(i2c_adapter);
+}
+
+/**
+ * Called at the end of the interrupt handlers. Once the FSM stops, the queued transfer
+ * is completed from the callback task, waiting for the stop bit is not done in the ISR.
+ */
+static void i2c_adapter_process_queue(struct pios_i2c_adapter *i2c_adapter)
+{
+    if (!i2c_adapter->queue_active || i2c_adapter->curr_state != I2C_STATE_STOPPING) {
+        return;
+    }
+
+#ifdef PIOS_INCLUDE_CALLBACKSCHEDULER
+    long xHigherPriorityTaskWoken = pdFALSE;
+    PIOS_CALLBACKSCHEDULER_DispatchFromISR(i2c_queue_cb, &xHigherPriorityTaskWoken);
+    portEND_SWITCHING_ISR(xHigherPriorityTaskWoken);
+#endif
+}
+
+/**
+ * Complete the queued transfer once the FSM stopped, or abort it when it hung.
+ * Called from task context only, by the queue callback and by blocking transfers
+ * waiting for the queue, only one of them services the queue at a time.
+ */
+static void i2c_adapter_service_queue(struct pios_i2c_adapter *i2c_adapter)
+{
+    PIOS_IRQ_Disable();
+    if (!i2c_adapter->queue_active || i2c_adapter->queue_servicing) {
+        PIOS_IRQ_Enable();
+        return;
+    }
+    i2c_adapter->queue_servicing = true;
+    PIOS_IRQ_Enable();
+
+    if (i2c_adapter->curr_state == I2C_STATE_STOPPING) {
+        if (i2c_adapter_wait_for_stopped(i2c_adapter)) {
+            i2c_adapter_inject_event(i2c_adapter, I2C_EVENT_STOPPED);
+        } else {
+            i2c_adapter_fsm_init(i2c_adapter);
+        }
+
+        i2c_adapter_complete_queued(i2c_adapter,
+                                    i2c_adapter->bus_error ? -1 :
+                                    i2c_adapter->nack ? -3 :
+                                    0);
+    } else if (PIOS_DELAY_DiffuS(i2c_adapter->queue_start_time) > i2c_adapter->cfg->transfer_timeout_ms * 1000) {
+        /* Hung transfer, reset the bus so the rest of the queue and the blocking transfers go on */
+        i2c_timeout_counter++;
+        i2c_adapter_abort_queued(i2c_adapter);
+        i2c_adapter_complete_queued(i2c_adapter, -2);
+    }
+
+    i2c_adapter->queue_servicing = false;
+}
+
 /**
  * Logs the last N state transitions and N IRQ events due to
  * an error condition
@@ -965,6 +1142,21 @@ static struct pios_i2c_adapter *PIOS_I2C_alloc(void)
 }
 #endif /* if defined(PIOS_INCLUDE_FREERTOS) && 0 */
 
+#ifdef PIOS_INCLUDE_CALLBACKSCHEDULER
+static void i2c_queue_callback(void)
+{
+    for (uint8_t i = 0; i < pios_i2c_num_adapters; i++) {
+        struct pios_i2c_adapter *i2c_adapter = &pios_i2c_adapters[i];
+
+        i2c_adapter_service_queue(i2c_adapter);
+        if (i2c_adapter->queue_active) {
+            /* Keep watching the transfer now on the bus */
+            PIOS_CALLBACKSCHEDULER_Schedule(i2c_queue_cb, i2c_adapter->cfg->transfer_timeout_ms + 1, CALLBACK_UPDATEMODE_SOONER);
+        }
+    }
+}
+#endif /* PIOS_INCLUDE_CALLBACKSCHEDULER */
+
 
 /**
  * Initializes IIC driver
@@ -996,6 +1188,19 @@ int32_t PIOS_I2C_Init(uint32_t *i2c_id, const struct pios_i2c_adapter_cfg *cfg)
 #else
     i2c_adapter->busy     = 0;
 #endif // USE_FREERTOS
+    i2c_adapter->queue_head   = NULL;
+    i2c_adapter->queue_tail   = NULL;
+    i2c_adapter->queue_active = false;
+    i2c_adapter->queue_servicing = false;
+    i2c_adapter->sync_active  = false;
+
+#ifdef PIOS_INCLUDE_CALLBACKSCHEDULER
+    /* The callback scheduler is initialized before the I2C adapters in PIOS_Board_Init() */
+    if (!i2c_queue_cb) {
+        i2c_queue_cb = PIOS_CALLBACKSCHEDULER_Create(&i2c_queue_callback, CALLBACK_PRIORITY_CRITICAL, CALLBACK_TASK_DEVICEDRIVER, -1, I2C_QUEUE_STACK_SIZE_BYTES);
+        PIOS_Assert(i2c_queue_cb);
+    }
+#endif
 
     /* Initialize the state machine */
     i2c_adapter_fsm_init(i2c_adapter);
@@ -1034,6 +1239,17 @@ int32_t PIOS_I2C_Transfer(uint32_t i2c_id, const struct pios_i2c_txn txn_list[],
     if (xSemaphoreTake(i2c_adapter->sem_busy, timeout) == pdFALSE) {
         return -2;
     }
+
+    /* Let the queued transfers complete first */
+    for (portTickType waited = 0; !i2c_adapter_claim_sync(i2c_adapter); waited++) {
+        if (waited >= timeout) {
+            xSemaphoreGive(i2c_adapter->sem_busy);
+            return -2;
+        }
+        vTaskDelay(1);
+        /* Times out a hung queued transfer instead of waiting for the next one to be queued */
+        i2c_adapter_service_queue(i2c_adapter);
+    }
 #else
     PIOS_IRQ_Disable();
     if (i2c_adapter->busy) {
@@ -1042,6 +1258,13 @@ int32_t PIOS_I2C_Transfer(uint32_t i2c_id, const struct pios_i2c_txn txn_list[],
     }
     i2c_adapter->busy = 1;
     PIOS_IRQ_Enable();
+
+    if (!i2c_adapter_claim_sync(i2c_adapter)) {
+        PIOS_IRQ_Disable();
+        i2c_adapter->busy = 0;
+        PIOS_IRQ_Enable();
+        return -2;
+    }
 #endif /* USE_FREERTOS */
 
     PIOS_DEBUG_Assert(i2c_adapter->curr_state == I2C_STATE_STOPPED);
@@ -1093,6 +1316,8 @@ int32_t PIOS_I2C_Transfer(uint32_t i2c_id, const struct pios_i2c_txn txn_list[],
         i2c_adapter_fsm_init(i2c_adapter);
     }
 
+    i2c_adapter_release_sync(i2c_adapter);
+
 #ifdef USE_FREERTOS
     /* Unlock the bus */
     xSemaphoreGive(i2c_adapter->sem_busy);
@@ -1167,6 +1392,115 @@ int32_t PIOS_I2C_Transfer_Callback(uint32_t i2c_id, const struct pios_i2c_txn tx
     return !semaphore_success ? -2 : 0;
 }
 
+/**
+ * Queue a transfer and return without waiting for it, so several sensors can be
+ * fetched back to back without a task switch per transfer.
+ * \param[in] i2c_id I2C adapter
+ * \param[in] request Transfer and completion callback, must stay valid until the callback
+ * \return 0 if the transfer has been queued
+ * \return -1 if the adapter is invalid, or without the callback scheduler to complete queued transfers
+ */
+int32_t PIOS_I2C_Transfer_Queued(uint32_t i2c_id, struct pios_i2c_request *request)
+{
+    struct pios_i2c_adapter *i2c_adapter = (struct pios_i2c_adapter *)i2c_id;
+    bool start;
+
+    if (!PIOS_I2C_validate(i2c_adapter)) {
+        return -1;
+    }
+
+    PIOS_Assert(request);
+    PIOS_Assert(request->callback);
+    PIOS_DEBUG_Assert(request->txn_list);
+    PIOS_DEBUG_Assert(request->num_txns);
+
+#ifndef PIOS_INCLUDE_CALLBACKSCHEDULER
+    /* Queued transfers are completed from a callback task */
+    return -1;
+#endif
+
+    request->next = NULL;
+
+    PIOS_IRQ_Disable();
+    if (i2c_adapter->queue_tail) {
+        i2c_adapter->queue_tail->next = request;
+    } else {
+        i2c_adapter->queue_head = request;
+    }
+    i2c_adapter->queue_tail = request;
+    start = !i2c_adapter->queue_active && !i2c_adapter->sync_active;
+    if (start) {
+        i2c_adapter->queue_active = true;
+    }
+    PIOS_IRQ_Enable();
+
+    if (start) {
+        i2c_adapter_start_queued(i2c_adapter);
+    }
+
+    return 0;
+}
+
+/**
+ * Take back a queued transfer, its callback is not called. A transfer already on the bus is
+ * aborted and the bus reset.
+ * \param[in] i2c_id I2C adapter
+ * \param[in] request Transfer queued with PIOS_I2C_Transfer_Queued()
+ * \return 0 if the request is no longer queued, it may be submitted again
+ * \return -1 if the adapter is invalid
+ * \return -2 if a task is completing a transfer right now, retry later
+ */
+int32_t PIOS_I2C_Transfer_Cancel(uint32_t i2c_id, struct pios_i2c_request *request)
+{
+    struct pios_i2c_adapter *i2c_adapter = (struct pios_i2c_adapter *)i2c_id;
+    struct pios_i2c_request *prev = NULL;
+    struct pios_i2c_request *cursor;
+    bool abort = false;
+
+    if (!PIOS_I2C_validate(i2c_adapter)) {
+        return -1;
+    }
+
+    PIOS_Assert(request);
+
+    PIOS_IRQ_Disable();
+    if (i2c_adapter->queue_servicing) {
+        /* The completed request is already unlinked but its callback may still be running */
+        PIOS_IRQ_Enable();
+        return -2;
+    }
+    if (i2c_adapter->queue_active && i2c_adapter->queue_head == request) {
+        /* On the bus, keep the queue to ourselves while aborting it */
+        i2c_adapter->queue_servicing = true;
+        abort = true;
+    } else {
+        for (cursor = i2c_adapter->queue_head; cursor; prev = cursor, cursor = cursor->next) {
+            if (cursor == request) {
+                if (prev) {
+                    prev->next = request->next;
+                } else {
+                    i2c_adapter->queue_head = request->next;
+                }
+                if (i2c_adapter->queue_tail == request) {
+                    i2c_adapter->queue_tail = prev;
+                }
+                break;
+            }
+        }
+    }
+    PIOS_IRQ_Enable();
+
+    if (abort) {
+        i2c_adapter_abort_queued(i2c_adapter);
+        if (i2c_adapter_dequeue(i2c_adapter)) {
+            i2c_adapter_start_queued(i2c_adapter);
+        }
+        i2c_adapter->queue_servicing = false;
+    }
+
+    return 0;
+}
+
 void PIOS_I2C_EV_IRQ_Handler(uint32_t i2c_id)
 {
     struct pios_i2c_adapter *i2c_adapter = (struct pios_i2c_adapter *)i2c_id;
@@ -1296,7 +1630,7 @@ void PIOS_I2C_EV_IRQ_Handler(uint32_t i2c_id)
     }
 
 skip_event:
-    ;
+    i2c_adapter_process_queue(i2c_adapter);
 }
 
 
@@ -1327,6 +1661,8 @@ void PIOS_I2C_ER_IRQ_Handler(uint32_t i2c_id)
         /* Fail hard on any errors for now */
         i2c_adapter_inject_event(i2c_adapter, I2C_EVENT_BUS_ERROR);
     }
+
+    i2c_adapter_process_queue(i2c_adapter);
 }
 
 #endif /* PIOS_INCLUDE_I2C */
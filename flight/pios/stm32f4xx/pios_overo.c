@@ -118,8 +118,7 @@ static struct pios_overo_dev *PIOS_OVERO_alloc(void)
  */
 static void PIOS_OVERO_WriteData(struct pios_overo_dev *overo_dev)
 {
-    // TODO: How do we protect against the DMA buffer swapping midway through adding data
-    // to this buffer.  If we were writing at the beginning it could cause a weird race.
+    // Called from the DMA interrupt, or with it masked (see PIOS_OVERO_TxStart())
     if (overo_dev->tx_out_cb) {
         int32_t max_bytes = PACKET_SIZE - overo_dev->writing_offset;
 
@@ -334,10 +333,17 @@ static void PIOS_OVERO_TxStart(uint32_t overo_id, __attribute__((unused)) uint16
 
     PIOS_Assert(valid);
 
-    // DMA TX enable (enable IRQ) ?
-
-    // Load any pending bytes from TX fifo
-    // PIOS_OVERO_WriteData(overo_dev);
+    /*
+     * Load the pending bytes in the buffer sent by the next transaction, rather than
+     * waiting for the end of the current one. The DMA interrupt is masked so the buffers
+     * are not swapped midway, and nothing is written if the hardware already switched to
+     * the writing buffer (the interrupt then runs as soon as it is unmasked).
+     */
+    NVIC_DisableIRQ(overo_dev->cfg->dma.irq.init.NVIC_IRQChannel);
+    if (overo_dev->writing_buffer == 1 - DMA_GetCurrentMemoryTarget(overo_dev->cfg->dma.tx.channel)) {
+        PIOS_OVERO_WriteData(overo_dev);
+    }
+    NVIC_EnableIRQ(overo_dev->cfg->dma.irq.init.NVIC_IRQChannel);
 }
 
 static void PIOS_OVERO_RegisterRxCallback(uint32_t overo_id, pios_com_callback rx_in_cb, uint32_t context)
@@ -49,6 +49,8 @@ static TIM_TypeDef *pios_servo_bank_timer[PIOS_SERVO_BANKS] = { 0 };
 
 // index of bank used for each pin
 static uint8_t *pios_servo_pin_bank;
+// compare register driving each pin
+static __IO uint32_t **pios_servo_pin_ccr;
 
 #define PIOS_SERVO_TIMER_CLOCK 1000000
 #define PIOS_SERVO_SAFE_MARGIN 50
@@ -66,6 +68,7 @@ int32_t PIOS_Servo_Init(const struct pios_servo_cfg *cfg)
     /* Store away the requested configuration */
     servo_cfg = cfg;
     pios_servo_pin_bank = pios_malloc(sizeof(uint8_t) * cfg->num_channels);
+    pios_servo_pin_ccr  = pios_malloc(sizeof(__IO uint32_t *) * cfg->num_channels);
 
     uint8_t bank = 0;
     for (uint8_t i = 0; (i < servo_cfg->num_channels); i++) {
@@ -97,18 +100,22 @@ int32_t PIOS_Servo_Init(const struct pios_servo_cfg *cfg)
         case TIM_Channel_1:
             TIM_OC1Init(chan->timer, &servo_cfg->tim_oc_init);
             TIM_OC1PreloadConfig(chan->timer, TIM_OCPreload_Enable);
+            pios_servo_pin_ccr[i] = &chan->timer->CCR1;
             break;
         case TIM_Channel_2:
             TIM_OC2Init(chan->timer, &servo_cfg->tim_oc_init);
             TIM_OC2PreloadConfig(chan->timer, TIM_OCPreload_Enable);
+            pios_servo_pin_ccr[i] = &chan->timer->CCR2;
             break;
         case TIM_Channel_3:
             TIM_OC3Init(chan->timer, &servo_cfg->tim_oc_init);
             TIM_OC3PreloadConfig(chan->timer, TIM_OCPreload_Enable);
+            pios_servo_pin_ccr[i] = &chan->timer->CCR3;
             break;
         case TIM_Channel_4:
             TIM_OC4Init(chan->timer, &servo_cfg->tim_oc_init);
             TIM_OC4PreloadConfig(chan->timer, TIM_OCPreload_Enable);
+            pios_servo_pin_ccr[i] = &chan->timer->CCR4;
             break;
         }
     }
@@ -152,6 +159,8 @@ void PIOS_Servo_SetBankMode(uint8_t bank, uint8_t mode)
 
 void PIOS_Servo_Update()
 {
+    // Fire all OneShot banks back to back so the motors get their new values together
+    PIOS_IRQ_Disable();
     for (uint8_t i = 0; (i < PIOS_SERVO_BANKS); i++) {
         const TIM_TypeDef *timer = pios_servo_bank_timer[i];
         if (timer && pios_servo_bank_mode[i] == PIOS_SERVO_BANK_MODE_SINGLE_PULSE) {
@@ -163,27 +172,14 @@ void PIOS_Servo_Update()
         }
         pios_servo_bank_max_pulse[i] = 0;
     }
+    PIOS_IRQ_Enable();
+
     for (uint8_t i = 0; (i < servo_cfg->num_channels); i++) {
         uint8_t bank = pios_servo_pin_bank[i];
         uint8_t mode = pios_servo_bank_mode[bank];
         if (mode == PIOS_SERVO_BANK_MODE_SINGLE_PULSE) {
-            /* Update the position */
-            const struct pios_tim_channel *chan = &servo_cfg->channels[i];
-
-            switch (chan->timer_chan) {
-            case TIM_Channel_1:
-                TIM_SetCompare1(chan->timer, 0);
-                break;
-            case TIM_Channel_2:
-                TIM_SetCompare2(chan->timer, 0);
-                break;
-            case TIM_Channel_3:
-                TIM_SetCompare3(chan->timer, 0);
-                break;
-            case TIM_Channel_4:
-                TIM_SetCompare4(chan->timer, 0);
-                break;
-            }
+            /* Clear the preloaded pulse so the next period stays low */
+            *pios_servo_pin_ccr[i] = 0;
         }
     }
 }
@@ -248,20 +244,7 @@ void PIOS_Servo_Set(uint8_t servo, uint16_t position)
     if (pios_servo_bank_max_pulse[bank] < val) {
         pios_servo_bank_max_pulse[bank] = val;
     }
-    switch (chan->timer_chan) {
-    case TIM_Channel_1:
-        TIM_SetCompare1(chan->timer, val);
-        break;
-    case TIM_Channel_2:
-        TIM_SetCompare2(chan->timer, val);
-        break;
-    case TIM_Channel_3:
-        TIM_SetCompare3(chan->timer, val);
-        break;
-    case TIM_Channel_4:
-        TIM_SetCompare4(chan->timer, val);
-        break;
-    }
+    *pios_servo_pin_ccr[servo] = val;
 }
 
 uint8_t PIOS_Servo_GetPinBank(uint8_t pin)
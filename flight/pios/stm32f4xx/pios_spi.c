@@ -34,7 +34,6 @@
  */
 /*
  * @todo	Clocking is wrong (interface is badly defined, should be speed not prescaler magic numbers)
- * @todo	DMA doesn't work.  Fix it.
  */
 #include <pios.h>
 
@@ -97,6 +96,7 @@ int32_t PIOS_SPI_Init(uint32_t *spi_id, const struct pios_spi_cfg *cfg)
 
     /* Disable callback function */
     spi_dev->callback = NULL;
+    spi_dev->async_callback = NULL;
 
     /* Set rx/tx dummy bytes to a known value */
     spi_dev->rx_dummy_byte = 0xFF;
@@ -443,6 +443,25 @@ int32_t PIOS_SPI_TransferByte(uint32_t spi_id, uint8_t b)
     return rx_byte;
 }
 
+/**
+ * Clear all event flags of a DMA stream. The flag bit positions depend on the
+ * stream number, so they are derived from the stream address instead of the
+ * board configuration, which only lists the RX stream flags.
+ */
+static void SPI_DMA_ClearStreamFlags(DMA_Stream_TypeDef *stream)
+{
+    static const uint8_t flag_shift[4] = { 0, 6, 16, 22 };
+    DMA_TypeDef *dma   = (DMA_TypeDef *)((uint32_t)stream & ~0xFFu);
+    uint32_t index     = (((uint32_t)stream & 0xFFu) - 0x10u) / 0x18u;
+    uint32_t mask      = 0x3Du << flag_shift[index & 3];
+
+    if (index < 4) {
+        dma->LIFCR = mask;
+    } else {
+        dma->HIFCR = mask;
+    }
+}
+
 /**
  * Transfers a block of bytes via DMA.
  * \param[in] spi SPI number (0 or 1)
@@ -485,10 +504,11 @@ static int32_t SPI_DMA_TransferBlock(uint32_t spi_id, const uint8_t *send_buffer
         ;
     }
 
-    /* Disable the SPI peripheral */
-    /* Initialize the SPI block */
-    SPI_DeInit(spi_dev->cfg->regs);
-    SPI_Init(spi_dev->cfg->regs, (SPI_InitTypeDef *)&(spi_dev->cfg->init));
+    /*
+     * Disable the SPI peripheral. The block is not re-initialised from the
+     * static configuration so a clock speed set by PIOS_SPI_SetClockSpeed()
+     * stays in effect.
+     */
     SPI_Cmd(spi_dev->cfg->regs, DISABLE);
     /* Configure CRC calculation */
     if (spi_dev->cfg->use_crc) {
@@ -556,7 +576,8 @@ static int32_t SPI_DMA_TransferBlock(uint32_t spi_id, const uint8_t *send_buffer
     DMA_Init(spi_dev->cfg->dma.tx.channel, &(dma_init));
 
     /* Enable DMA interrupt if callback function active */
-    DMA_ITConfig(spi_dev->cfg->dma.rx.channel, DMA_IT_TC, (callback != NULL) ? ENABLE : DISABLE);
+    bool async = (callback != NULL || spi_dev->async_callback != NULL);
+    DMA_ITConfig(spi_dev->cfg->dma.rx.channel, DMA_IT_TC, async ? ENABLE : DISABLE);
 
     /* Flush out the CRC registers */
     SPI_CalculateCRC(spi_dev->cfg->regs, DISABLE);
@@ -578,7 +599,7 @@ static int32_t SPI_DMA_TransferBlock(uint32_t spi_id, const uint8_t *send_buffer
     /* Reenable the SPI device */
     SPI_Cmd(spi_dev->cfg->regs, ENABLE);
 
-    if (callback) {
+    if (async) {
         /* User has requested a callback, don't wait for the transfer to complete. */
         return 0;
     }
@@ -702,6 +723,44 @@ int32_t PIOS_SPI_TransferBlock(uint32_t spi_id, const uint8_t *send_buffer, uint
     return SPI_PIO_TransferBlock(spi_id, send_buffer, receive_buffer, len);
 }
 
+/**
+ * Starts a DMA block transfer and returns immediately.
+ * The bus must be claimed and the slave selected by the caller, who keeps
+ * both until the callback has run.
+ * \param[in] spi_id SPI device handle
+ * \param[in] send_buffer pointer to buffer which should be sent.<BR>
+ * If NULL, 0xff (all-one) will be sent.
+ * \param[in] receive_buffer pointer to buffer which should get the received values.<BR>
+ * If NULL, received bytes will be discarded.
+ * \param[in] len number of bytes which should be transfered
+ * \param[in] callback function called from the DMA interrupt once the transfer is finished
+ * \param[in] context passed back to the callback
+ * \return >= 0 if the transfer has been started
+ * \return -3 if function has been called during an ongoing DMA transfer
+ */
+int32_t PIOS_SPI_TransferBlockAsync(uint32_t spi_id, const uint8_t *send_buffer, uint8_t *receive_buffer, uint16_t len, pios_spi_callback callback, uint32_t context)
+{
+    struct pios_spi_dev *spi_dev = (struct pios_spi_dev *)spi_id;
+
+    bool valid = PIOS_SPI_validate(spi_dev);
+
+    PIOS_Assert(valid)
+    PIOS_Assert(callback);
+
+    if (DMA_GetCurrDataCounter(spi_dev->cfg->dma.rx.channel)) {
+        return -3;
+    }
+
+    spi_dev->async_context  = context;
+    spi_dev->async_callback = callback;
+
+    int32_t ret = SPI_DMA_TransferBlock(spi_id, send_buffer, receive_buffer, len, NULL);
+    if (ret < 0) {
+        spi_dev->async_callback = NULL;
+    }
+    return ret;
+}
+
 /**
  * Check if a transfer is in progress
  * \param[in] spi SPI number (0 or 1)
@@ -736,8 +795,14 @@ void PIOS_SPI_IRQ_Handler(uint32_t spi_id)
 
     PIOS_Assert(valid)
 
-    // FIXME XXX Only RX channel or better clear flags for both channels?
-    DMA_ClearFlag(spi_dev->cfg->dma.rx.channel, spi_dev->cfg->dma.irq.flags);
+    SPI_DMA_ClearStreamFlags(spi_dev->cfg->dma.rx.channel);
+    SPI_DMA_ClearStreamFlags(spi_dev->cfg->dma.tx.channel);
+
+    /* Only the transfer complete interrupt is of interest */
+    if (DMA_GetCurrDataCounter(spi_dev->cfg->dma.rx.channel)) {
+        return;
+    }
+    DMA_ITConfig(spi_dev->cfg->dma.rx.channel, DMA_IT_TC, DISABLE);
 
     if (spi_dev->cfg->init.SPI_Mode == SPI_Mode_Master) {
         /* Wait for the final bytes of the transfer to complete, including CRC byte(s). */
@@ -751,7 +816,7 @@ void PIOS_SPI_IRQ_Handler(uint32_t spi_id)
         }
     }
 
-    if (spi_dev->callback != NULL) {
+    if (spi_dev->callback != NULL || spi_dev->async_callback != NULL) {
         bool crc_ok = true;
         uint8_t crc_val;
 
@@ -760,7 +825,14 @@ void PIOS_SPI_IRQ_Handler(uint32_t spi_id)
             SPI_I2S_ClearFlag(spi_dev->cfg->regs, SPI_FLAG_CRCERR);
         }
         crc_val = SPI_GetCRC(spi_dev->cfg->regs, SPI_CRC_Rx);
-        spi_dev->callback(crc_ok, crc_val);
+        if (spi_dev->async_callback != NULL) {
+            /* Clear before calling so the callback may start the next transfer */
+            pios_spi_callback callback = spi_dev->async_callback;
+            spi_dev->async_callback = NULL;
+            callback(spi_dev->async_context, crc_ok, crc_val);
+        } else {
+            spi_dev->callback(crc_ok, crc_val);
+        }
     }
 }
 
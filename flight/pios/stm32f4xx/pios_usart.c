@@ -53,6 +53,13 @@ const struct pios_com_driver pios_usart_com_driver = {
     .bind_rx_cb = PIOS_USART_RegisterRxCallback,
 };
 
+#ifndef PIOS_USART_DMA_RX_BUFFER_SIZE
+#define PIOS_USART_DMA_RX_BUFFER_SIZE 64
+#endif
+#ifndef PIOS_USART_DMA_TX_BUFFER_SIZE
+#define PIOS_USART_DMA_TX_BUFFER_SIZE 64
+#endif
+
 enum pios_usart_dev_magic {
     PIOS_USART_DEV_MAGIC = 0x4152834A,
 };
@@ -65,6 +72,11 @@ struct pios_usart_dev {
     uint32_t rx_in_context;
     pios_com_callback tx_out_cb;
     uint32_t tx_out_context;
+
+    /* DMA mode, buffers are only allocated for configured streams */
+    uint8_t  *rx_dma_buf;
+    uint16_t rx_dma_pos;
+    uint8_t  *tx_dma_buf;
 };
 
 static bool PIOS_USART_validate(struct pios_usart_dev *usart_dev)
@@ -113,6 +125,10 @@ static struct pios_usart_dev *PIOS_USART_alloc(void)
  * each physical IRQ to a specific registered device instance.
  */
 static void PIOS_USART_generic_irq_handler(uint32_t usart_id);
+static void PIOS_USART_DMA_Init(struct pios_usart_dev *usart_dev);
+static void PIOS_USART_DMA_RxFlush(struct pios_usart_dev *usart_dev, bool *need_yield);
+static void PIOS_USART_DMA_TxNext(struct pios_usart_dev *usart_dev, bool *need_yield);
+static void PIOS_USART_DMA_generic_irq_handler(struct pios_usart_dev *usart_dev);
 
 static uint32_t PIOS_USART_1_id;
 void USART1_IRQHandler(void) __attribute__((alias("PIOS_USART_1_irq_handler")));
@@ -216,8 +232,18 @@ int32_t PIOS_USART_Init(uint32_t *usart_id, const struct pios_usart_cfg *cfg)
         break;
     }
     NVIC_Init((NVIC_InitTypeDef *)&(usart_dev->cfg->irq.init));
-    USART_ITConfig(usart_dev->cfg->regs, USART_IT_RXNE, ENABLE);
-    USART_ITConfig(usart_dev->cfg->regs, USART_IT_TXE, ENABLE);
+    if (usart_dev->cfg->dma) {
+        PIOS_USART_DMA_Init(usart_dev);
+    }
+    if (usart_dev->rx_dma_buf) {
+        /* Bytes go straight to memory, the idle line marks the end of a burst */
+        USART_ITConfig(usart_dev->cfg->regs, USART_IT_IDLE, ENABLE);
+    } else {
+        USART_ITConfig(usart_dev->cfg->regs, USART_IT_RXNE, ENABLE);
+    }
+    if (!usart_dev->tx_dma_buf) {
+        USART_ITConfig(usart_dev->cfg->regs, USART_IT_TXE, ENABLE);
+    }
 
     // FIXME XXX Clear / reset uart here - sends NUL char else
 
@@ -238,7 +264,10 @@ static void PIOS_USART_RxStart(uint32_t usart_id, __attribute__((unused)) uint16
 
     PIOS_Assert(valid);
 
-    USART_ITConfig(usart_dev->cfg->regs, USART_IT_RXNE, ENABLE);
+    /* The circular DMA receiver never stops */
+    if (!usart_dev->rx_dma_buf) {
+        USART_ITConfig(usart_dev->cfg->regs, USART_IT_RXNE, ENABLE);
+    }
 }
 static void PIOS_USART_TxStart(uint32_t usart_id, __attribute__((unused)) uint16_t tx_bytes_avail)
 {
@@ -248,7 +277,12 @@ static void PIOS_USART_TxStart(uint32_t usart_id, __attribute__((unused)) uint16
 
     PIOS_Assert(valid);
 
-    USART_ITConfig(usart_dev->cfg->regs, USART_IT_TXE, ENABLE);
+    if (usart_dev->tx_dma_buf) {
+        /* Let the TX stream ISR pick up the data so only one context touches the stream */
+        NVIC_SetPendingIRQ((IRQn_Type)usart_dev->cfg->dma->tx_irq.init.NVIC_IRQChannel);
+    } else {
+        USART_ITConfig(usart_dev->cfg->regs, USART_IT_TXE, ENABLE);
+    }
 }
 
 /**
@@ -316,6 +350,11 @@ static void PIOS_USART_generic_irq_handler(uint32_t usart_id)
 
     PIOS_Assert(valid);
 
+    if (usart_dev->rx_dma_buf || usart_dev->tx_dma_buf) {
+        PIOS_USART_DMA_generic_irq_handler(usart_dev);
+        return;
+    }
+
     /* Force read of dr after sr to make sure to clear error flags */
     volatile uint16_t sr = usart_dev->cfg->regs->SR;
     volatile uint8_t dr  = usart_dev->cfg->regs->DR;
@@ -358,6 +397,201 @@ static void PIOS_USART_generic_irq_handler(uint32_t usart_id)
 #endif /* PIOS_INCLUDE_FREERTOS */
 }
 
+/**
+ * Set up the configured DMA streams. The RX stream writes into a circular
+ * buffer that is handed to the COM layer in chunks, the TX stream sends
+ * chunks pulled from the COM fifo.
+ */
+static void PIOS_USART_DMA_Init(struct pios_usart_dev *usart_dev)
+{
+    const struct pios_usart_dma *dma = usart_dev->cfg->dma;
+    DMA_InitTypeDef dma_init;
+
+    if (dma->rx.channel) {
+        usart_dev->rx_dma_buf = (uint8_t *)pios_malloc(PIOS_USART_DMA_RX_BUFFER_SIZE);
+    }
+    if (usart_dev->rx_dma_buf) {
+        /* Both the USART and the RX stream interrupts flush the stream, neither may preempt the other */
+        PIOS_Assert(dma->rx_irq.init.NVIC_IRQChannelPreemptionPriority == usart_dev->cfg->irq.init.NVIC_IRQChannelPreemptionPriority);
+        dma_init = dma->rx.init;
+        dma_init.DMA_PeripheralBaseAddr = (uint32_t)&(usart_dev->cfg->regs->DR);
+        dma_init.DMA_Memory0BaseAddr    = (uint32_t)usart_dev->rx_dma_buf;
+        dma_init.DMA_DIR        = DMA_DIR_PeripheralToMemory;
+        dma_init.DMA_BufferSize = PIOS_USART_DMA_RX_BUFFER_SIZE;
+        dma_init.DMA_Mode       = DMA_Mode_Circular;
+        DMA_DeInit(dma->rx.channel);
+        DMA_Init(dma->rx.channel, &dma_init);
+        DMA_ITConfig(dma->rx.channel, DMA_IT_HT | DMA_IT_TC, ENABLE);
+        NVIC_Init((NVIC_InitTypeDef *)&(dma->rx_irq.init));
+        USART_DMACmd(usart_dev->cfg->regs, USART_DMAReq_Rx, ENABLE);
+        DMA_Cmd(dma->rx.channel, ENABLE);
+    }
+
+    if (dma->tx.channel) {
+        usart_dev->tx_dma_buf = (uint8_t *)pios_malloc(PIOS_USART_DMA_TX_BUFFER_SIZE);
+    }
+    if (usart_dev->tx_dma_buf) {
+        dma_init = dma->tx.init;
+        dma_init.DMA_PeripheralBaseAddr = (uint32_t)&(usart_dev->cfg->regs->DR);
+        dma_init.DMA_Memory0BaseAddr    = (uint32_t)usart_dev->tx_dma_buf;
+        dma_init.DMA_DIR        = DMA_DIR_MemoryToPeripheral;
+        dma_init.DMA_BufferSize = PIOS_USART_DMA_TX_BUFFER_SIZE;
+        dma_init.DMA_Mode       = DMA_Mode_Normal;
+        DMA_DeInit(dma->tx.channel);
+        DMA_Init(dma->tx.channel, &dma_init);
+        DMA_ITConfig(dma->tx.channel, DMA_IT_TC, ENABLE);
+        NVIC_Init((NVIC_InitTypeDef *)&(dma->tx_irq.init));
+        USART_DMACmd(usart_dev->cfg->regs, USART_DMAReq_Tx, ENABLE);
+    }
+}
+
+/**
+ * Hand everything the RX stream wrote since the last call to the COM layer.
+ * Not reentrant, the USART and RX stream interrupts calling it share their
+ * preemption priority (checked in PIOS_USART_DMA_Init()).
+ */
+static void PIOS_USART_DMA_RxFlush(struct pios_usart_dev *usart_dev, bool *need_yield)
+{
+    uint16_t head = PIOS_USART_DMA_RX_BUFFER_SIZE - DMA_GetCurrDataCounter(usart_dev->cfg->dma->rx.channel);
+    uint16_t tail = usart_dev->rx_dma_pos;
+    bool yield    = false;
+
+    if (head >= PIOS_USART_DMA_RX_BUFFER_SIZE) {
+        head = 0;
+    }
+    if (head == tail) {
+        return;
+    }
+    if (usart_dev->rx_in_cb) {
+        if (head > tail) {
+            (void)(usart_dev->rx_in_cb)(usart_dev->rx_in_context, &usart_dev->rx_dma_buf[tail], head - tail, NULL, &yield);
+            *need_yield |= yield;
+        } else {
+            (void)(usart_dev->rx_in_cb)(usart_dev->rx_in_context, &usart_dev->rx_dma_buf[tail], PIOS_USART_DMA_RX_BUFFER_SIZE - tail, NULL, &yield);
+            *need_yield |= yield;
+            if (head > 0) {
+                (void)(usart_dev->rx_in_cb)(usart_dev->rx_in_context, usart_dev->rx_dma_buf, head, NULL, &yield);
+                *need_yield |= yield;
+            }
+        }
+    }
+    usart_dev->rx_dma_pos = head;
+}
+
+/**
+ * Start the next TX transfer if the stream is idle and the COM fifo has data.
+ * Only called from the TX stream interrupt.
+ */
+static void PIOS_USART_DMA_TxNext(struct pios_usart_dev *usart_dev, bool *need_yield)
+{
+    DMA_Stream_TypeDef *stream = usart_dev->cfg->dma->tx.channel;
+
+    if (DMA_GetCmdStatus(stream) == ENABLE || !usart_dev->tx_out_cb) {
+        return;
+    }
+
+    uint16_t bytes_to_send = (usart_dev->tx_out_cb)(usart_dev->tx_out_context, usart_dev->tx_dma_buf, PIOS_USART_DMA_TX_BUFFER_SIZE, NULL, need_yield);
+    if (bytes_to_send > 0) {
+        DMA_SetCurrDataCounter(stream, bytes_to_send);
+        DMA_Cmd(stream, ENABLE);
+    }
+}
+
+/**
+ * USART interrupt in DMA mode: only the idle line (RX) and, without a TX
+ * stream, the byte transmitter are of interest.
+ */
+static void PIOS_USART_DMA_generic_irq_handler(struct pios_usart_dev *usart_dev)
+{
+    bool rx_need_yield = false;
+    bool tx_need_yield = false;
+    volatile uint16_t sr = usart_dev->cfg->regs->SR;
+
+    if (usart_dev->rx_dma_buf) {
+        if (sr & (USART_SR_IDLE | USART_SR_ORE)) {
+            /* Reading DR after SR clears the idle and overrun flags */
+            (void)usart_dev->cfg->regs->DR;
+            PIOS_USART_DMA_RxFlush(usart_dev, &rx_need_yield);
+        }
+    } else if (sr & USART_SR_RXNE) {
+        uint8_t byte = usart_dev->cfg->regs->DR;
+        if (usart_dev->rx_in_cb) {
+            (void)(usart_dev->rx_in_cb)(usart_dev->rx_in_context, &byte, 1, NULL, &rx_need_yield);
+        }
+    }
+
+    if (!usart_dev->tx_dma_buf && (sr & USART_SR_TXE)) {
+        uint8_t b;
+        if (usart_dev->tx_out_cb && (usart_dev->tx_out_cb)(usart_dev->tx_out_context, &b, 1, NULL, &tx_need_yield) > 0) {
+            usart_dev->cfg->regs->DR = b;
+        } else {
+            USART_ITConfig(usart_dev->cfg->regs, USART_IT_TXE, DISABLE);
+        }
+    }
+
+#if defined(PIOS_INCLUDE_FREERTOS)
+    if (rx_need_yield || tx_need_yield) {
+        vPortYield();
+    }
+#endif /* PIOS_INCLUDE_FREERTOS */
+}
+
+/**
+ * Common handler for the RX and TX DMA stream interrupts of a USART.
+ * \param[in] regs USART the streams belong to
+ */
+void PIOS_USART_DMA_irq_handler(USART_TypeDef *regs)
+{
+    uint32_t usart_id;
+
+    switch ((uint32_t)regs) {
+    case (uint32_t)USART1:
+        usart_id = PIOS_USART_1_id;
+        break;
+    case (uint32_t)USART2:
+        usart_id = PIOS_USART_2_id;
+        break;
+    case (uint32_t)USART3:
+        usart_id = PIOS_USART_3_id;
+        break;
+    case (uint32_t)UART4:
+        usart_id = PIOS_USART_4_id;
+        break;
+    case (uint32_t)UART5:
+        usart_id = PIOS_USART_5_id;
+        break;
+    case (uint32_t)USART6:
+        usart_id = PIOS_USART_6_id;
+        break;
+    default:
+        return;
+    }
+
+    struct pios_usart_dev *usart_dev = (struct pios_usart_dev *)usart_id;
+
+    bool valid = PIOS_USART_validate(usart_dev);
+
+    PIOS_Assert(valid);
+
+    bool rx_need_yield = false;
+    bool tx_need_yield = false;
+
+    if (usart_dev->rx_dma_buf) {
+        DMA_ClearITPendingBit(usart_dev->cfg->dma->rx.channel, usart_dev->cfg->dma->rx_irq.flags);
+        PIOS_USART_DMA_RxFlush(usart_dev, &rx_need_yield);
+    }
+    if (usart_dev->tx_dma_buf) {
+        DMA_ClearITPendingBit(usart_dev->cfg->dma->tx.channel, usart_dev->cfg->dma->tx_irq.flags);
+        PIOS_USART_DMA_TxNext(usart_dev, &tx_need_yield);
+    }
+
+#if defined(PIOS_INCLUDE_FREERTOS)
+    if (rx_need_yield || tx_need_yield) {
+        vPortYield();
+    }
+#endif /* PIOS_INCLUDE_FREERTOS */
+}
+
 #endif /* PIOS_INCLUDE_USART */
 
 /**
@@ -40,6 +40,10 @@
 static ledbuf_t *fb = 0;
 // bitmask with pin to be set/reset using dma
 static ledbuf_t dmaSource[4];
+// colors held in the framebuffer, the bit stream is only rebuilt and sent when they change
+static Color_t ledColors[PIOS_WS2811_NUMLEDS];
+// framebuffer changed since the last transfer started
+static volatile bool fbDirty = false;
 
 static const struct pios_ws2811_cfg *pios_ws2811_cfg;
 static const struct pios_ws2811_pin_cfg *pios_ws2811_pin_cfg;
@@ -179,6 +183,8 @@ void PIOS_WS2811_Init(const struct pios_ws2811_cfg *ws2811_cfg, const struct pio
     memset(fb, 0, PIOS_WS2811_BUFFER_SIZE * sizeof(ledbuf_t));
     const Color_t ledoff = Color_Off;
     for (uint8_t i = 0; i < PIOS_WS2811_NUMLEDS; i++) {
+        // force the first write of each led
+        ledColors[i].R = ~ledoff.R;
         PIOS_WS2811_setColorRGB(ledoff, i, false);
     }
     // Setup timers
@@ -307,9 +313,13 @@ void PIOS_WS2811_setColorRGB(Color_t c, uint8_t led, bool update)
     if (led >= PIOS_WS2811_NUMLEDS) {
         return;
     }
-    setColor(c.G, fb + (led * 24));
-    setColor(c.R, fb + 8 + (led * 24));
-    setColor(c.B, fb + 16 + (led * 24));
+    if (ledColors[led].R != c.R || ledColors[led].G != c.G || ledColors[led].B != c.B) {
+        ledColors[led] = c;
+        setColor(c.G, fb + (led * 24));
+        setColor(c.R, fb + 8 + (led * 24));
+        setColor(c.B, fb + 16 + (led * 24));
+        fbDirty = true;
+    }
 
     if (update) {
         PIOS_WS2811_Update();
@@ -317,15 +327,11 @@ void PIOS_WS2811_setColorRGB(Color_t c, uint8_t led, bool update)
 }
 
 /**
- * trigger an update cycle if not already running
+ * start sending the framebuffer
  */
-void PIOS_WS2811_Update()
+static void startTransfer()
 {
-    // does not start if framebuffer is not allocated (init has not been called yet) or a transfer is still on going
-    if (!fb || (pios_ws2811_cfg->timer->CR1 & TIM_CR1_CEN)) {
-        return;
-    }
-
+    fbDirty = false;
     // reset counters for synchronization
     pios_ws2811_cfg->timer->CNT = PIOS_WS2811_TIM_PERIOD - 1;
 
@@ -336,6 +342,19 @@ void PIOS_WS2811_Update()
     TIM_Cmd(pios_ws2811_cfg->timer, ENABLE);
 }
 
+/**
+ * trigger an update cycle if the leds changed and it is not already running.
+ * Changes made during a transfer are sent by the next call once it completes.
+ */
+void PIOS_WS2811_Update()
+{
+    // does not start if framebuffer is not allocated (init has not been called yet) or a transfer is still on going
+    if (!fb || !fbDirty || (pios_ws2811_cfg->timer->CR1 & TIM_CR1_CEN)) {
+        return;
+    }
+    startTransfer();
+}
+
 /**
  * Stop timer once the complete framebuffer has been sent
  */
@@ -39,6 +39,7 @@
  */
 
 #define MODULE_INITCALL(ifn, sfn)
+#define MODULE_INITCALL_DEFERRED(ifn, sfn)
 
 #define MODULE_TASKCREATE_ALL
 
@@ -51,6 +52,10 @@
         SystemModInitialize(); }
 
 
+#define MODULE_INITIALISE_DEFERRED
+
+#define PIOS_INITCALL_PROFILE(phase, code) { code; }
+
 #endif /* PIOS_INITCALL_H */
 
 /**
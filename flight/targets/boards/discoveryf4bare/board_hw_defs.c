@@ -586,6 +586,10 @@ static const struct flashfs_logfs_cfg flashfs_internal_cfg = {
     .start_offset  = EE_BANK_BASE, /* start after the bootloader */
     .sector_size   = 0x00004000, /* 16K bytes */
     .page_size     = 0x00004000, /* 16K bytes */
+
+    .index_size    = 64, /* settings objects tracked in RAM */
+    .gc_headroom   = 8, /* compact in the background below this many free slots */
+    .batch_size    = 16, /* settings saves committed together */
 };
 
 static const struct flashfs_logfs_cfg flashfs_internal_user_cfg = {
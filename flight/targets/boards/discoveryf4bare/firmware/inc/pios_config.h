@@ -56,7 +56,8 @@
 #define PIOS_INCLUDE_SYS
 #define PIOS_INCLUDE_TASK_MONITOR
 
-#define PIOS_INSTRUMENTATION_MAX_COUNTERS 10
+#define PIOS_INSTRUMENTATION_MAX_COUNTERS 16
+#define PIOS_INSTRUMENTATION_TRACE_LENGTH 256
 #define PIOS_INCLUDE_INSTRUMENTATION
 
 /* PIOS hardware peripherals */
@@ -143,6 +144,7 @@
 #define PIOS_INCLUDE_COM_FLEXI
 /* #define PIOS_INCLUDE_COM_AUX */
 #define PIOS_TELEM_PRIORITY_QUEUE
+#define PIOS_TELEM_BANDWIDTH_BUDGET
 #define PIOS_INCLUDE_GPS
 /* #define PIOS_GPS_MINIMAL */
 #define PIOS_INCLUDE_GPS_NMEA_PARSER
@@ -211,8 +211,8 @@ uint32_t pios_rcvr_group_map[MANUALCONTROLSETTINGS_CHANNELGROUPS_NONE];
 
 #define PIOS_COM_GPS_RX_BUF_LEN          32
 
-#define PIOS_COM_TELEM_USB_RX_BUF_LEN    65
-#define PIOS_COM_TELEM_USB_TX_BUF_LEN    65
+#define PIOS_COM_TELEM_USB_RX_BUF_LEN    256
+#define PIOS_COM_TELEM_USB_TX_BUF_LEN    512
 
 #define PIOS_COM_BRIDGE_RX_BUF_LEN       65
 #define PIOS_COM_BRIDGE_TX_BUF_LEN       12
@@ -349,6 +349,9 @@ void PIOS_Board_Init(void)
 
 #ifdef PIOS_INCLUDE_INSTRUMENTATION
     PIOS_Instrumentation_Init(PIOS_INSTRUMENTATION_MAX_COUNTERS);
+#ifdef PIOS_INSTRUMENTATION_TRACE_LENGTH
+    PIOS_Instrumentation_InitTrace(PIOS_INSTRUMENTATION_TRACE_LENGTH);
+#endif
 #endif
 
 
@@ -680,11 +680,12 @@ const struct pios_rfm22b_cfg *PIOS_BOARD_HW_DEFS_GetRfm22Cfg(uint32_t board_revi
 #include "pios_flashfs_logfs_priv.h"
 #include "pios_flash_jedec_priv.h"
 #include "pios_flash_internal_priv.h"
+#include "pios_blackbox_priv.h"
 
 static const struct flashfs_logfs_cfg flashfs_external_user_cfg = {
-    .fs_magic      = 0x99abceff,
-    .total_fs_size = 0x001C0000, /* 2M bytes (32 sectors = entire chip) */
-    .arena_size    = 0x000E0000, /* biggest possible arena size fssize/2 */
+    .fs_magic      = 0x99abcf00, /* changed along with the layout, the old user log is reformatted */
+    .total_fs_size = 0x00040000, /* 256K bytes (4 sectors) */
+    .arena_size    = 0x00020000, /* biggest possible arena size fssize/2 */
     .slot_size     = 0x00000100, /* 256 bytes */
 
     .start_offset  = 0x00040000, /* start offset */
@@ -701,7 +702,21 @@ static const struct flashfs_logfs_cfg flashfs_external_system_cfg = {
     .start_offset  = 0,          /* start at the beginning of the chip */
     .sector_size   = 0x00010000, /* 64K bytes */
     .page_size     = 0x00000100, /* 256 bytes */
+
+    .index_size    = 64, /* settings objects tracked in RAM */
+    .gc_headroom   = 32, /* compact in the background below this many free slots */
+    .batch_size    = 16, /* settings saves committed together */
+};
+
+#if defined(PIOS_INCLUDE_BLACKBOX)
+static const struct pios_blackbox_cfg blackbox_external_cfg = {
+    .start_offset  = 0x00080000, /* after the user filesystem */
+    .size          = 0x00180000, /* 1.5M bytes (24 sectors, rest of the chip) */
+    .sector_size   = 0x00010000, /* 64K bytes */
+    .page_size     = 0x00000100, /* 256 bytes */
+    .chunk_size    = 0x00000800, /* 2K bytes buffered in RAM, twice */
 };
+#endif
 
 
 static const struct pios_flash_internal_cfg flash_internal_cfg = {};
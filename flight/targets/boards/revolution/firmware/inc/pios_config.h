@@ -53,11 +53,13 @@
 /* PIOS system functions */
 #define PIOS_INCLUDE_DELAY
 #define PIOS_INCLUDE_INITCALL
+#define PIOS_INCLUDE_INITCALL_PROFILE
 #define PIOS_INCLUDE_SYS
 #define PIOS_INCLUDE_TASK_MONITOR
 
 #define PIOS_INCLUDE_INSTRUMENTATION
-#define PIOS_INSTRUMENTATION_MAX_COUNTERS 10
+#define PIOS_INSTRUMENTATION_MAX_COUNTERS 16
+#define PIOS_INSTRUMENTATION_TRACE_LENGTH 256
 
 /* PIOS hardware peripherals */
 #define PIOS_INCLUDE_IRQ
@@ -122,6 +124,7 @@
 #define PIOS_INCLUDE_FLASH_INTERNAL
 #define PIOS_INCLUDE_FLASH_LOGFS_SETTINGS
 #define FLASH_FREERTOS
+#define PIOS_INCLUDE_BLACKBOX
 /* #define PIOS_INCLUDE_FLASH_EEPROM */
 
 /* PIOS radio modules */
@@ -143,6 +146,9 @@
 #define PIOS_INCLUDE_COM_FLEXI
 /* #define PIOS_INCLUDE_COM_AUX */
 #define PIOS_TELEM_PRIORITY_QUEUE
+#define PIOS_TELEM_BANDWIDTH_BUDGET
+#define PIOS_TELEM_FANOUT
+#define PIOS_TELEM_POLICY_CACHE
 #define PIOS_INCLUDE_GPS
 /* #define PIOS_GPS_MINIMAL */
 #define PIOS_INCLUDE_GPS_NMEA_PARSER
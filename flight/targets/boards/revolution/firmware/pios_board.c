@@ -208,6 +208,8 @@ static const struct pios_mpu6000_cfg pios_mpu6000_cfg = {
     .fast_prescaler = PIOS_SPI_PRESCALER_4,
     .std_prescaler  = PIOS_SPI_PRESCALER_64,
     .max_downsample = 20,
+    // read the 8kHz samples from the FIFO, 8 at a time
+    .fifo_burst     = 8,
 };
 #endif /* PIOS_INCLUDE_MPU6000 */
 
@@ -223,11 +225,11 @@ uint32_t pios_rcvr_group_map[MANUALCONTROLSETTINGS_CHANNELGROUPS_NONE];
 #define PIOS_COM_GPS_RX_BUF_LEN          128
 #define PIOS_COM_GPS_TX_BUF_LEN          32
 
-#define PIOS_COM_TELEM_USB_RX_BUF_LEN    65
-#define PIOS_COM_TELEM_USB_TX_BUF_LEN    65
+#define PIOS_COM_TELEM_USB_RX_BUF_LEN    256
+#define PIOS_COM_TELEM_USB_TX_BUF_LEN    512
 
 #define PIOS_COM_BRIDGE_RX_BUF_LEN       65
-#define PIOS_COM_BRIDGE_TX_BUF_LEN       12
+#define PIOS_COM_BRIDGE_TX_BUF_LEN       65
 
 #define PIOS_COM_RFM22B_RF_RX_BUF_LEN    512
 #define PIOS_COM_RFM22B_RF_TX_BUF_LEN    512
@@ -256,6 +258,9 @@ uint32_t pios_rfm22b_id        = 0;
 
 uintptr_t pios_uavo_settings_fs_id;
 uintptr_t pios_user_fs_id;
+#if defined(PIOS_INCLUDE_BLACKBOX)
+uintptr_t pios_blackbox_id;
+#endif
 
 /*
  * Setup a com port based on the passed cfg, driver and buffer sizes. tx size of -1 make the port rx only
@@ -371,6 +376,9 @@ void PIOS_Board_Init(void)
 
 #ifdef PIOS_INCLUDE_INSTRUMENTATION
     PIOS_Instrumentation_Init(PIOS_INSTRUMENTATION_MAX_COUNTERS);
+#ifdef PIOS_INSTRUMENTATION_TRACE_LENGTH
+    PIOS_Instrumentation_InitTrace(PIOS_INSTRUMENTATION_TRACE_LENGTH);
+#endif
 #endif
 
     /* Set up the SPI interface to the gyro/acelerometer */
@@ -506,6 +514,11 @@ void PIOS_Board_Init(void)
     if (PIOS_FLASHFS_Logfs_Init(&pios_user_fs_id, &flashfs_external_user_cfg, &pios_jedec_flash_driver, flash_id)) {
         PIOS_DEBUG_Assert(0);
     }
+#if defined(PIOS_INCLUDE_BLACKBOX)
+    if (PIOS_BLACKBOX_Init(&pios_blackbox_id, &blackbox_external_cfg, &pios_jedec_flash_driver, flash_id)) {
+        PIOS_DEBUG_Assert(0);
+    }
+#endif
 #endif /* if defined(PIOS_INCLUDE_FLASH) */
 
 #if defined(PIOS_INCLUDE_USB)
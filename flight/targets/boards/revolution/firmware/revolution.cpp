@@ -95,6 +95,9 @@ int main()
 
     /* Brings up System using CMSIS functions, enables the LEDs. */
     PIOS_SYS_Init();
+#ifdef PIOS_INCLUDE_INITCALL_PROFILE
+    PIOS_INITCALL_ProfileBoot();
+#endif
 
     /* For Revolution we use a FreeRTOS task to bring up the system so we can */
     /* always rely on FreeRTOS primitive */
@@ -125,7 +128,7 @@ int main()
 void initTask(__attribute__((unused)) void *parameters)
 {
     /* board driver init */
-    PIOS_Board_Init();
+    PIOS_INITCALL_PROFILE(PIOS_INITCALL_PHASE_BOARD, PIOS_Board_Init());
 
     /* Initialize modules */
     MODULE_INITIALISE_ALL;
@@ -295,11 +295,11 @@ uint32_t pios_rcvr_group_map[MANUALCONTROLSETTINGS_CHANNELGROUPS_NONE];
 
 #define PIOS_COM_GPS_RX_BUF_LEN       32
 
-#define PIOS_COM_TELEM_USB_RX_BUF_LEN 65
-#define PIOS_COM_TELEM_USB_TX_BUF_LEN 65
+#define PIOS_COM_TELEM_USB_RX_BUF_LEN 256
+#define PIOS_COM_TELEM_USB_TX_BUF_LEN 512
 
 #define PIOS_COM_BRIDGE_RX_BUF_LEN    65
-#define PIOS_COM_BRIDGE_TX_BUF_LEN    12
+#define PIOS_COM_BRIDGE_TX_BUF_LEN    65
 
 #define PIOS_COM_AUX_RX_BUF_LEN       512
 #define PIOS_COM_AUX_TX_BUF_LEN       512
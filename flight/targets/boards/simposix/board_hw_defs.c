@@ -64,6 +64,24 @@ const struct pios_udp_cfg pios_udp_aux_cfg = {
 
 #endif /* PIOS_UDP */
 
+#ifdef PIOS_INCLUDE_SHM
+/* The shared memory object is named after the instance, see pios_board.c */
+#include <pios_shm_priv.h>
+#endif /* PIOS_INCLUDE_SHM */
+
+#ifdef PIOS_INCLUDE_SIMCLOCK
+
+#include <pios_simclock_priv.h>
+
+/*
+ * Step requests from a lockstep simulator
+ */
+const struct pios_simclock_cfg pios_simclock_cfg = {
+    .ip   = "0.0.0.0",
+    .port = 9003,
+};
+#endif /* PIOS_INCLUDE_SIMCLOCK */
+
 #if defined(PIOS_INCLUDE_COM)
 
 #include <pios_com_priv.h>
@@ -65,6 +65,8 @@
 #define configUSE_RECURSIVE_MUTEXES                  1
 #define configUSE_COUNTING_SEMAPHORES                0
 #define configUSE_ALTERNATIVE_API                    0
+/* Telemetry TX task blocks on both of its queues */
+#define configUSE_QUEUE_SETS                         1
 #define configCHECK_FOR_STACK_OVERFLOW               2
 #define configQUEUE_REGISTRY_SIZE                    10
 
@@ -86,6 +88,11 @@
 #define INCLUDE_xTaskGetSchedulerState               1
 #define INCLUDE_xTaskGetCurrentTaskHandle            1
 #define INCLUDE_uxTaskGetStackHighWaterMark          0
+#define INCLUDE_xTaskGetIdleTaskHandle               1
+
+/* Let a simulator step the tick in lockstep, the hooks come from
+   PIOS_INCLUDE_SIMCLOCK (pios_simclock.c) */
+#define configUSE_LOCKSTEP_CLOCK                     1
 
 
 /* This is the raw value as per the Cortex-M3 NVIC.  Values can be 255
@@ -60,6 +60,8 @@
 #define PIOS_INCLUDE_RTC
 #define PIOS_INCLUDE_WDG
 #define PIOS_INCLUDE_UDP
+#define PIOS_INCLUDE_SIMCLOCK
+#define PIOS_INCLUDE_SHM
 
 /* Select the sensors to include */
 // #define PIOS_INCLUDE_BMA180
@@ -105,6 +107,7 @@
 /* Flags that alter behaviors - mostly to lower resources for CC */
 #define PIOS_INCLUDE_INITCALL          /* Include init call structures */
 #define PIOS_TELEM_PRIORITY_QUEUE      /* Enable a priority queue in telemetry */
+#define PIOS_TELEM_BANDWIDTH_BUDGET    /* Stretch telemetry periods to fit the link rate */
 #define PIOS_QUATERNION_STABILIZATION  /* Stabilization options */
 // #define PIOS_GPS_SETS_HOMELOCATION      /* GPS options */
 
@@ -78,6 +78,59 @@ uint32_t pios_com_bridge_id    = 0;
 uintptr_t pios_uavo_settings_fs_id;
 uintptr_t pios_user_fs_id;
 
+/* Instance number from the command line, see simposix.c */
+extern uint8_t simposix_instance;
+
+/* Every instance gets its own block of UDP ports: 9000 + 10 * instance and up */
+#define SIMPOSIX_PORT_STRIDE 10
+
+static const struct pios_udp_cfg *PIOS_Board_instance_cfg(const struct pios_udp_cfg *cfg)
+{
+    if (!simposix_instance) {
+        return cfg;
+    }
+
+    struct pios_udp_cfg *instance_cfg = (struct pios_udp_cfg *)pvPortMalloc(sizeof(struct pios_udp_cfg));
+    PIOS_Assert(instance_cfg);
+    *instance_cfg = *cfg;
+    instance_cfg->port += simposix_instance * SIMPOSIX_PORT_STRIDE;
+
+    return instance_cfg;
+}
+
+#if defined(PIOS_INCLUDE_SHM)
+/* Telemetry over shared memory instead of UDP, see simposix.c */
+extern bool simposix_shm;
+
+/*
+ * Setup a com port over the shared memory object of this instance
+ */
+static void PIOS_Board_configure_shm_com(size_t rx_buf_len, size_t tx_buf_len, uint32_t *pios_com_id)
+{
+    static char shm_name[32];
+    static const struct pios_shm_cfg shm_cfg = {
+        .name = shm_name,
+    };
+    uint32_t pios_shm_id;
+
+    snprintf(shm_name, sizeof(shm_name), PIOS_SHM_NAME_FORMAT, simposix_instance);
+    if (PIOS_SHM_Init(&pios_shm_id, &shm_cfg)) {
+        PIOS_Assert(0);
+    }
+
+    uint8_t *rx_buffer = (uint8_t *)pvPortMalloc(rx_buf_len);
+    PIOS_Assert(rx_buffer);
+    uint8_t *tx_buffer = (uint8_t *)pvPortMalloc(tx_buf_len);
+    PIOS_Assert(tx_buffer);
+
+    if (PIOS_COM_Init(pios_com_id, &pios_shm_com_driver, pios_shm_id,
+                      rx_buffer, rx_buf_len,
+                      tx_buffer, tx_buf_len)) {
+        PIOS_Assert(0);
+    }
+}
+#endif /* PIOS_INCLUDE_SHM */
+
 /*
  * Setup a com port based on the passed cfg, driver and buffer sizes. tx size of -1 make the port rx only
  */
@@ -86,7 +139,7 @@ static void PIOS_Board_configure_com(const struct pios_udp_cfg *usart_port_cfg,
 {
     uint32_t pios_usart_id;
 
-    if (PIOS_UDP_Init(&pios_usart_id, usart_port_cfg)) {
+    if (PIOS_UDP_Init(&pios_usart_id, PIOS_Board_instance_cfg(usart_port_cfg))) {
         PIOS_Assert(0);
     }
 
@@ -120,6 +173,15 @@ void PIOS_Board_Init(void)
     /* Delay system */
     PIOS_DELAY_Init();
 
+#if defined(PIOS_INCLUDE_SIMCLOCK)
+    /* Not fatal, the clock simply keeps running in real time */
+    struct pios_simclock_cfg simclock_cfg = pios_simclock_cfg;
+    simclock_cfg.port += simposix_instance * SIMPOSIX_PORT_STRIDE;
+    if (PIOS_SIMCLOCK_Init(&simclock_cfg)) {
+        printf("simclock - could not open socket, lockstep disabled\n");
+    }
+#endif
+
     // Initialize logfs for settings.
     // If linking in yaffs for testing, this will be /dev0 with settings stored
     // via the logfs object api in /dev0/logfs/
@@ -159,6 +221,12 @@ void PIOS_Board_Init(void)
     case HWSETTINGS_RV_TELEMETRYPORT_DISABLED:
         break;
     case HWSETTINGS_RV_TELEMETRYPORT_TELEMETRY:
+#if defined(PIOS_INCLUDE_SHM)
+        if (simposix_shm) {
+            PIOS_Board_configure_shm_com(PIOS_COM_TELEM_RF_RX_BUF_LEN, PIOS_COM_TELEM_RF_TX_BUF_LEN, &pios_com_telem_rf_id);
+            break;
+        }
+#endif
         PIOS_Board_configure_com(&pios_udp_telem_cfg, PIOS_COM_TELEM_RF_RX_BUF_LEN, PIOS_COM_TELEM_RF_TX_BUF_LEN, &pios_udp_com_driver, &pios_com_telem_rf_id);
         break;
     case HWSETTINGS_RV_TELEMETRYPORT_COMAUX:
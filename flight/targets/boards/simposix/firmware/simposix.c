@@ -34,6 +34,10 @@
 #include "inc/openpilot.h"
 #include <systemmod.h>
 #include <uavobjectsinit.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/stat.h>
 
 /* Task Priorities */
 #define PRIORITY_TASK_HOOKS (tskIDLE_PRIORITY + 3)
@@ -48,6 +52,11 @@ static uint8_t sdcard_available;
 char Buffer[1024];
 uint32_t Cache;
 
+/* Instance number, selects the UDP ports (see pios_board.c) and settings directory */
+uint8_t simposix_instance = 0;
+/* Telemetry over shared memory instead of UDP, for a GCS on the same host */
+bool simposix_shm = false;
+
 /* Function Prototypes */
 #if INCLUDE_TEST_TASKS
 static void TaskTick(void *pvParameters);
@@ -84,9 +93,33 @@ extern void InitModules(void);
  * If something goes wrong, blink LED1 and LED2 every 100ms
  *
  */
-int main()
+int main(int argc, char *argv[])
 {
     int result;
+    int opt;
+
+    /* -i <n> runs instance n, so several instances can run side by side */
+    /* -s moves the telemetry port to shared memory */
+    while ((opt = getopt(argc, argv, "i:s")) != -1) {
+        if (opt == 'i') {
+            simposix_instance = atoi(optarg);
+        } else if (opt == 's') {
+            simposix_shm = true;
+        } else {
+            fprintf(stderr, "usage: %s [-i instance] [-s]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (simposix_instance) {
+        /* Settings are stored as files in the working directory, keep them apart */
+        char dir[32];
+        snprintf(dir, sizeof(dir), "simposix-%u", simposix_instance);
+        mkdir(dir, 0755);
+        if (chdir(dir)) {
+            fprintf(stderr, "cannot enter settings directory %s\n", dir);
+            return 1;
+        }
+    }
 
     /* NOTE: Do NOT modify the following start-up sequence */
     /* Any new initialization functions should be added in OpenPilotInit() */
@@ -0,0 +1,154 @@
+#!/usr/bin/env python
+#
+# Runs a fleet of simposix SITL instances side by side and listens to the
+# telemetry of all of them, to benchmark telemetry scaling or to run
+# parameter sweeps in parallel.
+#
+# Instance n (1..N) is started as "simposix.elf -i n": it keeps its
+# settings in simposix-n/ below the working directory and uses UDP ports
+# 9000 + 10 * n (telemetry), +1 (GPS), +2 (aux) and +3 (lockstep clock).
+#
+# With --lockstep the harness also drives the simulation clock of every
+# instance (see flight/pios/inc/pios_simclock.h), so they run as fast as
+# the host allows instead of in real time.
+#
+# (c) 2015, The OpenPilot Team, http://www.openpilot.org
+# See also: The GNU Public License (GPL) Version 3
+#
+
+import argparse
+import os
+import select
+import socket
+import struct
+import subprocess
+import sys
+import time
+
+BASE_PORT = 9000
+PORT_STRIDE = 10
+TELEMETRY_PORT = 0
+SIMCLOCK_PORT = 3
+
+UAVTALK_SYNC = 0x3C
+SIMCLOCK_MAGIC = 0x4353504f
+SIMCLOCK_MSG = struct.Struct("=III")
+
+
+class Instance:
+    def __init__(self, number, elf, workdir, host):
+        self.number = number
+        self.process = subprocess.Popen([os.path.abspath(elf), "-i", str(number)],
+                                        cwd=workdir,
+                                        stdout=subprocess.DEVNULL,
+                                        stderr=subprocess.DEVNULL)
+        base = BASE_PORT + PORT_STRIDE * number
+        self.telemetry_addr = (host, base + TELEMETRY_PORT)
+        self.clock_addr = (host, base + SIMCLOCK_PORT)
+
+        self.telemetry = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        self.clock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+
+        self.bytes = 0
+        self.frames = 0
+        self.sim_time_us = None
+        self.sim_start_us = None
+        self.pending_step = False
+
+    def hello(self):
+        # The firmware answers to whoever sent it the last datagram,
+        # a lone byte is dropped by the UAVTalk parser
+        self.telemetry.sendto(b"\0", self.telemetry_addr)
+
+    def step(self, ticks):
+        self.clock.sendto(SIMCLOCK_MSG.pack(SIMCLOCK_MAGIC, ticks, 0), self.clock_addr)
+        self.pending_step = True
+
+    def read_telemetry(self):
+        data = self.telemetry.recv(65536)
+        self.bytes += len(data)
+        self.frames += bytearray(data).count(UAVTALK_SYNC)
+
+    def read_clock(self):
+        magic, _, time_us = SIMCLOCK_MSG.unpack(self.clock.recv(SIMCLOCK_MSG.size))
+        if magic == SIMCLOCK_MAGIC:
+            if self.sim_start_us is None:
+                self.sim_start_us = time_us
+            self.sim_time_us = time_us
+            self.pending_step = False
+
+    def simulated_seconds(self):
+        if self.sim_start_us is None:
+            return 0.0
+        return ((self.sim_time_us - self.sim_start_us) & 0xffffffff) / 1e6
+
+    def stop(self):
+        if self.process.poll() is None:
+            self.process.terminate()
+            self.process.wait()
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Run N simposix instances and collect their telemetry")
+    parser.add_argument("elf", help="path to the simposix firmware executable")
+    parser.add_argument("-n", "--instances", type=int, default=4, help="number of instances (default 4)")
+    parser.add_argument("-t", "--time", type=float, default=10.0, help="wall clock seconds to run (default 10)")
+    parser.add_argument("-d", "--workdir", default=".", help="directory for the per instance settings")
+    parser.add_argument("--host", default="127.0.0.1", help="address the instances listen on")
+    parser.add_argument("--lockstep", type=int, default=0, metavar="TICKS",
+                        help="drive the clocks in lockstep, TICKS per step (default off)")
+    args = parser.parse_args()
+
+    if not 0 < args.instances < 255:
+        parser.error("instances must be between 1 and 254")
+
+    fleet = [Instance(n, args.elf, args.workdir, args.host) for n in range(1, args.instances + 1)]
+    sockets = {}
+    for instance in fleet:
+        sockets[instance.telemetry] = instance.read_telemetry
+        sockets[instance.clock] = instance.read_clock
+
+    try:
+        # Give the instances time to open their sockets
+        time.sleep(1.0)
+        start = time.time()
+        last_hello = 0.0
+        while time.time() - start < args.time:
+            now = time.time()
+            if now - last_hello > 1.0:
+                for instance in fleet:
+                    instance.hello()
+                last_hello = now
+            if args.lockstep:
+                for instance in fleet:
+                    if not instance.pending_step:
+                        instance.step(args.lockstep)
+            readable, _, _ = select.select(list(sockets.keys()), [], [], 0.1)
+            for sock in readable:
+                try:
+                    sockets[sock]()
+                except socket.error:
+                    # Not listening yet, or the instance died
+                    pass
+        elapsed = time.time() - start
+    finally:
+        if args.lockstep:
+            # Hand the clocks back to real time
+            for instance in fleet:
+                instance.step(0)
+        for instance in fleet:
+            instance.stop()
+
+    print("%-9s %-6s %12s %10s %10s" % ("instance", "port", "bytes/s", "frames/s", "sim x"))
+    total_bytes = 0
+    for instance in fleet:
+        total_bytes += instance.bytes
+        print("%-9d %-6d %12.0f %10.1f %10.1f" % (instance.number, instance.telemetry_addr[1],
+                                                 instance.bytes / elapsed, instance.frames / elapsed,
+                                                 instance.simulated_seconds() / elapsed))
+    print("total     %19.0f bytes/s" % (total_bytes / elapsed))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
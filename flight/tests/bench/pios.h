@@ -0,0 +1,21 @@
+#ifndef PIOS_H
+#define PIOS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* PIOS Feature Selection */
+#include "pios_config.h"
+
+#ifdef PIOS_INCLUDE_FREERTOS
+/* FreeRTOS Includes */
+#include "FreeRTOS.h"
+#endif
+#include "pios_mem.h"
+#include "pios_crc.h"
+#ifdef PIOS_INCLUDE_FLASH
+#include <pios_flash.h>
+#include <pios_flashfs.h>
+#endif
+
+#endif /* PIOS_H */
@@ -0,0 +1,304 @@
+#include "gtest/gtest.h"
+
+#include <stdio.h> /* printf */
+#include <stdlib.h> /* rand */
+#include <string.h> /* memset */
+#include <math.h>
+#include <stdint.h>
+#include <time.h> /* clock_gettime */
+#include <unistd.h> /* unlink */
+#include <map>
+#include <string>
+
+extern "C" {
+#include "pios.h"
+#include "pios_flash_ut_priv.h"
+
+extern struct pios_flash_ut_cfg flash_config;
+
+#include "pios_flashfs_logfs_priv.h"
+
+extern struct flashfs_logfs_cfg flashfs_config_settings;
+}
+
+// The filter is compiled in its own namespace, as in the insgps test
+namespace insgps {
+#include "insgps13state.c"
+#undef PELEM
+}
+
+// and once more running on the unrolled template kernels
+#undef INSGPS_H_
+namespace insgpskernels {
+#define INSGPS_TEMPLATE_KERNELS
+#include "insgps13state.c"
+#undef INSGPS_TEMPLATE_KERNELS
+#undef PELEM
+}
+
+#if !defined(BENCH_RESULTS_FILE)
+#define BENCH_RESULTS_FILE "bench.tsv"
+#endif
+
+// Minimum run time of each measurement, long enough to smooth out the timer resolution
+#define BENCH_MIN_TIME_NS 100000000ULL
+
+#define UAVTALK_MAX_FRAME 267 // header + 255 bytes payload + crc
+#define LOGFS_OBJ_SIZE    100
+#define LOGFS_NUM_OBJS    32
+
+static uint64_t now_ns()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// Results of the previous run, read from and then written back to BENCH_RESULTS_FILE
+static std::map<std::string, double> previous_results;
+static std::map<std::string, double> results;
+
+// Runs every benchmark, reports its ns/op and tracks the results in a tab separated file
+// (name, ns/op) so that consecutive runs on the same machine can be compared.
+class Benchmark : public testing::Test {
+protected:
+    static void SetUpTestCase()
+    {
+        FILE *file = fopen(BENCH_RESULTS_FILE, "r");
+
+        if (file) {
+            char name[128];
+            double ns;
+            while (fscanf(file, "%127s %lf", name, &ns) == 2) {
+                previous_results[name] = ns;
+            }
+            fclose(file);
+        }
+    }
+
+    static void TearDownTestCase()
+    {
+        // Keep the entries of benchmarks that were filtered out of this run
+        std::map<std::string, double> merged = previous_results;
+        for (std::map<std::string, double>::iterator it = results.begin(); it != results.end(); ++it) {
+            merged[it->first] = it->second;
+        }
+
+        FILE *file = fopen(BENCH_RESULTS_FILE, "w");
+        if (file) {
+            for (std::map<std::string, double>::iterator it = merged.begin(); it != merged.end(); ++it) {
+                fprintf(file, "%s\t%.1f\n", it->first.c_str(), it->second);
+            }
+            fclose(file);
+        }
+    }
+
+    virtual void SetUp()
+    {
+        srand(1234);
+        for (int i = 0; i < UAVTALK_MAX_FRAME; i++) {
+            frame[i] = (uint8_t)rand();
+        }
+    }
+
+    // Call op until BENCH_MIN_TIME_NS have passed, doubling the batch size each round
+    void measure(const char *name, void (*op)(Benchmark *self, uint32_t iteration))
+    {
+        uint32_t iterations = 1;
+        uint64_t elapsed    = 0;
+        uint32_t done = 0;
+
+        while (elapsed < BENCH_MIN_TIME_NS) {
+            uint64_t start = now_ns();
+            for (uint32_t i = 0; i < iterations; i++) {
+                op(this, done + i);
+            }
+            elapsed = now_ns() - start;
+            done   += iterations;
+            iterations *= 2;
+        }
+
+        double ns = (double)elapsed / (iterations / 2);
+        results[name] = ns;
+        RecordProperty("ns_per_op", (int)(ns + 0.5));
+
+        if (previous_results.count(name)) {
+            printf("%-24s %12.1f ns/op (%+.1f%%)\n", name, ns, 100.0 * (ns / previous_results[name] - 1.0));
+        } else {
+            printf("%-24s %12.1f ns/op\n", name, ns);
+        }
+    }
+
+    uint8_t frame[UAVTALK_MAX_FRAME];
+    volatile uint32_t sink;
+};
+
+// CRC of a full size UAVTalk frame, as computed for every packet sent and received
+class CrcBenchmark : public Benchmark {
+public:
+    static void crc8(Benchmark *self, uint32_t)
+    {
+        CrcBenchmark *b = static_cast<CrcBenchmark *>(self);
+
+        b->sink = PIOS_CRC_updateCRC(0, b->frame, UAVTALK_MAX_FRAME - 1);
+    }
+
+    static void crc16(Benchmark *self, uint32_t)
+    {
+        CrcBenchmark *b = static_cast<CrcBenchmark *>(self);
+
+        b->sink = PIOS_CRC16_updateCRC(0, b->frame, UAVTALK_MAX_FRAME);
+    }
+
+    static void crc32(Benchmark *self, uint32_t)
+    {
+        CrcBenchmark *b = static_cast<CrcBenchmark *>(self);
+
+        b->sink = PIOS_CRC32_updateCRC(0, b->frame, UAVTALK_MAX_FRAME);
+    }
+};
+
+TEST_F(CrcBenchmark, crc8_uavtalk_frame) {
+    measure("crc8_uavtalk_frame", &CrcBenchmark::crc8);
+}
+
+TEST_F(CrcBenchmark, crc16_uavtalk_frame) {
+    measure("crc16_uavtalk_frame", &CrcBenchmark::crc16);
+}
+
+TEST_F(CrcBenchmark, crc32_uavtalk_frame) {
+    measure("crc32_uavtalk_frame", &CrcBenchmark::crc32);
+}
+
+// Settings saves and loads on the RAM flash, with the Revolution settings partition layout
+class LogfsBenchmark : public Benchmark {
+protected:
+    virtual void SetUp()
+    {
+        Benchmark::SetUp();
+
+        /* create an empty, appropriately sized flash filesystem */
+        FILE *theflash = fopen(FLASH_IMAGE_FILE, "wb");
+        uint8_t sector[flash_config.size_of_sector];
+
+        memset(sector, 0xFF, sizeof(sector));
+        for (uint32_t i = 0; i < flash_config.size_of_flash / flash_config.size_of_sector; i++) {
+            fwrite(sector, sizeof(sector), 1, theflash);
+        }
+        fclose(theflash);
+
+        ASSERT_EQ(0, PIOS_Flash_UT_Init(&flash_id, &flash_config));
+        ASSERT_EQ(0, PIOS_FLASHFS_Logfs_Init(&fs_id, &flashfs_config_settings, &pios_ut_flash_driver, flash_id));
+
+        // Populate the partition with a typical number of settings objects
+        for (uint32_t i = 0; i < LOGFS_NUM_OBJS; i++) {
+            ASSERT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, 0x10000 + i, 0, frame, LOGFS_OBJ_SIZE));
+        }
+    }
+
+    virtual void TearDown()
+    {
+        PIOS_FLASHFS_Logfs_Destroy(fs_id);
+        PIOS_Flash_UT_Destroy(flash_id);
+        unlink(FLASH_IMAGE_FILE);
+    }
+
+public:
+    static void save(Benchmark *self, uint32_t iteration)
+    {
+        LogfsBenchmark *b = static_cast<LogfsBenchmark *>(self);
+
+        // Change the data so every save is written, garbage collection is part of the cost
+        b->frame[0] = (uint8_t)iteration;
+        b->sink     = PIOS_FLASHFS_ObjSave(b->fs_id, 0x10000 + iteration % LOGFS_NUM_OBJS, 0, b->frame, LOGFS_OBJ_SIZE);
+    }
+
+    static void load(Benchmark *self, uint32_t iteration)
+    {
+        LogfsBenchmark *b = static_cast<LogfsBenchmark *>(self);
+
+        b->sink = PIOS_FLASHFS_ObjLoad(b->fs_id, 0x10000 + iteration % LOGFS_NUM_OBJS, 0, b->frame, LOGFS_OBJ_SIZE);
+    }
+
+    uintptr_t flash_id;
+    uintptr_t fs_id;
+};
+
+TEST_F(LogfsBenchmark, logfs_obj_save) {
+    measure("logfs_obj_save", &LogfsBenchmark::save);
+    EXPECT_EQ(0, (int32_t)sink);
+}
+
+TEST_F(LogfsBenchmark, logfs_obj_load) {
+    measure("logfs_obj_load", &LogfsBenchmark::load);
+    EXPECT_EQ(0, (int32_t)sink);
+}
+
+// One prediction and one correction step of the 13 state filter, as run by StateEstimation
+class InsGpsBenchmark : public Benchmark {
+protected:
+    virtual void SetUp()
+    {
+        Benchmark::SetUp();
+        insgps::INSGPSInit();
+        insgpskernels::INSGPSInit();
+    }
+
+public:
+    static void prediction(Benchmark *, uint32_t iteration)
+    {
+        float gyro[3]  = { 0.3f * sinf(iteration * 0.01f), 0.2f, 0.1f };
+        float accel[3] = { 0.5f, 0.2f, -9.81f };
+
+        insgps::INSStatePrediction(gyro, accel, 0.002f);
+        insgps::INSCovariancePrediction(0.002f);
+    }
+
+    static void correction(Benchmark *, uint32_t)
+    {
+        float mag[3] = { 0.6f, 0.1f, 0.8f };
+        float pos[3] = { 1.0f, -2.0f, -3.0f };
+        float vel[3] = { 0.5f, 0.2f, -0.1f };
+
+        insgps::FullCorrection(mag, pos, vel, 3.0f);
+    }
+
+    static void kernelsPrediction(Benchmark *, uint32_t iteration)
+    {
+        float gyro[3]  = { 0.3f * sinf(iteration * 0.01f), 0.2f, 0.1f };
+        float accel[3] = { 0.5f, 0.2f, -9.81f };
+
+        insgpskernels::INSStatePrediction(gyro, accel, 0.002f);
+        insgpskernels::INSCovariancePrediction(0.002f);
+    }
+
+    static void kernelsCorrection(Benchmark *, uint32_t)
+    {
+        float mag[3] = { 0.6f, 0.1f, 0.8f };
+        float pos[3] = { 1.0f, -2.0f, -3.0f };
+        float vel[3] = { 0.5f, 0.2f, -0.1f };
+
+        insgpskernels::FullCorrection(mag, pos, vel, 3.0f);
+    }
+};
+
+TEST_F(InsGpsBenchmark, insgps_prediction) {
+    measure("insgps_prediction", &InsGpsBenchmark::prediction);
+    EXPECT_FALSE(isnan(insgps::ekf.X[0]));
+}
+
+TEST_F(InsGpsBenchmark, insgps_correction) {
+    measure("insgps_correction", &InsGpsBenchmark::correction);
+    EXPECT_FALSE(isnan(insgps::ekf.X[0]));
+}
+
+TEST_F(InsGpsBenchmark, insgps_kernels_prediction) {
+    measure("insgps_kernels_prediction", &InsGpsBenchmark::kernelsPrediction);
+    EXPECT_FALSE(isnan(insgpskernels::ekf.X[0]));
+}
+
+TEST_F(InsGpsBenchmark, insgps_kernels_correction) {
+    measure("insgps_kernels_correction", &InsGpsBenchmark::kernelsCorrection);
+    EXPECT_FALSE(isnan(insgpskernels::ekf.X[0]));
+}
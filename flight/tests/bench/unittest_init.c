@@ -0,0 +1,30 @@
+/*
+ * These need to be defined in a .c file so that we can use
+ * designated initializer syntax which c++ doesn't support (yet).
+ */
+
+#include "pios_flash_ut_priv.h"
+
+
+const struct pios_flash_ut_cfg flash_config = {
+    .size_of_flash  = 0x00040000,
+    .size_of_sector = 0x00010000,
+};
+
+#include "pios_flashfs_logfs_priv.h"
+
+/* Same layout as the settings partition of the Revolution */
+const struct flashfs_logfs_cfg flashfs_config_settings = {
+    .fs_magic      = 0x99bbcdef,
+    .total_fs_size = 0x00040000, /* 256K bytes (4 sectors) */
+    .arena_size    = 0x00010000, /* 256 * slot size */
+    .slot_size     = 0x00000100, /* 256 bytes */
+
+    .start_offset  = 0,          /* start at the beginning of the chip */
+    .sector_size   = 0x00010000, /* 64K bytes */
+    .page_size     = 0x00000100, /* 256 bytes */
+
+    .index_size    = 64,         /* settings objects tracked in RAM */
+    .gc_headroom   = 32,         /* compact in the background below this many free slots */
+    .batch_size    = 16,         /* settings saves committed together */
+};
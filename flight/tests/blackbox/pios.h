@@ -0,0 +1,24 @@
+#ifndef PIOS_H
+#define PIOS_H
+
+/* PIOS Feature Selection */
+#include "pios_config.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "openpilot.h"
+#include "pios_mem.h"
+
+/* Provided by the test, stands in for pios_delay.c */
+uint32_t PIOS_DELAY_GetuS(void);
+
+#ifdef PIOS_INCLUDE_FLASH
+#include <pios_flash.h>
+#endif
+
+#ifdef PIOS_INCLUDE_BLACKBOX
+#include <pios_blackbox.h>
+#endif
+
+#endif /* PIOS_H */
@@ -0,0 +1,289 @@
+#include "gtest/gtest.h"
+
+#include <stdio.h> /* printf */
+#include <stdlib.h> /* abort */
+#include <string.h> /* memset */
+
+extern "C" {
+#include "pios_flash.h" /* PIOS_FLASH_* API */
+#include "pios_flash_ut_priv.h"
+
+extern struct pios_flash_ut_cfg flash_config;
+
+#include "pios_blackbox_priv.h"
+
+extern struct pios_blackbox_cfg blackbox_config;
+
+#include "pios_blackbox.h" /* PIOS_BLACKBOX_* */
+
+static uint32_t fake_time_us;
+uint32_t PIOS_DELAY_GetuS(void)
+{
+    return fake_time_us;
+}
+}
+
+#define GYRO_ID       0x1B8BB4D2
+#define GYRO_SIZE     16
+
+#define ATTITUDE_ID   0xD7E0D964
+#define ATTITUDE_SIZE 28
+
+// layout of the chunks and records in flash
+#define CHUNK_HEADER_SIZE  8
+#define RECORD_HEADER_SIZE 12
+
+// Stands in for another task requesting an erase while the writer is busy with the flash
+static uintptr_t erase_request_bb_id;
+static uint32_t erase_request_at;
+static uint32_t erased_sectors;
+
+static int32_t erase_sector_and_request(uintptr_t flash_id, uint32_t addr)
+{
+    if (++erased_sectors == erase_request_at) {
+        PIOS_BLACKBOX_Erase(erase_request_bb_id);
+    }
+    return pios_ut_flash_driver.erase_sector(flash_id, addr);
+}
+
+// To use a test fixture, derive a class from testing::Test.
+class BlackboxTest : public testing::Test {
+protected:
+    virtual void SetUp()
+    {
+        /* create an empty, appropriately sized flash */
+        FILE *theflash = fopen(FLASH_IMAGE_FILE, "wb");
+        uint8_t sector[flash_config.size_of_sector];
+
+        memset(sector, 0xFF, sizeof(sector));
+        for (uint32_t i = 0; i < flash_config.size_of_flash / flash_config.size_of_sector; i++) {
+            fwrite(sector, sizeof(sector), 1, theflash);
+        }
+        fclose(theflash);
+
+        for (uint32_t i = 0; i < sizeof(gyro); i++) {
+            gyro[i] = 0x10 + (i % 10);
+        }
+        for (uint32_t i = 0; i < sizeof(attitude); i++) {
+            attitude[i] = 0x20 + (i % 10);
+        }
+        fake_time_us = 0;
+
+        EXPECT_EQ(0, PIOS_Flash_UT_Init(&flash_id, &flash_config));
+        EXPECT_EQ(0, PIOS_BLACKBOX_Init(&bb_id, &blackbox_config, &pios_ut_flash_driver, flash_id));
+    }
+
+    virtual void TearDown()
+    {
+        PIOS_Flash_UT_Destroy(flash_id);
+        unlink(FLASH_IMAGE_FILE);
+    }
+
+    // log one sample of each at 500Hz
+    void logSamples(uint32_t count)
+    {
+        for (uint32_t i = 0; i < count; i++) {
+            fake_time_us += 2000;
+            EXPECT_EQ(0, PIOS_BLACKBOX_Write(bb_id, GYRO_ID, 0, gyro, sizeof(gyro)));
+            EXPECT_EQ(0, PIOS_BLACKBOX_Write(bb_id, ATTITUDE_ID, 0, attitude, sizeof(attitude)));
+            while (PIOS_BLACKBOX_Process(bb_id) > 0) {
+                ;
+            }
+        }
+    }
+
+    // walk the records of the chunk at offset, returns the number of records
+    uint32_t checkChunk(uint32_t offset, uint16_t session)
+    {
+        uint8_t chunk[blackbox_config.chunk_size];
+
+        EXPECT_EQ((int32_t)sizeof(chunk), PIOS_BLACKBOX_Read(bb_id, offset, chunk, sizeof(chunk)));
+
+        uint32_t magic;
+        uint16_t chunk_session, used;
+        memcpy(&magic, &chunk[0], sizeof(magic));
+        memcpy(&chunk_session, &chunk[4], sizeof(chunk_session));
+        memcpy(&used, &chunk[6], sizeof(used));
+        EXPECT_EQ(0xB1ACB0C5, magic);
+        EXPECT_EQ(session, chunk_session);
+        EXPECT_GE(blackbox_config.chunk_size, used);
+
+        uint32_t records = 0;
+        for (uint16_t pos = CHUNK_HEADER_SIZE; pos < used; records++) {
+            uint32_t obj_id;
+            uint16_t obj_size;
+            memcpy(&obj_id, &chunk[pos + 4], sizeof(obj_id));
+            memcpy(&obj_size, &chunk[pos + 10], sizeof(obj_size));
+            if (obj_id == GYRO_ID) {
+                EXPECT_EQ(GYRO_SIZE, obj_size);
+                EXPECT_EQ(0, memcmp(gyro, &chunk[pos + RECORD_HEADER_SIZE], sizeof(gyro)));
+            } else {
+                EXPECT_EQ(ATTITUDE_ID, obj_id);
+                EXPECT_EQ(ATTITUDE_SIZE, obj_size);
+                EXPECT_EQ(0, memcmp(attitude, &chunk[pos + RECORD_HEADER_SIZE], sizeof(attitude)));
+            }
+            pos += RECORD_HEADER_SIZE + obj_size;
+        }
+        return records;
+    }
+
+    uintptr_t flash_id;
+    uintptr_t bb_id;
+    uint8_t gyro[GYRO_SIZE];
+    uint8_t attitude[ATTITUDE_SIZE];
+};
+
+TEST_F(BlackboxTest, Empty) {
+    struct PIOS_BLACKBOX_Stats stats;
+
+    EXPECT_EQ(0, PIOS_BLACKBOX_GetStats(bb_id, &stats));
+    EXPECT_EQ(0U, stats.used_bytes);
+    EXPECT_EQ(blackbox_config.size, stats.free_bytes);
+    EXPECT_EQ(0, stats.session);
+
+    uint8_t data[16];
+    EXPECT_EQ(0, PIOS_BLACKBOX_Read(bb_id, 0, data, sizeof(data)));
+    EXPECT_EQ(0, PIOS_BLACKBOX_Process(bb_id));
+    EXPECT_EQ(-1, PIOS_BLACKBOX_Write(bb_id + 1, GYRO_ID, 0, gyro, sizeof(gyro)));
+}
+
+TEST_F(BlackboxTest, WriteFlushVerify) {
+    logSamples(10);
+
+    /* Nothing reaches the flash until a chunk is full or the session ends */
+    struct PIOS_BLACKBOX_Stats stats;
+    EXPECT_EQ(0, PIOS_BLACKBOX_GetStats(bb_id, &stats));
+    EXPECT_EQ(0U, stats.used_bytes);
+
+    EXPECT_EQ(0, PIOS_BLACKBOX_NewSession(bb_id));
+    EXPECT_EQ(0, PIOS_BLACKBOX_Process(bb_id));
+
+    EXPECT_EQ(0, PIOS_BLACKBOX_GetStats(bb_id, &stats));
+    EXPECT_EQ(blackbox_config.chunk_size, stats.used_bytes);
+    EXPECT_EQ(1, stats.session);
+    EXPECT_EQ(20U, checkChunk(0, 0));
+}
+
+TEST_F(BlackboxTest, StreamManyChunks) {
+    /* Roughly a second of samples */
+    logSamples(500);
+    EXPECT_EQ(0, PIOS_BLACKBOX_NewSession(bb_id));
+    EXPECT_EQ(0, PIOS_BLACKBOX_Process(bb_id));
+
+    struct PIOS_BLACKBOX_Stats stats;
+    EXPECT_EQ(0, PIOS_BLACKBOX_GetStats(bb_id, &stats));
+    EXPECT_EQ(0U, stats.dropped_records);
+
+    uint32_t records = 0;
+    for (uint32_t offset = 0; offset < stats.used_bytes; offset += blackbox_config.chunk_size) {
+        records += checkChunk(offset, 0);
+    }
+    EXPECT_EQ(1000U, records);
+}
+
+TEST_F(BlackboxTest, WriterFallsBehind) {
+    uint32_t written = 0;
+    int32_t rc;
+
+    /* Without the writer only the two RAM chunks can be filled */
+    while ((rc = PIOS_BLACKBOX_Write(bb_id, GYRO_ID, 0, gyro, sizeof(gyro))) == 0) {
+        written++;
+    }
+    EXPECT_EQ(-4, rc);
+    EXPECT_EQ(2U * ((blackbox_config.chunk_size - CHUNK_HEADER_SIZE) / (RECORD_HEADER_SIZE + GYRO_SIZE)), written);
+
+    struct PIOS_BLACKBOX_Stats stats;
+    EXPECT_EQ(0, PIOS_BLACKBOX_GetStats(bb_id, &stats));
+    EXPECT_EQ(1U, stats.dropped_records);
+
+    /* Once the writer catches up logging continues */
+    EXPECT_EQ(0, PIOS_BLACKBOX_Process(bb_id));
+    EXPECT_EQ(0, PIOS_BLACKBOX_Write(bb_id, GYRO_ID, 0, gyro, sizeof(gyro)));
+}
+
+TEST_F(BlackboxTest, RemountContinues) {
+    logSamples(10);
+    EXPECT_EQ(0, PIOS_BLACKBOX_NewSession(bb_id));
+    EXPECT_EQ(0, PIOS_BLACKBOX_Process(bb_id));
+
+    /* The next session starts after the end of the log */
+    EXPECT_EQ(0, PIOS_BLACKBOX_Init(&bb_id, &blackbox_config, &pios_ut_flash_driver, flash_id));
+    struct PIOS_BLACKBOX_Stats stats;
+    EXPECT_EQ(0, PIOS_BLACKBOX_GetStats(bb_id, &stats));
+    EXPECT_EQ(blackbox_config.chunk_size, stats.used_bytes);
+    EXPECT_EQ(1, stats.session);
+
+    logSamples(10);
+    EXPECT_EQ(0, PIOS_BLACKBOX_NewSession(bb_id));
+    EXPECT_EQ(0, PIOS_BLACKBOX_Process(bb_id));
+    EXPECT_EQ(20U, checkChunk(0, 0));
+    EXPECT_EQ(20U, checkChunk(blackbox_config.chunk_size, 1));
+}
+
+TEST_F(BlackboxTest, FillUp) {
+    /* Log until the partition is full */
+    uint32_t samples = 0;
+    while (PIOS_BLACKBOX_Write(bb_id, ATTITUDE_ID, 0, attitude, sizeof(attitude)) == 0) {
+        PIOS_BLACKBOX_Process(bb_id);
+        samples++;
+    }
+    EXPECT_EQ(-3, PIOS_BLACKBOX_Write(bb_id, GYRO_ID, 0, gyro, sizeof(gyro)));
+
+    struct PIOS_BLACKBOX_Stats stats;
+    EXPECT_EQ(0, PIOS_BLACKBOX_GetStats(bb_id, &stats));
+    EXPECT_EQ(blackbox_config.size, stats.used_bytes);
+    EXPECT_EQ(0U, stats.free_bytes);
+
+    /* Erasing takes one call per sector */
+    EXPECT_EQ(0, PIOS_BLACKBOX_Erase(bb_id));
+    EXPECT_EQ(-3, PIOS_BLACKBOX_Write(bb_id, GYRO_ID, 0, gyro, sizeof(gyro)));
+    EXPECT_EQ(1, PIOS_BLACKBOX_Process(bb_id));
+    EXPECT_EQ(0, PIOS_BLACKBOX_Process(bb_id));
+
+    EXPECT_EQ(0, PIOS_BLACKBOX_GetStats(bb_id, &stats));
+    EXPECT_EQ(0U, stats.used_bytes);
+    EXPECT_EQ(0, stats.session);
+    logSamples(10);
+}
+
+TEST_F(BlackboxTest, StaleDataIsErased) {
+    /* Something else used to live in the partition */
+    uint8_t junk[16];
+    memset(junk, 0x55, sizeof(junk));
+    pios_ut_flash_driver.start_transaction(flash_id);
+    pios_ut_flash_driver.write_data(flash_id, blackbox_config.start_offset + 3 * blackbox_config.chunk_size, junk, sizeof(junk));
+    pios_ut_flash_driver.end_transaction(flash_id);
+
+    EXPECT_EQ(0, PIOS_BLACKBOX_Init(&bb_id, &blackbox_config, &pios_ut_flash_driver, flash_id));
+    EXPECT_EQ(-3, PIOS_BLACKBOX_Write(bb_id, GYRO_ID, 0, gyro, sizeof(gyro)));
+    while (PIOS_BLACKBOX_Process(bb_id) > 0) {
+        ;
+    }
+
+    logSamples(10);
+    EXPECT_EQ(0, PIOS_BLACKBOX_NewSession(bb_id));
+    EXPECT_EQ(0, PIOS_BLACKBOX_Process(bb_id));
+    EXPECT_EQ(20U, checkChunk(0, 0));
+}
+
+TEST_F(BlackboxTest, EraseRequestedWhileErasing) {
+    struct pios_flash_driver driver = pios_ut_flash_driver;
+
+    driver.erase_sector = erase_sector_and_request;
+    EXPECT_EQ(0, PIOS_BLACKBOX_Init(&bb_id, &blackbox_config, &driver, flash_id));
+    erase_request_bb_id = bb_id;
+    erase_request_at    = 2;
+    erased_sectors = 0;
+
+    EXPECT_EQ(0, PIOS_BLACKBOX_Erase(bb_id));
+    while (PIOS_BLACKBOX_Process(bb_id) > 0) {
+        ;
+    }
+
+    /* The second request restarts the erase once the sector in progress is done */
+    EXPECT_EQ(erase_request_at + blackbox_config.size / blackbox_config.sector_size, erased_sectors);
+    logSamples(10);
+    EXPECT_EQ(0, PIOS_BLACKBOX_NewSession(bb_id));
+    EXPECT_EQ(0, PIOS_BLACKBOX_Process(bb_id));
+    EXPECT_EQ(20U, checkChunk(0, 0));
+}
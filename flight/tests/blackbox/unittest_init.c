@@ -0,0 +1,22 @@
+/*
+ * These need to be defined in a .c file so that we can use
+ * designated initializer syntax which c++ doesn't support (yet).
+ */
+
+#include "pios_flash_ut_priv.h"
+
+
+const struct pios_flash_ut_cfg flash_config = {
+    .size_of_flash  = 0x00040000,
+    .size_of_sector = 0x00010000,
+};
+
+#include "pios_blackbox_priv.h"
+
+const struct pios_blackbox_cfg blackbox_config = {
+    .start_offset = 0x00010000, /* leave the first sector to something else */
+    .size         = 0x00020000, /* 128K bytes (2 sectors) */
+    .sector_size  = 0x00010000, /* 64K bytes */
+    .page_size    = 0x00000100, /* 256 bytes */
+    .chunk_size   = 0x00000400, /* 1K bytes */
+};
@@ -0,0 +1,109 @@
+#include "gtest/gtest.h"
+
+#include <stdio.h> /* printf */
+#include <stdlib.h> /* rand */
+#include <string.h> /* memset */
+#include <time.h> /* clock */
+
+extern "C" {
+#include "pios.h"
+}
+
+#define BUFFER_SIZE     1024
+#define BENCHMARK_LOOPS 2000
+
+// Bitwise reference implementations, independent of the lookup tables
+static uint8_t ref_crc8(uint8_t crc, const uint8_t *data, int32_t length)
+{
+    while (length--) {
+        crc ^= *data++;
+        for (int i = 0; i < 8; i++) {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+static uint8_t ref_crc8_bytewise(uint8_t crc, const uint8_t *data, int32_t length)
+{
+    while (length--) {
+        crc = PIOS_CRC_updateByte(crc, *data++);
+    }
+    return crc;
+}
+
+// To use a test fixture, derive a class from testing::Test.
+class CrcTest : public testing::Test {
+protected:
+    virtual void SetUp()
+    {
+        srand(1234);
+        for (int i = 0; i < BUFFER_SIZE; i++) {
+            buffer[i] = (uint8_t)rand();
+        }
+    }
+
+    uint8_t buffer[BUFFER_SIZE];
+};
+
+TEST_F(CrcTest, crc8_known_value) {
+    const uint8_t check[] = "123456789";
+
+    EXPECT_EQ(0xF4, PIOS_CRC_updateCRC(0, check, 9));
+}
+
+TEST_F(CrcTest, crc8_empty) {
+    EXPECT_EQ(0x00, PIOS_CRC_updateCRC(0x00, buffer, 0));
+    EXPECT_EQ(0x5A, PIOS_CRC_updateCRC(0x5A, buffer, 0));
+}
+
+TEST_F(CrcTest, crc8_all_lengths_and_offsets) {
+    for (int offset = 0; offset < 8; offset++) {
+        for (int length = 0; length < 300; length++) {
+            for (int seed = 0; seed < 256; seed += 85) {
+                ASSERT_EQ(ref_crc8((uint8_t)seed, &buffer[offset], length),
+                          PIOS_CRC_updateCRC((uint8_t)seed, &buffer[offset], length))
+                    << "offset " << offset << " length " << length << " seed " << seed;
+            }
+        }
+    }
+}
+
+TEST_F(CrcTest, crc8_chained) {
+    uint8_t crc = 0;
+
+    crc = PIOS_CRC_updateCRC(crc, &buffer[0], 7);
+    crc = PIOS_CRC_updateCRC(crc, &buffer[7], 100);
+    crc = PIOS_CRC_updateCRC(crc, &buffer[107], 13);
+    EXPECT_EQ(ref_crc8(0, buffer, 120), crc);
+}
+
+TEST_F(CrcTest, crc32_calc_block) {
+    const uint8_t check[] = "123456789";
+
+    EXPECT_EQ(PIOS_CRC32_updateCRC(0xFFFFFFFF, check, 9), PIOS_CRC32_calcBlock(check, 9));
+    for (int length = 0; length < 64; length++) {
+        EXPECT_EQ(PIOS_CRC32_updateCRC(0xFFFFFFFF, &buffer[3], length), PIOS_CRC32_calcBlock(&buffer[3], length));
+    }
+}
+
+// Timings are printed for reference only, host performance is not asserted
+TEST_F(CrcTest, crc8_benchmark) {
+    volatile uint32_t sink = 0;
+    clock_t start;
+
+    start = clock();
+    for (int i = 0; i < BENCHMARK_LOOPS; i++) {
+        sink += ref_crc8_bytewise(0, buffer, BUFFER_SIZE);
+    }
+    double bytewise = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    start = clock();
+    for (int i = 0; i < BENCHMARK_LOOPS; i++) {
+        sink += PIOS_CRC_updateCRC(0, buffer, BUFFER_SIZE);
+    }
+    double blockwise = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    printf("crc8 %d x %d bytes: bytewise %.3fs, updateCRC %.3fs\n", BENCHMARK_LOOPS, BUFFER_SIZE, bytewise, blockwise);
+    (void)sink;
+}
@@ -0,0 +1,207 @@
+#include "gtest/gtest.h"
+
+#include <stdio.h> /* printf */
+#include <stdlib.h> /* abort */
+#include <string.h> /* memset */
+#include <math.h>
+#include <stdint.h>
+#include <time.h> /* clock */
+
+#include "pios_math.h"
+
+// Build the covariance implementations side by side, each in its own namespace
+// along with its own copy of the insgps.h declarations
+namespace reference {
+#include "insgps13state.c"
+#undef PELEM
+}
+
+#undef INSGPS_H_
+namespace packed {
+#define INSGPS_PACKED_COVARIANCE
+#include "insgps13state.c"
+#undef INSGPS_PACKED_COVARIANCE
+
+float getP(int i, int j)
+{
+    return PELEM(i, j);
+}
+#undef PELEM
+}
+
+#undef INSGPS_H_
+namespace kernels {
+#define INSGPS_TEMPLATE_KERNELS
+#include "insgps13state.c"
+#undef INSGPS_TEMPLATE_KERNELS
+#undef PELEM
+}
+
+#define PREDICTION_DT 0.002f
+
+// To use a test fixture, derive a class from testing::Test.
+class InsGpsPackedCovariance : public testing::Test {
+protected:
+    virtual void SetUp()
+    {
+        reference::INSGPSInit();
+        packed::INSGPSInit();
+    }
+
+    // Feed both filters the same slowly rotating, accelerating vehicle
+    void predict(int step)
+    {
+        float gyro[3]  = { 0.3f * sinf(step * 0.01f), 0.2f * cosf(step * 0.013f), 0.1f };
+        float accel[3] = { 0.5f * cosf(step * 0.007f), 0.2f, -9.81f + 0.3f * sinf(step * 0.011f) };
+
+        reference::INSStatePrediction(gyro, accel, PREDICTION_DT);
+        reference::INSCovariancePrediction(PREDICTION_DT);
+        packed::INSStatePrediction(gyro, accel, PREDICTION_DT);
+        packed::INSCovariancePrediction(PREDICTION_DT);
+    }
+
+    void correct()
+    {
+        float mag[3] = { 0.6f, 0.1f, 0.8f };
+        float pos[3] = { 1.0f, -2.0f, -3.0f };
+        float vel[3] = { 0.5f, 0.2f, -0.1f };
+
+        reference::FullCorrection(mag, pos, vel, 3.0f);
+        packed::FullCorrection(mag, pos, vel, 3.0f);
+    }
+
+    void expectSameP()
+    {
+        for (int i = 0; i < 13; i++) {
+            for (int j = 0; j < 13; j++) {
+                // covariances are compared relative to the variances of the states they couple
+                float ref = reference::ekf.P[i][j];
+                float tol = 1e-3f * sqrtf(reference::ekf.P[i][i] * reference::ekf.P[j][j]);
+                EXPECT_NEAR(ref, packed::getP(i, j), tol) << "P[" << i << "][" << j << "]";
+            }
+        }
+    }
+
+    void expectSameX()
+    {
+        for (int i = 0; i < 13; i++) {
+            EXPECT_NEAR(reference::ekf.X[i], packed::ekf.X[i], 1e-4f) << "X[" << i << "]";
+        }
+    }
+};
+
+TEST_F(InsGpsPackedCovariance, Init) {
+    expectSameP();
+    expectSameX();
+}
+
+TEST_F(InsGpsPackedCovariance, Prediction) {
+    for (int step = 0; step < 500; step++) {
+        predict(step);
+    }
+    expectSameP();
+    expectSameX();
+}
+
+TEST_F(InsGpsPackedCovariance, PredictionAndCorrection) {
+    for (int step = 0; step < 500; step++) {
+        predict(step);
+        if ((step % 10) == 0) {
+            correct();
+        }
+    }
+    expectSameP();
+    expectSameX();
+}
+
+TEST_F(InsGpsPackedCovariance, Benchmark) {
+    const int iterations = 20000;
+
+    // linearize once, then time the covariance prediction alone
+    predict(0);
+
+    clock_t start = clock();
+    for (int i = 0; i < iterations; i++) {
+        reference::INSCovariancePrediction(PREDICTION_DT);
+    }
+    clock_t ref_ticks = clock() - start;
+
+    start = clock();
+    for (int i = 0; i < iterations; i++) {
+        packed::INSCovariancePrediction(PREDICTION_DT);
+    }
+    clock_t packed_ticks = clock() - start;
+
+    // both still agree after the long run
+    expectSameP();
+
+    printf("CovariancePrediction: reference %.3f us, packed %.3f us per call\n",
+           1e6 * ref_ticks / CLOCKS_PER_SEC / iterations,
+           1e6 * packed_ticks / CLOCKS_PER_SEC / iterations);
+}
+
+// The unrolled kernels do the arithmetic of the reference loops, only the
+// summation order of the sparse terms may differ
+class InsGpsTemplateKernels : public testing::Test {
+protected:
+    virtual void SetUp()
+    {
+        reference::INSGPSInit();
+        kernels::INSGPSInit();
+    }
+
+    void predict(int step)
+    {
+        float gyro[3]  = { 0.3f * sinf(step * 0.01f), 0.2f * cosf(step * 0.013f), 0.1f };
+        float accel[3] = { 0.5f * cosf(step * 0.007f), 0.2f, -9.81f + 0.3f * sinf(step * 0.011f) };
+
+        reference::INSStatePrediction(gyro, accel, PREDICTION_DT);
+        reference::INSCovariancePrediction(PREDICTION_DT);
+        kernels::INSStatePrediction(gyro, accel, PREDICTION_DT);
+        kernels::INSCovariancePrediction(PREDICTION_DT);
+    }
+
+    void correct(uint16_t sensors)
+    {
+        float mag[3] = { 0.6f, 0.1f, 0.8f };
+        float pos[3] = { 1.0f, -2.0f, -3.0f };
+        float vel[3] = { 0.5f, 0.2f, -0.1f };
+
+        reference::INSCorrection(mag, pos, vel, 3.0f, sensors);
+        kernels::INSCorrection(mag, pos, vel, 3.0f, sensors);
+    }
+
+    void expectSame()
+    {
+        for (int i = 0; i < 13; i++) {
+            for (int j = 0; j < 13; j++) {
+                float tol = 1e-4f * sqrtf(reference::ekf.P[i][i] * reference::ekf.P[j][j]);
+                EXPECT_NEAR(reference::ekf.P[i][j], kernels::ekf.P[i][j], tol) << "P[" << i << "][" << j << "]";
+            }
+            EXPECT_NEAR(reference::ekf.X[i], kernels::ekf.X[i], 1e-5f) << "X[" << i << "]";
+        }
+    }
+};
+
+TEST_F(InsGpsTemplateKernels, Prediction) {
+    for (int step = 0; step < 500; step++) {
+        predict(step);
+    }
+    expectSame();
+}
+
+TEST_F(InsGpsTemplateKernels, PredictionAndCorrection) {
+    // cycle through the sensor combinations filterekf.c uses
+    const uint16_t sensors[] = {
+        FULL_SENSORS, MAG_SENSORS, HORIZ_SENSORS | VERT_SENSORS | BARO_SENSOR,
+        POS_SENSORS | HORIZ_SENSORS | VERT_SENSORS | BARO_SENSOR, BARO_SENSOR
+    };
+
+    for (int step = 0; step < 500; step++) {
+        predict(step);
+        if ((step % 10) == 0) {
+            correct(sensors[(step / 10) % (sizeof(sensors) / sizeof(sensors[0]))]);
+        }
+    }
+    expectSame();
+}
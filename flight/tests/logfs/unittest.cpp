@@ -297,6 +297,191 @@ TEST_F(LogfsTestCooked, WriteManyVerify) {
     EXPECT_EQ(0, memcmp(obj3, obj3_check, sizeof(obj3)));
 }
 
+TEST_F(LogfsTestCooked, WriteRemountVerifyDelete) {
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ1_ID, 0, obj1, sizeof(obj1)));
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ1_ID, 0, obj1_alt, sizeof(obj1_alt)));
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ2_ID, 0, obj2, sizeof(obj2)));
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ3_ID, 0, obj3, sizeof(obj3)));
+
+    /* Remount so the index gets rebuilt from the flash contents */
+    PIOS_FLASHFS_Logfs_Destroy(fs_id);
+    EXPECT_EQ(0, PIOS_FLASHFS_Logfs_Init(&fs_id, &flashfs_config_partition_a, &pios_ut_flash_driver, flash_id));
+
+    unsigned char obj1_check[OBJ1_SIZE];
+    memset(obj1_check, 0, sizeof(obj1_check));
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id, OBJ1_ID, 0, obj1_check, sizeof(obj1_check)));
+    EXPECT_EQ(0, memcmp(obj1_alt, obj1_check, sizeof(obj1_alt)));
+
+    unsigned char obj3_check[OBJ3_SIZE];
+    memset(obj3_check, 0, sizeof(obj3_check));
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id, OBJ3_ID, 0, obj3_check, sizeof(obj3_check)));
+    EXPECT_EQ(0, memcmp(obj3, obj3_check, sizeof(obj3)));
+
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjDelete(fs_id, OBJ2_ID, 0));
+
+    /* OBJ2 is gone, the others are still there */
+    unsigned char obj2_check[OBJ2_SIZE];
+    EXPECT_EQ(-3, PIOS_FLASHFS_ObjLoad(fs_id, OBJ2_ID, 0, obj2_check, sizeof(obj2_check)));
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id, OBJ1_ID, 0, obj1_check, sizeof(obj1_check)));
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id, OBJ3_ID, 0, obj3_check, sizeof(obj3_check)));
+
+    struct PIOS_FLASHFS_Stats stats;
+    EXPECT_EQ(0, PIOS_FLASHFS_GetStats(fs_id, &stats));
+    EXPECT_EQ(2, stats.num_active_slots);
+}
+
+TEST_F(LogfsTestCooked, CompactNotNeeded) {
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ1_ID, 0, obj1, sizeof(obj1)));
+
+    /* Plenty of free slots left, nothing to do */
+    EXPECT_EQ(0, PIOS_FLASHFS_Compact(fs_id, 4));
+    EXPECT_EQ(-1, PIOS_FLASHFS_Compact(fs_id + 1, 4));
+}
+
+TEST_F(LogfsTestCooked, CompactInBackground) {
+    uint32_t num_slots = flashfs_config_partition_a.arena_size / flashfs_config_partition_a.slot_size;
+
+    /* Objects at the start of the log get copied first */
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ2_ID, 0, obj2, sizeof(obj2)));
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ3_ID, 0, obj3, sizeof(obj3)));
+
+    /* Rewrite a handful of instances until the log runs low on free slots */
+    for (uint32_t i = 0; i < num_slots - 3 - (flashfs_config_partition_a.gc_headroom / 2); i++) {
+        EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ1_ID, i % 8, obj1, sizeof(obj1)));
+    }
+
+    /* Step the compaction along while saving and deleting objects on either side of it */
+    uint32_t steps = 0;
+    int32_t rc;
+    while ((rc = PIOS_FLASHFS_Compact(fs_id, 4)) == 1) {
+        switch (steps++) {
+        case 2:
+            /* Not copied yet */
+            EXPECT_EQ(0, PIOS_FLASHFS_ObjDelete(fs_id, OBJ1_ID, 7));
+            EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ1_ID, 1, obj1_alt, sizeof(obj1_alt)));
+            break;
+        case 5:
+            /* Already copied */
+            EXPECT_EQ(0, PIOS_FLASHFS_ObjDelete(fs_id, OBJ2_ID, 0));
+            EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ3_ID, 0, obj3, sizeof(obj3)));
+            break;
+        }
+    }
+    EXPECT_EQ(0, rc);
+    EXPECT_LT(5U, steps);
+
+    /* The log has been compacted down to the active objects plus the two copies obsoleted afterwards */
+    struct PIOS_FLASHFS_Stats stats;
+    EXPECT_EQ(0, PIOS_FLASHFS_GetStats(fs_id, &stats));
+    EXPECT_EQ(8, stats.num_active_slots);
+    EXPECT_EQ(num_slots - 1 - 8 - 2, (uint32_t)stats.num_free_slots);
+
+    /* Remount so the compacted arena is scanned from flash */
+    PIOS_FLASHFS_Logfs_Destroy(fs_id);
+    EXPECT_EQ(0, PIOS_FLASHFS_Logfs_Init(&fs_id, &flashfs_config_partition_a, &pios_ut_flash_driver, flash_id));
+    EXPECT_EQ(0, PIOS_FLASHFS_GetStats(fs_id, &stats));
+    EXPECT_EQ(8, stats.num_active_slots);
+
+    unsigned char obj1_check[OBJ1_SIZE];
+    memset(obj1_check, 0, sizeof(obj1_check));
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id, OBJ1_ID, 0, obj1_check, sizeof(obj1_check)));
+    EXPECT_EQ(0, memcmp(obj1, obj1_check, sizeof(obj1)));
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id, OBJ1_ID, 1, obj1_check, sizeof(obj1_check)));
+    EXPECT_EQ(0, memcmp(obj1_alt, obj1_check, sizeof(obj1_alt)));
+    EXPECT_EQ(-3, PIOS_FLASHFS_ObjLoad(fs_id, OBJ1_ID, 7, obj1_check, sizeof(obj1_check)));
+
+    unsigned char obj2_check[OBJ2_SIZE];
+    EXPECT_EQ(-3, PIOS_FLASHFS_ObjLoad(fs_id, OBJ2_ID, 0, obj2_check, sizeof(obj2_check)));
+
+    unsigned char obj3_check[OBJ3_SIZE];
+    memset(obj3_check, 0, sizeof(obj3_check));
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id, OBJ3_ID, 0, obj3_check, sizeof(obj3_check)));
+    EXPECT_EQ(0, memcmp(obj3, obj3_check, sizeof(obj3)));
+}
+
+TEST_F(LogfsTestCooked, CompactFinishedBySave) {
+    uint32_t num_slots = flashfs_config_partition_a.arena_size / flashfs_config_partition_a.slot_size;
+
+    for (uint32_t i = 0; i < num_slots - 1 - (flashfs_config_partition_a.gc_headroom / 2); i++) {
+        EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ1_ID, i % 8, obj1, sizeof(obj1)));
+    }
+
+    /* Erase the destination and copy part of the log, then fill it up */
+    EXPECT_EQ(1, PIOS_FLASHFS_Compact(fs_id, 4));
+    EXPECT_EQ(1, PIOS_FLASHFS_Compact(fs_id, 4));
+    for (uint32_t i = 0; i < flashfs_config_partition_a.gc_headroom; i++) {
+        EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ1_ID, i % 8, obj1_alt, sizeof(obj1_alt)));
+    }
+
+    /* The save that found the log full completed the compaction */
+    EXPECT_EQ(0, PIOS_FLASHFS_Compact(fs_id, 4));
+
+    unsigned char obj1_check[OBJ1_SIZE];
+    for (uint16_t i = 0; i < 8; i++) {
+        memset(obj1_check, 0, sizeof(obj1_check));
+        EXPECT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id, OBJ1_ID, i, obj1_check, sizeof(obj1_check)));
+        EXPECT_EQ(0, memcmp(obj1_alt, obj1_check, sizeof(obj1_alt)));
+    }
+}
+
+TEST_F(LogfsTestCooked, BatchSaveWithoutBegin) {
+    EXPECT_EQ(-2, PIOS_FLASHFS_BatchSave(fs_id, OBJ1_ID, 0, obj1, sizeof(obj1)));
+    EXPECT_EQ(-2, PIOS_FLASHFS_BatchCommit(fs_id));
+}
+
+TEST_F(LogfsTestCooked, BatchSaveVerify) {
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ1_ID, 0, obj1, sizeof(obj1)));
+
+    EXPECT_EQ(0, PIOS_FLASHFS_BatchBegin(fs_id));
+    EXPECT_EQ(0, PIOS_FLASHFS_BatchSave(fs_id, OBJ1_ID, 0, obj1, sizeof(obj1)));
+    EXPECT_EQ(0, PIOS_FLASHFS_BatchSave(fs_id, OBJ2_ID, 0, obj2, sizeof(obj2)));
+    EXPECT_EQ(0, PIOS_FLASHFS_BatchSave(fs_id, OBJ3_ID, 0, obj3, sizeof(obj3)));
+    /* Saved again in the same batch, only the last version is kept */
+    EXPECT_EQ(0, PIOS_FLASHFS_BatchSave(fs_id, OBJ1_ID, 0, obj1_alt, sizeof(obj1_alt)));
+    EXPECT_EQ(0, PIOS_FLASHFS_BatchCommit(fs_id));
+
+    struct PIOS_FLASHFS_Stats stats;
+    EXPECT_EQ(0, PIOS_FLASHFS_GetStats(fs_id, &stats));
+    EXPECT_EQ(3, stats.num_active_slots);
+
+    unsigned char obj1_check[OBJ1_SIZE];
+    memset(obj1_check, 0, sizeof(obj1_check));
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id, OBJ1_ID, 0, obj1_check, sizeof(obj1_check)));
+    EXPECT_EQ(0, memcmp(obj1_alt, obj1_check, sizeof(obj1_alt)));
+
+    unsigned char obj2_check[OBJ2_SIZE];
+    memset(obj2_check, 0, sizeof(obj2_check));
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id, OBJ2_ID, 0, obj2_check, sizeof(obj2_check)));
+    EXPECT_EQ(0, memcmp(obj2, obj2_check, sizeof(obj2)));
+
+    unsigned char obj3_check[OBJ3_SIZE];
+    memset(obj3_check, 0, sizeof(obj3_check));
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id, OBJ3_ID, 0, obj3_check, sizeof(obj3_check)));
+    EXPECT_EQ(0, memcmp(obj3, obj3_check, sizeof(obj3)));
+}
+
+TEST_F(LogfsTestCooked, BatchSaveFillsLog) {
+    uint32_t num_slots = flashfs_config_partition_a.arena_size / flashfs_config_partition_a.slot_size;
+
+    /* One batch larger than both the batch and the log, commits in chunks and collects garbage */
+    EXPECT_EQ(0, PIOS_FLASHFS_BatchBegin(fs_id));
+    for (uint32_t i = 0; i < 2 * num_slots; i++) {
+        EXPECT_EQ(0, PIOS_FLASHFS_BatchSave(fs_id, OBJ1_ID, i % 20, (i < num_slots) ? obj1 : obj1_alt, sizeof(obj1)));
+    }
+    EXPECT_EQ(0, PIOS_FLASHFS_BatchCommit(fs_id));
+
+    struct PIOS_FLASHFS_Stats stats;
+    EXPECT_EQ(0, PIOS_FLASHFS_GetStats(fs_id, &stats));
+    EXPECT_EQ(20, stats.num_active_slots);
+
+    unsigned char obj1_check[OBJ1_SIZE];
+    for (uint16_t i = 0; i < 20; i++) {
+        memset(obj1_check, 0, sizeof(obj1_check));
+        EXPECT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id, OBJ1_ID, i, obj1_check, sizeof(obj1_check)));
+        EXPECT_EQ(0, memcmp(obj1_alt, obj1_check, sizeof(obj1_alt)));
+    }
+}
+
 class LogfsTestCookedMultiPart : public LogfsTestRaw {
 protected:
     virtual void SetUp()
@@ -392,3 +577,47 @@ TEST_F(LogfsTestCookedMultiPart, WriteLarge) {
     memset(obj4_check, 0, sizeof(obj4_check));
     EXPECT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id_b, OBJ4_ID, 0, obj4_check, sizeof(obj4_check)));
 }
+
+TEST_F(LogfsTestCookedMultiPart, OverflowIndex) {
+    /* Partition B only indexes two objects, the third one forces lookups back to the flash */
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id_b, OBJ1_ID, 0, obj1, sizeof(obj1)));
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id_b, OBJ2_ID, 0, obj2, sizeof(obj2)));
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id_b, OBJ3_ID, 0, obj3, sizeof(obj3)));
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id_b, OBJ1_ID, 0, obj1_alt, sizeof(obj1_alt)));
+
+    unsigned char obj1_check[OBJ1_SIZE];
+    memset(obj1_check, 0, sizeof(obj1_check));
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id_b, OBJ1_ID, 0, obj1_check, sizeof(obj1_check)));
+    EXPECT_EQ(0, memcmp(obj1_alt, obj1_check, sizeof(obj1_alt)));
+
+    unsigned char obj3_check[OBJ3_SIZE];
+    memset(obj3_check, 0, sizeof(obj3_check));
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id_b, OBJ3_ID, 0, obj3_check, sizeof(obj3_check)));
+    EXPECT_EQ(0, memcmp(obj3, obj3_check, sizeof(obj3)));
+
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjDelete(fs_id_b, OBJ2_ID, 0));
+    unsigned char obj2_check[OBJ2_SIZE];
+    EXPECT_EQ(-3, PIOS_FLASHFS_ObjLoad(fs_id_b, OBJ2_ID, 0, obj2_check, sizeof(obj2_check)));
+}
+
+TEST_F(LogfsTestCookedMultiPart, BatchOverflowIndex) {
+    /* Partition B batches two saves and indexes two objects, old versions are found by scanning */
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id_b, OBJ1_ID, 0, obj1, sizeof(obj1)));
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id_b, OBJ2_ID, 0, obj2, sizeof(obj2)));
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id_b, OBJ3_ID, 0, obj3, sizeof(obj3)));
+
+    EXPECT_EQ(0, PIOS_FLASHFS_BatchBegin(fs_id_b));
+    EXPECT_EQ(0, PIOS_FLASHFS_BatchSave(fs_id_b, OBJ3_ID, 0, obj3, sizeof(obj3)));
+    EXPECT_EQ(0, PIOS_FLASHFS_BatchSave(fs_id_b, OBJ2_ID, 0, obj2, sizeof(obj2)));
+    EXPECT_EQ(0, PIOS_FLASHFS_BatchSave(fs_id_b, OBJ1_ID, 0, obj1_alt, sizeof(obj1_alt)));
+    EXPECT_EQ(0, PIOS_FLASHFS_BatchCommit(fs_id_b));
+
+    struct PIOS_FLASHFS_Stats stats;
+    EXPECT_EQ(0, PIOS_FLASHFS_GetStats(fs_id_b, &stats));
+    EXPECT_EQ(3, stats.num_active_slots);
+
+    unsigned char obj1_check[OBJ1_SIZE];
+    memset(obj1_check, 0, sizeof(obj1_check));
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id_b, OBJ1_ID, 0, obj1_check, sizeof(obj1_check)));
+    EXPECT_EQ(0, memcmp(obj1_alt, obj1_check, sizeof(obj1_alt)));
+}
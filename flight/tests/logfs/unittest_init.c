@@ -22,6 +22,10 @@ const struct flashfs_logfs_cfg flashfs_config_partition_a = {
     .start_offset  = 0,          /* start at the beginning of the chip */
     .sector_size   = 0x00010000, /* 64K bytes */
     .page_size     = 0x00000100, /* 256 bytes */
+
+    .index_size    = 255,        /* every slot of the arena */
+    .gc_headroom   = 32,         /* compact in the background below this many free slots */
+    .batch_size    = 16,         /* saves committed together */
 };
 
 const struct flashfs_logfs_cfg flashfs_config_partition_b = {
@@ -33,4 +37,7 @@ const struct flashfs_logfs_cfg flashfs_config_partition_b = {
     .start_offset  = 0x00200000, /* start after partition a */
     .sector_size   = 0x00010000, /* 64K bytes */
     .page_size     = 0x00000100, /* 256 bytes */
+
+    .index_size    = 2,          /* too small on purpose, overflows to scanning the flash */
+    .batch_size    = 2,          /* small as well, bulk saves are committed in chunks */
 };
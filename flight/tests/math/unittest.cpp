@@ -3,9 +3,13 @@
 #include <stdio.h> /* printf */
 #include <stdlib.h> /* abort */
 #include <string.h> /* memset */
+#include <time.h> /* clock */
 
 extern "C" {
 #include "mathmisc.h"
+#include "biquad.h"
+#include "fft.h"
+#include "pid.h"
 }
 
 #define epsilon 0.00001f
@@ -108,3 +112,225 @@ TEST_F(MathTestRaw, y_on_curve1) {
     EXPECT_NEAR(-0.35f, y_on_curve(1.250f, points, length(points)), epsilon);
     EXPECT_NEAR(-0.50f, y_on_curve(2.000f, points, length(points)), epsilon);
 }
+
+// error bounds documented in mathmisc.h
+#define fast_trig_epsilon 1e-5f
+#define fast_sin_epsilon  1e-6f
+#define BENCHMARK_LOOPS   1000000
+
+TEST_F(MathTestRaw, fast_atan2f) {
+    // sweep all quadrants and magnitudes
+    for (int i = -1000; i <= 1000; i++) {
+        for (int j = -1000; j <= 1000; j += 7) {
+            float y = i * 0.013f;
+            float x = j * 0.011f;
+            EXPECT_NEAR(atan2f(y, x), fast_atan2f(y, x), fast_trig_epsilon);
+        }
+    }
+    EXPECT_EQ(0.0f, fast_atan2f(0.0f, 0.0f));
+    EXPECT_NEAR(atan2f(1e6f, 1e-6f), fast_atan2f(1e6f, 1e-6f), fast_trig_epsilon);
+}
+
+TEST_F(MathTestRaw, fast_asinf) {
+    for (int i = -10000; i <= 10000; i++) {
+        float x = i * 1e-4f;
+        EXPECT_NEAR(asinf(x), fast_asinf(x), fast_trig_epsilon);
+    }
+    // slightly out of range values from rounding errors are clamped
+    EXPECT_NEAR(asinf(1.0f), fast_asinf(1.0000001f), fast_trig_epsilon);
+    EXPECT_NEAR(asinf(-1.0f), fast_asinf(-1.0000001f), fast_trig_epsilon);
+}
+
+TEST_F(MathTestRaw, fast_sincosf) {
+    for (int i = -100000; i <= 100000; i++) {
+        float x = i * 1e-3f;
+        EXPECT_NEAR(sinf(x), fast_sinf(x), fast_sin_epsilon);
+        EXPECT_NEAR(cosf(x), fast_cosf(x), fast_sin_epsilon);
+    }
+}
+
+// Timings are printed for reference only, host performance is not asserted
+TEST_F(MathTestRaw, fast_trig_benchmark) {
+    volatile float sink = 0.0f;
+    clock_t start;
+
+    start = clock();
+    for (int i = 0; i < BENCHMARK_LOOPS; i++) {
+        float x = (i & 0xfff) * 1e-3f - 2.0f;
+        sink += atan2f(x, 0.5f) + asinf(x * 0.4f) + sinf(x);
+    }
+    double libm = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    start = clock();
+    for (int i = 0; i < BENCHMARK_LOOPS; i++) {
+        float x = (i & 0xfff) * 1e-3f - 2.0f;
+        sink += fast_atan2f(x, 0.5f) + fast_asinf(x * 0.4f) + fast_sinf(x);
+    }
+    double fast = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    printf("atan2f + asinf + sinf x %d: libm %.3fs, fast %.3fs\n", BENCHMARK_LOOPS, libm, fast);
+    (void)sink;
+}
+
+// feed a sine of the given frequency ratio and return the output amplitude once settled
+static float biquad_gain(struct BiquadBank *bank, float ff)
+{
+    float peak = 0.0f;
+
+    for (int n = 0; n < 4000; n++) {
+        float x  = sinf(2.0f * 3.14159265f * ff * n);
+        float in[3] = { x, -x, 0.5f * x };
+        float out[3];
+        FilterBiquadBank(bank, in, out);
+        EXPECT_NEAR(-out[0], out[1], 1e-6f);
+        EXPECT_NEAR(0.5f * out[0], out[2], 1e-6f);
+        if (n >= 3000 && fabsf(out[0]) > peak) {
+            peak = fabsf(out[0]);
+        }
+    }
+    return peak;
+}
+
+TEST_F(MathTestRaw, biquad_first_order) {
+    struct BiquadBank bank;
+    struct BiquadCoeffs coeffs;
+    const float alpha = 0.8f;
+    float scalar = 0.0f;
+
+    InitBiquadBank(&bank);
+    InitBiquadFirstOrderLowPass(alpha, &coeffs);
+    EXPECT_TRUE(AddBiquadBankStage(&bank, &coeffs));
+
+    // must match the scalar low pass it replaces
+    for (int n = 0; n < 100; n++) {
+        float x     = (n & 8) ? 1.0f : -0.3f;
+        float in[3] = { x, x, x };
+        float out[3];
+        scalar = scalar * alpha + x * (1 - alpha);
+        FilterBiquadBank(&bank, in, out);
+        EXPECT_NEAR(scalar, out[0], epsilon);
+    }
+}
+
+TEST_F(MathTestRaw, biquad_notch_lowpass) {
+    struct BiquadBank bank;
+    struct BiquadCoeffs coeffs;
+
+    InitBiquadBank(&bank);
+    InitBiquadNotch(0.2f, 3.0f, &coeffs);
+    EXPECT_TRUE(AddBiquadBankStage(&bank, &coeffs));
+    EXPECT_NEAR(0.0f, biquad_gain(&bank, 0.2f), 1e-3f);
+    EXPECT_NEAR(1.0f, biquad_gain(&bank, 0.01f), 1e-2f);
+
+    InitBiquadBank(&bank);
+    InitBiquadLowPass(0.05f, 0.70710678f, &coeffs);
+    EXPECT_TRUE(AddBiquadBankStage(&bank, &coeffs));
+    EXPECT_NEAR(0.70710678f, biquad_gain(&bank, 0.05f), 1e-2f);
+    EXPECT_GT(0.05f, biquad_gain(&bank, 0.3f));
+}
+
+TEST_F(MathTestRaw, biquad_reset) {
+    struct BiquadBank bank;
+    struct BiquadCoeffs coeffs;
+    const float x0[3] = { 10.0f, -20.0f, 30.0f };
+
+    InitBiquadBank(&bank);
+    InitBiquadFirstOrderLowPass(0.9f, &coeffs);
+    EXPECT_TRUE(AddBiquadBankStage(&bank, &coeffs));
+    InitBiquadLowPass(0.1f, 0.70710678f, &coeffs);
+    EXPECT_TRUE(AddBiquadBankStage(&bank, &coeffs));
+    InitBiquadNotch(0.3f, 2.0f, &coeffs);
+    EXPECT_TRUE(AddBiquadBankStage(&bank, &coeffs));
+    InitBiquadNotch(0.4f, 2.0f, &coeffs);
+    EXPECT_TRUE(AddBiquadBankStage(&bank, &coeffs));
+    EXPECT_FALSE(AddBiquadBankStage(&bank, &coeffs));
+
+    // a constant input after a reset must not cause a transient
+    ResetBiquadBank(&bank, x0);
+    for (int n = 0; n < 50; n++) {
+        float out[3];
+        FilterBiquadBank(&bank, x0, out);
+        EXPECT_NEAR(x0[0], out[0], 1e-3f);
+        EXPECT_NEAR(x0[1], out[1], 1e-3f);
+        EXPECT_NEAR(x0[2], out[2], 1e-3f);
+    }
+}
+
+TEST_F(MathTestRaw, fft_q15) {
+    static struct FFTq15 fft;
+    int16_t re[128];
+    int16_t im[128];
+
+    EXPECT_EQ(-1, InitFFTq15(FFT_LOG2_MAX + 1, &fft));
+    ASSERT_EQ(0, InitFFTq15(7, &fft));
+
+    for (int bin = 1; bin < 64; bin += 5) {
+        for (int k = 0; k < 128; k++) {
+            re[k] = (int16_t)(16000.0f * sinf(2.0f * 3.14159265f * bin * k / 128) + 4000.0f);
+            im[k] = 0;
+        }
+        FFTq15(&fft, re, im);
+
+        // scaled by 1/n: the DC offset shows up in bin 0, the sine with half its amplitude
+        EXPECT_NEAR(4000, re[0], 4);
+        EXPECT_NEAR(8000, sqrtf((float)MagnitudeSquaredFFTq15(re[bin], im[bin])), 16);
+        EXPECT_NEAR(8000, sqrtf((float)MagnitudeSquaredFFTq15(re[128 - bin], im[128 - bin])), 16);
+        for (int k = 1; k < 64; k++) {
+            if (k != bin) {
+                EXPECT_GT(16.0f, sqrtf((float)MagnitudeSquaredFFTq15(re[k], im[k])));
+            }
+        }
+    }
+}
+
+TEST_F(MathTestRaw, fft_q15_window) {
+    static struct FFTq15 fft;
+    int16_t re[64];
+    int16_t im[64] = { 0 };
+
+    ASSERT_EQ(0, InitFFTq15(6, &fft));
+    for (int k = 0; k < 64; k++) {
+        re[k] = 20000;
+    }
+    WindowFFTq15(&fft, re);
+    EXPECT_EQ(0, re[0]);
+    EXPECT_NEAR(20000, re[32], 1);
+
+    // a windowed constant leaks into the first bin only
+    FFTq15(&fft, re, im);
+    EXPECT_NEAR(10000, re[0], 4);
+    EXPECT_NEAR(5000, sqrtf((float)MagnitudeSquaredFFTq15(re[1], im[1])), 4);
+    for (int k = 2; k < 32; k++) {
+        EXPECT_GT(4.0f, sqrtf((float)MagnitudeSquaredFFTq15(re[k], im[k])));
+    }
+}
+
+TEST_F(MathTestRaw, pid3_matches_pid) {
+    struct pid single[3];
+    struct pid3 triple;
+    const pid_scaler scaler[3] = {
+        { 1.0f, 1.0f, 1.0f }, { 0.5f, 2.0f, 1.5f }, { 1.0f, 0.0f, 1.0f }
+    };
+
+    pid_configure_derivative(25.0f, 0.8f);
+    pid3_zero(&triple);
+    for (int t = 0; t < 3; t++) {
+        pid_configure(&single[t], 0.002f * (t + 1), 0.006f, t == 1 ? 0.0f : 0.00003f, 0.3f);
+        pid_zero(&single[t]);
+        pid3_configure(&triple, t, 0.002f * (t + 1), 0.006f, t == 1 ? 0.0f : 0.00003f, 0.3f);
+    }
+
+    for (int n = 0; n < 500; n++) {
+        const float setpoint[3] = { 100.0f, -50.0f, (n / 100) % 2 ? 200.0f : -200.0f };
+        const float measured[3] = { 80.0f * sinf(0.05f * n), 30.0f, 0.3f * n };
+        float output[3];
+
+        pid3_apply_setpoint(&triple, scaler, setpoint, measured, 0.002f, output);
+        for (int t = 0; t < 3; t++) {
+            const float expected = pid_apply_setpoint(&single[t], &scaler[t], setpoint[t], measured[t], 0.002f);
+            ASSERT_NEAR(expected, output[t], 1e-4f * fmaxf(1.0f, fabsf(expected)));
+            ASSERT_NEAR(single[t].iAccumulator, triple.iAccumulator[t], 1e-3f);
+        }
+    }
+    pid_configure_derivative(20.0f, 1.0f);
+}
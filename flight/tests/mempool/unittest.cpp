@@ -0,0 +1,108 @@
+#include "gtest/gtest.h"
+
+#include <stdint.h>
+#include <string.h> /* memset */
+
+extern "C" {
+#include "pios_mempool.h"
+}
+
+#define NUM_BLOCKS 4
+
+struct entry {
+    void    *next;
+    uint32_t data[3];
+};
+
+// To use a test fixture, derive a class from testing::Test.
+class MempoolTest : public testing::Test {
+protected:
+    virtual void SetUp()
+    {
+        ASSERT_EQ(0, PIOS_MEMPOOL_Init(&pool, sizeof(struct entry), NUM_BLOCKS, false));
+    }
+
+    bool inPool(void *block)
+    {
+        return (uint8_t *)block >= pool.storage && (uint8_t *)block < pool.storage + pool.block_size * pool.num_blocks;
+    }
+
+    struct pios_mempool pool;
+};
+
+TEST_F(MempoolTest, init) {
+    EXPECT_EQ(NUM_BLOCKS, pool.num_blocks);
+    EXPECT_GE(pool.block_size, sizeof(struct entry));
+    EXPECT_EQ(0u, pool.block_size % sizeof(void *));
+    EXPECT_EQ(0, pool.used);
+    EXPECT_EQ(0, pool.max_used);
+    EXPECT_EQ(0, pool.overflows);
+}
+
+TEST_F(MempoolTest, alloc_distinct_blocks) {
+    void *blocks[NUM_BLOCKS];
+
+    for (int i = 0; i < NUM_BLOCKS; i++) {
+        blocks[i] = PIOS_MEMPOOL_Alloc(&pool);
+        ASSERT_TRUE(blocks[i] != NULL);
+        EXPECT_TRUE(inPool(blocks[i]));
+        for (int j = 0; j < i; j++) {
+            EXPECT_NE(blocks[j], blocks[i]);
+        }
+        // The whole block is usable
+        memset(blocks[i], 0xA5, sizeof(struct entry));
+    }
+    EXPECT_EQ(NUM_BLOCKS, pool.used);
+    EXPECT_EQ(NUM_BLOCKS, pool.max_used);
+    EXPECT_EQ(0, pool.overflows);
+}
+
+TEST_F(MempoolTest, free_and_reuse) {
+    void *a = PIOS_MEMPOOL_Alloc(&pool);
+    void *b = PIOS_MEMPOOL_Alloc(&pool);
+
+    PIOS_MEMPOOL_Free(&pool, a);
+    EXPECT_EQ(1, pool.used);
+    EXPECT_EQ(2, pool.max_used);
+
+    // The last freed block is handed out first
+    EXPECT_EQ(a, PIOS_MEMPOOL_Alloc(&pool));
+    PIOS_MEMPOOL_Free(&pool, b);
+    PIOS_MEMPOOL_Free(&pool, a);
+    EXPECT_EQ(0, pool.used);
+    EXPECT_EQ(2, pool.max_used);
+}
+
+TEST_F(MempoolTest, overflow_to_heap) {
+    void *blocks[NUM_BLOCKS];
+
+    for (int i = 0; i < NUM_BLOCKS; i++) {
+        blocks[i] = PIOS_MEMPOOL_Alloc(&pool);
+    }
+
+    void *extra = PIOS_MEMPOOL_Alloc(&pool);
+    ASSERT_TRUE(extra != NULL);
+    EXPECT_FALSE(inPool(extra));
+    EXPECT_EQ(1, pool.overflows);
+    EXPECT_EQ(NUM_BLOCKS + 1, pool.max_used);
+
+    // Heap blocks go back to the heap, not to the free list
+    PIOS_MEMPOOL_Free(&pool, extra);
+    PIOS_MEMPOOL_Free(&pool, blocks[0]);
+    EXPECT_EQ(blocks[0], PIOS_MEMPOOL_Alloc(&pool));
+    EXPECT_TRUE(PIOS_MEMPOOL_Alloc(&pool) != NULL);
+    EXPECT_EQ(2, pool.overflows);
+}
+
+TEST_F(MempoolTest, empty_pool) {
+    struct pios_mempool heapOnly;
+
+    ASSERT_EQ(0, PIOS_MEMPOOL_Init(&heapOnly, 1, 0, false));
+    EXPECT_EQ(sizeof(void *), heapOnly.block_size);
+
+    void *block = PIOS_MEMPOOL_Alloc(&heapOnly);
+    ASSERT_TRUE(block != NULL);
+    EXPECT_EQ(1, heapOnly.overflows);
+    PIOS_MEMPOOL_Free(&heapOnly, block);
+    EXPECT_EQ(0, heapOnly.used);
+}
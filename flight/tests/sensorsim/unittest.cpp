@@ -0,0 +1,130 @@
+#include "gtest/gtest.h"
+
+#include <stdio.h> /* printf */
+#include <stdlib.h> /* abort */
+#include <string.h> /* memset */
+#include <math.h>
+
+extern "C" {
+#include "sensorsim.h"
+}
+
+#define SAMPLE_PERIOD_US 2000
+#define SAMPLES_PER_S    (1000000 / SAMPLE_PERIOD_US)
+
+// To use a test fixture, derive a class from testing::Test.
+class SensorSim : public testing::Test {
+protected:
+    virtual void SetUp()
+    {
+        memset(&input, 0, sizeof(input));
+        input.Be[0] = 1;
+    }
+
+    struct sensorsim_input input;
+    struct sensorsim_block block;
+};
+
+TEST_F(SensorSim, SameSeedSameSamples) {
+    struct sensorsim_state a, b;
+    struct sensorsim_block other;
+
+    SensorSimInit(&a, 1234);
+    SensorSimInit(&b, 1234);
+    input.armed    = true;
+    input.throttle = 0.6f;
+    input.rate[0]  = 10;
+    for (int i = 0; i < 50; i++) {
+        SensorSimRun(&a, &input, 16, SAMPLE_PERIOD_US, &block);
+        SensorSimRun(&b, &input, 16, SAMPLE_PERIOD_US, &other);
+        for (int j = 0; j < 3; j++) {
+            ASSERT_EQ(0, memcmp(block.gyro[j], other.gyro[j], 16 * sizeof(float)));
+            ASSERT_EQ(0, memcmp(block.accel[j], other.accel[j], 16 * sizeof(float)));
+            ASSERT_EQ(0, memcmp(block.gps_pos[j], other.gps_pos[j], 16 * sizeof(float)));
+        }
+    }
+
+    SensorSimInit(&b, 4321);
+    SensorSimRun(&b, &input, 16, SAMPLE_PERIOD_US, &other);
+    EXPECT_NE(0, memcmp(block.gyro[0], other.gyro[0], 16 * sizeof(float)));
+}
+
+TEST_F(SensorSim, BlockLengthDoesNotMatter) {
+    struct sensorsim_state a, b;
+    struct sensorsim_block single;
+
+    SensorSimInit(&a, 99);
+    SensorSimInit(&b, 99);
+    input.armed    = true;
+    input.throttle = 0.7f;
+    input.rate[1]  = -20;
+    input.rate[2]  = 45;
+    for (int i = 0; i < 25; i++) {
+        SensorSimRun(&a, &input, 8, SAMPLE_PERIOD_US, &block);
+        for (int n = 0; n < 8; n++) {
+            SensorSimRun(&b, &input, 1, SAMPLE_PERIOD_US, &single);
+            ASSERT_EQ(block.time_us[n], single.time_us[0]);
+            ASSERT_EQ(block.due[n], single.due[0]);
+            for (int j = 0; j < 3; j++) {
+                ASSERT_NEAR(block.gyro[j][n], single.gyro[j][0], 1e-4f);
+                ASSERT_NEAR(block.accel[j][n], single.accel[j][0], 1e-4f);
+                ASSERT_NEAR(block.mag[j][n], single.mag[j][0], 1e-4f);
+                ASSERT_NEAR(block.pos[j][n], single.pos[j][0], 1e-3f);
+            }
+        }
+    }
+}
+
+TEST_F(SensorSim, RestingOnTheGround) {
+    struct sensorsim_state state;
+
+    SensorSimInit(&state, 1);
+    double gyro_sum = 0, gyro_sq = 0;
+    int samples     = 0;
+    for (int i = 0; i < 10 * SAMPLES_PER_S / SENSORSIM_MAX_BLOCK; i++) {
+        SensorSimRun(&state, &input, SENSORSIM_MAX_BLOCK, SAMPLE_PERIOD_US, &block);
+        for (int n = 0; n < block.count; n++) {
+            gyro_sum += block.gyro[0][n];
+            gyro_sq  += block.gyro[0][n] * block.gyro[0][n];
+            samples++;
+            ASSERT_NEAR(-9.81f, block.accel[2][n], 0.5f);
+            ASSERT_EQ(0.0f, block.pos[2][n]);
+            ASSERT_NEAR(1.0f, block.mag[0][n], 1e-5f);
+        }
+    }
+    double mean = gyro_sum / samples;
+    EXPECT_NEAR(0.0, mean, 0.05);
+    EXPECT_NEAR(1.0, sqrt(gyro_sq / samples - mean * mean), 0.05);
+}
+
+TEST_F(SensorSim, SlowSensorRates) {
+    struct sensorsim_state state;
+    int baro = 0, mag = 0, gps = 0;
+
+    SensorSimInit(&state, 0);
+    for (int i = 0; i < SAMPLES_PER_S / 20; i++) {
+        SensorSimRun(&state, &input, 20, SAMPLE_PERIOD_US, &block);
+        for (int n = 0; n < block.count; n++) {
+            baro += (block.due[n] & SENSORSIM_DUE_BARO) != 0;
+            mag  += (block.due[n] & SENSORSIM_DUE_MAG) != 0;
+            gps  += (block.due[n] & SENSORSIM_DUE_GPS) != 0;
+        }
+    }
+    EXPECT_EQ(1000000 / SENSORSIM_BARO_PERIOD_US, baro);
+    EXPECT_EQ(1000000 / SENSORSIM_MAG_PERIOD_US, mag);
+    EXPECT_EQ(1000000 / SENSORSIM_GPS_PERIOD_US, gps);
+}
+
+TEST_F(SensorSim, YawRateTurnsTheMag) {
+    struct sensorsim_state state;
+
+    SensorSimInit(&state, 7);
+    input.armed   = true;
+    input.rate[2] = 90;
+    for (int i = 0; i < SAMPLES_PER_S / 10; i++) {
+        SensorSimRun(&state, &input, 10, SAMPLE_PERIOD_US, &block);
+    }
+    // North seen from the body after a quarter turn to the east
+    float heading = atan2f(-block.mag[1][9], block.mag[0][9]) * 180.0f / (float)M_PI;
+    EXPECT_NEAR(90.0f, heading, 2.0f);
+}
@@ -0,0 +1,11 @@
+#ifndef CALLBACKINFO_H
+#define CALLBACKINFO_H
+
+/* The callback IDs used by the event dispatcher, the generated object is not needed */
+typedef enum {
+    CALLBACKINFO_RUNNING_EVENTDISPATCHER  = 0,
+    CALLBACKINFO_RUNNING_EVENTDISPATCHER1 = 1,
+    CALLBACKINFO_RUNNING_EVENTDISPATCHER2 = 2,
+} CallbackInfoRunningElem;
+
+#endif /* CALLBACKINFO_H */
@@ -0,0 +1,51 @@
+#ifndef PIOS_H
+#define PIOS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#define PIOS_Assert(x)        assert(x)
+#define PIOS_DEBUG_Assert(x)  PIOS_Assert(x)
+#define PIOS_STATIC_ASSERT(test) ((void)sizeof(int[1 - 2 * !(test)]))
+
+/* FreeRTOS, provided by the test */
+typedef void *xQueueHandle;
+typedef void *xSemaphoreHandle;
+typedef long portBASE_TYPE;
+typedef uint32_t portTickType;
+
+#define pdTRUE                  1
+#define pdFALSE                 0
+#define portMAX_DELAY           0xffffffff
+#define portTICK_RATE_MS        1
+#define tskIDLE_PRIORITY        0
+#define configMINIMAL_STACK_SIZE 128
+
+xQueueHandle xQueueCreate(uint32_t length, uint32_t itemSize);
+portBASE_TYPE xQueueSend(xQueueHandle queue, const void *item, uint32_t ticksToWait);
+portBASE_TYPE xQueueReceive(xQueueHandle queue, void *item, uint32_t ticksToWait);
+uint32_t uxQueueMessagesWaiting(xQueueHandle queue);
+xSemaphoreHandle xSemaphoreCreateRecursiveMutex(void);
+xSemaphoreHandle xSemaphoreCreateBinary(void);
+portBASE_TYPE xSemaphoreTakeRecursive(xSemaphoreHandle semaphore, uint32_t ticksToWait);
+portBASE_TYPE xSemaphoreGiveRecursive(xSemaphoreHandle semaphore);
+portBASE_TYPE xSemaphoreTake(xSemaphoreHandle semaphore, uint32_t ticksToWait);
+portBASE_TYPE xSemaphoreGive(xSemaphoreHandle semaphore);
+uint32_t xTaskGetTickCount(void);
+
+#define vSemaphoreCreateBinary(semaphore) ((semaphore) = xSemaphoreCreateBinary())
+
+#include "pios_mem.h"
+#include "pios_mempool.h"
+#include "pios_crc.h"
+#include "pios_struct_helper.h"
+#include "pios_callbackscheduler.h"
+
+/* Provided by the test, stands in for pios_debuglog.c */
+void PIOS_DEBUGLOG_UAVObject(uint32_t objid, uint16_t instid, size_t size, uint16_t num_words, uint16_t num_halfwords, uint8_t *data);
+
+#endif /* PIOS_H */
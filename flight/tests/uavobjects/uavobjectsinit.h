@@ -0,0 +1,7 @@
+#ifndef UAVOBJECTSINIT_H
+#define UAVOBJECTSINIT_H
+
+/* Size of the largest object for the UAVTalk buffers, the generated object set is not needed */
+#define UAVOBJECTS_LARGEST 256
+
+#endif /* UAVOBJECTSINIT_H */
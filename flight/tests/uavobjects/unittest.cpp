@@ -0,0 +1,459 @@
+#include "gtest/gtest.h"
+
+#include <stdio.h> /* printf */
+#include <stdlib.h> /* malloc */
+#include <string.h> /* memset */
+
+#include <deque>
+#include <vector>
+
+extern "C" {
+#include "openpilot.h"
+#include "callbackinfo.h"
+}
+
+/*
+ * FreeRTOS and callback scheduler stand-ins. Everything runs in the test
+ * thread, the scheduler callbacks only run when a test invokes them.
+ */
+struct TestQueue {
+    uint32_t length;
+    uint32_t itemSize;
+    std::deque<std::vector<uint8_t> > items;
+};
+
+struct DelayedCallbackInfoStruct {
+    DelayedCallback cb;
+    DelayedCallbackPriority     priority;
+    DelayedCallbackPriorityTask task;
+    int16_t callbackID;
+    uint32_t dispatched;
+};
+
+static std::vector<DelayedCallbackInfo *> callbacks;
+static uint32_t tickCount;
+static uint32_t semaphoreDummy;
+
+extern "C" {
+xQueueHandle xQueueCreate(uint32_t length, uint32_t itemSize)
+{
+    TestQueue *queue = new TestQueue;
+
+    queue->length   = length;
+    queue->itemSize = itemSize;
+    return queue;
+}
+
+portBASE_TYPE xQueueSend(xQueueHandle handle, const void *item, __attribute__((unused)) uint32_t ticksToWait)
+{
+    TestQueue *queue = (TestQueue *)handle;
+
+    if (queue->items.size() >= queue->length) {
+        return pdFALSE;
+    }
+    queue->items.push_back(std::vector<uint8_t>((const uint8_t *)item, (const uint8_t *)item + queue->itemSize));
+    return pdTRUE;
+}
+
+portBASE_TYPE xQueueReceive(xQueueHandle handle, void *item, __attribute__((unused)) uint32_t ticksToWait)
+{
+    TestQueue *queue = (TestQueue *)handle;
+
+    if (queue->items.empty()) {
+        return pdFALSE;
+    }
+    memcpy(item, &queue->items.front()[0], queue->itemSize);
+    queue->items.pop_front();
+    return pdTRUE;
+}
+
+uint32_t uxQueueMessagesWaiting(xQueueHandle handle)
+{
+    return ((TestQueue *)handle)->items.size();
+}
+
+xSemaphoreHandle xSemaphoreCreateRecursiveMutex(void)
+{
+    return &semaphoreDummy;
+}
+
+xSemaphoreHandle xSemaphoreCreateBinary(void)
+{
+    return &semaphoreDummy;
+}
+
+portBASE_TYPE xSemaphoreTakeRecursive(__attribute__((unused)) xSemaphoreHandle semaphore, __attribute__((unused)) uint32_t ticksToWait)
+{
+    return pdTRUE;
+}
+
+portBASE_TYPE xSemaphoreGiveRecursive(__attribute__((unused)) xSemaphoreHandle semaphore)
+{
+    return pdTRUE;
+}
+
+portBASE_TYPE xSemaphoreTake(__attribute__((unused)) xSemaphoreHandle semaphore, __attribute__((unused)) uint32_t ticksToWait)
+{
+    return pdTRUE;
+}
+
+portBASE_TYPE xSemaphoreGive(__attribute__((unused)) xSemaphoreHandle semaphore)
+{
+    return pdTRUE;
+}
+
+uint32_t xTaskGetTickCount(void)
+{
+    return tickCount;
+}
+
+DelayedCallbackInfo *PIOS_CALLBACKSCHEDULER_Create(DelayedCallback cb, DelayedCallbackPriority priority, DelayedCallbackPriorityTask priorityTask,
+                                                   int16_t callbackID, __attribute__((unused)) uint32_t stacksize)
+{
+    DelayedCallbackInfo *info = new DelayedCallbackInfo;
+
+    info->cb         = cb;
+    info->priority   = priority;
+    info->task       = priorityTask;
+    info->callbackID = callbackID;
+    info->dispatched = 0;
+    callbacks.push_back(info);
+    return info;
+}
+
+int32_t PIOS_CALLBACKSCHEDULER_Dispatch(DelayedCallbackInfo *cbinfo)
+{
+    cbinfo->dispatched++;
+    return 1;
+}
+
+int32_t PIOS_CALLBACKSCHEDULER_Schedule(__attribute__((unused)) DelayedCallbackInfo *cbinfo, __attribute__((unused)) int32_t milliseconds,
+                                        __attribute__((unused)) DelayedCallbackUpdateMode updatemode)
+{
+    return 1;
+}
+
+void PIOS_DEBUGLOG_UAVObject(__attribute__((unused)) uint32_t objid, __attribute__((unused)) uint16_t instid, __attribute__((unused)) size_t size,
+                             __attribute__((unused)) uint16_t num_words, __attribute__((unused)) uint16_t num_halfwords, __attribute__((unused)) uint8_t *data)
+{}
+}
+
+// Slots of the object handle section, UAVObjInitialize() sizes the object index from it
+static UAVObjHandle handles[16] __attribute__((section("_uavo_handles"), used));
+
+#define OBJ_ID     0x1A2B3C4C
+#define OBJ_SIZE   12
+
+static std::vector<UAVObjEventCallback> invoked;
+
+static void callbackA(__attribute__((unused)) UAVObjEvent *ev)
+{
+    invoked.push_back(&callbackA);
+}
+
+static void callbackB(__attribute__((unused)) UAVObjEvent *ev)
+{
+    invoked.push_back(&callbackB);
+}
+
+// To use a test fixture, derive a class from testing::Test.
+class UAVObjectsTest : public testing::Test {
+protected:
+    virtual void SetUp()
+    {
+        callbacks.clear();
+        invoked.clear();
+        // the dispatcher keeps its next periodic update time across tests
+        tickCount += 10000;
+        ASSERT_EQ(0, UAVObjInitialize());
+        ASSERT_EQ(0, EventDispatcherInitialize());
+    }
+
+    // The scheduler callback created for a lane, NULL if there is none
+    DelayedCallbackInfo *laneCallback(int16_t callbackID)
+    {
+        for (size_t i = 0; i < callbacks.size(); i++) {
+            if (callbacks[i]->callbackID == callbackID) {
+                return callbacks[i];
+            }
+        }
+        return NULL;
+    }
+};
+
+class EventLanes : public UAVObjectsTest {};
+
+TEST_F(EventLanes, OnlyRegularLaneAtInit) {
+    ASSERT_EQ(1u, callbacks.size());
+    DelayedCallbackInfo *regular = laneCallback(CALLBACKINFO_RUNNING_EVENTDISPATCHER);
+    ASSERT_TRUE(regular != NULL);
+    EXPECT_EQ(CALLBACK_PRIORITY_CRITICAL, regular->priority);
+    EXPECT_EQ(CALLBACK_TASK_FLIGHTCONTROL, regular->task);
+    EXPECT_EQ(1u, regular->dispatched);
+}
+
+TEST_F(EventLanes, LanesCreatedOnFirstUse) {
+    UAVObjHandle obj = UAVObjRegister(OBJ_ID, true, false, false, false, OBJ_SIZE, 0, 0, NULL);
+
+    ASSERT_TRUE(obj != NULL);
+    ASSERT_EQ(0, UAVObjConnectCallbackPriority(obj, &callbackA, EV_MASK_ALL_UPDATES, EV_PRIORITY_CRITICAL));
+    ASSERT_EQ(2u, callbacks.size());
+    DelayedCallbackInfo *critical = laneCallback(CALLBACKINFO_RUNNING_EVENTDISPATCHER1);
+    ASSERT_TRUE(critical != NULL);
+    EXPECT_EQ(CALLBACK_PRIORITY_CRITICAL, critical->priority);
+    EXPECT_EQ(CALLBACK_TASK_DEVICEDRIVER, critical->task);
+
+    // a lane is only created once
+    ASSERT_EQ(0, UAVObjConnectCallbackPriority(obj, &callbackB, EV_MASK_ALL_UPDATES, EV_PRIORITY_CRITICAL));
+    EXPECT_EQ(2u, callbacks.size());
+
+    UAVObjEvent ev = { obj, 0, EV_UPDATED_PERIODIC, false };
+    ASSERT_EQ(0, EventPeriodicCallbackCreatePriority(&ev, &callbackA, 10, EV_PRIORITY_LOW));
+    ASSERT_EQ(3u, callbacks.size());
+    DelayedCallbackInfo *low = laneCallback(CALLBACKINFO_RUNNING_EVENTDISPATCHER2);
+    ASSERT_TRUE(low != NULL);
+    EXPECT_EQ(CALLBACK_PRIORITY_LOW, low->priority);
+    EXPECT_EQ(CALLBACK_TASK_AUXILIARY, low->task);
+
+    EXPECT_EQ(-1, EventDispatcherEnablePriority((UAVObjEventPriority)EV_PRIORITY_COUNT));
+}
+
+TEST_F(EventLanes, ObjectCallbackRunsFromItsLane) {
+    UAVObjHandle obj = UAVObjRegister(OBJ_ID, true, false, false, false, OBJ_SIZE, 0, 0, NULL);
+
+    ASSERT_TRUE(obj != NULL);
+    ASSERT_EQ(0, UAVObjConnectCallbackPriority(obj, &callbackA, EV_MASK_ALL_UPDATES, EV_PRIORITY_CRITICAL));
+    ASSERT_EQ(0, UAVObjConnectCallback(obj, &callbackB, EV_MASK_ALL_UPDATES));
+    DelayedCallbackInfo *critical = laneCallback(CALLBACKINFO_RUNNING_EVENTDISPATCHER1);
+    DelayedCallbackInfo *regular  = laneCallback(CALLBACKINFO_RUNNING_EVENTDISPATCHER);
+    ASSERT_TRUE(critical != NULL);
+    ASSERT_TRUE(regular != NULL);
+
+    UAVObjUpdated(obj);
+    EXPECT_EQ(1u, critical->dispatched);
+    EXPECT_EQ(2u, regular->dispatched);
+
+    regular->cb();
+    ASSERT_EQ(1u, invoked.size());
+    EXPECT_EQ(&callbackB, invoked[0]);
+
+    critical->cb();
+    ASSERT_EQ(2u, invoked.size());
+    EXPECT_EQ(&callbackA, invoked[1]);
+}
+
+TEST_F(EventLanes, PeriodicCallbackQueuedToItsLane) {
+    UAVObjHandle obj = UAVObjRegister(OBJ_ID, true, false, false, false, OBJ_SIZE, 0, 0, NULL);
+    UAVObjEvent ev   = { obj, 0, EV_UPDATED_PERIODIC, false };
+
+    ASSERT_EQ(0, EventPeriodicCallbackCreatePriority(&ev, &callbackA, 10, EV_PRIORITY_LOW));
+    DelayedCallbackInfo *low     = laneCallback(CALLBACKINFO_RUNNING_EVENTDISPATCHER2);
+    DelayedCallbackInfo *regular = laneCallback(CALLBACKINFO_RUNNING_EVENTDISPATCHER);
+    ASSERT_TRUE(low != NULL);
+
+    // the regular lane runs the periodic updates, the callback itself is left to the low lane
+    tickCount += 100;
+    regular->cb();
+    EXPECT_EQ(0u, invoked.size());
+    EXPECT_EQ(1u, low->dispatched);
+
+    low->cb();
+    ASSERT_EQ(1u, invoked.size());
+    EXPECT_EQ(&callbackA, invoked[0]);
+}
+
+TEST_F(EventLanes, DisabledLaneFallsBackToRegular) {
+    UAVObjHandle obj = UAVObjRegister(OBJ_ID, true, false, false, false, OBJ_SIZE, 0, 0, NULL);
+    UAVObjEvent ev   = { obj, 0, EV_UPDATED, false };
+    DelayedCallbackInfo *regular = laneCallback(CALLBACKINFO_RUNNING_EVENTDISPATCHER);
+
+    EXPECT_EQ(pdTRUE, EventCallbackDispatchPriority(&ev, &callbackA, EV_PRIORITY_CRITICAL));
+    EXPECT_EQ(1u, callbacks.size());
+    regular->cb();
+    ASSERT_EQ(1u, invoked.size());
+    EXPECT_EQ(&callbackA, invoked[0]);
+}
+
+class ObjectIndex : public UAVObjectsTest {};
+
+TEST_F(ObjectIndex, LookupAfterUnorderedRegistration) {
+    static const uint32_t ids[] = { 0x80000000, 0x10000000, 0xF0000000, 0x40000000, 0x20000000, 0xC0000000, 0x00000010 };
+    const size_t count = sizeof(ids) / sizeof(ids[0]);
+    UAVObjHandle objs[count];
+
+    for (size_t i = 0; i < count; i++) {
+        objs[i] = UAVObjRegister(ids[i], true, false, false, false, OBJ_SIZE, 0, 0, NULL);
+        ASSERT_TRUE(objs[i] != NULL);
+        // every object registered so far stays visible
+        for (size_t j = 0; j <= i; j++) {
+            EXPECT_EQ(objs[j], UAVObjGetByID(ids[j]));
+            EXPECT_EQ(UAVObjGetLinkedObj(objs[j]), UAVObjGetByID(MetaObjectId(ids[j])));
+        }
+    }
+
+    EXPECT_TRUE(UAVObjGetByID(0x30000000) == NULL);
+    EXPECT_TRUE(UAVObjRegister(ids[2], true, false, false, false, OBJ_SIZE, 0, 0, NULL) == NULL);
+}
+
+class MultiInstance : public UAVObjectsTest {};
+
+TEST_F(MultiInstance, InstancesInChunks) {
+    // 100 byte instances: the chunks of instance 1 and instances 2-3 fit in the 512 byte arena, not the next one
+    const uint32_t size = 100;
+    UAVObjHandle obj    = UAVObjRegister(OBJ_ID, false, false, false, false, size, 0, 0, NULL);
+    uint8_t data[size];
+
+    ASSERT_TRUE(obj != NULL);
+    for (uint16_t instId = 1; instId < 8; instId++) {
+        EXPECT_EQ(instId, UAVObjCreateInstance(obj, NULL));
+    }
+    EXPECT_EQ(8, UAVObjGetNumInstances(obj));
+
+    for (uint16_t instId = 0; instId < 8; instId++) {
+        memset(data, instId, size);
+        EXPECT_EQ(0, UAVObjSetInstanceData(obj, instId, data));
+    }
+    for (uint16_t instId = 0; instId < 8; instId++) {
+        uint8_t expected[size];
+        memset(expected, instId, size);
+        EXPECT_EQ(0, UAVObjGetInstanceData(obj, instId, data));
+        EXPECT_EQ(0, memcmp(expected, data, size));
+    }
+    EXPECT_EQ(-1, UAVObjGetInstanceData(obj, 8, data));
+
+    // the overflows are counted in instances, not chunks
+    UAVObjStats stats;
+    UAVObjGetStats(&stats);
+    EXPECT_EQ(3 * size, stats.instanceArenaUsed);
+    EXPECT_EQ(4, stats.instanceArenaOverflows);
+}
+
+TEST_F(MultiInstance, PackInstances) {
+    UAVObjHandle multi  = UAVObjRegister(OBJ_ID, false, false, false, false, OBJ_SIZE, 0, 0, NULL);
+    UAVObjHandle single = UAVObjRegister(OBJ_ID + 2, true, false, false, false, OBJ_SIZE, 0, 0, NULL);
+    uint8_t data[8 * OBJ_SIZE];
+
+    ASSERT_TRUE(multi != NULL);
+    ASSERT_TRUE(single != NULL);
+    for (uint16_t instId = 0; instId < 8; instId++) {
+        if (instId > 0) {
+            EXPECT_EQ(instId, UAVObjCreateInstance(multi, NULL));
+        }
+        memset(data, instId, OBJ_SIZE);
+        EXPECT_EQ(0, UAVObjSetInstanceData(multi, instId, data));
+    }
+
+    // instances 1 to 6 span the chunks of instance 1, instances 2-3 and instances 4-7
+    memset(data, 0xFF, sizeof(data));
+    ASSERT_EQ(0, UAVObjPackInstances(multi, 1, 6, data));
+    for (uint16_t n = 0; n < 6; n++) {
+        uint8_t expected[OBJ_SIZE];
+        memset(expected, 1 + n, OBJ_SIZE);
+        EXPECT_EQ(0, memcmp(expected, &data[n * OBJ_SIZE], OBJ_SIZE));
+    }
+    EXPECT_EQ(0xFF, data[6 * OBJ_SIZE]);
+
+    EXPECT_EQ(-1, UAVObjPackInstances(multi, 5, 4, data));
+    EXPECT_EQ(0, UAVObjPackInstances(single, 0, 1, data));
+    EXPECT_EQ(-1, UAVObjPackInstances(single, 0, 2, data));
+}
+
+class UAVTalk : public UAVObjectsTest {
+protected:
+    static std::vector<uint8_t> sent;
+
+    static int32_t outputStream(uint8_t *data, int32_t length)
+    {
+        sent.insert(sent.end(), data, data + length);
+        return length;
+    }
+
+    // Sends all the instances of a new object of the given size, checks the messages are sent in reverse order
+    void sendAllInstances(uint32_t objId, uint16_t size, uint16_t numInst)
+    {
+        UAVObjHandle obj = UAVObjRegister(objId, false, false, false, false, size, 0, 0, NULL);
+        UAVTalkConnection connection = UAVTalkInitialize(&outputStream);
+        std::vector<uint8_t> data(size);
+
+        ASSERT_TRUE(obj != NULL);
+        ASSERT_TRUE(connection != NULL);
+        for (uint16_t instId = 0; instId < numInst; instId++) {
+            if (instId > 0) {
+                ASSERT_EQ(instId, UAVObjCreateInstance(obj, NULL));
+            }
+            memset(&data[0], 0x10 + instId, size);
+            ASSERT_EQ(0, UAVObjSetInstanceData(obj, instId, &data[0]));
+        }
+
+        sent.clear();
+        ASSERT_EQ(0, UAVTalkSendObject(connection, obj, UAVOBJ_ALL_INSTANCES, 0, 0));
+
+        // sync, type, size(2), object ID(4), instance ID(2), data, checksum
+        const size_t length = 10 + size + 1;
+        ASSERT_EQ(numInst * length, sent.size());
+        for (uint16_t n = 0; n < numInst; n++) {
+            const uint8_t *msg = &sent[n * length];
+            uint16_t instId    = numInst - n - 1;
+            EXPECT_EQ(objId, (uint32_t)(msg[4] | (msg[5] << 8) | (msg[6] << 16) | ((uint32_t)msg[7] << 24)));
+            EXPECT_EQ(instId, msg[8] | (msg[9] << 8));
+            for (uint16_t i = 0; i < size; i++) {
+                ASSERT_EQ(0x10 + instId, msg[10 + i]);
+            }
+            EXPECT_EQ(PIOS_CRC_updateCRC(0, msg, length - 1), msg[length - 1]);
+        }
+    }
+};
+
+std::vector<uint8_t> UAVTalk::sent;
+
+TEST_F(UAVTalk, AllInstancesPackedInBatches) {
+    // six instances per batch, the last batch is not full
+    sendAllInstances(OBJ_ID, 10, 8);
+}
+
+TEST_F(UAVTalk, AllInstancesTooLargeForABatch) {
+    sendAllInstances(OBJ_ID, 40, 5);
+}
+
+class EventChannel : public UAVObjectsTest {};
+
+TEST_F(EventChannel, SendReceive) {
+    UAVObjHandle obj = UAVObjRegister(OBJ_ID, false, false, false, false, OBJ_SIZE, 0, 0, NULL);
+    UAVObjEventChannel channel = UAVObjEventChannelCreate(3);
+    UAVObjEvent ev;
+
+    ASSERT_TRUE(obj != NULL);
+    ASSERT_TRUE(channel != NULL);
+    for (uint16_t instId = 1; instId <= 4; instId++) {
+        UAVObjCreateInstance(obj, NULL);
+    }
+    ASSERT_EQ(0, UAVObjConnectChannel(obj, channel, EV_UPDATED_MANUAL));
+    EXPECT_EQ(-1, UAVObjEventChannelReceive(channel, &ev, 0));
+
+    // the length is rounded up to 4 events, the 5th one is counted as an error
+    for (uint16_t instId = 0; instId < 5; instId++) {
+        UAVObjInstanceUpdated(obj, instId);
+    }
+    UAVObjStats stats;
+    UAVObjGetStats(&stats);
+    EXPECT_EQ(1u, stats.eventQueueErrors);
+    EXPECT_EQ((uint32_t)OBJ_ID, stats.lastQueueErrorID);
+
+    for (uint16_t instId = 0; instId < 4; instId++) {
+        ASSERT_EQ(0, UAVObjEventChannelReceive(channel, &ev, 0));
+        EXPECT_EQ(obj, ev.obj);
+        EXPECT_EQ(instId, ev.instId);
+        EXPECT_EQ(EV_UPDATED_MANUAL, ev.event);
+    }
+    EXPECT_EQ(-1, UAVObjEventChannelReceive(channel, &ev, 10));
+
+    // the free running indexes wrap around
+    for (uint32_t n = 0; n < 0x10000; n++) {
+        UAVObjUpdated(obj);
+        ASSERT_EQ(0, UAVObjEventChannelReceive(channel, &ev, 0));
+    }
+
+    ASSERT_EQ(0, UAVObjDisconnectChannel(obj, channel));
+    UAVObjUpdated(obj);
+    EXPECT_EQ(-1, UAVObjEventChannelReceive(channel, &ev, 0));
+}
@@ -0,0 +1,198 @@
+#include "gtest/gtest.h"
+
+#include <algorithm> /* std::min */
+#include <vector>
+
+extern "C" {
+#include "pios.h"
+}
+
+#include "uavtalkstream.h"
+
+#define ATTITUDE_ID 0xD7E0D964
+#define GYRO_ID     0x1E8B4DB2
+#define FLIGHT_ID   0x1A8FE1D8
+
+typedef std::vector<uint8_t> Bytes;
+
+// Encode a frame as the board does, the CRC is computed by PIOS_CRC_updateCRC()
+static Bytes frame(uint8_t type, uint32_t objId, uint16_t instId, const Bytes &data, int timestamp = -1)
+{
+    Bytes f;
+
+    f.push_back(0x3C);
+    f.push_back(timestamp >= 0 ? (type | 0x80) : type);
+    uint16_t length = 10 + (timestamp >= 0 ? 2 : 0) + data.size();
+    f.push_back(length & 0xFF);
+    f.push_back(length >> 8);
+    for (int i = 0; i < 4; i++) {
+        f.push_back((objId >> (8 * i)) & 0xFF);
+    }
+    f.push_back(instId & 0xFF);
+    f.push_back(instId >> 8);
+    if (timestamp >= 0) {
+        f.push_back(timestamp & 0xFF);
+        f.push_back(timestamp >> 8);
+    }
+    f.insert(f.end(), data.begin(), data.end());
+    f.push_back(PIOS_CRC_updateCRC(0, &f[0], f.size()));
+    return f;
+}
+
+static Bytes payload(int size, uint8_t seed)
+{
+    Bytes data(size);
+
+    for (int i = 0; i < size; i++) {
+        data[i] = (uint8_t)(seed + i);
+    }
+    return data;
+}
+
+static Bytes operator+(const Bytes &a, const Bytes &b)
+{
+    Bytes c(a);
+
+    c.insert(c.end(), b.begin(), b.end());
+    return c;
+}
+
+struct Received {
+    uint32_t objId;
+    uint16_t instId;
+    bool     timestamped;
+    uint16_t timestamp;
+    Bytes    data;
+};
+
+static void record(const UAVTalkStreamReader::Update &update, void *context)
+{
+    Received r;
+
+    r.objId       = update.objId;
+    r.instId      = update.instId;
+    r.timestamped = update.timestamped;
+    r.timestamp   = update.timestamp;
+    r.data.assign(update.data, update.data + update.length);
+    static_cast<std::vector<Received> *>(context)->push_back(r);
+}
+
+// To use a test fixture, derive a class from testing::Test.
+class UAVTalkStreamTest : public testing::Test {
+protected:
+    void feed(const Bytes &stream, size_t chunk = 0)
+    {
+        if (chunk == 0) {
+            chunk = stream.size();
+        }
+        for (size_t pos = 0; pos < stream.size(); pos += chunk) {
+            reader.feed(&stream[pos], std::min(chunk, stream.size() - pos));
+        }
+    }
+
+    UAVTalkStreamReader reader;
+    std::vector<Received> received;
+};
+
+TEST_F(UAVTalkStreamTest, single_update) {
+    reader.subscribe(ATTITUDE_ID, record, &received);
+    feed(frame(0x20, ATTITUDE_ID, 0, payload(28, 1)));
+
+    ASSERT_EQ(1u, received.size());
+    EXPECT_EQ((uint32_t)ATTITUDE_ID, received[0].objId);
+    EXPECT_EQ(0, received[0].instId);
+    EXPECT_FALSE(received[0].timestamped);
+    EXPECT_EQ(payload(28, 1), received[0].data);
+    EXPECT_EQ(1u, reader.stats().frames);
+    EXPECT_EQ(0u, reader.stats().crcErrors);
+}
+
+TEST_F(UAVTalkStreamTest, timestamped_update) {
+    reader.subscribe(0, record, &received);
+    feed(frame(0x20, GYRO_ID, 2, payload(16, 7), 0xBEEF));
+
+    ASSERT_EQ(1u, received.size());
+    EXPECT_EQ(2, received[0].instId);
+    EXPECT_TRUE(received[0].timestamped);
+    EXPECT_EQ(0xBEEF, received[0].timestamp);
+    EXPECT_EQ(payload(16, 7), received[0].data);
+}
+
+TEST_F(UAVTalkStreamTest, only_subscribed_objects) {
+    reader.subscribe(GYRO_ID, record, &received);
+    feed(frame(0x20, ATTITUDE_ID, 0, payload(28, 1)) + frame(0x20, GYRO_ID, 0, payload(16, 2)));
+
+    ASSERT_EQ(1u, received.size());
+    EXPECT_EQ((uint32_t)GYRO_ID, received[0].objId);
+    EXPECT_EQ(2u, reader.stats().frames);
+    EXPECT_EQ(1u, reader.stats().updates);
+}
+
+TEST_F(UAVTalkStreamTest, any_chunk_size) {
+    Bytes stream;
+
+    for (int i = 0; i < 20; i++) {
+        stream = stream + frame(0x20, i % 2 ? ATTITUDE_ID : GYRO_ID, 0, payload(i % 2 ? 28 : 16, i), i % 3 ? -1 : i);
+    }
+    reader.subscribe(0, record, &received);
+    for (size_t chunk = 1; chunk <= stream.size(); chunk += 7) {
+        received.clear();
+        feed(stream, chunk);
+        ASSERT_EQ(20u, received.size()) << "chunk " << chunk;
+        EXPECT_EQ(payload(28, 19), received[19].data) << "chunk " << chunk;
+    }
+    EXPECT_EQ(0u, reader.stats().syncErrors);
+}
+
+TEST_F(UAVTalkStreamTest, padding_is_skipped) {
+    reader.subscribe(0, record, &received);
+    feed(Bytes(13, 0xFF) + frame(0x20, GYRO_ID, 0, payload(16, 2)) + Bytes(40, 0xFF) + frame(0x20, GYRO_ID, 0, payload(16, 3)));
+
+    EXPECT_EQ(2u, received.size());
+    EXPECT_EQ(0u, reader.stats().syncErrors);
+}
+
+TEST_F(UAVTalkStreamTest, resync_after_corruption) {
+    Bytes bad = frame(0x20, ATTITUDE_ID, 0, payload(28, 1));
+
+    bad[15] ^= 0x10;
+    reader.subscribe(0, record, &received);
+    feed(Bytes(3, 0x55) + bad + frame(0x20, GYRO_ID, 0, payload(16, 2)));
+
+    ASSERT_EQ(1u, received.size());
+    EXPECT_EQ((uint32_t)GYRO_ID, received[0].objId);
+    EXPECT_EQ(1u, reader.stats().crcErrors);
+    EXPECT_GE(reader.stats().syncErrors, 3u);
+}
+
+TEST_F(UAVTalkStreamTest, bundle_is_split) {
+    Bytes entries;
+    Bytes gyro = frame(0x20, GYRO_ID, 0, payload(16, 2));
+    Bytes flight = frame(0x20, FLIGHT_ID, 1, payload(4, 9));
+
+    // Bundle entries are the object and instance IDs followed by the data
+    entries.insert(entries.end(), gyro.begin() + 4, gyro.end() - 1);
+    entries.insert(entries.end(), flight.begin() + 4, flight.end() - 1);
+
+    reader.subscribe(0, record, &received);
+    feed(frame(0x25, 0, 2, entries));
+    EXPECT_EQ(0u, received.size());
+    EXPECT_EQ(1u, reader.stats().droppedBundles);
+
+    reader.setObjectSize(GYRO_ID, 16);
+    reader.setObjectSize(FLIGHT_ID, 4);
+    feed(frame(0x25, 0, 2, entries));
+    ASSERT_EQ(2u, received.size());
+    EXPECT_EQ(payload(16, 2), received[0].data);
+    EXPECT_EQ((uint32_t)FLIGHT_ID, received[1].objId);
+    EXPECT_EQ(1, received[1].instId);
+    EXPECT_EQ(payload(4, 9), received[1].data);
+}
+
+TEST_F(UAVTalkStreamTest, requests_are_ignored) {
+    reader.subscribe(0, record, &received);
+    feed(frame(0x21, ATTITUDE_ID, 0, Bytes()) + frame(0x23, ATTITUDE_ID, 0, Bytes()));
+
+    EXPECT_EQ(0u, received.size());
+    EXPECT_EQ(2u, reader.stats().frames);
+}
@@ -4,7 +4,8 @@
  * @file       eventdispatcher.c
  * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2010.
  * @brief      Event dispatcher, distributes object events as callbacks. Alternative
- *             to using tasks and queues. All callbacks are invoked from the event task.
+ *             to using tasks and queues. The callbacks are invoked from one scheduler
+ *             callback per priority lane.
  * @see        The GNU Public License (GPL) Version 3
  *
  *****************************************************************************/
@@ -41,9 +42,15 @@
 #define STACK_SIZE           configMINIMAL_STACK_SIZE
 #endif /* PIOS_EVENTDISPATCHER_STACK_SIZE */
 
-#define CALLBACK_PRIORITY    CALLBACK_PRIORITY_CRITICAL
-#define TASK_PRIORITY        CALLBACK_TASK_FLIGHTCONTROL
 #define MAX_UPDATE_PERIOD_MS 1000
+#if defined(PIOS_EVENTDISPATCHER_PERIODIC_POOL)
+#define PERIODIC_POOL_SIZE   PIOS_EVENTDISPATCHER_PERIODIC_POOL
+#else
+#define PERIODIC_POOL_SIZE   32
+#endif
+#define HEAP_INITIAL_SIZE    16
+#define HEAP_INDEX_NONE      0xFFFF
+#define MAX_BATCH_SIZE       8
 
 // Private types
 
@@ -58,6 +65,31 @@ typedef struct {
     bool lowpriority; /** set to true for telemetry and other low priority stuffs, prevent raising warning */
 } EventCallbackInfo;
 
+/**
+ * Priority lane, a queue of callback events drained by its own scheduler callback.
+ * Only the regular lane exists from the start, the others are created on first use.
+ */
+typedef struct {
+    xQueueHandle queue;
+    DelayedCallbackInfo *callback; /** Set once the lane is ready */
+} EventLane;
+
+/**
+ * Scheduling of the lanes. The regular lane keeps the critical scheduler priority
+ * in the flight control task the dispatcher always ran with, the critical lane
+ * preempts it from the higher device driver task. The low lane runs from a lower
+ * priority task and is preempted by both.
+ */
+static const struct {
+    DelayedCallbackPriority     priority;
+    DelayedCallbackPriorityTask task;
+    int16_t callbackID;
+} mLaneConfig[EV_PRIORITY_COUNT] = {
+    [EV_PRIORITY_CRITICAL] = { CALLBACK_PRIORITY_CRITICAL, CALLBACK_TASK_DEVICEDRIVER,  CALLBACKINFO_RUNNING_EVENTDISPATCHER1 },
+    [EV_PRIORITY_REGULAR]  = { CALLBACK_PRIORITY_CRITICAL, CALLBACK_TASK_FLIGHTCONTROL, CALLBACKINFO_RUNNING_EVENTDISPATCHER  },
+    [EV_PRIORITY_LOW]      = { CALLBACK_PRIORITY_LOW,      CALLBACK_TASK_AUXILIARY,     CALLBACKINFO_RUNNING_EVENTDISPATCHER2 },
+};
+
 /**
  * List of object properties that are needed for the periodic updates.
  */
@@ -65,23 +97,34 @@ struct PeriodicObjectListStruct {
     EventCallbackInfo evInfo; /** Event callback information */
     uint16_t updatePeriodMs; /** Update period in ms or 0 if no periodic updates are needed */
     int32_t  timeToNextUpdateMs; /** Time delay to the next update */
+    uint16_t heapIndex; /** Position in the update heap or HEAP_INDEX_NONE if not scheduled */
+    uint8_t  priority; /** Lane the callback is invoked from */
     struct PeriodicObjectListStruct *next; /** Needed by linked list library (utlist.h) */
 };
 typedef struct PeriodicObjectListStruct PeriodicObjectList;
 
 // Private variables
 static PeriodicObjectList *mObjList;
-static xQueueHandle mQueue;
-static DelayedCallbackInfo *eventSchedulerCallback;
+static PeriodicObjectList **mHeap; /** Min-heap of scheduled entries ordered by timeToNextUpdateMs */
+static uint16_t mHeapSize;
+static uint16_t mHeapCapacity;
+static EventLane mLanes[EV_PRIORITY_COUNT];
 static xSemaphoreHandle mMutex;
 static EventStats mStats;
+static struct pios_mempool mPeriodicPool;
 
 // Private functions
 static int32_t processPeriodicUpdates();
 static void eventTask();
-static int32_t eventPeriodicCreate(UAVObjEvent *ev, UAVObjEventCallback cb, xQueueHandle queue, uint16_t periodMs);
+static void eventTaskCritical();
+static void eventTaskLow();
+static bool processLane(EventLane *lane);
+static int32_t eventPeriodicCreate(UAVObjEvent *ev, UAVObjEventCallback cb, xQueueHandle queue, uint16_t periodMs, UAVObjEventPriority priority);
 static int32_t eventPeriodicUpdate(UAVObjEvent *ev, UAVObjEventCallback cb, xQueueHandle queue, uint16_t periodMs);
 static uint16_t randomizePeriod(uint16_t periodMs);
+static void heapUpdate(PeriodicObjectList *objEntry);
+static void heapSiftUp(uint16_t index);
+static void heapSiftDown(uint16_t index);
 
 
 /**
@@ -91,26 +134,86 @@ static uint16_t randomizePeriod(uint16_t periodMs);
 int32_t EventDispatcherInitialize()
 {
     // Initialize variables
-    mObjList = NULL;
+    mObjList      = NULL;
+    mHeap         = NULL;
+    mHeapSize     = 0;
+    mHeapCapacity = 0;
     memset(&mStats, 0, sizeof(EventStats));
 
+    // Periodic entries and the heap to schedule them are sized up front
+    if (PIOS_MEMPOOL_Init(&mPeriodicPool, sizeof(PeriodicObjectList), PERIODIC_POOL_SIZE, false) != 0) {
+        return -1;
+    }
+    if (PERIODIC_POOL_SIZE > 0) {
+        mHeap = (PeriodicObjectList **)pios_malloc(PERIODIC_POOL_SIZE * sizeof(PeriodicObjectList *));
+        if (mHeap == NULL) {
+            return -1;
+        }
+        mHeapCapacity = PERIODIC_POOL_SIZE;
+    }
+
     // Create mMutex
     mMutex = xSemaphoreCreateRecursiveMutex();
     if (mMutex == NULL) {
         return -1;
     }
 
-    // Create event queue
-    mQueue = xQueueCreate(MAX_QUEUE_SIZE, sizeof(EventCallbackInfo));
-
-    // Create callback
-    eventSchedulerCallback = PIOS_CALLBACKSCHEDULER_Create(&eventTask, CALLBACK_PRIORITY, TASK_PRIORITY, CALLBACKINFO_RUNNING_EVENTDISPATCHER, STACK_SIZE * 4);
-    PIOS_CALLBACKSCHEDULER_Dispatch(eventSchedulerCallback);
+    // Create the regular lane, it also runs the periodic updates
+    memset(mLanes, 0, sizeof(mLanes));
+    if (EventDispatcherEnablePriority(EV_PRIORITY_REGULAR) != 0) {
+        return -1;
+    }
+    PIOS_CALLBACKSCHEDULER_Dispatch(mLanes[EV_PRIORITY_REGULAR].callback);
 
     // Done
     return 0;
 }
 
+/**
+ * Create the queue and the scheduler callback of a lane, if not done yet.
+ * Called when a callback is registered in the lane, so the boards only pay
+ * for the lanes their modules use.
+ * \param[in] priority The lane
+ * \return Success (0), failure (-1)
+ */
+int32_t EventDispatcherEnablePriority(UAVObjEventPriority priority)
+{
+    static const DelayedCallback laneTasks[EV_PRIORITY_COUNT] = {
+        [EV_PRIORITY_CRITICAL] = &eventTaskCritical,
+        [EV_PRIORITY_REGULAR]  = &eventTask,
+        [EV_PRIORITY_LOW]      = &eventTaskLow,
+    };
+    EventLane *lane;
+    int32_t result = 0;
+
+    if (priority >= EV_PRIORITY_COUNT) {
+        return -1;
+    }
+    lane = &mLanes[priority];
+    if (lane->callback) {
+        return 0;
+    }
+
+    xSemaphoreTakeRecursive(mMutex, portMAX_DELAY);
+    if (lane->callback == NULL) {
+        if (lane->queue == NULL) {
+            lane->queue = xQueueCreate(MAX_QUEUE_SIZE, sizeof(EventCallbackInfo));
+        }
+        if (lane->queue == NULL) {
+            result = -1;
+        } else {
+            // publish the lane only once its callback exists
+            lane->callback = PIOS_CALLBACKSCHEDULER_Create(laneTasks[priority], mLaneConfig[priority].priority, mLaneConfig[priority].task,
+                                                           mLaneConfig[priority].callbackID, STACK_SIZE * 4);
+            if (lane->callback == NULL) {
+                result = -1;
+            }
+        }
+    }
+    xSemaphoreGiveRecursive(mMutex);
+    return result;
+}
+
 /**
  * Get the statistics counters
  * @param[out] statsOut The statistics counters will be copied there
@@ -119,6 +222,8 @@ void EventGetStats(EventStats *statsOut)
 {
     xSemaphoreTakeRecursive(mMutex, portMAX_DELAY);
     memcpy(statsOut, &mStats, sizeof(EventStats));
+    statsOut->periodicPoolMax = mPeriodicPool.max_used;
+    statsOut->periodicPoolOverflows = mPeriodicPool.overflows;
     xSemaphoreGiveRecursive(mMutex);
 }
 
@@ -140,16 +245,34 @@ void EventClearStats()
  * \return Success (0), failure (-1)
  */
 int32_t EventCallbackDispatch(UAVObjEvent *ev, UAVObjEventCallback cb)
+{
+    return EventCallbackDispatchPriority(ev, cb, EV_PRIORITY_REGULAR);
+}
+
+/**
+ * Dispatch an event by invoking the supplied callback from the given lane. The
+ * event goes to the regular lane if the requested one was never enabled.
+ * \param[in] ev The event to be dispatched
+ * \param[in] cb The callback function
+ * \param[in] priority The lane
+ * \return Success (0), failure (-1)
+ */
+int32_t EventCallbackDispatchPriority(UAVObjEvent *ev, UAVObjEventCallback cb, UAVObjEventPriority priority)
 {
     EventCallbackInfo evInfo;
+    EventLane *lane = &mLanes[EV_PRIORITY_REGULAR];
+
+    if (priority < EV_PRIORITY_COUNT && mLanes[priority].callback) {
+        lane = &mLanes[priority];
+    }
 
     // Initialize event callback information
     memcpy(&evInfo.ev, ev, sizeof(UAVObjEvent));
     evInfo.cb    = cb;
     evInfo.queue = 0;
     // Push to queue
-    int32_t result = xQueueSend(mQueue, &evInfo, 0); // will not block if queue is full
-    PIOS_CALLBACKSCHEDULER_Dispatch(eventSchedulerCallback);
+    int32_t result = xQueueSend(lane->queue, &evInfo, 0); // will not block if queue is full
+    PIOS_CALLBACKSCHEDULER_Dispatch(lane->callback);
     return result;
 }
 
@@ -162,7 +285,23 @@ int32_t EventCallbackDispatch(UAVObjEvent *ev, UAVObjEventCallback cb)
  */
 int32_t EventPeriodicCallbackCreate(UAVObjEvent *ev, UAVObjEventCallback cb, uint16_t periodMs)
 {
-    return eventPeriodicCreate(ev, cb, 0, periodMs);
+    return eventPeriodicCreate(ev, cb, 0, periodMs, EV_PRIORITY_REGULAR);
+}
+
+/**
+ * Dispatch an event at periodic intervals, the callback is invoked from the given lane.
+ * \param[in] ev The event to be dispatched
+ * \param[in] cb The callback to be invoked
+ * \param[in] periodMs The period the event is generated
+ * \param[in] priority The lane
+ * \return Success (0), failure (-1)
+ */
+int32_t EventPeriodicCallbackCreatePriority(UAVObjEvent *ev, UAVObjEventCallback cb, uint16_t periodMs, UAVObjEventPriority priority)
+{
+    if (EventDispatcherEnablePriority(priority) != 0) {
+        return -1;
+    }
+    return eventPeriodicCreate(ev, cb, 0, periodMs, priority);
 }
 
 /**
@@ -186,7 +325,7 @@ int32_t EventPeriodicCallbackUpdate(UAVObjEvent *ev, UAVObjEventCallback cb, uin
  */
 int32_t EventPeriodicQueueCreate(UAVObjEvent *ev, xQueueHandle queue, uint16_t periodMs)
 {
-    return eventPeriodicCreate(ev, 0, queue, periodMs);
+    return eventPeriodicCreate(ev, 0, queue, periodMs, EV_PRIORITY_REGULAR);
 }
 
 /**
@@ -207,9 +346,10 @@ int32_t EventPeriodicQueueUpdate(UAVObjEvent *ev, xQueueHandle queue, uint16_t p
  * \param[in] cb The callback to be invoked or zero if none
  * \param[in] queue The queue or zero if none
  * \param[in] periodMs The period the event is generated
+ * \param[in] priority The lane the callback is invoked from
  * \return Success (0), failure (-1)
  */
-static int32_t eventPeriodicCreate(UAVObjEvent *ev, UAVObjEventCallback cb, xQueueHandle queue, uint16_t periodMs)
+static int32_t eventPeriodicCreate(UAVObjEvent *ev, UAVObjEventCallback cb, xQueueHandle queue, uint16_t periodMs, UAVObjEventPriority priority)
 {
     PeriodicObjectList *objEntry;
 
@@ -228,8 +368,9 @@ static int32_t eventPeriodicCreate(UAVObjEvent *ev, UAVObjEventCallback cb, xQue
         }
     }
     // Create handle
-    objEntry = (PeriodicObjectList *)pios_malloc(sizeof(PeriodicObjectList));
+    objEntry = (PeriodicObjectList *)PIOS_MEMPOOL_Alloc(&mPeriodicPool);
     if (objEntry == NULL) {
+        xSemaphoreGiveRecursive(mMutex);
         return -1;
     }
     objEntry->evInfo.ev.obj      = ev->obj;
@@ -239,8 +380,11 @@ static int32_t eventPeriodicCreate(UAVObjEvent *ev, UAVObjEventCallback cb, xQue
     objEntry->evInfo.queue       = queue;
     objEntry->updatePeriodMs     = periodMs;
     objEntry->timeToNextUpdateMs = randomizePeriod(periodMs); // avoid bunching of updates
-    // Add to list
+    objEntry->heapIndex = HEAP_INDEX_NONE;
+    objEntry->priority  = priority;
+    // Add to list and schedule
     LL_APPEND(mObjList, objEntry);
+    heapUpdate(objEntry);
     // Release lock
     xSemaphoreGiveRecursive(mMutex);
     return 0;
@@ -270,6 +414,7 @@ static int32_t eventPeriodicUpdate(UAVObjEvent *ev, UAVObjEventCallback cb, xQue
             // Object found, update period
             objEntry->updatePeriodMs     = periodMs;
             objEntry->timeToNextUpdateMs = randomizePeriod(periodMs); // avoid bunching of updates
+            heapUpdate(objEntry);
             // Release lock
             xSemaphoreGiveRecursive(mMutex);
             return 0;
@@ -281,42 +426,88 @@ static int32_t eventPeriodicUpdate(UAVObjEvent *ev, UAVObjEventCallback cb, xQue
 }
 
 /**
- * Delayed event callback, responsible of invoking (event) callbacks.
+ * Invoke the callbacks queued in a lane.
+ * \param[in] lane The lane
+ * \return true if events are left in the queue
  */
-static void eventTask()
+static bool processLane(EventLane *lane)
 {
-    static uint32_t timeToNextUpdateMs = 0;
     EventCallbackInfo evInfo;
 
     // Wait for queue message
     int limit = MAX_QUEUE_SIZE;
 
-    while (xQueueReceive(mQueue, &evInfo, 0) == pdTRUE) {
+    while (xQueueReceive(lane->queue, &evInfo, 0) == pdTRUE) {
         // Invoke callback, if any
         if (evInfo.cb != 0) {
             evInfo.cb(&evInfo.ev); // the function is expected to copy the event information
         }
         // limit loop to max queue size to slightly reduce the impact of recursive events
         if (!--limit) {
-            break;
+            return uxQueueMessagesWaiting(lane->queue) > 0;
         }
     }
+    return false;
+}
+
+/**
+ * Delayed event callback of the regular lane, responsible of invoking (event) callbacks
+ * and of the periodic updates.
+ */
+static void eventTask()
+{
+    static uint32_t timeToNextUpdateMs = 0;
+    EventLane *lane = &mLanes[EV_PRIORITY_REGULAR];
+
+    // Come back for the remaining events once the other callbacks had a chance to run
+    if (processLane(lane)) {
+        PIOS_CALLBACKSCHEDULER_Dispatch(lane->callback);
+    }
 
     // Process periodic updates
     if ((xTaskGetTickCount() * portTICK_RATE_MS) >= timeToNextUpdateMs) {
         timeToNextUpdateMs = processPeriodicUpdates();
     }
 
-    PIOS_CALLBACKSCHEDULER_Schedule(eventSchedulerCallback, timeToNextUpdateMs - (xTaskGetTickCount() * portTICK_RATE_MS), CALLBACK_UPDATEMODE_SOONER);
+    PIOS_CALLBACKSCHEDULER_Schedule(lane->callback, timeToNextUpdateMs - (xTaskGetTickCount() * portTICK_RATE_MS), CALLBACK_UPDATEMODE_SOONER);
+}
+
+/**
+ * Delayed event callback of the critical lane
+ */
+static void eventTaskCritical()
+{
+    EventLane *lane = &mLanes[EV_PRIORITY_CRITICAL];
+
+    if (processLane(lane)) {
+        PIOS_CALLBACKSCHEDULER_Dispatch(lane->callback);
+    }
+}
+
+/**
+ * Delayed event callback of the low priority lane
+ */
+static void eventTaskLow()
+{
+    EventLane *lane = &mLanes[EV_PRIORITY_LOW];
+
+    if (processLane(lane)) {
+        PIOS_CALLBACKSCHEDULER_Dispatch(lane->callback);
+    }
 }
 
 /**
  * Handle periodic updates for all objects.
+ * Only the entries that are due are touched, they are taken from the top of the heap.
  * \return The system time until the next update (in ms) or -1 if failed
  */
 static int32_t processPeriodicUpdates()
 {
     PeriodicObjectList *objEntry;
+    PeriodicObjectList *batch[MAX_BATCH_SIZE];
+    uint8_t batchSize = 0;
+    uint32_t errors   = 0;
+    uint32_t lastErrorID = 0;
     int32_t timeNow;
     int32_t timeToNextUpdate;
     int32_t offset;
@@ -324,44 +515,158 @@ static int32_t processPeriodicUpdates()
     // Get lock
     xSemaphoreTakeRecursive(mMutex, portMAX_DELAY);
 
-    // Iterate through each object and update its timer, if zero then transmit object.
-    // Also calculate smallest delay to next update.
-    timeToNextUpdate = xTaskGetTickCount() * portTICK_RATE_MS + MAX_UPDATE_PERIOD_MS;
-    LL_FOREACH(mObjList, objEntry) {
-        // If object is configured for periodic updates
-        if (objEntry->updatePeriodMs > 0) {
-            // Check if time for the next update
-            timeNow = xTaskGetTickCount() * portTICK_RATE_MS;
-            if (objEntry->timeToNextUpdateMs <= timeNow) {
-                // Reset timer
-                offset = (timeNow - objEntry->timeToNextUpdateMs) % objEntry->updatePeriodMs;
-                objEntry->timeToNextUpdateMs = timeNow + objEntry->updatePeriodMs - offset;
-                // Invoke callback, if one
-                if (objEntry->evInfo.cb != 0) {
-                    objEntry->evInfo.cb(&objEntry->evInfo.ev); // the function is expected to copy the event information
-                }
-                // Push event to queue, if one
-                if (objEntry->evInfo.queue != 0) {
-                    if (xQueueSend(objEntry->evInfo.queue, &objEntry->evInfo.ev, 0) != pdTRUE && !objEntry->evInfo.ev.lowPriority) { // do not block if queue is full
-                        if (objEntry->evInfo.ev.obj != NULL) {
-                            mStats.lastErrorID = UAVObjGetID(objEntry->evInfo.ev.obj);
-                        }
-                        ++mStats.eventErrors;
-                    }
+    // Take all due entries from the heap and reset their timers
+    timeNow = xTaskGetTickCount() * portTICK_RATE_MS;
+    while (mHeapSize > 0 && batchSize < MAX_BATCH_SIZE && mHeap[0]->timeToNextUpdateMs <= timeNow) {
+        objEntry = mHeap[0];
+        offset   = (timeNow - objEntry->timeToNextUpdateMs) % objEntry->updatePeriodMs;
+        objEntry->timeToNextUpdateMs = timeNow + objEntry->updatePeriodMs - offset;
+        heapSiftDown(0);
+        batch[batchSize++] = objEntry;
+    }
+
+    // The smallest delay to the next update is at the top of the heap
+    timeToNextUpdate = timeNow + MAX_UPDATE_PERIOD_MS;
+    if (mHeapSize > 0 && mHeap[0]->timeToNextUpdateMs < timeToNextUpdate) {
+        timeToNextUpdate = mHeap[0]->timeToNextUpdateMs; // in the past if the batch was full
+    }
+
+    xSemaphoreGiveRecursive(mMutex);
+
+    // Dispatch the batch without holding the lock, entries are never freed
+    for (uint8_t t = 0; t < batchSize; t++) {
+        objEntry = batch[t];
+        // Invoke callback, if one, the callbacks of the other lanes are queued there
+        if (objEntry->evInfo.cb != 0 && objEntry->priority != EV_PRIORITY_REGULAR) {
+            if (EventCallbackDispatchPriority(&objEntry->evInfo.ev, objEntry->evInfo.cb, (UAVObjEventPriority)objEntry->priority) != pdTRUE
+                && !objEntry->evInfo.ev.lowPriority) {
+                if (objEntry->evInfo.ev.obj != NULL) {
+                    lastErrorID = UAVObjGetID(objEntry->evInfo.ev.obj);
                 }
+                ++errors;
             }
-            // Update minimum delay
-            if (objEntry->timeToNextUpdateMs < timeToNextUpdate) {
-                timeToNextUpdate = objEntry->timeToNextUpdateMs;
+        } else if (objEntry->evInfo.cb != 0) {
+            objEntry->evInfo.cb(&objEntry->evInfo.ev); // the function is expected to copy the event information
+        }
+        // Push event to queue, if one
+        if (objEntry->evInfo.queue != 0) {
+            if (xQueueSend(objEntry->evInfo.queue, &objEntry->evInfo.ev, 0) != pdTRUE && !objEntry->evInfo.ev.lowPriority) { // do not block if queue is full
+                if (objEntry->evInfo.ev.obj != NULL) {
+                    lastErrorID = UAVObjGetID(objEntry->evInfo.ev.obj);
+                }
+                ++errors;
             }
         }
     }
 
+    if (errors) {
+        xSemaphoreTakeRecursive(mMutex, portMAX_DELAY);
+        if (lastErrorID) {
+            mStats.lastErrorID = lastErrorID;
+        }
+        mStats.eventErrors += errors;
+        xSemaphoreGiveRecursive(mMutex);
+    }
+
     // Done
-    xSemaphoreGiveRecursive(mMutex);
     return timeToNextUpdate;
 }
 
+/**
+ * Add, reposition or remove an entry in the update heap after its period or
+ * next update time changed. Must be called with the lock held.
+ * \param[in] objEntry The entry to update
+ */
+static void heapUpdate(PeriodicObjectList *objEntry)
+{
+    uint16_t index = objEntry->heapIndex;
+
+    if (objEntry->updatePeriodMs == 0) {
+        // no periodic updates, remove from the heap by moving the last entry into its place
+        if (index != HEAP_INDEX_NONE) {
+            objEntry->heapIndex = HEAP_INDEX_NONE;
+            if (--mHeapSize > index) {
+                PeriodicObjectList *moved = mHeap[mHeapSize];
+                mHeap[index]     = moved;
+                moved->heapIndex = index;
+                heapSiftUp(index);
+                heapSiftDown(moved->heapIndex);
+            }
+        }
+        return;
+    }
+
+    if (index == HEAP_INDEX_NONE) {
+        // grow the heap if needed
+        if (mHeapSize == mHeapCapacity) {
+            uint16_t newCapacity = mHeapCapacity ? mHeapCapacity * 2 : HEAP_INITIAL_SIZE;
+            PeriodicObjectList **newHeap = (PeriodicObjectList **)pios_malloc(newCapacity * sizeof(PeriodicObjectList *));
+            if (newHeap == NULL) {
+                return; // no periodic updates for this entry
+            }
+            if (mHeap) {
+                memcpy(newHeap, mHeap, mHeapSize * sizeof(PeriodicObjectList *));
+                pios_free(mHeap);
+            }
+            mHeap = newHeap;
+            mHeapCapacity = newCapacity;
+        }
+        index = mHeapSize++;
+        mHeap[index] = objEntry;
+        objEntry->heapIndex = index;
+    }
+    heapSiftUp(index);
+    heapSiftDown(objEntry->heapIndex);
+}
+
+/**
+ * Move a heap entry towards the top while it is due earlier than its parent
+ * \param[in] index Position of the entry
+ */
+static void heapSiftUp(uint16_t index)
+{
+    PeriodicObjectList *objEntry = mHeap[index];
+
+    while (index > 0) {
+        uint16_t parent = (index - 1) / 2;
+        if (mHeap[parent]->timeToNextUpdateMs <= objEntry->timeToNextUpdateMs) {
+            break;
+        }
+        mHeap[index] = mHeap[parent];
+        mHeap[index]->heapIndex = index;
+        index = parent;
+    }
+    mHeap[index] = objEntry;
+    objEntry->heapIndex = index;
+}
+
+/**
+ * Move a heap entry towards the bottom while it is due later than its children
+ * \param[in] index Position of the entry
+ */
+static void heapSiftDown(uint16_t index)
+{
+    PeriodicObjectList *objEntry = mHeap[index];
+
+    while (1) {
+        uint16_t child = 2 * index + 1;
+        if (child >= mHeapSize) {
+            break;
+        }
+        if (child + 1 < mHeapSize && mHeap[child + 1]->timeToNextUpdateMs < mHeap[child]->timeToNextUpdateMs) {
+            child++;
+        }
+        if (objEntry->timeToNextUpdateMs <= mHeap[child]->timeToNextUpdateMs) {
+            break;
+        }
+        mHeap[index] = mHeap[child];
+        mHeap[index]->heapIndex = index;
+        index = child;
+    }
+    mHeap[index] = objEntry;
+    objEntry->heapIndex = index;
+}
+
 /**
  * Return a psedorandom integer from 0 to periodMs
  * Based on the Park-Miller-Carta Pseudo-Random Number Generator
@@ -33,14 +33,19 @@
 typedef struct {
     uint32_t lastErrorID;
     uint32_t eventErrors;
+    uint16_t periodicPoolMax; /** High-water mark of the periodic entries, never cleared */
+    uint16_t periodicPoolOverflows; /** Periodic entries allocated from the heap, never cleared */
 } EventStats;
 
 // Public functions
 int32_t EventDispatcherInitialize();
 void EventGetStats(EventStats *statsOut);
 void EventClearStats();
+int32_t EventDispatcherEnablePriority(UAVObjEventPriority priority);
 int32_t EventCallbackDispatch(UAVObjEvent *ev, UAVObjEventCallback cb);
+int32_t EventCallbackDispatchPriority(UAVObjEvent *ev, UAVObjEventCallback cb, UAVObjEventPriority priority);
 int32_t EventPeriodicCallbackCreate(UAVObjEvent *ev, UAVObjEventCallback cb, uint16_t periodMs);
+int32_t EventPeriodicCallbackCreatePriority(UAVObjEvent *ev, UAVObjEventCallback cb, uint16_t periodMs, UAVObjEventPriority priority);
 int32_t EventPeriodicCallbackUpdate(UAVObjEvent *ev, UAVObjEventCallback cb, uint16_t periodMs);
 int32_t EventPeriodicQueueCreate(UAVObjEvent *ev, xQueueHandle queue, uint16_t periodMs);
 int32_t EventPeriodicQueueUpdate(UAVObjEvent *ev, xQueueHandle queue, uint16_t periodMs);
@@ -45,6 +45,8 @@
 #define UAVOBJ_TELEMETRY_UPDATE_MODE_SHIFT     4
 #define UAVOBJ_GCS_TELEMETRY_UPDATE_MODE_SHIFT 6
 #define UAVOBJ_LOGGING_UPDATE_MODE_SHIFT       8
+#define UAVOBJ_TELEMETRY_TIMESTAMPED_SHIFT     10
+#define UAVOBJ_TELEMETRY_SKIP_UNCHANGED_SHIFT  11
 #define UAVOBJ_UPDATE_MODE_MASK                0x3
 
 typedef void *UAVObjHandle;
@@ -114,6 +116,8 @@ typedef enum {
  *    4-5    telemetryUpdateMode      Update mode used by the telemetry module (UAVObjUpdateMode)
  *    6-7    gcsTelemetryUpdateMode   Update mode used by the GCS (UAVObjUpdateMode)
  *    8-9    loggingUpdateMode        Update mode used by the logging module (UAVObjUpdateMode)
+ *     10    telemetryTimestamped     Defines if the telemetry updates carry the board time (1:timestamped, 0:not timestamped)
+ *     11    telemetrySkipUnchanged   Defines if the periodic updates of unchanged data are skipped, but for a keepalive (1:skip, 0:always send)
  */
 typedef struct {
     uint16_t flags; /** Defines flags for update and logging modes and whether an update should be ACK'd (bits defined above) */
@@ -160,6 +164,12 @@ typedef struct {
     bool lowPriority; /* if true prevents raising warnings */
 } UAVObjEvent;
 
+/**
+ * Event channel handle, a lock free alternative to an event queue for links
+ * where a single task generates the events and a single task consumes them.
+ */
+typedef struct UAVObjEventChannelStruct *UAVObjEventChannel;
+
 /**
  * Event callback, this function is called when an event is invoked. The function
  * will be executed in the event task. The ev parameter should be copied if needed
@@ -167,11 +177,57 @@ typedef struct {
  */
 typedef void (*UAVObjEventCallback)(UAVObjEvent *ev);
 
+/**
+ * Event dispatcher lane an event callback is invoked from. Each lane has its own
+ * queue and scheduler callback, so a callback is never queued behind the events of
+ * a lower lane.
+ */
+typedef enum {
+    EV_PRIORITY_CRITICAL = 0, /** Latency critical callbacks, run before the other lanes */
+    EV_PRIORITY_REGULAR  = 1, /** Default lane, also runs the periodic updates */
+    EV_PRIORITY_LOW = 2 /** Slow or bulk callbacks, run from a lower priority task */
+} UAVObjEventPriority;
+#define EV_PRIORITY_COUNT 3
+
 /**
  * Callback used to initialize the object fields to their default values.
  */
 typedef void (*UAVObjInitializeCallback)(UAVObjHandle obj_handle, uint16_t instId);
 
+/**
+ * Compact representation of an object, sent instead of the full object over the slow links.
+ * The fields are described in order, the float fields with a compact type are quantized to
+ * int8 or int16 (value / scale, rounded and saturated), the other fields are copied as is.
+ */
+typedef enum {
+    UAVOBJ_COMPACT_RAW   = 0, /** Bytes copied as is, size is the number of bytes */
+    UAVOBJ_COMPACT_INT8  = 1, /** Float elements quantized to int8, size is the number of elements */
+    UAVOBJ_COMPACT_INT16 = 2 /** Float elements quantized to int16, size is the number of elements */
+} UAVObjCompactType;
+
+typedef struct {
+    uint16_t offset; /** Offset of the field in the object data */
+    uint16_t size;
+    uint8_t  type; /** UAVObjCompactType */
+    float    scale; /** Value of one quantization step */
+} UAVObjCompactField;
+
+typedef struct UAVObjCompactProfileStruct {
+    UAVObjHandle obj;
+    const UAVObjCompactField *fields;
+    uint8_t  numFields;
+    uint16_t numBytes; /** Size of the compact representation */
+    struct UAVObjCompactProfileStruct *next;
+} UAVObjCompactProfile;
+
+/**
+ * Object read by UAVObjGetSnapshot(), the data of instance 0 is copied to dataOut.
+ */
+typedef struct {
+    UAVObjHandle obj_handle;
+    void *dataOut;
+} UAVObjSnapshotEntry;
+
 /**
  * Event manager statistics
  */
@@ -180,12 +236,17 @@ typedef struct {
     uint32_t eventCallbackErrors;
     uint32_t lastCallbackErrorID;
     uint32_t lastQueueErrorID;
+    uint16_t eventPoolMax; /** High-water mark of the event entries, never cleared */
+    uint16_t eventPoolOverflows; /** Event entries allocated from the heap, never cleared */
+    uint16_t instanceArenaUsed; /** Bytes of instance arena used, never cleared */
+    uint16_t instanceArenaOverflows; /** Instances allocated from the heap, never cleared */
 } UAVObjStats;
 
 int32_t UAVObjInitialize();
 void UAVObjGetStats(UAVObjStats *statsOut);
 void UAVObjClearStats();
-UAVObjHandle UAVObjRegister(uint32_t id, bool isSingleInstance, bool isSettings, bool isPriority, uint32_t num_bytes, UAVObjInitializeCallback initCb);
+UAVObjHandle UAVObjRegister(uint32_t id, bool isSingleInstance, bool isSettings, bool isPriority, bool isHot, uint32_t num_bytes,
+                            uint16_t num_words, uint16_t num_halfwords, UAVObjInitializeCallback initCb);
 UAVObjHandle UAVObjGetByID(uint32_t id);
 uint32_t UAVObjGetID(UAVObjHandle obj);
 uint32_t UAVObjGetNumBytes(UAVObjHandle obj);
@@ -198,10 +259,18 @@ bool UAVObjIsSettings(UAVObjHandle obj);
 bool UAVObjIsPriority(UAVObjHandle obj);
 int32_t UAVObjUnpack(UAVObjHandle obj_handle, uint16_t instId, const uint8_t *dataIn);
 int32_t UAVObjPack(UAVObjHandle obj_handle, uint16_t instId, uint8_t *dataOut);
+int32_t UAVObjPackInstances(UAVObjHandle obj_handle, uint16_t instId, uint16_t count, uint8_t *dataOut);
+uint32_t UAVObjGetInstanceHash(UAVObjHandle obj_handle, uint16_t instId);
+void UAVObjSetCompactProfile(UAVObjHandle obj_handle, UAVObjCompactProfile *profile);
+const UAVObjCompactProfile *UAVObjGetCompactProfile(UAVObjHandle obj_handle);
+int32_t UAVObjPackCompact(UAVObjHandle obj_handle, uint16_t instId, uint8_t *dataOut);
 uint8_t UAVObjUpdateCRC(UAVObjHandle obj_handle, uint16_t instId, uint8_t crc);
 int32_t UAVObjSave(UAVObjHandle obj_handle, uint16_t instId);
 int32_t UAVObjLoad(UAVObjHandle obj_handle, uint16_t instId);
 int32_t UAVObjDelete(UAVObjHandle obj_handle, uint16_t instId);
+int32_t UAVObjBatchBegin();
+int32_t UAVObjBatchSave(UAVObjHandle obj_handle, uint16_t instId);
+int32_t UAVObjBatchCommit();
 int32_t UAVObjSaveSettings();
 int32_t UAVObjLoadSettings();
 int32_t UAVObjDeleteSettings();
@@ -216,6 +285,8 @@ int32_t UAVObjSetInstanceData(UAVObjHandle obj_handle, uint16_t instId, const vo
 int32_t UAVObjSetInstanceDataField(UAVObjHandle obj_handle, uint16_t instId, const void *dataIn, uint32_t offset, uint32_t size);
 int32_t UAVObjGetInstanceData(UAVObjHandle obj_handle, uint16_t instId, void *dataOut);
 int32_t UAVObjGetInstanceDataField(UAVObjHandle obj_handle, uint16_t instId, void *dataOut, uint32_t offset, uint32_t size);
+int32_t UAVObjGetDataFieldLockFree(UAVObjHandle obj_handle, void *dataOut, uint32_t offset, uint32_t size);
+int32_t UAVObjGetSnapshot(const UAVObjSnapshotEntry *entries, uint8_t count);
 int32_t UAVObjSetMetadata(UAVObjHandle obj_handle, const UAVObjMetadata *dataIn);
 int32_t UAVObjGetMetadata(UAVObjHandle obj_handle, UAVObjMetadata *dataOut);
 uint8_t UAVObjGetMetadataAccess(const UAVObjMetadata *dataOut);
@@ -227,6 +298,10 @@ uint8_t UAVObjGetTelemetryAcked(const UAVObjMetadata *dataOut);
 void UAVObjSetTelemetryAcked(UAVObjMetadata *dataOut, uint8_t val);
 uint8_t UAVObjGetGcsTelemetryAcked(const UAVObjMetadata *dataOut);
 void UAVObjSetGcsTelemetryAcked(UAVObjMetadata *dataOut, uint8_t val);
+uint8_t UAVObjGetTelemetryTimestamped(const UAVObjMetadata *dataOut);
+void UAVObjSetTelemetryTimestamped(UAVObjMetadata *dataOut, uint8_t val);
+uint8_t UAVObjGetTelemetrySkipUnchanged(const UAVObjMetadata *dataOut);
+void UAVObjSetTelemetrySkipUnchanged(UAVObjMetadata *dataOut, uint8_t val);
 UAVObjUpdateMode UAVObjGetTelemetryUpdateMode(const UAVObjMetadata *dataOut);
 void UAVObjSetTelemetryUpdateMode(UAVObjMetadata *dataOut, UAVObjUpdateMode val);
 UAVObjUpdateMode UAVObjGetGcsTelemetryUpdateMode(const UAVObjMetadata *dataOut);
@@ -237,7 +312,12 @@ int8_t UAVObjReadOnly(UAVObjHandle obj);
 int32_t UAVObjConnectQueue(UAVObjHandle obj_handle, xQueueHandle queue, uint8_t eventMask);
 int32_t UAVObjDisconnectQueue(UAVObjHandle obj_handle, xQueueHandle queue);
 int32_t UAVObjConnectCallback(UAVObjHandle obj_handle, UAVObjEventCallback cb, uint8_t eventMask);
+int32_t UAVObjConnectCallbackPriority(UAVObjHandle obj_handle, UAVObjEventCallback cb, uint8_t eventMask, UAVObjEventPriority priority);
 int32_t UAVObjDisconnectCallback(UAVObjHandle obj_handle, UAVObjEventCallback cb);
+UAVObjEventChannel UAVObjEventChannelCreate(uint16_t length);
+int32_t UAVObjEventChannelReceive(UAVObjEventChannel channel, UAVObjEvent *ev, uint32_t timeoutMs);
+int32_t UAVObjConnectChannel(UAVObjHandle obj_handle, UAVObjEventChannel channel, uint8_t eventMask);
+int32_t UAVObjDisconnectChannel(UAVObjHandle obj_handle, UAVObjEventChannel channel);
 void UAVObjRequestUpdate(UAVObjHandle obj);
 void UAVObjRequestInstanceUpdate(UAVObjHandle obj_handle, uint16_t instId);
 void UAVObjUpdated(UAVObjHandle obj);
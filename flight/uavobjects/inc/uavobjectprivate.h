@@ -70,9 +70,27 @@ typedef void *InstanceHandle;
 
 struct ObjectEventEntry {
     struct ObjectEventEntry *next;
-    xQueueHandle queue;
+    union {
+        xQueueHandle queue;
+        UAVObjEventChannel channel;
+    };
     UAVObjEventCallback     cb;
     uint8_t eventMask;
+    bool    isChannel; /* true if channel is connected instead of queue */
+    uint8_t priority; /* UAVObjEventPriority of the callback */
+};
+
+/**
+ * Single producer / single consumer ring buffer of events. The producer only
+ * writes head, the consumer only writes tail, so no locking is needed.
+ */
+struct UAVObjEventChannelStruct {
+    UAVObjEvent *buffer;
+    uint16_t    mask; /* length - 1, length is a power of two */
+    uint16_t volatile head; /* next slot to write, free running */
+    uint16_t volatile tail; /* next slot to read, free running */
+    uint8_t volatile  consumerWaiting; /* set by the consumer before it blocks */
+    xSemaphoreHandle  wakeup;
 };
 
 /*
@@ -100,6 +118,7 @@ struct UAVOBase {
         bool isSingle      : 1;
         bool isSettings    : 1;
         bool isPriority    : 1;
+        bool isHot         : 1;
     } flags;
 } __attribute__((packed));
 
@@ -119,34 +138,48 @@ struct UAVOData {
      */
     struct UAVOMeta metaObj;
     uint16_t instance_size;
+    /* Field layout used by the log compression, 32 bit then 16 bit then 8 bit fields */
+    uint16_t num_words;
+    uint16_t num_halfwords;
 } __attribute__((packed, aligned(4)));
 
 /* Augmented type for Single Instance Data UAVO */
 struct UAVOSingle {
     struct UAVOData uavo;
-
-    uint8_t instance0[];
     /*
-     * Additional space will be malloc'd here to hold the
-     * the data for this instance.
+     * Sequence counter guarding instance0 for lock free readers, odd while
+     * a write (always done under the object manager mutex) is in progress.
      */
-} __attribute__((packed));
+    uint32_t volatile seq;
 
-/* Part of a linked list of instances chained off of a multi instance UAVO. */
-struct UAVOMultiInst {
-    struct UAVOMultiInst *next;
-    uint8_t instance[];
+    uint8_t instance0[];
     /*
      * Additional space will be malloc'd here to hold the
      * the data for this instance.
      */
 } __attribute__((packed));
 
+/*
+ * The instances of a multi instance UAVO after instance 0 are stored in chunks
+ * of doubling size, chunk c holding instances 2^c to 2^(c+1) - 1. An instance is
+ * found in constant time and consecutive instances are mostly contiguous.
+ * A chunk is allocated whole when its first instance is created, so up to half
+ * of the reserved slots can be unused: creating instance 64 reserves the 64 slots
+ * of chunk 6 while 65 instances exist. Objects whose instance count is known
+ * (waypoints, path actions) waste the least with a power of two instances.
+ */
+#define UAVOBJ_INSTANCE_CHUNKS 10
+#if (1 << UAVOBJ_INSTANCE_CHUNKS) < UAVOBJ_MAX_INSTANCES
+#error UAVOBJ_INSTANCE_CHUNKS too small for UAVOBJ_MAX_INSTANCES
+#endif
+
 /* Augmented type for Multi Instance Data UAVO */
 struct UAVOMulti {
     struct UAVOData uavo;
     uint16_t num_instances;
-    struct UAVOMultiInst instance0 __attribute__((aligned(4)));
+    uint16_t instance_stride; /* instance size rounded up to a multiple of 4, within a chunk */
+    uint8_t  *chunks[UAVOBJ_INSTANCE_CHUNKS]; /* allocated when their first instance is created */
+    uint8_t  instance0[] __attribute__((aligned(4)));
     /*
      * Additional space will be malloc'd here to hold the
      * the data for instance 0.
@@ -162,7 +195,6 @@ struct UAVOMulti {
 
 /** all information about instances are dependant on object type **/
 #define ObjSingleInstanceDataOffset(obj) ((void *)(&(((struct UAVOSingle *)obj)->instance0)))
-#define InstanceDataOffset(inst)         ((void *)&(((struct UAVOMultiInst *)inst)->instance))
 #define InstanceData(instance)           ((void *)instance)
 
 // Private functions
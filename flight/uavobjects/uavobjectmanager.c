@@ -35,11 +35,40 @@
 #include "pios_struct_helper.h"
 #include "inc/uavobjectprivate.h"
 
+// Lock free field reads retried before falling back to the mutex
+#define UAVOBJ_SEQLOCK_RETRIES 3
+
+// Objects read in one UAVObjGetSnapshot() call
+#define UAVOBJ_SNAPSHOT_MAX_OBJECTS 10
+
+// Event entries reserved at init, per object linked in (telemetry connects each object and its metaobject)
+#if defined(PIOS_UAVOBJ_EVENTS_PER_OBJECT)
+#define UAVOBJ_EVENTS_PER_OBJECT PIOS_UAVOBJ_EVENTS_PER_OBJECT
+#else
+#define UAVOBJ_EVENTS_PER_OBJECT 2
+#endif
+
+// Bytes reserved at init for the additional instances of multi instance objects
+#if defined(PIOS_UAVOBJ_INSTANCE_ARENA_SIZE)
+#define UAVOBJ_INSTANCE_ARENA_SIZE PIOS_UAVOBJ_INSTANCE_ARENA_SIZE
+#else
+#define UAVOBJ_INSTANCE_ARENA_SIZE 512
+#endif
+
 // Private functions
 static InstanceHandle createInstance(struct UAVOData *obj, uint16_t instId);
-static int32_t connectObj(UAVObjHandle obj_handle, xQueueHandle queue, UAVObjEventCallback cb, uint8_t eventMask);
-static int32_t disconnectObj(UAVObjHandle obj_handle, xQueueHandle queue, UAVObjEventCallback cb);
+static uint8_t *multiInstance(struct UAVOMulti *uavo_multi, uint16_t instId, uint16_t *runLength);
+static int32_t connectObj(UAVObjHandle obj_handle, xQueueHandle queue, UAVObjEventChannel channel, UAVObjEventCallback cb, uint8_t eventMask, UAVObjEventPriority priority);
+static int32_t disconnectObj(UAVObjHandle obj_handle, xQueueHandle queue, UAVObjEventChannel channel, UAVObjEventCallback cb);
+static int32_t eventChannelSend(UAVObjEventChannel channel, const UAVObjEvent *ev);
 static void instanceAutoUpdated(UAVObjHandle obj_handle, uint16_t instId);
+static struct UAVOData *lookupIndex(uint32_t id);
+static struct UAVOData *searchIndex(uint32_t id);
+static void seqWriteBegin(struct UAVOData *obj);
+static void seqWriteEnd(struct UAVOData *obj);
+static bool seqReadable(UAVObjHandle obj_handle);
+static bool seqRead(UAVObjHandle obj_handle, void *dataOut, uint32_t offset, uint32_t size);
+static void insertIndex(struct UAVOData *obj);
 
 
 int32_t UAVObjPers_stub(__attribute__((unused)) UAVObjHandle obj_handle, __attribute__((unused))  uint16_t instId)
@@ -49,6 +78,14 @@ int32_t UAVObjPers_stub(__attribute__((unused)) UAVObjHandle obj_handle, __attri
 int32_t UAVObjSave(UAVObjHandle obj_handle, uint16_t instId)  __attribute__((weak, alias("UAVObjPers_stub")));;
 int32_t UAVObjLoad(UAVObjHandle obj_handle, uint16_t instId) __attribute__((weak, alias("UAVObjPers_stub")));
 int32_t UAVObjDelete(UAVObjHandle obj_handle, uint16_t instId) __attribute__((weak, alias("UAVObjPers_stub")));
+int32_t UAVObjBatchSave(UAVObjHandle obj_handle, uint16_t instId) __attribute__((weak, alias("UAVObjPers_stub")));
+
+int32_t UAVObjBatch_stub()
+{
+    return 0;
+}
+int32_t UAVObjBatchBegin() __attribute__((weak, alias("UAVObjBatch_stub")));
+int32_t UAVObjBatchCommit() __attribute__((weak, alias("UAVObjBatch_stub")));
 
 
 // Private variables
@@ -67,6 +104,32 @@ static const UAVObjMetadata defMetadata = {
 
 static UAVObjStats stats;
 
+/*
+ * Event entries come from a pool and additional instances are carved from an arena
+ * (instances are never deleted), both sized at init so that connecting and creating
+ * instances at runtime neither fragments the heap nor depends on its allocation time.
+ * Both fall back to the heap when exhausted.
+ */
+static struct pios_mempool eventPool;
+static uint8_t *instanceArena;
+static uint16_t instanceArenaUsed;
+static uint16_t instanceArenaOverflows;
+
+/*
+ * Sorted (by object ID) index of all registered data objects. It is sized from the
+ * _uavo_handles section at init time, so it can never hold fewer slots than there are
+ * objects linked into the firmware. Entries are only ever inserted (under the mutex).
+ * Lookups binary search it without taking the lock, the sequence counter (odd while
+ * an insertion shifts the entries) tells them when to search again.
+ */
+static struct UAVOData *volatile *uavo_index;
+static volatile uint16_t uavo_index_count;
+static volatile uint32_t uavo_index_seq;
+static uint16_t uavo_index_size;
+
+// Compact profiles of the few objects that define one
+static UAVObjCompactProfile *compactProfiles;
+
 /**
  * Initialize the object manager
  * \return 0 Success
@@ -88,6 +151,30 @@ int32_t UAVObjInitialize()
     memset(__start__uavo_handles, 0,
            (uintptr_t)__stop__uavo_handles - (uintptr_t)__start__uavo_handles);
 
+    // Allocate the lookup index, one slot per uavo handle
+    uavo_index_count = 0;
+    uavo_index_seq   = 0;
+    uavo_index_size  = __stop__uavo_handles - __start__uavo_handles;
+    if (uavo_index_size > 0) {
+        uavo_index = (struct UAVOData *volatile *)pios_malloc(uavo_index_size * sizeof(struct UAVOData *));
+        if (uavo_index == NULL) {
+            return -1;
+        }
+    }
+
+    // Reserve the event entries and the instance arena
+    if (PIOS_MEMPOOL_Init(&eventPool, sizeof(struct ObjectEventEntry), uavo_index_size * UAVOBJ_EVENTS_PER_OBJECT, false) != 0) {
+        return -1;
+    }
+    instanceArenaUsed = 0;
+    instanceArenaOverflows = 0;
+    if (UAVOBJ_INSTANCE_ARENA_SIZE > 0) {
+        instanceArena = (uint8_t *)pios_malloc(UAVOBJ_INSTANCE_ARENA_SIZE);
+        if (instanceArena == NULL) {
+            return -1;
+        }
+    }
+
     // Create mutex
     mutex = xSemaphoreCreateRecursiveMutex();
     if (mutex == NULL) {
@@ -110,6 +197,10 @@ void UAVObjGetStats(UAVObjStats *statsOut)
 {
     xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
     memcpy(statsOut, &stats, sizeof(UAVObjStats));
+    statsOut->eventPoolMax       = eventPool.max_used;
+    statsOut->eventPoolOverflows = eventPool.overflows;
+    statsOut->instanceArenaUsed  = instanceArenaUsed;
+    statsOut->instanceArenaOverflows = instanceArenaOverflows;
     xSemaphoreGiveRecursive(mutex);
 }
 
@@ -141,13 +232,22 @@ static void UAVObjInitMetaData(struct UAVOMeta *obj_meta)
     memset(&(obj_meta->instance0), 0, sizeof(obj_meta->instance0));
 }
 
-static struct UAVOData *UAVObjAllocSingle(uint32_t num_bytes)
+/**
+ * Allocate object memory, from the fast heap for hot objects
+ * (CCM RAM on F4, not shared with the DMA controllers).
+ */
+static void *UAVObjMalloc(size_t size, bool isHot)
+{
+    return isHot ? pios_fastheapmalloc(size) : pios_malloc(size);
+}
+
+static struct UAVOData *UAVObjAllocSingle(uint32_t num_bytes, bool isHot)
 {
     /* Compute the complete size of the object, including the data for a single embedded instance */
     uint32_t object_size = sizeof(struct UAVOSingle) + num_bytes;
 
     /* Allocate the object from the heap */
-    struct UAVOSingle *uavo_single = (struct UAVOSingle *)pios_malloc(object_size);
+    struct UAVOSingle *uavo_single = (struct UAVOSingle *)UAVObjMalloc(object_size, isHot);
 
     if (!uavo_single) {
         return NULL;
@@ -157,7 +257,9 @@ static struct UAVOData *UAVObjAllocSingle(uint32_t num_bytes)
     struct UAVOBase *uavo_base = &(uavo_single->uavo.base);
     memset(uavo_base, 0, sizeof(*uavo_base));
     uavo_base->flags.isSingle = true;
+    uavo_base->flags.isHot    = isHot;
     uavo_base->next_event     = NULL;
+    uavo_single->seq = 0;
 
     /* Clear the instance data carried in the UAVO */
     memset(&(uavo_single->instance0), 0, num_bytes);
@@ -166,13 +268,13 @@ static struct UAVOData *UAVObjAllocSingle(uint32_t num_bytes)
     return &(uavo_single->uavo);
 }
 
-static struct UAVOData *UAVObjAllocMulti(uint32_t num_bytes)
+static struct UAVOData *UAVObjAllocMulti(uint32_t num_bytes, bool isHot)
 {
     /* Compute the complete size of the object, including the data for a single embedded instance */
     uint32_t object_size = sizeof(struct UAVOMulti) + num_bytes;
 
     /* Allocate the object from the heap */
-    struct UAVOMulti *uavo_multi = (struct UAVOMulti *)pios_malloc(object_size);
+    struct UAVOMulti *uavo_multi = (struct UAVOMulti *)UAVObjMalloc(object_size, isHot);
 
     if (!uavo_multi) {
         return NULL;
@@ -182,13 +284,16 @@ static struct UAVOData *UAVObjAllocMulti(uint32_t num_bytes)
     struct UAVOBase *uavo_base = &(uavo_multi->uavo.base);
     memset(uavo_base, 0, sizeof(*uavo_base));
     uavo_base->flags.isSingle = false;
+    uavo_base->flags.isHot    = isHot;
     uavo_base->next_event     = NULL;
 
     /* Set up the type-specific part of the UAVO */
-    uavo_multi->num_instances = 1;
+    uavo_multi->num_instances   = 1;
+    uavo_multi->instance_stride = (num_bytes + 3) & ~3;
+    memset(uavo_multi->chunks, 0, sizeof(uavo_multi->chunks));
 
     /* Clear the multi instance data carried in the UAVO */
-    memset(&(uavo_multi->instance0), 0, sizeof(struct UAVOMultiInst) + num_bytes);
+    memset(uavo_multi->instance0, 0, num_bytes);
 
     /* Give back the generic UAVO part */
     return &(uavo_multi->uavo);
@@ -203,14 +308,19 @@ static struct UAVOData *UAVObjAllocMulti(uint32_t num_bytes)
  * \param[in] id Unique object ID
  * \param[in] isSingleInstance Is this a single instance or multi-instance object
  * \param[in] isSettings Is this a settings object
+ * \param[in] isPriority Is this object sent with priority
+ * \param[in] isHot Place the object data in fast RAM
  * \param[in] numBytes Number of bytes of object data (for one instance)
+ * \param[in] num_words Number of 32 bit field elements, stored first
+ * \param[in] num_halfwords Number of 16 bit field elements, stored after the 32 bit ones
  * \param[in] initCb Default field and metadata initialization function
  * \return Object handle, or NULL if failure.
  * \return
  */
 UAVObjHandle UAVObjRegister(uint32_t id,
-                            bool isSingleInstance, bool isSettings, bool isPriority,
+                            bool isSingleInstance, bool isSettings, bool isPriority, bool isHot,
                             uint32_t num_bytes,
+                            uint16_t num_words, uint16_t num_halfwords,
                             UAVObjInitializeCallback initCb)
 {
     struct UAVOData *uavo_data = NULL;
@@ -224,9 +334,9 @@ UAVObjHandle UAVObjRegister(uint32_t id,
 
     /* Map the various flags to one of the UAVO types we understand */
     if (isSingleInstance) {
-        uavo_data = UAVObjAllocSingle(num_bytes);
+        uavo_data = UAVObjAllocSingle(num_bytes, isHot);
     } else {
-        uavo_data = UAVObjAllocMulti(num_bytes);
+        uavo_data = UAVObjAllocMulti(num_bytes, isHot);
     }
 
     if (!uavo_data) {
@@ -236,6 +346,8 @@ UAVObjHandle UAVObjRegister(uint32_t id,
     /* Fill in the details about this UAVO */
     uavo_data->id = id;
     uavo_data->instance_size = num_bytes;
+    uavo_data->num_words     = num_words;
+    uavo_data->num_halfwords = num_halfwords;
     if (isSettings) {
         uavo_data->base.flags.isSettings = true;
         // settings defaults to being sent with priority
@@ -259,6 +371,9 @@ UAVObjHandle UAVObjRegister(uint32_t id,
         UAVObjLoad((UAVObjHandle)uavo_data, 0);
     }
 
+    /* Make the object visible to UAVObjGetByID */
+    insertIndex(uavo_data);
+
     // fire events for outer object and its embedded meta object
     instanceAutoUpdated((UAVObjHandle)uavo_data, 0);
     instanceAutoUpdated((UAVObjHandle) & (uavo_data->metaObj), 0);
@@ -275,26 +390,105 @@ unlock_exit:
  */
 UAVObjHandle UAVObjGetByID(uint32_t id)
 {
-    UAVObjHandle *found_obj = (UAVObjHandle *)NULL;
+    struct UAVOData *obj;
 
-    // Get lock
-    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+    // Look for a data object first, then for the data object owning the metaobject
+    obj = lookupIndex(id);
+    if (obj) {
+        return (UAVObjHandle)obj;
+    }
+    obj = lookupIndex(id - 1);
+    if (obj && MetaObjectId(obj->id) == id) {
+        return (UAVObjHandle) & (obj->metaObj);
+    }
 
-    // Look for object
-    UAVO_LIST_ITERATE(tmp_obj)
-    if (tmp_obj->id == id) {
-        found_obj = (UAVObjHandle *)tmp_obj;
-        goto unlock_exit;
+    return (UAVObjHandle)NULL;
+}
+
+/**
+ * Look up a data object in the index without taking the mutex.
+ * An insertion running meanwhile can briefly hide an entry from the binary
+ * search (the entries move while the search uses the old count), so a miss
+ * only counts if no insertion started or ended during the search. After a
+ * few retries the mutex is taken to wait for the insertion to complete.
+ * Any entry found is a registered object, so a hit is always valid.
+ * \param[in] id The data object ID
+ * \return The object or NULL if not found.
+ */
+static struct UAVOData *lookupIndex(uint32_t id)
+{
+    struct UAVOData *obj;
+
+    for (uint8_t retry = 0; retry < UAVOBJ_SEQLOCK_RETRIES; retry++) {
+        uint32_t seq = uavo_index_seq;
+        __sync_synchronize();
+        if (seq & 1) {
+            continue;
+        }
+        obj = searchIndex(id);
+        if (obj) {
+            return obj;
+        }
+        __sync_synchronize();
+        if (uavo_index_seq == seq) {
+            return NULL;
+        }
     }
-    if (MetaObjectId(tmp_obj->id) == id) {
-        found_obj = (UAVObjHandle *)&(tmp_obj->metaObj);
-        goto unlock_exit;
+
+    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+    obj = searchIndex(id);
+    xSemaphoreGiveRecursive(mutex);
+    return obj;
+}
+
+/**
+ * Binary search the object index for a data object.
+ * \param[in] id The data object ID
+ * \return The object or NULL if not found.
+ */
+static struct UAVOData *searchIndex(uint32_t id)
+{
+    uint16_t low  = 0;
+    uint16_t high = uavo_index_count;
+
+    while (low < high) {
+        uint16_t mid = low + (high - low) / 2;
+        struct UAVOData *obj = uavo_index[mid];
+        if (obj->id == id) {
+            return obj;
+        } else if (obj->id < id) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
     }
+
+    return NULL;
 }
 
-unlock_exit:
-xSemaphoreGiveRecursive(mutex);
-return found_obj;
+/**
+ * Insert a newly registered data object in the sorted object index.
+ * Must be called with the mutex held. The entries above the insertion point
+ * are shifted up in place, the sequence counter is odd meanwhile so that the
+ * lock free lookups do not trust a miss, see lookupIndex().
+ * \param[in] obj The data object to insert
+ */
+static void insertIndex(struct UAVOData *obj)
+{
+    uint16_t pos = uavo_index_count;
+
+    PIOS_Assert(uavo_index_count < uavo_index_size);
+
+    uavo_index_seq++;
+    __sync_synchronize();
+    while (pos > 0 && uavo_index[pos - 1]->id > obj->id) {
+        uavo_index[pos] = uavo_index[pos - 1];
+        pos--;
+    }
+    uavo_index[pos]  = obj;
+    uavo_index_count = uavo_index_count + 1;
+    __sync_synchronize();
+    uavo_index_seq++;
 }
 
 /**
@@ -533,7 +727,9 @@ int32_t UAVObjUnpack(UAVObjHandle obj_handle, uint16_t instId, const uint8_t *da
             }
         }
         // Set the data
+        seqWriteBegin(obj);
         memcpy(InstanceData(instEntry), dataIn, obj->instance_size);
+        seqWriteEnd(obj);
     }
 
     // Fire event
@@ -589,6 +785,198 @@ unlock_exit:
     return rc;
 }
 
+/**
+ * Pack consecutive instances of an object to a byte array, under a single lock
+ * \param[in] obj The object handle
+ * \param[in] instId The first instance ID
+ * \param[in] count The number of instances
+ * \param[out] dataOut The byte array, count times the object size
+ * \return 0 if success or -1 if failure (one of the instances does not exist)
+ */
+int32_t UAVObjPackInstances(UAVObjHandle obj_handle, uint16_t instId, uint16_t count, uint8_t *dataOut)
+{
+    PIOS_Assert(obj_handle);
+
+    if (UAVObjIsMetaobject(obj_handle) || UAVObjIsSingleInstance(obj_handle)) {
+        return count == 1 ? UAVObjPack(obj_handle, instId, dataOut) : -1;
+    }
+
+    // Lock
+    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+
+    int32_t rc = -1;
+    struct UAVOMulti *uavo_multi = (struct UAVOMulti *)obj_handle;
+    uint16_t size = uavo_multi->uavo.instance_size;
+
+    if ((uint32_t)instId + count > uavo_multi->num_instances) {
+        goto unlock_exit;
+    }
+    // Copy the runs of contiguous instances
+    while (count > 0) {
+        uint16_t run;
+        uint8_t *data = multiInstance(uavo_multi, instId, &run);
+        if (run > count) {
+            run = count;
+        }
+        if (size == uavo_multi->instance_stride) {
+            memcpy(dataOut, data, run * size);
+            dataOut += run * size;
+        } else {
+            for (uint16_t n = 0; n < run; n++) {
+                memcpy(dataOut, data, size);
+                data    += uavo_multi->instance_stride;
+                dataOut += size;
+            }
+        }
+        instId += run;
+        count  -= run;
+    }
+
+    rc = 0;
+
+unlock_exit:
+    xSemaphoreGiveRecursive(mutex);
+    return rc;
+}
+
+/**
+ * Hash the data of an object instance, to tell cheaply whether it changed
+ * \param[in] obj The object handle
+ * \param[in] instId The instance ID, UAVOBJ_ALL_INSTANCES to hash all the instances
+ * \return CRC32 of the data, 0 if the instance does not exist
+ */
+uint32_t UAVObjGetInstanceHash(UAVObjHandle obj_handle, uint16_t instId)
+{
+    PIOS_Assert(obj_handle);
+
+    // Lock
+    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+
+    uint32_t hash = 0;
+
+    if (UAVObjIsMetaobject(obj_handle)) {
+        hash = PIOS_CRC32_calcBlock((const uint8_t *)MetaDataPtr((struct UAVOMeta *)obj_handle), MetaNumBytes);
+    } else {
+        struct UAVOData *obj = (struct UAVOData *)obj_handle;
+        uint16_t first = instId;
+        uint16_t last  = instId;
+
+        if (instId == UAVOBJ_ALL_INSTANCES) {
+            first = 0;
+            last  = UAVObjGetNumInstances(obj_handle) - 1;
+        }
+        for (uint32_t n = first; n <= last; n++) {
+            InstanceHandle instEntry = getInstance(obj, n);
+            if (instEntry == NULL) {
+                break;
+            }
+            // Rotate so that swapping two instances changes the hash
+            hash = ((hash << 1) | (hash >> 31)) ^ PIOS_CRC32_calcBlock(InstanceData(instEntry), obj->instance_size);
+        }
+    }
+
+    xSemaphoreGiveRecursive(mutex);
+    return hash;
+}
+
+/**
+ * Register the compact representation of an object, called by the object initialisation
+ * \param[in] obj The object handle
+ * \param[in] profile The profile, it must stay valid
+ */
+void UAVObjSetCompactProfile(UAVObjHandle obj_handle, UAVObjCompactProfile *profile)
+{
+    PIOS_Assert(obj_handle && profile);
+
+    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+    if (UAVObjGetCompactProfile(obj_handle) == NULL) {
+        profile->obj    = obj_handle;
+        profile->next   = compactProfiles;
+        compactProfiles = profile;
+    }
+    xSemaphoreGiveRecursive(mutex);
+}
+
+/**
+ * Get the compact representation of an object
+ * \param[in] obj The object handle
+ * \return The profile, NULL if the object has none
+ */
+const UAVObjCompactProfile *UAVObjGetCompactProfile(UAVObjHandle obj_handle)
+{
+    for (const UAVObjCompactProfile *profile = compactProfiles; profile; profile = profile->next) {
+        if (profile->obj == obj_handle) {
+            return profile;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Pack the compact representation of an object instance into a byte array
+ * \param[in] obj The object handle
+ * \param[in] instId The instance ID
+ * \param[out] dataOut The byte array, UAVObjGetCompactProfile(obj)->numBytes long
+ * \return 0 if success or -1 if failure (no compact profile or no such instance)
+ */
+int32_t UAVObjPackCompact(UAVObjHandle obj_handle, uint16_t instId, uint8_t *dataOut)
+{
+    PIOS_Assert(obj_handle);
+
+    const UAVObjCompactProfile *profile = UAVObjGetCompactProfile(obj_handle);
+    if (profile == NULL || UAVObjIsMetaobject(obj_handle)) {
+        return -1;
+    }
+
+    // Lock
+    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+
+    int32_t rc = -1;
+    InstanceHandle instEntry = getInstance((struct UAVOData *)obj_handle, instId);
+    if (instEntry == NULL) {
+        goto unlock_exit;
+    }
+
+    const uint8_t *data = (const uint8_t *)InstanceData(instEntry);
+    for (uint8_t n = 0; n < profile->numFields; ++n) {
+        const UAVObjCompactField *field = &profile->fields[n];
+        if (field->type == UAVOBJ_COMPACT_RAW) {
+            memcpy(dataOut, &data[field->offset], field->size);
+            dataOut += field->size;
+            continue;
+        }
+        int32_t max = (field->type == UAVOBJ_COMPACT_INT8) ? INT8_MAX : INT16_MAX;
+        for (uint16_t i = 0; i < field->size; ++i) {
+            float value;
+            memcpy(&value, &data[field->offset + i * sizeof(float)], sizeof(float));
+            value /= field->scale;
+            int32_t quantized;
+            if (value >= max) {
+                quantized = max;
+            } else if (value <= -max) {
+                quantized = -max;
+            } else if (value == value) {
+                quantized = (int32_t)(value + (value >= 0.0f ? 0.5f : -0.5f));
+            } else {
+                // NaN
+                quantized = 0;
+            }
+            if (field->type == UAVOBJ_COMPACT_INT8) {
+                *dataOut++ = (uint8_t)(int8_t)quantized;
+            } else {
+                *dataOut++ = (uint8_t)(quantized & 0xFF);
+                *dataOut++ = (uint8_t)((quantized >> 8) & 0xFF);
+            }
+        }
+    }
+
+    rc = 0;
+
+unlock_exit:
+    xSemaphoreGiveRecursive(mutex);
+    return rc;
+}
+
 /**
  * Update a CRC with an object data
  * \param[in] obj The object handle
@@ -607,7 +995,8 @@ uint8_t UAVObjUpdateCRC(UAVObjHandle obj_handle, uint16_t instId, uint8_t crc)
         if (instId != 0) {
             goto unlock_exit;
         }
-        // TODO
+        // Update crc
+        crc = PIOS_CRC_updateCRC(crc, (uint8_t *)MetaDataPtr((struct UAVOMeta *)obj_handle), (int32_t)MetaNumBytes);
     } else {
         struct UAVOData *obj;
         InstanceHandle instEntry;
@@ -645,7 +1034,8 @@ void UAVObjInstanceWriteToLog(UAVObjHandle obj_handle, uint16_t instId)
         if (instId != 0) {
             goto unlock_exit;
         }
-        PIOS_DEBUGLOG_UAVObject(UAVObjGetID(obj_handle), instId, MetaNumBytes, (uint8_t *)MetaDataPtr((struct UAVOMeta *)obj_handle));
+        // metadata is made of uint16_t fields only
+        PIOS_DEBUGLOG_UAVObject(UAVObjGetID(obj_handle), instId, MetaNumBytes, 0, MetaNumBytes / sizeof(uint16_t), (uint8_t *)MetaDataPtr((struct UAVOMeta *)obj_handle));
     } else {
         struct UAVOData *obj;
         InstanceHandle instEntry;
@@ -659,7 +1049,7 @@ void UAVObjInstanceWriteToLog(UAVObjHandle obj_handle, uint16_t instId)
             goto unlock_exit;
         }
         // Pack data
-        PIOS_DEBUGLOG_UAVObject(UAVObjGetID(obj_handle), instId, obj->instance_size, (uint8_t *)InstanceData(instEntry));
+        PIOS_DEBUGLOG_UAVObject(UAVObjGetID(obj_handle), instId, obj->instance_size, obj->num_words, obj->num_halfwords, (uint8_t *)InstanceData(instEntry));
     }
 
 unlock_exit:
@@ -677,20 +1067,30 @@ int32_t UAVObjSaveSettings()
 
     int32_t rc = -1;
 
+    // Write all settings objects in one flash transaction
+    if (UAVObjBatchBegin() == -1) {
+        goto unlock_exit;
+    }
+
     // Save all settings objects
     UAVO_LIST_ITERATE(obj)
     // Check if this is a settings object
     if (UAVObjIsSettings(obj)) {
         // Save object
-        if (UAVObjSave((UAVObjHandle)obj, 0) ==
+        if (UAVObjBatchSave((UAVObjHandle)obj, 0) ==
             -1) {
-            goto unlock_exit;
+            goto commit_exit;
         }
     }
 }
 
 rc = 0;
 
+commit_exit:
+if (UAVObjBatchCommit() == -1) {
+    rc = -1;
+}
+
 unlock_exit:
 xSemaphoreGiveRecursive(mutex);
 return rc;
@@ -867,6 +1267,12 @@ int32_t UAVObjSetDataField(UAVObjHandle obj_handle, const void *dataIn, uint32_t
  */
 int32_t UAVObjGetData(UAVObjHandle obj_handle, void *dataOut)
 {
+    PIOS_Assert(obj_handle);
+
+    // Single instance data objects are read without the mutex, see UAVObjGetDataFieldLockFree()
+    if (seqReadable(obj_handle) && seqRead(obj_handle, dataOut, 0, ((struct UAVOData *)obj_handle)->instance_size)) {
+        return 0;
+    }
     return UAVObjGetInstanceData(obj_handle, 0, dataOut);
 }
 
@@ -920,7 +1326,9 @@ int32_t UAVObjSetInstanceData(UAVObjHandle obj_handle, uint16_t instId,
             goto unlock_exit;
         }
         // Set data
+        seqWriteBegin(obj);
         memcpy(InstanceData(instEntry), dataIn, obj->instance_size);
+        seqWriteEnd(obj);
     }
 
     // Fire event
@@ -985,7 +1393,9 @@ int32_t UAVObjSetInstanceDataField(UAVObjHandle obj_handle, uint16_t instId, con
         }
 
         // Set data
+        seqWriteBegin(obj);
         memcpy(InstanceData(instEntry) + offset, dataIn, size);
+        seqWriteEnd(obj);
     }
 
 
@@ -1103,6 +1513,100 @@ unlock_exit:
     return rc;
 }
 
+/**
+ * Get a field of a single instance data object without taking the object
+ * manager mutex. Writers bump the object's sequence counter around every
+ * update, the reader retries the copy if it raced with one. After a few
+ * failed attempts (the writer may have been preempted by the reader's task)
+ * it falls back to the locked path, so the priority inheritance of the mutex
+ * lets the writer finish. Settings and multi instance objects always use
+ * the locked path.
+ * \param[in] obj The object handle
+ * \param[out] dataOut The field data
+ * \param[in] offset The offset of the field in the object data
+ * \param[in] size The size of the field
+ * \return 0 if success or -1 if failure
+ */
+int32_t UAVObjGetDataFieldLockFree(UAVObjHandle obj_handle, void *dataOut, uint32_t offset, uint32_t size)
+{
+    PIOS_Assert(obj_handle);
+
+    if (seqReadable(obj_handle)) {
+        if ((size + offset) > ((struct UAVOData *)obj_handle)->instance_size) {
+            return -1;
+        }
+        if (seqRead(obj_handle, dataOut, offset, size)) {
+            return 0;
+        }
+    }
+
+    return UAVObjGetInstanceDataField(obj_handle, 0, dataOut, offset, size);
+}
+
+/**
+ * Get the data of several objects as they were at a single point in time,
+ * i.e. no update of any of them happened while they were copied.
+ * Single instance data objects are copied without the object manager mutex
+ * and the copy is retried if any of their sequence counters moved, after a
+ * few failed attempts (or when the list holds other kinds of objects) all
+ * the objects are copied with the mutex held, which writers also hold.
+ * \param[in] entries The objects and where to copy their data (instance 0)
+ * \param[in] count The number of entries, up to UAVOBJ_SNAPSHOT_MAX_OBJECTS
+ * \return 0 if success or -1 if failure
+ */
+int32_t UAVObjGetSnapshot(const UAVObjSnapshotEntry *entries, uint8_t count)
+{
+    PIOS_Assert(entries && count <= UAVOBJ_SNAPSHOT_MAX_OBJECTS);
+
+    uint32_t seqs[UAVOBJ_SNAPSHOT_MAX_OBJECTS];
+    bool lockFree = true;
+    uint8_t i;
+
+    for (i = 0; i < count; i++) {
+        PIOS_Assert(entries[i].obj_handle);
+        lockFree &= seqReadable(entries[i].obj_handle);
+    }
+
+    for (uint8_t retry = 0; lockFree && retry < UAVOBJ_SEQLOCK_RETRIES; ++retry) {
+        for (i = 0; i < count; i++) {
+            seqs[i] = ((struct UAVOSingle *)entries[i].obj_handle)->seq;
+            if (seqs[i] & 1) {
+                break;
+            }
+        }
+        if (i < count) {
+            continue;
+        }
+        __sync_synchronize();
+        for (i = 0; i < count; i++) {
+            struct UAVOSingle *uavo_single = (struct UAVOSingle *)entries[i].obj_handle;
+            memcpy(entries[i].dataOut, uavo_single->instance0, uavo_single->uavo.instance_size);
+        }
+        __sync_synchronize();
+        for (i = 0; i < count; i++) {
+            if (((struct UAVOSingle *)entries[i].obj_handle)->seq != seqs[i]) {
+                break;
+            }
+        }
+        if (i == count) {
+            return 0;
+        }
+    }
+
+    // The mutex is recursive, the instance reads below nest in it
+    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+
+    int32_t rc = 0;
+    for (i = 0; i < count; i++) {
+        if (UAVObjGetInstanceData(entries[i].obj_handle, 0, entries[i].dataOut) < 0) {
+            rc = -1;
+        }
+    }
+
+    xSemaphoreGiveRecursive(mutex);
+    return rc;
+}
+
 /**
  * Set the object metadata
  * \param[in] obj The object handle
@@ -1244,6 +1748,50 @@ void UAVObjSetGcsTelemetryAcked(UAVObjMetadata *metadata, uint8_t val)
     SET_BITS(metadata->flags, UAVOBJ_GCS_TELEMETRY_ACKED_SHIFT, val, 1);
 }
 
+/**
+ * Get the UAVObject metadata telemetry timestamped member
+ * \param[in] metadata The metadata object
+ * \return the telemetry timestamped boolean
+ */
+uint8_t UAVObjGetTelemetryTimestamped(const UAVObjMetadata *metadata)
+{
+    PIOS_Assert(metadata);
+    return (metadata->flags >> UAVOBJ_TELEMETRY_TIMESTAMPED_SHIFT) & 1;
+}
+
+/**
+ * Set the UAVObject metadata telemetry timestamped member
+ * \param[in] metadata The metadata object
+ * \param[in] val The telemetry timestamped boolean
+ */
+void UAVObjSetTelemetryTimestamped(UAVObjMetadata *metadata, uint8_t val)
+{
+    PIOS_Assert(metadata);
+    SET_BITS(metadata->flags, UAVOBJ_TELEMETRY_TIMESTAMPED_SHIFT, val, 1);
+}
+
+/**
+ * Get the UAVObject metadata telemetry skip unchanged member
+ * \param[in] metadata The metadata object
+ * \return the telemetry skip unchanged boolean
+ */
+uint8_t UAVObjGetTelemetrySkipUnchanged(const UAVObjMetadata *metadata)
+{
+    PIOS_Assert(metadata);
+    return (metadata->flags >> UAVOBJ_TELEMETRY_SKIP_UNCHANGED_SHIFT) & 1;
+}
+
+/**
+ * Set the UAVObject metadata telemetry skip unchanged member
+ * \param[in] metadata The metadata object
+ * \param[in] val The telemetry skip unchanged boolean
+ */
+void UAVObjSetTelemetrySkipUnchanged(UAVObjMetadata *metadata, uint8_t val)
+{
+    PIOS_Assert(metadata);
+    SET_BITS(metadata->flags, UAVOBJ_TELEMETRY_SKIP_UNCHANGED_SHIFT, val, 1);
+}
+
 /**
  * Get the UAVObject metadata telemetry update mode
  * \param[in] metadata The metadata object
@@ -1343,7 +1891,7 @@ int32_t UAVObjConnectQueue(UAVObjHandle obj_handle, xQueueHandle queue,
     PIOS_Assert(queue);
     int32_t res;
     xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
-    res = connectObj(obj_handle, queue, 0, eventMask);
+    res = connectObj(obj_handle, queue, 0, 0, eventMask, EV_PRIORITY_REGULAR);
     xSemaphoreGiveRecursive(mutex);
     return res;
 }
@@ -1360,7 +1908,7 @@ int32_t UAVObjDisconnectQueue(UAVObjHandle obj_handle, xQueueHandle queue)
     PIOS_Assert(queue);
     int32_t res;
     xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
-    res = disconnectObj(obj_handle, queue, 0);
+    res = disconnectObj(obj_handle, queue, 0, 0);
     xSemaphoreGiveRecursive(mutex);
     return res;
 }
@@ -1375,11 +1923,29 @@ int32_t UAVObjDisconnectQueue(UAVObjHandle obj_handle, xQueueHandle queue)
  */
 int32_t UAVObjConnectCallback(UAVObjHandle obj_handle, UAVObjEventCallback cb,
                               uint8_t eventMask)
+{
+    return UAVObjConnectCallbackPriority(obj_handle, cb, eventMask, EV_PRIORITY_REGULAR);
+}
+
+/**
+ * Connect an event callback to the object, invoked from the given event dispatcher lane.
+ * If the callback is already connected then the event mask and the lane are only updated.
+ * \param[in] obj The object handle
+ * \param[in] cb The event callback
+ * \param[in] eventMask The event mask, if EV_MASK_ALL then all events are enabled (e.g. EV_UPDATED | EV_UPDATED_MANUAL)
+ * \param[in] priority The lane, EV_PRIORITY_CRITICAL for the latency critical callbacks
+ * \return 0 if success or -1 if failure
+ */
+int32_t UAVObjConnectCallbackPriority(UAVObjHandle obj_handle, UAVObjEventCallback cb,
+                                      uint8_t eventMask, UAVObjEventPriority priority)
 {
     PIOS_Assert(obj_handle);
     int32_t res;
+    if (EventDispatcherEnablePriority(priority) != 0) {
+        return -1;
+    }
     xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
-    res = connectObj(obj_handle, 0, cb, eventMask);
+    res = connectObj(obj_handle, 0, 0, cb, eventMask, priority);
     xSemaphoreGiveRecursive(mutex);
     return res;
 }
@@ -1395,7 +1961,123 @@ int32_t UAVObjDisconnectCallback(UAVObjHandle obj_handle, UAVObjEventCallback cb
     PIOS_Assert(obj_handle);
     int32_t res;
     xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
-    res = disconnectObj(obj_handle, 0, cb);
+    res = disconnectObj(obj_handle, 0, 0, cb);
+    xSemaphoreGiveRecursive(mutex);
+    return res;
+}
+
+/**
+ * Create an event channel. Unlike a queue, a channel must only ever be fed by a
+ * single task (the one updating the connected objects) and read by a single task.
+ * Sending does not enter a critical section, the consumer is only woken up when
+ * it is blocked in UAVObjEventChannelReceive().
+ * \param[in] length Minimum number of events the channel can hold, rounded up to a power of two
+ * \return The channel handle or NULL if failure
+ */
+UAVObjEventChannel UAVObjEventChannelCreate(uint16_t length)
+{
+    UAVObjEventChannel channel;
+    uint16_t size = 1;
+
+    PIOS_Assert(length > 0 && length <= 0x8000);
+    while (size < length) {
+        size <<= 1;
+    }
+
+    channel = (UAVObjEventChannel)pios_malloc(sizeof(struct UAVObjEventChannelStruct));
+    if (!channel) {
+        return NULL;
+    }
+    channel->buffer = (UAVObjEvent *)pios_malloc(size * sizeof(UAVObjEvent));
+    if (!channel->buffer) {
+        pios_free(channel);
+        return NULL;
+    }
+    vSemaphoreCreateBinary(channel->wakeup);
+    if (!channel->wakeup) {
+        pios_free(channel->buffer);
+        pios_free(channel);
+        return NULL;
+    }
+    // the semaphore is created given, only wakeups should give it
+    xSemaphoreTake(channel->wakeup, 0);
+    channel->mask = size - 1;
+    channel->head = 0;
+    channel->tail = 0;
+    channel->consumerWaiting = 0;
+
+    return channel;
+}
+
+/**
+ * Receive an event from a channel, to be called by the consumer task only.
+ * \param[in] channel The channel
+ * \param[out] ev The received event
+ * \param[in] timeoutMs How long to wait for an event, 0 to poll
+ * \return 0 if an event was received or -1 if the channel is still empty, which can
+ * also happen before the timeout expired, so consumers should simply call again
+ */
+int32_t UAVObjEventChannelReceive(UAVObjEventChannel channel, UAVObjEvent *ev, uint32_t timeoutMs)
+{
+    PIOS_Assert(channel);
+    PIOS_Assert(ev);
+
+    if (channel->head == channel->tail) {
+        if (!timeoutMs) {
+            return -1;
+        }
+        // announce that we are about to block, then check again to not miss an event sent meanwhile
+        channel->consumerWaiting = 1;
+        __sync_synchronize();
+        if (channel->head == channel->tail) {
+            xSemaphoreTake(channel->wakeup, timeoutMs / portTICK_RATE_MS);
+        }
+        channel->consumerWaiting = 0;
+        if (channel->head == channel->tail) {
+            return -1;
+        }
+    }
+
+    // read the event before releasing the slot to the producer
+    *ev = channel->buffer[channel->tail & channel->mask];
+    __sync_synchronize();
+    channel->tail++;
+
+    return 0;
+}
+
+/**
+ * Connect an event channel to the object, if the channel is already connected then the event mask is only updated.
+ * All events matching the event mask will be pushed to the channel.
+ * \param[in] obj The object handle
+ * \param[in] channel The event channel
+ * \param[in] eventMask The event mask, if EV_MASK_ALL then all events are enabled (e.g. EV_UPDATED | EV_UPDATED_MANUAL)
+ * \return 0 if success or -1 if failure
+ */
+int32_t UAVObjConnectChannel(UAVObjHandle obj_handle, UAVObjEventChannel channel, uint8_t eventMask)
+{
+    PIOS_Assert(obj_handle);
+    PIOS_Assert(channel);
+    int32_t res;
+    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+    res = connectObj(obj_handle, 0, channel, 0, eventMask, EV_PRIORITY_REGULAR);
+    xSemaphoreGiveRecursive(mutex);
+    return res;
+}
+
+/**
+ * Disconnect an event channel from the object.
+ * \param[in] obj The object handle
+ * \param[in] channel The event channel
+ * \return 0 if success or -1 if failure
+ */
+int32_t UAVObjDisconnectChannel(UAVObjHandle obj_handle, UAVObjEventChannel channel)
+{
+    PIOS_Assert(obj_handle);
+    PIOS_Assert(channel);
+    int32_t res;
+    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+    res = disconnectObj(obj_handle, 0, channel, 0);
     xSemaphoreGiveRecursive(mutex);
     return res;
 }
@@ -1521,8 +2203,15 @@ int32_t sendEvent(struct UAVOBase *obj, uint16_t instId, UAVObjEventType trigger
 
     LL_FOREACH(obj->next_event, event) {
         if (event->eventMask == 0 || (event->eventMask & triggered_event) != 0) {
+            // Send to channel, lock free
+            if (event->isChannel) {
+                if (eventChannelSend(event->channel, &msg) != 0) {
+                    ++stats.eventQueueErrors;
+                    stats.lastQueueErrorID = UAVObjGetID(obj);
+                }
+            }
             // Send to queue if a valid queue is registered
-            if (event->queue) {
+            else if (event->queue) {
                 // will not block
                 if (xQueueSend(event->queue, &msg, 0) != pdTRUE) {
                     ++stats.eventQueueErrors;
@@ -1533,7 +2222,7 @@ int32_t sendEvent(struct UAVOBase *obj, uint16_t instId, UAVObjEventType trigger
             // Invoke callback (from event task) if a valid one is registered
             if (event->cb) {
                 // invoke callback from the event task, will not block
-                if (EventCallbackDispatch(&msg, event->cb) != pdTRUE) {
+                if (EventCallbackDispatchPriority(&msg, event->cb, (UAVObjEventPriority)event->priority) != pdTRUE) {
                     ++stats.eventCallbackErrors;
                     stats.lastCallbackErrorID = UAVObjGetID(obj);
                 }
@@ -1544,13 +2233,37 @@ int32_t sendEvent(struct UAVOBase *obj, uint16_t instId, UAVObjEventType trigger
     return 0;
 }
 
+/**
+ * Push an event to a channel, producer side
+ * \param[in] channel The channel
+ * \param[in] ev The event
+ * \return 0 if success or -1 if the channel is full
+ */
+static int32_t eventChannelSend(UAVObjEventChannel channel, const UAVObjEvent *ev)
+{
+    uint16_t head = channel->head;
+
+    if ((uint16_t)(head - channel->tail) > channel->mask) {
+        return -1; // full
+    }
+    // write the event before publishing it to the consumer
+    channel->buffer[head & channel->mask] = *ev;
+    __sync_synchronize();
+    channel->head = head + 1;
+    __sync_synchronize();
+    // only signal a consumer that is blocked (or about to block)
+    if (channel->consumerWaiting) {
+        channel->consumerWaiting = 0;
+        xSemaphoreGive(channel->wakeup);
+    }
+    return 0;
+}
+
 /**
  * Create a new object instance, return the instance info or NULL if failure.
  */
 static InstanceHandle createInstance(struct UAVOData *obj, uint16_t instId)
 {
-    struct UAVOMultiInst *instEntry;
-
     /* Don't allow more than one instance for single instance objects */
     if (UAVObjIsSingleInstance(&(obj->base))) {
         PIOS_Assert(0);
@@ -1574,22 +2287,122 @@ static InstanceHandle createInstance(struct UAVOData *obj, uint16_t instId)
         }
     }
 
-    /* Create the actual instance */
-    uint32_t size = sizeof(struct UAVOMultiInst) + obj->instance_size;
-    instEntry = (struct UAVOMultiInst *)pios_malloc(size);
-    if (!instEntry) {
-        return NULL;
+    /*
+     * Create the chunk of the instance when this is its first one, from the arena
+     * if it has room (hot objects stay in fast RAM). The instances are created in
+     * order so the chunk is always the next one.
+     */
+    struct UAVOMulti *uavo_multi = (struct UAVOMulti *)obj;
+    uint8_t chunk = 31 - __builtin_clz(instId);
+    if (uavo_multi->chunks[chunk] == NULL) {
+        uint32_t size = (uint32_t)uavo_multi->instance_stride << chunk;
+        uint8_t *chunkData;
+        if (!obj->base.flags.isHot && instanceArenaUsed + size <= UAVOBJ_INSTANCE_ARENA_SIZE) {
+            chunkData = instanceArena + instanceArenaUsed;
+            instanceArenaUsed += size;
+        } else {
+            chunkData = (uint8_t *)UAVObjMalloc(size, obj->base.flags.isHot);
+            if (!chunkData) {
+                return NULL;
+            }
+        }
+        memset(chunkData, 0, size);
+        uavo_multi->chunks[chunk] = chunkData;
+    }
+
+    // Count the instances the arena could not hold
+    if (!obj->base.flags.isHot
+        && (uavo_multi->chunks[chunk] < instanceArena || uavo_multi->chunks[chunk] >= instanceArena + UAVOBJ_INSTANCE_ARENA_SIZE)) {
+        instanceArenaOverflows++;
     }
-    memset(instEntry, 0, size);
-    LL_APPEND(((struct UAVOMulti *)obj)->instance0.next, instEntry);
 
-    ((struct UAVOMulti *)obj)->num_instances++;
+    uavo_multi->num_instances++;
 
     // Fire event
     instanceAutoUpdated((UAVObjHandle)obj, instId);
 
     // Done
-    return InstanceDataOffset(instEntry);
+    return multiInstance(uavo_multi, instId, NULL);
+}
+
+/**
+ * Locate an existing instance of a multi instance object.
+ * \param[in] uavo_multi The object
+ * \param[in] instId The instance ID, must be below num_instances
+ * \param[out] runLength If not NULL, number of instances stored contiguously from this one
+ * \return The instance data
+ */
+static uint8_t *multiInstance(struct UAVOMulti *uavo_multi, uint16_t instId, uint16_t *runLength)
+{
+    if (instId == 0) {
+        if (runLength) {
+            *runLength = 1;
+        }
+        return uavo_multi->instance0;
+    }
+
+    uint8_t chunk = 31 - __builtin_clz(instId);
+    uint16_t slot = instId - (1 << chunk);
+    if (runLength) {
+        *runLength = (1 << chunk) - slot;
+    }
+    return uavo_multi->chunks[chunk] + slot * uavo_multi->instance_stride;
+}
+
+/**
+ * Mark the start and the end of a write to the data of an object, for the
+ * lock free readers of single instance objects. Must be called with the
+ * mutex held.
+ */
+static void seqWriteBegin(struct UAVOData *obj)
+{
+    if (UAVObjIsSingleInstance(&(obj->base))) {
+        ((struct UAVOSingle *)obj)->seq++;
+        __sync_synchronize();
+    }
+}
+
+static void seqWriteEnd(struct UAVOData *obj)
+{
+    if (UAVObjIsSingleInstance(&(obj->base))) {
+        __sync_synchronize();
+        ((struct UAVOSingle *)obj)->seq++;
+    }
+}
+
+/**
+ * Whether the object can be read without the mutex, settings and multi
+ * instance objects always use the locked path.
+ */
+static bool seqReadable(UAVObjHandle obj_handle)
+{
+    struct UAVOBase *uavo_base = (struct UAVOBase *)obj_handle;
+
+    return uavo_base->flags.isSingle && !uavo_base->flags.isMeta && !uavo_base->flags.isSettings;
+}
+
+/**
+ * Copy data of an object for which seqReadable() holds without taking the
+ * mutex, fails when the copy raced with writers UAVOBJ_SEQLOCK_RETRIES times.
+ * The range must have been checked by the caller.
+ */
+static bool seqRead(UAVObjHandle obj_handle, void *dataOut, uint32_t offset, uint32_t size)
+{
+    struct UAVOSingle *uavo_single = (struct UAVOSingle *)obj_handle;
+
+    for (uint8_t retry = 0; retry < UAVOBJ_SEQLOCK_RETRIES; ++retry) {
+        uint32_t seq = uavo_single->seq;
+        if (seq & 1) {
+            continue;
+        }
+        __sync_synchronize();
+        memcpy(dataOut, &(uavo_single->instance0[offset]), size);
+        __sync_synchronize();
+        if (uavo_single->seq == seq) {
+            return true;
+        }
+    }
+    return false;
 }
 
 /**
@@ -1625,17 +2438,7 @@ InstanceHandle getInstance(struct UAVOData *obj, uint16_t instId)
             return NULL;
         }
 
-        // Look for specified instance ID
-        uint16_t instance = 0;
-        struct UAVOMultiInst *instEntry;
-        LL_FOREACH(&(uavo_multi->instance0), instEntry) {
-            if (instance++ == instId) {
-                /* Found it */
-                return &(instEntry->instance);
-            }
-        }
-        /* Instance was not found */
-        return NULL;
+        return multiInstance(uavo_multi, instId, NULL);
     }
 }
 
@@ -1643,34 +2446,46 @@ InstanceHandle getInstance(struct UAVOData *obj, uint16_t instId)
  * Connect an event queue to the object, if the queue is already connected then the event mask is only updated.
  * \param[in] obj The object handle
  * \param[in] queue The event queue
+ * \param[in] channel The event channel, if not zero it is connected instead of the queue
  * \param[in] cb The event callback
  * \param[in] eventMask The event mask, if EV_MASK_ALL then all events are enabled (e.g. EV_UPDATED | EV_UPDATED_MANUAL)
+ * \param[in] priority The event dispatcher lane the callback is invoked from
  * \return 0 if success or -1 if failure
  */
-static int32_t connectObj(UAVObjHandle obj_handle, xQueueHandle queue,
-                          UAVObjEventCallback cb, uint8_t eventMask)
+static int32_t connectObj(UAVObjHandle obj_handle, xQueueHandle queue, UAVObjEventChannel channel,
+                          UAVObjEventCallback cb, uint8_t eventMask, UAVObjEventPriority priority)
 {
     struct ObjectEventEntry *event;
     struct UAVOBase *obj;
+    bool isChannel = (channel != 0);
 
     // Check that the queue is not already connected, if it is simply update event mask
     obj = (struct UAVOBase *)obj_handle;
     LL_FOREACH(obj->next_event, event) {
-        if (event->queue == queue && event->cb == cb) {
+        if (event->isChannel == isChannel
+            && (isChannel ? (event->channel == channel) : (event->queue == queue))
+            && event->cb == cb) {
             // Already connected, update event mask and return
             event->eventMask = eventMask;
+            event->priority  = priority;
             return 0;
         }
     }
 
     // Add queue to list
-    event = (struct ObjectEventEntry *)pios_malloc(sizeof(struct ObjectEventEntry));
+    event = (struct ObjectEventEntry *)PIOS_MEMPOOL_Alloc(&eventPool);
     if (event == NULL) {
         return -1;
     }
-    event->queue     = queue;
+    if (isChannel) {
+        event->channel = channel;
+    } else {
+        event->queue = queue;
+    }
+    event->isChannel = isChannel;
     event->cb        = cb;
     event->eventMask = eventMask;
+    event->priority  = priority;
     LL_APPEND(obj->next_event, event);
 
     // Done
@@ -1681,22 +2496,25 @@ static int32_t connectObj(UAVObjHandle obj_handle, xQueueHandle queue,
  * Disconnect an event queue from the object
  * \param[in] obj The object handle
  * \param[in] queue The event queue
+ * \param[in] channel The event channel, if not zero it is disconnected instead of the queue
  * \param[in] cb The event callback
  * \return 0 if success or -1 if failure
  */
-static int32_t disconnectObj(UAVObjHandle obj_handle, xQueueHandle queue,
+static int32_t disconnectObj(UAVObjHandle obj_handle, xQueueHandle queue, UAVObjEventChannel channel,
                              UAVObjEventCallback cb)
 {
     struct ObjectEventEntry *event;
     struct UAVOBase *obj;
+    bool isChannel = (channel != 0);
 
     // Find queue and remove it
     obj = (struct UAVOBase *)obj_handle;
     LL_FOREACH(obj->next_event, event) {
-        if ((event->queue == queue
-             && event->cb == cb)) {
+        if (event->isChannel == isChannel
+            && (isChannel ? (event->channel == channel) : (event->queue == queue))
+            && event->cb == cb) {
             LL_DELETE(obj->next_event, event);
-            vPortFree(event);
+            PIOS_MEMPOOL_Free(&eventPool, event);
             return 0;
         }
     }
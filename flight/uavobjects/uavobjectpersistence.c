@@ -30,27 +30,19 @@
 
 extern uintptr_t pios_uavo_settings_fs_id;
 
-/**
- * Save the data of the specified object to the file system (SD card).
- * If the object contains multiple instances, all of them will be saved.
- * A new file with the name of the object will be created.
- * The object data can be restored using the UAVObjLoad function.
- * @param[in] obj The object handle.
- * @param[in] instId The instance ID
- * @return 0 if success or -1 if failure
- */
-int32_t UAVObjSave(UAVObjHandle obj_handle, uint16_t instId)
+/* NOTE: batched saves are only activated by PIOS_FLASHFS_BatchCommit */
+static int32_t saveObject(UAVObjHandle obj_handle, uint16_t instId, bool batched)
 {
     PIOS_Assert(obj_handle);
 
+    uint8_t *data;
+
     if (UAVObjIsMetaobject(obj_handle)) {
         if (instId != 0) {
             return -1;
         }
 
-        if (PIOS_FLASHFS_ObjSave(pios_uavo_settings_fs_id, UAVObjGetID(obj_handle), instId, (uint8_t *)MetaDataPtr((struct UAVOMeta *)obj_handle), UAVObjGetNumBytes(obj_handle)) != 0) {
-            return -1;
-        }
+        data = (uint8_t *)MetaDataPtr((struct UAVOMeta *)obj_handle);
     } else {
         InstanceHandle instEntry = getInstance((struct UAVOData *)obj_handle, instId);
 
@@ -62,13 +54,73 @@ int32_t UAVObjSave(UAVObjHandle obj_handle, uint16_t instId)
             return -1;
         }
 
-        if (PIOS_FLASHFS_ObjSave(pios_uavo_settings_fs_id, UAVObjGetID(obj_handle), instId, InstanceData(instEntry), UAVObjGetNumBytes(obj_handle)) != 0) {
+        data = InstanceData(instEntry);
+    }
+
+    if (batched) {
+        if (PIOS_FLASHFS_BatchSave(pios_uavo_settings_fs_id, UAVObjGetID(obj_handle), instId, data, UAVObjGetNumBytes(obj_handle)) != 0) {
+            return -1;
+        }
+    } else {
+        if (PIOS_FLASHFS_ObjSave(pios_uavo_settings_fs_id, UAVObjGetID(obj_handle), instId, data, UAVObjGetNumBytes(obj_handle)) != 0) {
             return -1;
         }
     }
     return 0;
 }
 
+/**
+ * Save the data of the specified object to the file system (SD card).
+ * If the object contains multiple instances, all of them will be saved.
+ * A new file with the name of the object will be created.
+ * The object data can be restored using the UAVObjLoad function.
+ * @param[in] obj The object handle.
+ * @param[in] instId The instance ID
+ * @return 0 if success or -1 if failure
+ */
+int32_t UAVObjSave(UAVObjHandle obj_handle, uint16_t instId)
+{
+    return saveObject(obj_handle, instId, false);
+}
+
+/**
+ * Start saving several objects in one go, see UAVObjBatchSave.
+ * Other tasks saving or loading objects wait until UAVObjBatchCommit.
+ * @return 0 if success or -1 if failure
+ */
+int32_t UAVObjBatchBegin()
+{
+    if (PIOS_FLASHFS_BatchBegin(pios_uavo_settings_fs_id) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Save the data of the specified object as part of the batch started with UAVObjBatchBegin.
+ * The data is written right away but replaces the previous version only on UAVObjBatchCommit.
+ * @param[in] obj The object handle.
+ * @param[in] instId The instance ID
+ * @return 0 if success or -1 if failure
+ */
+int32_t UAVObjBatchSave(UAVObjHandle obj_handle, uint16_t instId)
+{
+    return saveObject(obj_handle, instId, true);
+}
+
+/**
+ * Make all objects saved since UAVObjBatchBegin the current versions.
+ * Must be called even if one of the saves failed.
+ * @return 0 if success or -1 if failure
+ */
+int32_t UAVObjBatchCommit()
+{
+    if (PIOS_FLASHFS_BatchCommit(pios_uavo_settings_fs_id) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
 
 /**
  * Load an object from the file system (SD card).
@@ -31,6 +31,10 @@
 
 // Public types
 typedef int32_t (*UAVTalkOutputStream)(uint8_t *data, int32_t length);
+// Optional in-place output: reserve returns room for length bytes or NULL,
+// commit sends the reserved bytes (length 0 drops the reservation)
+typedef uint8_t *(*UAVTalkOutputReserve)(uint16_t length);
+typedef int32_t (*UAVTalkOutputCommit)(uint16_t length);
 
 typedef struct {
     uint32_t txBytes;
@@ -54,11 +58,18 @@ typedef enum { UAVTALK_STATE_ERROR = 0, UAVTALK_STATE_SYNC, UAVTALK_STATE_TYPE,
 UAVTalkConnection UAVTalkInitialize(UAVTalkOutputStream outputStream);
 int32_t UAVTalkSetOutputStream(UAVTalkConnection connection, UAVTalkOutputStream outputStream);
 UAVTalkOutputStream UAVTalkGetOutputStream(UAVTalkConnection connection);
+int32_t UAVTalkSetOutputReserve(UAVTalkConnection connection, UAVTalkOutputReserve reserve, UAVTalkOutputCommit commit);
 int32_t UAVTalkSendObject(UAVTalkConnection connection, UAVObjHandle obj, uint16_t instId, uint8_t acked, int32_t timeoutMs);
 int32_t UAVTalkSendObjectTimestamped(UAVTalkConnection connectionHandle, UAVObjHandle obj, uint16_t instId, uint8_t acked, int32_t timeoutMs);
 int32_t UAVTalkSendObjectRequest(UAVTalkConnection connection, UAVObjHandle obj, uint16_t instId, int32_t timeoutMs);
+int32_t UAVTalkSendObjectBundled(UAVTalkConnection connection, UAVObjHandle obj, uint16_t instId);
+int32_t UAVTalkSendObjectCompact(UAVTalkConnection connection, UAVObjHandle obj, uint16_t instId);
+int32_t UAVTalkFlushBundle(UAVTalkConnection connection);
+bool UAVTalkIsLossTolerant(const uint8_t *frame, uint16_t length);
 UAVTalkRxState UAVTalkProcessInputStream(UAVTalkConnection connection, uint8_t rxbyte);
 UAVTalkRxState UAVTalkProcessInputStreamQuiet(UAVTalkConnection connection, uint8_t rxbyte);
+UAVTalkRxState UAVTalkProcessInputBuffer(UAVTalkConnection connection, const uint8_t *rxbuffer, uint16_t length);
+UAVTalkRxState UAVTalkProcessInputBufferQuiet(UAVTalkConnection connection, const uint8_t *rxbuffer, uint16_t length, uint16_t *position);
 int32_t UAVTalkRelayPacket(UAVTalkConnection inConnectionHandle, UAVTalkConnection outConnectionHandle);
 int32_t UAVTalkReceiveObject(UAVTalkConnection connectionHandle);
 void UAVTalkGetStats(UAVTalkConnection connection, UAVTalkStats *stats, bool reset);
@@ -66,6 +77,7 @@ void UAVTalkAddStats(UAVTalkConnection connection, UAVTalkStats *stats, bool res
 void UAVTalkResetStats(UAVTalkConnection connection);
 void UAVTalkGetLastTimestamp(UAVTalkConnection connection, uint16_t *timestamp);
 uint32_t UAVTalkGetPacketObjId(UAVTalkConnection connection);
+uint8_t UAVTalkGetPacketType(UAVTalkConnection connection);
 
 #endif // UAVTALK_H
 /**
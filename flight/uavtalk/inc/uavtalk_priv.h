@@ -46,6 +46,12 @@
 #define UAVTALK_MIN_PACKET_LENGTH  UAVTALK_MAX_HEADER_LENGTH + UAVTALK_CHECKSUM_LENGTH
 #define UAVTALK_MAX_PACKET_LENGTH  UAVTALK_MIN_PACKET_LENGTH + UAVTALK_MAX_PAYLOAD_LENGTH
 
+// bundle entry header : object ID(4), instance ID(2)
+#define UAVTALK_BUNDLE_ENTRY_HEADER_LENGTH 6
+
+// max bundle payload, kept small enough to be relayed by boards with a smaller object set (OPLink)
+#define UAVTALK_MAX_BUNDLE_LENGTH  64
+
 typedef struct {
     uint8_t  type;
     uint16_t packet_size;
@@ -63,6 +69,8 @@ typedef struct {
 typedef struct {
     uint8_t canari;
     UAVTalkOutputStream outStream;
+    UAVTalkOutputReserve outReserve;
+    UAVTalkOutputCommit  outCommit;
     xSemaphoreHandle    lock;
     xSemaphoreHandle    transLock;
     xSemaphoreHandle    respSema;
@@ -73,6 +81,9 @@ typedef struct {
     UAVTalkInputProcessor iproc;
     uint8_t      *rxBuffer;
     uint8_t      *txBuffer;
+    uint8_t      *bundleBuffer;
+    uint16_t     bundleLength;
+    uint16_t     bundleCount;
 } UAVTalkConnectionData;
 
 #define UAVTALK_CANARI          0xCA
@@ -86,6 +97,8 @@ typedef struct {
 #define UAVTALK_TYPE_OBJ_ACK    (UAVTALK_TYPE_VER | 0x02)
 #define UAVTALK_TYPE_ACK        (UAVTALK_TYPE_VER | 0x03)
 #define UAVTALK_TYPE_NACK       (UAVTALK_TYPE_VER | 0x04)
+#define UAVTALK_TYPE_BUNDLE     (UAVTALK_TYPE_VER | 0x05)
+#define UAVTALK_TYPE_OBJ_COMPACT (UAVTALK_TYPE_VER | 0x06)
 #define UAVTALK_TYPE_OBJ_TS     (UAVTALK_TIMESTAMPED | UAVTALK_TYPE_OBJ)
 #define UAVTALK_TYPE_OBJ_ACK_TS (UAVTALK_TIMESTAMPED | UAVTALK_TYPE_OBJ_ACK)
 
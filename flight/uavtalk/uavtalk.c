@@ -50,9 +50,15 @@
 // Private functions
 static int32_t objectTransaction(UAVTalkConnectionData *connection, uint8_t type, UAVObjHandle obj, uint16_t instId, int32_t timeout);
 static int32_t sendObject(UAVTalkConnectionData *connection, uint8_t type, uint32_t objId, uint16_t instId, UAVObjHandle obj);
-static int32_t sendSingleObject(UAVTalkConnectionData *connection, uint8_t type, uint32_t objId, uint16_t instId, UAVObjHandle obj);
+static int32_t sendSingleObject(UAVTalkConnectionData *connection, uint8_t type, uint32_t objId, uint16_t instId, UAVObjHandle obj, const uint8_t *data);
+static int32_t sendAllInstances(UAVTalkConnectionData *connection, uint8_t type, uint32_t objId, uint16_t numInst, UAVObjHandle obj);
 static int32_t receiveObject(UAVTalkConnectionData *connection, uint8_t type, uint32_t objId, uint16_t instId, uint8_t *data);
+static int32_t receiveBundle(UAVTalkConnectionData *connection, uint16_t count, uint8_t *data, uint32_t length);
+static int32_t flushBundle(UAVTalkConnectionData *connection);
 static void updateAck(UAVTalkConnectionData *connection, uint8_t type, uint32_t objId, uint16_t instId);
+static uint8_t *txAcquire(UAVTalkConnectionData *connection, uint16_t length);
+static int32_t txSend(UAVTalkConnectionData *connection, uint8_t *buf, uint16_t length);
+static void txRelease(UAVTalkConnectionData *connection, uint8_t *buf);
 
 /**
  * Initialize the UAVTalk library
@@ -73,6 +79,8 @@ UAVTalkConnection UAVTalkInitialize(UAVTalkOutputStream outputStream)
     connection->iproc.rxPacketLength = 0;
     connection->iproc.state = UAVTALK_STATE_SYNC;
     connection->outStream   = outputStream;
+    connection->outReserve  = NULL;
+    connection->outCommit   = NULL;
     connection->lock = xSemaphoreCreateRecursiveMutex();
     connection->transLock   = xSemaphoreCreateRecursiveMutex();
     // allocate buffers
@@ -84,6 +92,10 @@ UAVTalkConnection UAVTalkInitialize(UAVTalkOutputStream outputStream)
     if (!connection->txBuffer) {
         return 0;
     }
+    // bundle buffer is allocated on first use
+    connection->bundleBuffer = NULL;
+    connection->bundleLength = 0;
+    connection->bundleCount  = 0;
     vSemaphoreCreateBinary(connection->respSema);
     xSemaphoreTake(connection->respSema, 0); // reset to zero
     UAVTalkResetStats((UAVTalkConnection)connection);
@@ -115,6 +127,38 @@ int32_t UAVTalkSetOutputStream(UAVTalkConnection connectionHandle, UAVTalkOutput
     return 0;
 }
 
+/**
+ * Set the optional in-place output, used to build packets directly in the
+ * output buffer instead of copying them out of the connection buffer.
+ * The output stream is still used whenever reserve returns NULL.
+ * \param[in] connection UAVTalkConnection to be used
+ * \param[in] reserve Function pointer that reserves room in the output, NULL to disable
+ * \param[in] commit Function pointer that sends the reserved bytes
+ * \return 0 Success
+ * \return -1 Failure
+ */
+int32_t UAVTalkSetOutputReserve(UAVTalkConnection connectionHandle, UAVTalkOutputReserve reserve, UAVTalkOutputCommit commit)
+{
+    UAVTalkConnectionData *connection;
+
+    CHECKCONHANDLE(connectionHandle, connection, return -1);
+
+    if (reserve && !commit) {
+        return -1;
+    }
+
+    // Lock
+    xSemaphoreTakeRecursive(connection->lock, portMAX_DELAY);
+
+    connection->outReserve = reserve;
+    connection->outCommit  = commit;
+
+    // Release lock
+    xSemaphoreGiveRecursive(connection->lock);
+
+    return 0;
+}
+
 /**
  * Get current output stream
  * \param[in] connection UAVTalkConnection to be used
@@ -265,6 +309,127 @@ int32_t UAVTalkSendObject(UAVTalkConnection connectionHandle, UAVObjHandle obj,
     }
 }
 
+/**
+ * Queue an update of the specified object to be sent in a bundle with other updates.
+ * The bundle is sent when it is full, when another message is sent or when
+ * UAVTalkFlushBundle() is called. Updates that do not fit in a bundle are sent immediately.
+ * \param[in] connection UAVTalkConnection to be used
+ * \param[in] obj Object to send
+ * \param[in] instId The instance ID or UAVOBJ_ALL_INSTANCES for all instances.
+ * \return 0 Success
+ * \return -1 Failure
+ */
+int32_t UAVTalkSendObjectBundled(UAVTalkConnection connectionHandle, UAVObjHandle obj, uint16_t instId)
+{
+    UAVTalkConnectionData *connection;
+
+    CHECKCONHANDLE(connectionHandle, connection, return -1);
+
+    uint32_t length = UAVObjGetNumBytes(obj);
+    if (instId == UAVOBJ_ALL_INSTANCES || length + UAVTALK_BUNDLE_ENTRY_HEADER_LENGTH > UAVTALK_MAX_BUNDLE_LENGTH) {
+        return objectTransaction(connection, UAVTALK_TYPE_OBJ, obj, instId, 0);
+    }
+
+    // Lock
+    xSemaphoreTakeRecursive(connection->lock, portMAX_DELAY);
+
+    if (!connection->bundleBuffer) {
+        connection->bundleBuffer = pios_malloc(UAVTALK_MAX_BUNDLE_LENGTH);
+        if (!connection->bundleBuffer) {
+            xSemaphoreGiveRecursive(connection->lock);
+            return objectTransaction(connection, UAVTALK_TYPE_OBJ, obj, instId, 0);
+        }
+    }
+
+    // Make room for the update, a failure to send the previous updates is accounted in the stats
+    int32_t ret = 0;
+    if (connection->bundleLength + UAVTALK_BUNDLE_ENTRY_HEADER_LENGTH + length > UAVTALK_MAX_BUNDLE_LENGTH) {
+        flushBundle(connection);
+    }
+
+    // Append object ID, instance ID and data
+    uint32_t objId = UAVObjGetID(obj);
+    uint8_t *entry = &connection->bundleBuffer[connection->bundleLength];
+    entry[0] = (uint8_t)(objId & 0xFF);
+    entry[1] = (uint8_t)((objId >> 8) & 0xFF);
+    entry[2] = (uint8_t)((objId >> 16) & 0xFF);
+    entry[3] = (uint8_t)((objId >> 24) & 0xFF);
+    entry[4] = (uint8_t)(instId & 0xFF);
+    entry[5] = (uint8_t)((instId >> 8) & 0xFF);
+    if (UAVObjPack(obj, instId, &entry[UAVTALK_BUNDLE_ENTRY_HEADER_LENGTH]) == -1) {
+        connection->stats.txErrors++;
+        ret = -1;
+    } else {
+        connection->bundleLength += UAVTALK_BUNDLE_ENTRY_HEADER_LENGTH + length;
+        connection->bundleCount++;
+    }
+
+    // Release lock
+    xSemaphoreGiveRecursive(connection->lock);
+
+    return ret;
+}
+
+/**
+ * Send the compact representation of the specified object, the object must have a compact profile.
+ * The compact updates are not acknowledged and not bundled.
+ * \param[in] connection UAVTalkConnection to be used
+ * \param[in] obj Object to send
+ * \param[in] instId The instance ID (can NOT be UAVOBJ_ALL_INSTANCES)
+ * \return 0 Success
+ * \return -1 Failure
+ */
+int32_t UAVTalkSendObjectCompact(UAVTalkConnection connectionHandle, UAVObjHandle obj, uint16_t instId)
+{
+    UAVTalkConnectionData *connection;
+
+    CHECKCONHANDLE(connectionHandle, connection, return -1);
+
+    if (instId == UAVOBJ_ALL_INSTANCES || UAVObjGetCompactProfile(obj) == NULL) {
+        return -1;
+    }
+
+    return objectTransaction(connection, UAVTALK_TYPE_OBJ_COMPACT, obj, instId, 0);
+}
+
+/**
+ * Send the pending bundled updates, if any.
+ * \param[in] connection UAVTalkConnection to be used
+ * \return 0 Success
+ * \return -1 Failure
+ */
+int32_t UAVTalkFlushBundle(UAVTalkConnection connectionHandle)
+{
+    UAVTalkConnectionData *connection;
+
+    CHECKCONHANDLE(connectionHandle, connection, return -1);
+
+    // Lock
+    xSemaphoreTakeRecursive(connection->lock, portMAX_DELAY);
+
+    int32_t ret = flushBundle(connection);
+
+    // Release lock
+    xSemaphoreGiveRecursive(connection->lock);
+
+    return ret;
+}
+
+/**
+ * Check whether a frame built by UAVTalk only carries updates that are not acknowledged,
+ * a link can drop those when it runs out of bandwidth.
+ * \param[in] frame The frame, as passed to the output stream
+ * \param[in] length Length of the frame
+ * \return true if the frame can be dropped
+ */
+bool UAVTalkIsLossTolerant(const uint8_t *frame, uint16_t length)
+{
+    if (length < UAVTALK_MIN_HEADER_LENGTH || frame[0] != UAVTALK_SYNC_VAL) {
+        return false;
+    }
+    return frame[1] == UAVTALK_TYPE_OBJ || frame[1] == UAVTALK_TYPE_OBJ_TS || frame[1] == UAVTALK_TYPE_BUNDLE || frame[1] == UAVTALK_TYPE_OBJ_COMPACT;
+}
+
 /**
  * Send the specified object through the telemetry link with a timestamp.
  * \param[in] connection UAVTalkConnection to be used
@@ -317,6 +482,8 @@ static int32_t objectTransaction(UAVTalkConnectionData *connection, uint8_t type
         connection->respType   = (type == UAVTALK_TYPE_OBJ_REQ) ? UAVTALK_TYPE_OBJ : UAVTALK_TYPE_ACK;
         connection->respObjId  = UAVObjGetID(obj);
         connection->respInstId = instId;
+        // Keep messages in order
+        flushBundle(connection);
         ret = sendObject(connection, type, UAVObjGetID(obj), instId, obj);
         xSemaphoreGiveRecursive(connection->lock);
         // Wait for response (or timeout) if sending the object succeeded
@@ -339,8 +506,10 @@ static int32_t objectTransaction(UAVTalkConnectionData *connection, uint8_t type
             xSemaphoreGiveRecursive(connection->transLock);
             return -1;
         }
-    } else if (type == UAVTALK_TYPE_OBJ || type == UAVTALK_TYPE_OBJ_TS) {
+    } else if (type == UAVTALK_TYPE_OBJ || type == UAVTALK_TYPE_OBJ_TS || type == UAVTALK_TYPE_OBJ_COMPACT) {
         xSemaphoreTakeRecursive(connection->lock, portMAX_DELAY);
+        // Keep messages in order
+        flushBundle(connection);
         ret = sendObject(connection, type, UAVObjGetID(obj), instId, obj);
         xSemaphoreGiveRecursive(connection->lock);
     }
@@ -589,6 +758,97 @@ UAVTalkRxState UAVTalkProcessInputStream(UAVTalkConnection connectionHandle, uin
     return state;
 }
 
+/**
+ * Process a block of bytes from the telemetry stream.
+ * This is equivalent to calling UAVTalkProcessInputStreamQuiet() for each byte, but the
+ * bytes preceding a sync byte are skipped at once and the payload is copied and checked
+ * in one pass, only the header is parsed byte per byte.
+ * The processing stops after a complete packet so that the caller can handle it before
+ * calling again with the remaining bytes.
+ * \param[in] connectionHandle UAVTalkConnection to be used
+ * \param[in] rxbuffer Received bytes
+ * \param[in] length Number of received bytes
+ * \param[out] position Number of bytes processed
+ * \return UAVTalkRxState after the last byte processed
+ */
+UAVTalkRxState UAVTalkProcessInputBufferQuiet(UAVTalkConnection connectionHandle, const uint8_t *rxbuffer, uint16_t length, uint16_t *position)
+{
+    UAVTalkConnectionData *connection;
+
+    *position = 0;
+    CHECKCONHANDLE(connectionHandle, connection, return -1);
+
+    UAVTalkInputProcessor *iproc = &connection->iproc;
+    uint16_t pos = 0;
+
+    while (pos < length) {
+        if (iproc->state == UAVTALK_STATE_SYNC || iproc->state == UAVTALK_STATE_ERROR || iproc->state == UAVTALK_STATE_COMPLETE) {
+            // Skip the garbage up to the next sync byte
+            const uint8_t *sync = memchr(&rxbuffer[pos], UAVTALK_SYNC_VAL, length - pos);
+            uint16_t skipped    = sync ? (uint16_t)(sync - &rxbuffer[pos]) : length - pos;
+            if (skipped > 0) {
+                connection->stats.rxBytes      += skipped;
+                connection->stats.rxSyncErrors += skipped;
+                iproc->state = UAVTALK_STATE_SYNC;
+                pos += skipped;
+                continue;
+            }
+        } else if (iproc->state == UAVTALK_STATE_DATA) {
+            // Copy the payload available in the block and update the CRC over it
+            uint16_t count = iproc->length - iproc->rxCount;
+            if (count > length - pos) {
+                count = length - pos;
+            }
+            memcpy(&connection->rxBuffer[iproc->rxCount], &rxbuffer[pos], count);
+            iproc->cs = PIOS_CRC_updateCRC(iproc->cs, &rxbuffer[pos], count);
+            iproc->rxCount += count;
+            iproc->rxPacketLength = (iproc->rxPacketLength + count < 0xffff) ? iproc->rxPacketLength + count : 0xffff;
+            connection->stats.rxBytes += count;
+            pos += count;
+            if (iproc->rxCount == iproc->length) {
+                iproc->rxCount = 0;
+                iproc->state   = UAVTALK_STATE_CS;
+            }
+            continue;
+        }
+
+        // Header and checksum bytes
+        if (UAVTalkProcessInputStreamQuiet(connectionHandle, rxbuffer[pos++]) == UAVTALK_STATE_COMPLETE) {
+            break;
+        }
+    }
+
+    *position = pos;
+    return iproc->state;
+}
+
+/**
+ * Process a block of bytes from the telemetry stream, the complete packets are received
+ * as with UAVTalkProcessInputStream().
+ * \param[in] connectionHandle UAVTalkConnection to be used
+ * \param[in] rxbuffer Received bytes
+ * \param[in] length Number of received bytes
+ * \return UAVTalkRxState after the last byte
+ */
+UAVTalkRxState UAVTalkProcessInputBuffer(UAVTalkConnection connectionHandle, const uint8_t *rxbuffer, uint16_t length)
+{
+    UAVTalkRxState state = UAVTALK_STATE_SYNC;
+    uint16_t position    = 0;
+
+    while (length > 0) {
+        state = UAVTalkProcessInputBufferQuiet(connectionHandle, rxbuffer, length, &position);
+        if (state == UAVTALK_STATE_COMPLETE) {
+            UAVTalkReceiveObject(connectionHandle);
+        } else if (position == 0) {
+            break;
+        }
+        rxbuffer += position;
+        length   -= position;
+    }
+
+    return state;
+}
+
 /**
  * Send a parsed packet received on one connection handle out on a different connection handle.
  * The packet must be in a complete state, meaning it is completed parsing.
@@ -696,6 +956,10 @@ int32_t UAVTalkReceiveObject(UAVTalkConnection connectionHandle)
         return -1;
     }
 
+    if (iproc->type == UAVTALK_TYPE_BUNDLE) {
+        return receiveBundle(connection, iproc->instId, connection->rxBuffer, iproc->length);
+    }
+
     return receiveObject(connection, iproc->type, iproc->objId, iproc->instId, connection->rxBuffer);
 }
 
@@ -713,6 +977,20 @@ uint32_t UAVTalkGetPacketObjId(UAVTalkConnection connectionHandle)
     return connection->iproc.objId;
 }
 
+/**
+ * Get the type of the current packet.
+ * \param[in] connectionHandle UAVTalkConnection to be used
+ * \return The packet type (UAVTALK_TYPE_xxx), or 0 on error.
+ */
+uint8_t UAVTalkGetPacketType(UAVTalkConnection connectionHandle)
+{
+    UAVTalkConnectionData *connection;
+
+    CHECKCONHANDLE(connectionHandle, connection, return 0);
+
+    return connection->iproc.type;
+}
+
 /**
  * Receive an object. This function process objects received through the telemetry stream.
  *
@@ -838,6 +1116,42 @@ static int32_t receiveObject(UAVTalkConnectionData *connection, uint8_t type, ui
     return ret;
 }
 
+/**
+ * Receive a bundle of object updates, each one is processed as an OBJ message.
+ * \param[in] connection UAVTalkConnection to be used
+ * \param[in] count Number of objects in the bundle
+ * \param[in] data Data buffer
+ * \param[in] length Buffer length
+ * \return 0 Success
+ * \return -1 Failure
+ */
+static int32_t receiveBundle(UAVTalkConnectionData *connection, uint16_t count, uint8_t *data, uint32_t length)
+{
+    uint32_t offset = 0;
+    int32_t ret     = 0;
+
+    for (uint16_t n = 0; n < count; ++n) {
+        if (offset + UAVTALK_BUNDLE_ENTRY_HEADER_LENGTH > length) {
+            return -1;
+        }
+        uint32_t objId  = data[offset] | (data[offset + 1] << 8) | (data[offset + 2] << 16) | ((uint32_t)data[offset + 3] << 24);
+        uint16_t instId = data[offset + 4] | (data[offset + 5] << 8);
+        offset += UAVTALK_BUNDLE_ENTRY_HEADER_LENGTH;
+
+        // The length of an unknown object is unknown, the rest of the bundle can not be parsed
+        UAVObjHandle obj = UAVObjGetByID(objId);
+        if (obj == 0 || offset + UAVObjGetNumBytes(obj) > length) {
+            return -1;
+        }
+        if (receiveObject(connection, UAVTALK_TYPE_OBJ, objId, instId, &data[offset]) == -1) {
+            ret = -1;
+        }
+        offset += UAVObjGetNumBytes(obj);
+    }
+
+    return ret;
+}
+
 /**
  * Check if an ack is pending on an object and give response semaphore
  * \param[in] connection UAVTalkConnection to be used
@@ -870,8 +1184,6 @@ static void updateAck(UAVTalkConnectionData *connection, uint8_t type, uint32_t
  */
 static int32_t sendObject(UAVTalkConnectionData *connection, uint8_t type, uint32_t objId, uint16_t instId, UAVObjHandle obj)
 {
-    uint32_t numInst;
-    uint32_t n;
     int32_t ret = -1;
 
     // Important note : obj can be null (when type is NACK for example) so protect all obj dereferences.
@@ -884,31 +1196,145 @@ static int32_t sendObject(UAVTalkConnectionData *connection, uint8_t type, uint3
     // Process message type
     if (type == UAVTALK_TYPE_OBJ || type == UAVTALK_TYPE_OBJ_TS || type == UAVTALK_TYPE_OBJ_ACK || type == UAVTALK_TYPE_OBJ_ACK_TS) {
         if (instId == UAVOBJ_ALL_INSTANCES) {
-            // Get number of instances
-            numInst = UAVObjGetNumInstances(obj);
-            // Send all instances in reverse order
-            // This allows the receiver to detect when the last object has been received (i.e. when instance 0 is received)
-            ret     = 0;
-            for (n = 0; n < numInst; ++n) {
-                ret = sendSingleObject(connection, type, objId, numInst - n - 1, obj);
-                if (ret == -1) {
-                    break;
-                }
-            }
+            ret = sendAllInstances(connection, type, objId, UAVObjGetNumInstances(obj), obj);
         } else {
-            ret = sendSingleObject(connection, type, objId, instId, obj);
+            ret = sendSingleObject(connection, type, objId, instId, obj, NULL);
         }
-    } else if (type == UAVTALK_TYPE_OBJ_REQ) {
-        ret = sendSingleObject(connection, type, objId, instId, obj);
+    } else if (type == UAVTALK_TYPE_OBJ_REQ || type == UAVTALK_TYPE_OBJ_COMPACT) {
+        ret = sendSingleObject(connection, type, objId, instId, obj, NULL);
     } else if (type == UAVTALK_TYPE_ACK || type == UAVTALK_TYPE_NACK) {
         if (instId != UAVOBJ_ALL_INSTANCES) {
-            ret = sendSingleObject(connection, type, objId, instId, obj);
+            ret = sendSingleObject(connection, type, objId, instId, obj, NULL);
         }
     }
 
     return ret;
 }
 
+/**
+ * Send all the instances of an object, one message each.
+ * The instances are packed a batch at a time with UAVObjPackInstances() in the bundle buffer,
+ * so the object is locked once per batch instead of once per instance.
+ * \param[in] connection UAVTalkConnection to be used (must be locked)
+ * \param[in] type Transaction type
+ * \param[in] objId The object ID
+ * \param[in] numInst Number of instances of the object
+ * \param[in] obj Object handle to send
+ * \return 0 Success
+ * \return -1 Failure
+ */
+static int32_t sendAllInstances(UAVTalkConnectionData *connection, uint8_t type, uint32_t objId, uint16_t numInst, UAVObjHandle obj)
+{
+    uint16_t size  = UAVObjGetNumBytes(obj);
+    uint16_t batch = size ? UAVTALK_MAX_BUNDLE_LENGTH / size : 0;
+    uint16_t n;
+
+    // The bundle buffer is free once flushed
+    flushBundle(connection);
+    if (batch > 1 && !connection->bundleBuffer) {
+        connection->bundleBuffer = pios_malloc(UAVTALK_MAX_BUNDLE_LENGTH);
+    }
+
+    // Send all instances in reverse order
+    // This allows the receiver to detect when the last object has been received (i.e. when instance 0 is received)
+    while (numInst > 0) {
+        if (batch < 2 || !connection->bundleBuffer) {
+            // Nothing to gain from a batch of one
+            if (sendSingleObject(connection, type, objId, --numInst, obj, NULL) == -1) {
+                return -1;
+            }
+            continue;
+        }
+
+        n = (numInst < batch) ? numInst : batch;
+        numInst -= n;
+        if (UAVObjPackInstances(obj, numInst, n, connection->bundleBuffer) == -1) {
+            connection->stats.txErrors++;
+            return -1;
+        }
+        while (n > 0) {
+            --n;
+            if (sendSingleObject(connection, type, objId, numInst + n, obj, &connection->bundleBuffer[n * size]) == -1) {
+                return -1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Send the pending bundled updates as a single message.
+ * A bundle holding a single update is sent as a regular OBJ message.
+ * \param[in] connection UAVTalkConnection to be used (must be locked)
+ * \return 0 Success
+ * \return -1 Failure
+ */
+static int32_t flushBundle(UAVTalkConnectionData *connection)
+{
+    uint8_t *data  = connection->bundleBuffer;
+    int32_t length = connection->bundleLength;
+    uint16_t count = connection->bundleCount;
+
+    if (count == 0) {
+        return 0;
+    }
+    connection->bundleLength = 0;
+    connection->bundleCount  = 0;
+
+    if (!connection->outStream) {
+        connection->stats.txErrors++;
+        return -1;
+    }
+
+    int32_t headerLength = UAVTALK_MIN_HEADER_LENGTH;
+    if (count == 1) {
+        length -= UAVTALK_BUNDLE_ENTRY_HEADER_LENGTH;
+    }
+    uint16_t tx_msg_len = headerLength + length + UAVTALK_CHECKSUM_LENGTH;
+    uint8_t *txBuffer   = txAcquire(connection, tx_msg_len);
+
+    // Setup sync byte and type
+    txBuffer[0] = UAVTALK_SYNC_VAL;
+    if (count == 1) {
+        // Object and instance IDs are those of the single entry
+        txBuffer[1] = UAVTALK_TYPE_OBJ;
+        memcpy(&txBuffer[4], data, UAVTALK_BUNDLE_ENTRY_HEADER_LENGTH);
+        data += UAVTALK_BUNDLE_ENTRY_HEADER_LENGTH;
+    } else {
+        // No object ID, the instance ID holds the number of objects
+        txBuffer[1] = UAVTALK_TYPE_BUNDLE;
+        memset(&txBuffer[4], 0, 4);
+        txBuffer[8] = (uint8_t)(count & 0xFF);
+        txBuffer[9] = (uint8_t)((count >> 8) & 0xFF);
+    }
+
+    memcpy(&txBuffer[headerLength], data, length);
+
+    // Store the packet length
+    txBuffer[2] = (uint8_t)((headerLength + length) & 0xFF);
+    txBuffer[3] = (uint8_t)(((headerLength + length) >> 8) & 0xFF);
+
+    // Calculate and store checksum
+    txBuffer[headerLength + length] = PIOS_CRC_updateCRC(0, txBuffer, headerLength + length);
+
+    // Send bundle
+    int32_t rc = txSend(connection, txBuffer, tx_msg_len);
+
+    // Update stats
+    if (rc == tx_msg_len) {
+        connection->stats.txObjects     += count;
+        connection->stats.txObjectBytes += length - (count > 1 ? count * UAVTALK_BUNDLE_ENTRY_HEADER_LENGTH : 0);
+        connection->stats.txBytes += tx_msg_len;
+    } else {
+        connection->stats.txErrors++;
+        connection->stats.txBytes += (rc > 0) ? rc : 0;
+        return -1;
+    }
+
+    return 0;
+}
+
 /**
  * Send an object through the telemetry link.
  * \param[in] connection UAVTalkConnection to be used
@@ -916,10 +1342,11 @@ static int32_t sendObject(UAVTalkConnectionData *connection, uint8_t type, uint3
  * \param[in] objId The object ID
  * \param[in] instId The instance ID (can NOT be UAVOBJ_ALL_INSTANCES, use () instead)
  * \param[in] obj Object handle to send (null when type is NACK)
+ * \param[in] data Instance data already packed by the caller, NULL to pack it from the object
  * \return 0 Success
  * \return -1 Failure
  */
-static int32_t sendSingleObject(UAVTalkConnectionData *connection, uint8_t type, uint32_t objId, uint16_t instId, UAVObjHandle obj)
+static int32_t sendSingleObject(UAVTalkConnectionData *connection, uint8_t type, uint32_t objId, uint16_t instId, UAVObjHandle obj, const uint8_t *data)
 {
     // IMPORTANT : obj can be null (when type is NACK for example)
 
@@ -928,26 +1355,8 @@ static int32_t sendSingleObject(UAVTalkConnectionData *connection, uint8_t type,
         return -1;
     }
 
-    // Setup sync byte
-    connection->txBuffer[0] = UAVTALK_SYNC_VAL;
-    // Setup type
-    connection->txBuffer[1] = type;
-    // next 2 bytes are reserved for data length (inserted here later)
-    // Setup object ID
-    connection->txBuffer[4] = (uint8_t)(objId & 0xFF);
-    connection->txBuffer[5] = (uint8_t)((objId >> 8) & 0xFF);
-    connection->txBuffer[6] = (uint8_t)((objId >> 16) & 0xFF);
-    connection->txBuffer[7] = (uint8_t)((objId >> 24) & 0xFF);
-    // Setup instance ID
-    connection->txBuffer[8] = (uint8_t)(instId & 0xFF);
-    connection->txBuffer[9] = (uint8_t)((instId >> 8) & 0xFF);
     int32_t headerLength = 10;
-
-    // Add timestamp when the transaction type is appropriate
     if (type & UAVTALK_TIMESTAMPED) {
-        portTickType time = xTaskGetTickCount();
-        connection->txBuffer[10] = (uint8_t)(time & 0xFF);
-        connection->txBuffer[11] = (uint8_t)((time >> 8) & 0xFF);
         headerLength += 2;
     }
 
@@ -955,6 +1364,8 @@ static int32_t sendSingleObject(UAVTalkConnectionData *connection, uint8_t type,
     int32_t length;
     if (type == UAVTALK_TYPE_OBJ_REQ || type == UAVTALK_TYPE_ACK || type == UAVTALK_TYPE_NACK) {
         length = 0;
+    } else if (type == UAVTALK_TYPE_OBJ_COMPACT) {
+        length = UAVObjGetCompactProfile(obj)->numBytes;
     } else {
         length = UAVObjGetNumBytes(obj);
     }
@@ -965,24 +1376,51 @@ static int32_t sendSingleObject(UAVTalkConnectionData *connection, uint8_t type,
         return -1;
     }
 
+    uint16_t tx_msg_len = headerLength + length + UAVTALK_CHECKSUM_LENGTH;
+    uint8_t *txBuffer   = txAcquire(connection, tx_msg_len);
+
+    // Setup sync byte
+    txBuffer[0] = UAVTALK_SYNC_VAL;
+    // Setup type
+    txBuffer[1] = type;
+    // Store the packet length
+    txBuffer[2] = (uint8_t)((headerLength + length) & 0xFF);
+    txBuffer[3] = (uint8_t)(((headerLength + length) >> 8) & 0xFF);
+    // Setup object ID
+    txBuffer[4] = (uint8_t)(objId & 0xFF);
+    txBuffer[5] = (uint8_t)((objId >> 8) & 0xFF);
+    txBuffer[6] = (uint8_t)((objId >> 16) & 0xFF);
+    txBuffer[7] = (uint8_t)((objId >> 24) & 0xFF);
+    // Setup instance ID
+    txBuffer[8] = (uint8_t)(instId & 0xFF);
+    txBuffer[9] = (uint8_t)((instId >> 8) & 0xFF);
+
+    // Add timestamp when the transaction type is appropriate
+    if (type & UAVTALK_TIMESTAMPED) {
+        portTickType time = xTaskGetTickCount();
+        txBuffer[10] = (uint8_t)(time & 0xFF);
+        txBuffer[11] = (uint8_t)((time >> 8) & 0xFF);
+    }
+
     // Copy data (if any)
-    if (length > 0) {
-        if (UAVObjPack(obj, instId, &connection->txBuffer[headerLength]) == -1) {
+    if (length > 0 && data) {
+        memcpy(&txBuffer[headerLength], data, length);
+    } else if (length > 0) {
+        int32_t packed = (type == UAVTALK_TYPE_OBJ_COMPACT) ?
+                         UAVObjPackCompact(obj, instId, &txBuffer[headerLength]) :
+                         UAVObjPack(obj, instId, &txBuffer[headerLength]);
+        if (packed == -1) {
+            txRelease(connection, txBuffer);
             connection->stats.txErrors++;
             return -1;
         }
     }
 
-    // Store the packet length
-    connection->txBuffer[2] = (uint8_t)((headerLength + length) & 0xFF);
-    connection->txBuffer[3] = (uint8_t)(((headerLength + length) >> 8) & 0xFF);
-
     // Calculate and store checksum
-    connection->txBuffer[headerLength + length] = PIOS_CRC_updateCRC(0, connection->txBuffer, headerLength + length);
+    txBuffer[headerLength + length] = PIOS_CRC_updateCRC(0, txBuffer, headerLength + length);
 
     // Send object
-    uint16_t tx_msg_len = headerLength + length + UAVTALK_CHECKSUM_LENGTH;
-    int32_t rc = (*connection->outStream)(connection->txBuffer, tx_msg_len);
+    int32_t rc = txSend(connection, txBuffer, tx_msg_len);
 
     // Update stats
     if (rc == tx_msg_len) {
@@ -1000,6 +1438,45 @@ static int32_t sendSingleObject(UAVTalkConnectionData *connection, uint8_t type,
     return 0;
 }
 
+/**
+ * Get the buffer to build an outgoing packet in: room reserved in the output
+ * when the connection supports it, the connection transmit buffer otherwise.
+ * \param[in] connection UAVTalkConnection to be used (must be locked)
+ * \param[in] length Full packet length including checksum
+ */
+static uint8_t *txAcquire(UAVTalkConnectionData *connection, uint16_t length)
+{
+    if (connection->outReserve) {
+        uint8_t *buf = (*connection->outReserve)(length);
+        if (buf) {
+            return buf;
+        }
+    }
+    return connection->txBuffer;
+}
+
+/**
+ * Send a packet built in a buffer returned by txAcquire()
+ * \return number of bytes sent, negative on failure
+ */
+static int32_t txSend(UAVTalkConnectionData *connection, uint8_t *buf, uint16_t length)
+{
+    if (buf != connection->txBuffer) {
+        return (*connection->outCommit)(length);
+    }
+    return (*connection->outStream)(buf, length);
+}
+
+/**
+ * Drop a buffer returned by txAcquire() without sending it
+ */
+static void txRelease(UAVTalkConnectionData *connection, uint8_t *buf)
+{
+    if (buf != connection->txBuffer) {
+        (*connection->outCommit)(0);
+    }
+}
+
 /**
  * @}
  * @}
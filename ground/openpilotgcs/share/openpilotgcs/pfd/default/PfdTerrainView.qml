@@ -6,6 +6,7 @@ OsgEarth {
 
     sceneFile: qmlWidget.earthFile
     fieldOfView: 90
+    lodScale: qmlWidget.terrainLodScale
 
     yaw: AttitudeState.Yaw
     pitch: AttitudeState.Pitch
@@ -238,6 +238,18 @@
     \sa initialize()
  */
 
+/*!
+    \fn void IPlugin::delayedInitialize()
+    Called once all plugins are running and the main window is up,
+    one plugin at a time from the event loop, in the same order as
+    IPlugin::extensionsInitialized().
+    Work that is expensive and not needed to show the initial workspace
+    (e.g. initializing a 3D engine) belongs here instead of in initialize().
+    Code that needs that work done before it runs (e.g. a gadget factory
+    creating its first gadget) calls PluginManager::ensureDelayedInitialized().
+    \sa PluginManager::ensureDelayedInitialized()
+ */
+
 /*!
     \fn void IPlugin::shutdown()
     Called during a shutdown sequence in the same order as initialization
@@ -51,6 +51,7 @@ public:
 
     virtual bool initialize(const QStringList &arguments, QString *errorString) = 0;
     virtual void extensionsInitialized() = 0;
+    virtual void delayedInitialize() {}
     virtual void shutdown() {}
 
     PluginSpec *pluginSpec() const;
@@ -35,6 +35,10 @@
 
 #include <QtCore/QMetaProperty>
 #include <QtCore/QDir>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QMap>
+#include <QtCore/QTimer>
 #include <QtCore/QTextStream>
 #include <QtCore/QWriteLocker>
 #include <QtDebug>
@@ -304,6 +308,91 @@ QStringList PluginManager::arguments() const
     return d->arguments;
 }
 
+/*!
+    \fn void PluginManager::ensureDelayedInitialized(PluginSpec *spec)
+    Runs IPlugin::delayedInitialize() of the plugin \a spec right away
+    if it is still waiting for its turn. Does nothing otherwise.
+ */
+void PluginManager::ensureDelayedInitialized(PluginSpec *spec)
+{
+    if (d->delayedInitializeQueue.removeOne(spec)) {
+        d->delayedInitialize(spec);
+    }
+}
+
+/*!
+    \fn void PluginManager::nextDelayedInitialize()
+    \internal
+ */
+void PluginManager::nextDelayedInitialize()
+{
+    if (!d->delayedInitializeQueue.isEmpty()) {
+        d->delayedInitialize(d->delayedInitializeQueue.takeFirst());
+    }
+    if (d->delayedInitializeQueue.isEmpty()) {
+        d->delayedInitializeTimer->stop();
+        d->writeProfilingReport();
+        emit initializationDone();
+    }
+}
+
+static QString formatTime(qint64 time)
+{
+    return (time < 0) ? QString("-") : QString::number(time);
+}
+
+/*!
+    \fn QString PluginManager::profilingReport() const
+    Time spent by each plugin in loading, IPlugin::initialize(),
+    IPlugin::extensionsInitialized() and IPlugin::delayedInitialize(),
+    slowest plugins first.
+ */
+QString PluginManager::profilingReport() const
+{
+    return d->profilingReport();
+}
+
+/*!
+    \fn QString PluginManagerPrivate::profilingReport() const
+    \internal
+ */
+QString PluginManagerPrivate::profilingReport() const
+{
+    QMultiMap<qint64, PluginSpec *> byTotal;
+    qint64 total = 0;
+
+    foreach(PluginSpec * spec, pluginSpecs) {
+        qint64 pluginTotal = qMax(spec->d->loadTime, (qint64)0) + qMax(spec->d->initializeTime, (qint64)0)
+                             + qMax(spec->d->extensionsInitializedTime, (qint64)0) + qMax(spec->d->delayedInitializeTime, (qint64)0);
+        byTotal.insert(pluginTotal, spec);
+        total += pluginTotal;
+    }
+
+    QString report = QString("%1 %2 %3 %4 %5 %6\n").arg("Plugin", -24).arg("load", 8).arg("init", 8)
+        .arg("ext.init", 8).arg("delayed", 8).arg("total", 8);
+    QMapIterator<qint64, PluginSpec *> it(byTotal);
+    it.toBack();
+    while (it.hasPrevious()) {
+        it.previous();
+        const PluginSpecPrivate *p = it.value()->d;
+        report += QString("%1 %2 %3 %4 %5 %6\n").arg(it.value()->name(), -24).arg(formatTime(p->loadTime), 8)
+            .arg(formatTime(p->initializeTime), 8).arg(formatTime(p->extensionsInitializedTime), 8)
+            .arg(formatTime(p->delayedInitializeTime), 8).arg(it.key(), 8);
+    }
+    report += QString("%1 %2\n").arg("Total (ms)", -60).arg(total, 8);
+    return report;
+}
+
+/*!
+    \fn void PluginManager::setProfilingReportFile(const QString &fileName)
+    Write the profilingReport() to \a fileName once all plugins finished
+    their delayed initialization.
+ */
+void PluginManager::setProfilingReportFile(const QString &fileName)
+{
+    d->profilingReportFile = fileName;
+}
+
 /*!
     \fn QList<PluginSpec *> PluginManager::plugins() const
     List of all plugin specifications that have been found in the plugin search paths.
@@ -494,8 +583,12 @@ PluginSpecPrivate *PluginManagerPrivate::privateSpec(PluginSpec *spec)
     \internal
  */
 PluginManagerPrivate::PluginManagerPrivate(PluginManager *pluginManager)
-    : extension("xml"), q(pluginManager)
-{}
+    : delayedInitializeTimer(new QTimer(pluginManager)), extension("xml"), q(pluginManager)
+{
+    // give the event loop room between two delayed initializations
+    delayedInitializeTimer->setInterval(DELAYED_INITIALIZE_INTERVAL);
+    QObject::connect(delayedInitializeTimer, SIGNAL(timeout()), q, SLOT(nextDelayedInitialize()));
+}
 
 /*!
     \fn PluginManagerPrivate::~PluginManagerPrivate()
@@ -512,6 +605,8 @@ PluginManagerPrivate::~PluginManagerPrivate()
 
 void PluginManagerPrivate::stopAll()
 {
+    delayedInitializeTimer->stop();
+    delayedInitializeQueue.clear();
     QList<PluginSpec *> queue = loadQueue();
     foreach(PluginSpec * spec, queue) {
         loadPlugin(spec, PluginSpec::Stopped);
@@ -593,10 +688,45 @@ void PluginManagerPrivate::loadPlugins()
         PluginSpec *plugin = it.previous();
         emit q->pluginAboutToBeLoaded(plugin);
         loadPlugin(plugin, PluginSpec::Running);
+        if (plugin->state() == PluginSpec::Running) {
+            delayedInitializeQueue.append(plugin);
+        }
     }
     emit q->pluginsChanged();
     q->m_allPluginsLoaded = true;
     emit q->pluginsLoadEnded();
+    delayedInitializeTimer->start();
+}
+
+/*!
+    \fn void PluginManagerPrivate::delayedInitialize(PluginSpec *spec)
+    \internal
+ */
+void PluginManagerPrivate::delayedInitialize(PluginSpec *spec)
+{
+    QElapsedTimer timer;
+
+    timer.start();
+    if (spec->d->delayedInitialize()) {
+        spec->d->delayedInitializeTime = timer.elapsed();
+    }
+}
+
+/*!
+    \fn void PluginManagerPrivate::writeProfilingReport()
+    \internal
+ */
+void PluginManagerPrivate::writeProfilingReport()
+{
+    if (profilingReportFile.isEmpty()) {
+        return;
+    }
+    QFile file(profilingReportFile);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        qWarning() << "PluginManager: cannot write startup profile to" << profilingReportFile;
+        return;
+    }
+    file.write(profilingReport().toUtf8());
 }
 
 /*!
@@ -667,8 +797,11 @@ void PluginManagerPrivate::loadPlugin(PluginSpec *spec, PluginSpec::State destSt
     if (spec->hasError()) {
         return;
     }
+    QElapsedTimer timer;
+    timer.start();
     if (destState == PluginSpec::Running) {
         spec->d->initializeExtensions();
+        spec->d->extensionsInitializedTime = timer.elapsed();
         return;
     } else if (destState == PluginSpec::Deleted) {
         spec->d->kill();
@@ -685,8 +818,10 @@ void PluginManagerPrivate::loadPlugin(PluginSpec *spec, PluginSpec::State destSt
     }
     if (destState == PluginSpec::Loaded) {
         spec->d->loadLibrary();
+        spec->d->loadTime = timer.elapsed();
     } else if (destState == PluginSpec::Initialized) {
         spec->d->initializePlugin();
+        spec->d->initializeTime = timer.elapsed();
     } else if (destState == PluginSpec::Stopped) {
         spec->d->stop();
     }
@@ -115,6 +115,13 @@ public:
     bool runningTests() const;
     QString testDataDirectory() const;
 
+    // delayed initialization
+    void ensureDelayedInitialized(PluginSpec *spec);
+
+    // startup profiling
+    QString profilingReport() const;
+    void setProfilingReportFile(const QString &fileName);
+
 signals:
     void objectAdded(QObject *obj);
     void aboutToRemoveObject(QObject *obj);
@@ -122,8 +129,10 @@ signals:
     void pluginAboutToBeLoaded(ExtensionSystem::PluginSpec *pluginSpec);
     void pluginsChanged();
     void pluginsLoadEnded();
+    void initializationDone();
 private slots:
     void startTests();
+    void nextDelayedInitialize();
 
 private:
     Internal::PluginManagerPrivate *d;
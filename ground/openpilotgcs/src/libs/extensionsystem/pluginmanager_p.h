@@ -36,6 +36,10 @@
 #include <QtCore/QStringList>
 #include <QtCore/QObject>
 
+QT_BEGIN_NAMESPACE
+class QTimer;
+QT_END_NAMESPACE
+
 namespace ExtensionSystem {
 class PluginManager;
 
@@ -56,7 +60,10 @@ public:
     void setPluginPaths(const QStringList &paths);
     QList<PluginSpec *> loadQueue();
     void loadPlugin(PluginSpec *spec, PluginSpec::State destState);
+    void delayedInitialize(PluginSpec *spec);
     void resolveDependencies();
+    void writeProfilingReport();
+    QString profilingReport() const;
 
     QList<PluginSpec *> pluginSpecs;
     QList<PluginSpec *> testSpecs;
@@ -66,6 +73,10 @@ public:
 
     QStringList arguments;
 
+    QList<PluginSpec *> delayedInitializeQueue;
+    QTimer *delayedInitializeTimer;
+    QString profilingReportFile;
+
     // Look in argument descriptions of the specs for the option.
     PluginSpec *pluginForOption(const QString &option, bool *requiresArgument) const;
     PluginSpec *pluginByName(const QString &name) const;
@@ -74,6 +85,8 @@ public:
     static PluginSpec *createSpec();
     static PluginSpecPrivate *privateSpec(PluginSpec *spec);
 private:
+    static const int DELAYED_INITIALIZE_INTERVAL = 20; // ms
+
     PluginManager *q;
 
     void readPluginPaths();
@@ -384,6 +384,10 @@ PluginSpecPrivate::PluginSpecPrivate(PluginSpec *spec)
     : plugin(0),
     state(PluginSpec::Invalid),
     hasError(false),
+    loadTime(-1),
+    initializeTime(-1),
+    extensionsInitializedTime(-1),
+    delayedInitializeTime(-1),
     q(spec)
 {}
 
@@ -886,6 +890,19 @@ bool PluginSpecPrivate::initializeExtensions()
     return true;
 }
 
+/*!
+    \fn bool PluginSpecPrivate::delayedInitialize()
+    \internal
+ */
+bool PluginSpecPrivate::delayedInitialize()
+{
+    if (hasError || state != PluginSpec::Running || !plugin) {
+        return false;
+    }
+    plugin->delayedInitialize();
+    return true;
+}
+
 /*!
     \fn bool PluginSpecPrivate::stop()
     \internal
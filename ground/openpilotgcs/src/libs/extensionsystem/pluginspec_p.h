@@ -52,6 +52,7 @@ public:
     bool loadLibrary();
     bool initializePlugin();
     bool initializeExtensions();
+    bool delayedInitialize();
     void stop();
     void kill();
 
@@ -77,6 +78,12 @@ public:
     bool hasError;
     QString errorString;
 
+    // startup profile, in milliseconds (-1 if the step did not run)
+    qint64 loadTime;
+    qint64 initializeTime;
+    qint64 extensionsInitializedTime;
+    qint64 delayedInitializeTime;
+
     static bool isValidVersion(const QString &version);
     static int versionCompare(const QString &version1, const QString &version2);
 
@@ -26,5 +26,13 @@
  */
 #include "diagnostics.h"
 
-diagnostics::diagnostics() : networkerrors(0), emptytiles(0), timeouts(0), runningThreads(0), tilesFromMem(0), tilesFromNet(0), tilesFromDB(0)
+diagnostics::diagnostics() : networkerrors(0), emptytiles(0), timeouts(0), runningThreads(0), tilesFromMem(0), tilesFromNet(0), tilesFromDB(0), tilesFromPack(0),
+    memoryHits(0), memoryMisses(0), memoryUsed(0)
 {}
+
+QString diagnostics::toString()
+{
+    return QString("Network errors:%1\nEmpty Tiles:%2\nTimeOuts:%3\nRunningThreads:%4\nTilesFromMem:%5\nTilesFromNet:%6\nTilesFromDB:%7").arg(networkerrors).arg(emptytiles).arg(timeouts).arg(runningThreads).arg(tilesFromMem).arg(tilesFromNet).arg(tilesFromDB)
+           + QString("\nTilesFromPack:%1").arg(tilesFromPack)
+           + QString("\nMemoryCache hits:%1 misses:%2 used:%3Mb").arg(memoryHits).arg(memoryMisses).arg(memoryUsed, 0, 'f', 1);
+}
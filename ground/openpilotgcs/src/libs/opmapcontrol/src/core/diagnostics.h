@@ -36,12 +36,12 @@ struct diagnostics {
     int     tilesFromMem;
     int     tilesFromNet;
     int     tilesFromDB;
-    QString toString()
-    {
-        return QString("Network errors:%1\nEmpty Tiles:%2\nTimeOuts:%3\nRunningThreads:%4\nTilesFromMem:%5\nTilesFromNet:%6\nTilesFromDB:%7").arg(networkerrors).arg(emptytiles).arg(timeouts).arg(runningThreads).arg(tilesFromMem).arg(tilesFromNet).arg(tilesFromDB);
-
-        ;
-    }
+    int     tilesFromPack;
+    // Lookups of the decoded tile memory cache and the Mb it holds
+    int     memoryHits;
+    int     memoryMisses;
+    double  memoryUsed;
+    QString toString();
 };
 
 #endif // DIAGNOSTICS_H
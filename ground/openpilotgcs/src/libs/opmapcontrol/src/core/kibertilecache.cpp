@@ -26,43 +26,65 @@
  */
 #include "kibertilecache.h"
 
-// TODO add readwrite lock
-
 namespace core {
-KiberTileCache::KiberTileCache()
+KiberTileCache::KiberTileCache() : hits(0), misses(0)
 {
-    memoryCacheSize = 0;
-    _MemoryCacheCapacity = 22;
+    // Enough for the visible tiles of a large map at its zoom and the ones next to it
+    tiles.setMaxCost(128 * 1048576);
 }
 
 void KiberTileCache::setMemoryCacheCapacity(const int &value)
 {
-    kiberCacheLock.lockForWrite();
-    _MemoryCacheCapacity = value;
-    kiberCacheLock.unlock();
+    QMutexLocker locker(&mutex);
+
+    tiles.setMaxCost(value * 1048576);
 }
 int KiberTileCache::MemoryCacheCapacity()
 {
-    kiberCacheLock.lockForRead();
-    return _MemoryCacheCapacity;
+    QMutexLocker locker(&mutex);
+
+    return tiles.maxCost() / 1048576;
+}
+double KiberTileCache::MemoryCacheSize()
+{
+    QMutexLocker locker(&mutex);
 
-    kiberCacheLock.unlock();
+    return tiles.totalCost() / 1048576.0;
 }
 
-void KiberTileCache::RemoveMemoryOverload()
+QImage KiberTileCache::Find(const RawTile &tile)
 {
-    while (MemoryCacheSize() > MemoryCacheCapacity()) {
-        if (cachequeue.count() > 0 && list.count() > 0) {
-#ifdef DEBUG_MEMORY_CACHE
-            qDebug() << "Cleaning Memory cache=" << " started with " << cachequeue.count() << " tile " << "ocupying " << memoryCacheSize << " bytes";
-#endif
-            RawTile first = list.dequeue();
-            memoryCacheSize -= cachequeue.value(first).size();
-            cachequeue.remove(first);
-        }
+    QMutexLocker locker(&mutex);
+    QImage *image = tiles.object(tile);
+
+    if (!image) {
+        ++misses;
+        return QImage();
     }
+    ++hits;
+    return *image;
+}
+void KiberTileCache::Insert(const RawTile &tile, const QImage &image)
+{
+    QMutexLocker locker(&mutex);
+
+    // Replaces the tile if it is there already, the least recently used go when over budget
+    tiles.insert(tile, new QImage(image), image.byteCount());
 #ifdef DEBUG_MEMORY_CACHE
-    qDebug() << "Cleaning Memory cache=" << " ended with " << cachequeue.count() << " tile " << "ocupying " << memoryCacheSize << " bytes";
+    qDebug() << "Current memory=" << tiles.totalCost() << " in " << tiles.count() << " tiles";
 #endif
 }
+
+int KiberTileCache::Hits()
+{
+    QMutexLocker locker(&mutex);
+
+    return hits;
+}
+int KiberTileCache::Misses()
+{
+    QMutexLocker locker(&mutex);
+
+    return misses;
+}
 }
@@ -29,28 +29,33 @@
 
 #include "rawtile.h"
 #include <QMutex>
-#include <QReadWriteLock>
-#include <QQueue>
+#include <QCache>
+#include <QImage>
 #include <QDebug>
 #include "debugheader.h"
 namespace core {
+/**
+ * Least recently used decoded tiles, within a budget of the bytes of their images
+ */
 class KiberTileCache {
 public:
     KiberTileCache();
 
+    // Capacity in Mb
     void setMemoryCacheCapacity(const int &value);
     int MemoryCacheCapacity();
-    double MemoryCacheSize()
-    {
-        return memoryCacheSize / 1048576.0;
-    }
-    void RemoveMemoryOverload();
-    QReadWriteLock kiberCacheLock;
-    QHash <RawTile, QByteArray> cachequeue;
-    QQueue <RawTile> list;
-    long memoryCacheSize;
+    // Used memory in Mb
+    double MemoryCacheSize();
+    // A null image if the tile is not in the cache, a hit makes it the most recently used
+    QImage Find(const RawTile &tile);
+    void Insert(const RawTile &tile, const QImage &image);
+    int Hits();
+    int Misses();
 private:
-    int _MemoryCacheCapacity;
+    QMutex mutex;
+    QCache<RawTile, QImage> tiles;
+    int hits;
+    int misses;
 };
 }
 #endif // KIBERTILECACHE_H
@@ -40,9 +40,8 @@ public:
     MemoryCache();
 
     KiberTileCache TilesInMemory;
-    QByteArray GetTileFromMemoryCache(const RawTile &tile);
-    void AddTileToMemoryCache(const RawTile &tile, const QByteArray &pic);
-    QReadWriteLock kiberCacheLock;
+    QImage GetTileFromMemoryCache(const RawTile &tile);
+    void AddTileToMemoryCache(const RawTile &tile, const QImage &pic);
 };
 }
 #endif // MEMORYCACHE_H
@@ -52,195 +52,209 @@ OPMaps::~OPMaps()
 }
 
 
-QByteArray OPMaps::GetImageFrom(const MapType::Types &type, const Point &pos, const int &zoom)
+QImage OPMaps::GetTileImage(const MapType::Types &type, const Point &pos, const int &zoom)
 {
-#ifdef DEBUG_TIMINGS
-    QTime time;
-    time.restart();
-#endif
-#ifdef DEBUG_GMAPS
-    qDebug() << "Entered GetImageFrom";
-#endif // DEBUG_GMAPS
-    QByteArray ret;
+    QImage image;
 
     if (useMemoryCache) {
 #ifdef DEBUG_GMAPS
         qDebug() << "Try Tile from memory:Size=" << TilesInMemory.MemoryCacheSize();
 #endif // DEBUG_GMAPS
-        ret = GetTileFromMemoryCache(RawTile(type, pos, zoom));
-        if (!ret.isEmpty()) {
+        image = GetTileFromMemoryCache(RawTile(type, pos, zoom));
+        if (!image.isNull()) {
             errorvars.lock();
             ++diag.tilesFromMem;
             errorvars.unlock();
+            return image;
         }
     }
-    if (ret.isEmpty()) {
+    image = PureImageProxy::Decode(GetImageFrom(type, pos, zoom));
+    if (useMemoryCache && !image.isNull()) {
 #ifdef DEBUG_GMAPS
-        qDebug() << "Tile not in memory";
+        qDebug() << "Add Tile to memory cache";
 #endif // DEBUG_GMAPS
-        if (accessmode != (AccessMode::ServerOnly)) {
+        AddTileToMemoryCache(RawTile(type, pos, zoom), image);
+    }
+    return image;
+}
+
+QByteArray OPMaps::GetImageFrom(const MapType::Types &type, const Point &pos, const int &zoom)
+{
+#ifdef DEBUG_TIMINGS
+    QTime time;
+    time.restart();
+#endif
 #ifdef DEBUG_GMAPS
-            qDebug() << "Try tile from DataBase";
+    qDebug() << "Entered GetImageFrom";
 #endif // DEBUG_GMAPS
-            ret = Cache::Instance()->ImageCache.GetImageFromCache(type, pos, zoom);
-            if (!ret.isEmpty()) {
-                errorvars.lock();
-                ++diag.tilesFromDB;
-                errorvars.unlock();
+    QByteArray ret;
+
+    if (accessmode != (AccessMode::ServerOnly)) {
+        tilePackLock.lockForRead();
+        ret = tilePack.GetImage(type, pos, zoom);
+        tilePackLock.unlock();
+        if (!ret.isEmpty()) {
+            errorvars.lock();
+            ++diag.tilesFromPack;
+            errorvars.unlock();
+            return ret;
+        }
 #ifdef DEBUG_GMAPS
-                qDebug() << "Tile found in Database";
+        qDebug() << "Try tile from DataBase";
 #endif // DEBUG_GMAPS
-                if (useMemoryCache) {
+        ret = Cache::Instance()->ImageCache.GetImageFromCache(type, pos, zoom);
+        if (!ret.isEmpty()) {
+            errorvars.lock();
+            ++diag.tilesFromDB;
+            errorvars.unlock();
 #ifdef DEBUG_GMAPS
-                    qDebug() << "Add Tile to memory";
+            qDebug() << "Tile found in Database";
 #endif // DEBUG_GMAPS
-                    AddTileToMemoryCache(RawTile(type, pos, zoom), ret);
-                }
-                return ret;
-            }
+            return ret;
+        }
+    }
+    if (accessmode != AccessMode::CacheOnly) {
+        QEventLoop q;
+        QNetworkReply *reply;
+        QNetworkRequest qheader;
+        QTimer tT;
+        tT.setSingleShot(true);
+        connect(&tT, SIGNAL(timeout()), &q, SLOT(quit()));
+        if (!networks.hasLocalData()) {
+            networks.setLocalData(new QNetworkAccessManager());
+        }
+        QNetworkAccessManager *network = networks.localData();
+        if (network->proxy() != Proxy) {
+            network->setProxy(Proxy);
         }
-        if (accessmode != AccessMode::CacheOnly) {
-            QEventLoop q;
-            QNetworkReply *reply;
-            QNetworkRequest qheader;
-            QNetworkAccessManager network;
-            QTimer tT;
-            tT.setSingleShot(true);
-            connect(&network, SIGNAL(finished(QNetworkReply *)),
-                    &q, SLOT(quit()));
-            connect(&tT, SIGNAL(timeout()), &q, SLOT(quit()));
-            network.setProxy(Proxy);
 #ifdef DEBUG_GMAPS
-            qDebug() << "Try Tile from the Internet";
+        qDebug() << "Try Tile from the Internet";
 #endif // DEBUG_GMAPS
 #ifdef DEBUG_TIMINGS
-            qDebug() << "opmaps before make image url" << time.elapsed();
+        qDebug() << "opmaps before make image url" << time.elapsed();
 #endif
-            QString url = MakeImageUrl(type, pos, zoom, LanguageStr);
+        QString url = MakeImageUrl(type, pos, zoom, LanguageStr);
 #ifdef DEBUG_TIMINGS
-            qDebug() << "opmaps after make image url" << time.elapsed();
+        qDebug() << "opmaps after make image url" << time.elapsed();
 #endif // url	"http://vec02.maps.yandex.ru/tiles?l=map&v=2.10.2&x=7&y=5&z=3"	string
        // "http://map3.pergo.com.tr/tile/02/000/000/007/000/000/002.png"
-            qheader.setUrl(QUrl(url));
-            qheader.setRawHeader("User-Agent", UserAgent);
-            qheader.setRawHeader("Accept", "*/*");
-            switch (type) {
-            case MapType::GoogleMap:
-            case MapType::GoogleSatellite:
-            case MapType::GoogleLabels:
-            case MapType::GoogleTerrain:
-            case MapType::GoogleHybrid:
-            {
-                qheader.setRawHeader("Referrer", "http://maps.google.com/");
-            }
-            break;
+        qheader.setUrl(QUrl(url));
+        qheader.setRawHeader("User-Agent", UserAgent);
+        qheader.setRawHeader("Accept", "*/*");
+        switch (type) {
+        case MapType::GoogleMap:
+        case MapType::GoogleSatellite:
+        case MapType::GoogleLabels:
+        case MapType::GoogleTerrain:
+        case MapType::GoogleHybrid:
+        {
+            qheader.setRawHeader("Referrer", "http://maps.google.com/");
+        }
+        break;
 
-            case MapType::GoogleMapChina:
-            case MapType::GoogleSatelliteChina:
-            case MapType::GoogleLabelsChina:
-            case MapType::GoogleTerrainChina:
-            case MapType::GoogleHybridChina:
-            {
-                qheader.setRawHeader("Referrer", "http://ditu.google.cn/");
-            }
-            break;
+        case MapType::GoogleMapChina:
+        case MapType::GoogleSatelliteChina:
+        case MapType::GoogleLabelsChina:
+        case MapType::GoogleTerrainChina:
+        case MapType::GoogleHybridChina:
+        {
+            qheader.setRawHeader("Referrer", "http://ditu.google.cn/");
+        }
+        break;
 
-            case MapType::BingHybrid:
-            case MapType::BingMap:
-            case MapType::BingSatellite:
-            {
-                qheader.setRawHeader("Referrer", "http://www.bing.com/maps/");
-            }
-            break;
+        case MapType::BingHybrid:
+        case MapType::BingMap:
+        case MapType::BingSatellite:
+        {
+            qheader.setRawHeader("Referrer", "http://www.bing.com/maps/");
+        }
+        break;
 
-            case MapType::YahooHybrid:
-            case MapType::YahooLabels:
-            case MapType::YahooMap:
-            case MapType::YahooSatellite:
-            {
-                qheader.setRawHeader("Referrer", "http://maps.yahoo.com/");
-            }
-            break;
+        case MapType::YahooHybrid:
+        case MapType::YahooLabels:
+        case MapType::YahooMap:
+        case MapType::YahooSatellite:
+        {
+            qheader.setRawHeader("Referrer", "http://maps.yahoo.com/");
+        }
+        break;
 
-            case MapType::ArcGIS_MapsLT_Map_Labels:
-            case MapType::ArcGIS_MapsLT_Map:
-            case MapType::ArcGIS_MapsLT_OrtoFoto:
-            case MapType::ArcGIS_MapsLT_Map_Hybrid:
-            {
-                qheader.setRawHeader("Referrer", "http://www.maps.lt/map_beta/");
-            }
-            break;
+        case MapType::ArcGIS_MapsLT_Map_Labels:
+        case MapType::ArcGIS_MapsLT_Map:
+        case MapType::ArcGIS_MapsLT_OrtoFoto:
+        case MapType::ArcGIS_MapsLT_Map_Hybrid:
+        {
+            qheader.setRawHeader("Referrer", "http://www.maps.lt/map_beta/");
+        }
+        break;
 
-            case MapType::OpenStreetMapSurfer:
-            case MapType::OpenStreetMapSurferTerrain:
-            {
-                qheader.setRawHeader("Referrer", "http://www.mapsurfer.net/");
-            }
-            break;
+        case MapType::OpenStreetMapSurfer:
+        case MapType::OpenStreetMapSurferTerrain:
+        {
+            qheader.setRawHeader("Referrer", "http://www.mapsurfer.net/");
+        }
+        break;
 
-            case MapType::OpenStreetMap:
-            case MapType::OpenStreetOsm:
-            {
-                qheader.setRawHeader("Referrer", "http://www.openstreetmap.org/");
-            }
-            break;
+        case MapType::OpenStreetMap:
+        case MapType::OpenStreetOsm:
+        {
+            qheader.setRawHeader("Referrer", "http://www.openstreetmap.org/");
+        }
+        break;
 
-            case MapType::YandexMapRu:
-            {
-                qheader.setRawHeader("Referrer", "http://maps.yandex.ru/");
-            }
+        case MapType::YandexMapRu:
+        {
+            qheader.setRawHeader("Referrer", "http://maps.yandex.ru/");
+        }
+        break;
+        default:
             break;
-            default:
-                break;
-            }
-            reply = network.get(qheader);
-            tT.start(Timeout);
-            q.exec();
+        }
+        reply = network->get(qheader);
+        connect(reply, SIGNAL(finished()), &q, SLOT(quit()));
+        tT.start(Timeout);
+        q.exec();
 
-            if (!tT.isActive()) {
-                errorvars.lock();
-                ++diag.timeouts;
-                errorvars.unlock();
-                return ret;
-            }
-            tT.stop();
-            if ((reply->error() != QNetworkReply::NoError)) {
-                errorvars.lock();
-                ++diag.networkerrors;
-                errorvars.unlock();
-                reply->deleteLater();
-                return ret;
-            }
-            ret = reply->readAll();
-            reply->deleteLater(); // TODO can't this be global??
-            if (ret.isEmpty()) {
-#ifdef DEBUG_GMAPS
-                qDebug() << "Invalid Tile";
-#endif // DEBUG_GMAPS
-                errorvars.lock();
-                ++diag.emptytiles;
-                errorvars.unlock();
-                return ret;
-            }
+        if (!tT.isActive()) {
+            errorvars.lock();
+            ++diag.timeouts;
+            errorvars.unlock();
+            // The manager outlives this request now, so it has to be dropped here
+            reply->abort();
+            delete reply;
+            return ret;
+        }
+        tT.stop();
+        if ((reply->error() != QNetworkReply::NoError)) {
+            errorvars.lock();
+            ++diag.networkerrors;
+            errorvars.unlock();
+            delete reply;
+            return ret;
+        }
+        ret = reply->readAll();
+        delete reply;
+        if (ret.isEmpty()) {
 #ifdef DEBUG_GMAPS
-            qDebug() << "Received Tile from the Internet";
+            qDebug() << "Invalid Tile";
 #endif // DEBUG_GMAPS
             errorvars.lock();
-            ++diag.tilesFromNet;
+            ++diag.emptytiles;
             errorvars.unlock();
-            if (useMemoryCache) {
+            return ret;
+        }
 #ifdef DEBUG_GMAPS
-                qDebug() << "Add Tile to memory cache";
+        qDebug() << "Received Tile from the Internet";
 #endif // DEBUG_GMAPS
-                AddTileToMemoryCache(RawTile(type, pos, zoom), ret);
-            }
-            if (accessmode != AccessMode::ServerOnly) {
+        errorvars.lock();
+        ++diag.tilesFromNet;
+        errorvars.unlock();
+        if (accessmode != AccessMode::ServerOnly) {
 #ifdef DEBUG_GMAPS
-                qDebug() << "Add tile to DataBase";
+            qDebug() << "Add tile to DataBase";
 #endif // DEBUG_GMAPS
-                CacheItemQueue *item = new CacheItemQueue(type, pos, ret, zoom);
-                TileDBcacheQueue.EnqueueCacheTask(item);
-            }
+            CacheItemQueue *item = new CacheItemQueue(type, pos, ret, zoom);
+            TileDBcacheQueue.EnqueueCacheTask(item);
         }
     }
 #ifdef DEBUG_GMAPS
@@ -258,6 +272,24 @@ bool OPMaps::ImportFromGMDB(const QString &file)
     return Cache::Instance()->ImageCache.ExportMapDataToDB(file, Cache::Instance()->ImageCache.GtileCache() + QDir::separator() + "Data.qmdb");
 }
 
+bool OPMaps::LoadTilePack(const QString &file)
+{
+    QWriteLocker locker(&tilePackLock);
+
+    if (file.isEmpty()) {
+        tilePack.Close();
+        return true;
+    }
+    return tilePack.Open(file);
+}
+
+QString OPMaps::TilePackFile()
+{
+    QReadLocker locker(&tilePackLock);
+
+    return tilePack.IsOpen() ? tilePack.FileName() : QString();
+}
+
 diagnostics OPMaps::GetDiagnostics()
 {
     diagnostics i;
@@ -265,6 +297,9 @@ diagnostics OPMaps::GetDiagnostics()
     errorvars.lock();
     i = diag;
     errorvars.unlock();
+    i.memoryHits   = TilesInMemory.Hits();
+    i.memoryMisses = TilesInMemory.Misses();
+    i.memoryUsed   = TilesInMemory.MemoryCacheSize();
     return i;
 }
 }
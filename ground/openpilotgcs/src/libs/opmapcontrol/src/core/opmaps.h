@@ -40,6 +40,9 @@
 #include "alllayersoftype.h"
 #include "urlfactory.h"
 #include "diagnostics.h"
+#include "tilepack.h"
+#include <QThreadStorage>
+#include <QReadWriteLock>
 
 // #include "point.h"
 
@@ -56,6 +59,8 @@ public: ~OPMaps();
     /// </summary>
 
 
+    // The decoded tile, from the memory cache if it is there
+    QImage GetTileImage(const MapType::Types &type, const core::Point &pos, const int &zoom);
     QByteArray GetImageFrom(const MapType::Types &type, const core::Point &pos, const int &zoom);
     bool UseMemoryCache()
     {
@@ -83,6 +88,9 @@ public: ~OPMaps();
     }
     int RetryLoadTile;
     diagnostics GetDiagnostics();
+    // Tiles of the pack are used before the ones of the database, an empty file name closes it
+    bool LoadTilePack(const QString &file);
+    QString TilePackFile();
 
 private:
     bool useMemoryCache;
@@ -99,6 +107,10 @@ private:
     static OPMaps *m_pInstance;
     diagnostics diag;
     QMutex errorvars;
+    // One network manager per loader thread, so connections to the tile servers are kept alive
+    QThreadStorage<QNetworkAccessManager *> networks;
+    QReadWriteLock tilePackLock;
+    TilePack tilePack;
 protected:
     // MemoryCache TilesInMemory;
 };
@@ -28,6 +28,7 @@
 #define PUREIMAGE_H
 
 #include <QPixmap>
+#include <QImage>
 #include <QByteArray>
 
 
@@ -37,6 +38,8 @@ public:
     PureImageProxy();
     static QPixmap FromStream(const QByteArray &array);
     static bool Save(const QByteArray &array, QPixmap &pic);
+    // Decodes a tile in a format that is drawn without conversion, safe outside the GUI thread
+    static QImage Decode(const QByteArray &array);
 };
 }
 #endif // PUREIMAGE_H
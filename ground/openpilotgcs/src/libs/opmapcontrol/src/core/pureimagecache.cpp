@@ -31,13 +31,15 @@
 namespace core {
 qlonglong PureImageCache::ConnCounter = 0;
 
-PureImageCache::PureImageCache()
+PureImageCache::PureImageCache() : generation(0)
 {}
 
 void PureImageCache::setGtileCache(const QString &value)
 {
     lock.lockForWrite();
     gtilecache = value;
+    // Connections to the previous file are reopened when their thread next uses them
+    generation++;
     QDir d;
     if (!d.exists(gtilecache)) {
         d.mkdir(gtilecache);
@@ -101,6 +103,14 @@ bool PureImageCache::CreateEmptyDB(const QString &file)
     if (query.numRowsAffected() == -1) {
 #ifdef DEBUG_PUREIMAGECACHE
         qDebug() << "CreateEmptyDB: " << query.lastError().driverText();
+#endif // DEBUG_PUREIMAGECACHE
+        db.close();
+        return false;
+    }
+    query.exec("CREATE INDEX IF NOT EXISTS IndexOfTiles ON Tiles (X, Y, Zoom, Type)");
+    if (query.numRowsAffected() == -1) {
+#ifdef DEBUG_PUREIMAGECACHE
+        qDebug() << "CreateEmptyDB: " << query.lastError().driverText();
 #endif // DEBUG_PUREIMAGECACHE
         db.close();
         return false;
@@ -158,127 +168,171 @@ bool PureImageCache::CreateEmptyDB(const QString &file)
     QSqlDatabase::removeDatabase(QLatin1String("CreateConn"));
     return true;
 }
+PureImageCache::Connection::Connection(const QString &name, const QString &file, int generation) :
+    name(name), generation(generation)
+{
+    db = QSqlDatabase::addDatabase("QSQLITE", name);
+    db.setDatabaseName(file);
+    // Without a shared cache SQLite locks the whole file, wait for the other threads instead of failing
+    db.setConnectOptions("QSQLITE_BUSY_TIMEOUT=5000");
+    if (!db.open()) {
+#ifdef DEBUG_PUREIMAGECACHE
+        qDebug() << "Connection: Unable to open" << file << db.lastError().driverText();
+#endif // DEBUG_PUREIMAGECACHE
+        return;
+    }
+
+    QSqlQuery query(db);
+    // With a write ahead log the map threads keep reading while the cache thread writes
+    query.exec("PRAGMA journal_mode=WAL");
+    query.exec("PRAGMA synchronous=NORMAL");
+    // Caches created before the index existed get it now
+    query.exec("CREATE INDEX IF NOT EXISTS IndexOfTiles ON Tiles (X, Y, Zoom, Type)");
+
+    selectTile = QSqlQuery(db);
+    selectTile.prepare("SELECT Tile FROM TilesData WHERE id = (SELECT id FROM Tiles WHERE X=? AND Y=? AND Zoom=? AND Type=?)");
+    insertTile = QSqlQuery(db);
+    insertTile.prepare("INSERT INTO Tiles(X, Y, Zoom, Type,Date) VALUES(?, ?, ?, ?,?)");
+    insertTileData = QSqlQuery(db);
+    insertTileData.prepare("INSERT INTO TilesData(id, Tile) VALUES((SELECT last_insert_rowid()), ?)");
+}
+
+PureImageCache::Connection::~Connection()
+{
+    // The statements have to go before the connection can be removed
+    selectTile     = QSqlQuery();
+    insertTile     = QSqlQuery();
+    insertTileData = QSqlQuery();
+    db.close();
+    db = QSqlDatabase();
+    QSqlDatabase::removeDatabase(name);
+}
+
+bool PureImageCache::Connection::insert(const QByteArray &tile, const MapType::Types &type, const Point &pos, const int &zoom)
+{
+    insertTile.bindValue(0, pos.X());
+    insertTile.bindValue(1, pos.Y());
+    insertTile.bindValue(2, zoom);
+    insertTile.bindValue(3, (int)type);
+    insertTile.bindValue(4, QDateTime::currentDateTime().toString());
+    if (!insertTile.exec()) {
+#ifdef DEBUG_PUREIMAGECACHE
+        qDebug() << "insert: " << insertTile.lastError().driverText();
+#endif // DEBUG_PUREIMAGECACHE
+        return false;
+    }
+    insertTileData.bindValue(0, tile);
+    return insertTileData.exec();
+}
+
+PureImageCache::Connection *PureImageCache::connection()
+{
+    Connection *cn = connections.localData();
+
+    if (!cn || cn->generation != generation || !cn->isOpen()) {
+        Mcounter.lock();
+        qlonglong id = ++ConnCounter;
+        Mcounter.unlock();
+        // Replacing the local data deletes the old connection
+        cn = new Connection(QString::number(id), gtilecache + "Data.qmdb", generation);
+        connections.setLocalData(cn);
+    }
+    return cn->isOpen() ? cn : NULL;
+}
+
 bool PureImageCache::PutImageToCache(const QByteArray &tile, const MapType::Types &type, const Point &pos, const int &zoom)
 {
+    QReadLocker locker(&lock);
+
     if (gtilecache.isEmpty() | gtilecache.isNull()) {
         return false;
     }
-    lock.lockForRead();
 #ifdef DEBUG_PUREIMAGECACHE
     qDebug() << "PutImageToCache Start:"; // <<pos;
 #endif // DEBUG_PUREIMAGECACHE
-    Mcounter.lock();
-    qlonglong id = ++ConnCounter;
-    Mcounter.unlock();
-    {
-        QSqlDatabase cn;
-        cn = QSqlDatabase::addDatabase("QSQLITE", QString::number(id));
-        QString db = gtilecache + "Data.qmdb";
-        cn.setDatabaseName(db);
-        cn.setConnectOptions("QSQLITE_ENABLE_SHARED_CACHE");
-        if (cn.open()) {
-            {
-                QSqlQuery query(cn);
-                query.prepare("INSERT INTO Tiles(X, Y, Zoom, Type,Date) VALUES(?, ?, ?, ?,?)");
-                query.addBindValue(pos.X());
-                query.addBindValue(pos.Y());
-                query.addBindValue(zoom);
+    Connection *cn = connection();
+    if (!cn) {
+        return false;
+    }
+    return cn->insert(tile, type, pos, zoom);
+}
+bool PureImageCache::PutImagesToCache(const QList<CacheItemQueue *> &tiles)
+{
+    QReadLocker locker(&lock);
 
-                query.addBindValue((int)type);
-                query.addBindValue(QDateTime::currentDateTime().toString());
-                query.exec();
-            }
-            {
-                QSqlQuery query(cn);
-                query.prepare("INSERT INTO TilesData(id, Tile) VALUES((SELECT last_insert_rowid()), ?)");
-                query.addBindValue(tile);
-                query.exec();
-            }
-            cn.close();
-        }
+    if (gtilecache.isEmpty() | gtilecache.isNull()) {
+        return false;
     }
-    QSqlDatabase::removeDatabase(QString::number(id));
-    lock.unlock();
-    return true;
+    Connection *cn = connection();
+    if (!cn) {
+        return false;
+    }
+    // It is the commit that costs, not the insert
+    bool ret = true;
+    cn->db.transaction();
+    foreach(CacheItemQueue * tile, tiles) {
+        ret &= cn->insert(tile->GetImg(), tile->GetMapType(), tile->GetPosition(), tile->GetZoom());
+    }
+    ret &= cn->db.commit();
+    return ret;
 }
 QByteArray PureImageCache::GetImageFromCache(MapType::Types type, Point pos, int zoom)
 {
-    lock.lockForRead();
+    QReadLocker locker(&lock);
     QByteArray ar;
+
     if (gtilecache.isEmpty() | gtilecache.isNull()) {
         return ar;
     }
-    QString dir  = gtilecache;
-    Mcounter.lock();
-    qlonglong id = ++ConnCounter;
-    Mcounter.unlock();
 #ifdef DEBUG_PUREIMAGECACHE
-    qDebug() << "Cache dir=" << dir << " Try to GET:" << pos.X() + "," + pos.Y();
+    qDebug() << "Cache dir=" << gtilecache << " Try to GET:" << pos.X() + "," + pos.Y();
 #endif // DEBUG_PUREIMAGECACHE
-
-    {
-        QString db = dir + "Data.qmdb";
-        {
-            QSqlDatabase cn;
-
-            cn = QSqlDatabase::addDatabase("QSQLITE", QString::number(id));
-
-            cn.setDatabaseName(db);
-            cn.setConnectOptions("QSQLITE_ENABLE_SHARED_CACHE");
-            if (cn.open()) {
-                {
-                    QSqlQuery query(cn);
-                    query.exec(QString("SELECT Tile FROM TilesData WHERE id = (SELECT id FROM Tiles WHERE X=%1 AND Y=%2 AND Zoom=%3 AND Type=%4)").arg(pos.X()).arg(pos.Y()).arg(zoom).arg((int)type));
-                    query.next();
-                    if (query.isValid()) {
-                        ar = query.value(0).toByteArray();
-                    }
-                }
-                cn.close();
-            }
-        }
+    Connection *cn = connection();
+    if (!cn) {
+        return ar;
     }
-    QSqlDatabase::removeDatabase(QString::number(id));
-    lock.unlock();
+    cn->selectTile.bindValue(0, pos.X());
+    cn->selectTile.bindValue(1, pos.Y());
+    cn->selectTile.bindValue(2, zoom);
+    cn->selectTile.bindValue(3, (int)type);
+    if (cn->selectTile.exec() && cn->selectTile.next()) {
+        ar = cn->selectTile.value(0).toByteArray();
+    }
+    // Ends the read transaction so the log can be checkpointed
+    cn->selectTile.finish();
     return ar;
 }
 void PureImageCache::deleteOlderTiles(int const & days)
 {
+    QReadLocker locker(&lock);
+
     if (gtilecache.isEmpty() | gtilecache.isNull()) {
         return;
     }
+    if (!QFileInfo(gtilecache + "Data.qmdb").exists()) {
+        return;
+    }
+    Connection *cn = connection();
+    if (!cn) {
+        return;
+    }
     QList<long> add;
-    bool ret    = true;
-    QString dir = gtilecache;
     {
-        QString db = dir + "Data.qmdb";
-        ret = QFileInfo(db).exists();
-        if (ret) {
-            QSqlDatabase cn;
-            Mcounter.lock();
-            qlonglong id = ++ConnCounter;
-            Mcounter.unlock();
-            cn = QSqlDatabase::addDatabase("QSQLITE", QString::number(id));
-            cn.setDatabaseName(db);
-            cn.setConnectOptions("QSQLITE_ENABLE_SHARED_CACHE");
-            if (cn.open()) {
-                {
-                    QSqlQuery query(cn);
-                    query.exec(QString("SELECT id, X, Y, Zoom, Type, Date FROM Tiles"));
-                    while (query.next()) {
-                        if (QDateTime::fromString(query.value(5).toString()).daysTo(QDateTime::currentDateTime()) > days) {
-                            add.append(query.value(0).toLongLong());
-                        }
-                    }
-                    foreach(long i, add) {
-                        query.exec(QString("DELETE FROM Tiles WHERE id = %1;").arg(i));
-                    }
-                }
-
-                cn.close();
+        QSqlQuery query(cn->db);
+        query.exec(QString("SELECT id, X, Y, Zoom, Type, Date FROM Tiles"));
+        while (query.next()) {
+            if (QDateTime::fromString(query.value(5).toString()).daysTo(QDateTime::currentDateTime()) > days) {
+                add.append(query.value(0).toLongLong());
             }
-            QSqlDatabase::removeDatabase(QString::number(id));
         }
+        query.finish();
+        cn->db.transaction();
+        query.prepare("DELETE FROM Tiles WHERE id = ?");
+        foreach(long i, add) {
+            query.bindValue(0, (qlonglong)i);
+            query.exec();
+        }
+        cn->db.commit();
     }
 }
 // PureImageCache::ExportMapDataToDB("C:/Users/Xapo/Documents/mapcontrol/debug/mapscache/data.qmdb","C:/Users/Xapo/Documents/mapcontrol/debug/mapscache/data2.qmdb");
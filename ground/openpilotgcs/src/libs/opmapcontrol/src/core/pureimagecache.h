@@ -42,19 +42,48 @@
 #include <QList>
 #include <QMutex>
 #include <QReadWriteLock>
+#include <QThreadStorage>
+#include "cacheitemqueue.h"
 namespace core {
 class PureImageCache {
 public:
     PureImageCache();
     static bool CreateEmptyDB(const QString &file);
     bool PutImageToCache(const QByteArray &tile, const MapType::Types &type, const core::Point &pos, const int &zoom);
+    // Inserts all tiles in a single transaction
+    bool PutImagesToCache(const QList<CacheItemQueue *> &tiles);
     QByteArray GetImageFromCache(MapType::Types type, core::Point pos, int zoom);
     QString GtileCache();
     void setGtileCache(const QString &value);
     static bool ExportMapDataToDB(QString sourceFile, QString destFile);
     void deleteOlderTiles(int const & days);
 private:
+    // Database connection of one thread with its prepared statements. It is
+    // kept open until the thread ends or the cache is moved to another file.
+    class Connection {
+public:
+        Connection(const QString &name, const QString &file, int generation);
+        ~Connection();
+        bool isOpen() const
+        {
+            return db.isOpen();
+        }
+        bool insert(const QByteArray &tile, const MapType::Types &type, const core::Point &pos, const int &zoom);
+
+        QString name;
+        int generation;
+        QSqlDatabase db;
+        QSqlQuery selectTile;
+        QSqlQuery insertTile;
+        QSqlQuery insertTileData;
+    };
+    // The connection of the calling thread, NULL if the database can not be opened
+    Connection *connection();
+
     QString gtilecache;
+    // Incremented whenever gtilecache changes
+    int generation;
+    QThreadStorage<Connection *> connections;
     QMutex Mcounter;
     QReadWriteLock lock;
     static qlonglong ConnCounter;
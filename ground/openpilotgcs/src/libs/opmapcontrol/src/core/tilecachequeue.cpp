@@ -71,26 +71,29 @@ void TileCacheQueue::run()
     qDebug() << "Cache Engine Start";
 #endif // DEBUG_TILECACHEQUEUE
     while (true) {
-        CacheItemQueue *task;
+        QList<CacheItemQueue *> tasks;
 #ifdef DEBUG_TILECACHEQUEUE
         qDebug() << "Cache";
 #endif // DEBUG_TILECACHEQUEUE
-        if (tileCacheQueue.count() > 0) {
-            mutex.lock();
-            task = tileCacheQueue.dequeue();
-            mutex.unlock();
+        // Everything that queued up while the last batch was written goes in the next one
+        mutex.lock();
+        while (!tileCacheQueue.isEmpty() && tasks.count() < MaxBatchSize) {
+            tasks.append(tileCacheQueue.dequeue());
+        }
+        mutex.unlock();
+        if (!tasks.isEmpty()) {
 #ifdef DEBUG_TILECACHEQUEUE
-            qDebug() << "Cache engine Put:" << task->GetPosition().X() << "," << task->GetPosition().Y();
+            qDebug() << "Cache engine Put:" << tasks.count() << "tiles";
 #endif // DEBUG_TILECACHEQUEUE
-            Cache::Instance()->ImageCache.PutImageToCache(task->GetImg(), task->GetMapType(), task->GetPosition(), task->GetZoom());
-            usleep(44);
-            delete task;
+            Cache::Instance()->ImageCache.PutImagesToCache(tasks);
+            qDeleteAll(tasks);
         } else {
             qDebug() << "Cache engine BEGIN WAIT";
             waitmutex.lock();
-            int tout = 4000;
-            if (!waitc.wait(&waitmutex, tout)) {
-                waitmutex.unlock();
+            int tout   = 4000;
+            bool woken = waitc.wait(&waitmutex, tout);
+            waitmutex.unlock();
+            if (!woken) {
 #ifdef DEBUG_TILECACHEQUEUE
                 qDebug() << "Cache Engine TimeOut";
 #endif // DEBUG_TILECACHEQUEUE
@@ -102,7 +105,6 @@ void TileCacheQueue::run()
                 mutex.unlock();
             }
             qDebug() << "Cache Engine DID NOT TimeOut";
-            waitmutex.unlock();
         }
     }
 #ifdef DEBUG_TILECACHEQUEUE
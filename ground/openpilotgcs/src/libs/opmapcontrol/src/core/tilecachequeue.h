@@ -49,6 +49,8 @@ public:
 protected:
     QQueue<CacheItemQueue *> tileCacheQueue;
 private:
+    // Most tiles written in one transaction
+    static const int MaxBatchSize = 64;
     void run();
     QMutex mutex;
     QMutex waitmutex;
@@ -0,0 +1,249 @@
+/**
+ ******************************************************************************
+ *
+ * @file       tilepack.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @brief
+ * @see        The GNU Public License (GPL) Version 3
+ * @defgroup   OPMapWidget
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "tilepack.h"
+#include <QtEndian>
+#include <QDebug>
+#include <algorithm>
+
+namespace core {
+const char TilePack::Magic[8] = { 'O', 'P', 'T', 'P', 'A', 'C', 'K', 0 };
+
+static quint64 SpreadBits(quint32 value)
+{
+    quint64 x = value & 0x3fffff;
+
+    x = (x | (x << 16)) & Q_UINT64_C(0x0000ffff0000ffff);
+    x = (x | (x << 8)) & Q_UINT64_C(0x00ff00ff00ff00ff);
+    x = (x | (x << 4)) & Q_UINT64_C(0x0f0f0f0f0f0f0f0f);
+    x = (x | (x << 2)) & Q_UINT64_C(0x3333333333333333);
+    x = (x | (x << 1)) & Q_UINT64_C(0x5555555555555555);
+    return x;
+}
+
+quint64 TilePack::Key(const MapType::Types &type, const Point &pos, const int &zoom)
+{
+    // 15 bits of type, 5 of zoom and 22 of x and y each, up to zoom 22
+    return ((quint64)(type & 0x7fff) << 49) | ((quint64)(zoom & 0x1f) << 44) |
+           SpreadBits(pos.X()) | (SpreadBits(pos.Y()) << 1);
+}
+
+TilePack::TilePack() : data(0), size(0), index(0), count(0)
+{}
+
+TilePack::~TilePack()
+{
+    Close();
+}
+
+bool TilePack::Open(const QString &fileName)
+{
+    Close();
+    file.setFileName(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qDebug() << "TilePack: cannot open" << fileName << file.errorString();
+        return false;
+    }
+    size = file.size();
+    if (size >= HeaderSize) {
+        data = file.map(0, size);
+    }
+    if (!data || memcmp(data, Magic, sizeof(Magic)) != 0 ||
+        qFromLittleEndian<quint32>(data + 8) != Version) {
+        qDebug() << "TilePack:" << fileName << "is not a tile pack";
+        Close();
+        return false;
+    }
+    quint32 n = qFromLittleEndian<quint32>(data + 12);
+    if (HeaderSize + (qint64)n * IndexItemSize > size) {
+        qDebug() << "TilePack:" << fileName << "is truncated";
+        Close();
+        return false;
+    }
+    index = data + HeaderSize;
+    count = n;
+    return true;
+}
+
+void TilePack::Close()
+{
+    if (data) {
+        file.unmap(data);
+    }
+    file.close();
+    data  = 0;
+    size  = 0;
+    index = 0;
+    count = 0;
+}
+
+QByteArray TilePack::GetImage(const MapType::Types &type, const Point &pos, const int &zoom) const
+{
+    if (!index) {
+        return QByteArray();
+    }
+    quint64 key = Key(type, pos, zoom);
+    quint32 low = 0;
+    quint32 high = count;
+    while (low < high) {
+        quint32 middle = low + (high - low) / 2;
+        const uchar *item = index + (qint64)middle * IndexItemSize;
+        quint64 itemKey = qFromLittleEndian<quint64>(item);
+        if (itemKey < key) {
+            low = middle + 1;
+        } else if (itemKey > key) {
+            high = middle;
+        } else {
+            quint64 offset = qFromLittleEndian<quint64>(item + 8);
+            quint32 length = qFromLittleEndian<quint32>(item + 16);
+            if (offset + length > (quint64)size) {
+                return QByteArray();
+            }
+            // Copied, the pack may be closed while the tile is still in use
+            return QByteArray((const char *)data + offset, length);
+        }
+    }
+    return QByteArray();
+}
+
+TilePackWriter::TilePackWriter()
+{}
+
+TilePackWriter::~TilePackWriter()
+{
+    if (images.isOpen()) {
+        Abort();
+    }
+}
+
+bool TilePackWriter::Open(const QString &fileName)
+{
+    QMutexLocker locker(&mutex);
+
+    this->fileName = fileName;
+    items.clear();
+    keys.clear();
+    images.setFileName(fileName + ".images");
+    if (!images.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qDebug() << "TilePackWriter: cannot create" << images.fileName() << images.errorString();
+        return false;
+    }
+    return true;
+}
+
+bool TilePackWriter::AddImage(const MapType::Types &type, const Point &pos, const int &zoom, const QByteArray &image)
+{
+    QMutexLocker locker(&mutex);
+
+    quint64 key = TilePack::Key(type, pos, zoom);
+
+    if (keys.contains(key)) {
+        return true;
+    }
+    Item item;
+    item.key    = key;
+    item.offset = images.pos();
+    item.size   = image.size();
+    if (images.write(image) != image.size()) {
+        return false;
+    }
+    items.append(item);
+    keys.insert(key);
+    return true;
+}
+
+bool TilePackWriter::Contains(const MapType::Types &type, const Point &pos, const int &zoom)
+{
+    QMutexLocker locker(&mutex);
+
+    return keys.contains(TilePack::Key(type, pos, zoom));
+}
+
+int TilePackWriter::Count()
+{
+    QMutexLocker locker(&mutex);
+
+    return items.count();
+}
+
+bool TilePackWriter::Finish()
+{
+    QMutexLocker locker(&mutex);
+
+    if (!images.isOpen()) {
+        return false;
+    }
+    images.close();
+    std::sort(items.begin(), items.end());
+
+    QFile pack(fileName + ".part");
+    if (!pack.open(QIODevice::WriteOnly | QIODevice::Truncate) || !images.open(QIODevice::ReadOnly)) {
+        qDebug() << "TilePackWriter: cannot write" << pack.fileName();
+        images.remove();
+        return false;
+    }
+    quint64 base = TilePack::HeaderSize + (quint64)items.count() * TilePack::IndexItemSize;
+    QByteArray header(TilePack::HeaderSize, 0);
+    memcpy(header.data(), TilePack::Magic, sizeof(TilePack::Magic));
+    qToLittleEndian<quint32>(TilePack::Version, (uchar *)header.data() + 8);
+    qToLittleEndian<quint32>(items.count(), (uchar *)header.data() + 12);
+    QByteArray index(items.count() * TilePack::IndexItemSize, 0);
+    uchar *item = (uchar *)index.data();
+    for (int i = 0; i < items.count(); i++, item += TilePack::IndexItemSize) {
+        qToLittleEndian<quint64>(items[i].key, item);
+        qToLittleEndian<quint64>(base + items[i].offset, item + 8);
+        qToLittleEndian<quint32>(items[i].size, item + 16);
+    }
+    bool ok = pack.write(header) == header.size() && pack.write(index) == index.size();
+    while (ok && !images.atEnd()) {
+        QByteArray chunk = images.read(1048576);
+        ok = !chunk.isEmpty() && pack.write(chunk) == chunk.size();
+    }
+    pack.close();
+    images.remove();
+    items.clear();
+    keys.clear();
+    if (ok) {
+        QFile::remove(fileName);
+        ok = pack.rename(fileName);
+    }
+    if (!ok) {
+        qDebug() << "TilePackWriter: failed writing" << fileName;
+        pack.remove();
+    }
+    return ok;
+}
+
+void TilePackWriter::Abort()
+{
+    QMutexLocker locker(&mutex);
+
+    images.close();
+    images.remove();
+    items.clear();
+    keys.clear();
+}
+}
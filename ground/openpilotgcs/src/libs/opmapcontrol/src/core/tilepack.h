@@ -0,0 +1,118 @@
+/**
+ ******************************************************************************
+ *
+ * @file       tilepack.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @brief
+ * @see        The GNU Public License (GPL) Version 3
+ * @defgroup   OPMapWidget
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef TILEPACK_H
+#define TILEPACK_H
+
+#include "maptype.h"
+#include "point.h"
+#include <QByteArray>
+#include <QFile>
+#include <QMutex>
+#include <QSet>
+#include <QString>
+#include <QVector>
+namespace core {
+/**
+ * Read only file of map tiles for offline use.
+ *
+ * A header, the index of all tiles sorted by key and then the tile images. The
+ * key interleaves the bits of the tile x and y below the map type and zoom, so
+ * tiles that are close on the map are close in the index. The file is mapped
+ * in memory and a lookup is a binary search of the index, safe from any thread
+ * once the pack is open.
+ */
+class TilePack {
+public:
+    TilePack();
+    ~TilePack();
+    bool Open(const QString &fileName);
+    void Close();
+    bool IsOpen() const
+    {
+        return index != 0;
+    }
+    QString FileName() const
+    {
+        return file.fileName();
+    }
+    int Count() const
+    {
+        return count;
+    }
+    // Empty if the tile is not in the pack
+    QByteArray GetImage(const MapType::Types &type, const core::Point &pos, const int &zoom) const;
+
+    static quint64 Key(const MapType::Types &type, const core::Point &pos, const int &zoom);
+
+    static const char Magic[8];
+    static const quint32 Version   = 1;
+    static const int HeaderSize    = 16;
+    static const int IndexItemSize = 24;
+private:
+    TilePack(TilePack const &);
+    TilePack & operator=(TilePack const &);
+    QFile file;
+    uchar *data;
+    qint64 size;
+    const uchar *index;
+    quint32 count;
+};
+
+/**
+ * Builds a tile pack, from as many threads as needed. The images go to a
+ * temporary file as they arrive, Finish() writes the sorted index and copies
+ * them after it.
+ */
+class TilePackWriter {
+public:
+    TilePackWriter();
+    ~TilePackWriter();
+    bool Open(const QString &fileName);
+    // False if the tile could not be written, a tile that is already in the pack is ignored
+    bool AddImage(const MapType::Types &type, const core::Point &pos, const int &zoom, const QByteArray &image);
+    bool Contains(const MapType::Types &type, const core::Point &pos, const int &zoom);
+    int Count();
+    bool Finish();
+    void Abort();
+private:
+    struct Item {
+        quint64 key;
+        quint64 offset;
+        quint32 size;
+        bool operator<(const Item &other) const
+        {
+            return key < other.key;
+        }
+    };
+    QMutex mutex;
+    QString fileName;
+    QFile images;
+    QVector<Item> items;
+    QSet<quint64> keys;
+};
+}
+#endif // TILEPACK_H
@@ -26,6 +26,8 @@
  */
 #include "core.h"
 
+#include <algorithm>
+
 #ifdef DEBUG_CORE
 qlonglong internals::Core::debugcounter = 0;
 #endif
@@ -109,27 +111,28 @@ void Core::run()
                             int retry = 0;
 
                             do {
-                                QByteArray img;
+                                // Decoded here rather than in the GUI thread each time the tile is drawn
+                                QImage image;
 
                                 // tile number inversion(BottomLeft -> TopLeft) for pergo maps
                                 if (tl == MapType::PergoTurkeyMap) {
-                                    img = OPMaps::Instance()->GetImageFrom(tl, Point(task.Pos.X(), maxOfTiles.Height() - task.Pos.Y()), task.Zoom);
+                                    image = OPMaps::Instance()->GetTileImage(tl, Point(task.Pos.X(), maxOfTiles.Height() - task.Pos.Y()), task.Zoom);
                                 } else { // ok
 #ifdef DEBUG_CORE
                                     qDebug() << "start getting image" << " ID=" << debug;
 #endif // DEBUG_CORE
-                                    img = OPMaps::Instance()->GetImageFrom(tl, task.Pos, task.Zoom);
+                                    image = OPMaps::Instance()->GetTileImage(tl, task.Pos, task.Zoom);
 #ifdef DEBUG_CORE
-                                    qDebug() << "Core::run:gotimage size:" << img.count() << " ID=" << debug << " time=" << t.elapsed();
+                                    qDebug() << "Core::run:gotimage size:" << image.size() << " ID=" << debug << " time=" << t.elapsed();
 #endif // DEBUG_CORE
                                 }
 
-                                if (img.length() != 0) {
+                                if (!image.isNull()) {
                                     Moverlays.lock();
                                     {
-                                        t->Overlays.append(img);
+                                        t->Overlays.append(image);
 #ifdef DEBUG_CORE
-                                        qDebug() << "Core::run append img:" << img.length() << " to tile:" << t->GetPos().ToString() << " now has " << t->Overlays.count() << " overlays" << " ID=" << debug;
+                                        qDebug() << "Core::run append img:" << image.size() << " to tile:" << t->GetPos().ToString() << " now has " << t->Overlays.count() << " overlays" << " ID=" << debug;
 #endif // DEBUG_CORE
                                     }
                                     Moverlays.unlock();
@@ -139,12 +142,7 @@ void Core::run()
 #ifdef DEBUG_CORE
                                     qDebug() << "ProcessLoadTask: " << task.ToString() << " -> empty tile, retry " << retry << " ID=" << debug;;
 #endif // DEBUG_CORE
-                                    {
-                                        QWaitCondition wait;
-                                        QMutex m;
-                                        m.lock();
-                                        wait.wait(&m, 500);
-                                    }
+                                    QThread::msleep(500);
                                 }
                             } while (++retry < OPMaps::Instance()->RetryLoadTile);
                         }
@@ -173,10 +171,6 @@ void Core::run()
                 {
                     // last buddy cleans stuff ;}
                     if (last) {
-                        OPMaps::Instance()->kiberCacheLock.lockForWrite();
-                        OPMaps::Instance()->TilesInMemory.RemoveMemoryOverload();
-                        OPMaps::Instance()->kiberCacheLock.unlock();
-
                         MtileDrawingList.lock();
                         {
                             Matrix.ClearPointsNotIn(tileDrawingList);
@@ -404,10 +398,7 @@ PointLatLng Core::FromLocalToLatLng(int const & x, int const & y)
 
 Point Core::FromLatLngToLocal(PointLatLng const & latlng)
 {
-    Point pLocal = Projection()->FromLatLngToPixel(latlng, Zoom());
-
-    pLocal.Offset(renderOffset);
-    return pLocal;
+    return FromPixelToLocal(Projection()->FromLatLngToPixel(latlng, Zoom()));
 }
 int Core::GetMaxZoomToFitRect(RectLatLng const & rect)
 {
@@ -552,11 +543,33 @@ void Core::CancelAsyncTasks()
         // ProcessLoadTaskCallback.waitForDone();
     }
 }
+/**
+ * Orders tiles by their distance from the centre tile of the view
+ */
+struct CloserToCenter {
+    CloserToCenter(const Point &center) : center(center) {}
+    bool operator()(const Point &a, const Point &b) const
+    {
+        return distance(a) < distance(b);
+    }
+    int distance(const Point &p) const
+    {
+        int dx = p.X() - center.X();
+        int dy = p.Y() - center.Y();
+
+        return dx * dx + dy * dy;
+    }
+    Point center;
+};
+
 void Core::UpdateBounds()
 {
     MtileDrawingList.lock();
     {
         FindTilesAround(tileDrawingList);
+        // The loaders take tiles from the front of the queue, so the tiles the
+        // user looks at fill in first
+        std::stable_sort(tileDrawingList.begin(), tileDrawingList.end(), CloserToCenter(centerTileXYLocation));
 
 #ifdef DEBUG_CORE
         qDebug() << "OnTileLoadStart: " << tileDrawingList.count() << " tiles to load at zoom " << Zoom() << ", time: " << QDateTime::currentDateTime().date();
@@ -565,25 +578,30 @@ void Core::UpdateBounds()
         emit OnTileLoadStart();
 
 
-        foreach(Point p, tileDrawingList) {
-            LoadTask task = LoadTask(p, Zoom());
-            {
-                MtileLoadQueue.lock();
-                {
-                    if (!tileLoadQueue.contains(task)) {
-                        MtileToload.lock();
-                        ++tilesToload;
-                        MtileToload.unlock();
-                        tileLoadQueue.enqueue(task);
+        MtileLoadQueue.lock();
+        {
+            // Rebuild the queue in drawing order, tiles that left the view are not loaded anymore
+            QQueue<LoadTask> queue;
+            foreach(Point p, tileDrawingList) {
+                LoadTask task = LoadTask(p, Zoom());
+                queue.enqueue(task);
+                if (!tileLoadQueue.removeOne(task)) {
+                    MtileToload.lock();
+                    ++tilesToload;
+                    MtileToload.unlock();
 #ifdef DEBUG_CORE
-                        qDebug() << "Core::UpdateBounds new Task" << task.Pos.ToString();
+                    qDebug() << "Core::UpdateBounds new Task" << task.Pos.ToString();
 #endif // DEBUG_CORE
-                        ProcessLoadTaskCallback.start(this);
-                    }
+                    ProcessLoadTaskCallback.start(this);
                 }
-                MtileLoadQueue.unlock();
             }
+            // Their runs find an empty queue and just return
+            MtileToload.lock();
+            tilesToload -= tileLoadQueue.count();
+            MtileToload.unlock();
+            tileLoadQueue = queue;
         }
+        MtileLoadQueue.unlock();
     }
     MtileDrawingList.unlock();
     UpdateGroundResolution();
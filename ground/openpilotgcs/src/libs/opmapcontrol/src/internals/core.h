@@ -274,6 +274,12 @@ public:
 
     Point FromLatLngToLocal(PointLatLng const & latlng);
 
+    Point FromPixelToLocal(Point pixel) const
+    {
+        pixel.Offset(renderOffset);
+        return pixel;
+    }
+
     int GetMaxZoomToFitRect(RectLatLng const & rect);
 
     void BeginDrag(core::Point const & pt);
@@ -67,6 +67,38 @@ internals::PointLatLng MercatorProjection::FromPixelToLatLng(const int &x, const
 
     return ret;
 }
+void MercatorProjection::FromLatLngsToPixels(const internals::PointLatLng *points, core::Point *pixels, int count, int zoom)
+{
+    Size s = GetTileMatrixSizePixel(zoom);
+    const double mapSizeX = s.Width();
+    const double mapSizeY = s.Height();
+
+    // Same arithmetic as FromLatLngToPixel(), so that both give the same pixels
+    for (int i = 0; i < count; i++) {
+        double lat = Clip(points[i].Lat(), MinLatitude, MaxLatitude);
+        double lng = Clip(points[i].Lng(), MinLongitude, MaxLongitude);
+
+        double x   = (lng + 180) / 360;
+        double sinLatitude = sin(lat * M_PI / 180);
+        double y   = 0.5 - log((1 + sinLatitude) / (1 - sinLatitude)) / (4 * M_PI);
+
+        pixels[i].SetX((int)Clip(x * mapSizeX + 0.5, 0, mapSizeX - 1));
+        pixels[i].SetY((int)Clip(y * mapSizeY + 0.5, 0, mapSizeY - 1));
+    }
+}
+void MercatorProjection::FromPixelsToLatLngs(const core::Point *pixels, internals::PointLatLng *points, int count, int zoom)
+{
+    Size s = GetTileMatrixSizePixel(zoom);
+    const double mapSizeX = s.Width();
+    const double mapSizeY = s.Height();
+
+    for (int i = 0; i < count; i++) {
+        double xx = (Clip(pixels[i].X(), 0, mapSizeX - 1) / mapSizeX) - 0.5;
+        double yy = 0.5 - (Clip(pixels[i].Y(), 0, mapSizeY - 1) / mapSizeY);
+        points[i].SetLat(90 - 360 * atan(exp(-yy * 2 * M_PI)) / M_PI);
+        points[i].SetLng(360 * xx);
+    }
+}
 double MercatorProjection::Clip(const double &n, const double &minValue, const double &maxValue) const
 {
     return qMin(qMax(n, minValue), maxValue);
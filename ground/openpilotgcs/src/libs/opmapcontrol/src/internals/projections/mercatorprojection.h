@@ -42,6 +42,8 @@ public:
     virtual double Flattening() const;
     virtual core::Point FromLatLngToPixel(double lat, double lng, int const & zoom);
     virtual internals::PointLatLng FromPixelToLatLng(const int &x, const int &y, const int &zoom);
+    virtual void FromLatLngsToPixels(const internals::PointLatLng *points, core::Point *pixels, int count, int zoom);
+    virtual void FromPixelsToLatLngs(const core::Point *pixels, internals::PointLatLng *points, int count, int zoom);
     virtual Size GetTileMatrixMinXY(const int &zoom);
     virtual Size GetTileMatrixMaxXY(const int &zoom);
 private:
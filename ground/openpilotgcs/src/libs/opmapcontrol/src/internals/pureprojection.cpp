@@ -49,6 +49,20 @@ PointLatLng PureProjection::FromPixelToLatLng(const Point &p, const int &zoom)
     return FromPixelToLatLng(p.X(), p.Y(), zoom);
 }
 
+void PureProjection::FromLatLngsToPixels(const PointLatLng *points, core::Point *pixels, int count, int zoom)
+{
+    for (int i = 0; i < count; i++) {
+        pixels[i] = FromLatLngToPixel(points[i].Lat(), points[i].Lng(), zoom);
+    }
+}
+
+void PureProjection::FromPixelsToLatLngs(const core::Point *pixels, PointLatLng *points, int count, int zoom)
+{
+    for (int i = 0; i < count; i++) {
+        points[i] = FromPixelToLatLng(pixels[i].X(), pixels[i].Y(), zoom);
+    }
+}
+
 Point PureProjection::FromPixelToTileXY(const Point &p)
 {
     return Point((int)(p.X() / TileSize().Width()), (int)(p.Y() / TileSize().Height()));
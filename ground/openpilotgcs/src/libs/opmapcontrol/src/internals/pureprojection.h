@@ -56,6 +56,10 @@ public:
     core::Point FromLatLngToPixel(const PointLatLng &p, const int &zoom);
 
     PointLatLng FromPixelToLatLng(const Point &p, const int &zoom);
+
+    // Projects count points at once, the projections hoist what only depends on the zoom out of the loop
+    virtual void FromLatLngsToPixels(const PointLatLng *points, core::Point *pixels, int count, int zoom);
+    virtual void FromPixelsToLatLngs(const core::Point *pixels, PointLatLng *points, int count, int zoom);
     virtual core::Point FromPixelToTileXY(const core::Point &p);
     virtual core::Point FromTileXYToPixel(const core::Point &p);
     virtual Size GetTileMatrixMinXY(const int &zoom) = 0;
@@ -66,7 +66,8 @@ public:
     {
         return !(zoom == 0);
     }
-    QList<QByteArray> Overlays;
+    // Decoded images of the layers, drawn as they are
+    QList<QImage> Overlays;
 protected:
 
     QMutex mutex;
@@ -37,10 +37,7 @@ GPSItem::GPSItem(MapGraphicItem *map, OPMapWidget *parent, QString uavPic) : map
     localposition = map->FromLatLngToLocal(mapwidget->CurrentPosition());
     this->setPos(localposition.X(), localposition.Y());
     this->setZValue(4);
-    trail     = new QGraphicsItemGroup(this);
-    trail->setParentItem(map);
-    trailLine = new QGraphicsItemGroup(this);
-    trailLine->setParentItem(map);
+    trail = new TrailItem(Qt::red, Qt::green, map);
     this->setFlag(QGraphicsItem::ItemIgnoresTransformations, true);
     setCacheMode(QGraphicsItem::ItemCoordinateCache);
     mapfollowtype = UAVMapFollowType::None;
@@ -51,7 +48,9 @@ GPSItem::GPSItem(MapGraphicItem *map, OPMapWidget *parent, QString uavPic) : map
     connect(map, SIGNAL(childSetOpacity(qreal)), this, SLOT(setOpacitySlot(qreal)));
 }
 GPSItem::~GPSItem()
-{}
+{
+    delete trail;
+}
 
 void GPSItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
 {
@@ -71,29 +70,13 @@ void GPSItem::SetUAVPos(const internals::PointLatLng &position, const int &altit
     if (coord != position) {
         if (trailtype == UAVTrailType::ByTimeElapsed) {
             if (timer.elapsed() > trailtime * 1000) {
-                TrailItem *ob = new TrailItem(position, altitude, Qt::red, map);
-                trail->addToGroup(ob);
-                connect(this, SIGNAL(setChildPosition()), ob, SLOT(setPosSLOT()));
-                if (!lasttrailline.IsEmpty()) {
-                    TrailLineItem *obj = new TrailLineItem(lasttrailline, position, Qt::green, map);
-                    trailLine->addToGroup(obj);
-                    connect(this, SIGNAL(setChildLine()), obj, SLOT(setLineSlot()));
-                }
-                lasttrailline = position;
+                trail->AddPoint(position, altitude);
                 timer.restart();
             }
         } else if (trailtype == UAVTrailType::ByDistance) {
             if (qAbs(internals::PureProjection::DistanceBetweenLatLng(lastcoord, position) * 1000) > traildistance) {
-                TrailItem *ob = new TrailItem(position, altitude, Qt::red, map);
-                trail->addToGroup(ob);
-                connect(this, SIGNAL(setChildPosition()), ob, SLOT(setPosSLOT()));
-                if (!lasttrailline.IsEmpty()) {
-                    TrailLineItem *obj = new TrailLineItem(lasttrailline, position, Qt::green, map);
-                    trailLine->addToGroup(obj);
-                    connect(this, SIGNAL(setChildLine()), obj, SLOT(setLineSlot()));
-                }
-                lasttrailline = position;
-                lastcoord     = position;
+                trail->AddPoint(position, altitude);
+                lastcoord = position;
             }
         }
         coord = position;
@@ -126,10 +109,8 @@ int GPSItem::type() const
 
 void GPSItem::RefreshPos()
 {
-    localposition = map->FromLatLngToLocal(coord);
+    localposition = projected.Local(map, coord);
     this->setPos(localposition.X(), localposition.Y());
-    emit setChildPosition();
-    emit setChildLine();
 }
 
 void GPSItem::setOpacitySlot(qreal opacity)
@@ -146,19 +127,16 @@ void GPSItem::SetTrailType(const UAVTrailType::Types &value)
 void GPSItem::SetShowTrail(const bool &value)
 {
     showtrail = value;
-    trail->setVisible(value);
+    trail->SetShowDots(value);
 }
 void GPSItem::SetShowTrailLine(const bool &value)
 {
     showtrailline = value;
-    trailLine->setVisible(value);
+    trail->SetShowLine(value);
 }
 void GPSItem::DeleteTrail() const
 {
-    foreach(QGraphicsItem * i, trail->childItems())
-    delete i;
-    foreach(QGraphicsItem * i, trailLine->childItems())
-    delete i;
+    trail->Clear();
 }
 double GPSItem::Distance3D(const internals::PointLatLng &coord, const int &altitude)
 {
@@ -39,7 +39,6 @@
 #include <QtSvg/QSvgRenderer>
 #include "opmapwidget.h"
 #include "trailitem.h"
-#include "traillineitem.h"
 namespace mapcontrol {
 class WayPointItem;
 class OPMapWidget;
@@ -239,12 +238,11 @@ private:
     UAVTrailType::Types trailtype;
     internals::PointLatLng coord;
     internals::PointLatLng lastcoord;
+    ProjectedPoint projected;
     QPixmap pic;
     core::Point localposition;
     OPMapWidget *mapwidget;
-    QGraphicsItemGroup *trail;
-    QGraphicsItemGroup *trailLine;
-    internals::PointLatLng lasttrailline;
+    TrailItem *trail;
     QTime timer;
     bool showtrail;
     bool showtrailline;
@@ -261,8 +259,6 @@ public slots:
 signals:
     void UAVReachedWayPoint(int const & waypointnumber, WayPointItem *waypoint);
     void UAVLeftSafetyBouble(internals::PointLatLng const & position);
-    void setChildPosition();
-    void setChildLine();
 };
 }
 #endif // GPSITEM_H
@@ -86,7 +86,7 @@ int HomeItem::type() const
 void HomeItem::RefreshPos()
 {
     prepareGeometryChange();
-    localposition = map->FromLatLngToLocal(coord);
+    localposition = projected.Local(map, coord);
     this->setPos(localposition.X(), localposition.Y());
     if (showsafearea) {
         localsafearea = safearea / map->Projection()->GetGroundResolution(map->ZoomTotal(), coord.Lat());
@@ -317,13 +317,14 @@ void MapGraphicItem::DrawMap2D(QPainter *painter)
                         // render tile
                         // lock(t.Overlays)
                         if (t != 0) {
-                            foreach(QByteArray img, t->Overlays) {
-                                if (img.count() != 0) {
+                            foreach(const QImage &img, t->Overlays) {
+                                if (!img.isNull()) {
                                     if (!found) {
                                         found = true;
                                     }
                                     {
-                                        painter->drawPixmap(core->tileRect.X(), core->tileRect.Y(), core->tileRect.Width(), core->tileRect.Height(), PureImageProxy::FromStream(img));
+                                        // Decoded by the loader threads already
+                                        painter->drawImage(QRect(core->tileRect.X(), core->tileRect.Y(), core->tileRect.Width(), core->tileRect.Height()), img);
                                     }
                                 }
                             }
@@ -372,7 +373,11 @@ void MapGraphicItem::DrawMap2D(QPainter *painter)
 
 core::Point MapGraphicItem::FromLatLngToLocal(internals::PointLatLng const & point)
 {
-    core::Point ret = core->FromLatLngToLocal(point);
+    return FromPixelToLocal(core->Projection()->FromLatLngToPixel(point, core->Zoom()));
+}
+core::Point MapGraphicItem::FromPixelToLocal(core::Point const & pixel)
+{
+    core::Point ret = core->FromPixelToLocal(pixel);
 
     if (MapRenderTransform != 1) {
         ret.SetX((int)(ret.X() * MapRenderTransform));
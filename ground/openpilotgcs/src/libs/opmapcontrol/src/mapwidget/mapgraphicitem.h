@@ -76,6 +76,20 @@ public:
      * @return core::Point Local item point
      */
     core::Point FromLatLngToLocal(internals::PointLatLng const & point);
+    /**
+     * @brief Converts map pixels at the zoom level of the tiles to local item coordinates
+     *
+     * The pixels of a point only change with ProjectionZoom(), so items can keep them
+     * and skip the projection when the map is only moved.
+     *
+     * @param pixel Pixel from the map projection at ProjectionZoom()
+     * @return core::Point Local item point
+     */
+    core::Point FromPixelToLocal(core::Point const & pixel);
+    int ProjectionZoom() const
+    {
+        return core->Zoom();
+    }
     /**
      * @brief Converts from local item coordinates to LatLong point
      *
@@ -105,6 +119,13 @@ public:
     double Zoom();
     double ZoomDigi();
     double ZoomTotal();
+    /**
+     * @brief Returns the scale the map is drawn with beyond its zoom step
+     */
+    qreal RenderTransform() const
+    {
+        return MapRenderTransform;
+    }
     void setOverlayOpacity(qreal value);
 protected:
     void mouseMoveEvent(QGraphicsSceneMouseEvent *event);
@@ -262,5 +283,27 @@ signals:
     void childRefreshPosition();
     void childSetOpacity(qreal value);
 };
+
+/**
+ * Map pixels of a LatLong point, projected again only when the point or the
+ * zoom level of the tiles changes.
+ */
+class ProjectedPoint {
+public:
+    ProjectedPoint() : zoom(-1) {}
+    core::Point Local(MapGraphicItem *map, internals::PointLatLng const & point)
+    {
+        if (zoom != map->ProjectionZoom() || coord != point) {
+            zoom  = map->ProjectionZoom();
+            coord = point;
+            pixel = map->Projection()->FromLatLngToPixel(point, zoom);
+        }
+        return map->FromPixelToLocal(pixel);
+    }
+private:
+    int zoom;
+    internals::PointLatLng coord;
+    core::Point pixel;
+};
 }
 #endif // MAPGRAPHICITEM_H
@@ -25,111 +25,231 @@
  * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
  */
 #include "mapripper.h"
+#include <QDir>
+#include <QFile>
+#include <QSettings>
+#include <math.h>
 namespace mapcontrol {
-MapRipper::MapRipper(internals::Core *core, const internals::RectLatLng & rect) : sleep(100), cancel(false), progressForm(0), core(core), yesToAll(false)
+MapRipper::MapRipper(internals::Core *core, const internals::RectLatLng & rect, int threads, int tilesPerSecond) :
+    cancel(false), progressForm(0), core(core), yesToAll(false), threads(qMax(1, threads)), running(0), next(0), done(0),
+    unsaved(0), nextRequest(0), requestInterval(1000 / qMax(1, tilesPerSecond))
 {
     if (!rect.IsEmpty()) {
         type    = core->GetMapType();
+        types   = OPMaps::Instance()->GetAllLayersOfType(type);
         progressForm = new MapRipForm;
         connect(progressForm, SIGNAL(cancelRequest()), this, SLOT(stopFetching()));
         area    = rect;
         zoom    = core->Zoom();
         maxzoom = core->MaxZoom();
-        points  = core->Projection()->GetAreaTileList(area, zoom, 0);
-        this->start();
-        cancel  = false;
+        if (!LoadManifest()) {
+            RemoveManifest();
+        }
         progressForm->show();
         connect(this, SIGNAL(percentageChanged(int)), progressForm, SLOT(SetPercentage(int)));
         connect(this, SIGNAL(numberOfTilesChanged(int, int)), progressForm, SLOT(SetNumberOfTiles(int, int)));
         connect(this, SIGNAL(providerChanged(QString, int)), progressForm, SLOT(SetProvider(QString, int)));
-        connect(this, SIGNAL(finished()), this, SLOT(finish()));
-        emit numberOfTilesChanged(0, 0);
-    } else
+        clock.start();
+        StartZoom();
+    } else {
 #ifdef Q_OS_DARWIN
-    { QMessageBox::information(new QWidget(), tr("No valid selection"), tr("This pre-caches map data.\n\nPlease first select the area of the map to rip with <COMMAND>+Left mouse click")); }
+        QMessageBox::information(new QWidget(), tr("No valid selection"), tr("This pre-caches map data.\n\nPlease first select the area of the map to rip with <COMMAND>+Left mouse click"));
 #else
-    { QMessageBox::information(new QWidget(), tr("No valid selection"), tr("This pre-caches map data.\n\nPlease first select the area of the map to rip with <CTRL>+Left mouse click")); }
+        QMessageBox::information(new QWidget(), tr("No valid selection"), tr("This pre-caches map data.\n\nPlease first select the area of the map to rip with <CTRL>+Left mouse click"));
 #endif
+        deleteLater();
+    }
 }
+
+MapRipper::~MapRipper()
+{
+    mutex.lock();
+    cancel = true;
+    mutex.unlock();
+    foreach(Worker * worker, workers) {
+        worker->wait();
+    }
+    qDeleteAll(workers);
+    delete progressForm;
+}
+
+// Fetches the tiles of the zoom level not fetched yet
+void MapRipper::StartZoom()
+{
+    points = core->Projection()->GetAreaTileList(area, zoom, 0);
+    if (fetched.size() != points.count()) {
+        fetched = QBitArray(points.count());
+    }
+    next = 0;
+    done = fetched.count(true);
+    emit providerChanged(core::MapType::StrByType(type), zoom);
+    emit numberOfTilesChanged(points.count(), done);
+    emit percentageChanged(points.isEmpty() ? 100 : done * 100 / points.count());
+
+    qDeleteAll(workers);
+    workers.clear();
+    running = qMax(1, qMin(threads, points.count() - done));
+    for (int i = 0; i < running; i++) {
+        Worker *worker = new Worker(this);
+        connect(worker, SIGNAL(finished()), this, SLOT(finish()));
+        workers.append(worker);
+    }
+    foreach(Worker * worker, workers) {
+        worker->start();
+    }
+}
+
 void MapRipper::finish()
 {
+    if (--running > 0) {
+        return;
+    }
+    SaveManifest();
     if (zoom < maxzoom && !cancel) {
-        ++zoom;
         int ret;
         if (!yesToAll) {
             QMessageBox msgBox;
-            msgBox.setText(QString(tr("Continue Ripping at zoom level %1?")).arg(zoom));
-            // msgBox.setInformativeText("Do you want to save your changes?");
+            msgBox.setText(QString(tr("Continue Ripping at zoom level %1?")).arg(zoom + 1));
             msgBox.setStandardButtons(QMessageBox::Yes | QMessageBox::No | QMessageBox::YesAll);
             msgBox.setDefaultButton(QMessageBox::Yes);
             ret = msgBox.exec();
         } else {
             ret = QMessageBox::Yes;
         }
-        if (ret == QMessageBox::Yes) {
-            points.clear();
-            points = core->Projection()->GetAreaTileList(area, zoom, 0);
-            this->start();
-        } else if (ret == QMessageBox::YesAll) {
-            yesToAll = true;
-            points.clear();
-            points   = core->Projection()->GetAreaTileList(area, zoom, 0);
-            this->start();
-        } else {
-            progressForm->close();
-            delete progressForm;
-            this->deleteLater();
+        if (ret == QMessageBox::Yes || ret == QMessageBox::YesAll) {
+            yesToAll = yesToAll || ret == QMessageBox::YesAll;
+            ++zoom;
+            fetched.clear();
+            StartZoom();
+            return;
         }
-    } else {
-        yesToAll = false;
-        progressForm->close();
-        delete progressForm;
-        this->deleteLater();
     }
+    // A cancelled rip is kept to be resumed, a completed one is forgotten
+    if (!cancel && fetched.count(true) == fetched.size()) {
+        RemoveManifest();
+    }
+    yesToAll = false;
+    progressForm->close();
+    deleteLater();
 }
 
-
-void MapRipper::run()
+bool MapRipper::NextPoint(int &index)
 {
-    int countOk   = 0;
-    bool goodtile = false;
-
-    // Stuff.Shuffle<Point>(ref list);
-    QVector<core::MapType::Types> types = OPMaps::Instance()->GetAllLayersOfType(type);
-    int all = points.count();
-    for (int i = 0; i < all; i++) {
-        emit numberOfTilesChanged(all, i + 1);
-        if (cancel) {
-            break;
+    QMutexLocker locker(&mutex);
+
+    while (!cancel && next < points.count()) {
+        index = next++;
+        if (!fetched.testBit(index)) {
+            return true;
         }
+    }
+    return false;
+}
 
-        core::Point p = points[i];
-        {
-            // qDebug()<<"offline fetching:"<<p.ToString();
-            foreach(core::MapType::Types type, types) {
-                emit providerChanged(core::MapType::StrByType(type), zoom);
-                QByteArray img = OPMaps::Instance()->GetImageFrom(type, p, zoom);
-
-                if (img.length() != 0) {
-                    goodtile = true;
-                    img = NULL;
-                } else {
-                    goodtile = false;
+// Hands out request slots requestInterval apart to all the workers
+void MapRipper::WaitForServer()
+{
+    mutex.lock();
+    qint64 now  = clock.elapsed();
+    qint64 slot = qMax(now, nextRequest);
+    nextRequest = slot + requestInterval;
+    mutex.unlock();
+    if (slot > now) {
+        QThread::msleep(slot - now);
+    }
+}
+
+void MapRipper::Fetch()
+{
+    int index;
+
+    while (NextPoint(index)) {
+        core::Point p = points.at(index);
+        bool goodtile = true;
+
+        foreach(core::MapType::Types layer, types) {
+            // Tiles already in the cache don't count against the server rate
+            QByteArray img = core::Cache::Instance()->ImageCache.GetImageFromCache(layer, p, zoom);
+            for (int retry = 0; img.isEmpty() && retry <= OPMaps::Instance()->RetryLoadTile && !cancel; retry++) {
+                if (retry) {
+                    QThread::msleep(1000);
                 }
+                WaitForServer();
+                img = OPMaps::Instance()->GetImageFrom(layer, p, zoom);
             }
-            if (goodtile) {
-                countOk++;
-            } else {
-                i--;
-                QThread::msleep(1000);
-                continue;
+            goodtile = goodtile && !img.isEmpty();
+        }
+
+        QMutexLocker locker(&mutex);
+        // Tiles that could not be fetched are left for a resumed rip
+        if (goodtile) {
+            fetched.setBit(index);
+            ++done;
+            if (++unsaved >= ManifestSaveInterval) {
+                SaveManifest();
             }
         }
-        emit percentageChanged((int)((i + 1) * 100 / all)); // , i+1);
-        // worker.ReportProgress((int) ((i+1)*100/all), i+1);
+        emit numberOfTilesChanged(points.count(), done);
+        emit percentageChanged(done * 100 / points.count());
+    }
+}
 
-        QThread::msleep(sleep);
+QString MapRipper::ManifestFile() const
+{
+    return core::Cache::Instance()->ImageCache.GtileCache() + QDir::separator() + "mapripper.ini";
+}
+
+// Resumes the rip of the manifest when it is for the same area and the user agrees
+bool MapRipper::LoadManifest()
+{
+    if (!QFile::exists(ManifestFile())) {
+        return false;
+    }
+    QSettings manifest(ManifestFile(), QSettings::IniFormat);
+    const double epsilon = 1e-9;
+    if (manifest.value("Type").toInt() != (int)type
+        || fabs(manifest.value("Lat").toDouble() - area.Lat()) > epsilon
+        || fabs(manifest.value("Lng").toDouble() - area.Lng()) > epsilon
+        || fabs(manifest.value("WidthLng").toDouble() - area.WidthLng()) > epsilon
+        || fabs(manifest.value("HeightLat").toDouble() - area.HeightLat()) > epsilon) {
+        return false;
     }
+    int savedZoom = manifest.value("Zoom").toInt();
+    QBitArray savedFetched = manifest.value("Fetched").toBitArray();
+    if (savedZoom < zoom || savedZoom > maxzoom) {
+        return false;
+    }
+    QMessageBox msgBox;
+    msgBox.setText(QString(tr("Resume the interrupted ripping of this area at zoom level %1 (%2 of %3 tiles done)?"))
+                   .arg(savedZoom).arg(savedFetched.count(true)).arg(savedFetched.size()));
+    msgBox.setStandardButtons(QMessageBox::Yes | QMessageBox::No);
+    msgBox.setDefaultButton(QMessageBox::Yes);
+    if (msgBox.exec() != QMessageBox::Yes) {
+        return false;
+    }
+    zoom    = savedZoom;
+    fetched = savedFetched;
+    return true;
+}
+
+// Called by the workers with the mutex held, or once they all finished
+void MapRipper::SaveManifest()
+{
+    QSettings manifest(ManifestFile(), QSettings::IniFormat);
+
+    manifest.setValue("Type", (int)type);
+    manifest.setValue("Lat", area.Lat());
+    manifest.setValue("Lng", area.Lng());
+    manifest.setValue("WidthLng", area.WidthLng());
+    manifest.setValue("HeightLat", area.HeightLat());
+    manifest.setValue("Zoom", zoom);
+    manifest.setValue("Fetched", fetched);
+    unsaved = 0;
+}
+
+void MapRipper::RemoveManifest()
+{
+    QFile::remove(ManifestFile());
 }
 
 void MapRipper::stopFetching()
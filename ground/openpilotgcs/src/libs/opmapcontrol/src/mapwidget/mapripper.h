@@ -30,19 +30,55 @@
 #include <QThread>
 #include "../internals/core.h"
 #include "mapripform.h"
+#include <QBitArray>
+#include <QElapsedTimer>
 #include <QObject>
 #include <QMessageBox>
 namespace mapcontrol {
-class MapRipper : public QThread {
+/**
+ * Fetches the tiles of the selected area into the cache, zoom level after
+ * zoom level. Several threads fetch at once, but together they ask the tile
+ * servers for no more than tilesPerSecond tiles.
+ *
+ * The progress is kept in a manifest next to the cache database, a rip that
+ * was cancelled or interrupted is offered to be resumed at the tile it had
+ * reached when the same area is ripped again.
+ */
+class MapRipper : public QObject {
     Q_OBJECT
 public:
-    MapRipper(internals::Core *, internals::RectLatLng const &);
-    void run();
+    MapRipper(internals::Core *, internals::RectLatLng const &, int threads = 4, int tilesPerSecond = 10);
+    ~MapRipper();
+private:
+    class Worker : public QThread {
+public:
+        Worker(MapRipper *ripper) : ripper(ripper) {}
+        void run()
+        {
+            ripper->Fetch();
+        }
 private:
+        MapRipper *ripper;
+    };
+
+    // Tiles completed between two saves of the manifest
+    static const int ManifestSaveInterval = 64;
+
+    void StartZoom();
+    bool NextPoint(int &index);
+    void WaitForServer();
+    void Fetch();
+    QString ManifestFile() const;
+    bool LoadManifest();
+    void SaveManifest();
+    void RemoveManifest();
+
     QList<core::Point> points;
+    // points of the zoom level fetched so far
+    QBitArray fetched;
     int zoom;
     core::MapType::Types type;
-    int sleep;
+    QVector<core::MapType::Types> types;
     internals::RectLatLng area;
     bool cancel;
     MapRipForm *progressForm;
@@ -50,6 +86,15 @@ private:
     internals::Core *core;
     bool yesToAll;
     QMutex mutex;
+    QList<Worker *> workers;
+    int threads;
+    int running;
+    int next;
+    int done;
+    int unsaved;
+    QElapsedTimer clock;
+    qint64 nextRequest;
+    int requestInterval;
 
 signals:
     void percentageChanged(int const & perc);
@@ -14,7 +14,7 @@ SOURCES += mapgraphicitem.cpp \
     homeitem.cpp \
     mapripform.cpp \
     mapripper.cpp \
-    traillineitem.cpp \
+    tileprefetcher.cpp \
     waypointline.cpp \
     waypointcircle.cpp
 
@@ -41,7 +41,7 @@ HEADERS += mapgraphicitem.h \
     homeitem.h \
     mapripform.h \
     mapripper.h \
-    traillineitem.h \
+    tileprefetcher.h \
     waypointline.h \
     waypointcircle.h
 QT += opengl
@@ -522,6 +522,34 @@ void OPMapWidget::RipMap()
     new MapRipper(core, map->SelectedArea());
 }
 
+QList<internals::PointLatLng> OPMapWidget::WPPath()
+{
+    QMap<int, internals::PointLatLng> path;
+    foreach(QGraphicsItem * i, map->childItems()) {
+        WayPointItem *w = qgraphicsitem_cast<WayPointItem *>(i);
+
+        if (w && w->Number() != -1) {
+            path.insert(w->Number(), w->Coord());
+        }
+    }
+    return path.values();
+}
+
+TilePrefetcher *OPMapWidget::PrefetchTiles(const QList<internals::PointLatLng> &area, bool closed, int minZoom, int maxZoom, const QString &packFile)
+{
+    return new TilePrefetcher(core, area, closed, minZoom, maxZoom, packFile);
+}
+
+bool OPMapWidget::LoadTilePack(const QString &file)
+{
+    if (!core::OPMaps::Instance()->LoadTilePack(file)) {
+        return false;
+    }
+    // Tiles that failed to load before may be in the pack
+    ReloadMap();
+    return true;
+}
+
 void OPMapWidget::setSelectedWP(QList<WayPointItem * >list)
 {
     this->scene()->clearSelection();
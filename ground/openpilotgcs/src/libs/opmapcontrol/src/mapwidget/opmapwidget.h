@@ -42,6 +42,7 @@
 #include "gpsitem.h"
 #include "homeitem.h"
 #include "mapripper.h"
+#include "tileprefetcher.h"
 #include "waypointline.h"
 #include "waypointcircle.h"
 #include "waypointitem.h"
@@ -522,6 +523,21 @@ public:
     void WPDelete(int number);
     WayPointItem *WPFind(int number);
     void setSelectedWP(QList<WayPointItem *> list);
+    /**
+     * @brief Returns the coordinates of the WayPoints in the order of their numbers
+     */
+    QList<internals::PointLatLng> WPPath();
+    /**
+     * @brief Prepares the download of the tiles of an area to a tile pack, see TilePrefetcher
+     *
+     * @param area a polygon if closed, else a path to fetch the tiles along
+     * @return TilePrefetcher the download, to be started or deleted
+     */
+    TilePrefetcher *PrefetchTiles(const QList<internals::PointLatLng> &area, bool closed, int minZoom, int maxZoom, const QString &packFile);
+    /**
+     * @brief Uses the tiles of a tile pack before the cached ones, an empty file name stops using it
+     */
+    bool LoadTilePack(const QString &file);
 private:
     internals::Core *core;
     MapGraphicItem *map;
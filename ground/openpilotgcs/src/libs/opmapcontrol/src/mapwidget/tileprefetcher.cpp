@@ -0,0 +1,235 @@
+/**
+ ******************************************************************************
+ *
+ * @file       tileprefetcher.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @brief      Downloads the tiles of a flight area into a tile pack
+ * @see        The GNU Public License (GPL) Version 3
+ * @defgroup   OPMapWidget
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "tileprefetcher.h"
+#include <QFileInfo>
+#include <QLineF>
+#include <QPolygonF>
+#include <limits>
+#include <math.h>
+namespace mapcontrol {
+// Distance from a point to the edges of a path, or to the path itself when it is a single point
+static double DistanceToPath(const QPolygonF &path, bool closed, const QPointF &point)
+{
+    if (path.size() == 1) {
+        return QLineF(path.first(), point).length();
+    }
+    double distance = std::numeric_limits<double>::max();
+    int edges = closed ? path.size() : path.size() - 1;
+    for (int i = 0; i < edges; i++) {
+        QPointF a  = path.at(i);
+        QPointF ab = path.at((i + 1) % path.size()) - a;
+        double length2 = ab.x() * ab.x() + ab.y() * ab.y();
+        double t = 0;
+        if (length2 > 0) {
+            t = qBound(0.0, ((point.x() - a.x()) * ab.x() + (point.y() - a.y()) * ab.y()) / length2, 1.0);
+        }
+        distance = qMin(distance, QLineF(a + ab * t, point).length());
+    }
+    return distance;
+}
+
+TilePrefetcher::TilePrefetcher(internals::Core *core, const QList<internals::PointLatLng> &area, bool closed, int minZoom, int maxZoom,
+                               const QString &packFile, double marginMeters, int threads, int tilesPerSecond) :
+    packFile(packFile), progressForm(0), next(0), done(0), failed(0), lastZoom(-1), cancel(false), running(0),
+    nextRequest(0), requestInterval(1000 / qMax(1, tilesPerSecond)), threads(qMax(1, threads))
+{
+    QVector<core::MapType::Types> types = OPMaps::Instance()->GetAllLayersOfType(core->GetMapType());
+
+    // The tile pack keys hold zoom levels up to 22
+    maxZoom = qMin(maxZoom, qMin(core->MaxZoom(), 22));
+    for (int zoom = qMax(minZoom, 0); zoom <= maxZoom; zoom++) {
+        AddAreaTiles(core->Projection(), area, closed, zoom, marginMeters, types);
+    }
+}
+
+TilePrefetcher::~TilePrefetcher()
+{
+    mutex.lock();
+    cancel = true;
+    mutex.unlock();
+    foreach(Worker * worker, workers) {
+        worker->wait();
+    }
+    qDeleteAll(workers);
+    delete progressForm;
+}
+
+void TilePrefetcher::AddAreaTiles(internals::PureProjection *projection, const QList<internals::PointLatLng> &area, bool closed, int zoom,
+                                  double marginMeters, const QVector<core::MapType::Types> &types)
+{
+    if (area.isEmpty()) {
+        return;
+    }
+    QPolygonF path;
+    foreach(internals::PointLatLng point, area) {
+        core::Point pixel = projection->FromLatLngToPixel(point, zoom);
+
+        path << QPointF(pixel.X(), pixel.Y());
+    }
+    closed = closed && path.size() > 2;
+
+    int tileSize  = projection->TileSize().Width();
+    double margin = qMax((double)tileSize, marginMeters / projection->GetGroundResolution(zoom, area.first().Lat()));
+    // A tile is fetched when any of it may be within the margin, so add half of its diagonal
+    double reach  = margin + tileSize * 0.71;
+    QRectF bounds = path.boundingRect().adjusted(-reach, -reach, reach, reach);
+    core::Size min = projection->GetTileMatrixMinXY(zoom);
+    core::Size max = projection->GetTileMatrixMaxXY(zoom);
+    int left   = qMax(min.Width(), (int)floor(bounds.left() / tileSize));
+    int right  = qMin(max.Width(), (int)floor(bounds.right() / tileSize));
+    int top    = qMax(min.Height(), (int)floor(bounds.top() / tileSize));
+    int bottom = qMin(max.Height(), (int)floor(bounds.bottom() / tileSize));
+
+    for (int x = left; x <= right; x++) {
+        for (int y = top; y <= bottom; y++) {
+            QPointF centre((x + 0.5) * tileSize, (y + 0.5) * tileSize);
+            if ((closed && path.containsPoint(centre, Qt::OddEvenFill)) || DistanceToPath(path, closed, centre) <= reach) {
+                foreach(core::MapType::Types type, types) {
+                    Task task;
+                    task.type = type;
+                    task.pos  = core::Point(x, y);
+                    task.zoom = zoom;
+                    tasks.append(task);
+                }
+            }
+        }
+    }
+}
+
+void TilePrefetcher::Start()
+{
+    if (!writer.Open(packFile)) {
+        emit packFinished(false, packFile, tasks.count());
+        deleteLater();
+        return;
+    }
+    progressForm = new MapRipForm;
+    connect(progressForm, SIGNAL(cancelRequest()), this, SLOT(stopFetching()));
+    connect(this, SIGNAL(percentageChanged(int)), progressForm, SLOT(SetPercentage(int)));
+    connect(this, SIGNAL(numberOfTilesChanged(int, int)), progressForm, SLOT(SetNumberOfTiles(int, int)));
+    connect(this, SIGNAL(providerChanged(QString, int)), progressForm, SLOT(SetProvider(QString, int)));
+    progressForm->show();
+    emit numberOfTilesChanged(tasks.count(), 0);
+
+    clock.start();
+    running = qMax(1, qMin(threads, tasks.count()));
+    for (int i = 0; i < running; i++) {
+        Worker *worker = new Worker(this);
+        connect(worker, SIGNAL(finished()), this, SLOT(workerFinished()));
+        workers.append(worker);
+    }
+    foreach(Worker * worker, workers) {
+        worker->start();
+    }
+}
+
+void TilePrefetcher::stopFetching()
+{
+    QMutexLocker locker(&mutex);
+
+    cancel = true;
+}
+
+void TilePrefetcher::workerFinished()
+{
+    if (--running > 0) {
+        return;
+    }
+    bool ok = false;
+    if (cancel) {
+        writer.Abort();
+    } else {
+        // The pack is replaced, so the map must let go of the old one
+        QString loaded = OPMaps::Instance()->TilePackFile();
+        if (!loaded.isEmpty() && QFileInfo(loaded) == QFileInfo(packFile)) {
+            OPMaps::Instance()->LoadTilePack(QString());
+        }
+        ok = writer.Finish();
+    }
+    progressForm->close();
+    delete progressForm;
+    progressForm = 0;
+    emit packFinished(ok, packFile, failed);
+    deleteLater();
+}
+
+bool TilePrefetcher::NextTask(Task &task)
+{
+    QMutexLocker locker(&mutex);
+
+    if (cancel || next >= tasks.count()) {
+        return false;
+    }
+    task = tasks.at(next++);
+    if (task.zoom != lastZoom) {
+        lastZoom = task.zoom;
+        emit providerChanged(core::MapType::StrByType(task.type), task.zoom);
+    }
+    return true;
+}
+
+// Hands out request slots requestInterval apart to all the workers
+void TilePrefetcher::WaitForServer()
+{
+    mutex.lock();
+    qint64 now  = clock.elapsed();
+    qint64 slot = qMax(now, nextRequest);
+    nextRequest = slot + requestInterval;
+    mutex.unlock();
+    if (slot > now) {
+        QThread::msleep(slot - now);
+    }
+}
+
+void TilePrefetcher::Fetch()
+{
+    Task task;
+
+    while (NextTask(task)) {
+        QByteArray image;
+        if (OPMaps::Instance()->GetAccessMode() != core::AccessMode::ServerOnly) {
+            image = core::Cache::Instance()->ImageCache.GetImageFromCache(task.type, task.pos, task.zoom);
+        }
+        for (int retry = 0; image.isEmpty() && retry <= OPMaps::Instance()->RetryLoadTile; retry++) {
+            if (retry) {
+                QThread::msleep(1000);
+            }
+            WaitForServer();
+            image = OPMaps::Instance()->GetImageFrom(task.type, task.pos, task.zoom);
+        }
+        bool ok = !image.isEmpty() && writer.AddImage(task.type, task.pos, task.zoom, image);
+
+        QMutexLocker locker(&mutex);
+        ++done;
+        if (!ok) {
+            ++failed;
+        }
+        emit numberOfTilesChanged(tasks.count(), done);
+        emit percentageChanged(done * 100 / tasks.count());
+    }
+}
+}
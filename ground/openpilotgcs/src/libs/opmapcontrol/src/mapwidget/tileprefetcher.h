@@ -0,0 +1,115 @@
+/**
+ ******************************************************************************
+ *
+ * @file       tileprefetcher.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @brief      Downloads the tiles of a flight area into a tile pack
+ * @see        The GNU Public License (GPL) Version 3
+ * @defgroup   OPMapWidget
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef TILEPREFETCHER_H
+#define TILEPREFETCHER_H
+
+#include "../internals/core.h"
+#include "../core/tilepack.h"
+#include "mapripform.h"
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QObject>
+#include <QThread>
+namespace mapcontrol {
+/**
+ * Fetches every tile of all the layers of the map type around an area, for a
+ * range of zoom levels, and writes them to a tile pack. The area is a closed
+ * polygon, everything inside it is fetched, or the path of a flight plan, then
+ * a corridor of marginMeters either side of it is.
+ *
+ * Several threads fetch at once, but together they ask the tile servers for
+ * no more than tilesPerSecond tiles. Tiles already in the database are copied
+ * from there.
+ */
+class TilePrefetcher : public QObject {
+    Q_OBJECT
+public:
+    TilePrefetcher(internals::Core *core, const QList<internals::PointLatLng> &area, bool closed, int minZoom, int maxZoom,
+                   const QString &packFile, double marginMeters = 250, int threads = 4, int tilesPerSecond = 8);
+    ~TilePrefetcher();
+    int TileCount() const
+    {
+        return tasks.count();
+    }
+    // Shows the progress and deletes itself when done
+    void Start();
+
+signals:
+    void percentageChanged(int const & perc);
+    void numberOfTilesChanged(int const & total, int const & actual);
+    void providerChanged(QString const & prov, int const & zoom);
+    // missing are the tiles that could not be fetched
+    void packFinished(bool ok, QString const & packFile, int const & missing);
+
+public slots:
+    void stopFetching();
+
+private slots:
+    void workerFinished();
+
+private:
+    class Worker : public QThread {
+public:
+        Worker(TilePrefetcher *prefetcher) : prefetcher(prefetcher) {}
+        void run()
+        {
+            prefetcher->Fetch();
+        }
+private:
+        TilePrefetcher *prefetcher;
+    };
+    struct Task {
+        core::MapType::Types type;
+        core::Point pos;
+        int zoom;
+    };
+
+    void AddAreaTiles(internals::PureProjection *projection, const QList<internals::PointLatLng> &area, bool closed, int zoom,
+                      double marginMeters, const QVector<core::MapType::Types> &types);
+    bool NextTask(Task &task);
+    void WaitForServer();
+    void Fetch();
+
+    QVector<Task> tasks;
+    QList<Worker *> workers;
+    core::TilePackWriter writer;
+    QString packFile;
+    MapRipForm *progressForm;
+    QMutex mutex;
+    int next;
+    int done;
+    int failed;
+    int lastZoom;
+    bool cancel;
+    int running;
+    QElapsedTimer clock;
+    qint64 nextRequest;
+    int requestInterval;
+    int threads;
+};
+}
+#endif // TILEPREFETCHER_H
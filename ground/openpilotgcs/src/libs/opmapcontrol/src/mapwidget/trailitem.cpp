@@ -3,7 +3,7 @@
  *
  * @file       trailitem.cpp
  * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2012.
- * @brief      A graphicsItem representing a trail point
+ * @brief      A graphicsItem drawing the trail of a UAV or GPS
  * @see        The GNU Public License (GPL) Version 3
  * @defgroup   OPMapWidget
  * @{
@@ -26,36 +26,207 @@
  */
 #include "trailitem.h"
 #include <QDateTime>
+#include <QGraphicsSceneHoverEvent>
+#include <QStyleOptionGraphicsItem>
+#include <QtCore/qmath.h>
 namespace mapcontrol {
-TrailItem::TrailItem(internals::PointLatLng const & coord, int const & altitude, QBrush color, MapGraphicItem *map) : QGraphicsItem(map), coord(coord), m_brush(color), m_map(map)
-{
-    QDateTime time    = QDateTime::currentDateTime();
-    QString coord_str = " " + QString::number(coord.Lat(), 'f', 6) + "   " + QString::number(coord.Lng(), 'f', 6);
+// In pixels at the projected zoom
+static const qreal MinSpacing  = 1.5;
+static const qreal DotSpacing  = 6;
+static const qreal CellSize    = 32;
+static const qreal HoverRadius = 4;
 
-    setToolTip(QString(tr("Position:") + "%1\n" + tr("Altitude:") + "%2\n" + tr("Time:") + "%3").arg(coord_str).arg(QString::number(altitude)).arg(time.toString()));
+TrailItem::TrailItem(QBrush dotColor, QBrush lineColor, MapGraphicItem *map) : QGraphicsItem(map), projectedZoom(-1),
+    m_dotBrush(dotColor), m_lineBrush(lineColor), showDots(true), showLine(true), m_map(map)
+{
+    setAcceptedMouseButtons(Qt::NoButton);
+    setAcceptHoverEvents(true);
+    setFlag(QGraphicsItem::ItemUsesExtendedStyleOption, true);
+    connect(map, SIGNAL(childRefreshPosition()), this, SLOT(RefreshPos()));
+    connect(map, SIGNAL(zoomChanged(double, double, double)), this, SLOT(RefreshPos()));
 }
 
 void TrailItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
 {
-    Q_UNUSED(option);
     Q_UNUSED(widget);
 
-    painter->setBrush(m_brush);
-    painter->drawEllipse(-2, -2, 4, 4);
+    if (showLine && drawn.count() > 1) {
+        QPen pen(m_lineBrush, 1);
+        pen.setCosmetic(true);
+        painter->setPen(pen);
+        painter->setBrush(Qt::NoBrush);
+        painter->drawPath(line);
+    }
+    if (showDots) {
+        QRectF exposed = option->exposedRect.adjusted(-2, -2, 2, 2);
+        painter->setPen(Qt::black);
+        painter->setBrush(m_dotBrush);
+        foreach(int i, dots) {
+            if (exposed.contains(drawn.at(i))) {
+                painter->drawEllipse(drawn.at(i), 2, 2);
+            }
+        }
+    }
 }
+
 QRectF TrailItem::boundingRect() const
 {
-    return QRectF(-2, -2, 4, 4);
+    return bounds.adjusted(-3, -3, 3, 3);
 }
 
-
 int TrailItem::type() const
 {
     return Type;
 }
 
-void TrailItem::setPosSLOT()
+QPointF TrailItem::Project(internals::PointLatLng const & coord) const
+{
+    core::Point pixel = m_map->Projection()->FromLatLngToPixel(coord, (int)projectedZoom);
+
+    return QPointF(pixel.X() - originPixel.X(), pixel.Y() - originPixel.Y());
+}
+
+quint64 TrailItem::CellKey(QPointF const & pixel)
+{
+    return ((quint64)(quint32)qFloor(pixel.x() / CellSize) << 32) | (quint32)qFloor(pixel.y() / CellSize);
+}
+
+void TrailItem::AddDrawn(int index, QPointF const & pixel)
+{
+    if (!drawn.isEmpty()) {
+        QPointF step = pixel - drawn.last();
+        if (step.manhattanLength() < MinSpacing) {
+            return;
+        }
+    }
+    if (drawn.isEmpty()) {
+        line.moveTo(pixel);
+        bounds = QRectF(pixel, QSizeF(0, 0));
+    } else {
+        line.lineTo(pixel);
+        // Not united, a rect without size is null to QRectF
+        bounds.setCoords(qMin(bounds.left(), pixel.x()), qMin(bounds.top(), pixel.y()),
+                         qMax(bounds.right(), pixel.x()), qMax(bounds.bottom(), pixel.y()));
+    }
+    if (dots.isEmpty() || (pixel - drawn.at(dots.last())).manhattanLength() >= DotSpacing) {
+        dots.append(drawn.count());
+    }
+    grid[CellKey(pixel)].append(drawn.count());
+    drawn.append(pixel);
+    drawnIndex.append(index);
+}
+
+void TrailItem::Reproject()
+{
+    prepareGeometryChange();
+    projectedZoom = m_map->Zoom();
+    drawn.clear();
+    drawnIndex.clear();
+    dots.clear();
+    grid.clear();
+    line   = QPainterPath();
+    bounds = QRectF();
+    if (points.isEmpty()) {
+        return;
+    }
+    QVector<internals::PointLatLng> coords(points.count());
+    QVector<core::Point> pixels(points.count());
+    for (int i = 0; i < points.count(); i++) {
+        coords[i] = points.at(i).coord;
+    }
+    m_map->Projection()->FromLatLngsToPixels(coords.constData(), pixels.data(), points.count(), (int)projectedZoom);
+    originPixel = pixels.first();
+    for (int i = 0; i < points.count(); i++) {
+        AddDrawn(i, QPointF(pixels.at(i).X() - originPixel.X(), pixels.at(i).Y() - originPixel.Y()));
+    }
+}
+
+void TrailItem::AddPoint(internals::PointLatLng const & coord, int const & altitude)
+{
+    TrailPoint point;
+
+    point.coord    = coord;
+    point.altitude = altitude;
+    point.time     = QDateTime::currentMSecsSinceEpoch();
+    points.append(point);
+    if (points.count() == 1 || projectedZoom != m_map->Zoom()) {
+        Reproject();
+        RefreshPos();
+    } else {
+        prepareGeometryChange();
+        AddDrawn(points.count() - 1, Project(coord));
+    }
+    update();
+}
+
+void TrailItem::Clear()
+{
+    points.clear();
+    Reproject();
+    update();
+}
+
+void TrailItem::SetShowDots(bool const & value)
+{
+    showDots = value;
+    setVisible(showDots || showLine);
+    update();
+}
+
+void TrailItem::SetShowLine(bool const & value)
+{
+    showLine = value;
+    setVisible(showDots || showLine);
+    update();
+}
+
+int TrailItem::Nearest(QPointF const & pixel) const
+{
+    int nearest = -1;
+    qreal best  = HoverRadius * HoverRadius;
+    quint64 key = CellKey(pixel);
+    qint32 cx   = (qint32)(key >> 32);
+    qint32 cy   = (qint32)(key & 0xffffffff);
+
+    for (qint32 x = cx - 1; x <= cx + 1; x++) {
+        for (qint32 y = cy - 1; y <= cy + 1; y++) {
+            foreach(int i, grid.value(((quint64)(quint32)x << 32) | (quint32)y)) {
+                QPointF d = drawn.at(i) - pixel;
+                qreal distance = d.x() * d.x() + d.y() * d.y();
+                if (distance <= best) {
+                    best    = distance;
+                    nearest = drawnIndex.at(i);
+                }
+            }
+        }
+    }
+    return nearest;
+}
+
+void TrailItem::hoverMoveEvent(QGraphicsSceneHoverEvent *event)
+{
+    int i = Nearest(event->pos());
+
+    if (i < 0) {
+        setToolTip(QString());
+        return;
+    }
+    const TrailPoint &point = points.at(i);
+    QString coord_str = " " + QString::number(point.coord.Lat(), 'f', 6) + "   " + QString::number(point.coord.Lng(), 'f', 6);
+    setToolTip(QString(tr("Position:") + "%1\n" + tr("Altitude:") + "%2\n" + tr("Time:") + "%3").arg(coord_str)
+               .arg(QString::number(point.altitude)).arg(QDateTime::fromMSecsSinceEpoch(point.time).toString()));
+}
+
+void TrailItem::RefreshPos()
 {
-    setPos(m_map->FromLatLngToLocal(this->coord).X(), m_map->FromLatLngToLocal(this->coord).Y());
+    if (points.isEmpty()) {
+        return;
+    }
+    if (projectedZoom != m_map->Zoom()) {
+        Reproject();
+    }
+    core::Point local = m_map->FromLatLngToLocal(points.first().coord);
+    setPos(local.X(), local.Y());
+    setScale(m_map->RenderTransform());
 }
 }
@@ -3,7 +3,7 @@
  *
  * @file       trailitem.h
  * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2012.
- * @brief      A graphicsItem representing a WayPoint
+ * @brief      A graphicsItem drawing the trail of a UAV or GPS
  * @see        The GNU Public License (GPL) Version 3
  * @defgroup   OPMapWidget
  * @{
@@ -29,28 +29,70 @@
 
 #include <QGraphicsItem>
 #include <QPainter>
-#include <QLabel>
+#include <QPainterPath>
+#include <QHash>
+#include <QVector>
 #include "../internals/pointlatlng.h"
 #include <QObject>
 #include "mapgraphicitem.h"
 
 namespace mapcontrol {
+/**
+ * The whole trail of a UAV or GPS as one item, its points and the line between them.
+ *
+ * The points are projected again only when the zoom changes, panning just moves the
+ * item. Points closer than MinSpacing pixels to the previous drawn one are not drawn
+ * and the dots are only drawn DotSpacing pixels apart, so a long flight costs about
+ * as much to paint as a short one. A grid of the drawn points finds the one under
+ * the mouse for the tooltip.
+ */
 class TrailItem : public QObject, public QGraphicsItem {
     Q_OBJECT Q_INTERFACES(QGraphicsItem)
 public:
     enum { Type = UserType + 3 };
-    TrailItem(internals::PointLatLng const & coord, int const & altitude, QBrush color, MapGraphicItem *map);
+    TrailItem(QBrush dotColor, QBrush lineColor, MapGraphicItem *map);
     void paint(QPainter *painter, const QStyleOptionGraphicsItem *option,
                QWidget *widget);
     QRectF boundingRect() const;
     int type() const;
-    internals::PointLatLng coord;
+    void AddPoint(internals::PointLatLng const & coord, int const & altitude);
+    void Clear();
+    int Count() const
+    {
+        return points.count();
+    }
+    void SetShowDots(bool const & value);
+    void SetShowLine(bool const & value);
+protected:
+    void hoverMoveEvent(QGraphicsSceneHoverEvent *event);
 private:
-    QBrush m_brush;
+    struct TrailPoint {
+        internals::PointLatLng coord;
+        int    altitude;
+        qint64 time;
+    };
+    QPointF Project(internals::PointLatLng const & coord) const;
+    void Reproject();
+    void AddDrawn(int index, QPointF const & pixel);
+    static quint64 CellKey(QPointF const & pixel);
+    int Nearest(QPointF const & pixel) const;
+    QVector<TrailPoint> points;
+    // Pixels at the projected zoom, relative to the first point
+    QVector<QPointF> drawn;
+    QVector<int> drawnIndex;
+    QVector<int> dots;
+    QHash<quint64, QVector<int> > grid;
+    QPainterPath line;
+    QRectF bounds;
+    double projectedZoom;
+    core::Point originPixel;
+    QBrush m_dotBrush;
+    QBrush m_lineBrush;
+    bool showDots;
+    bool showLine;
     MapGraphicItem *m_map;
 public slots:
-    void setPosSLOT();
-signals:
+    void RefreshPos();
 };
 }
 #endif // TRAILITEM_H
@@ -40,10 +40,7 @@ UAVItem::UAVItem(MapGraphicItem *map, OPMapWidget *parent, QString uavPic) : map
     localposition = map->FromLatLngToLocal(mapwidget->CurrentPosition());
     this->setPos(localposition.X(), localposition.Y());
     this->setZValue(4);
-    trail     = new QGraphicsItemGroup(this);
-    trail->setParentItem(map);
-    trailLine = new QGraphicsItemGroup(this);
-    trailLine->setParentItem(map);
+    trail = new TrailItem(Qt::green, Qt::red, map);
     this->setFlag(QGraphicsItem::ItemIgnoresTransformations, true);
     setCacheMode(QGraphicsItem::ItemCoordinateCache);
     mapfollowtype = UAVMapFollowType::None;
@@ -58,7 +55,9 @@ UAVItem::UAVItem(MapGraphicItem *map, OPMapWidget *parent, QString uavPic) : map
     connect(map, SIGNAL(zoomChanged(double, double, double)), this, SLOT(zoomChangedSlot()));
 }
 UAVItem::~UAVItem()
-{}
+{
+    delete trail;
+}
 
 void UAVItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
 {
@@ -249,29 +248,13 @@ void UAVItem::SetUAVPos(const internals::PointLatLng &position, const int &altit
     if (coord != position) {
         if (trailtype == UAVTrailType::ByTimeElapsed) {
             if (timer.elapsed() > trailtime * 1000) {
-                TrailItem *ob = new TrailItem(position, altitude, Qt::green, map);
-                trail->addToGroup(ob);
-                connect(this, SIGNAL(setChildPosition()), ob, SLOT(setPosSLOT()));
-                if (!lasttrailline.IsEmpty()) {
-                    TrailLineItem *obj = new TrailLineItem(lasttrailline, position, Qt::red, map);
-                    trailLine->addToGroup(obj);
-                    connect(this, SIGNAL(setChildLine()), obj, SLOT(setLineSlot()));
-                }
-                lasttrailline = position;
+                trail->AddPoint(position, altitude);
                 timer.restart();
             }
         } else if (trailtype == UAVTrailType::ByDistance) {
             if (qAbs(internals::PureProjection::DistanceBetweenLatLng(lastcoord, position) * 1000) > traildistance) {
-                TrailItem *ob = new TrailItem(position, altitude, Qt::green, map);
-                trail->addToGroup(ob);
-                connect(this, SIGNAL(setChildPosition()), ob, SLOT(setPosSLOT()));
-                if (!lasttrailline.IsEmpty()) {
-                    TrailLineItem *obj = new TrailLineItem(lasttrailline, position, Qt::red, map);
-                    trailLine->addToGroup(obj);
-                    connect(this, SIGNAL(setChildLine()), obj, SLOT(setLineSlot()));
-                }
-                lasttrailline = position;
-                lastcoord     = position;
+                trail->AddPoint(position, altitude);
+                lastcoord = position;
             }
         }
         coord = position;
@@ -334,10 +317,8 @@ int UAVItem::type() const
 
 void UAVItem::RefreshPos()
 {
-    localposition = map->FromLatLngToLocal(coord);
+    localposition = projected.Local(map, coord);
     this->setPos(localposition.X(), localposition.Y());
-    emit setChildPosition();
-    emit setChildLine();
     updateTextOverlay();
 }
 
@@ -366,20 +347,17 @@ void UAVItem::SetTrailType(const UAVTrailType::Types &value)
 void UAVItem::SetShowTrail(const bool &value)
 {
     showtrail = value;
-    trail->setVisible(value);
+    trail->SetShowDots(value);
 }
 void UAVItem::SetShowTrailLine(const bool &value)
 {
     showtrailline = value;
-    trailLine->setVisible(value);
+    trail->SetShowLine(value);
 }
 
 void UAVItem::DeleteTrail() const
 {
-    foreach(QGraphicsItem * i, trail->childItems())
-    delete i;
-    foreach(QGraphicsItem * i, trailLine->childItems())
-    delete i;
+    trail->Clear();
 }
 double UAVItem::Distance3D(const internals::PointLatLng &coord, const int &altitude)
 {
@@ -39,7 +39,6 @@
 #include <QtSvg/QSvgRenderer>
 #include "opmapwidget.h"
 #include "trailitem.h"
-#include "traillineitem.h"
 namespace mapcontrol {
 class WayPointItem;
 class OPMapWidget;
@@ -269,6 +268,7 @@ private:
     UAVTrailType::Types trailtype;
     internals::PointLatLng coord;
     internals::PointLatLng lastcoord;
+    ProjectedPoint projected;
     double NED[3];
     double vNED[3];
     double CAS_mps;
@@ -282,9 +282,7 @@ private:
     double ringTime;
     QPixmap pic;
     core::Point localposition;
-    QGraphicsItemGroup *trail;
-    QGraphicsItemGroup *trailLine;
-    internals::PointLatLng lasttrailline;
+    TrailItem *trail;
     QTime timer;
     bool showtrail;
     bool showtrailline;
@@ -309,8 +307,6 @@ public slots:
 signals:
     void UAVReachedWayPoint(int const & waypointnumber, WayPointItem *waypoint);
     void UAVLeftSafetyBouble(internals::PointLatLng const & position);
-    void setChildPosition();
-    void setChildLine();
 };
 }
 #endif // UAVITEM_H
@@ -433,7 +433,7 @@ WayPointItem::~WayPointItem()
 }
 void WayPointItem::RefreshPos()
 {
-    core::Point point = map->FromLatLngToLocal(coord);
+    core::Point point = projected.Local(map, coord);
 
     this->setPos(point.X(), point.Y());
     emit localPositionChanged(this->pos(), this);
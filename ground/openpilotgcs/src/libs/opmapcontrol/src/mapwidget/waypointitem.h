@@ -208,6 +208,7 @@ protected:
     void mouseDoubleClickEvent(QGraphicsSceneMouseEvent *event);
 private:
     internals::PointLatLng coord; // coordinates of this WayPoint
+    ProjectedPoint projected;
     distBearingAltitude relativeCoord;
     bool reached;
     QString description;
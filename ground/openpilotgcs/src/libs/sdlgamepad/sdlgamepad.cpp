@@ -91,6 +91,9 @@ bool SDLGamepad::init()
 void SDLGamepad::run()
 {
     while (loop) {
+        if (priv->gamepad) {
+            SDL_JoystickUpdate();
+        }
         updateAxes();
         updateButtons();
         msleep(tick);
@@ -142,7 +145,6 @@ void SDLGamepad::updateAxes()
 {
     if (priv->gamepad) {
         QListInt16 values;
-        SDL_JoystickUpdate();
 
         for (qint8 i = 0; i < axes; i++) {
             qint16 value = SDL_JoystickGetAxis(priv->gamepad, i);
@@ -154,7 +156,11 @@ void SDLGamepad::updateAxes()
             values.append(value);
         }
 
-        emit axesValues(values);
+        // Only report changes, receivers act on the new position right away
+        if (values != axesStates) {
+            axesStates = values;
+            emit axesValues(values);
+        }
     }
 }
 
@@ -162,8 +168,6 @@ void SDLGamepad::updateAxes()
 void SDLGamepad::updateButtons()
 {
     if (priv->gamepad) {
-        SDL_JoystickUpdate();
-
         for (qint8 i = 0; i < buttons; i++) {
             qint16 state = SDL_JoystickGetButton(priv->gamepad, i);
 
@@ -299,6 +299,11 @@ private:
      */
     QList<qint16> buttonStates;
 
+    /**
+     * The axes values last emitted with axesValues.
+     */
+    QListInt16 axesStates;
+
     /**
      * Variable that holds private members.
      */
@@ -339,9 +344,9 @@ signals:
      * A signal that emitts the current values of the gamepad axes.
      *
      * You can connect to this signal to receive the values of the
-     * gamepad axes. Unlike the button signal, this signal is thrown
-     * with every tick. You will get a QListInt16 containing the value
-     * of every present axis in a QList.
+     * gamepad axes. Like the button signal, this signal is only thrown
+     * when a tick finds a value that changed. You will get a QListInt16
+     * containing the value of every present axis in a QList.
      *
      * @see QListInt16
      * @param values A QListInt16 Type containing all axes values.
@@ -31,10 +31,39 @@
 #include <stdint.h>
 #include <QDebug>
 #include <math.h>
+#include <Eigen/Core>
 
 #define RAD2DEG (180.0 / M_PI)
 #define DEG2RAD (M_PI / 180.0)
 
+namespace {
+// Points stored one after the other, one column per point
+typedef Eigen::Matrix<double, 3, Eigen::Dynamic> Points;
+
+struct Atan2Op {
+    typedef double result_type;
+    double operator()(double y, double x) const
+    {
+        return atan2(y, x);
+    }
+};
+
+// Double precision Rne, the float one of RneFromLLA() loses centimeters a few km from home
+Eigen::Matrix3d RneFromHomeLLA(const double homeLLA[3])
+{
+    double sinLat = sin(DEG2RAD * homeLLA[0]);
+    double sinLon = sin(DEG2RAD * homeLLA[1]);
+    double cosLat = cos(DEG2RAD * homeLLA[0]);
+    double cosLon = cos(DEG2RAD * homeLLA[1]);
+    Eigen::Matrix3d Rne;
+
+    Rne << -sinLat * cosLon, -sinLat * sinLon, cosLat,
+        -sinLon, cosLon, 0,
+        -cosLat * cosLon, -cosLat * sinLon, -sinLat;
+    return Rne;
+}
+}
+
 namespace Utils {
 CoordinateConversions::CoordinateConversions()
 {}
@@ -63,7 +92,7 @@ void CoordinateConversions::RneFromLLA(double LLA[3], float Rne[3][3])
  * @param[in] LLA[3] latitude longitude alititude coordinates in
  * @param[out] ECEF[3] location in ECEF coordinates
  */
-void CoordinateConversions::LLA2ECEF(double LLA[3], double ECEF[3])
+void CoordinateConversions::LLA2ECEF(const double LLA[3], double ECEF[3])
 {
     const double a = 6378137.0; // Equatorial Radius
     const double e = 8.1819190842622e-2; // Eccentricity
@@ -190,6 +219,92 @@ void CoordinateConversions::LLA2Base(double LLA[3], double BaseECEF[3], float Rn
     NED[2]  = Rne[2][0] * diff[0] + Rne[2][1] * diff[1] + Rne[2][2] * diff[2];
 }
 
+/**
+ * Convert a whole track of LLA coordinates to NED offsets from the home location.
+ * The home ECEF and rotation matrix are computed once, the points are converted
+ * to ECEF together and rotated with a single matrix product.
+ * @param[in] homeLLA latitude, longitude and altitude of the home location
+ * @param[in] LLA count latitude, longitude, altitude coordinates
+ * @param[out] NED count offsets from the home location (in m)
+ * @param[in] count number of points
+ */
+void CoordinateConversions::LLA2NEDBatch(const double homeLLA[3], const double LLA[][3], double NED[][3], int count)
+{
+    const double a = 6378137.0; // Equatorial Radius
+    const double e = 8.1819190842622e-2; // Eccentricity
+
+    if (count <= 0) {
+        return;
+    }
+
+    Eigen::Map<const Points> lla(&LLA[0][0], 3, count);
+    Eigen::ArrayXd lat    = DEG2RAD * lla.row(0).transpose().array();
+    Eigen::ArrayXd lon    = DEG2RAD * lla.row(1).transpose().array();
+    Eigen::ArrayXd alt    = lla.row(2).transpose().array();
+    Eigen::ArrayXd sinLat = lat.sin();
+    Eigen::ArrayXd cosLat = lat.cos();
+    Eigen::ArrayXd N = a / (1.0 - e * e * sinLat.square()).sqrt(); // prime vertical radius of curvature
+
+    Points ECEF(3, count);
+    ECEF.row(0) = ((N + alt) * cosLat * lon.cos()).matrix().transpose();
+    ECEF.row(1) = ((N + alt) * cosLat * lon.sin()).matrix().transpose();
+    ECEF.row(2) = (((1 - e * e) * N + alt) * sinLat).matrix().transpose();
+
+    Eigen::Vector3d homeECEF;
+    LLA2ECEF(homeLLA, homeECEF.data());
+
+    Eigen::Map<Points>(&NED[0][0], 3, count) = RneFromHomeLLA(homeLLA) * (ECEF.colwise() - homeECEF);
+}
+
+/**
+ * Convert a whole track of NED offsets from the home location to LLA coordinates.
+ * The offsets are rotated to ECEF with a single matrix product, the latitude then
+ * comes from Bowring's closed form instead of the iterations of ECEF2LLA(), which
+ * is within a millimeter of it below 10 km of altitude.
+ * @param[in] homeLLA latitude, longitude and altitude of the home location
+ * @param[in] NED count offsets from the home location (in m)
+ * @param[out] LLA count latitude, longitude, altitude coordinates
+ * @param[in] count number of points
+ */
+void CoordinateConversions::NED2LLABatch(const double homeLLA[3], const double NED[][3], double LLA[][3], int count)
+{
+    const double a   = 6378137.0; // Equatorial Radius
+    const double e   = 8.1819190842622e-2; // Eccentricity
+    const double b   = a * sqrt(1 - e * e); // Polar Radius
+    const double ep2 = e * e / (1 - e * e); // Second eccentricity squared
+
+    if (count <= 0) {
+        return;
+    }
+
+    Eigen::Vector3d homeECEF;
+    LLA2ECEF(homeLLA, homeECEF.data());
+
+    /* P = ECEF + Rne' * NED */
+    Points ECEF = (RneFromHomeLLA(homeLLA).transpose() * Eigen::Map<const Points>(&NED[0][0], 3, count)).colwise() + homeECEF;
+    Eigen::ArrayXd x = ECEF.row(0).transpose().array();
+    Eigen::ArrayXd y = ECEF.row(1).transpose().array();
+    Eigen::ArrayXd z = ECEF.row(2).transpose().array();
+    Eigen::ArrayXd p = (x.square() + y.square()).sqrt();
+
+    // Parametric latitude, only its sine and cosine are needed
+    Eigen::ArrayXd r = ((z * a).square() + (p * b).square()).sqrt();
+    Eigen::ArrayXd sinU = z * a / r;
+    Eigen::ArrayXd cosU = p * b / r;
+
+    Eigen::ArrayXd latY   = z + ep2 * b * sinU.cube();
+    Eigen::ArrayXd latX   = p - e * e * a * cosU.cube();
+    Eigen::ArrayXd norm   = (latY.square() + latX.square()).sqrt();
+    Eigen::ArrayXd sinLat = latY / norm;
+    Eigen::ArrayXd cosLat = latX / norm;
+
+    Eigen::Map<Points> lla(&LLA[0][0], 3, count);
+    lla.row(0) = (RAD2DEG * latY.binaryExpr(latX, Atan2Op())).matrix().transpose();
+    lla.row(1) = (RAD2DEG * y.binaryExpr(x, Atan2Op())).matrix().transpose();
+    // Also valid near the poles, unlike p / cos(Lat) - N
+    lla.row(2) = (p * cosLat + z * sinLat - a * (1 - e * e * sinLat.square()).sqrt()).matrix().transpose();
+}
+
 // ****** find roll, pitch, yaw from quaternion ********
 void CoordinateConversions::Quaternion2RPY(const float q[4], float rpy[3])
 {
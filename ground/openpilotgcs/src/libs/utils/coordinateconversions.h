@@ -42,9 +42,11 @@ public:
     int NED2LLA_HomeECEF(double BaseECEFcm[3], double NED[3], double position[3]);
     int NED2LLA_HomeLLA(double LLA[3], double NED[3], double position[3]);
     void RneFromLLA(double LLA[3], float Rne[3][3]);
-    void LLA2ECEF(double LLA[3], double ECEF[3]);
+    void LLA2ECEF(const double LLA[3], double ECEF[3]);
     int ECEF2LLA(double ECEF[3], double LLA[3]);
     void LLA2Base(double LLA[3], double BaseECEF[3], float Rne[3][3], float NED[3]);
+    void LLA2NEDBatch(const double homeLLA[3], const double LLA[][3], double NED[][3], int count);
+    void NED2LLABatch(const double homeLLA[3], const double NED[][3], double LLA[][3], int count);
     void Quaternion2RPY(const float q[4], float rpy[3]);
     void RPY2Quaternion(const float rpy[3], float q[4]);
     void Quaternion2R(const float q[4], float Rbe[3][3]);
@@ -1,19 +1,91 @@
 #include "logfile.h"
 #include <QDebug>
 #include <QtGlobal>
+#include <QElapsedTimer>
+#include <QThread>
+#include <QtEndian>
+#include <algorithm>
+
+#if defined(Q_OS_WIN)
+#include <io.h>
+#elif defined(Q_OS_UNIX)
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// consumed replay data is only dropped from the front of the buffer in chunks this large
+#define REPLAY_BUFFER_CHUNK (64 * 1024)
+
+// UAVTalk framing, only as much as needed to tell which object a record updates
+#define UAVTALK_SYNC_VAL      0x3C
+#define UAVTALK_TYPE_OBJ      0x20
+#define UAVTALK_TYPE_OBJ_ACK  0x22
+#define UAVTALK_HEADER_LENGTH 10
+#define UAVTALK_CHECKSUM_LENGTH 1
+
+static quint64 objectKey(quint32 objId, quint16 instId)
+{
+    return ((quint64)objId << 16) | instId;
+}
+
+// the writer thread is woken up once this much is queued, and at least every WRITE_TIMEOUT ms
+#define WRITE_BLOCK_SIZE    (256 * 1024)
+#define WRITE_TIMEOUT       250
+
+// O_DIRECT transfers have to be aligned to the logical block size of the disk
+#define DIRECT_ALIGNMENT    4096
+#define DIRECT_BUFFER_SIZE  WRITE_BLOCK_SIZE
+
+/**
+ * Drains the record queue of a LogFile, see LogFile::writeRecords()
+ */
+class LogFileWriter : public QThread {
+public:
+    LogFileWriter(LogFile *logFile) : m_logFile(logFile) {}
+
+protected:
+    void run()
+    {
+        m_logFile->writeRecords();
+    }
+
+private:
+    LogFile *m_logFile;
+};
+
+static bool recordBefore(const LogFile::ReplayRecord &record, quint32 timestamp)
+{
+    return record.timestamp < timestamp;
+}
 
 LogFile::LogFile(QObject *parent) :
     QIODevice(parent),
-    m_lastTimeStamp(0),
-    m_lastPlayed(0),
+    m_dataBufferPos(0),
+    m_replayData(0),
+    m_nextRecord(0),
+    m_replayTime(0),
     m_timeOffset(0),
     m_playbackSpeed(1.0),
+    m_writePolicy(WriteImmediate),
+    m_syncInterval(DEFAULT_SYNC_INTERVAL),
+    m_writer(0),
+    m_directFill(0),
+    m_writeStop(false),
     m_nextTimeStamp(0),
     m_useProvidedTimeStamp(false)
 {
     connect(&m_timer, SIGNAL(timeout()), this, SLOT(timerFired()));
 }
 
+LogFile::~LogFile()
+{
+    // the writer thread must not outlive the queue it drains
+    if (m_writer) {
+        close();
+    }
+}
+
 /**
  * Opens the logfile QIODevice and the underlying logfile. In case
  * we want to save the logfile, we open in WriteOnly. In case we
@@ -31,7 +103,14 @@ bool LogFile::open(OpenMode mode)
         return true;
     }
 
-    if (m_file.open(mode) == false) {
+    bool batched = m_writePolicy != WriteImmediate && (mode & QIODevice::WriteOnly);
+    if (batched && m_writePolicy == WriteBatchedDirect && !openDirect(mode)) {
+        qDebug() << "Unable to bypass the page cache for " << m_file.fileName() << ", using batched writes";
+        m_writePolicy = WriteBatched;
+    }
+
+    // the writer thread already writes large blocks, there is no point in buffering them again
+    if (!m_file.isOpen() && m_file.open(batched ? mode | QIODevice::Unbuffered : mode) == false) {
         qDebug() << "Unable to open " << m_file.fileName() << " for logging";
         return false;
     }
@@ -44,9 +123,46 @@ bool LogFile::open(OpenMode mode)
     // during a logfile replay. Read nature is checked upon write ops below.
     QIODevice::open(QIODevice::ReadWrite);
 
+    if (batched) {
+        m_writeBuffer.clear();
+        m_writeBuffer.reserve(2 * WRITE_BLOCK_SIZE);
+        m_writeStop = false;
+        m_writer    = new LogFileWriter(this);
+        m_writer->start();
+    }
+
     return true;
 }
 
+/**
+ * Opens the file for writing with O_DIRECT, so that a long log does not push
+ * everything else out of the page cache. Only supported where O_DIRECT exists.
+ */
+bool LogFile::openDirect(OpenMode mode)
+{
+#ifdef O_DIRECT
+    if ((mode & (QIODevice::ReadOnly | QIODevice::Append)) != 0) {
+        return false;
+    }
+    int fd = ::open(QFile::encodeName(m_file.fileName()).constData(), O_WRONLY | O_CREAT | O_TRUNC | O_DIRECT, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    if (!m_file.open(fd, mode | QIODevice::Unbuffered, QFileDevice::AutoCloseHandle)) {
+        ::close(fd);
+        return false;
+    }
+    m_directBuffer.resize(DIRECT_BUFFER_SIZE + DIRECT_ALIGNMENT);
+    m_directFill = 0;
+    return true;
+
+#else
+    Q_UNUSED(mode);
+    return false;
+
+#endif
+}
+
 void LogFile::close()
 {
     emit aboutToClose();
@@ -54,6 +170,24 @@ void LogFile::close()
     if (m_timer.isActive()) {
         m_timer.stop();
     }
+    if (m_writer) {
+        // let the writer drain the queue and finish the file
+        m_writeMutex.lock();
+        m_writeStop = true;
+        m_writeCondition.wakeOne();
+        m_writeMutex.unlock();
+        m_writer->wait();
+        delete m_writer;
+        m_writer = 0;
+        m_directBuffer.clear();
+    }
+    if (m_replayData && m_replayData != (const uchar *)m_replayCopy.constData()) {
+        m_file.unmap((uchar *)m_replayData);
+    }
+    m_replayData = 0;
+    m_replayCopy.clear();
+    m_replayIndex.clear();
+    m_objectIndex.clear();
     m_file.close();
     QIODevice::close();
 }
@@ -68,6 +202,21 @@ qint64 LogFile::writeData(const char *data, qint64 dataSize)
     // This is used when saving logs from on-board logging
     quint32 timeStamp = m_useProvidedTimeStamp ? m_nextTimeStamp : m_myTime.elapsed();
 
+    if (m_writer) {
+        // only queue the record, the writer thread gets it to the disk
+        m_writeMutex.lock();
+        m_writeBuffer.append((const char *)&timeStamp, sizeof(timeStamp));
+        m_writeBuffer.append((const char *)&dataSize, sizeof(dataSize));
+        m_writeBuffer.append(data, dataSize);
+        if (m_writeBuffer.size() >= WRITE_BLOCK_SIZE) {
+            m_writeCondition.wakeOne();
+        }
+        m_writeMutex.unlock();
+
+        emit bytesWritten(dataSize);
+        return dataSize;
+    }
+
     m_file.write((char *)&timeStamp, sizeof(timeStamp));
     m_file.write((char *)&dataSize, sizeof(dataSize));
 
@@ -79,75 +228,223 @@ qint64 LogFile::writeData(const char *data, qint64 dataSize)
     return dataSize;
 }
 
+/**
+ * Writer thread loop, swaps the queue with its own buffer and writes it out
+ * while the callers of writeData() continue in the other one.
+ */
+void LogFile::writeRecords()
+{
+    QByteArray block;
+    QElapsedTimer lastSync;
+    bool last = false;
+
+    block.reserve(2 * WRITE_BLOCK_SIZE);
+    lastSync.start();
+
+    m_writeMutex.lock();
+    while (!last) {
+        if (!m_writeStop && m_writeBuffer.size() < WRITE_BLOCK_SIZE) {
+            m_writeCondition.wait(&m_writeMutex, WRITE_TIMEOUT);
+        }
+        last = m_writeStop;
+        m_writeBuffer.swap(block);
+        m_writeMutex.unlock();
+
+        if (!writeBlock(block, last)) {
+            qDebug() << "Error writing " << block.size() << " bytes to " << m_file.fileName();
+        }
+        block.resize(0);
+
+        // the end of the file is synced unless it is left to the page cache anyway
+        bool sync = (m_writePolicy == WriteBatchedSync && lastSync.elapsed() >= m_syncInterval)
+                    || (last && m_writePolicy != WriteBatched);
+        if (sync) {
+            syncFile();
+            lastSync.restart();
+        }
+
+        m_writeMutex.lock();
+    }
+    m_writeMutex.unlock();
+}
+
+#ifdef O_DIRECT
+static bool writeAll(int fd, const char *data, qint64 size)
+{
+    while (size > 0) {
+        ssize_t written = ::write(fd, data, size);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written < 0 && errno == EINVAL && (fcntl(fd, F_GETFL) & O_DIRECT)) {
+            // the file system accepted O_DIRECT on open but not on write
+            fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_DIRECT);
+            continue;
+        }
+        if (written < 0) {
+            return false;
+        }
+        data += written;
+        size -= written;
+    }
+    return true;
+}
+#endif
+
+bool LogFile::writeBlock(const QByteArray &block, bool last)
+{
+    if (m_writePolicy != WriteBatchedDirect) {
+        return m_file.write(block) == block.size();
+    }
+
+#ifdef O_DIRECT
+    char *aligned = (char *)(((quintptr)m_directBuffer.data() + DIRECT_ALIGNMENT - 1) & ~(quintptr)(DIRECT_ALIGNMENT - 1));
+    const char *data = block.constData();
+    int remaining    = block.size();
+    int fd = m_file.handle();
+
+    // only whole blocks are written, the rest stays at the front of the buffer
+    while (remaining > 0) {
+        int size = qMin(remaining, DIRECT_BUFFER_SIZE - m_directFill);
+        memcpy(aligned + m_directFill, data, size);
+        data         += size;
+        remaining    -= size;
+        m_directFill += size;
+
+        size = m_directFill / DIRECT_ALIGNMENT * DIRECT_ALIGNMENT;
+        if (!writeAll(fd, aligned, size)) {
+            return false;
+        }
+        m_directFill -= size;
+        memmove(aligned, aligned + size, m_directFill);
+    }
+
+    if (last && m_directFill > 0) {
+        // the end of the file is not a whole block, it has to go through the page cache
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_DIRECT);
+        if (!writeAll(fd, aligned, m_directFill)) {
+            return false;
+        }
+        m_directFill = 0;
+    }
+    return true;
+
+#else
+    Q_UNUSED(last);
+    return m_file.write(block) == block.size();
+
+#endif
+}
+
+void LogFile::syncFile()
+{
+#if defined(Q_OS_WIN)
+    _commit(m_file.handle());
+#elif defined(Q_OS_UNIX)
+    fsync(m_file.handle());
+#endif
+}
+
 qint64 LogFile::readData(char *data, qint64 maxSize)
 {
     QMutexLocker locker(&m_mutex);
-    qint64 toRead = qMin(maxSize, (qint64)m_dataBuffer.size());
+    qint64 toRead = qMin(maxSize, (qint64)m_dataBuffer.size() - m_dataBufferPos);
 
-    memcpy(data, m_dataBuffer.data(), toRead);
-    m_dataBuffer.remove(0, toRead);
+    memcpy(data, m_dataBuffer.constData() + m_dataBufferPos, toRead);
+    m_dataBufferPos += toRead;
+    // move the remaining data to the front only once in a while, not on every read
+    if (m_dataBufferPos == m_dataBuffer.size()) {
+        m_dataBuffer.resize(0);
+        m_dataBufferPos = 0;
+    } else if (m_dataBufferPos > REPLAY_BUFFER_CHUNK) {
+        m_dataBuffer.remove(0, m_dataBufferPos);
+        m_dataBufferPos = 0;
+    }
     return toRead;
 }
 
 qint64 LogFile::bytesAvailable() const
 {
-    return m_dataBuffer.size();
+    return m_dataBuffer.size() - m_dataBufferPos;
 }
 
-void LogFile::timerFired()
+/**
+ * Maps the log file and indexes its records, so that the replay can start
+ * anywhere and never has to read the file again. Records are stored as
+ * timestamp (quint32, ms), size (qint64) and the raw UAVTalk bytes.
+ */
+void LogFile::buildReplayIndex()
 {
-    qint64 dataSize;
-
-    if (m_file.bytesAvailable() > 4) {
-        int time;
-        time = m_myTime.elapsed();
+    qint64 fileSize = m_file.size();
 
-        // TODO: going back in time will be a problem
-        while ((m_lastPlayed + ((time - m_timeOffset) * m_playbackSpeed) > m_lastTimeStamp)) {
-            m_lastPlayed += ((time - m_timeOffset) * m_playbackSpeed);
-            if (m_file.bytesAvailable() < (qint64)sizeof(dataSize)) {
-                stopReplay();
-                return;
-            }
+    m_replayIndex.clear();
+    m_objectIndex.clear();
+    m_replayData = m_file.map(0, fileSize);
+    if (!m_replayData) {
+        // not something that can be mapped, keep a copy instead
+        m_replayCopy = m_file.readAll();
+        m_replayData = (const uchar *)m_replayCopy.constData();
+        fileSize     = m_replayCopy.size();
+    }
 
-            m_file.read((char *)&dataSize, sizeof(dataSize));
+    const qint64 headerSize = sizeof(quint32) + sizeof(qint64);
+    qint64 pos = 0;
+    while (pos + headerSize <= fileSize) {
+        ReplayRecord record;
+        memcpy(&record.timestamp, m_replayData + pos, sizeof(quint32));
+        memcpy(&record.size, m_replayData + pos + sizeof(quint32), sizeof(qint64));
+        record.offset = pos + headerSize;
 
-            if (dataSize < 1 || dataSize > (1024 * 1024)) {
-                qDebug() << "Error: Logfile corrupted! Unlikely packet size: " << dataSize << "\n";
-                stopReplay();
-                return;
+        if (record.size < 1 || record.size > (1024 * 1024) || record.offset + record.size > fileSize) {
+            qDebug() << "Error: Logfile corrupted! Unlikely packet size: " << record.size << "\n";
+            break;
+        }
+        if (!m_replayIndex.isEmpty()) {
+            quint32 save = m_replayIndex.last().timestamp;
+            // some validity checks, the index relies on increasing timestamps
+            if (record.timestamp < save // logfile goes back in time
+                || (record.timestamp - save) > (60 * 60 * 1000)) { // gap of more than 60 minutes)
+                qDebug() << "Error: Logfile corrupted! Unlikely timestamp " << record.timestamp << " after " << save << "\n";
+                break;
             }
+        }
 
-            if (m_file.bytesAvailable() < dataSize) {
-                stopReplay();
-                return;
-            }
+        // UAVTalk writes every object update with a single write, so most records hold exactly one
+        const uchar *frame = m_replayData + record.offset;
+        if (record.size >= UAVTALK_HEADER_LENGTH + UAVTALK_CHECKSUM_LENGTH && frame[0] == UAVTALK_SYNC_VAL
+            && (frame[1] == UAVTALK_TYPE_OBJ || frame[1] == UAVTALK_TYPE_OBJ_ACK)
+            && qFromLittleEndian<quint16>(frame + 2) + UAVTALK_CHECKSUM_LENGTH == record.size) {
+            quint64 key = objectKey(qFromLittleEndian<quint32>(frame + 4), qFromLittleEndian<quint16>(frame + 8));
+            m_objectIndex[key].append(m_replayIndex.size());
+        }
 
-            m_mutex.lock();
-            m_dataBuffer.append(m_file.read(dataSize));
-            m_mutex.unlock();
+        m_replayIndex.append(record);
+        pos = record.offset + record.size;
+    }
+}
 
-            emit readyRead();
+void LogFile::timerFired()
+{
+    int time = m_myTime.elapsed();
 
-            if (m_file.bytesAvailable() < (qint64)sizeof(m_lastTimeStamp)) {
-                stopReplay();
-                return;
-            }
+    m_replayTime += (time - m_timeOffset) * m_playbackSpeed;
+    m_timeOffset  = time;
 
-            int save = m_lastTimeStamp;
-            m_file.read((char *)&m_lastTimeStamp, sizeof(m_lastTimeStamp));
-            // some validity checks
-            if (m_lastTimeStamp < save // logfile goes back in time
-                || (m_lastTimeStamp - save) > (60 * 60 * 1000)) { // gap of more than 60 minutes)
-                qDebug() << "Error: Logfile corrupted! Unlikely timestamp " << m_lastTimeStamp << " after " << save << "\n";
-                stopReplay();
-                return;
-            }
+    bool gotData = false;
+    m_mutex.lock();
+    while (m_nextRecord < m_replayIndex.size() && m_replayIndex[m_nextRecord].timestamp <= m_replayTime) {
+        const ReplayRecord &record = m_replayIndex[m_nextRecord++];
+        m_dataBuffer.append((const char *)m_replayData + record.offset, record.size);
+        gotData = true;
+    }
+    m_mutex.unlock();
 
-            m_timeOffset = time;
-            time = m_myTime.elapsed();
-        }
-    } else {
+    if (gotData) {
+        emit readyRead();
+    }
+    emit replayTimeChanged((int)m_replayTime);
+
+    if (m_nextRecord >= m_replayIndex.size()) {
         stopReplay();
     }
 }
@@ -155,16 +452,109 @@ void LogFile::timerFired()
 bool LogFile::startReplay()
 {
     m_dataBuffer.clear();
+    // keep the buffer allocated while it is repeatedly drained
+    m_dataBuffer.reserve(REPLAY_BUFFER_CHUNK);
+    m_dataBufferPos = 0;
+    buildReplayIndex();
+    m_nextRecord = 0;
+    m_replayTime = replayStartTime();
     m_myTime.restart();
     m_timeOffset = 0;
-    m_lastPlayed = 0;
-    m_file.read((char *)&m_lastTimeStamp, sizeof(m_lastTimeStamp));
     m_timer.setInterval(10);
     m_timer.start();
     emit replayStarted();
     return true;
 }
 
+int LogFile::replayStartTime() const
+{
+    return m_replayIndex.isEmpty() ? 0 : m_replayIndex.first().timestamp;
+}
+
+int LogFile::replayEndTime() const
+{
+    return m_replayIndex.isEmpty() ? 0 : m_replayIndex.last().timestamp;
+}
+
+/**
+ * Index of the first of the given records with a timestamp not before timestamp
+ */
+int LogFile::firstRecordAfter(const QVector<int> &records, quint32 timestamp) const
+{
+    int first = 0;
+    int count = records.size();
+
+    while (count > 0) {
+        int step = count / 2;
+        if (m_replayIndex[records[first + step]].timestamp < timestamp) {
+            first += step + 1;
+            count -= step + 1;
+        } else {
+            count = step;
+        }
+    }
+    return first;
+}
+
+QVector<LogFile::ReplaySample> LogFile::replaySamples(quint32 objId, quint16 instId, int startTime, int endTime) const
+{
+    QVector<ReplaySample> samples;
+    QHash<quint64, QVector<int> >::const_iterator records = m_objectIndex.constFind(objectKey(objId, instId));
+
+    if (records == m_objectIndex.constEnd()) {
+        return samples;
+    }
+    for (int i = firstRecordAfter(*records, qMax(startTime, 0)); i < records->size(); ++i) {
+        const ReplayRecord &record = m_replayIndex[records->at(i)];
+        if (record.timestamp > (quint32)qMax(endTime, 0)) {
+            break;
+        }
+        ReplaySample sample;
+        sample.timestamp = record.timestamp;
+        sample.data = m_replayData + record.offset + UAVTALK_HEADER_LENGTH;
+        sample.size = record.size - UAVTALK_HEADER_LENGTH - UAVTALK_CHECKSUM_LENGTH;
+        samples.append(sample);
+    }
+    return samples;
+}
+
+/**
+ * Moves the replay to the given log time, forwards or backwards.
+ * Data queued for the old position that was not read yet is dropped.
+ * The last update of every object before the new position is replayed
+ * first, so that the GCS shows the state of the vehicle at that time
+ * also for objects that are rarely updated.
+ */
+void LogFile::setReplayTime(int time)
+{
+    m_mutex.lock();
+
+    m_nextRecord = std::lower_bound(m_replayIndex.constBegin(), m_replayIndex.constEnd(), (quint32)qMax(time, 0), recordBefore) - m_replayIndex.constBegin();
+    m_replayTime = time;
+    m_timeOffset = m_myTime.elapsed();
+    m_dataBuffer.resize(0);
+    m_dataBufferPos = 0;
+
+    QVector<int> state;
+    foreach(const QVector<int> &records, m_objectIndex) {
+        int last = firstRecordAfter(records, qMax(time, 0)) - 1;
+        if (last >= 0) {
+            state.append(records[last]);
+        }
+    }
+    std::sort(state.begin(), state.end());
+    foreach(int index, state) {
+        const ReplayRecord &record = m_replayIndex[index];
+        m_dataBuffer.append((const char *)m_replayData + record.offset, record.size);
+    }
+    m_mutex.unlock();
+
+    if (!state.isEmpty()) {
+        emit readyRead();
+    }
+    emit replaySeeked(time);
+}
+
 bool LogFile::stopReplay()
 {
     close();
@@ -8,12 +8,46 @@
 #include <QDebug>
 #include <QBuffer>
 #include <QFile>
+#include <QHash>
+#include <QVector>
+#include <QWaitCondition>
 #include "utils_global.h"
 
+class LogFileWriter;
+
 class QTCREATOR_UTILS_EXPORT LogFile : public QIODevice {
     Q_OBJECT
+    friend class LogFileWriter;
 public:
+    // how recorded data gets to the disk, set before opening the file for writing
+    enum WritePolicy {
+        // every record is written by the calling thread
+        WriteImmediate,
+        // records are queued and written in large blocks by a writer thread
+        WriteBatched,
+        // as WriteBatched, and the file is synced to disk every sync interval
+        WriteBatchedSync,
+        // as WriteBatched, bypassing the page cache where the platform supports it
+        WriteBatchedDirect
+    };
+    static const int DEFAULT_SYNC_INTERVAL = 1000;
+
+    // one record of the replayed log, data points into the mapped file
+    struct ReplayRecord {
+        quint32 timestamp;
+        qint64  offset;
+        qint64  size;
+    };
+
+    // one update of an object in the replayed log, data points to the packed object
+    struct ReplaySample {
+        quint32 timestamp;
+        const uchar *data;
+        int size;
+    };
+
     explicit LogFile(QObject *parent = 0);
+    ~LogFile();
     qint64 bytesAvailable() const;
     qint64 bytesToWrite() const
     {
@@ -30,6 +64,16 @@ public:
 
     bool startReplay();
     bool stopReplay();
+    // timestamps of the first and last record of the replayed log, in ms
+    int replayStartTime() const;
+    int replayEndTime() const;
+    // current position of the replay, in ms of log time
+    int replayTime() const
+    {
+        return (int)m_replayTime;
+    }
+    // all updates of an object instance between two log times, in time order
+    QVector<ReplaySample> replaySamples(quint32 objId, quint16 instId, int startTime, int endTime) const;
     void useProvidedTimeStamp(bool useProvidedTimeStamp)
     {
         m_useProvidedTimeStamp = useProvidedTimeStamp;
@@ -40,6 +84,12 @@ public:
         m_nextTimeStamp = nextTimestamp;
     }
 
+    void setWritePolicy(WritePolicy policy, int syncInterval = DEFAULT_SYNC_INTERVAL)
+    {
+        m_writePolicy  = policy;
+        m_syncInterval = syncInterval;
+    }
+
 public slots:
     void setReplaySpeed(double val)
     {
@@ -48,6 +98,7 @@ public slots:
     };
     void pauseReplay();
     void resumeReplay();
+    void setReplayTime(int time);
 
 protected slots:
     void timerFired();
@@ -56,20 +107,46 @@ signals:
     void readReady();
     void replayStarted();
     void replayFinished();
+    void replayTimeChanged(int time);
+    // the replay jumped to another position, emitted after setReplayTime()
+    void replaySeeked(int time);
 
 protected:
+    void buildReplayIndex();
+    int firstRecordAfter(const QVector<int> &records, quint32 timestamp) const;
+    bool openDirect(OpenMode mode);
+    void writeRecords();
+    bool writeBlock(const QByteArray &block, bool last);
+    void syncFile();
+
     QByteArray m_dataBuffer;
+    qint64 m_dataBufferPos; // first byte of m_dataBuffer not read yet
     QTimer m_timer;
     QTime m_myTime;
     QFile m_file;
-    qint32 m_lastTimeStamp;
-    qint32 m_lastPlayed;
     QMutex m_mutex;
 
+    const uchar *m_replayData;
+    QByteArray m_replayCopy; // holds the data when the file can not be mapped
+    QVector<ReplayRecord> m_replayIndex;
+    // records holding a single object update, by object and instance id
+    QHash<quint64, QVector<int> > m_objectIndex;
+    int m_nextRecord;
+    double m_replayTime;
 
     int m_timeOffset;
     double m_playbackSpeed;
 
+    WritePolicy m_writePolicy;
+    int m_syncInterval;
+    LogFileWriter *m_writer;
+    QMutex m_writeMutex;
+    QWaitCondition m_writeCondition;
+    QByteArray m_writeBuffer; // records queued for the writer thread
+    QByteArray m_directBuffer; // O_DIRECT only transfers whole blocks from aligned memory
+    int m_directFill;
+    bool m_writeStop;
+
 private:
     quint32 m_nextTimeStamp;
     bool m_useProvidedTimeStamp;
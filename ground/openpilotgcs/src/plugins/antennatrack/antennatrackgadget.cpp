@@ -92,8 +92,12 @@ void AntennaTrackGadget::loadConfiguration(IUAVGadgetConfiguration *config)
     qDebug() << "Using Telemetry parser";
     parser = new TelemetryParser();
 
+    m_widget->setPrediction(AntennaTrackConfig->gpsLatency(), AntennaTrackConfig->trackRate());
+
     connect(parser, SIGNAL(position(double, double, double)), m_widget, SLOT(setPosition(double, double, double)));
     connect(parser, SIGNAL(home(double, double, double)), m_widget, SLOT(setHomePosition(double, double, double)));
+    connect(parser, SIGNAL(velocity(double, double, double)), m_widget, SLOT(setVelocity(double, double, double)));
+    connect(parser, SIGNAL(linkLatency(int)), m_widget, SLOT(setLinkLatency(int)));
     connect(parser, SIGNAL(packet(QString)), m_widget, SLOT(dumpPacket(QString)));
 }
 
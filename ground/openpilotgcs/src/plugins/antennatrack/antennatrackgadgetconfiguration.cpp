@@ -41,7 +41,9 @@ AntennaTrackGadgetConfiguration::AntennaTrackGadgetConfiguration(QString classId
     m_defaultFlow(QSerialPort::UnknownFlowControl),
     m_defaultParity(QSerialPort::UnknownParity),
     m_defaultStopBits(QSerialPort::UnknownStopBits),
-    m_defaultTimeOut(5000)
+    m_defaultTimeOut(5000),
+    m_gpsLatency(100),
+    m_trackRate(20)
 {
     // if a saved configuration exists load it
     if (qSettings != 0) {
@@ -71,6 +73,8 @@ AntennaTrackGadgetConfiguration::AntennaTrackGadgetConfiguration(QString classId
         m_defaultParity   = parity;
         m_defaultStopBits = stopbits;
         m_connectionMode  = conMode;
+        m_gpsLatency = qSettings->value("gpsLatency", m_gpsLatency).toInt();
+        m_trackRate  = qSettings->value("trackRate", m_trackRate).toInt();
     }
 }
 
@@ -89,6 +93,8 @@ IUAVGadgetConfiguration *AntennaTrackGadgetConfiguration::clone()
     m->m_defaultStopBits = m_defaultStopBits;
     m->m_defaultPort     = m_defaultPort;
     m->m_connectionMode  = m_connectionMode;
+    m->m_gpsLatency = m_gpsLatency;
+    m->m_trackRate  = m_trackRate;
     return m;
 }
 
@@ -105,4 +111,6 @@ void AntennaTrackGadgetConfiguration::saveConfig(QSettings *settings) const
     settings->setValue("defaultStopBits", m_defaultStopBits);
     settings->setValue("defaultPort", m_defaultPort);
     settings->setValue("connectionMode", m_connectionMode);
+    settings->setValue("gpsLatency", m_gpsLatency);
+    settings->setValue("trackRate", m_trackRate);
 }
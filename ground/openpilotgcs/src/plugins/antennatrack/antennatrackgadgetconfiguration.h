@@ -89,6 +89,14 @@ public:
     {
         m_defaultTimeOut = timeout;
     }
+    void setGpsLatency(int latency)
+    {
+        m_gpsLatency = latency;
+    }
+    void setTrackRate(int rate)
+    {
+        m_trackRate = rate;
+    }
 
     // get port configuration functions
     QString port()
@@ -119,6 +127,16 @@ public:
     {
         return m_defaultTimeOut;
     }
+    // Age of a GPS position when it is sent by the board, in ms
+    int gpsLatency()
+    {
+        return m_gpsLatency;
+    }
+    // Tracker commands per second
+    int trackRate()
+    {
+        return m_trackRate;
+    }
 
     void saveConfig(QSettings *settings) const;
     IUAVGadgetConfiguration *clone();
@@ -132,6 +150,8 @@ private:
     QSerialPort::Parity m_defaultParity;
     QSerialPort::StopBits m_defaultStopBits;
     long m_defaultTimeOut;
+    int m_gpsLatency;
+    int m_trackRate;
 };
 
 #endif // ANTENNATRACKGADGETCONFIGURATION_H
@@ -132,6 +132,10 @@ QWidget *AntennaTrackGadgetOptionsPage::createPage(QWidget *parent)
     // TIMEOUT
     options_page->timeoutSpinBox->setValue(m_config->timeOut());
 
+    // PREDICTION
+    options_page->gpsLatencySpinBox->setValue(m_config->gpsLatency());
+    options_page->trackRateSpinBox->setValue(m_config->trackRate());
+
     QStringList connectionModes;
     connectionModes << "Serial";
     options_page->connectionMode->addItems(connectionModes);
@@ -163,6 +167,8 @@ void AntennaTrackGadgetOptionsPage::apply()
     m_config->setStopBits((QSerialPort::StopBits)options_page->stopBitsComboBox->itemData(options_page->stopBitsComboBox->currentIndex()).toInt());
     m_config->setParity((QSerialPort::Parity)options_page->parityComboBox->itemData(options_page->parityComboBox->currentIndex()).toInt());
     m_config->setTimeOut(options_page->timeoutSpinBox->value());
+    m_config->setGpsLatency(options_page->gpsLatencySpinBox->value());
+    m_config->setTrackRate(options_page->trackRateSpinBox->value());
     m_config->setConnectionMode(options_page->connectionMode->currentText());
 }
 
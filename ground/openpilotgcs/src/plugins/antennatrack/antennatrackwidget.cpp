@@ -34,6 +34,11 @@
 #include <QtGui>
 #include <QDebug>
 
+#define EARTH_RADIUS      6371000.0
+// A position older than this is not extrapolated further
+#define MAX_PREDICTION_MS 2000
+#define STEPPER_STEPS     400
+
 /*
  * Initialize the widget
  */
@@ -41,8 +46,14 @@ AntennaTrackWidget::AntennaTrackWidget(QWidget *parent) : QWidget(parent)
 {
     setupUi(this);
 
-    azimuth_old   = 0;
-    elevation_old = 0;
+    memset(&TrackData, 0, sizeof(TrackData));
+    azimuth_old      = 0;
+    elevation_old    = 0;
+    stepper_position = 0;
+    gps_latency  = 0;
+    link_latency = 0;
+
+    connect(&trackTimer, SIGNAL(timeout()), this, SLOT(updateTracker()));
 }
 
 AntennaTrackWidget::~AntennaTrackWidget()
@@ -52,6 +63,46 @@ void AntennaTrackWidget::setPort(QPointer<QSerialPort> portx)
     port = portx;
 }
 
+/*
+ * The tracker is commanded at trackRate from the position extrapolated to now,
+ * the position itself is gpsLatency plus the measured telemetry delay old.
+ */
+void AntennaTrackWidget::setPrediction(int gpsLatency, int trackRate)
+{
+    gps_latency = gpsLatency;
+    trackTimer.start(1000 / qMax(trackRate, 1));
+}
+
+void AntennaTrackWidget::setVelocity(double north, double east, double down)
+{
+    TrackData.VelocityNorth = north;
+    TrackData.VelocityEast  = east;
+    TrackData.VelocityDown  = down;
+}
+
+void AntennaTrackWidget::setLinkLatency(int latency)
+{
+    link_latency = latency;
+}
+
+void AntennaTrackWidget::updateTracker()
+{
+    if (!positionTime.isValid()) {
+        return;
+    }
+
+    double dt  = qMin(positionTime.elapsed() + link_latency + gps_latency, (qint64)MAX_PREDICTION_MS) / 1000.0;
+    double lat = TrackData.Latitude + (TrackData.VelocityNorth * dt / EARTH_RADIUS) * (180 / M_PI);
+    double lon = TrackData.Longitude;
+    double cosLat = cos(TrackData.Latitude * (M_PI / 180));
+    if (cosLat > 0.01) {
+        lon += (TrackData.VelocityEast * dt / (EARTH_RADIUS * cosLat)) * (180 / M_PI);
+    }
+    double alt = TrackData.Altitude - TrackData.VelocityDown * dt;
+
+    calcAntennaPosition(lat, lon, alt);
+}
+
 void AntennaTrackWidget::dumpPacket(const QString &packet)
 {
     textBrowser->append(packet);
@@ -95,7 +146,7 @@ void AntennaTrackWidget::setPosition(double lat, double lon, double alt)
     TrackData.Latitude  = lat;
     TrackData.Longitude = lon;
     TrackData.Altitude  = alt;
-    calcAntennaPosition();
+    positionTime.start();
 }
 
 void AntennaTrackWidget::setHomePosition(double lat, double lon, double alt)
@@ -129,23 +180,22 @@ void AntennaTrackWidget::setHomePosition(double lat, double lon, double alt)
     TrackData.HomeLatitude  = lat;
     TrackData.HomeLongitude = lon;
     TrackData.HomeAltitude  = alt;
-    calcAntennaPosition();
 }
 
-void AntennaTrackWidget::calcAntennaPosition(void)
+void AntennaTrackWidget::calcAntennaPosition(double lat, double lon, double alt)
 {
     /** http://www.movable-type.co.uk/scripts/latlong.html **/
     double lat1, lat2, lon1, lon2, a, c, d, x, y, brng;
     double azimuth, elevation;
     double gcsAlt = TrackData.HomeAltitude; // Home MSL altitude
-    double uavAlt = TrackData.Altitude; // UAV MSL altitude
+    double uavAlt = alt; // UAV MSL altitude
     double dAlt   = uavAlt - gcsAlt; // Altitude difference
 
     // Convert to radians
     lat1 = TrackData.HomeLatitude * (M_PI / 180); // Home lat
     lon1 = TrackData.HomeLongitude * (M_PI / 180); // Home lon
-    lat2 = TrackData.Latitude * (M_PI / 180); // UAV lat
-    lon2 = TrackData.Longitude * (M_PI / 180); // UAV lon
+    lat2 = lat * (M_PI / 180); // UAV lat
+    lon2 = lon * (M_PI / 180); // UAV lon
 
     // Bearing
     /**
@@ -198,13 +248,21 @@ void AntennaTrackWidget::calcAntennaPosition(void)
 
     // servo value 2000-4000
     int servo   = (int)(2000.0 / 180 * elevation + 2000);
-    int stepper = (int)(400.0 / 360 * (azimuth - azimuth_old));
+    // The stepper moves relative to where it was last sent, computed from its absolute
+    // position so that small steps are not lost to rounding, the short way across north
+    int stepper = (int)lround((double)STEPPER_STEPS / 360 * azimuth) - stepper_position;
+    if (stepper > STEPPER_STEPS / 2) {
+        stepper -= STEPPER_STEPS;
+    } else if (stepper < -STEPPER_STEPS / 2) {
+        stepper += STEPPER_STEPS;
+    }
 
     // send azimuth and elevation to tracker hardware
     str3.sprintf("move %d 2000 2000 2000 %d\r", stepper, servo);
-    if (port->isOpen()) {
-        if (azimuth_old != azimuth || elevation != elevation_old) {
+    if (port && port->isOpen()) {
+        if (stepper != 0 || elevation != elevation_old) {
             port->write(str3.toLatin1());
+            stepper_position = (stepper_position + stepper + STEPPER_STEPS) % STEPPER_STEPS;
         }
     }
     azimuth_old   = azimuth;
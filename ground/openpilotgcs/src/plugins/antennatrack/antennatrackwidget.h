@@ -36,6 +36,8 @@
 #include <QtSvg/QGraphicsSvgItem>
 #include <QtSerialPort/QSerialPort>
 #include <QPointer>
+#include <QElapsedTimer>
+#include <QTimer>
 
 class Ui_AntennaTrackWidget;
 
@@ -46,6 +48,9 @@ typedef struct struct_TrackData {
     double HomeLatitude;
     double HomeLongitude;
     double HomeAltitude;
+    double VelocityNorth;
+    double VelocityEast;
+    double VelocityDown;
 } TrackData_t;
 
 class AntennaTrackWidget : public QWidget, public Ui_AntennaTrackWidget {
@@ -56,17 +61,27 @@ public:
     ~AntennaTrackWidget();
     TrackData_t TrackData;
     void setPort(QPointer<QSerialPort> portx);
+    void setPrediction(int gpsLatency, int trackRate);
 
 private slots:
     void setPosition(double, double, double);
     void setHomePosition(double, double, double);
+    void setVelocity(double, double, double);
+    void setLinkLatency(int);
+    void updateTracker();
     void dumpPacket(const QString &packet);
 
 private:
-    void calcAntennaPosition(void);
+    void calcAntennaPosition(double lat, double lon, double alt);
     QGraphicsSvgItem *marker;
     QPointer<QSerialPort> port;
     double azimuth_old;
     double elevation_old;
+    int stepper_position;
+    // Time since the last position, used to extrapolate it with the velocity
+    QElapsedTimer positionTime;
+    QTimer trackTimer;
+    int gps_latency;
+    int link_latency;
 };
 #endif /* ANTENNATRACKWIDGET_H_ */
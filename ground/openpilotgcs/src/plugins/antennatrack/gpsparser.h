@@ -44,6 +44,8 @@ signals:
     void sv(int); // Satellites in view
     void position(double, double, double); // Lat, Lon, Alt
     void home(double, double, double); // Lat, Lon, Alt
+    void velocity(double, double, double); // North, East, Down in m/s
+    void linkLatency(int); // One way telemetry delay in ms
     void datetime(double, double); // Date then time
     void speedheading(double, double);
     void packet(QString); // Raw NMEA Packet (or just info)
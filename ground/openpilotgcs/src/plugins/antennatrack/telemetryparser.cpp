@@ -31,11 +31,14 @@
 #include <QDebug>
 #include <QStringList>
 
+// The telemetry round trip is measured this often
+#define LATENCY_PERIOD 2000
 
 /**
  * Initialize the parser
  */
-TelemetryParser::TelemetryParser(QObject *parent) : GPSParser(parent)
+TelemetryParser::TelemetryParser(QObject *parent) : GPSParser(parent),
+    latencyObj(0), latencyPending(false)
 {
     ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
     UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
@@ -53,6 +56,20 @@ TelemetryParser::TelemetryParser(QObject *parent) : GPSParser(parent)
     } else {
         qDebug() << "Error: Object is unknown (HomeLocation).";
     }
+
+    gpsObj = dynamic_cast<UAVDataObject *>(objManager->getObject("GPSVelocitySensor"));
+    if (gpsObj != NULL) {
+        connect(gpsObj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(updateVelocity(UAVObject *)));
+    } else {
+        qDebug() << "Error: Object is unknown (GPSVelocitySensor).";
+    }
+
+    latencyObj = objManager->getObject("FlightStatus");
+    if (latencyObj != NULL) {
+        connect(latencyObj, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(latencyMeasured(UAVObject *, bool)));
+        connect(&latencyTimer, SIGNAL(timeout()), this, SLOT(measureLatency()));
+        latencyTimer.start(LATENCY_PERIOD);
+    }
 }
 
 TelemetryParser::~TelemetryParser()
@@ -80,3 +97,31 @@ void TelemetryParser::updateGPS(UAVObject *object1)
     lon *= 1E-7;
     emit position(lat, lon, alt);
 }
+
+void TelemetryParser::updateVelocity(UAVObject *object1)
+{
+    double north = object1->getField(QString("North"))->getDouble();
+    double east  = object1->getField(QString("East"))->getDouble();
+    double down  = object1->getField(QString("Down"))->getDouble();
+
+    emit velocity(north, east, down);
+}
+
+/**
+ * Time a FlightStatus request, half of the round trip is the delay of the telemetry
+ */
+void TelemetryParser::measureLatency()
+{
+    // A request that did not complete within the period is given up
+    latencyPending = true;
+    latencyTime.start();
+    latencyObj->requestUpdate();
+}
+
+void TelemetryParser::latencyMeasured(UAVObject *, bool success)
+{
+    if (latencyPending && success) {
+        emit linkLatency(latencyTime.elapsed() / 2);
+    }
+    latencyPending = false;
+}
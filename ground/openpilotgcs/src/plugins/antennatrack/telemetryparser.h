@@ -34,6 +34,8 @@
 #include "uavobjectmanager.h"
 #include "uavobject.h"
 #include "gpsparser.h"
+#include <QElapsedTimer>
+#include <QTimer>
 
 
 class TelemetryParser : public GPSParser {
@@ -45,6 +47,17 @@ public:
 public slots:
     void updateGPS(UAVObject *object1);
     void updateHome(UAVObject *object1);
+    void updateVelocity(UAVObject *object1);
+
+private slots:
+    void measureLatency();
+    void latencyMeasured(UAVObject *, bool success);
+
+private:
+    UAVObject *latencyObj;
+    QTimer latencyTimer;
+    QElapsedTimer latencyTime;
+    bool latencyPending;
 };
 
 #endif // TELEMETRYPARSER_H
@@ -46,13 +46,65 @@ bool CalibrationUtils::EllipsoidCalibration(Eigen::VectorXf *samplesX, Eigen::Ve
                                             float nominalRange,
                                             EllipsoidCalibrationResult *result,
                                             bool fitAlongXYZ)
+{
+    EllipsoidFitAccumulator accumulator(fitAlongXYZ);
+
+    for (int i = 0; i < samplesX->rows(); i++) {
+        accumulator.addSample(samplesX->coeff(i), samplesY->coeff(i), samplesZ->coeff(i));
+    }
+    return accumulator.calibrate(nominalRange, result);
+}
+
+CalibrationUtils::EllipsoidFitAccumulator::EllipsoidFitAccumulator(bool fitAlongXYZ) :
+    m_fitAlongXYZ(fitAlongXYZ)
+{
+    clear();
+}
+
+void CalibrationUtils::EllipsoidFitAccumulator::clear()
+{
+    int parameters = m_fitAlongXYZ ? 6 : 9;
+
+    m_count = 0;
+    m_dtd.setZero(parameters, parameters);
+    m_dt1.setZero(parameters);
+}
+
+void CalibrationUtils::EllipsoidFitAccumulator::addSample(float x, float y, float z)
+{
+    Eigen::VectorXd d(m_dt1.rows());
+
+    // One row of D, see EllipsoidFit() for the meaning of the columns
+    if (!m_fitAlongXYZ) {
+        d << (double)x * x, (double)y * y, (double)z * z,
+            2.0 * x * y, 2.0 * x * z, 2.0 * y * z,
+            2.0 * x, 2.0 * y, 2.0 * z;
+    } else {
+        d << (double)x * x, (double)y * y, (double)z * z,
+            2.0 * x, 2.0 * y, 2.0 * z;
+    }
+    m_dtd.selfadjointView<Eigen::Lower>().rankUpdate(d);
+    m_dt1 += d;
+    m_count++;
+}
+
+bool CalibrationUtils::EllipsoidFitAccumulator::calibrate(float nominalRange, EllipsoidCalibrationResult *result) const
 {
     Eigen::VectorXf radii;
     Eigen::Vector3f center;
     Eigen::MatrixXf evecs;
 
-    EllipsoidFit(samplesX, samplesY, samplesZ, &center, &radii, &evecs, fitAlongXYZ);
+    // Solve the normal system of equations, only the lower triangle of D'D was accumulated
+    Eigen::VectorXd v = m_dtd.selfadjointView<Eigen::Lower>().ldlt().solve(m_dt1);
 
+    EllipsoidFit(v.cast<float>(), &center, &radii, &evecs, m_fitAlongXYZ);
+    EllipsoidResult(center, radii, evecs, nominalRange, result);
+    return true;
+}
+
+void CalibrationUtils::EllipsoidResult(Eigen::Vector3f center, Eigen::VectorXf radii, Eigen::MatrixXf evecs,
+                                       float nominalRange, EllipsoidCalibrationResult *result)
+{
     result->Scale.setZero();
 
     result->Scale << nominalRange / radii.coeff(0),
@@ -67,7 +119,6 @@ bool CalibrationUtils::EllipsoidCalibration(Eigen::VectorXf *samplesX, Eigen::Ve
     result->CalibrationMatrix = evecs * tmp * evecs.transpose();
     result->Bias.setZero();
     result->Bias << center.coeff(0), center.coeff(1), center.coeff(2);
-    return true;
 }
 
 bool CalibrationUtils::PolynomialCalibration(VectorXf *samplesX, Eigen::VectorXf *samplesY, int degree, Eigen::Ref<Eigen::VectorXf> result, const double maxRelativeError)
@@ -78,19 +129,13 @@ bool CalibrationUtils::PolynomialCalibration(VectorXf *samplesX, Eigen::VectorXf
     VectorXd doubleY = samplesY->cast<double>();
     Eigen::MatrixXd x(samples, degree + 1);
 
-    x.setOnes(samples, degree + 1);
-
+    x.col(0).setOnes();
     for (int i = 1; i < degree + 1; i++) {
-        Eigen::MatrixXd tmp  = Eigen::MatrixXd(x.col(i - 1));
-        Eigen::MatrixXd tmp2 = tmp.cwiseProduct(doubleX);
-
-        x.col(i) = tmp2;
+        x.col(i) = x.col(i - 1).cwiseProduct(doubleX);
     }
-    Eigen::MatrixXd xt   = x.transpose();
-
-    Eigen::MatrixXd xtx  = xt * x;
 
-    Eigen::VectorXd xty  = xt * doubleY;
+    Eigen::MatrixXd xtx  = x.transpose() * x;
+    Eigen::VectorXd xty  = x.transpose() * doubleY;
     Eigen::VectorXd tmpx = xtx.fullPivHouseholderQr().solve(xty);
     result = tmpx.cast<float>();
     double relativeError = (xtx * tmpx - xty).norm() / xty.norm();
@@ -283,43 +328,16 @@ void CalibrationUtils::ComputePoly(VectorXf *samplesX, Eigen::VectorXf *polynomi
 
  */
 
-void CalibrationUtils::EllipsoidFit(Eigen::VectorXf *samplesX, Eigen::VectorXf *samplesY, Eigen::VectorXf *samplesZ,
+/*
+ * The normal system of equations v = (D' * D) \ (D' * ones) is accumulated and solved
+ * by EllipsoidFitAccumulator, here v is turned into the ellipsoid parameters.
+ */
+void CalibrationUtils::EllipsoidFit(const Eigen::VectorXf &v,
                                     Eigen::Vector3f *center,
                                     Eigen::VectorXf *radii,
                                     Eigen::MatrixXf *evecs,
                                     bool fitAlongXYZ)
 {
-    int numSamples = (*samplesX).rows();
-    Eigen::MatrixXf D;
-
-    if (!fitAlongXYZ) {
-        D.setZero(numSamples, 9);
-        D.col(0) = (*samplesX).cwiseProduct(*samplesX);
-        D.col(1) = (*samplesY).cwiseProduct(*samplesY);
-        D.col(2) = (*samplesZ).cwiseProduct(*samplesZ);
-        D.col(3) = (*samplesX).cwiseProduct(*samplesY) * 2;
-        D.col(4) = (*samplesX).cwiseProduct(*samplesZ) * 2;
-        D.col(5) = (*samplesY).cwiseProduct(*samplesZ) * 2;
-        D.col(6) = 2 * (*samplesX);
-        D.col(7) = 2 * (*samplesY);
-        D.col(8) = 2 * (*samplesZ);
-    } else {
-        D.setZero(numSamples, 6);
-        D.setZero();
-        D.col(0) = (*samplesX).cwiseProduct(*samplesX);
-        D.col(1) = (*samplesY).cwiseProduct(*samplesY);
-        D.col(2) = (*samplesZ).cwiseProduct(*samplesZ);
-        D.col(3) = 2 * (*samplesX);
-        D.col(4) = 2 * (*samplesY);
-        D.col(5) = 2 * (*samplesZ);
-    }
-    Eigen::VectorXf ones(numSamples);
-    ones.setOnes(numSamples);
-
-    Eigen::MatrixXf dt1 = (D.transpose() * D);
-    Eigen::MatrixXf dt2 = (D.transpose() * ones);
-    Eigen::VectorXf v   = dt1.inverse() * dt2;
-
     if (!fitAlongXYZ) {
         Eigen::Matrix4f A;
         A << v.coeff(0), v.coeff(3), v.coeff(4), v.coeff(6),
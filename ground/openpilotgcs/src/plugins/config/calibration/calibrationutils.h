@@ -41,6 +41,30 @@ public:
         Eigen::Vector3f Scale;
         Eigen::Vector3f Bias;
     };
+
+    /**
+     * Accumulates the normal equations of the ellipsoid fit one sample at a time, so that
+     * the samples need not be kept and the fit at the end of the collection is immediate.
+     */
+    class EllipsoidFitAccumulator {
+public:
+        explicit EllipsoidFitAccumulator(bool fitAlongXYZ);
+        void clear();
+        void addSample(float x, float y, float z);
+        int count() const
+        {
+            return m_count;
+        }
+        bool calibrate(float nominalRange, EllipsoidCalibrationResult *result) const;
+
+private:
+        bool m_fitAlongXYZ;
+        int m_count;
+        // D'D and D'1 of the ellipsoid equation, D having one row per sample
+        Eigen::MatrixXd m_dtd;
+        Eigen::VectorXd m_dt1;
+    };
+
     static bool EllipsoidCalibration(Eigen::VectorXf *samplesX, Eigen::VectorXf *samplesY, Eigen::VectorXf *samplesZ,
                                      float nominalRange,
                                      EllipsoidCalibrationResult *result,
@@ -54,10 +78,12 @@ public:
     static double listMean(QList<double> list);
     static double listVar(QList<double> list);
 private:
-    static void EllipsoidFit(Eigen::VectorXf *samplesX, Eigen::VectorXf *samplesY, Eigen::VectorXf *samplesZ,
+    static void EllipsoidFit(const Eigen::VectorXf &v,
                              Eigen::Vector3f *center,
                              Eigen::VectorXf *radii,
                              Eigen::MatrixXf *evecs, bool fitAlongXYZ);
+    static void EllipsoidResult(Eigen::Vector3f center, Eigen::VectorXf radii, Eigen::MatrixXf evecs,
+                                float nominalRange, EllipsoidCalibrationResult *result);
 
     static int LinearEquationsSolve(int nDim, double *pfMatr, double *pfVect, double *pfSolution);
 };
@@ -31,6 +31,7 @@
 #include <uavtalk/telemetrymanager.h>
 #include "version_info/version_info.h"
 
+#include <QtConcurrent/QtConcurrentRun>
 #include <math.h>
 
 // uncomment to simulate board warming up (no need to put it in the fridge...)
@@ -63,6 +64,7 @@ ThermalCalibrationHelper::ThermalCalibrationHelper(QObject *parent) :
     ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
     TelemetryManager *telMngr = pm->getObject<TelemetryManager>();
     connect(telMngr, SIGNAL(disconnected()), this, SLOT(cleanup()));
+    connect(&m_calculation, SIGNAL(finished()), this, SLOT(calculationFinished()));
 }
 
 /**
@@ -300,56 +302,54 @@ void ThermalCalibrationHelper::cleanup()
 
 void ThermalCalibrationHelper::calculate()
 {
+    // Large datasets take a while to fit, do it on a worker thread with copies of the samples
+    m_calculation.setFuture(QtConcurrent::run(&ThermalCalibrationHelper::computeResults, m_baroSamples, m_gyroSamples));
+}
+
+/**
+ * @brief Fit the compensation polynomials, runs on a worker thread
+ */
+Results ThermalCalibrationHelper::computeResults(QList<BaroSensor::DataFields> baroSamples, QList<GyroSensor::DataFields> gyroSamples)
+{
+    Results results = Results();
+
     // baro
-    int count = m_baroSamples.count();
+    int count = baroSamples.count();
     Eigen::VectorXf datax(count);
     Eigen::VectorXf datay(1);
     Eigen::VectorXf dataz(1);
     Eigen::VectorXf datat(count);
 
     for (int x = 0; x < count; x++) {
-        datax[x] = m_baroSamples[x].Pressure;
-        datat[x] = m_baroSamples[x].Temperature;
+        datax[x] = baroSamples[x].Pressure;
+        datat[x] = baroSamples[x].Temperature;
     }
 
-    m_results.baroCalibrated = ThermalCalibration::BarometerCalibration(datax, datat, m_results.baro,
-                                                                        &m_results.baroInSigma, &m_results.baroOutSigma);
-    if (m_results.baroCalibrated) {
-        addInstructions(tr("Barometer is calibrated."));
-    } else {
-        qDebug() << "Failed to calibrate baro!";
-        addInstructions(tr("Failed to calibrate barometer!"), WizardModel::Warn);
-    }
-
-    m_results.baroTempMin = datat.array().minCoeff();
-    m_results.baroTempMax = datat.array().maxCoeff();
+    results.baroCalibrated = ThermalCalibration::BarometerCalibration(datax, datat, results.baro,
+                                                                      &results.baroInSigma, &results.baroOutSigma);
+    results.baroTempMin    = datat.array().minCoeff();
+    results.baroTempMax    = datat.array().maxCoeff();
 
     // gyro
-    count = m_gyroSamples.count();
+    count = gyroSamples.count();
     datax.resize(count);
     datay.resize(count);
     dataz.resize(count);
     datat.resize(count);
 
     for (int x = 0; x < count; x++) {
-        datax[x] = m_gyroSamples[x].x;
-        datay[x] = m_gyroSamples[x].y;
-        dataz[x] = m_gyroSamples[x].z;
-        datat[x] = m_gyroSamples[x].temperature;
+        datax[x] = gyroSamples[x].x;
+        datay[x] = gyroSamples[x].y;
+        dataz[x] = gyroSamples[x].z;
+        datat[x] = gyroSamples[x].temperature;
     }
 
-    m_results.gyroCalibrated = ThermalCalibration::GyroscopeCalibration(datax, datay, dataz, datat, m_results.gyro,
-                                                                        m_results.gyroInSigma, m_results.gyroOutSigma);
-    if (m_results.gyroCalibrated) {
-        addInstructions(tr("Gyro is calibrated."));
-    } else {
-        qDebug() << "Failed to calibrate gyro!";
-        addInstructions(tr("Failed to calibrate gyro!"), WizardModel::Warn);
-    }
+    results.gyroCalibrated = ThermalCalibration::GyroscopeCalibration(datax, datay, dataz, datat, results.gyro,
+                                                                      results.gyroInSigma, results.gyroOutSigma);
 
     // accel
-    m_results.accelGyroTempMin = datat.array().minCoeff();
-    m_results.accelGyroTempMax = datat.array().maxCoeff();
+    results.accelGyroTempMin = datat.array().minCoeff();
+    results.accelGyroTempMax = datat.array().maxCoeff();
     // TODO: sanity checks needs to be enforced before accel calibration can be enabled and usable.
     /*
        count = m_accelSamples.count();
@@ -367,7 +367,28 @@ void ThermalCalibrationHelper::calculate()
 
        m_results.accelCalibrated = ThermalCalibration::AccelerometerCalibration(datax, datay, dataz, datat, m_results.accel);
      */
-    m_results.accelCalibrated  = false;
+    results.accelCalibrated = false;
+
+    return results;
+}
+
+void ThermalCalibrationHelper::calculationFinished()
+{
+    m_results = m_calculation.result();
+
+    if (m_results.baroCalibrated) {
+        addInstructions(tr("Barometer is calibrated."));
+    } else {
+        qDebug() << "Failed to calibrate baro!";
+        addInstructions(tr("Failed to calibrate barometer!"), WizardModel::Warn);
+    }
+    if (m_results.gyroCalibrated) {
+        addInstructions(tr("Gyro is calibrated."));
+    } else {
+        qDebug() << "Failed to calibrate gyro!";
+        addInstructions(tr("Failed to calibrate gyro!"), WizardModel::Warn);
+    }
+
     QString str = QStringLiteral("INFO::Calibration results") + "\n";
     str += QStringLiteral("INFO::Baro cal {%1, %2, %3, %4}; initial variance: %5; Calibrated variance %6")
            .arg(m_results.baro[0]).arg(m_results.baro[1]).arg(m_results.baro[2]).arg(m_results.baro[3])
@@ -33,6 +33,7 @@
 #include <QTime>
 #include <QTemporaryDir>
 #include <QTextStream>
+#include <QFutureWatcher>
 
 #include "uavobjectmanager.h"
 #include <uavobject.h>
@@ -208,7 +209,13 @@ public slots:
 
     void cleanup();
 
+private slots:
+    void calculationFinished();
+
 private:
+    static Results computeResults(QList<BaroSensor::DataFields> baroSamples, QList<GyroSensor::DataFields> gyroSamples);
+    QFutureWatcher<Results> m_calculation;
+
     float getTemperature();
     void updateTemperature(float temp);
 
@@ -199,6 +199,7 @@ ConfigInputWidget::ConfigInputWidget(QWidget *parent) :
     addWidgetBinding("FlightModeSettings", "ArmedTimeout", ui->armTimeout, 0, 1000);
     connect(ManualControlCommand::GetInstance(getObjectManager()), SIGNAL(objectUpdated(UAVObject *)), this, SLOT(moveFMSlider()));
     connect(ManualControlSettings::GetInstance(getObjectManager()), SIGNAL(objectUpdated(UAVObject *)), this, SLOT(updatePositionSlider()));
+    connect(&manualSettingsUpdates, SIGNAL(sendUpdate(UAVObject *)), this, SLOT(sendManualSettings(UAVObject *)));
 
     addWidget(ui->configurationWizard);
     addWidget(ui->runCalibration);
@@ -790,6 +791,7 @@ void ConfigInputWidget::wizardTearDownStep(enum wizardSteps step)
         disconnect(manualCommandObj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(moveSticks()));
         disconnect(flightStatusObj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(moveSticks()));
         disconnect(accessoryDesiredObj0, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(moveSticks()));
+        manualSettingsUpdates.cancel(manualSettingsObj);
         manualSettingsObj->setData(manualSettingsData);
         setTxMovement(nothing);
         break;
@@ -1012,7 +1014,7 @@ void ConfigInputWidget::identifyLimits()
             }
         }
     }
-    manualSettingsObj->setData(manualSettingsData);
+    manualSettingsUpdates.requestUpdate(manualSettingsObj);
 }
 void ConfigInputWidget::setMoveFromCommand(int command)
 {
@@ -1584,8 +1586,17 @@ void ConfigInputWidget::updateCalibration()
         }
     }
 
+    manualSettingsUpdates.requestUpdate(manualSettingsObj);
+}
+
+/**
+ * Send the limits calibrated so far, called by manualSettingsUpdates
+ * once the previous update is done
+ */
+void ConfigInputWidget::sendManualSettings(UAVObject *obj)
+{
+    Q_UNUSED(obj);
     manualSettingsObj->setData(manualSettingsData);
-    manualSettingsObj->updated();
 }
 
 void ConfigInputWidget::simpleCalibration(bool enable)
@@ -1631,8 +1642,9 @@ void ConfigInputWidget::simpleCalibration(bool enable)
 
         connect(manualCommandObj, SIGNAL(objectUnpacked(UAVObject *)), this, SLOT(updateCalibration()));
     } else {
+        // manualSettingsData holds the calibration, the update still pending (if any) is sent below
+        manualSettingsUpdates.cancel(manualSettingsObj);
         manualCommandData  = manualCommandObj->getData();
-        manualSettingsData = manualSettingsObj->getData();
 
         restoreMdataSingle(manualCommandObj, &manualControlMdata);
 
@@ -30,6 +30,7 @@
 #include "ui_input.h"
 #include "ui_input_wizard.h"
 #include "../uavobjectwidgetutils/configtaskwidget.h"
+#include "../uavobjectwidgetutils/updatecoalescer.h"
 #include "extensionsystem/pluginmanager.h"
 #include "uavobjectmanager.h"
 #include "uavobject.h"
@@ -127,6 +128,8 @@ private:
     ManualControlSettings *manualSettingsObj;
     ManualControlSettings::DataFields manualSettingsData;
     ManualControlSettings::DataFields previousManualSettingsData;
+    // Sends manualSettingsData while the limits are being calibrated
+    UpdateCoalescer manualSettingsUpdates;
 
     ActuatorSettings *actuatorSettingsObj;
     ActuatorSettings::DataFields actuatorSettingsData;
@@ -202,6 +205,7 @@ private slots:
     void adjustSpecialNeutrals();
     void checkThrottleRange();
     void updateCalibration();
+    void sendManualSettings(UAVObject *obj);
     void resetChannelSettings();
     void resetActuatorSettings();
 
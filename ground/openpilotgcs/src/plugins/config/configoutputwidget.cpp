@@ -64,6 +64,7 @@ ConfigOutputWidget::ConfigOutputWidget(QWidget *parent) : ConfigTaskWidget(paren
     connect(importexportplugin, SIGNAL(importAboutToBegin()), this, SLOT(stopTests()));
 
     connect(m_ui->channelOutTest, SIGNAL(clicked(bool)), this, SLOT(runChannelTests(bool)));
+    connect(&m_channelTestUpdates, SIGNAL(sendUpdate(UAVObject *)), this, SLOT(sendChannelTestUpdate(UAVObject *)));
 
     // Configure the task widget
     // Connect the help button
@@ -205,9 +206,11 @@ void ConfigOutputWidget::runChannelTests(bool state)
         UAVObject::SetFlightAccess(mdata, UAVObject::ACCESS_READONLY);
         UAVObject::SetFlightTelemetryUpdateMode(mdata, UAVObject::UPDATEMODE_ONCHANGE);
         UAVObject::SetGcsTelemetryAcked(mdata, false);
-        UAVObject::SetGcsTelemetryUpdateMode(mdata, UAVObject::UPDATEMODE_ONCHANGE);
+        // The channel values are sent by m_channelTestUpdates, not on every change
+        UAVObject::SetGcsTelemetryUpdateMode(mdata, UAVObject::UPDATEMODE_MANUAL);
         mdata.gcsTelemetryUpdatePeriod = 100;
     } else {
+        m_channelTestUpdates.cancel(obj);
         mdata = m_accInitialData; // Restore metadata
     }
     obj->setMetadata(mdata);
@@ -277,6 +280,17 @@ void ConfigOutputWidget::sendChannelTest(int index, int value)
     ActuatorCommand::DataFields actuatorCommandFields = actuatorCommand->getData();
     actuatorCommandFields.Channel[index] = value;
     actuatorCommand->setData(actuatorCommandFields);
+    m_channelTestUpdates.requestUpdate(actuatorCommand);
+}
+
+/**
+   Sends the ActuatorCommand, with the latest channel values, while testing
+ */
+void ConfigOutputWidget::sendChannelTestUpdate(UAVObject *obj)
+{
+    if (m_ui->channelOutTest->isChecked()) {
+        obj->updated();
+    }
 }
 
 void ConfigOutputWidget::setColor(QWidget *widget, const QColor color)
@@ -29,6 +29,7 @@
 
 #include "ui_output.h"
 #include "../uavobjectwidgetutils/configtaskwidget.h"
+#include "../uavobjectwidgetutils/updatecoalescer.h"
 #include "extensionsystem/pluginmanager.h"
 #include "uavobjectmanager.h"
 #include "uavobject.h"
@@ -91,6 +92,7 @@ private:
     int m_mccDataRate;
     UAVObject::Metadata m_accInitialData;
     QList<OutputBankControls> m_banks;
+    UpdateCoalescer m_channelTestUpdates;
 
     OutputChannelForm *getOutputChannelForm(const int index) const;
     void updateChannelInSlider(QSlider *slider, QLabel *min, QLabel *max, QCheckBox *rev, int value);
@@ -105,6 +107,7 @@ private slots:
     void updateObjectsFromWidgets();
     void runChannelTests(bool state);
     void sendChannelTest(int index, int value);
+    void sendChannelTestUpdate(UAVObject *obj);
     void openHelp();
     void onBankTypeChange();
 };
@@ -48,6 +48,9 @@ GeneralSettings::GeneralSettings() :
     m_autoConnect(true),
     m_autoSelect(true),
     m_useUDPMirror(false),
+    m_useTelemetryThread(false),
+    m_telemetryRelayPort(0),
+    m_telemetryRelayRate(0),
     m_useExpertMode(false),
     m_dialog(0)
 {}
@@ -124,6 +127,10 @@ QWidget *GeneralSettings::createPage(QWidget *parent)
     m_page->checkAutoConnect->setChecked(m_autoConnect);
     m_page->checkAutoSelect->setChecked(m_autoSelect);
     m_page->cbUseUDPMirror->setChecked(m_useUDPMirror);
+    m_page->cbUseTelemetryThread->setChecked(m_useTelemetryThread);
+    m_page->sbTelemetryRelayPort->setValue(m_telemetryRelayPort);
+    m_page->sbTelemetryRelayRate->setValue(m_telemetryRelayRate);
+    m_page->leTelemetryCaptureFile->setText(m_telemetryCaptureFile);
     m_page->cbExpertMode->setChecked(m_useExpertMode);
     m_page->colorButton->setColor(StyleHelper::baseColor());
 
@@ -142,6 +149,10 @@ void GeneralSettings::apply()
 
     m_saveSettingsOnExit = m_page->checkBoxSaveOnExit->isChecked();
     m_useUDPMirror  = m_page->cbUseUDPMirror->isChecked();
+    m_useTelemetryThread = m_page->cbUseTelemetryThread->isChecked();
+    m_telemetryRelayPort = m_page->sbTelemetryRelayPort->value();
+    m_telemetryRelayRate = m_page->sbTelemetryRelayRate->value();
+    m_telemetryCaptureFile = m_page->leTelemetryCaptureFile->text().trimmed();
     m_useExpertMode = m_page->cbExpertMode->isChecked();
     m_autoConnect   = m_page->checkAutoConnect->isChecked();
     m_autoSelect    = m_page->checkAutoSelect->isChecked();
@@ -160,6 +171,10 @@ void GeneralSettings::readSettings(QSettings *qs)
     m_autoConnect   = qs->value(QLatin1String("AutoConnect"), m_autoConnect).toBool();
     m_autoSelect    = qs->value(QLatin1String("AutoSelect"), m_autoSelect).toBool();
     m_useUDPMirror  = qs->value(QLatin1String("UDPMirror"), m_useUDPMirror).toBool();
+    m_useTelemetryThread = qs->value(QLatin1String("TelemetryThread"), m_useTelemetryThread).toBool();
+    m_telemetryRelayPort = qs->value(QLatin1String("TelemetryRelayPort"), m_telemetryRelayPort).toUInt();
+    m_telemetryRelayRate = qs->value(QLatin1String("TelemetryRelayRate"), m_telemetryRelayRate).toUInt();
+    m_telemetryCaptureFile = qs->value(QLatin1String("TelemetryCaptureFile"), m_telemetryCaptureFile).toString();
     m_useExpertMode = qs->value(QLatin1String("ExpertMode"), m_useExpertMode).toBool();
     qs->endGroup();
 }
@@ -178,6 +193,10 @@ void GeneralSettings::saveSettings(QSettings *qs)
     qs->setValue(QLatin1String("AutoConnect"), m_autoConnect);
     qs->setValue(QLatin1String("AutoSelect"), m_autoSelect);
     qs->setValue(QLatin1String("UDPMirror"), m_useUDPMirror);
+    qs->setValue(QLatin1String("TelemetryThread"), m_useTelemetryThread);
+    qs->setValue(QLatin1String("TelemetryRelayPort"), m_telemetryRelayPort);
+    qs->setValue(QLatin1String("TelemetryRelayRate"), m_telemetryRelayRate);
+    qs->setValue(QLatin1String("TelemetryCaptureFile"), m_telemetryCaptureFile);
     qs->setValue(QLatin1String("ExpertMode"), m_useExpertMode);
     qs->endGroup();
 }
@@ -249,6 +268,26 @@ bool GeneralSettings::useUDPMirror() const
     return m_useUDPMirror;
 }
 
+bool GeneralSettings::useTelemetryThread() const
+{
+    return m_useTelemetryThread;
+}
+
+quint16 GeneralSettings::telemetryRelayPort() const
+{
+    return m_telemetryRelayPort;
+}
+
+quint32 GeneralSettings::telemetryRelayRate() const
+{
+    return m_telemetryRelayRate;
+}
+
+QString GeneralSettings::telemetryCaptureFile() const
+{
+    return m_telemetryCaptureFile;
+}
+
 bool GeneralSettings::useExpertMode() const
 {
     return m_useExpertMode;
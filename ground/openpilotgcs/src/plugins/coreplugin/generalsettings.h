@@ -57,6 +57,10 @@ public:
     bool autoConnect() const;
     bool autoSelect() const;
     bool useUDPMirror() const;
+    bool useTelemetryThread() const;
+    quint16 telemetryRelayPort() const;
+    quint32 telemetryRelayRate() const;
+    QString telemetryCaptureFile() const;
     void readSettings(QSettings *qs);
     void saveSettings(QSettings *qs);
     bool useExpertMode() const;
@@ -78,6 +82,10 @@ private:
     bool m_autoConnect;
     bool m_autoSelect;
     bool m_useUDPMirror;
+    bool m_useTelemetryThread;
+    quint16 m_telemetryRelayPort;
+    quint32 m_telemetryRelayRate;
+    QString m_telemetryCaptureFile;
     bool m_useExpertMode;
     QPointer<QWidget> m_dialog;
     QList<QTextCodec *> m_codecs;
@@ -81,6 +81,10 @@ public:
     virtual void saveState(QSettings * /*qSettings*/) {}
     virtual void restoreState(QByteArray) {}
     virtual void restoreState(QSettings * /*qSettings*/) {}
+    // The gadget is hidden with its workspace, or kept for reuse: it should
+    // stop its timers and object updates until it is resumed
+    virtual void suspend() {}
+    virtual void resume() {}
 public slots:
     virtual void configurationChanged(IUAVGadgetConfiguration *) {}
     virtual void configurationAdded(IUAVGadgetConfiguration *) {}
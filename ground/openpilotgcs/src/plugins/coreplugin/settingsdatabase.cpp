@@ -28,10 +28,13 @@
 
 #include "settingsdatabase.h"
 
+#include <QtCore/QBasicTimer>
 #include <QtCore/QDir>
 #include <QtCore/QMap>
+#include <QtCore/QSet>
 #include <QtCore/QString>
 #include <QtCore/QStringList>
+#include <QtCore/QTimerEvent>
 #include <QtCore/QVariant>
 
 #include <QtSql/QSqlDatabase>
@@ -44,9 +47,11 @@
     \brief An alternative to the application-wide QSettings that is more
     suitable for storing large amounts of data.
 
-    The settings database is SQLite based, and lazily retrieves data when it
-    is asked for. It also does incremental updates of the database rather than
-    rewriting the whole file each time one of the settings change.
+    The settings database is SQLite based. All the settings are read at once
+    when it is opened and are then served from memory. Changes are written
+    behind: they are collected and written out in a single transaction a
+    little later, on sync() or when the database is closed. Only the changed
+    settings are written rather than the whole file.
 
     The SettingsDatabase API mimics that of QSettings.
  */
@@ -56,6 +61,9 @@ using namespace Core::Internal;
 
 enum { debug_settings = 0 };
 
+// Changes are written out this long after the first one that is not written yet
+enum { write_delay_ms = 2000 };
+
 namespace Core {
 namespace Internal {
 typedef QMap<QString, QVariant> SettingsMap;
@@ -81,7 +89,10 @@ public:
     SettingsMap m_settings;
 
     QStringList m_groups;
-    QStringList m_dirtyKeys;
+    // Changes not written out yet, the removals are written first
+    QSet<QString> m_dirtyKeys;
+    QStringList m_removedKeys;
+    QBasicTimer m_writeTimer;
 
     QSqlDatabase m_db;
 };
@@ -126,10 +137,11 @@ SettingsDatabase::SettingsDatabase(const QString &path,
                                  << query.lastError().driverText() << ")";
         }
 
-        // Retrieve all available keys (values are retrieved lazily)
-        if (query.exec(QLatin1String("SELECT key FROM settings"))) {
+        // Retrieve all the settings at once, one by one queries add up at startup
+        query.setForwardOnly(true);
+        if (query.exec(QLatin1String("SELECT key, value FROM settings"))) {
             while (query.next()) {
-                d->m_settings.insert(query.value(0).toString(), QVariant());
+                d->m_settings.insert(query.value(0).toString(), query.value(1));
             }
         }
     }
@@ -154,12 +166,11 @@ void SettingsDatabase::setValue(const QString &key, const QVariant &value)
         return;
     }
 
-    // Instant apply (TODO: Delay writing out settings)
-    QSqlQuery query(d->m_db);
-    query.prepare(QLatin1String("INSERT INTO settings VALUES (?, ?)"));
-    query.addBindValue(effectiveKey);
-    query.addBindValue(value);
-    query.exec();
+    // Written out later, along with the other changes
+    d->m_dirtyKeys.insert(effectiveKey);
+    if (!d->m_writeTimer.isActive()) {
+        d->m_writeTimer.start(write_delay_ms, this);
+    }
 
     if (debug_settings) {
         qDebug() << "Stored:" << effectiveKey << "=" << value;
@@ -171,26 +182,11 @@ QVariant SettingsDatabase::value(const QString &key, const QVariant &defaultValu
     const QString effectiveKey    = d->effectiveKey(key);
     QVariant value = defaultValue;
 
+    // Every setting of the database was read when it was opened
     SettingsMap::const_iterator i = d->m_settings.constFind(effectiveKey);
 
     if (i != d->m_settings.constEnd() && i.value().isValid()) {
         value = i.value();
-    } else if (d->m_db.isOpen()) {
-        // Try to read the value from the database
-        QSqlQuery query(d->m_db);
-        query.prepare(QLatin1String("SELECT value FROM settings WHERE key = ?"));
-        query.addBindValue(effectiveKey);
-        query.exec();
-        if (query.next()) {
-            value = query.value(0);
-
-            if (debug_settings) {
-                qDebug() << "Retrieved:" << effectiveKey << "=" << value;
-            }
-        }
-
-        // Cache the result
-        d->m_settings.insert(effectiveKey, value);
     }
 
     return value;
@@ -205,13 +201,14 @@ void SettingsDatabase::remove(const QString &key)
 {
     const QString effectiveKey = d->effectiveKey(key);
 
-    // Remove keys from the cache
+    // Remove keys from the cache, and their changes not written out yet
     foreach(const QString &k, d->m_settings.keys()) {
         // Either it's an exact match, or it matches up to a /
         if (k.startsWith(effectiveKey)
             && (k.length() == effectiveKey.length()
                 || k.at(effectiveKey.length()) == QLatin1Char('/'))) {
             d->m_settings.remove(k);
+            d->m_dirtyKeys.remove(k);
         }
     }
 
@@ -219,12 +216,11 @@ void SettingsDatabase::remove(const QString &key)
         return;
     }
 
-    // Delete keys from the database
-    QSqlQuery query(d->m_db);
-    query.prepare(QLatin1String("DELETE FROM settings WHERE key = ? OR key LIKE ?"));
-    query.addBindValue(effectiveKey);
-    query.addBindValue(QString(effectiveKey + QLatin1String("/%")));
-    query.exec();
+    // Deleted from the database later, before the keys set meanwhile are written
+    d->m_removedKeys.append(effectiveKey);
+    if (!d->m_writeTimer.isActive()) {
+        d->m_writeTimer.start(write_delay_ms, this);
+    }
 }
 
 void SettingsDatabase::beginGroup(const QString &prefix)
@@ -259,7 +255,52 @@ QStringList SettingsDatabase::childKeys() const
     return childs;
 }
 
+/**
+ * Writes out the changes made since the last time, in one transaction
+ */
 void SettingsDatabase::sync()
 {
-    // TODO: Delay writing of dirty keys and save them here
+    d->m_writeTimer.stop();
+
+    if (!d->m_db.isOpen() || (d->m_dirtyKeys.isEmpty() && d->m_removedKeys.isEmpty())) {
+        return;
+    }
+
+    d->m_db.transaction();
+
+    QSqlQuery query(d->m_db);
+    if (!d->m_removedKeys.isEmpty()) {
+        query.prepare(QLatin1String("DELETE FROM settings WHERE key = ? OR key LIKE ?"));
+        foreach(const QString &key, d->m_removedKeys) {
+            query.addBindValue(key);
+            query.addBindValue(QString(key + QLatin1String("/%")));
+            query.exec();
+        }
+    }
+
+    if (!d->m_dirtyKeys.isEmpty()) {
+        query.prepare(QLatin1String("INSERT INTO settings VALUES (?, ?)"));
+        foreach(const QString &key, d->m_dirtyKeys) {
+            query.addBindValue(key);
+            query.addBindValue(d->m_settings.value(key));
+            query.exec();
+        }
+    }
+
+    if (!d->m_db.commit()) {
+        qWarning().nospace() << "Warning: Failed to write the settings database! ("
+                             << d->m_db.lastError().driverText() << ")";
+    }
+
+    d->m_removedKeys.clear();
+    d->m_dirtyKeys.clear();
+}
+
+void SettingsDatabase::timerEvent(QTimerEvent *event)
+{
+    if (event->timerId() == d->m_writeTimer.timerId()) {
+        sync();
+    } else {
+        QObject::timerEvent(event);
+    }
 }
@@ -58,6 +58,9 @@ public:
 
     void sync();
 
+protected:
+    void timerEvent(QTimerEvent *event);
+
 private:
     Internal::SettingsDatabasePrivate *d;
 };
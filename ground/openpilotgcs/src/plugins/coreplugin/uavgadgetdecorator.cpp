@@ -38,7 +38,8 @@ UAVGadgetDecorator::UAVGadgetDecorator(IUAVGadget *gadget, QList<IUAVGadgetConfi
     m_gadget(gadget),
     m_toolbar(new QComboBox),
     m_activeConfiguration(0),
-    m_configurations(configurations)
+    m_configurations(configurations),
+    m_suspended(false)
 {
     m_gadget->setParent(this);
     m_toolbar->setMinimumContentsLength(15);
@@ -111,6 +112,22 @@ void UAVGadgetDecorator::configurationNameChanged(IUAVGadgetConfiguration *confi
     }
 }
 
+void UAVGadgetDecorator::suspend()
+{
+    if (!m_suspended) {
+        m_suspended = true;
+        m_gadget->suspend();
+    }
+}
+
+void UAVGadgetDecorator::resume()
+{
+    if (m_suspended) {
+        m_suspended = false;
+        m_gadget->resume();
+    }
+}
+
 void UAVGadgetDecorator::updateToolbar()
 {
     m_toolbar->setEnabled(m_toolbar->count() > 1);
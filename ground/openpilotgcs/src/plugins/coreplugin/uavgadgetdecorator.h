@@ -53,6 +53,8 @@ public:
     void loadConfiguration(IUAVGadgetConfiguration *config);
     void saveState(QSettings *qSettings);
     void restoreState(QSettings *qSettings);
+    void suspend();
+    void resume();
 public slots:
     void configurationChanged(IUAVGadgetConfiguration *config);
     void configurationAdded(IUAVGadgetConfiguration *config);
@@ -66,6 +68,7 @@ private:
     QComboBox *m_toolbar;
     IUAVGadgetConfiguration *m_activeConfiguration;
     QList<IUAVGadgetConfiguration *> *m_configurations;
+    bool m_suspended;
 };
 } // namespace Core
 
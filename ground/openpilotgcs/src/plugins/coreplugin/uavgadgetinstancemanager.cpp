@@ -46,6 +46,9 @@ using namespace Core;
 
 static const UAVConfigVersion m_versionUAVGadgetConfigurations = UAVConfigVersion("1.2.0");
 
+// Removed gadgets kept for reuse, per class
+static const int m_maxCachedGadgets = 2;
+
 UAVGadgetInstanceManager::UAVGadgetInstanceManager(QObject *parent) :
     QObject(parent)
 {
@@ -73,6 +76,7 @@ UAVGadgetInstanceManager::~UAVGadgetInstanceManager()
 
 void UAVGadgetInstanceManager::readSettings(QSettings *qs)
 {
+    dropCachedGadgets();
     while (!m_configurations.isEmpty()) {
         emit configurationToBeDeleted(m_configurations.takeLast());
     }
@@ -265,6 +269,23 @@ IUAVGadget *UAVGadgetInstanceManager::createGadget(QString classId, QWidget *par
     IUAVGadgetFactory *f = factory(classId);
 
     if (f) {
+        QList<IUAVGadget *> &cached = m_cachedGadgets[classId];
+        if (!cached.isEmpty()) {
+            // Reusing a removed gadget saves building its widget and subscribing it again
+            IUAVGadget *gadget = cached.takeLast();
+            gadget->setParent(parent);
+            if (loadDefaultConfiguration) {
+                foreach(IUAVGadgetConfiguration * config, m_configurations) {
+                    if (config->classId() == classId) {
+                        gadget->loadConfiguration(config);
+                        break;
+                    }
+                }
+            }
+            m_gadgetInstances.append(gadget);
+            return gadget;
+        }
+
         QList<IUAVGadgetConfiguration *> *configs = configurations(classId);
         IUAVGadget *g = f->createGadget(parent);
         UAVGadgetDecorator *gadget = new UAVGadgetDecorator(g, configs);
@@ -282,15 +303,46 @@ IUAVGadget *UAVGadgetInstanceManager::createGadget(QString classId, QWidget *par
     return 0;
 }
 
+/**
+ * Removes a gadget from its view. A few gadgets of each class are kept
+ * suspended instead of being deleted, the next ones created reuse them.
+ */
 void UAVGadgetInstanceManager::removeGadget(IUAVGadget *gadget)
 {
     if (m_gadgetInstances.contains(gadget)) {
         m_gadgetInstances.removeOne(gadget);
-        delete gadget;
+        QList<IUAVGadget *> &cached = m_cachedGadgets[gadget->classId()];
+        if (cached.size() < m_maxCachedGadgets) {
+            gadget->suspend();
+            gadget->setParent(0);
+            gadget->widget()->setParent(0);
+            cached.append(gadget);
+        } else {
+            delete gadget;
+        }
         gadget = 0;
     }
 }
 
+/**
+ * Deletes the cached gadgets which use config, all of them when config is 0.
+ * Their configuration is about to be deleted.
+ */
+void UAVGadgetInstanceManager::dropCachedGadgets(IUAVGadgetConfiguration *config)
+{
+    QMutableMapIterator<QString, QList<IUAVGadget *> > ite(m_cachedGadgets);
+    while (ite.hasNext()) {
+        QMutableListIterator<IUAVGadget *> gadgets(ite.next().value());
+        while (gadgets.hasNext()) {
+            IUAVGadget *gadget = gadgets.next();
+            if (!config || gadget->activeConfiguration() == config) {
+                gadgets.remove();
+                delete gadget;
+            }
+        }
+    }
+}
+
 /**
  * Removes all the gadgets. This is called by the core plugin when
  * shutting down: this ensures that all registered gadget factory destructors are
@@ -300,6 +352,7 @@ void UAVGadgetInstanceManager::removeGadget(IUAVGadget *gadget)
  */
 void UAVGadgetInstanceManager::removeAllGadgets()
 {
+    dropCachedGadgets();
     foreach(IUAVGadget * gadget, m_gadgetInstances) {
         m_gadgetInstances.removeOne(gadget);
         delete gadget;
@@ -396,6 +449,7 @@ void UAVGadgetInstanceManager::applyChanges(IUAVGadgetConfiguration *config)
         m_provisionalDeletes.removeAt(m_provisionalDeletes.indexOf(config));
         int i = m_configurations.indexOf(config);
         if (i >= 0) {
+            dropCachedGadgets(config);
             emit configurationToBeDeleted(config);
             int j = m_takenNames[config->classId()].indexOf(config->name());
             m_takenNames[config->classId()].removeAt(j);
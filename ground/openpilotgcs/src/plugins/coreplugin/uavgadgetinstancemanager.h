@@ -93,6 +93,8 @@ public slots:
 
 private:
     QList<IUAVGadget *> m_gadgetInstances;
+    // Removed gadgets kept suspended for reuse, per class
+    QMap<QString, QList<IUAVGadget *> > m_cachedGadgets;
     QList<IUAVGadgetFactory *> m_factories;
     QList<IUAVGadgetConfiguration *> m_configurations;
     QList<IOptionsPage *> m_optionsPages;
@@ -106,6 +108,7 @@ private:
     ExtensionSystem::PluginManager *m_pm;
 
     IUAVGadgetFactory *factory(QString classId) const;
+    void dropCachedGadgets(IUAVGadgetConfiguration *config = 0);
 
     void createOptionsPages();
 
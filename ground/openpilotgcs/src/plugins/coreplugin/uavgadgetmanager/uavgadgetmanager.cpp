@@ -137,6 +137,15 @@ QList<int> UAVGadgetManager::context() const
 
 void UAVGadgetManager::modeChanged(Core::IMode *mode)
 {
+    // Only the gadgets of the workspace shown keep running
+    foreach(IUAVGadget * gadget, m_splitterOrView->gadgets()) {
+        if (mode == this) {
+            gadget->resume();
+        } else {
+            gadget->suspend();
+        }
+    }
+
     if (mode != this) {
         return;
     }
@@ -202,6 +211,11 @@ IUAVGadget *UAVGadgetManager::currentGadget() const
     return m_currentGadget;
 }
 
+bool UAVGadgetManager::isSuspended() const
+{
+    return m_core->modeManager()->currentMode() != this;
+}
+
 void UAVGadgetManager::emptyView(Core::Internal::UAVGadgetView *view)
 {
     if (!view) {
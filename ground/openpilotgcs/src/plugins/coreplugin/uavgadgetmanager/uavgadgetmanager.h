@@ -94,6 +94,8 @@ public:
     void ensureUAVGadgetManagerVisible();
 
     IUAVGadget *currentGadget() const;
+    // The gadgets are suspended while the workspace is not shown
+    bool isSuspended() const;
 
     void saveState(QSettings *) const;
     bool restoreState(QSettings *qSettings);
@@ -204,6 +204,11 @@ void UAVGadgetView::setGadget(IUAVGadget *uavGadget)
     tl->addWidget(m_uavGadget->widget());
     m_uavGadget->widget()->setParent(this);
     m_uavGadget->widget()->show();
+    if (m_uavGadgetManager->isSuspended()) {
+        m_uavGadget->suspend();
+    } else {
+        m_uavGadget->resume();
+    }
     int index = indexOfClassId(m_uavGadget->classId());
     Q_ASSERT(index >= 0);
     m_uavGadgetList->setCurrentIndex(index);
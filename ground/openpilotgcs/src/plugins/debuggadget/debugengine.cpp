@@ -1,8 +1,18 @@
 #include "debugengine.h"
+#include <QMetaObject>
+#include <QTime>
+#include <stdio.h>
+#include <stdlib.h>
 
-debugengine::debugengine()
+debugengine::debugengine() : _dropped(0), _previousHandler(0)
 {
-    mut_lock = new QMutex(QMutex::Recursive);
+    _writer = new DebugLogWriter;
+    _writer->moveToThread(&_writerThread);
+    connect(&_writerThread, SIGNAL(finished()), _writer, SLOT(deleteLater()));
+    _writerThread.start(QThread::LowPriority);
+
+    _flushTimer.setInterval(FlushPeriodMs);
+    connect(&_flushTimer, SIGNAL(timeout()), this, SLOT(flush()));
 }
 
 debugengine *debugengine::getInstance()
@@ -14,31 +24,137 @@ debugengine *debugengine::getInstance()
 
 debugengine::~debugengine()
 {
-    delete mut_lock;
-    mut_lock = NULL;
+    stop();
+}
+
+void debugengine::start()
+{
+    if (_flushTimer.isActive()) {
+        return;
+    }
+    _flushTimer.start();
+    _previousHandler = qInstallMessageHandler(messageHandler);
+}
+
+void debugengine::stop()
+{
+    if (!_flushTimer.isActive()) {
+        return;
+    }
+    qInstallMessageHandler(_previousHandler);
+    _flushTimer.stop();
+    flush();
+    // Queued after the last write
+    QMetaObject::invokeMethod(_writer, "close", Qt::BlockingQueuedConnection);
+    _writerThread.quit();
+    _writerThread.wait();
+}
+
+void debugengine::messageHandler(QtMsgType type, const QMessageLogContext &context, const QString &msg)
+{
+    debugengine *engine = getInstance();
+    QString txt;
+
+    switch (type) {
+    case QtDebugMsg:
+        txt = QString("Debug: %1").arg(msg);
+        break;
+    case QtWarningMsg:
+        txt = QString("Warning: %1").arg(msg);
+        break;
+    case QtCriticalMsg:
+        txt = QString("Critical: %1").arg(msg);
+        break;
+    case QtFatalMsg:
+        txt = QString("Fatal: %1").arg(msg);
+        break;
+    }
+    engine->writeMessage(type, QTime::currentTime().toString("hh:mm:ss.zzz ") + txt);
+
+    // The previous handler aborts on fatal messages
+    if (engine->_previousHandler) {
+        engine->_previousHandler(type, context, msg);
+    } else {
+        fprintf(stderr, "%s\n", qPrintable(txt));
+        if (type == QtFatalMsg) {
+            abort();
+        }
+    }
 }
 
-void debugengine::setTextEdit(QTextBrowser *textEdit)
+void debugengine::writeMessage(QtMsgType type, const QString &message)
 {
-    QMutexLocker lock(mut_lock);
+    QMutexLocker lock(&mut_lock);
+
+    if (_pending.count() >= MaxPending) {
+        _pending.removeFirst();
+        ++_dropped;
+    }
+    DebugMessage msg;
+    msg.type = type;
+    msg.text = message;
+    _pending.append(msg);
+}
 
-    _textEdit = textEdit;
+void debugengine::setLogFile(const QString &fileName)
+{
+    _logFile = fileName;
+    if (fileName.isEmpty()) {
+        QMetaObject::invokeMethod(_writer, "close", Qt::QueuedConnection);
+    } else {
+        QMetaObject::invokeMethod(_writer, "open", Qt::QueuedConnection, Q_ARG(QString, fileName));
+    }
 }
 
-void debugengine::writeMessage(const QString &message)
+void debugengine::flush()
 {
-    QMutexLocker lock(mut_lock);
+    QList<DebugMessage> messages;
+    int dropped;
 
-    if (_textEdit) {
-        _textEdit->append(message);
+    mut_lock.lock();
+    messages.swap(_pending);
+    dropped  = _dropped;
+    _dropped = 0;
+    mut_lock.unlock();
+
+    if (messages.isEmpty()) {
+        return;
+    }
+    if (dropped) {
+        DebugMessage msg;
+        msg.type = QtWarningMsg;
+        msg.text = QString("Warning: %1 messages dropped").arg(dropped);
+        messages.prepend(msg);
     }
+    if (!_logFile.isEmpty()) {
+        QByteArray data;
+        foreach(const DebugMessage &msg, messages) {
+            data.append(msg.text.toUtf8());
+            data.append('\n');
+        }
+        QMetaObject::invokeMethod(_writer, "write", Qt::QueuedConnection, Q_ARG(QByteArray, data));
+    }
+    emit messagesReady(messages);
 }
 
-void debugengine::setColor(const QColor &c)
+void DebugLogWriter::open(const QString &fileName)
 {
-    QMutexLocker lock(mut_lock);
+    close();
+    file.setFileName(fileName);
+    file.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text);
+}
 
-    if (_textEdit) {
-        _textEdit->setTextColor(c);
+void DebugLogWriter::write(const QByteArray &data)
+{
+    if (file.isOpen()) {
+        file.write(data);
+        file.flush();
+    }
+}
+
+void DebugLogWriter::close()
+{
+    if (file.isOpen()) {
+        file.close();
     }
 }
@@ -1,21 +1,74 @@
 #ifndef DEBUGENGINE_H
 #define DEBUGENGINE_H
-#include <QTextBrowser>
-#include <QPointer>
+#include <QFile>
+#include <QList>
 #include <QMutex>
+#include <QObject>
+#include <QString>
+#include <QThread>
+#include <QTimer>
 
-class debugengine {
-// Add all missing constructor etc... to have singleton
+struct DebugMessage {
+    QtMsgType type;
+    QString   text;
+};
+
+// Appends the messages to the log file, in its own thread
+class DebugLogWriter : public QObject {
+    Q_OBJECT
+public slots:
+    void open(const QString &fileName);
+    void write(const QByteArray &data);
+    void close();
+private:
+    QFile file;
+};
+
+/**
+ * Collects the debug messages of all the threads and hands them out in
+ * batches, from the main thread, to the debug gadgets and to the log file.
+ * At most MaxPending messages wait for the next batch, older ones are dropped.
+ */
+class debugengine : public QObject {
+    Q_OBJECT
     debugengine();
     ~debugengine();
 public:
     static debugengine *getInstance();
-    void setTextEdit(QTextBrowser *textEdit);
-    void writeMessage(const QString &message);
-    void setColor(const QColor &c);
-    QMutex *mut_lock;
+    // Installs the Qt message handler feeding the engine, the previous one still gets the messages
+    void start();
+    // Restores the previous message handler and writes out the pending messages
+    void stop();
+    // Can be called from any thread
+    void writeMessage(QtMsgType type, const QString &message);
+    // Tees all the messages to a file, an empty name stops it
+    void setLogFile(const QString &fileName);
+    QString logFile() const
+    {
+        return _logFile;
+    }
+
+signals:
+    void messagesReady(const QList<DebugMessage> &messages);
+
+private slots:
+    void flush();
+
 private:
-    QPointer<QTextBrowser> _textEdit;
+    static void messageHandler(QtMsgType type, const QMessageLogContext &context, const QString &msg);
+
+    // Batches are handed out at this period
+    static const int FlushPeriodMs = 40;
+    static const int MaxPending    = 10000;
+
+    QMutex mut_lock;
+    QList<DebugMessage> _pending;
+    int _dropped;
+    QTimer _flushTimer;
+    QThread _writerThread;
+    DebugLogWriter *_writer;
+    QString _logFile;
+    QtMessageHandler _previousHandler;
 };
 
 #endif // DEBUGENGINE_H
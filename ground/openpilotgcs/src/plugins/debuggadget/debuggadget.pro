@@ -8,11 +8,13 @@ HEADERS += debugplugin.h \
 HEADERS += debuggadget.h
 HEADERS += debuggadgetwidget.h
 HEADERS += debuggadgetfactory.h
+HEADERS += debuglogmodel.h
 SOURCES += debugplugin.cpp \
     debugengine.cpp
 SOURCES += debuggadget.cpp
 SOURCES += debuggadgetfactory.cpp
 SOURCES += debuggadgetwidget.cpp
+SOURCES += debuglogmodel.cpp
 
 OTHER_FILES += DebugGadget.pluginspec
 
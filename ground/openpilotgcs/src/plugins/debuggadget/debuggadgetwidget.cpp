@@ -25,90 +25,43 @@
  * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
  */
 #include "debuggadgetwidget.h"
+#include "debuglogmodel.h"
 
-#include <QDebug>
-#include <QStringList>
-#include <QWidget>
-#include <QTextEdit>
-#include <QVBoxLayout>
-#include <QPushButton>
-#include "debugengine.h"
 #include <QFile>
 #include <QFileDialog>
 #include <QMessageBox>
 #include <QScrollBar>
-#include <QTime>
-
-QPointer<QTextBrowser> m_textedit;
-
-void DebugGadgetWidget::customMessageHandler(QtMsgType type, const QMessageLogContext &context, const QString &msg)
-{
-    Q_UNUSED(context);
-    QString txt;
-    QColor color = Qt::black;
-
-    switch (type) {
-    case QtDebugMsg:
-        txt   = QString("Debug: %1").arg(msg);
-        color = Qt::black;
-        break;
-    case QtWarningMsg:
-        txt   = QString("Warning: %1").arg(msg);
-        color = Qt::red;
-        break;
-    case QtCriticalMsg:
-        txt   = QString("Critical: %1").arg(msg);
-        color = Qt::red;
-        break;
-    case QtFatalMsg:
-        txt   = QString("Fatal: %1").arg(msg);
-        abort();
-    }
-
-    debugengine::getInstance()->setTextEdit(m_textedit);
-    debugengine::getInstance()->setColor(color);
-    debugengine::getInstance()->writeMessage(txt);
-}
 
 DebugGadgetWidget::DebugGadgetWidget(QWidget *parent) : QLabel(parent)
 {
     m_config = new Ui_Form();
     m_config->setupUi(this);
 
-    // m_textedit = m_config->plainTextEdit;
-    // MyplainTextEdit=m_config->plainTextEdit;
-    // debugengine *de = new debugengine();
-    // qInstallMessageHandler(customMessageHandler);
-    // connect(de, SIGNAL(dbgMsg(QString, QList<QVariant>)), this, SLOT(dbgMsg(QString, QList<QVariant>)));
-    // connect(de, SIGNAL(dbgMsgError(QString, QList<QVariant>)), this, SLOT(dbgMsgError(QString, QList<QVariant>)));
+    m_model  = new DebugLogModel(this);
+    m_config->logView->setModel(m_model);
+    m_config->teeButton->setChecked(!debugengine::getInstance()->logFile().isEmpty());
+
+    connect(debugengine::getInstance(), SIGNAL(messagesReady(QList<DebugMessage>)), this, SLOT(messagesReady(QList<DebugMessage>)));
     connect(m_config->pushButton, SIGNAL(clicked()), this, SLOT(saveLog()));
+    connect(m_config->teeButton, SIGNAL(toggled(bool)), this, SLOT(teeLog(bool)));
 }
 
 DebugGadgetWidget::~DebugGadgetWidget()
 {
-    // Do nothing
+    delete m_config;
 }
 
-void DebugGadgetWidget::dbgMsg(const QString &level, const QList<QVariant> &msgs)
+void DebugGadgetWidget::messagesReady(const QList<DebugMessage> &messages)
 {
-    m_config->plainTextEdit->setTextColor(Qt::red);
-
-    m_config->plainTextEdit->append(QString("%2[%0]%1").arg(level).arg(msgs[0].toString()).arg(QTime::currentTime().toString()));
+    QScrollBar *sb = m_config->logView->verticalScrollBar();
+    bool scroll    = sb->value() == sb->maximum();
 
-    QScrollBar *sb = m_config->plainTextEdit->verticalScrollBar();
-    sb->setValue(sb->maximum());
+    m_model->append(messages);
+    if (scroll) {
+        m_config->logView->scrollToBottom();
+    }
 }
 
-void DebugGadgetWidget::dbgMsgError(const QString &level, const QList<QVariant> &msgs)
-{
-    m_config->plainTextEdit->setTextColor(Qt::black);
-
-
-    m_config->plainTextEdit->append(QString("%2[%0]%1").arg(level).arg(msgs[0].toString()).arg(QTime::currentTime().toString()));
-
-    QScrollBar *sb = m_config->plainTextEdit->verticalScrollBar();
-    sb->setValue(sb->maximum());
-}
 void DebugGadgetWidget::saveLog()
 {
     QString fileName = QFileDialog::getSaveFileName(0, tr("Save log File As"), "");
@@ -118,8 +71,8 @@ void DebugGadgetWidget::saveLog()
     }
 
     QFile file(fileName);
-    if (file.open(QIODevice::WriteOnly) &&
-        (file.write(m_config->plainTextEdit->toHtml().toLatin1()) != -1)) {
+    if (file.open(QIODevice::WriteOnly | QIODevice::Text) &&
+        (file.write(m_model->toText().toUtf8()) != -1)) {
         file.close();
     } else {
         QMessageBox::critical(0,
@@ -129,3 +82,20 @@ void DebugGadgetWidget::saveLog()
         return;
     }
 }
+
+void DebugGadgetWidget::teeLog(bool enable)
+{
+    if (!enable) {
+        debugengine::getInstance()->setLogFile(QString());
+        return;
+    }
+    if (!debugengine::getInstance()->logFile().isEmpty()) {
+        return;
+    }
+    QString fileName = QFileDialog::getSaveFileName(0, tr("Log to File"), "");
+    if (fileName.isEmpty()) {
+        m_config->teeButton->setChecked(false);
+        return;
+    }
+    debugengine::getInstance()->setLogFile(fileName);
+}
@@ -31,19 +31,21 @@
 #include <QLabel>
 #include "ui_debug.h"
 #include "debugengine.h"
+class DebugLogModel;
+
 class DebugGadgetWidget : public QLabel {
     Q_OBJECT
 
 public:
     DebugGadgetWidget(QWidget *parent = 0);
     ~DebugGadgetWidget();
-    static void customMessageHandler(QtMsgType type, const QMessageLogContext &context, const QString &msg);
 private:
     Ui_Form *m_config;
+    DebugLogModel *m_model;
 private slots:
     void saveLog();
-    void dbgMsgError(const QString & level, const QList<QVariant> & msgs);
-    void dbgMsg(const QString & level, const QList<QVariant> & msgs);
+    void teeLog(bool enable);
+    void messagesReady(const QList<DebugMessage> &messages);
 };
 
 #endif /* DEBUGGADGETWIDGET_H_ */
@@ -0,0 +1,87 @@
+/**
+ ******************************************************************************
+ *
+ * @file       debuglogmodel.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup DebugGadgetPlugin Debug Gadget Plugin
+ * @{
+ * @brief The debug messages log
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "debuglogmodel.h"
+#include <QBrush>
+
+DebugLogModel::DebugLogModel(QObject *parent) : QAbstractListModel(parent), m_ring(Capacity), m_first(0), m_count(0)
+{}
+
+int DebugLogModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_count;
+}
+
+QVariant DebugLogModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_count) {
+        return QVariant();
+    }
+    const DebugMessage &msg = at(index.row());
+    switch (role) {
+    case Qt::DisplayRole:
+        return msg.text;
+    case Qt::ForegroundRole:
+        return QBrush(msg.type == QtDebugMsg ? Qt::black : Qt::red);
+    default:
+        return QVariant();
+    }
+}
+
+void DebugLogModel::append(const QList<DebugMessage> &messages)
+{
+    // Only the last Capacity messages of a large batch are kept
+    int skip  = qMax(0, messages.count() - Capacity);
+    int count = messages.count() - skip;
+
+    if (count == 0) {
+        return;
+    }
+    int removed = qMax(0, m_count + count - Capacity);
+    if (removed > 0) {
+        beginRemoveRows(QModelIndex(), 0, removed - 1);
+        m_first  = (m_first + removed) % Capacity;
+        m_count -= removed;
+        endRemoveRows();
+    }
+    beginInsertRows(QModelIndex(), m_count, m_count + count - 1);
+    for (int i = skip; i < messages.count(); i++) {
+        m_ring[(m_first + m_count++) % Capacity] = messages.at(i);
+    }
+    endInsertRows();
+}
+
+QString DebugLogModel::toText() const
+{
+    QString text;
+
+    for (int row = 0; row < m_count; row++) {
+        text.append(at(row).text);
+        text.append('\n');
+    }
+    return text;
+}
@@ -0,0 +1,65 @@
+/**
+ ******************************************************************************
+ *
+ * @file       debuglogmodel.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup DebugGadgetPlugin Debug Gadget Plugin
+ * @{
+ * @brief The debug messages log
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef DEBUGLOGMODEL_H
+#define DEBUGLOGMODEL_H
+
+#include "debugengine.h"
+#include <QAbstractListModel>
+#include <QVector>
+
+/**
+ * The last Capacity debug messages, in a ring buffer: when it is full the
+ * oldest rows are removed as new ones are appended.
+ */
+class DebugLogModel : public QAbstractListModel {
+    Q_OBJECT
+
+public:
+    static const int Capacity = 20000;
+
+    DebugLogModel(QObject *parent = 0);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+
+    void append(const QList<DebugMessage> &messages);
+    // The messages, oldest first, one per line
+    QString toText() const;
+
+private:
+    const DebugMessage &at(int row) const
+    {
+        return m_ring.at((m_first + row) % Capacity);
+    }
+
+    QVector<DebugMessage> m_ring;
+    int m_first;
+    int m_count;
+};
+
+#endif // DEBUGLOGMODEL_H
@@ -88,13 +88,13 @@ void DialGadgetWidget::connectNeedles(QString object1, QString nfield1,
                                       QString object3, QString nfield3)
 {
     if (obj1 != NULL) {
-        disconnect(obj1, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(updateNeedle1(UAVObject *)));
+        disconnect(obj1, SIGNAL(objectUpdatedCoalesced(UAVObject *)), this, SLOT(updateNeedle1(UAVObject *)));
     }
     if (obj2 != NULL) {
-        disconnect(obj2, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(updateNeedle2(UAVObject *)));
+        disconnect(obj2, SIGNAL(objectUpdatedCoalesced(UAVObject *)), this, SLOT(updateNeedle2(UAVObject *)));
     }
     if (obj3 != NULL) {
-        disconnect(obj3, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(updateNeedle3(UAVObject *)));
+        disconnect(obj3, SIGNAL(objectUpdatedCoalesced(UAVObject *)), this, SLOT(updateNeedle3(UAVObject *)));
     }
 
     ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
@@ -105,7 +105,7 @@ void DialGadgetWidget::connectNeedles(QString object1, QString nfield1,
         obj1 = dynamic_cast<UAVDataObject *>(objManager->getObject(object1));
         if (obj1 != NULL) {
             // qDebug() << "Connected Object 1 (" << object1 << ").";
-            connect(obj1, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(updateNeedle1(UAVObject *)));
+            connect(obj1, SIGNAL(objectUpdatedCoalesced(UAVObject *)), this, SLOT(updateNeedle1(UAVObject *)));
             if (nfield1.contains("-")) {
                 QStringList fieldSubfield = nfield1.split("-", QString::SkipEmptyParts);
                 field1        = fieldSubfield.at(0);
@@ -125,7 +125,7 @@ void DialGadgetWidget::connectNeedles(QString object1, QString nfield1,
         obj2 = dynamic_cast<UAVDataObject *>(objManager->getObject(object2));
         if (obj2 != NULL) {
             // qDebug() << "Connected Object 2 (" << object2 << ").";
-            connect(obj2, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(updateNeedle2(UAVObject *)));
+            connect(obj2, SIGNAL(objectUpdatedCoalesced(UAVObject *)), this, SLOT(updateNeedle2(UAVObject *)));
             if (nfield2.contains("-")) {
                 QStringList fieldSubfield = nfield2.split("-", QString::SkipEmptyParts);
                 field2        = fieldSubfield.at(0);
@@ -145,7 +145,7 @@ void DialGadgetWidget::connectNeedles(QString object1, QString nfield1,
         obj3 = dynamic_cast<UAVDataObject *>(objManager->getObject(object3));
         if (obj3 != NULL) {
             // qDebug() << "Connected Object 3 (" << object3 << ").";
-            connect(obj3, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(updateNeedle3(UAVObject *)));
+            connect(obj3, SIGNAL(objectUpdatedCoalesced(UAVObject *)), this, SLOT(updateNeedle3(UAVObject *)));
             if (nfield3.contains("-")) {
                 QStringList fieldSubfield = nfield3.split("-", QString::SkipEmptyParts);
                 field3        = fieldSubfield.at(0);
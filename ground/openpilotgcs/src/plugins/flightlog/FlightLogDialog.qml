@@ -73,6 +73,7 @@ Rectangle {
                                     case 1 : text: qsTr("Text"); break;
                                     case 2 : text: qsTr("UAVO"); break;
                                     case 3 : text: qsTr("UAVO(P)"); break;
+                                    case 4 : text: qsTr("Trace"); break;
                                     default: text: qsTr("Unknown"); break;
                                     }
                                 }
@@ -141,6 +142,12 @@ Rectangle {
                             Rectangle {
                                 Layout.fillWidth: true
                             }
+                            Button {
+                                text: qsTr("Load messages...")
+                                enabled: !logManager.disableControls
+                                activeFocusOnPress: true
+                                onClicked: logManager.loadMessageTable()
+                            }
                             Button {
                                 text: qsTr("Download logs")
                                 enabled: !logManager.disableControls && logManager.boardConnected
@@ -155,6 +162,20 @@ Rectangle {
                             Rectangle {
                                 Layout.fillWidth: true
                             }
+                            Button {
+                                id: startTraceButton
+                                enabled: !logManager.disableControls && logManager.boardConnected
+                                text: qsTr("Start trace")
+                                activeFocusOnPress: true
+                                onClicked: logManager.startTrace()
+                            }
+                            Button {
+                                id: dumpTraceButton
+                                enabled: !logManager.disableControls && logManager.boardConnected
+                                text: qsTr("Dump trace")
+                                activeFocusOnPress: true
+                                onClicked: logManager.dumpTrace()
+                            }
                             Button {
                                 id: clearButton
                                 enabled: !logManager.disableControls && logManager.boardConnected
@@ -32,6 +32,9 @@
 #include <QFileDialog>
 #include <QXmlStreamReader>
 #include <QMessageBox>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
 #include <QDebug>
 
 #include "debuglogcontrol.h"
@@ -42,8 +45,8 @@
 #include <uavobjectutil/uavobjectutilmanager.h>
 
 FlightLogManager::FlightLogManager(QObject *parent) :
-    QObject(parent), m_disableControls(false),
-    m_disableExport(true), m_cancelDownload(false),
+    QObject(parent), m_bulkFlight(0), m_bulkEnd(-1), m_bulkLast(-1), m_bulkLoop(0),
+    m_disableControls(false), m_disableExport(true), m_cancelDownload(false),
     m_adjustExportedTimestamps(true)
 {
     ExtensionSystem::PluginManager *pluginManager = ExtensionSystem::PluginManager::instance();
@@ -173,6 +176,29 @@ void FlightLogManager::clearAllLogs()
     setDisableControls(false);
 }
 
+void FlightLogManager::startTrace()
+{
+    setDisableControls(true);
+    UAVObjectUpdaterHelper updateHelper;
+
+    m_flightLogControl->setOperation(DebugLogControl::OPERATION_STARTTRACE);
+    updateHelper.doObjectAndWait(m_flightLogControl, UAVTALK_TIMEOUT);
+    setDisableControls(false);
+}
+
+void FlightLogManager::dumpTrace()
+{
+    setDisableControls(true);
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    UAVObjectUpdaterHelper updateHelper;
+
+    // The trace is written to the log on flight side, download the logs afterwards to get it
+    m_flightLogControl->setOperation(DebugLogControl::OPERATION_DUMPTRACE);
+    updateHelper.doObjectAndWait(m_flightLogControl, UAVTALK_TIMEOUT);
+    QApplication::restoreOverrideCursor();
+    setDisableControls(false);
+}
+
 void FlightLogManager::clearLogList()
 {
     QList<ExtendedDebugLogEntry *> tmpList(m_logEntries);
@@ -200,64 +226,77 @@ void FlightLogManager::retrieveLogs(int flightToRetrieve)
     int startFlight = (flightToRetrieve == -1) ? 0 : flightToRetrieve;
     int endFlight   = (flightToRetrieve == -1) ? m_flightLogStatus->getFlight() : flightToRetrieve;
 
-    // Prepare to send request for event retrieval
-    m_flightLogControl->setOperation(DebugLogControl::OPERATION_RETRIEVE);
     for (int flight = startFlight; flight <= endFlight; flight++) {
+        m_bulkEntries.clear();
+        m_bulkEnd = -1;
+
+        // let the board stream the whole flight, then ask again for the entries lost on the way
+        int period = BULK_PERIOD_MS;
+        bulkRetrieve(flight, 0, 0, period);
+        for (int pass = 0; pass < BULK_PASSES && !m_cancelDownload; pass++) {
+            // nothing streamed at all, leave it to the entry by entry retrieval below
+            if (m_bulkEntries.isEmpty() && m_bulkEnd < 0) {
+                break;
+            }
+            int end = (m_bulkEnd >= 0) ? m_bulkEnd : (m_bulkEntries.isEmpty() ? 0 : m_bulkEntries.lastKey() + 1);
+            QList<QPair<int, int> > gaps;
+            int missing = 0;
+            for (int slot = 0; slot < end; slot++) {
+                if (!m_bulkEntries.contains(slot)) {
+                    if (!gaps.isEmpty() && gaps.last().first + gaps.last().second == slot) {
+                        gaps.last().second++;
+                    } else {
+                        gaps << QPair<int, int>(slot, 1);
+                    }
+                    missing++;
+                }
+            }
+            if (gaps.isEmpty() && m_bulkEnd >= 0) {
+                break;
+            }
+            // losing many entries means the link can not keep up, slow the board down
+            if (missing * 4 > end) {
+                period = qMin(period * 2, (int)BULK_MAX_PERIOD_MS);
+            }
+            for (int i = 0; i < gaps.count() && !m_cancelDownload; i++) {
+                bulkRetrieve(flight, gaps[i].first, gaps[i].second, period);
+            }
+            if (m_bulkEnd < 0 && !m_cancelDownload) {
+                bulkRetrieve(flight, end, 0, period);
+            }
+        }
+
+        // whatever the stream could not deliver is fetched one acked entry at a time
+        m_flightLogControl->setOperation(DebugLogControl::OPERATION_RETRIEVE);
         m_flightLogControl->setFlight(flight);
-        bool gotLast = false;
-        int slot     = 0;
-        while (!gotLast) {
+        for (int slot = 0; !m_cancelDownload && (m_bulkEnd < 0 || slot < m_bulkEnd); slot++) {
+            if (m_bulkEntries.contains(slot)) {
+                continue;
+            }
             // Send request for loading flight entry on flight side and wait for ack/nack
             m_flightLogControl->setEntry(slot);
 
             if (updateHelper.doObjectAndWait(m_flightLogControl, UAVTALK_TIMEOUT) == UAVObjectUpdaterHelper::SUCCESS &&
                 requestHelper.doObjectAndWait(m_flightLogEntry, UAVTALK_TIMEOUT) == UAVObjectUpdaterHelper::SUCCESS) {
                 if (m_flightLogEntry->getType() != DebugLogEntry::TYPE_EMPTY) {
-                    // Ok, we retrieved the entry, and it was the correct one. clone it and add it to the list
-                    ExtendedDebugLogEntry *logEntry = new ExtendedDebugLogEntry();
-
-                    logEntry->setData(m_flightLogEntry->getData(), m_objectManager);
-                    m_logEntries << logEntry;
-                    if (logEntry->getData().Type == DebugLogEntry::TYPE_MULTIPLEUAVOBJECTS) {
-                        const quint32 total_len  = sizeof(DebugLogEntry::DataFields);
-                        const quint32 data_len   = sizeof(((DebugLogEntry::DataFields *)0)->Data);
-                        const quint32 header_len = total_len - data_len;
-
-                        DebugLogEntry::DataFields fields;
-                        quint32 start = logEntry->getData().Size;
-
-                        // cycle until there is space for another object
-                        while (start + header_len + 1 < data_len) {
-                            memset(&fields, 0xFF, total_len);
-                            memcpy(&fields, &logEntry->getData().Data[start], header_len);
-                            // check wether a packed object is found
-                            // note that empty data blocks are set as 0xFF in flight side to minimize flash wearing
-                            // thus as soon as this read outside of used area, the test will fail as lenght would be 0xFFFF
-                            quint32 toread = header_len + fields.Size;
-                            if (!(toread + start > data_len)) {
-                                memcpy(&fields, &logEntry->getData().Data[start], toread);
-                                ExtendedDebugLogEntry *subEntry = new ExtendedDebugLogEntry();
-                                subEntry->setData(fields, m_objectManager);
-                                m_logEntries << subEntry;
-                            }
-                            start += toread;
-                        }
-                    }
-
-                    // Increment to get next entry from flight side
-                    slot++;
+                    m_bulkEntries.insert(slot, m_flightLogEntry->getData());
                 } else {
                     // We are done, not more entries on this flight
-                    gotLast = true;
+                    m_bulkEnd = slot;
                 }
             } else {
                 // We failed for some reason
                 break;
             }
-            if (m_cancelDownload) {
-                break;
-            }
         }
+
+        // compact entries are delta coded against the previous ones of the same flight
+        ExtendedDebugLogEntry::CompactState compactState;
+        foreach(const DebugLogEntry::DataFields &fields, m_bulkEntries) {
+            addRetrievedEntry(fields, compactState);
+        }
+        m_bulkEntries.clear();
+
         if (m_cancelDownload) {
             break;
         }
@@ -275,6 +314,118 @@ void FlightLogManager::retrieveLogs(int flightToRetrieve)
     setDisableControls(false);
 }
 
+void FlightLogManager::addRetrievedEntry(const DebugLogEntry::DataFields &data, ExtendedDebugLogEntry::CompactState &compactState)
+{
+    if (data.Type == DebugLogEntry::TYPE_COMPACTUAVOBJECTS) {
+        foreach(const DebugLogEntry::DataFields &sample, ExtendedDebugLogEntry::decodeCompact(data, compactState)) {
+            // skip objects this GCS does not know about
+            if (m_objectManager->getObject(sample.ObjectID, sample.InstanceID)) {
+                ExtendedDebugLogEntry *subEntry = new ExtendedDebugLogEntry();
+                subEntry->setData(sample, m_objectManager);
+                m_logEntries << subEntry;
+            }
+        }
+        return;
+    }
+    if (data.Type == DebugLogEntry::TYPE_MESSAGES) {
+        foreach(const DebugLogEntry::DataFields &message, ExtendedDebugLogEntry::decodeMessages(data, m_messageFormats)) {
+            ExtendedDebugLogEntry *subEntry = new ExtendedDebugLogEntry();
+            subEntry->setData(message, m_objectManager);
+            m_logEntries << subEntry;
+        }
+        return;
+    }
+
+    // Ok, we retrieved the entry, and it was the correct one. clone it and add it to the list
+    ExtendedDebugLogEntry *logEntry = new ExtendedDebugLogEntry();
+
+    logEntry->setData(data, m_objectManager);
+    m_logEntries << logEntry;
+    if (logEntry->getData().Type == DebugLogEntry::TYPE_MULTIPLEUAVOBJECTS) {
+        const quint32 total_len  = sizeof(DebugLogEntry::DataFields);
+        const quint32 data_len   = sizeof(((DebugLogEntry::DataFields *)0)->Data);
+        const quint32 header_len = total_len - data_len;
+
+        DebugLogEntry::DataFields fields;
+        quint32 start = logEntry->getData().Size;
+
+        // cycle until there is space for another object
+        while (start + header_len + 1 < data_len) {
+            memset(&fields, 0xFF, total_len);
+            memcpy(&fields, &logEntry->getData().Data[start], header_len);
+            // check wether a packed object is found
+            // note that empty data blocks are set as 0xFF in flight side to minimize flash wearing
+            // thus as soon as this read outside of used area, the test will fail as lenght would be 0xFFFF
+            quint32 toread = header_len + fields.Size;
+            if (!(toread + start > data_len)) {
+                memcpy(&fields, &logEntry->getData().Data[start], toread);
+                ExtendedDebugLogEntry *subEntry = new ExtendedDebugLogEntry();
+                subEntry->setData(fields, m_objectManager);
+                m_logEntries << subEntry;
+            }
+            start += toread;
+        }
+    }
+}
+
+void FlightLogManager::bulkRetrieve(int flight, int start, int count, int period)
+{
+    UAVObjectUpdaterHelper updateHelper;
+    QEventLoop loop;
+
+    m_bulkFlight = flight;
+    m_bulkLast   = count ? start + count - 1 : -1;
+    m_bulkLoop   = &loop;
+    connect(m_flightLogEntry, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(bulkEntryReceived(UAVObject *)));
+    connect(&m_bulkTimer, SIGNAL(timeout()), &loop, SLOT(quit()));
+
+    m_flightLogControl->setOperation(DebugLogControl::OPERATION_BULKRETRIEVE);
+    m_flightLogControl->setFlight(flight);
+    m_flightLogControl->setEntry(start);
+    m_flightLogControl->setCount(count);
+    m_flightLogControl->setPeriod(period);
+    if (updateHelper.doObjectAndWait(m_flightLogControl, UAVTALK_TIMEOUT) == UAVObjectUpdaterHelper::SUCCESS) {
+        // the stream is over once the last entry arrived or the board went quiet
+        m_bulkTimer.setSingleShot(true);
+        m_bulkTimer.start(BULK_IDLE_TIMEOUT + period);
+        loop.exec();
+        m_bulkTimer.stop();
+    }
+
+    disconnect(&m_bulkTimer, SIGNAL(timeout()), &loop, SLOT(quit()));
+    disconnect(m_flightLogEntry, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(bulkEntryReceived(UAVObject *)));
+    m_bulkLoop = 0;
+
+    if (m_cancelDownload) {
+        // stop the board from streaming any further
+        m_flightLogControl->setOperation(DebugLogControl::OPERATION_NONE);
+        updateHelper.doObjectAndWait(m_flightLogControl, UAVTALK_TIMEOUT);
+    }
+}
+
+void FlightLogManager::bulkEntryReceived(UAVObject *object)
+{
+    Q_UNUSED(object);
+
+    DebugLogEntry::DataFields fields = m_flightLogEntry->getData();
+    if (!m_bulkLoop || fields.Flight != m_bulkFlight) {
+        return;
+    }
+    m_bulkTimer.start();
+
+    if (fields.Type == DebugLogEntry::TYPE_EMPTY) {
+        if (m_bulkEnd < 0 || fields.Entry < m_bulkEnd) {
+            m_bulkEnd = fields.Entry;
+        }
+        m_bulkLoop->quit();
+        return;
+    }
+    m_bulkEntries.insert(fields.Entry, fields);
+    if (fields.Entry == m_bulkLast || m_cancelDownload) {
+        m_bulkLoop->quit();
+    }
+}
+
 void FlightLogManager::exportToOPL(QString fileName)
 {
     // Fix the file name
@@ -372,6 +523,90 @@ void FlightLogManager::exportToXML(QString fileName)
     }
 }
 
+void FlightLogManager::exportToTrace(QString fileName)
+{
+    QFile traceFile(fileName);
+
+    if (traceFile.open(QFile::WriteOnly | QFile::Truncate)) {
+        // Chrome trace event format, one process per flight and one timeline row per flight module
+        QJsonArray events;
+        QList<int> flights;
+        foreach(ExtendedDebugLogEntry * entry, m_logEntries) {
+            if (entry->getType() == DebugLogEntry::TYPE_TRACE && !flights.contains(entry->getFlight() + 1)) {
+                flights << entry->getFlight() + 1;
+            }
+        }
+        foreach(int flight, flights) {
+            QJsonObject process;
+            QJsonObject processArgs;
+            process["name"] = "process_name";
+            process["ph"]   = "M";
+            process["pid"]  = flight;
+            processArgs["name"] = tr("Flight %1").arg(flight);
+            process["args"] = processArgs;
+            events.append(process);
+            for (int module = 0; module < 5; module++) {
+                QJsonObject name;
+                QJsonObject nameArgs;
+                name["name"] = "thread_name";
+                name["ph"]   = "M";
+                name["pid"]  = flight;
+                name["tid"]  = module;
+                nameArgs["name"] = ExtendedDebugLogEntry::traceModuleName(module);
+                name["args"] = nameArgs;
+                events.append(name);
+                QJsonObject sort;
+                QJsonObject sortArgs;
+                sort["name"] = "thread_sort_index";
+                sort["ph"]   = "M";
+                sort["pid"]  = flight;
+                sort["tid"]  = module;
+                sortArgs["sort_index"] = module;
+                sort["args"] = sortArgs;
+                events.append(sort);
+            }
+        }
+
+        quint32 baseTime = 0;
+        quint32 currentFlight = 0;
+        foreach(ExtendedDebugLogEntry * entry, m_logEntries) {
+            if (entry->getType() != DebugLogEntry::TYPE_TRACE) {
+                continue;
+            }
+            if (m_adjustExportedTimestamps && entry->getFlight() != currentFlight) {
+                currentFlight = entry->getFlight();
+                baseTime = entry->getFlightTime();
+            }
+            foreach(const ExtendedDebugLogEntry::TraceEvent &traceEvent, entry->traceEvents()) {
+                QJsonObject event;
+                event["name"] = QString("0x%1").arg(traceEvent.id, 8, 16, QChar('0'));
+                event["pid"]  = (int)entry->getFlight() + 1;
+                event["tid"]  = ExtendedDebugLogEntry::traceModuleIndex(traceEvent.id);
+                event["ts"]   = (double)(quint32)(traceEvent.timestamp - baseTime);
+                switch (traceEvent.type) {
+                case ExtendedDebugLogEntry::TRACE_ENTER:
+                    event["ph"] = "B";
+                    break;
+                case ExtendedDebugLogEntry::TRACE_EXIT:
+                    event["ph"] = "E";
+                    break;
+                default:
+                    event["ph"] = "i";
+                    event["s"]  = "t";
+                    break;
+                }
+                events.append(event);
+            }
+        }
+        QJsonObject root;
+        root["traceEvents"] = events;
+        root["displayTimeUnit"] = "ms";
+        traceFile.write(QJsonDocument(root).toJson());
+        traceFile.flush();
+        traceFile.close();
+    }
+}
+
 void FlightLogManager::exportLogs()
 {
     if (m_logEntries.isEmpty()) {
@@ -384,11 +619,12 @@ void FlightLogManager::exportLogs()
     QString oplFilter = tr("OpenPilot Log file %1").arg("(*.opl)");
     QString csvFilter = tr("Text file %1").arg("(*.csv)");
     QString xmlFilter = tr("XML file %1").arg("(*.xml)");
+    QString traceFilter = tr("Trace timeline %1").arg("(*.json)");
 
     QString selectedFilter = csvFilter;
 
     QString fileName = QFileDialog::getSaveFileName(NULL, tr("Save Log Entries"), QDir::homePath(),
-                                                    QString("%1;;%2;;%3").arg(oplFilter, csvFilter, xmlFilter), &selectedFilter);
+                                                    QString("%1;;%2;;%3;;%4").arg(oplFilter, csvFilter, xmlFilter, traceFilter), &selectedFilter);
     if (!fileName.isEmpty()) {
         if (selectedFilter == oplFilter) {
             if (!fileName.endsWith(".opl")) {
@@ -405,6 +641,11 @@ void FlightLogManager::exportLogs()
                 fileName.append(".xml");
             }
             exportToXML(fileName);
+        } else if (selectedFilter == traceFilter) {
+            if (!fileName.endsWith(".json")) {
+                fileName.append(".json");
+            }
+            exportToTrace(fileName);
         }
     }
 
@@ -475,6 +716,28 @@ void FlightLogManager::loadSettings()
     }
 }
 
+/**
+ * Load the string table the deferred debug log messages are expanded with when
+ * they are retrieved. It is made along with the firmware (fw_<board>.debuglog)
+ * and only matches logs written by that same firmware.
+ */
+void FlightLogManager::loadMessageTable()
+{
+    QString tableFilter = tr("Debug log string table %1").arg("(*.debuglog)");
+    QString fileName    = QFileDialog::getOpenFileName(NULL, tr("Load Message Table"), QDir::homePath(), tableFilter);
+
+    if (!fileName.isEmpty()) {
+        QFile file(fileName);
+        if (file.open(QIODevice::ReadOnly)) {
+            m_messageFormats = file.readAll();
+            file.close();
+        } else {
+            QMessageBox::warning(NULL, tr("Message table not loaded."),
+                                 tr("Could not open %1.").arg(fileName), QMessageBox::Ok);
+        }
+    }
+}
+
 void FlightLogManager::saveSettings()
 {
     QString xmlFilter = tr("XML file %1").arg("(*.xml)");
@@ -643,6 +906,12 @@ QString ExtendedDebugLogEntry::getLogString()
         return QString((const char *)getData().Data);
     } else if (getType() == DebugLogEntry::TYPE_UAVOBJECT || getType() == DebugLogEntry::TYPE_MULTIPLEUAVOBJECTS) {
         return m_object->toString().replace("\n", " ").replace("\t", " ");
+    } else if (getType() == DebugLogEntry::TYPE_TRACE) {
+        QList<TraceEvent> events = traceEvents();
+        if (events.isEmpty()) {
+            return "";
+        }
+        return QString("%1 trace events, %2 us").arg(events.count()).arg(events.last().timestamp - events.first().timestamp);
     } else {
         return "";
     }
@@ -660,6 +929,16 @@ void ExtendedDebugLogEntry::toXML(QXmlStreamWriter *xmlWriter, quint32 baseTime)
     } else if (getType() == DebugLogEntry::TYPE_UAVOBJECT || getType() == DebugLogEntry::TYPE_MULTIPLEUAVOBJECTS) {
         xmlWriter->writeAttribute("type", "uavobject");
         m_object->toXML(xmlWriter);
+    } else if (getType() == DebugLogEntry::TYPE_TRACE) {
+        xmlWriter->writeAttribute("type", "trace");
+        foreach(const TraceEvent &event, traceEvents()) {
+            xmlWriter->writeStartElement("event");
+            xmlWriter->writeAttribute("id", QString("0x%1").arg(event.id, 8, 16, QChar('0')));
+            xmlWriter->writeAttribute("module", traceModuleName(traceModuleIndex(event.id)));
+            xmlWriter->writeAttribute("type", QString::number(event.type));
+            xmlWriter->writeAttribute("flighttime", QString::number(event.timestamp - baseTime));
+            xmlWriter->writeEndElement(); // event
+        }
     }
     xmlWriter->writeEndElement(); // entry
 }
@@ -668,7 +947,16 @@ void ExtendedDebugLogEntry::toCSV(QTextStream *csvStream, quint32 baseTime)
 {
     QString data;
 
-    if (getType() == DebugLogEntry::TYPE_TEXT) {
+    if (getType() == DebugLogEntry::TYPE_TRACE) {
+        // one line per event so the timeline can be plotted directly
+        static const char *typeNames[] = { "enter", "exit", "period", "value" };
+        foreach(const TraceEvent &event, traceEvents()) {
+            QString typeName = event.type < 4 ? QString(typeNames[event.type]) : QString::number(event.type);
+            *csvStream << QString::number(getFlight() + 1) << '\t' << QString::number(event.timestamp - baseTime) << '\t' << QString::number(getEntry()) << '\t'
+                       << traceModuleName(traceModuleIndex(event.id)) << ' ' << QString("0x%1").arg(event.id, 8, 16, QChar('0')) << ' ' << typeName << '\n';
+        }
+        return;
+    } else if (getType() == DebugLogEntry::TYPE_TEXT) {
         data = QString((const char *)getData().Data);
     } else if (getType() == DebugLogEntry::TYPE_UAVOBJECT || getType() == DebugLogEntry::TYPE_MULTIPLEUAVOBJECTS) {
         data = m_object->toString().replace("\n", "").replace("\t", "");
@@ -676,6 +964,318 @@ void ExtendedDebugLogEntry::toCSV(QTextStream *csvStream, quint32 baseTime)
     *csvStream << QString::number(getFlight() + 1) << '\t' << QString::number(getFlightTime() - baseTime) << '\t' << QString::number(getEntry()) << '\t' << data << '\n';
 }
 
+static bool readVarint(const quint8 *data, quint32 size, quint32 &pos, quint32 &value)
+{
+    value = 0;
+    for (int shift = 0; shift < 35 && pos < size; shift += 7) {
+        quint8 byte = data[pos++];
+        value |= (quint32)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static inline qint32 unzigzag(quint32 value)
+{
+    return (qint32)(value >> 1) ^ -(qint32)(value & 1);
+}
+
+QList<DebugLogEntry::DataFields> ExtendedDebugLogEntry::decodeCompact(const DataFields &data, CompactState &state)
+{
+    QList<DataFields> samples;
+
+    // records are packed as described in pios_debuglog.c, each one is a field by field delta
+    // against the previous sample in the same slot, or against zero for keyframes
+    const quint8 *in  = data.Data;
+    const quint32 end = qMin((quint32)data.Size, (quint32)sizeof(data.Data));
+    quint32 pos = 0;
+    quint32 time = data.FlightTime;
+
+    while (pos < end) {
+        quint32 header, delta;
+        if (!readVarint(in, end, pos, header) || !readVarint(in, end, pos, delta)) {
+            break;
+        }
+        time += delta;
+
+        int slot = header >> 1;
+        bool keyframe = header & 1;
+        CompactObject object;
+        quint32 size;
+        if (keyframe) {
+            quint32 instanceId, numWords, numHalfWords;
+            if (pos + 4 > end) {
+                break;
+            }
+            object.objectId = in[pos] | (in[pos + 1] << 8) | (in[pos + 2] << 16) | ((quint32)in[pos + 3] << 24);
+            pos += 4;
+            if (!readVarint(in, end, pos, instanceId) || !readVarint(in, end, pos, size) ||
+                !readVarint(in, end, pos, numWords) || !readVarint(in, end, pos, numHalfWords) ||
+                size > sizeof(data.Data) || 4 * numWords + 2 * numHalfWords > size) {
+                break;
+            }
+            object.instanceId   = instanceId;
+            object.numWords     = numWords;
+            object.numHalfWords = numHalfWords;
+            object.previous     = QByteArray(size, 0);
+        } else if (state.contains(slot)) {
+            object = state.value(slot);
+            size   = object.previous.size();
+        } else {
+            // a delta without its keyframe, its length is unknown so the rest of the entry is lost
+            break;
+        }
+
+        QByteArray current(size, 0);
+        const quint8 *prev = (const quint8 *)object.previous.constData();
+        quint8 *cur = (quint8 *)current.data();
+        quint32 i   = 0;
+        bool ok     = true;
+        for (int n = 0; ok && n < object.numWords; n++, i += 4) {
+            quint32 value;
+            ok = readVarint(in, end, pos, value);
+            quint32 word = prev[i] | (prev[i + 1] << 8) | (prev[i + 2] << 16) | ((quint32)prev[i + 3] << 24);
+            word += (quint32)unzigzag(value);
+            cur[i]     = word & 0xFF;
+            cur[i + 1] = (word >> 8) & 0xFF;
+            cur[i + 2] = (word >> 16) & 0xFF;
+            cur[i + 3] = (word >> 24) & 0xFF;
+        }
+        for (int n = 0; ok && n < object.numHalfWords; n++, i += 2) {
+            quint32 value;
+            ok = readVarint(in, end, pos, value);
+            quint16 halfword = prev[i] | (prev[i + 1] << 8);
+            halfword  += (quint16)unzigzag(value);
+            cur[i]     = halfword & 0xFF;
+            cur[i + 1] = (halfword >> 8) & 0xFF;
+        }
+        for (; ok && i < size; i++) {
+            quint32 value;
+            ok     = readVarint(in, end, pos, value);
+            cur[i] = prev[i] + (quint8)unzigzag(value);
+        }
+        if (!ok) {
+            break;
+        }
+
+        object.previous = current;
+        state.insert(slot, object);
+
+        DataFields sample;
+        memset(&sample, 0, sizeof(sample));
+        sample.Flight     = data.Flight;
+        sample.FlightTime = time;
+        sample.Entry      = data.Entry;
+        sample.Type       = DebugLogEntry::TYPE_UAVOBJECT;
+        sample.ObjectID   = object.objectId;
+        sample.InstanceID = object.instanceId;
+        sample.Size       = size;
+        memcpy(sample.Data, current.constData(), size);
+        samples << sample;
+    }
+    return samples;
+}
+
+// Format one deferred debug log message, the arguments are coded as described in pios_debuglog.c
+static QString formatMessage(const QByteArray &formats, quint32 id, const quint8 *args, quint32 size)
+{
+    if (id >= (quint32)formats.size()) {
+        // no string table, or not the one of the firmware that wrote the log
+        return QString("Message 0x%1 (%2 bytes of arguments)").arg(id, 0, 16).arg(size);
+    }
+
+    const char *start = formats.constData() + id;
+    const QByteArray format(start, qstrnlen(start, formats.size() - id));
+    QString text;
+    quint32 pos = 0;
+
+    for (int i = 0; i < format.size(); i++) {
+        if (format[i] != '%') {
+            text += QChar::fromLatin1(format[i]);
+            continue;
+        }
+        if (i + 1 < format.size() && format[i + 1] == '%') {
+            text += '%';
+            i++;
+            continue;
+        }
+
+        int conversionStart = i;
+        QByteArray spec("%");
+        quint32 value = 0;
+        bool ok = true;
+        for (i++; ok && i < format.size() && strchr("-+ #0123456789.*", format[i]); i++) {
+            if (format[i] == '*') {
+                ok = readVarint(args, size, pos, value);
+                spec += QByteArray::number(unzigzag(value));
+            } else {
+                spec += format[i];
+            }
+        }
+        // every integer is logged as 32 bit, drop the length modifiers
+        while (i < format.size() && strchr("hlLqjzt", format[i])) {
+            i++;
+        }
+        char conversion = i < format.size() ? format[i] : 0;
+        spec += conversion;
+
+        switch (conversion) {
+        case 'd':
+        case 'i':
+            if ((ok = ok && readVarint(args, size, pos, value))) {
+                text += QString().sprintf(spec.constData(), unzigzag(value));
+            }
+            break;
+        case 'u':
+        case 'o':
+        case 'x':
+        case 'X':
+        case 'c':
+            if ((ok = ok && readVarint(args, size, pos, value))) {
+                text += QString().sprintf(spec.constData(), value);
+            }
+            break;
+        case 'p':
+            if ((ok = ok && readVarint(args, size, pos, value))) {
+                text += QString("0x%1").arg(value, 8, 16, QChar('0'));
+            }
+            break;
+        case 'e':
+        case 'E':
+        case 'f':
+        case 'F':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A':
+            if ((ok = ok && pos + sizeof(float) <= size)) {
+                float number;
+                memcpy(&number, args + pos, sizeof(number));
+                pos  += sizeof(number);
+                text += QString().sprintf(spec.constData(), (double)number);
+            }
+            break;
+        case 's':
+            if ((ok = ok && readVarint(args, size, pos, value) && pos + value <= size)) {
+                QByteArray string((const char *)args + pos, value);
+                pos  += value;
+                text += QString().sprintf(spec.constData(), string.constData());
+            }
+            break;
+        case 'n':
+            break;
+        default:
+            ok = false;
+            break;
+        }
+        if (!ok) {
+            // the arguments that follow were not logged, keep the rest of the format as is
+            text += QString::fromLatin1(format.mid(conversionStart));
+            break;
+        }
+    }
+    return text;
+}
+
+QList<DebugLogEntry::DataFields> ExtendedDebugLogEntry::decodeMessages(const DataFields &data, const QByteArray &formats)
+{
+    QList<DataFields> messages;
+
+    // records are packed as described in pios_debuglog.c, each one is expanded to a text entry
+    const quint8 *in  = data.Data;
+    const quint32 end = qMin((quint32)data.Size, (quint32)sizeof(data.Data));
+    quint32 pos  = 0;
+    quint32 time = data.FlightTime;
+
+    while (pos < end) {
+        quint32 id, delta, argsSize;
+        if (!readVarint(in, end, pos, id) || !readVarint(in, end, pos, delta) ||
+            !readVarint(in, end, pos, argsSize) || pos + argsSize > end) {
+            break;
+        }
+        time += delta;
+        QByteArray text = formatMessage(formats, id, in + pos, argsSize).toUtf8().left(sizeof(data.Data) - 1);
+        pos += argsSize;
+
+        DataFields message;
+        memset(&message, 0, sizeof(message));
+        message.Flight     = data.Flight;
+        message.FlightTime = time;
+        message.Entry      = data.Entry;
+        message.Type       = DebugLogEntry::TYPE_TEXT;
+        message.Size       = text.size();
+        memcpy(message.Data, text.constData(), text.size());
+        messages << message;
+    }
+    return messages;
+}
+
+QList<ExtendedDebugLogEntry::TraceEvent> ExtendedDebugLogEntry::traceEvents()
+{
+    QList<TraceEvent> events;
+
+    if (getType() != DebugLogEntry::TYPE_TRACE) {
+        return events;
+    }
+    // records are packed little endian as { uint32 timestamp, uint32 id, uint8 type }
+    const int recordSize = 9;
+    const quint8 *data   = getData().Data;
+    int size = qMin((int)getData().Size, (int)sizeof(((DebugLogEntry::DataFields *)0)->Data));
+    for (int offset = 0; offset + recordSize <= size; offset += recordSize) {
+        TraceEvent event;
+        event.timestamp = data[offset] | (data[offset + 1] << 8) | (data[offset + 2] << 16) | ((quint32)data[offset + 3] << 24);
+        event.id   = data[offset + 4] | (data[offset + 5] << 8) | (data[offset + 6] << 16) | ((quint32)data[offset + 7] << 24);
+        event.type = data[offset + 8];
+        events << event;
+    }
+    return events;
+}
+
+// Timeline rows follow the control chain Sensors -> StateEstimation -> Stabilization -> Actuator,
+// counters of any other module end up in the last row
+int ExtendedDebugLogEntry::traceModuleIndex(quint32 id)
+{
+    switch (id >> 16) {
+    case 0x5300:
+        return 0;
+
+    case 0x5E00:
+    case 0xA771:
+        return 1;
+
+    case 0x5AB1:
+        return 2;
+
+    case 0xAC70:
+        return 3;
+
+    default:
+        return 4;
+    }
+}
+
+QString ExtendedDebugLogEntry::traceModuleName(int moduleIndex)
+{
+    switch (moduleIndex) {
+    case 0:
+        return "Sensors";
+
+    case 1:
+        return "StateEstimation";
+
+    case 2:
+        return "Stabilization";
+
+    case 3:
+        return "Actuator";
+
+    default:
+        return "Other";
+    }
+}
+
 void ExtendedDebugLogEntry::setData(const DebugLogEntry::DataFields &data, UAVObjectManager *objectManager)
 {
     DebugLogEntry::setData(data);
@@ -31,6 +31,9 @@
 #include <QObject>
 #include <QList>
 #include <QHash>
+#include <QMap>
+#include <QTimer>
+#include <QEventLoop>
 #include <QQmlListProperty>
 #include <QSemaphore>
 #include <QXmlStreamWriter>
@@ -141,12 +144,36 @@ class ExtendedDebugLogEntry : public DebugLogEntry {
     Q_OBJECT Q_PROPERTY(QString LogString READ getLogString WRITE setLogString NOTIFY LogStringUpdated)
 
 public:
+    enum TraceEventType { TRACE_ENTER = 0, TRACE_EXIT, TRACE_PERIOD, TRACE_VALUE };
+
+    // one instrumentation event as packed by InstrumentationDumpTrace() on flight side
+    struct TraceEvent {
+        quint32 timestamp;
+        quint32 id;
+        quint8  type;
+    };
+
+    // decoder state of one object slot of compact entries, see pios_debuglog.c on flight side
+    struct CompactObject {
+        quint32    objectId;
+        quint16    instanceId;
+        quint16    numWords;
+        quint16    numHalfWords;
+        QByteArray previous;
+    };
+    typedef QHash<int, CompactObject> CompactState;
+
     explicit ExtendedDebugLogEntry();
     ~ExtendedDebugLogEntry();
 
     QString getLogString();
     void toXML(QXmlStreamWriter *xmlWriter, quint32 baseTime);
     void toCSV(QTextStream *csvStream, quint32 baseTime);
+    QList<TraceEvent> traceEvents();
+    static QString traceModuleName(int moduleIndex);
+    static int traceModuleIndex(quint32 id);
+    static QList<DataFields> decodeCompact(const DataFields & data, CompactState & state);
+    static QList<DataFields> decodeMessages(const DataFields & data, const QByteArray & formats);
     UAVDataObject *uavObject()
     {
         return m_object;
@@ -266,8 +293,11 @@ public slots:
     void retrieveLogs(int flightToRetrieve = -1);
     void exportLogs();
     void cancelExportLogs();
+    void startTrace();
+    void dumpTrace();
     void loadSettings();
     void saveSettings();
+    void loadMessageTable();
     void resetSettings(bool clear);
     void saveSettingsToBoard();
     bool saveUAVObjectToFlash(UAVObject *object);
@@ -319,6 +349,7 @@ private slots:
     void setupLogStatuses();
     void connectionStatusChanged();
     bool updateLogWrapper(QString name, int level, int period);
+    void bulkEntryReceived(UAVObject *object);
 
 private:
     UAVObjectManager *m_objectManager;
@@ -331,6 +362,8 @@ private:
     ObjectPersistence *m_objectPersistence;
 
     QList<ExtendedDebugLogEntry *> m_logEntries;
+    // format strings of the deferred debug log messages, see PIOS_DEBUGLOG_MESSAGE() on flight side
+    QByteArray m_messageFormats;
     QStringList m_flightEntries;
     QStringList m_logSettings;
     QStringList m_logStatuses;
@@ -341,9 +374,24 @@ private:
     void exportToOPL(QString fileName);
     void exportToCSV(QString fileName);
     void exportToXML(QString fileName);
+    void exportToTrace(QString fileName);
+    void addRetrievedEntry(const DebugLogEntry::DataFields & data, ExtendedDebugLogEntry::CompactState & compactState);
+    void bulkRetrieve(int flight, int start, int count, int period);
+
+    // entries of the flight being retrieved, by entry number
+    QMap<int, DebugLogEntry::DataFields> m_bulkEntries;
+    int m_bulkFlight;
+    int m_bulkEnd; // entry number of the end of the flight, -1 while unknown
+    int m_bulkLast; // last entry expected from the running stream, -1 for all
+    QEventLoop *m_bulkLoop;
+    QTimer m_bulkTimer;
 
     static const int UAVTALK_TIMEOUT = 4000;
     static const int LOG_SETTINGS_FILE_VERSION = 1;
+    static const int BULK_PERIOD_MS     = 2;
+    static const int BULK_MAX_PERIOD_MS = 64;
+    static const int BULK_PASSES        = 4;
+    static const int BULK_IDLE_TIMEOUT  = 1000;
     bool m_disableControls;
     bool m_disableExport;
     bool m_cancelDownload;
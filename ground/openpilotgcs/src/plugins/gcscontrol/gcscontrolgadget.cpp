@@ -31,8 +31,13 @@
 #include "uavobjectmanager.h"
 #include "uavobject.h"
 #include <QDebug>
+#include <QTimer>
 
-#define JOYSTICK_UPDATE_RATE 50
+// Minimum time between two joystick updates of ManualControlCommand. A change is sent
+// right away when the last update is older, otherwise the latest position is sent as
+// soon as the interval is over.
+#define JOYSTICK_MIN_INTERVAL 20
+#define LATENCY_PERIOD        1000
 
 GCSControlGadget::GCSControlGadget(QString classId, GCSControlGadgetWidget *widget, QWidget *parent, QObject *plugin) :
     IUAVGadget(classId, parent),
@@ -49,6 +54,23 @@ GCSControlGadget::GCSControlGadget(QString classId, GCSControlGadgetWidget *widg
     connect(control_sock, SIGNAL(readyRead()), this, SLOT(readUDPCommand()));
 
     joystickTime.start();
+    joystickPending = false;
+    inputLatency    = 0;
+    joystickTimer   = new QTimer(this);
+    joystickTimer->setSingleShot(true);
+    joystickTimer->setTimerType(Qt::PreciseTimer);
+    connect(joystickTimer, SIGNAL(timeout()), this, SLOT(sendJoystickSticks()));
+
+    linkPending  = false;
+    latencyTimer = new QTimer(this);
+    connect(latencyTimer, SIGNAL(timeout()), this, SLOT(measureLatency()));
+    latencyTimer->start(LATENCY_PERIOD);
+    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
+    UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
+    connect(objManager->getObject(QString("FlightStatus")), SIGNAL(transactionCompleted(UAVObject *, bool)),
+            this, SLOT(latencyMeasured(UAVObject *, bool)));
+    connect(this, SIGNAL(latencyChanged(int, int)), widget, SLOT(setLatency(int, int)));
+
     GCSControlPlugin *pl = dynamic_cast<GCSControlPlugin *>(plugin);
     connect(pl->sdlGamepad, SIGNAL(gamepads(quint8)), this, SLOT(gamepads(quint8)));
     connect(pl->sdlGamepad, SIGNAL(buttonState(ButtonNumber, bool)), this, SLOT(buttonState(ButtonNumber, bool)));
@@ -458,27 +480,90 @@ void GCSControlGadget::axesValues(QListInt16 values)
     }
 
 
-    if (joystickTime.elapsed() > JOYSTICK_UPDATE_RATE) {
-        joystickTime.restart();
-        // Remap RPYT to left X/Y and right X/Y depending on mode
-        // Mode 1: LeftX = Yaw, LeftY = Pitch, RightX = Roll, RightY = Throttle
-        // Mode 2: LeftX = Yaw, LeftY = THrottle, RightX = Roll, RightY = Pitch
-        // Mode 3: LeftX = Roll, LeftY = Pitch, RightX = Yaw, RightY = Throttle
-        // Mode 4: LeftX = Roll, LeftY = Throttle, RightX = Yaw, RightY = Pitch;
-        switch (controlsMode) {
-        case 1:
-            sticksChangedLocally(yValue / max, -pValue / max, rValue / max, -tValue / max);
-            break;
-        case 2:
-            sticksChangedLocally(yValue / max, -tValue / max, rValue / max, -pValue / max);
-            break;
-        case 3:
-            sticksChangedLocally(rValue / max, -pValue / max, yValue / max, -tValue / max);
-            break;
-        case 4:
-            sticksChangedLocally(rValue / max, -tValue / max, yValue / max, -pValue / max);
-            break;
-        }
+    // Remap RPYT to left X/Y and right X/Y depending on mode
+    // Mode 1: LeftX = Yaw, LeftY = Pitch, RightX = Roll, RightY = Throttle
+    // Mode 2: LeftX = Yaw, LeftY = THrottle, RightX = Roll, RightY = Pitch
+    // Mode 3: LeftX = Roll, LeftY = Pitch, RightX = Yaw, RightY = Throttle
+    // Mode 4: LeftX = Roll, LeftY = Throttle, RightX = Yaw, RightY = Pitch;
+    switch (controlsMode) {
+    case 1:
+        queueJoystickSticks(yValue / max, -pValue / max, rValue / max, -tValue / max);
+        break;
+    case 2:
+        queueJoystickSticks(yValue / max, -tValue / max, rValue / max, -pValue / max);
+        break;
+    case 3:
+        queueJoystickSticks(rValue / max, -pValue / max, yValue / max, -tValue / max);
+        break;
+    case 4:
+        queueJoystickSticks(rValue / max, -tValue / max, yValue / max, -pValue / max);
+        break;
+    }
+}
+
+/**
+   Send a joystick position now if the last update is old enough, otherwise keep
+   it until JOYSTICK_MIN_INTERVAL is over. Newer positions replace the kept one.
+ */
+void GCSControlGadget::queueJoystickSticks(double leftX, double leftY, double rightX, double rightY)
+{
+    if (!joystickPending) {
+        joystickInputTime.start();
+    }
+    joystickSticks[0] = leftX;
+    joystickSticks[1] = leftY;
+    joystickSticks[2] = rightX;
+    joystickSticks[3] = rightY;
+    joystickPending   = true;
+
+    int wait = JOYSTICK_MIN_INTERVAL - joystickTime.elapsed();
+    if (wait <= 0) {
+        sendJoystickSticks();
+    } else if (!joystickTimer->isActive()) {
+        joystickTimer->start(wait);
+    }
+}
+
+void GCSControlGadget::sendJoystickSticks()
+{
+    if (!joystickPending) {
+        return;
+    }
+    joystickPending = false;
+    joystickTime.restart();
+    sticksChangedLocally(joystickSticks[0], joystickSticks[1], joystickSticks[2], joystickSticks[3]);
+    inputLatency = joystickInputTime.elapsed();
+}
+
+/**
+   Time a FlightStatus request while in GCS control, half of the round trip is
+   added to the joystick input delay to show the stick to board latency.
+ */
+void GCSControlGadget::measureLatency()
+{
+    if (!((GCSControlGadgetWidget *)m_widget)->getGCSControl()) {
+        linkPending = false;
+        emit latencyChanged(-1, -1);
+        return;
+    }
+    // A request that did not complete within the period is given up
+    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
+    UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
+    linkPending = true;
+    linkTime.start();
+    objManager->getObject(QString("FlightStatus"))->requestUpdate();
+}
+
+void GCSControlGadget::latencyMeasured(UAVObject *, bool success)
+{
+    if (!linkPending) {
+        return;
+    }
+    linkPending = false;
+    if (success) {
+        emit latencyChanged(inputLatency, linkTime.elapsed() / 2);
+    } else {
+        emit latencyChanged(inputLatency, -1);
     }
 }
 
@@ -33,10 +33,12 @@
 #include "gcscontrolgadgetconfiguration.h"
 #include "sdlgamepad/sdlgamepad.h"
 #include <QTime>
+#include <QElapsedTimer>
 #include "gcscontrolplugin.h"
 #include <QUdpSocket>
 #include <QHostAddress>
 
+class QTimer;
 
 namespace Core {
 class IUAVGadget;
@@ -71,7 +73,18 @@ public:
 private:
     ManualControlCommand *getManualControlCommand();
     double constrain(double value);
+    void queueJoystickSticks(double leftX, double leftY, double rightX, double rightY);
     QTime joystickTime;
+    // Joystick position not sent yet, waits for joystickTimer
+    QTimer *joystickTimer;
+    double joystickSticks[4];
+    bool joystickPending;
+    QElapsedTimer joystickInputTime;
+    int inputLatency;
+    // Round trip of a FlightStatus request, to estimate the link delay
+    QTimer *latencyTimer;
+    QElapsedTimer linkTime;
+    bool linkPending;
     QWidget *m_widget;
     QList<int> m_context;
     UAVObject::Metadata mccInitialData;
@@ -89,11 +102,15 @@ private:
 
 signals:
     void sticksChangedRemotely(double leftX, double leftY, double rightX, double rightY);
+    void latencyChanged(int inputMs, int linkMs);
 
 protected slots:
     void manualControlCommandUpdated(UAVObject *);
     void sticksChangedLocally(double leftX, double leftY, double rightX, double rightY);
     void readUDPCommand();
+    void sendJoystickSticks();
+    void measureLatency();
+    void latencyMeasured(UAVObject *, bool success);
 
     // signals from joystick
     void gamepads(quint8 count);
@@ -101,6 +101,18 @@ void GCSControlGadgetWidget::updateSticks(double nleftX, double nleftY, double n
     m_gcscontrol->widgetRightStick->changePosition(rightX, rightY);
 }
 
+void GCSControlGadgetWidget::setLatency(int inputMs, int linkMs)
+{
+    if (inputMs < 0) {
+        m_gcscontrol->labelLatency->clear();
+    } else if (linkMs < 0) {
+        m_gcscontrol->labelLatency->setText(tr("Latency: %1 ms + link timeout").arg(inputMs));
+    } else {
+        m_gcscontrol->labelLatency->setText(tr("Latency: %1 ms").arg(inputMs + linkMs));
+        m_gcscontrol->labelLatency->setToolTip(tr("Joystick input %1 ms, link %2 ms").arg(inputMs).arg(linkMs));
+    }
+}
+
 void GCSControlGadgetWidget::leftStickClicked(double X, double Y)
 {
     leftX = X;
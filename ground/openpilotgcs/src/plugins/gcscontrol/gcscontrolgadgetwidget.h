@@ -59,6 +59,9 @@ public slots:
     void leftStickClicked(double X, double Y);
     void rightStickClicked(double X, double Y);
 
+    // stick to board latency estimate, negative values when unknown
+    void setLatency(int inputMs, int linkMs);
+
 protected slots:
     void toggleControl(int state);
     void toggleArmed(int state);
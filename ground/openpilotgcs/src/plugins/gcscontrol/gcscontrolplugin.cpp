@@ -31,6 +31,9 @@
 #include <QStringList>
 #include <extensionsystem/pluginmanager.h>
 
+// Gamepad polling period in ms
+#define JOYSTICK_POLL_RATE 2
+
 
 GCSControlPlugin::GCSControlPlugin()
 {
@@ -48,6 +51,8 @@ bool GCSControlPlugin::initialize(const QStringList & args, QString *errMsg)
     Q_UNUSED(errMsg);
     sdlGamepad = new SDLGamepad();
     if (sdlGamepad->init()) {
+        // Poll often, the gamepad only reports changes
+        sdlGamepad->setTickRate(JOYSTICK_POLL_RATE);
         sdlGamepad->start();
         qRegisterMetaType<QListInt16>("QListInt16");
         qRegisterMetaType<ButtonNumber>("ButtonNumber");
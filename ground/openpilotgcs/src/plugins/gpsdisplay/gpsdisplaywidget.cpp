@@ -39,10 +39,16 @@
 #include <QtGui>
 #include <QDebug>
 
+// The parser reports every sentence, the display is refreshed at most this often
+#define REFRESH_PERIOD_MS  100
+#define MAX_PACKET_LINES   200
+
 /*
  * Initialize the widget
  */
-GpsDisplayWidget::GpsDisplayWidget(QWidget *parent) : QWidget(parent)
+GpsDisplayWidget::GpsDisplayWidget(QWidget *parent) : QWidget(parent),
+    pendingRefresh(0), sv(0), lat(0), lon(0), alt(0), date(0), time(0),
+    speed(0), heading(0), hdop(0), vdop(0), pdop(0)
 {
     setupUi(this);
 
@@ -58,109 +64,171 @@ GpsDisplayWidget::GpsDisplayWidget(QWidget *parent) : QWidget(parent)
     fescene->addItem(marker);
     double scale = earthpix.width() / (marker->boundingRect().width() * 20);
     marker->setScale(scale);
+
+    refreshTimer.setSingleShot(true);
+    connect(&refreshTimer, SIGNAL(timeout()), this, SLOT(refresh()));
 }
 
 GpsDisplayWidget::~GpsDisplayWidget()
 {}
 
-void GpsDisplayWidget::setSpeedHeading(double speed, double heading)
+void GpsDisplayWidget::scheduleRefresh(int parts)
 {
-    QString str;
+    pendingRefresh |= parts;
+    if (!refreshTimer.isActive()) {
+        refreshTimer.start(REFRESH_PERIOD_MS);
+    }
+}
 
-    speed_value->setText(str.sprintf("%.02f m/s", speed));
-    bear_value->setText(str.sprintf("%.02f deg", heading));
+void GpsDisplayWidget::setSpeedHeading(double speed, double heading)
+{
+    this->speed   = speed;
+    this->heading = heading;
+    scheduleRefresh(RefreshSpeedHeading);
 }
 
 void GpsDisplayWidget::setDateTime(double date, double time)
 {
-    QString dstring1, dstring2;
-
-    dstring1.sprintf("%06.0f", date);
-    dstring1.insert(dstring1.length() - 2, ".");
-    dstring1.insert(dstring1.length() - 5, ".");
-    dstring2.sprintf("%06.0f", time);
-    dstring2.insert(dstring2.length() - 2, ":");
-    dstring2.insert(dstring2.length() - 5, ":");
-    time_value->setText(dstring1 + "    " + dstring2 + " GMT");
+    this->date = date;
+    this->time = time;
+    scheduleRefresh(RefreshDateTime);
 }
 
 void GpsDisplayWidget::setFixType(const QString &fixtype)
 {
-    if (fixtype == "NoGPS") {
-        fix_value->setText("No GPS");
-    } else if (fixtype == "NoFix") {
-        fix_value->setText("Fix not available");
-    } else if (fixtype == "Fix2D") {
-        fix_value->setText("2D");
-    } else if (fixtype == "Fix3D") {
-        fix_value->setText("3D");
-    } else {
-        fix_value->setText("Unknown");
-    }
+    fixType = fixtype;
+    scheduleRefresh(RefreshFixType);
 }
 
 void GpsDisplayWidget::dumpPacket(const QString &packet)
 {
-    textBrowser->append(packet);
-    if (textBrowser->document()->lineCount() > 200) {
-        QTextCursor tc = textBrowser->textCursor();
-        tc.movePosition(QTextCursor::Start);
-        tc.movePosition(QTextCursor::Down, QTextCursor::KeepAnchor);
-        tc.movePosition(QTextCursor::StartOfLine, QTextCursor::KeepAnchor);
-        tc.removeSelectedText();
+    pendingPackets.append(packet);
+    if (pendingPackets.size() > MAX_PACKET_LINES) {
+        pendingPackets.removeFirst();
     }
+    scheduleRefresh(RefreshPackets);
 }
 
 void GpsDisplayWidget::setSVs(int sv)
 {
-    QString temp;
-
-    temp.append(QString::number(sv));
-    status_value->setText(temp);
-    status_value->adjustSize();
+    this->sv = sv;
+    scheduleRefresh(RefreshSVs);
 }
 
 void GpsDisplayWidget::setDOP(double hdop, double vdop, double pdop)
 {
-    QString str;
-
-    str.sprintf("%.2f / %.2f / %.2f", hdop, vdop, pdop);
-    dop_value->setText(str);
+    this->hdop = hdop;
+    this->vdop = vdop;
+    this->pdop = pdop;
+    scheduleRefresh(RefreshDOP);
 }
 
 void GpsDisplayWidget::setPosition(double lat, double lon, double alt)
 {
-    // lat *= 1E-7;
-    // lon *= 1E-7;
-    double deg = floor(fabs(lat));
-    double min = (fabs(lat) - deg) * 60;
-    QString str1;
-
-    str1.sprintf("%.0f%c%.3f' ", deg, 0x00b0, min);
-    if (lat > 0) {
-        str1.append("N");
-    } else {
-        str1.append("S");
+    this->lat = lat;
+    this->lon = lon;
+    this->alt = alt;
+    scheduleRefresh(RefreshPosition);
+}
+
+/*
+ * Show the latest values received since the last refresh
+ */
+void GpsDisplayWidget::refresh()
+{
+    int parts = pendingRefresh;
+
+    pendingRefresh = 0;
+
+    if (parts & RefreshSpeedHeading) {
+        QString str;
+        speed_value->setText(str.sprintf("%.02f m/s", speed));
+        bear_value->setText(str.sprintf("%.02f deg", heading));
+    }
+
+    if (parts & RefreshDateTime) {
+        QString dstring1, dstring2;
+        dstring1.sprintf("%06.0f", date);
+        dstring1.insert(dstring1.length() - 2, ".");
+        dstring1.insert(dstring1.length() - 5, ".");
+        dstring2.sprintf("%06.0f", time);
+        dstring2.insert(dstring2.length() - 2, ":");
+        dstring2.insert(dstring2.length() - 5, ":");
+        time_value->setText(dstring1 + "    " + dstring2 + " GMT");
+    }
+
+    if (parts & RefreshFixType) {
+        if (fixType == "NoGPS") {
+            fix_value->setText("No GPS");
+        } else if (fixType == "NoFix") {
+            fix_value->setText("Fix not available");
+        } else if (fixType == "Fix2D") {
+            fix_value->setText("2D");
+        } else if (fixType == "Fix3D") {
+            fix_value->setText("3D");
+        } else {
+            fix_value->setText("Unknown");
+        }
     }
-    coord_value->setText(str1);
-    deg = floor(fabs(lon));
-    min = (fabs(lon) - deg) * 60;
-    QString str2;
-    str2.sprintf("%.0f%c%.3f' ", deg, 0x00b0, min);
-    if (lon > 0) {
-        str2.append("E");
-    } else {
-        str2.append("W");
+
+    if (parts & RefreshPackets) {
+        textBrowser->append(pendingPackets.join("\n"));
+        pendingPackets.clear();
+        // Keep the last MAX_PACKET_LINES lines
+        int extra = textBrowser->document()->lineCount() - MAX_PACKET_LINES;
+        if (extra > 0) {
+            QTextCursor tc = textBrowser->textCursor();
+            tc.movePosition(QTextCursor::Start);
+            tc.movePosition(QTextCursor::Down, QTextCursor::KeepAnchor, extra);
+            tc.movePosition(QTextCursor::StartOfLine, QTextCursor::KeepAnchor);
+            tc.removeSelectedText();
+        }
+    }
+
+    if (parts & RefreshSVs) {
+        status_value->setText(QString::number(sv));
+        status_value->adjustSize();
+    }
+
+    if (parts & RefreshDOP) {
+        QString str;
+        str.sprintf("%.2f / %.2f / %.2f", hdop, vdop, pdop);
+        dop_value->setText(str);
+    }
+
+    if (parts & RefreshPosition) {
+        // lat *= 1E-7;
+        // lon *= 1E-7;
+        double deg = floor(fabs(lat));
+        double min = (fabs(lat) - deg) * 60;
+        QString str1;
+
+        str1.sprintf("%.0f%c%.3f' ", deg, 0x00b0, min);
+        if (lat > 0) {
+            str1.append("N");
+        } else {
+            str1.append("S");
+        }
+        coord_value->setText(str1);
+        deg = floor(fabs(lon));
+        min = (fabs(lon) - deg) * 60;
+        QString str2;
+        str2.sprintf("%.0f%c%.3f' ", deg, 0x00b0, min);
+        if (lon > 0) {
+            str2.append("E");
+        } else {
+            str2.append("W");
+        }
+        coord_value_2->setText(str2);
+        QString str3;
+        str3.sprintf("%.2f m", alt);
+        coord_value_3->setText(str3);
+
+        // Now place the marker:
+        double wscale = flatEarth->sceneRect().width() / 360;
+        double hscale = flatEarth->sceneRect().height() / 180;
+        QPointF opd   = QPointF((lon + 180) * wscale - marker->boundingRect().width() * marker->scale() / 2,
+                                (90 - lat) * hscale - marker->boundingRect().height() * marker->scale() / 2);
+        marker->setTransform(QTransform::fromTranslate(opd.x(), opd.y()), false);
     }
-    coord_value_2->setText(str2);
-    QString str3;
-    str3.sprintf("%.2f m", alt);
-    coord_value_3->setText(str3);
-
-    // Now place the marker:
-    double wscale = flatEarth->sceneRect().width() / 360;
-    double hscale = flatEarth->sceneRect().height() / 180;
-    QPointF opd   = QPointF((lon + 180) * wscale - marker->boundingRect().width() * marker->scale() / 2,
-                            (90 - lat) * hscale - marker->boundingRect().height() * marker->scale() / 2);
-    marker->setTransform(QTransform::fromTranslate(opd.x(), opd.y()), false);
 }
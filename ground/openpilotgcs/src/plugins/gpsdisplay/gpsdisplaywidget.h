@@ -33,6 +33,7 @@
 #include "gpsconstellationwidget.h"
 #include "uavobject.h"
 #include <QGraphicsView>
+#include <QTimer>
 #include <QtSvg/QSvgRenderer>
 #include <QtSvg/QGraphicsSvgItem>
 
@@ -53,9 +54,32 @@ private slots:
     void dumpPacket(const QString &packet);
     void setFixType(const QString &fixtype);
     void setDOP(double hdop, double vdop, double pdop);
+    void refresh();
 
 private:
+    // Parts of the display with new values waiting for refresh()
+    enum {
+        RefreshSVs          = 0x01,
+        RefreshPosition     = 0x02,
+        RefreshDateTime     = 0x04,
+        RefreshSpeedHeading = 0x08,
+        RefreshFixType      = 0x10,
+        RefreshDOP          = 0x20,
+        RefreshPackets      = 0x40
+    };
+
+    void scheduleRefresh(int parts);
+
     GpsConstellationWidget *gpsConstellation;
     QGraphicsSvgItem *marker;
+    QTimer refreshTimer;
+    int pendingRefresh;
+    int sv;
+    double lat, lon, alt;
+    double date, time;
+    double speed, heading;
+    QString fixType;
+    double hdop, vdop, pdop;
+    QStringList pendingPackets;
 };
 #endif /* GPSDISPLAYWIDGET_H_ */
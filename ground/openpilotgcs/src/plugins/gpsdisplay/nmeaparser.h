@@ -31,11 +31,11 @@
 #include <QObject>
 #include <QtCore>
 #include <stdint.h>
-#include "buffer.h"
 #include "gpsparser.h"
 
 // constants/macros/typdefs
 #define NMEA_BUFFERSIZE 128
+#define NMEA_MAX_PARAMS 24 // GSV has 20 fields, GSA 18
 
 typedef struct struct_GpsData {
     double Latitude;
@@ -53,6 +53,12 @@ typedef struct struct_GpsData {
     double GPSdate;
 } GpsData_t;
 
+/**
+ * Parses a stream of NMEA sentences as it is received. The sentence is assembled in
+ * a fixed buffer, its checksum and field boundaries are tracked byte by byte, and the
+ * fields are terminated in place, so nothing is allocated besides the raw packet
+ * string that is emitted for display.
+ */
 class NMEAParser : public GPSParser {
     Q_OBJECT
 
@@ -60,23 +66,28 @@ public:
     NMEAParser(QObject *parent = 0);
     ~NMEAParser();
     void processInputStream(char c);
-    char *nmeaGetPacketBuffer(void);
-    char nmeaChecksum(char *gps_buffer);
-    void nmeaTerminateAtChecksum(char *gps_buffer);
-    uint8_t nmeaProcess(cBuffer *rxBuffer);
-    void nmeaProcessGPGGA(char *packet);
-    void nmeaProcessGPRMC(char *packet);
-    void nmeaProcessGPVTG(char *packet);
-    void nmeaProcessGPGSA(char *packet);
-    void nmeaProcessGPGSV(char *packet);
-    void nmeaProcessGPZDA(char *packet);
+    void nmeaProcess();
+    void nmeaProcessGPGGA();
+    void nmeaProcessGPRMC();
+    void nmeaProcessGPVTG();
+    void nmeaProcessGPGSA();
+    void nmeaProcessGPGSV();
+    void nmeaProcessGPZDA();
     GpsData_t GpsData;
-    cBuffer gpsRxBuffer;
-    char gpsRxData[512];
     char NmeaPacket[NMEA_BUFFERSIZE];
     uint32_t numUpdates;
     uint32_t numErrors;
     int32_t gpsRxOverflow;
+
+private:
+    const char *nmeaParam(int index) const;
+
+    int rxCount;
+    bool startFlag;
+    uint8_t checksum;
+    int starPos; // position of the '*' checksum marker, 0 while not found
+    int nbParams;
+    char *params[NMEA_MAX_PARAMS];
 };
 
 #endif // NMEAPARSER_H
@@ -81,7 +81,7 @@ HITLConfiguration::HITLConfiguration(QString classId, QSettings *qSettings, QObj
         settings.latitude      = qSettings->value("latitude").toString();
         settings.longitude     = qSettings->value("longitude").toString();
         settings.startSim      = qSettings->value("startSim").toBool();
-        settings.addNoise      = qSettings->value("noiseCheckBox").toBool();
+        settings.addNoise      = qSettings->value("addNoise").toBool();
 
         settings.gcsReceiverEnabled   = qSettings->value("gcsReceiverEnabled").toBool();
         settings.manualControlEnabled = qSettings->value("manualControlEnabled").toBool();
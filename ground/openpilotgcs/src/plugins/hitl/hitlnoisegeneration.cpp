@@ -26,17 +26,137 @@
  */
 
 #include "hitlnoisegeneration.h"
+#include <math.h>
 
+// Standard deviations of the simulated sensor noise
+#define ACCEL_SIGMA       0.1f  // m/s^2
+#define GYRO_SIGMA        0.5f  // deg/s
+#define ATTITUDE_SIGMA    0.2f  // deg
+#define BARO_ALT_SIGMA    0.3f  // m
+#define BARO_PRESS_SIGMA  0.004f // kPa
+#define GPS_LATLON_SIGMA  135.0f // 1e-7 deg, about 1.5m
+#define GPS_ALT_SIGMA     3.0f  // m
+#define GPS_SPEED_SIGMA   0.1f  // m/s
+#define GPS_HEADING_SIGMA 1.0f  // deg
+#define VELOCITY_SIGMA    0.05f // m/s
+#define POSITION_SIGMA    0.5f  // m
+#define AIRSPEED_SIGMA    0.5f  // m/s
 
-HitlNoiseGeneration::HitlNoiseGeneration()
+// Ziggurat constants for 128 layers (Marsaglia & Tsang)
+#define ZIGGURAT_R        3.442619855899
+#define ZIGGURAT_V        9.91256303526217e-3
+
+quint32 HitlNoiseGeneration::kn[ZIGGURAT_LAYERS];
+float HitlNoiseGeneration::wn[ZIGGURAT_LAYERS];
+float HitlNoiseGeneration::fn[ZIGGURAT_LAYERS];
+bool HitlNoiseGeneration::tablesReady = false;
+
+HitlNoiseGeneration::HitlNoiseGeneration(quint32 seed)
 {
     memset(&noise, 0, sizeof(Noise));
+    setupTables();
+    this->seed(seed);
 }
 
 
 HitlNoiseGeneration::~HitlNoiseGeneration()
 {}
 
+/**
+ * Build the Ziggurat tables, once for all instances
+ */
+void HitlNoiseGeneration::setupTables()
+{
+    if (tablesReady) {
+        return;
+    }
+
+    const double m1 = 2147483648.0;
+    double dn = ZIGGURAT_R;
+    double tn = dn;
+    double q  = ZIGGURAT_V / exp(-0.5 * dn * dn);
+
+    kn[0] = (quint32)((dn / q) * m1);
+    kn[1] = 0;
+    wn[0] = q / m1;
+    wn[ZIGGURAT_LAYERS - 1] = dn / m1;
+    fn[0] = 1.0f;
+    fn[ZIGGURAT_LAYERS - 1] = exp(-0.5 * dn * dn);
+
+    for (int i = ZIGGURAT_LAYERS - 2; i >= 1; i--) {
+        dn        = sqrt(-2.0 * log(ZIGGURAT_V / dn + exp(-0.5 * dn * dn)));
+        kn[i + 1] = (quint32)((dn / tn) * m1);
+        tn        = dn;
+        fn[i]     = exp(-0.5 * dn * dn);
+        wn[i]     = dn / m1;
+    }
+    tablesReady = true;
+}
+
+void HitlNoiseGeneration::seed(quint32 seed)
+{
+    // xorshift must not start from 0
+    state    = seed ? seed : DEFAULT_SEED;
+    batchPos = BATCH_SIZE;
+}
+
+quint32 HitlNoiseGeneration::random()
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+float HitlNoiseGeneration::uniform()
+{
+    return 0.5f + (qint32)random() * 0.2328306e-9f;
+}
+
+/**
+ * Slow path of the Ziggurat, taken for a few percent of the samples
+ */
+float HitlNoiseGeneration::tail(qint32 hz, int iz)
+{
+    for (;;) {
+        float x = hz * wn[iz];
+        if (iz == 0) {
+            float y;
+            do {
+                x = -logf(uniform()) * (float)(1.0 / ZIGGURAT_R);
+                y = -logf(uniform());
+            } while (y + y < x * x);
+            return (hz > 0) ? (float)ZIGGURAT_R + x : -(float)ZIGGURAT_R - x;
+        }
+        if (fn[iz] + uniform() * (fn[iz - 1] - fn[iz]) < expf(-0.5f * x * x)) {
+            return x;
+        }
+        hz = (qint32)random();
+        iz = hz & (ZIGGURAT_LAYERS - 1);
+        if ((quint32)qAbs((qint64)hz) < kn[iz]) {
+            return hz * wn[iz];
+        }
+    }
+}
+
+void HitlNoiseGeneration::fillBatch()
+{
+    for (int i = 0; i < BATCH_SIZE; i++) {
+        qint32 hz = (qint32)random();
+        int iz    = hz & (ZIGGURAT_LAYERS - 1);
+        batch[i] = ((quint32)qAbs((qint64)hz) < kn[iz]) ? hz * wn[iz] : tail(hz, iz);
+    }
+    batchPos = 0;
+}
+
+float HitlNoiseGeneration::gaussian(float sigma)
+{
+    if (batchPos >= BATCH_SIZE) {
+        fillBatch();
+    }
+    return sigma * batch[batchPos++];
+}
+
 Noise HitlNoiseGeneration::getNoise()
 {
     return noise;
@@ -44,35 +164,41 @@ Noise HitlNoiseGeneration::getNoise()
 
 Noise HitlNoiseGeneration::generateNoise()
 {
-    noise.accelStateData.x       = 0;
-    noise.accelStateData.y       = 0;
-    noise.accelStateData.z       = 0;
+    noise.accelStateData.x       = gaussian(ACCEL_SIGMA);
+    noise.accelStateData.y       = gaussian(ACCEL_SIGMA);
+    noise.accelStateData.z       = gaussian(ACCEL_SIGMA);
+
+    noise.gpsPosData.Latitude    = (qint32)gaussian(GPS_LATLON_SIGMA);
+    noise.gpsPosData.Longitude   = (qint32)gaussian(GPS_LATLON_SIGMA);
+    noise.gpsPosData.Groundspeed = gaussian(GPS_SPEED_SIGMA);
+    noise.gpsPosData.Heading     = gaussian(GPS_HEADING_SIGMA);
+    noise.gpsPosData.Altitude    = gaussian(GPS_ALT_SIGMA);
 
-    noise.gpsPosData.Latitude    = 0;
-    noise.gpsPosData.Longitude   = 0;
-    noise.gpsPosData.Groundspeed = 0;
-    noise.gpsPosData.Heading     = 0;
-    noise.gpsPosData.Altitude    = 0;
+    noise.gpsVelData.North       = gaussian(GPS_SPEED_SIGMA);
+    noise.gpsVelData.East = gaussian(GPS_SPEED_SIGMA);
+    noise.gpsVelData.Down = gaussian(GPS_SPEED_SIGMA);
 
-    noise.gpsVelData.North       = 0;
-    noise.gpsVelData.East = 0;
-    noise.gpsVelData.Down = 0;
+    noise.baroAltData.Altitude = gaussian(BARO_ALT_SIGMA);
+    noise.baroAltData.Pressure = gaussian(BARO_PRESS_SIGMA);
 
-    noise.baroAltData.Altitude = 0;
+    noise.attStateData.Roll    = gaussian(ATTITUDE_SIGMA);
+    noise.attStateData.Pitch   = gaussian(ATTITUDE_SIGMA);
+    noise.attStateData.Yaw     = gaussian(ATTITUDE_SIGMA);
 
-    noise.attStateData.Roll    = 0;
-    noise.attStateData.Pitch   = 0;
-    noise.attStateData.Yaw     = 0;
+    noise.gyroStateData.x  = gaussian(GYRO_SIGMA);
+    noise.gyroStateData.y  = gaussian(GYRO_SIGMA);
+    noise.gyroStateData.z  = gaussian(GYRO_SIGMA);
 
-    noise.gyroStateData.x  = 0;
-    noise.gyroStateData.y  = 0;
-    noise.gyroStateData.z  = 0;
+    noise.velocityStateData.North = gaussian(VELOCITY_SIGMA);
+    noise.velocityStateData.East  = gaussian(VELOCITY_SIGMA);
+    noise.velocityStateData.Down  = gaussian(VELOCITY_SIGMA);
 
-    noise.accelStateData.x = 0;
-    noise.accelStateData.y = 0;
-    noise.accelStateData.z = 0;
+    noise.positionStateData.North = gaussian(POSITION_SIGMA);
+    noise.positionStateData.East  = gaussian(POSITION_SIGMA);
+    noise.positionStateData.Down  = gaussian(POSITION_SIGMA);
 
-    noise.airspeedState.CalibratedAirspeed = 0;
+    noise.airspeedState.CalibratedAirspeed = gaussian(AIRSPEED_SIGMA);
+    noise.airspeedState.TrueAirspeed = gaussian(AIRSPEED_SIGMA);
 
     return noise;
 }
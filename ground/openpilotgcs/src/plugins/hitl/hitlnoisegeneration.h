@@ -52,14 +52,38 @@ struct Noise {
 class HitlNoiseGeneration {
 // Q_OBJECT
 public:
-    HitlNoiseGeneration();
+    // Fixed default seed so runs with noise are reproducible
+    static const quint32 DEFAULT_SEED = 0x4f504e5au;
+
+    HitlNoiseGeneration(quint32 seed = DEFAULT_SEED);
     ~HitlNoiseGeneration();
 
+    void seed(quint32 seed);
     Noise getNoise();
     Noise generateNoise();
 private slots:
 
 private:
+    // Gaussian samples are made in batches from precomputed Ziggurat tables
+    static const int ZIGGURAT_LAYERS = 128;
+    static const int BATCH_SIZE = 256;
+
+    static quint32 kn[ZIGGURAT_LAYERS];
+    static float wn[ZIGGURAT_LAYERS];
+    static float fn[ZIGGURAT_LAYERS];
+    static bool tablesReady;
+    static void setupTables();
+
+    quint32 state;
+    float batch[BATCH_SIZE];
+    int batchPos;
+
+    inline quint32 random();
+    inline float uniform();
+    float tail(qint32 hz, int iz);
+    void fillBatch();
+    inline float gaussian(float sigma);
+
     Noise noise;
 };
 #endif // HITLNOISEGENERATION_H
@@ -57,7 +57,8 @@ Simulator::Simulator(const SimulatorSettings & params) :
     simConnectionStatus(false),
     txTimer(NULL),
     simTimer(NULL),
-    name("")
+    name(""),
+    noiseSource(new HitlNoiseGeneration())
 {
     // move to thread
     moveToThread(Core::ICore::instance()->threadManager()->getRealTimeThread());
@@ -105,6 +106,10 @@ Simulator::~Simulator()
         delete simTimer;
         simTimer = NULL;
     }
+
+    delete noiseSource;
+    noiseSource = NULL;
+
     // NOTE: Does not currently work, may need to send control+c to through the terminal
     if (simProcess != NULL) {
         // connect(simProcess,SIGNAL(finished(int, QProcess::ExitStatus)),this,SLOT(onFinished(int, QProcess::ExitStatus)));
@@ -392,10 +397,9 @@ void Simulator::updateUAVOs(Output2Hardware out)
     QTime currentTime = QTime::currentTime();
 
     Noise noise;
-    HitlNoiseGeneration noiseSource;
 
     if (settings.addNoise) {
-        noise = noiseSource.generateNoise();
+        noise = noiseSource->generateNoise();
     } else {
         memset(&noise, 0, sizeof(Noise));
     }
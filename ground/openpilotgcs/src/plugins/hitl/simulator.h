@@ -61,6 +61,8 @@
 #include <QProcess>
 #include <qmath.h>
 
+class HitlNoiseGeneration;
+
 /**
  * just imagine this was a class without methods and all public properties
  */
@@ -374,6 +376,9 @@ private:
     void setupObjects();
 
     AirParameters airParameters;
+
+    // Kept for the whole run so the noise sequence is reproducible
+    HitlNoiseGeneration *noiseSource;
 };
 
 
@@ -2,6 +2,10 @@
 #define IPCONNECTION_INTERNAL_H
 
 #include "ipconnectionplugin.h"
+#include <QtNetwork/QAbstractSocket>
+#include <QIODevice>
+#include <QList>
+#include <QByteArray>
 
 // Simple class for creating & destroying a socket in the real-time thread
 // Needed because sockets need to be created in the same thread that they're used
@@ -16,7 +20,55 @@ public:
 public slots:
 
     void onOpenDevice(QString HostName, int Port, bool UseTCP);
-    void onCloseDevice(QAbstractSocket *ipSocket);
+    void onCloseDevice(QIODevice *ipDevice);
+
+signals:
+    // The connection could not be established, emitted asynchronously after onOpenDevice()
+    void openFailed(QString errorMsg);
+
+private slots:
+    void onSocketConnected();
+    void onSocketError(QAbstractSocket::SocketError error);
+};
+
+// Batches the datagrams of a connected UDP socket so UAVTalk can treat it as a stream.
+// All the datagrams pending when the socket becomes readable are read at once, and the
+// frames written during one event loop iteration are coalesced into as few datagrams as
+// possible. Each write is one UAVTalk frame and frames are never split across datagrams.
+class IPDatagramDevice : public QIODevice {
+    Q_OBJECT
+
+public:
+    IPDatagramDevice(QUdpSocket *socket, QObject *parent);
+
+    QUdpSocket *socket() const
+    {
+        return m_socket;
+    }
+
+    bool isSequential() const
+    {
+        return true;
+    }
+    qint64 bytesAvailable() const;
+    qint64 bytesToWrite() const;
+    void close();
+
+protected:
+    qint64 readData(char *data, qint64 maxSize);
+    qint64 writeData(const char *data, qint64 maxSize);
+
+private slots:
+    void socketReadyRead();
+    void flushOutput();
+
+private:
+    QUdpSocket *m_socket;
+    QByteArray m_rxBuffer;
+    // Datagrams waiting to be sent, the last one is still being filled
+    QList<QByteArray> m_txDatagrams;
+    qint64 m_txBytes;
+    bool m_flushPending;
 };
 
 #endif // IPCONNECTION_INTERNAL_H
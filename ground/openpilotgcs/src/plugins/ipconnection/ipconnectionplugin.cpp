@@ -32,6 +32,7 @@
 
 #include <extensionsystem/pluginmanager.h>
 #include <coreplugin/icore.h>
+#include <coreplugin/connectionmanager.h>
 #include "ipconnection_internal.h"
 
 #include <QtCore/QtPlugin>
@@ -42,17 +43,21 @@
 #include <QtNetwork/QUdpSocket>
 #include <QWaitCondition>
 #include <QMutex>
+#include <QTimer>
 #include <coreplugin/threadmanager.h>
 
 #include <QDebug>
 
+// Largest datagram sent, small enough to never be fragmented on usual links
+#define UDP_MAX_DATAGRAM 1400
+
 // Communication between IPconnectionConnection::OpenDevice() and IPConnection::onOpenDevice()
 QString errorMsg;
 QWaitCondition openDeviceWait;
 QWaitCondition closeDeviceWait;
 // QReadWriteLock dummyLock;
 QMutex ipConMutex;
-QAbstractSocket *ret;
+QIODevice *ret;
 
 IPConnection::IPConnection(IPconnectionConnection *connection) : QObject()
 {
@@ -60,8 +65,10 @@ IPConnection::IPConnection(IPconnectionConnection *connection) : QObject()
 
     QObject::connect(connection, SIGNAL(CreateSocket(QString, int, bool)),
                      this, SLOT(onOpenDevice(QString, int, bool)));
-    QObject::connect(connection, SIGNAL(CloseSocket(QAbstractSocket *)),
-                     this, SLOT(onCloseDevice(QAbstractSocket *)));
+    QObject::connect(connection, SIGNAL(CloseSocket(QIODevice *)),
+                     this, SLOT(onCloseDevice(QIODevice *)));
+    QObject::connect(this, SIGNAL(openFailed(QString)),
+                     connection, SLOT(onOpenFailed(QString)));
 }
 
 /*IPConnection::~IPConnection()
@@ -71,49 +78,147 @@ IPConnection::IPConnection(IPconnectionConnection *connection) : QObject()
 
 void IPConnection::onOpenDevice(QString HostName, int Port, bool UseTCP)
 {
-    QAbstractSocket *ipSocket;
-    const int Timeout = 5 * 1000;
-
     ipConMutex.lock();
-    if (UseTCP) {
-        ipSocket = new QTcpSocket(this);
-    } else {
-        ipSocket = new QUdpSocket(this);
-    }
 
     // do sanity check on hostname and port...
     if ((HostName.length() == 0) || (Port < 1)) {
         errorMsg = "Please configure Host and Port options before opening the connection";
+        ret = NULL;
+        openDeviceWait.wakeAll();
+        ipConMutex.unlock();
+        return;
+    }
+
+    QAbstractSocket *ipSocket;
+    if (UseTCP) {
+        ipSocket = new QTcpSocket(this);
+        ret = ipSocket;
     } else {
-        // try to connect...
-        ipSocket->connectToHost(HostName, Port);
-
-        // in blocking mode so we wait for the connection to succeed
-        if (ipSocket->waitForConnected(Timeout)) {
-            ret = ipSocket;
-            openDeviceWait.wakeAll();
-            ipConMutex.unlock();
-            return;
-        }
-        // tell user something went wrong
-        errorMsg = ipSocket->errorString();
+        QUdpSocket *udpSocket = new QUdpSocket();
+        ipSocket = udpSocket;
+        ret = new IPDatagramDevice(udpSocket, this);
     }
-    /* BUGBUG TODO - returning null here leads to segfault because some caller still calls disconnect without checking our return value properly
-     * someone needs to debug this, I got lost in the calling chain.*/
-    ret = NULL;
+
+    // Connect asynchronously, the socket is usable right away: TCP buffers what is written
+    // until the connection is established and the datagram device holds back its datagrams.
+    // A failure is reported to the GUI thread with openFailed().
+    connect(ipSocket, SIGNAL(connected()), this, SLOT(onSocketConnected()));
+    connect(ipSocket, SIGNAL(error(QAbstractSocket::SocketError)), this, SLOT(onSocketError(QAbstractSocket::SocketError)));
+    ipSocket->connectToHost(HostName, Port);
+
     openDeviceWait.wakeAll();
     ipConMutex.unlock();
 }
 
-void IPConnection::onCloseDevice(QAbstractSocket *ipSocket)
+void IPConnection::onCloseDevice(QIODevice *ipDevice)
 {
     ipConMutex.lock();
-    ipSocket->close();
-    delete (ipSocket);
+    ipDevice->close();
+    delete (ipDevice);
     closeDeviceWait.wakeAll();
     ipConMutex.unlock();
 }
 
+void IPConnection::onSocketConnected()
+{
+    // Errors once connected are handled by the telemetry timeouts, as for the other connections
+    QAbstractSocket *ipSocket = qobject_cast<QAbstractSocket *>(sender());
+
+    disconnect(ipSocket, SIGNAL(error(QAbstractSocket::SocketError)), this, SLOT(onSocketError(QAbstractSocket::SocketError)));
+}
+
+void IPConnection::onSocketError(QAbstractSocket::SocketError error)
+{
+    Q_UNUSED(error);
+    QAbstractSocket *ipSocket = qobject_cast<QAbstractSocket *>(sender());
+
+    disconnect(ipSocket, SIGNAL(error(QAbstractSocket::SocketError)), this, SLOT(onSocketError(QAbstractSocket::SocketError)));
+    emit openFailed(ipSocket->errorString());
+}
+
+
+IPDatagramDevice::IPDatagramDevice(QUdpSocket *socket, QObject *parent) : QIODevice(parent),
+    m_socket(socket), m_txBytes(0), m_flushPending(false)
+{
+    m_socket->setParent(this);
+    connect(m_socket, SIGNAL(readyRead()), this, SLOT(socketReadyRead()));
+    // Datagrams written while the host name is being looked up are sent once connected
+    connect(m_socket, SIGNAL(connected()), this, SLOT(flushOutput()));
+    setOpenMode(QIODevice::ReadWrite);
+}
+
+qint64 IPDatagramDevice::bytesAvailable() const
+{
+    return m_rxBuffer.size() + QIODevice::bytesAvailable();
+}
+
+qint64 IPDatagramDevice::bytesToWrite() const
+{
+    return m_txBytes;
+}
+
+void IPDatagramDevice::close()
+{
+    m_rxBuffer.clear();
+    m_txDatagrams.clear();
+    m_txBytes = 0;
+    m_socket->close();
+    QIODevice::close();
+}
+
+qint64 IPDatagramDevice::readData(char *data, qint64 maxSize)
+{
+    qint64 size = qMin(maxSize, (qint64)m_rxBuffer.size());
+
+    memcpy(data, m_rxBuffer.constData(), size);
+    m_rxBuffer.remove(0, size);
+    return size;
+}
+
+qint64 IPDatagramDevice::writeData(const char *data, qint64 maxSize)
+{
+    if (m_txDatagrams.isEmpty() || m_txDatagrams.last().size() + maxSize > UDP_MAX_DATAGRAM) {
+        m_txDatagrams.append(QByteArray());
+    }
+    m_txDatagrams.last().append(data, maxSize);
+    m_txBytes += maxSize;
+
+    // Send everything written during this event loop iteration together
+    if (!m_flushPending) {
+        m_flushPending = true;
+        QTimer::singleShot(0, this, SLOT(flushOutput()));
+    }
+    return maxSize;
+}
+
+void IPDatagramDevice::socketReadyRead()
+{
+    // Drain the socket, one readyRead() is emitted for all the datagrams
+    while (m_socket->hasPendingDatagrams()) {
+        int offset = m_rxBuffer.size();
+        m_rxBuffer.resize(offset + m_socket->pendingDatagramSize());
+        qint64 size = m_socket->readDatagram(m_rxBuffer.data() + offset, m_rxBuffer.size() - offset);
+        m_rxBuffer.resize(offset + qMax(size, (qint64)0));
+    }
+    if (!m_rxBuffer.isEmpty()) {
+        emit readyRead();
+    }
+}
+
+void IPDatagramDevice::flushOutput()
+{
+    m_flushPending = false;
+    if (m_socket->state() != QAbstractSocket::ConnectedState) {
+        return;
+    }
+    foreach(const QByteArray &datagram, m_txDatagrams) {
+        m_socket->write(datagram);
+        emit bytesWritten(datagram.size());
+    }
+    m_txDatagrams.clear();
+    m_txBytes = 0;
+}
+
 
 IPConnection *connection = 0;
 
@@ -205,6 +310,15 @@ QIODevice *IPconnectionConnection::openDevice(const QString &)
     return ipSocket;
 }
 
+void IPconnectionConnection::onOpenFailed(QString errorMsg)
+{
+    Core::ICore::instance()->connectionManager()->disconnectDevice();
+
+    QMessageBox msgBox;
+    msgBox.setText(errorMsg);
+    msgBox.exec();
+}
+
 void IPconnectionConnection::closeDevice(const QString &)
 {
     if (ipSocket) {
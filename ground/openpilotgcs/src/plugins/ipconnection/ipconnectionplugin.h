@@ -35,7 +35,7 @@
 #include <extensionsystem/iplugin.h>
 // #include <QtCore/QSettings>
 
-class QAbstractSocket;
+class QIODevice;
 class QTcpSocket;
 class QUdpSocket;
 
@@ -71,13 +71,14 @@ public:
 
 protected slots:
     void onEnumerationChanged();
+    void onOpenFailed(QString errorMsg);
 
 signals: // For the benefit of IPConnection
     void CreateSocket(QString HostName, int Port, bool UseTCP);
-    void CloseSocket(QAbstractSocket *socket);
+    void CloseSocket(QIODevice *socket);
 
 private:
-    QAbstractSocket *ipSocket;
+    QIODevice *ipSocket;
     IPconnectionConfiguration *m_config;
     IPconnectionOptionsPage *m_optionspage;
     // QSettings* settings;
@@ -78,7 +78,7 @@ void LineardialGadgetWidget::enableOpenGL(bool flag)
 void LineardialGadgetWidget::connectInput(QString object1, QString nfield1)
 {
     if (obj1 != NULL) {
-        disconnect(obj1, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(updateIndex(UAVObject *)));
+        disconnect(obj1, SIGNAL(objectUpdatedCoalesced(UAVObject *)), this, SLOT(updateIndex(UAVObject *)));
     }
     ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
     UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
@@ -89,7 +89,7 @@ void LineardialGadgetWidget::connectInput(QString object1, QString nfield1)
     if (!(object1.isEmpty() || nfield1.isEmpty())) {
         obj1 = dynamic_cast<UAVDataObject *>(objManager->getObject(object1));
         if (obj1 != NULL) {
-            connect(obj1, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(updateIndex(UAVObject *)));
+            connect(obj1, SIGNAL(objectUpdatedCoalesced(UAVObject *)), this, SLOT(updateIndex(UAVObject *)));
             if (nfield1.contains("-")) {
                 QStringList fieldSubfield = nfield1.split("-", QString::SkipEmptyParts);
                 field1        = fieldSubfield.at(0);
@@ -58,6 +58,10 @@ void LoggingGadgetWidget::setPlugin(LoggingPlugin *p)
     connect(m_logging->pauseButton, SIGNAL(clicked()), p->getLogfile(), SLOT(pauseReplay()));
     connect(m_logging->pauseButton, SIGNAL(clicked()), scpPlugin, SLOT(stopPlotting()));
     connect(m_logging->playbackSpeed, SIGNAL(valueChanged(double)), p->getLogfile(), SLOT(setReplaySpeed(double)));
+    connect(m_logging->replayPosition, SIGNAL(sliderMoved(int)), p->getLogfile(), SLOT(setReplayTime(int)));
+    connect(p->getLogfile(), SIGNAL(replayTimeChanged(int)), this, SLOT(replayTimeChanged(int)));
+    connect(p->getLogfile(), SIGNAL(replayStarted()), this, SLOT(replayStarted()));
+    connect(p->getLogfile(), SIGNAL(replayFinished()), this, SLOT(replayFinished()));
     void pauseReplay();
     void resumeReplay();
 }
@@ -68,6 +72,26 @@ void LoggingGadgetWidget::stateChanged(QString status)
     m_logging->statusLabel->setText(status);
 }
 
+void LoggingGadgetWidget::replayStarted()
+{
+    m_logging->replayPosition->setRange(loggingPlugin->getLogfile()->replayStartTime(), loggingPlugin->getLogfile()->replayEndTime());
+    m_logging->replayPosition->setValue(loggingPlugin->getLogfile()->replayStartTime());
+    m_logging->replayPosition->setEnabled(true);
+}
+
+void LoggingGadgetWidget::replayFinished()
+{
+    m_logging->replayPosition->setEnabled(false);
+}
+
+void LoggingGadgetWidget::replayTimeChanged(int time)
+{
+    // don't fight the user while the slider is being dragged
+    if (!m_logging->replayPosition->isSliderDown()) {
+        m_logging->replayPosition->setValue(time);
+    }
+}
+
 /**
  * @}
  * @}
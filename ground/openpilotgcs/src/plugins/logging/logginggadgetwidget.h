@@ -47,6 +47,9 @@ public:
 
 protected slots:
     void stateChanged(QString status);
+    void replayStarted();
+    void replayFinished();
+    void replayTimeChanged(int time);
 
 signals:
     void pause();
@@ -37,7 +37,9 @@
 #include <QFileDialog>
 #include <QList>
 #include <QErrorMessage>
+#include <QReadLocker>
 #include <QWriteLocker>
+#include <QSettings>
 
 #include <extensionsystem/pluginmanager.h>
 #include <QKeySequence>
@@ -121,14 +123,27 @@ LoggingThread::~LoggingThread()
 
 /**
  * Sets the file to use for logging and takes the parent plugin
- * to connect to stop logging signal
+ * to connect to stop logging signal.
+ * Updates are queued and written by the log file writer thread, the
+ * Logging/WritePolicy and Logging/SyncInterval settings select how
+ * (see LogFile::WritePolicy).
  * @param[in] file File name to write to
  * @param[in] parent plugin
  */
 bool LoggingThread::openFile(QString file, LoggingPlugin *parent)
 {
+    QSettings *settings = Core::ICore::instance()->settings();
+
+    settings->beginGroup("Logging");
+    LogFile::WritePolicy policy = (LogFile::WritePolicy)settings->value("WritePolicy", LogFile::WriteBatched).toInt();
+    int syncInterval = settings->value("SyncInterval", LogFile::DEFAULT_SYNC_INTERVAL).toInt();
+    settings->endGroup();
+
     logFile.setFileName(file);
-    logFile.open(QIODevice::WriteOnly);
+    logFile.setWritePolicy(policy, syncInterval);
+    if (!logFile.open(QIODevice::WriteOnly)) {
+        return false;
+    }
 
     ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
     UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
@@ -147,7 +162,8 @@ bool LoggingThread::openFile(QString file, LoggingPlugin *parent)
  */
 void LoggingThread::objectUpdated(UAVObject *obj)
 {
-    QWriteLocker locker(&lock);
+    // Only keeps stopLogging() out, the log file queues the update itself
+    QReadLocker locker(&lock);
 
     if (!uavTalk->sendObject(obj, false, false)) {
         qDebug() << "Error logging " << obj->getName();
@@ -225,6 +241,7 @@ void LoggingThread::retrieveSettings()
 {
     // Clear object queue
     queue.clear();
+    pending.clear();
     // Get all objects, add metaobjects, settings and data objects with OnChange update mode to the queue
     // Get UAVObjectManager instance
     ExtensionSystem::PluginManager *pm   = ExtensionSystem::PluginManager::instance();
@@ -244,21 +261,27 @@ void LoggingThread::retrieveSettings()
 
 
 /**
- * Retrieve the next object in the queue
+ * Retrieve the next objects in the queue, keeping up to
+ * MAX_PENDING_REQUESTS requests outstanding.
  */
 void LoggingThread::retrieveNextObject()
 {
     // If queue is empty return
     if (queue.isEmpty()) {
-        qDebug() << "Logging: Object retrieval completed";
+        if (pending.isEmpty()) {
+            qDebug() << "Logging: Object retrieval completed";
+        }
         return;
     }
-    // Get next object from the queue
-    UAVObject *obj = queue.dequeue();
-    // Connect to object
-    connect(obj, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(transactionCompleted(UAVObject *, bool)));
-    // Request update
-    obj->requestUpdate();
+    while (!queue.isEmpty() && pending.size() < MAX_PENDING_REQUESTS) {
+        // Get next object from the queue
+        UAVObject *obj = queue.dequeue();
+        // Connect to object
+        connect(obj, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(transactionCompleted(UAVObject *, bool)));
+        // Request update
+        pending.insert(obj);
+        obj->requestUpdate();
+    }
 }
 
 /**
@@ -268,7 +291,10 @@ void LoggingThread::transactionCompleted(UAVObject *obj, bool success)
 {
     Q_UNUSED(success);
     // Disconnect from sending object
-    obj->disconnect(this);
+    disconnect(obj, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(transactionCompleted(UAVObject *, bool)));
+    if (!pending.remove(obj)) {
+        return;
+    }
     // Process next object if telemetry is still available
     // Get stats objects
     ExtensionSystem::PluginManager *pm     = ExtensionSystem::PluginManager::instance();
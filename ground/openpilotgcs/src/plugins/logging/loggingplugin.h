@@ -39,6 +39,7 @@
 
 #include <QThread>
 #include <QQueue>
+#include <QSet>
 #include <QReadWriteLock>
 
 class LoggingPlugin;
@@ -108,7 +109,10 @@ protected:
     UAVTalk *uavTalk;
 
 private:
+    static const int MAX_PENDING_REQUESTS = 8;
+
     QQueue<UAVDataObject *> queue;
+    QSet<UAVObject *> pending;
 
     void retrieveSettings();
     void retrieveNextObject();
@@ -29,6 +29,7 @@
     #include "OpenGL/OpenGL.h"
 #endif
 #include "modelviewgadgetwidget.h"
+#include "modelviewloader.h"
 #include "extensionsystem/pluginmanager.h"
 #include "glc_context.h"
 #include "glc_exception.h"
@@ -37,8 +38,22 @@
 
 #include <iostream>
 
+// The model is redrawn at most at this period, buffer swaps are synchronised
+// with the display refresh so a redraw never takes less than a frame
+#define RENDER_PERIOD_MS 16
+// Samples further apart than this are not interpolated, the model jumps to the latest one
+#define MAX_INTERPOLATION_MS 1000
+
+static QGLFormat modelViewFormat()
+{
+    QGLFormat format(QGL::SampleBuffers);
+
+    format.setSwapInterval(1);
+    return format;
+}
+
 ModelViewGadgetWidget::ModelViewGadgetWidget(QWidget *parent)
-    : QGLWidget(new GLC_Context(QGLFormat(QGL::SampleBuffers)), parent)
+    : QGLWidget(new GLC_Context(modelViewFormat()), parent)
     , m_Light()
     , m_World()
     , m_GlView()
@@ -48,6 +63,9 @@ ModelViewGadgetWidget::ModelViewGadgetWidget(QWidget *parent)
     , acFilename()
     , bgFilename()
     , vboEnable(false)
+    , m_prevSampleTime(0)
+    , m_lastSampleTime(0)
+    , m_renderedAttitude(0.0f, 0.0f, 0.0f, 0.0f)
 {
     connect(&m_GlView, SIGNAL(updateOpenGL()), this, SLOT(updateGL()));
     setSizePolicy(QSizePolicy::MinimumExpanding, QSizePolicy::MinimumExpanding);
@@ -63,17 +81,32 @@ ModelViewGadgetWidget::ModelViewGadgetWidget(QWidget *parent)
     repColor.setRgbF(1.0, 0.11372, 0.11372, 0.0);
     m_MoverController = GLC_Factory::instance()->createDefaultMoverController(repColor, &m_GlView);
 
+    m_loader = new ModelViewLoader();
+    m_loader->moveToThread(&m_loaderThread);
+    connect(&m_loaderThread, &QThread::finished, m_loader, &QObject::deleteLater);
+    connect(this, SIGNAL(loadModel(QString)), m_loader, SLOT(load(QString)));
+    connect(m_loader, SIGNAL(loaded(QString, GLC_World *)), this, SLOT(modelLoaded(QString, GLC_World *)));
+    m_loaderThread.start(QThread::LowPriority);
+
     CreateScene();
     // Get required UAVObjects
     ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
     UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
     attState = AttitudeState::GetInstance(objManager);
 
+    connect(attState, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(attitudeUpdated(UAVObject *)));
+    m_clock.start();
+    attitudeUpdated(attState);
+
+    m_MotionTimer.setTimerType(Qt::PreciseTimer);
     connect(&m_MotionTimer, SIGNAL(timeout()), this, SLOT(updateAttitude()));
 }
 
 ModelViewGadgetWidget::~ModelViewGadgetWidget()
-{}
+{
+    m_loaderThread.quit();
+    m_loaderThread.wait();
+}
 
 
 void ModelViewGadgetWidget::setAcFilename(QString acf)
@@ -126,7 +159,7 @@ void ModelViewGadgetWidget::initializeGL()
     // Enable antialiasing
     glEnable(GL_MULTISAMPLE);
 
-    m_MotionTimer.start(100);
+    m_MotionTimer.start(RENDER_PERIOD_MS);
     setFocusPolicy(Qt::StrongFocus); // keyboard capture for camera switching
 }
 
@@ -197,18 +230,35 @@ void ModelViewGadgetWidget::CreateScene()
         qDebug("ModelView: background image file loading failed.");
     }
 
-    try {
-        if (QFile::exists(acFilename)) {
-            QFile aircraft(acFilename);
-            m_World = GLC_Factory::instance()->createWorldFromFile(aircraft);
-            m_ModelBoundingBox = m_World.boundingBox();
-            m_GlView.reframe(m_ModelBoundingBox); // center 3D model in the scene
-        } else {
-            qDebug("ModelView: aircraft file not found.");
-        }
-    } catch(GLC_Exception e) {
+    // The current model stays in view until the new one is loaded
+    if (QFile::exists(acFilename)) {
+        emit loadModel(acFilename);
+    } else {
+        qDebug("ModelView: aircraft file not found.");
+    }
+}
+
+void ModelViewGadgetWidget::modelLoaded(QString fileName, GLC_World *world)
+{
+    if (!world) {
         qDebug("ModelView: aircraft file loading failed.");
+        return;
+    }
+    // Superseded by a later configuration change
+    if (fileName != acFilename) {
+        delete world;
+        return;
     }
+
+    m_World = *world;
+    delete world;
+    m_World.collection()->setVboUsage(vboEnable);
+    m_ModelBoundingBox = m_World.boundingBox();
+    m_GlView.reframe(m_ModelBoundingBox); // center 3D model in the scene
+
+    // The new model has no attitude yet, apply it on the next tick
+    m_renderedAttitude = QQuaternion(0.0f, 0.0f, 0.0f, 0.0f);
+    updateGL();
 }
 
 void ModelViewGadgetWidget::wheelEvent(QWheelEvent *e)
@@ -320,18 +370,55 @@ void ModelViewGadgetWidget::keyPressEvent(QKeyEvent *e) // switch between camera
 //////////////////////////////////////////////////////////////////////
 // Private slots Functions
 //////////////////////////////////////////////////////////////////////
+void ModelViewGadgetWidget::attitudeUpdated(UAVObject *)
+{
+    AttitudeState::DataFields data = attState->getData(); // get attitude data
+    QQuaternion attitude(data.q1, data.q2, data.q3, data.q4);
+
+    if (attitude.isNull()) {
+        attitude = QQuaternion();
+    }
+    // Take the shortest path when interpolating
+    if (QQuaternion::dotProduct(m_lastAttitude, attitude) < 0.0f) {
+        attitude = -attitude;
+    }
+
+    m_prevAttitude   = m_lastAttitude;
+    m_prevSampleTime = m_lastSampleTime;
+    m_lastAttitude   = attitude;
+    m_lastSampleTime = m_clock.elapsed();
+}
+
 void ModelViewGadgetWidget::updateAttitude()
 {
-    AttitudeState::DataFields data  = attState->getData(); // get attitude data
-    GLC_StructOccurence *rootObject = m_World.rootOccurence(); // get the full 3D model
-    double x = data.q3;
-    double y = data.q2;
-    double z = data.q4;
-    double w = data.q1;
+    // Render one sample interval late so the attitude can move smoothly from the
+    // previous sample to the latest one instead of jumping at each update
+    qint64 interval = m_lastSampleTime - m_prevSampleTime;
+    float t = 1.0f;
 
-    if (w == 0.0) {
-        w = 1.0;
+    if (interval > 0 && interval < MAX_INTERPOLATION_MS) {
+        t = qBound(0.0f, (float)(m_clock.elapsed() - m_lastSampleTime) / interval, 1.0f);
     }
+    QQuaternion attitude = QQuaternion::slerp(m_prevAttitude, m_lastAttitude, t);
+
+    // Nothing to redraw until the next sample once the latest one is reached
+    if (qFuzzyCompare(attitude, m_renderedAttitude) || !isVisible()) {
+        return;
+    }
+    m_renderedAttitude = attitude;
+
+    setModelAttitude(attitude);
+    updateGL();
+}
+
+void ModelViewGadgetWidget::setModelAttitude(const QQuaternion &q)
+{
+    GLC_StructOccurence *rootObject = m_World.rootOccurence(); // get the full 3D model
+    double x = q.y();
+    double y = q.x();
+    double z = q.z();
+    double w = q.scalar();
+
     // create and gives the product of 2 4x4 matrices to get the rotation of the 3D model's matrix
     QMatrix4x4 m1;
     m1.setRow(0, QVector4D(w, z, -y, x));
@@ -348,5 +435,4 @@ void ModelViewGadgetWidget::updateAttitude()
     GLC_Matrix4x4 rootObjectRotation(m0.data());
     rootObject->structInstance()->setMatrix(rootObjectRotation);
     rootObject->updateChildrenAbsoluteMatrix();
-    updateGL();
 }
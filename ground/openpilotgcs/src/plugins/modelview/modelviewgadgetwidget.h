@@ -30,6 +30,9 @@
 
 #include <QGLWidget>
 #include <QTimer>
+#include <QElapsedTimer>
+#include <QQuaternion>
+#include <QThread>
 
 #include "glc_factory.h"
 #include "viewport/glc_viewport.h"
@@ -41,6 +44,8 @@
 #include "uavobjectmanager.h"
 #include "attitudestate.h"
 
+class ModelViewLoader;
+
 
 class ModelViewGadgetWidget : public QGLWidget {
     Q_OBJECT
@@ -61,6 +66,7 @@ private:
     void resizeGL(int width, int height);
     // Create GLC_Object to display
     void CreateScene();
+    void setModelAttitude(const QQuaternion &q);
 
     // Mouse events
     void mousePressEvent(QMouseEvent *e);
@@ -74,6 +80,11 @@ private:
 //////////////////////////////////////////////////////////////////////
 private slots:
     void updateAttitude();
+    void attitudeUpdated(UAVObject *obj);
+    void modelLoaded(QString fileName, GLC_World *world);
+
+signals:
+    void loadModel(QString fileName);
 
 private:
     GLC_Factory *m_pFactory;
@@ -89,6 +100,19 @@ private:
     QString bgFilename;
     bool vboEnable;
 
+    // The two latest attitude samples and when they were received, the model is
+    // rendered at the attitude interpolated between them
+    QElapsedTimer m_clock;
+    QQuaternion m_prevAttitude;
+    QQuaternion m_lastAttitude;
+    qint64 m_prevSampleTime;
+    qint64 m_lastSampleTime;
+    QQuaternion m_renderedAttitude;
+
+    // Models are loaded in the background by m_loader, running in m_loaderThread
+    QThread m_loaderThread;
+    ModelViewLoader *m_loader;
+
     AttitudeState *attState;
 };
 
@@ -0,0 +1,145 @@
+/**
+ ******************************************************************************
+ *
+ * @file       modelviewloader.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ModelViewPlugin ModelView Plugin
+ * @{
+ * @brief A gadget that displays a 3D representation of the UAV
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "modelviewloader.h"
+#include "glc_factory.h"
+#include "glc_exception.h"
+#include "geometry/glc_bsrep.h"
+#include "geometry/glc_mesh.h"
+#include "sceneGraph/glc_world.h"
+#include "io/glc_bsreptoworld.h"
+#include <utils/pathutils.h>
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QtDebug>
+
+ModelViewLoader::ModelViewLoader() : QObject()
+{
+    qRegisterMetaType<GLC_World *>("GLC_World*");
+}
+
+void ModelViewLoader::load(QString fileName)
+{
+    GLC_World *world = 0;
+
+    // Models built into the resources are small and do not need to be cached
+    QString cacheFile = fileName.startsWith(":") ? QString() : cacheFileName(fileName);
+
+    if (!cacheFile.isEmpty()) {
+        world = loadFromCache(fileName, cacheFile);
+    }
+
+    if (!world) {
+        try {
+            QFile file(fileName);
+            world = new GLC_World(GLC_Factory::instance()->createWorldFromFile(file));
+        } catch(GLC_Exception e) {
+            qDebug() << "ModelView: loading" << fileName << "failed:" << e.what();
+            emit loaded(fileName, 0);
+            return;
+        }
+        if (!cacheFile.isEmpty()) {
+            saveToCache(*world, fileName, cacheFile);
+        }
+    }
+
+    emit loaded(fileName, world);
+}
+
+QString ModelViewLoader::cacheFileName(const QString &fileName) const
+{
+    QDir dir(Utils::PathUtils().GetStoragePath() + "modelcache");
+
+    if (!dir.exists() && !dir.mkpath(".")) {
+        return QString();
+    }
+    QByteArray hash = QCryptographicHash::hash(QFileInfo(fileName).absoluteFilePath().toUtf8(), QCryptographicHash::Sha1);
+    return dir.filePath(QString(hash.toHex()) + "." + GLC_BSRep::suffix());
+}
+
+GLC_World *ModelViewLoader::loadFromCache(const QString &fileName, const QString &cacheFile)
+{
+    if (!QFile::exists(cacheFile)) {
+        return 0;
+    }
+
+    // The cache is stamped with the modification time of the model file it was made from
+    GLC_BSRep binaryRep(cacheFile);
+    if (!binaryRep.isUsable(QFileInfo(fileName).lastModified())) {
+        return 0;
+    }
+
+    try {
+        QFile file(cacheFile);
+        return GLC_BSRepToWorld().CreateWorldFromBSRep(file);
+    } catch(GLC_Exception e) {
+        qDebug() << "ModelView: cached model" << cacheFile << "could not be read:" << e.what();
+        return 0;
+    }
+}
+
+void ModelViewLoader::saveToCache(const GLC_World &world, const QString &fileName, const QString &cacheFile)
+{
+    // A BSRep holds a single representation, merge the meshes of every occurrence
+    // into one, moved to where the occurrence puts them
+    GLC_3DRep rep;
+    QList<GLC_StructOccurence *> occurences = world.rootOccurence()->subOccurenceList();
+
+    occurences.prepend(world.rootOccurence());
+    foreach(GLC_StructOccurence * occurence, occurences) {
+        if (!occurence->hasRepresentation()) {
+            continue;
+        }
+        GLC_3DRep *occurenceRep = dynamic_cast<GLC_3DRep *>(occurence->structReference()->representationHandle());
+        if (!occurenceRep) {
+            continue;
+        }
+        for (int i = 0; i < occurenceRep->numberOfBody(); i++) {
+            GLC_Geometry *geometry = occurenceRep->geomAt(i)->clone();
+            GLC_Mesh *mesh = dynamic_cast<GLC_Mesh *>(geometry);
+            if (!mesh) {
+                // Only meshes can be moved, leave models with other geometries uncached
+                delete geometry;
+                return;
+            }
+            mesh->transformVertice(occurence->absoluteMatrix());
+            rep.addGeom(mesh);
+        }
+    }
+
+    if (rep.isEmpty()) {
+        return;
+    }
+    rep.setLastModified(QFileInfo(fileName).lastModified());
+    if (!GLC_BSRep(cacheFile).save(rep)) {
+        qDebug() << "ModelView: could not write the model cache" << cacheFile;
+    }
+}
@@ -0,0 +1,61 @@
+/**
+ ******************************************************************************
+ *
+ * @file       modelviewloader.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ModelViewPlugin ModelView Plugin
+ * @{
+ * @brief A gadget that displays a 3D representation of the UAV
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef MODELVIEWLOADER_H_
+#define MODELVIEWLOADER_H_
+
+#include <QObject>
+#include <QString>
+
+class GLC_World;
+
+/**
+ * Loads the 3D models of the ModelView gadget away from the GUI thread.
+ * The first time a model file is loaded its meshes are flattened into a single
+ * binary representation (BSRep) kept in the GCS storage directory, later loads
+ * of the same, unmodified, file read that instead of parsing the file again.
+ */
+class ModelViewLoader : public QObject {
+    Q_OBJECT
+
+public:
+    ModelViewLoader();
+
+public slots:
+    void load(QString fileName);
+
+signals:
+    // The world is owned by the receiver, NULL if the file could not be loaded
+    void loaded(QString fileName, GLC_World *world);
+
+private:
+    QString cacheFileName(const QString &fileName) const;
+    GLC_World *loadFromCache(const QString &fileName, const QString &cacheFile);
+    void saveToCache(const GLC_World &world, const QString &fileName, const QString &cacheFile);
+};
+
+#endif /* MODELVIEWLOADER_H_ */
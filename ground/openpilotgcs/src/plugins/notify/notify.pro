@@ -13,14 +13,16 @@ HEADERS += notifyplugin.h \
     notifyitemdelegate.h \
     notifytablemodel.h \
     notificationitem.h \
-    notifylogging.h
+    notifylogging.h \
+    notifyaudiooutput.h
 
 SOURCES += notifyplugin.cpp \  
     notifypluginoptionspage.cpp \
     notifyitemdelegate.cpp \
     notifytablemodel.cpp \
     notificationitem.cpp \
-    notifylogging.cpp
+    notifylogging.cpp \
+    notifyaudiooutput.cpp
  
 OTHER_FILES += NotifyPlugin.pluginspec
 
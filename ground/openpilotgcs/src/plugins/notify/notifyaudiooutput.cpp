@@ -0,0 +1,260 @@
+/**
+ ******************************************************************************
+ *
+ * @file       notifyaudiooutput.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @brief      Plays notification sounds from decoded samples kept in memory
+ * @see        The GNU Public License (GPL) Version 3
+ * @defgroup   notifyplugin
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "notifyaudiooutput.h"
+#include "notifylogging.h"
+
+#include <QAudioOutput>
+#include <QAudioDeviceInfo>
+#include <QDir>
+#include <QFile>
+#include <QtEndian>
+#include <string.h>
+
+// All the sounds are converted to this format, the one of the shipped sound collection
+#define OUTPUT_RATE      44100
+// Audio buffered ahead of the sound card, a new notification is heard after at most this
+#define OUTPUT_BUFFER_MS 50
+
+NotifyAudioOutput::NotifyAudioOutput(QObject *parent) : QIODevice(parent),
+    m_output(0), m_position(0), m_playing(false)
+{
+    m_format.setSampleRate(OUTPUT_RATE);
+    m_format.setChannelCount(1);
+    m_format.setSampleSize(16);
+    m_format.setSampleType(QAudioFormat::SignedInt);
+    m_format.setByteOrder(QAudioFormat::LittleEndian);
+    m_format.setCodec("audio/pcm");
+}
+
+NotifyAudioOutput::~NotifyAudioOutput()
+{
+    delete m_output;
+}
+
+/**
+ * Open the sound card, must be called from the thread the output lives in.
+ * While open, silence is played between the notifications.
+ */
+void NotifyAudioOutput::start()
+{
+    if (!m_output) {
+        QAudioDeviceInfo device = QAudioDeviceInfo::defaultOutputDevice();
+        if (!device.isFormatSupported(m_format)) {
+            qNotifyDebug() << "NotifyAudioOutput - audio format not supported by" << device.deviceName();
+            return;
+        }
+        m_output = new QAudioOutput(device, m_format, this);
+        m_output->setBufferSize(m_format.bytesForDuration(OUTPUT_BUFFER_MS * 1000));
+        connect(m_output, SIGNAL(stateChanged(QAudio::State)), this, SLOT(outputStateChanged(QAudio::State)));
+        open(QIODevice::ReadOnly);
+    }
+    if (m_output->state() != QAudio::ActiveState) {
+        m_output->start(this);
+    }
+}
+
+/**
+ * Decode all the sounds found in the directories ahead of time, and open the
+ * sound card so that the first notification does not wait for it either.
+ */
+void NotifyAudioOutput::preload(QStringList directories)
+{
+    foreach(QString directory, directories) {
+        QDir dir(directory);
+
+        foreach(QString name, dir.entryList(QStringList("*.wav"), QDir::Files)) {
+            sample(QDir::toNativeSeparators(dir.filePath(name)));
+        }
+    }
+    start();
+}
+
+/**
+ * Play the sound files one after the other, replaces what is being played.
+ */
+void NotifyAudioOutput::play(QStringList fileNames)
+{
+    m_sequence.clear();
+    m_position = 0;
+    foreach(QString fileName, fileNames) {
+        const QByteArray &data = sample(fileName);
+
+        if (!data.isEmpty()) {
+            m_sequence.append(data);
+        }
+    }
+    m_playing = true;
+    start();
+
+    if (!m_output || m_sequence.isEmpty()) {
+        // Nothing will be played, don't leave the caller waiting
+        m_sequence.clear();
+        m_playing = false;
+        emit finished();
+    }
+}
+
+void NotifyAudioOutput::stop()
+{
+    m_sequence.clear();
+    m_playing = false;
+    if (m_output) {
+        m_output->stop();
+    }
+}
+
+qint64 NotifyAudioOutput::readData(char *data, qint64 maxlen)
+{
+    qint64 written = 0;
+
+    while (written < maxlen && !m_sequence.isEmpty()) {
+        const QByteArray &current = m_sequence.first();
+        qint64 count = qMin(maxlen - written, (qint64)current.size() - m_position);
+
+        memcpy(data + written, current.constData() + m_position, count);
+        written    += count;
+        m_position += count;
+        if (m_position >= current.size()) {
+            m_sequence.removeFirst();
+            m_position = 0;
+        }
+    }
+
+    if (m_playing && m_sequence.isEmpty()) {
+        // At most OUTPUT_BUFFER_MS before the end is actually heard
+        m_playing = false;
+        emit finished();
+    }
+
+    // Keep the output running, new sounds then start without reopening the device
+    memset(data + written, 0, maxlen - written);
+    return maxlen;
+}
+
+qint64 NotifyAudioOutput::writeData(const char *data, qint64 len)
+{
+    Q_UNUSED(data);
+    Q_UNUSED(len);
+    return -1;
+}
+
+void NotifyAudioOutput::outputStateChanged(QAudio::State state)
+{
+    if (state == QAudio::StoppedState && m_output->error() != QAudio::NoError) {
+        qNotifyDebug() << "NotifyAudioOutput - audio output error" << m_output->error();
+        if (m_playing) {
+            m_sequence.clear();
+            m_playing = false;
+            emit finished();
+        }
+    }
+}
+
+/**
+ * Decoded samples of a sound file, decoded on first use.
+ */
+const QByteArray &NotifyAudioOutput::sample(const QString &fileName)
+{
+    QHash<QString, QByteArray>::iterator it = m_samples.find(fileName);
+
+    if (it == m_samples.end()) {
+        // Files that fail to decode are cached empty, and not tried again
+        it = m_samples.insert(fileName, decodeWav(fileName));
+    }
+    return it.value();
+}
+
+/**
+ * Decode a PCM wav file to the output format, 8 or 16 bit, any rate and channels.
+ */
+QByteArray NotifyAudioOutput::decodeWav(const QString &fileName) const
+{
+    QFile file(fileName);
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        qNotifyDebug() << "NotifyAudioOutput - can not open" << fileName;
+        return QByteArray();
+    }
+    QByteArray wav = file.readAll();
+    const uchar *bytes = (const uchar *)wav.constData();
+
+    if (wav.size() < 12 || !wav.startsWith("RIFF") || wav.mid(8, 4) != "WAVE") {
+        qNotifyDebug() << "NotifyAudioOutput - not a wav file" << fileName;
+        return QByteArray();
+    }
+
+    quint16 encoding   = 0;
+    quint16 channels   = 0;
+    quint16 sampleBits = 0;
+    quint32 sampleRate = 0;
+    const uchar *pcm   = 0;
+    qint64 pcmSize     = 0;
+    int pos = 12;
+    while (pos + 8 <= wav.size()) {
+        QByteArray id = wav.mid(pos, 4);
+        qint64 size   = qMin((qint64)qFromLittleEndian<quint32>(bytes + pos + 4), (qint64)wav.size() - pos - 8);
+        pos += 8;
+        if (id == "fmt " && size >= 16) {
+            encoding   = qFromLittleEndian<quint16>(bytes + pos);
+            channels   = qFromLittleEndian<quint16>(bytes + pos + 2);
+            sampleRate = qFromLittleEndian<quint32>(bytes + pos + 4);
+            sampleBits = qFromLittleEndian<quint16>(bytes + pos + 14);
+        } else if (id == "data") {
+            pcm     = bytes + pos;
+            pcmSize = size;
+        }
+        // Chunks are word aligned
+        pos += size + (size & 1);
+    }
+
+    if (encoding != 1 || (sampleBits != 8 && sampleBits != 16) || channels == 0 || sampleRate == 0 || !pcm) {
+        qNotifyDebug() << "NotifyAudioOutput - unsupported wav format" << fileName;
+        return QByteArray();
+    }
+
+    int frameSize  = channels * sampleBits / 8;
+    qint64 frames  = pcmSize / frameSize;
+    qint64 outputFrames = frames * OUTPUT_RATE / sampleRate;
+    QByteArray output(outputFrames * 2, 0);
+    uchar *out     = (uchar *)output.data();
+
+    for (qint64 i = 0; i < outputFrames; i++) {
+        // Nearest sample, the notifications are speech and beeps
+        const uchar *frame = pcm + (i * sampleRate / OUTPUT_RATE) * frameSize;
+        int sum = 0;
+        for (int channel = 0; channel < channels; channel++) {
+            if (sampleBits == 16) {
+                sum += qFromLittleEndian<qint16>(frame + channel * 2);
+            } else {
+                sum += (frame[channel] - 128) << 8;
+            }
+        }
+        qToLittleEndian<qint16>(sum / channels, out + i * 2);
+    }
+    return output;
+}
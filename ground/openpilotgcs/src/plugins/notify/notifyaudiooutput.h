@@ -0,0 +1,84 @@
+/**
+ ******************************************************************************
+ *
+ * @file       notifyaudiooutput.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @brief      Plays notification sounds from decoded samples kept in memory
+ * @see        The GNU Public License (GPL) Version 3
+ * @defgroup   notifyplugin
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef NOTIFYAUDIOOUTPUT_H
+#define NOTIFYAUDIOOUTPUT_H
+
+#include <QIODevice>
+#include <QHash>
+#include <QList>
+#include <QStringList>
+#include <QAudio>
+#include <QAudioFormat>
+
+class QAudioOutput;
+
+/**
+ * Single audio output for all the notifications.
+ * The wav files are decoded once to 16 bit mono PCM and kept in memory, a sequence
+ * of them is played by feeding the samples to one QAudioOutput that stays open, so
+ * starting a notification does not involve any file or decoder.
+ * Lives in its own thread, so that busy GCS does not delay the sound.
+ */
+class NotifyAudioOutput : public QIODevice {
+    Q_OBJECT
+
+public:
+    NotifyAudioOutput(QObject *parent = 0);
+    ~NotifyAudioOutput();
+
+public slots:
+    void start();
+    void preload(QStringList directories);
+    void play(QStringList fileNames);
+    void stop();
+
+signals:
+    // the sequence given to play() has been played
+    void finished();
+
+protected:
+    qint64 readData(char *data, qint64 maxlen);
+    qint64 writeData(const char *data, qint64 len);
+
+private slots:
+    void outputStateChanged(QAudio::State state);
+
+private:
+    const QByteArray &sample(const QString &fileName);
+    QByteArray decodeWav(const QString &fileName) const;
+
+    QAudioFormat m_format;
+    QAudioOutput *m_output;
+    QHash<QString, QByteArray> m_samples;
+    // samples of the sequence being played, and the position in the first one
+    QList<QByteArray> m_sequence;
+    qint64 m_position;
+    bool m_playing;
+};
+
+#endif // NOTIFYAUDIOOUTPUT_H
@@ -29,6 +29,7 @@
 #include "notificationitem.h"
 #include "notifypluginoptionspage.h"
 #include "notifylogging.h"
+#include "notifyaudiooutput.h"
 
 #include <extensionsystem/pluginmanager.h>
 #include <coreplugin/icore.h>
@@ -45,18 +46,17 @@ static const QString VERSION = "1.0.0";
 // #define DEBUG_NOTIFIES
 
 
-SoundNotifyPlugin::SoundNotifyPlugin()
-{
-    phonon.mo = NULL;
-}
+SoundNotifyPlugin::SoundNotifyPlugin() :
+    _nowPlayingNotification(NULL), audio(NULL), audioReady(false), audioPlaying(false)
+{}
 
 SoundNotifyPlugin::~SoundNotifyPlugin()
 {
     Core::ICore::instance()->saveSettings(this);
 
-    if (phonon.mo != NULL) {
-        delete phonon.mo;
-    }
+    audioThread.quit();
+    audioThread.wait();
+    delete audio;
 }
 
 bool SoundNotifyPlugin::initialize(const QStringList & args, QString *errMsg)
@@ -67,6 +67,14 @@ bool SoundNotifyPlugin::initialize(const QStringList & args, QString *errMsg)
     mop = new NotifyPluginOptionsPage(this);
     addAutoReleasedObject(mop);
 
+    audio = new NotifyAudioOutput();
+    audio->moveToThread(&audioThread);
+    connect(this, SIGNAL(preloadSounds(QStringList)), audio, SLOT(preload(QStringList)));
+    connect(this, SIGNAL(playSounds(QStringList)), audio, SLOT(play(QStringList)));
+    connect(this, SIGNAL(stopSounds()), audio, SLOT(stop()));
+    connect(audio, SIGNAL(finished()), this, SLOT(audioFinished()));
+    audioThread.start(QThread::HighPriority);
+
     return true;
 }
 
@@ -181,9 +189,11 @@ void SoundNotifyPlugin::connectNotifications()
             disconnect(obj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(on_arrived_Notification(UAVObject *)));
         }
     }
-    if (phonon.mo != NULL) {
-        delete phonon.mo;
-        phonon.mo = NULL;
+    if (audioReady) {
+        emit stopSounds();
+        audioReady   = false;
+        audioPlaying = false;
+        _nowPlayingNotification = NULL;
     }
 
     if (!enableSound) {
@@ -229,11 +239,20 @@ void SoundNotifyPlugin::connectNotifications()
     if (_notificationList.isEmpty()) {
         return;
     }
-    // set notification message to current event
-    phonon.mo = new QMediaPlayer;
-    phonon.firstPlay = true;
-    connect(phonon.mo, SIGNAL(stateChanged(QMediaPlayer::State)),
-            this, SLOT(stateChanged(QMediaPlayer::State)));
+    // decode all the sounds of the collections in use before they are needed
+    QStringList directories;
+    foreach(NotificationItem * notify, _notificationList) {
+        QString language = notify->getSoundCollectionPath() + "/" + notify->getCurrentLanguage();
+        QString fallback = notify->getSoundCollectionPath() + "/default";
+        if (!directories.contains(language)) {
+            directories << language;
+        }
+        if (!directories.contains(fallback)) {
+            directories << fallback;
+        }
+    }
+    emit preloadSounds(directories);
+    audioReady = true;
 }
 
 void SoundNotifyPlugin::on_arrived_Notification(UAVObject *object)
@@ -323,34 +342,25 @@ void SoundNotifyPlugin::on_expiredTimer_Notification()
     }
 }
 
-void SoundNotifyPlugin::stateChanged(QMediaPlayer::State newstate)
+void SoundNotifyPlugin::audioFinished()
 {
-    // qNotifyDebug() << "File length (ms): " << phonon.mo->totalTime();
-
-#ifndef Q_OS_WIN
-    // This is a hack to force Linux to wait until the end of the
-    // wav file before moving to the next in the queue.
-    // I wish I did not have to go through a #define, but I did not
-    // manage to make this work on both platforms any other way!
-// if (phonon.mo->totalTime() > 0) {
-// phonon.mo->setTransitionTime(phonon.mo->totalTime());
-// }
-#endif
-    if ((newstate == QMediaPlayer::PausedState) ||
-        (newstate == QMediaPlayer::StoppedState)) {
-        qNotifyDebug() << "New State: " << QVariant(newstate).toString();
-
-        // assignment to NULL needed to detect that palying is finished
-        // it's useful in repeat timer handler, where we can detect
-        // that notification has not overlap with itself
-        _nowPlayingNotification = NULL;
+    // a stop may have been requested while the sounds were finishing
+    if (!audioPlaying) {
+        return;
+    }
+    qNotifyDebug() << "audio finished";
+    audioPlaying = false;
 
-        if (!_pendingNotifications.isEmpty()) {
-            NotificationItem *notification = _pendingNotifications.takeFirst();
-            qNotifyDebug_if(notification) << "play audioFree - " << notification->toString();
-            playNotification(notification);
-            qNotifyDebug() << "end playNotification";
-        }
+    // assignment to NULL needed to detect that palying is finished
+    // it's useful in repeat timer handler, where we can detect
+    // that notification has not overlap with itself
+    _nowPlayingNotification = NULL;
+
+    if (!_pendingNotifications.isEmpty()) {
+        NotificationItem *notification = _pendingNotifications.takeFirst();
+        qNotifyDebug_if(notification) << "play audioFree - " << notification->toString();
+        playNotification(notification);
+        qNotifyDebug() << "end playNotification";
     }
 }
 
@@ -471,21 +481,16 @@ void SoundNotifyPlugin::checkNotificationRule(NotificationItem *notification, UA
 
 bool SoundNotifyPlugin::playNotification(NotificationItem *notification)
 {
-    playlist = new QMediaPlaylist;
     if (!notification) {
         return false;
     }
 
-    // Check: race condition, if phonon.mo got deleted don't go further
-    if (phonon.mo == NULL) {
+    // Check: sounds are disabled or the notifications are being reconnected
+    if (!audioReady) {
         return false;
     }
 
-    // qNotifyDebug() << "Phonon State: " << phonon.mo->state();
-
-    if ((phonon.mo->state() == QMediaPlayer::PausedState)
-        || (phonon.mo->state() == QMediaPlayer::StoppedState)
-        || phonon.firstPlay) {
+    if (!audioPlaying) {
         _nowPlayingNotification = notification;
         notification->stopExpireTimer();
 
@@ -518,17 +523,9 @@ bool SoundNotifyPlugin::playNotification(NotificationItem *notification)
                         this, SLOT(on_timerRepeated_Notification()), Qt::UniqueConnection);
             }
         }
-        phonon.mo->stop();
         qNotifyDebug() << "play: " << notification->toString();
-        foreach(QString item, notification->toSoundList()) {
-            playlist->addMedia(QUrl::fromLocalFile(item));
-        }
-        qNotifyDebug() << "begin play";
-        phonon.mo->setPlaylist(playlist);
-        phonon.mo->play();
-        qNotifyDebug() << "end play";
-        phonon.firstPlay = false; // On Linux, you sometimes have to nudge Phonon to play 1 time before
-                                  // the state is not "Loading" anymore.
+        audioPlaying = true;
+        emit playSounds(notification->toSoundList());
         return true;
     }
 
@@ -34,16 +34,10 @@
 #include "notificationitem.h"
 
 #include <QSettings>
-#include <QMediaPlaylist>
-#include <QMediaPlayer>
+#include <QThread>
 
 class NotifyPluginOptionsPage;
-
-typedef struct {
-    QMediaPlayer *mo;
-    NotificationItem *notify;
-    bool firstPlay;
-} PhononObject, *pPhononObject;
+class NotifyAudioOutput;
 
 
 class SoundNotifyPlugin : public Core::IConfigurablePlugin {
@@ -95,7 +89,12 @@ private slots:
     void on_arrived_Notification(UAVObject *object);
     void on_timerRepeated_Notification(void);
     void on_expiredTimer_Notification(void);
-    void stateChanged(QMediaPlayer::State newstate);
+    void audioFinished();
+
+signals:
+    void preloadSounds(QStringList directories);
+    void playSounds(QStringList fileNames);
+    void stopSounds();
 
 private:
     bool enableSound;
@@ -108,9 +107,12 @@ private:
     NotificationItem currentNotification;
     NotificationItem *_nowPlayingNotification;
 
-    PhononObject phonon;
+    // Sounds are played in their own thread, one notification at a time
+    NotifyAudioOutput *audio;
+    QThread audioThread;
+    bool audioReady;
+    bool audioPlaying;
     NotifyPluginOptionsPage *mop;
-    QMediaPlaylist *playlist;
 };
 
 #endif // SOUNDNOTIFYPLUGIN_H
@@ -47,7 +47,7 @@ public:
 
     ~opHID_hidapi();
 
-    int open(int max, int vid, int pid, int usage_page, int usage);
+    int open(int max, int vid, int pid, int usage_page, int usage, const QString &serial = QString());
 
     int receive(int, void *buf, int len, int timeout);
 
@@ -36,13 +36,125 @@
 
 class IConnection;
 
-// timeout value used when we want to return directly without waiting
+// the read blocks until a report arrives, the timeout only bounds
+// how long it takes the thread to notice a shutdown request
 static const int READ_TIMEOUT  = 200;
 static const int READ_SIZE     = 64;
 
 static const int WRITE_TIMEOUT = 1000;
 static const int WRITE_SIZE    = 64;
 
+// maximum number of reports handled per wake up of a thread
+static const int READ_BATCH    = 32;
+static const int WRITE_BATCH   = 32;
+
+// payload of a report, the first two bytes are the report ID and the valid data length
+static const int REPORT_DATA_SIZE  = 62;
+
+static const int RING_BUFFER_SIZE  = 16384;
+
+
+// *********************************************************************************
+
+/**
+ *   Circular byte buffer shared by a thread and the RawHID device.
+ *   It is not thread safe, users lock their own mutex around it.
+ *   The capacity is a power of two and doubles when data does not fit.
+ */
+class RawHIDRingBuffer {
+public:
+    RawHIDRingBuffer(int capacity);
+
+    int size() const
+    {
+        return m_size;
+    }
+
+    void append(const char *data, int size);
+
+    /** Copy up to size bytes from the head without removing them */
+    int peek(char *data, int size) const;
+
+    /** Drop size bytes from the head */
+    void remove(int size);
+
+    int read(char *data, int size);
+
+private:
+    void grow(int capacity);
+
+    QByteArray m_buffer;
+    int m_mask;
+    int m_head;
+    int m_size;
+};
+
+RawHIDRingBuffer::RawHIDRingBuffer(int capacity)
+    : m_buffer(capacity, 0),
+    m_mask(capacity - 1),
+    m_head(0),
+    m_size(0)
+{
+    Q_ASSERT((capacity & m_mask) == 0);
+}
+
+void RawHIDRingBuffer::grow(int capacity)
+{
+    int newCapacity = m_buffer.size();
+
+    while (newCapacity < capacity) {
+        newCapacity <<= 1;
+    }
+
+    QByteArray buffer(newCapacity, 0);
+    peek(buffer.data(), m_size);
+
+    m_buffer = buffer;
+    m_mask   = newCapacity - 1;
+    m_head   = 0;
+}
+
+void RawHIDRingBuffer::append(const char *data, int size)
+{
+    if (m_size + size > m_buffer.size()) {
+        grow(m_size + size);
+    }
+
+    int tail  = (m_head + m_size) & m_mask;
+    int first = qMin(size, m_buffer.size() - tail);
+
+    memcpy(m_buffer.data() + tail, data, first);
+    memcpy(m_buffer.data(), data + first, size - first);
+    m_size += size;
+}
+
+int RawHIDRingBuffer::peek(char *data, int size) const
+{
+    size = qMin(size, m_size);
+
+    int first = qMin(size, m_buffer.size() - m_head);
+
+    memcpy(data, m_buffer.constData() + m_head, first);
+    memcpy(data + first, m_buffer.constData(), size - first);
+
+    return size;
+}
+
+void RawHIDRingBuffer::remove(int size)
+{
+    size    = qMin(size, m_size);
+    m_head  = (m_head + size) & m_mask;
+    m_size -= size;
+}
+
+int RawHIDRingBuffer::read(char *data, int size)
+{
+    size = peek(data, size);
+    remove(size);
+
+    return size;
+}
+
 
 // *********************************************************************************
 
@@ -69,9 +181,10 @@ public slots:
 protected:
     void run();
 
-    /** QByteArray might not be the most efficient way to implement
-       a circular buffer but it's good enough and very simple */
-    QByteArray m_readBuffer;
+    /** Append the payload of a report to data, return its length */
+    static int unpackReport(const char *report, int length, char *data);
+
+    RawHIDRingBuffer m_readBuffer;
 
     /** A mutex to protect read buffer */
     QMutex m_readBufMtx;
@@ -110,9 +223,7 @@ public slots:
 protected:
     void run();
 
-    /** QByteArray might not be the most efficient way to implement
-       a circular buffer but it's good enough and very simple */
-    QByteArray m_writeBuffer;
+    RawHIDRingBuffer m_writeBuffer;
 
     /** A mutex to protect read buffer */
     QMutex m_writeBufMtx;
@@ -131,7 +242,8 @@ protected:
 // *********************************************************************************
 
 RawHIDReadThread::RawHIDReadThread(RawHID *hid)
-    : m_hid(hid),
+    : m_readBuffer(RING_BUFFER_SIZE),
+    m_hid(hid),
     hiddev(&hid->dev),
     hidno(hid->m_deviceNo),
     m_running(true)
@@ -165,19 +277,32 @@ void RawHIDReadThread::run()
         // although it would be nice if the device had a different report to
         // configure this
         char buffer[READ_SIZE] = { 0 };
+        char data[READ_BATCH * REPORT_DATA_SIZE];
+        int size = 0;
 
+        // sleep in the OS until the first report arrives
         int ret = hiddev->receive(hidno, buffer, READ_SIZE, READ_TIMEOUT);
 
-        if (ret > 0) { // read some data
-            QMutexLocker lock(&m_readBufMtx);
-            // Note: Preprocess the USB packets in this OS independent code
-            // First byte is report ID, second byte is the number of valid bytes
-            m_readBuffer.append(&buffer[2], buffer[1]);
+        // then collect what else is already queued without waiting,
+        // so a burst of reports costs one lock and one readyRead()
+        for (int reports = 0; ret > 0; ) {
+            size += unpackReport(buffer, ret, &data[size]);
+            if (++reports == READ_BATCH) {
+                break;
+            }
+            ret = hiddev->receive(hidno, buffer, READ_SIZE, 0);
+        }
+
+        if (size > 0) { // read some data
+            {
+                QMutexLocker lock(&m_readBufMtx);
+                m_readBuffer.append(data, size);
+            }
 
             emit m_hid->readyRead();
-        } else if (ret == 0) { // nothing read
-        } else { // < 0 => error
-                 // TODO! make proper error handling, this only quick hack for unplug freeze
+        }
+        if (ret < 0) { // < 0 => error
+                       // TODO! make proper error handling, this only quick hack for unplug freeze
             m_running = false;
         }
     }
@@ -186,18 +311,27 @@ void RawHIDReadThread::run()
     OPHID_TRACE("OUT");
 }
 
-int RawHIDReadThread::getReadData(char *data, int size)
+int RawHIDReadThread::unpackReport(const char *report, int length, char *data)
 {
-    QMutexLocker lock(&m_readBufMtx);
-
-    size = qMin(size, m_readBuffer.size());
+    // Note: Preprocess the USB packets in this OS independent code
+    // First byte is report ID, second byte is the number of valid bytes
+    if (length < 2) {
+        return 0;
+    }
+    int size = qMin((int)(quint8)report[1], qMin(length - 2, REPORT_DATA_SIZE));
 
-    memcpy(data, m_readBuffer.constData(), size);
-    m_readBuffer.remove(0, size);
+    memcpy(data, &report[2], size);
 
     return size;
 }
 
+int RawHIDReadThread::getReadData(char *data, int size)
+{
+    QMutexLocker lock(&m_readBufMtx);
+
+    return m_readBuffer.read(data, size);
+}
+
 qint64 RawHIDReadThread::getBytesAvailable()
 {
     QMutexLocker lock(&m_readBufMtx);
@@ -208,7 +342,8 @@ qint64 RawHIDReadThread::getBytesAvailable()
 // *********************************************************************************
 
 RawHIDWriteThread::RawHIDWriteThread(RawHID *hid)
-    : m_hid(hid),
+    : m_writeBuffer(RING_BUFFER_SIZE),
+    m_hid(hid),
     hiddev(&hid->dev),
     hidno(hid->m_deviceNo),
     m_running(true)
@@ -226,47 +361,60 @@ RawHIDWriteThread::~RawHIDWriteThread()
 void RawHIDWriteThread::run()
 {
     while (m_running) {
-        char buffer[WRITE_SIZE] = { 0 };
+        char data[WRITE_BATCH * REPORT_DATA_SIZE];
         int size;
 
         {
             QMutexLocker lock(&m_writeBufMtx);
-            size = qMin(WRITE_SIZE - 2, m_writeBuffer.size());
-            while (size <= 0) {
+            while (m_writeBuffer.size() <= 0) {
                 // wait on new data to write condition, the timeout
                 // enable the thread to shutdown properly
                 m_newDataToWrite.wait(&m_writeBufMtx, 200);
                 if (!m_running) {
                     return;
                 }
-
-                size = m_writeBuffer.size();
             }
 
+            // take everything queued up to a batch, the data stays in the
+            // buffer until it is sent so bytesToWrite() remains accurate
+            size = m_writeBuffer.peek(data, sizeof(data));
+        }
+
+        int sent = 0;
+        while (sent < size) {
+            char buffer[WRITE_SIZE] = { 0 };
+
             // NOTE: data size is limited to 2 bytes less than the
             // usb packet size (64 bytes for interrupt) to make room
             // for the reportID and valid data length
-            size = qMin(WRITE_SIZE - 2, m_writeBuffer.size());
-            memcpy(&buffer[2], m_writeBuffer.constData(), size);
-            buffer[1] = size; // valid data length
+            int length = qMin(REPORT_DATA_SIZE, size - sent);
+            memcpy(&buffer[2], &data[sent], length);
+            buffer[1] = length; // valid data length
             buffer[0] = 2; // reportID
-        }
 
-        // must hold lock through the send to know how much was sent
-        int ret = hiddev->send(hidno, buffer, WRITE_SIZE, WRITE_TIMEOUT);
+            int ret = hiddev->send(hidno, buffer, WRITE_SIZE, WRITE_TIMEOUT);
+
+            if (ret > 0) {
+                sent += length;
+            } else if (ret < 0) { // < 0 => error
+                // TODO! make proper error handling, this only quick hack for unplug freeze
+                m_running = false;
+                qDebug() << "Error writing to device (" << ret << ")";
+                break;
+            } else {
+                qDebug() << "No data written to device ??";
+                break;
+            }
+        }
 
-        if (ret > 0) {
+        if (sent > 0) {
             // only remove the size actually written to the device
-            QMutexLocker lock(&m_writeBufMtx);
-            m_writeBuffer.remove(0, size);
+            {
+                QMutexLocker lock(&m_writeBufMtx);
+                m_writeBuffer.remove(sent);
+            }
 
-            emit m_hid->bytesWritten(ret - 2);
-        } else if (ret < 0) { // < 0 => error
-            // TODO! make proper error handling, this only quick hack for unplug freeze
-            m_running = false;
-            qDebug() << "Error writing to device (" << ret << ")";
-        } else {
-            qDebug() << "No data written to device ??";
+            emit m_hid->bytesWritten(sent);
         }
     }
 }
@@ -283,7 +431,8 @@ int RawHIDWriteThread::pushDataToWrite(const char *data, int size)
 
 qint64 RawHIDWriteThread::getBytesToWrite()
 {
-    // QMutexLocker lock(&m_writeBufMtx);
+    QMutexLocker lock(&m_writeBufMtx);
+
     return m_writeBuffer.size();
 }
 
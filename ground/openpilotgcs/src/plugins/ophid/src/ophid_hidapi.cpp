@@ -124,10 +124,12 @@ int opHID_hidapi::enumerate(struct hid_device_info * *current_device_pptr, int *
  *
  * \param[in] vid USB vendor id of the device to open (-1 for any).
  * \param[in] pid USB product id of the device to open (-1 for any).
+ * \param[in] serial USB serial number of the device to open, empty for the first one found.
+ *            Only used when both vid and pid are given.
  * \return Number of opened device.
  * \retval 0 or 1.
  */
-int opHID_hidapi::open(int max, int vid, int pid, int usage_page, int usage)
+int opHID_hidapi::open(int max, int vid, int pid, int usage_page, int usage, const QString &serial)
 {
     int devices_found = false;
     struct hid_device_info *current_device_ptr    = NULL;
@@ -152,7 +154,13 @@ int opHID_hidapi::open(int max, int vid, int pid, int usage_page, int usage)
 
     // If caller knows which one to look for open it right away
     if (vid != 0 && pid != 0) {
-        handle = hid_open(vid, pid, NULL);
+        if (serial.isEmpty()) {
+            handle = hid_open(vid, pid, NULL);
+        } else {
+            wchar_t buf[USB_MAX_STRING_SIZE];
+            buf[serial.left(USB_MAX_STRING_SIZE - 1).toWCharArray(buf)] = 0;
+            handle = hid_open(vid, pid, buf);
+        }
 
         if (!handle) {
             OPHID_ERROR("Unable to open device.");
@@ -215,20 +223,19 @@ int opHID_hidapi::open(int max, int vid, int pid, int usage_page, int usage)
 /**
  * \brief Read an Input report from a HID device.
  *
- * \note This function does \b not block for now.
- *      Tests show that it does not need to.
+ * \note This function blocks until a report arrives or the timeout
+ *      expires, a timeout of 0 only returns an already queued report.
  *
  * \param[in] num Id of the device to receive packet (NOT supported).
  * \param[in] buf Pointer to the bufer to write the received packet to.
  * \param[in] len Size of the buffer.
- * \param[in] timeout Not supported.
- * \return Number of bytes received, or -1 on error.
+ * \param[in] timeout Timeout in ms, -1 to wait forever.
+ * \return Number of bytes received, 0 on timeout, or -1 on error.
  * \retval -1 for error or bytes received.
  */
 int opHID_hidapi::receive(int num, void *buf, int len, int timeout)
 {
     Q_UNUSED(num);
-    Q_UNUSED(timeout);
 
     int bytes_read = 0;
 
@@ -248,7 +255,7 @@ int opHID_hidapi::receive(int num, void *buf, int len, int timeout)
     }
 
     hid_read_Mtx.lock();
-    bytes_read = hid_read(handle, (unsigned char *)buf, len);
+    bytes_read = hid_read_timeout(handle, (unsigned char *)buf, len, timeout);
     hid_read_Mtx.unlock();
 
     // hidapi lib does not expose the libusb errors.
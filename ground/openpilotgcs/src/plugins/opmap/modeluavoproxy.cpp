@@ -27,9 +27,22 @@
 #include "modeluavoproxy.h"
 #include "extensionsystem/pluginmanager.h"
 #include "uavobjecthelper.h"
+#include "uavtalk/telemetrymanager.h"
 
 #include <QProgressDialog>
 #include <math.h>
+#include <string.h>
+
+// Waypoint and path action transactions run at a time
+#define TRANSFER_WINDOW 8
+
+static QByteArray packedData(UAVObject *obj)
+{
+    QByteArray data(obj->getNumBytes(), 0);
+
+    obj->pack((quint8 *)data.data());
+    return data;
+}
 
 ModelUavoProxy::ModelUavoProxy(QObject *parent, flightDataModel *model) : QObject(parent), myModel(model)
 {
@@ -39,56 +52,78 @@ ModelUavoProxy::ModelUavoProxy(QObject *parent, flightDataModel *model) : QObjec
 
     objMngr = pm->getObject<UAVObjectManager>();
     Q_ASSERT(objMngr != NULL);
+
+    memset(&boardPlan, 0, sizeof(boardPlan));
+
+    // Whatever plan the board had is not known anymore once disconnected
+    TelemetryManager *telMngr = pm->getObject<TelemetryManager>();
+    if (telMngr) {
+        connect(telMngr, SIGNAL(disconnected()), this, SLOT(forgetBoardPlan()));
+    }
 }
 
 void ModelUavoProxy::sendPathPlan()
 {
-    modelToObjects();
-
-    PathPlan *pathPlan      = PathPlan::GetInstance(objMngr);
+    if (!modelToObjects()) {
+        QMessageBox::critical(NULL, tr("Sending Path Plan Failed!"), tr("Failed to create the path plan objects."));
+        return;
+    }
 
-    const int waypointCount = pathPlan->getWaypointCount();
-    const int actionCount   = pathPlan->getPathActionCount();
+    PathPlan *pathPlan = PathPlan::GetInstance(objMngr);
+    PathPlan::DataFields pathPlanData = pathPlan->getData();
 
-    QProgressDialog progress(tr("Sending the path plan to the board... "), "", 0, 1 + waypointCount + actionCount);
+    QProgressDialog progress(tr("Sending the path plan to the board... "), "", 0, 0);
     progress.setWindowModality(Qt::WindowModal);
     progress.setCancelButton(NULL);
     progress.show();
 
-    UAVObjectUpdaterHelper updateHelper;
-
-    // send PathPlan
-    bool success = (updateHelper.doObjectAndWait(pathPlan) == UAVObjectUpdaterHelper::SUCCESS);
-    progress.setValue(1);
+    // The instances sent before are only skipped if the board still has the plan they were sent with
+    if (!boardData.isEmpty()) {
+        UAVObjectRequestHelper requestHelper;
+        bool known = (requestHelper.doObjectAndWait(pathPlan) == UAVObjectRequestHelper::SUCCESS);
+        PathPlan::DataFields currentBoardPlan = pathPlan->getData();
+        if (!known || memcmp(&currentBoardPlan, &boardPlan, sizeof(boardPlan))) {
+            forgetBoardPlan();
+        }
+        pathPlan->setData(pathPlanData);
+    }
 
-    if (success) {
-        // send Waypoint instances
-        qDebug() << "sending" << waypointCount << "waypoints";
-        for (int i = 0; i < waypointCount; ++i) {
-            Waypoint *waypoint = Waypoint::GetInstance(objMngr, i);
-            success = (updateHelper.doObjectAndWait(waypoint) == UAVObjectUpdaterHelper::SUCCESS);
-            if (!success) {
-                break;
-            }
-            progress.setValue(progress.value() + 1);
+    const int waypointCount = pathPlanData.WaypointCount;
+    const int actionCount   = pathPlanData.PathActionCount;
+    QList<UAVObject *> objects;
+    foreach(UAVObject * obj, planObjects(waypointCount, actionCount)) {
+        if (boardData.value(obj) != packedData(obj)) {
+            objects << obj;
         }
     }
+    if (objects.isEmpty() && !boardData.isEmpty() && !memcmp(&pathPlanData, &boardPlan, sizeof(boardPlan))) {
+        qDebug() << "ModelUavoProxy::sendPathPlan - the board already has the path plan";
+        progress.close();
+        return;
+    }
+    if (objects.isEmpty() && waypointCount > 0) {
+        // The board checks the plan when a waypoint or a path action is updated
+        objects << Waypoint::GetInstance(objMngr, 0);
+    }
+
+    progress.setMaximum(objects.size());
+    progress.setValue(0);
 
+    UAVObjectUpdaterHelper updateHelper;
+    connect(&updateHelper, SIGNAL(objectsCompleted(int)), &progress, SLOT(setValue(int)));
+
+    // send PathPlan, then the Waypoint and PathAction instances the board does not have yet
+    bool success = (updateHelper.doObjectAndWait(pathPlan) == UAVObjectUpdaterHelper::SUCCESS);
     if (success) {
-        // send PathAction instances
-        qDebug() << "sending" << actionCount << "path actions";
-        for (int i = 0; i < actionCount; ++i) {
-            PathAction *action = PathAction::GetInstance(objMngr, i);
-            success = (updateHelper.doObjectAndWait(action) == UAVObjectUpdaterHelper::SUCCESS);
-            if (!success) {
-                break;
-            }
-            progress.setValue(progress.value() + 1);
-        }
+        qDebug() << "sending" << objects.size() << "of" << waypointCount << "waypoints and" << actionCount << "path actions";
+        success = (updateHelper.doObjectsAndWait(objects, TRANSFER_WINDOW) == UAVObjectUpdaterHelper::SUCCESS);
     }
 
     qDebug() << "ModelUavoProxy::pathPlanSent - completed" << success;
-    if (!success) {
+    if (success) {
+        rememberBoardPlan();
+    } else {
+        forgetBoardPlan();
         QMessageBox::critical(NULL, tr("Sending Path Plan Failed!"), tr("Failed to send the path plan to the board."));
     }
 
@@ -111,51 +146,29 @@ void ModelUavoProxy::receivePathPlan()
     const int waypointCount = pathPlan->getWaypointCount();
     const int actionCount   = pathPlan->getPathActionCount();
 
-    progress.setMaximum(1 + waypointCount + actionCount);
-    progress.setValue(1);
+    progress.setMaximum(waypointCount + actionCount);
+    progress.setValue(0);
 
-    if (success && (waypointCount > objMngr->getNumInstances(Waypoint::OBJID))) {
-        // allocate needed Waypoint instances
-        Waypoint *waypoint = new Waypoint;
-        waypoint->initialize(waypointCount - 1, waypoint->getMetaObject());
-        success = objMngr->registerObject(waypoint);
-    }
+    // allocate needed Waypoint and PathAction instances
     if (success) {
-        // request Waypoint instances
-        qDebug() << "requesting" << waypointCount << "waypoints";
-        for (int i = 0; i < waypointCount; ++i) {
-            Waypoint *waypoint = Waypoint::GetInstance(objMngr, i);
-            success = (requestHelper.doObjectAndWait(waypoint) == UAVObjectRequestHelper::SUCCESS);
-            if (!success) {
-                break;
-            }
-            progress.setValue(progress.value() + 1);
-        }
-    }
-
-    if (success && (actionCount > objMngr->getNumInstances(PathAction::OBJID))) {
-        // allocate needed PathAction instances
-        PathAction *action = new PathAction;
-        action->initialize(actionCount - 1, action->getMetaObject());
-        success = objMngr->registerObject(action);
+        success = allocateInstances(new Waypoint, waypointCount) && allocateInstances(new PathAction, actionCount);
     }
     if (success) {
-        // request PathAction isntances
-        qDebug() << "requesting" << actionCount << "path actions";
-        for (int i = 0; i < actionCount; ++i) {
-            PathAction *action = PathAction::GetInstance(objMngr, i);
-            success = (requestHelper.doObjectAndWait(action) == UAVObjectRequestHelper::SUCCESS);
-            if (!success) {
-                break;
-            }
-            progress.setValue(progress.value() + 1);
-        }
+        // request Waypoint and PathAction instances
+        qDebug() << "requesting" << waypointCount << "waypoints and" << actionCount << "path actions";
+        connect(&requestHelper, SIGNAL(objectsCompleted(int)), &progress, SLOT(setValue(int)));
+        success = (requestHelper.doObjectsAndWait(planObjects(waypointCount, actionCount), TRANSFER_WINDOW) == UAVObjectRequestHelper::SUCCESS);
     }
 
     qDebug() << "ModelUavoProxy::pathPlanReceived - completed" << success;
     if (success) {
-        objectsToModel();
+        if (objectsToModel()) {
+            rememberBoardPlan();
+        } else {
+            forgetBoardPlan();
+        }
     } else {
+        forgetBoardPlan();
         QMessageBox::critical(NULL, tr("Receiving Path Plan Failed!"), tr("Failed to receive the path plan from the board."));
     }
 
@@ -176,45 +189,46 @@ bool ModelUavoProxy::modelToObjects()
 {
     qDebug() << "ModelUAVProxy::modelToObjects";
 
-    // track number of path actions
-    int actionCount   = 0;
-
-    // iterate over waypoints
     int waypointCount = myModel->rowCount();
-    for (int i = 0; i < waypointCount; ++i) {
-        // Path Actions
 
-        // create action to use as a search criteria
-        // this object does not need to be deleted as it will either be added to the managed list or deleted later
-        PathAction *action = new PathAction;
+    // Path Actions
 
+    // the path actions are compared as binary data, so no field can be forgotten by the compare
+    PathAction defaultAction;
+    QList<PathAction::DataFields> actions;
+    QVector<int> waypointActions(waypointCount);
+    for (int i = 0; i < waypointCount; ++i) {
         // get model data
-        PathAction::DataFields actionData = action->getData();
+        PathAction::DataFields actionData = defaultAction.getData();
         modelToPathAction(i, actionData);
 
         // see if that path action has already been added in this run
-        PathAction *foundAction = findPathAction(actionData, actionCount);
-        // TODO this test needs a consistency check as it is unsafe.
-        // if the find method is buggy and returns false positives then the flight plan sent to the uav is broken!
-        // the find method should do a "binary" compare instead of a field by field compare
-        // if a field is added everywhere and not in the compare method then you can start having false positives
-        if (!foundAction) {
-            // create or reuse an action instance
-            action = createPathAction(actionCount, action);
-            actionCount++;
-
-            // update UAVObject
-            action->setData(actionData);
-        } else {
-            action->deleteLater();
-            action = foundAction;
-            qDebug() << "ModelUAVProxy::modelToObjects - found action instance :" << action->getInstID();
+        int actionIndex = 0;
+        while (actionIndex < actions.size() && memcmp(&actions.at(actionIndex), &actionData, sizeof(actionData))) {
+            ++actionIndex;
+        }
+        if (actionIndex == actions.size()) {
+            actions.append(actionData);
         }
+        waypointActions[i] = actionIndex;
+    }
+    int actionCount = actions.size();
 
-        // Waypoints
+    // create the missing instances all at once
+    if (!allocateInstances(new Waypoint, waypointCount) || !allocateInstances(new PathAction, actionCount)) {
+        qWarning() << "ModelUAVProxy::modelToObjects - failed to allocate" << waypointCount << "waypoints and" << actionCount << "path actions";
+        return false;
+    }
+
+    // update UAVObjects
+    for (int i = 0; i < actionCount; ++i) {
+        PathAction::GetInstance(objMngr, i)->setData(actions.at(i));
+    }
 
-        // create or reuse a waypoint instance
-        Waypoint *waypoint = createWaypoint(i, NULL);
+    // Waypoints
+
+    for (int i = 0; i < waypointCount; ++i) {
+        Waypoint *waypoint = Waypoint::GetInstance(objMngr, i);
         Q_ASSERT(waypoint);
 
         // get model data
@@ -222,7 +236,7 @@ bool ModelUavoProxy::modelToObjects()
         modelToWaypoint(i, waypointData);
 
         // connect waypoint to path action
-        waypointData.Action = action->getInstID();
+        waypointData.Action = waypointActions.at(i);
 
         // update UAVObject
         waypoint->setData(waypointData);
@@ -253,84 +267,45 @@ bool ModelUavoProxy::modelToObjects()
     return true;
 }
 
-Waypoint *ModelUavoProxy::createWaypoint(int index, Waypoint *newWaypoint)
+// the given object is registered as the last needed instance, the manager creating the ones in between,
+// it is deleted when there are enough instances already
+bool ModelUavoProxy::allocateInstances(UAVDataObject *obj, int count)
 {
-    Waypoint *waypoint = NULL;
-    int count = objMngr->getNumInstances(Waypoint::OBJID);
-
-    if (index < count) {
-        // reuse object
-        qDebug() << "ModelUAVProxy::createWaypoint - reused waypoint instance :" << index << "/" << count;
-        waypoint = Waypoint::GetInstance(objMngr, index);
-        if (newWaypoint) {
-            newWaypoint->deleteLater();
-        }
-    } else if (index < count + 1) {
-        // create "next" object
-        qDebug() << "ModelUAVProxy::createWaypoint - created waypoint instance :" << index;
-        // TODO is there a limit to the number of wp?
-        waypoint = newWaypoint ? newWaypoint : new Waypoint;
-        waypoint->initialize(index, waypoint->getMetaObject());
-        objMngr->registerObject(waypoint);
-    } else {
-        // we can only create the "next" object
-        // TODO fail in a clean way :(
+    if (count <= objMngr->getNumInstances(obj->getObjID())) {
+        delete obj;
+        return true;
     }
-    return waypoint;
+    qDebug() << "ModelUAVProxy::allocateInstances - allocating" << obj->getName() << "instances up to" << count;
+    obj->initialize(count - 1, obj->getMetaObject());
+    return objMngr->registerObject(obj);
 }
 
-PathAction *ModelUavoProxy::createPathAction(int index, PathAction *newAction)
+QList<UAVObject *> ModelUavoProxy::planObjects(int waypointCount, int actionCount)
 {
-    PathAction *action = NULL;
-    int count = objMngr->getNumInstances(PathAction::OBJID);
-
-    if (index < count) {
-        // reuse object
-        qDebug() << "ModelUAVProxy::createPathAction - reused action instance :" << index << "/" << count;
-        action = PathAction::GetInstance(objMngr, index);
-        if (newAction) {
-            newAction->deleteLater();
-        }
-    } else if (index < count + 1) {
-        // create "next" object
-        qDebug() << "ModelUAVProxy::createPathAction - created action instance :" << index;
-        // TODO is there a limit to the number of path actions?
-        action = newAction ? newAction : new PathAction;
-        action->initialize(index, action->getMetaObject());
-        objMngr->registerObject(action);
-    } else {
-        // we can only create the "next" object
-        // TODO fail in a clean way :(
+    QList<UAVObject *> objects;
+
+    for (int i = 0; i < waypointCount; ++i) {
+        objects << Waypoint::GetInstance(objMngr, i);
     }
-    return action;
+    for (int i = 0; i < actionCount; ++i) {
+        objects << PathAction::GetInstance(objMngr, i);
+    }
+    return objects;
 }
 
-PathAction *ModelUavoProxy::findPathAction(const PathAction::DataFields &actionData, int actionCount)
+void ModelUavoProxy::rememberBoardPlan()
 {
-    int instancesCount = objMngr->getNumInstances(PathAction::OBJID);
-    int count = actionCount <= instancesCount ? actionCount : instancesCount;
-
-    for (int i = 0; i < count; ++i) {
-        PathAction *action = PathAction::GetInstance(objMngr, i);
-        Q_ASSERT(action);
-        if (!action) {
-            continue;
-        }
-        PathAction::DataFields fields = action->getData();
-        if (fields.Command == actionData.Command
-            && fields.ConditionParameters[0] == actionData.ConditionParameters[0]
-            && fields.ConditionParameters[1] == actionData.ConditionParameters[1]
-            && fields.ConditionParameters[2] == actionData.ConditionParameters[2]
-            && fields.EndCondition == actionData.EndCondition
-            && fields.ErrorDestination == actionData.ErrorDestination
-            && fields.JumpDestination == actionData.JumpDestination && fields.Mode == actionData.Mode
-            && fields.ModeParameters[0] == actionData.ModeParameters[0]
-            && fields.ModeParameters[1] == actionData.ModeParameters[1]
-            && fields.ModeParameters[2] == actionData.ModeParameters[2]) {
-            return action;
-        }
+    boardPlan = PathPlan::GetInstance(objMngr)->getData();
+    boardData.clear();
+    foreach(UAVObject * obj, planObjects(boardPlan.WaypointCount, boardPlan.PathActionCount)) {
+        boardData.insert(obj, packedData(obj));
     }
-    return NULL;
+}
+
+void ModelUavoProxy::forgetBoardPlan()
+{
+    memset(&boardPlan, 0, sizeof(boardPlan));
+    boardData.clear();
 }
 
 bool ModelUavoProxy::objectsToModel()
@@ -34,6 +34,7 @@
 #include "waypoint.h"
 
 #include <QObject>
+#include <QHash>
 
 class ModelUavoProxy : public QObject {
     Q_OBJECT
@@ -45,17 +46,24 @@ public slots:
     void sendPathPlan();
     void receivePathPlan();
 
+private slots:
+    void forgetBoardPlan();
+
 private:
     UAVObjectManager *objMngr;
     flightDataModel *myModel;
 
+    // Plan last sent to or received from the board, and the data of its instances,
+    // the instances that did not change since are not sent again
+    PathPlan::DataFields boardPlan;
+    QHash<UAVObject *, QByteArray> boardData;
+
     bool modelToObjects();
     bool objectsToModel();
 
-    Waypoint *createWaypoint(int index, Waypoint *newWaypoint);
-    PathAction *createPathAction(int index, PathAction *newAction);
-
-    PathAction *findPathAction(const PathAction::DataFields & actionFields, int actionCount);
+    bool allocateInstances(UAVDataObject *obj, int count);
+    QList<UAVObject *> planObjects(int waypointCount, int actionCount);
+    void rememberBoardPlan();
 
     void modelToWaypoint(int i, Waypoint::DataFields &data);
     void modelToPathAction(int i, PathAction::DataFields &data);
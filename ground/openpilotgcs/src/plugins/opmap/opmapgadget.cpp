@@ -33,12 +33,24 @@ OPMapGadget::OPMapGadget(QString classId, OPMapGadgetWidget *widget, QWidget *pa
 {
     connect(m_widget, SIGNAL(defaultLocationAndZoomChanged(double, double, double)), this, SLOT(saveDefaultLocation(double, double, double)));
     connect(m_widget, SIGNAL(overlayOpacityChanged(qreal)), this, SLOT(saveOpacity(qreal)));
+    connect(m_widget, SIGNAL(tilePackChanged(QString)), this, SLOT(saveTilePack(QString)));
 }
 
 OPMapGadget::~OPMapGadget()
 {
     delete m_widget;
 }
+
+void OPMapGadget::suspend()
+{
+    m_widget->setSuspended(true);
+}
+
+void OPMapGadget::resume()
+{
+    m_widget->setSuspended(false);
+}
+
 void OPMapGadget::saveDefaultLocation(double lng, double lat, double zoom)
 {
     if (m_config) {
@@ -55,6 +67,14 @@ void OPMapGadget::saveOpacity(qreal value)
         m_config->setOpacity(value);
     }
 }
+
+void OPMapGadget::saveTilePack(QString file)
+{
+    if (m_config) {
+        m_config->setTilePack(file);
+        m_config->saveConfig();
+    }
+}
 void OPMapGadget::loadConfiguration(IUAVGadgetConfiguration *config)
 {
     m_config = qobject_cast<OPMapGadgetConfiguration *>(config);
@@ -64,6 +84,7 @@ void OPMapGadget::loadConfiguration(IUAVGadgetConfiguration *config)
     m_widget->setAccessMode(m_config->accessMode());
     m_widget->setUseMemoryCache(m_config->useMemoryCache());
     m_widget->setCacheLocation(m_config->cacheLocation());
+    m_widget->setTilePack(m_config->tilePack());
     m_widget->SetUavPic(m_config->uavSymbol());
     m_widget->setZoom(m_config->zoom());
     m_widget->setPosition(QPointF(m_config->longitude(), m_config->latitude()));
@@ -50,11 +50,14 @@ public:
         return m_widget;
     }
     void loadConfiguration(IUAVGadgetConfiguration *m_config);
+    void suspend();
+    void resume();
 private:
     OPMapGadgetWidget *m_widget;
     OPMapGadgetConfiguration *m_config;
 private slots:
     void saveOpacity(qreal value);
+    void saveTilePack(QString file);
     void saveDefaultLocation(double lng, double lat, double zoom);
 };
 
@@ -60,6 +60,7 @@ OPMapGadgetConfiguration::OPMapGadgetConfiguration(QString classId, QSettings *q
         int max_update_rate    = qSettings->value("maxUpdateRate").toInt();
 
         m_opacity = qSettings->value("overlayOpacity", 1).toReal();
+        m_tilePack = qSettings->value("tilePack").toString();
 
         if (!mapProvider.isEmpty()) {
             m_mapProvider = mapProvider;
@@ -102,6 +103,7 @@ IUAVGadgetConfiguration *OPMapGadgetConfiguration::clone()
     m->m_uavSymbol = m_uavSymbol;
     m->m_maxUpdateRate     = m_maxUpdateRate;
     m->m_opacity = m_opacity;
+    m->m_tilePack = m_tilePack;
 
     return m;
 }
@@ -122,6 +124,7 @@ void OPMapGadgetConfiguration::saveConfig() const
     m_settings->setValue("cacheLocation", Utils::PathUtils().RemoveStoragePath(m_cacheLocation));
     m_settings->setValue("maxUpdateRate", m_maxUpdateRate);
     m_settings->setValue("overlayOpacity", m_opacity);
+    m_settings->setValue("tilePack", m_tilePack);
 }
 void OPMapGadgetConfiguration::saveConfig(QSettings *qSettings) const
 {
@@ -137,6 +140,7 @@ void OPMapGadgetConfiguration::saveConfig(QSettings *qSettings) const
     qSettings->setValue("cacheLocation", Utils::PathUtils().RemoveStoragePath(m_cacheLocation));
     qSettings->setValue("maxUpdateRate", m_maxUpdateRate);
     qSettings->setValue("overlayOpacity", m_opacity);
+    qSettings->setValue("tilePack", m_tilePack);
 }
 void OPMapGadgetConfiguration::setCacheLocation(QString cacheLocation)
 {
@@ -46,6 +46,7 @@ class OPMapGadgetConfiguration : public IUAVGadgetConfiguration {
     Q_PROPERTY(QString uavSymbol READ uavSymbol WRITE setUavSymbol)
     Q_PROPERTY(int maxUpdateRate READ maxUpdateRate WRITE setMaxUpdateRate)
     Q_PROPERTY(qreal overlayOpacity READ opacity WRITE setOpacity)
+    Q_PROPERTY(QString tilePack READ tilePack WRITE setTilePack)
 
 public:
     explicit OPMapGadgetConfiguration(QString classId, QSettings *qSettings = 0, QObject *parent = 0);
@@ -101,6 +102,10 @@ public:
     {
         return m_opacity;
     }
+    QString tilePack() const
+    {
+        return m_tilePack;
+    }
     void saveConfig() const;
 public slots:
     void setMapProvider(QString provider)
@@ -148,6 +153,10 @@ public slots:
     {
         m_maxUpdateRate = update_rate;
     }
+    void setTilePack(QString file)
+    {
+        m_tilePack = file;
+    }
 
 private:
     QString m_mapProvider;
@@ -163,6 +172,7 @@ private:
     int m_maxUpdateRate;
     QSettings *m_settings;
     qreal m_opacity;
+    QString m_tilePack;
 };
 
 #endif // OPMAP_GADGETCONFIGURATION_H
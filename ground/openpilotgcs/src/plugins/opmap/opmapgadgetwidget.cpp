@@ -33,6 +33,7 @@
 #include <QHBoxLayout>
 #include <QVBoxLayout>
 #include <QInputDialog>
+#include <QFileDialog>
 #include <QClipboard>
 #include <QMenu>
 #include <QStringList>
@@ -374,6 +375,10 @@ void OPMapGadgetWidget::contextMenuEvent(QContextMenuEvent *event)
     contextMenu.addAction(reloadAct);
     contextMenu.addSeparator();
     contextMenu.addAction(ripAct);
+    contextMenu.addAction(prefetchTilesAct);
+    contextMenu.addAction(loadTilePackAct);
+    unloadTilePackAct->setEnabled(!core::OPMaps::Instance()->TilePackFile().isEmpty());
+    contextMenu.addAction(unloadTilePackAct);
     contextMenu.addSeparator();
 
     QMenu maxUpdateRateSubMenu(tr("&Max Update Rate ") + "(" + QString::number(m_maxUpdateRate) + " ms)", this);
@@ -1089,6 +1094,24 @@ void OPMapGadgetWidget::setMaxUpdateRate(int update_rate)
 // m_statusUpdateTimer->setInterval(m_maxUpdateRate);
 }
 
+/**
+ * The UAV is not followed while the map is hidden
+ */
+void OPMapGadgetWidget::setSuspended(bool suspended)
+{
+    if (!m_updateTimer || !m_statusUpdateTimer) {
+        return;
+    }
+
+    if (suspended) {
+        m_updateTimer->stop();
+        m_statusUpdateTimer->stop();
+    } else {
+        m_updateTimer->start();
+        m_statusUpdateTimer->start();
+    }
+}
+
 void OPMapGadgetWidget::setZoom(int zoom)
 {
     if (!m_widget || !m_map) {
@@ -1241,6 +1264,18 @@ void OPMapGadgetWidget::setCacheLocation(QString cacheLocation)
     m_map->configuration->SetCacheLocation(cacheLocation);
 }
 
+void OPMapGadgetWidget::setTilePack(QString file)
+{
+    if (!m_widget || !m_map) {
+        return;
+    }
+
+    if (file == core::OPMaps::Instance()->TilePackFile()) {
+        return;
+    }
+    m_map->LoadTilePack(file);
+}
+
 void OPMapGadgetWidget::setMapMode(opMapModeType mode)
 {
     if (!m_widget || !m_map) {
@@ -1317,6 +1352,15 @@ void OPMapGadgetWidget::createActions()
     ripAct = new QAction(tr("&Rip map"), this);
     ripAct->setStatusTip(tr("Rip the map tiles"));
     connect(ripAct, SIGNAL(triggered()), this, SLOT(onRipAct_triggered()));
+    prefetchTilesAct = new QAction(tr("&Prefetch tiles for offline use..."), this);
+    prefetchTilesAct->setStatusTip(tr("Download the tiles of the selection or around the waypoints to a tile pack"));
+    connect(prefetchTilesAct, SIGNAL(triggered()), this, SLOT(onPrefetchTilesAct_triggered()));
+    loadTilePackAct  = new QAction(tr("Load &tile pack..."), this);
+    loadTilePackAct->setStatusTip(tr("Use the tiles of a tile pack before the cached ones"));
+    connect(loadTilePackAct, SIGNAL(triggered()), this, SLOT(onLoadTilePackAct_triggered()));
+    unloadTilePackAct = new QAction(tr("Unload tile pack"), this);
+    unloadTilePackAct->setStatusTip(tr("Stop using the tile pack"));
+    connect(unloadTilePackAct, SIGNAL(triggered()), this, SLOT(onUnloadTilePackAct_triggered()));
 
     copyMouseLatLonToClipAct = new QAction(tr("Mouse latitude and longitude"), this);
     copyMouseLatLonToClipAct->setStatusTip(tr("Copy the mouse latitude and longitude to the clipboard"));
@@ -1605,6 +1649,97 @@ void OPMapGadgetWidget::onRipAct_triggered()
     m_map->RipMap();
 }
 
+void OPMapGadgetWidget::onPrefetchTilesAct_triggered()
+{
+    if (!m_widget || !m_map) {
+        return;
+    }
+
+    // the selected area if there is one, else a corridor along the waypoints
+    QList<internals::PointLatLng> area;
+    bool closed = false;
+    internals::RectLatLng selection = m_map->SelectedArea();
+    if (!selection.IsEmpty()) {
+        area << selection.LocationTopLeft() << internals::PointLatLng(selection.Top(), selection.Right())
+             << internals::PointLatLng(selection.Bottom(), selection.Right()) << internals::PointLatLng(selection.Bottom(), selection.Left());
+        closed = true;
+    } else {
+        area = m_map->WPPath();
+    }
+    if (area.isEmpty()) {
+        QMessageBox::information(this, tr("Nothing to prefetch"),
+                                 tr("Please first select an area of the map with <CTRL>+Left mouse click or add waypoints."));
+        return;
+    }
+
+    bool ok;
+    int zoom    = (int)m_map->ZoomReal();
+    int minZoom = QInputDialog::getInt(this, tr("Prefetch tiles"), tr("From zoom level:"), zoom, m_map->MinZoom(), m_map->MaxZoom(), 1, &ok);
+    if (!ok) {
+        return;
+    }
+    int maxZoom = QInputDialog::getInt(this, tr("Prefetch tiles"), tr("To zoom level:"), qMax(minZoom, qMin(zoom + 3, m_map->MaxZoom())),
+                                       minZoom, m_map->MaxZoom(), 1, &ok);
+    if (!ok) {
+        return;
+    }
+    QString file = QFileDialog::getSaveFileName(this, tr("Save tile pack"), m_map->configuration->CacheLocation(), tr("Tile packs (*.optiles)"));
+    if (file.isEmpty()) {
+        return;
+    }
+    if (!file.endsWith(".optiles")) {
+        file += ".optiles";
+    }
+
+    TilePrefetcher *prefetcher = m_map->PrefetchTiles(area, closed, minZoom, maxZoom, file);
+    QMessageBox msgBox;
+    msgBox.setText(tr("Download %1 tiles to %2?").arg(prefetcher->TileCount()).arg(QDir::toNativeSeparators(file)));
+    msgBox.setStandardButtons(QMessageBox::Yes | QMessageBox::No);
+    if (msgBox.exec() != QMessageBox::Yes) {
+        delete prefetcher;
+        return;
+    }
+    connect(prefetcher, SIGNAL(packFinished(bool, QString, int)), this, SLOT(onTilePackFinished(bool, QString, int)));
+    prefetcher->Start();
+}
+
+void OPMapGadgetWidget::onTilePackFinished(bool ok, QString const & packFile, int const & missing)
+{
+    if (!ok) {
+        QMessageBox::warning(this, tr("Prefetch tiles"), tr("The tile pack %1 was not written.").arg(QDir::toNativeSeparators(packFile)));
+        return;
+    }
+    if (missing > 0) {
+        QMessageBox::warning(this, tr("Prefetch tiles"), tr("%1 tiles could not be downloaded, prefetch again to complete the pack.").arg(missing));
+    }
+    setTilePack(packFile);
+    emit tilePackChanged(packFile);
+}
+
+void OPMapGadgetWidget::onLoadTilePackAct_triggered()
+{
+    if (!m_widget || !m_map) {
+        return;
+    }
+
+    QString file = QFileDialog::getOpenFileName(this, tr("Load tile pack"), m_map->configuration->CacheLocation(), tr("Tile packs (*.optiles)"));
+
+    if (file.isEmpty()) {
+        return;
+    }
+    if (!m_map->LoadTilePack(file)) {
+        QMessageBox::warning(this, tr("Load tile pack"), tr("%1 is not a tile pack.").arg(QDir::toNativeSeparators(file)));
+        return;
+    }
+    emit tilePackChanged(file);
+}
+
+void OPMapGadgetWidget::onUnloadTilePackAct_triggered()
+{
+    setTilePack(QString());
+    emit tilePackChanged(QString());
+}
+
 void OPMapGadgetWidget::onCopyMouseLatLonToClipAct_triggered()
 {
     QClipboard *clipboard = QApplication::clipboard();
@@ -108,15 +108,18 @@ public:
     void setAccessMode(QString accessMode);
     void setUseMemoryCache(bool useMemoryCache);
     void setCacheLocation(QString cacheLocation);
+    void setTilePack(QString file);
     void setMapMode(opMapModeType mode);
     void SetUavPic(QString UAVPic);
     void setMaxUpdateRate(int update_rate);
+    void setSuspended(bool suspended);
     void setHomePosition(QPointF pos);
     void setOverlayOpacity(qreal value);
     bool getGPSPositionSensor(double &latitude, double &longitude, double &altitude);
 signals:
     void defaultLocationAndZoomChanged(double lng, double lat, double zoom);
     void overlayOpacityChanged(qreal);
+    void tilePackChanged(QString file);
 
 public slots:
     void homePositionUpdated(UAVObject *);
@@ -167,6 +170,10 @@ private slots:
      */
     void onReloadAct_triggered();
     void onRipAct_triggered();
+    void onPrefetchTilesAct_triggered();
+    void onLoadTilePackAct_triggered();
+    void onUnloadTilePackAct_triggered();
+    void onTilePackFinished(bool ok, QString const & packFile, int const & missing);
     void onCopyMouseLatLonToClipAct_triggered();
     void onCopyMouseLatToClipAct_triggered();
     void onCopyMouseLonToClipAct_triggered();
@@ -238,6 +245,9 @@ private:
     bool m_telemetry_connected;
     QAction *reloadAct;
     QAction *ripAct;
+    QAction *prefetchTilesAct;
+    QAction *loadTilePackAct;
+    QAction *unloadTilePackAct;
     QAction *copyMouseLatLonToClipAct;
     QAction *copyMouseLatToClipAct;
     QAction *copyMouseLonToClipAct;
@@ -28,6 +28,8 @@
 #include "osgearthviewgadgetconfiguration.h"
 #include "osgearthviewgadgetoptionspage.h"
 #include <coreplugin/iuavgadget.h>
+#include <extensionsystem/iplugin.h>
+#include <extensionsystem/pluginmanager.h>
 
 OsgEarthviewGadgetFactory::OsgEarthviewGadgetFactory(QObject *parent) :
     IUAVGadgetFactory(QString("OsgEarthviewGadget"),
@@ -40,6 +42,12 @@ OsgEarthviewGadgetFactory::~OsgEarthviewGadgetFactory()
 
 Core::IUAVGadget *OsgEarthviewGadgetFactory::createGadget(QWidget *parent)
 {
+    // the OSG windowing system is set up by OsgEarthviewPlugin::delayedInitialize()
+    ExtensionSystem::IPlugin *plugin = qobject_cast<ExtensionSystem::IPlugin *>(this->parent());
+    if (plugin) {
+        ExtensionSystem::PluginManager::instance()->ensureDelayedInitialized(plugin->pluginSpec());
+    }
+
     OsgEarthviewWidget *gadgetWidget = new OsgEarthviewWidget(parent);
 
     return new OsgEarthviewGadget(QString("OsgEarthviewGadget"), gadgetWidget, parent);
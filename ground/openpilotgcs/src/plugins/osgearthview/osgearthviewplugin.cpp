@@ -50,11 +50,15 @@ bool OsgEarthviewPlugin::initialize(const QStringList & args, QString *errMsg)
     mf = new OsgEarthviewGadgetFactory(this);
     addAutoReleasedObject(mf);
 
-    osgQt::initQtWindowingSystem();
-
     return true;
 }
 
+void OsgEarthviewPlugin::delayedInitialize()
+{
+    // not needed until the first earth view is shown, see OsgEarthviewGadgetFactory::createGadget()
+    osgQt::initQtWindowingSystem();
+}
+
 void OsgEarthviewPlugin::extensionsInitialized()
 {
     // Do nothing
@@ -42,6 +42,7 @@ public:
 
     void extensionsInitialized();
     bool initialize(const QStringList & arguments, QString *errorString);
+    void delayedInitialize();
     void shutdown();
 private:
     OsgEarthviewGadgetFactory *mf;
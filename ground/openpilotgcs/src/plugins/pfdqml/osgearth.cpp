@@ -53,6 +53,7 @@ OsgEarthItem::OsgEarthItem(QDeclarativeItem *parent) :
     m_longitude(153.0),
     m_altitude(400.0),
     m_fieldOfView(90.0),
+    m_lodScale(1.0),
     m_sceneFile(QLatin1String("/usr/share/osgearth/maps/srtm.earth"))
 {
     setSize(m_currentSize);
@@ -225,6 +226,16 @@ void OsgEarthItem::setFieldOfView(qreal arg)
     }
 }
 
+// ! Multiplier of the distances at which finer terrain tiles are paged in, > 1 favors coarser tiles
+void OsgEarthItem::setLodScale(qreal arg)
+{
+    if (!qFuzzyCompare(m_lodScale, arg)) {
+        m_lodScale = arg;
+        emit lodScaleChanged(arg);
+        updateFrame();
+    }
+}
+
 void OsgEarthItem::setSceneFile(QString arg)
 {
     if (m_sceneFile != arg) {
@@ -357,6 +368,7 @@ void OsgEarthItemRenderer::updateFrame()
 // qDebug() << "c " << center.x() << center.y() << center.z();
 // qDebug() << "up" << upVector.x() << upVector.y() << upVector.z();
 
+    m_viewer->getCamera()->setLODScale(m_item->lodScale());
     m_viewer->getCamera()->setViewMatrixAsLookAt(osg::Vec3d(eye.x(), eye.y(), eye.z()),
                                                  osg::Vec3d(center.x(), center.y(), center.z()),
                                                  osg::Vec3d(upVector.x(), upVector.y(), upVector.z()));
@@ -31,6 +31,7 @@ class OsgEarthItem : public QDeclarativeItem {
 
     Q_PROPERTY(QString sceneFile READ sceneFile WRITE setSceneFile NOTIFY sceneFileChanged)
     Q_PROPERTY(qreal fieldOfView READ fieldOfView WRITE setFieldOfView NOTIFY fieldOfViewChanged)
+    Q_PROPERTY(qreal lodScale READ lodScale WRITE setLodScale NOTIFY lodScaleChanged)
 
     Q_PROPERTY(qreal roll READ roll WRITE setRoll NOTIFY rollChanged)
     Q_PROPERTY(qreal pitch READ pitch WRITE setPitch NOTIFY pitchChanged)
@@ -53,6 +54,10 @@ public:
     {
         return m_fieldOfView;
     }
+    qreal lodScale() const
+    {
+        return m_lodScale;
+    }
 
     qreal roll() const
     {
@@ -88,6 +93,7 @@ public slots:
     void updateView();
     void setSceneFile(QString arg);
     void setFieldOfView(qreal arg);
+    void setLodScale(qreal arg);
 
     void setRoll(qreal arg);
     void setPitch(qreal arg);
@@ -108,6 +114,7 @@ signals:
 
     void sceneFileChanged(QString arg);
     void fieldOfViewChanged(qreal arg);
+    void lodScaleChanged(qreal arg);
 
 private slots:
     void updateFrame();
@@ -127,6 +134,7 @@ private:
     double m_altitude;
 
     qreal m_fieldOfView;
+    qreal m_lodScale;
     QString m_sceneFile;
 };
 
@@ -3,6 +3,7 @@ TARGET = PfdQml
 QT += svg
 QT += opengl
 QT += qml quick
+QT += concurrent
 OSG {
     DEFINES += USE_OSG
 }
@@ -17,7 +18,8 @@ HEADERS += \
     pfdqmlgadgetwidget.h \
     pfdqmlgadgetfactory.h \
     pfdqmlgadgetconfiguration.h \
-    pfdqmlgadgetoptionspage.h
+    pfdqmlgadgetoptionspage.h \
+    uavobjectqmlproxy.h
 
 SOURCES += \
     pfdqmlplugin.cpp \
@@ -25,7 +27,8 @@ SOURCES += \
     pfdqmlgadgetfactory.cpp \
     pfdqmlgadgetwidget.cpp \
     pfdqmlgadgetconfiguration.cpp \
-    pfdqmlgadgetoptionspage.cpp
+    pfdqmlgadgetoptionspage.cpp \
+    uavobjectqmlproxy.cpp
 
 
 contains(DEFINES,USE_OSG) {
@@ -37,6 +37,20 @@ PfdQmlGadget::~PfdQmlGadget()
    first time, so you have to be careful not to assume all the plugin values are initialized
    the first time you use them
  */
+// Set an environment variable, or remove it when the value is empty
+static void setEnvironment(const char *name, const QByteArray &value)
+{
+    if (!value.isEmpty()) {
+        qputenv(name, value);
+    } else {
+#ifdef Q_OS_WIN32
+        qputenv(name, "");
+#else
+        unsetenv(name);
+#endif
+    }
+}
+
 void PfdQmlGadget::loadConfiguration(IUAVGadgetConfiguration *config)
 {
     PfdQmlGadgetConfiguration *m = qobject_cast<PfdQmlGadgetConfiguration *>(config);
@@ -53,16 +67,15 @@ void PfdQmlGadget::loadConfiguration(IUAVGadgetConfiguration *config)
     m_widget->setSpeedUnit(m->speedUnit());
     m_widget->setAltitudeFactor(m->altitudeFactor());
     m_widget->setAltitudeUnit(m->altitudeUnit());
+    m_widget->setMaxFrameRate(m->maxFrameRate());
+    m_widget->setTerrainLodScale(m->terrainLodScale());
 
     // setting OSGEARTH_CACHE_ONLY seems to work the most reliably
     // between osgEarth versions I tried
-    if (m->cacheOnly()) {
-        qputenv("OSGEARTH_CACHE_ONLY", "true");
-    } else {
-#ifdef Q_OS_WIN32
-        qputenv("OSGEARTH_CACHE_ONLY", "");
-#else
-        unsetenv("OSGEARTH_CACHE_ONLY");
-#endif
-    }
+    setEnvironment("OSGEARTH_CACHE_ONLY", m->cacheOnly() ? "true" : "");
+
+    // The tile cache and the paged tile budget are picked up when the terrain is loaded
+    setEnvironment("OSGEARTH_CACHE_DRIVER", "filesystem");
+    setEnvironment("OSGEARTH_CACHE_PATH", m->terrainCachePath().toLocal8Bit());
+    setEnvironment("OSG_MAX_PAGEDLOD", m->terrainMaxTiles() > 0 ? QByteArray::number(m->terrainMaxTiles()) : QByteArray());
 }
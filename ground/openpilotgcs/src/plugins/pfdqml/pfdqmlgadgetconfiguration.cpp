@@ -32,8 +32,14 @@ PfdQmlGadgetConfiguration::PfdQmlGadgetConfiguration(QString classId, QSettings
     m_longitude(0),
     m_altitude(0),
     m_cacheOnly(false),
+    m_terrainCachePath(Utils::PathUtils().GetStoragePath() + "osgearthcache"),
+    m_terrainLodScale(1.0),
+    m_terrainMaxTiles(0),
+    m_terrainSeedRadius(5.0),
+    m_terrainSeedLevel(14),
     m_speedFactor(1.0),
-    m_altitudeFactor(1.0)
+    m_altitudeFactor(1.0),
+    m_maxFrameRate(0)
 {
     m_speedMap[1.0]       = "m/s";
     m_speedMap[3.6]       = "km/h";
@@ -58,8 +64,14 @@ PfdQmlGadgetConfiguration::PfdQmlGadgetConfiguration(QString classId, QSettings
         m_longitude          = qSettings->value("longitude").toDouble();
         m_altitude           = qSettings->value("altitude").toDouble();
         m_cacheOnly          = qSettings->value("cacheOnly").toBool();
+        m_terrainCachePath   = qSettings->value("terrainCachePath", m_terrainCachePath).toString();
+        m_terrainLodScale    = qSettings->value("terrainLodScale", m_terrainLodScale).toDouble();
+        m_terrainMaxTiles    = qSettings->value("terrainMaxTiles", m_terrainMaxTiles).toInt();
+        m_terrainSeedRadius  = qSettings->value("terrainSeedRadius", m_terrainSeedRadius).toDouble();
+        m_terrainSeedLevel   = qSettings->value("terrainSeedLevel", m_terrainSeedLevel).toInt();
         m_speedFactor        = qSettings->value("speedFactor").toDouble();
         m_altitudeFactor     = qSettings->value("altitudeFactor").toDouble();
+        m_maxFrameRate       = qSettings->value("maxFrameRate", 0).toInt();
     }
 }
 
@@ -80,8 +92,14 @@ IUAVGadgetConfiguration *PfdQmlGadgetConfiguration::clone()
     m->m_longitude          = m_longitude;
     m->m_altitude           = m_altitude;
     m->m_cacheOnly          = m_cacheOnly;
+    m->m_terrainCachePath   = m_terrainCachePath;
+    m->m_terrainLodScale    = m_terrainLodScale;
+    m->m_terrainMaxTiles    = m_terrainMaxTiles;
+    m->m_terrainSeedRadius  = m_terrainSeedRadius;
+    m->m_terrainSeedLevel   = m_terrainSeedLevel;
     m->m_speedFactor        = m_speedFactor;
     m->m_altitudeFactor     = m_altitudeFactor;
+    m->m_maxFrameRate       = m_maxFrameRate;
 
     return m;
 }
@@ -105,6 +123,12 @@ void PfdQmlGadgetConfiguration::saveConfig(QSettings *qSettings) const
     qSettings->setValue("longitude", m_longitude);
     qSettings->setValue("altitude", m_altitude);
     qSettings->setValue("cacheOnly", m_cacheOnly);
+    qSettings->setValue("terrainCachePath", m_terrainCachePath);
+    qSettings->setValue("terrainLodScale", m_terrainLodScale);
+    qSettings->setValue("terrainMaxTiles", m_terrainMaxTiles);
+    qSettings->setValue("terrainSeedRadius", m_terrainSeedRadius);
+    qSettings->setValue("terrainSeedLevel", m_terrainSeedLevel);
     qSettings->setValue("speedFactor", m_speedFactor);
     qSettings->setValue("altitudeFactor", m_altitudeFactor);
+    qSettings->setValue("maxFrameRate", m_maxFrameRate);
 }
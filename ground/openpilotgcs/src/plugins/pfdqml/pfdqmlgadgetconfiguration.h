@@ -63,6 +63,26 @@ public:
     {
         m_cacheOnly = flag;
     }
+    void setTerrainCachePath(const QString &path)
+    {
+        m_terrainCachePath = path;
+    }
+    void setTerrainLodScale(double scale)
+    {
+        m_terrainLodScale = scale;
+    }
+    void setTerrainMaxTiles(int tiles)
+    {
+        m_terrainMaxTiles = tiles;
+    }
+    void setTerrainSeedRadius(double km)
+    {
+        m_terrainSeedRadius = km;
+    }
+    void setTerrainSeedLevel(int level)
+    {
+        m_terrainSeedLevel = level;
+    }
     void setSpeedFactor(double factor)
     {
         m_speedFactor = factor;
@@ -71,6 +91,10 @@ public:
     {
         m_altitudeFactor = factor;
     }
+    void setMaxFrameRate(int fps)
+    {
+        m_maxFrameRate = fps;
+    }
 
     QString qmlFile() const
     {
@@ -108,6 +132,26 @@ public:
     {
         return m_cacheOnly;
     }
+    QString terrainCachePath() const
+    {
+        return m_terrainCachePath;
+    }
+    double terrainLodScale() const
+    {
+        return m_terrainLodScale;
+    }
+    int terrainMaxTiles() const
+    {
+        return m_terrainMaxTiles;
+    }
+    double terrainSeedRadius() const
+    {
+        return m_terrainSeedRadius;
+    }
+    int terrainSeedLevel() const
+    {
+        return m_terrainSeedLevel;
+    }
     double speedFactor() const
     {
         return m_speedFactor;
@@ -116,6 +160,10 @@ public:
     {
         return m_altitudeFactor;
     }
+    int maxFrameRate() const
+    {
+        return m_maxFrameRate;
+    }
 
     QString speedUnit() const
     {
@@ -150,8 +198,14 @@ private:
     double m_longitude;
     double m_altitude;
     bool m_cacheOnly;
+    QString m_terrainCachePath; // osgEarth file system tile cache
+    double m_terrainLodScale; // > 1 keeps coarser tiles for longer
+    int m_terrainMaxTiles; // paged tiles kept in memory, 0 for the osg default
+    double m_terrainSeedRadius; // km around the location pre-seeded in the cache
+    int m_terrainSeedLevel; // deepest level pre-seeded
     double m_speedFactor;
     double m_altitudeFactor;
+    int m_maxFrameRate; // 0 means no limit, redraw at most once per display refresh
     QMap<double, QString> m_speedMap;
     QMap<double, QString> m_altitudeMap;
 };
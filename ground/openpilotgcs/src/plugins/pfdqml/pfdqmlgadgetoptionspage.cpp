@@ -23,13 +23,24 @@
 
 
 #include <QFileDialog>
+#include <QMessageBox>
 #include <QtAlgorithms>
 #include <QStringList>
+#include <QtConcurrent/QtConcurrentRun>
+#include <math.h>
+
+#ifdef USE_OSG
+#include <osgDB/ReadFile>
+#include <osgEarth/MapNode>
+#include <osgEarthUtil/CacheSeed>
+#endif
 
 PfdQmlGadgetOptionsPage::PfdQmlGadgetOptionsPage(PfdQmlGadgetConfiguration *config, QObject *parent) :
     IOptionsPage(parent),
     m_config(config)
-{}
+{
+    connect(&m_seedWatcher, SIGNAL(finished()), this, SLOT(terrainSeeded()));
+}
 
 // creates options page widget (uses the UI file)
 QWidget *PfdQmlGadgetOptionsPage::createPage(QWidget *parent)
@@ -62,6 +73,16 @@ QWidget *PfdQmlGadgetOptionsPage::createPage(QWidget *parent)
     options_page->altitude->setText(QString::number(m_config->altitude()));
     options_page->useOnlyCache->setChecked(m_config->cacheOnly());
 
+    options_page->terrainCachePath->setExpectedKind(Utils::PathChooser::Directory);
+    options_page->terrainCachePath->setPromptDialogTitle(tr("Choose terrain tile cache directory"));
+    options_page->terrainCachePath->setPath(m_config->terrainCachePath());
+    options_page->terrainLodScale->setValue(m_config->terrainLodScale());
+    options_page->terrainMaxTiles->setValue(m_config->terrainMaxTiles());
+    options_page->terrainSeedRadius->setValue(m_config->terrainSeedRadius());
+    options_page->terrainSeedLevel->setValue(m_config->terrainSeedLevel());
+    options_page->preSeedTerrain->setEnabled(!m_seedWatcher.isRunning());
+    connect(options_page->preSeedTerrain, SIGNAL(clicked()), this, SLOT(preSeedTerrain()));
+
     // Setup units combos
     QMapIterator<double, QString> iter = m_config->speedMapIterator();
     while (iter.hasNext()) {
@@ -77,6 +98,8 @@ QWidget *PfdQmlGadgetOptionsPage::createPage(QWidget *parent)
     }
     options_page->altUnitCombo->setCurrentIndex(options_page->altUnitCombo->findData(m_config->altitudeFactor()));
 
+    options_page->maxFrameRate->setValue(m_config->maxFrameRate());
+
 #ifndef USE_OSG
     options_page->showTerrain->setChecked(false);
     options_page->showTerrain->setVisible(false);
@@ -108,10 +131,80 @@ void PfdQmlGadgetOptionsPage::apply()
     m_config->setLongitude(options_page->longitude->text().toDouble());
     m_config->setAltitude(options_page->altitude->text().toDouble());
     m_config->setCacheOnly(options_page->useOnlyCache->isChecked());
+    m_config->setTerrainCachePath(options_page->terrainCachePath->path());
+    m_config->setTerrainLodScale(options_page->terrainLodScale->value());
+    m_config->setTerrainMaxTiles(options_page->terrainMaxTiles->value());
+    m_config->setTerrainSeedRadius(options_page->terrainSeedRadius->value());
+    m_config->setTerrainSeedLevel(options_page->terrainSeedLevel->value());
 
     m_config->setSpeedFactor(options_page->speedUnitCombo->itemData(options_page->speedUnitCombo->currentIndex()).toDouble());
     m_config->setAltitudeFactor(options_page->altUnitCombo->itemData(options_page->altUnitCombo->currentIndex()).toDouble());
+    m_config->setMaxFrameRate(options_page->maxFrameRate->value());
 }
 
 void PfdQmlGadgetOptionsPage::finish()
 {}
+
+#ifdef USE_OSG
+// Download every tile of the terrain layers up to level, for the area within radius km of
+// latitude/longitude, into the osgEarth cache. Runs outside the GUI thread.
+static bool seedTerrainCache(QString earthFile, double latitude, double longitude, double radius, int level)
+{
+    osg::ref_ptr<osg::Node> node = osgDB::readNodeFile(earthFile.toStdString());
+    osgEarth::MapNode *mapNode   = osgEarth::MapNode::findMapNode(node.get());
+
+    if (!mapNode) {
+        return false;
+    }
+
+    // 1 degree of latitude is about 111 km
+    double dLatitude  = radius / 111.32;
+    double dLongitude = dLatitude / qMax(0.01, cos(latitude * M_PI / 180.0));
+
+    osgEarth::Util::CacheSeed seeder;
+    seeder.setMinLevel(0);
+    seeder.setMaxLevel(level);
+    seeder.addExtent(osgEarth::GeoExtent(osgEarth::SpatialReference::create("wgs84"),
+                                         longitude - dLongitude, latitude - dLatitude,
+                                         longitude + dLongitude, latitude + dLatitude));
+    seeder.seed(mapNode->getMap());
+    return true;
+}
+#endif
+
+void PfdQmlGadgetOptionsPage::preSeedTerrain()
+{
+#ifdef USE_OSG
+    if (m_seedWatcher.isRunning()) {
+        return;
+    }
+    if (options_page->useOnlyCache->isChecked()) {
+        QMessageBox::warning(0, tr("Pre seed terrain cache"), tr("Disable \"Use only cache data\" and apply to download the terrain."));
+        return;
+    }
+
+    // The seeder fills the same cache the PFD reads from
+    qputenv("OSGEARTH_CACHE_DRIVER", "filesystem");
+    qputenv("OSGEARTH_CACHE_PATH", options_page->terrainCachePath->path().toLocal8Bit());
+
+    m_seedButton = options_page->preSeedTerrain;
+    m_seedButton->setEnabled(false);
+    m_seedWatcher.setFuture(QtConcurrent::run(seedTerrainCache, options_page->earthFile->path(),
+                                              options_page->latitude->text().toDouble(),
+                                              options_page->longitude->text().toDouble(),
+                                              options_page->terrainSeedRadius->value(),
+                                              options_page->terrainSeedLevel->value()));
+#endif
+}
+
+void PfdQmlGadgetOptionsPage::terrainSeeded()
+{
+    if (m_seedButton) {
+        m_seedButton->setEnabled(true);
+    }
+    if (!m_seedWatcher.result()) {
+        QMessageBox::warning(0, tr("Pre seed terrain cache"), tr("The OsgEarth file could not be loaded."));
+    } else {
+        QMessageBox::information(0, tr("Pre seed terrain cache"), tr("The terrain cache is ready."));
+    }
+}
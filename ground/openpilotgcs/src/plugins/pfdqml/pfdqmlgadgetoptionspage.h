@@ -21,6 +21,9 @@
 #include "QString"
 #include <QStringList>
 #include <QDebug>
+#include <QFutureWatcher>
+#include <QPointer>
+#include <QPushButton>
 
 namespace Core {
 class IUAVGadgetConfiguration;
@@ -46,8 +49,13 @@ public:
 private:
     Ui::PfdQmlGadgetOptionsPage *options_page;
     PfdQmlGadgetConfiguration *m_config;
+    QFutureWatcher<bool> m_seedWatcher;
+    // The page may be closed before seeding completes
+    QPointer<QPushButton> m_seedButton;
 
 private slots:
+    void preSeedTerrain();
+    void terrainSeeded();
 };
 
 #endif // PfdQmlGADGETOPTIONSPAGE_H
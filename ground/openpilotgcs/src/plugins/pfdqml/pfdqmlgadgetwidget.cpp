@@ -18,6 +18,7 @@
 #include "extensionsystem/pluginmanager.h"
 #include "uavobjectmanager.h"
 #include "uavobject.h"
+#include "uavobjectqmlproxy.h"
 #include "utils/svgimageprovider.h"
 #ifdef USE_OSG
 #include "osgearth.h"
@@ -40,13 +41,21 @@ PfdQmlGadgetWidget::PfdQmlGadgetWidget(QWindow *parent) :
     m_latitude(46.671478),
     m_longitude(10.158932),
     m_altitude(2000),
+    m_terrainLodScale(1.0),
     m_speedUnit("m/s"),
     m_speedFactor(1.0),
     m_altitudeUnit("m"),
-    m_altitudeFactor(1.0)
+    m_altitudeFactor(1.0),
+    m_maxFrameRate(0),
+    m_frameRequested(false)
 {
     setResizeMode(SizeRootObjectToView);
 
+    m_frameTimer.setSingleShot(true);
+    connect(&m_frameTimer, SIGNAL(timeout()), this, SLOT(requestFrame()));
+    // sample the objects once per frame, just before the scene graph is synchronized
+    connect(this, SIGNAL(afterAnimating()), this, SLOT(syncObjects()));
+
     // setViewport(new QGLWidget(QGLFormat(QGL::SampleBuffers)));
 
     QStringList objectsToExport;
@@ -86,7 +95,10 @@ PfdQmlGadgetWidget::PfdQmlGadgetWidget(QWindow *parent) :
         UAVObject *object = objManager->getObject(objectName);
 
         if (object) {
-            engine()->rootContext()->setContextProperty(objectName, object);
+            UAVObjectQmlProxy *proxy = new UAVObjectQmlProxy(object, this);
+            connect(proxy, SIGNAL(dirty()), this, SLOT(requestFrame()));
+            m_proxies << proxy;
+            engine()->rootContext()->setContextProperty(objectName, proxy);
         } else {
             qWarning() << "Failed to load object" << objectName;
         }
@@ -225,3 +237,47 @@ void PfdQmlGadgetWidget::setAltitude(double arg)
         emit altitudeChanged(arg);
     }
 }
+
+void PfdQmlGadgetWidget::setTerrainLodScale(double scale)
+{
+    if (!qFuzzyCompare(m_terrainLodScale, scale)) {
+        m_terrainLodScale = scale;
+        emit terrainLodScaleChanged(scale);
+    }
+}
+
+void PfdQmlGadgetWidget::setMaxFrameRate(int fps)
+{
+    m_maxFrameRate = qMax(0, fps);
+}
+
+// Called when an exported object changed, schedules a frame if none is pending
+// and the frame rate limit allows it
+void PfdQmlGadgetWidget::requestFrame()
+{
+    if (m_frameRequested || m_frameTimer.isActive()) {
+        return;
+    }
+
+    if (m_maxFrameRate > 0 && m_frameClock.isValid()) {
+        qint64 interval = 1000 / m_maxFrameRate;
+        qint64 elapsed  = m_frameClock.elapsed();
+        if (elapsed < interval) {
+            m_frameTimer.start(interval - elapsed);
+            return;
+        }
+    }
+
+    m_frameRequested = true;
+    update();
+}
+
+void PfdQmlGadgetWidget::syncObjects()
+{
+    m_frameRequested = false;
+    m_frameClock.restart();
+
+    foreach(UAVObjectQmlProxy * proxy, m_proxies) {
+        proxy->sync();
+    }
+}
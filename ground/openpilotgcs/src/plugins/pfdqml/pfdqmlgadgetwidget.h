@@ -19,6 +19,10 @@
 
 #include "pfdqmlgadgetconfiguration.h"
 #include <QQuickView>
+#include <QElapsedTimer>
+#include <QTimer>
+
+class UAVObjectQmlProxy;
 
 class PfdQmlGadgetWidget : public QQuickView {
     Q_OBJECT Q_PROPERTY(QString earthFile READ earthFile WRITE setEarthFile NOTIFY earthFileChanged)
@@ -35,6 +39,7 @@ class PfdQmlGadgetWidget : public QQuickView {
     Q_PROPERTY(double latitude READ latitude WRITE setLatitude NOTIFY latitudeChanged)
     Q_PROPERTY(double longitude READ longitude WRITE setLongitude NOTIFY longitudeChanged)
     Q_PROPERTY(double altitude READ altitude WRITE setAltitude NOTIFY altitudeChanged)
+    Q_PROPERTY(double terrainLodScale READ terrainLodScale WRITE setTerrainLodScale NOTIFY terrainLodScaleChanged)
 
 public:
     PfdQmlGadgetWidget(QWindow *parent = 0);
@@ -84,6 +89,16 @@ public:
         return m_altitude;
     }
 
+    double terrainLodScale() const
+    {
+        return m_terrainLodScale;
+    }
+
+    int maxFrameRate() const
+    {
+        return m_maxFrameRate;
+    }
+
 public slots:
     void setEarthFile(QString arg);
     void setTerrainEnabled(bool arg);
@@ -100,6 +115,9 @@ public slots:
     void setAltitude(double arg);
 
     void setActualPositionUsed(bool arg);
+    void setTerrainLodScale(double scale);
+
+    void setMaxFrameRate(int fps);
 
 signals:
     void earthFileChanged(QString arg);
@@ -109,6 +127,7 @@ signals:
     void latitudeChanged(double arg);
     void longitudeChanged(double arg);
     void altitudeChanged(double arg);
+    void terrainLodScaleChanged(double arg);
 
     void speedUnitChanged(QString arg);
     void speedFactorChanged(double arg);
@@ -118,6 +137,10 @@ signals:
 protected:
     void mouseReleaseEvent(QMouseEvent *event);
 
+private slots:
+    void requestFrame();
+    void syncObjects();
+
 private:
     QString m_qmlFileName;
     QString m_earthFile;
@@ -128,11 +151,19 @@ private:
     double m_latitude;
     double m_longitude;
     double m_altitude;
+    double m_terrainLodScale;
 
     QString m_speedUnit;
     double m_speedFactor;
     QString m_altitudeUnit;
     double m_altitudeFactor;
+
+    // QML sees frame synchronized copies of the exported objects
+    QList<UAVObjectQmlProxy *> m_proxies;
+    int m_maxFrameRate;
+    bool m_frameRequested;
+    QElapsedTimer m_frameClock;
+    QTimer m_frameTimer;
 };
 
 #endif /* PFDQMLGADGETWIDGET_H_ */
@@ -0,0 +1,57 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+
+#include "uavobjectqmlproxy.h"
+#include "uavobject.h"
+
+UAVObjectQmlProxy::UAVObjectQmlProxy(UAVObject *object, QObject *parent) :
+    QQmlPropertyMap(parent),
+    m_object(object),
+    m_dirty(1)
+{
+    const QMetaObject *mo = m_object->metaObject();
+
+    for (int i = QObject::staticMetaObject.propertyCount(); i < mo->propertyCount(); ++i) {
+        m_properties << mo->property(i);
+    }
+
+    // Direct connection: the object is updated from the telemetry thread and
+    // only the flag is touched here, the values are read in sync()
+    connect(m_object, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(objectUpdated()), Qt::DirectConnection);
+
+    sync();
+}
+
+bool UAVObjectQmlProxy::sync()
+{
+    if (!m_dirty.testAndSetOrdered(1, 0)) {
+        return false;
+    }
+
+    // insert() only notifies the bindings of values that actually changed
+    foreach(const QMetaProperty &property, m_properties) {
+        insert(property.name(), property.read(m_object));
+    }
+    return true;
+}
+
+void UAVObjectQmlProxy::objectUpdated()
+{
+    if (m_dirty.testAndSetOrdered(0, 1)) {
+        emit dirty();
+    }
+}
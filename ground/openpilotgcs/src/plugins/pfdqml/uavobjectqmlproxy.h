@@ -0,0 +1,63 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+
+#ifndef UAVOBJECTQMLPROXY_H_
+#define UAVOBJECTQMLPROXY_H_
+
+#include <QQmlPropertyMap>
+#include <QMetaProperty>
+#include <QAtomicInt>
+
+class UAVObject;
+
+/**
+ * QML facing copy of a UAVObject.
+ *
+ * Exposes the same properties as the object it wraps but only refreshes them
+ * when sync() is called, which the PFD does once per rendered frame.
+ * Telemetry can update an object hundreds of times per second; binding to the
+ * object directly re-evaluates every dependent binding on each update, most of
+ * which are never displayed.
+ */
+class UAVObjectQmlProxy : public QQmlPropertyMap {
+    Q_OBJECT
+
+public:
+    UAVObjectQmlProxy(UAVObject *object, QObject *parent = 0);
+
+    bool isDirty() const
+    {
+        return m_dirty.load() != 0;
+    }
+
+    // Copies the current object values, returns true if the object had changed
+    bool sync();
+
+signals:
+    // Emitted (from the thread updating the object) when the object changes after a sync
+    void dirty();
+
+private slots:
+    void objectUpdated();
+
+private:
+    UAVObject *m_object;
+    QList<QMetaProperty> m_properties;
+    QAtomicInt m_dirty;
+};
+
+#endif /* UAVOBJECTQMLPROXY_H_ */
@@ -162,6 +162,13 @@ plugin_ipconnection.subdir = ipconnection
 plugin_ipconnection.depends = plugin_coreplugin
 SUBDIRS += plugin_ipconnection
 
+# Shared memory connection plugin, for SITL on the same host
+unix {
+    plugin_shmconnection.subdir = shmconnection
+    plugin_shmconnection.depends = plugin_coreplugin
+    SUBDIRS += plugin_shmconnection
+}
+
 #HITL Simulation gadget
 plugin_hitl.subdir = hitl
 plugin_hitl.depends = plugin_coreplugin
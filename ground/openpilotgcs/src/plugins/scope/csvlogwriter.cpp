@@ -0,0 +1,258 @@
+/**
+ ******************************************************************************
+ *
+ * @file       csvlogwriter.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ScopePlugin Scope Gadget Plugin
+ * @{
+ * @brief The scope Gadget, graphically plots the states of UAVObjects
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "csvlogwriter.h"
+
+#include <QDebug>
+#include <QMutexLocker>
+#include <math.h>
+#include <string.h>
+
+// The queued rows are written at least this often
+#define WRITE_PERIOD_MS  250
+// Reserved for each row buffer, the thread is woken up early when half of it is used
+#define ROW_BUFFER_SIZE  (1 << 20)
+// Rows are dropped beyond this, when the disk can not keep up
+#define MAX_PENDING_SIZE (16 << 20)
+// The formatted text is written in chunks of this size
+#define TEXT_CHUNK_SIZE  (64 << 10)
+// Longest formatted number, "%.10g" of a double
+#define MAX_NUMBER_TEXT  24
+#define MSECS_PER_DAY    86400000
+
+CsvLogWriter::CsvLogWriter() :
+    m_startMsecsOfDay(0), m_binary(false), m_rowSize(0), m_day(-1), m_stop(false), m_dropped(0)
+{}
+
+CsvLogWriter::~CsvLogWriter()
+{
+    close();
+}
+
+bool CsvLogWriter::open(const QString &fileName, const QList<Column> &columns, const QDateTime &startTime, bool binary)
+{
+    close();
+
+    m_file.setFileName(fileName);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        qDebug() << "Unable to open " << m_file.fileName() << " for csv logging";
+        return false;
+    }
+
+    m_columns   = columns;
+    m_startTime = startTime;
+    m_startMsecsOfDay = startTime.time().msecsSinceStartOfDay();
+    m_binary    = binary;
+    m_rowSize   = 3 + columns.size();
+    m_day = -1;
+    m_stop = false;
+    m_dropped   = 0;
+
+    QByteArray header = binary ? "" : "date, Time, ";
+    header += "Sec since start, Connected, Data changed";
+    // Date, time, seconds since start and flags
+    int lineSize = 80;
+    m_options.clear();
+    foreach(const Column &column, columns) {
+        header += ", " + column.name.toUtf8();
+
+        QList<QByteArray> options;
+        int optionSize = MAX_NUMBER_TEXT;
+        foreach(const QString &option, column.options) {
+            options.append(option.toUtf8());
+            optionSize = qMax(optionSize, options.last().size());
+        }
+        m_options.append(options);
+        lineSize += optionSize + 2;
+    }
+    header += "\n";
+    m_file.write(header);
+
+    m_pending.reserve(ROW_BUFFER_SIZE);
+    m_writing.reserve(ROW_BUFFER_SIZE);
+    m_text.reserve(TEXT_CHUNK_SIZE + lineSize);
+    m_line.resize(lineSize);
+
+    start(QThread::LowPriority);
+    return true;
+}
+
+void CsvLogWriter::close()
+{
+    if (isRunning()) {
+        m_mutex.lock();
+        m_stop = true;
+        m_wakeup.wakeOne();
+        m_mutex.unlock();
+        wait();
+    }
+    if (m_file.isOpen()) {
+        if (m_dropped) {
+            qDebug() << "csv logging: the disk did not keep up," << m_dropped << "rows dropped from" << m_file.fileName();
+        }
+        m_file.close();
+    }
+    m_pending.resize(0);
+    m_writing.resize(0);
+}
+
+void CsvLogWriter::appendRow(qint64 msecs, bool connected, bool updated, const double *values)
+{
+    const double flags[3] = { (double)msecs, connected ? 1.0 : 0.0, updated ? 1.0 : 0.0 };
+    const int valuesSize  = m_columns.size() * sizeof(double);
+
+    QMutexLocker locker(&m_mutex);
+
+    if (m_pending.size() + (int)sizeof(flags) + valuesSize > MAX_PENDING_SIZE) {
+        m_dropped++;
+        return;
+    }
+    m_pending.append((const char *)flags, sizeof(flags));
+    m_pending.append((const char *)values, valuesSize);
+    if (m_pending.size() >= ROW_BUFFER_SIZE / 2) {
+        m_wakeup.wakeOne();
+    }
+}
+
+void CsvLogWriter::run()
+{
+    QMutexLocker locker(&m_mutex);
+
+    while (true) {
+        if (m_pending.isEmpty() && !m_stop) {
+            m_wakeup.wait(&m_mutex, WRITE_PERIOD_MS);
+        }
+        if (m_pending.isEmpty()) {
+            if (m_stop) {
+                break;
+            }
+            continue;
+        }
+
+        // The GUI thread goes on queueing in the other buffer while these rows are written
+        m_writing.swap(m_pending);
+        locker.unlock();
+
+        writeRows(m_writing);
+        // Keeps the reserved capacity
+        m_writing.resize(0);
+
+        locker.relock();
+    }
+}
+
+void CsvLogWriter::writeRows(QByteArray &rows)
+{
+    const int rowCount = rows.size() / (m_rowSize * sizeof(double));
+
+    if (m_binary) {
+        double *row = (double *)rows.data();
+        for (int i = 0; i < rowCount; i++, row += m_rowSize) {
+            row[0] /= 1000.0;
+        }
+        m_file.write(rows);
+        m_file.flush();
+        return;
+    }
+
+    const double *row = (const double *)rows.constData();
+    for (int i = 0; i < rowCount; i++, row += m_rowSize) {
+        qint64 msecs = qMax((qint64)0, (qint64)row[0]);
+        qint64 time  = m_startMsecsOfDay + msecs;
+        qint64 day   = time / MSECS_PER_DAY;
+        if (day != m_day) {
+            m_day = day;
+            m_dateText = m_startTime.date().addDays(day).toString("yyyy-MM-dd").toLatin1();
+        }
+        int msecsOfDay = time % MSECS_PER_DAY;
+
+        char *out = m_line.data();
+        memcpy(out, m_dateText.constData(), m_dateText.size());
+        out += m_dateText.size();
+        out += qsnprintf(out, 32, ", %02d:%02d:%02d.%d, ", msecsOfDay / 3600000, (msecsOfDay / 60000) % 60,
+                         (msecsOfDay / 1000) % 60, msecsOfDay % 1000);
+        out  = formatValue(out, msecs / 1000.0, QList<QByteArray>());
+        *out++ = ',';
+        *out++ = ' ';
+        *out++ = row[1] ? '1' : '0';
+        *out++ = ',';
+        *out++ = ' ';
+        *out++ = row[2] ? '1' : '0';
+        for (int j = 0; j < m_columns.size(); j++) {
+            *out++ = ',';
+            *out++ = ' ';
+            out    = formatValue(out, row[3 + j], m_options.at(j));
+        }
+        *out++ = '\n';
+
+        m_text.append(m_line.constData(), out - m_line.constData());
+        if (m_text.size() >= TEXT_CHUNK_SIZE) {
+            m_file.write(m_text);
+            m_text.resize(0);
+        }
+    }
+    m_file.write(m_text);
+    m_text.resize(0);
+    m_file.flush();
+}
+
+/**
+ * Formats value as "%.10g" would, without going through the C library for the
+ * integers most fields hold. NaN is an empty cell, an enum is its option name.
+ */
+char *CsvLogWriter::formatValue(char *out, double value, const QList<QByteArray> &options)
+{
+    if (value != value) {
+        return out;
+    }
+
+    if (!options.isEmpty()) {
+        const QByteArray &option = options.value((int)value);
+        memcpy(out, option.constData(), option.size());
+        return out + option.size();
+    }
+
+    if (value == floor(value) && fabs(value) < 1e10) {
+        qint64 integer = (qint64)value;
+        if (integer < 0) {
+            *out++  = '-';
+            integer = -integer;
+        }
+        char digits[16];
+        int count = 0;
+        do {
+            digits[count++] = '0' + integer % 10;
+            integer /= 10;
+        } while (integer);
+        while (count) {
+            *out++ = digits[--count];
+        }
+        return out;
+    }
+
+    return out + qsnprintf(out, MAX_NUMBER_TEXT, "%.10g", value);
+}
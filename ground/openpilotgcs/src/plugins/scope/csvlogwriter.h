@@ -0,0 +1,111 @@
+/**
+ ******************************************************************************
+ *
+ * @file       csvlogwriter.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ScopePlugin Scope Gadget Plugin
+ * @{
+ * @brief The scope Gadget, graphically plots the states of UAVObjects
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef CSVLOGWRITER_H
+#define CSVLOGWRITER_H
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QFile>
+#include <QList>
+#include <QMutex>
+#include <QStringList>
+#include <QThread>
+#include <QWaitCondition>
+
+/*!
+   \brief Writes the scope log from its own thread. The GUI thread only copies
+   the values of each row into a pre-sized buffer, the rows are formatted and
+   written in the background.
+
+   A row is the time since the start in ms, the connected and data changed flags
+   and one value per column, NaN where the curve has no data yet, enums being the
+   index of their option.
+
+   The log is either CSV text, or binary: the CSV header line of the columns
+   after the date and time, followed by the rows as doubles in the host byte
+   order, the time in seconds, the flags, then the values.
+ */
+class CsvLogWriter : public QThread {
+    Q_OBJECT
+
+public:
+    struct Column {
+        QString     name;
+        // Option names of an enum, empty for a number
+        QStringList options;
+    };
+
+    CsvLogWriter();
+    ~CsvLogWriter();
+
+    // Creates the file, writes the header and starts the thread
+    bool open(const QString &fileName, const QList<Column> &columns, const QDateTime &startTime, bool binary);
+    // Writes the queued rows, stops the thread and closes the file
+    void close();
+
+    int columnCount() const
+    {
+        return m_columns.size();
+    }
+
+    // Queues a row, values holds columnCount() values
+    void appendRow(qint64 msecs, bool connected, bool updated, const double *values);
+
+protected:
+    void run();
+
+private:
+    void writeRows(QByteArray &rows);
+    char *formatValue(char *out, double value, const QList<QByteArray> &options);
+
+    QFile m_file;
+    QList<Column> m_columns;
+    QList<QList<QByteArray> > m_options;
+    QDateTime m_startTime;
+    int m_startMsecsOfDay;
+    bool m_binary;
+    // Doubles per row
+    int m_rowSize;
+
+    // Day and date text of the last row written
+    qint64 m_day;
+    QByteArray m_dateText;
+
+    QMutex m_mutex;
+    QWaitCondition m_wakeup;
+    bool m_stop;
+    // Rows queued by the GUI thread and rows being written, swapped by the thread
+    QByteArray m_pending;
+    QByteArray m_writing;
+    // Text of the rows written, and of the row being formatted
+    QByteArray m_text;
+    QByteArray m_line;
+    quint64 m_dropped;
+};
+
+#endif // CSVLOGWRITER_H
@@ -27,17 +27,18 @@
 
 
 #include "plotdata.h"
+#include "qwt/src/qwt_plot_directpainter.h"
 #include <math.h>
 #include <QDebug>
+#include <QtConcurrent/QtConcurrentRun>
 
 PlotData::PlotData(UAVObject *object, UAVObjectField *field, int element,
                    int scaleOrderFactor, int meanSamples, QString mathFunction,
                    double plotDataSize, QPen pen, bool antialiased) :
-    m_scalePower(scaleOrderFactor), m_meanSamples(meanSamples),
-    m_meanSum(0.0f), m_mathFunction(mathFunction), m_correctionSum(0.0f),
-    m_correctionCount(0), m_plotDataSize(plotDataSize),
+    m_scalePower(scaleOrderFactor), m_math(mathFunction, meanSamples), m_plotDataSize(plotDataSize),
     m_object(object), m_field(field), m_element(element),
-    m_plotCurve(NULL), m_isVisible(true), m_pen(pen), m_isEnumPlot(false)
+    m_samples(new PlotSamples()), m_plotCurve(NULL), m_isVisible(true), m_pen(pen), m_isEnumPlot(false),
+    m_drawnIndex(-1), m_drawnMarkers(0)
 {
     if (m_field->getNumElements() > 1) {
         m_elementName = m_field->getElementNames().at(m_element);
@@ -62,12 +63,17 @@ PlotData::PlotData(UAVObject *object, UAVObjectField *field, int element,
     }
 
     m_plotCurve->setPen(m_pen);
-    m_plotCurve->setSamples(m_xDataEntries, m_yDataEntries);
+    m_plotCurve->setSamples(m_samples);
     m_isEnumPlot = m_field->getType() == UAVObjectField::ENUM;
+
+    m_series     = ScopeSampleStore::instance()->subscribe(this, m_object, m_field, m_element);
 }
 
 PlotData::~PlotData()
 {
+    if (m_series) {
+        ScopeSampleStore::instance()->unsubscribe(this, m_series);
+    }
     while (!m_enumMarkerList.isEmpty()) {
         QwtPlotMarker *marker = m_enumMarkerList.takeFirst();
         marker->detach();
@@ -90,41 +96,121 @@ void PlotData::setVisible(bool visible)
 
 void PlotData::updatePlotData()
 {
-    m_plotCurve->setSamples(m_xDataEntries, m_yDataEntries);
+    // Hand the curve about one min/max pair per pixel, however long the window is
+    if (m_plotCurve->plot()) {
+        m_samples->setMaxPoints(m_plotCurve->plot()->canvas()->width());
+    }
+    // The curve reads the samples in place, it only needs to know that they changed
+    m_plotCurve->itemChanged();
+}
+
+bool PlotData::append(UAVObject *obj)
+{
+    if ((obj != NULL && obj != m_object) || !m_series) {
+        return false;
+    }
+
+    ScopeSeries::Sample sample;
+    sample.time  = ScopeSampleStore::instance()->currentTime();
+    sample.value = m_series->decode(m_field);
+    return appendSample(sample);
+}
+
+bool PlotData::appendSample(const ScopeSeries::Sample &sample)
+{
+    // The x value of a sequential sample is its position in the window
+    return appendValue(sample.value, plotType() == SequentialPlot ? 0 : sample.time);
+}
+
+void PlotData::appendHistory()
+{
+    if (!m_series) {
+        return;
+    }
+
+    const PlotRing<ScopeSeries::Sample> &history = m_series->history();
+
+    for (int i = 0; i < history.size(); i++) {
+        appendSample(history.at(i));
+    }
+}
+
+void PlotData::setSuspended(bool suspended)
+{
+    if (suspended == (m_series == NULL)) {
+        return;
+    }
+
+    if (suspended) {
+        ScopeSampleStore::instance()->unsubscribe(this, m_series);
+        m_series = NULL;
+    } else {
+        // What was missed meanwhile is only known to the store
+        m_series = ScopeSampleStore::instance()->subscribe(this, m_object, m_field, m_element);
+        clearData();
+        appendHistory();
+    }
 }
 
 void PlotData::clear()
 {
-    m_meanSum = 0.0f;
-    m_correctionSum   = 0.0f;
-    m_correctionCount = 0;
-    m_xDataEntries.clear();
-    m_yDataEntries.clear();
+    clearData();
+    if (wantsInitialData()) {
+        append(m_object);
+    }
+}
+
+void PlotData::clearData()
+{
+    m_math.reset();
+    m_samples->clear();
+    m_drawnIndex = -1;
     while (!m_enumMarkerList.isEmpty()) {
         QwtPlotMarker *marker = m_enumMarkerList.takeFirst();
         marker->detach();
         delete marker;
     }
-    if (wantsInitialData()) {
-        append(m_object);
+}
+
+/**
+ * Replaces the plotted data with updates of the object taken from the replayed log.
+ * They are unpacked into a copy of the object, the object itself keeps its state.
+ */
+void PlotData::setReplayData(const QVector<LogFile::ReplaySample> &samples)
+{
+    clearData();
+
+    UAVDataObject *dataObject = dynamic_cast<UAVDataObject *>(m_object);
+    if (!dataObject || samples.isEmpty() || !m_series) {
+        return;
     }
+
+    UAVDataObject *copy   = dataObject->clone(m_object->getInstID());
+    UAVObjectField *field = copy->getField(m_field->getName());
+    foreach(const LogFile::ReplaySample &sample, samples) {
+        if (sample.size == (int)copy->getNumBytes()) {
+            copy->unpack(sample.data);
+            appendValue(m_series->decode(field), sample.timestamp / 1000.0);
+        }
+    }
+    delete copy;
 }
 
 bool PlotData::hasData() const
 {
     if (!m_isEnumPlot) {
-        return !m_xDataEntries.isEmpty();
+        return !m_samples->isEmpty();
     } else {
         return !m_enumMarkerList.isEmpty();
     }
 }
 
-QString PlotData::lastDataAsString()
+double PlotData::lastData()
 {
     if (!m_isEnumPlot) {
-        return QString().sprintf("%3.10g", m_yDataEntries.last());
+        return m_samples->lastY();
     } else {
-        return m_enumMarkerList.last()->title().text();
+        return m_field->getOptions().indexOf(m_enumMarkerList.last()->title().text());
     }
 }
 
@@ -133,6 +219,51 @@ void PlotData::attach(QwtPlot *plot)
     m_plotCurve->attach(plot);
 }
 
+bool PlotData::canDrawNewSamples() const
+{
+    if (!m_plotCurve->plot() || !m_plotCurve->isVisible()) {
+        return true;
+    }
+    // New markers are attached to the plot, they need a replot
+    if (m_drawnIndex < 0 || m_enumMarkerList.size() != m_drawnMarkers) {
+        return false;
+    }
+    if (!m_plotCurve->plot()->axisAutoScale(m_plotCurve->yAxis())) {
+        return true;
+    }
+
+    // An autoscaled axis has to grow first
+    QwtInterval range = m_plotCurve->plot()->axisInterval(m_plotCurve->yAxis());
+    qint64 first = qMax(m_drawnIndex, m_samples->firstIndex()) - m_samples->firstIndex();
+    m_samples->setRaw(true);
+    for (int i = (int)first; i < m_samples->count(); i++) {
+        if (!range.contains(m_samples->sample(i).y())) {
+            m_samples->setRaw(false);
+            return false;
+        }
+    }
+    m_samples->setRaw(false);
+    return true;
+}
+
+void PlotData::drawNewSamples(QwtPlotDirectPainter *painter)
+{
+    if (m_plotCurve->plot() && m_plotCurve->isVisible() && m_samples->endIndex() > m_drawnIndex) {
+        // From the last sample drawn, to join it to the new ones
+        qint64 from = qMax(m_drawnIndex - 1, m_samples->firstIndex()) - m_samples->firstIndex();
+        m_samples->setRaw(true);
+        painter->drawSeries(m_plotCurve, (int)from, m_samples->count() - 1);
+        m_samples->setRaw(false);
+    }
+    markDrawn();
+}
+
+void PlotData::markDrawn()
+{
+    m_drawnIndex   = m_samples->endIndex();
+    m_drawnMarkers = m_enumMarkerList.size();
+}
+
 void PlotData::visibilityChanged(QwtPlotItem *item)
 {
     if (m_plotCurve == item) {
@@ -142,37 +273,9 @@ void PlotData::visibilityChanged(QwtPlotItem *item)
     }
 }
 
-void PlotData::calcMathFunction(double currentValue)
+QString PlotData::enumOption(double value) const
 {
-    // Put the new value at the back
-    m_yDataHistory.append(currentValue);
-
-    // calculate average value
-    m_meanSum += currentValue;
-    if (m_yDataHistory.size() > m_meanSamples) {
-        m_meanSum -= m_yDataHistory.first();
-        m_yDataHistory.pop_front();
-    }
-    // make sure to correct the sum every meanSamples steps to prevent it
-    // from running away due to floating point rounding errors
-    m_correctionSum += currentValue;
-    if (++m_correctionCount >= m_meanSamples) {
-        m_meanSum = m_correctionSum;
-        m_correctionSum = 0.0f;
-        m_correctionCount = 0;
-    }
-
-    double boxcarAvg = m_meanSum / m_yDataHistory.size();
-    if (m_mathFunction == "Standard deviation") {
-        // Calculate square of sample standard deviation, with Bessel's correction
-        double stdSum = 0;
-        for (int i = 0; i < m_yDataHistory.size(); i++) {
-            stdSum += pow(m_yDataHistory.at(i) - boxcarAvg, 2) / (m_meanSamples - 1);
-        }
-        m_yDataEntries.append(sqrt(stdSum));
-    } else {
-        m_yDataEntries.append(boxcarAvg);
-    }
+    return m_field->getOptions().value((int)value);
 }
 
 QwtPlotMarker *PlotData::createMarker(QString value)
@@ -199,100 +302,71 @@ QwtPlotMarker *PlotData::createMarker(QString value)
     return marker;
 }
 
-bool SequentialPlotData::append(UAVObject *obj)
+bool SequentialPlotData::appendValue(double value, double x)
 {
-    if (obj == NULL) {
-        obj = m_object;
-    }
+    if (!m_isEnumPlot) {
+        double currentValue = value * pow(10, m_scalePower);
 
-    if (m_object == obj && m_field) {
-        if (!m_isEnumPlot) {
-            double currentValue = m_field->getValue(m_element).toDouble() * pow(10, m_scalePower);
+        // Perform scope math, if necessary
+        currentValue = m_math.apply(currentValue, x);
 
-            // Perform scope math, if necessary
-            if (m_mathFunction == "Boxcar average" || m_mathFunction == "Standard deviation") {
-                calcMathFunction(currentValue);
-            } else {
-                m_yDataEntries.append(currentValue);
-            }
+        m_samples->append(0, currentValue);
+        if (m_samples->count() > m_plotDataSize) {
+            // If new data overflows the window, remove old data
+            m_samples->removeFirst();
+        }
+        return true;
+    } else {
+        // Enum markers
+        QString option = enumOption(value);
 
-            if (m_yDataEntries.size() > m_plotDataSize) {
-                // If new data overflows the window, remove old data...
-                m_yDataEntries.pop_front();
-            } else {
-                // ...otherwise, add a new y point at position xData
-                m_xDataEntries.insert(m_xDataEntries.size(), m_xDataEntries.size());
-            }
-            return true;
-        } else {
-            // Enum markers
-            QString value = m_field->getValue(m_element).toString();
-
-            QwtPlotMarker *marker = m_enumMarkerList.isEmpty() ? NULL : m_enumMarkerList.last();
-            if (!marker || marker->title() != value) {
-                marker = createMarker(value);
-                marker->setXValue(m_enumMarkerList.size());
-
-                if (m_plotCurve->isVisible()) {
-                    marker->attach(m_plotCurve->plot());
-                }
-                m_enumMarkerList.append(marker);
+        QwtPlotMarker *marker = m_enumMarkerList.isEmpty() ? NULL : m_enumMarkerList.last();
+        if (!marker || marker->title() != option) {
+            marker = createMarker(option);
+            marker->setXValue(m_enumMarkerList.size());
+
+            if (m_plotCurve->isVisible()) {
+                marker->attach(m_plotCurve->plot());
             }
+            m_enumMarkerList.append(marker);
         }
     }
     return false;
 }
 
-bool ChronoPlotData::append(UAVObject *obj)
+bool ChronoPlotData::appendValue(double value, double xValue)
 {
-    if (obj == NULL) {
-        obj = m_object;
-    }
-
-    if (m_object == obj && m_field) {
-        // Get the field of interest
-        // THINK ABOUT REIMPLEMENTING THIS TO SHOW UAVO TIME, NOT SYSTEM TIME
-        QDateTime NOW = QDateTime::currentDateTime();
-
-        double xValue = NOW.toTime_t() + NOW.time().msec() / 1000.0;
-        if (!m_isEnumPlot) {
-            double currentValue = m_field->getValue(m_element).toDouble() * pow(10, m_scalePower);
+    if (!m_isEnumPlot) {
+        double currentValue = value * pow(10, m_scalePower);
 
-            // Perform scope math, if necessary
-            if (m_mathFunction == "Boxcar average" || m_mathFunction == "Standard deviation") {
-                calcMathFunction(currentValue);
-            } else {
-                m_yDataEntries.append(currentValue);
-            }
+        // Perform scope math, if necessary
+        currentValue = m_math.apply(currentValue, xValue);
 
-            m_xDataEntries.append(xValue);
-        } else {
-            // Enum markers
-            QString value = m_field->getValue(m_element).toString();
+        m_samples->append(xValue, currentValue);
+    } else {
+        // Enum markers
+        QString option = enumOption(value);
 
-            QwtPlotMarker *marker = m_enumMarkerList.isEmpty() ? NULL : m_enumMarkerList.last();
-            if (!marker || marker->title() != value) {
-                marker = createMarker(value);
-                marker->setXValue(xValue);
+        QwtPlotMarker *marker = m_enumMarkerList.isEmpty() ? NULL : m_enumMarkerList.last();
+        if (!marker || marker->title() != option) {
+            marker = createMarker(option);
+            marker->setXValue(xValue);
 
-                if (m_plotCurve->isVisible()) {
-                    marker->attach(m_plotCurve->plot());
-                }
-                m_enumMarkerList.append(marker);
+            if (m_plotCurve->isVisible()) {
+                marker->attach(m_plotCurve->plot());
             }
+            m_enumMarkerList.append(marker);
         }
-        removeStaleData();
-        return true;
     }
-    return false;
+    removeStaleData();
+    return true;
 }
 
 void ChronoPlotData::removeStaleData()
 {
-    while (!m_xDataEntries.isEmpty() &&
-           (m_xDataEntries.last() - m_xDataEntries.first()) > m_plotDataSize) {
-        m_yDataEntries.pop_front();
-        m_xDataEntries.pop_front();
+    while (!m_samples->isEmpty() &&
+           (m_samples->lastX() - m_samples->firstX()) > m_plotDataSize) {
+        m_samples->removeFirst();
     }
     while (!m_enumMarkerList.isEmpty() &&
            (m_enumMarkerList.last()->xValue() - m_enumMarkerList.first()->xValue()) > m_plotDataSize) {
@@ -301,3 +375,98 @@ void ChronoPlotData::removeStaleData()
         delete marker;
     }
 }
+
+SpectrumPlotData::SpectrumPlotData(UAVObject *object, UAVObjectField *field, int element,
+                                   int scaleFactor, int meanSamples, QString mathFunction,
+                                   double plotDataSize, QPen pen, bool antialiased,
+                                   int spectrumSize, int spectrumOverlap)
+    : PlotData(object, field, element, scaleFactor, meanSamples,
+               mathFunction, plotDataSize, pen, antialiased),
+    m_spectrum(spectrumSize, spectrumOverlap), m_lastValue(0),
+    m_generation(0), m_analysisGeneration(0)
+{
+    connect(&m_analysis, SIGNAL(finished()), this, SLOT(analysisFinished()));
+}
+
+SpectrumPlotData::~SpectrumPlotData()
+{
+    m_analysis.waitForFinished();
+}
+
+bool SpectrumPlotData::appendValue(double value, double x)
+{
+    // Enums have no spectrum
+    if (m_isEnumPlot) {
+        return false;
+    }
+
+    double currentValue = value * pow(10, m_scalePower);
+
+    // Perform scope math, if necessary
+    m_lastValue = m_math.apply(currentValue, x);
+
+    m_values.append(m_lastValue);
+    m_times.append(x);
+
+    // If the analysis falls behind, forget what it can not catch up with
+    // anymore, in large steps to keep the removal cheap
+    int maxSamples = 8 * m_spectrum.size();
+    if (m_values.size() > 2 * maxSamples) {
+        m_values.remove(0, m_values.size() - maxSamples);
+        m_times.remove(0, m_times.size() - maxSamples);
+    }
+    return true;
+}
+
+void SpectrumPlotData::updatePlotData()
+{
+    // One analysis at a time, new samples queue up meanwhile
+    if (m_analysis.isRunning() || m_values.size() < m_spectrum.size()) {
+        return;
+    }
+
+    // The samples come at the telemetry update rate, averaged over the batch
+    double duration   = m_times.last() - m_times.first();
+    double sampleRate = (duration > 0) ? (m_values.size() - 1) / duration : 1.0;
+
+    m_analysisGeneration = m_generation;
+    m_analysis.setFuture(QtConcurrent::run(m_spectrum, &PlotSpectrum::analyze, m_values, sampleRate));
+
+    // The worker has its own copy, keep what the next frames overlap
+    int consumed = m_spectrum.consumed(m_values.size());
+    m_values.remove(0, consumed);
+    m_times.remove(0, consumed);
+}
+
+void SpectrumPlotData::analysisFinished()
+{
+    if (m_analysisGeneration != m_generation) {
+        return;
+    }
+
+    PlotSpectrum::Result result = m_analysis.result();
+    if (result.frames == 0) {
+        return;
+    }
+
+    double binWidth = result.sampleRate / m_spectrum.size();
+    m_samples->clear();
+    for (int i = 0; i < result.amplitude.size(); i++) {
+        m_samples->append(i * binWidth, result.amplitude[i]);
+    }
+    PlotData::updatePlotData();
+}
+
+double SpectrumPlotData::lastData()
+{
+    return m_lastValue;
+}
+
+void SpectrumPlotData::clearData()
+{
+    PlotData::clearData();
+    m_values.clear();
+    m_times.clear();
+    m_lastValue = 0;
+    m_generation++;
+}
@@ -29,6 +29,10 @@
 #define PLOTDATA_H
 
 #include "uavobject.h"
+#include "plotsamples.h"
+#include "plotmath.h"
+#include "plotspectrum.h"
+#include "scopesamplestore.h"
 
 #include "qwt/src/qwt.h"
 #include "qwt/src/qwt_plot.h"
@@ -40,12 +44,17 @@
 #include <QTimer>
 #include <QTime>
 #include <QVector>
+#include <QPointer>
+#include <QFutureWatcher>
 #include <uavdataobject.h>
+#include <utils/logfile.h>
+
+class QwtPlotDirectPainter;
 
 /*!
    \brief Defines the different type of plots.
  */
-enum PlotType { SequentialPlot, ChronoPlot };
+enum PlotType { SequentialPlot, ChronoPlot, SpectrumPlot };
 
 /*!
    \brief Base class that keeps the data for each curve in the plot.
@@ -88,34 +97,46 @@ public:
         return m_isEnumPlot;
     }
 
-    virtual bool append(UAVObject *obj) = 0;
-    virtual PlotType plotType() const   = 0;
+    // Appends the current value of obj, NULL for the plotted object
+    bool append(UAVObject *obj);
+    // Appends a sample decoded by the sample store
+    bool appendSample(const ScopeSeries::Sample &sample);
+    // Appends the samples the store kept from before the curve was created
+    void appendHistory();
+    // A suspended curve is unsubscribed from the sample store
+    void setSuspended(bool suspended);
+    virtual PlotType plotType() const = 0;
     virtual void removeStaleData() = 0;
 
-    void updatePlotData();
+    virtual void updatePlotData();
     void clear();
 
+    void setReplayData(const QVector<LogFile::ReplaySample> &samples);
+
     bool hasData() const;
-    QString lastDataAsString();
+    // Last value appended, enums are the index of their option
+    virtual double lastData();
 
     void attach(QwtPlot *plot);
 
+    // False when the samples appended since the last replot can not just be painted over it
+    bool canDrawNewSamples() const;
+    // Paints the samples appended since the curve was last drawn
+    void drawNewSamples(QwtPlotDirectPainter *painter);
+    // The plot has been replotted with all the samples
+    void markDrawn();
+
 public slots:
     void visibilityChanged(QwtPlotItem *item);
 
 protected:
     // This is the power to which each value must be raised
     int m_scalePower;
-    int m_meanSamples;
-    double m_meanSum;
-    QString m_mathFunction;
-    double m_correctionSum;
-    int m_correctionCount;
+    PlotMath m_math;
     double m_plotDataSize;
 
-    QVector<double> m_xDataEntries;
-    QVector<double> m_yDataEntries;
-    QVector<double> m_yDataHistory;
+    // Owned by m_plotCurve, which draws straight from it
+    PlotSamples *m_samples;
 
     UAVObject *m_object;
     UAVObjectField *m_field;
@@ -127,8 +148,16 @@ protected:
     bool m_isVisible;
     QPen m_pen;
     bool m_isEnumPlot;
-    virtual void calcMathFunction(double currentValue);
+    // Shared with the other curves plotting the same element, NULL while suspended
+    ScopeSeries *m_series;
+    // Samples and markers on the plot, m_drawnIndex is -1 until the next replot after a clear
+    qint64 m_drawnIndex;
+    int m_drawnMarkers;
+    // Appends a decoded value at time x, enums are the index of their option
+    virtual bool appendValue(double value, double x) = 0;
+    QString enumOption(double value) const;
     QwtPlotMarker *createMarker(QString value);
+    virtual void clearData();
 };
 
 /*!
@@ -142,15 +171,22 @@ public:
                        int scaleFactor, int meanSamples, QString mathFunction,
                        double plotDataSize, QPen pen, bool antialiased)
         : PlotData(object, field, element, scaleFactor, meanSamples,
-                   mathFunction, plotDataSize, pen, antialiased) {}
+                   mathFunction, plotDataSize, pen, antialiased)
+    {
+        m_samples->setSequential(true);
+        m_math.setSequential(true);
+        m_samples->reserve((int)plotDataSize);
+    }
     ~SequentialPlotData() {}
 
-    bool append(UAVObject *obj);
     PlotType plotType() const
     {
         return SequentialPlot;
     }
     void removeStaleData() {}
+
+protected:
+    bool appendValue(double value, double x);
 };
 
 /*!
@@ -167,12 +203,61 @@ public:
     {}
     ~ChronoPlotData() {}
 
-    bool append(UAVObject *obj);
     PlotType plotType() const
     {
         return ChronoPlot;
     }
     void removeStaleData();
+
+protected:
+    bool appendValue(double value, double x);
+};
+
+/*!
+   \brief The spectrum plot shows the amplitude over frequency of the latest samples.
+   Complete batches of samples are analyzed in a worker thread, the curve is replaced
+   whenever an analysis finishes.
+ */
+class SpectrumPlotData : public PlotData {
+    Q_OBJECT
+public:
+    SpectrumPlotData(UAVObject *object, UAVObjectField *field, int element,
+                     int scaleFactor, int meanSamples, QString mathFunction,
+                     double plotDataSize, QPen pen, bool antialiased,
+                     int spectrumSize, int spectrumOverlap);
+    ~SpectrumPlotData();
+
+    PlotType plotType() const
+    {
+        return SpectrumPlot;
+    }
+    void removeStaleData() {}
+    void updatePlotData();
+    double lastData();
+
+    int spectrumSize() const
+    {
+        return m_spectrum.size();
+    }
+
+protected:
+    bool appendValue(double value, double x);
+    void clearData();
+
+private slots:
+    void analysisFinished();
+
+private:
+    PlotSpectrum m_spectrum;
+    // Samples not yet analyzed, with the times they were taken at
+    QVector<double> m_values;
+    QVector<double> m_times;
+    double m_lastValue;
+
+    QFutureWatcher<PlotSpectrum::Result> m_analysis;
+    // Results of an analysis started before the data was cleared are dropped
+    int m_generation;
+    int m_analysisGeneration;
 };
 
 #endif // PLOTDATA_H
@@ -0,0 +1,217 @@
+/**
+ ******************************************************************************
+ *
+ * @file       plotmath.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ScopePlugin Scope Gadget Plugin
+ * @{
+ * @brief The scope Gadget, graphically plots the states of UAVObjects
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "plotmath.h"
+
+#include <math.h>
+
+PlotMath::PlotMath(const QString &function, int windowSize) :
+    m_function(None), m_windowSize(qMax(1, windowSize)), m_sequential(false)
+{
+    int index = functionNames().indexOf(function);
+
+    if (index >= 0) {
+        m_function = (Function)index;
+    }
+    if (m_function == FFTMagnitude) {
+        // The FFT works on a power of two window
+        int size = 4;
+        while (size * 2 <= m_windowSize) {
+            size *= 2;
+        }
+        m_windowSize = size;
+        m_re.resize(size);
+        m_im.resize(size);
+    }
+    m_window.reserve(m_windowSize + 1);
+    reset();
+}
+
+QStringList PlotMath::functionNames()
+{
+    return QStringList() << "None" << "Boxcar average" << "Standard deviation" << "Exponential average"
+                         << "Derivative" << "RMS" << "FFT magnitude";
+}
+
+void PlotMath::reset()
+{
+    m_window.clear();
+    m_sum        = 0;
+    m_sumSquares = 0;
+    m_mean       = 0;
+    m_m2         = 0;
+    m_sinceRecalculation = 0;
+    m_lastValue  = 0;
+    m_lastX      = 0;
+    m_result     = 0;
+    m_hasLast    = false;
+}
+
+double PlotMath::apply(double value, double x)
+{
+    switch (m_function) {
+    case None:
+        return value;
+
+    case ExponentialAverage:
+        // Same center of mass as a boxcar average of the window size
+        m_result  = m_hasLast ? m_result + (value - m_result) * 2.0 / (m_windowSize + 1) : value;
+        m_hasLast = true;
+        return m_result;
+
+    case Derivative:
+        if (m_hasLast && m_sequential) {
+            m_result = value - m_lastValue;
+        } else if (m_hasLast && x > m_lastX) {
+            m_result = (value - m_lastValue) / (x - m_lastX);
+        }
+        m_lastValue = value;
+        m_lastX     = x;
+        m_hasLast   = true;
+        return m_result;
+
+    default:
+        break;
+    }
+
+    // Slide the window
+    m_window.append(value);
+    double oldValue = 0;
+    bool full = m_window.size() > m_windowSize;
+    if (full) {
+        oldValue = m_window.at(0);
+        m_window.removeFirst(1);
+    }
+
+    m_sum += value - oldValue;
+    m_sumSquares += value * value - oldValue * oldValue;
+    if (full) {
+        // Replace oldValue by value, the count stays the same
+        double mean = m_mean + (value - oldValue) / m_window.size();
+        m_m2  += (value - oldValue) * (value - mean + oldValue - m_mean);
+        m_mean = mean;
+    } else {
+        double delta = value - m_mean;
+        m_mean += delta / m_window.size();
+        m_m2   += delta * (value - m_mean);
+    }
+    if (++m_sinceRecalculation >= m_windowSize) {
+        recalculate();
+    }
+
+    int count = m_window.size();
+    switch (m_function) {
+    case BoxcarAverage:
+        return m_sum / count;
+
+    case StandardDeviation:
+        // Sample standard deviation of a full window, with Bessel's correction
+        if (m_windowSize < 2) {
+            return 0;
+        }
+        return sqrt(qMax(0.0, m_m2) / (m_windowSize - 1));
+
+    case RMS:
+        return sqrt(qMax(0.0, m_sumSquares) / count);
+
+    case FFTMagnitude:
+        // The window is recalculated every m_windowSize values, transform it twice as often
+        if (full && m_sinceRecalculation % (m_windowSize / 2) == 0) {
+            m_result = fftMagnitude();
+        }
+        return m_result;
+
+    default:
+        return value;
+    }
+}
+
+void PlotMath::recalculate()
+{
+    int count = m_window.size();
+
+    m_sum        = 0;
+    m_sumSquares = 0;
+    for (int i = 0; i < count; i++) {
+        m_sum        += m_window.at(i);
+        m_sumSquares += m_window.at(i) * m_window.at(i);
+    }
+    m_mean = m_sum / count;
+    m_m2   = 0;
+    for (int i = 0; i < count; i++) {
+        m_m2 += (m_window.at(i) - m_mean) * (m_window.at(i) - m_mean);
+    }
+    m_sinceRecalculation = 0;
+}
+
+/**
+ * Amplitude of the strongest frequency in the window, leaving out the mean.
+ * Radix-2 FFT of the Hann windowed values.
+ */
+double PlotMath::fftMagnitude()
+{
+    int n = m_windowSize;
+    double windowSum = 0;
+
+    for (int i = 0; i < n; i++) {
+        double hann = 0.5 - 0.5 * cos(2 * M_PI * i / n);
+        windowSum += hann;
+
+        // Bit reversed order
+        int j = 0;
+        for (int bit = 1, rev = n >> 1; bit < n; bit <<= 1, rev >>= 1) {
+            if (i & bit) {
+                j |= rev;
+            }
+        }
+        m_re[j] = (m_window.at(i) - m_mean) * hann;
+        m_im[j] = 0;
+    }
+
+    for (int len = 2; len <= n; len <<= 1) {
+        double angle = -2 * M_PI / len;
+        for (int k = 0; k < len / 2; k++) {
+            double wr = cos(angle * k);
+            double wi = sin(angle * k);
+            for (int i = k; i < n; i += len) {
+                int j     = i + len / 2;
+                double tr = m_re[j] * wr - m_im[j] * wi;
+                double ti = m_re[j] * wi + m_im[j] * wr;
+                m_re[j] = m_re[i] - tr;
+                m_im[j] = m_im[i] - ti;
+                m_re[i] += tr;
+                m_im[i] += ti;
+            }
+        }
+    }
+
+    double peak = 0;
+    for (int k = 1; k < n / 2; k++) {
+        peak = qMax(peak, m_re[k] * m_re[k] + m_im[k] * m_im[k]);
+    }
+    return 2 * sqrt(peak) / windowSum;
+}
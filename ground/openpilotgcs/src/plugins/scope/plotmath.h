@@ -0,0 +1,100 @@
+/**
+ ******************************************************************************
+ *
+ * @file       plotmath.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ScopePlugin Scope Gadget Plugin
+ * @{
+ * @brief The scope Gadget, graphically plots the states of UAVObjects
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef PLOTMATH_H
+#define PLOTMATH_H
+
+#include "plotsamples.h"
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/*!
+   \brief Streaming math function applied to the values of a curve before they are plotted.
+
+   Every function costs O(1) per value, amortized: sliding sums are updated as values
+   enter and leave the window and recalculated once per window length to keep
+   rounding errors from building up, the FFT only runs once per half window.
+ */
+class PlotMath {
+public:
+    enum Function {
+        None, BoxcarAverage, StandardDeviation, ExponentialAverage, Derivative, RMS, FFTMagnitude
+    };
+
+    PlotMath(const QString &function, int windowSize);
+
+    // Names as shown in the configuration, indexed by Function
+    static QStringList functionNames();
+    // Whether the function uses the window size at all
+    static bool hasWindow(Function function)
+    {
+        return function != None && function != Derivative;
+    }
+
+    Function function() const
+    {
+        return m_function;
+    }
+    // Values are one sample apart instead of at their x values
+    void setSequential(bool sequential)
+    {
+        m_sequential = sequential;
+    }
+    // The value to plot at x for the new value
+    double apply(double value, double x);
+    void reset();
+
+private:
+    void recalculate();
+    double fftMagnitude();
+
+    Function m_function;
+    int m_windowSize;
+    bool m_sequential;
+    PlotRing<double> m_window;
+
+    // Sliding sums over m_window
+    double m_sum;
+    double m_sumSquares;
+    // Welford mean and sum of squared differences from it
+    double m_mean;
+    double m_m2;
+    int m_sinceRecalculation;
+
+    double m_lastValue;
+    double m_lastX;
+    double m_result;
+    bool m_hasLast;
+
+    // Scratch buffers of the FFT
+    QVector<double> m_re;
+    QVector<double> m_im;
+};
+
+#endif // PLOTMATH_H
@@ -0,0 +1,287 @@
+/**
+ ******************************************************************************
+ *
+ * @file       plotsamples.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ScopePlugin Scope Gadget Plugin
+ * @{
+ * @brief The scope Gadget, graphically plots the states of UAVObjects
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "plotsamples.h"
+
+// Levels are added while the top one would still have this many blocks
+#define MIN_LEVEL_BLOCKS 256
+
+PlotSamples::PlotSamples() :
+    m_sequential(false), m_raw(false), m_firstIndex(0), m_minY(0), m_maxY(0), m_rangeValid(true),
+    m_maxPoints(0), m_decimated(false), m_displayValid(true)
+{}
+
+size_t PlotSamples::size() const
+{
+    if (m_raw) {
+        return m_samples.size();
+    }
+    if (!m_displayValid) {
+        updateDisplay();
+    }
+    return m_decimated ? m_display.size() : m_samples.size();
+}
+
+QPointF PlotSamples::sample(size_t i) const
+{
+    QPointF point = (m_decimated && !m_raw) ? m_display.at(i) : m_samples.at(i);
+
+    if (m_sequential) {
+        // Sequential samples are stored with their index since the last clear
+        point.setX(point.x() - m_firstIndex);
+    }
+    return point;
+}
+
+QRectF PlotSamples::boundingRect() const
+{
+    if (isEmpty()) {
+        // Invalid rectangle, same as qwtBoundingRect() of no samples
+        return QRectF(1.0, 1.0, -2.0, -2.0);
+    }
+
+    if (!m_rangeValid) {
+        calcRange();
+    }
+
+    d_boundingRect = QRectF(firstX(), m_minY, lastX() - firstX(), m_maxY - m_minY);
+    return d_boundingRect;
+}
+
+void PlotSamples::setMaxPoints(int maxPoints)
+{
+    if (maxPoints != m_maxPoints) {
+        m_maxPoints    = maxPoints;
+        m_displayValid = false;
+    }
+}
+
+double PlotSamples::firstX() const
+{
+    Q_ASSERT(!isEmpty());
+    return m_sequential ? 0 : m_samples.at(0).x();
+}
+
+double PlotSamples::lastX() const
+{
+    Q_ASSERT(!isEmpty());
+    return m_sequential ? m_samples.size() - 1 : m_samples.at(m_samples.size() - 1).x();
+}
+
+double PlotSamples::lastY() const
+{
+    Q_ASSERT(!isEmpty());
+    return m_samples.at(m_samples.size() - 1).y();
+}
+
+void PlotSamples::reserve(int capacity)
+{
+    m_samples.reserve(capacity);
+}
+
+void PlotSamples::append(double x, double y)
+{
+    qint64 index = m_firstIndex + m_samples.size();
+    QPointF point(m_sequential ? index : x, y);
+
+    if (isEmpty()) {
+        m_minY = m_maxY = y;
+        m_rangeValid = true;
+    } else if (m_rangeValid) {
+        m_minY = qMin(m_minY, y);
+        m_maxY = qMax(m_maxY, y);
+    }
+    m_samples.append(point);
+
+    Bucket bucket = { point, point };
+    for (int level = 0; level < m_levels.size(); level++) {
+        addToLevel(level, index, bucket);
+    }
+    if ((m_samples.size() >> levelShift(m_levels.size())) >= MIN_LEVEL_BLOCKS) {
+        addLevel();
+    }
+    m_displayValid = false;
+}
+
+void PlotSamples::removeFirst(int count)
+{
+    count = qMin(count, m_samples.size());
+    for (int i = 0; i < count && m_rangeValid; i++) {
+        double y = m_samples.at(i).y();
+        if (y <= m_minY || y >= m_maxY) {
+            m_rangeValid = false;
+        }
+    }
+    m_samples.removeFirst(count);
+    m_firstIndex += count;
+
+    // Drop the blocks that are gone completely, the first one may be partially gone
+    for (int level = 0; level < m_levels.size(); level++) {
+        qint64 drop = (m_firstIndex >> levelShift(level)) - m_levelFirst[level];
+        if (drop > 0) {
+            m_levels[level].removeFirst((int)qMin<qint64>(drop, m_levels.at(level).size()));
+            m_levelFirst[level] += drop;
+        }
+    }
+    // Keep some hysteresis before giving up the top level
+    while (!m_levels.isEmpty() &&
+           (m_samples.size() >> levelShift(m_levels.size() - 1)) < MIN_LEVEL_BLOCKS / 2) {
+        m_levels.removeLast();
+        m_levelFirst.removeLast();
+    }
+    m_displayValid = false;
+}
+
+void PlotSamples::clear()
+{
+    m_samples.clear();
+    m_firstIndex = 0;
+    m_levels.clear();
+    m_levelFirst.clear();
+    m_rangeValid   = true;
+    m_displayValid = false;
+}
+
+void PlotSamples::merge(Bucket &bucket, const QPointF &point)
+{
+    if (point.y() < bucket.min.y()) {
+        bucket.min = point;
+    }
+    if (point.y() > bucket.max.y()) {
+        bucket.max = point;
+    }
+}
+
+void PlotSamples::addToLevel(int level, qint64 index, const Bucket &bucket)
+{
+    PlotRing<Bucket> &blocks = m_levels[level];
+    qint64 block = index >> levelShift(level);
+
+    if (blocks.size() == 0) {
+        m_levelFirst[level] = block;
+    }
+    if (blocks.size() > 0 && m_levelFirst[level] + blocks.size() - 1 == block) {
+        merge(blocks.last(), bucket.min);
+        merge(blocks.last(), bucket.max);
+    } else {
+        blocks.append(bucket);
+    }
+}
+
+void PlotSamples::addLevel()
+{
+    int level = m_levels.size();
+
+    m_levels.append(PlotRing<Bucket>());
+    m_levelFirst.append(0);
+
+    // Build the new level from the one below, or from the samples
+    if (level == 0) {
+        for (int i = 0; i < m_samples.size(); i++) {
+            Bucket bucket = { m_samples.at(i), m_samples.at(i) };
+            addToLevel(level, m_firstIndex + i, bucket);
+        }
+    } else {
+        const PlotRing<Bucket> &below = m_levels.at(level - 1);
+        for (int i = 0; i < below.size(); i++) {
+            // The first sample of a block at the level below lies in the same block here
+            // When the first block below was partially dropped, so is the first one here
+            addToLevel(level, (m_levelFirst.at(level - 1) + i) << levelShift(level - 1), below.at(i));
+        }
+    }
+}
+
+void PlotSamples::calcRange() const
+{
+    // Scan the top level, and the samples of its first, partially dropped, block
+    int top = m_levels.size() - 1;
+    int i   = 0;
+
+    m_minY = m_maxY = m_samples.at(0).y();
+    if (top >= 0) {
+        qint64 firstBlock = (m_firstIndex >> levelShift(top)) + 1;
+        int partial = qMin<qint64>((firstBlock << levelShift(top)) - m_firstIndex, m_samples.size());
+        for (; i < partial; i++) {
+            m_minY = qMin(m_minY, m_samples.at(i).y());
+            m_maxY = qMax(m_maxY, m_samples.at(i).y());
+        }
+        const PlotRing<Bucket> &blocks = m_levels.at(top);
+        for (int j = (int)(firstBlock - m_levelFirst.at(top)); j < blocks.size(); j++) {
+            m_minY = qMin(m_minY, blocks.at(j).min.y());
+            m_maxY = qMax(m_maxY, blocks.at(j).max.y());
+        }
+    } else {
+        for (; i < m_samples.size(); i++) {
+            m_minY = qMin(m_minY, m_samples.at(i).y());
+            m_maxY = qMax(m_maxY, m_samples.at(i).y());
+        }
+    }
+    m_rangeValid = true;
+}
+
+void PlotSamples::updateDisplay() const
+{
+    m_displayValid = true;
+    m_decimated    = false;
+    m_display.clear();
+
+    // Two points per block, the lowest level with no more blocks than pixels
+    int level = 0;
+    while (level < m_levels.size() - 1 &&
+           (m_samples.size() >> levelShift(level)) > m_maxPoints) {
+        level++;
+    }
+    if (m_maxPoints <= 0 || m_levels.isEmpty() ||
+        m_samples.size() <= ((m_samples.size() >> levelShift(level)) + 1) * 2) {
+        // Every sample fits, or not enough of them to decimate
+        return;
+    }
+
+    const PlotRing<Bucket> &blocks = m_levels.at(level);
+    qint64 firstBlock = m_levelFirst.at(level);
+    int first = 0;
+    m_display.reserve(2 * blocks.size());
+
+    if ((firstBlock << levelShift(level)) < m_firstIndex) {
+        // The first block was partially dropped, its remaining samples make up a block of their own
+        int partial = qMin<qint64>(((firstBlock + 1) << levelShift(level)) - m_firstIndex, m_samples.size());
+        Bucket bucket = { m_samples.at(0), m_samples.at(0) };
+        for (int i = 1; i < partial; i++) {
+            merge(bucket, m_samples.at(i));
+        }
+        m_display.append(bucket.min.x() <= bucket.max.x() ? bucket.min : bucket.max);
+        m_display.append(bucket.min.x() <= bucket.max.x() ? bucket.max : bucket.min);
+        first = 1;
+    }
+    for (int i = first; i < blocks.size(); i++) {
+        const Bucket &bucket = blocks.at(i);
+        // Keep the points in x order
+        m_display.append(bucket.min.x() <= bucket.max.x() ? bucket.min : bucket.max);
+        m_display.append(bucket.min.x() <= bucket.max.x() ? bucket.max : bucket.min);
+    }
+    m_decimated = true;
+}
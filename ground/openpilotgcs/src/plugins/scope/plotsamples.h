@@ -0,0 +1,213 @@
+/**
+ ******************************************************************************
+ *
+ * @file       plotsamples.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ScopePlugin Scope Gadget Plugin
+ * @{
+ * @brief The scope Gadget, graphically plots the states of UAVObjects
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef PLOTSAMPLES_H
+#define PLOTSAMPLES_H
+
+#include "qwt/src/qwt_series_data.h"
+
+#include <QPointF>
+#include <QRectF>
+#include <QVector>
+
+/*!
+   \brief Power of two sized circular buffer, appending and dropping the oldest entries are O(1).
+ */
+template <typename T>
+class PlotRing {
+public:
+    PlotRing() : m_first(0), m_size(0)
+    {
+        m_buffer.resize(64);
+    }
+
+    int size() const
+    {
+        return m_size;
+    }
+    const T &at(int i) const
+    {
+        return m_buffer.at((m_first + i) & (m_buffer.size() - 1));
+    }
+    T &last()
+    {
+        return m_buffer[(m_first + m_size - 1) & (m_buffer.size() - 1)];
+    }
+
+    void reserve(int capacity)
+    {
+        if (capacity > m_buffer.size()) {
+            grow(capacity);
+        }
+    }
+    void append(const T &value)
+    {
+        if (m_size == m_buffer.size()) {
+            grow(m_size + 1);
+        }
+        m_buffer[(m_first + m_size) & (m_buffer.size() - 1)] = value;
+        m_size++;
+    }
+    void removeFirst(int count)
+    {
+        count   = qMin(count, m_size);
+        m_first = (m_first + count) & (m_buffer.size() - 1);
+        m_size -= count;
+    }
+    void clear()
+    {
+        m_first = 0;
+        m_size  = 0;
+    }
+
+private:
+    void grow(int capacity)
+    {
+        int newCapacity = m_buffer.size();
+
+        while (newCapacity < capacity) {
+            newCapacity *= 2;
+        }
+
+        // Unwrap the entries to the start of the new buffer
+        QVector<T> buffer(newCapacity);
+        for (int i = 0; i < m_size; i++) {
+            buffer[i] = at(i);
+        }
+        m_buffer = buffer;
+        m_first  = 0;
+    }
+
+    QVector<T> m_buffer;
+    int m_first;
+    int m_size;
+};
+
+/*!
+   \brief Samples of one curve, read by the curve in place.
+
+   The samples are kept in a PlotRing. The x values must not decrease, so that
+   the x range is given by the first and the last sample. In sequential mode the
+   x value of a sample is its position in the buffer instead, so old samples
+   scroll out to the left.
+
+   Long windows are drawn from a min/max pyramid: level k holds the lowest and
+   the highest sample of every block of 4 << k samples, updated as samples come
+   and go. With setMaxPoints() the curve is only handed the extremes of about
+   as many blocks as there are pixels, drawing then no longer depends on the
+   length of the window.
+
+   The samples are numbered from the last clear, so that the ones appended since
+   the curve was drawn can be found again after old ones were dropped.
+ */
+class PlotSamples : public QwtSeriesData<QPointF> {
+public:
+    PlotSamples();
+
+    // Number of points drawn, which are the decimated ones for long windows
+    size_t size() const;
+    QPointF sample(size_t i) const;
+    QRectF boundingRect() const;
+
+    void setSequential(bool sequential)
+    {
+        m_sequential = sequential;
+    }
+    // Horizontal resolution of the plot, 0 to always draw every sample
+    void setMaxPoints(int maxPoints);
+    // While set, the curve is handed every sample, to paint the latest ones over the decimated ones
+    void setRaw(bool raw)
+    {
+        m_raw = raw;
+    }
+
+    // Number of samples in the window
+    int count() const
+    {
+        return m_samples.size();
+    }
+    bool isEmpty() const
+    {
+        return m_samples.size() == 0;
+    }
+    double firstX() const;
+    double lastX() const;
+    double lastY() const;
+    // Number of the first sample, and of the next one to be appended
+    qint64 firstIndex() const
+    {
+        return m_firstIndex;
+    }
+    qint64 endIndex() const
+    {
+        return m_firstIndex + m_samples.size();
+    }
+
+    void reserve(int capacity);
+    void append(double x, double y);
+    void removeFirst(int count = 1);
+    void clear();
+
+private:
+    struct Bucket {
+        QPointF min;
+        QPointF max;
+    };
+
+    static int levelShift(int level)
+    {
+        return level + 2;
+    }
+    static void merge(Bucket &bucket, const QPointF &point);
+    void addToLevel(int level, qint64 index, const Bucket &bucket);
+    void addLevel();
+    void calcRange() const;
+    void updateDisplay() const;
+
+    bool m_sequential;
+    bool m_raw;
+    PlotRing<QPointF> m_samples;
+    // Number of samples dropped since the last clear, the index of m_samples.at(0)
+    qint64 m_firstIndex;
+
+    // m_levels[k].at(0) is the block m_levelFirst[k] of 4 << k samples
+    QVector<PlotRing<Bucket> > m_levels;
+    QVector<qint64> m_levelFirst;
+
+    // Range of the y values, recalculated once the oldest extreme was dropped
+    mutable double m_minY;
+    mutable double m_maxY;
+    mutable bool m_rangeValid;
+
+    // Points handed to the curve while m_decimated is set
+    int m_maxPoints;
+    mutable QVector<QPointF> m_display;
+    mutable bool m_decimated;
+    mutable bool m_displayValid;
+};
+
+#endif // PLOTSAMPLES_H
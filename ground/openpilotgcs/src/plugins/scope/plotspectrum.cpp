@@ -0,0 +1,111 @@
+/**
+ ******************************************************************************
+ *
+ * @file       plotspectrum.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ScopePlugin Scope Gadget Plugin
+ * @{
+ * @brief The scope Gadget, graphically plots the states of UAVObjects
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "plotspectrum.h"
+
+#include <unsupported/Eigen/FFT>
+
+#include <complex>
+#include <vector>
+#include <math.h>
+
+PlotSpectrum::PlotSpectrum(int size, int overlap)
+{
+    // The FFT works on a power of two window
+    m_size = 16;
+    while (m_size * 2 <= size) {
+        m_size *= 2;
+    }
+    overlap = qBound(0, overlap, 90);
+    m_hop   = qMax(1, m_size - m_size * overlap / 100);
+}
+
+QStringList PlotSpectrum::sizeNames()
+{
+    return QStringList() << "64" << "128" << "256" << "512" << "1024" << "2048" << "4096" << "8192";
+}
+
+int PlotSpectrum::consumed(int count) const
+{
+    if (count < m_size) {
+        return 0;
+    }
+    // Every frame that fits has been analyzed, the next one starts a hop after the last
+    return ((count - m_size) / m_hop + 1) * m_hop;
+}
+
+PlotSpectrum::Result PlotSpectrum::analyze(const QVector<double> &values, double sampleRate) const
+{
+    Result result;
+
+    result.sampleRate = sampleRate;
+    result.frames     = 0;
+    if (values.size() < m_size) {
+        return result;
+    }
+
+    std::vector<double> window(m_size);
+    double windowSum = 0;
+    for (int i = 0; i < m_size; i++) {
+        window[i]  = 0.5 * (1.0 - cos(2.0 * M_PI * i / (m_size - 1)));
+        windowSum += window[i];
+    }
+
+    Eigen::FFT<double> fft;
+    fft.SetFlag(Eigen::FFT<double>::HalfSpectrum);
+
+    int bins = m_size / 2 + 1;
+    std::vector<double> frame(m_size);
+    std::vector<std::complex<double> > spectrum(bins);
+    std::vector<double> power(bins, 0.0);
+
+    for (int start = 0; start + m_size <= values.size(); start += m_hop) {
+        // Remove the offset of the frame so its leakage does not bury the low bins
+        double mean = 0;
+        for (int i = 0; i < m_size; i++) {
+            mean += values[start + i];
+        }
+        mean /= m_size;
+        for (int i = 0; i < m_size; i++) {
+            frame[i] = (values[start + i] - mean) * window[i];
+        }
+
+        fft.fwd(&spectrum[0], &frame[0], m_size);
+        for (int i = 0; i < bins; i++) {
+            power[i] += std::norm(spectrum[i]);
+        }
+        result.frames++;
+    }
+
+    // Single sided amplitude, so a sine shows at its own amplitude
+    result.amplitude.resize(bins);
+    for (int i = 0; i < bins; i++) {
+        double amplitude = sqrt(power[i] / result.frames) / windowSum;
+        result.amplitude[i] = (i == 0 || i == bins - 1) ? amplitude : 2.0 * amplitude;
+    }
+    return result;
+}
@@ -0,0 +1,74 @@
+/**
+ ******************************************************************************
+ *
+ * @file       plotspectrum.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ScopePlugin Scope Gadget Plugin
+ * @{
+ * @brief The scope Gadget, graphically plots the states of UAVObjects
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef PLOTSPECTRUM_H
+#define PLOTSPECTRUM_H
+
+#include <QStringList>
+#include <QVector>
+
+/*!
+   \brief Welch estimate of the amplitude spectrum of a stream of samples.
+
+   Samples are cut into Hann windowed frames of a power of two size, which overlap
+   by a configurable percentage, and the power of all frames of a batch is averaged.
+   analyze() only works on its arguments so it can run in a worker thread.
+ */
+class PlotSpectrum {
+public:
+    struct Result {
+        // Amplitude of the bins from 0 to the Nyquist frequency
+        QVector<double> amplitude;
+        double sampleRate;
+        int    frames;
+    };
+
+    PlotSpectrum(int size, int overlap);
+
+    // Sizes as shown in the configuration
+    static QStringList sizeNames();
+
+    int size() const
+    {
+        return m_size;
+    }
+    // Distance between the starts of two frames
+    int hop() const
+    {
+        return m_hop;
+    }
+    // Number of samples, from the start of a batch of count, that no later frame needs
+    int consumed(int count) const;
+
+    Result analyze(const QVector<double> &values, double sampleRate) const;
+
+private:
+    int m_size;
+    int m_hop;
+};
+
+#endif // PLOTSPECTRUM_H
@@ -6,9 +6,18 @@ DEFINES += SCOPE_LIBRARY
 include(../../openpilotgcsplugin.pri)
 include (scope_dependencies.pri)
 
+QT += opengl concurrent
+
+INCLUDEPATH += ../../libs/eigen
+
 HEADERS += \
     scopeplugin.h \
     plotdata.h \
+    plotsamples.h \
+    plotmath.h \
+    plotspectrum.h \
+    scopesamplestore.h \
+    csvlogwriter.h \
     scope_global.h \
     scopegadgetoptionspage.h \
     scopegadgetconfiguration.h \
@@ -19,6 +28,11 @@ HEADERS += \
 SOURCES += \
     scopeplugin.cpp \
     plotdata.cpp \
+    plotsamples.cpp \
+    plotmath.cpp \
+    plotspectrum.cpp \
+    scopesamplestore.cpp \
+    csvlogwriter.cpp \
     scopegadgetoptionspage.cpp \
     scopegadgetconfiguration.cpp \
     scopegadget.cpp \
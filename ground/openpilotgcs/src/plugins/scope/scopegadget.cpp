@@ -50,11 +50,15 @@ void ScopeGadget::loadConfiguration(IUAVGadgetConfiguration *config)
     widget->setObjectName(config->name());
     widget->setPlotDataSize(sgConfig->dataSize());
     widget->setRefreshInterval(sgConfig->refreshInterval());
+    widget->setSpectrum(sgConfig->spectrumSize(), sgConfig->spectrumOverlap());
+    widget->setOpenGL(sgConfig->openGL());
 
     if (sgConfig->plotType() == SequentialPlot) {
         widget->setupSequentialPlot();
     } else if (sgConfig->plotType() == ChronoPlot) {
         widget->setupChronoPlot();
+    } else if (sgConfig->plotType() == SpectrumPlot) {
+        widget->setupSpectrumPlot();
     }
 
     foreach(PlotCurveConfiguration * plotCurveConfig, sgConfig->plotCurveConfigs()) {
@@ -84,6 +88,7 @@ void ScopeGadget::loadConfiguration(IUAVGadgetConfiguration *config)
     widget->setLoggingEnabled(sgConfig->getLoggingEnabled());
     widget->setLoggingNewFileOnConnect(sgConfig->getLoggingNewFileOnConnect());
     widget->setLoggingPath(sgConfig->getLoggingPath());
+    widget->setLoggingBinary(sgConfig->getLoggingBinary());
 
     widget->csvLoggingStop();
     widget->csvLoggingSetName(sgConfig->name());
@@ -107,3 +112,13 @@ void ScopeGadget::restoreState(QSettings *qSettings)
 {
     m_widget->restoreState(qSettings);
 }
+
+void ScopeGadget::suspend()
+{
+    m_widget->setSuspended(true);
+}
+
+void ScopeGadget::resume()
+{
+    m_widget->setSuspended(false);
+}
@@ -65,6 +65,8 @@ public:
 
     void saveState(QSettings *qSettings);
     void restoreState(QSettings *qSettings);
+    void suspend();
+    void resume();
 
 private:
     ScopeGadgetWidget *m_widget;
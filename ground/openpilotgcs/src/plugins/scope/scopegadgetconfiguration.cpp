@@ -32,7 +32,11 @@ ScopeGadgetConfiguration::ScopeGadgetConfiguration(QString classId, QSettings *q
     m_plotType((int)ChronoPlot),
     m_dataSize(60),
     m_refreshInterval(1000),
-    m_mathFunctionType(0)
+    m_mathFunctionType(0),
+    m_spectrumSize(512),
+    m_spectrumOverlap(50),
+    m_openGL(false),
+    m_loggingBinary(false)
 {
     uint currentStreamVersion = 0;
     int plotCurveCount = 0;
@@ -49,6 +53,9 @@ ScopeGadgetConfiguration::ScopeGadgetConfiguration(QString classId, QSettings *q
         m_plotType        = qSettings->value("plotType").toInt();
         m_dataSize        = qSettings->value("dataSize").toInt();
         m_refreshInterval = qSettings->value("refreshInterval").toInt();
+        m_spectrumSize    = qSettings->value("spectrumSize", 512).toInt();
+        m_spectrumOverlap = qSettings->value("spectrumOverlap", 50).toInt();
+        m_openGL          = qSettings->value("openGL", false).toBool();
         plotCurveCount    = qSettings->value("plotCurveCount").toInt();
 
         for (int plotDatasLoadIndex = 0; plotDatasLoadIndex < plotCurveCount; plotDatasLoadIndex++) {
@@ -73,6 +80,7 @@ ScopeGadgetConfiguration::ScopeGadgetConfiguration(QString classId, QSettings *q
         m_loggingEnabled = qSettings->value("LoggingEnabled").toBool();
         m_loggingNewFileOnConnect = qSettings->value("LoggingNewFileOnConnect").toBool();
         m_loggingPath    = qSettings->value("LoggingPath").toString();
+        m_loggingBinary  = qSettings->value("LoggingBinary", false).toBool();
     }
 }
 
@@ -102,6 +110,9 @@ IUAVGadgetConfiguration *ScopeGadgetConfiguration::clone()
     m->setDataSize(m_dataSize);
     m->setMathFunctionType(m_mathFunctionType);
     m->setRefreashInterval(m_refreshInterval);
+    m->setSpectrumSize(m_spectrumSize);
+    m->setSpectrumOverlap(m_spectrumOverlap);
+    m->setOpenGL(m_openGL);
 
     plotCurveCount = m_plotCurveConfigs.size();
 
@@ -125,6 +136,7 @@ IUAVGadgetConfiguration *ScopeGadgetConfiguration::clone()
     m->setLoggingEnabled(m_loggingEnabled);
     m->setLoggingNewFileOnConnect(m_loggingNewFileOnConnect);
     m->setLoggingPath(m_loggingPath);
+    m->setLoggingBinary(m_loggingBinary);
 
     return m;
 }
@@ -143,6 +155,9 @@ void ScopeGadgetConfiguration::saveConfig(QSettings *qSettings) const
     qSettings->setValue("plotType", m_plotType);
     qSettings->setValue("dataSize", m_dataSize);
     qSettings->setValue("refreshInterval", m_refreshInterval);
+    qSettings->setValue("spectrumSize", m_spectrumSize);
+    qSettings->setValue("spectrumOverlap", m_spectrumOverlap);
+    qSettings->setValue("openGL", m_openGL);
     qSettings->setValue("plotCurveCount", plotCurveCount);
 
     for (plotDatasLoadIndex = 0; plotDatasLoadIndex < plotCurveCount; plotDatasLoadIndex++) {
@@ -165,6 +180,7 @@ void ScopeGadgetConfiguration::saveConfig(QSettings *qSettings) const
     qSettings->setValue("LoggingEnabled", m_loggingEnabled);
     qSettings->setValue("LoggingNewFileOnConnect", m_loggingNewFileOnConnect);
     qSettings->setValue("LoggingPath", m_loggingPath);
+    qSettings->setValue("LoggingBinary", m_loggingBinary);
 }
 
 void ScopeGadgetConfiguration::replacePlotCurveConfig(QList<PlotCurveConfiguration *> newPlotCurveConfigs)
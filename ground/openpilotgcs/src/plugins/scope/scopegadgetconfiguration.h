@@ -71,6 +71,18 @@ public:
     {
         m_refreshInterval = value;
     }
+    void setSpectrumSize(int value)
+    {
+        m_spectrumSize = value;
+    }
+    void setSpectrumOverlap(int value)
+    {
+        m_spectrumOverlap = value;
+    }
+    void setOpenGL(bool value)
+    {
+        m_openGL = value;
+    }
     void addPlotCurveConfig(PlotCurveConfiguration *value)
     {
         m_plotCurveConfigs.append(value);
@@ -94,6 +106,18 @@ public:
     {
         return m_refreshInterval;
     }
+    int spectrumSize()
+    {
+        return m_spectrumSize;
+    }
+    int spectrumOverlap()
+    {
+        return m_spectrumOverlap;
+    }
+    bool openGL()
+    {
+        return m_openGL;
+    }
     QList<PlotCurveConfiguration *> plotCurveConfigs()
     {
         return m_plotCurveConfigs;
@@ -114,6 +138,10 @@ public:
     {
         return m_loggingPath;
     }
+    bool getLoggingBinary()
+    {
+        return m_loggingBinary;
+    }
     void setLoggingEnabled(bool value)
     {
         m_loggingEnabled = value;
@@ -126,6 +154,10 @@ public:
     {
         m_loggingPath = value;
     }
+    void setLoggingBinary(bool value)
+    {
+        m_loggingBinary = value;
+    }
 
 private:
 
@@ -139,12 +171,19 @@ private:
     int m_refreshInterval;
     // The type of math function to be used in the scope analysis
     int m_mathFunctionType;
+    // Samples per FFT frame of the spectrum plot and percentage that frames overlap
+    int m_spectrumSize;
+    int m_spectrumOverlap;
+    // Draw the plot canvas with OpenGL instead of the raster paint engine
+    bool m_openGL;
     QList<PlotCurveConfiguration *> m_plotCurveConfigs;
 
     void clearPlotData();
     bool m_loggingEnabled;
     bool m_loggingNewFileOnConnect;
     QString m_loggingPath;
+    // Log the values as binary columns instead of CSV text
+    bool m_loggingBinary;
 };
 
 #endif // SCOPEGADGETCONFIGURATION_H
@@ -30,6 +30,8 @@
 #include "extensionsystem/pluginmanager.h"
 #include "uavobjectmanager.h"
 #include "uavdataobject.h"
+#include "plotmath.h"
+#include "plotspectrum.h"
 
 
 #include <qpalette.h>
@@ -55,6 +57,8 @@ QWidget *ScopeGadgetOptionsPage::createPage(QWidget *parent)
 
     options_page->cmbPlotType->addItem("Sequential Plot", "");
     options_page->cmbPlotType->addItem("Chronological Plot", "");
+    options_page->cmbPlotType->addItem("Spectrum Plot", "");
+    options_page->cmbSpectrumSize->addItems(PlotSpectrum::sizeNames());
 
     // Fills the combo boxes for the UAVObjects
     ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
@@ -69,9 +73,7 @@ QWidget *ScopeGadgetOptionsPage::createPage(QWidget *parent)
     // Connect signals to slots cmbUAVObjects.currentIndexChanged
     connect(options_page->cmbUAVObjects, SIGNAL(currentIndexChanged(QString)), this, SLOT(on_cmbUAVObjects_currentIndexChanged(QString)));
 
-    options_page->mathFunctionComboBox->addItem("None");
-    options_page->mathFunctionComboBox->addItem("Boxcar average");
-    options_page->mathFunctionComboBox->addItem("Standard deviation");
+    options_page->mathFunctionComboBox->addItems(PlotMath::functionNames());
 
     if (options_page->cmbUAVObjects->currentIndex() >= 0) {
         on_cmbUAVObjects_currentIndexChanged(options_page->cmbUAVObjects->currentText());
@@ -100,6 +102,9 @@ QWidget *ScopeGadgetOptionsPage::createPage(QWidget *parent)
     options_page->mathFunctionComboBox->setCurrentIndex(m_config->mathFunctionType());
     options_page->spnDataSize->setValue(m_config->dataSize());
     options_page->spnRefreshInterval->setValue(m_config->refreshInterval());
+    options_page->cmbSpectrumSize->setCurrentIndex(options_page->cmbSpectrumSize->findText(QString::number(m_config->spectrumSize())));
+    options_page->spnSpectrumOverlap->setValue(m_config->spectrumOverlap());
+    options_page->chkOpenGL->setChecked(m_config->openGL());
 
     // add the configured curves
     foreach(PlotCurveConfiguration * plotData, m_config->plotCurveConfigs()) {
@@ -124,6 +129,8 @@ QWidget *ScopeGadgetOptionsPage::createPage(QWidget *parent)
     connect(options_page->btnColor, SIGNAL(clicked()), this, SLOT(on_btnColor_clicked()));
     connect(options_page->mathFunctionComboBox, SIGNAL(currentIndexChanged(int)), this, SLOT(on_mathFunctionComboBox_currentIndexChanged(int)));
     connect(options_page->spnRefreshInterval, SIGNAL(valueChanged(int)), this, SLOT(on_spnRefreshInterval_valueChanged(int)));
+    connect(options_page->cmbPlotType, SIGNAL(currentIndexChanged(int)), this, SLOT(on_cmbPlotType_currentIndexChanged(int)));
+    on_cmbPlotType_currentIndexChanged(options_page->cmbPlotType->currentIndex());
 
     setYAxisWidgetFromPlotCurve();
 
@@ -133,6 +140,7 @@ QWidget *ScopeGadgetOptionsPage::createPage(QWidget *parent)
     options_page->LoggingPath->setPath(m_config->getLoggingPath());
     options_page->LoggingConnect->setChecked(m_config->getLoggingNewFileOnConnect());
     options_page->LoggingEnable->setChecked(m_config->getLoggingEnabled());
+    options_page->LoggingBinary->setChecked(m_config->getLoggingBinary());
     connect(options_page->LoggingEnable, SIGNAL(clicked()), this, SLOT(on_loggingEnable_clicked()));
     on_loggingEnable_clicked();
 
@@ -168,13 +176,23 @@ bool ScopeGadgetOptionsPage::eventFilter(QObject *obj, QEvent *evt)
 
 void ScopeGadgetOptionsPage::on_mathFunctionComboBox_currentIndexChanged(int currentIndex)
 {
-    if (currentIndex > 0) {
+    if (PlotMath::hasWindow((PlotMath::Function)currentIndex)) {
         options_page->spnMeanSamples->setEnabled(true);
     } else {
         options_page->spnMeanSamples->setEnabled(false);
     }
 }
 
+void ScopeGadgetOptionsPage::on_cmbPlotType_currentIndexChanged(int currentIndex)
+{
+    // The spectrum is taken over a number of samples instead of a time window
+    bool spectrum = (currentIndex == SpectrumPlot);
+
+    options_page->spnDataSize->setEnabled(!spectrum);
+    options_page->cmbSpectrumSize->setEnabled(spectrum);
+    options_page->spnSpectrumOverlap->setEnabled(spectrum);
+}
+
 void ScopeGadgetOptionsPage::on_btnColor_clicked()
 {
     QColor color = QColorDialog::getColor(QColor(options_page->btnColor->text()));
@@ -275,6 +293,9 @@ void ScopeGadgetOptionsPage::apply()
     m_config->setMathFunctionType(options_page->mathFunctionComboBox->currentIndex());
     m_config->setDataSize(options_page->spnDataSize->value());
     m_config->setRefreashInterval(options_page->spnRefreshInterval->value());
+    m_config->setSpectrumSize(options_page->cmbSpectrumSize->currentText().toInt());
+    m_config->setSpectrumOverlap(options_page->spnSpectrumOverlap->value());
+    m_config->setOpenGL(options_page->chkOpenGL->isChecked());
 
     QList<PlotCurveConfiguration *> plotCurveConfigs;
     for (int iIndex = 0; iIndex < options_page->lstCurves->count(); iIndex++) {
@@ -313,6 +334,7 @@ void ScopeGadgetOptionsPage::apply()
     m_config->setLoggingPath(options_page->LoggingPath->path());
     m_config->setLoggingNewFileOnConnect(options_page->LoggingConnect->isChecked());
     m_config->setLoggingEnabled(options_page->LoggingEnable->isChecked());
+    m_config->setLoggingBinary(options_page->LoggingBinary->isChecked());
 }
 
 /*!
@@ -407,6 +429,7 @@ void ScopeGadgetOptionsPage::on_loggingEnable_clicked()
 
     options_page->LoggingPath->setEnabled(en);
     options_page->LoggingConnect->setEnabled(en);
+    options_page->LoggingBinary->setEnabled(en);
     options_page->LoggingLabel->setEnabled(en);
 }
 
@@ -72,6 +72,7 @@ private:
     bool eventFilter(QObject *obj, QEvent *evt);
 
 private slots:
+    void on_cmbPlotType_currentIndexChanged(int currentIndex);
     void on_spnRefreshInterval_valueChanged(int);
     void on_lstCurves_currentRowChanged(int currentRow);
     void on_btnRemoveCurve_clicked();
@@ -53,28 +53,31 @@
 #include <QAction>
 #include <QClipboard>
 #include <QApplication>
+#include <QtNumeric>
 
 #include <qwt/src/qwt_legend_label.h>
 #include <qwt/src/qwt_plot_canvas.h>
+#include <qwt/src/qwt_plot_glcanvas.h>
 #include <qwt/src/qwt_plot_layout.h>
 
+// The time axis of the ChronoPlot runs ahead of the latest samples by this part of
+// the window, it only scrolls, and the plot is replotted, once they reach its end
+#define CHRONO_PAGE_LEAD 0.25
+
 ScopeGadgetWidget::ScopeGadgetWidget(QWidget *parent) : QwtPlot(parent),
+    m_spectrumSize(512), m_spectrumOverlap(50), m_suspended(false), m_pageEnd(-HUGE_VAL),
     m_csvLoggingStarted(false), m_csvLoggingEnabled(false),
-    m_csvLoggingHeaderSaved(false), m_csvLoggingDataSaved(false),
     m_csvLoggingNameSet(false), m_csvLoggingDataValid(false),
     m_csvLoggingDataUpdated(false), m_csvLoggingConnected(false),
-    m_csvLoggingNewFileOnConnect(false),
+    m_csvLoggingNewFileOnConnect(false), m_csvLoggingBinary(false),
     m_csvLoggingStartTime(QDateTime::currentDateTime()),
+    m_csvLoggingStartMSecs(m_csvLoggingStartTime.toMSecsSinceEpoch()),
     m_csvLoggingPath("./csvlogging/"),
     m_plotLegend(NULL)
 {
     setMouseTracking(true);
 
-    QwtPlotCanvas *plotCanvas = dynamic_cast<QwtPlotCanvas *>(canvas());
-    if (plotCanvas) {
-        plotCanvas->setFrameStyle(QFrame::StyledPanel | QFrame::Sunken);
-        plotCanvas->setBorderRadius(8);
-    }
+    setupCanvas(canvas());
 
     axisWidget(QwtPlot::yLeft)->setMargin(2);
     axisWidget(QwtPlot::xBottom)->setMargin(2);
@@ -82,6 +85,7 @@ ScopeGadgetWidget::ScopeGadgetWidget(QWidget *parent) : QwtPlot(parent),
     // Setup the timer that replots data
     replotTimer = new QTimer(this);
     connect(replotTimer, SIGNAL(timeout()), this, SLOT(replotNewData()));
+    m_directPainter = new QwtPlotDirectPainter(this);
 
     // Listen to telemetry connection/disconnection events, no point in
     // running the scopes if we are not connected and not replaying logs.
@@ -90,14 +94,60 @@ ScopeGadgetWidget::ScopeGadgetWidget(QWidget *parent) : QwtPlot(parent),
     connect(cm, SIGNAL(deviceAboutToDisconnect()), this, SLOT(stopPlotting()));
     connect(cm, SIGNAL(deviceConnected(QIODevice *)), this, SLOT(startPlotting()));
 
+    // Replayed logs are plotted in log time and can jump
+    connect(cm, SIGNAL(deviceConnected(QIODevice *)), this, SLOT(deviceConnected(QIODevice *)));
+    connect(cm, SIGNAL(deviceAboutToDisconnect()), this, SLOT(deviceDisconnected()));
+
     // Listen to autopilot connection events
     connect(cm, SIGNAL(deviceAboutToDisconnect()), this, SLOT(csvLoggingDisconnect()));
     connect(cm, SIGNAL(deviceConnected(QIODevice *)), this, SLOT(csvLoggingConnect()));
 
+    // The curves get their samples from the store, which tells when an update has been plotted
+    connect(ScopeSampleStore::instance(), SIGNAL(objectDecoded(UAVObject *)), this, SLOT(uavObjectReceived(UAVObject *)));
+
     setContextMenuPolicy(Qt::CustomContextMenu);
     connect(this, SIGNAL(customContextMenuRequested(const QPoint &)), this, SLOT(popUpMenu(const QPoint &)));
 }
 
+/**
+ * Switches between the raster canvas and an OpenGL canvas. The curves
+ * are drawn into a GL framebuffer then, which keeps the paint time of
+ * wide plots with many curves off the CPU.
+ */
+void ScopeGadgetWidget::setOpenGL(bool openGL)
+{
+    if (openGL == (qobject_cast<QwtPlotGLCanvas *>(canvas()) != NULL)) {
+        return;
+    }
+
+    QWidget *plotCanvas;
+    if (openGL) {
+        plotCanvas = new QwtPlotGLCanvas();
+    } else {
+        plotCanvas = new QwtPlotCanvas();
+    }
+    setupCanvas(plotCanvas);
+
+    // The plot deletes the old canvas
+    setCanvas(plotCanvas);
+}
+
+void ScopeGadgetWidget::setupCanvas(QWidget *plotCanvas)
+{
+    QwtPlotCanvas *rasterCanvas = qobject_cast<QwtPlotCanvas *>(plotCanvas);
+
+    if (rasterCanvas) {
+        rasterCanvas->setFrameStyle(QFrame::StyledPanel | QFrame::Sunken);
+        rasterCanvas->setBorderRadius(8);
+    }
+
+    // The GL canvas only imitates a frame and has no styled panel
+    QwtPlotGLCanvas *glCanvas = qobject_cast<QwtPlotGLCanvas *>(plotCanvas);
+    if (glCanvas) {
+        glCanvas->setFrameStyle(QwtPlotGLCanvas::Panel | QwtPlotGLCanvas::Sunken);
+    }
+}
+
 ScopeGadgetWidget::~ScopeGadgetWidget()
 {
     if (replotTimer) {
@@ -106,15 +156,6 @@ ScopeGadgetWidget::~ScopeGadgetWidget()
         replotTimer = NULL;
     }
 
-    // Get the object to de-monitor
-    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
-    UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
-    foreach(QString uavObjName, m_connectedUAVObjects) {
-        UAVDataObject *obj = dynamic_cast<UAVDataObject *>(objManager->getObject(uavObjName));
-
-        disconnect(obj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(uavObjectReceived(UAVObject *)));
-    }
-
     clearCurvePlots();
 }
 
@@ -194,7 +235,7 @@ void ScopeGadgetWidget::showEvent(QShowEvent *e)
  */
 void ScopeGadgetWidget::startPlotting()
 {
-    if (replotTimer && !replotTimer->isActive()) {
+    if (replotTimer && !replotTimer->isActive() && !m_suspended) {
         foreach(PlotData * plot, m_curvesData.values()) {
             if (plot->wantsInitialData()) {
                 plot->append(NULL);
@@ -211,6 +252,106 @@ void ScopeGadgetWidget::stopPlotting()
     }
 }
 
+/**
+ * A suspended scope stops plotting and its curves stop receiving samples,
+ * unless they are logged to a CSV file. Once resumed, the curves start
+ * again from the samples kept by the sample store.
+ */
+void ScopeGadgetWidget::setSuspended(bool suspended)
+{
+    if (m_suspended == suspended) {
+        return;
+    }
+    m_suspended = suspended;
+
+    m_mutex.lock();
+    if (!m_csvLoggingEnabled) {
+        foreach(PlotData * plotData, m_curvesData.values()) {
+            plotData->setSuspended(suspended);
+        }
+    }
+    m_mutex.unlock();
+
+    if (suspended) {
+        stopPlotting();
+    } else if (Core::ICore::instance()->connectionManager()->isConnected()) {
+        startPlotting();
+    }
+}
+
+void ScopeGadgetWidget::deviceConnected(QIODevice *device)
+{
+    setReplay(qobject_cast<LogFile *>(device));
+}
+
+void ScopeGadgetWidget::deviceDisconnected()
+{
+    setReplay(NULL);
+}
+
+/**
+ * Switches the plots between clock time and the time of a replayed log.
+ * Data of one can not be shown with the other, so the plots are cleared.
+ */
+void ScopeGadgetWidget::setReplay(LogFile *replay)
+{
+    if (m_replay == replay) {
+        return;
+    }
+    if (m_replay) {
+        disconnect(m_replay, SIGNAL(replaySeeked(int)), this, SLOT(replaySeeked(int)));
+    }
+    m_replay = replay;
+    if (m_replay) {
+        connect(m_replay, SIGNAL(replaySeeked(int)), this, SLOT(replaySeeked(int)));
+    }
+    ScopeSampleStore::instance()->setReplay(replay);
+    m_pageEnd = -HUGE_VAL;
+
+    QMutexLocker locker(&m_mutex);
+    foreach(PlotData * plotData, m_curvesData.values()) {
+        plotData->clear();
+    }
+    if (m_plotType == ChronoPlot) {
+        if (m_replay) {
+            setAxisScaleDraw(QwtPlot::xBottom, new ReplayTimeScaleDraw());
+        } else {
+            setAxisScaleDraw(QwtPlot::xBottom, new TimeScaleDraw());
+        }
+    }
+}
+
+/**
+ * The replay jumped, refill the plots with the data before the new position
+ * straight from the log instead of waiting for it to be replayed again.
+ */
+void ScopeGadgetWidget::replaySeeked(int time)
+{
+    if (!m_replay) {
+        return;
+    }
+
+    m_mutex.lock();
+    foreach(PlotData * plotData, m_curvesData.values()) {
+        UAVObject *obj = plotData->object();
+        if (plotData->plotType() == ChronoPlot) {
+            plotData->setReplayData(m_replay->replaySamples(obj->getObjID(), obj->getInstID(),
+                                                            time - (int)(m_plotDataSize * 1000), time));
+        } else {
+            // The spectrum is taken over the last frame before the seek position
+            int count = (int)m_plotDataSize;
+            if (plotData->plotType() == SpectrumPlot) {
+                count = static_cast<SpectrumPlotData *>(plotData)->spectrumSize();
+            }
+            QVector<LogFile::ReplaySample> samples = m_replay->replaySamples(obj->getObjID(), obj->getInstID(), 0, time);
+            plotData->setReplayData(samples.mid(qMax(0, samples.size() - count)));
+        }
+    }
+    m_mutex.unlock();
+
+    replotNewData();
+}
+
 void ScopeGadgetWidget::deleteLegend()
 {
     if (m_plotLegend) {
@@ -271,7 +412,7 @@ void ScopeGadgetWidget::preparePlot(PlotType plotType)
 
     // Only start the timer if we are already connected
     Core::ConnectionManager *cm = Core::ICore::instance()->connectionManager();
-    if (cm->isConnected() && replotTimer) {
+    if (cm->isConnected() && replotTimer && !m_suspended) {
         if (!replotTimer->isActive()) {
             replotTimer->start(m_refreshInterval);
         } else {
@@ -318,9 +459,31 @@ void ScopeGadgetWidget::setupChronoPlot()
 {
     preparePlot(ChronoPlot);
 
-    setAxisScaleDraw(QwtPlot::xBottom, new TimeScaleDraw());
+    if (m_replay) {
+        setAxisScaleDraw(QwtPlot::xBottom, new ReplayTimeScaleDraw());
+    } else {
+        setAxisScaleDraw(QwtPlot::xBottom, new TimeScaleDraw());
+    }
     uint NOW = QDateTime::currentDateTime().toTime_t();
     setAxisScale(QwtPlot::xBottom, NOW - m_plotDataSize / 1000, NOW);
+    m_pageEnd = -HUGE_VAL;
+    setAxisLabelRotation(QwtPlot::xBottom, 0.0);
+    setAxisLabelAlignment(QwtPlot::xBottom, Qt::AlignLeft | Qt::AlignBottom);
+
+    // reduce the axis font size
+    QFont fnt(axisFont(QwtPlot::xBottom));
+    fnt.setPointSize(7);
+    setAxisFont(QwtPlot::xBottom, fnt); // x-axis
+    setAxisFont(QwtPlot::yLeft, fnt); // y-axis
+}
+
+void ScopeGadgetWidget::setupSpectrumPlot()
+{
+    preparePlot(SpectrumPlot);
+
+    // Frequencies run from 0 to the Nyquist frequency of the update rate
+    setAxisScaleDraw(QwtPlot::xBottom, new QwtScaleDraw());
+    setAxisAutoScale(QwtPlot::xBottom);
     setAxisLabelRotation(QwtPlot::xBottom, 0.0);
     setAxisLabelAlignment(QwtPlot::xBottom, Qt::AlignLeft | Qt::AlignBottom);
 
@@ -379,32 +542,39 @@ void ScopeGadgetWidget::addCurvePlot(QString objectName, QString fieldPlusSubFie
         plotData = new ChronoPlotData(object, field, element, scaleFactor,
                                       meanSamples, mathFunction, m_plotDataSize,
                                       pen, antialiased);
+    } else if (m_plotType == SpectrumPlot) {
+        plotData = new SpectrumPlotData(object, field, element, scaleFactor,
+                                        meanSamples, mathFunction, m_plotDataSize,
+                                        pen, antialiased, m_spectrumSize, m_spectrumOverlap);
     }
     connect(this, SIGNAL(visibilityChanged(QwtPlotItem *)), plotData, SLOT(visibilityChanged(QwtPlotItem *)));
     plotData->attach(this);
+    // Start from what the other scopes have already received
+    plotData->appendHistory();
+    if (m_suspended && !m_csvLoggingEnabled) {
+        plotData->setSuspended(true);
+    }
 
     // Keep the curve details for later
     m_curvesData.insert(plotData->plotName(), plotData);
 
-    // Link to the new signal data only if this UAVObject has not been connected yet
-    if (!m_connectedUAVObjects.contains(object->getName())) {
-        m_connectedUAVObjects.append(object->getName());
-        connect(object, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(uavObjectReceived(UAVObject *)));
-    }
-
     m_mutex.lock();
     replot();
     m_mutex.unlock();
 }
 
+/**
+ * The curves of obj have already been handed the update by the sample store
+ */
 void ScopeGadgetWidget::uavObjectReceived(UAVObject *obj)
 {
     foreach(PlotData * plotData, m_curvesData.values()) {
-        if (plotData->append(obj)) {
+        if (plotData->object() == obj) {
             m_csvLoggingDataUpdated = 1;
+            csvLoggingAddData();
+            return;
         }
     }
-    csvLoggingAddData();
 }
 
 void ScopeGadgetWidget::replotNewData()
@@ -422,13 +592,54 @@ void ScopeGadgetWidget::replotNewData()
     QDateTime NOW = QDateTime::currentDateTime();
     double toTime = NOW.toTime_t();
     toTime += NOW.time().msec() / 1000.0;
+    if (m_replay) {
+        toTime = m_replay->replayTime() / 1000.0;
+    }
+    bool replotNeeded = true;
     if (m_plotType == ChronoPlot) {
-        setAxisScale(QwtPlot::xBottom, toTime - m_plotDataSize, toTime);
+        double lead = m_plotDataSize * CHRONO_PAGE_LEAD;
+        if (toTime > m_pageEnd || toTime < m_pageEnd - lead) {
+            // Scroll by a page, or jump to where a replay was moved to
+            m_pageEnd = toTime + lead;
+            setAxisScale(QwtPlot::xBottom, toTime - m_plotDataSize, m_pageEnd);
+        } else {
+            replotNeeded = !drawNewData();
+        }
     }
 
-    csvLoggingInsertData();
+    if (replotNeeded) {
+        replot();
+    }
+}
 
-    replot();
+/**
+ * Paints the samples appended since the last replot over the plot, which costs
+ * as much as the new samples only. Returns false when a replot is needed instead.
+ */
+bool ScopeGadgetWidget::drawNewData()
+{
+    // The GL canvas is repainted as a whole anyway
+    if (!qobject_cast<QwtPlotCanvas *>(canvas())) {
+        return false;
+    }
+
+    foreach(PlotData * plotData, m_curvesData.values()) {
+        if (!plotData->canDrawNewSamples()) {
+            return false;
+        }
+    }
+    foreach(PlotData * plotData, m_curvesData.values()) {
+        plotData->drawNewSamples(m_directPainter);
+    }
+    return true;
+}
+
+void ScopeGadgetWidget::replot()
+{
+    QwtPlot::replot();
+    foreach(PlotData * plotData, m_curvesData.values()) {
+        plotData->markDrawn();
+    }
 }
 
 void ScopeGadgetWidget::clearCurvePlots()
@@ -475,39 +686,42 @@ void ScopeGadgetWidget::restoreState(QSettings *qSettings)
     }
 }
 
-/*
-   int csvLoggingEnable;
-   int csvLoggingHeaderSaved;
-   int csvLoggingDataSaved;
-   QString csvLoggingPath;
-   QFile csvLoggingFile;
- */
 int ScopeGadgetWidget::csvLoggingStart()
 {
     if (!m_csvLoggingStarted) {
         if (m_csvLoggingEnabled) {
             if ((!m_csvLoggingNewFileOnConnect) || (m_csvLoggingNewFileOnConnect && m_csvLoggingConnected)) {
                 QDateTime NOW = QDateTime::currentDateTime();
-                m_csvLoggingStartTime   = NOW;
-                m_csvLoggingHeaderSaved = 0;
-                m_csvLoggingDataSaved   = 0;
-                m_csvLoggingBuffer.clear();
+                m_csvLoggingStartTime  = NOW;
+                m_csvLoggingStartMSecs = NOW.toMSecsSinceEpoch();
                 QDir PathCheck(m_csvLoggingPath);
                 if (!PathCheck.exists()) {
                     PathCheck.mkpath("./");
                 }
 
+                QString extension = m_csvLoggingBinary ? "bin" : "csv";
+                QString fileName;
                 if (m_csvLoggingNameSet) {
-                    m_csvLoggingFile.setFileName(QString("%1/%2_%3_%4.csv").arg(m_csvLoggingPath).arg(m_csvLoggingName).arg(NOW.toString("yyyy-MM-dd")).arg(NOW.toString("hh-mm-ss")));
+                    fileName = QString("%1/%2_%3_%4.%5").arg(m_csvLoggingPath).arg(m_csvLoggingName).arg(NOW.toString("yyyy-MM-dd")).arg(NOW.toString("hh-mm-ss")).arg(extension);
                 } else {
-                    m_csvLoggingFile.setFileName(QString("%1/Log_%2_%3.csv").arg(m_csvLoggingPath).arg(NOW.toString("yyyy-MM-dd")).arg(NOW.toString("hh-mm-ss")));
+                    fileName = QString("%1/Log_%2_%3.%4").arg(m_csvLoggingPath).arg(NOW.toString("yyyy-MM-dd")).arg(NOW.toString("hh-mm-ss")).arg(extension);
                 }
-                QDir FileCheck(m_csvLoggingFile.fileName());
-                if (FileCheck.exists()) {
-                    m_csvLoggingFile.setFileName("");
-                } else {
-                    m_csvLoggingStarted = 1;
-                    csvLoggingInsertHeader();
+                QDir FileCheck(fileName);
+                if (!FileCheck.exists()) {
+                    QList<CsvLogWriter::Column> columns;
+                    foreach(PlotData * plotData2, m_curvesData.values()) {
+                        CsvLogWriter::Column column;
+                        column.name = plotData2->objectName() + "." + plotData2->field()->getName();
+                        if (!plotData2->elementName().isEmpty()) {
+                            column.name += "." + plotData2->elementName();
+                        }
+                        if (plotData2->field()->getType() == UAVObjectField::ENUM) {
+                            column.options = plotData2->field()->getOptions();
+                        }
+                        columns.append(column);
+                    }
+                    m_csvLoggingRow.resize(columns.size());
+                    m_csvLoggingStarted = m_csvLogWriter.open(fileName, columns, NOW, m_csvLoggingBinary);
                 }
             }
         }
@@ -519,94 +733,40 @@ int ScopeGadgetWidget::csvLoggingStart()
 int ScopeGadgetWidget::csvLoggingStop()
 {
     m_csvLoggingStarted = 0;
+    m_csvLogWriter.close();
 
     return 0;
 }
 
-int ScopeGadgetWidget::csvLoggingInsertHeader()
+/**
+ * Queues a row with the last value of every curve, the writer thread formats it
+ */
+int ScopeGadgetWidget::csvLoggingAddData()
 {
     if (!m_csvLoggingStarted) {
         return -1;
     }
-    if (m_csvLoggingHeaderSaved) {
+    // The curves have changed since the header was written
+    if (m_curvesData.size() != m_csvLogWriter.columnCount()) {
         return -2;
     }
-    if (m_csvLoggingDataSaved) {
-        return -3;
-    }
 
-    m_csvLoggingHeaderSaved = 1;
-    if (m_csvLoggingFile.open(QIODevice::WriteOnly | QIODevice::Append) == false) {
-        qDebug() << "Unable to open " << m_csvLoggingFile.fileName() << " for csv logging Header";
-    } else {
-        QTextStream ts(&m_csvLoggingFile);
-        ts << "date" << ", " << "Time" << ", " << "Sec since start" << ", " << "Connected" << ", " << "Data changed";
-
-        foreach(PlotData * plotData2, m_curvesData.values()) {
-            ts << ", ";
-            ts << plotData2->objectName();
-            ts << "." << plotData2->field()->getName();
-            if (!plotData2->elementName().isEmpty()) {
-                ts << "." << plotData2->elementName();
-            }
-        }
-        ts << endl;
-        m_csvLoggingFile.close();
-    }
-    return 0;
-}
-
-int ScopeGadgetWidget::csvLoggingAddData()
-{
-    if (!m_csvLoggingStarted) {
-        return -1;
-    }
     m_csvLoggingDataValid = false;
-    QDateTime NOW = QDateTime::currentDateTime();
-    QString tempString;
-
-    QTextStream ss(&tempString);
-    ss << NOW.toString("yyyy-MM-dd") << ", " << NOW.toString("hh:mm:ss.z") << ", ";
-
-#if QT_VERSION >= 0x040700
-    ss << (NOW.toMSecsSinceEpoch() - m_csvLoggingStartTime.toMSecsSinceEpoch()) / 1000.00;
-#else
-    ss << (NOW.toTime_t() - m_csvLoggingStartTime.toTime_t());
-#endif
-    ss << ", " << m_csvLoggingConnected << ", " << m_csvLoggingDataUpdated;
-    m_csvLoggingDataUpdated = false;
-
+    int column = 0;
     foreach(PlotData * plotData2, m_curvesData.values()) {
-        ss << ", ";
         if (plotData2->hasData()) {
-            ss << plotData2->lastDataAsString();
-            m_csvLoggingDataValid = true;
+            m_csvLoggingRow[column] = plotData2->lastData();
+            m_csvLoggingDataValid   = true;
+        } else {
+            m_csvLoggingRow[column] = qQNaN();
         }
+        column++;
     }
-    ss << endl;
     if (m_csvLoggingDataValid) {
-        QTextStream ts(&m_csvLoggingBuffer);
-        ts << tempString;
-    }
-
-    return 0;
-}
-
-int ScopeGadgetWidget::csvLoggingInsertData()
-{
-    if (!m_csvLoggingStarted) {
-        return -1;
+        m_csvLogWriter.appendRow(QDateTime::currentMSecsSinceEpoch() - m_csvLoggingStartMSecs,
+                                 m_csvLoggingConnected, m_csvLoggingDataUpdated, m_csvLoggingRow.constData());
     }
-    m_csvLoggingDataSaved = 1;
-
-    if (m_csvLoggingFile.open(QIODevice::WriteOnly | QIODevice::Append) == false) {
-        qDebug() << "Unable to open " << m_csvLoggingFile.fileName() << " for csv logging Data";
-    } else {
-        QTextStream ts(&m_csvLoggingFile);
-        ts << m_csvLoggingBuffer;
-        m_csvLoggingFile.close();
-    }
-    m_csvLoggingBuffer.clear();
+    m_csvLoggingDataUpdated = false;
 
     return 0;
 }
@@ -627,8 +787,7 @@ void ScopeGadgetWidget::csvLoggingConnect()
 
 void ScopeGadgetWidget::csvLoggingDisconnect()
 {
-    m_csvLoggingHeaderSaved = 0;
-    m_csvLoggingConnected   = 0;
+    m_csvLoggingConnected = 0;
     if (m_csvLoggingNewFileOnConnect) {
         csvLoggingStop();
     }
@@ -29,11 +29,13 @@
 #define SCOPEGADGETWIDGET_H_
 
 #include "plotdata.h"
+#include "csvlogwriter.h"
 
 #include "qwt/src/qwt.h"
 #include "qwt/src/qwt_legend.h"
 #include "qwt/src/qwt_plot.h"
 #include "qwt/src/qwt_plot_curve.h"
+#include "qwt/src/qwt_plot_directpainter.h"
 #include "qwt/src/qwt_scale_draw.h"
 #include "qwt/src/qwt_scale_widget.h"
 
@@ -41,6 +43,8 @@
 #include <QTime>
 #include <QVector>
 #include <QMutex>
+#include <QPointer>
+#include <utils/logfile.h>
 
 class QSettings;
 
@@ -62,6 +66,19 @@ public:
     }
 };
 
+/*!
+   \brief Renders the time since the start of the log on the horizontal axis for the
+   ChronoPlot while a log is replayed.
+ */
+class ReplayTimeScaleDraw : public QwtScaleDraw {
+public:
+    ReplayTimeScaleDraw() {}
+    virtual QwtText label(double v) const
+    {
+        return QTime(0, 0).addMSecs(qMax(v, 0.0) * 1000).toString("hh:mm:ss");
+    }
+};
+
 class ScopeGadgetWidget : public QwtPlot {
     Q_OBJECT
 
@@ -71,6 +88,7 @@ public:
 
     void setupSequentialPlot();
     void setupChronoPlot();
+    void setupSpectrumPlot();
     void setupUAVObjectPlot();
     PlotType plotType()
     {
@@ -93,7 +111,17 @@ public:
     {
         return m_refreshInterval;
     }
+    void setSpectrum(int size, int overlap)
+    {
+        m_spectrumSize    = size;
+        m_spectrumOverlap = overlap;
+    }
+    void setOpenGL(bool openGL);
+    // Stops the plots while the scope is hidden
+    void setSuspended(bool suspended);
 
+    // Replots everything, the new samples of the ChronoPlot are painted over it in between
+    void replot();
 
     void addCurvePlot(QString uavObject, QString uavFieldSubField, int scaleOrderFactor = 0, int meanSamples = 1,
                       QString mathFunction = "None", QPen pen = QPen(Qt::black), bool antialiased = true);
@@ -118,6 +146,10 @@ public:
     {
         m_csvLoggingPath = value;
     }
+    void setLoggingBinary(bool value)
+    {
+        m_csvLoggingBinary = value;
+    }
 signals:
     void visibilityChanged(QwtPlotItem *item);
 
@@ -141,44 +173,59 @@ private slots:
     void clearPlot();
     void copyToClipboardAsImage();
     void showOptionDialog();
+    void deviceConnected(QIODevice *device);
+    void deviceDisconnected();
+    void replaySeeked(int time);
 
 private:
 
     void preparePlot(PlotType plotType);
     void setupExamplePlot();
+    void setupCanvas(QWidget *canvas);
+    void setReplay(LogFile *replay);
+    bool drawNewData();
 
     PlotType m_plotType;
 
     double m_plotDataSize;
     int m_refreshInterval;
-    QList<QString> m_connectedUAVObjects;
+    int m_spectrumSize;
+    int m_spectrumOverlap;
     QMap<QString, PlotData *> m_curvesData;
 
     QTimer *replotTimer;
+    bool m_suspended;
+
+    // Paints the new samples of the ChronoPlot between the replots
+    QwtPlotDirectPainter *m_directPainter;
+    // End of the time axis of the ChronoPlot, which scrolls by pages
+    double m_pageEnd;
+
+    // the replayed log while the GCS is connected to one
+    QPointer<LogFile> m_replay;
 
     bool m_csvLoggingStarted;
     bool m_csvLoggingEnabled;
-    bool m_csvLoggingHeaderSaved;
-    bool m_csvLoggingDataSaved;
     bool m_csvLoggingNameSet;
     bool m_csvLoggingDataValid;
     bool m_csvLoggingDataUpdated;
     bool m_csvLoggingConnected;
     bool m_csvLoggingNewFileOnConnect;
+    bool m_csvLoggingBinary;
 
     QDateTime m_csvLoggingStartTime;
+    qint64 m_csvLoggingStartMSecs;
 
     QString m_csvLoggingName;
     QString m_csvLoggingPath;
-    QString m_csvLoggingBuffer;
-    QFile m_csvLoggingFile;
+    // Formats and writes the rows in the background
+    CsvLogWriter m_csvLogWriter;
+    QVector<double> m_csvLoggingRow;
 
     QMutex m_mutex;
     QwtLegend *m_plotLegend;
 
-    int csvLoggingInsertHeader();
     int csvLoggingAddData();
-    int csvLoggingInsertData();
 
     void deleteLegend();
     void addLegend();
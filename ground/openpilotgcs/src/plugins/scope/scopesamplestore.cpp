@@ -0,0 +1,140 @@
+/**
+ ******************************************************************************
+ *
+ * @file       scopesamplestore.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ScopePlugin Scope Gadget Plugin
+ * @{
+ * @brief The scope Gadget, graphically plots the states of UAVObjects
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "scopesamplestore.h"
+#include "plotdata.h"
+
+#include <QDateTime>
+
+double ScopeSeries::decode(UAVObjectField *field) const
+{
+    if (field->getType() == UAVObjectField::ENUM) {
+        return field->getOptions().indexOf(field->getValue(m_element).toString());
+    }
+    return field->getDouble(m_element);
+}
+
+ScopeSampleStore *ScopeSampleStore::instance()
+{
+    static ScopeSampleStore store;
+
+    return &store;
+}
+
+ScopeSampleStore::~ScopeSampleStore()
+{
+    foreach(const QList<ScopeSeries *> &series, m_series) {
+        qDeleteAll(series);
+    }
+}
+
+ScopeSeries *ScopeSampleStore::subscribe(PlotData *view, UAVObject *object, UAVObjectField *field, int element)
+{
+    QList<ScopeSeries *> &objectSeries = m_series[object];
+
+    if (objectSeries.isEmpty()) {
+        connect(object, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(objectUpdated(UAVObject *)));
+    }
+
+    ScopeSeries *series = NULL;
+    foreach(ScopeSeries * s, objectSeries) {
+        if (s->m_field == field && s->m_element == element) {
+            series = s;
+            break;
+        }
+    }
+    if (!series) {
+        series = new ScopeSeries(object, field, element);
+        series->m_history.reserve(ScopeSeries::HistorySize);
+        objectSeries.append(series);
+    }
+    series->m_views.append(view);
+    return series;
+}
+
+void ScopeSampleStore::unsubscribe(PlotData *view, ScopeSeries *series)
+{
+    series->m_views.removeAll(view);
+    if (!series->m_views.isEmpty()) {
+        return;
+    }
+
+    UAVObject *object = series->m_object;
+    QList<ScopeSeries *> &objectSeries = m_series[object];
+    objectSeries.removeAll(series);
+    delete series;
+    if (objectSeries.isEmpty()) {
+        disconnect(object, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(objectUpdated(UAVObject *)));
+        m_series.remove(object);
+    }
+}
+
+void ScopeSampleStore::setReplay(LogFile *replay)
+{
+    if (m_replay == replay) {
+        return;
+    }
+    m_replay = replay;
+    // Times of the clock and of the replay can not be mixed
+    foreach(const QList<ScopeSeries *> &series, m_series) {
+        foreach(ScopeSeries * s, series) {
+            s->m_history.clear();
+        }
+    }
+}
+
+double ScopeSampleStore::currentTime() const
+{
+    if (m_replay) {
+        return m_replay->replayTime() / 1000.0;
+    }
+    QDateTime now = QDateTime::currentDateTime();
+    return now.toTime_t() + now.time().msec() / 1000.0;
+}
+
+void ScopeSampleStore::objectUpdated(UAVObject *obj)
+{
+    QList<ScopeSeries *> objectSeries = m_series.value(obj);
+
+    if (objectSeries.isEmpty()) {
+        return;
+    }
+
+    ScopeSeries::Sample sample;
+    sample.time = currentTime();
+    foreach(ScopeSeries * series, objectSeries) {
+        sample.value = series->decode(series->m_field);
+        if (series->m_history.size() >= ScopeSeries::HistorySize) {
+            series->m_history.removeFirst(1);
+        }
+        series->m_history.append(sample);
+        foreach(PlotData * view, series->m_views) {
+            view->appendSample(sample);
+        }
+    }
+    emit objectDecoded(obj);
+}
@@ -0,0 +1,115 @@
+/**
+ ******************************************************************************
+ *
+ * @file       scopesamplestore.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ScopePlugin Scope Gadget Plugin
+ * @{
+ * @brief The scope Gadget, graphically plots the states of UAVObjects
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef SCOPESAMPLESTORE_H
+#define SCOPESAMPLESTORE_H
+
+#include "plotsamples.h"
+#include "uavobject.h"
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QPointer>
+#include <utils/logfile.h>
+
+class PlotData;
+
+/*!
+   \brief One element of a UAVObject field, decoded once per update for all the
+   curves of all the scopes plotting it. The latest samples are kept, so that a
+   new curve can start from them.
+ */
+class ScopeSeries {
+public:
+    struct Sample {
+        double time;
+        // Enums are the index of their option
+        double value;
+    };
+
+    // Samples kept for the curves created later
+    static const int HistorySize = 1024;
+
+    UAVObject *object() const
+    {
+        return m_object;
+    }
+    const PlotRing<Sample> &history() const
+    {
+        return m_history;
+    }
+    // Decodes the current value of the element from field, which belongs to the object or a copy of it
+    double decode(UAVObjectField *field) const;
+
+private:
+    friend class ScopeSampleStore;
+    ScopeSeries(UAVObject *object, UAVObjectField *field, int element) :
+        m_object(object), m_field(field), m_element(element)
+    {}
+
+    UAVObject *m_object;
+    UAVObjectField *m_field;
+    int m_element;
+    PlotRing<Sample> m_history;
+    QList<PlotData *> m_views;
+};
+
+/*!
+   \brief Decodes the fields plotted by the scope gadgets when their objects are
+   updated, and hands the samples to the curves showing them.
+ */
+class ScopeSampleStore : public QObject {
+    Q_OBJECT
+
+public:
+    static ScopeSampleStore *instance();
+
+    // The curve gets the samples of the element from now on
+    ScopeSeries *subscribe(PlotData *view, UAVObject *object, UAVObjectField *field, int element);
+    void unsubscribe(PlotData *view, ScopeSeries *series);
+
+    // While a log is replayed, samples are time stamped with the position of the replay
+    void setReplay(LogFile *replay);
+    double currentTime() const;
+
+signals:
+    // The samples of the update of obj have been handed to the curves
+    void objectDecoded(UAVObject *obj);
+
+private slots:
+    void objectUpdated(UAVObject *obj);
+
+private:
+    ScopeSampleStore() {}
+    ~ScopeSampleStore();
+
+    QHash<UAVObject *, QList<ScopeSeries *> > m_series;
+    QPointer<LogFile> m_replay;
+};
+
+#endif // SCOPESAMPLESTORE_H
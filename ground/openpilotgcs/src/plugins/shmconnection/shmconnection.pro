@@ -0,0 +1,15 @@
+TEMPLATE = lib
+TARGET = ShmConnection
+include(../../openpilotgcsplugin.pri)
+include(shmconnection_dependencies.pri)
+
+# The ring layout is shared with the firmware driver (flight/pios/posix/pios_shm.c)
+INCLUDEPATH += $$ROOT_DIR/flight/pios/inc
+
+HEADERS += shmconnectionplugin.h \
+    shmdevice.h
+SOURCES += shmconnectionplugin.cpp \
+    shmdevice.cpp
+OTHER_FILES += ShmConnection.pluginspec
+
+linux:LIBS += -lrt
@@ -0,0 +1 @@
+include(../../plugins/coreplugin/coreplugin.pri)
\ No newline at end of file
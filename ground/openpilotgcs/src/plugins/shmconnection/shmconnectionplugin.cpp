@@ -0,0 +1,146 @@
+/**
+ ******************************************************************************
+ *
+ * @file       shmconnectionplugin.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ShmConnPlugin Shared Memory Telemetry Plugin
+ * @{
+ * @brief Telemetry with a SITL board on the same host over shared memory
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "shmconnectionplugin.h"
+#include "shmdevice.h"
+
+#include <pios_shm_ring.h>
+
+#include <QtCore/QtPlugin>
+#include <QDebug>
+
+// simposix instances looked for, see the -i option
+#define SHM_MAX_INSTANCES         10
+#define SHM_ENUMERATION_PERIOD_MS 2000
+
+ShmConnection::ShmConnection() : m_device(NULL)
+{
+    connect(&m_pollTimer, SIGNAL(timeout()), this, SLOT(pollDevices()));
+    m_pollTimer.start(SHM_ENUMERATION_PERIOD_MS);
+}
+
+ShmConnection::~ShmConnection()
+{
+    if (m_device) {
+        m_device->close();
+        delete m_device;
+    }
+}
+
+void ShmConnection::pollDevices()
+{
+    if (m_device) {
+        return;
+    }
+    QList <Core::IConnection::device> devices = availableDevices();
+    if (devices != m_devices) {
+        m_devices = devices;
+        emit availableDevChanged(this);
+    }
+}
+
+QList <Core::IConnection::device> ShmConnection::availableDevices()
+{
+    QList <Core::IConnection::device> list;
+
+    for (int instance = 0; instance < SHM_MAX_INSTANCES; instance++) {
+        QString name = QString().sprintf(PIOS_SHM_NAME_FORMAT, instance);
+        if (ShmDevice::exists(name)) {
+            device d;
+            d.name = name;
+            d.displayName = QString("SITL instance %1").arg(instance);
+            list.append(d);
+        }
+    }
+    return list;
+}
+
+QIODevice *ShmConnection::openDevice(const QString &deviceName)
+{
+    if (m_device) {
+        closeDevice(deviceName);
+    }
+    // No parent, the device is moved to the telemetry thread (see telemetrymanager.cpp)
+    ShmDevice *device = new ShmDevice(deviceName);
+    if (!device->open(QIODevice::ReadWrite)) {
+        qWarning() << "ShmConnection:" << device->errorString();
+        delete device;
+        return NULL;
+    }
+    m_device = device;
+    return m_device;
+}
+
+void ShmConnection::closeDevice(const QString &deviceName)
+{
+    Q_UNUSED(deviceName);
+    if (m_device) {
+        m_device->deleteLater();
+        m_device = NULL;
+    }
+}
+
+QString ShmConnection::connectionName()
+{
+    return QString("Shared memory SITL port");
+}
+
+QString ShmConnection::shortName()
+{
+    return QString("SITL");
+}
+
+void ShmConnection::suspendPolling()
+{
+    m_pollTimer.stop();
+}
+
+void ShmConnection::resumePolling()
+{
+    m_pollTimer.start(SHM_ENUMERATION_PERIOD_MS);
+}
+
+
+ShmConnectionPlugin::ShmConnectionPlugin() : m_connection(NULL)
+{}
+
+ShmConnectionPlugin::~ShmConnectionPlugin()
+{}
+
+void ShmConnectionPlugin::extensionsInitialized()
+{
+    addAutoReleasedObject(m_connection);
+}
+
+bool ShmConnectionPlugin::initialize(const QStringList &arguments, QString *errorString)
+{
+    Q_UNUSED(arguments);
+    Q_UNUSED(errorString);
+    m_connection = new ShmConnection();
+
+    return true;
+}
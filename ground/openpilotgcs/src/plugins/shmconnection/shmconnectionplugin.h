@@ -0,0 +1,82 @@
+/**
+ ******************************************************************************
+ *
+ * @file       shmconnectionplugin.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ShmConnPlugin Shared Memory Telemetry Plugin
+ * @{
+ * @brief Telemetry with a SITL board on the same host over shared memory
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef SHMCONNECTIONPLUGIN_H
+#define SHMCONNECTIONPLUGIN_H
+
+#include "coreplugin/iconnection.h"
+#include <extensionsystem/iplugin.h>
+#include <QTimer>
+
+class ShmDevice;
+
+/**
+ * One device per simposix instance started with -s, the instances are
+ * looked for every two seconds while no device is open.
+ */
+class ShmConnection : public Core::IConnection {
+    Q_OBJECT
+
+public:
+    ShmConnection();
+    virtual ~ShmConnection();
+
+    virtual QList <Core::IConnection::device> availableDevices();
+    virtual QIODevice *openDevice(const QString &deviceName);
+    virtual void closeDevice(const QString &deviceName);
+
+    virtual QString connectionName();
+    virtual QString shortName();
+
+    virtual void suspendPolling();
+    virtual void resumePolling();
+
+private slots:
+    void pollDevices();
+
+private:
+    ShmDevice *m_device;
+    QTimer m_pollTimer;
+    QList <Core::IConnection::device> m_devices;
+};
+
+class ShmConnectionPlugin : public ExtensionSystem::IPlugin {
+    Q_OBJECT
+    Q_PLUGIN_METADATA(IID "OpenPilot.ShmConnection")
+
+public:
+    ShmConnectionPlugin();
+    ~ShmConnectionPlugin();
+
+    virtual bool initialize(const QStringList &arguments, QString *error_message);
+    virtual void extensionsInitialized();
+
+private:
+    ShmConnection *m_connection;
+};
+
+#endif // SHMCONNECTIONPLUGIN_H
@@ -0,0 +1,148 @@
+/**
+ ******************************************************************************
+ *
+ * @file       shmdevice.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ShmConnPlugin Shared Memory Telemetry Plugin
+ * @{
+ * @brief Telemetry with a SITL board on the same host over shared memory
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "shmdevice.h"
+
+#include <pios_shm_ring.h>
+
+#include <QTimerEvent>
+#include <QDebug>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Period the rings are polled at, the firmware side polls at its tick rate
+#define SHM_POLL_PERIOD_MS 1
+
+ShmDevice::ShmDevice(const QString &name) : QIODevice(), m_name(name), m_region(NULL), m_pollTimer(0)
+{}
+
+ShmDevice::~ShmDevice()
+{
+    close();
+}
+
+bool ShmDevice::exists(const QString &name)
+{
+    int fd = shm_open(name.toLatin1().constData(), O_RDONLY, 0);
+
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    bool sized = fstat(fd, &st) == 0 && st.st_size >= (off_t)sizeof(struct pios_shm_region);
+    ::close(fd);
+    return sized;
+}
+
+bool ShmDevice::open(OpenMode mode)
+{
+    int fd = shm_open(m_name.toLatin1().constData(), O_RDWR, 0);
+
+    if (fd < 0) {
+        setErrorString(QString("Cannot open %1, is simposix running with -s?").arg(m_name));
+        return false;
+    }
+    void *region = mmap(NULL, sizeof(struct pios_shm_region), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (region == MAP_FAILED) {
+        setErrorString(QString("Cannot map %1").arg(m_name));
+        return false;
+    }
+    m_region = (struct pios_shm_region *)region;
+    if (m_region->magic == PIOS_SHM_MAGIC && m_region->version != PIOS_SHM_VERSION) {
+        setErrorString(QString("%1 has version %2, version %3 is expected").arg(m_name).arg(m_region->version).arg(PIOS_SHM_VERSION));
+        munmap(m_region, sizeof(struct pios_shm_region));
+        m_region = NULL;
+        return false;
+    }
+
+    // Drop what the firmware sent while nobody was listening
+    m_region->to_gcs.tail = m_region->to_gcs.head;
+
+    // The timer follows the device when it is moved to the telemetry thread
+    m_pollTimer = startTimer(SHM_POLL_PERIOD_MS, Qt::PreciseTimer);
+    return QIODevice::open(mode | QIODevice::Unbuffered);
+}
+
+void ShmDevice::close()
+{
+    if (m_pollTimer) {
+        killTimer(m_pollTimer);
+        m_pollTimer = 0;
+    }
+    if (m_region) {
+        munmap(m_region, sizeof(struct pios_shm_region));
+        m_region = NULL;
+    }
+    QIODevice::close();
+}
+
+bool ShmDevice::valid() const
+{
+    // The magic is cleared while the firmware (re)initializes the region
+    return m_region && m_region->magic == PIOS_SHM_MAGIC;
+}
+
+qint64 ShmDevice::bytesAvailable() const
+{
+    return (valid() ? pios_shm_ring_used(&m_region->to_gcs) : 0) + QIODevice::bytesAvailable();
+}
+
+qint64 ShmDevice::readData(char *data, qint64 maxSize)
+{
+    if (!valid()) {
+        return 0;
+    }
+    return pios_shm_ring_read(&m_region->to_gcs, (uint8_t *)data, (uint32_t)qMin(maxSize, (qint64)PIOS_SHM_RING_SIZE));
+}
+
+qint64 ShmDevice::writeData(const char *data, qint64 maxSize)
+{
+    if (!valid()) {
+        // Nobody on the other side, the data is lost as it would be on a link
+        return maxSize;
+    }
+    qint64 written = pios_shm_ring_write(&m_region->to_fc, (const uint8_t *)data, (uint32_t)qMin(maxSize, (qint64)PIOS_SHM_RING_SIZE));
+    if (written > 0) {
+        emit bytesWritten(written);
+    }
+    return written;
+}
+
+void ShmDevice::timerEvent(QTimerEvent *event)
+{
+    if (event->timerId() != m_pollTimer) {
+        QIODevice::timerEvent(event);
+        return;
+    }
+    if (valid() && pios_shm_ring_used(&m_region->to_gcs) > 0) {
+        emit readyRead();
+    }
+}
@@ -0,0 +1,72 @@
+/**
+ ******************************************************************************
+ *
+ * @file       shmdevice.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ShmConnPlugin Shared Memory Telemetry Plugin
+ * @{
+ * @brief Telemetry with a SITL board on the same host over shared memory
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef SHMDEVICE_H
+#define SHMDEVICE_H
+
+#include <QIODevice>
+#include <QString>
+
+struct pios_shm_region;
+
+/**
+ * Stream over the shared memory rings of a simposix instance started with -s.
+ * Reads and writes are plain copies in and out of the rings, the rings are
+ * polled for new data every millisecond.
+ */
+class ShmDevice : public QIODevice {
+    Q_OBJECT
+
+public:
+    explicit ShmDevice(const QString &name);
+    ~ShmDevice();
+
+    // Whether the shared memory object of a running instance exists
+    static bool exists(const QString &name);
+
+    bool open(OpenMode mode);
+    void close();
+    bool isSequential() const
+    {
+        return true;
+    }
+    qint64 bytesAvailable() const;
+
+protected:
+    qint64 readData(char *data, qint64 maxSize);
+    qint64 writeData(const char *data, qint64 maxSize);
+    void timerEvent(QTimerEvent *event);
+
+private:
+    bool valid() const;
+
+    QString m_name;
+    struct pios_shm_region *m_region;
+    int m_pollTimer;
+};
+
+#endif // SHMDEVICE_H
@@ -49,5 +49,6 @@ void SystemHealthGadget::loadConfiguration(IUAVGadgetConfiguration *config)
 {
     SystemHealthGadgetConfiguration *m = qobject_cast<SystemHealthGadgetConfiguration *>(config);
 
+    m_widget->setVehicle(m->getVehicle());
     m_widget->setSystemFile(m->getSystemFile()); // Triggers widget repaint
 }
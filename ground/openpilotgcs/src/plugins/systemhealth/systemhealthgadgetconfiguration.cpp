@@ -40,6 +40,7 @@ SystemHealthGadgetConfiguration::SystemHealthGadgetConfiguration(QString classId
     if (qSettings != 0) {
         QString diagram = qSettings->value("diagram").toString();
         systemFile = Utils::PathUtils().InsertDataPath(diagram);
+        vehicle    = qSettings->value("vehicle").toString();
     }
 }
 
@@ -52,6 +53,7 @@ IUAVGadgetConfiguration *SystemHealthGadgetConfiguration::clone()
     SystemHealthGadgetConfiguration *m = new SystemHealthGadgetConfiguration(this->classId());
 
     m->systemFile = systemFile;
+    m->vehicle    = vehicle;
     return m;
 }
 
@@ -64,4 +66,5 @@ void SystemHealthGadgetConfiguration::saveConfig(QSettings *qSettings) const
     QString diagram = Utils::PathUtils().RemoveDataPath(systemFile);
 
     qSettings->setValue("diagram", diagram);
+    qSettings->setValue("vehicle", vehicle);
 }
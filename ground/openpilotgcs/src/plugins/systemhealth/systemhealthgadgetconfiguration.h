@@ -45,12 +45,20 @@ public:
     {
         systemFile = filename;
     }
+    void setVehicle(QString name)
+    {
+        vehicle = name;
+    }
 
     // get dial configuration functions
     QString getSystemFile()
     {
         return systemFile;
     }
+    QString getVehicle()
+    {
+        return vehicle;
+    }
 
     void saveConfig(QSettings *settings) const;
     IUAVGadgetConfiguration *clone();
@@ -58,6 +66,8 @@ public:
 private:
     // systemFile contains the source SVG:
     QString systemFile;
+    // vehicle the gadget is bound to, empty for the primary vehicle
+    QString vehicle;
 };
 
 #endif // SYSTEMHEALTHGADGETCONFIGURATION_H
@@ -28,6 +28,8 @@
 #include "systemhealthgadgetoptionspage.h"
 #include "systemhealthgadgetconfiguration.h"
 #include "ui_systemhealthgadgetoptionspage.h"
+#include "extensionsystem/pluginmanager.h"
+#include "uavtalk/vehiclemanager.h"
 
 #include <QFileDialog>
 #include <QtAlgorithms>
@@ -54,6 +56,14 @@ QWidget *SystemHealthGadgetOptionsPage::createPage(QWidget *parent)
     options_page->svgFilePathChooser->setPromptDialogTitle(tr("Choose SVG image"));
     options_page->svgFilePathChooser->setPath(m_config->getSystemFile());
 
+    // The empty entry is the primary vehicle
+    VehicleManager *vehicleMngr = ExtensionSystem::PluginManager::instance()->getObject<VehicleManager>();
+    options_page->vehicleComboBox->addItem(QString());
+    if (vehicleMngr) {
+        options_page->vehicleComboBox->addItems(vehicleMngr->vehicleNames());
+    }
+    options_page->vehicleComboBox->setEditText(m_config->getVehicle());
+
     return optionsPageWidget;
 }
 /**
@@ -65,6 +75,7 @@ QWidget *SystemHealthGadgetOptionsPage::createPage(QWidget *parent)
 void SystemHealthGadgetOptionsPage::apply()
 {
     m_config->setSystemFile(options_page->svgFilePathChooser->path());
+    m_config->setVehicle(options_page->vehicleComboBox->currentText().trimmed());
 }
 
 
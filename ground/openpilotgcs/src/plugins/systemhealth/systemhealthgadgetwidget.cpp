@@ -26,12 +26,18 @@
  */
 
 #include "systemalarms.h"
+#include "callbacklatency.h"
+#include "callbackinfo.h"
+#include "taskinfo.h"
+#include "systemhealthsummary.h"
+#include "timesync.h"
 #include "systemhealthgadgetwidget.h"
 
 #include "utils/stylehelper.h"
 #include "extensionsystem/pluginmanager.h"
 #include "uavobjectmanager.h"
 #include <uavtalk/telemetrymanager.h>
+#include <uavtalk/vehiclemanager.h>
 
 #include <QDebug>
 #include <QWhatsThis>
@@ -39,7 +45,8 @@
 /*
  * Initialize the widget
  */
-SystemHealthGadgetWidget::SystemHealthGadgetWidget(QWidget *parent) : QGraphicsView(parent)
+SystemHealthGadgetWidget::SystemHealthGadgetWidget(QWidget *parent) : QGraphicsView(parent),
+    m_objManager(0), m_telMngr(0)
 {
     setMinimumSize(128, 128);
     setSizePolicy(QSizePolicy::MinimumExpanding, QSizePolicy::MinimumExpanding);
@@ -51,21 +58,87 @@ SystemHealthGadgetWidget::SystemHealthGadgetWidget(QWidget *parent) : QGraphicsV
     foreground = new QGraphicsSvgItem();
     nolink     = new QGraphicsSvgItem();
     missingElements = new QStringList();
+    summaryReceived = false;
     paint();
 
-    // Now connect the widget to the SystemAlarms UAVObject
+    // Now connect the widget to the primary vehicle, until the configuration says otherwise
     ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
-    UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
+    bindVehicle(pm->getObject<UAVObjectManager>(), pm->getObject<TelemetryManager>());
 
-    SystemAlarms *obj = dynamic_cast<SystemAlarms *>(objManager->getObject(QString("SystemAlarms")));
-    connect(obj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(updateAlarms(UAVObject *)));
+    VehicleManager *vehicleMngr = pm->getObject<VehicleManager>();
+    if (vehicleMngr) {
+        connect(vehicleMngr, SIGNAL(vehicleAdded(Vehicle *)), this, SLOT(onVehicleAdded(Vehicle *)));
+        connect(vehicleMngr, SIGNAL(vehicleAboutToBeRemoved(Vehicle *)), this, SLOT(onVehicleAboutToBeRemoved(Vehicle *)));
+    }
+
+    setToolTip(tr("Displays flight system errors. Click on an alarm for more information."));
+}
+
+/**
+ * Show the vehicle with the given name, the primary vehicle when the name is empty
+ * or not (yet) configured
+ */
+void SystemHealthGadgetWidget::setVehicle(QString name)
+{
+    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
+    VehicleManager *vehicleMngr = pm->getObject<VehicleManager>();
+
+    m_vehicle = name;
+    if (vehicleMngr) {
+        bindVehicle(vehicleMngr->objectManager(name), vehicleMngr->telemetryManager(name));
+    }
+}
+
+/**
+ * Connect the widget to the objects and telemetry of a vehicle
+ */
+void SystemHealthGadgetWidget::bindVehicle(UAVObjectManager *objManager, TelemetryManager *telMngr)
+{
+    if (objManager == m_objManager && telMngr == m_telMngr) {
+        return;
+    }
+    if (m_objManager) {
+        SystemAlarms::GetInstance(m_objManager)->disconnect(this);
+        SystemHealthSummary::GetInstance(m_objManager)->disconnect(this);
+        m_telMngr->disconnect(this);
+    }
+    m_objManager = objManager;
+    m_telMngr    = telMngr;
+
+    SystemAlarms *obj = SystemAlarms::GetInstance(m_objManager);
+    connect(obj, SIGNAL(objectUpdatedCoalesced(UAVObject *)), this, SLOT(updateAlarms(UAVObject *)));
+    // Boards that send the health summary also show their alarms through it
+    SystemHealthSummary *summary = SystemHealthSummary::GetInstance(m_objManager);
+    connect(summary, SIGNAL(objectUpdatedCoalesced(UAVObject *)), this, SLOT(updateSummary(UAVObject *)));
 
     // Listen to autopilot connection events
-    TelemetryManager *telMngr = pm->getObject<TelemetryManager>();
-    connect(telMngr, SIGNAL(connected()), this, SLOT(onAutopilotConnect()));
-    connect(telMngr, SIGNAL(disconnected()), this, SLOT(onAutopilotDisconnect()));
+    connect(m_telMngr, SIGNAL(connected()), this, SLOT(onAutopilotConnect()));
+    connect(m_telMngr, SIGNAL(disconnected()), this, SLOT(onAutopilotDisconnect()));
+
+    if (m_telMngr->isConnected()) {
+        onAutopilotConnect();
+        updateAlarms(obj);
+    } else {
+        onAutopilotDisconnect();
+    }
+}
 
-    setToolTip(tr("Displays flight system errors. Click on an alarm for more information."));
+void SystemHealthGadgetWidget::onVehicleAdded(Vehicle *vehicle)
+{
+    if (!m_vehicle.isEmpty() && vehicle->name() == m_vehicle) {
+        bindVehicle(vehicle->objectManager(), vehicle->telemetryManager());
+    }
+}
+
+/**
+ * Fall back to the primary vehicle before the objects go away
+ */
+void SystemHealthGadgetWidget::onVehicleAboutToBeRemoved(Vehicle *vehicle)
+{
+    if (vehicle->objectManager() == m_objManager) {
+        ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
+        bindVehicle(pm->getObject<UAVObjectManager>(), pm->getObject<TelemetryManager>());
+    }
 }
 
 /**
@@ -82,9 +155,63 @@ void SystemHealthGadgetWidget::onAutopilotConnect()
 void SystemHealthGadgetWidget::onAutopilotDisconnect()
 {
     nolink->setVisible(true);
+    summaryReceived = false;
 }
 
 void SystemHealthGadgetWidget::updateAlarms(UAVObject *systemAlarm)
+{
+    QStringList elements;
+    QStringList values;
+
+    foreach(UAVObjectField * field, systemAlarm->getFields()) {
+        for (uint i = 0; i < field->getNumElements(); ++i) {
+            elements.append(field->getElementNames()[i]);
+            values.append(field->getValue(i).toString());
+        }
+    }
+    showAlarms(elements, values);
+}
+
+/**
+ * Show the alarms from the bitmasks of the health summary, one bit per
+ * element of the SystemAlarms Alarm field. The extended alarm status is
+ * not part of the summary and comes from the last SystemAlarms received.
+ */
+void SystemHealthGadgetWidget::updateSummary(UAVObject *summary)
+{
+    SystemHealthSummary *obj = dynamic_cast<SystemHealthSummary *>(summary);
+    SystemHealthSummary::DataFields data = obj->getData();
+
+    QStringList elements;
+    QStringList values;
+
+    foreach(UAVObjectField * field, SystemAlarms::GetInstance(m_objManager)->getFields()) {
+        bool isAlarm = (field->getName() == "Alarm");
+        for (uint i = 0; i < field->getNumElements(); ++i) {
+            elements.append(field->getElementNames()[i]);
+            if (!isAlarm) {
+                values.append(field->getValue(i).toString());
+                continue;
+            }
+            quint32 bit = 1 << i;
+            if (data.AlarmError & bit) {
+                values.append("Error");
+            } else if (data.AlarmCritical & bit) {
+                values.append("Critical");
+            } else if (data.AlarmWarning & bit) {
+                values.append("Warning");
+            } else if (data.AlarmOK & bit) {
+                values.append("OK");
+            } else {
+                values.append("Uninitialised");
+            }
+        }
+    }
+    summaryReceived = true;
+    showAlarms(elements, values);
+}
+
+void SystemHealthGadgetWidget::showAlarms(const QStringList &elements, const QStringList &values)
 {
     // This code does not know anything about alarms beforehand, and
     // I found no efficient way to locate items inside the scene by
@@ -99,40 +226,37 @@ void SystemHealthGadgetWidget::updateAlarms(UAVObject *systemAlarm)
 
     QMatrix backgroundMatrix = (m_renderer->matrixForElement(background->elementId())).inverted();
 
-    QString alarm = systemAlarm->getName();
-    foreach(UAVObjectField * field, systemAlarm->getFields()) {
-        for (uint i = 0; i < field->getNumElements(); ++i) {
-            QString element = field->getElementNames()[i];
-            QString value   = field->getValue(i).toString();
-            if (!missingElements->contains(element)) {
-                if (m_renderer->elementExists(element)) {
-                    QString element2 = element + "-" + value;
-                    if (!missingElements->contains(element2)) {
-                        if (m_renderer->elementExists(element2)) {
-                            // element2 is in global coordinates
-                            // transform its matrix into the coordinates of background
-                            QMatrix blockMatrix   = backgroundMatrix * m_renderer->matrixForElement(element2);
-                            // use this composed projection to get the position in background coordinates
-                            QRectF rectProjected  = blockMatrix.mapRect(m_renderer->boundsOnElement(element2));
-
-                            QGraphicsSvgItem *ind = new QGraphicsSvgItem();
-                            ind->setSharedRenderer(m_renderer);
-                            ind->setElementId(element2);
-                            ind->setParentItem(background);
-                            QTransform matrix;
-                            matrix.translate(rectProjected.x(), rectProjected.y());
-                            ind->setTransform(matrix, false);
-                        } else {
-                            if (value.compare("Uninitialised") != 0) {
-                                missingElements->append(element2);
-                                qDebug() << "Warning: element " << element2 << " not found in SVG.";
-                            }
+    for (int i = 0; i < elements.size(); ++i) {
+        QString element = elements[i];
+        QString value   = values[i];
+        if (!missingElements->contains(element)) {
+            if (m_renderer->elementExists(element)) {
+                QString element2 = element + "-" + value;
+                if (!missingElements->contains(element2)) {
+                    if (m_renderer->elementExists(element2)) {
+                        // element2 is in global coordinates
+                        // transform its matrix into the coordinates of background
+                        QMatrix blockMatrix   = backgroundMatrix * m_renderer->matrixForElement(element2);
+                        // use this composed projection to get the position in background coordinates
+                        QRectF rectProjected  = blockMatrix.mapRect(m_renderer->boundsOnElement(element2));
+
+                        QGraphicsSvgItem *ind = new QGraphicsSvgItem();
+                        ind->setSharedRenderer(m_renderer);
+                        ind->setElementId(element2);
+                        ind->setParentItem(background);
+                        QTransform matrix;
+                        matrix.translate(rectProjected.x(), rectProjected.y());
+                        ind->setTransform(matrix, false);
+                    } else {
+                        if (value.compare("Uninitialised") != 0) {
+                            missingElements->append(element2);
+                            qDebug() << "Warning: element " << element2 << " not found in SVG.";
                         }
                     }
-                } else {
-                    missingElements->append(element);
-                    qDebug() << "Warning: Element " << element << " not found in SVG.";
                 }
+            } else {
+                missingElements->append(element);
+                qDebug() << "Warning: Element " << element << " not found in SVG.";
             }
         }
     }
@@ -173,13 +297,9 @@ void SystemHealthGadgetWidget::setSystemFile(QString dfn)
             fitInView(background, Qt::KeepAspectRatio);
 
             // Check whether the autopilot is connected already, by the way:
-            ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
-            UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
-            TelemetryManager *telMngr    = pm->getObject<TelemetryManager>();
-            if (telMngr->isConnected()) {
+            if (m_telMngr->isConnected()) {
                 onAutopilotConnect();
-                SystemAlarms *obj = dynamic_cast<SystemAlarms *>(objManager->getObject(QString("SystemAlarms")));
-                updateAlarms(obj);
+                updateAlarms(SystemAlarms::GetInstance(m_objManager));
             }
         }
     } else { qDebug() << "SystemHealthGadget: no file"; }
@@ -286,9 +406,134 @@ void SystemHealthGadgetWidget::showAllAlarmDescriptions(const QPoint & location)
             }
         }
 
+        // Append the health summary and the callback scheduler timing, if the board reports them
+        alarmsText.append(healthSummaryDescription());
+        alarmsText.append(callbackLatencyDescription());
+        alarmsText.append(linkLatencyDescription());
+
         // Show alarms text if we have any
         if (alarmsText.length() > 0) {
             QWhatsThis::showText(location, alarmsText);
         }
     }
 }
+
+/**
+ * Format the health summary as html table
+ * \return The table, or an empty string if the board does not send the summary
+ */
+QString SystemHealthGadgetWidget::healthSummaryDescription()
+{
+    UAVObjectManager *objManager = m_objManager;
+    SystemHealthSummary *obj     = SystemHealthSummary::GetInstance(objManager);
+
+    if (!obj || !summaryReceived || !m_telMngr->isConnected()) {
+        return QString();
+    }
+
+    SystemHealthSummary::DataFields data = obj->getData();
+    QStringList tasks     = TaskInfo::GetInstance(objManager)->getField("StackRemaining")->getElementNames();
+    QStringList callbacks = CallbackInfo::GetInstance(objManager)->getField("StackRemaining")->getElementNames();
+
+    QString rows;
+    rows.append("<tr><td>" + tr("CPU load") + "</td><td align=\"right\">" + QString::number(data.CPULoad) + " %</td></tr>");
+    if (data.TopCPUTask < tasks.size()) {
+        rows.append("<tr><td>" + tr("Busiest task (%1)").arg(tasks[data.TopCPUTask]) +
+                    "</td><td align=\"right\">" + QString::number(data.TopCPUTaskLoad, 'f', 1) + " %</td></tr>");
+    }
+    if (data.TopCPUCallback < callbacks.size()) {
+        rows.append("<tr><td>" + tr("Busiest callback (%1)").arg(callbacks[data.TopCPUCallback]) +
+                    "</td><td align=\"right\">" + QString::number(data.TopCPUCallbackLoad, 'f', 1) + " %</td></tr>");
+    }
+    rows.append("<tr><td>" + tr("Heap remaining") + "</td><td align=\"right\">" + QString::number(data.HeapRemaining) + " bytes</td></tr>");
+    rows.append("<tr><td>" + tr("IRQ stack remaining") + "</td><td align=\"right\">" + QString::number(data.IRQStackRemaining) + " bytes</td></tr>");
+    if (data.TaskStackTask < tasks.size()) {
+        rows.append("<tr><td>" + tr("Lowest task stack (%1)").arg(tasks[data.TaskStackTask]) +
+                    "</td><td align=\"right\">" + QString::number(data.TaskStackRemaining) + " bytes</td></tr>");
+    }
+    if (data.CallbackStackCallback < callbacks.size()) {
+        rows.append("<tr><td>" + tr("Lowest callback stack (%1)").arg(callbacks[data.CallbackStackCallback]) +
+                    "</td><td align=\"right\">" + QString::number(data.CallbackStackRemaining) + " bytes</td></tr>");
+    }
+    if (data.LatencyCallback < callbacks.size()) {
+        rows.append("<tr><td>" + tr("Worst callback latency p99 (%1)").arg(callbacks[data.LatencyCallback]) +
+                    "</td><td align=\"right\">" + QString::number(data.LatencyP99) + " us</td></tr>");
+        rows.append("<tr><td>" + tr("Worst callback latency max") +
+                    "</td><td align=\"right\">" + QString::number(data.LatencyMax) + " us</td></tr>");
+    }
+    rows.append("<tr><td>" + tr("Event errors") + "</td><td align=\"right\">" + QString::number(data.EventErrors) + "</td></tr>");
+
+    return tr("<h3>System health</h3>") + "<table>" + rows + "</table>";
+}
+
+/**
+ * Format the link latency measured by the time sync as html table
+ * \return The table, or an empty string if the board does not answer the time sync
+ */
+QString SystemHealthGadgetWidget::linkLatencyDescription()
+{
+    TimeSync *obj = TimeSync::GetInstance(m_objManager);
+
+    if (!obj || !m_telMngr->isConnected()) {
+        return QString();
+    }
+
+    TimeSync::DataFields data = obj->getData();
+    if (data.BoardTime == 0) {
+        return QString();
+    }
+
+    QString rows;
+    rows.append("<tr><td>" + tr("Round trip") + "</td><td align=\"right\">" + QString::number(data.RoundTrip, 'f', 1) + " ms</td></tr>");
+    rows.append("<tr><td>" + tr("Jitter") + "</td><td align=\"right\">" + QString::number(data.Jitter, 'f', 1) + " ms</td></tr>");
+    if (data.ObjectLatency > 0) {
+        rows.append("<tr><td>" + tr("Timestamped updates latency") + "</td><td align=\"right\">" + QString::number(data.ObjectLatency, 'f', 1) + " ms</td></tr>");
+    }
+
+    return tr("<h3>Link</h3>") + "<table>" + rows + "</table>";
+}
+
+/**
+ * Format the callback scheduler latency and execution times as html table
+ * \return The table, or an empty string if no timing is reported
+ */
+QString SystemHealthGadgetWidget::callbackLatencyDescription()
+{
+    UAVObjectManager *objManager = m_objManager;
+    CallbackLatency *obj = CallbackLatency::GetInstance(objManager);
+
+    if (!obj || !m_telMngr->isConnected()) {
+        return QString();
+    }
+
+    const char *columns[] = { "LatencyAvg", "LatencyP99", "LatencyMax", "ExecutionAvg", "ExecutionP99", "ExecutionMax" };
+    const int numColumns  = sizeof(columns) / sizeof(columns[0]);
+    UAVObjectField *fields[numColumns];
+    for (int c = 0; c < numColumns; ++c) {
+        fields[c] = obj->getField(columns[c]);
+        Q_ASSERT(fields[c]);
+    }
+
+    QString rows;
+    QStringList names = fields[0]->getElementNames();
+    for (int i = 0; i < names.size(); ++i) {
+        // callbacks which never ran report no timing at all
+        if (fields[2]->getUInt16(i) == 0 && fields[5]->getUInt16(i) == 0) {
+            continue;
+        }
+        rows.append("<tr><td>" + names[i] + "</td>");
+        for (int c = 0; c < numColumns; ++c) {
+            rows.append("<td align=\"right\">" + QString::number(fields[c]->getUInt16(i)) + "</td>");
+        }
+        rows.append("</tr>");
+    }
+    if (rows.isEmpty()) {
+        return QString();
+    }
+
+    return tr("<h3>Callback timing (us)</h3>") +
+           "<table><tr><th></th><th colspan=\"3\">" + tr("Latency") + "</th><th colspan=\"3\">" + tr("Execution") + "</th></tr>" +
+           "<tr><th></th><th>" + tr("avg") + "</th><th>" + tr("p99") + "</th><th>" + tr("max") + "</th>" +
+           "<th>" + tr("avg") + "</th><th>" + tr("p99") + "</th><th>" + tr("max") + "</th></tr>" +
+           rows + "</table>";
+}
@@ -39,6 +39,10 @@
 #include <QFile>
 #include <QTimer>
 
+class UAVObjectManager;
+class TelemetryManager;
+class Vehicle;
+
 class SystemHealthGadgetWidget : public QGraphicsView {
     Q_OBJECT
 
@@ -46,6 +50,7 @@ public:
     SystemHealthGadgetWidget(QWidget *parent = 0);
     ~SystemHealthGadgetWidget();
     void setSystemFile(QString dfn);
+    void setVehicle(QString name);
     void setIndicator(QString indicator);
     void paint();
 
@@ -56,10 +61,18 @@ protected:
 
 private slots:
     void updateAlarms(UAVObject *systemAlarm); // Called by the systemalarms UAVObject
+    void updateSummary(UAVObject *summary); // Called by the systemhealthsummary UAVObject
     void onAutopilotConnect();
     void onAutopilotDisconnect();
+    void onVehicleAdded(Vehicle *vehicle);
+    void onVehicleAboutToBeRemoved(Vehicle *vehicle);
 
 private:
+    // Vehicle the gadget is bound to, empty for the primary vehicle
+    QString m_vehicle;
+    UAVObjectManager *m_objManager;
+    TelemetryManager *m_telMngr;
+
     QSvgRenderer *m_renderer;
     QGraphicsSvgItem *background;
     QGraphicsSvgItem *foreground;
@@ -67,8 +80,15 @@ private:
     QStringList *missingElements;
     // Simple flag to skip rendering if the
     bool fgenabled; // layer does not exist.
+    // Set once the board sent a SystemHealthSummary
+    bool summaryReceived;
 
+    void bindVehicle(UAVObjectManager *objManager, TelemetryManager *telMngr);
     void showAlarmDescriptionForItemId(const QString itemId, const QPoint & location);
     void showAllAlarmDescriptions(const QPoint &location);
+    void showAlarms(const QStringList &elements, const QStringList &values);
+    QString healthSummaryDescription();
+    QString callbackLatencyDescription();
+    QString linkLatencyDescription();
 };
 #endif /* SYSTEMHEALTHGADGETWIDGET_H_ */
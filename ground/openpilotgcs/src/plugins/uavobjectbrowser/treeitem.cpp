@@ -28,8 +28,10 @@
 #include "treeitem.h"
 
 /* Constructor */
-HighLightManager::HighLightManager(long checkingInterval)
+HighLightManager::HighLightManager(long checkingInterval) :
+    m_checkingInterval(checkingInterval)
 {
+    m_clock.start();
     // Start the timer and connect it to the callback
     m_expirationTimer.start(checkingInterval);
     connect(&m_expirationTimer, SIGNAL(timeout()), this, SLOT(checkItemsExpired()));
@@ -46,7 +48,9 @@ bool HighLightManager::add(TreeItem *itemToAdd)
 
     // Check so that the item isn't already in the list
     if (!m_items.contains(itemToAdd)) {
-        m_items.insert(itemToAdd);
+        qint64 tick = tickOf(itemToAdd->getHiglightExpires());
+        m_buckets[tick].insert(itemToAdd);
+        m_items.insert(itemToAdd, tick);
         return true;
     }
     return false;
@@ -62,7 +66,17 @@ bool HighLightManager::remove(TreeItem *itemToRemove)
     QMutexLocker locker(&m_mutex);
 
     // Remove item and return result
-    return m_items.remove(itemToRemove);
+    QHash<TreeItem *, qint64>::iterator item = m_items.find(itemToRemove);
+    if (item == m_items.end()) {
+        return false;
+    }
+    QMap<qint64, QSet<TreeItem *> >::iterator bucket = m_buckets.find(item.value());
+    bucket->remove(itemToRemove);
+    if (bucket->isEmpty()) {
+        m_buckets.erase(bucket);
+    }
+    m_items.erase(item);
+    return true;
 }
 
 /*
@@ -76,21 +90,28 @@ void HighLightManager::checkItemsExpired()
     // Lock to ensure thread safety
     QMutexLocker locker(&m_mutex);
 
-    // Get a mutable iterator for the list
-    QMutableSetIterator<TreeItem *> iter(m_items);
-
     // This is the timestamp to compare with
-    QTime now = QTime::currentTime();
-
-    // Loop over all items, check if they expired.
-    while (iter.hasNext()) {
-        TreeItem *item = iter.next();
-        if (item->getHiglightExpires() < now) {
-            // If expired, call removeHighlight
-            item->removeHighlight();
-
-            // Remove from list since it is restored.
-            iter.remove();
+    qint64 now = m_clock.elapsed();
+    qint64 nowTick = tickOf(now);
+
+    // Loop over the due buckets, check if their items expired.
+    while (!m_buckets.isEmpty() && m_buckets.begin().key() <= nowTick) {
+        QSet<TreeItem *> due = m_buckets.take(m_buckets.begin().key());
+        foreach(TreeItem * item, due) {
+            qint64 expires = item->getHiglightExpires();
+
+            if (expires < now) {
+                // If expired, call removeHighlight
+                item->removeHighlight();
+
+                // Remove from list since it is restored.
+                m_items.remove(item);
+            } else {
+                // Updated meanwhile, wait for its new expiration time.
+                qint64 tick = qMax(tickOf(expires), nowTick + 1);
+                m_buckets[tick].insert(item);
+                m_items.insert(item, tick);
+            }
         }
     }
 }
@@ -102,14 +123,16 @@ TreeItem::TreeItem(const QList<QVariant> &data, TreeItem *parent) :
     m_data(data),
     m_parent(parent),
     m_highlight(false),
-    m_changed(false)
+    m_changed(false),
+    m_highlightExpires(0)
 {}
 
 TreeItem::TreeItem(const QVariant &data, TreeItem *parent) :
     QObject(0),
     m_parent(parent),
     m_highlight(false),
-    m_changed(false)
+    m_changed(false),
+    m_highlightExpires(0)
 {
     m_data << data << "" << "";
 }
@@ -188,7 +211,7 @@ void TreeItem::setHighlight(bool highlight)
     m_changed   = false;
     if (highlight) {
         // Update the expires timestamp
-        m_highlightExpires = QTime::currentTime().addMSecs(m_highlightTimeMs);
+        m_highlightExpires = m_highlightManager->now() + m_highlightTimeMs;
 
         // Add to highlightmanager
         if (m_highlightManager->add(this)) {
@@ -219,11 +242,16 @@ void TreeItem::setHighlightManager(HighLightManager *mgr)
     m_highlightManager = mgr;
 }
 
-QTime TreeItem::getHiglightExpires()
+qint64 TreeItem::getHiglightExpires()
 {
     return m_highlightExpires;
 }
 
+QList<DataObjectTreeItem *> TopTreeItem::getObjectItems()
+{
+    return m_objectTreeItemsPerObjectIds.values();
+}
+
 QList<MetaObjectTreeItem *> TopTreeItem::getMetaObjectItems()
 {
     return m_metaObjectTreeItemsPerObjectIds.values();
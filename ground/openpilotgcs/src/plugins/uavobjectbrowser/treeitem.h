@@ -35,7 +35,7 @@
 #include <QtCore/QLinkedList>
 #include <QtCore/QMap>
 #include <QtCore/QVariant>
-#include <QtCore/QTime>
+#include <QtCore/QElapsedTimer>
 #include <QtCore/QTimer>
 #include <QtCore/QObject>
 #include <QtCore/QDebug>
@@ -45,17 +45,17 @@ class TreeItem;
 /*
  * Small utility class that handles the higlighting of
  * tree grid items.
- * Basicly it maintains all items due to be restored to
- * non highlighted state in a linked list.
- * A timer traverses this list periodically to find out
- * if any of the items should be restored. All items are
- * updated withan expiration timestamp when they expires.
- * An item that is beeing restored is removed from the
- * list and its removeHighlight() method is called. Items
- * that are not expired are left in the list til next time.
+ * Items due to be restored to non highlighted state are
+ * kept in buckets, one per checking interval, keyed by
+ * the tick their highlight expires in.
+ * A timer only looks at the buckets that are due. An
+ * item in them that was updated meanwhile, and so expires
+ * later, is moved to the bucket of its new expiration
+ * time. The others are removed and their removeHighlight()
+ * method is called.
  * Items that are updated during the expiration time are
- * left untouched in the list. This reduces unwanted emits
- * of signals to the repaint/update function.
+ * left untouched in their bucket, so a check costs the
+ * number of items expiring, not of items highlighted.
  */
 class HighLightManager : public QObject {
     Q_OBJECT
@@ -70,16 +70,30 @@ public:
     // This is called when an item is set to highlighted = false;
     bool remove(TreeItem *itemToRemove);
 
+    // Milliseconds of the clock expiration times are measured with.
+    qint64 now() const
+    {
+        return m_clock.elapsed();
+    }
+
 private slots:
     // Timer callback method.
     void checkItemsExpired();
 
 private:
+    qint64 tickOf(qint64 time) const
+    {
+        return time / m_checkingInterval + 1;
+    }
+
     // The timer checking highlight expiration.
     QTimer m_expirationTimer;
+    QElapsedTimer m_clock;
+    long m_checkingInterval;
 
-    // The collection holding all items due to be updated.
-    QSet<TreeItem *> m_items;
+    // The items due to be updated, by the tick they are in.
+    QMap<qint64, QSet<TreeItem *> > m_buckets;
+    QHash<TreeItem *, qint64> m_items;
 
     // Mutex to lock when accessing collection.
     QMutex m_mutex;
@@ -158,7 +172,7 @@ public:
 
     virtual void setHighlightManager(HighLightManager *mgr);
 
-    QTime getHiglightExpires();
+    qint64 getHiglightExpires();
 
     virtual void removeHighlight();
 
@@ -239,7 +253,7 @@ private:
     TreeItem *m_parent;
     bool m_highlight;
     bool m_changed;
-    QTime m_highlightExpires;
+    qint64 m_highlightExpires;
     HighLightManager *m_highlightManager;
 };
 
@@ -272,6 +286,7 @@ public:
         return m_metaObjectTreeItemsPerObjectIds.contains(objectId) ? m_metaObjectTreeItemsPerObjectIds[objectId] : 0;
     }
 
+    QList<DataObjectTreeItem *> getObjectItems();
     QList<MetaObjectTreeItem *> getMetaObjectItems();
 
 private:
@@ -279,18 +294,25 @@ private:
     QHash<quint32, MetaObjectTreeItem *> m_metaObjectTreeItemsPerObjectIds;
 };
 
+/*
+ * The field items of an object are only created when it is first
+ * expanded. Until then an update packs the object and compares it
+ * to the last packed data, to highlight the object when it changed.
+ */
 class ObjectTreeItem : public TreeItem {
     Q_OBJECT
 public:
     ObjectTreeItem(const QList<QVariant> &data, UAVObject *object, TreeItem *parent = 0) :
-        TreeItem(data, parent), m_obj(object)
+        TreeItem(data, parent), m_obj(object), m_fieldsCreated(false)
     {
         setDescription(m_obj->getDescription());
+        packObject(m_lastData);
     }
     ObjectTreeItem(const QVariant &data, UAVObject *object, TreeItem *parent = 0) :
-        TreeItem(data, parent), m_obj(object)
+        TreeItem(data, parent), m_obj(object), m_fieldsCreated(false)
     {
         setDescription(m_obj->getDescription());
+        packObject(m_lastData);
     }
     inline UAVObject *object()
     {
@@ -300,9 +322,48 @@ public:
     {
         return !m_obj->isSettingsObject() || m_obj->isKnown();
     }
+    inline bool fieldsCreated()
+    {
+        return m_fieldsCreated;
+    }
+    void setFieldsCreated(bool created)
+    {
+        m_fieldsCreated = created;
+        if (created) {
+            m_lastData.clear();
+        }
+    }
+    virtual void update()
+    {
+        if (m_fieldsCreated) {
+            TreeItem::update();
+        } else {
+            updateObjectData();
+        }
+    }
+
+protected:
+    void updateObjectData()
+    {
+        QByteArray data;
+
+        packObject(data);
+        if (data != m_lastData) {
+            m_lastData = data;
+            setHighlight(true);
+        }
+    }
 
 private:
+    void packObject(QByteArray &data)
+    {
+        data.resize(m_obj->getNumBytes());
+        m_obj->pack((quint8 *)data.data());
+    }
+
     UAVObject *m_obj;
+    bool m_fieldsCreated;
+    QByteArray m_lastData;
 };
 
 class MetaObjectTreeItem : public ObjectTreeItem {
@@ -340,6 +401,10 @@ public:
     }
     virtual void update()
     {
+        if (!fieldsCreated()) {
+            updateObjectData();
+            return;
+        }
         foreach(TreeItem * child, treeChildren()) {
             MetaObjectTreeItem *metaChild = dynamic_cast<MetaObjectTreeItem *>(child);
 
@@ -365,7 +430,7 @@ public:
     }
     virtual void update()
     {
-        TreeItem::update();
+        ObjectTreeItem::update();
     }
 };
 
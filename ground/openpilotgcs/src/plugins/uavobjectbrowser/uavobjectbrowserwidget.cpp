@@ -76,6 +76,10 @@ UAVObjectBrowserWidget::UAVObjectBrowserWidget(QWidget *parent) : QWidget(parent
     connect(m_viewoptions->cbCategorized, SIGNAL(toggled(bool)), this, SLOT(viewOptionsChangedSlot()));
     connect(m_viewoptions->cbDescription, SIGNAL(toggled(bool)), this, SLOT(viewOptionsChangedSlot()));
     connect(m_browser->splitter, SIGNAL(splitterMoved(int, int)), this, SLOT(splitterMoved()));
+    connect(m_browser->searchLine, SIGNAL(textChanged(QString)), this, SLOT(searchTextChanged(QString)));
+    // Queued so that the model has added the row to hide
+    UAVObjectManager *objManager = ExtensionSystem::PluginManager::instance()->getObject<UAVObjectManager>();
+    connect(objManager, SIGNAL(newObject(UAVObject *)), this, SLOT(objectAdded()), Qt::QueuedConnection);
     enableSendRequest(false);
 }
 
@@ -122,6 +126,7 @@ void UAVObjectBrowserWidget::categorize(bool categorize)
     m_model->setUnknowObjectColor(m_unknownObjectColor);
     m_browser->treeView->setModel(m_model);
     showMetaData(m_viewoptions->cbMetaData->isChecked());
+    applySearchFilter();
     connect(m_browser->treeView->selectionModel(), SIGNAL(currentChanged(QModelIndex, QModelIndex)), this, SLOT(currentChanged(QModelIndex, QModelIndex)), Qt::UniqueConnection);
 
     delete tmpModel;
@@ -138,11 +143,65 @@ void UAVObjectBrowserWidget::useScientificNotation(bool scientific)
     m_model->setUnknowObjectColor(m_unknownObjectColor);
     m_browser->treeView->setModel(m_model);
     showMetaData(m_viewoptions->cbMetaData->isChecked());
+    applySearchFilter();
     connect(m_browser->treeView->selectionModel(), SIGNAL(currentChanged(QModelIndex, QModelIndex)), this, SLOT(currentChanged(QModelIndex, QModelIndex)), Qt::UniqueConnection);
 
     delete tmpModel;
 }
 
+void UAVObjectBrowserWidget::searchTextChanged(const QString &text)
+{
+    Q_UNUSED(text);
+    applySearchFilter();
+}
+
+void UAVObjectBrowserWidget::objectAdded()
+{
+    // Indexed again on the next search
+    m_searchIndex.clear();
+    if (!m_browser->searchLine->text().trimmed().isEmpty()) {
+        applySearchFilter();
+    }
+}
+
+void UAVObjectBrowserWidget::applySearchFilter()
+{
+    QString query = m_browser->searchLine->text().trimmed();
+
+    if (query.isEmpty()) {
+        m_model->clearObjectFilter();
+    } else {
+        if (m_searchIndex.isEmpty()) {
+            m_searchIndex.build(ExtensionSystem::PluginManager::instance()->getObject<UAVObjectManager>());
+        }
+        // The rows are hidden rather than proxied, so that the updates of the
+        // shown objects do not filter the model again
+        m_model->setObjectFilter(m_searchIndex.search(query));
+    }
+    filterRows(QModelIndex());
+}
+
+bool UAVObjectBrowserWidget::filterRows(const QModelIndex &parent)
+{
+    bool anyShown = false;
+
+    for (int row = 0; row < m_model->rowCount(parent); ++row) {
+        QModelIndex index = m_model->index(row, 0, parent);
+        TreeItem *item    = static_cast<TreeItem *>(index.internalPointer());
+        ObjectTreeItem *objItem = dynamic_cast<ObjectTreeItem *>(item);
+        bool shown;
+        if (objItem) {
+            shown = !m_model->isFilteredOut(objItem->object());
+        } else {
+            // Settings, data objects and category items, shown when one of their objects is
+            shown = filterRows(index);
+        }
+        m_browser->treeView->setRowHidden(row, parent, !shown);
+        anyShown |= shown;
+    }
+    return anyShown;
+}
+
 void UAVObjectBrowserWidget::sendUpdate()
 {
     this->setFocus();
@@ -32,6 +32,7 @@
 #include <QTreeView>
 #include "objectpersistence.h"
 #include "uavobjecttreemodel.h"
+#include "uavobjectsearchindex.h"
 
 class QPushButton;
 class ObjectTreeItem;
@@ -88,6 +89,8 @@ private slots:
     void viewSlot();
     void viewOptionsChangedSlot();
     void splitterMoved();
+    void searchTextChanged(const QString &text);
+    void objectAdded();
     QString createObjectDescription(UAVObject *object);
 signals:
     void viewOptionsChanged(bool categorized, bool scientific, bool metadata, bool description);
@@ -99,6 +102,7 @@ private:
     Ui_viewoptions *m_viewoptions;
     QDialog *m_viewoptionsDialog;
     UAVObjectTreeModel *m_model;
+    UAVObjectSearchIndex m_searchIndex;
 
     int m_recentlyUpdatedTimeout;
     QColor m_unknownObjectColor;
@@ -110,6 +114,8 @@ private:
     void updateObjectPersistance(ObjectPersistence::OperationOptions op, UAVObject *obj);
     void enableSendRequest(bool enable);
     void updateDescription();
+    void applySearchFilter();
+    bool filterRows(const QModelIndex &parent);
     ObjectTreeItem *findCurrentObjectTreeItem();
     QString loadFileIntoString(QString fileName);
 };
@@ -0,0 +1,155 @@
+/**
+ ******************************************************************************
+ *
+ * @file       uavobjectsearchindex.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVObjectBrowserPlugin UAVObject Browser Plugin
+ * @{
+ * @brief The UAVObject Browser gadget plugin
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "uavobjectsearchindex.h"
+#include "uavobjectmanager.h"
+#include "uavdataobject.h"
+#include "uavobjectfield.h"
+#include <QtCore/QRegExp>
+#include <algorithm>
+
+UAVObjectSearchIndex::UAVObjectSearchIndex()
+{}
+
+void UAVObjectSearchIndex::build(UAVObjectManager *objManager)
+{
+    clear();
+    QList< QList<UAVDataObject *> > objList = objManager->getDataObjects();
+    foreach(QList<UAVDataObject *> list, objList) {
+        if (!list.isEmpty()) {
+            // All the instances share the same names and description
+            addObject(list.first());
+        }
+    }
+    std::sort(m_entries.begin(), m_entries.end());
+    m_entries.erase(std::unique(m_entries.begin(), m_entries.end()), m_entries.end());
+    m_entries.squeeze();
+}
+
+void UAVObjectSearchIndex::clear()
+{
+    m_entries.clear();
+    m_lastRanges.clear();
+}
+
+void UAVObjectSearchIndex::addObject(UAVObject *obj)
+{
+    quint32 objId = obj->getObjID();
+
+    addText(obj->getName(), objId);
+    addText(obj->getCategory(), objId);
+    addText(obj->getDescription(), objId);
+    foreach(UAVObjectField * field, obj->getFields()) {
+        addText(field->getName(), objId);
+        addText(field->getDescription(), objId);
+        if (field->getNumElements() > 1) {
+            foreach(QString element, field->getElementNames()) {
+                addText(element, objId);
+            }
+        }
+    }
+}
+
+void UAVObjectSearchIndex::addText(const QString &text, quint32 objId)
+{
+    static const QRegExp separators("[^A-Za-z0-9]+");
+
+    foreach(QString word, text.split(separators, QString::SkipEmptyParts)) {
+        addWord(word.toLower(), objId);
+        // "GyroSensor" is also found by "sensor"
+        for (int i = 1; i < word.length(); ++i) {
+            if (word.at(i).isUpper() && word.at(i - 1).isLower()) {
+                addWord(word.mid(i).toLower(), objId);
+            }
+        }
+    }
+}
+
+void UAVObjectSearchIndex::addWord(const QString &word, quint32 objId)
+{
+    Entry entry;
+
+    entry.word  = word;
+    entry.objId = objId;
+    m_entries.append(entry);
+}
+
+UAVObjectSearchIndex::Range UAVObjectSearchIndex::findRange(const QString &prefix, int begin, int end) const
+{
+    Range range;
+    Entry key;
+
+    key.word     = prefix;
+    key.objId    = 0;
+    range.prefix = prefix;
+    range.begin  = std::lower_bound(m_entries.constBegin() + begin, m_entries.constBegin() + end, key) - m_entries.constBegin();
+    range.end    = range.begin;
+    // The words starting with the prefix follow it, bisect for the first one that does not
+    int count = end - range.begin;
+    while (count > 0) {
+        int step = count / 2;
+        int mid  = range.end + step;
+        if (m_entries.at(mid).word.startsWith(prefix)) {
+            range.end = mid + 1;
+            count    -= step + 1;
+        } else {
+            count = step;
+        }
+    }
+    return range;
+}
+
+QSet<quint32> UAVObjectSearchIndex::search(const QString &query)
+{
+    QStringList words = query.toLower().split(QRegExp("[^a-z0-9]+"), QString::SkipEmptyParts);
+    QList<Range> ranges;
+
+    for (int i = 0; i < words.count(); ++i) {
+        const QString &word = words.at(i);
+        // Narrow the range of the previous query when the word was only extended
+        if (i < m_lastRanges.count() && word.startsWith(m_lastRanges.at(i).prefix)) {
+            ranges.append(findRange(word, m_lastRanges.at(i).begin, m_lastRanges.at(i).end));
+        } else {
+            ranges.append(findRange(word, 0, m_entries.count()));
+        }
+    }
+    m_lastRanges = ranges;
+
+    QSet<quint32> result;
+    for (int i = 0; i < ranges.count(); ++i) {
+        QSet<quint32> matches;
+        for (int e = ranges.at(i).begin; e < ranges.at(i).end; ++e) {
+            if (i == 0 || result.contains(m_entries.at(e).objId)) {
+                matches.insert(m_entries.at(e).objId);
+            }
+        }
+        result.swap(matches);
+        if (result.isEmpty()) {
+            break;
+        }
+    }
+    return result;
+}
@@ -0,0 +1,88 @@
+/**
+ ******************************************************************************
+ *
+ * @file       uavobjectsearchindex.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVObjectBrowserPlugin UAVObject Browser Plugin
+ * @{
+ * @brief The UAVObject Browser gadget plugin
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef UAVOBJECTSEARCHINDEX_H
+#define UAVOBJECTSEARCHINDEX_H
+
+#include <QtCore/QSet>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QVector>
+
+class UAVObject;
+class UAVObjectManager;
+
+/*
+ * Sorted list of the lower case words of the object names, categories,
+ * field names, element names and descriptions, each with the id of its
+ * object. A query word matches the objects with a word it is a prefix of,
+ * found by binary search. The range of each query word is kept, so that
+ * typing one more letter only searches the range of the previous query.
+ */
+class UAVObjectSearchIndex {
+public:
+    UAVObjectSearchIndex();
+
+    void build(UAVObjectManager *objManager);
+    void clear();
+    bool isEmpty() const
+    {
+        return m_entries.isEmpty();
+    }
+
+    // Ids of the objects matching all the words of the query
+    QSet<quint32> search(const QString &query);
+
+private:
+    struct Entry {
+        QString word;
+        quint32 objId;
+        bool operator<(const Entry &other) const
+        {
+            return word < other.word || (word == other.word && objId < other.objId);
+        }
+        bool operator==(const Entry &other) const
+        {
+            return objId == other.objId && word == other.word;
+        }
+    };
+    struct Range {
+        QString prefix;
+        int     begin;
+        int     end;
+    };
+
+    void addObject(UAVObject *obj);
+    void addText(const QString &text, quint32 objId);
+    void addWord(const QString &word, quint32 objId);
+    Range findRange(const QString &prefix, int begin, int end) const;
+
+    QVector<Entry> m_entries;
+    QList<Range> m_lastRanges;
+};
+
+#endif // UAVOBJECTSEARCHINDEX_H
@@ -36,6 +36,7 @@
 #include <QtCore/QTimer>
 #include <QtCore/QSignalMapper>
 #include <QtCore/QDebug>
+#include <algorithm>
 
 UAVObjectTreeModel::UAVObjectTreeModel(QObject *parent, bool categorize, bool useScientificNotation) :
     QAbstractItemModel(parent),
@@ -44,7 +45,9 @@ UAVObjectTreeModel::UAVObjectTreeModel(QObject *parent, bool categorize, bool us
     m_recentlyUpdatedTimeout(500), // ms
     m_recentlyUpdatedColor(QColor(255, 230, 230)),
     m_manuallyChangedColor(QColor(230, 230, 255)),
-    m_unknownObjectColor(QColor(Qt::gray))
+    m_unknownObjectColor(QColor(Qt::gray)),
+    m_onlyHilightChangedValues(false),
+    m_filtered(false)
 {
     ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
     UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
@@ -53,6 +56,10 @@ UAVObjectTreeModel::UAVObjectTreeModel(QObject *parent, bool categorize, bool us
 
     // Create highlight manager, let it run every 300 ms.
     m_highlightManager = new HighLightManager(300);
+    m_updateTimer = new QTimer(this);
+    m_updateTimer->setSingleShot(true);
+    m_updateTimer->setInterval(UPDATE_INTERVAL_MS);
+    connect(m_updateTimer, SIGNAL(timeout()), this, SLOT(emitPendingUpdates()));
     connect(objManager, SIGNAL(newObject(UAVObject *)), this, SLOT(newObject(UAVObject *)));
     connect(objManager, SIGNAL(newInstance(UAVObject *)), this, SLOT(newObject(UAVObject *)));
 
@@ -113,9 +120,14 @@ void UAVObjectTreeModel::addDataObject(UAVDataObject *obj)
 
     ObjectTreeItem *existing = root->findDataObjectTreeItemByObjectId(obj->getObjID());
     if (existing) {
+        // The view may already show the other instances
+        beginInsertRows(index(existing), existing->childCount(), existing->childCount());
         addInstance(obj, existing);
+        endInsertRows();
     } else {
         DataObjectTreeItem *dataTreeItem = new DataObjectTreeItem(obj->getName(), obj);
+        // The instances of a multi instance object are created at once, their fields on expansion
+        dataTreeItem->setFieldsCreated(!obj->isSingleInstance());
         dataTreeItem->setHighlightManager(m_highlightManager);
         connect(dataTreeItem, SIGNAL(updateHighlight(TreeItem *)), this, SLOT(updateHighlight(TreeItem *)));
         connect(dataTreeItem, SIGNAL(updateIsKnown(TreeItem *)), this, SLOT(updateIsKnown(TreeItem *)));
@@ -150,46 +162,42 @@ TreeItem *UAVObjectTreeModel::createCategoryItems(QStringList categoryPath, Tree
 
 MetaObjectTreeItem *UAVObjectTreeModel::addMetaObject(UAVMetaObject *obj, TreeItem *parent)
 {
-    connect(obj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(highlightUpdatedObject(UAVObject *)));
+    connect(obj, SIGNAL(objectUpdatedCoalesced(UAVObject *)), this, SLOT(highlightUpdatedObject(UAVObject *)));
     MetaObjectTreeItem *meta = new MetaObjectTreeItem(obj, tr("Meta Data"));
 
     meta->setHighlightManager(m_highlightManager);
     connect(meta, SIGNAL(updateHighlight(TreeItem *)), this, SLOT(updateHighlight(TreeItem *)));
-    foreach(UAVObjectField * field, obj->getFields()) {
-        if (field->getNumElements() > 1) {
-            addArrayField(field, meta);
-        } else {
-            addSingleField(0, field, meta);
-        }
-    }
     parent->appendChild(meta);
     return meta;
 }
 
 void UAVObjectTreeModel::addInstance(UAVObject *obj, TreeItem *parent)
 {
-    connect(obj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(highlightUpdatedObject(UAVObject *)));
+    connect(obj, SIGNAL(objectUpdatedCoalesced(UAVObject *)), this, SLOT(highlightUpdatedObject(UAVObject *)));
     connect(obj, SIGNAL(isKnownChanged(UAVObject *, bool)), this, SLOT(isKnownChanged(UAVObject *, bool)));
-    TreeItem *item;
     if (obj->isSingleInstance()) {
-        item = parent;
         DataObjectTreeItem *objectItem = static_cast<DataObjectTreeItem *>(parent);
         connect(objectItem, SIGNAL(updateIsKnown(TreeItem *)), this, SLOT(updateIsKnown(TreeItem *)));
     } else {
         QString name = tr("Instance") + " " + QString::number(obj->getInstID());
-        item = new InstanceTreeItem(obj, name);
+        TreeItem *item = new InstanceTreeItem(obj, name);
         item->setHighlightManager(m_highlightManager);
         connect(item, SIGNAL(updateHighlight(TreeItem *)), this, SLOT(updateHighlight(TreeItem *)));
         connect(item, SIGNAL(updateIsKnown(TreeItem *)), this, SLOT(updateIsKnown(TreeItem *)));
         parent->appendChild(item);
     }
-    foreach(UAVObjectField * field, obj->getFields()) {
+}
+
+void UAVObjectTreeModel::addFields(ObjectTreeItem *item)
+{
+    foreach(UAVObjectField * field, item->object()->getFields()) {
         if (field->getNumElements() > 1) {
             addArrayField(field, item);
         } else {
             addSingleField(0, field, item);
         }
     }
+    item->setFieldsCreated(true);
 }
 
 void UAVObjectTreeModel::addArrayField(UAVObjectField *field, TreeItem *parent)
@@ -287,17 +295,7 @@ QModelIndex UAVObjectTreeModel::index(TreeItem *item)
         return QModelIndex();
     }
 
-    QModelIndex root = index(item->parent());
-
-    for (int i = 0; i < rowCount(root); ++i) {
-        QModelIndex childIndex = index(i, 0, root);
-        TreeItem *child = static_cast<TreeItem *>(childIndex.internalPointer());
-        if (child == item) {
-            return childIndex;
-        }
-    }
-    Q_ASSERT(false);
-    return QModelIndex();
+    return createIndex(item->row(), 0, item);
 }
 
 QModelIndex UAVObjectTreeModel::parent(const QModelIndex &index) const
@@ -333,6 +331,46 @@ int UAVObjectTreeModel::rowCount(const QModelIndex &parent) const
     return parentItem->childCount();
 }
 
+bool UAVObjectTreeModel::hasChildren(const QModelIndex &parent) const
+{
+    if (parent.column() > 0) {
+        return false;
+    }
+    if (parent.isValid()) {
+        ObjectTreeItem *objItem = dynamic_cast<ObjectTreeItem *>(static_cast<TreeItem *>(parent.internalPointer()));
+        if (objItem && !objItem->fieldsCreated()) {
+            return true;
+        }
+    }
+    return rowCount(parent) > 0;
+}
+
+bool UAVObjectTreeModel::canFetchMore(const QModelIndex &parent) const
+{
+    if (!parent.isValid()) {
+        return false;
+    }
+    ObjectTreeItem *objItem = dynamic_cast<ObjectTreeItem *>(static_cast<TreeItem *>(parent.internalPointer()));
+    return objItem && !objItem->fieldsCreated();
+}
+
+void UAVObjectTreeModel::fetchMore(const QModelIndex &parent)
+{
+    if (!canFetchMore(parent)) {
+        return;
+    }
+    ObjectTreeItem *objItem = static_cast<ObjectTreeItem *>(static_cast<TreeItem *>(parent.internalPointer()));
+    int first = objItem->childCount();
+    int count = objItem->object()->getFields().count();
+    if (count == 0) {
+        objItem->setFieldsCreated(true);
+        return;
+    }
+    beginInsertRows(parent, first, first + count - 1);
+    addFields(objItem);
+    endInsertRows();
+}
+
 int UAVObjectTreeModel::columnCount(const QModelIndex &parent) const
 {
     if (parent.isValid()) {
@@ -444,20 +482,97 @@ QVariant UAVObjectTreeModel::headerData(int section, Qt::Orientation orientation
     return QVariant();
 }
 
+void UAVObjectTreeModel::setObjectFilter(const QSet<quint32> &objectIds)
+{
+    QSet<quint32> wasShown = m_shownObjectIds;
+    bool wasFiltered = m_filtered;
+
+    m_filtered = true;
+    m_shownObjectIds = objectIds;
+    refreshShownObjects(wasShown, wasFiltered);
+}
+
+void UAVObjectTreeModel::clearObjectFilter()
+{
+    QSet<quint32> wasShown = m_shownObjectIds;
+    bool wasFiltered = m_filtered;
+
+    m_filtered = false;
+    m_shownObjectIds.clear();
+    refreshShownObjects(wasShown, wasFiltered);
+}
+
+bool UAVObjectTreeModel::isFilteredOut(UAVObject *obj) const
+{
+    if (!m_filtered) {
+        return false;
+    }
+    UAVMetaObject *metaObject = qobject_cast<UAVMetaObject *>(obj);
+    if (metaObject) {
+        // Meta data rows are shown with their object
+        obj = metaObject->getParentObject();
+    }
+    return !m_shownObjectIds.contains(obj->getObjID());
+}
+
+void UAVObjectTreeModel::refreshShownObjects(const QSet<quint32> &wasShown, bool wasFiltered)
+{
+    if (!wasFiltered) {
+        return;
+    }
+    // The updates of the objects coming back into view were skipped, catch up once
+    QList<DataObjectTreeItem *> items = m_settingsTree->getObjectItems() + m_nonSettingsTree->getObjectItems();
+    foreach(DataObjectTreeItem * item, items) {
+        quint32 objId = item->object()->getObjID();
+
+        if (!wasShown.contains(objId) && !isFilteredOut(item->object())) {
+            item->update();
+            foreach(TreeItem * child, item->treeChildren()) {
+                MetaObjectTreeItem *metaChild = dynamic_cast<MetaObjectTreeItem *>(child);
+
+                if (metaChild) {
+                    metaChild->update();
+                }
+            }
+        }
+    }
+}
+
 void UAVObjectTreeModel::highlightUpdatedObject(UAVObject *obj)
 {
     Q_ASSERT(obj);
+    if (isFilteredOut(obj)) {
+        // Hidden by the search, refreshed when shown again
+        return;
+    }
     ObjectTreeItem *item = findObjectTreeItem(obj);
     Q_ASSERT(item);
+    if (!obj->isSingleInstance()) {
+        // Only the updated instance, not all of them
+        ObjectTreeItem *instanceItem = findInstanceTreeItem(item, obj);
+        if (instanceItem) {
+            item = instanceItem;
+        }
+    }
     if (!m_onlyHilightChangedValues) {
         item->setHighlight(true);
     }
     item->update();
     if (!m_onlyHilightChangedValues) {
-        QModelIndex itemIndex = index(item);
-        Q_ASSERT(itemIndex != QModelIndex());
-        emit dataChanged(itemIndex, itemIndex);
+        updateHighlight(item);
+    }
+}
+
+ObjectTreeItem *UAVObjectTreeModel::findInstanceTreeItem(ObjectTreeItem *objectItem, UAVObject *obj)
+{
+    foreach(TreeItem * child, objectItem->treeChildren()) {
+        InstanceTreeItem *instanceItem = dynamic_cast<InstanceTreeItem *>(child);
+
+        if (instanceItem && instanceItem->object() == obj) {
+            return instanceItem;
+        }
     }
+    return 0;
 }
 
 ObjectTreeItem *UAVObjectTreeModel::findObjectTreeItem(UAVObject *object)
@@ -492,10 +607,40 @@ MetaObjectTreeItem *UAVObjectTreeModel::findMetaObjectTreeItem(UAVMetaObject *ob
 
 void UAVObjectTreeModel::updateHighlight(TreeItem *item)
 {
-    QModelIndex itemIndex = index(item);
+    // Repainted together at most once per frame
+    m_pendingUpdates.insert(item);
+    if (!m_updateTimer->isActive()) {
+        m_updateTimer->start();
+    }
+}
 
-    Q_ASSERT(itemIndex != QModelIndex());
-    emit dataChanged(itemIndex, itemIndex.sibling(itemIndex.row(), TreeItem::DATA_COLUMN));
+void UAVObjectTreeModel::emitPendingUpdates()
+{
+    QSet<TreeItem *> items;
+
+    items.swap(m_pendingUpdates);
+
+    // One dataChanged per run of adjacent rows of the same parent
+    QHash<TreeItem *, QList<int> > rowsPerParent;
+    foreach(TreeItem * item, items) {
+        Q_ASSERT(item->parent());
+        rowsPerParent[item->parent()].append(item->row());
+    }
+    QHash<TreeItem *, QList<int> >::iterator i;
+    for (i = rowsPerParent.begin(); i != rowsPerParent.end(); ++i) {
+        TreeItem *parent  = i.key();
+        QList<int> &rows  = i.value();
+        std::sort(rows.begin(), rows.end());
+        int first = 0;
+        for (int r = 1; r <= rows.count(); ++r) {
+            if (r == rows.count() || rows.at(r) != rows.at(r - 1) + 1) {
+                QModelIndex topLeft     = createIndex(rows.at(first), TreeItem::TITLE_COLUMN, parent->getChild(rows.at(first)));
+                QModelIndex bottomRight = createIndex(rows.at(r - 1), TreeItem::DATA_COLUMN, parent->getChild(rows.at(r - 1)));
+                emit dataChanged(topLeft, bottomRight);
+                first = r;
+            }
+        }
+    }
 }
 
 void UAVObjectTreeModel::updateIsKnown(TreeItem *item)
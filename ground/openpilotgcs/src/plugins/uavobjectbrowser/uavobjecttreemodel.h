@@ -32,6 +32,7 @@
 #include <QAbstractItemModel>
 #include <QtCore/QMap>
 #include <QtCore/QList>
+#include <QtCore/QSet>
 #include <QColor>
 
 class TopTreeItem;
@@ -61,6 +62,10 @@ public:
     QModelIndex parent(const QModelIndex &index) const;
     int rowCount(const QModelIndex &parent = QModelIndex()) const;
     int columnCount(const QModelIndex &parent = QModelIndex()) const;
+    // The fields of objects are created when they are first expanded
+    bool hasChildren(const QModelIndex &parent = QModelIndex()) const;
+    bool canFetchMore(const QModelIndex &parent) const;
+    void fetchMore(const QModelIndex &parent);
 
     void setUnknowObjectColor(QColor color)
     {
@@ -86,6 +91,11 @@ public:
 
     QList<QModelIndex> getMetaDataIndexes();
 
+    // Updates of the objects not in objectIds are ignored until the filter changes
+    void setObjectFilter(const QSet<quint32> &objectIds);
+    void clearObjectFilter();
+    bool isFilteredOut(UAVObject *obj) const;
+
 signals:
 
 public slots:
@@ -96,6 +106,7 @@ private slots:
     void updateIsKnown(TreeItem *item);
     void highlightUpdatedObject(UAVObject *obj);
     void isKnownChanged(UAVObject *object, bool isKnown);
+    void emitPendingUpdates();
 
 private:
     void setupModelData(UAVObjectManager *objManager);
@@ -105,11 +116,14 @@ private:
     void addArrayField(UAVObjectField *field, TreeItem *parent);
     void addSingleField(int index, UAVObjectField *field, TreeItem *parent);
     void addInstance(UAVObject *obj, TreeItem *parent);
+    void addFields(ObjectTreeItem *item);
+    void refreshShownObjects(const QSet<quint32> &wasShown, bool wasFiltered);
 
     TreeItem *createCategoryItems(QStringList categoryPath, TreeItem *root);
 
     QString updateMode(quint8 updateMode);
     ObjectTreeItem *findObjectTreeItem(UAVObject *obj);
+    ObjectTreeItem *findInstanceTreeItem(ObjectTreeItem *objectItem, UAVObject *obj);
     DataObjectTreeItem *findDataObjectTreeItem(UAVDataObject *obj);
     MetaObjectTreeItem *findMetaObjectTreeItem(UAVMetaObject *obj);
 
@@ -123,9 +137,16 @@ private:
     QColor m_manuallyChangedColor;
     QColor m_unknownObjectColor;
     bool m_onlyHilightChangedValues;
+    bool m_filtered;
+    QSet<quint32> m_shownObjectIds;
 
     // Highlight manager to handle highlighting of tree items.
     HighLightManager *m_highlightManager;
+
+    // Items to repaint, dataChanged is emitted at most once per frame
+    static const int UPDATE_INTERVAL_MS = 33;
+    QSet<TreeItem *> m_pendingUpdates;
+    QTimer *m_updateTimer;
 };
 
 #endif // UAVOBJECTTREEMODEL_H
@@ -26,6 +26,7 @@
  * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
  */
 #include "uavobject.h"
+#include "uavobjectjson.h"
 
 #include <utils/crc.h>
 
@@ -62,6 +63,7 @@ UAVObject::UAVObject(quint32 objID, bool isSingleInst, const QString & name)
     this->name         = name;
     this->data         = 0;
     this->numBytes     = 0;
+    this->compactNumBytes = 0;
     this->mutex        = new QMutex(QMutex::Recursive);
     m_isKnown = false;
 }
@@ -91,11 +93,14 @@ void UAVObject::initializeFields(QList<UAVObjectField *> & fields, quint8 *data,
     this->fields   = fields;
     // Initialize fields
     quint32 offset = 0;
+    quint32 compactOffset = 0;
     for (int n = 0; n < fields.length(); ++n) {
         fields[n]->initialize(data, offset, this);
         offset += fields[n]->getNumBytes();
+        compactOffset += fields[n]->getCompactNumBytes();
         connect(fields[n], SIGNAL(fieldUpdated(UAVObjectField *)), this, SLOT(fieldUpdated(UAVObjectField *)));
     }
+    this->compactNumBytes = (compactOffset != numBytes) ? compactOffset : 0;
 }
 
 /**
@@ -300,12 +305,18 @@ UAVObjectField *UAVObject::getField(const QString & name)
 qint32 UAVObject::pack(quint8 *dataOut)
 {
     QMutexLocker locker(mutex);
+
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    // The fields are stored back to back in the wire format
+    memcpy(dataOut, data, numBytes);
+#else
     qint32 offset = 0;
 
     for (int n = 0; n < fields.length(); ++n) {
         fields[n]->pack(&dataOut[offset]);
         offset += fields[n]->getNumBytes();
     }
+#endif
     return numBytes;
 }
 
@@ -316,18 +327,51 @@ qint32 UAVObject::pack(quint8 *dataOut)
 qint32 UAVObject::unpack(const quint8 *dataIn)
 {
     QMutexLocker locker(mutex);
+
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    // The fields are stored back to back in the wire format
+    memcpy(data, dataIn, numBytes);
+#else
     qint32 offset = 0;
 
     for (int n = 0; n < fields.length(); ++n) {
         fields[n]->unpack(&dataIn[offset]);
         offset += fields[n]->getNumBytes();
     }
+#endif
     emit objectUnpacked(this); // trigger object updated event
     emit objectUpdated(this);
 
     return numBytes;
 }
 
+/**
+ * Get the size of the compact updates sent over the slow links
+ * @returns The number of bytes, 0 when the object has no compact representation
+ */
+quint32 UAVObject::getCompactNumBytes()
+{
+    return compactNumBytes;
+}
+
+/**
+ * Unpack the object data from a compact update
+ * @returns The number of bytes used
+ */
+qint32 UAVObject::unpackCompact(const quint8 *dataIn)
+{
+    QMutexLocker locker(mutex);
+    qint32 offset = 0;
+
+    for (int n = 0; n < fields.length(); ++n) {
+        offset += fields[n]->unpackCompact(&dataIn[offset]);
+    }
+    emit objectUnpacked(this); // trigger object updated event
+    emit objectUpdated(this);
+
+    return offset;
+}
+
 /**
  * Update a CRC with the object data
  * @returns The updated CRC
@@ -572,6 +616,21 @@ void UAVObject::toJson(QJsonObject &jsonObject)
     jsonObject["fields"] = jSonFields;
 }
 
+void UAVObject::toJson(UAVObjectJsonWriter *writer)
+{
+    writer->writeStartObject();
+    writer->writeString("name", getName());
+    writer->writeBool("setting", isSettingsObject());
+    writer->writeString("id", QString::number(getObjID(), 16).toUpper());
+    writer->writeInteger("instance", getInstID());
+    writer->writeStartArray("fields");
+    foreach(UAVObjectField * field, fields) {
+        field->toJson(writer);
+    }
+    writer->writeEndArray();
+    writer->writeEndObject();
+}
+
 void UAVObject::fromJson(const QJsonObject &jsonObject)
 {
     if (jsonObject["name"].toString() == getName() &&
@@ -604,6 +663,25 @@ void UAVObject::emitNewInstance(UAVObject *obj)
     emit newInstance(obj);
 }
 
+/**
+ * Emit the coalesced update signal, called by the UAVObjectManager at most once per
+ * coalescing period if the object was updated during that period.
+ */
+void UAVObject::emitObjectUpdatedCoalesced()
+{
+    emit objectUpdatedCoalesced(this);
+}
+
+/**
+ * Check if anything is connected to the coalesced update signal.
+ */
+bool UAVObject::hasCoalescedReceivers() const
+{
+    static const QMetaMethod coalescedSignal = QMetaMethod::fromSignal(&UAVObject::objectUpdatedCoalesced);
+
+    return isSignalConnected(coalescedSignal);
+}
+
 bool UAVObject::isKnown() const
 {
     QMutexLocker locker(mutex);
@@ -737,6 +815,46 @@ void UAVObject::SetGcsTelemetryAcked(UAVObject::Metadata & metadata, quint8 val)
     SET_BITS(metadata.flags, UAVOBJ_GCS_TELEMETRY_ACKED_SHIFT, val, 1);
 }
 
+/**
+ * Get the UAVObject metadata flight telemetry timestamped member
+ * \param[in] metadata The metadata object
+ * \return the telemetry timestamped boolean
+ */
+quint8 UAVObject::GetFlightTelemetryTimestamped(const UAVObject::Metadata & metadata)
+{
+    return (metadata.flags >> UAVOBJ_TELEMETRY_TIMESTAMPED_SHIFT) & 1;
+}
+
+/**
+ * Set the UAVObject metadata flight telemetry timestamped member
+ * \param[in] metadata The metadata object
+ * \param[in] val The telemetry timestamped boolean
+ */
+void UAVObject::SetFlightTelemetryTimestamped(UAVObject::Metadata & metadata, quint8 val)
+{
+    SET_BITS(metadata.flags, UAVOBJ_TELEMETRY_TIMESTAMPED_SHIFT, val, 1);
+}
+
+/**
+ * Get the UAVObject metadata flight telemetry skip unchanged member
+ * \param[in] metadata The metadata object
+ * \return the telemetry skip unchanged boolean
+ */
+quint8 UAVObject::GetFlightTelemetrySkipUnchanged(const UAVObject::Metadata & metadata)
+{
+    return (metadata.flags >> UAVOBJ_TELEMETRY_SKIP_UNCHANGED_SHIFT) & 1;
+}
+
+/**
+ * Set the UAVObject metadata flight telemetry skip unchanged member
+ * \param[in] metadata The metadata object
+ * \param[in] val The telemetry skip unchanged boolean
+ */
+void UAVObject::SetFlightTelemetrySkipUnchanged(UAVObject::Metadata & metadata, quint8 val)
+{
+    SET_BITS(metadata.flags, UAVOBJ_TELEMETRY_SKIP_UNCHANGED_SHIFT, val, 1);
+}
+
 /**
  * Get the UAVObject metadata telemetry update mode
  * \param[in] metadata The metadata object
@@ -50,9 +50,12 @@
 #define UAVOBJ_TELEMETRY_UPDATE_MODE_SHIFT     4
 #define UAVOBJ_GCS_TELEMETRY_UPDATE_MODE_SHIFT 6
 #define UAVOBJ_LOGGING_UPDATE_MODE_SHIFT       8
+#define UAVOBJ_TELEMETRY_TIMESTAMPED_SHIFT     10
+#define UAVOBJ_TELEMETRY_SKIP_UNCHANGED_SHIFT  11
 #define UAVOBJ_UPDATE_MODE_MASK                0x3
 
 class UAVObjectField;
+class UAVObjectJsonWriter;
 
 class UAVOBJECTS_EXPORT UAVObject : public QObject {
     Q_OBJECT
@@ -94,6 +97,8 @@ public:
      *    4-5    telemetryUpdateMode        Update mode used by the telemetry module (UAVObjUpdateMode)
      *    6-7    gcsTelemetryUpdateMode     Update mode used by the GCS (UAVObjUpdateMode)
      *    8-9    loggingUpdateMode          Update mode used by the logging module (UAVObjUpdateMode)
+     *     10    telemetryTimestamped       Defines if the flight telemetry updates carry the board time (1:timestamped, 0:not timestamped)
+     *     11    telemetrySkipUnchanged     Defines if the flight skips the periodic updates of unchanged data, but for a keepalive (1:skip, 0:always send)
      */
     typedef struct {
         quint16 flags; /** Defines flags for update and logging modes and whether an update should be ACK'd (bits defined above) */
@@ -114,6 +119,8 @@ public:
     quint32 getNumBytes();
     qint32 pack(quint8 *dataOut);
     qint32 unpack(const quint8 *dataIn);
+    quint32 getCompactNumBytes();
+    qint32 unpackCompact(const quint8 *dataIn);
     quint8 updateCRC(quint8 crc = 0);
     bool save();
     bool save(QFile & file);
@@ -138,9 +145,12 @@ public:
 
     void toJson(QJsonObject &jsonObject);
     void fromJson(const QJsonObject &jsonObject);
+    void toJson(UAVObjectJsonWriter *writer);
 
     void emitTransactionCompleted(bool success);
     void emitNewInstance(UAVObject *);
+    void emitObjectUpdatedCoalesced();
+    bool hasCoalescedReceivers() const;
 
     bool isKnown() const;
     void setIsKnown(bool isKnown);
@@ -159,6 +169,10 @@ public:
     static void SetFlightTelemetryAcked(Metadata & meta, quint8 val);
     static quint8 GetGcsTelemetryAcked(const Metadata & meta);
     static void SetGcsTelemetryAcked(Metadata & meta, quint8 val);
+    static quint8 GetFlightTelemetryTimestamped(const Metadata & meta);
+    static void SetFlightTelemetryTimestamped(Metadata & meta, quint8 val);
+    static quint8 GetFlightTelemetrySkipUnchanged(const Metadata & meta);
+    static void SetFlightTelemetrySkipUnchanged(Metadata & meta, quint8 val);
     static UpdateMode GetFlightTelemetryUpdateMode(const Metadata & meta);
     static void SetFlightTelemetryUpdateMode(Metadata & meta, UpdateMode val);
     static UpdateMode GetGcsTelemetryUpdateMode(const Metadata & meta);
@@ -174,6 +188,9 @@ public slots:
 
 signals:
     void objectUpdated(UAVObject *obj);
+    // Same as objectUpdated but emitted at most once per UAVObjectManager coalescing period,
+    // for receivers that only need the latest value (instruments, browser...)
+    void objectUpdatedCoalesced(UAVObject *obj);
     void objectUpdatedAuto(UAVObject *obj);
     void objectUpdatedManual(UAVObject *obj, bool all = false);
     void objectUpdatedPeriodic(UAVObject *obj);
@@ -191,6 +208,8 @@ protected:
     QString description;
     QString category;
     quint32 numBytes;
+    // size of the compact updates, 0 when the object has no compact representation
+    quint32 compactNumBytes;
     QMutex *mutex;
     quint8 *data;
     QList<UAVObjectField *> fields;
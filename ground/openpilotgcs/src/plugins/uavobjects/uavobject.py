@@ -40,7 +40,19 @@ class UAVMetaData(object):
         self.loggingUpdateMode = 0
         self.loggingUpdatePeriod = 0
 
+def make_dtype(fields):
+    """Build the numpy dtype of an object from its (name, type[, shape]) fields, None without numpy"""
+    try:
+        import numpy
+    except ImportError:
+        return None
+    return numpy.dtype(fields)
+
 class UAVObject(object):
+    # Precomputed object data layout, set by the generated objects
+    STRUCT = None
+    DTYPE  = None
+
     def __init__(self, objid, name, metaname, instanceid, issingle):
         self.objid      = objid
         self.name       = name
@@ -56,6 +68,8 @@ class UAVObject(object):
         self.fields.append(field)
 
     def get_struct(self):
+        if self.STRUCT is not None:
+            return self.STRUCT
         fmt = "<"
         for f in self.fields:
             fmt += f.get_struct()
@@ -68,6 +82,22 @@ class UAVObject(object):
     def get_size(self):
         return self.get_struct().size
 
+    @classmethod
+    def unpack_all(cls, data):
+        """Decode the concatenated data of several instances, one flat tuple per instance"""
+        s = cls.STRUCT
+        if hasattr(s, "iter_unpack"):
+            return list(s.iter_unpack(data))
+        return [s.unpack_from(data, offset) for offset in range(0, len(data) - s.size + 1, s.size)]
+
+    @classmethod
+    def decode_array(cls, data):
+        """Decode the concatenated data of several instances into a numpy structured array"""
+        if cls.DTYPE is None:
+            raise ImportError("numpy is required to decode %s into an array" % cls.__name__)
+        import numpy
+        return numpy.frombuffer(data, dtype=cls.DTYPE, count=len(data) // cls.DTYPE.itemsize)
+
 class UAVObjectField(object):
     def __init__(self, fieldname, type, nelements, elemnames, values):
         self.name      = fieldname
@@ -26,6 +26,7 @@
  * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
  */
 #include "uavobjectfield.h"
+#include "uavobjectjson.h"
 #include <QtEndian>
 #include <QDebug>
 #include <QtWidgets>
@@ -47,6 +48,27 @@ UAVObjectField::UAVObjectField(const QString & name, const QString & description
     constructorInitialize(name, description, units, type, elementNames, options, limits);
 }
 
+/**
+ * Create a field with the same description as the prototype, the names, options
+ * and limits are implicitly shared with it. The field still needs to be initialized.
+ */
+UAVObjectField::UAVObjectField(const UAVObjectField *prototype) :
+    name(prototype->name),
+    description(prototype->description),
+    units(prototype->units),
+    type(prototype->type),
+    elementNames(prototype->elementNames),
+    options(prototype->options),
+    numElements(prototype->numElements),
+    numBytesPerElement(prototype->numBytesPerElement),
+    offset(0),
+    compactType(prototype->compactType),
+    compactScale(prototype->compactScale),
+    data(NULL),
+    obj(NULL),
+    elementLimits(prototype->elementLimits)
+{}
+
 void UAVObjectField::constructorInitialize(const QString & name, const QString & description, const QString & units, FieldType type, const QStringList & elementNames, const QStringList & options, const QString &limits)
 {
     // Copy params
@@ -57,6 +79,8 @@ void UAVObjectField::constructorInitialize(const QString & name, const QString &
     this->options      = options;
     this->numElements  = elementNames.length();
     this->offset       = 0;
+    this->compactType  = type;
+    this->compactScale = 1.0;
     this->data         = NULL;
     this->obj = NULL;
     this->elementNames = elementNames;
@@ -187,6 +211,12 @@ void UAVObjectField::limitsInitialize(const QString &limits)
                         lstruc.values.append(QVariant());
                     }
                 }
+                foreach(QVariant value, lstruc.values) {
+                    double key;
+                    if (limitKey(value, key)) {
+                        lstruc.keys.append(key);
+                    }
+                }
                 limitList.append(lstruc);
             } else {
                 if (!valuesPerElement.at(0).isEmpty() && !startFlag) {
@@ -210,255 +240,116 @@ void UAVObjectField::limitsInitialize(const QString &limits)
     // }
     // }
 }
+/**
+ * Convert a value to the domain limits are compared in: integers and floats
+ * (rounded to float precision, as the field stores them) map to a double,
+ * enum values to their option index. Returns false for field types that
+ * are compared as strings.
+ */
+bool UAVObjectField::limitKey(const QVariant &var, double &key) const
+{
+    switch (type) {
+    case INT8:
+    case INT16:
+    case INT32:
+        key = var.toInt();
+        return true;
+
+    case UINT8:
+    case UINT16:
+    case UINT32:
+    case BITFIELD:
+        key = var.toUInt();
+        return true;
+
+    case FLOAT32:
+        key = var.toFloat();
+        return true;
+
+    case ENUM:
+        key = options.indexOf(var.toString());
+        return true;
+
+    default:
+        return false;
+    }
+}
+
 bool UAVObjectField::isWithinLimits(QVariant var, quint32 index, int board)
 {
-    if (!elementLimits.keys().contains(index)) {
+    QMap<quint32, QList<LimitStruct> >::const_iterator limits = elementLimits.constFind(index);
+
+    if (limits == elementLimits.constEnd()) {
         return true;
     }
 
-    foreach(LimitStruct struc, elementLimits.value(index)) {
+    double key;
+    bool numeric = limitKey(var, key);
+    // enum values unknown to the field can only match by name
+    if (type == ENUM && key < 0) {
+        numeric = false;
+    }
+
+    foreach(const LimitStruct &struc, limits.value()) {
         if ((struc.board != board) && board != 0 && struc.board != 0) {
             continue;
         }
         switch (struc.type) {
         case EQUAL:
-            switch (type) {
-            case INT8:
-            case INT16:
-            case INT32:
-                foreach(QVariant vars, struc.values) {
-                    if (var.toInt() == vars.toInt()) {
-                        return true;
-                    }
-                }
-                return false;
-
-                break;
-            case UINT8:
-            case UINT16:
-            case UINT32:
-            case BITFIELD:
-                foreach(QVariant vars, struc.values) {
-                    if (var.toUInt() == vars.toUInt()) {
-                        return true;
-                    }
-                }
-                return false;
-
-                break;
-            case ENUM:
-            case STRING:
-                foreach(QVariant vars, struc.values) {
-                    if (var.toString() == vars.toString()) {
-                        return true;
-                    }
-                }
-                return false;
-
-                break;
-            case FLOAT32:
-                foreach(QVariant vars, struc.values) {
-                    if (var.toFloat() == vars.toFloat()) {
-                        return true;
-                    }
-                }
-                return false;
-
-                break;
-            default:
-                return true;
-            }
-            break;
         case NOT_EQUAL:
-            switch (type) {
-            case INT8:
-            case INT16:
-            case INT32:
-                foreach(QVariant vars, struc.values) {
-                    if (var.toInt() == vars.toInt()) {
-                        return false;
-                    }
-                }
-                return true;
-
-                break;
-            case UINT8:
-            case UINT16:
-            case UINT32:
-            case BITFIELD:
-                foreach(QVariant vars, struc.values) {
-                    if (var.toUInt() == vars.toUInt()) {
-                        return false;
-                    }
-                }
-                return true;
-
-                break;
-            case ENUM:
-            case STRING:
-                foreach(QVariant vars, struc.values) {
-                    if (var.toString() == vars.toString()) {
-                        return false;
-                    }
-                }
-                return true;
-
-                break;
-            case FLOAT32:
-                foreach(QVariant vars, struc.values) {
-                    if (var.toFloat() == vars.toFloat()) {
-                        return false;
+        {
+            bool found = false;
+            if (numeric) {
+                found = struc.keys.contains(key);
+            } else if (type == ENUM || type == STRING) {
+                QString str = var.toString();
+                foreach(const QVariant &value, struc.values) {
+                    if (str == value.toString()) {
+                        found = true;
+                        break;
                     }
                 }
-                return true;
-
-                break;
-            default:
+            } else {
                 return true;
             }
-            break;
+            return (struc.type == EQUAL) ? found : !found;
+        }
         case BETWEEN:
-            if (struc.values.length() < 2) {
-                qDebug() << __FUNCTION__ << "between limit with less than 1 pair, aborting; field:" << name;
+            if (struc.keys.size() < 2) {
+                if (type != STRING) {
+                    qDebug() << __FUNCTION__ << "between limit with less than 1 pair, aborting; field:" << name;
+                }
                 return true;
             }
-            if (struc.values.length() > 2) {
+            if (struc.keys.size() > 2) {
                 qDebug() << __FUNCTION__ << "between limit with more than 1 pair, using first; field" << name;
             }
-            switch (type) {
-            case INT8:
-            case INT16:
-            case INT32:
-                if (!(var.toInt() >= struc.values.at(0).toInt() && var.toInt() <= struc.values.at(1).toInt())) {
-                    return false;
-                }
-                return true;
-
-                break;
-            case UINT8:
-            case UINT16:
-            case UINT32:
-            case BITFIELD:
-                if (!(var.toUInt() >= struc.values.at(0).toUInt() && var.toUInt() <= struc.values.at(1).toUInt())) {
-                    return false;
-                }
-                return true;
-
-                break;
-            case ENUM:
-                if (!(options.indexOf(var.toString()) >= options.indexOf(struc.values.at(0).toString()) && options.indexOf(var.toString()) <= options.indexOf(struc.values.at(1).toString()))) {
-                    return false;
-                }
-                return true;
-
-                break;
-            case STRING:
-                return true;
-
-                break;
-            case FLOAT32:
-                if (!(var.toFloat() >= struc.values.at(0).toFloat() && var.toFloat() <= struc.values.at(1).toFloat())) {
-                    return false;
-                }
-                return true;
-
-                break;
-            default:
+            if (!limitKey(var, key)) {
                 return true;
             }
-            break;
+            return key >= struc.keys.at(0) && key <= struc.keys.at(1);
+
         case BIGGER:
-            if (struc.values.length() < 1) {
-                qDebug() << __FUNCTION__ << "BIGGER limit with less than 1 value, aborting; field:" << name;
+            if (struc.keys.isEmpty()) {
+                if (type != STRING) {
+                    qDebug() << __FUNCTION__ << "BIGGER limit with less than 1 value, aborting; field:" << name;
+                }
                 return true;
             }
-            if (struc.values.length() > 1) {
+            if (struc.keys.size() > 1) {
                 qDebug() << __FUNCTION__ << "BIGGER limit with more than 1 value, using first; field" << name;
             }
-            switch (type) {
-            case INT8:
-            case INT16:
-            case INT32:
-                if (!(var.toInt() >= struc.values.at(0).toInt())) {
-                    return false;
-                }
-                return true;
-
-                break;
-            case UINT8:
-            case UINT16:
-            case UINT32:
-            case BITFIELD:
-                if (!(var.toUInt() >= struc.values.at(0).toUInt())) {
-                    return false;
-                }
-                return true;
-
-                break;
-            case ENUM:
-                if (!(options.indexOf(var.toString()) >= options.indexOf(struc.values.at(0).toString()))) {
-                    return false;
-                }
-                return true;
-
-                break;
-            case STRING:
-                return true;
-
-                break;
-            case FLOAT32:
-                if (!(var.toFloat() >= struc.values.at(0).toFloat())) {
-                    return false;
-                }
-                return true;
-
-                break;
-            default:
+            if (!limitKey(var, key)) {
                 return true;
             }
-            break;
-        case SMALLER:
-            switch (type) {
-            case INT8:
-            case INT16:
-            case INT32:
-                if (!(var.toInt() <= struc.values.at(0).toInt())) {
-                    return false;
-                }
-                return true;
-
-                break;
-            case UINT8:
-            case UINT16:
-            case UINT32:
-            case BITFIELD:
-                if (!(var.toUInt() <= struc.values.at(0).toUInt())) {
-                    return false;
-                }
-                return true;
+            return key >= struc.keys.at(0);
 
-                break;
-            case ENUM:
-                if (!(options.indexOf(var.toString()) <= options.indexOf(struc.values.at(0).toString()))) {
-                    return false;
-                }
-                return true;
-
-                break;
-            case STRING:
-                return true;
-
-                break;
-            case FLOAT32:
-                if (!(var.toFloat() <= struc.values.at(0).toFloat())) {
-                    return false;
-                }
-                return true;
-
-                break;
-            default:
+        case SMALLER:
+            if (struc.keys.isEmpty() || !limitKey(var, key)) {
                 return true;
             }
+            return key <= struc.keys.at(0);
+
         default:
             return true;
         }
@@ -470,8 +361,8 @@ QString UAVObjectField::getLimitsAsString(quint32 index, int board)
 {
     QString limitString;
 
-    if (elementLimits.keys().contains(index)) {
-        foreach(LimitStruct struc, elementLimits.value(index)) {
+    if (elementLimits.contains(index)) {
+        foreach(const LimitStruct &struc, elementLimits.value(index)) {
             if ((struc.board != board) && board != 0 && struc.board != 0) {
                 continue;
             }
@@ -520,10 +411,10 @@ QString UAVObjectField::getLimitsAsString(quint32 index, int board)
 
 QVariant UAVObjectField::getMaxLimit(quint32 index, int board)
 {
-    if (!elementLimits.keys().contains(index)) {
+    if (!elementLimits.contains(index)) {
         return QVariant();
     }
-    foreach(LimitStruct struc, elementLimits.value(index)) {
+    foreach(const LimitStruct &struc, elementLimits.value(index)) {
         if ((struc.board != board) && board != 0 && struc.board != 0) {
             continue;
         }
@@ -547,10 +438,10 @@ QVariant UAVObjectField::getMaxLimit(quint32 index, int board)
 }
 QVariant UAVObjectField::getMinLimit(quint32 index, int board)
 {
-    if (!elementLimits.keys().contains(index)) {
+    if (!elementLimits.contains(index)) {
         return QVariant();
     }
-    foreach(LimitStruct struc, elementLimits.value(index)) {
+    foreach(const LimitStruct &struc, elementLimits.value(index)) {
         if ((struc.board != board) && board != 0 && struc.board != 0) {
             return QVariant();
         }
@@ -677,6 +568,23 @@ quint32 UAVObjectField::getDataOffset()
     return offset;
 }
 
+/**
+ * Return a copy of the packed bytes backing one element. Bitfield and string
+ * elements share their storage, so for those the whole field is returned.
+ */
+QByteArray UAVObjectField::getRawElement(quint32 index)
+{
+    QMutexLocker locker(obj->getMutex());
+
+    if (index >= numElements) {
+        return QByteArray();
+    }
+    if (type == BITFIELD || type == STRING) {
+        return QByteArray((const char *)&data[offset], getNumBytes());
+    }
+    return QByteArray((const char *)&data[offset + numBytesPerElement * index], numBytesPerElement);
+}
+
 quint32 UAVObjectField::getNumBytes()
 {
     switch (type) {
@@ -766,6 +674,57 @@ void UAVObjectField::fromJson(const QJsonObject &jsonObject)
     }
 }
 
+/**
+ * Write the field straight from its data, numbers as JSON numbers
+ */
+void UAVObjectField::toJson(UAVObjectJsonWriter *writer)
+{
+    QMutexLocker locker(obj->getMutex());
+
+    writer->writeStartObject();
+    writer->writeString("name", name);
+    writer->writeString("type", getTypeAsString());
+    writer->writeString("unit", units);
+    writer->writeStartArray("values");
+    for (quint32 n = 0; n < numElements; ++n) {
+        writer->writeStartObject();
+        writer->writeString("name", elementNames.at(n));
+        switch (type) {
+        case INT8:
+            writer->writeInteger("value", getElement<qint8>(INT8, n));
+            break;
+        case INT16:
+            writer->writeInteger("value", getElement<qint16>(INT16, n));
+            break;
+        case INT32:
+            writer->writeInteger("value", getElement<qint32>(INT32, n));
+            break;
+        case UINT8:
+            writer->writeInteger("value", getElement<quint8>(UINT8, n));
+            break;
+        case UINT16:
+            writer->writeInteger("value", getElement<quint16>(UINT16, n));
+            break;
+        case UINT32:
+            writer->writeInteger("value", getElement<quint32>(UINT32, n));
+            break;
+        case FLOAT32:
+            writer->writeFloat("value", getElement<float>(FLOAT32, n));
+            break;
+        case BITFIELD:
+            writer->writeInteger("value", (data[offset + n / 8] >> (n % 8)) & 1);
+            break;
+        case ENUM:
+        case STRING:
+            writer->writeString("value", getValue(n).toString());
+            break;
+        }
+        writer->writeEndObject();
+    }
+    writer->writeEndArray();
+    writer->writeEndObject();
+}
+
 qint32 UAVObjectField::pack(quint8 *dataOut)
 {
     QMutexLocker locker(obj->getMutex());
@@ -900,6 +859,50 @@ qint32 UAVObjectField::unpack(const quint8 *dataIn)
     return getNumBytes();
 }
 
+/**
+ * Quantize a float field in the compact updates sent over the slow links
+ * @param compactType INT8 or INT16
+ * @param compactScale Value of one quantization step
+ */
+void UAVObjectField::setCompact(FieldType compactType, double compactScale)
+{
+    Q_ASSERT(type == FLOAT32 && (compactType == INT8 || compactType == INT16) && compactScale > 0.0);
+    this->compactType  = compactType;
+    this->compactScale = compactScale;
+}
+
+quint32 UAVObjectField::getCompactNumBytes()
+{
+    if (compactType == type) {
+        return getNumBytes();
+    }
+    return numElements * (compactType == INT8 ? sizeof(qint8) : sizeof(qint16));
+}
+
+/**
+ * Unpack the field from a compact update, the quantized elements are scaled back
+ * @returns The number of bytes used
+ */
+qint32 UAVObjectField::unpackCompact(const quint8 *dataIn)
+{
+    if (compactType == type) {
+        return unpack(dataIn);
+    }
+
+    QMutexLocker locker(obj->getMutex());
+
+    for (quint32 index = 0; index < numElements; ++index) {
+        float value;
+        if (compactType == INT8) {
+            value = (float)((qint8)dataIn[index] * compactScale);
+        } else {
+            value = (float)(qFromLittleEndian<qint16>(&dataIn[sizeof(qint16) * index]) * compactScale);
+        }
+        memcpy(&data[offset + numBytesPerElement * index], &value, numBytesPerElement);
+    }
+    return getCompactNumBytes();
+}
+
 bool UAVObjectField::isNumeric()
 {
     switch (type) {
@@ -1180,10 +1183,104 @@ void UAVObjectField::setValue(const QVariant & value, quint32 index)
 
 double UAVObjectField::getDouble(quint32 index)
 {
-    return getValue(index).toDouble();
+    switch (type) {
+    case INT8:
+        return getInt8(index);
+
+    case INT16:
+        return getInt16(index);
+
+    case INT32:
+        return getInt32(index);
+
+    case UINT8:
+        return getUInt8(index);
+
+    case UINT16:
+        return getUInt16(index);
+
+    case UINT32:
+        return getUInt32(index);
+
+    case FLOAT32:
+        return getFloat(index);
+
+    case BITFIELD:
+    {
+        QMutexLocker locker(obj->getMutex());
+        if (index >= numElements) {
+            return 0;
+        }
+        return (data[offset + numBytesPerElement * ((quint32)(index / 8))] >> (index % 8)) & 1;
+    }
+    default:
+        // Enums and strings keep their textual conversion
+        return getValue(index).toDouble();
+    }
 }
 
 void UAVObjectField::setDouble(double value, quint32 index)
 {
     setValue(QVariant(value), index);
 }
+
+/**
+ * Read one element straight from the object data, without going through
+ * a QVariant. Returns 0 if the index is out of bounds or the field is not
+ * of the expected type.
+ */
+template<typename T> T UAVObjectField::getElement(FieldType expectedType, quint32 index)
+{
+    QMutexLocker locker(obj->getMutex());
+
+    if (index >= numElements || type != expectedType) {
+        return 0;
+    }
+    T value;
+    memcpy(&value, &data[offset + numBytesPerElement * index], sizeof(T));
+    return value;
+}
+
+qint8 UAVObjectField::getInt8(quint32 index)
+{
+    return getElement<qint8>(INT8, index);
+}
+
+qint16 UAVObjectField::getInt16(quint32 index)
+{
+    return getElement<qint16>(INT16, index);
+}
+
+qint32 UAVObjectField::getInt32(quint32 index)
+{
+    return getElement<qint32>(INT32, index);
+}
+
+quint8 UAVObjectField::getUInt8(quint32 index)
+{
+    return getElement<quint8>(UINT8, index);
+}
+
+quint16 UAVObjectField::getUInt16(quint32 index)
+{
+    return getElement<quint16>(UINT16, index);
+}
+
+quint32 UAVObjectField::getUInt32(quint32 index)
+{
+    return getElement<quint32>(UINT32, index);
+}
+
+float UAVObjectField::getFloat(quint32 index)
+{
+    return getElement<float>(FLOAT32, index);
+}
+
+/**
+ * Get the raw option index of an enum element, avoiding the option
+ * string lookup done by getValue().
+ */
+quint8 UAVObjectField::getEnumIndex(quint32 index)
+{
+    return getElement<quint8>(ENUM, index);
+}
@@ -34,11 +34,13 @@
 #include <QVariant>
 #include <QList>
 #include <QMap>
+#include <QVector>
 #include <QXmlStreamWriter>
 #include <QXmlStreamReader>
 #include <QJsonObject>
 
 class UAVObject;
+class UAVObjectJsonWriter;
 
 class UAVOBJECTS_EXPORT UAVObjectField : public QObject {
     Q_OBJECT
@@ -49,11 +51,15 @@ public:
     typedef struct {
         LimitType type;
         QList<QVariant> values;
+        // values converted once to the comparison domain of the field type
+        // (option index for enums), see limitKey()
+        QVector<double> keys;
         int board;
     } LimitStruct;
 
     UAVObjectField(const QString & name, const QString & description, const QString & units, FieldType type, quint32 numElements, const QStringList & options, const QString & limits = QString());
     UAVObjectField(const QString & name, const QString & description, const QString & units, FieldType type, const QStringList & elementNames, const QStringList & options, const QString & limits = QString());
+    explicit UAVObjectField(const UAVObjectField *prototype);
     void initialize(quint8 *data, quint32 dataOffset, UAVObject *obj);
     UAVObject *getObject();
     FieldType getType();
@@ -66,13 +72,25 @@ public:
     QStringList getOptions();
     qint32 pack(quint8 *dataOut);
     qint32 unpack(const quint8 *dataIn);
+    void setCompact(FieldType compactType, double compactScale);
+    quint32 getCompactNumBytes();
+    qint32 unpackCompact(const quint8 *dataIn);
     QVariant getValue(quint32 index = 0);
     bool checkValue(const QVariant & data, quint32 index = 0);
     void setValue(const QVariant & data, quint32 index = 0);
     double getDouble(quint32 index = 0);
     void setDouble(double value, quint32 index = 0);
+    qint8 getInt8(quint32 index = 0);
+    qint16 getInt16(quint32 index = 0);
+    qint32 getInt32(quint32 index = 0);
+    quint8 getUInt8(quint32 index = 0);
+    quint16 getUInt16(quint32 index = 0);
+    quint32 getUInt32(quint32 index = 0);
+    float getFloat(quint32 index = 0);
+    quint8 getEnumIndex(quint32 index = 0);
     quint32 getDataOffset();
     quint32 getNumBytes();
+    QByteArray getRawElement(quint32 index = 0);
     bool isNumeric();
     bool isInteger();
     bool isText();
@@ -83,6 +101,7 @@ public:
 
     void toJson(QJsonObject &jsonObject);
     void fromJson(const QJsonObject &jsonObject);
+    void toJson(UAVObjectJsonWriter *writer);
 
     bool isWithinLimits(QVariant var, quint32 index, int board = 0);
     QString getLimitsAsString(quint32 index, int board = 0);
@@ -101,12 +120,17 @@ protected:
     quint32 numElements;
     quint32 numBytesPerElement;
     quint32 offset;
+    // representation in the compact updates, the field type when sent as is
+    FieldType compactType;
+    double compactScale;
     quint8 *data;
     UAVObject *obj;
     QMap<quint32, QList<LimitStruct> > elementLimits;
     void clear();
     void constructorInitialize(const QString & name, const QString & description, const QString & units, FieldType type, const QStringList & elementNames, const QStringList & options, const QString &limits);
     void limitsInitialize(const QString &limits);
+    bool limitKey(const QVariant &var, double &key) const;
+    template<typename T> T getElement(FieldType expectedType, quint32 index);
 };
 
 #endif // UAVOBJECTFIELD_H
@@ -0,0 +1,525 @@
+/**
+ ******************************************************************************
+ *
+ * @file       uavobjectjson.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @see        The GNU Public License (GPL) Version 3
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVObjectsPlugin UAVObjects Plugin
+ * @{
+ * @brief      The UAVUObjects GCS plugin
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "uavobjectjson.h"
+#include "uavobjectmanager.h"
+#include <QIODevice>
+#include <ctype.h>
+
+// The output is written to the device in chunks of about this size
+#define WRITE_BUFFER_SIZE 65536
+// and the input read in chunks of this size
+#define READ_BUFFER_SIZE  65536
+
+UAVObjectJsonWriter::UAVObjectJsonWriter(QIODevice *device) :
+    m_device(device), m_error(false)
+{
+    m_buffer.reserve(WRITE_BUFFER_SIZE + 1024);
+}
+
+UAVObjectJsonWriter::~UAVObjectJsonWriter()
+{
+    flush();
+}
+
+void UAVObjectJsonWriter::writeStartObject(const char *key)
+{
+    writeKey(key);
+    m_buffer.append('{');
+    m_hasMember.append(false);
+}
+
+void UAVObjectJsonWriter::writeEndObject()
+{
+    m_hasMember.removeLast();
+    m_buffer.append('}');
+    if (m_buffer.size() >= WRITE_BUFFER_SIZE) {
+        flush();
+    }
+}
+
+void UAVObjectJsonWriter::writeStartArray(const char *key)
+{
+    writeKey(key);
+    m_buffer.append('[');
+    m_hasMember.append(false);
+}
+
+void UAVObjectJsonWriter::writeEndArray()
+{
+    m_hasMember.removeLast();
+    m_buffer.append(']');
+}
+
+void UAVObjectJsonWriter::writeString(const char *key, const QString &value)
+{
+    writeKey(key);
+    writeQuoted(value);
+}
+
+void UAVObjectJsonWriter::writeBool(const char *key, bool value)
+{
+    writeKey(key);
+    m_buffer.append(value ? "true" : "false");
+}
+
+void UAVObjectJsonWriter::writeInteger(const char *key, qint64 value)
+{
+    writeKey(key);
+    m_buffer.append(QByteArray::number(value));
+}
+
+void UAVObjectJsonWriter::writeFloat(const char *key, float value)
+{
+    writeKey(key);
+    // 9 significant digits are enough to read the same float back
+    if (qIsFinite(value)) {
+        m_buffer.append(QByteArray::number(value, 'g', 9));
+    } else {
+        m_buffer.append("null");
+    }
+}
+
+bool UAVObjectJsonWriter::flush()
+{
+    if (!m_error && !m_buffer.isEmpty()) {
+        m_error = m_device->write(m_buffer) != m_buffer.size();
+    }
+    // Keeps the capacity
+    m_buffer.resize(0);
+    return !m_error;
+}
+
+void UAVObjectJsonWriter::writeKey(const char *key)
+{
+    if (!m_hasMember.isEmpty()) {
+        if (m_hasMember.last()) {
+            m_buffer.append(',');
+        }
+        m_hasMember.last() = true;
+    }
+    if (key) {
+        m_buffer.append('"').append(key).append("\":");
+    }
+}
+
+void UAVObjectJsonWriter::writeQuoted(const QString &value)
+{
+    static const char hex[] = "0123456789abcdef";
+    QByteArray utf8 = value.toUtf8();
+
+    m_buffer.append('"');
+    for (int i = 0; i < utf8.size(); i++) {
+        char c = utf8.at(i);
+        switch (c) {
+        case '"':
+            m_buffer.append("\\\"");
+            break;
+        case '\\':
+            m_buffer.append("\\\\");
+            break;
+        case '\n':
+            m_buffer.append("\\n");
+            break;
+        case '\r':
+            m_buffer.append("\\r");
+            break;
+        case '\t':
+            m_buffer.append("\\t");
+            break;
+        default:
+            if ((uchar)c < 0x20) {
+                m_buffer.append("\\u00").append(hex[(uchar)c >> 4]).append(hex[c & 0xf]);
+            } else {
+                m_buffer.append(c);
+            }
+            break;
+        }
+    }
+    m_buffer.append('"');
+}
+
+UAVObjectJsonReader::UAVObjectJsonReader(QIODevice *device) :
+    m_device(device), m_pos(0)
+{}
+
+/**
+ * Read the "objects" array and update the objects it holds, one at a time.
+ * The objects read before an error are updated.
+ */
+bool UAVObjectJsonReader::readObjects(UAVObjectManager *manager, QList<UAVObject *> *updatedObjects)
+{
+    if (!expect('{')) {
+        return false;
+    }
+    bool first = true;
+    QString key;
+    while (next('}', first)) {
+        if (!readKey(key)) {
+            return false;
+        }
+        if (key == "objects") {
+            if (!expect('[')) {
+                return false;
+            }
+            bool firstObject = true;
+            while (next(']', firstObject)) {
+                if (!readObject(manager, updatedObjects)) {
+                    return false;
+                }
+            }
+        } else if (!skipValue()) {
+            return false;
+        }
+    }
+    return m_errorString.isEmpty();
+}
+
+bool UAVObjectJsonReader::readObject(UAVObjectManager *manager, QList<UAVObject *> *updatedObjects)
+{
+    QString name;
+    int instance = 0;
+    QList<Field> fields;
+
+    if (!expect('{')) {
+        return false;
+    }
+    // The members can come in any order, the fields are kept until the object is known
+    bool first = true;
+    QString key;
+    while (next('}', first)) {
+        if (!readKey(key)) {
+            return false;
+        }
+        if (key == "name") {
+            if (!readString(name)) {
+                return false;
+            }
+        } else if (key == "instance") {
+            QVariant value;
+            if (!readScalar(value)) {
+                return false;
+            }
+            instance = value.toInt();
+        } else if (key == "fields") {
+            if (!expect('[')) {
+                return false;
+            }
+            bool firstField = true;
+            while (next(']', firstField)) {
+                fields.append(Field());
+                if (!readField(fields.last())) {
+                    return false;
+                }
+            }
+        } else if (!skipValue()) {
+            return false;
+        }
+    }
+    if (!m_errorString.isEmpty()) {
+        return false;
+    }
+
+    UAVObject *object = manager->getObject(name, instance);
+    if (object != NULL) {
+        foreach(const Field &field, fields) {
+            UAVObjectField *objectField = object->getField(field.name);
+
+            if (objectField != NULL) {
+                QStringList elementNames = objectField->getElementNames();
+                foreach(const Value &value, field.values) {
+                    int index = elementNames.indexOf(value.first);
+                    if (index >= 0) {
+                        objectField->setValue(value.second, index);
+                    }
+                }
+            }
+        }
+        object->updated();
+        if (updatedObjects != NULL) {
+            updatedObjects->append(object);
+        }
+    }
+    return true;
+}
+
+bool UAVObjectJsonReader::readField(Field &field)
+{
+    if (!expect('{')) {
+        return false;
+    }
+    bool first = true;
+    QString key;
+    while (next('}', first)) {
+        if (!readKey(key)) {
+            return false;
+        }
+        if (key == "name") {
+            if (!readString(field.name)) {
+                return false;
+            }
+        } else if (key == "values") {
+            if (!expect('[')) {
+                return false;
+            }
+            bool firstValue = true;
+            while (next(']', firstValue)) {
+                field.values.append(Value());
+                if (!readValue(field.values.last())) {
+                    return false;
+                }
+            }
+        } else if (!skipValue()) {
+            return false;
+        }
+    }
+    return m_errorString.isEmpty();
+}
+
+bool UAVObjectJsonReader::readValue(Value &value)
+{
+    if (!expect('{')) {
+        return false;
+    }
+    bool first = true;
+    QString key;
+    while (next('}', first)) {
+        if (!readKey(key)) {
+            return false;
+        }
+        if (key == "name") {
+            if (!readString(value.first)) {
+                return false;
+            }
+        } else if (key == "value") {
+            if (!readScalar(value.second)) {
+                return false;
+            }
+        } else if (!skipValue()) {
+            return false;
+        }
+    }
+    return m_errorString.isEmpty();
+}
+
+bool UAVObjectJsonReader::readString(QString &value)
+{
+    if (!expect('"')) {
+        return false;
+    }
+    QByteArray utf8;
+    for (;;) {
+        char c = getRaw();
+        if (c == '"') {
+            break;
+        } else if (c == 0) {
+            return fail("unterminated string");
+        } else if (c != '\\') {
+            utf8.append(c);
+            continue;
+        }
+        c = getRaw();
+        switch (c) {
+        case '"':
+        case '\\':
+        case '/':
+            utf8.append(c);
+            break;
+        case 'b':
+            utf8.append('\b');
+            break;
+        case 'f':
+            utf8.append('\f');
+            break;
+        case 'n':
+            utf8.append('\n');
+            break;
+        case 'r':
+            utf8.append('\r');
+            break;
+        case 't':
+            utf8.append('\t');
+            break;
+        case 'u':
+        {
+            QByteArray code;
+            for (int i = 0; i < 4; i++) {
+                code.append(getRaw());
+            }
+            bool ok;
+            ushort unicode = code.toUShort(&ok, 16);
+            if (!ok) {
+                return fail("invalid escape sequence");
+            }
+            utf8.append(QString(QChar(unicode)).toUtf8());
+            break;
+        }
+        default:
+            return fail("invalid escape sequence");
+        }
+    }
+    value = QString::fromUtf8(utf8);
+    return true;
+}
+
+/**
+ * Read a string, number, boolean or null value
+ */
+bool UAVObjectJsonReader::readScalar(QVariant &value)
+{
+    char c = peek();
+
+    if (c == '"') {
+        QString str;
+        if (!readString(str)) {
+            return false;
+        }
+        value = str;
+        return true;
+    }
+
+    QByteArray token;
+    while (c != 0 && c != ',' && c != '}' && c != ']' && !isspace((uchar)c)) {
+        token.append(getRaw());
+        c = peekRaw();
+    }
+    if (token == "true") {
+        value = true;
+    } else if (token == "false") {
+        value = false;
+    } else if (token == "null") {
+        value = QVariant();
+    } else {
+        bool ok;
+        value = token.toDouble(&ok);
+        if (!ok) {
+            return fail(QString("invalid value '%1'").arg(QString::fromLatin1(token)));
+        }
+    }
+    return true;
+}
+
+bool UAVObjectJsonReader::skipValue()
+{
+    char c = peek();
+
+    if (c == '{' || c == '[') {
+        char end = c == '{' ? '}' : ']';
+        get();
+        bool first = true;
+        while (next(end, first)) {
+            QString key;
+            if ((end == '}' && !readKey(key)) || !skipValue()) {
+                return false;
+            }
+        }
+        return m_errorString.isEmpty();
+    }
+    QVariant value;
+    return readScalar(value);
+}
+
+bool UAVObjectJsonReader::readKey(QString &key)
+{
+    return readString(key) && expect(':');
+}
+
+bool UAVObjectJsonReader::next(char end, bool &first)
+{
+    char c = peek();
+
+    if (c == end) {
+        get();
+        return false;
+    }
+    if (!first) {
+        if (c != ',') {
+            return fail(QString("expected ',' or '%1'").arg(end));
+        }
+        get();
+    }
+    first = false;
+    return true;
+}
+
+char UAVObjectJsonReader::peek()
+{
+    char c;
+
+    while (isspace((uchar)(c = peekRaw()))) {
+        m_pos++;
+    }
+    return c;
+}
+
+char UAVObjectJsonReader::get()
+{
+    char c = peek();
+
+    if (c != 0) {
+        m_pos++;
+    }
+    return c;
+}
+
+char UAVObjectJsonReader::peekRaw()
+{
+    if (m_pos >= m_buffer.size()) {
+        m_buffer = m_device->read(READ_BUFFER_SIZE);
+        m_pos    = 0;
+        if (m_buffer.isEmpty()) {
+            return 0;
+        }
+    }
+    return m_buffer.at(m_pos);
+}
+
+char UAVObjectJsonReader::getRaw()
+{
+    char c = peekRaw();
+
+    if (c != 0) {
+        m_pos++;
+    }
+    return c;
+}
+
+bool UAVObjectJsonReader::expect(char c)
+{
+    if (get() != c) {
+        return fail(QString("expected '%1'").arg(c));
+    }
+    return true;
+}
+
+bool UAVObjectJsonReader::fail(const QString &error)
+{
+    if (m_errorString.isEmpty()) {
+        m_errorString = QString("%1 at offset %2").arg(error).arg(m_device->pos() - m_buffer.size() + m_pos);
+    }
+    return false;
+}
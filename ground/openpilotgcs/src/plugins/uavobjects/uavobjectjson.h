@@ -0,0 +1,129 @@
+/**
+ ******************************************************************************
+ *
+ * @file       uavobjectjson.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @see        The GNU Public License (GPL) Version 3
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVObjectsPlugin UAVObjects Plugin
+ * @{
+ * @brief      The UAVUObjects GCS plugin
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef UAVOBJECTJSON_H
+#define UAVOBJECTJSON_H
+
+#include "uavobjects_global.h"
+#include <QByteArray>
+#include <QList>
+#include <QPair>
+#include <QString>
+#include <QVariant>
+#include <QVector>
+
+class QIODevice;
+class UAVObject;
+class UAVObjectManager;
+
+/**
+ * Writes JSON straight to a device, through a small buffer, instead of
+ * building a QJsonDocument of everything first. Values are written as
+ * they come, the commas between them are taken care of.
+ */
+class UAVOBJECTS_EXPORT UAVObjectJsonWriter {
+public:
+    explicit UAVObjectJsonWriter(QIODevice *device);
+    ~UAVObjectJsonWriter();
+
+    // key is only given for the members of an object
+    void writeStartObject(const char *key = 0);
+    void writeEndObject();
+    void writeStartArray(const char *key = 0);
+    void writeEndArray();
+
+    void writeString(const char *key, const QString &value);
+    void writeBool(const char *key, bool value);
+    void writeInteger(const char *key, qint64 value);
+    void writeFloat(const char *key, float value);
+
+    // Writes out what is still buffered, false if the device failed
+    bool flush();
+    bool hasError() const
+    {
+        return m_error;
+    }
+
+private:
+    void writeKey(const char *key);
+    void writeQuoted(const QString &value);
+
+    QIODevice *m_device;
+    QByteArray m_buffer;
+    // Whether the object or array at each level already has a member
+    QVector<bool> m_hasMember;
+    bool m_error;
+};
+
+/**
+ * Reads the objects exported with UAVObjectManager::toJson() from a device,
+ * one object at a time, and updates them as they are read.
+ */
+class UAVObjectJsonReader {
+public:
+    explicit UAVObjectJsonReader(QIODevice *device);
+
+    bool readObjects(UAVObjectManager *manager, QList<UAVObject *> *updatedObjects);
+    QString errorString() const
+    {
+        return m_errorString;
+    }
+
+private:
+    // Element name and value of a field, as read
+    typedef QPair<QString, QVariant> Value;
+    struct Field {
+        QString name;
+        QList<Value> values;
+    };
+
+    bool readObject(UAVObjectManager *manager, QList<UAVObject *> *updatedObjects);
+    bool readField(Field &field);
+    bool readValue(Value &value);
+
+    bool readString(QString &value);
+    bool readScalar(QVariant &value);
+    bool skipValue();
+    bool readKey(QString &key);
+    // Steps over the comma before the next member or element, false at the end of the object or array
+    bool next(char end, bool &first);
+
+    // Next character, after the white space for peek() and get(), 0 at the end of the input
+    char peek();
+    char get();
+    char peekRaw();
+    char getRaw();
+    bool expect(char c);
+    bool fail(const QString &error);
+
+    QIODevice *m_device;
+    QByteArray m_buffer;
+    int m_pos;
+    QString m_errorString;
+};
+
+#endif // UAVOBJECTJSON_H
@@ -26,6 +26,7 @@
  * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
  */
 #include "uavobjectmanager.h"
+#include "uavobjectjson.h"
 
 #include <QtWidgetsDepends>
 
@@ -35,6 +36,9 @@
 UAVObjectManager::UAVObjectManager()
 {
     mutex = new QMutex(QMutex::Recursive);
+
+    connect(&coalescingTimer, SIGNAL(timeout()), this, SLOT(flushCoalescedUpdates()));
+    coalescingTimer.start(DEFAULT_COALESCING_PERIOD);
 }
 
 UAVObjectManager::~UAVObjectManager()
@@ -50,57 +54,118 @@ UAVObjectManager::~UAVObjectManager()
  */
 bool UAVObjectManager::registerObject(UAVDataObject *obj)
 {
-    QMutexLocker locker(mutex);
+    QList<UAVObject *> newObjects;
+    QList<UAVObject *> newInstances;
+    bool registered;
+    {
+        QMutexLocker locker(mutex);
+        registered = registerObject(obj, newObjects, newInstances);
+    }
+    emitRegistered(newObjects, newInstances);
+    return registered;
+}
 
-    // Check if this object type is already in the list
-    for (int objidx = 0; objidx < objects.length(); ++objidx) {
-        // Check if the object ID is in the list
-        if (objects[objidx].length() > 0 && objects[objidx][0]->getObjID() == obj->getObjID()) {
-            // Check if this is a single instance object, if yes we can not add a new instance
-            if (obj->isSingleInstance()) {
-                return false;
-            }
-            // The object type has alredy been added, so now we need to initialize the new instance with the appropriate id
-            // There is a single metaobject for all object instances of this type, so no need to create a new one
-            // Get object type metaobject from existing instance
-            UAVDataObject *refObj = dynamic_cast<UAVDataObject *>(objects[objidx][0]);
-            if (refObj == NULL) {
-                return false;
+/**
+ * Register several newly created objects at once, see registerObject(UAVDataObject *).
+ * The object storage and indexes are grown once for the whole list and the newObject()
+ * and newInstance() signals are only emitted once all objects are registered.
+ * @returns The number of objects that were registered
+ */
+int UAVObjectManager::registerObjects(const QList<UAVDataObject *> &objs)
+{
+    QList<UAVObject *> newObjects;
+    QList<UAVObject *> newInstances;
+    int registered = 0;
+    {
+        QMutexLocker locker(mutex);
+        // Each new object type also brings its metaobject
+        int capacity = objects.length() + 2 * objs.length();
+        objects.reserve(capacity);
+        objectIndexById.reserve(capacity);
+        objectIndexByName.reserve(capacity);
+        newObjects.reserve(2 * objs.length());
+
+        foreach(UAVDataObject * obj, objs) {
+            if (registerObject(obj, newObjects, newInstances)) {
+                ++registered;
             }
-            UAVMetaObject *mobj = refObj->getMetaObject();
-            // If the instance ID is specified and not at the default value (0) then we need to make sure
-            // that there are no gaps in the instance list. If gaps are found then then additional instances
-            // will be created.
-            if ((obj->getInstID() > 0) && (obj->getInstID() < MAX_INSTANCES)) {
-                for (int instidx = 0; instidx < objects[objidx].length(); ++instidx) {
-                    if (objects[objidx][instidx]->getInstID() == obj->getInstID()) {
-                        // Instance conflict, do not add
-                        return false;
-                    }
-                }
-                // Check if there are any gaps between the requested instance ID and the ones in the list,
-                // if any then create the missing instances.
-                for (quint32 instidx = objects[objidx].length(); instidx < obj->getInstID(); ++instidx) {
-                    UAVDataObject *cobj = obj->clone(instidx);
-                    cobj->initialize(mobj);
-                    objects[objidx].append(cobj);
-                    getObject(cobj->getObjID())->emitNewInstance(cobj);
-                    emit newInstance(cobj);
+        }
+    }
+    emitRegistered(newObjects, newInstances);
+    return registered;
+}
+
+/**
+ * Notify the registration of new object types and instances.
+ * Must be called without holding the mutex.
+ */
+void UAVObjectManager::emitRegistered(const QList<UAVObject *> &newObjects, const QList<UAVObject *> &newInstances)
+{
+    foreach(UAVObject * obj, newObjects) {
+        emit newObject(obj);
+    }
+    foreach(UAVObject * obj, newInstances) {
+        UAVObject *firstInstance = getObject(obj->getObjID());
+        if (firstInstance) {
+            firstInstance->emitNewInstance(obj);
+        }
+        emit newInstance(obj);
+    }
+}
+
+/**
+ * Register an object, the new object types and instances are appended to
+ * newObjects and newInstances for notification once the mutex is released.
+ * The caller must hold the mutex.
+ */
+bool UAVObjectManager::registerObject(UAVDataObject *obj, QList<UAVObject *> &newObjects, QList<UAVObject *> &newInstances)
+{
+    // Check if this object type is already in the list
+    int objidx = findObjectIndex(NULL, obj->getObjID());
+
+    if (objidx >= 0) {
+        // Check if this is a single instance object, if yes we can not add a new instance
+        if (obj->isSingleInstance()) {
+            return false;
+        }
+        // The object type has alredy been added, so now we need to initialize the new instance with the appropriate id
+        // There is a single metaobject for all object instances of this type, so no need to create a new one
+        // Get object type metaobject from existing instance
+        UAVDataObject *refObj = dynamic_cast<UAVDataObject *>(objects[objidx][0]);
+        if (refObj == NULL) {
+            return false;
+        }
+        UAVMetaObject *mobj = refObj->getMetaObject();
+        // If the instance ID is specified and not at the default value (0) then we need to make sure
+        // that there are no gaps in the instance list. If gaps are found then then additional instances
+        // will be created.
+        if ((obj->getInstID() > 0) && (obj->getInstID() < MAX_INSTANCES)) {
+            for (int instidx = 0; instidx < objects[objidx].length(); ++instidx) {
+                if (objects[objidx][instidx]->getInstID() == obj->getInstID()) {
+                    // Instance conflict, do not add
+                    return false;
                 }
-                // Finally, initialize the actual object instance
-                obj->initialize(mobj);
-            } else if (obj->getInstID() == 0) {
-                // Assign the next available ID and initialize the object instance
-                obj->initialize(objects[objidx].length(), mobj);
-            } else {
-                return false;
             }
-            // Add the actual object instance in the list
-            objects[objidx].append(obj);
-            getObject(obj->getObjID())->emitNewInstance(obj);
-            emit newInstance(obj);
-            return true;
+            // Check if there are any gaps between the requested instance ID and the ones in the list,
+            // if any then create the missing instances.
+            for (quint32 instidx = objects[objidx].length(); instidx < obj->getInstID(); ++instidx) {
+                UAVDataObject *cobj = obj->clone(instidx);
+                cobj->initialize(mobj);
+                addInstance(objidx, cobj);
+                newInstances.append(cobj);
+            }
+            // Finally, initialize the actual object instance
+            obj->initialize(mobj);
+        } else if (obj->getInstID() == 0) {
+            // Assign the next available ID and initialize the object instance
+            obj->initialize(objects[objidx].length(), mobj);
+        } else {
+            return false;
         }
+        // Add the actual object instance in the list
+        addInstance(objidx, obj);
+        newInstances.append(obj);
+        return true;
     }
     // If this point is reached then this is the first time this object type (ID) is added in the list
     // create a new list of the instances, add in the object collection and create the object's metaobject
@@ -113,6 +178,8 @@ bool UAVObjectManager::registerObject(UAVDataObject *obj)
     // Add to list
     addObject(obj);
     addObject(mobj);
+    newObjects.append(obj);
+    newObjects.append(mobj);
     return true;
 }
 
@@ -122,7 +189,93 @@ void UAVObjectManager::addObject(UAVObject *obj)
     QList<UAVObject *> list;
     list.append(obj);
     objects.append(list);
-    emit newObject(obj);
+    objectIndexById.insert(obj->getObjID(), objects.length() - 1);
+    objectIndexByName.insert(obj->getName(), objects.length() - 1);
+    connect(obj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(coalesceUpdate(UAVObject *)), Qt::DirectConnection);
+}
+
+void UAVObjectManager::addInstance(int objidx, UAVObject *obj)
+{
+    objects[objidx].append(obj);
+    connect(obj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(coalesceUpdate(UAVObject *)), Qt::DirectConnection);
+}
+
+/**
+ * Find the position of an object type in the objects list, by name if one is given or by ID otherwise.
+ * The caller must hold the mutex.
+ * @returns The index in the objects list or -1 if not found
+ */
+int UAVObjectManager::findObjectIndex(const QString *name, quint32 objId) const
+{
+    if (name != NULL) {
+        return objectIndexByName.value(*name, -1);
+    }
+    return objectIndexById.value(objId, -1);
+}
+
+/**
+ * Find an instance of the object type at the given position in the objects list.
+ * Instances are registered without gaps so the instance ID is normally its position
+ * in the instance list, the list is only searched if that is not the case.
+ * The caller must hold the mutex.
+ * @returns The instance or NULL if not found
+ */
+UAVObject *UAVObjectManager::findInstance(int objidx, quint32 instId) const
+{
+    const QList<UAVObject *> &instances = objects.at(objidx);
+
+    if (instId < (quint32)instances.length() && instances.at(instId)->getInstID() == instId) {
+        return instances.at(instId);
+    }
+    for (int instidx = 0; instidx < instances.length(); ++instidx) {
+        if (instances.at(instidx)->getInstID() == instId) {
+            return instances.at(instidx);
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Get the period, in ms, at which the objectUpdatedCoalesced() signals are emitted.
+ */
+int UAVObjectManager::getCoalescingPeriod() const
+{
+    return coalescingTimer.interval();
+}
+
+/**
+ * Set the period, in ms, at which the objectUpdatedCoalesced() signals are emitted.
+ */
+void UAVObjectManager::setCoalescingPeriod(int periodMs)
+{
+    coalescingTimer.setInterval(periodMs);
+}
+
+/**
+ * Called (directly, possibly from the telemetry thread) on every object update.
+ * Only remembers that the object was updated if anything listens to its coalesced updates.
+ */
+void UAVObjectManager::coalesceUpdate(UAVObject *obj)
+{
+    if (obj->hasCoalescedReceivers()) {
+        QMutexLocker locker(&coalescedUpdatesMutex);
+        coalescedUpdates.insert(obj);
+    }
+}
+
+/**
+ * Emit one coalesced update for each object updated during the last period.
+ */
+void UAVObjectManager::flushCoalescedUpdates()
+{
+    QSet<UAVObject *> updates;
+    {
+        QMutexLocker locker(&coalescedUpdatesMutex);
+        updates.swap(coalescedUpdates);
+    }
+    foreach(UAVObject * obj, updates) {
+        obj->emitObjectUpdatedCoalesced();
+    }
 }
 
 /**
@@ -227,19 +380,10 @@ UAVObject *UAVObjectManager::getObject(const QString *name, quint32 objId, quint
 {
     QMutexLocker locker(mutex);
 
-    // Check if this object type is already in the list
-    for (int objidx = 0; objidx < objects.length(); ++objidx) {
-        // Check if the object ID is in the list
-        if (objects[objidx].length() > 0) {
-            if ((name != NULL && objects[objidx][0]->getName().compare(name) == 0) || (name == NULL && objects[objidx][0]->getObjID() == objId)) {
-                // Look for the requested instance ID
-                for (int instidx = 0; instidx < objects[objidx].length(); ++instidx) {
-                    if (objects[objidx][instidx]->getInstID() == instId) {
-                        return objects[objidx][instidx];
-                    }
-                }
-            }
-        }
+    int objidx = findObjectIndex(name, objId);
+
+    if (objidx >= 0) {
+        return findInstance(objidx, instId);
     }
     // qWarning("UAVObjectManager::getObject: Object not found.  Probably a bug or mismatched GCS/flight versions.");
     // If this point is reached then the requested object could not be found
@@ -269,14 +413,10 @@ QList<UAVObject *> UAVObjectManager::getObjectInstances(const QString *name, qui
 {
     QMutexLocker locker(mutex);
 
-    // Check if this object type is already in the list
-    for (int objidx = 0; objidx < objects.length(); ++objidx) {
-        // Check if the object ID is in the list
-        if (objects[objidx].length() > 0) {
-            if ((name != NULL && objects[objidx][0]->getName().compare(name) == 0) || (name == NULL && objects[objidx][0]->getObjID() == objId)) {
-                return objects[objidx];
-            }
-        }
+    int objidx = findObjectIndex(name, objId);
+
+    if (objidx >= 0) {
+        return objects[objidx];
     }
     // If this point is reached then the requested object could not be found
     return QList<UAVObject *>();
@@ -300,19 +440,7 @@ qint32 UAVObjectManager::getNumInstances(quint32 objId)
 
 void UAVObjectManager::toJson(QJsonObject &jsonObject, UAVObjectManager::JSON_EXPORT_OPTION what)
 {
-    QList<UAVObject *> objects;
-    QList< QList<UAVObject *> > allObjects = getObjects();
-    foreach(QList<UAVObject *> instances, allObjects) {
-        foreach(UAVObject * object, instances) {
-            if (what == JSON_EXPORT_ALL ||
-                (what == JSON_EXPORT_DATA && !object->isSettingsObject()) ||
-                (what == JSON_EXPORT_SETTINGS && object->isSettingsObject()) ||
-                (what == JSON_EXPORT_SETTINGS && object->isMetaDataObject())) {
-                objects << object;
-            }
-        }
-    }
-    toJson(jsonObject, objects);
+    toJson(jsonObject, getExportObjects(what));
 }
 
 void UAVObjectManager::toJson(QJsonObject &jsonObject, const QList<QString> &objectsToExport)
@@ -356,6 +484,66 @@ void UAVObjectManager::fromJson(const QJsonObject &jsonObject, QList<UAVObject *
     }
 }
 
+bool UAVObjectManager::toJson(QIODevice *device, UAVObjectManager::JSON_EXPORT_OPTION what)
+{
+    return toJson(device, getExportObjects(what));
+}
+
+/**
+ * Write the objects to the device as they are formatted, in the same
+ * format as toJson(QJsonObject &, ...) through QJsonDocument::toJson()
+ */
+bool UAVObjectManager::toJson(QIODevice *device, const QList<UAVObject *> &objectsToExport)
+{
+    UAVObjectJsonWriter writer(device);
+
+    writer.writeStartObject();
+    writer.writeStartArray("objects");
+    foreach(UAVObject * object, objectsToExport) {
+        object->toJson(&writer);
+        if (writer.hasError()) {
+            return false;
+        }
+    }
+    writer.writeEndArray();
+    writer.writeEndObject();
+    return writer.flush();
+}
+
+/**
+ * Read objects written by toJson() from the device and update them as they are read.
+ * The objects read before an error are updated.
+ */
+bool UAVObjectManager::fromJson(QIODevice *device, QList<UAVObject *> *updatedObjects, QString *errorString)
+{
+    UAVObjectJsonReader reader(device);
+
+    if (!reader.readObjects(this, updatedObjects)) {
+        if (errorString != NULL) {
+            *errorString = reader.errorString();
+        }
+        return false;
+    }
+    return true;
+}
+
+QList<UAVObject *> UAVObjectManager::getExportObjects(UAVObjectManager::JSON_EXPORT_OPTION what)
+{
+    QList<UAVObject *> objects;
+    QList< QList<UAVObject *> > allObjects = getObjects();
+    foreach(QList<UAVObject *> instances, allObjects) {
+        foreach(UAVObject * object, instances) {
+            if (what == JSON_EXPORT_ALL ||
+                (what == JSON_EXPORT_DATA && !object->isSettingsObject()) ||
+                (what == JSON_EXPORT_SETTINGS && object->isSettingsObject()) ||
+                (what == JSON_EXPORT_SETTINGS && object->isMetaDataObject())) {
+                objects << object;
+            }
+        }
+    }
+    return objects;
+}
+
 /**
  * Helper function for public getNumInstances
  */
@@ -363,14 +551,10 @@ qint32 UAVObjectManager::getNumInstances(const QString *name, quint32 objId)
 {
     QMutexLocker locker(mutex);
 
-    // Check if this object type is already in the list
-    for (int objidx = 0; objidx < objects.length(); ++objidx) {
-        // Check if the object ID is in the list
-        if (objects[objidx].length() > 0) {
-            if ((name != NULL && objects[objidx][0]->getName().compare(name) == 0) || (name == NULL && objects[objidx][0]->getObjID() == objId)) {
-                return objects[objidx].length();
-            }
-        }
+    int objidx = findObjectIndex(name, objId);
+
+    if (objidx >= 0) {
+        return objects[objidx].length();
     }
     // If this point is reached then the requested object could not be found
     return -1;
@@ -33,9 +33,13 @@
 #include "uavdataobject.h"
 #include "uavmetaobject.h"
 #include <QList>
+#include <QHash>
 #include <QMutex>
 #include <QMutexLocker>
+#include <QSet>
+#include <QTimer>
 #include <QJsonObject>
+#include <QIODevice>
 
 class UAVOBJECTS_EXPORT UAVObjectManager : public QObject {
     Q_OBJECT
@@ -46,6 +50,7 @@ public:
     ~UAVObjectManager();
 
     bool registerObject(UAVDataObject *obj);
+    int registerObjects(const QList<UAVDataObject *> &objs);
     QList< QList<UAVObject *> > getObjects();
     QList< QList<UAVDataObject *> > getDataObjects();
     QList< QList<UAVMetaObject *> > getMetaObjects();
@@ -56,25 +61,53 @@ public:
     qint32 getNumInstances(const QString & name);
     qint32 getNumInstances(quint32 objId);
 
+    int getCoalescingPeriod() const;
+    void setCoalescingPeriod(int periodMs);
+
     void toJson(QJsonObject &jsonObject, JSON_EXPORT_OPTION what = JSON_EXPORT_ALL);
     void toJson(QJsonObject &jsonObject, const QList<QString> &objectsToExport);
     void toJson(QJsonObject &jsonObject, const QList<UAVObject *> &objectsToExport);
     void fromJson(const QJsonObject &jsonObject, QList<UAVObject *> *updatedObjects = NULL);
 
+    // Streaming versions, for whole exports and imports without building the document in memory
+    bool toJson(QIODevice *device, JSON_EXPORT_OPTION what = JSON_EXPORT_ALL);
+    bool toJson(QIODevice *device, const QList<UAVObject *> &objectsToExport);
+    bool fromJson(QIODevice *device, QList<UAVObject *> *updatedObjects = NULL, QString *errorString = NULL);
+
 signals:
     void newObject(UAVObject *obj);
     void newInstance(UAVObject *obj);
 
+private slots:
+    void coalesceUpdate(UAVObject *obj);
+    void flushCoalescedUpdates();
+
 private:
     static const quint32 MAX_INSTANCES = 1000;
+    // Default coalescing period, about the display refresh rate
+    static const int DEFAULT_COALESCING_PERIOD = 33;
 
     QList< QList<UAVObject *> > objects;
+    // Position of each object type in the objects list, by ID and by name
+    QHash<quint32, int> objectIndexById;
+    QHash<QString, int> objectIndexByName;
     QMutex *mutex;
 
+    // Objects updated since the last coalesced notification
+    QSet<UAVObject *> coalescedUpdates;
+    QMutex coalescedUpdatesMutex;
+    QTimer coalescingTimer;
+
+    bool registerObject(UAVDataObject *obj, QList<UAVObject *> &newObjects, QList<UAVObject *> &newInstances);
+    void emitRegistered(const QList<UAVObject *> &newObjects, const QList<UAVObject *> &newInstances);
     void addObject(UAVObject *obj);
+    void addInstance(int objidx, UAVObject *obj);
+    int findObjectIndex(const QString *name, quint32 objId) const;
+    UAVObject *findInstance(int objidx, quint32 instId) const;
     UAVObject *getObject(const QString *name, quint32 objId, quint32 instId);
     QList<UAVObject *> getObjectInstances(const QString *name, quint32 objId);
     qint32 getNumInstances(const QString *name, quint32 objId);
+    QList<UAVObject *> getExportObjects(JSON_EXPORT_OPTION what);
 };
 
 
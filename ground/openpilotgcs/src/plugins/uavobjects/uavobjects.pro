@@ -13,6 +13,7 @@ HEADERS += \
     uavobjectmanager.h \
     uavdataobject.h \
     uavobjectfield.h \
+    uavobjectjson.h \
     uavobjectsinit.h \
     uavobjectsplugin.h
 SOURCES += \
@@ -21,6 +22,7 @@ SOURCES += \
     uavobjectmanager.cpp \
     uavdataobject.cpp \
     uavobjectfield.cpp \
+    uavobjectjson.cpp \
     uavobjectsplugin.cpp
 
 OTHER_FILES += UAVObjects.pluginspec
@@ -48,8 +50,11 @@ HEADERS += \
     $$UAVOBJECT_SYNTHETICS/revocalibration.h \
     $$UAVOBJECT_SYNTHETICS/revosettings.h \
     $$UAVOBJECT_SYNTHETICS/gcstelemetrystats.h \
+    $$UAVOBJECT_SYNTHETICS/timesync.h \
     $$UAVOBJECT_SYNTHETICS/gyrostate.h \
     $$UAVOBJECT_SYNTHETICS/gyrosensor.h \
+    $$UAVOBJECT_SYNTHETICS/gyrofiltersettings.h \
+    $$UAVOBJECT_SYNTHETICS/gyrospectrum.h \
     $$UAVOBJECT_SYNTHETICS/accelsensor.h \
     $$UAVOBJECT_SYNTHETICS/accelstate.h \
     $$UAVOBJECT_SYNTHETICS/magsensor.h \
@@ -57,8 +62,11 @@ HEADERS += \
     $$UAVOBJECT_SYNTHETICS/camerastabsettings.h \
     $$UAVOBJECT_SYNTHETICS/flighttelemetrystats.h \
     $$UAVOBJECT_SYNTHETICS/systemstats.h \
+    $$UAVOBJECT_SYNTHETICS/systemhealthsummary.h \
+    $$UAVOBJECT_SYNTHETICS/bootstats.h \
     $$UAVOBJECT_SYNTHETICS/systemalarms.h \
     $$UAVOBJECT_SYNTHETICS/objectpersistence.h \
+    $$UAVOBJECT_SYNTHETICS/settingsdigest.h \
     $$UAVOBJECT_SYNTHETICS/overosyncstats.h \
     $$UAVOBJECT_SYNTHETICS/overosyncsettings.h \
     $$UAVOBJECT_SYNTHETICS/systemsettings.h \
@@ -90,6 +98,7 @@ HEADERS += \
     $$UAVOBJECT_SYNTHETICS/homelocation.h \
     $$UAVOBJECT_SYNTHETICS/mixersettings.h \
     $$UAVOBJECT_SYNTHETICS/mixerstatus.h \
+    $$UAVOBJECT_SYNTHETICS/controllatency.h \
     $$UAVOBJECT_SYNTHETICS/velocitydesired.h \
     $$UAVOBJECT_SYNTHETICS/velocitystate.h \
     $$UAVOBJECT_SYNTHETICS/groundtruth.h \
@@ -102,6 +111,7 @@ HEADERS += \
     $$UAVOBJECT_SYNTHETICS/flightbatterysettings.h \
     $$UAVOBJECT_SYNTHETICS/taskinfo.h \
     $$UAVOBJECT_SYNTHETICS/callbackinfo.h \
+    $$UAVOBJECT_SYNTHETICS/callbacklatency.h \
     $$UAVOBJECT_SYNTHETICS/flightplanstatus.h \
     $$UAVOBJECT_SYNTHETICS/flightplansettings.h \
     $$UAVOBJECT_SYNTHETICS/flightplancontrol.h \
@@ -154,17 +164,23 @@ SOURCES += \
     $$UAVOBJECT_SYNTHETICS/revocalibration.cpp \
     $$UAVOBJECT_SYNTHETICS/revosettings.cpp \
     $$UAVOBJECT_SYNTHETICS/gcstelemetrystats.cpp \
+    $$UAVOBJECT_SYNTHETICS/timesync.cpp \
     $$UAVOBJECT_SYNTHETICS/accelsensor.cpp \
     $$UAVOBJECT_SYNTHETICS/accelstate.cpp \
     $$UAVOBJECT_SYNTHETICS/gyrostate.cpp \
     $$UAVOBJECT_SYNTHETICS/gyrosensor.cpp \
+    $$UAVOBJECT_SYNTHETICS/gyrofiltersettings.cpp \
+    $$UAVOBJECT_SYNTHETICS/gyrospectrum.cpp \
     $$UAVOBJECT_SYNTHETICS/magsensor.cpp \
     $$UAVOBJECT_SYNTHETICS/magstate.cpp \
     $$UAVOBJECT_SYNTHETICS/camerastabsettings.cpp \
     $$UAVOBJECT_SYNTHETICS/flighttelemetrystats.cpp \
     $$UAVOBJECT_SYNTHETICS/systemstats.cpp \
+    $$UAVOBJECT_SYNTHETICS/systemhealthsummary.cpp \
+    $$UAVOBJECT_SYNTHETICS/bootstats.cpp \
     $$UAVOBJECT_SYNTHETICS/systemalarms.cpp \
     $$UAVOBJECT_SYNTHETICS/objectpersistence.cpp \
+    $$UAVOBJECT_SYNTHETICS/settingsdigest.cpp \
     $$UAVOBJECT_SYNTHETICS/overosyncstats.cpp \
     $$UAVOBJECT_SYNTHETICS/overosyncsettings.cpp \
     $$UAVOBJECT_SYNTHETICS/systemsettings.cpp \
@@ -196,6 +212,7 @@ SOURCES += \
     $$UAVOBJECT_SYNTHETICS/homelocation.cpp \
     $$UAVOBJECT_SYNTHETICS/mixersettings.cpp \
     $$UAVOBJECT_SYNTHETICS/mixerstatus.cpp \
+    $$UAVOBJECT_SYNTHETICS/controllatency.cpp \
     $$UAVOBJECT_SYNTHETICS/velocitydesired.cpp \
     $$UAVOBJECT_SYNTHETICS/velocitystate.cpp \
     $$UAVOBJECT_SYNTHETICS/groundtruth.cpp \
@@ -208,6 +225,7 @@ SOURCES += \
     $$UAVOBJECT_SYNTHETICS/flightbatterysettings.cpp \
     $$UAVOBJECT_SYNTHETICS/taskinfo.cpp \
     $$UAVOBJECT_SYNTHETICS/callbackinfo.cpp \
+    $$UAVOBJECT_SYNTHETICS/callbacklatency.cpp \
     $$UAVOBJECT_SYNTHETICS/flightplanstatus.cpp \
     $$UAVOBJECT_SYNTHETICS/flightplansettings.cpp \
     $$UAVOBJECT_SYNTHETICS/flightplancontrol.cpp \
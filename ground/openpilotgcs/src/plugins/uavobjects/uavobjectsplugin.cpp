@@ -27,6 +27,8 @@
  */
 #include "uavobjectsplugin.h"
 #include "uavobjectsinit.h"
+#include <QElapsedTimer>
+#include <QDebug>
 
 UAVObjectsPlugin::UAVObjectsPlugin()
 {}
@@ -44,7 +46,10 @@ bool UAVObjectsPlugin::initialize(const QStringList & arguments, QString *errorS
 
     addAutoReleasedObject(objMngr);
     // Initialize UAVObjects
+    QElapsedTimer timer;
+    timer.start();
     UAVObjectsInitialize(objMngr);
+    qDebug() << "UAVObjectsPlugin - registered" << objMngr->getObjects().length() << "object types in" << timer.elapsed() << "ms";
     // Done
     Q_UNUSED(arguments);
     Q_UNUSED(errorString);
@@ -29,7 +29,7 @@
 #include <QTimer>
 
 AbstractUAVObjectHelper::AbstractUAVObjectHelper(QObject *parent) :
-    QObject(parent), m_transactionResult(false), m_transactionCompleted(false)
+    QObject(parent), m_transactionResult(false), m_transactionCompleted(false), m_completedCount(0), m_failed(false)
 {}
 
 AbstractUAVObjectHelper::~AbstractUAVObjectHelper()
@@ -76,6 +76,73 @@ AbstractUAVObjectHelper::Result AbstractUAVObjectHelper::doObjectAndWait(UAVObje
     }
 }
 
+AbstractUAVObjectHelper::Result AbstractUAVObjectHelper::doObjectsAndWait(const QList<UAVObject *> &objects, int window, int timeout)
+{
+    // Lock, we can't call this twice from different threads
+    QMutexLocker locker(&m_mutex);
+
+    m_inFlight.clear();
+    m_completedCount = 0;
+    m_failed = false;
+
+    QTimer timeoutTimer;
+    timeoutTimer.setSingleShot(true);
+    connect(&timeoutTimer, SIGNAL(timeout()), &m_eventLoop, SLOT(quit()));
+
+    Result result = SUCCESS;
+    int started   = 0;
+    while (started < objects.size() || !m_inFlight.isEmpty()) {
+        // Keep the window full
+        while (!m_failed && started < objects.size() && m_inFlight.size() < window) {
+            m_object = objects.at(started++);
+            m_inFlight.insert(m_object);
+            connect(m_object, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(windowTransactionCompleted(UAVObject *, bool)));
+            doObjectAndWaitImpl();
+        }
+        if (m_failed) {
+            break;
+        }
+        if (m_inFlight.isEmpty()) {
+            // All completed before returning
+            continue;
+        }
+
+        // Wait for the next completion
+        int completedCount = m_completedCount;
+        timeoutTimer.start(timeout);
+        m_eventLoop.exec();
+        timeoutTimer.stop();
+        if (m_completedCount == completedCount) {
+            result = TIMEOUT;
+            break;
+        }
+    }
+    if (m_failed) {
+        result = FAIL;
+    }
+
+    // Disconnect, the transactions still in flight after a failure are not waited for
+    for (int i = 0; i < started; ++i) {
+        disconnect(objects.at(i), SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(windowTransactionCompleted(UAVObject *, bool)));
+    }
+    disconnect(&timeoutTimer, SIGNAL(timeout()), &m_eventLoop, SLOT(quit()));
+    m_inFlight.clear();
+
+    return result;
+}
+
+void AbstractUAVObjectHelper::windowTransactionCompleted(UAVObject *object, bool success)
+{
+    if (m_inFlight.remove(object)) {
+        ++m_completedCount;
+        if (!success) {
+            m_failed = true;
+        }
+        emit objectsCompleted(m_completedCount);
+        m_eventLoop.quit();
+    }
+}
+
 void AbstractUAVObjectHelper::transactionCompleted(UAVObject *object, bool success)
 {
     Q_UNUSED(object)
@@ -32,6 +32,7 @@
 #include <QEventLoop>
 #include <QMutex>
 #include <QMutexLocker>
+#include <QSet>
 
 #include "uavobjectutil_global.h"
 #include "uavobject.h"
@@ -48,18 +49,33 @@ public:
     // where 3 is the number of UAVTalk retries and 250ms is the UAVTalk timeout
     Result doObjectAndWait(UAVObject *object, int timeout = 800);
 
+    // Runs the transactions of all the objects (instances), window of them at a time instead of
+    // waiting for each one to complete before starting the next. Stops at the first failure, the
+    // timeout applies to the wait for each completion.
+    Result doObjectsAndWait(const QList<UAVObject *> &objects, int window = 8, int timeout = 800);
+
+signals:
+    // Number of objects done so far by doObjectsAndWait()
+    void objectsCompleted(int count);
+
 protected:
     virtual void doObjectAndWaitImpl() = 0;
     UAVObject *m_object;
 
 private slots:
     void transactionCompleted(UAVObject *object, bool success);
+    void windowTransactionCompleted(UAVObject *object, bool success);
 
 private:
     QMutex m_mutex;
     QEventLoop m_eventLoop;
     bool m_transactionResult;
     bool m_transactionCompleted;
+
+    // Transactions started by doObjectsAndWait() and not completed yet
+    QSet<UAVObject *> m_inFlight;
+    int m_completedCount;
+    bool m_failed;
 };
 
 class UAVOBJECTUTIL_EXPORT UAVObjectUpdaterHelper : public AbstractUAVObjectHelper {
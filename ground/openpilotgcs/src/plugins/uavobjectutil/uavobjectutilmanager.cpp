@@ -47,6 +47,10 @@ UAVObjectUtilManager::UAVObjectUtilManager()
 {
     mutex     = new QMutex(QMutex::Recursive);
     saveState = IDLE;
+    saveBatchLength = 0;
+    singleSaveCount = 0;
+    saveDone  = 0;
+    saveTotal = 0;
     failureTimer.stop();
     failureTimer.setSingleShot(true);
     failureTimer.setInterval(1000);
@@ -95,41 +99,61 @@ void UAVObjectUtilManager::saveObjectToSD(UAVObject *obj)
 {
     // Add to queue
     queue.enqueue(obj);
+    saveTotal++;
     qDebug() << "Enqueue object: " << obj->getName();
 
 
-    // If queue length is one, then start sending (call sendNextObject)
+    // If queue length is one, start sending from the event loop so that the
+    // objects queued by the caller in the meantime go in the same request.
     // Otherwise, do nothing, it's sending anyway
     if (queue.length() == 1) {
-        saveNextObject();
+        QTimer::singleShot(0, this, SLOT(saveNextObject()));
     }
 }
 
+/*
+   Send the next save request to the board. Up to ObjectPersistence::OBJECTIDLIST_NUMELEM
+   queued objects are saved with one request, the board writes them in one flash batch.
+ */
 void UAVObjectUtilManager::saveNextObject()
 {
-    if (queue.isEmpty()) {
+    if (queue.isEmpty() || saveState != IDLE) {
         return;
     }
 
-    Q_ASSERT(saveState == IDLE);
+    ObjectPersistence *objper = dynamic_cast<ObjectPersistence *>(getObjectManager()->getObject(ObjectPersistence::NAME));
+    ObjectPersistence::DataFields data = objper->getData();
 
-    // Get next object from the queue
-    UAVObject *obj = queue.head();
-    qDebug() << "Send save object request to board " << obj->getName();
+    if (singleSaveCount > 0) {
+        saveBatchLength = 1;
+    } else {
+        saveBatchLength = qMin(queue.length(), (int)ObjectPersistence::OBJECTIDLIST_NUMELEM);
+    }
+    data.Operation = ObjectPersistence::OPERATION_SAVE;
+    if (saveBatchLength == 1) {
+        UAVObject *obj = queue.head();
+        qDebug() << "Send save object request to board " << obj->getName();
+        data.Selection   = ObjectPersistence::SELECTION_SINGLEOBJECT;
+        data.ObjectID    = obj->getObjID();
+        data.InstanceID  = obj->getInstID();
+        data.ObjectCount = 0;
+    } else {
+        qDebug() << "Send save request for" << saveBatchLength << "objects to board";
+        data.Selection   = ObjectPersistence::SELECTION_OBJECTLIST;
+        data.ObjectID    = 0;
+        data.InstanceID  = 0;
+        data.ObjectCount = saveBatchLength;
+        for (int i = 0; i < saveBatchLength; ++i) {
+            data.ObjectIDList[i]   = queue.at(i)->getObjID();
+            data.InstanceIDList[i] = queue.at(i)->getInstID();
+        }
+    }
 
-    ObjectPersistence *objper = dynamic_cast<ObjectPersistence *>(getObjectManager()->getObject(ObjectPersistence::NAME));
     connect(objper, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(objectPersistenceTransactionCompleted(UAVObject *, bool)));
     connect(objper, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(objectPersistenceUpdated(UAVObject *)));
     saveState = AWAITING_ACK;
-    if (obj != NULL) {
-        ObjectPersistence::DataFields data;
-        data.Operation  = ObjectPersistence::OPERATION_SAVE;
-        data.Selection  = ObjectPersistence::SELECTION_SINGLEOBJECT;
-        data.ObjectID   = obj->getObjID();
-        data.InstanceID = obj->getInstID();
-        objper->setData(data);
-        objper->updated();
-    }
+    objper->setData(data);
+    objper->updated();
     // Now: we are going to get two "objectUpdated" messages (one coming from GCS, one coming from Flight, which
     // will confirm the object was properly received by both sides) and then one "transactionCompleted" indicating
     // that the Flight side did not only receive the object but it did receive it without error. Last we will get
@@ -137,12 +161,60 @@ void UAVObjectUtilManager::saveNextObject()
     // operation we asked for (saved, other).
 }
 
+/**
+ * @brief Dequeue the objects of the request just answered and send the next request
+ * @param[in] success Indicates that the board saved the objects
+ *
+ * When a request for several objects fails they are sent again one by one, so that
+ * one object the board does not know does not fail the others.
+ */
+void UAVObjectUtilManager::saveBatchFinished(bool success)
+{
+    ObjectPersistence *objectPersistence = ObjectPersistence::GetInstance(getObjectManager());
+
+    Q_ASSERT(objectPersistence);
+    objectPersistence->disconnect(this);
+    failureTimer.stop();
+    saveState = IDLE;
+
+    if (!success && saveBatchLength > 1) {
+        qDebug() << "Save request for" << saveBatchLength << "objects failed, saving them one by one";
+        singleSaveCount = saveBatchLength;
+        saveBatchLength = 0;
+        saveNextObject();
+        return;
+    }
+
+    QList<UAVObject *> saved;
+    for (int i = 0; i < saveBatchLength; ++i) {
+        saved.append(queue.dequeue());
+    }
+    if (singleSaveCount > 0) {
+        singleSaveCount--;
+    }
+    saveBatchLength = 0;
+    saveDone += saved.length();
+    int done  = saveDone;
+    int total = saveTotal;
+    if (queue.isEmpty()) {
+        saveDone  = 0;
+        saveTotal = 0;
+    }
+
+    foreach(UAVObject * obj, saved) {
+        emit saveCompleted(obj->getObjID(), success);
+    }
+    emit saveProgress(done, total);
+
+    saveNextObject();
+}
+
 /**
  * @brief Process the transactionCompleted message from Telemetry indicating request sent successfully
  * @param[in] The object just transsacted.  Must be ObjectPersistance
  * @param[in] success Indicates that the transaction did not time out
  *
- * After a failed transaction (usually timeout) resends the save request.  After a succesful
+ * After a failed transaction (usually timeout) fails the objects of the request.  After a succesful
  * transaction will then wait for a save completed update from the autopilot.
  */
 void UAVObjectUtilManager::objectPersistenceTransactionCompleted(UAVObject *obj, bool success)
@@ -154,20 +226,15 @@ void UAVObjectUtilManager::objectPersistenceTransactionCompleted(UAVObject *obj,
         // Either the Object Save Request did actually go through, and then we should get in
         // "AWAITING_COMPLETED" mode, or the Object Save Request did _not_ go through, for example
         // because the object does not exist and then we will never get a subsequent update.
-        // For this reason, we will arm a 1 second timer to make provision for this and not block
-        // the queue:
+        // For this reason, we will arm a timer to make provision for this and not block
+        // the queue, the board verifies each saved object before answering:
         saveState = AWAITING_COMPLETED;
         disconnect(obj, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(objectPersistenceTransactionCompleted(UAVObject *, bool)));
-        failureTimer.start(2000); // Create a timeout
+        failureTimer.start(2000 + 250 * (saveBatchLength - 1)); // Create a timeout
     } else {
         // Can be caused by timeout errors on sending.  Forget it and send next.
         qDebug() << "objectPersistenceTranscationCompleted (error)";
-        UAVObject *obj = getObjectManager()->getObject(ObjectPersistence::NAME);
-        obj->disconnect(this);
-        queue.dequeue(); // We can now remove the object, it failed anyway.
-        saveState = IDLE;
-        emit saveCompleted(obj->getField("ObjectID")->getValue().toInt(), false);
-        saveNextObject();
+        saveBatchFinished(false);
     }
 }
 
@@ -179,28 +246,14 @@ void UAVObjectUtilManager::objectPersistenceOperationFailed()
 {
     if (saveState == AWAITING_COMPLETED) {
         // TODO: some warning that this operation failed somehow
-        // We have to disconnect the object persistence 'updated' signal
-        // and ask to save the next object:
-
-        ObjectPersistence *objectPersistence = ObjectPersistence::GetInstance(getObjectManager());
-        Q_ASSERT(objectPersistence);
-
-        UAVObject *obj = queue.dequeue(); // We can now remove the object, it failed anyway.
-        Q_ASSERT(obj);
-
-        objectPersistence->disconnect(this);
-
-        saveState = IDLE;
-        emit saveCompleted(obj->getObjID(), false);
-
-        saveNextObject();
+        saveBatchFinished(false);
     }
 }
 
 
 /**
- * @brief Process the ObjectPersistence updated message to confirm the right object saved
- * then requests next object be saved.
+ * @brief Process the ObjectPersistence updated message to confirm the right objects saved
+ * then requests next objects be saved.
  * @param[in] The object just received.  Must be ObjectPersistance
  */
 void UAVObjectUtilManager::objectPersistenceUpdated(UAVObject *obj)
@@ -210,24 +263,22 @@ void UAVObjectUtilManager::objectPersistenceUpdated(UAVObject *obj)
     ObjectPersistence::DataFields objectPersistence = ((ObjectPersistence *)obj)->getData();
 
     if (saveState == AWAITING_COMPLETED && objectPersistence.Operation == ObjectPersistence::OPERATION_ERROR) {
-        failureTimer.stop();
-        objectPersistenceOperationFailed();
+        saveBatchFinished(false);
     } else if (saveState == AWAITING_COMPLETED &&
                objectPersistence.Operation == ObjectPersistence::OPERATION_COMPLETED) {
-        failureTimer.stop();
-        // Check right object saved
-        UAVObject *savingObj = queue.head();
-        if (objectPersistence.ObjectID != savingObj->getObjID()) {
-            objectPersistenceOperationFailed();
-            return;
+        // Check right objects saved
+        bool match;
+        if (saveBatchLength == 1) {
+            match = objectPersistence.Selection == ObjectPersistence::SELECTION_SINGLEOBJECT &&
+                    objectPersistence.ObjectID == queue.head()->getObjID();
+        } else {
+            match = objectPersistence.Selection == ObjectPersistence::SELECTION_OBJECTLIST &&
+                    objectPersistence.ObjectCount == saveBatchLength;
+            for (int i = 0; match && i < saveBatchLength; ++i) {
+                match = objectPersistence.ObjectIDList[i] == queue.at(i)->getObjID();
+            }
         }
-
-        obj->disconnect(this);
-        queue.dequeue(); // We can now remove the object, it's done.
-        saveState = IDLE;
-
-        emit saveCompleted(objectPersistence.ObjectID, true);
-        saveNextObject();
+        saveBatchFinished(match);
     }
 }
 
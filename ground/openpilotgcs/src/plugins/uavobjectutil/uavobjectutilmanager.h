@@ -72,12 +72,18 @@ protected:
 
 signals:
     void saveCompleted(int objectID, bool status);
+    void saveProgress(int done, int total);
 
 private:
     QMutex *mutex;
+    // Objects to save, the first saveBatchLength ones are being saved
     QQueue<UAVObject *> queue;
     enum { IDLE, AWAITING_ACK, AWAITING_COMPLETED } saveState;
-    void saveNextObject();
+    int saveBatchLength;
+    int singleSaveCount;
+    int saveDone;
+    int saveTotal;
+    void saveBatchFinished(bool success);
     QTimer failureTimer;
 
     ExtensionSystem::PluginManager *pm;
@@ -85,6 +91,7 @@ private:
     UAVObjectUtilManager *obum;
 
 private slots:
+    void saveNextObject();
     // void transactionCompleted(UAVObject *obj, bool success);
     void objectPersistenceTransactionCompleted(UAVObject *obj, bool success);
     void objectPersistenceUpdated(UAVObject *obj);
@@ -181,6 +181,7 @@ void ConfigTaskWidget::setWidgetBindingObjectEnabled(QString objectName, bool en
 
     foreach(WidgetBinding * binding, m_widgetBindingsPerObject.values(object)) {
         binding->setIsEnabled(enabled);
+        binding->invalidateFieldSnapshot();
         if (enabled) {
             if (binding->value().isValid() && !binding->value().isNull()) {
                 setWidgetFromVariant(binding->widget(), binding->value(), binding);
@@ -280,6 +281,7 @@ void ConfigTaskWidget::populateWidgets()
     foreach(WidgetBinding * binding, m_widgetBindingsPerObject) {
         if (binding->isEnabled() && binding->object() != NULL && binding->field() != NULL && binding->widget() != NULL) {
             setWidgetFromField(binding->widget(), binding->field(), binding);
+            binding->updateFieldSnapshot();
         }
     }
     setDirty(dirtyBack);
@@ -296,11 +298,16 @@ void ConfigTaskWidget::refreshWidgetsValues(UAVObject *obj)
     QList<WidgetBinding *> bindings = obj == NULL ? m_widgetBindingsPerObject.values() : m_widgetBindingsPerObject.values(obj);
     foreach(WidgetBinding * binding, bindings) {
         if (binding->field() != NULL && binding->widget() != NULL) {
+            // On object updates only touch widgets whose element changed
+            if (obj != NULL && !binding->isFieldChanged()) {
+                continue;
+            }
             if (binding->isEnabled()) {
                 setWidgetFromField(binding->widget(), binding->field(), binding);
             } else {
                 binding->updateValueFromObjectField();
             }
+            binding->updateFieldSnapshot();
         }
     }
     setDirty(dirtyBack);
@@ -405,6 +412,10 @@ void ConfigTaskWidget::widgetsContentsChanged()
     QVariant value;
 
     foreach(WidgetBinding * binding, m_widgetBindingsPerWidget.values(emitter)) {
+        if (binding) {
+            // The widget no longer shows the object value
+            binding->invalidateFieldSnapshot();
+        }
         if (binding && binding->isEnabled()) {
             if (binding->widget() == emitter) {
                 value = getVariantFromWidget(emitter, binding);
@@ -734,6 +745,7 @@ void ConfigTaskWidget::defaultButtonClicked()
         }
         UAVDataObject *temp = ((UAVDataObject *)binding->object())->dirtyClone();
         setWidgetFromField(binding->widget(), temp->getField(binding->field()->getName()), binding);
+        binding->invalidateFieldSnapshot();
     }
 }
 
@@ -777,6 +789,7 @@ void ConfigTaskWidget::reloadButtonClicked()
                 binding->object()->requestUpdate();
                 if (binding->widget()) {
                     setWidgetFromField(binding->widget(), binding->field(), binding);
+                    binding->invalidateFieldSnapshot();
                 }
             }
             m_realtimeUpdateTimer->stop();
@@ -1218,6 +1231,26 @@ void WidgetBinding::updateValueFromObjectField()
     }
 }
 
+bool WidgetBinding::isFieldChanged() const
+{
+    if (!m_field || m_fieldSnapshot.isEmpty()) {
+        return true;
+    }
+    return m_field->getRawElement(m_index) != m_fieldSnapshot;
+}
+
+void WidgetBinding::updateFieldSnapshot()
+{
+    if (m_field) {
+        m_fieldSnapshot = m_field->getRawElement(m_index);
+    }
+}
+
+void WidgetBinding::invalidateFieldSnapshot()
+{
+    m_fieldSnapshot.clear();
+}
+
 ShadowWidgetBinding::ShadowWidgetBinding(QWidget *widget, double scale, bool isLimited)
 {
     m_widget    = widget;
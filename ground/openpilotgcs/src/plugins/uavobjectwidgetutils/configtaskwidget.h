@@ -88,6 +88,10 @@ public:
     void updateObjectFieldFromValue();
     void updateValueFromObjectField();
 
+    bool isFieldChanged() const;
+    void updateFieldSnapshot();
+    void invalidateFieldSnapshot();
+
 private:
     UAVObject *m_object;
     UAVObjectField *m_field;
@@ -95,6 +99,8 @@ private:
     bool m_isEnabled;
     QList<ShadowWidgetBinding *> m_shadows;
     QVariant m_value;
+    // Raw field element as last rendered into the widget, empty when unknown
+    QByteArray m_fieldSnapshot;
 };
 
 class UAVOBJECTWIDGETUTILS_EXPORT ConfigTaskWidget : public QWidget {
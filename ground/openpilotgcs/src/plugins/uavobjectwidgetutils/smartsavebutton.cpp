@@ -75,6 +75,7 @@ void SmartSaveButton::processOperation(QPushButton *button, bool save)
     bool error = false;
     ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
     UAVObjectUtilManager *utilMngr     = pm->getObject<UAVObjectUtilManager>();
+    QList<UAVDataObject *> toSave;
     foreach(UAVDataObject * obj, objects) {
         UAVObject::Metadata mdata = obj->getMetadata();
 
@@ -112,34 +113,51 @@ void SmartSaveButton::processOperation(QPushButton *button, bool save)
             continue;
         }
 
-        sv_result = false;
-        current_objectID = obj->getObjID();
         if (save && (obj->isSettingsObject())) {
-            for (int i = 0; i < 3; ++i) {
-                qDebug() << "Saving" << obj->getName() << "to board.";
-                connect(utilMngr, SIGNAL(saveCompleted(int, bool)), this, SLOT(saving_finished(int, bool)));
-                connect(&timer, SIGNAL(timeout()), &loop, SLOT(quit()));
-                utilMngr->saveObjectToSD(obj);
-
-                timer.start(3000);
-                loop.exec();
-                if (!timer.isActive()) {
-                    qDebug() << "Saving of" << obj->getName() << "timed out.";
-                }
-                timer.stop();
-
-                disconnect(utilMngr, SIGNAL(saveCompleted(int, bool)), this, SLOT(saving_finished(int, bool)));
-                disconnect(&timer, SIGNAL(timeout()), &loop, SLOT(quit()));
-                if (sv_result) {
-                    qDebug() << "Saving of" << obj->getName() << "successful.";
-                    break;
-                }
-            }
-            if (sv_result == false) {
-                qDebug() << "Saving of" << obj->getName() << "failed after 3 tries.";
-                error = true;
+            toSave.append(obj);
+        }
+    }
+
+    // Queue all the saves at once, the board saves them in batches. The timeout
+    // restarts each time some of them complete.
+    for (int i = 0; i < 3 && !toSave.isEmpty(); ++i) {
+        qDebug() << "Saving" << toSave.length() << "objects to board.";
+        pending_saves.clear();
+        saved_objects.clear();
+        foreach(UAVDataObject * obj, toSave) {
+            pending_saves.insert(obj->getObjID());
+        }
+        connect(utilMngr, SIGNAL(saveCompleted(int, bool)), this, SLOT(saving_finished(int, bool)));
+        connect(utilMngr, SIGNAL(saveProgress(int, int)), &timer, SLOT(start()));
+        connect(&timer, SIGNAL(timeout()), &loop, SLOT(quit()));
+        foreach(UAVDataObject * obj, toSave) {
+            utilMngr->saveObjectToSD(obj);
+        }
+
+        timer.start(3000);
+        loop.exec();
+        if (!timer.isActive()) {
+            qDebug() << "Saving timed out.";
+        }
+        timer.stop();
+
+        disconnect(utilMngr, SIGNAL(saveCompleted(int, bool)), this, SLOT(saving_finished(int, bool)));
+        disconnect(utilMngr, SIGNAL(saveProgress(int, int)), &timer, SLOT(start()));
+        disconnect(&timer, SIGNAL(timeout()), &loop, SLOT(quit()));
+
+        QList<UAVDataObject *> failed;
+        foreach(UAVDataObject * obj, toSave) {
+            if (saved_objects.contains(obj->getObjID())) {
+                qDebug() << "Saving of" << obj->getName() << "successful.";
+            } else {
+                failed.append(obj);
             }
         }
+        toSave = failed;
+    }
+    foreach(UAVDataObject * obj, toSave) {
+        qDebug() << "Saving of" << obj->getName() << "failed after 3 tries.";
+        error = true;
     }
     if (button) {
         button->setEnabled(true);
@@ -193,9 +211,13 @@ void SmartSaveButton::transaction_finished(UAVObject *obj, bool result)
 
 void SmartSaveButton::saving_finished(int id, bool result)
 {
-    if (id == (int)current_objectID) {
-        sv_result = result;
-        loop.quit();
+    if (pending_saves.remove((quint32)id)) {
+        if (result) {
+            saved_objects.insert((quint32)id);
+        }
+        if (pending_saves.isEmpty()) {
+            loop.quit();
+        }
     }
 }
 
@@ -32,6 +32,7 @@
 #include "uavobject.h"
 #include <QPushButton>
 #include <QList>
+#include <QSet>
 #include <QEventLoop>
 #include "uavobjectutilmanager.h"
 #include <QObject>
@@ -73,10 +74,10 @@ private slots:
     void saving_finished(int, bool);
 
 private:
-    quint32 current_objectID;
     UAVDataObject *current_object;
     bool up_result;
-    bool sv_result;
+    QSet<quint32> pending_saves;
+    QSet<quint32> saved_objects;
     QEventLoop loop;
     QList<UAVDataObject *> objects;
     QMap<QPushButton *, buttonTypeEnum> buttonList;
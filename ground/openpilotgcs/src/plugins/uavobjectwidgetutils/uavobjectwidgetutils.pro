@@ -13,7 +13,8 @@ HEADERS += uavobjectwidgetutils_global.h \
     mixercurvepoint.h \
     mixercurveline.h \
     smartsavebutton.h \
-    popupwidget.h
+    popupwidget.h \
+    updatecoalescer.h
 
 SOURCES += uavobjectwidgetutilsplugin.cpp \
     configtaskwidget.cpp \
@@ -21,7 +22,8 @@ SOURCES += uavobjectwidgetutilsplugin.cpp \
     mixercurvepoint.cpp \
     mixercurveline.cpp \
     smartsavebutton.cpp \
-    popupwidget.cpp
+    popupwidget.cpp \
+    updatecoalescer.cpp
 
 RESOURCES += uavobjectwidgetutils.qrc
 
@@ -0,0 +1,99 @@
+/**
+ ******************************************************************************
+ *
+ * @file       updatecoalescer.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVObjectWidgetUtils Plugin
+ * @{
+ * @brief Utility plugin for UAVObject to Widget relation management
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "updatecoalescer.h"
+#include "uavobject.h"
+#include <QTimerEvent>
+
+// Unacked updates are sent at most at this period
+#define MIN_UPDATE_PERIOD_MS 50
+// An acked update is given up on after this time if it is never acknowledged,
+// longer than the telemetry retries
+#define ACK_TIMEOUT_MS       2000
+
+UpdateCoalescer::UpdateCoalescer(QObject *parent) : QObject(parent)
+{}
+
+void UpdateCoalescer::requestUpdate(UAVObject *obj)
+{
+    if (!m_states.contains(obj)) {
+        connect(obj, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(transactionCompleted(UAVObject *, bool)));
+    }
+    State &state = m_states[obj];
+    if (state.inFlight) {
+        state.pending = true;
+    } else {
+        send(obj, state);
+    }
+}
+
+void UpdateCoalescer::cancel(UAVObject *obj)
+{
+    if (m_states.contains(obj)) {
+        m_states[obj].pending = false;
+    }
+}
+
+void UpdateCoalescer::timerEvent(QTimerEvent *event)
+{
+    for (QHash<UAVObject *, State>::iterator i = m_states.begin(); i != m_states.end(); ++i) {
+        if (i.value().timerId == event->timerId()) {
+            done(i.key(), i.value());
+            return;
+        }
+    }
+}
+
+void UpdateCoalescer::transactionCompleted(UAVObject *obj, bool success)
+{
+    Q_UNUSED(success);
+
+    State &state = m_states[obj];
+    if (state.inFlight) {
+        done(obj, state);
+    }
+}
+
+void UpdateCoalescer::send(UAVObject *obj, State &state)
+{
+    bool acked = UAVObject::GetGcsTelemetryAcked(obj->getMetadata());
+
+    state.pending  = false;
+    state.inFlight = true;
+    state.timerId  = startTimer(acked ? ACK_TIMEOUT_MS : MIN_UPDATE_PERIOD_MS);
+    // The transaction can complete before this returns, the state is ready for it
+    emit sendUpdate(obj);
+}
+
+void UpdateCoalescer::done(UAVObject *obj, State &state)
+{
+    killTimer(state.timerId);
+    state.timerId  = 0;
+    state.inFlight = false;
+    if (state.pending) {
+        send(obj, state);
+    }
+}
@@ -0,0 +1,78 @@
+/**
+ ******************************************************************************
+ *
+ * @file       updatecoalescer.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVObjectWidgetUtils Plugin
+ * @{
+ * @brief Utility plugin for UAVObject to Widget relation management
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef UPDATECOALESCER_H
+#define UPDATECOALESCER_H
+
+#include "uavobjectwidgetutils_global.h"
+#include <QObject>
+#include <QHash>
+
+class UAVObject;
+
+/**
+ * Keeps interactive widgets (sliders, live calibration) from flooding the
+ * telemetry queue: at most one update of each object is in flight, the
+ * updates requested meanwhile are merged into a single one, sent once the
+ * update in flight is acknowledged (acked objects) or after a short interval.
+ *
+ * The owner sends the object, with its newest data, from sendUpdate().
+ */
+class UAVOBJECTWIDGETUTILS_EXPORT UpdateCoalescer : public QObject {
+    Q_OBJECT
+
+public:
+    explicit UpdateCoalescer(QObject *parent = 0);
+
+    // sendUpdate(obj) is emitted now, or once the update in flight is done
+    void requestUpdate(UAVObject *obj);
+    // Drop the update still pending for obj, if any
+    void cancel(UAVObject *obj);
+
+signals:
+    void sendUpdate(UAVObject *obj);
+
+protected:
+    void timerEvent(QTimerEvent *event);
+
+private slots:
+    void transactionCompleted(UAVObject *obj, bool success);
+
+private:
+    struct State {
+        State() : inFlight(false), pending(false), timerId(0) {}
+        bool inFlight;
+        bool pending;
+        int  timerId;
+    };
+
+    void send(UAVObject *obj, State &state);
+    void done(UAVObject *obj, State &state);
+
+    QHash<UAVObject *, State> m_states;
+};
+
+#endif // UPDATECOALESCER_H
@@ -91,6 +91,35 @@ void ImportSummaryDialog::addLine(QString uavObjectName, QString text, bool stat
     this->showEvent(NULL);
 }
 
+/*
+   Saving is only possible once the imported values reached the board
+ */
+void ImportSummaryDialog::beginUpload()
+{
+    ui->saveToFlash->setEnabled(false);
+}
+
+void ImportSummaryDialog::objectUploaded(UAVObject *obj, bool success)
+{
+    if (success) {
+        return;
+    }
+    for (int i = 0; i < ui->importSummaryList->rowCount(); i++) {
+        if (ui->importSummaryList->item(i, 1)->text() == obj->getName()) {
+            QCheckBox *box = dynamic_cast<QCheckBox *>(ui->importSummaryList->cellWidget(i, 0));
+            box->setChecked(false);
+            box->setEnabled(false);
+            ui->importSummaryList->item(i, 2)->setText(tr("Error (Upload failed)"));
+            break;
+        }
+    }
+}
+
+void ImportSummaryDialog::uploadFinished()
+{
+    ui->saveToFlash->setEnabled(true);
+}
+
 /*
    Saves every checked UAVObjet in the list to Flash
  */
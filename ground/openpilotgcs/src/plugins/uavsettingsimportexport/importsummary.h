@@ -49,6 +49,7 @@ public:
     ImportSummaryDialog(QWidget *parent = 0);
     ~ImportSummaryDialog();
     void addLine(QString objectName, QString text, bool status);
+    void beginUpload();
 
 protected:
     void showEvent(QShowEvent *event);
@@ -59,6 +60,8 @@ private:
 
 public slots:
     void updateSaveCompletion();
+    void objectUploaded(UAVObject *obj, bool success);
+    void uploadFinished();
 
 private slots:
     void doTheSaving();
@@ -0,0 +1,68 @@
+/**
+ ******************************************************************************
+ *
+ * @file       settingsuploader.cpp
+ * @author     (C) 2015 The OpenPilot Team, http://www.openpilot.org
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVSettingsImportExport UAVSettings Import/Export Plugin
+ * @{
+ * @brief UAVSettings Import/Export Plugin
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "settingsuploader.h"
+#include "uavobject.h"
+
+SettingsUploader::SettingsUploader(QObject *parent) : QObject(parent)
+{}
+
+void SettingsUploader::upload(const QList<UAVObject *> &objects)
+{
+    foreach(UAVObject * obj, objects) {
+        m_queue.enqueue(obj);
+    }
+    uploadNext();
+}
+
+void SettingsUploader::uploadNext()
+{
+    while (!m_queue.isEmpty() && m_pending.size() < MAX_PENDING_UPLOADS) {
+        UAVObject *obj = m_queue.dequeue();
+        if (UAVObject::GetGcsTelemetryAcked(obj->getMetadata())) {
+            connect(obj, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(transactionCompleted(UAVObject *, bool)));
+            m_pending.insert(obj);
+            obj->updated();
+        } else {
+            // No acknowledgement will come back, consider it sent
+            obj->updated();
+            emit objectUploaded(obj, true);
+        }
+    }
+    if (m_queue.isEmpty() && m_pending.isEmpty()) {
+        emit finished();
+    }
+}
+
+void SettingsUploader::transactionCompleted(UAVObject *obj, bool success)
+{
+    disconnect(obj, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(transactionCompleted(UAVObject *, bool)));
+    if (!m_pending.remove(obj)) {
+        return;
+    }
+    emit objectUploaded(obj, success);
+    uploadNext();
+}
@@ -0,0 +1,68 @@
+/**
+ ******************************************************************************
+ *
+ * @file       settingsuploader.h
+ * @author     (C) 2015 The OpenPilot Team, http://www.openpilot.org
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVSettingsImportExport UAVSettings Import/Export Plugin
+ * @{
+ * @brief UAVSettings Import/Export Plugin
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef SETTINGSUPLOADER_H
+#define SETTINGSUPLOADER_H
+
+#include <QObject>
+#include <QQueue>
+#include <QSet>
+
+class UAVObject;
+
+/**
+ * Sends a batch of objects to the board, keeping up to MAX_PENDING_UPLOADS
+ * acked updates in flight instead of waiting for each acknowledgement in turn.
+ */
+class SettingsUploader : public QObject {
+    Q_OBJECT
+
+public:
+    SettingsUploader(QObject *parent = 0);
+
+    void upload(const QList<UAVObject *> &objects);
+    bool isRunning() const
+    {
+        return !m_queue.isEmpty() || !m_pending.isEmpty();
+    }
+
+signals:
+    void objectUploaded(UAVObject *obj, bool success);
+    void finished();
+
+private slots:
+    void transactionCompleted(UAVObject *obj, bool success);
+
+private:
+    static const int MAX_PENDING_UPLOADS = 8;
+
+    QQueue<UAVObject *> m_queue;
+    QSet<UAVObject *> m_pending;
+
+    void uploadNext();
+};
+
+#endif // SETTINGSUPLOADER_H
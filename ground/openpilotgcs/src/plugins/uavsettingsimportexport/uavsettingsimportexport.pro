@@ -1,6 +1,6 @@
 
 TEMPLATE = lib
-QT += xml
+QT += xml concurrent
 
 TARGET = UAVSettingsImportExport
 DEFINES += UAVSETTINGSIMPORTEXPORT_LIBRARY
@@ -10,9 +10,13 @@ include(../../libs/version_info/version_info.pri)
 
 HEADERS += uavsettingsimportexport.h \
     importsummary.h \
+    settingsuploader.h \
+    uavsettingssnapshot.h \
     uavsettingsimportexportfactory.h
 SOURCES += uavsettingsimportexport.cpp \
     importsummary.cpp \
+    settingsuploader.cpp \
+    uavsettingssnapshot.cpp \
     uavsettingsimportexportfactory.cpp
  
 OTHER_FILES += uavsettingsimportexport.pluginspec
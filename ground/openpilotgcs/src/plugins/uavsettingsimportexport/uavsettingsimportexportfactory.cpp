@@ -31,6 +31,8 @@
 #include <QDebug>
 #include <QCheckBox>
 #include "importsummary.h"
+#include "settingsuploader.h"
+#include "uavsettingssnapshot.h"
 #include "version_info/version_info.h"
 
 // for menu item
@@ -51,6 +53,12 @@
 #include <QFileDialog>
 #include <QMessageBox>
 
+// for the worker thread conversions
+#include <QApplication>
+#include <QEventLoop>
+#include <QFutureWatcher>
+#include <QtConcurrent/QtConcurrentRun>
+
 UAVSettingsImportExportFactory::~UAVSettingsImportExportFactory()
 {
     // Do nothing
@@ -90,49 +98,65 @@ UAVSettingsImportExportFactory::UAVSettingsImportExportFactory(QObject *parent)
     connect(cmd->action(), SIGNAL(triggered(bool)), this, SLOT(exportUAVData()));
 }
 
+// Parse an import file, runs in a worker thread
+static UAVSettingsSnapshot parseSettingsFile(const QByteArray &contents)
+{
+    if (UAVSettingsSnapshot::isBinary(contents)) {
+        return UAVSettingsSnapshot::fromBinary(contents);
+    }
+    return UAVSettingsSnapshot::fromXml(contents);
+}
+
+// Keep the GUI alive while a worker thread does the conversion
+template<typename T>
+static T waitForResult(const QFuture<T> &future)
+{
+    QFutureWatcher<T> watcher;
+    QEventLoop loop;
+
+    QObject::connect(&watcher, SIGNAL(finished()), &loop, SLOT(quit()));
+    watcher.setFuture(future);
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    if (!future.isFinished()) {
+        loop.exec(QEventLoop::ExcludeUserInputEvents);
+    }
+    QApplication::restoreOverrideCursor();
+    return future.result();
+}
+
 // Slot called by the menu manager on user action
 void UAVSettingsImportExportFactory::importUAVSettings()
 {
     // ask for file name
     QString fileName;
-    QString filters = tr("UAVObjects XML files (*.uav);; XML files (*.xml)");
+    QString filters = tr("UAVObjects XML files (*.uav);; XML files (*.xml);; UAVObjects binary snapshots (*.uavbin)");
 
     fileName = QFileDialog::getOpenFileName(0, tr("Import UAV Settings"), "", filters);
     if (fileName.isEmpty()) {
         return;
     }
 
-    // Now open the file
+    // Now open the file and parse it off the GUI thread
     QFile file(fileName);
-    QDomDocument doc("UAVObjects");
-    file.open(QFile::ReadOnly | QFile::Text);
-    if (!doc.setContent(file.readAll())) {
-        QMessageBox msgBox;
-        msgBox.setText(tr("File Parsing Failed."));
-        msgBox.setInformativeText(tr("This file is not a correct XML file"));
-        msgBox.setStandardButtons(QMessageBox::Ok);
-        msgBox.exec();
+    if (!file.open(QFile::ReadOnly)) {
+        QMessageBox::critical(0, tr("UAV Settings Import"), tr("Unable to open file: ") + fileName, QMessageBox::Ok);
         return;
     }
+    UAVSettingsSnapshot snapshot = waitForResult(QtConcurrent::run(parseSettingsFile, file.readAll()));
     file.close();
 
-    // find the root of settings subtree
-    emit importAboutToBegin();
-    qDebug() << "Import about to begin";
-
-    QDomElement root = doc.documentElement();
-    if (root.tagName() == "uavobjects") {
-        root = root.firstChildElement("settings");
-    }
-    if (root.isNull() || (root.tagName() != "settings")) {
+    if (!snapshot.isValid()) {
         QMessageBox msgBox;
-        msgBox.setText(tr("Wrong file contents"));
-        msgBox.setInformativeText(tr("This file does not contain correct UAVSettings"));
+        msgBox.setText(tr("File Parsing Failed."));
+        msgBox.setInformativeText(snapshot.errorText);
         msgBox.setStandardButtons(QMessageBox::Ok);
         msgBox.exec();
         return;
     }
 
+    emit importAboutToBegin();
+    qDebug() << "Import about to begin";
+
     // We are now ok: setup the import summary dialog & update it as we
     // go along.
     ImportSummaryDialog swui((QWidget *)Core::ICore::instance()->mainWindow());
@@ -141,79 +165,95 @@ void UAVSettingsImportExportFactory::importUAVSettings()
     UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
     swui.show();
 
-    QDomNode node = root.firstChild();
-    while (!node.isNull()) {
-        QDomElement e = node.toElement();
-        if (e.tagName() == "object") {
-            // - Read each object
-            QString uavObjectName = e.attribute("name");
-            uint uavObjectID = e.attribute("id").toUInt(NULL, 16);
-
-            // Sanity Check:
-            UAVObject *obj   = objManager->getObject(uavObjectName);
+    QList<UAVObject *> updatedObjects;
+    foreach(const UAVSettingsSnapshot::Object &o, snapshot.objects) {
+        if (!o.data.isEmpty()) {
+            // Binary snapshot: the object ID identifies the definition the data was packed with
+            UAVObject *obj = objManager->getObject(o.objId, o.instId);
             if (obj == NULL) {
-                // This object is unknown!
-                qDebug() << "Object unknown:" << uavObjectName << uavObjectID;
-                swui.addLine(uavObjectName, "Error (Object unknown)", false);
+                qDebug() << "Object unknown:" << hex << o.objId;
+                swui.addLine(QString("0x%1").arg(o.objId, 8, 16, QChar('0')).toUpper(), "Error (Object unknown)", false);
+            } else if (obj->getNumBytes() != (quint32)o.data.size()) {
+                swui.addLine(obj->getName(), "Error (Object size mismatch)", false);
             } else {
-                // - Update each field
-                // - Issue and "updated" command
-                bool error     = false;
-                bool setError  = false;
-                QDomNode field = node.firstChild();
-                while (!field.isNull()) {
-                    QDomElement f = field.toElement();
-                    if (f.tagName() == "field") {
-                        UAVObjectField *uavfield = obj->getField(f.attribute("name"));
-                        if (uavfield) {
-                            QStringList list = f.attribute("values").split(",");
-                            if (list.length() == 1) {
-                                if (false == uavfield->checkValue(f.attribute("values"))) {
-                                    qDebug() << "checkValue returned false on: " << uavObjectName << f.attribute("values");
-                                    setError = true;
-                                } else {
-                                    uavfield->setValue(f.attribute("values"));
-                                }
-                            } else {
-                                // This is an enum:
-                                int i = 0;
-                                QStringList list = f.attribute("values").split(",");
-                                foreach(QString element, list) {
-                                    if (false == uavfield->checkValue(element, i)) {
-                                        qDebug() << "checkValue(list) returned false on: " << uavObjectName << list;
-                                        setError = true;
-                                    } else {
-                                        uavfield->setValue(element, i);
-                                    }
-                                    i++;
-                                }
-                            }
-                        } else {
-                            error = true;
-                        }
-                    }
-                    field = field.nextSibling();
-                }
-                obj->updated();
-
-                if (error) {
-                    swui.addLine(uavObjectName, "Warning (Object field unknown)", true);
-                } else if (uavObjectID != obj->getObjID()) {
-                    qDebug() << "Mismatch for Object " << uavObjectName << uavObjectID << " - " << obj->getObjID();
-                    swui.addLine(uavObjectName, "Warning (ObjectID mismatch)", true);
-                } else if (setError) {
-                    swui.addLine(uavObjectName, "Warning (Objects field value(s) invalid)", false);
+                obj->unpack((const quint8 *)o.data.constData());
+                updatedObjects << obj;
+                swui.addLine(obj->getName(), "OK", true);
+            }
+            continue;
+        }
+
+        // Sanity Check:
+        UAVObject *obj = objManager->getObject(o.name);
+        if (obj == NULL) {
+            // This object is unknown!
+            qDebug() << "Object unknown:" << o.name << o.objId;
+            swui.addLine(o.name, "Error (Object unknown)", false);
+            continue;
+        }
+
+        // - Update each field
+        bool error    = false;
+        bool setError = false;
+        foreach(const UAVSettingsSnapshot::Field &f, o.fields) {
+            UAVObjectField *uavfield = obj->getField(f.name);
+            if (!uavfield) {
+                error = true;
+                continue;
+            }
+            int i = 0;
+            foreach(const QString &element, f.values) {
+                if (false == uavfield->checkValue(element, i)) {
+                    qDebug() << "checkValue returned false on: " << o.name << f.values;
+                    setError = true;
                 } else {
-                    swui.addLine(uavObjectName, "OK", true);
+                    uavfield->setValue(element, i);
                 }
+                i++;
             }
         }
-        node = node.nextSibling();
+        updatedObjects << obj;
+
+        if (error) {
+            swui.addLine(o.name, "Warning (Object field unknown)", true);
+        } else if (o.objId != obj->getObjID()) {
+            qDebug() << "Mismatch for Object " << o.name << o.objId << " - " << obj->getObjID();
+            swui.addLine(o.name, "Warning (ObjectID mismatch)", true);
+        } else if (setError) {
+            swui.addLine(o.name, "Warning (Objects field value(s) invalid)", false);
+        } else {
+            swui.addLine(o.name, "OK", true);
+        }
     }
     qDebug() << "End import";
+
+    // - Send the updated objects, several acked transactions at a time
+    SettingsUploader uploader;
+    connect(&uploader, SIGNAL(objectUploaded(UAVObject *, bool)), &swui, SLOT(objectUploaded(UAVObject *, bool)));
+    connect(&uploader, SIGNAL(finished()), &swui, SLOT(uploadFinished()));
+    swui.beginUpload();
+    uploader.upload(updatedObjects);
+
     swui.exec();
 }
 
+// All settings object instances, in UAVObjectManager order
+QList<UAVDataObject *> UAVSettingsImportExportFactory::settingsObjects() const
+{
+    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
+    UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
+    QList<UAVDataObject *> settings;
+
+    foreach(const QList<UAVDataObject *> &list, objManager->getDataObjects()) {
+        foreach(UAVDataObject * obj, list) {
+            if (obj->isSettingsObject()) {
+                settings << obj;
+            }
+        }
+    }
+    return settings;
+}
+
 // Create an XML document from UAVObject database
 QString UAVSettingsImportExportFactory::createXMLDocument(const enum storedData what, const bool fullExport)
 {
@@ -336,28 +376,41 @@ void UAVSettingsImportExportFactory::exportUAVSettings()
 {
     // ask for file name
     QString fileName;
-    QString filters = tr("UAVObjects XML files (*.uav)");
+    QString filters = tr("UAVObjects XML files (*.uav);; UAVObjects binary snapshots (*.uavbin)");
+    QString selectedFilter;
 
-    fileName = QFileDialog::getSaveFileName(0, tr("Save UAVSettings File As"), "", filters);
+    fileName = QFileDialog::getSaveFileName(0, tr("Save UAVSettings File As"), "", filters, &selectedFilter);
     if (fileName.isEmpty()) {
         return;
     }
 
     // If the filename ends with .xml, we will do a full export, otherwise, a simple export
     bool fullExport = false;
+    bool binary     = false;
     if (fileName.endsWith(".xml")) {
         fullExport = true;
+    } else if (fileName.endsWith(".uavbin") || (!fileName.endsWith(".uav") && selectedFilter.contains("uavbin"))) {
+        binary = true;
+        if (!fileName.endsWith(".uavbin")) {
+            fileName.append(".uavbin");
+        }
     } else if (!fileName.endsWith(".uav")) {
         fileName.append(".uav");
     }
 
-    // generate an XML first (used for all export formats as a formatted data source)
-    QString xml = createXMLDocument(Settings, fullExport);
+    QByteArray contents;
+    if (binary) {
+        // the raw packed settings, no conversion needed
+        contents = UAVSettingsSnapshot::toBinary(settingsObjects());
+    } else {
+        // generate the XML in a worker thread, it only reads the objects
+        contents = waitForResult(QtConcurrent::run(this, &UAVSettingsImportExportFactory::createXMLDocument, Settings, fullExport)).toLatin1();
+    }
 
     // save file
     QFile file(fileName);
     if (file.open(QIODevice::WriteOnly) &&
-        (file.write(xml.toLatin1()) != -1)) {
+        (file.write(contents) != -1)) {
         file.close();
     } else {
         QMessageBox::critical(0,
@@ -403,7 +456,7 @@ void UAVSettingsImportExportFactory::exportUAVData()
     }
 
     // generate an XML first (used for all export formats as a formatted data source)
-    QString xml = createXMLDocument(Both, fullExport);
+    QString xml = waitForResult(QtConcurrent::run(this, &UAVSettingsImportExportFactory::createXMLDocument, Both, fullExport));
 
     // save file
     QFile file(fileName);
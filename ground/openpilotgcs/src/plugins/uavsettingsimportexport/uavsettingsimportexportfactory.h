@@ -39,6 +39,7 @@ public:
 private:
     enum storedData { Settings, Data, Both };
     QString createXMLDocument(const enum storedData, const bool fullExport);
+    QList<UAVDataObject *> settingsObjects() const;
 
 private slots:
     void importUAVSettings();
@@ -0,0 +1,150 @@
+/**
+ ******************************************************************************
+ *
+ * @file       uavsettingssnapshot.cpp
+ * @author     (C) 2015 The OpenPilot Team, http://www.openpilot.org
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVSettingsImportExport UAVSettings Import/Export Plugin
+ * @{
+ * @brief UAVSettings Import/Export Plugin
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "uavsettingssnapshot.h"
+#include "uavdataobject.h"
+#include <utils/crc.h>
+
+#include <QDataStream>
+#include <QDomDocument>
+
+static const char BINARY_MAGIC[]   = "UAVB";
+static const quint16 BINARY_VERSION = 1;
+
+UAVSettingsSnapshot UAVSettingsSnapshot::fromXml(const QByteArray &xml)
+{
+    UAVSettingsSnapshot snapshot;
+    QDomDocument doc("UAVObjects");
+
+    if (!doc.setContent(xml)) {
+        snapshot.errorText = tr("This file is not a correct XML file");
+        return snapshot;
+    }
+
+    // find the root of settings subtree
+    QDomElement root = doc.documentElement();
+    if (root.tagName() == "uavobjects") {
+        root = root.firstChildElement("settings");
+    }
+    if (root.isNull() || (root.tagName() != "settings")) {
+        snapshot.errorText = tr("This file does not contain correct UAVSettings");
+        return snapshot;
+    }
+
+    for (QDomElement e = root.firstChildElement("object"); !e.isNull(); e = e.nextSiblingElement("object")) {
+        Object object;
+        object.name   = e.attribute("name");
+        object.objId  = e.attribute("id").toUInt(NULL, 16);
+        object.instId = 0;
+        for (QDomElement f = e.firstChildElement("field"); !f.isNull(); f = f.nextSiblingElement("field")) {
+            Field field;
+            field.name   = f.attribute("name");
+            field.values = f.attribute("values").split(",");
+            object.fields << field;
+        }
+        snapshot.objects << object;
+    }
+    snapshot.valid = true;
+    return snapshot;
+}
+
+bool UAVSettingsSnapshot::isBinary(const QByteArray &contents)
+{
+    return contents.startsWith(BINARY_MAGIC);
+}
+
+/**
+ * Binary snapshot layout (little endian):
+ *   "UAVB", quint16 version, quint32 object count, then per object
+ *   quint32 object ID, quint16 instance ID, quint16 size, size bytes of packed data, quint8 CRC
+ */
+QByteArray UAVSettingsSnapshot::toBinary(const QList<UAVDataObject *> &objects)
+{
+    QByteArray binary;
+    QDataStream out(&binary, QIODevice::WriteOnly);
+
+    out.setByteOrder(QDataStream::LittleEndian);
+    out.writeRawData(BINARY_MAGIC, 4);
+    out << BINARY_VERSION << (quint32)objects.size();
+
+    QByteArray data;
+    foreach(UAVDataObject * obj, objects) {
+        data.resize(obj->getNumBytes());
+        obj->pack((quint8 *)data.data());
+        out << obj->getObjID() << (quint16)obj->getInstID() << (quint16)data.size();
+        out.writeRawData(data.constData(), data.size());
+        out << Utils::Crc::updateCRC(0, (const quint8 *)data.constData(), data.size());
+    }
+    return binary;
+}
+
+UAVSettingsSnapshot UAVSettingsSnapshot::fromBinary(const QByteArray &binary)
+{
+    UAVSettingsSnapshot snapshot;
+    QDataStream in(binary);
+
+    in.setByteOrder(QDataStream::LittleEndian);
+
+    quint16 version = 0;
+    quint32 count   = 0;
+    if (!isBinary(binary) || in.skipRawData(4) != 4) {
+        snapshot.errorText = tr("This file is not a settings snapshot");
+        return snapshot;
+    }
+    in >> version >> count;
+    if (version != BINARY_VERSION) {
+        snapshot.errorText = tr("Unsupported settings snapshot version %1").arg(version);
+        return snapshot;
+    }
+
+    for (quint32 i = 0; i < count; ++i) {
+        Object object;
+        quint16 instId;
+        quint16 size;
+        quint8 crc;
+        in >> object.objId >> instId >> size;
+        object.instId = instId;
+        object.data.resize(size);
+        if (in.status() != QDataStream::Ok || in.readRawData(object.data.data(), size) != size) {
+            break;
+        }
+        in >> crc;
+        if (in.status() != QDataStream::Ok) {
+            break;
+        }
+        if (crc != Utils::Crc::updateCRC(0, (const quint8 *)object.data.constData(), size)) {
+            snapshot.errorText = tr("Settings snapshot is corrupted (object 0x%1)").arg(object.objId, 8, 16, QChar('0'));
+            return snapshot;
+        }
+        snapshot.objects << object;
+    }
+    if ((quint32)snapshot.objects.size() != count) {
+        snapshot.errorText = tr("Settings snapshot is truncated");
+        return snapshot;
+    }
+    snapshot.valid = true;
+    return snapshot;
+}
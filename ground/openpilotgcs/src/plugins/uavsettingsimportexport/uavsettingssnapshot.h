@@ -0,0 +1,82 @@
+/**
+ ******************************************************************************
+ *
+ * @file       uavsettingssnapshot.h
+ * @author     (C) 2015 The OpenPilot Team, http://www.openpilot.org
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVSettingsImportExport UAVSettings Import/Export Plugin
+ * @{
+ * @brief UAVSettings Import/Export Plugin
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef UAVSETTINGSSNAPSHOT_H
+#define UAVSETTINGSSNAPSHOT_H
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QCoreApplication>
+
+class UAVDataObject;
+
+/**
+ * Settings read from an import file, decoupled from the UAVObjectManager so
+ * that parsing can run in a worker thread.
+ *
+ * Two formats are understood: the XML (.uav/.xml) export and a binary snapshot
+ * (.uavbin) holding the packed object data. The binary snapshot is tied to the
+ * object definitions: each record carries the generated object ID, which
+ * changes with the field layout, and a CRC of the data.
+ */
+class UAVSettingsSnapshot {
+    Q_DECLARE_TR_FUNCTIONS(UAVSettingsSnapshot)
+
+public:
+    struct Field {
+        QString     name;
+        QStringList values;
+    };
+
+    struct Object {
+        QString      name; // only known for XML files
+        quint32      objId;
+        quint32      instId;
+        QByteArray   data; // packed object data, binary snapshots only
+        QList<Field> fields; // XML files only
+    };
+
+    UAVSettingsSnapshot() : valid(false) {}
+
+    bool isValid() const
+    {
+        return valid;
+    }
+
+    bool valid;
+    QString errorText;
+    QList<Object> objects;
+
+    static UAVSettingsSnapshot fromXml(const QByteArray &xml);
+    static UAVSettingsSnapshot fromBinary(const QByteArray &binary);
+    static QByteArray toBinary(const QList<UAVDataObject *> &objects);
+
+    static bool isBinary(const QByteArray &contents);
+};
+
+#endif // UAVSETTINGSSNAPSHOT_H
@@ -31,7 +31,9 @@
 #include <QTime>
 #include <QtGlobal>
 #include <stdlib.h>
+#include <string.h>
 #include <QDebug>
+#include <algorithm>
 
 /**
  * Constructor
@@ -40,6 +42,14 @@ Telemetry::Telemetry(UAVTalk *utalk, UAVObjectManager *objMngr) : objMngr(objMng
 {
     mutex = new QMutex(QMutex::Recursive);
 
+    // Setup and start the periodic timer, registering the objects schedules their updates
+    updateClock.start();
+    updateTimerDueMs = MAX_UPDATE_PERIOD_MS;
+    updateTimer = new QTimer(this);
+    updateTimer->setSingleShot(true);
+    connect(updateTimer, SIGNAL(timeout()), this, SLOT(processPeriodicUpdates()));
+    updateTimer->start(MAX_UPDATE_PERIOD_MS);
+
     // Register all objects in the list
     foreach(QList<UAVObject *> instances, objMngr->getObjects()) {
         foreach(UAVObject * object, instances) {
@@ -63,15 +73,23 @@ Telemetry::Telemetry(UAVTalk *utalk, UAVObjectManager *objMngr) : objMngr(objMng
     // Get GCS stats object
     gcsStatsObj = GCSTelemetryStats::GetInstance(objMngr);
 
-    // Setup and start the periodic timer
-    timeToNextUpdateMs = 0;
-    updateTimer = new QTimer(this);
-    connect(updateTimer, SIGNAL(timeout()), this, SLOT(processPeriodicUpdates()));
-    updateTimer->start(1000);
-
     // Setup and start the stats timer
     txErrors  = 0;
     txRetries = 0;
+
+    // Exchange the time with the board, the reply is matched on the time we sent
+    timeSyncObj     = TimeSync::GetInstance(objMngr);
+    timeSyncTxTime  = 0;
+    timeSyncNext    = 0;
+    memset(&timeSyncRef, 0, sizeof(timeSyncRef));
+    lastRoundTripUs = 0;
+    jitterUs = 0;
+    objectLatencyMs = 0;
+    connect(timeSyncObj, SIGNAL(objectUnpacked(UAVObject *)), this, SLOT(timeSyncReceived(UAVObject *)));
+    connect(utalk, SIGNAL(objectTimestamped(quint32, quint16, quint16)), this, SLOT(objectTimestamped(quint32, quint16, quint16)));
+    timeSyncTimer = new QTimer(this);
+    connect(timeSyncTimer, SIGNAL(timeout()), this, SLOT(sendTimeSync()));
+    timeSyncTimer->start(TIMESYNC_PERIOD_MS);
 }
 
 Telemetry::~Telemetry()
@@ -102,20 +120,20 @@ void Telemetry::registerObject(UAVObject *obj)
  */
 void Telemetry::addObject(UAVObject *obj)
 {
+    QMutexLocker locker(mutex);
+
     // Check if object type is already in the list
-    for (int n = 0; n < objList.length(); ++n) {
-        if (objList[n].obj->getObjID() == obj->getObjID()) {
-            // Object type (not instance!) is already in the list, do nothing
-            return;
-        }
+    if (objTimeInfo.contains(obj->getObjID())) {
+        // Object type (not instance!) is already in the list, do nothing
+        return;
     }
 
     // If this point is reached, then the object type is new, let's add it
     ObjectTimeInfo timeInfo;
     timeInfo.obj = obj;
-    timeInfo.timeToNextUpdateMs = 0;
-    timeInfo.updatePeriodMs     = 0;
-    objList.append(timeInfo);
+    timeInfo.updatePeriodMs = 0;
+    timeInfo.generation     = 0;
+    objTimeInfo.insert(obj->getObjID(), timeInfo);
 }
 
 /**
@@ -123,15 +141,60 @@ void Telemetry::addObject(UAVObject *obj)
  */
 void Telemetry::setUpdatePeriod(UAVObject *obj, qint32 periodMs)
 {
+    QMutexLocker locker(mutex);
+
     // Find object type (not instance!) and update its period
-    for (int n = 0; n < objList.length(); ++n) {
-        if (objList[n].obj->getObjID() == obj->getObjID()) {
-            objList[n].updatePeriodMs     = periodMs;
-            objList[n].timeToNextUpdateMs = quint32((float)periodMs * (float)qrand() / (float)RAND_MAX); // avoid bunching of updates
+    QHash<quint32, ObjectTimeInfo>::iterator it = objTimeInfo.find(obj->getObjID());
+
+    if (it == objTimeInfo.end()) {
+        return;
+    }
+    // The update already scheduled, if any, is dropped when it comes up
+    it->updatePeriodMs = periodMs;
+    it->generation++;
+    if (periodMs > 0) {
+        qint64 dueMs = updateClock.elapsed() + qint64((float)periodMs * (float)qrand() / (float)RAND_MAX); // avoid bunching of updates
+        scheduleUpdate(it.key(), it.value(), dueMs);
+        if (dueMs < updateTimerDueMs) {
+            // Rearm the timer from the telemetry thread, this can be called from any thread
+            updateTimerDueMs = dueMs;
+            QMetaObject::invokeMethod(this, "processPeriodicUpdates", Qt::QueuedConnection);
+        }
+    }
+}
+
+/**
+ * Add a periodic update to the update heap
+ */
+void Telemetry::scheduleUpdate(quint32 objId, const ObjectTimeInfo &info, qint64 dueMs)
+{
+    ScheduledUpdate update;
+
+    update.dueMs = dueMs;
+    update.objId = objId;
+    update.generation = info.generation;
+    updateQueue.append(update);
+    std::push_heap(updateQueue.begin(), updateQueue.end(), updateDueLater);
+
+    // Drop the stale updates left by period changes when they pile up
+    if (updateQueue.size() > 2 * objTimeInfo.size()) {
+        QVector<ScheduledUpdate> current;
+        foreach(const ScheduledUpdate &scheduled, updateQueue) {
+            QHash<quint32, ObjectTimeInfo>::const_iterator it = objTimeInfo.constFind(scheduled.objId);
+            if (it != objTimeInfo.constEnd() && it->generation == scheduled.generation && it->updatePeriodMs > 0) {
+                current.append(scheduled);
+            }
         }
+        updateQueue = current;
+        std::make_heap(updateQueue.begin(), updateQueue.end(), updateDueLater);
     }
 }
 
+bool Telemetry::updateDueLater(const ScheduledUpdate &a, const ScheduledUpdate &b)
+{
+    return a.dueMs > b.dueMs;
+}
+
 /**
  * Connect to all instances of an object depending on the event mask specified
  */
@@ -449,59 +512,48 @@ void Telemetry::processObjectQueue()
 }
 
 /**
- * Check is any objects are pending for periodic updates
- * TODO: Clean-up
+ * Send the periodic updates that are due and rearm the timer for the next one
  */
 void Telemetry::processPeriodicUpdates()
 {
     QMutexLocker locker(mutex);
 
-    // Stop timer
     updateTimer->stop();
 
-    // Iterate through each object and update its timer, if zero then transmit object.
-    // Also calculate smallest delay to next update (will be used for setting timeToNextUpdateMs)
-    qint32 minDelay  = MAX_UPDATE_PERIOD_MS;
-    ObjectTimeInfo *objinfo;
-    qint32 elapsedMs = 0;
-    QTime time;
-    qint32 offset;
-    bool allInstances;
-    for (int n = 0; n < objList.length(); ++n) {
-        objinfo = &objList[n];
-        // If object is configured for periodic updates
-        if (objinfo->updatePeriodMs > 0) {
-            objinfo->timeToNextUpdateMs -= timeToNextUpdateMs;
-            // Check if time for the next update
-            if (objinfo->timeToNextUpdateMs <= 0) {
-                // Reset timer
-                offset = (-objinfo->timeToNextUpdateMs) % objinfo->updatePeriodMs;
-                objinfo->timeToNextUpdateMs = objinfo->updatePeriodMs - offset;
-                // Send object
-                time.start();
-                allInstances = !objinfo->obj->isSingleInstance();
-                processObjectUpdates(objinfo->obj, EV_UPDATED_PERIODIC, allInstances, false);
-                elapsedMs    = time.elapsed();
-                // Update timeToNextUpdateMs with the elapsed delay of sending the object;
-                timeToNextUpdateMs += elapsedMs;
-            }
-            // Update minimum delay
-            if (objinfo->timeToNextUpdateMs < minDelay) {
-                minDelay = objinfo->timeToNextUpdateMs;
-            }
+    while (!updateQueue.isEmpty() && updateQueue.first().dueMs <= updateClock.elapsed()) {
+        std::pop_heap(updateQueue.begin(), updateQueue.end(), updateDueLater);
+        ScheduledUpdate update = updateQueue.takeLast();
+
+        // Skip the updates scheduled before the period was changed
+        QHash<quint32, ObjectTimeInfo>::iterator it = objTimeInfo.find(update.objId);
+        if (it == objTimeInfo.end() || it->generation != update.generation || it->updatePeriodMs <= 0) {
+            continue;
         }
-    }
 
-    // Check if delay for the next update is too short
-    if (minDelay < MIN_UPDATE_PERIOD_MS) {
-        minDelay = MIN_UPDATE_PERIOD_MS;
-    }
+        // Schedule the next update first, sending may change the period
+        // Keep the phase, skipping the updates missed if running late
+        qint32 periodMs = it->updatePeriodMs;
+        qint64 nextMs   = update.dueMs + periodMs;
+        qint64 now = updateClock.elapsed();
+        if (nextMs <= now) {
+            nextMs += ((now - nextMs) / periodMs + 1) * periodMs;
+        }
+        scheduleUpdate(update.objId, it.value(), nextMs);
 
-    // Done
-    timeToNextUpdateMs = minDelay;
+        // Send object
+        UAVObject *obj    = it->obj;
+        bool allInstances = !obj->isSingleInstance();
+        processObjectUpdates(obj, EV_UPDATED_PERIODIC, allInstances, false);
+    }
 
-    // Restart timer
-    updateTimer->start(timeToNextUpdateMs);
+    // Restart the timer for the next update, never sooner than the minimum period
+    qint64 now = updateClock.elapsed();
+    qint64 dueMs = now + MAX_UPDATE_PERIOD_MS;
+    if (!updateQueue.isEmpty()) {
+        dueMs = qBound(now + MIN_UPDATE_PERIOD_MS, updateQueue.first().dueMs, dueMs);
+    }
+    updateTimerDueMs = dueMs;
+    updateTimer->start(dueMs - now);
 }
 
 Telemetry::TelemetryStats Telemetry::getStats()
@@ -579,6 +631,110 @@ void Telemetry::updateRequested(UAVObject *obj, bool all)
     processObjectUpdates(obj, EV_UPDATE_REQ, allInstances, true);
 }
 
+/**
+ * Time of the time sync exchanges, in us, wraps around like the board time
+ */
+quint32 Telemetry::timeSyncClock()
+{
+    return (quint32)(updateClock.nsecsElapsed() / 1000);
+}
+
+/**
+ * Board tick count (ms) at the given GCS time, 0 until the first time sync reply
+ */
+quint32 Telemetry::boardTickMs(quint32 gcsTimeUs)
+{
+    if (timeSyncSamples.isEmpty()) {
+        return 0;
+    }
+    return timeSyncRef.boardTickMs + (qint32)(gcsTimeUs - timeSyncRef.gcsTimeUs) / 1000;
+}
+
+/**
+ * Send a time sync request, sent straight away so that the time is not stale
+ * by the time the request leaves the queues
+ */
+void Telemetry::sendTimeSync()
+{
+    TimeSync::DataFields data = timeSyncObj->getData();
+
+    timeSyncTxTime  = timeSyncClock();
+    data.GCSTxTime  = timeSyncTxTime;
+    timeSyncObj->setData(data);
+    utalk->sendObject(timeSyncObj, false, false);
+}
+
+/**
+ * Work out the round trip and the board clock from a time sync reply (NTP like):
+ * the round trip is the time the request was away less the time the board held it,
+ * the board sent the reply half the round trip before it was received.
+ * The board time is taken from the exchange with the shortest round trip of the last
+ * few, the one the least delayed by the link queues.
+ * The estimated board time at reception is stored with the reply, logging the object
+ * pairs the log time with the board time.
+ */
+void Telemetry::timeSyncReceived(UAVObject *obj)
+{
+    quint32 rxTime = timeSyncClock();
+    TimeSync::DataFields data = static_cast<TimeSync *>(obj)->getData();
+
+    if (data.GCSTxTime != timeSyncTxTime) {
+        // Late reply to an older request, or not a reply at all
+        return;
+    }
+
+    qint32 roundTrip = (qint32)((rxTime - data.GCSTxTime) - (data.BoardTxTime - data.BoardRxTime));
+    if (roundTrip < 0) {
+        roundTrip = 0;
+    }
+
+    TimeSyncSample sample;
+    sample.roundTripUs = roundTrip;
+    sample.boardTickMs = data.BoardTxTick;
+    sample.gcsTimeUs   = rxTime - roundTrip / 2;
+    if (timeSyncSamples.size() < TIMESYNC_SAMPLES) {
+        timeSyncSamples.append(sample);
+    } else {
+        timeSyncSamples[timeSyncNext] = sample;
+        timeSyncNext = (timeSyncNext + 1) % TIMESYNC_SAMPLES;
+    }
+    timeSyncRef = timeSyncSamples.first();
+    foreach(const TimeSyncSample &s, timeSyncSamples) {
+        if (s.roundTripUs < timeSyncRef.roundTripUs) {
+            timeSyncRef = s;
+        }
+    }
+
+    // Jitter of the round trip, smoothed as in RFC 3550
+    if (timeSyncSamples.size() > 1) {
+        jitterUs += (qAbs((qint32)(roundTrip - lastRoundTripUs)) - jitterUs) / 16;
+    }
+    lastRoundTripUs    = roundTrip;
+
+    data.BoardTime     = boardTickMs(rxTime);
+    data.RoundTrip     = roundTrip / 1000.0f;
+    data.Jitter        = jitterUs / 1000.0f;
+    data.ObjectLatency = objectLatencyMs;
+    static_cast<TimeSync *>(obj)->setData(data);
+}
+
+/**
+ * Measure the latency of the updates the board sends timestamped, from the time
+ * they were sent (board tick count, 16 bits) to the time they are received
+ */
+void Telemetry::objectTimestamped(quint32 objId, quint16 instId, quint16 boardTimeMs)
+{
+    Q_UNUSED(objId);
+    Q_UNUSED(instId);
+
+    if (timeSyncSamples.isEmpty()) {
+        return;
+    }
+    quint32 now = boardTickMs(timeSyncClock());
+    qint16 latency = (qint16)((quint16)now - boardTimeMs);
+    objectLatencyMs += (qMax((qint16)0, latency) - objectLatencyMs) / 16;
+}
+
 void Telemetry::newObject(UAVObject *obj)
 {
     QMutexLocker locker(mutex);
@@ -31,11 +31,15 @@
 #include "uavtalk.h"
 #include "uavobjectmanager.h"
 #include "gcstelemetrystats.h"
+#include "timesync.h"
 #include <QMutex>
 #include <QMutexLocker>
 #include <QTimer>
+#include <QElapsedTimer>
 #include <QQueue>
 #include <QMap>
+#include <QHash>
+#include <QVector>
 
 class ObjectTransactionInfo : public QObject {
     Q_OBJECT
@@ -86,6 +90,9 @@ private:
     static const int MAX_UPDATE_PERIOD_MS = 1000;
     static const int MIN_UPDATE_PERIOD_MS = 1;
     static const int MAX_QUEUE_SIZE = 20;
+    static const int TIMESYNC_PERIOD_MS = 1000;
+    // The clock offset is taken from the fastest of the last exchanges
+    static const int TIMESYNC_SAMPLES   = 8;
 
     // Types
     /**
@@ -103,40 +110,78 @@ private:
     typedef struct {
         UAVObject *obj;
         qint32    updatePeriodMs; /** Update period in ms or 0 if no periodic updates are needed */
-        qint32    timeToNextUpdateMs; /** Time delay to the next update */
+        quint32   generation; /** Incremented when the period changes, invalidates the scheduled update */
     } ObjectTimeInfo;
 
+    /**
+     * Periodic update scheduled in updateQueue
+     */
+    typedef struct {
+        qint64  dueMs; /** Time of the update on updateClock */
+        quint32 objId;
+        quint32 generation; /** ObjectTimeInfo generation the update was scheduled for */
+    } ScheduledUpdate;
+
     typedef struct {
         UAVObject *obj;
         EventMask event;
         bool allInstances;
     } ObjectQueueInfo;
 
+    /**
+     * Time sync exchange, times in us on updateClock
+     */
+    typedef struct {
+        quint32 roundTripUs;
+        quint32 boardTickMs; /** Board tick count when the reply was sent */
+        quint32 gcsTimeUs; /** GCS time at the same instant, half the round trip before the reply was received */
+    } TimeSyncSample;
+
     // Variables
     UAVObjectManager *objMngr;
     UAVTalk *utalk;
     GCSTelemetryStats *gcsStatsObj;
-    QList<ObjectTimeInfo> objList;
+    // Periodic update settings of each object type, by object ID
+    QHash<quint32, ObjectTimeInfo> objTimeInfo;
+    // Heap of the scheduled periodic updates, the next one first
+    QVector<ScheduledUpdate> updateQueue;
+    QElapsedTimer updateClock;
     QQueue<ObjectQueueInfo> objQueue;
     QQueue<ObjectQueueInfo> objPriorityQueue;
     QMap<quint32, QMap<quint32, ObjectTransactionInfo *> *> transMap;
     QMutex *mutex;
     QTimer *updateTimer;
     QTimer *statsTimer;
-    qint32 timeToNextUpdateMs;
+    // Time the update timer fires, on updateClock
+    qint64 updateTimerDueMs;
     quint32 txErrors;
     quint32 txRetries;
+    // Time sync
+    TimeSync *timeSyncObj;
+    QTimer *timeSyncTimer;
+    quint32 timeSyncTxTime;
+    QVector<TimeSyncSample> timeSyncSamples;
+    int timeSyncNext;
+    // Reference of the board tick count, from the fastest recent exchange
+    TimeSyncSample timeSyncRef;
+    quint32 lastRoundTripUs;
+    float jitterUs;
+    float objectLatencyMs;
 
     // Methods
     void registerObject(UAVObject *obj);
     void addObject(UAVObject *obj);
     void setUpdatePeriod(UAVObject *obj, qint32 periodMs);
+    void scheduleUpdate(quint32 objId, const ObjectTimeInfo &info, qint64 dueMs);
+    static bool updateDueLater(const ScheduledUpdate &a, const ScheduledUpdate &b);
     void connectToObjectInstances(UAVObject *obj, quint32 eventMask);
     void connectToObject(UAVObject *obj, quint32 eventMask);
     void updateObject(UAVObject *obj, quint32 eventMask);
     void processObjectUpdates(UAVObject *obj, EventMask event, bool allInstances, bool priority);
     void processObjectTransaction(ObjectTransactionInfo *transInfo);
     void processObjectQueue();
+    quint32 timeSyncClock();
+    quint32 boardTickMs(quint32 gcsTimeUs);
 
     ObjectTransactionInfo *findTransaction(UAVObject *obj);
     void openTransaction(ObjectTransactionInfo *trans);
@@ -153,6 +198,9 @@ private slots:
     void newInstance(UAVObject *obj);
     void processPeriodicUpdates();
     void transactionCompleted(UAVObject *obj, bool success);
+    void sendTimeSync();
+    void timeSyncReceived(UAVObject *obj);
+    void objectTimestamped(quint32 objId, quint16 instId, quint16 boardTimeMs);
 };
 
 #endif // TELEMETRY_H
@@ -0,0 +1,249 @@
+/**
+ ******************************************************************************
+ *
+ * @file       telemetrycapture.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief The UAVTalk protocol plugin
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "telemetrycapture.h"
+#include <utils/crc.h>
+#include <QDebug>
+#include <QTimer>
+#include <QtEndian>
+#include <string.h>
+
+using namespace Utils;
+
+// The file is flushed at this period so that it can be opened while capturing
+#define FLUSH_PERIOD_MS       1000
+
+// UAVTalk framing, see UAVTalk
+#define SYNC_VAL              0x3C
+#define HEADER_LENGTH         10
+#define MAX_PAYLOAD_LENGTH    256
+#define CHECKSUM_LENGTH       1
+
+// pcapng block types, options and link type
+#define SECTION_HEADER_BLOCK  0x0A0D0D0A
+#define INTERFACE_BLOCK       0x00000001
+#define ENHANCED_PACKET_BLOCK 0x00000006
+#define BYTE_ORDER_MAGIC      0x1A2B3C4D
+#define OPT_ENDOFOPT          0
+#define OPT_IF_NAME           2
+#define OPT_EPB_FLAGS         2
+#define EPB_FLAGS_INBOUND     0x1
+#define EPB_FLAGS_OUTBOUND    0x2
+#define LINKTYPE_IPV4         228
+
+// Made up endpoints, the port is the UAVTalk dissector default
+#define AIRCRAFT_ADDRESS      0xC0000202 // 192.0.2.2
+#define GCS_ADDRESS           0xC0000201 // 192.0.2.1
+#define UAVTALK_PORT          9000
+#define IPV4_HEADER_LENGTH    20
+#define UDP_HEADER_LENGTH     8
+
+TelemetryCapture::TelemetryCapture(const QString &fileName) :
+    m_file(fileName), m_flushTimer(0), m_packets(0)
+{}
+
+TelemetryCapture::~TelemetryCapture()
+{
+    if (m_file.isOpen()) {
+        qDebug() << "TelemetryCapture -" << m_packets << "packets written to" << m_file.fileName();
+        m_file.close();
+    }
+}
+
+/**
+ * Open the file and start a new section, must be called from the thread the capture lives in.
+ */
+void TelemetryCapture::start()
+{
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        qWarning() << "TelemetryCapture - could not open" << m_file.fileName() << m_file.errorString();
+        return;
+    }
+    writeHeader();
+
+    m_flushTimer = new QTimer(this);
+    connect(m_flushTimer, SIGNAL(timeout()), this, SLOT(flush()));
+    m_flushTimer->start(FLUSH_PERIOD_MS);
+}
+
+/**
+ * Record data captured by UAVTalk.
+ * \param[in] timestamp Time the data was read or written, microseconds since the epoch
+ * \param[in] data A block read from the device, or a whole frame written to it
+ * \param[in] outgoing True for the data written to the device
+ */
+void TelemetryCapture::capture(qint64 timestamp, QByteArray data, bool outgoing)
+{
+    if (!m_file.isOpen()) {
+        return;
+    }
+    if (outgoing) {
+        writePacket(timestamp, (const quint8 *)data.constData(), data.size(), true);
+        return;
+    }
+
+    m_rxData.append(data);
+
+    // The frames completed by this block get its timestamp
+    const quint8 *rx = (const quint8 *)m_rxData.constData();
+    int size  = m_rxData.size();
+    int pos   = 0;
+    int start = 0; // first byte not written yet
+    while (pos < size) {
+        if (rx[pos] != SYNC_VAL) {
+            pos++;
+            continue;
+        }
+        if (size - pos < 4) {
+            break;
+        }
+        int length = qFromLittleEndian<quint16>(&rx[pos + 2]);
+        if (length < HEADER_LENGTH || length > HEADER_LENGTH + MAX_PAYLOAD_LENGTH) {
+            pos++;
+            continue;
+        }
+        if (size - pos < length + CHECKSUM_LENGTH) {
+            break;
+        }
+        if (Crc::updateCRC(0, &rx[pos], length) != rx[pos + length]) {
+            pos++;
+            continue;
+        }
+        if (pos > start) {
+            writePacket(timestamp, &rx[start], pos - start, false);
+        }
+        writePacket(timestamp, &rx[pos], length + CHECKSUM_LENGTH, false);
+        pos  += length + CHECKSUM_LENGTH;
+        start = pos;
+    }
+    // Whatever is left before an incomplete frame can not be part of a valid one
+    if (pos > start) {
+        writePacket(timestamp, &rx[start], pos - start, false);
+    }
+    m_rxData.remove(0, pos);
+}
+
+void TelemetryCapture::flush()
+{
+    m_file.flush();
+}
+
+/**
+ * Write the section header and the description of the (only) interface, in host byte order.
+ */
+void TelemetryCapture::writeHeader()
+{
+    struct {
+        quint32 type;
+        quint32 length;
+        quint32 byteOrderMagic;
+        quint16 majorVersion;
+        quint16 minorVersion;
+        qint64  sectionLength;
+        quint32 trailingLength;
+    } shb = { SECTION_HEADER_BLOCK, 28, BYTE_ORDER_MAGIC, 1, 0, -1, 28 };
+    m_file.write((const char *)&shb, 28);
+
+    // if_name option, padded to 32 bits, then the end of options
+    static const char name[] = "uavtalk";
+    const quint32 nameLength = sizeof(name) - 1;
+    const quint32 nameSpace  = (nameLength + 3) & ~3;
+    const quint32 length     = 20 + 4 + nameSpace + 4;
+    struct {
+        quint32 type;
+        quint32 length;
+        quint16 linkType;
+        quint16 reserved;
+        quint32 snapLength;
+        quint16 optionCode;
+        quint16 optionLength;
+    } idb = { INTERFACE_BLOCK, length, LINKTYPE_IPV4, 0, 0, OPT_IF_NAME, nameLength };
+    m_file.write((const char *)&idb, 16 + 4);
+    QByteArray padded(name, nameLength);
+    padded.append(QByteArray(nameSpace - nameLength, 0));
+    m_file.write(padded);
+    const quint32 trailer[2] = { OPT_ENDOFOPT, length };
+    m_file.write((const char *)trailer, sizeof(trailer));
+}
+
+/**
+ * Write one enhanced packet block holding the data in an IPv4/UDP datagram.
+ */
+void TelemetryCapture::writePacket(qint64 timestamp, const quint8 *data, int length, bool outgoing)
+{
+    quint8 packet[IPV4_HEADER_LENGTH + UDP_HEADER_LENGTH];
+    const int packetLength = IPV4_HEADER_LENGTH + UDP_HEADER_LENGTH + length;
+
+    // IPv4 header, no options nor fragmentation, in network byte order
+    memset(packet, 0, sizeof(packet));
+    packet[0] = 0x45;
+    qToBigEndian<quint16>(packetLength, &packet[2]);
+    qToBigEndian<quint16>(m_packets, &packet[4]);
+    packet[8] = 64; // TTL
+    packet[9] = 17; // UDP
+    qToBigEndian<quint32>(outgoing ? GCS_ADDRESS : AIRCRAFT_ADDRESS, &packet[12]);
+    qToBigEndian<quint32>(outgoing ? AIRCRAFT_ADDRESS : GCS_ADDRESS, &packet[16]);
+    quint32 sum = 0;
+    for (int i = 0; i < IPV4_HEADER_LENGTH; i += 2) {
+        sum += (packet[i] << 8) | packet[i + 1];
+    }
+    while (sum >> 16) {
+        sum = (sum & 0xFFFF) + (sum >> 16);
+    }
+    qToBigEndian<quint16>(~sum, &packet[10]);
+
+    // UDP header, the checksum is optional over IPv4
+    qToBigEndian<quint16>(UAVTALK_PORT, &packet[20]);
+    qToBigEndian<quint16>(UAVTALK_PORT, &packet[22]);
+    qToBigEndian<quint16>(UDP_HEADER_LENGTH + length, &packet[24]);
+
+    const quint32 padding = (4 - (packetLength & 3)) & 3;
+    const quint32 blockLength = 28 + packetLength + padding + 8 + 4 + 4;
+    const quint32 epb[7] = {
+        ENHANCED_PACKET_BLOCK, blockLength, 0,
+        (quint32)((quint64)timestamp >> 32), (quint32)timestamp,
+        (quint32)packetLength, (quint32)packetLength
+    };
+    m_file.write((const char *)epb, sizeof(epb));
+    m_file.write((const char *)packet, sizeof(packet));
+    m_file.write((const char *)data, length);
+    if (padding) {
+        static const char zeros[3] = { 0, 0, 0 };
+        m_file.write(zeros, padding);
+    }
+    // epb_flags option, the end of options and the block length again
+    struct {
+        quint16 optionCode;
+        quint16 optionLength;
+        quint32 flags;
+        quint32 endOfOptions;
+        quint32 trailingLength;
+    } trailer = { OPT_EPB_FLAGS, 4, (quint32)(outgoing ? EPB_FLAGS_OUTBOUND : EPB_FLAGS_INBOUND), OPT_ENDOFOPT, blockLength };
+    m_file.write((const char *)&trailer, 16);
+
+    m_packets++;
+}
@@ -0,0 +1,73 @@
+/**
+ ******************************************************************************
+ *
+ * @file       telemetrycapture.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief The UAVTalk protocol plugin
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef TELEMETRYCAPTURE_H
+#define TELEMETRYCAPTURE_H
+
+#include "uavtalk_global.h"
+#include <QObject>
+#include <QByteArray>
+#include <QFile>
+
+class QTimer;
+
+/**
+ * Records the telemetry link to a pcapng file that Wireshark opens with the OpenPilot
+ * UAVTalk dissector (packet-op-uavtalk).
+ * Each UAVTalk frame is stored as a UDP datagram to or from port 9000, the dissector
+ * default, between a made up aircraft (192.0.2.2) and GCS (192.0.2.1) address. The direction
+ * is also recorded in the packet flags. The blocks received from the device are split in
+ * frames here, bytes that do not make a valid frame are stored in packets of their own so
+ * that sync and CRC errors show up as malformed packets.
+ * The timestamps are taken by UAVTalk in the device thread, the capture itself runs in its
+ * own thread. Each capture is appended to the file as a new pcapng section.
+ */
+class UAVTALK_EXPORT TelemetryCapture : public QObject {
+    Q_OBJECT
+
+public:
+    TelemetryCapture(const QString &fileName);
+    ~TelemetryCapture();
+
+public slots:
+    void start();
+    void capture(qint64 timestamp, QByteArray data, bool outgoing);
+
+private slots:
+    void flush();
+
+private:
+    void writeHeader();
+    void writePacket(qint64 timestamp, const quint8 *data, int length, bool outgoing);
+
+    QFile m_file;
+    QTimer *m_flushTimer;
+    // Received bytes that do not make a whole frame yet
+    QByteArray m_rxData;
+    quint32 m_packets;
+};
+
+#endif // TELEMETRYCAPTURE_H
@@ -28,11 +28,15 @@
 #include "telemetrymanager.h"
 #include "telemetry.h"
 #include "telemetrymonitor.h"
+#include "telemetryrelay.h"
+#include "telemetrycapture.h"
 #include <extensionsystem/pluginmanager.h>
 #include <coreplugin/icore.h>
 #include <coreplugin/threadmanager.h>
+#include <coreplugin/generalsettings.h>
 
-TelemetryManager::TelemetryManager() : m_connectionState(TELEMETRY_DISCONNECTED)
+TelemetryManager::TelemetryManager() : m_uavTalk(0), m_telemetry(0), m_telemetryMonitor(0), m_connectionState(TELEMETRY_DISCONNECTED), m_primary(true),
+    m_useReaderThread(false), m_telemetryRelay(0), m_telemetryCapture(0)
 {
     moveToThread(Core::ICore::instance()->threadManager()->getRealTimeThread());
     // Get UAVObjectManager instance
@@ -41,7 +45,20 @@ TelemetryManager::TelemetryManager() : m_connectionState(TELEMETRY_DISCONNECTED)
 
     // connect to start stop signals
     connect(this, SIGNAL(myStart()), this, SLOT(onStart()), Qt::QueuedConnection);
-    connect(this, SIGNAL(myStop()), this, SLOT(onStop()), Qt::QueuedConnection);
+}
+
+/**
+ * Telemetry manager of an additional vehicle, running the link with its own object manager
+ * in the given thread.
+ */
+TelemetryManager::TelemetryManager(UAVObjectManager *objMngr, QThread *thread) :
+    m_uavobjectManager(objMngr), m_uavTalk(0), m_telemetry(0), m_telemetryMonitor(0), m_connectionState(TELEMETRY_DISCONNECTED),
+    m_primary(false), m_useReaderThread(false), m_telemetryRelay(0), m_telemetryCapture(0)
+{
+    moveToThread(thread);
+
+    // connect to start stop signals
+    connect(this, SIGNAL(myStart()), this, SLOT(onStart()), Qt::QueuedConnection);
 }
 
 TelemetryManager::~TelemetryManager()
@@ -75,27 +92,59 @@ void TelemetryManager::start(QIODevice *dev)
 void TelemetryManager::onStart()
 {
     m_uavTalk = new UAVTalk(m_telemetryDevice, m_uavobjectManager);
-    if (false) {
+
+    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
+    Core::Internal::GeneralSettings *settings = pm->getObject<Core::Internal::GeneralSettings>();
+    m_useReaderThread = settings->useTelemetryThread() && !settings->useUDPMirror();
+    if (m_useReaderThread) {
         // UAVTalk must be thread safe and for that:
         // 1- all public methods must lock a mutex
         // 2- the reader thread must lock that mutex too
         // The reader thread locks the mutex once a packet is read and decoded.
         // It is assumed that the UAVObjectManager is thread safe
+        // The device itself is only read and written from this thread, UAVTalk forwards the read
+        // blocks to the reader and queues back the packets the reader needs to send.
 
         // Create the reader and move it to the reader thread
         IODeviceReader *reader = new IODeviceReader(m_uavTalk);
         reader->moveToThread(&m_telemetryReaderThread);
         // The reader will be deleted (later) when the thread finishes
         connect(&m_telemetryReaderThread, &QThread::finished, reader, &QObject::deleteLater);
-        // Connect IO device to reader
-        connect(m_telemetryDevice, SIGNAL(readyRead()), reader, SLOT(read()));
-        // start the reader thread
-        m_telemetryReaderThread.start();
+        // Connect IO device to UAVTalk and UAVTalk to the reader
+        m_uavTalk->setForwardInput(true);
+        connect(m_telemetryDevice, SIGNAL(readyRead()), m_uavTalk, SLOT(processInputStream()));
+        connect(m_uavTalk, SIGNAL(inputReceived(QByteArray)), reader, SLOT(read(QByteArray)));
+        // start the reader thread, decoding must not be starved by the GUI
+        m_telemetryReaderThread.start(QThread::TimeCriticalPriority);
     } else {
         // Connect IO device to reader
         connect(m_telemetryDevice, SIGNAL(readyRead()), m_uavTalk, SLOT(processInputStream()));
     }
 
+    if (m_primary && settings->telemetryRelayPort() != 0) {
+        // The relay serves its clients from its own thread, the frames are queued to it
+        // as they are received and it is deleted (later) when the thread finishes
+        m_telemetryRelay = new TelemetryRelay(settings->telemetryRelayPort(), settings->telemetryRelayRate());
+        m_telemetryRelay->moveToThread(&m_telemetryRelayThread);
+        connect(&m_telemetryRelayThread, &QThread::finished, m_telemetryRelay, &QObject::deleteLater);
+        connect(m_uavTalk, SIGNAL(frameReceived(QByteArray)), m_telemetryRelay, SLOT(relayFrame(QByteArray)));
+        m_uavTalk->setRelayFrames(true);
+        m_telemetryRelayThread.start();
+        QMetaObject::invokeMethod(m_telemetryRelay, "start", Qt::QueuedConnection);
+    }
+
+    if (m_primary && !settings->telemetryCaptureFile().isEmpty()) {
+        // The capture writes the file from its own thread, UAVTalk only timestamps the data
+        // and queues it (shared, not copied)
+        m_telemetryCapture = new TelemetryCapture(settings->telemetryCaptureFile());
+        m_telemetryCapture->moveToThread(&m_telemetryCaptureThread);
+        connect(&m_telemetryCaptureThread, &QThread::finished, m_telemetryCapture, &QObject::deleteLater);
+        connect(m_uavTalk, SIGNAL(dataCaptured(qint64, QByteArray, bool)), m_telemetryCapture, SLOT(capture(qint64, QByteArray, bool)));
+        m_telemetryCaptureThread.start();
+        QMetaObject::invokeMethod(m_telemetryCapture, "start", Qt::QueuedConnection);
+        m_uavTalk->setCaptureData(true);
+    }
+
     m_telemetry = new Telemetry(m_uavTalk, m_uavobjectManager);
     m_telemetryMonitor = new TelemetryMonitor(m_uavobjectManager, m_telemetry);
 
@@ -108,20 +157,47 @@ void TelemetryManager::stop()
 {
     m_connectionState = TELEMETRY_DISCONNECTING;
     emit disconnecting();
-    emit myStop();
-
-    if (false) {
-        m_telemetryReaderThread.quit();
-        m_telemetryReaderThread.wait();
-    }
+    // The device, UAVTalk and the telemetry objects all live in the real time thread.
+    // Tear them down there and wait for it: the caller closes (and possibly deletes)
+    // the device right after this returns and the real time thread must be done with it.
+    // Only block on another thread that is running: a thread that is not running (e.g. at
+    // shutdown) would never serve the call, and blocking on the current thread deadlocks.
+    // In both cases nothing else runs in the real time thread, tear down from here.
+    bool blocking = thread() && thread() != QThread::currentThread() && thread()->isRunning();
+    QMetaObject::invokeMethod(this, "onStop", blocking ? Qt::BlockingQueuedConnection : Qt::DirectConnection);
 }
 
 void TelemetryManager::onStop()
 {
+    if (!m_uavTalk) {
+        // Never started, or already stopped
+        onDisconnect();
+        return;
+    }
+    if (m_useReaderThread) {
+        // Make sure the reader is done with UAVTalk before deleting it
+        m_telemetryReaderThread.quit();
+        m_telemetryReaderThread.wait();
+    }
+    if (m_telemetryRelay) {
+        m_telemetryRelayThread.quit();
+        m_telemetryRelayThread.wait();
+        m_telemetryRelay = 0;
+    }
+    if (m_telemetryCapture) {
+        // Let the capture write the data already queued to it before stopping its thread
+        QMetaObject::invokeMethod(m_telemetryCapture, "flush", Qt::BlockingQueuedConnection);
+        m_telemetryCaptureThread.quit();
+        m_telemetryCaptureThread.wait();
+        m_telemetryCapture = 0;
+    }
     m_telemetryMonitor->disconnect(this);
     delete m_telemetryMonitor;
     delete m_telemetry;
     delete m_uavTalk;
+    m_telemetryMonitor = 0;
+    m_telemetry = 0;
+    m_uavTalk   = 0;
     onDisconnect();
 }
 
@@ -145,7 +221,7 @@ void TelemetryManager::onTelemetryUpdate(double txRate, double rxRate)
 IODeviceReader::IODeviceReader(UAVTalk *uavTalk) : m_uavTalk(uavTalk)
 {}
 
-void IODeviceReader::read()
+void IODeviceReader::read(QByteArray block)
 {
-    m_uavTalk->processInputStream();
+    m_uavTalk->processInputBlock((quint8 *)block.data(), block.size());
 }
@@ -33,9 +33,12 @@
 #include "uavobjectmanager.h"
 #include <QIODevice>
 #include <QObject>
+#include <QThread>
 
 class Telemetry;
 class TelemetryMonitor;
+class TelemetryRelay;
+class TelemetryCapture;
 
 class UAVTALK_EXPORT TelemetryManager : public QObject {
     Q_OBJECT
@@ -49,6 +52,7 @@ public:
     };
 
     TelemetryManager();
+    TelemetryManager(UAVObjectManager *objMngr, QThread *thread);
     ~TelemetryManager();
 
     void start(QIODevice *dev);
@@ -63,7 +67,6 @@ signals:
     void disconnected();
     void telemetryUpdated(double txRate, double rxRate);
     void myStart();
-    void myStop();
 
 private slots:
     void onConnect();
@@ -79,7 +82,14 @@ private:
     TelemetryMonitor *m_telemetryMonitor;
     QIODevice *m_telemetryDevice;
     ConnectionState m_connectionState;
+    // The GCS own link, the relay and capture settings only apply to it
+    bool m_primary;
+    bool m_useReaderThread;
     QThread m_telemetryReaderThread;
+    TelemetryRelay *m_telemetryRelay;
+    QThread m_telemetryRelayThread;
+    TelemetryCapture *m_telemetryCapture;
+    QThread m_telemetryCaptureThread;
 };
 
 
@@ -91,7 +101,7 @@ public:
     UAVTalk *m_uavTalk;
 
 public slots:
-    void read();
+    void read(QByteArray block);
 };
 
 #endif // TELEMETRYMANAGER_H
@@ -38,14 +38,22 @@ TelemetryMonitor::TelemetryMonitor(UAVObjectManager *objMngr, Telemetry *tel) :
     gcsStatsObj(GCSTelemetryStats::GetInstance(objMngr)),
     flightStatsObj(FlightTelemetryStats::GetInstance(objMngr)),
     firmwareIAPObj(FirmwareIAPObj::GetInstance(objMngr)),
+    settingsDigestObj(SettingsDigest::GetInstance(objMngr)),
+    digestTimer(new QTimer(this)),
+    digestPage(0),
     statsTimer(new QTimer(this)),
-    objPending(NULL),
     mutex(new QMutex(QMutex::Recursive)),
     connectionTimer(new QTime())
 {
     // Listen for flight stats updates
     connect(flightStatsObj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(flightStatsUpdated(UAVObject *)));
 
+    // Listen for settings digest replies
+    connect(settingsDigestObj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(settingsDigestUpdated(UAVObject *)));
+    connect(settingsDigestObj, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(settingsDigestCompleted(UAVObject *, bool)));
+    digestTimer->setSingleShot(true);
+    connect(digestTimer, SIGNAL(timeout()), this, SLOT(settingsDigestTimeout()));
+
     // Start update timer
     connect(statsTimer, SIGNAL(timeout()), this, SLOT(processStatsUpdates()));
     statsTimer->start(STATS_CONNECT_PERIOD_MS);
@@ -87,7 +95,94 @@ void TelemetryMonitor::startRetrievingObjects()
             }
         }
     }
-    // Start retrieving
+    // Ask for the settings digest first, objects that are already up to date
+    // will be removed from the queue before retrieving starts
+    requestSettingsDigest(0);
+}
+
+/**
+ * Request one page of the settings digest from the autopilot
+ */
+void TelemetryMonitor::requestSettingsDigest(quint8 page)
+{
+    SettingsDigest::DataFields digest = settingsDigestObj->getData();
+
+    digest.Operation = SettingsDigest::OPERATION_REQUEST;
+    digest.Page = page;
+    digestPage  = page;
+    settingsDigestObj->setData(digest);
+    digestTimer->start(DIGEST_TIMEOUT_MS);
+    settingsDigestObj->updated();
+}
+
+/**
+ * Called when the autopilot replies with a page of the settings digest.
+ * Objects whose CRC matches the local copy are dropped from the queue.
+ */
+void TelemetryMonitor::settingsDigestUpdated(UAVObject *obj)
+{
+    Q_UNUSED(obj);
+    QMutexLocker locker(mutex);
+
+    SettingsDigest::DataFields digest = settingsDigestObj->getData();
+    if (!digestTimer->isActive() || digest.Operation != SettingsDigest::OPERATION_REPLY || digest.Page != digestPage) {
+        return;
+    }
+    digestTimer->stop();
+
+    bool lastPage = false;
+    for (quint32 n = 0; n < SettingsDigest::OBJECTID_NUMELEM; ++n) {
+        if (digest.ObjectID[n] == 0) {
+            lastPage = true;
+            break;
+        }
+        QList<UAVObject *> instances = objMngr->getObjectInstances(digest.ObjectID[n]);
+        if (instances.isEmpty()) {
+            continue;
+        }
+        quint8 crc = 0;
+        foreach(UAVObject * instance, instances) {
+            crc = instance->updateCRC(crc);
+        }
+        if (crc == digest.ObjectCRC[n] && queue.removeOne(instances.first())) {
+            foreach(UAVObject * instance, instances) {
+                instance->setIsKnown(true);
+            }
+        }
+    }
+
+    if (!lastPage && digestPage < 0xFF) {
+        requestSettingsDigest(digestPage + 1);
+    } else {
+        // Start retrieving
+        qDebug() << tr("Starting to retrieve meta and settings objects from the autopilot (%1 objects)")
+            .arg(queue.length());
+        retrieveNextObject();
+    }
+}
+
+/**
+ * Called when the settings digest request could not be delivered,
+ * e.g. the firmware does not know the SettingsDigest object.
+ */
+void TelemetryMonitor::settingsDigestCompleted(UAVObject *obj, bool success)
+{
+    Q_UNUSED(obj);
+    QMutexLocker locker(mutex);
+
+    if (!success && digestTimer->isActive()) {
+        settingsDigestTimeout();
+    }
+}
+
+/**
+ * No digest reply, retrieve all the remaining objects
+ */
+void TelemetryMonitor::settingsDigestTimeout()
+{
+    QMutexLocker locker(mutex);
+
+    digestTimer->stop();
     qDebug() << tr("Starting to retrieve meta and settings objects from the autopilot (%1 objects)")
         .arg(queue.length());
     retrieveNextObject();
@@ -99,35 +194,47 @@ void TelemetryMonitor::startRetrievingObjects()
 void TelemetryMonitor::stopRetrievingObjects()
 {
     qDebug("Object retrieval has been cancelled");
+    digestTimer->stop();
     queue.clear();
+    foreach(UAVObject * obj, objPending) {
+        obj->disconnect(this);
+    }
+    objPending.clear();
 }
 
 /**
- * Retrieve the next object in the queue
+ * Retrieve the next objects in the queue.
+ * Up to MAX_PENDING_REQUESTS requests are kept outstanding so that the
+ * retrieval is bounded by the link bandwidth rather than by its round-trip
+ * latency. Each request is retried by Telemetry with its own timer.
  */
 void TelemetryMonitor::retrieveNextObject()
 {
-    // If queue is empty return
+    // If queue is empty and no request is outstanding, we are done
     if (queue.isEmpty()) {
-        qDebug("Object retrieval completed");
-        if (firmwareIAPObj->getBoardType()) {
-            emit connected();
-        } else {
-            connect(firmwareIAPObj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(firmwareIAPUpdated(UAVObject *)));
+        if (objPending.isEmpty()) {
+            qDebug("Object retrieval completed");
+            if (firmwareIAPObj->getBoardType()) {
+                emit connected();
+            } else {
+                connect(firmwareIAPObj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(firmwareIAPUpdated(UAVObject *)));
+            }
         }
         return;
     }
 
-    // Get next object from the queue
-    UAVObject *obj = queue.dequeue();
-    // qDebug( tr("Retrieving object: %1").arg(obj->getName()) );
+    while (!queue.isEmpty() && objPending.size() < MAX_PENDING_REQUESTS) {
+        // Get next object from the queue
+        UAVObject *obj = queue.dequeue();
+        // qDebug( tr("Retrieving object: %1").arg(obj->getName()) );
 
-    // Connect to object
-    connect(obj, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(transactionCompleted(UAVObject *, bool)));
+        // Connect to object
+        connect(obj, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(transactionCompleted(UAVObject *, bool)));
 
-    // Request update
-    obj->requestUpdate();
-    objPending = obj;
+        // Request update (the transaction may complete immediately if it can not be sent)
+        objPending.insert(obj);
+        obj->requestUpdate();
+    }
 }
 
 /**
@@ -138,10 +245,9 @@ void TelemetryMonitor::transactionCompleted(UAVObject *obj, bool success)
     Q_UNUSED(success);
     QMutexLocker locker(mutex);
 
-    if (obj == objPending) {
+    if (objPending.remove(obj)) {
         // Disconnect from sending object
         obj->disconnect(this);
-        objPending = NULL;
         // Process next object if telemetry is still available
         GCSTelemetryStats::DataFields gcsStats = gcsStatsObj->getData();
 
@@ -30,6 +30,7 @@
 
 #include <QObject>
 #include <QQueue>
+#include <QSet>
 #include <QTimer>
 #include <QTime>
 #include <QMutex>
@@ -38,6 +39,7 @@
 #include "gcstelemetrystats.h"
 #include "flighttelemetrystats.h"
 #include "firmwareiapobj.h"
+#include "settingsdigest.h"
 #include "systemstats.h"
 #include "telemetry.h"
 
@@ -58,11 +60,16 @@ public slots:
     void processStatsUpdates();
     void flightStatsUpdated(UAVObject *obj);
     void firmwareIAPUpdated(UAVObject *obj);
+    void settingsDigestUpdated(UAVObject *obj);
+    void settingsDigestCompleted(UAVObject *obj, bool success);
+    void settingsDigestTimeout();
 
 private:
     static const int STATS_UPDATE_PERIOD_MS  = 4000;
     static const int STATS_CONNECT_PERIOD_MS = 2000;
     static const int CONNECTION_TIMEOUT_MS   = 8000;
+    static const int MAX_PENDING_REQUESTS    = 8;
+    static const int DIGEST_TIMEOUT_MS = 1000;
 
     UAVObjectManager *objMngr;
     Telemetry *tel;
@@ -70,14 +77,18 @@ private:
     GCSTelemetryStats *gcsStatsObj;
     FlightTelemetryStats *flightStatsObj;
     FirmwareIAPObj *firmwareIAPObj;
+    SettingsDigest *settingsDigestObj;
+    QTimer *digestTimer;
+    quint8 digestPage;
     QTimer *statsTimer;
-    UAVObject *objPending;
+    QSet<UAVObject *> objPending;
     QMutex *mutex;
     QTime *connectionTimer;
 
     void startRetrievingObjects();
     void retrieveNextObject();
     void stopRetrievingObjects();
+    void requestSettingsDigest(quint8 page);
 };
 
 #endif // TELEMETRYMONITOR_H
@@ -0,0 +1,263 @@
+/**
+ ******************************************************************************
+ *
+ * @file       telemetryrelay.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief The UAVTalk protocol plugin
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "telemetryrelay.h"
+#include <QDebug>
+#include <QTimer>
+#include <QtNetwork/QTcpServer>
+#include <QtNetwork/QTcpSocket>
+#include <QtNetwork/QUdpSocket>
+
+// Frames are batched and sent to the clients at this period
+#define FLUSH_PERIOD_MS      20
+// UDP clients must send a datagram (any content) at least this often to keep receiving
+#define UDP_CLIENT_TIMEOUT_MS 5000
+// Largest datagram sent to UDP clients, frames are never split
+#define UDP_MAX_DATAGRAM     1400
+// TCP clients that do not keep up are skipped until their backlog drains below this
+#define TCP_MAX_BACKLOG      (64 * 1024)
+
+TelemetryRelay::TelemetryRelay(quint16 port, quint32 clientRate) :
+    m_port(port), m_clientRate(clientRate), m_tcpServer(0), m_udpSocket(0),
+    m_flushTimer(0), m_lastFlush(0), m_pendingBytes(0)
+{}
+
+TelemetryRelay::~TelemetryRelay()
+{
+    // The sockets are children of the relay and go with it
+}
+
+/**
+ * Open the server sockets, must be called from the thread the relay lives in.
+ */
+void TelemetryRelay::start()
+{
+    m_tcpServer = new QTcpServer(this);
+    connect(m_tcpServer, SIGNAL(newConnection()), this, SLOT(newTcpConnection()));
+    if (!m_tcpServer->listen(QHostAddress::Any, m_port)) {
+        qWarning() << "TelemetryRelay - could not listen on TCP port" << m_port << m_tcpServer->errorString();
+    }
+
+    m_udpSocket = new QUdpSocket(this);
+    connect(m_udpSocket, SIGNAL(readyRead()), this, SLOT(udpReadyRead()));
+    if (!m_udpSocket->bind(QHostAddress::Any, m_port)) {
+        qWarning() << "TelemetryRelay - could not bind UDP port" << m_port << m_udpSocket->errorString();
+    }
+
+    m_clock.start();
+    m_flushTimer = new QTimer(this);
+    connect(m_flushTimer, SIGNAL(timeout()), this, SLOT(flush()));
+    m_flushTimer->start(FLUSH_PERIOD_MS);
+}
+
+void TelemetryRelay::relayFrame(QByteArray frame)
+{
+    if (m_clients.isEmpty()) {
+        return;
+    }
+    m_frames.append(frame);
+    m_pendingBytes += frame.size();
+}
+
+void TelemetryRelay::newTcpConnection()
+{
+    while (m_tcpServer->hasPendingConnections()) {
+        QTcpSocket *socket = m_tcpServer->nextPendingConnection();
+        socket->setParent(this);
+        connect(socket, SIGNAL(disconnected()), this, SLOT(tcpDisconnected()));
+        connect(socket, SIGNAL(readyRead()), this, SLOT(tcpReadyRead()));
+
+        Client client;
+        client.socket   = socket;
+        client.address  = socket->peerAddress();
+        client.port     = socket->peerPort();
+        client.budget   = m_clientRate;
+        client.lastSeen = m_clock.elapsed();
+        client.dropped  = 0;
+        m_clients.append(client);
+        qDebug() << "TelemetryRelay - TCP client" << client.address.toString() << client.port << "connected";
+    }
+}
+
+void TelemetryRelay::tcpDisconnected()
+{
+    QTcpSocket *socket = qobject_cast<QTcpSocket *>(sender());
+
+    for (int i = 0; i < m_clients.size(); i++) {
+        if (m_clients[i].socket == socket) {
+            removeClient(i);
+            break;
+        }
+    }
+}
+
+void TelemetryRelay::tcpReadyRead()
+{
+    // The relay is receive only
+    QTcpSocket *socket = qobject_cast<QTcpSocket *>(sender());
+
+    socket->readAll();
+}
+
+void TelemetryRelay::udpReadyRead()
+{
+    while (m_udpSocket->hasPendingDatagrams()) {
+        QHostAddress address;
+        quint16 port;
+        char dummy;
+        m_udpSocket->readDatagram(&dummy, sizeof(dummy), &address, &port);
+
+        int i;
+        for (i = 0; i < m_clients.size(); i++) {
+            if (!m_clients[i].socket && m_clients[i].address == address && m_clients[i].port == port) {
+                break;
+            }
+        }
+        if (i == m_clients.size()) {
+            Client client;
+            client.socket  = 0;
+            client.address = address;
+            client.port    = port;
+            client.budget  = m_clientRate;
+            client.dropped = 0;
+            m_clients.append(client);
+            qDebug() << "TelemetryRelay - UDP client" << address.toString() << port << "registered";
+        }
+        m_clients[i].lastSeen = m_clock.elapsed();
+    }
+}
+
+/**
+ * Send the frames received since the last call to every client, within its rate limit.
+ */
+void TelemetryRelay::flush()
+{
+    qint64 now = m_clock.elapsed();
+    qint64 refill = (qint64)m_clientRate * (now - m_lastFlush) / 1000;
+
+    m_lastFlush = now;
+
+    // Everything received since the last flush, shared by all the clients that can take it
+    QByteArray batch;
+    if (m_pendingBytes > 0) {
+        batch.reserve(m_pendingBytes);
+        foreach(const QByteArray &frame, m_frames) {
+            batch.append(frame);
+        }
+    }
+
+    for (int i = m_clients.size() - 1; i >= 0; i--) {
+        Client &client = m_clients[i];
+
+        if (!client.socket && now - client.lastSeen > UDP_CLIENT_TIMEOUT_MS) {
+            removeClient(i);
+            continue;
+        }
+        // Allow bursts of up to a second worth of data
+        client.budget = qMin(client.budget + refill, (qint64)m_clientRate);
+
+        if (batch.isEmpty()) {
+            continue;
+        }
+
+        if (m_clientRate == 0) {
+            if (!sendTo(client, batch)) {
+                client.dropped += m_frames.size();
+            }
+            continue;
+        }
+
+        if (client.budget >= batch.size()) {
+            client.budget -= batch.size();
+            if (!sendTo(client, batch)) {
+                client.dropped += m_frames.size();
+            }
+            continue;
+        }
+
+        // Over the limit, send the frames that fit and drop the others
+        QByteArray limited;
+        int count = 0;
+        foreach(const QByteArray &frame, m_frames) {
+            if (client.budget >= frame.size()) {
+                client.budget -= frame.size();
+                limited.append(frame);
+                count++;
+            }
+        }
+        client.dropped += m_frames.size() - count;
+        if (!limited.isEmpty() && !sendTo(client, limited)) {
+            client.dropped += count;
+        }
+    }
+
+    m_frames.clear();
+    m_pendingBytes = 0;
+}
+
+/**
+ * Send data made of whole frames to a client.
+ * \return false if the data was dropped because the client does not keep up
+ */
+bool TelemetryRelay::sendTo(Client &client, const QByteArray &data)
+{
+    if (client.socket) {
+        if (client.socket->bytesToWrite() > TCP_MAX_BACKLOG) {
+            return false;
+        }
+        client.socket->write(data);
+        return true;
+    }
+
+    // Split the data in datagrams on frame boundaries, the frame length is in the header
+    int start = 0;
+    int pos   = 0;
+    while (pos < data.size()) {
+        int frameLength = (pos + 4 <= data.size()) ?
+                          ((quint8)data[pos + 2] | ((quint8)data[pos + 3] << 8)) + 1 : data.size() - pos;
+        if (pos > start && pos + frameLength - start > UDP_MAX_DATAGRAM) {
+            m_udpSocket->writeDatagram(data.constData() + start, pos - start, client.address, client.port);
+            start = pos;
+        }
+        pos += frameLength;
+    }
+    if (start < data.size()) {
+        m_udpSocket->writeDatagram(data.constData() + start, data.size() - start, client.address, client.port);
+    }
+    return true;
+}
+
+void TelemetryRelay::removeClient(int index)
+{
+    Client &client = m_clients[index];
+
+    qDebug() << "TelemetryRelay - client" << client.address.toString() << client.port << "removed," << client.dropped << "frames dropped";
+    if (client.socket) {
+        client.socket->deleteLater();
+    }
+    m_clients.removeAt(index);
+}
@@ -0,0 +1,95 @@
+/**
+ ******************************************************************************
+ *
+ * @file       telemetryrelay.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief The UAVTalk protocol plugin
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef TELEMETRYRELAY_H
+#define TELEMETRYRELAY_H
+
+#include "uavtalk_global.h"
+#include <QObject>
+#include <QList>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QHostAddress>
+
+class QTcpServer;
+class QTcpSocket;
+class QUdpSocket;
+class QTimer;
+
+/**
+ * Relays the telemetry received from the aircraft to observer stations.
+ * The received UAVTalk frames are forwarded as they are, without decoding or re-encoding,
+ * to every client connected over TCP and to every UDP client that sent a datagram to the
+ * relay port in the last few seconds. The relay is receive only, whatever the clients send
+ * is discarded. Each client gets at most clientRate bytes per second (0 for no limit),
+ * frames over the limit are dropped for that client only.
+ */
+class UAVTALK_EXPORT TelemetryRelay : public QObject {
+    Q_OBJECT
+
+public:
+    TelemetryRelay(quint16 port, quint32 clientRate);
+    ~TelemetryRelay();
+
+public slots:
+    void start();
+    void relayFrame(QByteArray frame);
+
+private slots:
+    void newTcpConnection();
+    void tcpDisconnected();
+    void tcpReadyRead();
+    void udpReadyRead();
+    void flush();
+
+private:
+    struct Client {
+        QTcpSocket   *socket; // NULL for UDP clients
+        QHostAddress address;
+        quint16      port;
+        qint64 budget; // bytes it can still be sent
+        qint64 lastSeen; // ms, UDP clients only
+        quint32 dropped;
+    };
+
+    bool sendTo(Client &client, const QByteArray &data);
+    void removeClient(int index);
+
+    quint16 m_port;
+    quint32 m_clientRate;
+    QTcpServer *m_tcpServer;
+    QUdpSocket *m_udpSocket;
+    QTimer *m_flushTimer;
+    QElapsedTimer m_clock;
+    qint64 m_lastFlush;
+
+    QList<Client> m_clients;
+    // Frames received since the last flush
+    QList<QByteArray> m_frames;
+    int m_pendingBytes;
+};
+
+#endif // TELEMETRYRELAY_H
@@ -0,0 +1,83 @@
+/**
+ ******************************************************************************
+ *
+ * @file       allocationcounter.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief The UAVTalk protocol plugin
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "allocationcounter.h"
+
+#include <stdlib.h>
+
+#if defined(__GLIBC__)
+
+// The allocator entry points are interposed, the calls made by the Qt and GCS libraries are counted too
+extern "C" {
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t nmemb, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+
+static volatile quint64 allocations;
+
+void *malloc(size_t size)
+{
+    __sync_fetch_and_add(&allocations, 1);
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t nmemb, size_t size)
+{
+    __sync_fetch_and_add(&allocations, 1);
+    return __libc_calloc(nmemb, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+    __sync_fetch_and_add(&allocations, 1);
+    return __libc_realloc(ptr, size);
+}
+}
+
+bool AllocationCounter::supported()
+{
+    return true;
+}
+
+quint64 AllocationCounter::count()
+{
+    return allocations;
+}
+
+#else /* if defined(__GLIBC__) */
+
+bool AllocationCounter::supported()
+{
+    return false;
+}
+
+quint64 AllocationCounter::count()
+{
+    return 0;
+}
+
+#endif /* if defined(__GLIBC__) */
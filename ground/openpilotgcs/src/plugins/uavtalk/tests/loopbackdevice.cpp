@@ -0,0 +1,79 @@
+/**
+ ******************************************************************************
+ *
+ * @file       loopbackdevice.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief The UAVTalk protocol plugin
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "loopbackdevice.h"
+
+#include <string.h>
+
+LoopbackDevice::LoopbackDevice(bool keepOutput, QObject *parent) :
+    QIODevice(parent), m_inputPos(0), m_keepOutput(keepOutput), m_outputBytes(0)
+{
+    // Unbuffered so that bytesAvailable() and readyRead() match what was fed
+    open(QIODevice::ReadWrite | QIODevice::Unbuffered);
+}
+
+qint64 LoopbackDevice::bytesAvailable() const
+{
+    return m_input.size() - m_inputPos + QIODevice::bytesAvailable();
+}
+
+void LoopbackDevice::feed(const QByteArray &data)
+{
+    if (m_inputPos == m_input.size()) {
+        m_input    = data;
+        m_inputPos = 0;
+    } else {
+        m_input.append(data);
+    }
+    emit readyRead();
+}
+
+QByteArray LoopbackDevice::takeOutput()
+{
+    QByteArray output = m_output;
+
+    m_output.clear();
+    return output;
+}
+
+qint64 LoopbackDevice::readData(char *data, qint64 maxSize)
+{
+    qint64 size = qMin(maxSize, (qint64)(m_input.size() - m_inputPos));
+
+    memcpy(data, m_input.constData() + m_inputPos, size);
+    m_inputPos += size;
+    return size;
+}
+
+qint64 LoopbackDevice::writeData(const char *data, qint64 size)
+{
+    if (m_keepOutput) {
+        m_output.append(data, size);
+    }
+    m_outputBytes += size;
+    return size;
+}
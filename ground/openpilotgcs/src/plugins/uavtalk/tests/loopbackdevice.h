@@ -0,0 +1,70 @@
+/**
+ ******************************************************************************
+ *
+ * @file       loopbackdevice.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief The UAVTalk protocol plugin
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef LOOPBACKDEVICE_H
+#define LOOPBACKDEVICE_H
+
+#include <QIODevice>
+#include <QByteArray>
+
+/**
+ * In memory sequential device standing for the telemetry link.
+ * Data passed to feed() is read back by the device user, readyRead() is emitted
+ * synchronously so the reader decodes it before feed() returns.
+ * Data written by the device user is counted and, if asked for, kept.
+ */
+class LoopbackDevice : public QIODevice {
+    Q_OBJECT
+
+public:
+    explicit LoopbackDevice(bool keepOutput, QObject *parent = 0);
+
+    bool isSequential() const
+    {
+        return true;
+    }
+    qint64 bytesAvailable() const;
+
+    void feed(const QByteArray &data);
+    QByteArray takeOutput();
+    qint64 outputBytes() const
+    {
+        return m_outputBytes;
+    }
+
+protected:
+    qint64 readData(char *data, qint64 maxSize);
+    qint64 writeData(const char *data, qint64 size);
+
+private:
+    QByteArray m_input;
+    int m_inputPos;
+    bool m_keepOutput;
+    QByteArray m_output;
+    qint64 m_outputBytes;
+};
+
+#endif // LOOPBACKDEVICE_H
@@ -0,0 +1,72 @@
+/**
+ ******************************************************************************
+ *
+ * @file       main.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief The UAVTalk protocol plugin
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QTimer>
+
+#include "uavtalkbenchmark.h"
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+
+    parser.setApplicationDescription("Measures the GCS UAVTalk/UAVObject/Telemetry data path over a loopback device.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("file", "Stream to replay, raw UAVTalk bytes or a GCS log (.opl). A synthetic stream is used when omitted.", "[file]");
+    QCommandLineOption objectsOption(QStringList() << "o" << "objects", "Comma separated objects of the synthetic stream (default all telemetry objects).", "names");
+    QCommandLineOption framesOption(QStringList() << "n" << "frames", "Frames in the synthetic stream (default 100000).", "count", "100000");
+    QCommandLineOption repeatOption(QStringList() << "r" << "repeat", "Times the stream is fed (default 1).", "count", "1");
+    QCommandLineOption rateOption(QStringList() << "b" << "rate", "Feed rate in bytes per second, 0 for full speed (default 0).", "bytes", "0");
+    QCommandLineOption chunkOption(QStringList() << "c" << "chunk", "Bytes per read (default 64).", "bytes", "64");
+    QCommandLineOption telemetryOption(QStringList() << "t" << "telemetry", "Run Telemetry on top of UAVTalk.");
+    parser.addOption(objectsOption);
+    parser.addOption(framesOption);
+    parser.addOption(repeatOption);
+    parser.addOption(rateOption);
+    parser.addOption(chunkOption);
+    parser.addOption(telemetryOption);
+    parser.process(app);
+
+    UAVTalkBenchmark::Options options;
+    options.replayFile = parser.positionalArguments().value(0);
+    options.objects    = parser.value(objectsOption).split(',', QString::SkipEmptyParts);
+    options.frames     = qMax(1, parser.value(framesOption).toInt());
+    options.repeat     = qMax(1, parser.value(repeatOption).toInt());
+    options.rate = parser.value(rateOption).toUInt();
+    options.chunkSize  = qMax(1, parser.value(chunkOption).toInt());
+    options.telemetry  = parser.isSet(telemetryOption);
+
+    UAVTalkBenchmark benchmark(options);
+    QObject::connect(&benchmark, SIGNAL(finished()), &app, SLOT(quit()), Qt::QueuedConnection);
+    QTimer::singleShot(0, &benchmark, SLOT(run()));
+
+    app.exec();
+    return benchmark.result();
+}
@@ -0,0 +1,252 @@
+/**
+ ******************************************************************************
+ *
+ * @file       uavtalkbenchmark.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief The UAVTalk protocol plugin
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "uavtalkbenchmark.h"
+#include "loopbackdevice.h"
+#include "allocationcounter.h"
+
+#include "uavobjectmanager.h"
+#include "uavobjectsinit.h"
+#include "uavtalk/uavtalk.h"
+#include "uavtalk/telemetry.h"
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QtAlgorithms>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+// Frames are fed at this period when running at a given rate
+#define FEED_PERIOD_MS 1
+
+static qint64 cpuTimeMs()
+{
+    return (qint64)clock() * 1000 / CLOCKS_PER_SEC;
+}
+
+UAVTalkBenchmark::UAVTalkBenchmark(const Options &options) :
+    m_options(options), m_result(0), m_streamFrames(0), m_objMngr(0), m_device(0), m_talk(0), m_telemetry(0),
+    m_fedBytes(0), m_totalBytes(0), m_fedAt(0), m_startAllocations(0), m_startCpu(0)
+{
+    m_feedTimer.setTimerType(Qt::PreciseTimer);
+    connect(&m_feedTimer, SIGNAL(timeout()), this, SLOT(feed()));
+}
+
+UAVTalkBenchmark::~UAVTalkBenchmark()
+{
+    delete m_telemetry;
+    delete m_talk;
+    delete m_device;
+    delete m_objMngr;
+}
+
+void UAVTalkBenchmark::run()
+{
+    m_stream = m_options.replayFile.isEmpty() ? synthesize() : load(m_options.replayFile);
+    if (m_stream.isEmpty()) {
+        fprintf(stderr, "uavtalkbenchmark: empty stream\n");
+        m_result = 1;
+        emit finished();
+        return;
+    }
+
+    m_objMngr = new UAVObjectManager();
+    UAVObjectsInitialize(m_objMngr);
+    m_device  = new LoopbackDevice(false);
+    m_talk    = new UAVTalk(m_device, m_objMngr);
+    connect(m_device, SIGNAL(readyRead()), m_talk, SLOT(processInputStream()));
+    if (m_options.telemetry) {
+        m_telemetry = new Telemetry(m_talk, m_objMngr);
+    }
+
+    foreach(QList<UAVObject *> instances, m_objMngr->getObjects()) {
+        foreach(UAVObject * obj, instances) {
+            connect(obj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(objectUpdated(UAVObject *)));
+        }
+    }
+
+    m_totalBytes = (qint64)m_stream.size() * m_options.repeat;
+    m_latencies.reserve(m_streamFrames > 0 ? m_streamFrames * m_options.repeat : m_totalBytes / 16);
+
+    printf("stream: %d bytes%s, fed %d time(s) in %d byte reads at %s\n", m_stream.size(),
+           m_streamFrames > 0 ? qPrintable(QString(", %1 frames").arg(m_streamFrames)) : "",
+           m_options.repeat, m_options.chunkSize,
+           m_options.rate ? qPrintable(QString("%1 bytes/s").arg(m_options.rate)) : "full speed");
+
+    // Let Telemetry settle (initial object requests) before measuring
+    QCoreApplication::processEvents();
+    m_talk->resetStats();
+
+    m_startAllocations = AllocationCounter::count();
+    m_startCpu = cpuTimeMs();
+    m_clock.start();
+    if (m_options.rate) {
+        m_feedTimer.start(FEED_PERIOD_MS);
+    } else {
+        QTimer::singleShot(0, this, SLOT(feed()));
+    }
+}
+
+/**
+ * Feed the chunks that are due, all of them when running at full speed
+ */
+void UAVTalkBenchmark::feed()
+{
+    qint64 due = m_options.rate ? qMin(m_totalBytes, m_clock.elapsed() * m_options.rate / 1000) : m_totalBytes;
+
+    while (m_fedBytes < due) {
+        int offset = m_fedBytes % m_stream.size();
+        int size   = qMin((qint64)qMin(m_options.chunkSize, m_stream.size() - offset), due - m_fedBytes);
+
+        m_fedAt = m_clock.nsecsElapsed();
+        m_device->feed(m_stream.mid(offset, size));
+        m_fedBytes += size;
+        if (!m_options.rate && m_telemetry) {
+            // Telemetry queues its work, give it a chance to run as it would in the GCS
+            QCoreApplication::processEvents();
+        }
+    }
+
+    if (m_fedBytes >= m_totalBytes) {
+        m_feedTimer.stop();
+        report();
+        emit finished();
+    }
+}
+
+void UAVTalkBenchmark::objectUpdated(UAVObject *obj)
+{
+    Q_UNUSED(obj);
+    m_latencies.append(m_clock.nsecsElapsed() - m_fedAt);
+}
+
+void UAVTalkBenchmark::report()
+{
+    qint64 wallNs = m_clock.nsecsElapsed();
+    qint64 cpuMs  = cpuTimeMs() - m_startCpu;
+    quint64 allocations = AllocationCounter::count() - m_startAllocations;
+    UAVTalk::ComStats stats = m_talk->getStats();
+    double seconds = wallNs / 1e9;
+
+    printf("decoded: %u packets, %u rx errors (%u sync, %u crc)\n",
+           stats.rxObjects, stats.rxErrors, stats.rxSyncErrors, stats.rxCrcErrors);
+    printf("time: %.1f ms wall, %lld ms cpu (%.0f%%)\n", wallNs / 1e6, cpuMs, seconds > 0 ? 100.0 * cpuMs / 1000.0 / seconds : 0.0);
+    printf("throughput: %.0f packets/s, %.2f MB/s\n", stats.rxObjects / seconds, m_totalBytes / seconds / 1e6);
+
+    if (!m_latencies.isEmpty()) {
+        qSort(m_latencies);
+        qint64 sum = 0;
+        foreach(qint64 latency, m_latencies) {
+            sum += latency;
+        }
+        printf("update latency: %.2f us mean, %.2f us p50, %.2f us p99, %.2f us max (%d updates)\n",
+               sum / 1e3 / m_latencies.size(),
+               m_latencies[m_latencies.size() / 2] / 1e3,
+               m_latencies[m_latencies.size() * 99 / 100] / 1e3,
+               m_latencies.last() / 1e3, m_latencies.size());
+    }
+
+    if (AllocationCounter::supported() && stats.rxObjects > 0) {
+        printf("allocations: %llu, %.2f per packet\n", allocations, (double)allocations / stats.rxObjects);
+    }
+    if (m_telemetry) {
+        printf("telemetry: %lld bytes sent\n", m_device->outputBytes());
+    }
+}
+
+/**
+ * Encode random data for the selected objects with a second object manager and UAVTalk
+ */
+QByteArray UAVTalkBenchmark::synthesize()
+{
+    UAVObjectManager objMngr;
+
+    UAVObjectsInitialize(&objMngr);
+    LoopbackDevice device(true);
+    UAVTalk talk(&device, &objMngr);
+
+    QList<UAVObject *> objects;
+    foreach(QList<UAVDataObject *> instances, objMngr.getDataObjects()) {
+        UAVDataObject *obj = instances.first();
+
+        if (m_options.objects.isEmpty() ? !obj->isSettingsObject() : m_options.objects.contains(obj->getName())) {
+            objects.append(obj);
+        }
+    }
+    if (objects.isEmpty()) {
+        return QByteArray();
+    }
+
+    qsrand(1234);
+    for (int i = 0; i < m_options.frames; i++) {
+        UAVObject *obj = objects[i % objects.size()];
+        QByteArray data(obj->getNumBytes(), 0);
+        for (int j = 0; j < data.size(); j++) {
+            data[j] = (char)qrand();
+        }
+        obj->unpack((const quint8 *)data.constData());
+        talk.sendObject(obj, false, false);
+    }
+    m_streamFrames = m_options.frames;
+
+    return device.takeOutput();
+}
+
+/**
+ * Load a stream recorded as raw UAVTalk bytes, or a GCS log file (.opl)
+ * made of records of timestamp (quint32, ms), size (qint64) and the raw bytes.
+ */
+QByteArray UAVTalkBenchmark::load(const QString &fileName)
+{
+    QFile file(fileName);
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        fprintf(stderr, "uavtalkbenchmark: cannot open %s\n", qPrintable(fileName));
+        return QByteArray();
+    }
+    QByteArray contents = file.readAll();
+    if (!fileName.endsWith(".opl", Qt::CaseInsensitive)) {
+        return contents;
+    }
+
+    QByteArray stream;
+    const int headerSize = sizeof(quint32) + sizeof(qint64);
+    int pos = 0;
+    while (pos + headerSize <= contents.size()) {
+        qint64 size;
+        memcpy(&size, contents.constData() + pos + sizeof(quint32), sizeof(size));
+        pos += headerSize;
+        if (size < 0 || size > contents.size() - pos) {
+            fprintf(stderr, "uavtalkbenchmark: %s is corrupted at offset %d\n", qPrintable(fileName), pos);
+            break;
+        }
+        stream.append(contents.constData() + pos, size);
+        pos += size;
+    }
+    return stream;
+}
@@ -0,0 +1,114 @@
+/**
+ ******************************************************************************
+ *
+ * @file       uavtalkbenchmark.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief The UAVTalk protocol plugin
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef UAVTALKBENCHMARK_H
+#define UAVTALKBENCHMARK_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QTimer>
+#include <QVector>
+
+class UAVObject;
+class UAVObjectManager;
+class UAVTalk;
+class Telemetry;
+class LoopbackDevice;
+
+/**
+ * Feeds a UAVTalk stream through the GCS data path (UAVTalk decoding, UAVObjectManager
+ * object updates and, optionally, Telemetry) over a LoopbackDevice and reports the
+ * decoded packets per second, the latency from the data being read to the object
+ * update signal, the heap allocations per packet and the CPU used.
+ *
+ * The stream is either synthesized by encoding random data for the telemetry objects,
+ * or replayed from a file holding raw UAVTalk bytes or a GCS log (.opl).
+ * It is fed in chunks, as a serial or USB link would deliver it, as fast as possible
+ * or at a given byte rate.
+ */
+class UAVTalkBenchmark : public QObject {
+    Q_OBJECT
+
+public:
+    struct Options {
+        QString     replayFile; // empty for a synthetic stream
+        QStringList objects; // objects in the synthetic stream, all telemetry objects when empty
+        int frames; // frames in the synthetic stream
+        int repeat; // times the stream is fed
+        quint32     rate; // bytes per second, 0 for as fast as possible
+        int chunkSize; // bytes per read
+        bool telemetry; // run Telemetry on top of UAVTalk
+    };
+
+    explicit UAVTalkBenchmark(const Options &options);
+    ~UAVTalkBenchmark();
+
+    // Exit code, valid once finished() has been emitted
+    int result() const
+    {
+        return m_result;
+    }
+
+signals:
+    void finished();
+
+public slots:
+    void run();
+
+private slots:
+    void feed();
+    void objectUpdated(UAVObject *obj);
+
+private:
+    QByteArray synthesize();
+    QByteArray load(const QString &fileName);
+    void report();
+
+    Options m_options;
+    int m_result;
+    QByteArray m_stream;
+    int m_streamFrames;
+
+    UAVObjectManager *m_objMngr;
+    LoopbackDevice *m_device;
+    UAVTalk *m_talk;
+    Telemetry *m_telemetry;
+
+    QTimer m_feedTimer;
+    QElapsedTimer m_clock;
+    qint64 m_fedBytes;
+    qint64 m_totalBytes;
+    // time the chunk being decoded was fed, ns
+    qint64 m_fedAt;
+    QVector<qint64> m_latencies;
+
+    quint64 m_startAllocations;
+    qint64 m_startCpu;
+};
+
+#endif // UAVTALKBENCHMARK_H
@@ -0,0 +1,29 @@
+# -------------------------------------------------
+# Headless benchmark of the GCS telemetry data path:
+# UAVTalk decoding, UAVObject updates and Telemetry.
+# Build it after the GCS, it links against the plugins.
+# -------------------------------------------------
+QT += network
+TARGET = uavtalkbenchmark
+CONFIG += console
+CONFIG -= app_bundle
+TEMPLATE = app
+
+include(../../../../openpilotgcs.pri)
+include(../uavtalk.pri)
+
+INCLUDEPATH += $$GCS_SOURCE_TREE/src/plugins
+LIBS += -L$$GCS_PLUGIN_PATH/OpenPilot
+linux-* {
+    QMAKE_RPATHDIR += $$GCS_PLUGIN_PATH/OpenPilot
+    QMAKE_RPATHDIR += $$GCS_LIBRARY_PATH
+}
+
+SOURCES += main.cpp \
+    loopbackdevice.cpp \
+    allocationcounter.cpp \
+    uavtalkbenchmark.cpp
+
+HEADERS += loopbackdevice.h \
+    allocationcounter.h \
+    uavtalkbenchmark.h
@@ -49,16 +49,20 @@ using namespace Utils;
 /**
  * Constructor
  */
-UAVTalk::UAVTalk(QIODevice *iodev, UAVObjectManager *objMngr) : io(iodev), objMngr(objMngr), mutex(QMutex::Recursive)
+UAVTalk::UAVTalk(QIODevice *iodev, UAVObjectManager *objMngr) : io(iodev), objMngr(objMngr), mutex(QMutex::Recursive), forwardInput(false), relayFrames(false),
+    captureData(false), captureEpoch(0)
 {
     rxState = STATE_SYNC;
     rxPacketLength = 0;
+    rxTimestamped  = false;
+    rxTimestamp    = 0;
 
     memset(&stats, 0, sizeof(ComStats));
 
+    // There are no GCS settings when used outside of the GCS (uavtalkbenchmark)
     ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
-    Core::Internal::GeneralSettings *settings = pm->getObject<Core::Internal::GeneralSettings>();
-    useUDPMirror = settings->useUDPMirror();
+    Core::Internal::GeneralSettings *settings = pm ? pm->getObject<Core::Internal::GeneralSettings>() : 0;
+    useUDPMirror = settings && settings->useUDPMirror();
     qDebug() << "USE UDP:::::::::::." << useUDPMirror;
     if (useUDPMirror) {
         udpSocketTx = new QUdpSocket(this);
@@ -98,6 +102,47 @@ UAVTalk::ComStats UAVTalk::getStats()
     return stats;
 }
 
+/**
+ * Select where the received data is decoded.
+ * When set the blocks read from the device are not decoded in the device thread but emitted
+ * with inputReceived(), the receiver (usually in another thread) then decodes them by
+ * calling processInputBlock().
+ * The UDP mirror is only supported when the input is decoded in the device thread.
+ */
+void UAVTalk::setForwardInput(bool forward)
+{
+    forwardInput = forward && !useUDPMirror;
+}
+
+/**
+ * When set every valid frame received is also emitted as is with frameReceived(),
+ * for the telemetry relay.
+ */
+void UAVTalk::setRelayFrames(bool relay)
+{
+    relayFrames = relay;
+}
+
+/**
+ * When set the blocks read from the device and the packets written to it are also
+ * emitted as is with dataCaptured(), for the telemetry capture.
+ * The blocks are shared with the decoder, not copied, and are timestamped (in microseconds
+ * since the epoch) in the device thread as soon as they are read.
+ */
+void UAVTalk::setCaptureData(bool capture)
+{
+    captureData = capture;
+    if (capture) {
+        captureEpoch = QDateTime::currentMSecsSinceEpoch() * 1000;
+        captureClock.start();
+    }
+}
+
+qint64 UAVTalk::captureTime() const
+{
+    return captureEpoch + captureClock.nsecsElapsed() / 1000;
+}
+
 void UAVTalk::dummyUDPRead()
 {
     QUdpSocket *socket = qobject_cast<QUdpSocket *>(sender());
@@ -208,33 +253,155 @@ bool UAVTalk::objectTransaction(quint8 type, quint32 objId, quint16 instId, UAVO
  */
 void UAVTalk::processInputStream()
 {
-    quint8 tmp;
-
     if (io && io->isReadable()) {
         while (io->bytesAvailable() > 0) {
-            int ret = io->read((char *)&tmp, 1);
-            if (ret != -1) {
-                processInputByte(tmp);
+            QByteArray block = io->readAll();
+            if (block.isEmpty()) {
+                break;
+            }
+            if (captureData) {
+                emit dataCaptured(captureTime(), block, false);
+            }
+            if (forwardInput) {
+                emit inputReceived(block);
             } else {
-                // TODOD
+                processInputBlock((quint8 *)block.data(), block.size());
             }
-            if (rxState == STATE_COMPLETE) {
-                mutex.lock();
-                if (receiveObject(rxType, rxObjId, rxInstId, rxBuffer, rxLength)) {
-                    stats.rxObjectBytes += rxLength;
-                    stats.rxObjects++;
-                } else {
-                    // TODO...
-                }
-                mutex.unlock();
+        }
+    }
+}
 
-                if (useUDPMirror) {
-                    // it is safe to do this outside of the above critical section as the rxDataArray is
-                    // accessed from this thread only
-                    udpSocketTx->writeDatagram(rxDataArray, QHostAddress::LocalHost, udpSocketRx->localPort());
+/**
+ * Process a block of bytes read from the telemetry stream.
+ * Complete frames found in the block are validated and unpacked in place, only the frames
+ * that span several blocks (or that fail to validate) go through the byte by byte state machine.
+ * \param[in] data Received bytes
+ * \param[in] length Number of received bytes
+ */
+void UAVTalk::processInputBlock(quint8 *data, qint32 length)
+{
+    qint32 pos = 0;
+
+    while (pos < length) {
+        if (rxState == STATE_SYNC || rxState == STATE_COMPLETE || rxState == STATE_ERROR) {
+            if (rxState != STATE_SYNC) {
+                rxState = STATE_SYNC;
+                if (useUDPMirror || relayFrames) {
+                    rxDataArray.clear();
                 }
             }
+
+            // Skip everything up to the next sync byte
+            quint8 *sync = (quint8 *)memchr(&data[pos], SYNC_VAL, length - pos);
+            qint32 skip  = (sync != NULL) ? (qint32)(sync - &data[pos]) : (length - pos);
+            if (skip > 0) {
+                stats.rxBytes      += skip;
+                stats.rxSyncErrors += skip;
+                pos += skip;
+                continue;
+            }
+
+            // Try to handle a whole frame straight from the block
+            qint32 frameLength = processInputFrame(&data[pos], length - pos);
+            if (frameLength > 0) {
+                pos += frameLength;
+                continue;
+            }
         }
+
+        processInputByte(data[pos++]);
+        if (rxState == STATE_COMPLETE) {
+            dispatchObject(rxType, rxObjId, rxInstId, rxBuffer, rxLength);
+            if (rxTimestamped) {
+                emit objectTimestamped(rxObjId, rxInstId, rxTimestamp);
+            }
+
+            if (useUDPMirror) {
+                // it is safe to do this outside of the critical section as the rxDataArray is
+                // accessed from this thread only
+                udpSocketTx->writeDatagram(rxDataArray, QHostAddress::LocalHost, udpSocketRx->localPort());
+            }
+            if (relayFrames) {
+                emit frameReceived(rxDataArray);
+            }
+        }
+    }
+}
+
+/**
+ * Process a complete frame starting with a sync byte, without copying it.
+ * Does nothing if the frame is incomplete or invalid, the caller then falls back on the
+ * byte by byte state machine which takes care of error reporting and resynchronisation.
+ * \param[in] data Received bytes, data[0] is a sync byte
+ * \param[in] length Number of received bytes
+ * \return The length of the processed frame, 0 if nothing was done
+ */
+qint32 UAVTalk::processInputFrame(quint8 *data, qint32 length)
+{
+    if (length < HEADER_LENGTH + CHECKSUM_LENGTH) {
+        return 0;
+    }
+
+    quint8 type = data[1];
+    if ((type & TYPE_MASK) != TYPE_VER) {
+        return 0;
+    }
+
+    qint32 size = qFromLittleEndian<quint16>(&data[2]);
+    if (size < HEADER_LENGTH || size > HEADER_LENGTH + MAX_PAYLOAD_LENGTH || length < size + CHECKSUM_LENGTH) {
+        return 0;
+    }
+
+    quint32 objId  = qFromLittleEndian<quint32>(&data[4]);
+    quint16 instId = qFromLittleEndian<quint16>(&data[8]);
+
+    // Determine data length, same rules as the state machine
+    qint32 dataLength;
+    if (type == TYPE_OBJ_REQ || type == TYPE_ACK || type == TYPE_NACK) {
+        dataLength = 0;
+    } else if (type == TYPE_BUNDLE) {
+        dataLength = size - HEADER_LENGTH;
+    } else {
+        UAVObject *obj = objMngr->getObject(objId);
+        if (obj == NULL) {
+            return 0;
+        }
+        dataLength = (type == TYPE_OBJ_COMPACT) ? obj->getCompactNumBytes() : obj->getNumBytes();
+    }
+    if (dataLength >= MAX_PAYLOAD_LENGTH || HEADER_LENGTH + dataLength != size) {
+        return 0;
+    }
+
+    if (Crc::updateCRC(0, data, size) != data[size]) {
+        return 0;
+    }
+
+    stats.rxBytes += size + CHECKSUM_LENGTH;
+
+    dispatchObject(type, objId, instId, &data[HEADER_LENGTH], dataLength);
+
+    if (useUDPMirror) {
+        udpSocketTx->writeDatagram((const char *)data, size + CHECKSUM_LENGTH, QHostAddress::LocalHost, udpSocketRx->localPort());
+    }
+    if (relayFrames) {
+        emit frameReceived(QByteArray((const char *)data, size + CHECKSUM_LENGTH));
+    }
+
+    return size + CHECKSUM_LENGTH;
+}
+
+/**
+ * Hand a received object over to receiveObject() and update the statistics.
+ */
+void UAVTalk::dispatchObject(quint8 type, quint32 objId, quint16 instId, quint8 *data, qint32 length)
+{
+    QMutexLocker locker(&mutex);
+
+    if (receiveObject(type, objId, instId, data, length)) {
+        stats.rxObjectBytes += length;
+        stats.rxObjects++;
+    } else {
+        // TODO...
     }
 }
 
@@ -248,7 +415,7 @@ bool UAVTalk::processInputByte(quint8 rxbyte)
     if (rxState == STATE_COMPLETE || rxState == STATE_ERROR) {
         rxState = STATE_SYNC;
 
-        if (useUDPMirror) {
+        if (useUDPMirror || relayFrames) {
             rxDataArray.clear();
         }
     }
@@ -259,7 +426,7 @@ bool UAVTalk::processInputByte(quint8 rxbyte)
     // update packet byte count
     rxPacketLength++;
 
-    if (useUDPMirror) {
+    if (useUDPMirror || relayFrames) {
         rxDataArray.append(rxbyte);
     }
 
@@ -278,6 +445,11 @@ bool UAVTalk::processInputByte(quint8 rxbyte)
 
         rxPacketLength = 1;
 
+        if (relayFrames) {
+            // Drop the bytes skipped while looking for the sync byte
+            rxDataArray = QByteArray(1, (char)rxbyte);
+        }
+
         // case local byte counter, don't forget to zero it after use.
         rxCount = 0;
 
@@ -289,14 +461,16 @@ bool UAVTalk::processInputByte(quint8 rxbyte)
         // Update CRC
         rxCS = Crc::updateCRC(rxCS, rxbyte);
 
-        if ((rxbyte & TYPE_MASK) != TYPE_VER) {
+        // The timestamped types are only handled here, processInputFrame() leaves them to us
+        if ((rxbyte & TYPE_MASK & ~TYPE_TIMESTAMPED) != TYPE_VER) {
             qWarning() << "UAVTalk - error : bad type";
             stats.rxErrors++;
             rxState = STATE_ERROR;
             break;
         }
 
-        rxType     = rxbyte;
+        rxType = rxbyte & ~TYPE_TIMESTAMPED;
+        rxTimestamped = (rxbyte & TYPE_TIMESTAMPED) != 0;
 
         packetSize = 0;
 
@@ -317,7 +491,7 @@ bool UAVTalk::processInputByte(quint8 rxbyte)
         rxCount     = 0;
 
 
-        if (packetSize < HEADER_LENGTH || packetSize > HEADER_LENGTH + MAX_PAYLOAD_LENGTH) {
+        if (packetSize < HEADER_LENGTH || packetSize > HEADER_LENGTH + (rxTimestamped ? TIMESTAMP_LENGTH : 0) + MAX_PAYLOAD_LENGTH) {
             // incorrect packet size
             qWarning() << "UAVTalk - error : incorrect packet size";
             stats.rxErrors++;
@@ -361,8 +535,9 @@ bool UAVTalk::processInputByte(quint8 rxbyte)
 
         // Search for object, if not found reset state machine
         {
+            qint32 timestampLength = rxTimestamped ? TIMESTAMP_LENGTH : 0;
             UAVObject *rxObj = objMngr->getObject(rxObjId);
-            if (rxObj == NULL && rxType != TYPE_OBJ_REQ) {
+            if (rxObj == NULL && rxType != TYPE_OBJ_REQ && rxType != TYPE_BUNDLE) {
                 qWarning() << "UAVTalk - error : unknown object" << rxObjId;
                 stats.rxErrors++;
                 rxState = STATE_ERROR;
@@ -374,9 +549,9 @@ bool UAVTalk::processInputByte(quint8 rxbyte)
                 rxLength = 0;
             } else {
                 if (rxObj) {
-                    rxLength = rxObj->getNumBytes();
+                    rxLength = (rxType == TYPE_OBJ_COMPACT) ? rxObj->getCompactNumBytes() : rxObj->getNumBytes();
                 } else {
-                    rxLength = packetSize - rxPacketLength;
+                    rxLength = packetSize - rxPacketLength - timestampLength;
                 }
             }
 
@@ -390,7 +565,7 @@ bool UAVTalk::processInputByte(quint8 rxbyte)
             }
 
             // Check the lengths match
-            if ((rxPacketLength + rxLength) != packetSize) {
+            if ((rxPacketLength + timestampLength + rxLength) != packetSize) {
                 // packet error - mismatched packet size
                 qWarning() << "UAVTalk - error : mismatched packet size" << rxObjId;
                 stats.rxErrors++;
@@ -399,7 +574,29 @@ bool UAVTalk::processInputByte(quint8 rxbyte)
             }
         }
 
-        // If there is a payload get it, otherwise receive checksum
+        // If there is a timestamp get it, then the payload if any, otherwise receive checksum
+        if (rxTimestamped) {
+            rxState = STATE_TIMESTAMP;
+        } else if (rxLength > 0) {
+            rxState = STATE_DATA;
+        } else {
+            rxState = STATE_CS;
+        }
+        break;
+
+    case STATE_TIMESTAMP:
+
+        // Update CRC
+        rxCS = Crc::updateCRC(rxCS, rxbyte);
+
+        rxTmpBuffer[rxCount++] = rxbyte;
+        if (rxCount < TIMESTAMP_LENGTH) {
+            break;
+        }
+        rxCount     = 0;
+
+        rxTimestamp = qFromLittleEndian<quint16>(rxTmpBuffer);
+
         if (rxLength > 0) {
             rxState = STATE_DATA;
         } else {
@@ -567,6 +764,16 @@ bool UAVTalk::receiveObject(quint8 type, quint32 objId, quint16 instId, quint8 *
         }
         break;
 
+    case TYPE_BUNDLE:
+        // The instance ID holds the number of objects in the bundle
+        error = !receiveBundle(instId, data, length);
+        break;
+
+    case TYPE_OBJ_COMPACT:
+        // Quantized update sent over the slow links, never acked
+        error = allInstances || updateObject(objId, instId, data, true) == NULL;
+        break;
+
     case TYPE_NACK:
         // All instances, not allowed for NACK messages
         if (!allInstances) {
@@ -594,12 +801,44 @@ bool UAVTalk::receiveObject(quint8 type, quint32 objId, quint16 instId, quint8 *
     return !error;
 }
 
+/**
+ * Receive a bundle of object updates, each one is processed as an OBJ message.
+ * \param[in] count Number of objects in the bundle
+ * \param[in] data Data buffer
+ * \param[in] length Buffer length
+ * \return Success (true), Failure (false)
+ */
+bool UAVTalk::receiveBundle(quint16 count, quint8 *data, qint32 length)
+{
+    qint32 offset = 0;
+    bool success  = true;
+
+    for (quint16 n = 0; n < count; ++n) {
+        if (offset + BUNDLE_ENTRY_HEADER_LENGTH > length) {
+            return false;
+        }
+        quint32 objId  = qFromLittleEndian<quint32>(&data[offset]);
+        quint16 instId = qFromLittleEndian<quint16>(&data[offset + 4]);
+        offset += BUNDLE_ENTRY_HEADER_LENGTH;
+
+        // The length of an unknown object is unknown, the rest of the bundle can not be parsed
+        UAVObject *obj = objMngr->getObject(objId);
+        if (obj == NULL || offset + (qint32)obj->getNumBytes() > length) {
+            qWarning() << "UAVTalk - error : bad bundle entry" << objId;
+            return false;
+        }
+        success &= receiveObject(TYPE_OBJ, objId, instId, &data[offset], obj->getNumBytes());
+        offset  += obj->getNumBytes();
+    }
+    return success;
+}
+
 /**
  * Update the data of an object from a byte array (unpack).
  * If the object instance could not be found in the list, then a
- * new one is created.
+ * new one is created. Compact updates are unpacked from their quantized representation.
  */
-UAVObject *UAVTalk::updateObject(quint32 objId, quint16 instId, quint8 *data)
+UAVObject *UAVTalk::updateObject(quint32 objId, quint16 instId, quint8 *data, bool compact)
 {
     // Get object
     UAVObject *obj = objMngr->getObject(objId, instId);
@@ -623,11 +862,19 @@ UAVObject *UAVTalk::updateObject(quint32 objId, quint16 instId, quint8 *data)
             qWarning() << "UAVTalk - failed to register object " << instObj->toStringBrief();
             return NULL;
         }
-        instObj->unpack(data);
+        if (compact) {
+            instObj->unpackCompact(data);
+        } else {
+            instObj->unpack(data);
+        }
         return instObj;
     } else {
         // Unpack data into object instance
-        obj->unpack(data);
+        if (compact) {
+            obj->unpackCompact(data);
+        } else {
+            obj->unpack(data);
+        }
         return obj;
     }
 }
@@ -785,10 +1032,18 @@ bool UAVTalk::transmitSingleObject(quint8 type, quint32 objId, quint16 instId, U
     // Calculate checksum
     txBuffer[HEADER_LENGTH + length] = Crc::updateCRC(0, txBuffer, HEADER_LENGTH + length);
 
-    // Send buffer, check that the transmit backlog does not grow above limit
-    if (!io.isNull() && io->isWritable()) {
+    if (QThread::currentThread() != thread()) {
+        // The device can only be used from its own thread, packets sent while decoding input
+        // in another thread (ACKs, NACKs and object request responses) are queued to it.
+        QMetaObject::invokeMethod(this, "writeOutput", Qt::QueuedConnection,
+                                  Q_ARG(QByteArray, QByteArray((const char *)txBuffer, HEADER_LENGTH + length + CHECKSUM_LENGTH)));
+    } else if (!io.isNull() && io->isWritable()) {
+        // Send buffer, check that the transmit backlog does not grow above limit
         if (io->bytesToWrite() < TX_BUFFER_SIZE) {
             io->write((const char *)txBuffer, HEADER_LENGTH + length + CHECKSUM_LENGTH);
+            if (captureData) {
+                emit dataCaptured(captureTime(), QByteArray((const char *)txBuffer, HEADER_LENGTH + length + CHECKSUM_LENGTH), true);
+            }
             if (useUDPMirror) {
                 udpSocketRx->writeDatagram((const char *)txBuffer, HEADER_LENGTH + length + CHECKSUM_LENGTH, QHostAddress::LocalHost, udpSocketTx->localPort());
             }
@@ -812,6 +1067,25 @@ bool UAVTalk::transmitSingleObject(quint8 type, quint32 objId, quint16 instId, U
     return true;
 }
 
+/**
+ * Write a packet queued from another thread to the device.
+ */
+void UAVTalk::writeOutput(QByteArray block)
+{
+    if (!io.isNull() && io->isWritable()) {
+        if (io->bytesToWrite() < TX_BUFFER_SIZE) {
+            io->write(block);
+            if (captureData) {
+                emit dataCaptured(captureTime(), block, true);
+            }
+        } else {
+            qWarning() << "UAVTalk - error transmitting : io device full";
+            QMutexLocker locker(&mutex);
+            ++stats.txErrors;
+        }
+    }
+}
+
 UAVTalk::Transaction *UAVTalk::findTransaction(quint32 objId, quint16 instId)
 {
     // Lookup the transaction in the transaction map
@@ -896,6 +1170,16 @@ const char *UAVTalk::typeToString(quint8 type)
     case TYPE_NACK:
         return "nack";
 
+        break;
+
+    case TYPE_BUNDLE:
+        return "bundle";
+
+        break;
+
+    case TYPE_OBJ_COMPACT:
+        return "object (compact)";
+
         break;
     }
     return "<error>";
@@ -70,12 +70,22 @@ public:
     bool sendObjectRequest(UAVObject *obj, bool allInstances);
     void cancelTransaction(UAVObject *obj);
 
+    void setForwardInput(bool forward);
+    void setRelayFrames(bool relay);
+    void setCaptureData(bool capture);
+
 signals:
     void transactionCompleted(UAVObject *obj, bool success);
+    void inputReceived(QByteArray block);
+    void frameReceived(QByteArray frame);
+    void dataCaptured(qint64 timestamp, QByteArray data, bool outgoing);
+    // An update sent with the board time (board tick count, ms, 16 bits) was received
+    void objectTimestamped(quint32 objId, quint16 instId, quint16 boardTimeMs);
 
 private slots:
     void processInputStream();
     void dummyUDPRead();
+    void writeOutput(QByteArray block);
 
 private:
 
@@ -93,10 +103,19 @@ private:
     static const int TYPE_OBJ_ACK  = (TYPE_VER | 0x02);
     static const int TYPE_ACK      = (TYPE_VER | 0x03);
     static const int TYPE_NACK     = (TYPE_VER | 0x04);
+    static const int TYPE_BUNDLE   = (TYPE_VER | 0x05);
+    static const int TYPE_OBJ_COMPACT = (TYPE_VER | 0x06);
+    static const int TYPE_TIMESTAMPED = 0x80;
 
     // header : sync(1), type (1), size(2), object ID(4), instance ID(2)
     static const int HEADER_LENGTH = 10;
 
+    // timestamp(2), after the header of the timestamped types
+    static const int TIMESTAMP_LENGTH = 2;
+
+    // bundle entry header : object ID(4), instance ID(2)
+    static const int BUNDLE_ENTRY_HEADER_LENGTH = 6;
+
     static const int MAX_PAYLOAD_LENGTH = 256;
 
     static const int CHECKSUM_LENGTH    = 1;
@@ -107,7 +126,7 @@ private:
 
     // Types
     typedef enum {
-        STATE_SYNC, STATE_TYPE, STATE_SIZE, STATE_OBJID, STATE_INSTID, STATE_DATA, STATE_CS, STATE_COMPLETE, STATE_ERROR
+        STATE_SYNC, STATE_TYPE, STATE_SIZE, STATE_OBJID, STATE_INSTID, STATE_TIMESTAMP, STATE_DATA, STATE_CS, STATE_COMPLETE, STATE_ERROR
     } RxStateType;
 
     // Variables
@@ -132,7 +151,9 @@ private:
     RxStateType rxState;
     // data variables
     quint8 rxTmpBuffer[4];
-    quint8 rxType;
+    quint8 rxType; // without the timestamped bit
+    bool rxTimestamped;
+    quint16 rxTimestamp;
     quint32 rxObjId;
     quint16 rxInstId;
     quint16 rxLength;
@@ -140,6 +161,14 @@ private:
     quint8 rxCSPacket;
     quint8 rxCS;
 
+    bool forwardInput;
+    bool relayFrames;
+
+    bool captureData;
+    // Capture timestamps are captureEpoch (us since the epoch) plus the captureClock time
+    qint64 captureEpoch;
+    QElapsedTimer captureClock;
+
     bool useUDPMirror;
     QUdpSocket *udpSocketTx;
     QUdpSocket *udpSocketRx;
@@ -147,9 +176,13 @@ private:
 
     // Methods
     bool objectTransaction(quint8 type, quint32 objId, quint16 instId, UAVObject *obj);
+    void processInputBlock(quint8 *data, qint32 length);
+    qint32 processInputFrame(quint8 *data, qint32 length);
     bool processInputByte(quint8 rxbyte);
+    void dispatchObject(quint8 type, quint32 objId, quint16 instId, quint8 *data, qint32 length);
     bool receiveObject(quint8 type, quint32 objId, quint16 instId, quint8 *data, qint32 length);
-    UAVObject *updateObject(quint32 objId, quint16 instId, quint8 *data);
+    bool receiveBundle(quint16 count, quint8 *data, qint32 length);
+    UAVObject *updateObject(quint32 objId, quint16 instId, quint8 *data, bool compact = false);
     void updateAck(quint8 type, quint32 objId, quint16 instId, UAVObject *obj);
     void updateNack(quint32 objId, quint16 instId, UAVObject *obj);
     bool transmitObject(quint8 type, quint32 objId, quint16 instId, UAVObject *obj);
@@ -161,6 +194,7 @@ private:
     void closeAllTransactions();
 
     const char *typeToString(quint8 type);
+    qint64 captureTime() const;
 };
 
 #endif // UAVTALK_H
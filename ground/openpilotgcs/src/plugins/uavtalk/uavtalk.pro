@@ -1,7 +1,7 @@
 TEMPLATE = lib
 TARGET = UAVTalk
 
-QT += network
+QT += network serialport
 
 DEFINES += UAVTALK_LIBRARY
 
@@ -16,6 +16,11 @@ HEADERS += \
     uavtalkplugin.h \
     telemetrymonitor.h \
     telemetrymanager.h \
+    telemetryrelay.h \
+    telemetrycapture.h \
+    vehicle.h \
+    vehiclemanager.h \
+    vehicleoptionspage.h \
     uavtalk_global.h \
     telemetry.h
 
@@ -24,6 +29,11 @@ SOURCES += \
     uavtalkplugin.cpp \
     telemetrymonitor.cpp \
     telemetrymanager.cpp \
+    telemetryrelay.cpp \
+    telemetrycapture.cpp \
+    vehicle.cpp \
+    vehiclemanager.cpp \
+    vehicleoptionspage.cpp \
     telemetry.cpp
 
 OTHER_FILES += UAVTalk.pluginspec
@@ -25,6 +25,8 @@
  * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
  */
 #include "uavtalkplugin.h"
+#include "vehiclemanager.h"
+#include "vehicleoptionspage.h"
 
 #include <coreplugin/icore.h>
 #include <coreplugin/connectionmanager.h>
@@ -38,7 +40,10 @@ UAVTalkPlugin::~UAVTalkPlugin()
  * Called once all the plugins which depend on us have been loaded
  */
 void UAVTalkPlugin::extensionsInitialized()
-{}
+{
+    // Connect the additional vehicles
+    vehicleMngr->readSettings(Core::ICore::instance()->settings());
+}
 
 /**
  * Called at startup, before any plugin which depends on us is initialized
@@ -53,6 +58,12 @@ bool UAVTalkPlugin::initialize(const QStringList & arguments, QString *errorStri
     telMngr = new TelemetryManager();
     addAutoReleasedObject(telMngr);
 
+    // Create VehicleManager, the primary vehicle uses the global object manager and telemetry
+    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
+    vehicleMngr = new VehicleManager(pm->getObject<UAVObjectManager>(), telMngr);
+    addAutoReleasedObject(vehicleMngr);
+    addAutoReleasedObject(new VehicleOptionsPage(vehicleMngr));
+
     // Connect to connection manager so we get notified when the user connect to his device
     Core::ConnectionManager *cm = Core::ICore::instance()->connectionManager();
     QObject::connect(cm, SIGNAL(deviceConnected(QIODevice *)),
@@ -33,6 +33,8 @@
 #include "uavtalk.h"
 #include "telemetrymanager.h"
 
+class VehicleManager;
+
 class UAVTALK_EXPORT UAVTalkPlugin : public ExtensionSystem::IPlugin {
     Q_OBJECT
                      Q_PLUGIN_METADATA(IID "OpenPilot.UAVTalk")
@@ -51,6 +53,7 @@ protected slots:
 
 private:
     TelemetryManager *telMngr;
+    VehicleManager *vehicleMngr;
 };
 
 #endif // UAVTALKPLUGIN_H
@@ -0,0 +1,151 @@
+/**
+ ******************************************************************************
+ *
+ * @file       vehicle.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief The UAVTalk protocol plugin
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "vehicle.h"
+#include "telemetrymanager.h"
+#include "uavobjectmanager.h"
+#include "uavobjectsinit.h"
+#include <QDebug>
+#include <QStringList>
+#include <QtNetwork/QTcpSocket>
+#include <QtSerialPort/QSerialPort>
+
+// Time allowed to open a TCP link
+#define TCP_CONNECT_TIMEOUT_MS 3000
+#define DEFAULT_BAUD_RATE      57600
+
+/**
+ * The primary vehicle, wrapping the GCS object manager and telemetry manager
+ */
+Vehicle::Vehicle(UAVObjectManager *objMngr, TelemetryManager *telMngr) :
+    m_primary(true), m_objMngr(objMngr), m_telMngr(telMngr), m_device(0)
+{}
+
+/**
+ * An additional vehicle, with its own objects and telemetry thread
+ */
+Vehicle::Vehicle(const QString &name, const QString &link) :
+    m_primary(false), m_name(name), m_link(link), m_device(0)
+{
+    m_objMngr = new UAVObjectManager();
+    UAVObjectsInitialize(m_objMngr);
+    m_telemetryThread.setObjectName(QString("Telemetry %1").arg(name));
+    m_telemetryThread.start(QThread::TimeCriticalPriority);
+    m_telMngr = new TelemetryManager(m_objMngr, &m_telemetryThread);
+}
+
+Vehicle::~Vehicle()
+{
+    if (m_primary) {
+        return;
+    }
+    disconnectLink();
+    m_telemetryThread.quit();
+    m_telemetryThread.wait();
+    delete m_telMngr;
+    delete m_objMngr;
+}
+
+/**
+ * Open the link of an additional vehicle and start its telemetry
+ * \return false if the link could not be opened
+ */
+bool Vehicle::connectLink()
+{
+    if (m_primary || m_device) {
+        return false;
+    }
+    m_device = openLink();
+    if (!m_device) {
+        return false;
+    }
+    // The telemetry manager moves the device to its thread
+    m_telMngr->start(m_device);
+    return true;
+}
+
+void Vehicle::disconnectLink()
+{
+    if (m_primary || !m_device) {
+        return;
+    }
+    // Waits for the telemetry thread to be done with the device
+    m_telMngr->stop();
+    m_device->close();
+    m_device->deleteLater();
+    m_device = 0;
+}
+
+/**
+ * Check the syntax of a link description
+ */
+bool Vehicle::isValidLink(const QString &link)
+{
+    QStringList parts = link.split(':');
+
+    if (parts.value(0) == "serial") {
+        return (parts.size() == 2 || (parts.size() == 3 && parts[2].toInt() > 0)) && !parts[1].isEmpty();
+    }
+    if (parts.value(0) == "tcp") {
+        return parts.size() == 3 && !parts[1].isEmpty() && parts[2].toUShort() > 0;
+    }
+    return false;
+}
+
+QIODevice *Vehicle::openLink()
+{
+    if (!isValidLink(m_link)) {
+        qWarning() << "Vehicle" << m_name << "- invalid link" << m_link;
+        return 0;
+    }
+
+    // The device is created without parent, it is moved to the telemetry thread
+    QStringList parts = m_link.split(':');
+    if (parts[0] == "serial") {
+        QSerialPort *port = new QSerialPort(parts[1]);
+        if (port->open(QIODevice::ReadWrite)
+            && port->setBaudRate(parts.size() > 2 ? parts[2].toInt() : DEFAULT_BAUD_RATE)
+            && port->setDataBits(QSerialPort::Data8)
+            && port->setParity(QSerialPort::NoParity)
+            && port->setStopBits(QSerialPort::OneStop)
+            && port->setFlowControl(QSerialPort::NoFlowControl)) {
+            return port;
+        }
+        qWarning() << "Vehicle" << m_name << "- could not open" << parts[1] << port->errorString();
+        delete port;
+        return 0;
+    }
+
+    QTcpSocket *socket = new QTcpSocket();
+    socket->connectToHost(parts[1], parts[2].toUShort());
+    if (socket->waitForConnected(TCP_CONNECT_TIMEOUT_MS)) {
+        return socket;
+    }
+    qWarning() << "Vehicle" << m_name << "- could not connect to" << parts[1] << parts[2] << socket->errorString();
+    delete socket;
+    return 0;
+}
@@ -0,0 +1,98 @@
+/**
+ ******************************************************************************
+ *
+ * @file       vehicle.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief The UAVTalk protocol plugin
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef VEHICLE_H
+#define VEHICLE_H
+
+#include "uavtalk_global.h"
+#include <QObject>
+#include <QString>
+#include <QThread>
+
+class QIODevice;
+class UAVObjectManager;
+class TelemetryManager;
+
+/**
+ * A vehicle monitored by the GCS: its objects, the telemetry link to it and the name
+ * gadgets use to bind to it.
+ * The primary vehicle is the one connected through the connection manager, it uses the
+ * UAVObjectManager and TelemetryManager registered in the plugin manager. The other
+ * vehicles have their own object manager and run their telemetry in their own thread.
+ * All the object managers share the field descriptions of the object types.
+ */
+class UAVTALK_EXPORT Vehicle : public QObject {
+    Q_OBJECT
+
+public:
+    Vehicle(UAVObjectManager *objMngr, TelemetryManager *telMngr);
+    Vehicle(const QString &name, const QString &link);
+    ~Vehicle();
+
+    bool isPrimary() const
+    {
+        return m_primary;
+    }
+    QString name() const
+    {
+        return m_name;
+    }
+    QString link() const
+    {
+        return m_link;
+    }
+    UAVObjectManager *objectManager() const
+    {
+        return m_objMngr;
+    }
+    TelemetryManager *telemetryManager() const
+    {
+        return m_telMngr;
+    }
+
+    bool connectLink();
+    void disconnectLink();
+    bool isLinkOpen() const
+    {
+        return m_device != 0;
+    }
+
+    static bool isValidLink(const QString &link);
+
+private:
+    QIODevice *openLink();
+
+    bool m_primary;
+    QString m_name;
+    // Additional vehicles only: "serial:<port>[:<baud rate>]" or "tcp:<host>:<port>"
+    QString m_link;
+    UAVObjectManager *m_objMngr;
+    TelemetryManager *m_telMngr;
+    QThread m_telemetryThread;
+    QIODevice *m_device;
+};
+
+#endif // VEHICLE_H
@@ -0,0 +1,151 @@
+/**
+ ******************************************************************************
+ *
+ * @file       vehiclemanager.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief The UAVTalk protocol plugin
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "vehiclemanager.h"
+#include <QDebug>
+#include <QSettings>
+
+VehicleManager::VehicleManager(UAVObjectManager *objMngr, TelemetryManager *telMngr)
+{
+    m_vehicles.append(new Vehicle(objMngr, telMngr));
+}
+
+VehicleManager::~VehicleManager()
+{
+    qDeleteAll(m_vehicles);
+}
+
+Vehicle *VehicleManager::vehicle(const QString &name) const
+{
+    foreach(Vehicle * vehicle, m_vehicles) {
+        if (vehicle->name() == name) {
+            return vehicle;
+        }
+    }
+    return 0;
+}
+
+QStringList VehicleManager::vehicleNames() const
+{
+    QStringList names;
+
+    foreach(Vehicle * vehicle, m_vehicles) {
+        if (!vehicle->isPrimary()) {
+            names.append(vehicle->name());
+        }
+    }
+    return names;
+}
+
+UAVObjectManager *VehicleManager::objectManager(const QString &name) const
+{
+    Vehicle *bound = vehicle(name);
+
+    return (bound ? bound : primaryVehicle())->objectManager();
+}
+
+TelemetryManager *VehicleManager::telemetryManager(const QString &name) const
+{
+    Vehicle *bound = vehicle(name);
+
+    return (bound ? bound : primaryVehicle())->telemetryManager();
+}
+
+QList<QPair<QString, QString> > VehicleManager::configuration() const
+{
+    QList<QPair<QString, QString> > vehicles;
+
+    foreach(Vehicle * vehicle, m_vehicles) {
+        if (!vehicle->isPrimary()) {
+            vehicles.append(qMakePair(vehicle->name(), vehicle->link()));
+        }
+    }
+    return vehicles;
+}
+
+/**
+ * Add, remove and reconnect the additional vehicles to match the configuration.
+ * The vehicles whose name and link did not change are left alone.
+ */
+void VehicleManager::setConfiguration(const QList<QPair<QString, QString> > &vehicles)
+{
+    for (int i = m_vehicles.size() - 1; i > 0; i--) {
+        Vehicle *vehicle = m_vehicles[i];
+        if (!vehicles.contains(qMakePair(vehicle->name(), vehicle->link()))) {
+            emit vehicleAboutToBeRemoved(vehicle);
+            m_vehicles.removeAt(i);
+            delete vehicle;
+        }
+    }
+
+    for (int i = 0; i < vehicles.size(); i++) {
+        const QString &name = vehicles[i].first;
+        if (name.isEmpty()) {
+            continue;
+        }
+        Vehicle *existing = this->vehicle(name);
+        if (existing) {
+            // Retry the links that could not be opened
+            if (!existing->isLinkOpen()) {
+                existing->connectLink();
+            }
+            continue;
+        }
+        Vehicle *vehicle = new Vehicle(name, vehicles[i].second);
+        m_vehicles.append(vehicle);
+        if (!vehicle->connectLink()) {
+            qWarning() << "VehicleManager - vehicle" << name << "is not connected";
+        }
+        emit vehicleAdded(vehicle);
+    }
+}
+
+void VehicleManager::readSettings(QSettings *qs)
+{
+    QList<QPair<QString, QString> > vehicles;
+
+    int count = qs->beginReadArray(QLatin1String("Vehicles"));
+    for (int i = 0; i < count; i++) {
+        qs->setArrayIndex(i);
+        vehicles.append(qMakePair(qs->value(QLatin1String("Name")).toString(), qs->value(QLatin1String("Link")).toString()));
+    }
+    qs->endArray();
+    setConfiguration(vehicles);
+}
+
+void VehicleManager::saveSettings(QSettings *qs) const
+{
+    QList<QPair<QString, QString> > vehicles = configuration();
+
+    qs->beginWriteArray(QLatin1String("Vehicles"), vehicles.size());
+    for (int i = 0; i < vehicles.size(); i++) {
+        qs->setArrayIndex(i);
+        qs->setValue(QLatin1String("Name"), vehicles[i].first);
+        qs->setValue(QLatin1String("Link"), vehicles[i].second);
+    }
+    qs->endArray();
+}
@@ -0,0 +1,84 @@
+/**
+ ******************************************************************************
+ *
+ * @file       vehiclemanager.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief The UAVTalk protocol plugin
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef VEHICLEMANAGER_H
+#define VEHICLEMANAGER_H
+
+#include "uavtalk_global.h"
+#include "vehicle.h"
+#include <QObject>
+#include <QList>
+#include <QPair>
+#include <QStringList>
+
+class QSettings;
+class UAVObjectManager;
+class TelemetryManager;
+
+/**
+ * Keeps the vehicles monitored by the GCS, registered in the plugin manager.
+ * The primary vehicle (unnamed) is always there, the additional vehicles are configured in
+ * the Vehicles options page and connected when they are added.
+ * Gadgets bind to a vehicle by name, an empty or unknown name binds to the primary vehicle.
+ */
+class UAVTALK_EXPORT VehicleManager : public QObject {
+    Q_OBJECT
+
+public:
+    VehicleManager(UAVObjectManager *objMngr, TelemetryManager *telMngr);
+    ~VehicleManager();
+
+    QList<Vehicle *> vehicles() const
+    {
+        return m_vehicles;
+    }
+    Vehicle *primaryVehicle() const
+    {
+        return m_vehicles.first();
+    }
+    Vehicle *vehicle(const QString &name) const;
+    QStringList vehicleNames() const;
+
+    UAVObjectManager *objectManager(const QString &name) const;
+    TelemetryManager *telemetryManager(const QString &name) const;
+
+    // Additional vehicles, as (name, link) pairs
+    QList<QPair<QString, QString> > configuration() const;
+    void setConfiguration(const QList<QPair<QString, QString> > &vehicles);
+
+    void readSettings(QSettings *qs);
+    void saveSettings(QSettings *qs) const;
+
+signals:
+    void vehicleAdded(Vehicle *vehicle);
+    void vehicleAboutToBeRemoved(Vehicle *vehicle);
+
+private:
+    // The primary vehicle first
+    QList<Vehicle *> m_vehicles;
+};
+
+#endif // VEHICLEMANAGER_H
@@ -0,0 +1,121 @@
+/**
+ ******************************************************************************
+ *
+ * @file       vehicleoptionspage.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief The UAVTalk protocol plugin
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "vehicleoptionspage.h"
+#include "vehiclemanager.h"
+#include "vehicle.h"
+#include <coreplugin/icore.h>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QPushButton>
+#include <QTableWidget>
+#include <QVBoxLayout>
+
+VehicleOptionsPage::VehicleOptionsPage(VehicleManager *manager, QObject *parent) :
+    IOptionsPage(parent), m_manager(manager), m_table(0)
+{}
+
+QWidget *VehicleOptionsPage::createPage(QWidget *parent)
+{
+    QWidget *page = new QWidget(parent);
+    QVBoxLayout *layout = new QVBoxLayout(page);
+
+    QLabel *label = new QLabel(tr("Vehicles monitored in addition to the one connected with the connection manager. "
+                                  "Each one has its own objects and telemetry thread, gadgets that support it can be bound to a vehicle by name. "
+                                  "Links are \"serial:<port>[:<baud rate>]\" or \"tcp:<host>:<port>\"."), page);
+    label->setWordWrap(true);
+    layout->addWidget(label);
+
+    m_table = new QTableWidget(0, 2, page);
+    m_table->setHorizontalHeaderLabels(QStringList() << tr("Name") << tr("Link"));
+    m_table->horizontalHeader()->setStretchLastSection(true);
+    m_table->verticalHeader()->hide();
+    m_table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    QList<QPair<QString, QString> > vehicles = m_manager->configuration();
+    for (int i = 0; i < vehicles.size(); i++) {
+        m_table->insertRow(i);
+        m_table->setItem(i, 0, new QTableWidgetItem(vehicles[i].first));
+        m_table->setItem(i, 1, new QTableWidgetItem(vehicles[i].second));
+    }
+    layout->addWidget(m_table);
+
+    QHBoxLayout *buttons = new QHBoxLayout();
+    QPushButton *addButton    = new QPushButton(tr("Add"), page);
+    QPushButton *removeButton = new QPushButton(tr("Remove"), page);
+    connect(addButton, SIGNAL(clicked()), this, SLOT(addVehicle()));
+    connect(removeButton, SIGNAL(clicked()), this, SLOT(removeVehicle()));
+    buttons->addWidget(addButton);
+    buttons->addWidget(removeButton);
+    buttons->addStretch();
+    layout->addLayout(buttons);
+
+    return page;
+}
+
+/**
+ * Apply the vehicles with a name and a valid link, the others are ignored
+ */
+void VehicleOptionsPage::apply()
+{
+    QList<QPair<QString, QString> > vehicles;
+
+    for (int i = 0; i < m_table->rowCount(); i++) {
+        QTableWidgetItem *name = m_table->item(i, 0);
+        QTableWidgetItem *link = m_table->item(i, 1);
+        if (!name || !link || name->text().trimmed().isEmpty() || !Vehicle::isValidLink(link->text().trimmed())) {
+            continue;
+        }
+        vehicles.append(qMakePair(name->text().trimmed(), link->text().trimmed()));
+    }
+    m_manager->setConfiguration(vehicles);
+    m_manager->saveSettings(Core::ICore::instance()->settings());
+}
+
+void VehicleOptionsPage::finish()
+{
+    m_table = 0;
+}
+
+void VehicleOptionsPage::addVehicle()
+{
+    int row = m_table->rowCount();
+
+    m_table->insertRow(row);
+    m_table->setItem(row, 0, new QTableWidgetItem(tr("Vehicle %1").arg(row + 1)));
+    m_table->setItem(row, 1, new QTableWidgetItem("tcp:localhost:9000"));
+    m_table->editItem(m_table->item(row, 0));
+}
+
+void VehicleOptionsPage::removeVehicle()
+{
+    int row = m_table->currentRow();
+
+    if (row >= 0) {
+        m_table->removeRow(row);
+    }
+}
@@ -0,0 +1,74 @@
+/**
+ ******************************************************************************
+ *
+ * @file       vehicleoptionspage.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief The UAVTalk protocol plugin
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef VEHICLEOPTIONSPAGE_H
+#define VEHICLEOPTIONSPAGE_H
+
+#include <coreplugin/dialogs/ioptionspage.h>
+
+class QTableWidget;
+class VehicleManager;
+
+/**
+ * Options page listing the additional vehicles, by name and link
+ */
+class VehicleOptionsPage : public Core::IOptionsPage {
+    Q_OBJECT
+
+public:
+    VehicleOptionsPage(VehicleManager *manager, QObject *parent = 0);
+
+    QString id() const
+    {
+        return QLatin1String("Vehicles");
+    }
+    QString trName() const
+    {
+        return tr("Vehicles");
+    }
+    QString category() const
+    {
+        return QLatin1String("Environment");
+    }
+    QString trCategory() const
+    {
+        return tr("Environment");
+    }
+
+    QWidget *createPage(QWidget *parent);
+    void apply();
+    void finish();
+
+private slots:
+    void addVehicle();
+    void removeVehicle();
+
+private:
+    VehicleManager *m_manager;
+    QTableWidget *m_table;
+};
+
+#endif // VEHICLEOPTIONSPAGE_H
@@ -0,0 +1,182 @@
+/**
+ ******************************************************************************
+ *
+ * @file       batchuploader.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup Uploader Uploader Plugin
+ * @{
+ * @brief Flashes one firmware image to every connected bootloader at once
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "batchuploader.h"
+
+BatchUploader::BatchUploader(QObject *parent) : QObject(parent),
+    m_succeeded(0), m_failed(0), m_starting(false)
+{}
+
+BatchUploader::~BatchUploader()
+{
+    qDeleteAll(m_serials.keys());
+}
+
+/**
+   Checks the loaded firmware against a board type, the same way the
+   device widget does for a single board
+ */
+bool BatchUploader::checkFirmware(int board, QString &error) const
+{
+    if (m_description.isEmpty()) {
+        // Not a packaged firmware, nothing to check against
+        return true;
+    }
+    int firmwareBoard = ((m_description.at(12) & 0xff) << 8) + (m_description.at(13) & 0xff);
+    if ((board == 0x401 && firmwareBoard == 0x402) ||
+        (board == 0x901 && firmwareBoard == 0x902) || // L3GD20 revo supports Revolution firmware
+        (board == 0x902 && firmwareBoard == 0x903)) { // RevoMini1 supporetd by RevoMini2 firmware
+        // These firmwares are designed to be backwards compatible
+    } else if (firmwareBoard != board) {
+        error = tr("firmware does not match board");
+        return false;
+    }
+    return true;
+}
+
+/**
+   Starts uploading filename to every bootloader currently connected.
+   Boards that cannot be opened or do not match the firmware are reported
+   through deviceFinished() right away.
+ */
+int BatchUploader::start(const QString &filename)
+{
+    if (isRunning()) {
+        return 0;
+    }
+
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly)) {
+        emit operationProgress(tr("Could not open %1").arg(filename));
+        return 0;
+    }
+    m_firmware = file.readAll();
+    m_description.clear();
+    QByteArray desc = m_firmware.right(100);
+    if (desc.startsWith("OpFw")) {
+        QByteArray firmwareHash = desc.mid(40, 20);
+        QByteArray fileHash     = QCryptographicHash::hash(m_firmware.left(m_firmware.length() - 100), QCryptographicHash::Sha1);
+        if (firmwareHash != fileHash) {
+            emit operationProgress(tr("Error: firmware file corrupt"));
+            return 0;
+        }
+        m_description = desc;
+    }
+
+    m_succeeded = 0;
+    m_failed    = 0;
+    m_starting  = true;
+    m_timer.start();
+
+    foreach(USBPortInfo info, DFUObject::bootloaders()) {
+        QString serial = info.serialNumber;
+        if (serial.isEmpty()) {
+            // Without a serial number the board cannot be told apart from the others
+            emit operationProgress(tr("Skipping a bootloader without USB serial number"));
+            continue;
+        }
+        DFUObject *dfu = new DFUObject(false, false, QString(), serial);
+        QString error;
+
+        m_serials.insert(dfu, serial);
+        if (!dfu->ready()) {
+            error = tr("could not open bootloader");
+        } else {
+            dfu->AbortOperation();
+            if (!dfu->enterDFU(0) || !dfu->findDevices() || dfu->numberOfDevices < 1) {
+                error = tr("could not enter DFU mode");
+            } else if (!dfu->devices[0].Writable) {
+                error = tr("device not writable");
+            } else {
+                checkFirmware(dfu->devices[0].ID, error);
+            }
+        }
+        if (error.isEmpty()) {
+            dfu->AbortOperation(); // Necessary, otherwise I get random failures.
+            connect(dfu, SIGNAL(progressUpdated(int)), this, SLOT(onProgressUpdated(int)));
+            connect(dfu, SIGNAL(uploadFinished(OP_DFU::Status)), this, SLOT(onUploadFinished(OP_DFU::Status)));
+            if (!dfu->UploadFirmware(filename, false, 0)) {
+                error = tr("could not start upload");
+            }
+        }
+        if (!error.isEmpty()) {
+            emit operationProgress(QString("%1: %2").arg(serial).arg(error));
+            deviceDone(dfu, false);
+        }
+    }
+
+    m_starting = false;
+    if (m_serials.isEmpty() && m_failed > 0) {
+        emit finished(0, m_failed, 0.0);
+    }
+    return m_serials.count();
+}
+
+void BatchUploader::onProgressUpdated(int percent)
+{
+    DFUObject *dfu = qobject_cast<DFUObject *>(sender());
+
+    if (m_serials.contains(dfu)) {
+        emit deviceProgress(m_serials.value(dfu), percent);
+    }
+}
+
+void BatchUploader::onUploadFinished(OP_DFU::Status status)
+{
+    DFUObject *dfu = qobject_cast<DFUObject *>(sender());
+
+    if (!m_serials.contains(dfu)) {
+        return;
+    }
+    QString serial = m_serials.value(dfu);
+    if (status == OP_DFU::Last_operation_Success && !m_description.isEmpty()) {
+        status = dfu->UploadDescription(m_description);
+    }
+    if (status != OP_DFU::Last_operation_Success) {
+        emit operationProgress(QString("%1: upload failed with code: %2").arg(serial).arg(dfu->StatusToString(status)));
+    }
+    deviceDone(dfu, status == OP_DFU::Last_operation_Success);
+}
+
+void BatchUploader::deviceDone(DFUObject *dfu, bool success)
+{
+    QString serial = m_serials.take(dfu);
+
+    dfu->deleteLater();
+    if (success) {
+        ++m_succeeded;
+    } else {
+        ++m_failed;
+    }
+    emit deviceFinished(serial, success);
+
+    if (m_serials.isEmpty() && !m_starting) {
+        qint64 elapsed = qMax(m_timer.elapsed(), (qint64)1);
+        double throughput = (double)m_firmware.length() * m_succeeded * 1000.0 / elapsed;
+        emit finished(m_succeeded, m_failed, throughput);
+    }
+}
@@ -0,0 +1,79 @@
+/**
+ ******************************************************************************
+ *
+ * @file       batchuploader.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup Uploader Uploader Plugin
+ * @{
+ * @brief Flashes one firmware image to every connected bootloader at once
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef BATCHUPLOADER_H
+#define BATCHUPLOADER_H
+
+#include "op_dfu.h"
+#include <QObject>
+#include <QMap>
+#include <QElapsedTimer>
+
+using namespace OP_DFU;
+
+// Opens one DFUObject per bootloader found on USB and uploads the same
+// image to all of them. Every DFUObject runs its transfer in its own
+// thread, so a tray of boards takes about as long as a single one.
+class BatchUploader : public QObject {
+    Q_OBJECT
+
+public:
+    BatchUploader(QObject *parent = 0);
+    ~BatchUploader();
+
+    // Returns the number of uploads started
+    int start(const QString &filename);
+    bool isRunning() const
+    {
+        return !m_serials.isEmpty();
+    }
+
+signals:
+    void operationProgress(QString status);
+    void deviceProgress(QString serial, int percent);
+    void deviceFinished(QString serial, bool success);
+    // throughput is the total number of firmware bytes written per second
+    void finished(int succeeded, int failed, double throughput);
+
+private slots:
+    void onProgressUpdated(int percent);
+    void onUploadFinished(OP_DFU::Status status);
+
+private:
+    QMap<DFUObject *, QString> m_serials;
+    QByteArray m_firmware;
+    QByteArray m_description;
+    QElapsedTimer m_timer;
+    int m_succeeded;
+    int m_failed;
+    bool m_starting;
+
+    bool checkFirmware(int board, QString &error) const;
+    void deviceDone(DFUObject *dfu, bool success);
+};
+
+#endif // BATCHUPLOADER_H
@@ -29,15 +29,18 @@
 #include <cmath>
 #include <qwaitcondition.h>
 #include <QMetaType>
+#include <QVector>
+#include <string.h>
 #include <QtWidgets/QApplication>
 
 using namespace OP_DFU;
 
-DFUObject::DFUObject(bool _debug, bool _use_serial, QString portname) :
+DFUObject::DFUObject(bool _debug, bool _use_serial, QString portname, QString usbSerial) :
     debug(_debug), use_serial(_use_serial), mready(true)
 {
     info = NULL;
-    numberOfDevices = 0;
+    numberOfDevices  = 0;
+    compressedUpload = false;
 
     qRegisterMetaType<OP_DFU::Status>("Status");
 
@@ -75,9 +78,9 @@ DFUObject::DFUObject(bool _debug, bool _use_serial, QString portname) :
         QTimer::singleShot(200, &m_eventloop, SLOT(quit()));
         m_eventloop.exec();
         QList<USBPortInfo> devices;
-        devices = USBMonitor::instance()->availableDevices(0x20a0, -1, -1, USBMonitor::Bootloader);
+        devices = bootloaders(usbSerial);
         if (devices.length() == 1) {
-            if (hidHandle.open(1, devices.first().vendorID, devices.first().productID, 0, 0) == 1) {
+            if (hidHandle.open(1, devices.first().vendorID, devices.first().productID, 0, 0, usbSerial) == 1) {
                 mready = true;
                 QTimer::singleShot(200, &m_eventloop, SLOT(quit()));
                 m_eventloop.exec();
@@ -97,11 +100,11 @@ DFUObject::DFUObject(bool _debug, bool _use_serial, QString portname) :
                     QTimer::singleShot(2000, &m_eventloop, SLOT(quit()));
                 }
                 m_eventloop.exec();
-                devices = USBMonitor::instance()->availableDevices(0x20a0, -1, -1, USBMonitor::Bootloader);
+                devices = bootloaders(usbSerial);
                 qDebug() << "Devices length: " << devices.length();
                 if (devices.length() == 1) {
                     qDebug() << "Opening device";
-                    if (hidHandle.open(1, devices.first().vendorID, devices.first().productID, 0, 0) == 1) {
+                    if (hidHandle.open(1, devices.first().vendorID, devices.first().productID, 0, 0, usbSerial) == 1) {
                         QTimer::singleShot(200, &m_eventloop, SLOT(quit()));
                         m_eventloop.exec();
                         qDebug() << "OP_DFU detected after delay";
@@ -132,6 +135,23 @@ DFUObject::~DFUObject()
     }
 }
 
+/**
+   Lists the connected bootloaders, or only the one with the given USB serial number
+ */
+QList<USBPortInfo> DFUObject::bootloaders(const QString &usbSerial)
+{
+    QList<USBPortInfo> devices = USBMonitor::instance()->availableDevices(0x20a0, -1, -1, USBMonitor::Bootloader);
+
+    if (!usbSerial.isEmpty()) {
+        for (int i = devices.length() - 1; i >= 0; --i) {
+            if (devices[i].serialNumber != usbSerial) {
+                devices.removeAt(i);
+            }
+        }
+    }
+    return devices;
+}
+
 bool DFUObject::SaveByteArrayToFile(QString const & sfile, const QByteArray &array)
 {
     QFile file(sfile);
@@ -179,8 +199,9 @@ bool DFUObject::enterDFU(int const &devNumber)
    Tells the board to get ready for an upload. It will in particular
    erase the memory to make room for the data. You will have to query
    its status to wait until erase is done before doing the actual upload.
+   A non zero uncompressedSize tells the data is an LZ4 stream decompressing to that size.
  */
-bool DFUObject::StartUpload(qint32 const & numberOfBytes, TransferTypes const & type, quint32 crc)
+bool DFUObject::StartUpload(qint32 const & numberOfBytes, TransferTypes const & type, quint32 crc, quint32 uncompressedSize)
 {
     int lastPacketCount;
     qint32 numberOfPackets = numberOfBytes / 4 / 14;
@@ -199,12 +220,18 @@ bool DFUObject::StartUpload(qint32 const & numberOfBytes, TransferTypes const &
     buf[3]  = numberOfPackets >> 16; // DFU Count
     buf[4]  = numberOfPackets >> 8; // DFU Count
     buf[5]  = numberOfPackets; // DFU Count
-    buf[6]  = (int)type; // DFU Data0
+    buf[6]  = (int)type | (uncompressedSize ? DFU_TRANSFER_COMPRESSED : 0); // DFU Data0
     buf[7]  = lastPacketCount; // DFU Data1
     buf[8]  = crc >> 24;
     buf[9]  = crc >> 16;
     buf[10] = crc >> 8;
     buf[11] = crc;
+    buf[12] = 0;
+    buf[13] = 0;
+    buf[14] = uncompressedSize >> 24; // DFU second option word
+    buf[15] = uncompressedSize >> 16;
+    buf[16] = uncompressedSize >> 8;
+    buf[17] = uncompressedSize;
     if (debug) {
         qDebug() << "Number of packets:" << numberOfPackets << " Size of last packet:" << lastPacketCount;
     }
@@ -253,7 +280,7 @@ bool DFUObject::UploadData(qint32 const & numberOfBytes, QByteArray & data)
             printProgBar((int)percentage, "UPLOADING");
         }
         laspercentage = (int)percentage;
-        if (packetcount == numberOfPackets) {
+        if (packetcount == numberOfPackets - 1) {
             packetsize = lastPacketCount;
         } else {
             packetsize = 14;
@@ -617,9 +644,10 @@ bool DFUObject::findDevices()
         return false;
     }
 
-    numberOfDevices = buf[7];
+    numberOfDevices  = buf[7];
     RWFlags = buf[8];
     RWFlags = RWFlags << 8 | buf[9];
+    compressedUpload = (buf[2] & DFU_CAPABILITY_COMPRESSED) != 0;
 
     if (buf[1] == OP_DFU::Rep_Capabilities) {
         for (int x = 0; x < numberOfDevices; ++x) {
@@ -761,7 +789,24 @@ OP_DFU::Status DFUObject::UploadFirmwareT(const QString &sfile, const bool &veri
         qDebug() << "NEW FIRMWARE CRC=" << crc;
     }
 
-    if (!StartUpload(arr.length(), OP_DFU::FW, crc)) {
+    // Most of the flashing time is spent on the link, send a compressed image when the
+    // bootloader can take it and it pays off
+    QByteArray data = arr;
+    quint32 uncompressedSize = 0;
+    if (compressedUpload) {
+        QByteArray compressed = CompressLZ4(arr);
+        if (compressed.length() < arr.length() * 9 / 10) {
+            // padding of the last word is ignored past the decompressed size
+            compressed.append(QByteArray((4 - compressed.length() % 4) % 4, 0));
+            data = compressed;
+            uncompressedSize = arr.length();
+            if (debug) {
+                qDebug() << "Compressed to" << data.length() << "bytes";
+            }
+        }
+    }
+
+    if (!StartUpload(data.length(), OP_DFU::FW, crc, uncompressedSize)) {
         ret = StatusRequest();
         if (debug) {
             qDebug() << "StartUpload failed";
@@ -794,7 +839,7 @@ OP_DFU::Status DFUObject::UploadFirmwareT(const QString &sfile, const bool &veri
     }
 
     emit operationProgress(QString("Uploading firmware"));
-    if (!UploadData(arr.length(), arr)) {
+    if (!UploadData(data.length(), data)) {
         ret = StatusRequest();
         if (debug) {
             qDebug() << "Upload failed (upload data)";
@@ -816,11 +861,12 @@ OP_DFU::Status DFUObject::UploadFirmwareT(const QString &sfile, const bool &veri
     }
 
     if (verify) {
+        // The bootloader already checked the flash against the CRC sent with StartUpload
+        // before reporting success, so ask it for the CRC of the flash once more instead
+        // of reading the whole image back over HID.
         emit operationProgress(QString("Verifying firmware"));
         cout << "Starting code verification\n";
-        QByteArray arr2;
-        StartDownloadT(&arr2, arr.length(), OP_DFU::FW);
-        if (arr != arr2) {
+        if (!findDevices() || device >= devices.size() || devices[device].FW_CRC != crc) {
             cout << "Verify:FAILED\n";
             return OP_DFU::abort;
         }
@@ -876,6 +922,72 @@ OP_DFU::Status DFUObject::CompareFirmware(const QString &sfile, const CompareTyp
     }
 }
 
+static void appendLZ4Length(QByteArray &out, int length)
+{
+    for (; length >= 255; length -= 255) {
+        out.append((char)255);
+    }
+    out.append((char)length);
+}
+
+/**
+   Append an LZ4 sequence, literals followed by a match. A matchLength of 0 ends the block.
+ */
+static void appendLZ4Sequence(QByteArray &out, const char *literals, int literalLength, int offset, int matchLength)
+{
+    int matchCode = matchLength ? matchLength - 4 : 0;
+
+    out.append((char)((qMin(literalLength, 15) << 4) | qMin(matchCode, 15)));
+    if (literalLength >= 15) {
+        appendLZ4Length(out, literalLength - 15);
+    }
+    out.append(literals, literalLength);
+    if (matchLength) {
+        out.append((char)offset);
+        out.append((char)(offset >> 8));
+        if (matchCode >= 15) {
+            appendLZ4Length(out, matchCode - 15);
+        }
+    }
+}
+
+/**
+   Compress data as a single LZ4 block, greedily matching the last occurrence of each 4 byte sequence.
+   The bootloader stops decoding at the decompressed size, so the end of block rules are not needed.
+ */
+QByteArray DFUObject::CompressLZ4(const QByteArray &data)
+{
+    const int hashBits = 14;
+    const int maxOffset = 65535;
+    QVector<int> table(1 << hashBits, -1);
+    const uchar *in = (const uchar *)data.constData();
+    const int size  = data.length();
+    QByteArray out;
+    int anchor = 0;
+    int pos    = 0;
+
+    out.reserve(size);
+    while (pos + 4 <= size) {
+        quint32 sequence = in[pos] | (in[pos + 1] << 8) | (in[pos + 2] << 16) | ((quint32)in[pos + 3] << 24);
+        quint32 hash     = (sequence * 2654435761U) >> (32 - hashBits);
+        int candidate    = table[hash];
+        table[hash] = pos;
+        if (candidate < 0 || pos - candidate > maxOffset || memcmp(in + candidate, in + pos, 4)) {
+            ++pos;
+            continue;
+        }
+        int length = 4;
+        while (pos + length < size && in[candidate + length] == in[pos + length]) {
+            ++length;
+        }
+        appendLZ4Sequence(out, data.constData() + anchor, pos - anchor, pos - candidate, length);
+        pos   += length;
+        anchor = pos;
+    }
+    appendLZ4Sequence(out, data.constData() + anchor, size - anchor, 0, 0);
+    return out;
+}
+
 void DFUObject::CopyWords(char *source, char *destination, int count)
 {
     for (int x = 0; x < count; x = x + 4) {
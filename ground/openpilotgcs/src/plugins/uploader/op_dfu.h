@@ -30,6 +30,10 @@ using namespace std;
 #define MAX_PACKET_DATA_LEN 255
 #define MAX_PACKET_BUF_SIZE (1 + 1 + MAX_PACKET_DATA_LEN + 2)
 
+// Must match flight/libraries/inc/op_dfu.h
+#define DFU_CAPABILITY_COMPRESSED 0x01
+#define DFU_TRANSFER_COMPRESSED   0x80
+
 namespace OP_DFU {
 enum TransferTypes {
     FW,
@@ -113,7 +117,8 @@ class DFUObject : public QThread {
 public:
     static quint32 CRCFromQBArray(QByteArray array, quint32 Size);
     // DFUObject(bool debug);
-    DFUObject(bool debug, bool use_serial, QString port);
+    // usbSerial selects one bootloader by USB serial number when several are connected
+    DFUObject(bool debug, bool use_serial, QString port, QString usbSerial = QString());
 
     virtual ~DFUObject();
 
@@ -152,12 +157,16 @@ public:
     // Variables:
     QList<device> devices;
     int numberOfDevices;
+    // the bootloader decompresses LZ4 firmware images on the fly
+    bool compressedUpload;
     int send_delay;
     bool use_delay;
 
     // Helper functions:
     QString StatusToString(OP_DFU::Status const & status);
     static quint32 CRC32WideFast(quint32 Crc, quint32 Size, quint32 *Buffer);
+    static QByteArray CompressLZ4(const QByteArray &data);
+    static QList<USBPortInfo> bootloaders(const QString &usbSerial = QString());
     OP_DFU::eBoardType GetBoardType(int boardNum);
 
 
@@ -190,7 +199,7 @@ private:
 
     void CopyWords(char *source, char *destination, int count);
     void printProgBar(int const & percent, QString const & label);
-    bool StartUpload(qint32 const &numberOfBytes, TransferTypes const & type, quint32 crc);
+    bool StartUpload(qint32 const &numberOfBytes, TransferTypes const & type, quint32 crc, quint32 uncompressedSize = 0);
     bool UploadData(qint32 const & numberOfPackets, QByteArray & data);
 
     // Thread management:
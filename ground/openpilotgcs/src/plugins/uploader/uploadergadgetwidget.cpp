@@ -39,6 +39,7 @@
 #include <uavtalk/telemetrymanager.h>
 
 #include <QDesktopServices>
+#include <QFileDialog>
 #include <QMessageBox>
 #include <QProgressBar>
 #include <QDebug>
@@ -142,6 +143,7 @@ UploaderGadgetWidget::UploaderGadgetWidget(QWidget *parent) : QWidget(parent)
     m_currentIAPStep = IAP_STATE_READY;
     m_resetOnly = false;
     m_dfu = NULL;
+    m_batch = new BatchUploader(this);
     m_autoUpdateClosing = false;
 
     // Listen to autopilot connection events
@@ -159,6 +161,11 @@ UploaderGadgetWidget::UploaderGadgetWidget(QWidget *parent) : QWidget(parent)
     connect(m_config->safeBootButton, SIGNAL(clicked()), this, SLOT(systemSafeBoot()));
     connect(m_config->eraseBootButton, SIGNAL(clicked()), this, SLOT(systemEraseBoot()));
     connect(m_config->rescueButton, SIGNAL(clicked()), this, SLOT(systemRescue()));
+    connect(m_config->flashAllButton, SIGNAL(clicked()), this, SLOT(flashAll()));
+    connect(m_batch, SIGNAL(operationProgress(QString)), this, SLOT(log(QString)));
+    connect(m_batch, SIGNAL(deviceProgress(QString, int)), this, SLOT(flashAllProgress(QString, int)));
+    connect(m_batch, SIGNAL(deviceFinished(QString, bool)), this, SLOT(flashAllDeviceFinished(QString, bool)));
+    connect(m_batch, SIGNAL(finished(int, int, double)), this, SLOT(flashAllFinished(int, int, double)));
 
     getSerialPorts();
 
@@ -1135,6 +1142,60 @@ UploaderGadgetWidget::~UploaderGadgetWidget()
     }
 }
 
+/**
+   Flashes the same firmware to every board connected in bootloader mode
+ */
+void UploaderGadgetWidget::flashAll()
+{
+    if (m_dfu || m_batch->isRunning()) {
+        log("Cannot flash all boards while a board is open in the bootloader.");
+        return;
+    }
+    QString fileName = QFileDialog::getOpenFileName(this,
+                                                    tr("Select firmware file"),
+                                                    "",
+                                                    tr("Firmware Files (*.opfw *.bin)"));
+    if (fileName.isEmpty()) {
+        return;
+    }
+
+    clearLog();
+    m_batchProgress.clear();
+    m_config->flashAllButton->setEnabled(false);
+    m_config->rescueButton->setEnabled(false);
+    int count = m_batch->start(fileName);
+    if (count > 0) {
+        log(QString("Flashing %1 boards with %2").arg(count).arg(fileName));
+    } else {
+        log("No board in bootloader mode was flashed.");
+        m_config->flashAllButton->setEnabled(true);
+        m_config->rescueButton->setEnabled(true);
+    }
+}
+
+void UploaderGadgetWidget::flashAllProgress(QString serial, int percent)
+{
+    // Only log every quarter, a tray of boards would flood the log otherwise
+    int step = percent / 25;
+
+    if (step > m_batchProgress.value(serial, 0)) {
+        m_batchProgress.insert(serial, step);
+        log(QString("%1: %2%").arg(serial).arg(step * 25));
+    }
+}
+
+void UploaderGadgetWidget::flashAllDeviceFinished(QString serial, bool success)
+{
+    log(QString("%1: %2").arg(serial).arg(success ? "done" : "FAILED"));
+}
+
+void UploaderGadgetWidget::flashAllFinished(int succeeded, int failed, double throughput)
+{
+    log(QString("Flashed %1 boards, %2 failed, %3 kB/s total").arg(succeeded).arg(failed).arg(throughput / 1024.0, 0, 'f', 1));
+    m_config->flashAllButton->setEnabled(true);
+    m_config->rescueButton->setEnabled(true);
+}
+
 void UploaderGadgetWidget::openHelp()
 {
     QDesktopServices::openUrl(QUrl(tr("http://wiki.openpilot.org/x/AoBZ"), QUrl::StrictMode));
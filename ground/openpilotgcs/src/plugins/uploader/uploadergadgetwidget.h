@@ -33,6 +33,7 @@
 
 #include "enums.h"
 #include "op_dfu.h"
+#include "batchuploader.h"
 
 #include <QProgressDialog>
 #include "oplinkwatchdog.h"
@@ -120,10 +121,10 @@ public:
     static const int ERASE_TIMEOUT;
     static const int BOOTLOADER_TIMEOUT;
 
-    void log(QString str);
     bool autoUpdateCapable();
 
 public slots:
+    void log(QString str);
     void onAutopilotConnect();
     void onAutopilotDisconnect();
     void populate();
@@ -144,6 +145,8 @@ signals:
 private:
     Ui_UploaderWidget *m_config;
     DFUObject *m_dfu;
+    BatchUploader *m_batch;
+    QMap<QString, int> m_batchProgress;
     IAPStep m_currentIAPStep;
     bool m_resetOnly;
     OPLinkWatchdog m_oplinkwatchdog;
@@ -171,6 +174,10 @@ private slots:
     void systemReboot();
     void commonSystemBoot(bool safeboot = false, bool erase = false);
     void systemRescue();
+    void flashAll();
+    void flashAllProgress(QString serial, int percent);
+    void flashAllDeviceFinished(QString serial, bool success);
+    void flashAllFinished(int succeeded, int failed, double throughput);
     void getSerialPorts();
     void uploadStarted();
     void uploadEnded(bool succeed);
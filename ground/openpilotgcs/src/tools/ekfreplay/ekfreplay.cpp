@@ -0,0 +1,526 @@
+/**
+ ******************************************************************************
+ *
+ * @file       ekfreplay.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @addtogroup GCSTools
+ * @{
+ * @addtogroup EKFReplay
+ * @{
+ * @brief Replay of logged sensor data through the flight EKF
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+
+#include "ekfreplay.h"
+
+#include "uavobjectmanager.h"
+#include "accelsensor.h"
+#include "barosensor.h"
+#include "gpspositionsensor.h"
+#include "gpssettings.h"
+#include "gpsvelocitysensor.h"
+#include "gyrosensor.h"
+#include "magsensor.h"
+#include "revosettings.h"
+
+#include <utils/logfile.h>
+
+#include <QDebug>
+
+#include <algorithm>
+#include <limits>
+#include <math.h>
+#include <string.h>
+
+// The filter is built in, its covariance and measurement model are needed for the innovations
+#include "insgps13state.c"
+
+extern "C" {
+#include "CoordinateConversions.h"
+}
+
+// As in filterekf.c
+#define DT_ALPHA    1e-3f
+#define DT_MIN      1e-6f
+#define DT_MAX      1.0f
+#define INIT_STAGES 10
+
+// As in filterbaro.c
+#define BARO_INIT_CYCLES 100
+
+#define UPDATED(type) (1 << (type))
+#define CORRECTION_UPDATES \
+    (UPDATED(SampleMag) | UPDATED(SampleBaro) | UPDATED(SamplePosition) | UPDATED(SampleVelocity))
+
+EKFReplay::EKFReplay(UAVObjectManager *objMngr) :
+    m_objMngr(objMngr), m_initialDT(DT_MIN), m_baro(0.0f), m_covarianceDT(0.0f), m_covarianceSteps(0)
+{
+    memset(&m_home, 0, sizeof(m_home));
+    memset(m_gyro, 0, sizeof(m_gyro));
+    memset(m_accel, 0, sizeof(m_accel));
+    memset(m_mag, 0, sizeof(m_mag));
+    memset(m_pos, 0, sizeof(m_pos));
+    memset(m_vel, 0, sizeof(m_vel));
+}
+
+bool EKFReplay::load(const QString &fileName)
+{
+    LogFile log;
+
+    log.setFileName(fileName);
+    if (!log.open(QIODevice::ReadOnly)) {
+        m_errorString = QString("Cannot open %1").arg(fileName);
+        return false;
+    }
+
+    // Only the index of the object updates built by the replay is used
+    log.startReplay();
+    log.pauseReplay();
+    int startTime = log.replayStartTime();
+    int endTime   = log.replayEndTime();
+
+    m_samples.clear();
+    bool success = loadSettings(log, startTime, endTime);
+    if (success) {
+        loadSamples(log, GyroSensor::GetInstance(m_objMngr), SampleGyro, startTime, endTime);
+        loadSamples(log, AccelSensor::GetInstance(m_objMngr), SampleAccel, startTime, endTime);
+        loadSamples(log, MagSensor::GetInstance(m_objMngr), SampleMag, startTime, endTime);
+        loadSamples(log, BaroSensor::GetInstance(m_objMngr), SampleBaro, startTime, endTime);
+        loadSamples(log, GPSPositionSensor::GetInstance(m_objMngr), SamplePosition, startTime, endTime);
+        loadSamples(log, GPSVelocitySensor::GetInstance(m_objMngr), SampleVelocity, startTime, endTime);
+    }
+    log.close();
+    if (!success) {
+        return false;
+    }
+
+    std::stable_sort(m_samples.begin(), m_samples.end(), sampleBefore);
+
+    int gyroCount = 0;
+    quint32 firstGyro = 0;
+    quint32 lastGyro  = 0;
+    foreach(const Sample &sample, m_samples) {
+        if (sample.type == SampleGyro) {
+            if (gyroCount++ == 0) {
+                firstGyro = sample.timestamp;
+            }
+            lastGyro = sample.timestamp;
+        }
+    }
+    if (gyroCount < 2) {
+        m_errorString = QString("%1 has no GyroSensor updates to replay").arg(fileName);
+        return false;
+    }
+    m_initialDT = qBound(DT_MIN, (lastGyro - firstGyro) * 1e-3f / (gyroCount - 1), DT_MAX);
+
+    preprocess();
+    return true;
+}
+
+/**
+ * The settings are the last update of each settings object in the log, or the defaults
+ */
+bool EKFReplay::loadSettings(LogFile &log, int startTime, int endTime)
+{
+    QList<UAVObject *> settings;
+
+    settings << HomeLocation::GetInstance(m_objMngr) << GPSSettings::GetInstance(m_objMngr)
+             << RevoSettings::GetInstance(m_objMngr) << EKFConfiguration::GetInstance(m_objMngr);
+    foreach(UAVObject * obj, settings) {
+        QVector<LogFile::ReplaySample> samples = log.replaySamples(obj->getObjID(), obj->getInstID(), startTime, endTime);
+        if (!samples.isEmpty() && samples.last().size == (int)obj->getNumBytes()) {
+            obj->unpack(samples.last().data);
+        } else {
+            qWarning() << obj->getName() << "is not in the log, using the defaults";
+        }
+    }
+
+    m_home = HomeLocation::GetInstance(m_objMngr)->getData();
+    if (m_home.Set != HomeLocation::SET_TRUE) {
+        m_errorString = "The HomeLocation of the log is not set, the EKF needs it";
+        return false;
+    }
+    if (m_home.Be[0] * m_home.Be[0] + m_home.Be[1] * m_home.Be[1] + m_home.Be[2] * m_home.Be[2] < 1e-5f) {
+        m_errorString = "The HomeLocation of the log has no magnetic field, the EKF needs it";
+        return false;
+    }
+    return true;
+}
+
+void EKFReplay::loadSamples(LogFile &log, UAVObject *obj, SampleType type, int startTime, int endTime)
+{
+    // the GPS position is converted to the local frame as filterlla.c does
+    GPSSettings::DataFields gpsSettings = GPSSettings::GetInstance(m_objMngr)->getData();
+    int32_t homeLLA[3] = { m_home.Latitude, m_home.Longitude, (int32_t)(m_home.Altitude * 1e4f) };
+    double homeECEF[3];
+    float homeRne[3][3];
+
+    LLA2ECEF(homeLLA, homeECEF);
+    RneFromLLA(homeLLA, homeRne);
+
+    foreach(const LogFile::ReplaySample &replaySample, log.replaySamples(obj->getObjID(), obj->getInstID(), startTime, endTime)) {
+        if (replaySample.size != (int)obj->getNumBytes()) {
+            continue;
+        }
+        obj->unpack(replaySample.data);
+
+        Sample sample;
+        sample.timestamp = replaySample.timestamp;
+        sample.type = type;
+        switch (type) {
+        case SampleGyro:
+        {
+            GyroSensor::DataFields data = static_cast<GyroSensor *>(obj)->getData();
+            sample.value[0] = data.x;
+            sample.value[1] = data.y;
+            sample.value[2] = data.z;
+            break;
+        }
+        case SampleAccel:
+        {
+            AccelSensor::DataFields data = static_cast<AccelSensor *>(obj)->getData();
+            sample.value[0] = data.x;
+            sample.value[1] = data.y;
+            sample.value[2] = data.z;
+            break;
+        }
+        case SampleMag:
+        {
+            MagSensor::DataFields data = static_cast<MagSensor *>(obj)->getData();
+            sample.value[0] = data.x;
+            sample.value[1] = data.y;
+            sample.value[2] = data.z;
+            break;
+        }
+        case SampleBaro:
+            sample.value[0] = static_cast<BaroSensor *>(obj)->getAltitude();
+            sample.value[1] = sample.value[2] = 0.0f;
+            break;
+        case SamplePosition:
+        {
+            GPSPositionSensor::DataFields data = static_cast<GPSPositionSensor *>(obj)->getData();
+            if (data.PDOP >= gpsSettings.MaxPDOP || data.Satellites < gpsSettings.MinSatellites
+                || data.Status != GPSPositionSensor::STATUS_FIX3D || (data.Latitude == 0 && data.Longitude == 0)) {
+                continue;
+            }
+            int32_t LLA[3] = { data.Latitude, data.Longitude, (int32_t)((data.Altitude + data.GeoidSeparation) * 1e4f) };
+            LLA2Base(LLA, homeECEF, homeRne, sample.value);
+            break;
+        }
+        case SampleVelocity:
+        {
+            GPSVelocitySensor::DataFields data = static_cast<GPSVelocitySensor *>(obj)->getData();
+            sample.value[0] = data.North;
+            sample.value[1] = data.East;
+            sample.value[2] = data.Down;
+            break;
+        }
+        }
+        m_samples.append(sample);
+    }
+}
+
+/**
+ * Applies the baro offset as filterbaro.c does with a GPS: the first GPS altitude and
+ * the first baro samples give the initial offset, the GPS altitude corrects it afterwards.
+ * The baro samples used for the initial offset are not passed to the EKF.
+ */
+void EKFReplay::preprocess()
+{
+    float alpha   = RevoSettings::GetInstance(m_objMngr)->getBaroGPSOffsetCorrectionAlpha();
+    float offset  = 0.0f;
+    float baroAlt = 0.0f;
+    float gpsAlt  = 0.0f;
+    int firstRun  = BARO_INIT_CYCLES;
+
+    QVector<Sample> samples;
+
+    samples.reserve(m_samples.size());
+    foreach(Sample sample, m_samples) {
+        if (firstRun) {
+            if (sample.type == SamplePosition && firstRun == BARO_INIT_CYCLES) {
+                gpsAlt = sample.value[2];
+                firstRun--;
+            }
+            if (sample.type == SampleBaro) {
+                if (firstRun < BARO_INIT_CYCLES) {
+                    offset  = ((float)(BARO_INIT_CYCLES - firstRun) / BARO_INIT_CYCLES) * offset
+                              + ((float)firstRun / BARO_INIT_CYCLES) * (sample.value[0] + gpsAlt);
+                    baroAlt = sample.value[0];
+                    firstRun--;
+                }
+                continue;
+            }
+        } else {
+            if (sample.type == SamplePosition) {
+                offset = offset * alpha + (1.0f - alpha) * (baroAlt + sample.value[2]);
+            }
+            if (sample.type == SampleBaro) {
+                baroAlt = sample.value[0];
+                sample.value[0] -= offset;
+            }
+        }
+        samples.append(sample);
+    }
+    m_samples = samples;
+}
+
+/**
+ * Time order, the gyro last of the samples of a same time as it triggers the filter
+ * (the "gyros last" rule of filterekf.c)
+ */
+bool EKFReplay::sampleBefore(const Sample &a, const Sample &b)
+{
+    if (a.timestamp != b.timestamp) {
+        return a.timestamp < b.timestamp;
+    }
+    return a.type != SampleGyro && b.type == SampleGyro;
+}
+
+/**
+ * Replays all the samples, the prediction and initialization steps are those of filter() in filterekf.c
+ */
+EKFReplay::Result EKFReplay::run(const EKFConfiguration::DataFields &config)
+{
+    Result result;
+
+    memset(&result, 0, sizeof(result));
+
+    float zeros[3]   = { 0.0f, 0.0f, 0.0f };
+    quint16 updated  = 0;
+    quint16 pending  = 0;
+    bool inited      = false;
+    int initStage    = 0;
+    float dTAverage  = m_initialDT;
+    bool gyroTimeSet = false;
+    quint32 gyroTime = 0;
+
+    m_covarianceDT    = 0.0f;
+    m_covarianceSteps = 0;
+
+    foreach(const Sample &sample, m_samples) {
+        switch (sample.type) {
+        case SampleGyro:
+            memcpy(m_gyro, sample.value, sizeof(m_gyro));
+            break;
+        case SampleAccel:
+            memcpy(m_accel, sample.value, sizeof(m_accel));
+            break;
+        case SampleMag:
+            memcpy(m_mag, sample.value, sizeof(m_mag));
+            break;
+        case SampleBaro:
+            m_baro = sample.value[0];
+            break;
+        case SamplePosition:
+            memcpy(m_pos, sample.value, sizeof(m_pos));
+            break;
+        case SampleVelocity:
+            memcpy(m_vel, sample.value, sizeof(m_vel));
+            break;
+        }
+        updated |= UPDATED(sample.type);
+        if (sample.type != SampleGyro || !(updated & UPDATED(SampleAccel))) {
+            continue;
+        }
+
+        // the averaged time between the gyro samples, with the log time rather than the board time
+        float dT = gyroTimeSet ? qBound(DT_MIN, (sample.timestamp - gyroTime) * 1e-3f, DT_MAX) : dTAverage;
+        gyroTimeSet = true;
+        gyroTime    = sample.timestamp;
+        dTAverage   = dTAverage * (1.0f - DT_ALPHA) + dT * DT_ALPHA;
+        dT = dTAverage;
+
+        float gyros[3] = { DEG2RAD(m_gyro[0]), DEG2RAD(m_gyro[1]), DEG2RAD(m_gyro[2]) };
+
+        if (!inited && (updated & UPDATED(SampleMag)) && (updated & UPDATED(SampleBaro)) && (updated & UPDATED(SamplePosition))) {
+            if (initStage == 0) {
+                INSGPSInit();
+                float Be2 = m_home.Be[0] * m_home.Be[0] + m_home.Be[1] * m_home.Be[1] + m_home.Be[2] * m_home.Be[2];
+                // the mag variance is in mGa, the EKF works with a normalized vector
+                float magVar[3]      = { config.R[EKFConfiguration::R_MAGX] / Be2,
+                                         config.R[EKFConfiguration::R_MAGY] / Be2,
+                                         config.R[EKFConfiguration::R_MAGZ] / Be2 };
+                float accelVar[3]    = { config.Q[EKFConfiguration::Q_ACCELX],
+                                         config.Q[EKFConfiguration::Q_ACCELY],
+                                         config.Q[EKFConfiguration::Q_ACCELZ] };
+                float gyroVar[3]     = { config.Q[EKFConfiguration::Q_GYROX],
+                                         config.Q[EKFConfiguration::Q_GYROY],
+                                         config.Q[EKFConfiguration::Q_GYROZ] };
+                float gyroBiasVar[3] = { config.Q[EKFConfiguration::Q_GYRODRIFTX],
+                                         config.Q[EKFConfiguration::Q_GYRODRIFTY],
+                                         config.Q[EKFConfiguration::Q_GYRODRIFTZ] };
+                INSSetMagVar(magVar);
+                INSSetAccelVar(accelVar);
+                INSSetGyroVar(gyroVar);
+                INSSetGyroBiasVar(gyroBiasVar);
+                INSSetBaroVar(config.R[EKFConfiguration::R_BAROZ]);
+                INSSetGyroBias(zeros);
+
+                // initial attitude from the accels and the mag
+                float rpy[3];
+                rpy[0] = atan2f(-m_accel[1], -m_accel[2]);
+                float zn  = cosf(rpy[0]) * m_mag[2] + sinf(rpy[0]) * m_mag[1];
+                float yn  = cosf(rpy[0]) * m_mag[1] - sinf(rpy[0]) * m_mag[2];
+                float azn = cosf(rpy[0]) * m_accel[2] + sinf(rpy[0]) * m_accel[1];
+                rpy[1] = atan2f(m_accel[0], -azn);
+                float xn  = cosf(rpy[1]) * m_mag[0] + sinf(rpy[1]) * zn;
+                rpy[2] = atan2f(-yn, xn);
+                rpy[0] = RAD2DEG(rpy[0]);
+                rpy[1] = RAD2DEG(rpy[1]);
+                rpy[2] = RAD2DEG(rpy[2]);
+                float q[4];
+                RPY2Quaternion(rpy, q);
+
+                INSSetState(m_pos, zeros, q, zeros, zeros);
+
+                float P[EKFConfiguration::P_NUMELEM];
+                memcpy(P, config.P, sizeof(P));
+                INSResetP(P);
+                m_covarianceDT    = 0.0f;
+                m_covarianceSteps = 0;
+                pending = 0;
+            } else {
+                INSStatePrediction(gyros, m_accel, dT);
+            }
+            if (++initStage > INIT_STAGES) {
+                inited = true;
+            }
+            continue;
+        }
+        if (!inited) {
+            continue;
+        }
+
+        INSStatePrediction(gyros, m_accel, dT);
+        m_covarianceDT += dT;
+        m_covarianceSteps++;
+
+        pending |= updated & CORRECTION_UPDATES;
+        updated  = 0;
+        if (pending || m_covarianceDT >= DT_MAX ||
+            (config.CovarianceDecimation && m_covarianceSteps >= config.CovarianceDecimation)) {
+            correct(config, pending, result);
+            pending = 0;
+            if (result.diverged) {
+                break;
+            }
+        }
+    }
+
+    if (!inited || result.corrections == 0) {
+        result.diverged = true;
+    }
+    result.score = 0.0;
+    for (int group = 0; group < NUM_GROUPS; group++) {
+        if (result.count[group]) {
+            result.rms[group]  = sqrt(result.rms[group] / result.count[group]);
+            result.nis[group] /= result.count[group];
+            result.score += fabs(log(result.nis[group]));
+        }
+    }
+    if (result.diverged || isnan(result.score)) {
+        result.diverged = true;
+        result.score    = std::numeric_limits<double>::infinity();
+    }
+    return result;
+}
+
+/**
+ * Correction step, as correctionCb() in filterekf.c (outdoor, no airspeed).
+ * The innovations are measured after the covariance prediction, before the correction.
+ */
+void EKFReplay::correct(const EKFConfiguration::DataFields &config, quint16 updates, Result &result)
+{
+    quint16 sensors = 0;
+
+    if (updates & UPDATED(SampleMag)) {
+        sensors |= MAG_SENSORS;
+    }
+    if (updates & UPDATED(SampleBaro)) {
+        sensors |= BARO_SENSOR;
+    }
+    if (updates & UPDATED(SamplePosition)) {
+        sensors |= POS_SENSORS;
+    }
+    if (updates & UPDATED(SampleVelocity)) {
+        sensors |= HORIZ_SENSORS | VERT_SENSORS;
+    }
+
+    INSSetMagNorth(m_home.Be);
+    float posVar[3] = { config.R[EKFConfiguration::R_GPSPOSNORTH],
+                        config.R[EKFConfiguration::R_GPSPOSEAST],
+                        config.R[EKFConfiguration::R_GPSPOSDOWN] };
+    float velVar[3] = { config.R[EKFConfiguration::R_GPSVELNORTH],
+                        config.R[EKFConfiguration::R_GPSVELEAST],
+                        config.R[EKFConfiguration::R_GPSVELDOWN] };
+    INSSetPosVelVar(posVar, velVar);
+
+    if (sensors || m_covarianceDT >= DT_MAX ||
+        (config.CovarianceDecimation && m_covarianceSteps >= config.CovarianceDecimation)) {
+        INSCovariancePrediction(m_covarianceDT);
+        m_covarianceDT    = 0.0f;
+        m_covarianceSteps = 0;
+    }
+
+    if (sensors) {
+        // measurement vector as built by INSCorrection()
+        float Bmag = sqrtf(m_mag[0] * m_mag[0] + m_mag[1] * m_mag[1] + m_mag[2] * m_mag[2]);
+        float Z[NUMV] = { m_pos[0], m_pos[1], m_pos[2], m_vel[0], m_vel[1], m_vel[2],
+                          m_mag[0] / Bmag, m_mag[1] / Bmag, m_mag[2] / Bmag, m_baro };
+        float Y[NUMV];
+        LinearizeH(ekf.X, ekf.Be, ekf.H);
+        MeasurementEq(ekf.X, ekf.Be, Y);
+
+        for (int i = 0; i < NUMV; i++) {
+            if (!(sensors & (1 << i))) {
+                continue;
+            }
+            // innovation variance H P H' + R of this measurement alone
+            float S = ekf.R[i];
+            for (int j = 0; j < NUMX; j++) {
+                for (int k = 0; k < NUMX; k++) {
+                    S += ekf.H[i][j] * PELEM(j, k) * ekf.H[i][k];
+                }
+            }
+            float innovation = Z[i] - Y[i];
+            int group = i < 3 ? GroupPosition : i < 6 ? GroupVelocity : i < 9 ? GroupMag : GroupBaro;
+            result.rms[group] += innovation * innovation;
+            result.nis[group] += innovation * innovation / S;
+            result.count[group]++;
+        }
+
+        INSCorrection(m_mag, m_pos, m_vel, m_baro, sensors);
+        result.corrections++;
+    }
+
+    // the board resets the covariance when it becomes invalid, a tuning that gets there is rejected
+    float P[NUMX];
+    INSGetP(P);
+    for (int t = 0; t < NUMX; t++) {
+        if (!IS_REAL(P[t]) || P[t] <= 0.0f) {
+            result.diverged = true;
+            break;
+        }
+    }
+}
+
+/**
+ * @}
+ * @}
+ */
@@ -0,0 +1,123 @@
+/**
+ ******************************************************************************
+ *
+ * @file       ekfreplay.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @addtogroup GCSTools
+ * @{
+ * @addtogroup EKFReplay
+ * @{
+ * @brief Replay of logged sensor data through the flight EKF
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef EKFREPLAY_H
+#define EKFREPLAY_H
+
+#include "ekfconfiguration.h"
+#include "homelocation.h"
+
+#include <QString>
+#include <QVector>
+
+class LogFile;
+class UAVObject;
+class UAVObjectManager;
+
+/**
+ * Runs the sensor updates recorded in an OPL log through the 13 state EKF of the
+ * flight code (insgps13state.c), sequenced as filterekf.c does it on the board,
+ * and measures how well the filter predicts the measurements it is corrected with.
+ *
+ * The GPS position is converted to the local frame and the baro offset is tracked
+ * once when loading, as the LLA and baro filters of the StateEstimation module do,
+ * so a run only costs the EKF itself. The settings (HomeLocation, GPSSettings,
+ * RevoSettings and the EKFConfiguration that is tuned) are the last ones found in
+ * the log, or the defaults.
+ *
+ * The filter state is global in insgps13state.c, a process runs one replay at a time.
+ */
+class EKFReplay {
+public:
+    enum Group { GroupPosition, GroupVelocity, GroupMag, GroupBaro, NUM_GROUPS };
+
+    // Innovation statistics of one run
+    struct Result {
+        bool   diverged; // the covariance became invalid, or the filter never initialized
+        int    corrections;
+        // per measurement group, over all the corrections
+        int    count[NUM_GROUPS];
+        double rms[NUM_GROUPS]; // innovation, in the units of the measurement
+        double nis[NUM_GROUPS]; // mean normalized innovation squared, 1 for a consistent filter
+        // sum of |ln(nis)| of the measured groups, lower is better
+        double score;
+    };
+
+    EKFReplay(UAVObjectManager *objMngr);
+
+    bool load(const QString &fileName);
+    Result run(const EKFConfiguration::DataFields &config);
+
+    QString errorString() const
+    {
+        return m_errorString;
+    }
+    int numSamples() const
+    {
+        return m_samples.size();
+    }
+    // duration of the replayed sensor data, in ms
+    quint32 duration() const
+    {
+        return m_samples.isEmpty() ? 0 : m_samples.last().timestamp - m_samples.first().timestamp;
+    }
+
+private:
+    enum SampleType { SampleGyro, SampleAccel, SampleMag, SampleBaro, SamplePosition, SampleVelocity };
+
+    struct Sample {
+        quint32 timestamp; // log time, ms
+        quint8  type;
+        float   value[3];
+    };
+
+    bool loadSettings(LogFile &log, int startTime, int endTime);
+    void loadSamples(LogFile &log, UAVObject *obj, SampleType type, int startTime, int endTime);
+    void preprocess();
+    void correct(const EKFConfiguration::DataFields &config, quint16 updates, Result &result);
+
+    static bool sampleBefore(const Sample &a, const Sample &b);
+
+    UAVObjectManager *m_objMngr;
+    QString m_errorString;
+    QVector<Sample> m_samples;
+    HomeLocation::DataFields m_home;
+    // average gyro period of the log, the initial dT of the filter
+    float m_initialDT;
+
+    // working set of the filter, as in filterekf.c
+    float m_gyro[3];
+    float m_accel[3];
+    float m_mag[3];
+    float m_baro;
+    float m_pos[3];
+    float m_vel[3];
+    float m_covarianceDT;
+    int   m_covarianceSteps;
+};
+
+#endif // EKFREPLAY_H
@@ -0,0 +1,39 @@
+include(../../../openpilotgcs.pri)
+
+TEMPLATE = app
+TARGET = ekfreplay
+DESTDIR = $$GCS_APP_PATH
+
+QT -= gui
+CONFIG += console
+CONFIG -= app_bundle
+
+# Only the UAVObjects and Utils libraries are used, the application never loads the plugins
+include(../../plugins/uavobjects/uavobjects.pri)
+LIBS *= -L$$GCS_PLUGIN_PATH/OpenPilot
+
+# The filter itself is the flight code, insgps13state.c is included by ekfreplay.cpp
+FLIGHT_LIB_DIR = $$ROOT_DIR/flight/libraries
+INCLUDEPATH += $$FLIGHT_LIB_DIR \
+    $$FLIGHT_LIB_DIR/inc \
+    $$FLIGHT_LIB_DIR/math \
+    $$ROOT_DIR/flight/pios/inc
+QMAKE_CFLAGS += -std=gnu99
+
+HEADERS += ekfreplay.h
+
+SOURCES += main.cpp \
+    ekfreplay.cpp \
+    $$FLIGHT_LIB_DIR/CoordinateConversions.c
+
+!macx {
+    target.path = /bin
+    INSTALLS   += target
+}
+
+linux-* {
+    QMAKE_RPATHDIR = \'\$$ORIGIN\'/$$relative_path($$GCS_LIBRARY_PATH, $$GCS_APP_PATH)
+    QMAKE_RPATHDIR += \'\$$ORIGIN\'/$$relative_path($$GCS_PLUGIN_PATH/OpenPilot, $$GCS_APP_PATH)
+    QMAKE_RPATHDIR += \'\$$ORIGIN\'/$$relative_path($$GCS_QT_LIBRARY_PATH, $$GCS_APP_PATH)
+    include(../../rpath.pri)
+}
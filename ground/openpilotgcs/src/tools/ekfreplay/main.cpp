@@ -0,0 +1,292 @@
+/**
+ ******************************************************************************
+ *
+ * @file       main.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @addtogroup GCSTools
+ * @{
+ * @addtogroup EKFReplay
+ * @{
+ * @brief Offline tuning of the EKFConfiguration from logged sensor data
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+
+#include "ekfreplay.h"
+
+#include "uavobjectmanager.h"
+#include "uavobjectsinit.h"
+#include "uavobjectfield.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QProcess>
+#include <QTextStream>
+#include <QThread>
+
+#include <algorithm>
+#include <limits>
+#include <math.h>
+
+// One swept element of the EKFConfiguration
+struct Sweep {
+    QString name;
+    UAVObjectField *field;
+    int element;
+    QList<double>  values;
+};
+
+struct Run {
+    int index;
+    EKFReplay::Result result;
+};
+
+static const char *groupNames[EKFReplay::NUM_GROUPS] = { "pos", "vel", "mag", "baro" };
+
+/**
+ * Parses Field.Element=v1,v2,... or Field.Element=from:to:count, the latter for count
+ * values spaced logarithmically as variances are tuned in orders of magnitude
+ */
+static bool parseSweep(const QString &spec, EKFConfiguration *config, Sweep &sweep, QString &error)
+{
+    sweep.name    = spec.section('=', 0, 0);
+    sweep.field   = config->getField(sweep.name.section('.', 0, 0));
+    sweep.element = sweep.field ? sweep.field->getElementNames().indexOf(sweep.name.section('.', 1)) : -1;
+    if (sweep.element < 0) {
+        error = QString("Unknown EKFConfiguration element %1").arg(sweep.name);
+        return false;
+    }
+
+    QString values = spec.section('=', 1);
+    QStringList range = values.split(':');
+    bool ok = true;
+    if (range.size() == 3) {
+        double from = range[0].toDouble(&ok);
+        double to   = ok ? range[1].toDouble(&ok) : 0.0;
+        int count   = ok ? range[2].toInt(&ok) : 0;
+        ok = ok && from > 0.0 && to > 0.0 && count > 0;
+        for (int i = 0; ok && i < count; i++) {
+            sweep.values << (count > 1 ? from * pow(to / from, (double)i / (count - 1)) : from);
+        }
+    } else {
+        foreach(QString value, values.split(',', QString::SkipEmptyParts)) {
+            sweep.values << value.toDouble(&ok);
+            if (!ok) {
+                break;
+            }
+        }
+    }
+    if (!ok || sweep.values.isEmpty()) {
+        error = QString("Invalid values for %1: %2").arg(sweep.name).arg(values);
+        return false;
+    }
+    return true;
+}
+
+// Configuration of a combination, the index counts through the values of the first sweep first
+static EKFConfiguration::DataFields combination(EKFConfiguration *config, const QList<Sweep> &sweeps, int index)
+{
+    foreach(const Sweep &sweep, sweeps) {
+        sweep.field->setDouble(sweep.values[index % sweep.values.size()], sweep.element);
+        index /= sweep.values.size();
+    }
+    return config->getData();
+}
+
+static bool runBefore(const Run &a, const Run &b)
+{
+    return a.result.score < b.result.score;
+}
+
+static QString formatRun(const Run &run)
+{
+    const EKFReplay::Result &result = run.result;
+    QStringList fields;
+
+    fields << QString::number(run.index) << QString::number(result.diverged) << QString::number(result.corrections)
+           << QString::number(result.score, 'g', 9);
+    for (int group = 0; group < EKFReplay::NUM_GROUPS; group++) {
+        fields << QString::number(result.count[group]) << QString::number(result.rms[group], 'g', 9)
+               << QString::number(result.nis[group], 'g', 9);
+    }
+    return fields.join(' ');
+}
+
+static bool parseRun(const QString &line, Run &run)
+{
+    QStringList fields = line.split(' ');
+
+    if (fields.size() != 4 + 3 * EKFReplay::NUM_GROUPS) {
+        return false;
+    }
+    EKFReplay::Result &result = run.result;
+    run.index          = fields[0].toInt();
+    result.diverged    = fields[1].toInt();
+    result.corrections = fields[2].toInt();
+    result.score = result.diverged ? std::numeric_limits<double>::infinity() : fields[3].toDouble();
+    for (int group = 0; group < EKFReplay::NUM_GROUPS; group++) {
+        result.count[group] = fields[4 + 3 * group].toInt();
+        result.rms[group]   = fields[5 + 3 * group].toDouble();
+        result.nis[group]   = fields[6 + 3 * group].toDouble();
+    }
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCoreApplication::setApplicationName("ekfreplay");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Replays the sensor data of an OpenPilot log file (.opl) through the flight EKF "
+                                     "for combinations of EKFConfiguration values, and ranks them by how consistent "
+                                     "the measurement innovations are with the filter covariance.\n"
+                                     "The log needs the GyroSensor, AccelSensor, MagSensor, BaroSensor, "
+                                     "GPSPositionSensor and GPSVelocitySensor updates, at the highest possible "
+                                     "telemetry rate, and a HomeLocation that is set.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("log", "Log file to replay.");
+    QCommandLineOption sweepOption(QStringList() << "s" << "sweep",
+                                   "Values of an EKFConfiguration element, as Field.Element=v1,v2,... or "
+                                   "Field.Element=from:to:count (log spaced), e.g. Q.GyroX=1e-4:1e-1:4. "
+                                   "All the combinations of the swept elements are replayed.", "sweep");
+    QCommandLineOption jobsOption(QStringList() << "j" << "jobs",
+                                  "Number of replays run concurrently, defaults to the number of cores.", "n",
+                                  QString::number(QThread::idealThreadCount()));
+    QCommandLineOption topOption(QStringList() << "n" << "top", "Number of ranked combinations printed.", "n", "10");
+    QCommandLineOption workerOption("worker", "Internal, runs the share of the combinations of a worker process.",
+                                    "index", "-1");
+    parser.addOption(sweepOption);
+    parser.addOption(jobsOption);
+    parser.addOption(topOption);
+    parser.addOption(workerOption);
+    parser.process(app);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    if (parser.positionalArguments().size() != 1) {
+        parser.showHelp(1);
+    }
+    int jobs   = qMax(1, parser.value(jobsOption).toInt());
+    int top    = qMax(1, parser.value(topOption).toInt());
+    int worker = parser.value(workerOption).toInt();
+
+    UAVObjectManager objMngr;
+    UAVObjectsInitialize(&objMngr);
+    EKFReplay replay(&objMngr);
+
+    QElapsedTimer timer;
+    timer.start();
+    if (!replay.load(parser.positionalArguments().first())) {
+        err << replay.errorString() << endl;
+        return 1;
+    }
+
+    // The sweeps apply to the EKFConfiguration found in the log
+    EKFConfiguration *config = EKFConfiguration::GetInstance(&objMngr);
+    QList<Sweep> sweeps;
+    int combinations = 1;
+    foreach(QString spec, parser.values(sweepOption)) {
+        Sweep sweep;
+        QString error;
+        if (!parseSweep(spec, config, sweep, error)) {
+            err << error << endl;
+            return 1;
+        }
+        sweeps << sweep;
+        combinations *= sweep.values.size();
+    }
+
+    if (worker >= 0) {
+        // The filter state is global in the flight code, the replays are run in processes
+        // and each worker process runs every jobs-th combination
+        for (int index = worker; index < combinations; index += jobs) {
+            Run run;
+            run.index  = index;
+            run.result = replay.run(combination(config, sweeps, index));
+            out << formatRun(run) << endl;
+        }
+        return 0;
+    }
+
+    QList<Run> runs;
+    jobs = qMin(jobs, combinations);
+    if (jobs == 1) {
+        for (int index = 0; index < combinations; index++) {
+            Run run;
+            run.index  = index;
+            run.result = replay.run(combination(config, sweeps, index));
+            runs << run;
+        }
+    } else {
+        QList<QProcess *> workers;
+        for (int i = 0; i < jobs; i++) {
+            QProcess *process = new QProcess;
+            process->start(QCoreApplication::applicationFilePath(), QCoreApplication::arguments().mid(1)
+                           << "--jobs" << QString::number(jobs) << "--worker" << QString::number(i));
+            workers << process;
+        }
+        foreach(QProcess * process, workers) {
+            process->waitForFinished(-1);
+            if (process->exitStatus() != QProcess::NormalExit || process->exitCode() != 0) {
+                err << "A replay process failed: " << process->readAllStandardError() << endl;
+                qDeleteAll(workers);
+                return 1;
+            }
+            foreach(QString line, QString(process->readAllStandardOutput()).split('\n', QString::SkipEmptyParts)) {
+                Run run;
+                if (parseRun(line, run)) {
+                    runs << run;
+                }
+            }
+        }
+        qDeleteAll(workers);
+    }
+    std::stable_sort(runs.begin(), runs.end(), runBefore);
+
+    out << "Replayed " << replay.numSamples() << " samples (" << replay.duration() / 1000 << " s) for "
+        << combinations << " combinations in " << timer.elapsed() << " ms with " << jobs << " processes" << endl;
+    out << "score: sum of |ln(NIS)| per measurement group, lower is better; "
+        << "per group: innovation RMS / mean NIS (1 for a consistent filter)" << endl;
+    for (int rank = 0; rank < qMin(top, runs.size()); rank++) {
+        const Run &run = runs[rank];
+        const EKFReplay::Result &result = run.result;
+
+        combination(config, sweeps, run.index);
+        out << endl << "#" << rank + 1 << " score " << (result.diverged ? QString("diverged") : QString::number(result.score, 'g', 4))
+            << ", " << result.corrections << " corrections" << endl;
+        foreach(const Sweep &sweep, sweeps) {
+            out << "    " << sweep.name << " = " << sweep.field->getDouble(sweep.element) << endl;
+        }
+        for (int group = 0; group < EKFReplay::NUM_GROUPS; group++) {
+            if (result.count[group]) {
+                out << "    " << groupNames[group] << ": " << QString::number(result.rms[group], 'g', 4)
+                    << " / " << QString::number(result.nis[group], 'g', 4) << endl;
+            }
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @}
+ * @}
+ */
@@ -0,0 +1,484 @@
+/**
+ ******************************************************************************
+ *
+ * @file       logconverter.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @addtogroup GCSTools
+ * @{
+ * @addtogroup OPLogConvert
+ * @{
+ * @brief Batch conversion of OPL log files to per object columns
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "logconverter.h"
+
+#include "uavobjectmanager.h"
+#include "uavobjectfield.h"
+
+#include <utils/crc.h>
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFuture>
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrentRun>
+#include <QtEndian>
+
+#include <algorithm>
+#include <string.h>
+
+using namespace Utils;
+
+LogConverter::LogConverter(UAVObjectManager *objMngr) :
+    m_numSamples(0), m_numErrors(0), m_numUnknown(0)
+{
+    foreach(QList<UAVObject *> instances, objMngr->getObjects()) {
+        UAVObject *obj = instances.first();
+        ObjectStream *stream = new ObjectStream;
+
+        stream->name     = obj->getName();
+        stream->objId    = obj->getObjID();
+        stream->numBytes = obj->getNumBytes();
+        foreach(UAVObjectField * field, obj->getFields()) {
+            Column column;
+
+            column.name         = field->getName();
+            column.units        = field->getUnits();
+            column.type         = field->getType();
+            column.offset       = field->getDataOffset();
+            column.elements     = field->getNumElements();
+            column.elementSize  = field->getNumBytes() / field->getNumElements();
+            column.elementNames = field->getElementNames();
+            column.options      = field->getOptions();
+            stream->columns.append(column);
+        }
+        m_objects.insert(stream->objId, stream);
+    }
+}
+
+LogConverter::~LogConverter()
+{
+    qDeleteAll(m_objects);
+}
+
+int LogConverter::numObjects() const
+{
+    int count = 0;
+
+    foreach(const ObjectStream * obj, m_objects) {
+        if (!obj->samples.isEmpty()) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+/**
+ * Read the log records and decode all UAVTalk frames they contain.
+ * The payload of every record is collected in one stream first because
+ * the logger does not guarantee that frames are aligned to records.
+ * \param[in] fileName OPL log to decode
+ * \return Success (true), Failure (false)
+ */
+bool LogConverter::load(const QString &fileName)
+{
+    QFile file(fileName);
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        m_errorString = QString("Unable to open %1: %2").arg(fileName, file.errorString());
+        return false;
+    }
+
+    QByteArray copy;
+    const uchar *data = file.map(0, file.size());
+    if (!data) {
+        copy = file.readAll();
+        data = (const uchar *)copy.constData();
+    }
+
+    const qint64 size = file.size();
+    qint64 pos = 0;
+    m_stream.reserve(size);
+    while (pos + (qint64)(sizeof(quint32) + sizeof(qint64)) <= size) {
+        quint32 timestamp;
+        qint64 dataSize;
+
+        memcpy(&timestamp, &data[pos], sizeof(timestamp));
+        memcpy(&dataSize, &data[pos + sizeof(timestamp)], sizeof(dataSize));
+        pos += sizeof(timestamp) + sizeof(dataSize);
+
+        if (dataSize < 1 || dataSize > size - pos) {
+            qWarning() << "LogConverter - error : corrupted record at offset" << pos << ", remaining data ignored";
+            break;
+        }
+
+        Record record;
+        record.offset    = m_stream.size();
+        record.timestamp = timestamp;
+        m_records.append(record);
+        m_stream.append((const char *)&data[pos], dataSize);
+        pos += dataSize;
+    }
+
+    if (data != (const uchar *)copy.constData()) {
+        file.unmap((uchar *)data);
+    }
+    file.close();
+
+    scan();
+    return true;
+}
+
+/**
+ * Split the stream into frames and file every object update under its object.
+ * Frames are checked the same way UAVTalk checks them, a frame that fails is
+ * skipped by searching for the next sync byte.
+ */
+void LogConverter::scan()
+{
+    const quint8 *data = (const quint8 *)m_stream.constData();
+    const int length   = m_stream.size();
+    int record = 0;
+    int pos    = 0;
+
+    while (pos + HEADER_LENGTH + CHECKSUM_LENGTH <= length) {
+        if (data[pos] != SYNC_VAL) {
+            const quint8 *sync = (const quint8 *)memchr(&data[pos], SYNC_VAL, length - pos);
+            if (!sync) {
+                break;
+            }
+            pos = sync - data;
+            continue;
+        }
+
+        const quint8 *frame = &data[pos];
+        quint8 type = frame[1];
+        int size    = qFromLittleEndian<quint16>(&frame[2]);
+        if ((type & TYPE_MASK) != TYPE_VER || size < HEADER_LENGTH || size > HEADER_LENGTH + MAX_PAYLOAD_LENGTH
+            || pos + size + CHECKSUM_LENGTH > length) {
+            ++m_numErrors;
+            ++pos;
+            continue;
+        }
+
+        quint32 objId  = qFromLittleEndian<quint32>(&frame[4]);
+        quint16 instId = qFromLittleEndian<quint16>(&frame[8]);
+        ObjectStream *obj = m_objects.value(objId);
+
+        // Determine data length, same rules as the UAVTalk state machine
+        int dataLength;
+        if (type == TYPE_OBJ_REQ || type == TYPE_ACK || type == TYPE_NACK) {
+            dataLength = 0;
+        } else if (type == TYPE_BUNDLE || !obj) {
+            // The length of unknown objects is only given by the frame size
+            dataLength = size - HEADER_LENGTH;
+        } else {
+            dataLength = obj->numBytes;
+        }
+        if (dataLength >= MAX_PAYLOAD_LENGTH || HEADER_LENGTH + dataLength != size
+            || Crc::updateCRC(0, frame, size) != frame[size]) {
+            ++m_numErrors;
+            ++pos;
+            continue;
+        }
+
+        // The frame belongs to the record it starts in
+        while (record + 1 < m_records.size() && m_records[record + 1].offset <= pos) {
+            ++record;
+        }
+        quint32 timestamp = m_records[record].timestamp;
+
+        if (type == TYPE_OBJ || type == TYPE_OBJ_ACK) {
+            if (obj) {
+                Sample sample = { timestamp, instId, pos + HEADER_LENGTH };
+                obj->samples.append(sample);
+                ++m_numSamples;
+            } else {
+                ++m_numUnknown;
+            }
+        } else if (type == TYPE_BUNDLE) {
+            // The instance ID holds the number of objects in the bundle
+            int offset = pos + HEADER_LENGTH;
+            int end    = offset + dataLength;
+            for (quint16 n = 0; n < instId; ++n) {
+                if (offset + BUNDLE_ENTRY_HEADER_LENGTH > end) {
+                    ++m_numErrors;
+                    break;
+                }
+                ObjectStream *entry = m_objects.value(qFromLittleEndian<quint32>(&data[offset]));
+                quint16 entryInstId = qFromLittleEndian<quint16>(&data[offset + 4]);
+                offset += BUNDLE_ENTRY_HEADER_LENGTH;
+
+                // The length of an unknown object is unknown, the rest of the bundle can not be parsed
+                if (!entry || offset + (int)entry->numBytes > end) {
+                    ++m_numUnknown;
+                    break;
+                }
+                Sample sample = { timestamp, entryInstId, offset };
+                entry->samples.append(sample);
+                ++m_numSamples;
+                offset += entry->numBytes;
+            }
+        }
+
+        pos += size + CHECKSUM_LENGTH;
+    }
+}
+
+/**
+ * Write the columns of every object found in the log, one object per task.
+ * \param[in] outputDir Directory that receives the files, created if needed
+ * \param[in] format CSV or binary columns
+ * \param[in] threads Maximum number of objects written concurrently
+ * \return Success (true), Failure (false)
+ */
+bool LogConverter::write(const QString &outputDir, Format format, int threads)
+{
+    if (!QDir().mkpath(outputDir)) {
+        m_errorString = QString("Unable to create %1").arg(outputDir);
+        return false;
+    }
+
+    // Start the largest objects first so that they do not end up last on a single thread
+    QList<const ObjectStream *> objects;
+    foreach(const ObjectStream * obj, m_objects) {
+        if (!obj->samples.isEmpty()) {
+            objects.append(obj);
+        }
+    }
+    std::sort(objects.begin(), objects.end(), moreSamples);
+
+    QThreadPool::globalInstance()->setMaxThreadCount(qMax(threads, 1));
+    QList<QFuture<bool> > futures;
+    foreach(const ObjectStream * obj, objects) {
+        futures.append(QtConcurrent::run(this, &LogConverter::writeObject, obj, outputDir, format));
+    }
+
+    bool success = true;
+    for (int i = 0; i < futures.size(); ++i) {
+        if (!futures[i].result()) {
+            m_errorString = QString("Unable to write %1").arg(objects[i]->name);
+            success = false;
+        }
+    }
+    return success;
+}
+
+bool LogConverter::writeObject(const ObjectStream *obj, const QString &outputDir, Format format) const
+{
+    return format == CSV ? writeCsv(obj, outputDir) : writeBinary(obj, outputDir);
+}
+
+/**
+ * One <object>.csv file, one row per sample and one column per element.
+ * Enums are written as their index, the options are listed in the binary manifest.
+ */
+bool LogConverter::writeCsv(const ObjectStream *obj, const QString &outputDir) const
+{
+    QFile file(QDir(outputDir).filePath(obj->name + ".csv"));
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+
+    QByteArray line("timestamp,instance");
+    foreach(const Column &column, obj->columns) {
+        if (column.type == UAVObjectField::STRING || column.elements == 1) {
+            line.append(',').append(column.name.toUtf8());
+        } else {
+            foreach(const QString &element, column.elementNames) {
+                line.append(',').append(column.name.toUtf8()).append('.').append(element.toUtf8());
+            }
+        }
+    }
+    line.append('\n');
+
+    const quint8 *stream = (const quint8 *)m_stream.constData();
+    QByteArray buffer;
+    buffer.reserve(WRITE_CHUNK + 4096);
+    buffer.append(line);
+    foreach(const Sample &sample, obj->samples) {
+        const quint8 *data = &stream[sample.offset];
+
+        buffer.append(QByteArray::number(sample.timestamp)).append(',').append(QByteArray::number(sample.instId));
+        foreach(const Column &column, obj->columns) {
+            if (column.type == UAVObjectField::STRING) {
+                const char *text = (const char *)&data[column.offset];
+                buffer.append(",\"").append(text, qstrnlen(text, column.elements)).append('"');
+                continue;
+            }
+            for (quint32 n = 0; n < column.elements; ++n) {
+                buffer.append(',');
+                appendValue(buffer, column, n, data);
+            }
+        }
+        buffer.append('\n');
+
+        if (buffer.size() >= WRITE_CHUNK) {
+            if (file.write(buffer) != buffer.size()) {
+                return false;
+            }
+            buffer.resize(0);
+        }
+    }
+    return file.write(buffer) == buffer.size();
+}
+
+/**
+ * One <object> directory holding timestamp.u4, instance.u2 and one file per field.
+ * Field files hold all elements of a sample next to each other exactly as they
+ * are sent, so numpy.fromfile(name, dtype).reshape(-1, elements) reads them back.
+ * columns.csv lists the type, elements, units and options of every file.
+ */
+bool LogConverter::writeBinary(const ObjectStream *obj, const QString &outputDir) const
+{
+    QDir dir(outputDir);
+
+    if (!dir.mkpath(obj->name) || !dir.cd(obj->name)) {
+        return false;
+    }
+
+    const quint8 *stream = (const quint8 *)m_stream.constData();
+    QByteArray column;
+    QFile file;
+
+    column.reserve(obj->samples.size() * sizeof(quint32));
+    foreach(const Sample &sample, obj->samples) {
+        quint32 timestamp = qToLittleEndian(sample.timestamp);
+        column.append((const char *)&timestamp, sizeof(timestamp));
+    }
+    file.setFileName(dir.filePath("timestamp.u4"));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(column) != column.size()) {
+        return false;
+    }
+    file.close();
+
+    column.resize(0);
+    foreach(const Sample &sample, obj->samples) {
+        quint16 instId = qToLittleEndian(sample.instId);
+        column.append((const char *)&instId, sizeof(instId));
+    }
+    file.setFileName(dir.filePath("instance.u2"));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(column) != column.size()) {
+        return false;
+    }
+    file.close();
+
+    QByteArray manifest("file,type,elements,units,names,options\n");
+    manifest.append("timestamp.u4,u4,1,ms,,\n");
+    manifest.append("instance.u2,u2,1,,,\n");
+    foreach(const Column &field, obj->columns) {
+        QString fileName = field.name + "." + dtype(field.type);
+        int bytes = field.elements * field.elementSize;
+
+        column.resize(0);
+        column.reserve(obj->samples.size() * bytes);
+        foreach(const Sample &sample, obj->samples) {
+            column.append((const char *)&stream[sample.offset + field.offset], bytes);
+        }
+        file.setFileName(dir.filePath(fileName));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(column) != column.size()) {
+            return false;
+        }
+        file.close();
+
+        QStringList entry;
+        entry << fileName << dtype(field.type) << QString::number(field.elements) << field.units
+              << field.elementNames.join(";") << field.options.join(";");
+        manifest.append(entry.join(",").toUtf8()).append('\n');
+    }
+
+    file.setFileName(dir.filePath("columns.csv"));
+    return file.open(QIODevice::WriteOnly | QIODevice::Truncate) && file.write(manifest) == manifest.size();
+}
+
+void LogConverter::appendValue(QByteArray &line, const Column &column, quint32 element, const quint8 *data) const
+{
+    const quint8 *value = &data[column.offset + element * column.elementSize];
+
+    switch (column.type) {
+    case UAVObjectField::INT8:
+        line.append(QByteArray::number((qint8)value[0]));
+        break;
+    case UAVObjectField::INT16:
+        line.append(QByteArray::number(qFromLittleEndian<qint16>(value)));
+        break;
+    case UAVObjectField::INT32:
+        line.append(QByteArray::number(qFromLittleEndian<qint32>(value)));
+        break;
+    case UAVObjectField::UINT16:
+        line.append(QByteArray::number(qFromLittleEndian<quint16>(value)));
+        break;
+    case UAVObjectField::UINT32:
+        line.append(QByteArray::number(qFromLittleEndian<quint32>(value)));
+        break;
+    case UAVObjectField::FLOAT32:
+    {
+        quint32 bits = qFromLittleEndian<quint32>(value);
+        float number;
+        memcpy(&number, &bits, sizeof(number));
+        line.append(QByteArray::number(number, 'g', 9));
+        break;
+    }
+    default:
+        // UINT8, ENUM and BITFIELD
+        line.append(QByteArray::number(value[0]));
+        break;
+    }
+}
+
+/**
+ * numpy type codes, also used as file extension
+ */
+const char *LogConverter::dtype(int type)
+{
+    switch (type) {
+    case UAVObjectField::INT8:
+        return "i1";
+
+    case UAVObjectField::INT16:
+        return "i2";
+
+    case UAVObjectField::INT32:
+        return "i4";
+
+    case UAVObjectField::UINT16:
+        return "u2";
+
+    case UAVObjectField::UINT32:
+        return "u4";
+
+    case UAVObjectField::FLOAT32:
+        return "f4";
+
+    default:
+        // UINT8, ENUM, BITFIELD and STRING
+        return "u1";
+    }
+}
+
+bool LogConverter::moreSamples(const ObjectStream *a, const ObjectStream *b)
+{
+    return a->samples.size() > b->samples.size();
+}
+
+/**
+ * @}
+ * @}
+ */
@@ -0,0 +1,153 @@
+/**
+ ******************************************************************************
+ *
+ * @file       logconverter.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @addtogroup GCSTools
+ * @{
+ * @addtogroup OPLogConvert
+ * @{
+ * @brief Batch conversion of OPL log files to per object columns
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef LOGCONVERTER_H
+#define LOGCONVERTER_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+class UAVObjectManager;
+
+/**
+ * Decodes a complete OPL log in one go and writes the samples of every object
+ * as columns, either one CSV file per object or one raw little endian file per
+ * field. The UAVTalk frames are parsed here rather than through the UAVTalk
+ * plugin, which needs a running GCS, but with the same validation rules.
+ */
+class LogConverter {
+public:
+    enum Format { CSV, Binary };
+
+    LogConverter(UAVObjectManager *objMngr);
+    ~LogConverter();
+
+    bool load(const QString &fileName);
+    bool write(const QString &outputDir, Format format, int threads);
+
+    QString errorString() const
+    {
+        return m_errorString;
+    }
+    qint64 numBytes() const
+    {
+        return m_stream.size();
+    }
+    int numRecords() const
+    {
+        return m_records.size();
+    }
+    int numObjects() const;
+    quint64 numSamples() const
+    {
+        return m_numSamples;
+    }
+    quint64 numErrors() const
+    {
+        return m_numErrors;
+    }
+    quint64 numUnknown() const
+    {
+        return m_numUnknown;
+    }
+
+private:
+    static const quint8 SYNC_VAL     = 0x3C;
+    static const int TYPE_MASK       = 0xF8;
+    static const int TYPE_VER        = 0x20;
+    static const int TYPE_OBJ        = (TYPE_VER | 0x00);
+    static const int TYPE_OBJ_REQ    = (TYPE_VER | 0x01);
+    static const int TYPE_OBJ_ACK    = (TYPE_VER | 0x02);
+    static const int TYPE_ACK        = (TYPE_VER | 0x03);
+    static const int TYPE_NACK       = (TYPE_VER | 0x04);
+    static const int TYPE_BUNDLE     = (TYPE_VER | 0x05);
+    static const int HEADER_LENGTH   = 10;
+    static const int BUNDLE_ENTRY_HEADER_LENGTH = 6;
+    static const int MAX_PAYLOAD_LENGTH = 256;
+    static const int CHECKSUM_LENGTH = 1;
+    static const int WRITE_CHUNK     = 1024 * 1024;
+
+    // Layout of one field, copied out of the UAVObjects so the writer threads
+    // never touch them
+    struct Column {
+        QString     name;
+        QString     units;
+        int         type;
+        quint32     offset;
+        quint32     elements;
+        quint32     elementSize;
+        QStringList elementNames;
+        QStringList options;
+    };
+
+    struct Sample {
+        quint32 timestamp;
+        quint16 instId;
+        int     offset; // of the payload in m_stream
+    };
+
+    struct ObjectStream {
+        QString         name;
+        quint32         objId;
+        quint32         numBytes;
+        QVector<Column> columns;
+        QVector<Sample> samples;
+    };
+
+    struct Record {
+        int     offset; // in m_stream
+        quint32 timestamp;
+    };
+
+    void scan();
+    bool writeObject(const ObjectStream *obj, const QString &outputDir, Format format) const;
+    bool writeCsv(const ObjectStream *obj, const QString &outputDir) const;
+    bool writeBinary(const ObjectStream *obj, const QString &outputDir) const;
+    void appendValue(QByteArray &line, const Column &column, quint32 element, const quint8 *data) const;
+
+    static const char *dtype(int type);
+    static bool moreSamples(const ObjectStream *a, const ObjectStream *b);
+
+    QHash<quint32, ObjectStream *> m_objects;
+    QByteArray m_stream;
+    QVector<Record> m_records;
+    quint64 m_numSamples;
+    quint64 m_numErrors;
+    quint64 m_numUnknown;
+    QString m_errorString;
+};
+
+#endif // LOGCONVERTER_H
+
+/**
+ * @}
+ * @}
+ */
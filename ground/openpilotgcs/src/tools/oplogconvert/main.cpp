@@ -0,0 +1,128 @@
+/**
+ ******************************************************************************
+ *
+ * @file       main.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @addtogroup GCSTools
+ * @{
+ * @addtogroup OPLogConvert
+ * @{
+ * @brief Command line conversion of OPL log files for numpy and matlab
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "logconverter.h"
+
+#include "uavobjectmanager.h"
+#include "uavobjectsinit.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QThread>
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCoreApplication::setApplicationName("oplogconvert");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Converts an OpenPilot log file (.opl) to one CSV file "
+                                     "or one directory of binary columns per UAVObject.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("log", "Log file to convert.");
+    QCommandLineOption outputOption(QStringList() << "o" << "output",
+                                    "Output directory, defaults to the log file name without extension.", "dir");
+    QCommandLineOption formatOption(QStringList() << "f" << "format",
+                                    "Output format, csv (default) or binary.", "format", "csv");
+    QCommandLineOption threadsOption(QStringList() << "j" << "threads",
+                                     "Number of objects written concurrently, defaults to the number of cores.", "n",
+                                     QString::number(QThread::idealThreadCount()));
+    parser.addOption(outputOption);
+    parser.addOption(formatOption);
+    parser.addOption(threadsOption);
+    parser.process(app);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    if (parser.positionalArguments().size() != 1) {
+        parser.showHelp(1);
+    }
+    QString logFile = parser.positionalArguments().first();
+
+    LogConverter::Format format;
+    if (parser.value(formatOption) == "csv") {
+        format = LogConverter::CSV;
+    } else if (parser.value(formatOption) == "binary") {
+        format = LogConverter::Binary;
+    } else {
+        err << "Unknown format " << parser.value(formatOption) << endl;
+        return 1;
+    }
+
+    bool ok;
+    int threads = parser.value(threadsOption).toInt(&ok);
+    if (!ok || threads < 1) {
+        err << "Invalid number of threads " << parser.value(threadsOption) << endl;
+        return 1;
+    }
+
+    QString outputDir = parser.value(outputOption);
+    if (outputDir.isEmpty()) {
+        QFileInfo info(logFile);
+        outputDir = info.dir().filePath(info.completeBaseName());
+    }
+
+    UAVObjectManager objMngr;
+    UAVObjectsInitialize(&objMngr);
+    LogConverter converter(&objMngr);
+
+    QElapsedTimer timer;
+    timer.start();
+    if (!converter.load(logFile)) {
+        err << converter.errorString() << endl;
+        return 1;
+    }
+    qint64 decoded = timer.elapsed();
+
+    if (!converter.write(outputDir, format, threads)) {
+        err << converter.errorString() << endl;
+        return 1;
+    }
+    qint64 written = timer.elapsed();
+
+    out << "Decoded " << converter.numRecords() << " records, " << converter.numBytes() << " bytes in "
+        << decoded << " ms" << endl;
+    out << "Wrote " << converter.numSamples() << " samples of " << converter.numObjects() << " objects to "
+        << outputDir << " in " << written - decoded << " ms" << endl;
+    if (converter.numErrors() || converter.numUnknown()) {
+        out << "Skipped " << converter.numErrors() << " bad frames and " << converter.numUnknown()
+            << " updates of unknown objects" << endl;
+    }
+
+    return 0;
+}
+
+/**
+ * @}
+ * @}
+ */
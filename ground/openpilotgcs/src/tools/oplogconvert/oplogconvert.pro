@@ -0,0 +1,31 @@
+include(../../../openpilotgcs.pri)
+
+TEMPLATE = app
+TARGET = oplogconvert
+DESTDIR = $$GCS_APP_PATH
+
+QT -= gui
+QT += concurrent
+CONFIG += console
+CONFIG -= app_bundle
+
+# Only the UAVObjects library is used, the application never loads the plugins
+include(../../plugins/uavobjects/uavobjects.pri)
+LIBS *= -L$$GCS_PLUGIN_PATH/OpenPilot
+
+HEADERS += logconverter.h
+
+SOURCES += main.cpp \
+    logconverter.cpp
+
+!macx {
+    target.path = /bin
+    INSTALLS   += target
+}
+
+linux-* {
+    QMAKE_RPATHDIR = \'\$$ORIGIN\'/$$relative_path($$GCS_LIBRARY_PATH, $$GCS_APP_PATH)
+    QMAKE_RPATHDIR += \'\$$ORIGIN\'/$$relative_path($$GCS_PLUGIN_PATH/OpenPilot, $$GCS_APP_PATH)
+    QMAKE_RPATHDIR += \'\$$ORIGIN\'/$$relative_path($$GCS_QT_LIBRARY_PATH, $$GCS_APP_PATH)
+    include(../../rpath.pri)
+}
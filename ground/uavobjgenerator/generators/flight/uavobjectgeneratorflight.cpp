@@ -33,8 +33,8 @@ bool UAVObjectGeneratorFlight::generate(UAVObjectParser *parser, QString templat
     fieldTypeStrC << "int8_t" << "int16_t" << "int32_t" << "uint8_t"
                   << "uint16_t" << "uint32_t" << "float" << "uint8_t";
 
-    QString flightObjInit, objInc, objFileNames, objNames;
-    qint32 sizeCalc;
+    QString flightObjInit, objInc, objFileNames, objNames, hotNames;
+    qint32 sizeCalc, hotSize;
     flightCodePath            = QDir(templatepath + QString(FLIGHT_CODE_DIR));
     flightOutputPath          = QDir(outputpath + QString("flight"));
     flightOutputPath.mkpath(flightOutputPath.absolutePath());
@@ -51,6 +51,7 @@ bool UAVObjectGeneratorFlight::generate(UAVObjectParser *parser, QString templat
     }
 
     sizeCalc = 0;
+    hotSize  = 0;
     for (int objidx = 0; objidx < parser->getNumObjects(); ++objidx) {
         ObjectInfo *info = parser->getObjectByIndex(objidx);
         process_object(info);
@@ -63,8 +64,16 @@ bool UAVObjectGeneratorFlight::generate(UAVObjectParser *parser, QString templat
         if (parser->getNumBytes(objidx) > sizeCalc) {
             sizeCalc = parser->getNumBytes(objidx);
         }
+        if (info->isHot) {
+            hotNames.append(" " + info->name);
+            hotSize += parser->getNumBytes(objidx);
+        }
     }
 
+    // Report the fast RAM taken by the hot objects, should a target link all of them
+    cout << "Hot objects (fast RAM): " << hotSize << " bytes of instance data for"
+         << hotNames.toStdString() << endl;
+
     // Write the flight object inialization files
     flightInitTemplate.replace(QString("$(OBJINC)"), objInc);
     flightInitTemplate.replace(QString("$(OBJINIT)"), flightObjInit);
@@ -151,6 +160,20 @@ bool UAVObjectGeneratorFlight::process_object(ObjectInfo *info)
     }
     outInclude.replace(QString("$(DATAFIELDS)"), fields);
     outInclude.replace(QString("$(DATASTRUCTURES)"), dataStructures);
+
+    // Replace the $(NUMWORDS) and $(NUMHALFWORDS) tags, fields are sorted by size
+    // so this is enough to describe the field layout to the log compression
+    int numWords     = 0;
+    int numHalfWords = 0;
+    for (int n = 0; n < info->fields.length(); ++n) {
+        if (info->fields[n]->numBytes == 4) {
+            numWords += info->fields[n]->numElements;
+        } else if (info->fields[n]->numBytes == 2) {
+            numHalfWords += info->fields[n]->numElements;
+        }
+    }
+    outInclude.replace(QString("$(NUMWORDS)"), QString().setNum(numWords));
+    outInclude.replace(QString("$(NUMHALFWORDS)"), QString().setNum(numHalfWords));
     // Replace the $(DATAFIELDINFO) tag
     QString enums;
     for (int n = 0; n < info->fields.length(); ++n) {
@@ -253,145 +276,95 @@ bool UAVObjectGeneratorFlight::process_object(ObjectInfo *info)
     }
     outCode.replace(QString("$(INITFIELDS)"), initfields);
 
-    // Replace the $(SETGETFIELDS) tag
-    QString setgetfields;
+    // Replace the $(COMPACTPROFILE) and $(COMPACTPROFILEREGISTER) tags, only the objects
+    // with quantized fields have a compact representation. Consecutive raw fields are merged.
+    QString compactFields;
+    QString compactProfile;
+    QString compactRegister;
+    int numCompactFields = 0;
+    int compactNumBytes  = 0;
+    bool hasCompact = false;
     for (int n = 0; n < info->fields.length(); ++n) {
-        // if (!info->fields[n]->defaultValues.isEmpty() )
-        {
-            // For non-array fields
-            if (info->fields[n]->numElements == 1) {
-                /* Set */
-                setgetfields.append(QString("void %2%3Set(%1 *New%3)\n")
-                                    .arg(fieldTypeStrC[info->fields[n]->type])
-                                    .arg(info->name)
-                                    .arg(info->fields[n]->name));
-                setgetfields.append(QString("{\n"));
-                setgetfields.append(QString("    UAVObjSetDataField(%1Handle(), (void *)New%2, offsetof(%1Data, %2), sizeof(%3));\n")
-                                    .arg(info->name)
-                                    .arg(info->fields[n]->name)
-                                    .arg(fieldTypeStrC[info->fields[n]->type]));
-                setgetfields.append(QString("}\n"));
-
-                /* GET */
-                setgetfields.append(QString("void %2%3Get(%1 *New%3)\n")
-                                    .arg(fieldTypeStrC[info->fields[n]->type])
-                                    .arg(info->name)
-                                    .arg(info->fields[n]->name));
-                setgetfields.append(QString("{\n"));
-                setgetfields.append(QString("    UAVObjGetDataField(%1Handle(), (void *)New%2, offsetof(%1Data, %2), sizeof(%3));\n")
-                                    .arg(info->name)
-                                    .arg(info->fields[n]->name)
-                                    .arg(fieldTypeStrC[info->fields[n]->type]));
-                setgetfields.append(QString("}\n"));
-            } else {
-                // When no struct accessor is available for a field array accessor is the default.
-                QString suffix = QString("");
-
-                if (info->fields[n]->elementNames[0].compare(QString("0")) != 0) {
-                    // struct based field accessor
-                    QString structTypeName = QString("%1%2Data").arg(info->name).arg(info->fields[n]->name);
-                    /* SET */
-                    setgetfields.append(QString("void %2%3Set( %1 *New%3 )\n")
-                                        .arg(structTypeName)
-                                        .arg(info->name)
-                                        .arg(info->fields[n]->name));
-                    setgetfields.append(QString("{\n"));
-                    setgetfields.append(QString("    UAVObjSetDataField(%1Handle(), (void *)New%2, offsetof(%1Data, %2), %3*sizeof(%4));\n")
-                                        .arg(info->name)
-                                        .arg(info->fields[n]->name)
-                                        .arg(info->fields[n]->numElements)
-                                        .arg(fieldTypeStrC[info->fields[n]->type]));
-                    setgetfields.append(QString("}\n"));
-
-                    /* GET */
-                    setgetfields.append(QString("void %2%3Get( %1 *New%3 )\n")
-                                        .arg(structTypeName)
-                                        .arg(info->name)
-                                        .arg(info->fields[n]->name));
-                    setgetfields.append(QString("{\n"));
-                    setgetfields.append(QString("    UAVObjGetDataField(%1Handle(), (void *)New%2, offsetof(%1Data, %2), %3*sizeof(%4));\n")
-                                        .arg(info->name)
-                                        .arg(info->fields[n]->name)
-                                        .arg(info->fields[n]->numElements)
-                                        .arg(fieldTypeStrC[info->fields[n]->type]));
-                    setgetfields.append(QString("}\n"));
-
-                    // Append array suffix to array accessors
-                    suffix = QString("Array");
-                }
-
-                // array based field accessor
-                /* SET */
-                setgetfields.append(QString("void %2%3%4Set( %1 *New%3 )\n")
-                                    .arg(fieldTypeStrC[info->fields[n]->type])
-                                    .arg(info->name)
-                                    .arg(info->fields[n]->name)
-                                    .arg(suffix));
-                setgetfields.append(QString("{\n"));
-                setgetfields.append(QString("    UAVObjSetDataField(%1Handle(), (void *)New%2, offsetof(%1Data, %2), %3*sizeof(%4));\n")
-                                    .arg(info->name)
-                                    .arg(info->fields[n]->name)
-                                    .arg(info->fields[n]->numElements)
-                                    .arg(fieldTypeStrC[info->fields[n]->type]));
-                setgetfields.append(QString("}\n"));
-
-                /* GET */
-                setgetfields.append(QString("void %2%3%4Get( %1 *New%3 )\n")
-                                    .arg(fieldTypeStrC[info->fields[n]->type])
-                                    .arg(info->name)
-                                    .arg(info->fields[n]->name)
-                                    .arg(suffix));
-                setgetfields.append(QString("{\n"));
-                setgetfields.append(QString("    UAVObjGetDataField(%1Handle(), (void *)New%2, offsetof(%1Data, %2), %3*sizeof(%4));\n")
-                                    .arg(info->name)
-                                    .arg(info->fields[n]->name)
-                                    .arg(info->fields[n]->numElements)
-                                    .arg(fieldTypeStrC[info->fields[n]->type]));
-                setgetfields.append(QString("}\n"));
+        FieldInfo *field = info->fields[n];
+        if (field->compactType >= 0) {
+            hasCompact = true;
+            compactFields.append(QString("    { offsetof(%1Data, %2), %3, %4, %5f },\n")
+                                 .arg(info->name)
+                                 .arg(field->name)
+                                 .arg(field->numElements)
+                                 .arg(field->compactType == FIELDTYPE_INT8 ? "UAVOBJ_COMPACT_INT8" : "UAVOBJ_COMPACT_INT16")
+                                 .arg(field->compactScale, 0, 'e', 6));
+            compactNumBytes += field->numElements * (field->compactType == FIELDTYPE_INT8 ? 1 : 2);
+            ++numCompactFields;
+        } else {
+            int size = field->numElements * field->numBytes;
+            while (n + 1 < info->fields.length() && info->fields[n + 1]->compactType < 0) {
+                ++n;
+                size += info->fields[n]->numElements * info->fields[n]->numBytes;
             }
+            compactFields.append(QString("    { offsetof(%1Data, %2), %3, UAVOBJ_COMPACT_RAW, 0.0f },\n")
+                                 .arg(info->name)
+                                 .arg(field->name)
+                                 .arg(size));
+            compactNumBytes += size;
+            ++numCompactFields;
         }
     }
-    outCode.replace(QString("$(SETGETFIELDS)"), setgetfields);
-
-    // Replace the $(SETGETFIELDSEXTERN) tag
-    QString setgetfieldsextern;
+    if (hasCompact) {
+        compactProfile.append(QString("\n// Compact representation sent over the slow links\n"));
+        compactProfile.append(QString("static const UAVObjCompactField compactFields[] = {\n%1};\n").arg(compactFields));
+        compactProfile.append(QString("static UAVObjCompactProfile compactProfile = { NULL, compactFields, %1, %2, NULL };\n")
+                              .arg(numCompactFields)
+                              .arg(compactNumBytes));
+        compactRegister.append(QString("    if (handle) {\n        UAVObjSetCompactProfile(handle, &compactProfile);\n    }\n"));
+    }
+    outCode.replace(QString("$(COMPACTPROFILE)"), compactProfile);
+    outCode.replace(QString("$(COMPACTPROFILEREGISTER)"), compactRegister);
+
+    // Replace the $(SETGETFIELDS) tag, the field accessors are generated inline
+    // with compile time offsets. Single instance data objects are read through
+    // the lock free path of the object manager.
+    QString getFieldFunction = (info->isSingleInst && !info->isSettings) ?
+                               QString("UAVObjGetDataFieldLockFree") : QString("UAVObjGetDataField");
+    QString setgetfields;
     for (int n = 0; n < info->fields.length(); ++n) {
-        // if (!info->fields[n]->defaultValues.isEmpty() )
-        {
-            QString suffix = QString("");
-            if (info->fields[n]->elementNames[0].compare(QString("0")) != 0) {
-                // struct based field accessor
-                QString structTypeName = QString("%1%2Data").arg(info->name).arg(info->fields[n]->name);
+        QString fieldSize = (info->fields[n]->numElements == 1) ?
+                            QString("sizeof(%1)").arg(fieldTypeStrC[info->fields[n]->type]) :
+                            QString("%1 * sizeof(%2)").arg(info->fields[n]->numElements).arg(fieldTypeStrC[info->fields[n]->type]);
+        QStringList accessorTypes;
+        QStringList accessorSuffixes;
+
+        if (info->fields[n]->numElements > 1 && info->fields[n]->elementNames[0].compare(QString("0")) != 0) {
+            // struct based field accessor, the array accessor gets a suffix
+            accessorTypes << QString("%1%2Data").arg(info->name).arg(info->fields[n]->name);
+            accessorSuffixes << QString("");
+            accessorTypes << fieldTypeStrC[info->fields[n]->type];
+            accessorSuffixes << QString("Array");
+        } else {
+            accessorTypes << fieldTypeStrC[info->fields[n]->type];
+            accessorSuffixes << QString("");
+        }
 
-                /* SET */
-                setgetfieldsextern.append(QString("extern void %2%3Set(%1 *New%3);\n")
-                                          .arg(structTypeName)
-                                          .arg(info->name)
-                                          .arg(info->fields[n]->name));
-
-                /* GET */
-                setgetfieldsextern.append(QString("extern void %2%3Get(%1 *New%3);\n")
-                                          .arg(structTypeName)
-                                          .arg(info->name)
-                                          .arg(info->fields[n]->name));
-                suffix = QString("Array");
-            }
+        for (int m = 0; m < accessorTypes.length(); ++m) {
             /* SET */
-            setgetfieldsextern.append(QString("extern void %2%3%4Set(%1 *New%3);\n")
-                                      .arg(fieldTypeStrC[info->fields[n]->type])
-                                      .arg(info->name)
-                                      .arg(info->fields[n]->name)
-                                      .arg(suffix));
+            setgetfields.append(QString("static inline void %2%3%4Set(%1 *New%3) { UAVObjSetDataField(%2Handle(), (void *)New%3, offsetof(%2Data, %3), %5); }\n")
+                                .arg(accessorTypes[m])
+                                .arg(info->name)
+                                .arg(info->fields[n]->name)
+                                .arg(accessorSuffixes[m])
+                                .arg(fieldSize));
 
             /* GET */
-            setgetfieldsextern.append(QString("extern void %2%3%4Get(%1 *New%3);\n")
-                                      .arg(fieldTypeStrC[info->fields[n]->type])
-                                      .arg(info->name)
-                                      .arg(info->fields[n]->name)
-                                      .arg(suffix));
+            setgetfields.append(QString("static inline void %2%3%4Get(%1 *New%3) { %6(%2Handle(), (void *)New%3, offsetof(%2Data, %3), %5); }\n")
+                                .arg(accessorTypes[m])
+                                .arg(info->name)
+                                .arg(info->fields[n]->name)
+                                .arg(accessorSuffixes[m])
+                                .arg(fieldSize)
+                                .arg(getFieldFunction));
         }
     }
-    outInclude.replace(QString("$(SETGETFIELDSEXTERN)"), setgetfieldsextern);
+    outInclude.replace(QString("$(SETGETFIELDS)"), setgetfields);
 
     // Write the flight code
     bool res = writeFileIfDiffrent(flightOutputPath.absolutePath() + "/" + info->namelc + ".c", outCode);
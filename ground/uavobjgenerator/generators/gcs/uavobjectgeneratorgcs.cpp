@@ -55,13 +55,14 @@ bool UAVObjectGeneratorGCS::generate(UAVObjectParser *parser, QString templatepa
         ObjectInfo *info = parser->getObjectByIndex(objidx);
         process_object(info);
 
-        gcsObjInit.append("    objMngr->registerObject( new " + info->name + "() );\n");
+        gcsObjInit.append("    objects << new " + info->name + "();\n");
         objInc.append("#include \"" + info->namelc + ".h\"\n");
     }
 
     // Write the gcs object inialization files
     gcsInitTemplate.replace(QString("$(OBJINC)"), objInc);
     gcsInitTemplate.replace(QString("$(OBJINIT)"), gcsObjInit);
+    gcsInitTemplate.replace(QString("$(NUMOBJECTS)"), QString::number(parser->getNumObjects()));
     bool res = writeFileIfDiffrent(gcsOutputPath.absolutePath() + "/uavobjectsinit.cpp", gcsInitTemplate);
     if (!res) {
         cout << "Error: Could not write output files" << endl;
@@ -277,6 +278,12 @@ bool UAVObjectGeneratorGCS::process_object(ObjectInfo *info)
                          .arg(varElemName)
                          .arg(info->fields[n]->limitValues));
         }
+        // Quantized in the compact updates
+        if (info->fields[n]->compactType >= 0) {
+            finit.append(QString("    fields.last()->setCompact(UAVObjectField::%1, %2);\n")
+                         .arg(fieldTypeStrCPPClass[info->fields[n]->compactType])
+                         .arg(info->fields[n]->compactScale, 0, 'e', 6));
+        }
     }
     outCode.replace(QString("$(FIELDSINIT)"), finit);
 
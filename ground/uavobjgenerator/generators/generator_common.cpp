@@ -75,6 +75,9 @@ void replaceCommonTags(QString & out, ObjectInfo *info)
     // Replace $(ISPRIORITY) tag
     out.replace(QString("$(ISPRIORITY)"), boolTo01String(info->isPriority));
     out.replace(QString("$(ISPRIORITYTF)"), boolToTRUEFALSEString(info->isPriority));
+    // Replace $(ISHOT) tag
+    out.replace(QString("$(ISHOT)"), boolTo01String(info->isHot));
+    out.replace(QString("$(ISHOTTF)"), boolToTRUEFALSEString(info->isHot));
     // Replace $(GCSACCESS) tag
     value = accessModeStr[info->gcsAccess];
     out.replace(QString("$(GCSACCESS)"), value);
@@ -89,6 +92,8 @@ void replaceCommonTags(QString & out, ObjectInfo *info)
     out.replace(QString("$(FLIGHTTELEM_UPDATEMODE)"), value);
     // Replace $(FLIGHTTELEM_UPDATEPERIOD) tag
     out.replace(QString("$(FLIGHTTELEM_UPDATEPERIOD)"), QString().setNum(info->flightTelemetryUpdatePeriod));
+    // Replace $(FLIGHTTELEM_SKIPUNCHANGED) tag
+    out.replace(QString("$(FLIGHTTELEM_SKIPUNCHANGED)"), boolTo01String(info->flightTelemetrySkipUnchanged));
     // Replace $(GCSTELEM_ACKED) tag
     out.replace(QString("$(GCSTELEM_ACKED)"), boolTo01String(info->gcsTelemetryAcked));
     out.replace(QString("$(GCSTELEM_ACKEDTF)"), boolToTRUEFALSEString(info->gcsTelemetryAcked));
@@ -53,13 +53,12 @@ bool UAVObjectGeneratorMatlab::generate(UAVObjectParser *parser, QString templat
     }
 
     matlabCodeTemplate.replace(QString("$(INSTANTIATIONCODE)"), matlabInstantiationCode);
-    matlabCodeTemplate.replace(QString("$(SWITCHCODE)"), matlabSwitchCode);
-    matlabCodeTemplate.replace(QString("$(CLEANUPCODE)"), matlabCleanupCode);
+    matlabCodeTemplate.replace(QString("$(INDEXCODE)"), matlabIndexCode);
     matlabCodeTemplate.replace(QString("$(SAVEOBJECTSCODE)"), matlabSaveObjectsCode);
     matlabCodeTemplate.replace(QString("$(ALLOCATIONCODE)"), matlabAllocationCode);
     matlabCodeTemplate.replace(QString("$(EXPORTCSVCODE)"), matlabExportCsvCode);
 
-    bool res = writeFile(matlabOutputPath.absolutePath() + "/OPLogConvert.m", matlabCodeTemplate);
+    bool res = writeFileIfDiffrent(matlabOutputPath.absolutePath() + "/OPLogConvert.m", matlabCodeTemplate);
     if (!res) {
         cout << "Error: Could not write output files" << endl;
         return false;
@@ -81,7 +80,6 @@ bool UAVObjectGeneratorMatlab::process_object(ObjectInfo *info, int numBytes)
     QString objectName(info->name);
     // QString objectTableName(objectName + "Objects");
     QString objectTableName(objectName);
-    QString tableIdxName(objectName.toLower() + "Idx");
     QString objectID(QString().setNum(info->id));
     QString numBytesString = QString("%1").arg(numBytes);
 
@@ -92,8 +90,7 @@ bool UAVObjectGeneratorMatlab::process_object(ObjectInfo *info, int numBytes)
     QString type;
     QString instantiationFields;
 
-    matlabInstantiationCode.append("\n\t" + tableIdxName + " = 0;\n");
-    matlabInstantiationCode.append("\t" + objectTableName + "=struct('timestamp', 0");
+    matlabInstantiationCode.append("\n\t" + objectTableName + "=struct('timestamp', 0");
     if (!info->isSingleInst) {
         instantiationFields.append(",...\n\t\t 'instanceID', 0");
     }
@@ -115,22 +112,13 @@ bool UAVObjectGeneratorMatlab::process_object(ObjectInfo *info, int numBytes)
     matlabInstantiationCode.append("\t" + objectName + "FidIdx = [];\n");
 
 
-    // ==============================================================//
-    // Generate 'Switch:' code (will replace the $(SWITCHCODE) tag) //
-    // ==============================================================//
-    matlabSwitchCode.append("\t\tcase " + objectTableName.toUpper() + "_OBJID\n");
-    matlabSwitchCode.append("\t\t\t" + tableIdxName + " = " + tableIdxName + " + 1;\n");
-    matlabSwitchCode.append("\t\t\t" + objectTableName + "FidIdx(" + tableIdxName + ") = bufferIdx; %#ok<*AGROW>\n");
-    matlabSwitchCode.append("\t\t\tbufferIdx=bufferIdx + " + objectTableName.toUpper() + "_NUMBYTES+1; %+1 is for CRC\n");
-    matlabSwitchCode.append("\t\t\tif " + tableIdxName + " >= length(" + objectTableName + "FidIdx) %Check to see if pre-allocated memory is exhausted\n");
-    matlabSwitchCode.append("\t\t\t\t" + objectTableName + "FidIdx(" + tableIdxName + "*2) = 0;\n");
-    matlabSwitchCode.append("\t\t\tend\n");
-
-
     // ============================================================//
-    // Generate 'Cleanup:' code (will replace the $(CLEANUP) tag) //
+    // Generate 'Index:' code (will replace the $(INDEXCODE) tag) //
     // ============================================================//
-    matlabCleanupCode.append(objectTableName + "FidIdx =" + objectTableName + "FidIdx(1:" + tableIdxName + ");\n");
+    // All the messages of the object are selected at once from the message index
+    matlabIndexCode.append("objSel = objIDs == " + objectTableName.toUpper() + "_OBJID;\n");
+    matlabIndexCode.append(objectTableName + "FidIdx = dataIdx(objSel);\n");
+    matlabIndexCode.append("unknownObj(objSel) = false;\n");
 
     // =================================================================//
     // Generate functions code (will replace the $(ALLOCATIONCODE) tag) //
@@ -38,8 +38,7 @@ public:
 private:
     bool process_object(ObjectInfo *info, int numBytes);
     QString matlabInstantiationCode;
-    QString matlabSwitchCode;
-    QString matlabCleanupCode;
+    QString matlabIndexCode;
     QString matlabAllocationCode;
     QString matlabSaveObjectsCode;
     QString matlabExportCsvCode;
@@ -27,6 +27,12 @@
 #include "uavobjectgeneratorpython.h"
 using namespace std;
 
+#define HOST_CODE_DIR "ground/openpilotgcs/src/plugins/uavobjects"
+
+// struct module format characters and numpy dtypes (little endian) of the field types
+static const char *fieldTypeStrStruct[] = { "b", "h", "i", "B", "H", "I", "f", "B" };
+static const char *fieldTypeStrDtype[]  = { "i1", "<i2", "<i4", "u1", "<u2", "<u4", "<f4", "u1" };
+
 bool UAVObjectGeneratorPython::generate(UAVObjectParser *parser, QString templatepath, QString outputpath)
 {
     // Load template and setup output directory
@@ -39,10 +45,26 @@ bool UAVObjectGeneratorPython::generate(UAVObjectParser *parser, QString templat
         return false;
     }
 
+    // Host bindings for the analysis scripts, they decode the object data with precomputed struct formats
+    QDir hostCodePath  = QDir(templatepath + QString(HOST_CODE_DIR));
+    hostOutputPath     = QDir(outputpath + QString("python/host"));
+    hostOutputPath.mkpath(hostOutputPath.absolutePath());
+    hostCodeTemplate   = readFile(hostCodePath.absoluteFilePath("uavobject.py.template"));
+    QString hostBase   = readFile(hostCodePath.absoluteFilePath("uavobject.py"));
+    if (hostCodeTemplate.isEmpty() || hostBase.isEmpty()) {
+        std::cerr << "Problem reading python host templates" << endl;
+        return false;
+    }
+    if (!writeFileIfDiffrent(hostOutputPath.absolutePath() + "/uavobject.py", hostBase)) {
+        cout << "Error: Could not write Python output files" << endl;
+        return false;
+    }
+
     // Process each object
     for (int objidx = 0; objidx < parser->getNumObjects(); ++objidx) {
         ObjectInfo *info = parser->getObjectByIndex(objidx);
         process_object(info);
+        process_object_host(info);
     }
 
     return true; // if we come here everything should be fine
@@ -118,3 +140,68 @@ bool UAVObjectGeneratorPython::process_object(ObjectInfo *info)
 
     return true;
 }
+
+/**
+ * Generate the python host object files
+ */
+bool UAVObjectGeneratorPython::process_object_host(ObjectInfo *info)
+{
+    if (info == NULL) {
+        return false;
+    }
+
+    // Prepare output strings
+    QString outCode = hostCodeTemplate;
+
+    // Replace common tags
+    replaceCommonTags(outCode, info);
+
+    // Replace the $(DATAFIELDS), $(STRUCTFORMAT) and $(DTYPEFIELDS) tags
+    QString datafields("[\n");
+    QString structFormat;
+    QString dtypeFields("[\n");
+    for (int n = 0; n < info->fields.length(); ++n) {
+        FieldInfo *field = info->fields[n];
+
+        datafields.append(QString("    uavobject.UAVObjectField('%1', '%2', %3,\n")
+                          .arg(field->name).arg(fieldTypeStrStruct[field->type]).arg(field->numElements));
+        // Element names
+        datafields.append(QString("        ["));
+        if (field->numElements > 1 && !field->defaultElementNames) {
+            for (int m = 0; m < field->elementNames.length(); ++m) {
+                datafields.append(QString("%1'%2'").arg(m ? ", " : "").arg(field->elementNames[m]));
+            }
+        }
+        datafields.append(QString("],\n"));
+        // Enumeration options
+        datafields.append(QString("        {"));
+        if (field->type == FIELDTYPE_ENUM) {
+            for (int m = 0; m < field->options.length(); ++m) {
+                datafields.append(QString("%1%2: '%3'").arg(m ? ", " : "").arg(m).arg(field->options[m]));
+            }
+        }
+        datafields.append(QString("}),\n"));
+
+        if (field->numElements > 1) {
+            structFormat.append(QString("%1%2").arg(field->numElements).arg(fieldTypeStrStruct[field->type]));
+            dtypeFields.append(QString("    ('%1', '%2', (%3,)),\n").arg(field->name).arg(fieldTypeStrDtype[field->type]).arg(field->numElements));
+        } else {
+            structFormat.append(fieldTypeStrStruct[field->type]);
+            dtypeFields.append(QString("    ('%1', '%2'),\n").arg(field->name).arg(fieldTypeStrDtype[field->type]));
+        }
+    }
+    datafields.append("]");
+    dtypeFields.append("]");
+    outCode.replace(QString("$(DATAFIELDS)"), datafields);
+    outCode.replace(QString("$(STRUCTFORMAT)"), structFormat);
+    outCode.replace(QString("$(DTYPEFIELDS)"), dtypeFields);
+
+    // Write the Python code
+    bool res = writeFileIfDiffrent(hostOutputPath.absolutePath() + "/" + info->namelc + ".py", outCode);
+    if (!res) {
+        cout << "Error: Could not write Python output files" << endl;
+        return false;
+    }
+
+    return true;
+}
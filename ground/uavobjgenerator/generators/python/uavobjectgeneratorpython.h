@@ -35,10 +35,13 @@ public:
 
 private:
     bool process_object(ObjectInfo *info);
+    bool process_object_host(ObjectInfo *info);
 
     QString pythonCodeTemplate;
     QDir pythonCodePath;
     QDir pythonOutputPath;
+    QString hostCodeTemplate;
+    QDir hostOutputPath;
 };
 
 #endif
@@ -27,6 +27,8 @@
 #include <QFile>
 #include <QString>
 #include <QStringList>
+#include <QFuture>
+#include <QtConcurrent/QtConcurrentRun>
 #include <iostream>
 
 #include "generators/java/uavobjectgeneratorjava.h"
@@ -209,46 +211,54 @@ int main(int argc, char *argv[])
         return RETURN_OK;
     }
 
+    // The generators only read the parsed objects and each one writes its own
+    // output directory, so all requested languages are generated in parallel
+    UAVObjectGeneratorFlight flightgen;
+    UAVObjectGeneratorGCS gcsgen;
+    UAVObjectGeneratorJava javagen;
+    UAVObjectGeneratorPython pygen;
+    UAVObjectGeneratorMatlab matlabgen;
+    UAVObjectGeneratorWireshark wiresharkgen;
+    QList<QFuture<bool> > generators;
+
     // generate flight code if wanted
     if (do_flight | do_all) {
         cout << "generating flight code" << endl;
-        UAVObjectGeneratorFlight flightgen;
-        flightgen.generate(parser, templatepath, outputpath);
+        generators << QtConcurrent::run(&flightgen, &UAVObjectGeneratorFlight::generate, parser, templatepath, outputpath);
     }
 
     // generate gcs code if wanted
     if (do_gcs | do_all) {
         cout << "generating gcs code" << endl;
-        UAVObjectGeneratorGCS gcsgen;
-        gcsgen.generate(parser, templatepath, outputpath);
+        generators << QtConcurrent::run(&gcsgen, &UAVObjectGeneratorGCS::generate, parser, templatepath, outputpath);
     }
 
     // generate java code if wanted
     if (do_java | do_all) {
         cout << "generating java code" << endl;
-        UAVObjectGeneratorJava javagen;
-        javagen.generate(parser, templatepath, outputpath);
+        generators << QtConcurrent::run(&javagen, &UAVObjectGeneratorJava::generate, parser, templatepath, outputpath);
     }
 
     // generate python code if wanted
     if (do_python | do_all) {
         cout << "generating python code" << endl;
-        UAVObjectGeneratorPython pygen;
-        pygen.generate(parser, templatepath, outputpath);
+        generators << QtConcurrent::run(&pygen, &UAVObjectGeneratorPython::generate, parser, templatepath, outputpath);
     }
 
     // generate matlab code if wanted
     if (do_matlab | do_all) {
         cout << "generating matlab code" << endl;
-        UAVObjectGeneratorMatlab matlabgen;
-        matlabgen.generate(parser, templatepath, outputpath);
+        generators << QtConcurrent::run(&matlabgen, &UAVObjectGeneratorMatlab::generate, parser, templatepath, outputpath);
     }
 
     // generate wireshark plugin if wanted
     if (do_wireshark | do_all) {
         cout << "generating wireshark code" << endl;
-        UAVObjectGeneratorWireshark wiresharkgen;
-        wiresharkgen.generate(parser, templatepath, outputpath);
+        generators << QtConcurrent::run(&wiresharkgen, &UAVObjectGeneratorWireshark::generate, parser, templatepath, outputpath);
+    }
+
+    for (int n = 0; n < generators.length(); ++n) {
+        generators[n].waitForFinished();
     }
 
     return RETURN_OK;
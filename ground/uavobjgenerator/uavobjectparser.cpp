@@ -140,6 +140,7 @@ QString UAVObjectParser::parseXML(QString & xml, QString & filename)
         ObjectInfo *info = new ObjectInfo;
 
         info->filename = filename;
+        info->flightTelemetrySkipUnchanged = false;
         // Process object attributes
         QString status = processObjectAttributes(node, info);
         if (!status.isNull()) {
@@ -185,6 +186,11 @@ QString UAVObjectParser::parseXML(QString & xml, QString & filename)
                     return status;
                 }
 
+                status = processObjectSkipUnchanged(childNode, &info->flightTelemetrySkipUnchanged);
+                if (!status.isNull()) {
+                    return status;
+                }
+
                 telFlightFound = true;
             } else if (childNode.nodeName().compare(QString("logging")) == 0) {
                 QString status = processObjectMetadata(childNode, &info->loggingUpdateMode,
@@ -282,6 +288,11 @@ void UAVObjectParser::calculateID(ObjectInfo *info)
                 hash = updateHash(options[m], hash);
             }
         }
+        // The compact representation changes the wire format, objects without one keep their ID
+        if (info->fields[n]->compactType >= 0) {
+            hash = updateHash(info->fields[n]->compactType, hash);
+            hash = updateHash((quint32)qRound(info->fields[n]->compactScale * 1e6), hash);
+        }
     }
     // Done
     info->id = hash & 0xFFFFFFFE;
@@ -362,6 +373,25 @@ QString UAVObjectParser::processObjectMetadata(QDomNode & childNode, UpdateMode
     return QString();
 }
 
+/**
+ * Process the optional skipunchanged attribute of the flight telemetry metadata
+ */
+QString UAVObjectParser::processObjectSkipUnchanged(QDomNode & childNode, bool *skipUnchanged)
+{
+    QDomNode elemAttr = childNode.attributes().namedItem("skipunchanged");
+
+    *skipUnchanged = false;
+    if (!elemAttr.isNull()) {
+        if (elemAttr.nodeValue().compare(QString("true")) == 0) {
+            *skipUnchanged = true;
+        } else if (elemAttr.nodeValue().compare(QString("false")) != 0) {
+            return QString("Object:telemetryflight:skipunchanged attribute value is invalid (true|false)");
+        }
+    }
+    // Done
+    return QString();
+}
+
 /**
  * Process the object access tag of the XML
  */
@@ -585,6 +615,33 @@ QString UAVObjectParser::processObjectFields(QDomNode & childNode, ObjectInfo *i
     } else {
         field->limitValues = elemAttr.nodeValue();
     }
+
+    // Compact representation attributes, float fields sent quantized over the slow links
+    field->compactType  = -1;
+    field->compactScale = 0.0;
+    elemAttr = elemAttributes.namedItem("compacttype");
+    if (!elemAttr.isNull()) {
+        if (field->type != FIELDTYPE_FLOAT32) {
+            return QString("Object:field:compacttype attribute is only valid on float fields");
+        }
+        if (elemAttr.nodeValue() == "int8") {
+            field->compactType = FIELDTYPE_INT8;
+        } else if (elemAttr.nodeValue() == "int16") {
+            field->compactType = FIELDTYPE_INT16;
+        } else {
+            return QString("Object:field:compacttype attribute value is invalid (int8 or int16)");
+        }
+        elemAttr = elemAttributes.namedItem("compactscale");
+        bool ok  = !elemAttr.isNull();
+        if (ok) {
+            field->compactScale = elemAttr.nodeValue().toDouble(&ok);
+        }
+        if (!ok || field->compactScale <= 0.0) {
+            return QString("Object:field:compactscale attribute is missing or invalid");
+        }
+    } else if (!elemAttributes.namedItem("compactscale").isNull()) {
+        return QString("Object:field:compactscale attribute without compacttype");
+    }
     // Add field to object
     info->fields.append(field);
     // Done
@@ -652,6 +709,17 @@ QString UAVObjectParser::processObjectAttributes(QDomNode & node, ObjectInfo *in
         }
     }
 
+    // Get hot attribute
+    attr = attributes.namedItem("hot");
+    info->isHot = false;
+    if (!attr.isNull()) {
+        if (attr.nodeValue().compare(QString("true")) == 0) {
+            info->isHot = true;
+        } else if (attr.nodeValue().compare(QString("false")) != 0) {
+            return QString("Object:hot attribute value is invalid (true|false)");
+        }
+    }
+
     // Settings objects can only have a single instance
     if (info->isSettings && !info->isSingleInst) {
         return QString("Object: Settings objects can not have multiple instances");
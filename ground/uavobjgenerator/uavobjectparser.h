@@ -59,6 +59,8 @@ typedef struct {
     bool defaultElementNames;
     QStringList defaultValues;
     QString     limitValues;
+    int compactType; // FIELDTYPE_INT8 or FIELDTYPE_INT16 when quantized in the compact representation, -1 otherwise
+    double      compactScale; // value of one quantization step
 } FieldInfo;
 
 /**
@@ -86,11 +88,13 @@ typedef struct  {
     bool       isSingleInst;
     bool       isSettings;
     bool       isPriority;
+    bool       isHot; /** Instance data is placed in fast RAM on targets that have it **/
     AccessMode gcsAccess;
     AccessMode flightAccess;
     bool       flightTelemetryAcked;
     UpdateMode flightTelemetryUpdateMode; /** Update mode used by the autopilot (UpdateMode) */
     int flightTelemetryUpdatePeriod; /** Update period used by the autopilot (only if telemetry mode is PERIODIC) */
+    bool       flightTelemetrySkipUnchanged; /** Periodic updates of unchanged data are skipped, but for a keepalive */
     bool       gcsTelemetryAcked;
     UpdateMode gcsTelemetryUpdateMode; /** Update mode used by the GCS (UpdateMode) */
     int gcsTelemetryUpdatePeriod; /** Update period used by the GCS (only if telemetry mode is PERIODIC) */
@@ -131,6 +135,7 @@ private:
     QString processObjectDescription(QDomNode & childNode, QString *description);
     QString processObjectCategory(QDomNode & childNode, QString *category);
     QString processObjectMetadata(QDomNode & childNode, UpdateMode *mode, int *period, bool *acked);
+    QString processObjectSkipUnchanged(QDomNode & childNode, bool *skipUnchanged);
     void calculateID(ObjectInfo *info);
     quint32 updateHash(quint32 value, quint32 hash);
     quint32 updateHash(QString & value, quint32 hash);
@@ -0,0 +1,260 @@
+/**
+ ******************************************************************************
+ *
+ * @file       uavtalkstream.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @brief      Decodes the UAVTalk stream sent by the flight controller to a
+ *             companion computer.
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "uavtalkstream.h"
+
+#include <string.h>
+
+// Protocol constants, as in flight/uavtalk/inc/uavtalk_priv.h
+#define SYNC_VAL           0x3C
+#define TYPE_MASK          0x78
+#define TYPE_VER           0x20
+#define TIMESTAMPED        0x80
+#define TYPE_OBJ           (TYPE_VER | 0x00)
+#define TYPE_OBJ_ACK       (TYPE_VER | 0x02)
+#define TYPE_BUNDLE        (TYPE_VER | 0x05)
+#define MIN_HEADER_LENGTH  10
+#define TIMESTAMP_LENGTH   2
+#define CHECKSUM_LENGTH    1
+#define BUNDLE_ENTRY_HEADER_LENGTH 6
+
+// Bigger than any object, a larger length is a corrupted header
+#define MAX_FRAME_LENGTH   2048
+
+// OveroSync fills the SPI buffers with this value when it has nothing to send
+#define SPI_PADDING        0xFF
+
+// CRC-8 with polynomial 0x07, as PIOS_CRC_updateCRC()
+static uint8_t crcTable[256];
+
+static void initCrcTable()
+{
+    for (int i = 0; i < 256; i++) {
+        uint8_t crc = (uint8_t)i;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+        }
+        crcTable[i] = crc;
+    }
+}
+
+static uint8_t updateCrc(uint8_t crc, const uint8_t *data, size_t length)
+{
+    while (length--) {
+        crc = crcTable[crc ^ *data++];
+    }
+    return crc;
+}
+
+static uint16_t getUInt16(const uint8_t *data)
+{
+    return (uint16_t)(data[0] | (data[1] << 8));
+}
+
+static uint32_t getUInt32(const uint8_t *data)
+{
+    return (uint32_t)data[0] | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+}
+
+UAVTalkStreamReader::UAVTalkStreamReader()
+{
+    if (crcTable[1] == 0) {
+        initCrcTable();
+    }
+    resetStats();
+}
+
+void UAVTalkStreamReader::subscribe(uint32_t objId, Handler handler, void *context)
+{
+    Subscription subscription;
+
+    subscription.handler = handler;
+    subscription.context = context;
+    m_subscriptions[objId] = subscription;
+}
+
+void UAVTalkStreamReader::unsubscribe(uint32_t objId)
+{
+    m_subscriptions.erase(objId);
+}
+
+void UAVTalkStreamReader::setObjectSize(uint32_t objId, uint16_t size)
+{
+    m_sizes[objId] = size;
+}
+
+void UAVTalkStreamReader::resetStats()
+{
+    memset(&m_stats, 0, sizeof(m_stats));
+}
+
+/**
+ * Decode the frames completed by data, the incomplete one is kept for the next call.
+ * The data is parsed in place when nothing is pending, it is only copied when a frame
+ * spans two calls.
+ */
+void UAVTalkStreamReader::feed(const uint8_t *data, size_t length)
+{
+    if (m_buffer.empty()) {
+        size_t pos = parseAll(data, length);
+        m_buffer.assign(data + pos, data + length);
+    } else {
+        m_buffer.insert(m_buffer.end(), data, data + length);
+        size_t pos = parseAll(&m_buffer[0], m_buffer.size());
+        m_buffer.erase(m_buffer.begin(), m_buffer.begin() + pos);
+    }
+}
+
+/**
+ * Decode the complete frames of data.
+ * \return the number of bytes consumed
+ */
+size_t UAVTalkStreamReader::parseAll(const uint8_t *data, size_t length)
+{
+    size_t pos = 0;
+
+    while (pos < length) {
+        size_t next = parse(data, length, pos);
+        if (next == pos) {
+            break;
+        }
+        pos = next;
+    }
+    return pos;
+}
+
+/**
+ * Decode the frame starting at pos.
+ * \return the position of the next frame, pos when the frame is incomplete
+ */
+size_t UAVTalkStreamReader::parse(const uint8_t *data, size_t length, size_t pos)
+{
+    const uint8_t *frame = &data[pos];
+    size_t available     = length - pos;
+
+    if (frame[0] != SYNC_VAL) {
+        if (frame[0] != SPI_PADDING) {
+            m_stats.syncErrors++;
+        }
+        return pos + 1;
+    }
+    if (available < 4) {
+        return pos;
+    }
+
+    uint8_t type = frame[1];
+    uint16_t frameLength  = getUInt16(&frame[2]);
+    uint16_t headerLength = MIN_HEADER_LENGTH + ((type & TIMESTAMPED) ? TIMESTAMP_LENGTH : 0);
+    if ((type & TYPE_MASK) != TYPE_VER || frameLength < headerLength || frameLength > MAX_FRAME_LENGTH) {
+        // Not a frame, the sync value was part of something else
+        m_stats.syncErrors++;
+        return pos + 1;
+    }
+    if (available < (size_t)frameLength + CHECKSUM_LENGTH) {
+        return pos;
+    }
+    if (updateCrc(0, frame, frameLength) != frame[frameLength]) {
+        m_stats.crcErrors++;
+        return pos + 1;
+    }
+
+    m_stats.frames++;
+    dispatch(frame, frameLength);
+    return pos + frameLength + CHECKSUM_LENGTH;
+}
+
+void UAVTalkStreamReader::dispatch(const uint8_t *frame, uint16_t length)
+{
+    uint8_t type = frame[1];
+    Update update;
+
+    update.objId       = getUInt32(&frame[4]);
+    update.instId      = getUInt16(&frame[8]);
+    update.timestamped = (type & TIMESTAMPED) != 0;
+    update.timestamp   = update.timestamped ? getUInt16(&frame[MIN_HEADER_LENGTH]) : 0;
+
+    uint16_t headerLength = MIN_HEADER_LENGTH + (update.timestamped ? TIMESTAMP_LENGTH : 0);
+    update.data   = &frame[headerLength];
+    update.length = length - headerLength;
+
+    switch (type & ~TIMESTAMPED) {
+    case TYPE_OBJ:
+    case TYPE_OBJ_ACK:
+        deliver(update);
+        break;
+    case TYPE_BUNDLE:
+        // The instance ID holds the number of objects
+        dispatchBundle(update.data, update.length, update.instId);
+        break;
+    default:
+        break;
+    }
+}
+
+/**
+ * Split a bundle into its updates, entries are made of the object ID, the instance ID
+ * and the object data.
+ */
+void UAVTalkStreamReader::dispatchBundle(const uint8_t *data, uint16_t length, uint16_t count)
+{
+    uint16_t offset = 0;
+
+    for (uint16_t i = 0; i < count; i++) {
+        if (offset + BUNDLE_ENTRY_HEADER_LENGTH > length) {
+            m_stats.droppedBundles++;
+            return;
+        }
+        Update update;
+        update.objId       = getUInt32(&data[offset]);
+        update.instId      = getUInt16(&data[offset + 4]);
+        update.timestamped = false;
+        update.timestamp   = 0;
+        offset += BUNDLE_ENTRY_HEADER_LENGTH;
+
+        // The rest of the bundle can not be parsed without the size of the object
+        std::map<uint32_t, uint16_t>::const_iterator size = m_sizes.find(update.objId);
+        if (size == m_sizes.end() || offset + size->second > length) {
+            m_stats.droppedBundles++;
+            return;
+        }
+        update.data   = &data[offset];
+        update.length = size->second;
+        offset += size->second;
+        deliver(update);
+    }
+}
+
+void UAVTalkStreamReader::deliver(Update &update)
+{
+    std::map<uint32_t, Subscription>::const_iterator subscription = m_subscriptions.find(update.objId);
+
+    if (subscription == m_subscriptions.end()) {
+        subscription = m_subscriptions.find(0);
+        if (subscription == m_subscriptions.end()) {
+            return;
+        }
+    }
+    m_stats.updates++;
+    subscription->second.handler(update, subscription->second.context);
+}
@@ -0,0 +1,100 @@
+/**
+ ******************************************************************************
+ *
+ * @file       uavtalkstream.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2015.
+ * @brief      Decodes the UAVTalk stream sent by the flight controller to a
+ *             companion computer.
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef UAVTALKSTREAM_H
+#define UAVTALKSTREAM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <map>
+#include <vector>
+
+/**
+ * Decodes the UAVTalk stream of a flight controller (OveroSync over SPI, or a telemetry
+ * port) on a companion computer and hands the object updates to the subscribed handlers.
+ *
+ * The bytes are fed as they are read, in chunks of any size. The SPI padding (0xFF)
+ * sent by OveroSync when it has nothing to stream is skipped. Bundles are split when
+ * the size of their objects has been given with setObjectSize(), they are dropped
+ * otherwise. Requests, acks and compact updates are ignored.
+ *
+ * Only the C++ standard library is used, so that it builds on any companion computer.
+ * The update data is the object packed as on the board (little endian, no padding),
+ * it points into the reader buffer and is only valid during the handler call.
+ */
+class UAVTalkStreamReader {
+public:
+    struct Update {
+        uint32_t objId;
+        uint16_t instId;
+        bool     timestamped;
+        uint16_t timestamp; // board time in ms, modulo 65536
+        const uint8_t *data;
+        uint16_t length;
+    };
+
+    typedef void (*Handler)(const Update &update, void *context);
+
+    struct Stats {
+        uint32_t frames; // valid frames decoded
+        uint32_t updates; // updates handed to a handler
+        uint32_t syncErrors; // bytes skipped to find a frame, padding excluded
+        uint32_t crcErrors;
+        uint32_t droppedBundles; // bundles with an object of unknown size
+    };
+
+    UAVTalkStreamReader();
+
+    // Call handler on each update of objId, of all the objects when objId is 0
+    void subscribe(uint32_t objId, Handler handler, void *context);
+    void unsubscribe(uint32_t objId);
+    // Size of the object data, needed to split the bundles
+    void setObjectSize(uint32_t objId, uint16_t size);
+
+    void feed(const uint8_t *data, size_t length);
+
+    const Stats &stats() const
+    {
+        return m_stats;
+    }
+    void resetStats();
+
+private:
+    struct Subscription {
+        Handler handler;
+        void    *context;
+    };
+
+    size_t parseAll(const uint8_t *data, size_t length);
+    size_t parse(const uint8_t *data, size_t length, size_t pos);
+    void dispatch(const uint8_t *frame, uint16_t length);
+    void dispatchBundle(const uint8_t *data, uint16_t length, uint16_t count);
+    void deliver(Update &update);
+
+    std::vector<uint8_t> m_buffer;
+    std::map<uint32_t, Subscription> m_subscriptions;
+    std::map<uint32_t, uint16_t> m_sizes;
+    Stats m_stats;
+};
+
+#endif // UAVTALKSTREAM_H
@@ -0,0 +1,12 @@
+#
+# Qmake project for the UAVTalk stream reader library, to be linked in the
+# companion computer software. It does not depend on Qt.
+# Copyright (c) 2015, The OpenPilot Team, http://www.openpilot.org
+#
+
+TEMPLATE = lib
+TARGET = uavtalkstream
+CONFIG += staticlib
+CONFIG -= qt
+HEADERS += uavtalkstream.h
+SOURCES += uavtalkstream.cpp
@@ -85,6 +85,7 @@ SRC += $(PIOSCOMMON)/pios_sensors.c
 
 ## Misc library functions
 SRC += $(FLIGHTLIB)/sanitycheck.c
+SRC += $(FLIGHTLIB)/loadgovernor.c
 SRC += $(FLIGHTLIB)/CoordinateConversions.c
 SRC += $(MATHLIB)/sin_lookup.c
 SRC += $(MATHLIB)/pid.c
@@ -93,6 +94,7 @@ SRC += $(MATHLIB)/pid.c
 SRC += $(PIOSCOMMON)/pios_flashfs_logfs.c
 SRC += $(PIOSCOMMON)/pios_flash_jedec.c
 SRC += $(PIOSCOMMON)/pios_debuglog.c
+SRC += $(PIOSCOMMON)/pios_blackbox.c
 endif
 
 SRC += $(PIOSCOMMON)/pios_iap.c
@@ -110,15 +112,19 @@ SRC += $(PIOSCOMMON)/pios_usb_util.c
 endif
 ## PIOS system code
 SRC += $(PIOSCOMMON)/pios_task_monitor.c
+SRC += $(PIOSCOMMON)/pios_initcall.c
 SRC += $(PIOSCOMMON)/pios_callbackscheduler.c
 SRC += $(PIOSCOMMON)/pios_notify.c
 SRC += $(PIOSCOMMON)/pios_instrumentation.c
 SRC += $(PIOSCOMMON)/pios_mem.c
+SRC += $(PIOSCOMMON)/pios_mempool.c
 ## Misc library functions
 SRC += $(FLIGHTLIB)/fifo_buffer.c
 
 SRC += $(MATHLIB)/mathmisc.c
 SRC += $(MATHLIB)/butterworth.c
+SRC += $(MATHLIB)/biquad.c
+SRC += $(MATHLIB)/fft.c
 SRC += $(FLIGHTLIB)/printf-stdarg.c
 SRC += $(FLIGHTLIB)/optypes.c
 
@@ -32,9 +32,17 @@ ENABLE_DEBUG_PINS    ?= NO
 # Set to YES to enable the AUX UART which is mapped on the S1 (Tx) and S2 (Rx) servo outputs
 ENABLE_AUX_UART      ?= NO
 
+# Set to YES to store the INS EKF covariance as a packed triangle with a block structured prediction
+INSGPS_PACKED_COVARIANCE ?= NO
+
+# Set to YES to run the INS EKF covariance prediction and update through the compile time
+# unrolled C++ kernels (larger code), only applies to targets built with USE_CXX = YES
+INSGPS_TEMPLATE_KERNELS ?= NO
+
 # Include objects that are just nice information to show
 DIAG_STACK           ?= NO
 DIAG_MIXERSTATUS     ?= NO
+DIAG_CONTROLLATENCY  ?= NO
 DIAG_RATEDESIRED     ?= NO
 DIAG_I2C_WDG_STATS   ?= NO
 DIAG_TASKS           ?= NO
@@ -73,6 +81,19 @@ ifeq ($(ENABLE_AUX_UART), YES)
     CDEFS += -DPIOS_ENABLE_AUX_UART
 endif
 
+ifeq ($(INSGPS_PACKED_COVARIANCE), YES)
+    CDEFS += -DINSGPS_PACKED_COVARIANCE
+endif
+
+ifeq ($(INSGPS_TEMPLATE_KERNELS), YES)
+ifeq ($(USE_CXX), YES)
+ifneq (,$(filter %/insgps13state.c,$(SRC)))
+    CDEFS  += -DINSGPS_TEMPLATE_KERNELS
+    CPPSRC += $(FLIGHTLIB)/insgps13kernels.cpp
+endif
+endif
+endif
+
 # The following Makefile command, ifneq (,$(filter) $(A), $(B) $(C))
 #    is equivalent to the pseudocode `if (A == B || A == C)`
 ifneq (,$(filter YES,$(DIAG_STACK) $(DIAG_ALL)))
@@ -83,6 +104,10 @@ ifneq (,$(filter YES,$(DIAG_MIXERSTATUS) $(DIAG_ALL)))
     CFLAGS += -DDIAG_MIXERSTATUS
 endif
 
+ifneq (,$(filter YES,$(DIAG_CONTROLLATENCY) $(DIAG_ALL)))
+    CFLAGS += -DDIAG_CONTROLLATENCY
+endif
+
 ifneq (,$(filter YES,$(DIAG_RATEDESIRED) $(DIAG_ALL)))
     CFLAGS += -DDIAG_RATEDESIRED
 endif
@@ -224,11 +249,11 @@ DEPFILES   = $(addprefix $(OUTDIR)/dep/, $(addsuffix .o.d, $(ALLSRCBASE)))
 all: build
 
 ifeq ($(LOADFORMAT),ihex)
-build: elf hex sym
+build: elf hex sym debuglog
 else ifeq ($(LOADFORMAT),binary)
-build: elf bin sym
+build: elf bin sym debuglog
 else ifeq ($(LOADFORMAT),both)
-build: elf hex bin sym
+build: elf hex bin sym debuglog
 else
     $(error "$(MSG_FORMATERROR) $(FORMAT)")
 endif
@@ -278,10 +303,11 @@ $(eval $(call OPFW_TEMPLATE,$(OUTDIR)/$(TARGET).bin,$(BOARD_TYPE),$(BOARD_REVISI
 
 $(OUTDIR)/$(TARGET).bin.o: $(OUTDIR)/$(TARGET).bin
 
-.PHONY: elf lss sym hex bin bino opfw
+.PHONY: elf lss sym debuglog hex bin bino opfw
 elf: $(OUTDIR)/$(TARGET).elf
 lss: $(OUTDIR)/$(TARGET).lss
 sym: $(OUTDIR)/$(TARGET).sym
+debuglog: $(OUTDIR)/$(TARGET).debuglog
 hex: $(OUTDIR)/$(TARGET).hex
 bin: $(OUTDIR)/$(TARGET).bin
 bino: $(OUTDIR)/$(TARGET).bin.o
@@ -298,6 +324,7 @@ clean:
 	$(V1) $(RM) -f $(OUTDIR)/$(TARGET).hex
 	$(V1) $(RM) -f $(OUTDIR)/$(TARGET).bin
 	$(V1) $(RM) -f $(OUTDIR)/$(TARGET).sym
+	$(V1) $(RM) -f $(OUTDIR)/$(TARGET).debuglog
 	$(V1) $(RM) -f $(OUTDIR)/$(TARGET).lss
 	$(V1) $(RM) -f $(OUTDIR)/$(TARGET).bin.o
 	$(V1) $(RM) -f $(OUTDIR)/$(TARGET).opfw
@@ -48,6 +48,7 @@ MSG_BIN_OBJ          = $(QUOTE) BINO      $(MSG_EXTRA) $(QUOTE)
 MSG_STRIP_FILE       = $(QUOTE) STRIP     $(MSG_EXTRA) $(QUOTE)
 MSG_EXTENDED_LISTING = $(QUOTE) LIS       $(MSG_EXTRA) $(QUOTE)
 MSG_SYMBOL_TABLE     = $(QUOTE) NM        $(MSG_EXTRA) $(QUOTE)
+MSG_DEBUGLOG_TABLE   = $(QUOTE) DEBUGLOG  $(MSG_EXTRA) $(QUOTE)
 MSG_ARCHIVING        = $(QUOTE) AR        $(MSG_EXTRA) $(QUOTE)
 MSG_LINKING          = $(QUOTE) LD        $(MSG_EXTRA) $(QUOTE)
 MSG_COMPILING        = $(QUOTE) CC        $(MSG_EXTRA) $(QUOTE)
@@ -119,6 +120,12 @@ gccversion:
 	@$(ECHO) $(MSG_SYMBOL_TABLE) $(call toprel, $@)
 	$(V1) $(NM) -n $< > $@
 
+# Create the string table of the deferred debug log messages from ELF output file.
+# It holds the format strings back to back, the offset of a string is its message id.
+%.debuglog: %.elf
+	@$(ECHO) $(MSG_DEBUGLOG_TABLE) $(call toprel, $@)
+	$(V1) $(OBJCOPY) -O binary --only-section=debuglog_fmt $< $@
+
 define SIZE_TEMPLATE
 .PHONY: size
 size: $(1)_size
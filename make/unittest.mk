@@ -30,7 +30,7 @@ override THUMB :=
 
 # Unit test source files
 ALLSRC     := $(SRC) $(wildcard ./*.c)
-ALLCPPSRC  := $(wildcard ./*.cpp) $(GTEST_DIR)/src/gtest_main.cc
+ALLCPPSRC  := $(CPPSRC) $(wildcard ./*.cpp) $(GTEST_DIR)/src/gtest_main.cc
 ALLSRCBASE := $(notdir $(basename $(ALLSRC) $(ALLCPPSRC)))
 ALLOBJ     := $(addprefix $(OUTDIR)/, $(addsuffix .o, $(ALLSRCBASE)))
 